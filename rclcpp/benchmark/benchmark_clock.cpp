@@ -0,0 +1,75 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include "rcl/time.h"
+
+#include "rclcpp/rclcpp.hpp"
+
+/// Cost of Clock::now() for a clock type.
+static void
+BM_clock_now(benchmark::State & state)
+{
+  rclcpp::Clock clock(static_cast<rcl_clock_type_t>(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(clock.now());
+  }
+}
+
+/// Cost of rcl_clock_get_now(), what Clock::now() used to call, for a clock type.
+static void
+BM_rcl_clock_get_now(benchmark::State & state)
+{
+  rclcpp::Clock clock(static_cast<rcl_clock_type_t>(state.range(0)));
+  rcl_clock_t * clock_handle = clock.get_clock_handle();
+  rcl_time_point_value_t now = 0;
+  for (auto _ : state) {
+    if (rcl_clock_get_now(clock_handle, &now) != RCL_RET_OK) {
+      state.SkipWithError("rcl_clock_get_now() failed");
+      break;
+    }
+    benchmark::DoNotOptimize(now);
+  }
+}
+
+/// Cost of Clock::now() for a ROS clock whose override is enabled with rcl, which uses rcl.
+static void
+BM_clock_now_ros_time_override(benchmark::State & state)
+{
+  rclcpp::Clock clock(RCL_ROS_TIME);
+  if (rcl_enable_ros_time_override(clock.get_clock_handle()) != RCL_RET_OK) {
+    state.SkipWithError("rcl_enable_ros_time_override() failed");
+    return;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(clock.now());
+  }
+}
+
+#define RCLCPP_BENCHMARK_CLOCK_TYPES \
+  Arg(RCL_ROS_TIME)->Arg(RCL_SYSTEM_TIME)->Arg(RCL_STEADY_TIME)
+
+BENCHMARK(BM_clock_now)->RCLCPP_BENCHMARK_CLOCK_TYPES;
+BENCHMARK(BM_rcl_clock_get_now)->RCLCPP_BENCHMARK_CLOCK_TYPES;
+BENCHMARK(BM_clock_now_ros_time_override);
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  rclcpp::shutdown();
+  return 0;
+}
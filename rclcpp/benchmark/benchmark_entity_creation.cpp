@@ -0,0 +1,142 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+#include "test_msgs/srv/empty.hpp"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+enum class EntityKind
+{
+  Publisher,
+  Subscription,
+  Service,
+  Timer,
+};
+
+std::shared_ptr<void>
+create_entity(rclcpp::Node & node, EntityKind kind, const std::string & name)
+{
+  switch (kind) {
+    case EntityKind::Publisher:
+      return node.create_publisher<test_msgs::msg::Empty>(name, 10);
+    case EntityKind::Subscription:
+      return node.create_subscription<test_msgs::msg::Empty>(
+        name, 10, [](test_msgs::msg::Empty::SharedPtr) {});
+    case EntityKind::Service:
+      return node.create_service<test_msgs::srv::Empty>(
+        name, [](
+          const std::shared_ptr<test_msgs::srv::Empty::Request>,
+          std::shared_ptr<test_msgs::srv::Empty::Response>) {});
+    case EntityKind::Timer:
+      return node.create_wall_timer(1h, []() {});
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+/// Time to create and to destroy N nodes with M entities of a kind each.
+/**
+ * The nodes are added to a spinning executor, as in an application, so that the interrupts
+ * of the executor and the graph changes are part of the cost.
+ * The creation and destruction times per entity are reported as counters, in microseconds:
+ * if they grow with N, creating an entity scales with the number of entities in the process.
+ */
+template<EntityKind Kind>
+static void
+BM_create_entities(benchmark::State & state)
+{
+  const size_t number_of_nodes = static_cast<size_t>(state.range(0));
+  const size_t entities_per_node = static_cast<size_t>(state.range(1));
+  rclcpp::executors::SingleThreadedExecutor executor;
+  std::thread spinner([&executor]() {executor.spin();});
+
+  std::chrono::nanoseconds creation_time(0);
+  std::chrono::nanoseconds destruction_time(0);
+  for (auto _ : state) {
+    std::vector<rclcpp::Node::SharedPtr> nodes;
+    std::vector<std::shared_ptr<void>> entities;
+    nodes.reserve(number_of_nodes);
+    entities.reserve(number_of_nodes * entities_per_node);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < number_of_nodes; ++i) {
+      nodes.push_back(std::make_shared<rclcpp::Node>("benchmark_node_" + std::to_string(i)));
+      executor.add_node(nodes.back());
+      for (size_t j = 0; j < entities_per_node; ++j) {
+        entities.push_back(create_entity(*nodes.back(), Kind, "entity_" + std::to_string(j)));
+      }
+    }
+    auto created = std::chrono::steady_clock::now();
+    entities.clear();
+    for (auto & node : nodes) {
+      executor.remove_node(node);
+    }
+    nodes.clear();
+    auto destroyed = std::chrono::steady_clock::now();
+
+    creation_time += created - start;
+    destruction_time += destroyed - created;
+    state.SetIterationTime(std::chrono::duration<double>(destroyed - start).count());
+  }
+  executor.cancel();
+  spinner.join();
+
+  const double entities = static_cast<double>(
+    state.iterations() * number_of_nodes * (entities_per_node ? entities_per_node : 1));
+  state.counters["creation_us_per_entity"] =
+    std::chrono::duration<double, std::micro>(creation_time).count() / entities;
+  state.counters["destruction_us_per_entity"] =
+    std::chrono::duration<double, std::micro>(destruction_time).count() / entities;
+  state.SetItemsProcessed(state.iterations() * number_of_nodes * entities_per_node);
+}
+
+// With M = 0 only nodes are created, the time is then per node.
+#define RCLCPP_BENCHMARK_NODES_X_ENTITIES \
+  Args({1, 0})->Args({10, 0})->Args({100, 0})-> \
+  Args({1, 10})->Args({10, 10})->Args({100, 10})->Args({1, 1000})-> \
+  UseManualTime()->Unit(benchmark::kMillisecond)
+
+BENCHMARK_TEMPLATE(BM_create_entities, EntityKind::Publisher)->
+  RCLCPP_BENCHMARK_NODES_X_ENTITIES;
+BENCHMARK_TEMPLATE(BM_create_entities, EntityKind::Subscription)->
+  RCLCPP_BENCHMARK_NODES_X_ENTITIES;
+BENCHMARK_TEMPLATE(BM_create_entities, EntityKind::Service)->
+  RCLCPP_BENCHMARK_NODES_X_ENTITIES;
+BENCHMARK_TEMPLATE(BM_create_entities, EntityKind::Timer)->
+  RCLCPP_BENCHMARK_NODES_X_ENTITIES;
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,190 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+/// N nodes with M entities each, added to an executor.
+template<typename ExecutorT>
+class ExecutorFixture
+{
+public:
+  ExecutorFixture()
+  : executor(rclcpp::executor::create_default_executor_arguments()) {}
+
+  void
+  add_nodes(size_t number_of_nodes)
+  {
+    for (size_t i = 0; i < number_of_nodes; ++i) {
+      nodes.push_back(std::make_shared<rclcpp::Node>("benchmark_node_" + std::to_string(i)));
+      executor.add_node(nodes.back());
+    }
+  }
+
+  ExecutorT executor;
+  std::vector<rclcpp::Node::SharedPtr> nodes;
+  std::vector<rclcpp::SubscriptionBase::SharedPtr> subscriptions;
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+};
+
+}  // namespace
+
+/// Cost of a spin_some() which finds no work, with N nodes x M subscriptions.
+template<typename ExecutorT>
+static void
+BM_spin_some_idle(benchmark::State & state)
+{
+  ExecutorFixture<ExecutorT> fixture;
+  fixture.add_nodes(state.range(0));
+  for (auto & node : fixture.nodes) {
+    for (int64_t i = 0; i < state.range(1); ++i) {
+      fixture.subscriptions.push_back(
+        node->create_subscription<test_msgs::msg::Empty>(
+          "benchmark_topic_" + std::to_string(i), 10, [](test_msgs::msg::Empty::SharedPtr) {}));
+    }
+  }
+  for (auto _ : state) {
+    fixture.executor.spin_some();
+  }
+}
+
+/// Rate at which empty callbacks are dispatched while spinning, with N nodes x M timers.
+/**
+ * The timers have a period of zero, so they are always ready.
+ * One iteration is one callback per timer.
+ */
+template<typename ExecutorT>
+static void
+BM_dispatch_empty_callbacks(benchmark::State & state)
+{
+  ExecutorFixture<ExecutorT> fixture;
+  fixture.add_nodes(state.range(0));
+  std::atomic_size_t count {0};
+  for (auto & node : fixture.nodes) {
+    for (int64_t i = 0; i < state.range(1); ++i) {
+      fixture.timers.push_back(node->create_wall_timer(0ns, [&count]() {count++;}));
+    }
+  }
+  const size_t callbacks_per_iteration = fixture.timers.size();
+
+  std::thread spinner([&fixture]() {fixture.executor.spin();});
+  for (auto _ : state) {
+    size_t target = count.load() + callbacks_per_iteration;
+    while (count.load() < target) {
+    }
+  }
+  fixture.executor.cancel();
+  spinner.join();
+  state.SetItemsProcessed(state.iterations() * callbacks_per_iteration);
+}
+
+/// Jitter of a 1ms timer while spinning, reported as counters in nanoseconds.
+/**
+ * One iteration is one timer call.
+ */
+template<typename ExecutorT>
+static void
+BM_timer_jitter(benchmark::State & state)
+{
+  ExecutorFixture<ExecutorT> fixture;
+  fixture.add_nodes(1);
+  const auto period = std::chrono::milliseconds(1);
+  // Written by the spinning thread before it publishes the new count.
+  std::vector<std::chrono::steady_clock::time_point> calls(state.max_iterations + 1);
+  std::atomic_size_t count {0};
+  fixture.timers.push_back(
+    fixture.nodes[0]->create_wall_timer(
+      period, [&calls, &count]() {
+        size_t index = count.load();
+        if (index < calls.size()) {
+          calls[index] = std::chrono::steady_clock::now();
+          count.store(index + 1);
+        }
+      }));
+
+  std::thread spinner([&fixture]() {fixture.executor.spin();});
+  while (count.load() == 0) {
+  }
+  for (auto _ : state) {
+    size_t target = count.load() + 1;
+    while (count.load() < target) {
+    }
+  }
+  fixture.executor.cancel();
+  spinner.join();
+
+  // Compare the calls to an ideal clock starting at the first call.
+  size_t number_of_calls = count.load();
+  std::chrono::nanoseconds max_jitter(0);
+  std::chrono::nanoseconds total_jitter(0);
+  for (size_t i = 1; i < number_of_calls; ++i) {
+    auto expected = calls[0] + i * period;
+    auto jitter = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      calls[i] > expected ? calls[i] - expected : expected - calls[i]);
+    max_jitter = std::max(max_jitter, jitter);
+    total_jitter += jitter;
+  }
+  if (number_of_calls > 1) {
+    state.counters["mean_jitter_ns"] =
+      static_cast<double>(total_jitter.count()) / static_cast<double>(number_of_calls - 1);
+    state.counters["max_jitter_ns"] = static_cast<double>(max_jitter.count());
+  }
+}
+
+using rclcpp::executors::MultiThreadedExecutor;
+using rclcpp::executors::SingleThreadedExecutor;
+using rclcpp::executors::StaticSingleThreadedExecutor;
+
+#define RCLCPP_BENCHMARK_NODES_X_ENTITIES \
+  Args({1, 1})->Args({1, 10})->Args({10, 10})->Args({50, 10})
+
+// The other executors use the same spin_some(), or do not implement it.
+BENCHMARK_TEMPLATE(BM_spin_some_idle, SingleThreadedExecutor)->RCLCPP_BENCHMARK_NODES_X_ENTITIES;
+
+BENCHMARK_TEMPLATE(BM_dispatch_empty_callbacks, SingleThreadedExecutor)->
+  RCLCPP_BENCHMARK_NODES_X_ENTITIES->UseRealTime();
+BENCHMARK_TEMPLATE(BM_dispatch_empty_callbacks, StaticSingleThreadedExecutor)->
+  RCLCPP_BENCHMARK_NODES_X_ENTITIES->UseRealTime();
+BENCHMARK_TEMPLATE(BM_dispatch_empty_callbacks, MultiThreadedExecutor)->
+  RCLCPP_BENCHMARK_NODES_X_ENTITIES->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_timer_jitter, SingleThreadedExecutor)->Iterations(1000)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_timer_jitter, StaticSingleThreadedExecutor)->Iterations(1000)->
+  UseRealTime();
+BENCHMARK_TEMPLATE(BM_timer_jitter, MultiThreadedExecutor)->Iterations(1000)->UseRealTime();
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  rclcpp::shutdown();
+  return 0;
+}
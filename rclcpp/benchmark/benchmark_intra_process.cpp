@@ -0,0 +1,106 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+using test_msgs::msg::BasicTypes;
+
+/// Cost of an intra-process publish of a unique_ptr to N subscriptions taking a shared_ptr.
+/**
+ * The message is promoted to a shared_ptr once and shared by all the subscriptions.
+ */
+static void
+BM_intra_process_publish_shared_subscriptions(benchmark::State & state)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "benchmark_intra_process_shared", rclcpp::NodeOptions().use_intra_process_comms(true));
+  std::vector<rclcpp::Subscription<BasicTypes>::SharedPtr> subscriptions;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    subscriptions.push_back(
+      node->create_subscription<BasicTypes>(
+        "benchmark_intra_process_topic", 10, [](BasicTypes::ConstSharedPtr) {}));
+  }
+  auto publisher = node->create_publisher<BasicTypes>("benchmark_intra_process_topic", 10);
+  for (auto _ : state) {
+    publisher->publish(std::make_unique<BasicTypes>());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Cost of an intra-process publish of a unique_ptr to N subscriptions taking a unique_ptr.
+/**
+ * Every subscription but one gets its own copy of the message.
+ */
+static void
+BM_intra_process_publish_unique_subscriptions(benchmark::State & state)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "benchmark_intra_process_unique", rclcpp::NodeOptions().use_intra_process_comms(true));
+  std::vector<rclcpp::Subscription<BasicTypes>::SharedPtr> subscriptions;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    subscriptions.push_back(
+      node->create_subscription<BasicTypes>(
+        "benchmark_intra_process_topic", 10, [](BasicTypes::UniquePtr) {}));
+  }
+  auto publisher = node->create_publisher<BasicTypes>("benchmark_intra_process_topic", 10);
+  for (auto _ : state) {
+    publisher->publish(std::make_unique<BasicTypes>());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Cost of an intra-process publish of a unique_ptr to N subscriptions taking a unique_ptr
+/// from a buffer of shared_ptr.
+/**
+ * The copies are made when the subscriptions take the message, not by the publisher.
+ */
+static void
+BM_intra_process_publish_copy_on_take_subscriptions(benchmark::State & state)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "benchmark_intra_process_copy_on_take", rclcpp::NodeOptions().use_intra_process_comms(true));
+  rclcpp::SubscriptionOptions options;
+  options.intra_process_buffer_type = rclcpp::IntraProcessBufferType::SharedPtr;
+  std::vector<rclcpp::Subscription<BasicTypes>::SharedPtr> subscriptions;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    subscriptions.push_back(
+      node->create_subscription<BasicTypes>(
+        "benchmark_intra_process_topic", 10, [](BasicTypes::UniquePtr) {}, options));
+  }
+  auto publisher = node->create_publisher<BasicTypes>("benchmark_intra_process_topic", 10);
+  for (auto _ : state) {
+    publisher->publish(std::make_unique<BasicTypes>());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_intra_process_publish_shared_subscriptions)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK(BM_intra_process_publish_unique_subscriptions)->Arg(1)->Arg(4)->Arg(16);
+BENCHMARK(BM_intra_process_publish_copy_on_take_subscriptions)->Arg(1)->Arg(4)->Arg(16);
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,208 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/unbounded_sequences.hpp"
+
+using test_msgs::msg::UnboundedSequences;
+
+namespace
+{
+
+using SharedSubscriptions = std::false_type;
+using OwnedSubscriptions = std::true_type;
+
+/// Latencies from the publish to each callback, in nanoseconds.
+class LatencyRecorder
+{
+public:
+  void
+  start()
+  {
+    publish_time_ns_.store(now_ns());
+  }
+
+  void
+  record()
+  {
+    int64_t latency_ns = now_ns() - publish_time_ns_.load();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      latencies_ns_.push_back(latency_ns);
+    }
+    count_.fetch_add(1);
+  }
+
+  size_t
+  count() const
+  {
+    return count_.load();
+  }
+
+  /// Report the percentiles of the latencies as counters, in microseconds.
+  void
+  report(benchmark::State & state)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (latencies_ns_.empty()) {
+      return;
+    }
+    std::sort(latencies_ns_.begin(), latencies_ns_.end());
+    auto percentile = [this](double p) {
+        size_t index = static_cast<size_t>(p * static_cast<double>(latencies_ns_.size() - 1));
+        return static_cast<double>(latencies_ns_[index]) / 1000.0;
+      };
+    state.counters["p50_us"] = percentile(0.5);
+    state.counters["p99_us"] = percentile(0.99);
+    state.counters["p99_9_us"] = percentile(0.999);
+    state.counters["max_us"] = static_cast<double>(latencies_ns_.back()) / 1000.0;
+  }
+
+private:
+  static int64_t
+  now_ns()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  std::atomic<int64_t> publish_time_ns_ {0};
+  std::atomic_size_t count_ {0};
+  std::mutex mutex_;
+  std::vector<int64_t> latencies_ns_;
+};
+
+rclcpp::SubscriptionBase::SharedPtr
+create_subscription(
+  rclcpp::Node & node, LatencyRecorder & recorder, SharedSubscriptions)
+{
+  return node.create_subscription<UnboundedSequences>(
+    "benchmark_intra_process_latency_topic", 10,
+    [&recorder](UnboundedSequences::ConstSharedPtr) {recorder.record();});
+}
+
+rclcpp::SubscriptionBase::SharedPtr
+create_subscription(
+  rclcpp::Node & node, LatencyRecorder & recorder, OwnedSubscriptions)
+{
+  return node.create_subscription<UnboundedSequences>(
+    "benchmark_intra_process_latency_topic", 10,
+    [&recorder](UnboundedSequences::UniquePtr) {recorder.record();});
+}
+
+}  // namespace
+
+/// Latency from an intra-process publish to the callbacks of N subscriptions.
+/**
+ * The first argument is the size of the message in bytes, the second the number of
+ * subscriptions, which either share the message or each own one.
+ * One iteration is one publish, timed until the last callback returns, and the latencies of
+ * all the callbacks are reported as percentiles.
+ */
+template<typename ExecutorT, typename OwnedT>
+static void
+BM_intra_process_latency(benchmark::State & state)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "benchmark_intra_process_latency", rclcpp::NodeOptions().use_intra_process_comms(true));
+  LatencyRecorder recorder;
+  std::vector<rclcpp::SubscriptionBase::SharedPtr> subscriptions;
+  for (int64_t i = 0; i < state.range(1); ++i) {
+    subscriptions.push_back(create_subscription(*node, recorder, OwnedT()));
+  }
+  auto publisher = node->create_publisher<UnboundedSequences>(
+    "benchmark_intra_process_latency_topic", 10);
+  const size_t message_size = static_cast<size_t>(state.range(0));
+  const size_t callbacks_per_iteration = subscriptions.size();
+
+  ExecutorT executor;
+  executor.add_node(node);
+  std::thread spinner([&executor]() {executor.spin();});
+  for (auto _ : state) {
+    auto message = std::make_unique<UnboundedSequences>();
+    message->uint8_values.resize(message_size);
+    size_t target = recorder.count() + callbacks_per_iteration;
+
+    auto start = std::chrono::steady_clock::now();
+    recorder.start();
+    publisher->publish(std::move(message));
+    while (recorder.count() < target) {
+    }
+    state.SetIterationTime(
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+  executor.cancel();
+  spinner.join();
+
+  recorder.report(state);
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+using rclcpp::executors::EventsExecutor;
+using rclcpp::executors::MultiThreadedExecutor;
+using rclcpp::executors::SingleThreadedExecutor;
+using rclcpp::executors::StaticSingleThreadedExecutor;
+
+/// Message sizes from 64 B to 8 MB, with 1 and 4 subscriptions.
+static void
+sizes_x_subscriptions(benchmark::internal::Benchmark * benchmark)
+{
+  for (int64_t size : {64, 4 << 10, 64 << 10, 1 << 20, 8 << 20}) {
+    for (int64_t subscriptions : {1, 4}) {
+      benchmark->Args({size, subscriptions});
+    }
+  }
+  benchmark->UseManualTime()->Unit(benchmark::kMicrosecond);
+}
+
+BENCHMARK_TEMPLATE(BM_intra_process_latency, SingleThreadedExecutor, SharedSubscriptions)->
+  Apply(sizes_x_subscriptions);
+BENCHMARK_TEMPLATE(BM_intra_process_latency, SingleThreadedExecutor, OwnedSubscriptions)->
+  Apply(sizes_x_subscriptions);
+BENCHMARK_TEMPLATE(BM_intra_process_latency, StaticSingleThreadedExecutor, SharedSubscriptions)->
+  Apply(sizes_x_subscriptions);
+BENCHMARK_TEMPLATE(BM_intra_process_latency, StaticSingleThreadedExecutor, OwnedSubscriptions)->
+  Apply(sizes_x_subscriptions);
+BENCHMARK_TEMPLATE(BM_intra_process_latency, MultiThreadedExecutor, SharedSubscriptions)->
+  Apply(sizes_x_subscriptions);
+BENCHMARK_TEMPLATE(BM_intra_process_latency, MultiThreadedExecutor, OwnedSubscriptions)->
+  Apply(sizes_x_subscriptions);
+BENCHMARK_TEMPLATE(BM_intra_process_latency, EventsExecutor, SharedSubscriptions)->
+  Apply(sizes_x_subscriptions);
+BENCHMARK_TEMPLATE(BM_intra_process_latency, EventsExecutor, OwnedSubscriptions)->
+  Apply(sizes_x_subscriptions);
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,214 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+namespace
+{
+
+std::vector<std::string>
+parameter_names(size_t count)
+{
+  std::vector<std::string> names;
+  names.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    names.push_back("parameter_" + std::to_string(i));
+  }
+  return names;
+}
+
+/// Return a node which declared the integer parameters of the names.
+rclcpp::Node::SharedPtr
+create_node(const std::vector<std::string> & names, bool start_parameter_services = false)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "benchmark_parameters",
+    rclcpp::NodeOptions().start_parameter_services(start_parameter_services));
+  for (const auto & name : names) {
+    node->declare_parameter(name, rclcpp::ParameterValue(int64_t(0)));
+  }
+  return node;
+}
+
+}  // namespace
+
+// The benchmarks take the number of parameters of the node as argument, from 10 to 100k, to
+// catch the costs growing with it. Compare the results of two releases with
+// --benchmark_out=<file> --benchmark_out_format=json and Google Benchmark's compare.py.
+
+/// Time to declare the parameters of a node, per parameter.
+static void
+BM_declare_parameter(benchmark::State & state)
+{
+  auto names = parameter_names(static_cast<size_t>(state.range(0)));
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto node = std::make_shared<rclcpp::Node>(
+      "benchmark_parameters", rclcpp::NodeOptions().start_parameter_services(false));
+    state.ResumeTiming();
+    for (const auto & name : names) {
+      node->declare_parameter(name, rclcpp::ParameterValue(int64_t(0)));
+    }
+    state.PauseTiming();
+    node.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Time to get one parameter of a node.
+static void
+BM_get_parameter(benchmark::State & state)
+{
+  auto names = parameter_names(static_cast<size_t>(state.range(0)));
+  auto node = create_node(names);
+  size_t index = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(node->get_parameter(names[index]));
+    index = (index + 1) % names.size();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/// Time to set 10 parameters of a node atomically.
+static void
+BM_set_parameters_atomically(benchmark::State & state)
+{
+  auto names = parameter_names(static_cast<size_t>(state.range(0)));
+  auto node = create_node(names);
+  std::vector<rclcpp::Parameter> parameters;
+  for (size_t i = 0; i < 10; ++i) {
+    parameters.emplace_back(names[i * names.size() / 10], int64_t(0));
+  }
+  int64_t value = 0;
+  for (auto _ : state) {
+    ++value;
+    for (auto & parameter : parameters) {
+      parameter = rclcpp::Parameter(parameter.get_name(), value);
+    }
+    auto result = node->set_parameters_atomically(parameters);
+    if (!result.successful) {
+      state.SkipWithError(result.reason.c_str());
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * 10);
+}
+
+/// Time to list all the parameters of a node, per parameter.
+static void
+BM_list_parameters(benchmark::State & state)
+{
+  auto node = create_node(parameter_names(static_cast<size_t>(state.range(0))));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(node->list_parameters({}, 0));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/// Round trip of a request to the get_parameters service of a node, for one parameter.
+/**
+ * The node and the client are spun by an executor, the parameter services go through the
+ * middleware even in the same process.
+ */
+static void
+BM_get_parameters_service(benchmark::State & state)
+{
+  auto names = parameter_names(static_cast<size_t>(state.range(0)));
+  auto node = create_node(names, true);
+  auto client_node = std::make_shared<rclcpp::Node>("benchmark_parameters_client");
+  auto client = std::make_shared<rclcpp::AsyncParametersClient>(
+    client_node, "benchmark_parameters");
+  if (!client->wait_for_service(std::chrono::seconds(10))) {
+    state.SkipWithError("the parameter services aren't ready");
+    return;
+  }
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.add_node(client_node);
+  std::thread spinner([&executor]() {executor.spin();});
+  size_t index = 0;
+  for (auto _ : state) {
+    auto future = client->get_parameters({names[index]});
+    if (future.wait_for(std::chrono::seconds(10)) != std::future_status::ready) {
+      state.SkipWithError("no response of the get_parameters service");
+      break;
+    }
+    index = (index + 1) % names.size();
+  }
+  executor.cancel();
+  spinner.join();
+  state.SetItemsProcessed(state.iterations());
+}
+
+/// Round trip of a request to the list_parameters service of a node, per parameter.
+static void
+BM_list_parameters_service(benchmark::State & state)
+{
+  auto node = create_node(parameter_names(static_cast<size_t>(state.range(0))), true);
+  auto client_node = std::make_shared<rclcpp::Node>("benchmark_parameters_client");
+  auto client = std::make_shared<rclcpp::AsyncParametersClient>(
+    client_node, "benchmark_parameters");
+  if (!client->wait_for_service(std::chrono::seconds(10))) {
+    state.SkipWithError("the parameter services aren't ready");
+    return;
+  }
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.add_node(client_node);
+  std::thread spinner([&executor]() {executor.spin();});
+  for (auto _ : state) {
+    auto future = client->list_parameters({}, 0);
+    if (future.wait_for(std::chrono::seconds(10)) != std::future_status::ready) {
+      state.SkipWithError("no response of the list_parameters service");
+      break;
+    }
+  }
+  executor.cancel();
+  spinner.join();
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_declare_parameter)->RangeMultiplier(10)->Range(10, 100000)->
+  Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_get_parameter)->RangeMultiplier(10)->Range(10, 100000);
+BENCHMARK(BM_set_parameters_atomically)->RangeMultiplier(10)->Range(10, 100000)->
+  Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_list_parameters)->RangeMultiplier(10)->Range(10, 100000)->
+  Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_get_parameters_service)->RangeMultiplier(10)->Range(10, 100000)->
+  Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_list_parameters_service)->RangeMultiplier(10)->Range(10, 100000)->
+  Unit(benchmark::kMicrosecond);
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,213 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#ifndef _WIN32
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/srv/basic_types.hpp"
+
+using test_msgs::srv::BasicTypes;
+
+namespace
+{
+
+using LocalServer = std::false_type;
+using RemoteServer = std::true_type;
+
+using FutureMode = std::false_type;
+using CallbackMode = std::true_type;
+
+constexpr char local_service_name[] = "benchmark_service_round_trip_local";
+constexpr char remote_service_name[] = "benchmark_service_round_trip_remote";
+
+/// Return the service echoing the string of the requests.
+rclcpp::ServiceBase::SharedPtr
+create_echo_service(rclcpp::Node & node, const std::string & service_name)
+{
+  return node.create_service<BasicTypes>(
+    service_name,
+    [](
+      const std::shared_ptr<BasicTypes::Request> request,
+      std::shared_ptr<BasicTypes::Response> response)
+    {
+      response->string_value = std::move(request->string_value);
+    });
+}
+
+/// Report the percentiles of the latencies as counters, in microseconds.
+void
+report_latencies(benchmark::State & state, std::vector<int64_t> & latencies_ns)
+{
+  if (latencies_ns.empty()) {
+    return;
+  }
+  std::sort(latencies_ns.begin(), latencies_ns.end());
+  auto percentile = [&latencies_ns](double p) {
+      size_t index = static_cast<size_t>(p * static_cast<double>(latencies_ns.size() - 1));
+      return static_cast<double>(latencies_ns[index]) / 1000.0;
+    };
+  state.counters["p50_us"] = percentile(0.5);
+  state.counters["p99_us"] = percentile(0.99);
+  state.counters["p99_9_us"] = percentile(0.999);
+  state.counters["max_us"] = static_cast<double>(latencies_ns.back()) / 1000.0;
+}
+
+void
+send_request(
+  rclcpp::Client<BasicTypes> & client, std::shared_ptr<BasicTypes::Request> request,
+  std::atomic_size_t & responses, FutureMode)
+{
+  client.async_send_request(
+    request, [&responses](rclcpp::Client<BasicTypes>::SharedFuture) {++responses;});
+}
+
+void
+send_request(
+  rclcpp::Client<BasicTypes> & client, std::shared_ptr<BasicTypes::Request> request,
+  std::atomic_size_t & responses, CallbackMode)
+{
+  client.async_send_request(
+    request, [&responses](rclcpp::Client<BasicTypes>::SharedResponse) {++responses;});
+}
+
+}  // namespace
+
+/// Round trips of requests to a service, in the same process or from another one.
+/**
+ * The argument is the size of the string of the request, which the service echoes.
+ * One iteration sends a request and waits for its response, the responses are given
+ * either through a future or only to a callback.
+ * The remote service runs in a child process, forked by main() before rclcpp is initialized.
+ */
+template<typename ExecutorT, typename ServerT, typename ModeT>
+static void
+BM_service_round_trip(benchmark::State & state)
+{
+  auto node = std::make_shared<rclcpp::Node>("benchmark_service_round_trip");
+  rclcpp::ServiceBase::SharedPtr service;
+  std::string service_name = remote_service_name;
+  if (!ServerT::value) {
+    service_name = local_service_name;
+    service = create_echo_service(*node, service_name);
+  }
+  auto client = node->create_client<BasicTypes>(service_name);
+  if (!client->wait_for_service(std::chrono::seconds(10))) {
+    state.SkipWithError("the service isn't ready");
+    return;
+  }
+
+  ExecutorT executor;
+  executor.add_node(node);
+  std::thread spinner([&executor]() {executor.spin();});
+  auto request = std::make_shared<BasicTypes::Request>();
+  request->string_value.resize(static_cast<size_t>(state.range(0)), 'a');
+  std::atomic_size_t responses{0};
+  std::vector<int64_t> latencies_ns;
+  for (auto _ : state) {
+    size_t target = responses.load() + 1;
+    auto start = std::chrono::steady_clock::now();
+    send_request(*client, request, responses, ModeT());
+    while (responses.load() < target) {
+    }
+    auto latency = std::chrono::steady_clock::now() - start;
+    latencies_ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+    state.SetIterationTime(std::chrono::duration<double>(latency).count());
+  }
+  executor.cancel();
+  spinner.join();
+
+  report_latencies(state, latencies_ns);
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+using rclcpp::executors::MultiThreadedExecutor;
+using rclcpp::executors::SingleThreadedExecutor;
+using rclcpp::executors::StaticSingleThreadedExecutor;
+
+/// Request sizes from 64 B to 1 MB.
+static void
+request_sizes(benchmark::internal::Benchmark * benchmark)
+{
+  for (int64_t size : {64, 4 << 10, 64 << 10, 1 << 20}) {
+    benchmark->Arg(size);
+  }
+  benchmark->UseManualTime()->Unit(benchmark::kMicrosecond);
+}
+
+BENCHMARK_TEMPLATE(BM_service_round_trip, SingleThreadedExecutor, LocalServer, FutureMode)->
+  Apply(request_sizes);
+BENCHMARK_TEMPLATE(BM_service_round_trip, SingleThreadedExecutor, LocalServer, CallbackMode)->
+  Apply(request_sizes);
+BENCHMARK_TEMPLATE(
+  BM_service_round_trip, StaticSingleThreadedExecutor, LocalServer, CallbackMode)->
+  Apply(request_sizes);
+BENCHMARK_TEMPLATE(BM_service_round_trip, MultiThreadedExecutor, LocalServer, CallbackMode)->
+  Apply(request_sizes);
+BENCHMARK_TEMPLATE(BM_service_round_trip, SingleThreadedExecutor, RemoteServer, FutureMode)->
+  Apply(request_sizes);
+BENCHMARK_TEMPLATE(BM_service_round_trip, SingleThreadedExecutor, RemoteServer, CallbackMode)->
+  Apply(request_sizes);
+BENCHMARK_TEMPLATE(
+  BM_service_round_trip, StaticSingleThreadedExecutor, RemoteServer, CallbackMode)->
+  Apply(request_sizes);
+BENCHMARK_TEMPLATE(BM_service_round_trip, MultiThreadedExecutor, RemoteServer, CallbackMode)->
+  Apply(request_sizes);
+
+int main(int argc, char ** argv)
+{
+#ifndef _WIN32
+  // The remote service is forked before any thread is started.
+  pid_t server_pid = fork();
+  if (0 == server_pid) {
+    rclcpp::init(argc, argv);
+    auto node = std::make_shared<rclcpp::Node>("benchmark_service_round_trip_server");
+    auto service = create_echo_service(*node, remote_service_name);
+    // Spins until the benchmarks interrupt it.
+    rclcpp::spin(node);
+    rclcpp::shutdown();
+    return 0;
+  }
+#endif
+  rclcpp::init(argc, argv);
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  rclcpp::shutdown();
+#ifndef _WIN32
+  if (server_pid > 0) {
+    kill(server_pid, SIGINT);
+    waitpid(server_pid, nullptr, 0);
+  }
+#endif
+  return 0;
+}
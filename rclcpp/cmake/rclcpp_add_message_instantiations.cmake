@@ -0,0 +1,86 @@
+# Copyright 2020 Open Source Robotics Foundation, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+#
+# Add a shared library instantiating the rclcpp templates of message types.
+#
+# One source file is generated per message, so the instantiations are built in
+# parallel, with RCLCPP_INSTANTIATE_MESSAGE_TEMPLATES() of rclcpp/extern_templates.hpp.
+# The header `<target>/extern_templates.hpp` is generated too: it includes the
+# messages and declares their instantiations with RCLCPP_EXTERN_MESSAGE_TEMPLATES(),
+# so the targets linking the library include it instead of the message headers.
+#
+# The header name of a message is its name in snake case, e.g. the header of
+# `sensor_msgs/msg/PointCloud2` is `sensor_msgs/msg/point_cloud2.hpp`.
+#
+# :param target: the name of the library to be created
+# :type target: string
+# :param MESSAGES: the message types, e.g. `std_msgs/msg/String`
+# :type MESSAGES: list of strings
+# :param DEPENDENCIES: the packages of the messages
+# :type DEPENDENCIES: list of strings
+#
+function(rclcpp_add_message_instantiations target)
+  cmake_parse_arguments(ARG "" "" "MESSAGES;DEPENDENCIES" ${ARGN})
+  if(ARG_UNPARSED_ARGUMENTS)
+    message(FATAL_ERROR "rclcpp_add_message_instantiations() called with unused "
+      "arguments: ${ARG_UNPARSED_ARGUMENTS}")
+  endif()
+  if(NOT ARG_MESSAGES)
+    message(FATAL_ERROR
+      "rclcpp_add_message_instantiations() requires at least one message type")
+  endif()
+
+  set(output_dir "${CMAKE_CURRENT_BINARY_DIR}/rclcpp_message_instantiations/${target}")
+  set(includes "")
+  set(declarations "")
+  set(sources "")
+  foreach(message ${ARG_MESSAGES})
+    get_filename_component(message_name "${message}" NAME)
+    get_filename_component(message_dir "${message}" DIRECTORY)
+    string(REGEX REPLACE "([a-z0-9])([A-Z])" "\\1_\\2" header_name "${message_name}")
+    string(TOLOWER "${header_name}" header_name)
+    set(header "${message_dir}/${header_name}.hpp")
+    string(REPLACE "/" "::" type "${message}")
+    string(REPLACE "/" "__" source_name "${message_dir}/${header_name}")
+
+    set(includes "${includes}#include \"${header}\"\n")
+    set(declarations "${declarations}RCLCPP_EXTERN_MESSAGE_TEMPLATES(${type});\n")
+    set(source "${output_dir}/src/${source_name}.cpp")
+    set(content "// generated by rclcpp_add_message_instantiations()\n\n")
+    set(content "${content}#include \"${header}\"\n\n")
+    set(content "${content}#include \"rclcpp/extern_templates.hpp\"\n\n")
+    set(content "${content}RCLCPP_INSTANTIATE_MESSAGE_TEMPLATES(${type});\n")
+    file(GENERATE OUTPUT "${source}" CONTENT "${content}")
+    list(APPEND sources "${source}")
+  endforeach()
+
+  string(TOUPPER "${target}" guard)
+  string(MAKE_C_IDENTIFIER "${guard}" guard)
+  set(content "// generated by rclcpp_add_message_instantiations()\n\n")
+  set(content "${content}#ifndef ${guard}__EXTERN_TEMPLATES_HPP_\n")
+  set(content "${content}#define ${guard}__EXTERN_TEMPLATES_HPP_\n\n")
+  set(content "${content}${includes}\n")
+  set(content "${content}#include \"rclcpp/extern_templates.hpp\"\n\n")
+  set(content "${content}${declarations}\n")
+  set(content "${content}#endif  // ${guard}__EXTERN_TEMPLATES_HPP_\n")
+  file(GENERATE OUTPUT "${output_dir}/include/${target}/extern_templates.hpp"
+    CONTENT "${content}")
+
+  add_library(${target} SHARED ${sources})
+  target_include_directories(${target} PUBLIC
+    "$<BUILD_INTERFACE:${output_dir}/include>"
+    "$<INSTALL_INTERFACE:include>")
+  ament_target_dependencies(${target} "rclcpp" ${ARG_DEPENDENCIES})
+endfunction()
@@ -82,6 +82,29 @@ rcl_allocator_t get_rcl_allocator(Alloc & allocator)
   return rcl_allocator;
 }
 
+template<typename T>
+class MessagePoolAllocator;
+
+template<typename T>
+class ArenaAllocator;
+
+// The memory allocated by rcl doesn't come from the pools and arenas bundled with rclcpp:
+// rcl keeps a pointer to the allocator it is given beyond the lifetime of the options, and
+// retyped_reallocate() doesn't preserve the content of the memory it reallocates.
+template<typename T, typename U>
+rcl_allocator_t get_rcl_allocator(MessagePoolAllocator<U> & allocator)
+{
+  (void)allocator;
+  return rcl_get_default_allocator();
+}
+
+template<typename T, typename U>
+rcl_allocator_t get_rcl_allocator(ArenaAllocator<U> & allocator)
+{
+  (void)allocator;
+  return rcl_get_default_allocator();
+}
+
 // TODO(jacquelinekay) Workaround for an incomplete implementation of std::allocator<void>
 template<
   typename T,
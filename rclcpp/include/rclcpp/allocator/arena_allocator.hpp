@@ -0,0 +1,253 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ALLOCATOR__ARENA_ALLOCATOR_HPP_
+#define RCLCPP__ALLOCATOR__ARENA_ALLOCATOR_HPP_
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+
+#include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace allocator
+{
+
+/// Memory arena with a deterministic, constant time allocation.
+/**
+ * The whole arena is allocated by the constructor.
+ * Blocks are rounded up to a power of two size, and each size class has its own free list:
+ * allocate() takes a block from the free list of its size class, or carves a new one from the
+ * unused part of the arena, and deallocate() gives it back to its free list.
+ * Both run in constant time, and never call the global allocator.
+ *
+ * Blocks are not split nor merged, so the arena should be sized for the peak usage of each size
+ * class. allocate() throws std::bad_alloc once the arena is used up.
+ */
+class Arena
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(Arena)
+
+  /// Constructor.
+  /**
+   * \param[in] capacity size of the arena in bytes.
+   * \throws std::invalid_argument if the capacity is zero.
+   */
+  explicit Arena(size_t capacity)
+  : capacity_(round_up(capacity)),
+    storage_(new Header[capacity_ / sizeof(Header)]),
+    used_(0),
+    block_count_(0)
+  {
+    if (capacity == 0) {
+      throw std::invalid_argument("capacity must be a positive, non-zero value");
+    }
+    free_blocks_.fill(nullptr);
+  }
+
+  /// Allocate a block of at least `size` bytes, aligned as std::max_align_t.
+  /**
+   * \throws std::bad_alloc if the arena is used up.
+   */
+  void *
+  allocate(size_t size)
+  {
+    size_t size_class = get_size_class(size + sizeof(Header));
+    std::lock_guard<std::mutex> lock(mutex_);
+    Header * block = free_blocks_[size_class];
+    if (block) {
+      free_blocks_[size_class] = block->next;
+    } else {
+      size_t block_size = min_block_size << size_class;
+      if (capacity_ - used_ < block_size) {
+        throw std::bad_alloc();
+      }
+      block = reinterpret_cast<Header *>(reinterpret_cast<char *>(storage_.get()) + used_);
+      used_ += block_size;
+    }
+    block->size_class = size_class;
+    block_count_++;
+    return block + 1;
+  }
+
+  /// Give back a block returned by allocate().
+  void
+  deallocate(void * pointer)
+  {
+    if (!pointer) {
+      return;
+    }
+    Header * block = static_cast<Header *>(pointer) - 1;
+    size_t size_class = block->size_class;
+    std::lock_guard<std::mutex> lock(mutex_);
+    block->next = free_blocks_[size_class];
+    free_blocks_[size_class] = block;
+    block_count_--;
+  }
+
+  /// Return true if the pointer was allocated from this arena.
+  bool
+  owns(const void * pointer) const
+  {
+    auto begin = reinterpret_cast<const char *>(storage_.get());
+    auto address = static_cast<const char *>(pointer);
+    return address >= begin && address < begin + capacity_;
+  }
+
+  size_t
+  get_capacity() const
+  {
+    return capacity_;
+  }
+
+  /// Return the number of bytes of the arena carved into blocks, free or not.
+  size_t
+  get_used_size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return used_;
+  }
+
+  /// Return the number of blocks which are allocated.
+  size_t
+  get_block_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return block_count_;
+  }
+
+private:
+  /// Stored before each block, it is also the alignment of the blocks.
+  union alignas(std::max_align_t) Header
+  {
+    Header * next;
+    size_t size_class;
+  };
+
+  static constexpr size_t min_block_size = 2 * sizeof(Header);
+  static constexpr size_t size_class_count = sizeof(size_t) * 8;
+
+  static size_t
+  round_up(size_t size)
+  {
+    return (size + sizeof(Header) - 1) / sizeof(Header) * sizeof(Header);
+  }
+
+  static size_t
+  get_size_class(size_t size)
+  {
+    size_t size_class = 0;
+    while ((min_block_size << size_class) < size) {
+      if (++size_class == size_class_count) {
+        throw std::bad_alloc();
+      }
+    }
+    return size_class;
+  }
+
+  const size_t capacity_;
+  std::unique_ptr<Header[]> storage_;
+  std::array<Header *, size_class_count> free_blocks_;
+  size_t used_;
+  size_t block_count_;
+  mutable std::mutex mutex_;
+};
+
+/// Allocator taking its memory from an Arena.
+/**
+ * It can be used with all the entities taking an allocator: publishers, subscriptions, their
+ * message memory strategies and the executor memory strategy, so that spinning doesn't use the
+ * global allocator once the executor and the entities are warmed up.
+ *
+ * All the allocators rebound from the same instance share its arena.
+ * A default constructed allocator has no arena and uses the global operator new.
+ */
+template<typename T>
+class ArenaAllocator
+{
+public:
+  using value_type = T;
+
+  template<typename U>
+  struct rebind
+  {
+    using other = ArenaAllocator<U>;
+  };
+
+  ArenaAllocator() = default;
+
+  explicit ArenaAllocator(Arena::SharedPtr arena)
+  : arena_(std::move(arena))
+  {}
+
+  template<typename U>
+  ArenaAllocator(const ArenaAllocator<U> & other)  // NOLINT(runtime/explicit)
+  : arena_(other.get_arena())
+  {}
+
+  T *
+  allocate(size_t n)
+  {
+    if (!arena_) {
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+    return static_cast<T *>(arena_->allocate(n * sizeof(T)));
+  }
+
+  void
+  deallocate(T * pointer, size_t n)
+  {
+    (void)n;
+    if (!arena_) {
+      ::operator delete(pointer);
+      return;
+    }
+    arena_->deallocate(pointer);
+  }
+
+  const Arena::SharedPtr &
+  get_arena() const
+  {
+    return arena_;
+  }
+
+private:
+  Arena::SharedPtr arena_;
+};
+
+template<typename T, typename U>
+bool
+operator==(const ArenaAllocator<T> & lhs, const ArenaAllocator<U> & rhs)
+{
+  return lhs.get_arena() == rhs.get_arena();
+}
+
+template<typename T, typename U>
+bool
+operator!=(const ArenaAllocator<T> & lhs, const ArenaAllocator<U> & rhs)
+{
+  return !(lhs == rhs);
+}
+
+}  // namespace allocator
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ALLOCATOR__ARENA_ALLOCATOR_HPP_
@@ -0,0 +1,253 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ALLOCATOR__HUGE_PAGE_ALLOCATOR_HPP_
+#define RCLCPP__ALLOCATOR__HUGE_PAGE_ALLOCATOR_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace allocator
+{
+
+/// Options of a HugePageArena.
+struct HugePageArenaOptions
+{
+  /// Size of the arena in bytes, rounded up to a multiple of the huge page size.
+  size_t capacity = 64 * 1024 * 1024;
+  /// Allocations smaller than this use the global operator new, so that only the large buffers,
+  /// e.g. of images and point clouds, take space in the arena.
+  size_t min_allocation_size = 64 * 1024;
+  /// Map the arena from the pool of huge pages of hugetlbfs, which needs huge pages reserved
+  /// by the system, instead of asking for transparent huge pages. It falls back to transparent
+  /// huge pages if the pool can't provide the arena.
+  bool use_hugetlbfs = false;
+};
+
+/// Counters of a HugePageArena.
+struct HugePageArenaStatistics
+{
+  /// Number of allocations served from the arena.
+  uint64_t arena_allocations = 0;
+  /// Number of allocations at least of the minimum size served by the global operator new, the
+  /// arena being used up.
+  uint64_t overflow_allocations = 0;
+  /// Number of allocations under the minimum size, served by the global operator new.
+  uint64_t small_allocations = 0;
+  /// Number of bytes of the arena carved into blocks, free or not.
+  size_t used_size = 0;
+  /// Number of bytes of the arena the system currently backs with huge pages.
+  size_t huge_page_size = 0;
+
+  /// Return the ratio of the large allocations served from the arena, 1 if there were none.
+  double
+  get_hit_rate() const
+  {
+    uint64_t large_allocations = arena_allocations + overflow_allocations;
+    return large_allocations ? static_cast<double>(arena_allocations) / large_allocations : 1.0;
+  }
+};
+
+/// Arena of huge pages for the large buffers of the messages.
+/**
+ * The arena is mapped by the constructor, aligned on huge pages, and backed with transparent
+ * huge pages or with hugetlbfs, see HugePageArenaOptions.
+ * Large multi-megabyte buffers then take a few TLB entries instead of hundreds, and their page
+ * faults are reduced as much when first touched.
+ *
+ * Like Arena, blocks have size classes with a free list each, and are not split nor merged;
+ * there are four size classes per power of two, from 4 KiB, to waste less of the arena on the
+ * large buffers.
+ * Once the arena is used up, the allocations use the global operator new and are counted as
+ * overflows, so the arena should be sized for the peak usage of the buffers.
+ * Where huge pages are not supported the arena is allocated with the global operator new.
+ */
+class HugePageArena
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(HugePageArena)
+
+  /// Constructor.
+  /**
+   * \param[in] options The options of the arena.
+   * \throws std::invalid_argument if the capacity is zero.
+   * \throws std::bad_alloc if the arena can't be mapped.
+   */
+  RCLCPP_PUBLIC
+  explicit HugePageArena(const HugePageArenaOptions & options = HugePageArenaOptions());
+
+  RCLCPP_PUBLIC
+  ~HugePageArena();
+
+  /// Allocate at least `size` bytes, aligned as std::max_align_t.
+  /**
+   * \throws std::bad_alloc if neither the arena nor the global operator new can allocate it.
+   */
+  RCLCPP_PUBLIC
+  void *
+  allocate(size_t size);
+
+  /// Give back memory returned by allocate().
+  RCLCPP_PUBLIC
+  void
+  deallocate(void * pointer);
+
+  /// Return true if the pointer was allocated from the arena.
+  bool
+  owns(const void * pointer) const
+  {
+    auto address = static_cast<const char *>(pointer);
+    return address >= storage_ && address < storage_ + capacity_;
+  }
+
+  size_t
+  get_capacity() const
+  {
+    return capacity_;
+  }
+
+  /// Return true if the arena was mapped from hugetlbfs.
+  bool
+  uses_hugetlbfs() const
+  {
+    return hugetlbfs_;
+  }
+
+  /// Return the counters of the arena.
+  /**
+   * HugePageArenaStatistics::huge_page_size is read from the system, from /proc/self/smaps
+   * for the transparent huge pages, so this isn't meant to be called on a hot path.
+   */
+  RCLCPP_PUBLIC
+  HugePageArenaStatistics
+  get_statistics() const;
+
+private:
+  /// Stored before each block, it is also the alignment of the blocks.
+  union alignas(std::max_align_t) Header
+  {
+    Header * next;
+    size_t size_class;
+  };
+
+  static constexpr size_t min_block_size = 4096;
+  static constexpr size_t size_class_count = 4 * sizeof(size_t) * 8;
+
+  /// Return the size class of a block of `size` bytes, and set `block_size` to its size.
+  static size_t
+  get_size_class(size_t size, size_t & block_size);
+
+  const size_t min_allocation_size_;
+  size_t capacity_;
+  char * storage_;
+  /// Size of the mapping of the arena, 0 if it was allocated with the global operator new.
+  size_t mapped_size_;
+  bool hugetlbfs_;
+  std::array<Header *, size_class_count> free_blocks_;
+  size_t used_;
+  uint64_t arena_allocations_;
+  std::atomic<uint64_t> overflow_allocations_;
+  std::atomic<uint64_t> small_allocations_;
+  mutable std::mutex mutex_;
+};
+
+/// Allocator taking the large allocations from a HugePageArena.
+/**
+ * It can be used like ArenaAllocator with the publishers, the subscriptions and their message
+ * memory strategies, the messages allocated for the intra-process buffers included.
+ *
+ * All the allocators rebound from the same instance share its arena.
+ * A default constructed allocator has no arena and uses the global operator new.
+ */
+template<typename T>
+class HugePageAllocator
+{
+public:
+  using value_type = T;
+
+  template<typename U>
+  struct rebind
+  {
+    using other = HugePageAllocator<U>;
+  };
+
+  HugePageAllocator() = default;
+
+  explicit HugePageAllocator(HugePageArena::SharedPtr arena)
+  : arena_(std::move(arena))
+  {}
+
+  template<typename U>
+  HugePageAllocator(const HugePageAllocator<U> & other)  // NOLINT(runtime/explicit)
+  : arena_(other.get_arena())
+  {}
+
+  T *
+  allocate(size_t n)
+  {
+    if (!arena_) {
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+    return static_cast<T *>(arena_->allocate(n * sizeof(T)));
+  }
+
+  void
+  deallocate(T * pointer, size_t n)
+  {
+    (void)n;
+    if (!arena_) {
+      ::operator delete(pointer);
+      return;
+    }
+    arena_->deallocate(pointer);
+  }
+
+  const HugePageArena::SharedPtr &
+  get_arena() const
+  {
+    return arena_;
+  }
+
+private:
+  HugePageArena::SharedPtr arena_;
+};
+
+template<typename T, typename U>
+bool
+operator==(const HugePageAllocator<T> & lhs, const HugePageAllocator<U> & rhs)
+{
+  return lhs.get_arena() == rhs.get_arena();
+}
+
+template<typename T, typename U>
+bool
+operator!=(const HugePageAllocator<T> & lhs, const HugePageAllocator<U> & rhs)
+{
+  return !(lhs == rhs);
+}
+
+}  // namespace allocator
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ALLOCATOR__HUGE_PAGE_ALLOCATOR_HPP_
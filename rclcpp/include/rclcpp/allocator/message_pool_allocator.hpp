@@ -0,0 +1,291 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ALLOCATOR__MESSAGE_POOL_ALLOCATOR_HPP_
+#define RCLCPP__ALLOCATOR__MESSAGE_POOL_ALLOCATOR_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/numa.hpp"
+
+namespace rclcpp
+{
+namespace allocator
+{
+
+/// Fixed number of preallocated memory blocks of the same size.
+/**
+ * All the blocks are allocated by the constructor, allocate() and deallocate() then only
+ * take a block from and give it back to a free list whose capacity is reserved.
+ * Requests larger than a block, or made while all the blocks are in use, fall back to the
+ * global operator new and are counted by get_fallback_count().
+ *
+ * The blocks can be placed on a NUMA node, e.g. the one of the executor thread running the
+ * subscriptions using the pool, see rclcpp::ThreadOptions::numa_node.
+ */
+class MessagePool
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(MessagePool)
+
+  /// Constructor.
+  /**
+   * \param[in] block_size minimum size of the blocks in bytes; it is rounded up to the
+   *   alignment of std::max_align_t.
+   * \param[in] block_count number of blocks.
+   * \param[in] numa_node NUMA node the blocks are preferably placed on, negative for the
+   *   default placement, see rclcpp::allocate_on_numa_node().
+   * \throws std::invalid_argument if the block size or the block count are zero.
+   */
+  MessagePool(size_t block_size, size_t block_count, int numa_node = -1)
+  : block_size_(round_up_block_size(block_size)),
+    block_count_(block_count),
+    numa_node_(numa_node),
+    storage_(nullptr, StorageDeleter{0}),
+    fallback_count_(0)
+  {
+    if (block_size == 0 || block_count == 0) {
+      throw std::invalid_argument("block_size and block_count must be positive, non-zero values");
+    }
+    size_t storage_size = block_size_ * block_count_;
+    if (numa_node_ < 0) {
+      storage_ = Storage(new Block[storage_size / sizeof(Block)], StorageDeleter{0});
+    } else {
+      storage_ = Storage(
+        static_cast<Block *>(rclcpp::allocate_on_numa_node(storage_size, numa_node_)),
+        StorageDeleter{storage_size});
+    }
+    free_blocks_.reserve(block_count_);
+    for (size_t i = block_count_; i > 0; --i) {
+      free_blocks_.push_back(get_block(i - 1));
+    }
+  }
+
+  /// Return a free block if `size` fits in it, memory from the global operator new otherwise.
+  void *
+  allocate(size_t size)
+  {
+    if (size <= block_size_) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!free_blocks_.empty()) {
+        void * block = free_blocks_.back();
+        free_blocks_.pop_back();
+        return block;
+      }
+    }
+    fallback_count_.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+  }
+
+  /// Give back memory returned by allocate().
+  void
+  deallocate(void * pointer)
+  {
+    if (owns(pointer)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_blocks_.push_back(pointer);
+      return;
+    }
+    ::operator delete(pointer);
+  }
+
+  /// Return true if the pointer is one of the blocks of this pool.
+  bool
+  owns(const void * pointer) const
+  {
+    auto begin = reinterpret_cast<const char *>(storage_.get());
+    auto address = static_cast<const char *>(pointer);
+    return address >= begin && address < begin + block_size_ * block_count_;
+  }
+
+  size_t
+  get_block_size() const
+  {
+    return block_size_;
+  }
+
+  size_t
+  get_block_count() const
+  {
+    return block_count_;
+  }
+
+  /// Return the NUMA node the blocks are placed on, negative for the default placement.
+  int
+  get_numa_node() const
+  {
+    return numa_node_;
+  }
+
+  /// Return the number of blocks which are not in use.
+  size_t
+  get_free_block_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_blocks_.size();
+  }
+
+  /// Touch the free blocks, so that their first use doesn't fault.
+  /**
+   * The blocks are zeroed, the ones in use are left as they are.
+   * \sa rclcpp::RealtimeWarmUpRegistry
+   */
+  void
+  prefault()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (void * block : free_blocks_) {
+      std::memset(block, 0, block_size_);
+    }
+  }
+
+  /// Return the number of allocations which did not use a block of the pool.
+  size_t
+  get_fallback_count() const
+  {
+    return fallback_count_.load(std::memory_order_relaxed);
+  }
+
+private:
+  using Block = std::max_align_t;
+
+  struct StorageDeleter
+  {
+    void operator()(Block * storage) const
+    {
+      if (numa_size == 0) {
+        delete[] storage;
+      } else {
+        rclcpp::deallocate_on_numa_node(storage, numa_size);
+      }
+    }
+
+    // Size given to allocate_on_numa_node(), 0 if the storage was allocated with new[].
+    size_t numa_size;
+  };
+
+  using Storage = std::unique_ptr<Block[], StorageDeleter>;
+
+  static size_t
+  round_up_block_size(size_t block_size)
+  {
+    return (block_size + sizeof(Block) - 1) / sizeof(Block) * sizeof(Block);
+  }
+
+  void *
+  get_block(size_t index)
+  {
+    return reinterpret_cast<char *>(storage_.get()) + index * block_size_;
+  }
+
+  const size_t block_size_;
+  const size_t block_count_;
+  const int numa_node_;
+  Storage storage_;
+  std::vector<void *> free_blocks_;
+  mutable std::mutex mutex_;
+  std::atomic<size_t> fallback_count_;
+};
+
+/// Allocator taking its memory from a MessagePool.
+/**
+ * It can be used as the allocator of publishers and subscriptions, so that messages, and the
+ * control blocks of the shared pointers used for intra-process, come from preallocated memory.
+ * With a block size large enough for both, and enough blocks for the messages in flight, the
+ * storage of a message is recycled once all the subscriptions released it and publishing does
+ * not allocate once warmed up.
+ *
+ * All the allocators rebound from the same instance share its pool.
+ * A default constructed allocator has no pool and uses the global operator new.
+ */
+template<typename T>
+class MessagePoolAllocator
+{
+public:
+  using value_type = T;
+
+  template<typename U>
+  struct rebind
+  {
+    using other = MessagePoolAllocator<U>;
+  };
+
+  MessagePoolAllocator() = default;
+
+  explicit MessagePoolAllocator(MessagePool::SharedPtr pool)
+  : pool_(std::move(pool))
+  {}
+
+  template<typename U>
+  MessagePoolAllocator(const MessagePoolAllocator<U> & other)  // NOLINT(runtime/explicit)
+  : pool_(other.get_pool())
+  {}
+
+  T *
+  allocate(size_t n)
+  {
+    if (!pool_) {
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+    return static_cast<T *>(pool_->allocate(n * sizeof(T)));
+  }
+
+  void
+  deallocate(T * pointer, size_t n)
+  {
+    (void)n;
+    if (!pool_) {
+      ::operator delete(pointer);
+      return;
+    }
+    pool_->deallocate(pointer);
+  }
+
+  const MessagePool::SharedPtr &
+  get_pool() const
+  {
+    return pool_;
+  }
+
+private:
+  MessagePool::SharedPtr pool_;
+};
+
+template<typename T, typename U>
+bool
+operator==(const MessagePoolAllocator<T> & lhs, const MessagePoolAllocator<U> & rhs)
+{
+  return lhs.get_pool() == rhs.get_pool();
+}
+
+template<typename T, typename U>
+bool
+operator!=(const MessagePoolAllocator<T> & lhs, const MessagePoolAllocator<U> & rhs)
+{
+  return !(lhs == rhs);
+}
+
+}  // namespace allocator
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ALLOCATOR__MESSAGE_POOL_ALLOCATOR_HPP_
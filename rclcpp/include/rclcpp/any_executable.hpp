@@ -15,6 +15,7 @@
 #ifndef RCLCPP__ANY_EXECUTABLE_HPP_
 #define RCLCPP__ANY_EXECUTABLE_HPP_
 
+#include <functional>
 #include <memory>
 
 #include "rclcpp/callback_group.hpp"
@@ -46,6 +47,8 @@ struct AnyExecutable
   rclcpp::ServiceBase::SharedPtr service;
   rclcpp::ClientBase::SharedPtr client;
   rclcpp::Waitable::SharedPtr waitable;
+  /// Function scheduled with Executor::call_later().
+  std::function<void()> deferred_call;
   // These are used to keep the scope on the containing items
   rclcpp::callback_group::CallbackGroup::SharedPtr callback_group;
   rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base;
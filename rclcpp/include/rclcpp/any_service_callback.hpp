@@ -19,8 +19,11 @@
 #include <memory>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "rclcpp/function_traits.hpp"
+#include "rclcpp/service_responder.hpp"
 #include "rclcpp/visibility_control.hpp"
 #include "rmw/types.h"
 #include "tracetools/tracetools.h"
@@ -32,6 +35,11 @@ namespace rclcpp
 template<typename ServiceT>
 class AnyServiceCallback
 {
+public:
+  /// A request taken in a batch, with the header identifying its client.
+  using BatchRequest = std::pair<
+    std::shared_ptr<rmw_request_id_t>, std::shared_ptr<typename ServiceT::Request>>;
+
 private:
   using SharedPtrCallback = std::function<
     void (
@@ -44,13 +52,27 @@ private:
       const std::shared_ptr<typename ServiceT::Request>,
       std::shared_ptr<typename ServiceT::Response>
     )>;
+  using SharedPtrDeferredCallback = std::function<
+    void (
+      const std::shared_ptr<typename ServiceT::Request>,
+      std::shared_ptr<ServiceResponder<ServiceT>>
+    )>;
+
+  using SharedPtrBatchCallback = std::function<
+    void (
+      const std::vector<BatchRequest> &,
+      std::vector<std::shared_ptr<typename ServiceT::Response>> &
+    )>;
 
   SharedPtrCallback shared_ptr_callback_;
   SharedPtrWithRequestHeaderCallback shared_ptr_with_request_header_callback_;
+  SharedPtrDeferredCallback shared_ptr_deferred_callback_;
+  SharedPtrBatchCallback shared_ptr_batch_callback_;
 
 public:
   AnyServiceCallback()
-  : shared_ptr_callback_(nullptr), shared_ptr_with_request_header_callback_(nullptr)
+  : shared_ptr_callback_(nullptr), shared_ptr_with_request_header_callback_(nullptr),
+    shared_ptr_deferred_callback_(nullptr), shared_ptr_batch_callback_(nullptr)
   {}
 
   AnyServiceCallback(const AnyServiceCallback &) = default;
@@ -83,6 +105,48 @@ public:
     shared_ptr_with_request_header_callback_ = callback;
   }
 
+  /// Set a callback which sends the response later with the responder, see ServiceResponder.
+  template<
+    typename CallbackT,
+    typename std::enable_if<
+      rclcpp::function_traits::same_arguments<
+        CallbackT,
+        SharedPtrDeferredCallback
+      >::value
+    >::type * = nullptr
+  >
+  void set(CallbackT callback)
+  {
+    shared_ptr_deferred_callback_ = callback;
+  }
+
+  /// Set a callback which handles the requests received so far at once, see dispatch_batch().
+  template<
+    typename CallbackT,
+    typename std::enable_if<
+      rclcpp::function_traits::same_arguments<
+        CallbackT,
+        SharedPtrBatchCallback
+      >::value
+    >::type * = nullptr
+  >
+  void set(CallbackT callback)
+  {
+    shared_ptr_batch_callback_ = callback;
+  }
+
+  /// Return true if the callback responds with a ServiceResponder, see dispatch_deferred().
+  bool is_deferred() const
+  {
+    return shared_ptr_deferred_callback_ != nullptr;
+  }
+
+  /// Return true if the callback handles batches of requests, see dispatch_batch().
+  bool is_batched() const
+  {
+    return shared_ptr_batch_callback_ != nullptr;
+  }
+
   void dispatch(
     std::shared_ptr<rmw_request_id_t> request_header,
     std::shared_ptr<typename ServiceT::Request> request,
@@ -94,12 +158,41 @@ public:
       shared_ptr_callback_(request, response);
     } else if (shared_ptr_with_request_header_callback_ != nullptr) {
       shared_ptr_with_request_header_callback_(request_header, request, response);
+    } else if (shared_ptr_deferred_callback_ != nullptr) {
+      throw std::runtime_error("unexpected request with a response for a deferred callback");
+    } else if (shared_ptr_batch_callback_ != nullptr) {
+      throw std::runtime_error("unexpected single request for a batch callback");
     } else {
       throw std::runtime_error("unexpected request without any callback set");
     }
     TRACEPOINT(callback_end, (const void *)this);
   }
 
+  void dispatch_deferred(
+    std::shared_ptr<typename ServiceT::Request> request,
+    std::shared_ptr<ServiceResponder<ServiceT>> responder)
+  {
+    if (shared_ptr_deferred_callback_ == nullptr) {
+      throw std::runtime_error("unexpected deferred request without a deferred callback set");
+    }
+    TRACEPOINT(callback_start, (const void *)this, false);
+    shared_ptr_deferred_callback_(request, responder);
+    TRACEPOINT(callback_end, (const void *)this);
+  }
+
+  /// Call the batch callback, with one response for each request, in the same order.
+  void dispatch_batch(
+    const std::vector<BatchRequest> & requests,
+    std::vector<std::shared_ptr<typename ServiceT::Response>> & responses)
+  {
+    if (shared_ptr_batch_callback_ == nullptr) {
+      throw std::runtime_error("unexpected batch of requests without a batch callback set");
+    }
+    TRACEPOINT(callback_start, (const void *)this, false);
+    shared_ptr_batch_callback_(requests, responses);
+    TRACEPOINT(callback_end, (const void *)this);
+  }
+
   void register_callback_for_tracing()
   {
 #ifndef TRACETOOLS_DISABLED
@@ -113,6 +206,16 @@ public:
         rclcpp_callback_register,
         (const void *)this,
         get_symbol(shared_ptr_with_request_header_callback_));
+    } else if (shared_ptr_deferred_callback_) {
+      TRACEPOINT(
+        rclcpp_callback_register,
+        (const void *)this,
+        get_symbol(shared_ptr_deferred_callback_));
+    } else if (shared_ptr_batch_callback_) {
+      TRACEPOINT(
+        rclcpp_callback_register,
+        (const void *)this,
+        get_symbol(shared_ptr_batch_callback_));
     }
 #endif  // TRACETOOLS_DISABLED
   }
@@ -17,14 +17,18 @@
 
 #include <rmw/types.h>
 
+#include <cstddef>
 #include <functional>
 #include <memory>
 #include <stdexcept>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "rclcpp/allocator/allocator_common.hpp"
 #include "rclcpp/function_traits.hpp"
+#include "rclcpp/message_info.hpp"
+#include "rclcpp/subscription_loaned_message.hpp"
 #include "rclcpp/visibility_control.hpp"
 #include "tracetools/tracetools.h"
 #include "tracetools/utils.hpp"
@@ -50,25 +54,52 @@ class AnySubscriptionCallback
   using UniquePtrCallback = std::function<void (MessageUniquePtr)>;
   using UniquePtrWithInfoCallback =
     std::function<void (MessageUniquePtr, const rmw_message_info_t &)>;
-
-  SharedPtrCallback shared_ptr_callback_;
-  SharedPtrWithInfoCallback shared_ptr_with_info_callback_;
-  ConstSharedPtrCallback const_shared_ptr_callback_;
-  ConstSharedPtrWithInfoCallback const_shared_ptr_with_info_callback_;
-  UniquePtrCallback unique_ptr_callback_;
-  UniquePtrWithInfoCallback unique_ptr_with_info_callback_;
+  using ConstSharedPtrBatchCallback =
+    std::function<void (std::vector<std::shared_ptr<const MessageT>>)>;
+  using LoanedMessageCallback = std::function<void (SubscriptionLoanedMessage<MessageT>)>;
+  using LoanedMessageWithInfoCallback =
+    std::function<void (SubscriptionLoanedMessage<MessageT>, const rmw_message_info_t &)>;
+  using SharedPtrWithMessageInfoCallback =
+    std::function<void (const std::shared_ptr<MessageT>, const MessageInfo &)>;
+  using ConstSharedPtrWithMessageInfoCallback =
+    std::function<void (const std::shared_ptr<const MessageT>, const MessageInfo &)>;
+  using UniquePtrWithMessageInfoCallback =
+    std::function<void (MessageUniquePtr, const MessageInfo &)>;
+  using LoanedMessageWithMessageInfoCallback =
+    std::function<void (SubscriptionLoanedMessage<MessageT>, const MessageInfo &)>;
 
 public:
   explicit AnySubscriptionCallback(std::shared_ptr<Alloc> allocator)
-  : shared_ptr_callback_(nullptr), shared_ptr_with_info_callback_(nullptr),
-    const_shared_ptr_callback_(nullptr), const_shared_ptr_with_info_callback_(nullptr),
-    unique_ptr_callback_(nullptr), unique_ptr_with_info_callback_(nullptr)
+  : operations_(nullptr)
   {
     message_allocator_ = std::make_shared<MessageAlloc>(*allocator.get());
     allocator::set_allocator_for_deleter(&message_deleter_, message_allocator_.get());
   }
 
-  AnySubscriptionCallback(const AnySubscriptionCallback &) = default;
+  AnySubscriptionCallback(const AnySubscriptionCallback & other)
+  : operations_(nullptr),
+    message_allocator_(other.message_allocator_),
+    message_deleter_(other.message_deleter_)
+  {
+    copy_callback_from(other);
+  }
+
+  AnySubscriptionCallback &
+  operator=(const AnySubscriptionCallback & other)
+  {
+    if (this != &other) {
+      reset_callback();
+      copy_callback_from(other);
+      message_allocator_ = other.message_allocator_;
+      message_deleter_ = other.message_deleter_;
+    }
+    return *this;
+  }
+
+  ~AnySubscriptionCallback()
+  {
+    reset_callback();
+  }
 
   template<
     typename CallbackT,
@@ -81,7 +112,8 @@ public:
   >
   void set(CallbackT callback)
   {
-    shared_ptr_callback_ = callback;
+    set_callback<CallbackT, SharedPtrCallback, ArgumentKind::SharedPtr, false>(
+      std::move(callback));
   }
 
   template<
@@ -95,7 +127,8 @@ public:
   >
   void set(CallbackT callback)
   {
-    shared_ptr_with_info_callback_ = callback;
+    set_callback<CallbackT, SharedPtrWithInfoCallback, ArgumentKind::SharedPtr, true>(
+      std::move(callback));
   }
 
   template<
@@ -109,7 +142,8 @@ public:
   >
   void set(CallbackT callback)
   {
-    const_shared_ptr_callback_ = callback;
+    set_callback<CallbackT, ConstSharedPtrCallback, ArgumentKind::ConstSharedPtr, false>(
+      std::move(callback));
   }
 
   template<
@@ -123,7 +157,8 @@ public:
   >
   void set(CallbackT callback)
   {
-    const_shared_ptr_with_info_callback_ = callback;
+    set_callback<CallbackT, ConstSharedPtrWithInfoCallback, ArgumentKind::ConstSharedPtr, true>(
+      std::move(callback));
   }
 
   template<
@@ -137,7 +172,8 @@ public:
   >
   void set(CallbackT callback)
   {
-    unique_ptr_callback_ = callback;
+    set_callback<CallbackT, UniquePtrCallback, ArgumentKind::UniquePtr, false>(
+      std::move(callback));
   }
 
   template<
@@ -151,115 +187,629 @@ public:
   >
   void set(CallbackT callback)
   {
-    unique_ptr_with_info_callback_ = callback;
+    set_callback<CallbackT, UniquePtrWithInfoCallback, ArgumentKind::UniquePtr, true>(
+      std::move(callback));
+  }
+
+  /// Set a callback taking the messages by batches, see rclcpp::SubscriptionBatchingOptions.
+  template<
+    typename CallbackT,
+    typename std::enable_if<
+      rclcpp::function_traits::same_arguments<
+        CallbackT,
+        ConstSharedPtrBatchCallback
+      >::value
+    >::type * = nullptr
+  >
+  void set(CallbackT callback)
+  {
+    set_callback<CallbackT, ConstSharedPtrBatchCallback, ArgumentKind::ConstSharedPtrBatch, false>(
+      std::move(callback));
+  }
+
+  /// Set a callback taking the ownership of messages which may be loaned by the middleware.
+  template<
+    typename CallbackT,
+    typename std::enable_if<
+      rclcpp::function_traits::same_arguments<
+        CallbackT,
+        LoanedMessageCallback
+      >::value
+    >::type * = nullptr
+  >
+  void set(CallbackT callback)
+  {
+    set_callback<CallbackT, LoanedMessageCallback, ArgumentKind::LoanedMessage, false>(
+      std::move(callback));
+  }
+
+  template<
+    typename CallbackT,
+    typename std::enable_if<
+      rclcpp::function_traits::same_arguments<
+        CallbackT,
+        LoanedMessageWithInfoCallback
+      >::value
+    >::type * = nullptr
+  >
+  void set(CallbackT callback)
+  {
+    set_callback<CallbackT, LoanedMessageWithInfoCallback, ArgumentKind::LoanedMessage, true>(
+      std::move(callback));
+  }
+
+  /// Set a callback taking the message info with the source and receive timestamps.
+  template<
+    typename CallbackT,
+    typename std::enable_if<
+      rclcpp::function_traits::same_arguments<
+        CallbackT,
+        SharedPtrWithMessageInfoCallback
+      >::value
+    >::type * = nullptr
+  >
+  void set(CallbackT callback)
+  {
+    set_callback<CallbackT, SharedPtrWithMessageInfoCallback, ArgumentKind::SharedPtr, true>(
+      std::move(callback));
+  }
+
+  template<
+    typename CallbackT,
+    typename std::enable_if<
+      rclcpp::function_traits::same_arguments<
+        CallbackT,
+        ConstSharedPtrWithMessageInfoCallback
+      >::value
+    >::type * = nullptr
+  >
+  void set(CallbackT callback)
+  {
+    set_callback<
+      CallbackT, ConstSharedPtrWithMessageInfoCallback, ArgumentKind::ConstSharedPtr, true
+    >(std::move(callback));
+  }
+
+  template<
+    typename CallbackT,
+    typename std::enable_if<
+      rclcpp::function_traits::same_arguments<
+        CallbackT,
+        UniquePtrWithMessageInfoCallback
+      >::value
+    >::type * = nullptr
+  >
+  void set(CallbackT callback)
+  {
+    set_callback<CallbackT, UniquePtrWithMessageInfoCallback, ArgumentKind::UniquePtr, true>(
+      std::move(callback));
+  }
+
+  template<
+    typename CallbackT,
+    typename std::enable_if<
+      rclcpp::function_traits::same_arguments<
+        CallbackT,
+        LoanedMessageWithMessageInfoCallback
+      >::value
+    >::type * = nullptr
+  >
+  void set(CallbackT callback)
+  {
+    set_callback<
+      CallbackT, LoanedMessageWithMessageInfoCallback, ArgumentKind::LoanedMessage, true
+    >(std::move(callback));
   }
 
   void dispatch(
-    std::shared_ptr<MessageT> message, const rmw_message_info_t & message_info)
+    std::shared_ptr<MessageT> message, const MessageInfo & message_info)
   {
     TRACEPOINT(callback_start, (const void *)this, false);
-    if (shared_ptr_callback_) {
-      shared_ptr_callback_(message);
-    } else if (shared_ptr_with_info_callback_) {
-      shared_ptr_with_info_callback_(message, message_info);
-    } else if (const_shared_ptr_callback_) {
-      const_shared_ptr_callback_(message);
-    } else if (const_shared_ptr_with_info_callback_) {
-      const_shared_ptr_with_info_callback_(message, message_info);
-    } else if (unique_ptr_callback_) {
-      auto ptr = MessageAllocTraits::allocate(*message_allocator_.get(), 1);
-      MessageAllocTraits::construct(*message_allocator_.get(), ptr, *message);
-      unique_ptr_callback_(MessageUniquePtr(ptr, message_deleter_));
-    } else if (unique_ptr_with_info_callback_) {
-      auto ptr = MessageAllocTraits::allocate(*message_allocator_.get(), 1);
-      MessageAllocTraits::construct(*message_allocator_.get(), ptr, *message);
-      unique_ptr_with_info_callback_(MessageUniquePtr(ptr, message_deleter_), message_info);
-    } else {
-      throw std::runtime_error("unexpected message without any callback set");
-    }
+    get_operations().dispatch(*this, std::move(message), message_info);
     TRACEPOINT(callback_end, (const void *)this);
   }
 
   void dispatch_intra_process(
-    ConstMessageSharedPtr message, const rmw_message_info_t & message_info)
+    ConstMessageSharedPtr message, const MessageInfo & message_info)
   {
     TRACEPOINT(callback_start, (const void *)this, true);
-    if (const_shared_ptr_callback_) {
-      const_shared_ptr_callback_(message);
-    } else if (const_shared_ptr_with_info_callback_) {
-      const_shared_ptr_with_info_callback_(message, message_info);
-    } else {
-      if (
-        unique_ptr_callback_ || unique_ptr_with_info_callback_ ||
-        shared_ptr_callback_ || shared_ptr_with_info_callback_)
-      {
-        throw std::runtime_error(
-                "unexpected dispatch_intra_process const shared "
-                "message call with no const shared_ptr callback");
-      } else {
-        throw std::runtime_error("unexpected message without any callback set");
-      }
-    }
+    get_operations().dispatch_const_shared(*this, std::move(message), message_info);
     TRACEPOINT(callback_end, (const void *)this);
   }
 
   void dispatch_intra_process(
-    MessageUniquePtr message, const rmw_message_info_t & message_info)
+    MessageUniquePtr message, const MessageInfo & message_info)
   {
     TRACEPOINT(callback_start, (const void *)this, true);
-    if (shared_ptr_callback_) {
-      typename std::shared_ptr<MessageT> shared_message = std::move(message);
-      shared_ptr_callback_(shared_message);
-    } else if (shared_ptr_with_info_callback_) {
-      typename std::shared_ptr<MessageT> shared_message = std::move(message);
-      shared_ptr_with_info_callback_(shared_message, message_info);
-    } else if (unique_ptr_callback_) {
-      unique_ptr_callback_(std::move(message));
-    } else if (unique_ptr_with_info_callback_) {
-      unique_ptr_with_info_callback_(std::move(message), message_info);
-    } else if (const_shared_ptr_callback_ || const_shared_ptr_with_info_callback_) {
-      throw std::runtime_error(
-              "unexpected dispatch_intra_process unique message call"
-              " with const shared_ptr callback");
-    } else {
-      throw std::runtime_error("unexpected message without any callback set");
-    }
+    get_operations().dispatch_unique(*this, std::move(message), message_info);
+    TRACEPOINT(callback_end, (const void *)this);
+  }
+
+  /// Give a batch of messages to a callback taking a batch.
+  /**
+   * A callback taking a batch given a single message by dispatch() gets a batch of one.
+   * \throws std::runtime_error if the callback takes a single message.
+   */
+  void dispatch_batch(std::vector<ConstMessageSharedPtr> messages)
+  {
+    TRACEPOINT(callback_start, (const void *)this, false);
+    get_operations().dispatch_batch(*this, std::move(messages));
+    TRACEPOINT(callback_end, (const void *)this);
+  }
+
+  /// Give a message loaned by the middleware to a callback taking a SubscriptionLoanedMessage.
+  /**
+   * \throws std::runtime_error if the callback doesn't take a SubscriptionLoanedMessage.
+   */
+  void dispatch_loaned(
+    SubscriptionLoanedMessage<MessageT> message, const MessageInfo & message_info)
+  {
+    TRACEPOINT(callback_start, (const void *)this, false);
+    get_operations().dispatch_loaned(*this, std::move(message), message_info);
     TRACEPOINT(callback_end, (const void *)this);
   }
 
   bool use_take_shared_method() const
   {
-    return const_shared_ptr_callback_ || const_shared_ptr_with_info_callback_;
+    return operations_ && (operations_->argument_kind == ArgumentKind::ConstSharedPtr ||
+           operations_->argument_kind == ArgumentKind::ConstSharedPtrBatch);
+  }
+
+  /// Return true if the callback takes a batch of messages.
+  bool is_batch_callback() const
+  {
+    return operations_ && operations_->argument_kind == ArgumentKind::ConstSharedPtrBatch;
+  }
+
+  /// Return true if the callback takes a SubscriptionLoanedMessage.
+  bool is_loaned_message_callback() const
+  {
+    return operations_ && operations_->argument_kind == ArgumentKind::LoanedMessage;
   }
 
   void register_callback_for_tracing()
   {
 #ifndef TRACETOOLS_DISABLED
-    if (shared_ptr_callback_) {
-      TRACEPOINT(
-        rclcpp_callback_register,
-        (const void *)this,
-        get_symbol(shared_ptr_callback_));
-    } else if (shared_ptr_with_info_callback_) {
-      TRACEPOINT(
-        rclcpp_callback_register,
-        (const void *)this,
-        get_symbol(shared_ptr_with_info_callback_));
-    } else if (unique_ptr_callback_) {
-      TRACEPOINT(
-        rclcpp_callback_register,
-        (const void *)this,
-        get_symbol(unique_ptr_callback_));
-    } else if (unique_ptr_with_info_callback_) {
-      TRACEPOINT(
-        rclcpp_callback_register,
-        (const void *)this,
-        get_symbol(unique_ptr_with_info_callback_));
+    if (operations_) {
+      operations_->register_for_tracing(*this);
     }
 #endif  // TRACETOOLS_DISABLED
   }
 
 private:
+  /// How the callback takes the message.
+  enum class ArgumentKind
+  {
+    SharedPtr,
+    ConstSharedPtr,
+    UniquePtr,
+    ConstSharedPtrBatch,
+    LoanedMessage
+  };
+
+  template<ArgumentKind Kind>
+  using ArgumentTag = std::integral_constant<ArgumentKind, Kind>;
+
+  /// Operations on the stored callback, selected at compile time when the callback is set.
+  struct Operations
+  {
+    ArgumentKind argument_kind;
+    void (* dispatch)(
+      AnySubscriptionCallback &, std::shared_ptr<MessageT>, const MessageInfo &);
+    void (* dispatch_const_shared)(
+      AnySubscriptionCallback &, ConstMessageSharedPtr, const MessageInfo &);
+    void (* dispatch_unique)(
+      AnySubscriptionCallback &, MessageUniquePtr, const MessageInfo &);
+    void (* dispatch_batch)(AnySubscriptionCallback &, std::vector<ConstMessageSharedPtr>);
+    void (* dispatch_loaned)(
+      AnySubscriptionCallback &, SubscriptionLoanedMessage<MessageT>, const MessageInfo &);
+    void (* copy)(const AnySubscriptionCallback &, AnySubscriptionCallback &);
+    void (* destroy)(AnySubscriptionCallback &);
+    void (* register_for_tracing)(AnySubscriptionCallback &);
+  };
+
+  /// Callbacks up to this size are stored in the object, larger ones on the heap.
+  static constexpr size_t inline_callback_size = 4 * sizeof(void *);
+
+  using CallbackStorage =
+    typename std::aligned_storage<inline_callback_size, alignof(std::max_align_t)>::type;
+
+  template<typename CallbackT>
+  using is_stored_inline = std::integral_constant<bool,
+      sizeof(CallbackT) <= inline_callback_size &&
+      alignof(CallbackT) <= alignof(CallbackStorage)>;
+
+  template<typename CallbackT>
+  CallbackT &
+  get_callback()
+  {
+    return get_callback<CallbackT>(is_stored_inline<CallbackT>());
+  }
+
+  template<typename CallbackT>
+  const CallbackT &
+  get_callback() const
+  {
+    return const_cast<AnySubscriptionCallback *>(this)->get_callback<CallbackT>();
+  }
+
+  template<typename CallbackT>
+  CallbackT &
+  get_callback(std::true_type)
+  {
+    return *reinterpret_cast<CallbackT *>(&callback_storage_);
+  }
+
+  template<typename CallbackT>
+  CallbackT &
+  get_callback(std::false_type)
+  {
+    return **reinterpret_cast<CallbackT **>(&callback_storage_);
+  }
+
+  template<typename CallbackT>
+  void
+  construct_callback(const CallbackT & callback, std::true_type)
+  {
+    new (&callback_storage_) CallbackT(callback);
+  }
+
+  template<typename CallbackT>
+  void
+  construct_callback(const CallbackT & callback, std::false_type)
+  {
+    *reinterpret_cast<CallbackT **>(&callback_storage_) = new CallbackT(callback);
+  }
+
+  template<typename CallbackT>
+  void
+  destroy_callback(std::true_type)
+  {
+    get_callback<CallbackT>().~CallbackT();
+  }
+
+  template<typename CallbackT>
+  void
+  destroy_callback(std::false_type)
+  {
+    delete &get_callback<CallbackT>();
+  }
+
+  template<typename CallbackT, typename FunctionT, ArgumentKind Kind, bool WithInfo>
+  struct CallbackOperations
+  {
+    using WithInfoTag = std::integral_constant<bool, WithInfo>;
+
+    static void
+    dispatch(
+      AnySubscriptionCallback & self,
+      std::shared_ptr<MessageT> message,
+      const MessageInfo & message_info)
+    {
+      self.call(
+        self.get_callback<CallbackT>(), ArgumentTag<Kind>(), std::move(message), message_info,
+        WithInfoTag());
+    }
+
+    static void
+    dispatch_const_shared(
+      AnySubscriptionCallback & self,
+      ConstMessageSharedPtr message,
+      const MessageInfo & message_info)
+    {
+      self.call(
+        self.get_callback<CallbackT>(), ArgumentTag<Kind>(), std::move(message), message_info,
+        WithInfoTag());
+    }
+
+    static void
+    dispatch_unique(
+      AnySubscriptionCallback & self,
+      MessageUniquePtr message,
+      const MessageInfo & message_info)
+    {
+      self.call(
+        self.get_callback<CallbackT>(), ArgumentTag<Kind>(), std::move(message), message_info,
+        WithInfoTag());
+    }
+
+    static void
+    dispatch_batch(AnySubscriptionCallback & self, std::vector<ConstMessageSharedPtr> messages)
+    {
+      self.call(self.get_callback<CallbackT>(), ArgumentTag<Kind>(), std::move(messages));
+    }
+
+    static void
+    dispatch_loaned(
+      AnySubscriptionCallback & self,
+      SubscriptionLoanedMessage<MessageT> message,
+      const MessageInfo & message_info)
+    {
+      self.call(
+        self.get_callback<CallbackT>(), ArgumentTag<Kind>(), std::move(message), message_info,
+        WithInfoTag());
+    }
+
+    static void
+    copy(const AnySubscriptionCallback & from, AnySubscriptionCallback & to)
+    {
+      to.construct_callback(from.get_callback<CallbackT>(), is_stored_inline<CallbackT>());
+    }
+
+    static void
+    destroy(AnySubscriptionCallback & self)
+    {
+      self.destroy_callback<CallbackT>(is_stored_inline<CallbackT>());
+    }
+
+    static void
+    register_for_tracing(AnySubscriptionCallback & self)
+    {
+      (void)self;
+#ifndef TRACETOOLS_DISABLED
+      TRACEPOINT(
+        rclcpp_callback_register,
+        (const void *)&self,
+        get_symbol(FunctionT(self.get_callback<CallbackT>())));
+#endif  // TRACETOOLS_DISABLED
+    }
+
+    static const Operations *
+    get()
+    {
+      static const Operations operations = {
+        Kind, &dispatch, &dispatch_const_shared, &dispatch_unique, &dispatch_batch,
+        &dispatch_loaned, &copy, &destroy, &register_for_tracing
+      };
+      return &operations;
+    }
+  };
+
+  template<typename CallbackT, typename FunctionT, ArgumentKind Kind, bool WithInfo>
+  void
+  set_callback(CallbackT callback)
+  {
+    reset_callback();
+    construct_callback(callback, is_stored_inline<CallbackT>());
+    operations_ = CallbackOperations<CallbackT, FunctionT, Kind, WithInfo>::get();
+  }
+
+  void
+  copy_callback_from(const AnySubscriptionCallback & other)
+  {
+    if (other.operations_) {
+      other.operations_->copy(other, *this);
+      operations_ = other.operations_;
+    }
+  }
+
+  void
+  reset_callback()
+  {
+    if (operations_) {
+      operations_->destroy(*this);
+      operations_ = nullptr;
+    }
+  }
+
+  const Operations &
+  get_operations() const
+  {
+    if (!operations_) {
+      throw std::runtime_error("unexpected message without any callback set");
+    }
+    return *operations_;
+  }
+
+  template<typename CallbackT, typename ArgumentT>
+  static void
+  invoke(CallbackT & callback, ArgumentT && argument, const MessageInfo &, std::false_type)
+  {
+    callback(std::forward<ArgumentT>(argument));
+  }
+
+  template<typename CallbackT, typename ArgumentT>
+  static void
+  invoke(
+    CallbackT & callback, ArgumentT && argument, const MessageInfo & message_info,
+    std::true_type)
+  {
+    callback(std::forward<ArgumentT>(argument), message_info);
+  }
+
+  // Message taken from the middleware, to a callback taking a shared or const shared pointer
+  template<typename CallbackT, ArgumentKind Kind, typename WithInfoTag>
+  void
+  call(
+    CallbackT & callback, ArgumentTag<Kind>, std::shared_ptr<MessageT> message,
+    const MessageInfo & message_info, WithInfoTag with_info)
+  {
+    invoke(callback, message, message_info, with_info);
+  }
+
+  // Message taken from the middleware, to a callback taking a unique pointer
+  template<typename CallbackT, typename WithInfoTag>
+  void
+  call(
+    CallbackT & callback, ArgumentTag<ArgumentKind::UniquePtr>,
+    std::shared_ptr<MessageT> message, const MessageInfo & message_info,
+    WithInfoTag with_info)
+  {
+    auto ptr = MessageAllocTraits::allocate(*message_allocator_.get(), 1);
+    MessageAllocTraits::construct(*message_allocator_.get(), ptr, *message);
+    invoke(callback, MessageUniquePtr(ptr, message_deleter_), message_info, with_info);
+  }
+
+  // Intra-process const shared pointer, to a callback taking a const shared pointer
+  template<typename CallbackT, typename WithInfoTag>
+  void
+  call(
+    CallbackT & callback, ArgumentTag<ArgumentKind::ConstSharedPtr>,
+    ConstMessageSharedPtr message, const MessageInfo & message_info,
+    WithInfoTag with_info)
+  {
+    invoke(callback, message, message_info, with_info);
+  }
+
+  // Intra-process const shared pointer, to a callback taking ownership
+  template<typename CallbackT, ArgumentKind Kind, typename WithInfoTag>
+  void
+  call(
+    CallbackT &, ArgumentTag<Kind>, ConstMessageSharedPtr, const MessageInfo &,
+    WithInfoTag)
+  {
+    throw std::runtime_error(
+            "unexpected dispatch_intra_process const shared "
+            "message call with no const shared_ptr callback");
+  }
+
+  // Intra-process unique pointer, to a callback taking a shared pointer
+  template<typename CallbackT, typename WithInfoTag>
+  void
+  call(
+    CallbackT & callback, ArgumentTag<ArgumentKind::SharedPtr>, MessageUniquePtr message,
+    const MessageInfo & message_info, WithInfoTag with_info)
+  {
+    typename std::shared_ptr<MessageT> shared_message = std::move(message);
+    invoke(callback, shared_message, message_info, with_info);
+  }
+
+  // Intra-process unique pointer, to a callback taking a unique pointer
+  template<typename CallbackT, typename WithInfoTag>
+  void
+  call(
+    CallbackT & callback, ArgumentTag<ArgumentKind::UniquePtr>, MessageUniquePtr message,
+    const MessageInfo & message_info, WithInfoTag with_info)
+  {
+    invoke(callback, std::move(message), message_info, with_info);
+  }
+
+  // Intra-process unique pointer, to a callback taking a const shared pointer
+  template<typename CallbackT, typename WithInfoTag>
+  void
+  call(
+    CallbackT &, ArgumentTag<ArgumentKind::ConstSharedPtr>, MessageUniquePtr,
+    const MessageInfo &, WithInfoTag)
+  {
+    throw std::runtime_error(
+            "unexpected dispatch_intra_process unique message call"
+            " with const shared_ptr callback");
+  }
+
+  // Message taken from the middleware, to a callback taking a batch
+  template<typename CallbackT, typename WithInfoTag>
+  void
+  call(
+    CallbackT & callback, ArgumentTag<ArgumentKind::ConstSharedPtrBatch>,
+    std::shared_ptr<MessageT> message, const MessageInfo &, WithInfoTag)
+  {
+    callback(std::vector<ConstMessageSharedPtr>{std::move(message)});
+  }
+
+  // Intra-process const shared pointer, to a callback taking a batch
+  template<typename CallbackT, typename WithInfoTag>
+  void
+  call(
+    CallbackT & callback, ArgumentTag<ArgumentKind::ConstSharedPtrBatch>,
+    ConstMessageSharedPtr message, const MessageInfo &, WithInfoTag)
+  {
+    callback(std::vector<ConstMessageSharedPtr>{std::move(message)});
+  }
+
+  // Intra-process unique pointer, to a callback taking a batch
+  template<typename CallbackT, typename WithInfoTag>
+  void
+  call(
+    CallbackT & callback, ArgumentTag<ArgumentKind::ConstSharedPtrBatch>,
+    MessageUniquePtr message, const MessageInfo &, WithInfoTag)
+  {
+    callback(std::vector<ConstMessageSharedPtr>{ConstMessageSharedPtr(std::move(message))});
+  }
+
+  // Batch of messages, to a callback taking a batch
+  template<typename CallbackT>
+  void
+  call(
+    CallbackT & callback, ArgumentTag<ArgumentKind::ConstSharedPtrBatch>,
+    std::vector<ConstMessageSharedPtr> messages)
+  {
+    callback(std::move(messages));
+  }
+
+  // Batch of messages, to a callback taking a single message
+  template<typename CallbackT, ArgumentKind Kind>
+  void
+  call(CallbackT &, ArgumentTag<Kind>, std::vector<ConstMessageSharedPtr>)
+  {
+    throw std::runtime_error("unexpected batch of messages with no batch callback");
+  }
+
+  // Message taken from the middleware, to a callback taking a SubscriptionLoanedMessage
+  template<typename CallbackT, typename WithInfoTag>
+  void
+  call(
+    CallbackT & callback, ArgumentTag<ArgumentKind::LoanedMessage>,
+    std::shared_ptr<MessageT> message, const MessageInfo & message_info,
+    WithInfoTag with_info)
+  {
+    auto ptr = MessageAllocTraits::allocate(*message_allocator_.get(), 1);
+    MessageAllocTraits::construct(*message_allocator_.get(), ptr, *message);
+    invoke(
+      callback, SubscriptionLoanedMessage<MessageT>(MessageUniquePtr(ptr, message_deleter_)),
+      message_info, with_info);
+  }
+
+  // Intra-process const shared pointer, to a callback taking a SubscriptionLoanedMessage
+  template<typename CallbackT, typename WithInfoTag>
+  void
+  call(
+    CallbackT & callback, ArgumentTag<ArgumentKind::LoanedMessage>,
+    ConstMessageSharedPtr message, const MessageInfo & message_info,
+    WithInfoTag with_info)
+  {
+    auto ptr = MessageAllocTraits::allocate(*message_allocator_.get(), 1);
+    MessageAllocTraits::construct(*message_allocator_.get(), ptr, *message);
+    invoke(
+      callback, SubscriptionLoanedMessage<MessageT>(MessageUniquePtr(ptr, message_deleter_)),
+      message_info, with_info);
+  }
+
+  // Intra-process unique pointer, to a callback taking a SubscriptionLoanedMessage
+  template<typename CallbackT, typename WithInfoTag>
+  void
+  call(
+    CallbackT & callback, ArgumentTag<ArgumentKind::LoanedMessage>, MessageUniquePtr message,
+    const MessageInfo & message_info, WithInfoTag with_info)
+  {
+    invoke(
+      callback, SubscriptionLoanedMessage<MessageT>(std::move(message)), message_info, with_info);
+  }
+
+  // Loaned message, to a callback taking a SubscriptionLoanedMessage
+  template<typename CallbackT, typename WithInfoTag>
+  void
+  call(
+    CallbackT & callback, ArgumentTag<ArgumentKind::LoanedMessage>,
+    SubscriptionLoanedMessage<MessageT> message, const MessageInfo & message_info,
+    WithInfoTag with_info)
+  {
+    invoke(callback, std::move(message), message_info, with_info);
+  }
+
+  // Loaned message, to a callback not taking a SubscriptionLoanedMessage
+  template<typename CallbackT, ArgumentKind Kind, typename WithInfoTag>
+  void
+  call(
+    CallbackT &, ArgumentTag<Kind>, SubscriptionLoanedMessage<MessageT>,
+    const MessageInfo &, WithInfoTag)
+  {
+    throw std::runtime_error(
+            "unexpected loaned message with no SubscriptionLoanedMessage callback");
+  }
+
+  CallbackStorage callback_storage_;
+  const Operations * operations_;
+
   std::shared_ptr<MessageAlloc> message_allocator_;
   MessageDeleter message_deleter_;
 };
@@ -0,0 +1,73 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ASYNC_PUBLISH_OPTIONS_HPP_
+#define RCLCPP__ASYNC_PUBLISH_OPTIONS_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace rclcpp
+{
+
+/// What publish() does when the queue of an asynchronous publisher is full.
+enum class AsyncPublishOverflowPolicy
+{
+  /// Drop the message being published.
+  DropNewest,
+  /// Drop the oldest queued message to make room for the message being published.
+  DropOldest
+};
+
+/// Configuration of the asynchronous publishing, used in PublisherOptions.
+/**
+ * When enabled, publish() queues the messages for the inter-process subscriptions instead of
+ * calling rcl_publish(), and a thread of the context takes care of serializing and writing
+ * them, so this latency isn't added to the publishing thread.
+ * The intra-process subscriptions still get the messages in publish().
+ *
+ * Serialized and loaned messages are published synchronously.
+ */
+struct AsyncPublishOptions
+{
+  /// If true, the messages are published asynchronously.
+  bool enabled = false;
+  /// Maximum number of queued messages, rounded up to the next power of two.
+  size_t queue_depth = 64;
+  AsyncPublishOverflowPolicy overflow_policy = AsyncPublishOverflowPolicy::DropNewest;
+};
+
+/// Statistics of an asynchronous publisher.
+struct AsyncPublishStatistics
+{
+  /// Number of messages currently queued.
+  size_t queue_depth = 0;
+  /// Largest number of messages which were queued at once.
+  size_t max_queue_depth = 0;
+  /// Number of messages written to the middleware.
+  uint64_t published_count = 0;
+  /// Number of messages dropped because the queue was full.
+  uint64_t dropped_count = 0;
+  /// Time between the last message being queued and rcl_publish() returning for it.
+  std::chrono::nanoseconds last_latency {0};
+  /// Largest time between a message being queued and rcl_publish() returning for it.
+  std::chrono::nanoseconds max_latency {0};
+  /// Sum of the latencies of all the published messages.
+  std::chrono::nanoseconds total_latency {0};
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ASYNC_PUBLISH_OPTIONS_HPP_
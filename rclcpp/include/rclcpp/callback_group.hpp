@@ -16,6 +16,8 @@
 #define RCLCPP__CALLBACK_GROUP_HPP_
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -40,6 +42,11 @@ class NodeTopics;
 class NodeWaitables;
 }  // namespace node_interfaces
 
+namespace executor
+{
+class Executor;
+}  // namespace executor
+
 namespace callback_group
 {
 
@@ -62,6 +69,13 @@ public:
   RCLCPP_PUBLIC
   explicit CallbackGroup(CallbackGroupType group_type);
 
+  template<typename Function>
+  rclcpp::PublisherBase::SharedPtr
+  find_publisher_ptrs_if(Function func) const
+  {
+    return _find_ptrs_if_impl<rclcpp::PublisherBase, Function>(func, publisher_ptrs_);
+  }
+
   template<typename Function>
   rclcpp::SubscriptionBase::SharedPtr
   find_subscription_ptrs_if(Function func) const
@@ -105,6 +119,52 @@ public:
   const CallbackGroupType &
   type() const;
 
+  /// Set the scheduling priority of the callbacks in this group.
+  /**
+   * Only executors which schedule by priority, like PriorityExecutor, use it.
+   * Higher values are executed first, the default is 0.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_priority(int priority);
+
+  RCLCPP_PUBLIC
+  int
+  get_priority() const;
+
+  /// Assign the group to one of the executors its node was added to, nullptr for all of them.
+  /**
+   * Only the assigned executor waits on the entities of the group, see CallbackGroupBalancer.
+   * The executors see the change the next time they collect the entities, e.g. once the notify
+   * guard condition of the node was triggered.
+   */
+  RCLCPP_PUBLIC
+  void
+  assign_to_executor(const rclcpp::executor::Executor * executor);
+
+  RCLCPP_PUBLIC
+  const rclcpp::executor::Executor *
+  get_assigned_executor() const;
+
+  /// Return true if the group is assigned to the executor, or to none.
+  RCLCPP_PUBLIC
+  bool
+  is_assigned_to(const rclcpp::executor::Executor * executor) const;
+
+  /// Add to the CPU time spent executing the callbacks of the group.
+  RCLCPP_PUBLIC
+  void
+  add_cpu_time(std::chrono::nanoseconds cpu_time);
+
+  /// Return the CPU time spent executing the callbacks of the group so far.
+  /**
+   * Only counted by the executors measuring it, see
+   * Executor::set_callback_group_cpu_time_measurement().
+   */
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  get_cpu_time() const;
+
 protected:
   RCLCPP_DISABLE_COPY(CallbackGroup)
 
@@ -139,12 +199,16 @@ protected:
   CallbackGroupType type_;
   // Mutex to protect the subsequent vectors of pointers.
   mutable std::mutex mutex_;
+  std::vector<rclcpp::PublisherBase::WeakPtr> publisher_ptrs_;
   std::vector<rclcpp::SubscriptionBase::WeakPtr> subscription_ptrs_;
   std::vector<rclcpp::TimerBase::WeakPtr> timer_ptrs_;
   std::vector<rclcpp::ServiceBase::WeakPtr> service_ptrs_;
   std::vector<rclcpp::ClientBase::WeakPtr> client_ptrs_;
   std::vector<rclcpp::Waitable::WeakPtr> waitable_ptrs_;
   std::atomic_bool can_be_taken_from_;
+  std::atomic_int priority_;
+  std::atomic<const rclcpp::executor::Executor *> assigned_executor_;
+  std::atomic<int64_t> cpu_time_ns_;
 
 private:
   template<typename TypeT, typename Function>
@@ -15,22 +15,36 @@
 #ifndef RCLCPP__CLIENT_HPP_
 #define RCLCPP__CLIENT_HPP_
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
 #include <future>
-#include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
-#include <tuple>
+#include <typeinfo>
 #include <utility>
+#include <vector>
 
 #include "rcl/client.h"
 #include "rcl/error_handling.h"
 #include "rcl/wait.h"
 
+#include "rclcpp/allocator/message_pool_allocator.hpp"
+#include "rclcpp/detail/pending_request_table.hpp"
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/experimental/client_intra_process.hpp"
+#include "rclcpp/experimental/intra_process_service_manager.hpp"
 #include "rclcpp/function_traits.hpp"
+#include "rclcpp/future_waiter.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/memory_usage.hpp"
 #include "rclcpp/node_interfaces/node_graph_interface.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/tracepoints.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/utilities.hpp"
 #include "rclcpp/expand_topic_or_service_name.hpp"
@@ -49,7 +63,7 @@ namespace node_interfaces
 class NodeBaseInterface;
 }  // namespace node_interfaces
 
-class ClientBase
+class ClientBase : public std::enable_shared_from_this<ClientBase>
 {
 public:
   RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(ClientBase)
@@ -93,9 +107,71 @@ public:
   virtual void handle_response(
     std::shared_ptr<rmw_request_id_t> request_header, std::shared_ptr<void> response) = 0;
 
+  /// Remove the pending requests whose timeout expired, called by the timeout timer.
+  virtual void expire_pending_requests() = 0;
+
+  /// Return the timer expiring the requests which timed out, created on the first call.
+  /**
+   * It is added to the callback group of the client when the client is added to a node, so the
+   * timeouts are enforced by the executor spinning the client.
+   * It is canceled while no pending request has a timeout.
+   */
+  RCLCPP_PUBLIC
+  rclcpp::TimerBase::SharedPtr
+  get_timeout_timer();
+
+  /// Return the bytes used by the client, see rclcpp::MemoryUsage.
+  RCLCPP_PUBLIC
+  virtual
+  rclcpp::MemoryUsage
+  get_memory_usage() const;
+
+  /// Give the requests to the services of the context directly, see IntraProcessServiceManager.
+  /**
+   * Called when the client is added to a node using intra-process communication.
+   * The responses are then handled by the waitable returned by get_intra_process_waitable(),
+   * which must be added to the callback group of the client.
+   *
+   * \throws std::runtime_error if the guard condition of the waitable can't be initialized.
+   */
+  RCLCPP_PUBLIC
+  void
+  setup_intra_process();
+
+  /// Return the waitable handling the intra-process responses, nullptr if there is none.
+  RCLCPP_PUBLIC
+  rclcpp::Waitable::SharedPtr
+  get_intra_process_waitable() const;
+
 protected:
   RCLCPP_DISABLE_COPY(ClientBase)
 
+  /// Give a request to a service of the context, if there is one with the type of the client.
+  /**
+   * \param[in] service_type The type of the service, e.g. typeid(ServiceT).
+   * \param[in] request The request, shared with the service.
+   * \param[out] sequence_number The sequence number of the request, negative so that it is
+   *   distinct from the sequence numbers of the middleware.
+   * \return false if the request must be sent through the middleware.
+   */
+  RCLCPP_PUBLIC
+  bool
+  send_intra_process_request(
+    const std::type_info & service_type,
+    std::shared_ptr<void> request,
+    int64_t & sequence_number);
+
+  /// Make the timeout timer fire at a deadline, or cancel it for time_point::max().
+  /**
+   * The executors in spin_until_future_complete() are woken up to wait for the new deadline.
+   *
+   * \param[in] deadline The deadline.
+   * \param[in] earlier_only True to keep the timer unchanged if it fires before the deadline.
+   */
+  RCLCPP_PUBLIC
+  void
+  update_timeout_timer(std::chrono::steady_clock::time_point deadline, bool earlier_only);
+
   RCLCPP_PUBLIC
   bool
   wait_for_service_nanoseconds(std::chrono::nanoseconds timeout);
@@ -113,6 +189,20 @@ protected:
   std::shared_ptr<rclcpp::Context> context_;
 
   std::shared_ptr<rcl_client_t> client_handle_;
+
+private:
+  void
+  arm_timeout_timer();
+
+  std::mutex timeout_timer_mutex_;
+  rclcpp::TimerBase::SharedPtr timeout_timer_;
+  std::chrono::steady_clock::time_point timeout_deadline_ =
+    std::chrono::steady_clock::time_point::max();
+
+  std::weak_ptr<rclcpp::experimental::IntraProcessServiceManager> intra_process_manager_;
+  rclcpp::experimental::ClientIntraProcess::SharedPtr intra_process_client_;
+  uint64_t intra_process_client_id_ = 0;
+  std::atomic<int64_t> next_intra_process_sequence_number_{-1};
 };
 
 template<typename ServiceT>
@@ -133,6 +223,8 @@ public:
 
   using CallbackType = std::function<void (SharedFuture)>;
   using CallbackWithRequestType = std::function<void (SharedFutureWithRequest)>;
+  /// Callback of a request sent without a future, see async_send_request().
+  using ResponseCallback = std::function<void (SharedResponse)>;
 
   RCLCPP_SMART_PTR_DEFINITIONS(Client)
 
@@ -146,21 +238,23 @@ public:
     using rosidl_typesupport_cpp::get_service_type_support_handle;
     auto service_type_support_handle =
       get_service_type_support_handle<ServiceT>();
+    // A shared rcl node has none of the names and arguments of this node.
+    const std::string rcl_service_name = node_base->shares_rcl_node() ?
+      node_base->resolve_topic_or_service_name(service_name, true) : service_name;
     rcl_ret_t ret = rcl_client_init(
       this->get_client_handle().get(),
       this->get_rcl_node_handle(),
       service_type_support_handle,
-      service_name.c_str(),
+      rcl_service_name.c_str(),
       &client_options);
     if (ret != RCL_RET_OK) {
       if (ret == RCL_RET_SERVICE_NAME_INVALID) {
-        auto rcl_node_handle = this->get_rcl_node_handle();
         // this will throw on any validation problem
         rcl_reset_error();
         expand_topic_or_service_name(
-          service_name,
-          rcl_node_get_name(rcl_node_handle),
-          rcl_node_get_namespace(rcl_node_handle),
+          rcl_service_name,
+          node_base->get_name(),
+          node_base->get_namespace(),
           true);
       }
       rclcpp::exceptions::throw_from_rcl_error(ret, "could not create client");
@@ -174,7 +268,8 @@ public:
   std::shared_ptr<void>
   create_response() override
   {
-    return std::shared_ptr<void>(new typename ServiceT::Response());
+    rclcpp::allocator::MessagePoolAllocator<char> allocator(std::atomic_load(&response_pool_));
+    return std::allocate_shared<typename ServiceT::Response>(allocator);
   }
 
   std::shared_ptr<rmw_request_id_t>
@@ -182,7 +277,8 @@ public:
   {
     // TODO(wjwwood): This should probably use rmw_request_id's allocator.
     //                (since it is a C type)
-    return std::shared_ptr<rmw_request_id_t>(new rmw_request_id_t);
+    rclcpp::allocator::MessagePoolAllocator<char> allocator(std::atomic_load(&response_pool_));
+    return std::allocate_shared<rmw_request_id_t>(allocator);
   }
 
   void
@@ -193,23 +289,63 @@ public:
     std::unique_lock<std::mutex> lock(pending_requests_mutex_);
     auto typed_response = std::static_pointer_cast<typename ServiceT::Response>(response);
     int64_t sequence_number = request_header->sequence_number;
+    PendingRequest pending_request;
     // TODO(esteve) this should throw instead since it is not expected to happen in the first place
-    if (this->pending_requests_.count(sequence_number) == 0) {
+    if (!this->pending_requests_.take(sequence_number, pending_request)) {
       RCUTILS_LOG_ERROR_NAMED(
         "rclcpp",
         "Received invalid sequence number. Ignoring...");
       return;
     }
-    auto tuple = this->pending_requests_[sequence_number];
-    auto call_promise = std::get<0>(tuple);
-    auto callback = std::get<1>(tuple);
-    auto future = std::get<2>(tuple);
-    this->pending_requests_.erase(sequence_number);
     // Unlock here to allow the service to be called recursively from one of its callbacks.
     lock.unlock();
 
-    call_promise->set_value(typed_response);
-    callback(future);
+    if (pending_request.promise) {
+      pending_request.promise->set_value(typed_response);
+      rclcpp::executor::notify_future_waiters();
+      pending_request.callback(pending_request.future);
+    } else {
+      pending_request.response_callback(typed_response);
+    }
+    // The callback may complete other futures, e.g. the one of a request with its response.
+    rclcpp::executor::notify_future_waiters();
+  }
+
+  void
+  expire_pending_requests() override
+  {
+    std::vector<PendingRequest> expired;
+    {
+      std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+      auto now = std::chrono::steady_clock::now();
+      auto next_deadline = std::chrono::steady_clock::time_point::max();
+      pending_requests_.take_if(
+        [now, &next_deadline](const PendingRequest & pending_request) {
+          if (pending_request.deadline <= now) {
+            return true;
+          }
+          next_deadline = std::min(next_deadline, pending_request.deadline);
+          return false;
+        },
+        [&expired](PendingRequest && pending_request) {
+          expired.push_back(std::move(pending_request));
+        });
+      expired_requests_ += expired.size();
+      update_timeout_timer(next_deadline, false);
+    }
+
+    // The requests sent with a response callback only are dropped.
+    for (auto & pending_request : expired) {
+      if (pending_request.promise) {
+        pending_request.promise->set_exception(
+          std::make_exception_ptr(rclcpp::exceptions::RequestTimeoutError()));
+        rclcpp::executor::notify_future_waiters();
+        pending_request.callback(pending_request.future);
+      }
+    }
+    if (!expired.empty()) {
+      rclcpp::executor::notify_future_waiters();
+    }
   }
 
   SharedFuture
@@ -218,6 +354,18 @@ public:
     return async_send_request(request, [](SharedFuture) {});
   }
 
+  /// Send a request, whose future is completed with the response.
+  /**
+   * The callback is called with the future once it is completed.
+   * If no response arrives within `timeout`, the request is removed, and the future is
+   * completed with a rclcpp::exceptions::RequestTimeoutError, which its get() throws.
+   *
+   * \param[in] request The request.
+   * \param[in] cb The callback, called with the future.
+   * \param[in] timeout The time to wait for the response, negative to wait forever.
+   * \return the future of the response.
+   * \throws anything rclcpp::exceptions::throw_from_rcl_error can throw.
+   */
   template<
     typename CallbackT,
     typename std::enable_if<
@@ -228,22 +376,64 @@ public:
     >::type * = nullptr
   >
   SharedFuture
-  async_send_request(SharedRequest request, CallbackT && cb)
+  async_send_request(
+    SharedRequest request, CallbackT && cb,
+    std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1))
   {
     std::lock_guard<std::mutex> lock(pending_requests_mutex_);
     int64_t sequence_number;
-    rcl_ret_t ret = rcl_send_request(get_client_handle().get(), request.get(), &sequence_number);
-    if (RCL_RET_OK != ret) {
-      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send request");
-    }
+    send_request(request, sequence_number);
 
-    SharedPromise call_promise = std::make_shared<Promise>();
+    // The promise, its shared state and its result come from the pool, if any.
+    rclcpp::allocator::MessagePoolAllocator<char> allocator(promise_pool_);
+    SharedPromise call_promise = std::allocate_shared<Promise>(
+      allocator, std::allocator_arg, allocator);
     SharedFuture f(call_promise->get_future());
-    pending_requests_[sequence_number] =
-      std::make_tuple(call_promise, std::forward<CallbackType>(cb), f);
+    PendingRequest & pending_request = pending_requests_.insert(sequence_number);
+    pending_request.promise = std::move(call_promise);
+    pending_request.callback = std::forward<CallbackT>(cb);
+    pending_request.future = f;
+    set_request_deadline(pending_request, timeout);
     return f;
   }
 
+  /// Send a request whose response is only given to a callback, without a future.
+  /**
+   * No promise and no future are created, so with enough pending requests reserved, see
+   * reserve_pending_requests(), sending the request doesn't allocate in rclcpp.
+   * The callback is called by the executor spinning the node of the client.
+   *
+   * If the request times out, it is dropped without calling the callback.
+   *
+   * \param[in] request The request.
+   * \param[in] cb The callback, called with the response.
+   * \param[in] timeout The time to wait for the response, negative to wait forever.
+   * \return the sequence number of the request, see remove_pending_request().
+   * \throws anything rclcpp::exceptions::throw_from_rcl_error can throw.
+   */
+  template<
+    typename CallbackT,
+    typename std::enable_if<
+      rclcpp::function_traits::same_arguments<
+        CallbackT,
+        ResponseCallback
+      >::value
+    >::type * = nullptr
+  >
+  int64_t
+  async_send_request(
+    SharedRequest request, CallbackT && cb,
+    std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1))
+  {
+    std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+    int64_t sequence_number;
+    send_request(request, sequence_number);
+    PendingRequest & pending_request = pending_requests_.insert(sequence_number);
+    pending_request.response_callback = std::forward<CallbackT>(cb);
+    set_request_deadline(pending_request, timeout);
+    return sequence_number;
+  }
+
   template<
     typename CallbackT,
     typename std::enable_if<
@@ -254,27 +444,151 @@ public:
     >::type * = nullptr
   >
   SharedFutureWithRequest
-  async_send_request(SharedRequest request, CallbackT && cb)
+  async_send_request(
+    SharedRequest request, CallbackT && cb,
+    std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1))
   {
     SharedPromiseWithRequest promise = std::make_shared<PromiseWithRequest>();
     SharedFutureWithRequest future_with_request(promise->get_future());
 
-    auto wrapping_cb = [future_with_request, promise, request, &cb](SharedFuture future) {
-        auto response = future.get();
-        promise->set_value(std::make_pair(request, response));
+    auto wrapping_cb = [future_with_request, promise, request, cb = std::forward<CallbackT>(cb)](
+      SharedFuture future) {
+        try {
+          auto response = future.get();
+          promise->set_value(std::make_pair(request, response));
+        } catch (const rclcpp::exceptions::RequestTimeoutError &) {
+          promise->set_exception(std::current_exception());
+        }
         cb(future_with_request);
       };
 
-    async_send_request(request, wrapping_cb);
+    async_send_request(request, wrapping_cb, timeout);
 
     return future_with_request;
   }
 
+  /// Make room for a number of pending requests, so that sending them doesn't allocate.
+  /**
+   * The table of the pending requests is grown if needed, and the promises of the requests sent
+   * with a future are then allocated from a pool of blocks preallocated for `capacity`
+   * requests; requests beyond it still work, allocating as usual.
+   * The responses and their headers, taken by the executor, are allocated from another pool,
+   * and recycled once the last shared pointer to the response is released.
+   *
+   * \param[in] capacity The number of requests expected to be pending at the same time.
+   */
+  void
+  reserve_pending_requests(size_t capacity)
+  {
+    std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+    pending_requests_.reserve(capacity);
+    if (capacity > 0) {
+      // The control block of the promise, its shared state and its result.
+      promise_pool_ = std::make_shared<rclcpp::allocator::MessagePool>(128, 3 * capacity);
+      // Room for the control block of the shared pointer too, which holds a copy of the allocator.
+      size_t block_size =
+        std::max(sizeof(typename ServiceT::Response), sizeof(rmw_request_id_t)) + 64;
+      std::atomic_store(
+        &response_pool_,
+        std::make_shared<rclcpp::allocator::MessagePool>(block_size, 2 * capacity));
+    }
+  }
+
+  /// Forget a pending request, e.g. when its response is not needed anymore.
+  /**
+   * The future of the request, if any, is then never completed.
+   *
+   * \return false if there was no such pending request.
+   */
+  bool
+  remove_pending_request(int64_t sequence_number)
+  {
+    std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+    return pending_requests_.erase(sequence_number);
+  }
+
+  /// Return the number of requests waiting for a response.
+  size_t
+  get_number_of_pending_requests()
+  {
+    std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+    return pending_requests_.size();
+  }
+
+  /// Return the number of requests which timed out since the client was created.
+  size_t
+  get_number_of_expired_requests()
+  {
+    std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+    return expired_requests_;
+  }
+
+  rclcpp::MemoryUsage
+  get_memory_usage() const override
+  {
+    rclcpp::MemoryUsage usage = ClientBase::get_memory_usage();
+    usage.entity_bytes = sizeof(*this);
+    std::lock_guard<std::mutex> lock(pending_requests_mutex_);
+    usage.pending_request_bytes = pending_requests_.memory_usage();
+    if (promise_pool_) {
+      usage.pending_request_bytes +=
+        promise_pool_->get_block_size() * promise_pool_->get_block_count();
+    }
+    auto response_pool = std::atomic_load(&response_pool_);
+    if (response_pool) {
+      usage.message_pool_bytes = response_pool->get_block_size() * response_pool->get_block_count();
+    }
+    return usage;
+  }
+
 private:
   RCLCPP_DISABLE_COPY(Client)
 
-  std::map<int64_t, std::tuple<SharedPromise, CallbackType, SharedFuture>> pending_requests_;
-  std::mutex pending_requests_mutex_;
+  /// A request waiting for a response, either with a promise or with a response callback.
+  struct PendingRequest
+  {
+    SharedPromise promise;
+    CallbackType callback;
+    SharedFuture future;
+    ResponseCallback response_callback;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+  };
+
+  /// Send a request, to a service of the context if there is one, see send_intra_process_request().
+  /**
+   * Called with the pending requests locked, so the response can't be handled before the
+   * pending request is inserted.
+   */
+  void
+  send_request(const SharedRequest & request, int64_t & sequence_number)
+  {
+    if (send_intra_process_request(typeid(ServiceT), request, sequence_number)) {
+      return;
+    }
+    rcl_ret_t ret = rcl_send_request(get_client_handle().get(), request.get(), &sequence_number);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to send request");
+    }
+    RCLCPP_TRACEPOINT(SendRequest, get_client_handle().get(), &sequence_number);
+  }
+
+  /// Give a pending request the deadline of its timeout, negative for none.
+  void
+  set_request_deadline(PendingRequest & pending_request, std::chrono::nanoseconds timeout)
+  {
+    if (timeout < std::chrono::nanoseconds::zero()) {
+      return;
+    }
+    pending_request.deadline = std::chrono::steady_clock::now() + timeout;
+    update_timeout_timer(pending_request.deadline, true);
+  }
+
+  rclcpp::detail::PendingRequestTable<PendingRequest> pending_requests_;
+  rclcpp::allocator::MessagePool::SharedPtr promise_pool_;
+  /// Read and replaced with the atomic functions of std::shared_ptr, by the executor thread.
+  rclcpp::allocator::MessagePool::SharedPtr response_pool_;
+  size_t expired_requests_ = 0;
+  mutable std::mutex pending_requests_mutex_;
 };
 
 }  // namespace rclcpp
@@ -15,10 +15,14 @@
 #ifndef RCLCPP__CLOCK_HPP_
 #define RCLCPP__CLOCK_HPP_
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
 
+#include "rclcpp/contexts/default_context.hpp"
+#include "rclcpp/duration.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/time.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -31,6 +35,7 @@ namespace rclcpp
 {
 
 class TimeSource;
+class SimTimeSource;
 
 class JumpHandler
 {
@@ -71,6 +76,11 @@ public:
   /**
    * Returns current time from the time source specified by clock_type.
    *
+   * On Linux the system and steady clocks, and the ROS clocks without ROS time override, are
+   * read directly with std::chrono instead of rcl_clock_get_now().
+   * The ROS time override is tracked with a jump callback, so it may still be changed with the
+   * rcl functions on get_clock_handle().
+   *
    * \return current time.
    * \throws anything rclcpp::exceptions::throw_from_rcl_error can throw.
    */
@@ -89,6 +99,48 @@ public:
   bool
   ros_time_is_active();
 
+  /// Sleep until the clock reaches a time, or the context is shutdown.
+  /**
+   * The system and steady clocks, and the ROS clocks without ROS time override, sleep on the
+   * matching std::chrono clock.
+   * A ROS clock with ROS time override doesn't poll: it waits until woken up by the updates of
+   * its time, from a SimTimeSource, TimeSource::set_clock() or rcl_set_ros_time_override() on
+   * get_clock_handle(), and by the activation or deactivation of the ROS time override, after
+   * which the sleep goes on with the new time.
+   *
+   * \param[in] until Time to sleep until, of the type of this clock.
+   * \param[in] context Context whose shutdown interrupts the sleep.
+   * \return true if `until` was reached, false if the context was shutdown.
+   * \throws std::invalid_argument if `until` is of another clock type.
+   * \throws std::runtime_error if the context is invalid.
+   * \throws anything rclcpp::exceptions::throw_from_rcl_error can throw.
+   */
+  RCLCPP_PUBLIC
+  bool
+  sleep_until(
+    Time until,
+    Context::SharedPtr context = contexts::default_context::get_global_default_context());
+
+  /// Sleep for a duration of the clock, or until the context is shutdown.
+  /**
+   * Equivalent to `sleep_until(now() + rel_time, context)`.
+   *
+   * \param[in] rel_time Duration to sleep for, in the time of this clock.
+   * \param[in] context Context whose shutdown interrupts the sleep.
+   * \return true if the duration elapsed, false if the context was shutdown.
+   * \throws std::runtime_error if the context is invalid.
+   * \throws anything rclcpp::exceptions::throw_from_rcl_error can throw.
+   */
+  RCLCPP_PUBLIC
+  bool
+  sleep_for(
+    Duration rel_time,
+    Context::SharedPtr context = contexts::default_context::get_global_default_context());
+
+  /// Return the rcl clock.
+  /**
+   * If the clock follows the time of a SimTimeSource, its ROS time override is updated first.
+   */
   RCLCPP_PUBLIC
   rcl_clock_t *
   get_clock_handle() noexcept;
@@ -130,6 +182,27 @@ public:
     const rcl_jump_threshold_t & threshold);
 
 private:
+  friend class SimTimeSource;
+
+  /// Follow the time of a SimTimeSource in now(), nullptr to stop.
+  RCLCPP_PUBLIC
+  void
+  set_sim_time(std::shared_ptr<const std::atomic<int64_t>> sim_time);
+
+  /// Update the ROS time override from the SimTimeSource, if the rcl clock needs it.
+  /**
+   * The rcl clock is used by its jump callbacks, e.g. of the timers, the other clocks are
+   * updated by get_clock_handle().
+   * \throws anything rclcpp::exceptions::throw_from_rcl_error can throw.
+   */
+  RCLCPP_PUBLIC
+  void
+  on_sim_time_update();
+
+  /// Set the ROS time override to the time of the SimTimeSource, if it changed.
+  rcl_ret_t
+  sync_sim_time();
+
   // Invoke time jump callback
   RCLCPP_PUBLIC
   static void
@@ -15,6 +15,7 @@
 #ifndef RCLCPP__CONTEXT_HPP_
 #define RCLCPP__CONTEXT_HPP_
 
+#include <atomic>
 #include <condition_variable>
 #include <functional>
 #include <memory>
@@ -113,9 +114,10 @@ public:
   /**
    * The context is valid if it has been initialized but not shutdown.
    *
-   * This function is thread-safe.
-   * This function is lock free so long as pointers and uint64_t atomics are
-   * lock free.
+   * This function is thread-safe and lock free, it's a single relaxed atomic load, cheap
+   * enough to be called on every iteration of an executor.
+   * Only shutdown() through this class, or rclcpp::shutdown(), is seen, shutting down the rcl
+   * context returned by get_rcl_context() directly isn't.
    *
    * \return true if valid, otherwise false
    */
@@ -237,6 +239,31 @@ public:
   void
   interrupt_all_sleep_for();
 
+  /// Notify a condition variable of the caller when interrupted.
+  /**
+   * An alternative to sleep_for() for the blocking calls waiting on their own condition
+   * variable, like Clock::sleep_until(): interrupt_all_sleep_for() locks `mutex` and notifies
+   * all the waiters of `condition_variable`, so a waiter checking is_valid() with `mutex`
+   * locked before waiting doesn't miss the shutdown.
+   *
+   * The condition variable must be removed with remove_interrupt_condition_variable()
+   * before being destroyed, it may be added several times and is then removed as many times.
+   * `mutex` must not be locked when calling this function or the remove one.
+   *
+   * \param[in] condition_variable Condition variable to notify when interrupted.
+   * \param[in] mutex Mutex of the waiters of the condition variable.
+   * \throws std::invalid_argument if either is nullptr.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_interrupt_condition_variable(
+    std::condition_variable * condition_variable, std::mutex * mutex);
+
+  /// Stop notifying a condition variable added with add_interrupt_condition_variable().
+  RCLCPP_PUBLIC
+  void
+  remove_interrupt_condition_variable(std::condition_variable * condition_variable);
+
   /// Get a handle to the guard condition which is triggered when interrupted.
   /**
    * This guard condition is triggered any time interrupt_all_wait_sets() is
@@ -289,12 +316,61 @@ public:
   void
   release_interrupt_guard_condition(rcl_wait_set_t * wait_set, const std::nothrow_t &) noexcept;
 
+  /// Trigger a guard condition of the caller when interrupted.
+  /**
+   * An alternative to get_interrupt_guard_condition() for wait sets which
+   * already have a guard condition to wake them up, like the interrupt guard
+   * condition of an executor: the same guard condition is then woken up by
+   * interrupt_all_wait_sets(), so the context doesn't create another one and
+   * the wait set holds one guard condition less.
+   *
+   * The guard condition must be removed with remove_interrupt_guard_condition()
+   * before being finalized.
+   * A guard condition added after this context is shutdown isn't triggered,
+   * so the waiters should still check is_valid() before waiting.
+   *
+   * \param[in] guard_condition Guard condition to trigger when interrupted.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_interrupt_guard_condition(rcl_guard_condition_t * guard_condition);
+
+  /// Stop triggering a guard condition added with add_interrupt_guard_condition().
+  RCLCPP_PUBLIC
+  void
+  remove_interrupt_guard_condition(rcl_guard_condition_t * guard_condition);
+
   /// Interrupt any blocking executors, or wait sets associated with this context.
   RCLCPP_PUBLIC
   virtual
   void
   interrupt_all_wait_sets();
 
+  /// Refuse the creation of entities in the nodes of this context from now on.
+  /**
+   * Meant for the static systems which create all their entities at startup, see
+   * InitOptions::entity_capacities: the nodes, publishers, subscriptions, timers, services,
+   * clients and waitables created afterwards throw exceptions::EntityCreationLockedError, so
+   * the system can't allocate and rebuild the executors at runtime by mistake.
+   * The entities can still be destroyed.
+   * It is reset when the context is initialized again.
+   */
+  RCLCPP_PUBLIC
+  void
+  lock_entity_creation();
+
+  RCLCPP_PUBLIC
+  bool
+  is_entity_creation_locked() const;
+
+  /// Throw exceptions::EntityCreationLockedError if the creation of entities is locked.
+  /**
+   * \param[in] entity_kind the kind of entity created, for the message of the exception.
+   */
+  RCLCPP_PUBLIC
+  void
+  check_entity_creation(const char * entity_kind) const;
+
   /// Return a singleton instance for the SubContext type, constructing one if necessary.
   template<typename SubContext, typename ... Args>
   std::shared_ptr<SubContext>
@@ -320,6 +396,19 @@ public:
     return sub_context;
   }
 
+  /// Return the instance of the SubContext type, nullptr if it was not constructed.
+  template<typename SubContext>
+  std::shared_ptr<SubContext>
+  find_sub_context()
+  {
+    std::lock_guard<std::recursive_mutex> lock(sub_contexts_mutex_);
+    auto it = sub_contexts_.find(std::type_index(typeid(SubContext)));
+    if (it == sub_contexts_.end()) {
+      return nullptr;
+    }
+    return std::static_pointer_cast<SubContext>(it->second);
+  }
+
 protected:
   // Called by constructor and destructor to clean up by finalizing the
   // shutdown rcl context and preparing for a new init cycle.
@@ -335,6 +424,10 @@ private:
   // between is_initialized and shutdown.
   std::recursive_mutex init_mutex_;
   std::shared_ptr<rcl_context_t> rcl_context_;
+  /// True between a successful init() and shutdown(), read without locking by is_valid().
+  std::atomic<bool> valid_{false};
+  /// See lock_entity_creation().
+  std::atomic<bool> entity_creation_locked_{false};
   rclcpp::InitOptions init_options_;
   std::string shutdown_reason_;
 
@@ -350,16 +443,24 @@ private:
   std::condition_variable interrupt_condition_variable_;
   /// Mutex for protecting the global condition variable.
   std::mutex interrupt_mutex_;
+  /// Condition variables of the callers notified on interrupt_all_sleep_for(), with their
+  /// mutex, also guarded by interrupt_mutex_.
+  std::vector<std::pair<std::condition_variable *, std::mutex *>> interrupt_condition_variables_;
 
   /// Mutex to protect sigint_guard_cond_handles_.
   std::mutex interrupt_guard_cond_handles_mutex_;
   /// Guard conditions for interrupting of associated wait sets on interrupt_all_wait_sets().
   std::unordered_map<rcl_wait_set_t *, rcl_guard_condition_t> interrupt_guard_cond_handles_;
+  /// Guard conditions of the callers triggered on interrupt_all_wait_sets(), also guarded by
+  /// interrupt_guard_cond_handles_mutex_.
+  std::vector<rcl_guard_condition_t *> added_interrupt_guard_conditions_;
 };
 
 /// Return a copy of the list of context shared pointers.
 /**
  * This function is thread-safe.
+ * It doesn't lock, the list is replaced when a context is initialized or shutdown, so getting
+ * the contexts doesn't contend with other contexts being initialized.
  */
 RCLCPP_PUBLIC
 std::vector<Context::SharedPtr>
@@ -0,0 +1,445 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__COROUTINE_HPP_
+#define RCLCPP__COROUTINE_HPP_
+
+// The coroutines need C++20, this header is empty for the earlier standards.
+#if defined(__cpp_impl_coroutine)
+#define RCLCPP_HAS_COROUTINES 1
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "rclcpp/client.hpp"
+#include "rclcpp/create_timer.hpp"
+#include "rclcpp/duration.hpp"
+#include "rclcpp/timer.hpp"
+
+namespace rclcpp
+{
+
+template<typename T>
+class Task;
+
+namespace detail
+{
+
+/// Completion of a task, shared by the Task and its coroutine.
+class TaskStateBase
+{
+public:
+  /// Return true if the coroutine ended.
+  bool
+  done() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return done_;
+  }
+
+  /// Set the coroutine to resume when the task ends.
+  /**
+   * \return false if the task already ended, then the coroutine must not be suspended.
+   */
+  bool
+  set_continuation(std::coroutine_handle<> continuation)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (done_) {
+      return false;
+    }
+    continuation_ = continuation;
+    return true;
+  }
+
+  /// Mark the task as ended, return the coroutine to resume, if any.
+  std::coroutine_handle<>
+  complete()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_ = true;
+    return std::exchange(continuation_, nullptr);
+  }
+
+  void
+  set_exception(std::exception_ptr exception)
+  {
+    exception_ = exception;
+  }
+
+protected:
+  void
+  check_result() const
+  {
+    if (!done()) {
+      throw std::logic_error("the task is not done");
+    }
+    if (exception_) {
+      std::rethrow_exception(exception_);
+    }
+  }
+
+private:
+  mutable std::mutex mutex_;
+  bool done_ = false;
+  std::coroutine_handle<> continuation_;
+  std::exception_ptr exception_;
+};
+
+template<typename T>
+class TaskState : public TaskStateBase
+{
+public:
+  template<typename U>
+  void
+  set_value(U && value)
+  {
+    value_.emplace(std::forward<U>(value));
+  }
+
+  T
+  get()
+  {
+    check_result();
+    return std::move(*value_);
+  }
+
+private:
+  std::optional<T> value_;
+};
+
+template<>
+class TaskState<void> : public TaskStateBase
+{
+public:
+  void
+  get()
+  {
+    check_result();
+  }
+};
+
+/// Resume the awaiting coroutine, if any, when a task ends, then let the task frame be destroyed.
+struct TaskFinalAwaiter
+{
+  TaskStateBase * state;
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  bool
+  await_suspend(std::coroutine_handle<>) noexcept
+  {
+    std::coroutine_handle<> continuation = state->complete();
+    if (continuation) {
+      continuation.resume();
+    }
+    // Not suspending ends the coroutine, which destroys its frame.
+    return false;
+  }
+
+  void
+  await_resume() const noexcept
+  {}
+};
+
+template<typename T>
+struct TaskPromiseBase
+{
+  std::shared_ptr<TaskState<T>> state = std::make_shared<TaskState<T>>();
+
+  Task<T>
+  get_return_object()
+  {
+    return Task<T>(state);
+  }
+
+  std::suspend_never
+  initial_suspend() const noexcept
+  {
+    return {};
+  }
+
+  TaskFinalAwaiter
+  final_suspend() const noexcept
+  {
+    return TaskFinalAwaiter{state.get()};
+  }
+
+  void
+  unhandled_exception()
+  {
+    state->set_exception(std::current_exception());
+  }
+};
+
+template<typename T>
+struct TaskPromise : public TaskPromiseBase<T>
+{
+  template<typename U>
+  void
+  return_value(U && value)
+  {
+    this->state->set_value(std::forward<U>(value));
+  }
+};
+
+template<>
+struct TaskPromise<void> : public TaskPromiseBase<void>
+{
+  void
+  return_void() const
+  {}
+};
+
+}  // namespace detail
+
+/// Coroutine of the rclcpp awaitables, e.g. rclcpp::await_response().
+/**
+ * The coroutine starts when it is called, and runs until its first suspension.
+ * It is then resumed by the executor spinning the entity it awaits, in the callback of that
+ * entity, so it doesn't hold a thread while suspended.
+ *
+ * The coroutine frame is destroyed when the coroutine ends, the Task may be dropped before.
+ * A Task can be awaited by another coroutine, which is resumed when it ends.
+ *
+ * ```cpp
+ * using AddTwoInts = example_interfaces::srv::AddTwoInts;
+ *
+ * rclcpp::Task<int64_t> add(
+ *   rclcpp::Node::SharedPtr node, rclcpp::Client<AddTwoInts>::SharedPtr client)
+ * {
+ *   auto request = std::make_shared<AddTwoInts::Request>();
+ *   auto response = co_await rclcpp::await_response(client, request);
+ *   co_await rclcpp::await_sleep_for(node, std::chrono::seconds(1));
+ *   co_return response->sum;
+ * }
+ * ```
+ */
+template<typename T = void>
+class Task
+{
+public:
+  using promise_type = detail::TaskPromise<T>;
+
+  explicit Task(std::shared_ptr<detail::TaskState<T>> state)
+  : state_(std::move(state))
+  {}
+
+  /// Return true if the coroutine ended.
+  bool
+  done() const
+  {
+    return state_->done();
+  }
+
+  /// Return the value of the coroutine, the value is moved out.
+  /**
+   * \throws anything the coroutine threw.
+   * \throws std::logic_error if the coroutine didn't end.
+   */
+  T
+  get()
+  {
+    return state_->get();
+  }
+
+  /// Resume the awaiting coroutine when this one ends, with its value.
+  auto
+  operator co_await() const noexcept
+  {
+    struct Awaiter
+    {
+      std::shared_ptr<detail::TaskState<T>> state;
+
+      bool
+      await_ready() const
+      {
+        return state->done();
+      }
+
+      bool
+      await_suspend(std::coroutine_handle<> handle)
+      {
+        return state->set_continuation(handle);
+      }
+
+      T
+      await_resume()
+      {
+        return state->get();
+      }
+    };
+    return Awaiter{state_};
+  }
+
+private:
+  std::shared_ptr<detail::TaskState<T>> state_;
+};
+
+/// Awaitable sending a request, see rclcpp::await_response().
+template<typename ServiceT>
+class ServiceResponseAwaiter
+{
+public:
+  using ClientT = rclcpp::Client<ServiceT>;
+
+  ServiceResponseAwaiter(
+    std::shared_ptr<ClientT> client,
+    typename ClientT::SharedRequest request,
+    std::chrono::nanoseconds timeout)
+  : client_(std::move(client)), request_(std::move(request)), timeout_(timeout)
+  {}
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> handle)
+  {
+    // The coroutine may be resumed, and this awaiter destroyed, before the call returns.
+    auto client = client_;
+    client->async_send_request(
+      request_,
+      [this, handle](typename ClientT::SharedFuture future) {
+        future_ = future;
+        handle.resume();
+      },
+      timeout_);
+  }
+
+  typename ClientT::SharedResponse
+  await_resume()
+  {
+    return future_.get();
+  }
+
+private:
+  std::shared_ptr<ClientT> client_;
+  typename ClientT::SharedRequest request_;
+  std::chrono::nanoseconds timeout_;
+  typename ClientT::SharedFuture future_;
+};
+
+/// Send a request, and resume the awaiting coroutine with the response.
+/**
+ * The coroutine is resumed by the executor spinning the client.
+ *
+ * \param[in] client The client.
+ * \param[in] request The request.
+ * \param[in] timeout The time to wait for the response, negative to wait forever.
+ * \return the awaitable, which gives the response.
+ *   Awaiting it throws rclcpp::exceptions::RequestTimeoutError if the request times out.
+ */
+template<typename ServiceT>
+ServiceResponseAwaiter<ServiceT>
+await_response(
+  std::shared_ptr<rclcpp::Client<ServiceT>> client,
+  typename rclcpp::Client<ServiceT>::SharedRequest request,
+  std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1))
+{
+  return ServiceResponseAwaiter<ServiceT>(std::move(client), std::move(request), timeout);
+}
+
+/// Awaitable waiting for a one-shot timer, see rclcpp::await_sleep_for().
+template<typename NodeT>
+class SleepAwaiter
+{
+public:
+  SleepAwaiter(NodeT node, rclcpp::Clock::SharedPtr clock, std::chrono::nanoseconds duration)
+  : node_(std::move(node)), clock_(std::move(clock)), duration_(duration),
+    state_(std::make_shared<State>())
+  {}
+
+  bool
+  await_ready() const noexcept
+  {
+    return duration_ <= std::chrono::nanoseconds::zero();
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> handle)
+  {
+    // The timer may fire, and this awaiter be destroyed, once the lock is released.
+    auto state = state_;
+    std::lock_guard<std::mutex> lock(state->mutex);
+    std::weak_ptr<State> weak_state = state;
+    state->timer = rclcpp::create_timer(
+      node_, clock_, rclcpp::Duration(duration_),
+      [weak_state, handle](rclcpp::TimerBase & timer) {
+        auto state = weak_state.lock();
+        if (!state) {
+          return;
+        }
+        {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          timer.cancel();
+        }
+        handle.resume();
+      });
+  }
+
+  void
+  await_resume() const noexcept
+  {}
+
+private:
+  struct State
+  {
+    std::mutex mutex;
+    // Only owned here, so that the timer is destroyed with the awaiter.
+    rclcpp::TimerBase::SharedPtr timer;
+  };
+
+  NodeT node_;
+  rclcpp::Clock::SharedPtr clock_;
+  std::chrono::nanoseconds duration_;
+  std::shared_ptr<State> state_;
+};
+
+/// Resume the awaiting coroutine after a duration, measured with the clock of a node.
+/**
+ * The wait is a one-shot timer of the node, so the coroutine is resumed by the executor spinning
+ * the node, and follows the simulated time if the node uses it.
+ *
+ * \param[in] node The node.
+ * \param[in] duration The duration, the coroutine isn't suspended if it is not positive.
+ * \return the awaitable.
+ */
+template<typename NodeT>
+SleepAwaiter<NodeT>
+await_sleep_for(NodeT node, std::chrono::nanoseconds duration)
+{
+  auto clock = node->get_clock();
+  return SleepAwaiter<NodeT>(std::move(node), std::move(clock), duration);
+}
+
+}  // namespace rclcpp
+
+#endif  // defined(__cpp_impl_coroutine)
+
+#endif  // RCLCPP__COROUTINE_HPP_
@@ -18,6 +18,7 @@
 #include <memory>
 #include <string>
 
+#include "rclcpp/detail/make_entity_shared.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_services_interface.hpp"
 #include "rmw/rmw.h"
@@ -40,7 +41,8 @@ create_client(
   rcl_client_options_t options = rcl_client_get_default_options();
   options.qos = qos_profile;
 
-  auto cli = rclcpp::Client<ServiceT>::make_shared(
+  auto cli = rclcpp::detail::make_entity_shared<rclcpp::Client<ServiceT>>(
+    node_base->get_entity_arena(),
     node_base.get(),
     node_graph,
     service_name,
@@ -0,0 +1,139 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__CREATE_CPU_TIME_REPORT_TIMER_HPP_
+#define RCLCPP__CREATE_CPU_TIME_REPORT_TIMER_HPP_
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "rcl/node.h"
+
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/detail/make_entity_shared.hpp"
+#include "rclcpp/executor_instrumentation.hpp"
+#include "rclcpp/logger.hpp"
+#include "rclcpp/logging.hpp"
+#include "rclcpp/node_interfaces/get_node_base_interface.hpp"
+#include "rclcpp/node_interfaces/get_node_timers_interface.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/node_interfaces/node_timers_interface.hpp"
+#include "rclcpp/timer.hpp"
+
+namespace rclcpp
+{
+
+/// Create a wall timer logging the CPU time spent in the callbacks of a node periodically.
+/**
+ * The report has one line per callback group of the node, with the CPU time of the group since
+ * the start and since the previous report, see CallbackGroup::get_cpu_time().
+ * If instrumentation is given, it is followed by one line per entity executed by the executors
+ * using it, see ExecutorInstrumentation::get_cpu_time_histograms().
+ * The CPU time is only counted by the executors with
+ * Executor::set_callback_group_cpu_time_measurement() enabled.
+ *
+ * Like create_memory_usage_report_timer(), the report is logged at the info level with the
+ * logger of the node, so it is published to /rosout with the other logs of the node.
+ *
+ * \param[in] node_base the node whose callback groups are reported.
+ * \param[in] node_timers used to add the timer to the node.
+ * \param[in] period the period of the report.
+ * \param[in] instrumentation the instrumentation of the executors, to report each entity.
+ * \param[in] group the callback group of the timer, the default one of the node if nullptr.
+ * \return the timer, the report stops when it is canceled or released.
+ */
+inline
+rclcpp::TimerBase::SharedPtr
+create_cpu_time_report_timer(
+  node_interfaces::NodeBaseInterface * node_base,
+  node_interfaces::NodeTimersInterface * node_timers,
+  std::chrono::nanoseconds period,
+  rclcpp::executor::ExecutorInstrumentation::SharedPtr instrumentation = nullptr,
+  rclcpp::callback_group::CallbackGroup::SharedPtr group = nullptr)
+{
+  rclcpp::Logger logger =
+    rclcpp::get_logger(rcl_node_get_logger_name(node_base->get_rcl_node_handle()));
+  std::unordered_map<const void *, std::chrono::nanoseconds> last_cpu_times;
+  rclcpp::VoidCallbackType callback =
+    [node_base, logger, instrumentation, last_cpu_times]() mutable {
+      std::ostringstream report;
+      std::unordered_map<const void *, std::chrono::nanoseconds> cpu_times;
+      size_t index = 0;
+      for (auto & weak_group : node_base->get_callback_groups()) {
+        auto callback_group = weak_group.lock();
+        if (!callback_group) {
+          continue;
+        }
+        std::chrono::nanoseconds cpu_time = callback_group->get_cpu_time();
+        auto last = last_cpu_times.find(callback_group.get());
+        std::chrono::nanoseconds previous =
+          last == last_cpu_times.end() ? std::chrono::nanoseconds(0) : last->second;
+        cpu_times.emplace(callback_group.get(), cpu_time);
+        report << "group " << index++ <<
+          (callback_group->type() == rclcpp::callback_group::CallbackGroupType::Reentrant ?
+          " reentrant" : " mutually exclusive") <<
+          ": total " << cpu_time.count() << "ns last period " <<
+          (cpu_time - previous).count() << "ns\n";
+      }
+      // Forget the groups which were destroyed.
+      last_cpu_times = std::move(cpu_times);
+      if (instrumentation) {
+        for (auto & entity : instrumentation->get_cpu_time_histograms()) {
+          report << entity.name << ": count " << entity.histogram.count() <<
+            " mean " << entity.histogram.mean().count() <<
+            "ns max " << entity.histogram.max().count() <<
+            "ns total " << entity.histogram.total().count() << "ns\n";
+        }
+      }
+      RCLCPP_INFO(logger, "cpu time:\n%s", report.str().c_str());
+    };
+  auto timer = rclcpp::detail::make_entity_shared<rclcpp::WallTimer<rclcpp::VoidCallbackType>>(
+    node_base->get_entity_arena(),
+    period,
+    std::move(callback),
+    node_base->get_context());
+  node_timers->add_timer(timer, group);
+  return timer;
+}
+
+/// Create a wall timer logging the CPU time spent in the callbacks of a node periodically.
+/**
+ * \sa create_cpu_time_report_timer(node_interfaces::NodeBaseInterface *,
+ *   node_interfaces::NodeTimersInterface *, std::chrono::nanoseconds,
+ *   rclcpp::executor::ExecutorInstrumentation::SharedPtr,
+ *   rclcpp::callback_group::CallbackGroup::SharedPtr)
+ */
+template<typename NodeT>
+rclcpp::TimerBase::SharedPtr
+create_cpu_time_report_timer(
+  NodeT node,
+  std::chrono::nanoseconds period,
+  rclcpp::executor::ExecutorInstrumentation::SharedPtr instrumentation = nullptr,
+  rclcpp::callback_group::CallbackGroup::SharedPtr group = nullptr)
+{
+  return create_cpu_time_report_timer(
+    rclcpp::node_interfaces::get_node_base_interface(node),
+    rclcpp::node_interfaces::get_node_timers_interface(node),
+    period,
+    instrumentation,
+    group);
+}
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__CREATE_CPU_TIME_REPORT_TIMER_HPP_
@@ -0,0 +1,79 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__CREATE_GENERIC_SUBSCRIPTION_HPP_
+#define RCLCPP__CREATE_GENERIC_SUBSCRIPTION_HPP_
+
+#include <memory>
+#include <string>
+
+#include "rclcpp/detail/make_entity_shared.hpp"
+#include "rclcpp/generic_subscription.hpp"
+#include "rclcpp/node_interfaces/node_topics_interface.hpp"
+#include "rclcpp/subscription_factory.hpp"
+#include "rclcpp/subscription_options.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/typesupport_helpers.hpp"
+
+namespace rclcpp
+{
+
+/// Create and return a GenericSubscription.
+/**
+ * The type support of the messages is loaded at runtime from the name of their type.
+ *
+ * \param[in] topics_interface NodeTopicsInterface pointer used in parts of the setup.
+ * \param[in] topic_name Name of the topic to subscribe to.
+ * \param[in] topic_type Name of the message type, e.g. "std_msgs/msg/String".
+ * \param[in] qos QoS profile of the subscription.
+ * \param[in] callback called with each serialized message taken.
+ * \param[in] options options of the subscription.
+ * \throws std::invalid_argument if the type name is malformed.
+ * \throws std::runtime_error if the type support of the type can't be loaded.
+ */
+inline
+std::shared_ptr<GenericSubscription>
+create_generic_subscription(
+  rclcpp::node_interfaces::NodeTopicsInterface::SharedPtr topics_interface,
+  const std::string & topic_name,
+  const std::string & topic_type,
+  const rclcpp::QoS & qos,
+  GenericSubscription::CallbackType callback,
+  const rclcpp::SubscriptionOptions & options = rclcpp::SubscriptionOptions())
+{
+  auto typesupport_library = rclcpp::get_typesupport_library(topic_type, "rosidl_typesupport_cpp");
+  auto type_support = rclcpp::get_typesupport_handle(
+    topic_type, "rosidl_typesupport_cpp", *typesupport_library);
+
+  rclcpp::SubscriptionFactory factory {
+    [typesupport_library, type_support, callback, options](
+      rclcpp::node_interfaces::NodeBaseInterface * node_base,
+      const std::string & topic_name,
+      const rclcpp::QoS & qos) -> rclcpp::SubscriptionBase::SharedPtr
+    {
+      return rclcpp::detail::make_entity_shared<GenericSubscription>(
+        node_base->get_entity_arena(), node_base, typesupport_library, *type_support,
+        topic_name, qos, callback, options);
+    }
+  };
+
+  auto sub = topics_interface->create_subscription(topic_name, factory, qos);
+  topics_interface->add_subscription(sub, options.callback_group);
+  return std::dynamic_pointer_cast<GenericSubscription>(sub);
+}
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__CREATE_GENERIC_SUBSCRIPTION_HPP_
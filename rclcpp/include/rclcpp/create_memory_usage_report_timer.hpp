@@ -0,0 +1,95 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__CREATE_MEMORY_USAGE_REPORT_TIMER_HPP_
+#define RCLCPP__CREATE_MEMORY_USAGE_REPORT_TIMER_HPP_
+
+#include <chrono>
+#include <string>
+#include <utility>
+
+#include "rcl/node.h"
+
+#include "rclcpp/detail/make_entity_shared.hpp"
+#include "rclcpp/logger.hpp"
+#include "rclcpp/logging.hpp"
+#include "rclcpp/memory_usage.hpp"
+#include "rclcpp/node_interfaces/get_node_base_interface.hpp"
+#include "rclcpp/node_interfaces/get_node_timers_interface.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/node_interfaces/node_timers_interface.hpp"
+#include "rclcpp/timer.hpp"
+
+namespace rclcpp
+{
+
+/// Create a wall timer logging the memory usage of a node periodically.
+/**
+ * The report, see rclcpp::to_string(const NodeMemoryUsage &), is logged at the info level with
+ * the logger of the node, so it is published to /rosout with the other logs of the node.
+ * Like any timer, it is only called while the node is spun, and it must not outlive the node.
+ *
+ * \param[in] node_base the node whose memory usage is reported.
+ * \param[in] node_timers used to add the timer to the node.
+ * \param[in] period the period of the report.
+ * \param[in] group the callback group of the timer, the default one of the node if nullptr.
+ * \return the timer, the report stops when it is canceled or released.
+ */
+inline
+rclcpp::TimerBase::SharedPtr
+create_memory_usage_report_timer(
+  node_interfaces::NodeBaseInterface * node_base,
+  node_interfaces::NodeTimersInterface * node_timers,
+  std::chrono::nanoseconds period,
+  rclcpp::callback_group::CallbackGroup::SharedPtr group = nullptr)
+{
+  rclcpp::Logger logger =
+    rclcpp::get_logger(rcl_node_get_logger_name(node_base->get_rcl_node_handle()));
+  rclcpp::VoidCallbackType callback = [node_base, logger]() {
+      std::string report = rclcpp::to_string(node_base->get_memory_usage());
+      RCLCPP_INFO(logger, "memory usage:\n%s", report.c_str());
+    };
+  auto timer = rclcpp::detail::make_entity_shared<rclcpp::WallTimer<rclcpp::VoidCallbackType>>(
+    node_base->get_entity_arena(),
+    period,
+    std::move(callback),
+    node_base->get_context());
+  node_timers->add_timer(timer, group);
+  return timer;
+}
+
+/// Create a wall timer logging the memory usage of a node periodically.
+/**
+ * \sa create_memory_usage_report_timer(node_interfaces::NodeBaseInterface *,
+ *   node_interfaces::NodeTimersInterface *, std::chrono::nanoseconds,
+ *   rclcpp::callback_group::CallbackGroup::SharedPtr)
+ */
+template<typename NodeT>
+rclcpp::TimerBase::SharedPtr
+create_memory_usage_report_timer(
+  NodeT node,
+  std::chrono::nanoseconds period,
+  rclcpp::callback_group::CallbackGroup::SharedPtr group = nullptr)
+{
+  return create_memory_usage_report_timer(
+    rclcpp::node_interfaces::get_node_base_interface(node),
+    rclcpp::node_interfaces::get_node_timers_interface(node),
+    period,
+    group);
+}
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__CREATE_MEMORY_USAGE_REPORT_TIMER_HPP_
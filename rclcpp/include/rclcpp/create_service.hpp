@@ -19,6 +19,7 @@
 #include <string>
 #include <utility>
 
+#include "rclcpp/detail/make_entity_shared.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_services_interface.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -45,9 +46,13 @@ create_service(
   rcl_service_options_t service_options = rcl_service_get_default_options();
   service_options.qos = qos_profile;
 
-  auto serv = Service<ServiceT>::make_shared(
+  // A shared rcl node has none of the names and arguments of this node.
+  auto serv = rclcpp::detail::make_entity_shared<Service<ServiceT>>(
+    node_base->get_entity_arena(),
     node_base->get_shared_rcl_node_handle(),
-    service_name, any_service_callback, service_options);
+    node_base->shares_rcl_node() ?
+    node_base->resolve_topic_or_service_name(service_name, true) : service_name,
+    any_service_callback, service_options);
   auto serv_base_ptr = std::dynamic_pointer_cast<ServiceBase>(serv);
   node_services->add_service(serv_base_ptr, group);
   return serv;
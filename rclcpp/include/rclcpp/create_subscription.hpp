@@ -41,7 +41,9 @@ template<
   typename AllocatorT = std::allocator<void>,
   typename CallbackMessageT =
   typename rclcpp::subscription_traits::has_message_type<CallbackT>::type,
-  typename SubscriptionT = rclcpp::Subscription<CallbackMessageT, AllocatorT>,
+  typename SubscriptionT = rclcpp::Subscription<
+    typename rclcpp::subscription_traits::subscribed_type<MessageT, CallbackMessageT>::type,
+    AllocatorT>,
   typename MessageMemoryStrategyT = rclcpp::message_memory_strategy::MessageMemoryStrategy<
     CallbackMessageT,
     AllocatorT
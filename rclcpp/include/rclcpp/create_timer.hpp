@@ -15,10 +15,12 @@
 #ifndef RCLCPP__CREATE_TIMER_HPP_
 #define RCLCPP__CREATE_TIMER_HPP_
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <utility>
 
+#include "rclcpp/detail/make_entity_shared.hpp"
 #include "rclcpp/duration.hpp"
 #include "rclcpp/node_interfaces/get_node_base_interface.hpp"
 #include "rclcpp/node_interfaces/get_node_timers_interface.hpp"
@@ -37,19 +39,25 @@ create_timer(
   rclcpp::Clock::SharedPtr clock,
   rclcpp::Duration period,
   CallbackT && callback,
-  rclcpp::callback_group::CallbackGroup::SharedPtr group = nullptr)
+  rclcpp::callback_group::CallbackGroup::SharedPtr group = nullptr,
+  std::chrono::nanoseconds slack = std::chrono::nanoseconds::zero())
 {
-  auto timer = rclcpp::GenericTimer<CallbackT>::make_shared(
+  auto timer = rclcpp::detail::make_entity_shared<rclcpp::GenericTimer<CallbackT>>(
+    node_base->get_entity_arena(),
     clock,
     period.to_chrono<std::chrono::nanoseconds>(),
     std::forward<CallbackT>(callback),
     node_base->get_context());
+  timer->set_slack(slack);
 
   node_timers->add_timer(timer, group);
   return timer;
 }
 
 /// Create a timer with a given clock
+/**
+ * The slack is the tolerated lateness of the callback, see rclcpp::TimerBase::set_slack().
+ */
 template<typename NodeT, typename CallbackT>
 typename rclcpp::TimerBase::SharedPtr
 create_timer(
@@ -57,7 +65,8 @@ create_timer(
   rclcpp::Clock::SharedPtr clock,
   rclcpp::Duration period,
   CallbackT && callback,
-  rclcpp::callback_group::CallbackGroup::SharedPtr group = nullptr)
+  rclcpp::callback_group::CallbackGroup::SharedPtr group = nullptr,
+  std::chrono::nanoseconds slack = std::chrono::nanoseconds::zero())
 {
   return create_timer(
     rclcpp::node_interfaces::get_node_base_interface(node),
@@ -65,7 +74,8 @@ create_timer(
     clock,
     period,
     std::forward<CallbackT>(callback),
-    group);
+    group,
+    slack);
 }
 
 }  // namespace rclcpp
@@ -0,0 +1,138 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DEFERRED_CALL_QUEUE_HPP_
+#define RCLCPP__DEFERRED_CALL_QUEUE_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executor
+{
+
+/// Schedule one-shot calls of an executor, without an rcl timer for each of them.
+/**
+ * The calls are kept in a min-heap ordered by their deadline, like the timers of a TimerManager,
+ * so pushing a call is O(log n) and the executor only gives the time until the nearest deadline
+ * to the wait.
+ * A canceled call is only removed from the map of the pending calls, its heap item is dropped
+ * once it reaches the top, or when the canceled items outnumber the pending calls.
+ *
+ * All the methods are thread-safe.
+ */
+class DeferredCallQueue
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(DeferredCallQueue)
+
+  using Callback = std::function<void ()>;
+
+  RCLCPP_PUBLIC
+  DeferredCallQueue();
+
+  /// Schedule a call.
+  /**
+   * \param[in] deadline the time at which the call is ready.
+   * \param[in] callback the function called.
+   * \param[in] group the callback group the call is executed in, the call is dropped if the
+   *   group is destroyed before.
+   * \return the handle of the call, never 0.
+   */
+  RCLCPP_PUBLIC
+  uint64_t
+  push(
+    std::chrono::steady_clock::time_point deadline,
+    Callback callback,
+    rclcpp::callback_group::CallbackGroup::WeakPtr group);
+
+  /// Cancel a call which was not taken yet.
+  /**
+   * \return true if the call was pending, false if it was already taken or canceled.
+   */
+  RCLCPP_PUBLIC
+  bool
+  cancel(uint64_t handle);
+
+  /// Return the deadline of the earliest pending call, time_point::max() if there is none.
+  RCLCPP_PUBLIC
+  std::chrono::steady_clock::time_point
+  get_next_deadline();
+
+  /// Take the expired call with the earliest deadline.
+  /**
+   * \param[in] can_take called with the group of the expired calls in deadline order, the first
+   *   call for which it returns true is taken, e.g. whose callback group can be taken from.
+   * \param[out] callback set to the function of the call taken.
+   * \return true if a call was taken.
+   */
+  RCLCPP_PUBLIC
+  bool
+  take_next_ready(
+    const std::function<bool(const rclcpp::callback_group::CallbackGroup::SharedPtr &)> & can_take,
+    Callback & callback);
+
+  /// Return the number of pending calls.
+  RCLCPP_PUBLIC
+  size_t
+  size() const;
+
+private:
+  struct Call
+  {
+    Callback callback;
+    rclcpp::callback_group::CallbackGroup::WeakPtr group;
+  };
+
+  struct HeapItem
+  {
+    std::chrono::steady_clock::time_point deadline;
+    uint64_t handle;
+  };
+
+  struct LaterDeadline
+  {
+    bool
+    operator()(const HeapItem & a, const HeapItem & b) const
+    {
+      return a.deadline > b.deadline;
+    }
+  };
+
+  /// Pop the items of the canceled calls, mutex_ must be locked.
+  /**
+   * \return true if the heap has a pending call at its top.
+   */
+  bool
+  prune_top();
+
+  mutable std::mutex mutex_;
+  std::unordered_map<uint64_t, Call> calls_;
+  std::vector<HeapItem> heap_;
+  uint64_t last_handle_;
+};
+
+}  // namespace executor
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DEFERRED_CALL_QUEUE_HPP_
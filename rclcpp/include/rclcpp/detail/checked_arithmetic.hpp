@@ -0,0 +1,87 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__DETAIL__CHECKED_ARITHMETIC_HPP_
+#define RCLCPP__DETAIL__CHECKED_ARITHMETIC_HPP_
+
+#include <cstdint>
+#include <limits>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Store x + y in result, return false if the sum doesn't fit in an int64_t.
+/**
+ * result is overwritten either way, so it must not alias x or y.
+ */
+inline
+bool
+checked_add(int64_t x, int64_t y, int64_t & result) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return !__builtin_add_overflow(x, y, &result);
+#else
+  if ((y > 0 && x > std::numeric_limits<int64_t>::max() - y) ||
+    (y < 0 && x < std::numeric_limits<int64_t>::min() - y))
+  {
+    return false;
+  }
+  result = x + y;
+  return true;
+#endif
+}
+
+/// Store x - y in result, return false if the difference doesn't fit in an int64_t.
+/**
+ * result is overwritten either way, so it must not alias x or y.
+ */
+inline
+bool
+checked_sub(int64_t x, int64_t y, int64_t & result) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return !__builtin_sub_overflow(x, y, &result);
+#else
+  if ((y < 0 && x > std::numeric_limits<int64_t>::max() + y) ||
+    (y > 0 && x < std::numeric_limits<int64_t>::min() + y))
+  {
+    return false;
+  }
+  result = x - y;
+  return true;
+#endif
+}
+
+/// Throw std::overflow_error, or std::underflow_error if `overflow` is false.
+/**
+ * Shared by the arithmetic operators of rclcpp::Time and rclcpp::Duration, kept out of their
+ * checked fast path.
+ *
+ * \param[in] operation the failed operation, e.g. "addition".
+ * \param[in] overflow whether the result was too large rather than too small.
+ */
+[[noreturn]]
+RCLCPP_PUBLIC
+void
+throw_int64_overflow(const char * operation, bool overflow);
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__CHECKED_ARITHMETIC_HPP_
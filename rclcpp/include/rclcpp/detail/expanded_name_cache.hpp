@@ -0,0 +1,99 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__EXPANDED_NAME_CACHE_HPP_
+#define RCLCPP__DETAIL__EXPANDED_NAME_CACHE_HPP_
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Memoize the names of a node expanded, and possibly remapped, from the names given by the user.
+/**
+ * The result of the expansion only depends on the name, the name and the namespace of the node
+ * and its remapping rules, which don't change during the life of the node, so one cache is used
+ * per node.
+ * Only the names resolved successfully are kept, a name failing validation throws each time.
+ * The cache is cleared when it reaches max_size, to bound the memory used by nodes resolving
+ * many names once.
+ */
+class ExpandedNameCache
+{
+public:
+  enum class Kind
+  {
+    Topic,
+    Service,
+    RemappedTopic,
+  };
+
+  explicit ExpandedNameCache(size_t max_size = 1024)
+  : max_size_(max_size)
+  {}
+
+  /// Return the resolved name, calling resolve() if it isn't in the cache.
+  template<typename ResolveT>
+  std::string
+  get(const std::string & name, Kind kind, ResolveT && resolve)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto iter = names_.find(Key(kind, name));
+      if (iter != names_.end()) {
+        return iter->second;
+      }
+    }
+    // Resolve without holding the lock, it may throw.
+    std::string resolved = resolve();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (names_.size() >= max_size_) {
+      names_.clear();
+    }
+    names_.emplace(Key(kind, name), resolved);
+    return resolved;
+  }
+
+  size_t
+  size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_.size();
+  }
+
+  void
+  clear()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    names_.clear();
+  }
+
+private:
+  using Key = std::pair<Kind, std::string>;
+
+  const size_t max_size_;
+  mutable std::mutex mutex_;
+  std::map<Key, std::string> names_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__EXPANDED_NAME_CACHE_HPP_
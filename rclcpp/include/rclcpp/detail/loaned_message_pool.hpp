@@ -0,0 +1,135 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__LOANED_MESSAGE_POOL_HPP_
+#define RCLCPP__DETAIL__LOANED_MESSAGE_POOL_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Messages recycled by the loaned messages of a publisher whose middleware can't loan.
+/**
+ * A message is allocated and constructed once, then kept by release() for the next acquire(),
+ * up to the capacity of the pool, so that borrowing a message doesn't allocate in steady state.
+ * A recycled message keeps the content it was published with, its sequences keeping their
+ * capacity, like the memory loaned by a middleware isn't reset either.
+ */
+template<typename MessageT, typename AllocatorT = std::allocator<void>>
+class LoanedMessagePool
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(LoanedMessagePool)
+
+  using MessageAllocatorTraits = allocator::AllocRebind<MessageT, AllocatorT>;
+  using MessageAllocator = typename MessageAllocatorTraits::allocator_type;
+
+  /// Constructor.
+  /**
+   * \param[in] capacity Maximum number of messages kept for recycling.
+   * \param[in] message_allocator Allocator of the messages.
+   */
+  LoanedMessagePool(size_t capacity, std::shared_ptr<MessageAllocator> message_allocator)
+  : capacity_(capacity), message_allocator_(std::move(message_allocator)), allocation_count_(0)
+  {
+    messages_.reserve(capacity_);
+  }
+
+  ~LoanedMessagePool()
+  {
+    for (MessageT * message : messages_) {
+      destroy(message);
+    }
+  }
+
+  /// Return a recycled message, or a new one if none is left.
+  MessageT *
+  acquire()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!messages_.empty()) {
+        MessageT * message = messages_.back();
+        messages_.pop_back();
+        return message;
+      }
+      allocation_count_++;
+    }
+    MessageT * message = MessageAllocatorTraits::allocate(*message_allocator_, 1);
+    try {
+      MessageAllocatorTraits::construct(*message_allocator_, message);
+    } catch (...) {
+      MessageAllocatorTraits::deallocate(*message_allocator_, message, 1);
+      throw;
+    }
+    return message;
+  }
+
+  /// Keep a message returned by acquire() for recycling, or destroy it if the pool is full.
+  void
+  release(MessageT * message)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (messages_.size() < capacity_) {
+        messages_.push_back(message);
+        return;
+      }
+    }
+    destroy(message);
+  }
+
+  MessageAllocator &
+  get_allocator() const
+  {
+    return *message_allocator_;
+  }
+
+  /// Return the number of messages allocated because none could be recycled.
+  size_t
+  get_allocation_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocation_count_;
+  }
+
+private:
+  void
+  destroy(MessageT * message)
+  {
+    MessageAllocatorTraits::destroy(*message_allocator_, message);
+    MessageAllocatorTraits::deallocate(*message_allocator_, message, 1);
+  }
+
+  const size_t capacity_;
+  std::shared_ptr<MessageAllocator> message_allocator_;
+  std::vector<MessageT *> messages_;
+  size_t allocation_count_;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__LOANED_MESSAGE_POOL_HPP_
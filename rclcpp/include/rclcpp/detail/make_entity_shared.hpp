@@ -0,0 +1,119 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__MAKE_ENTITY_SHARED_HPP_
+#define RCLCPP__DETAIL__MAKE_ENTITY_SHARED_HPP_
+
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "rclcpp/allocator/arena_allocator.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Allocator taking its memory from the entity arena of a node, or from the global allocator.
+/**
+ * Unlike ArenaAllocator, it doesn't throw when the arena is used up, the memory is then taken
+ * from the global allocator.
+ */
+template<typename T>
+class EntityAllocator
+{
+public:
+  using value_type = T;
+
+  template<typename U>
+  struct rebind
+  {
+    using other = EntityAllocator<U>;
+  };
+
+  explicit EntityAllocator(rclcpp::allocator::Arena::SharedPtr arena)
+  : arena_(std::move(arena))
+  {}
+
+  template<typename U>
+  EntityAllocator(const EntityAllocator<U> & other)  // NOLINT(runtime/explicit)
+  : arena_(other.get_arena())
+  {}
+
+  T *
+  allocate(size_t n)
+  {
+    try {
+      return static_cast<T *>(arena_->allocate(n * sizeof(T)));
+    } catch (const std::bad_alloc &) {
+      return static_cast<T *>(::operator new(n * sizeof(T)));
+    }
+  }
+
+  void
+  deallocate(T * pointer, size_t n)
+  {
+    (void)n;
+    if (arena_->owns(pointer)) {
+      arena_->deallocate(pointer);
+    } else {
+      ::operator delete(pointer);
+    }
+  }
+
+  const rclcpp::allocator::Arena::SharedPtr &
+  get_arena() const
+  {
+    return arena_;
+  }
+
+private:
+  rclcpp::allocator::Arena::SharedPtr arena_;
+};
+
+template<typename T, typename U>
+bool
+operator==(const EntityAllocator<T> & lhs, const EntityAllocator<U> & rhs)
+{
+  return lhs.get_arena() == rhs.get_arena();
+}
+
+template<typename T, typename U>
+bool
+operator!=(const EntityAllocator<T> & lhs, const EntityAllocator<U> & rhs)
+{
+  return !(lhs == rhs);
+}
+
+/// Create an entity of a node in its entity arena, or with std::make_shared if it has none.
+/**
+ * The entity and its reference counts are allocated together in the arena, which is kept alive
+ * until the entity is destroyed.
+ */
+template<typename EntityT, typename ... Args>
+std::shared_ptr<EntityT>
+make_entity_shared(const rclcpp::allocator::Arena::SharedPtr & arena, Args && ... args)
+{
+  if (!arena) {
+    return std::make_shared<EntityT>(std::forward<Args>(args)...);
+  }
+  return std::allocate_shared<EntityT>(
+    EntityAllocator<EntityT>(arena), std::forward<Args>(args)...);
+}
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__MAKE_ENTITY_SHARED_HPP_
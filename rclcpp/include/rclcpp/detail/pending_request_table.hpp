@@ -0,0 +1,237 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__PENDING_REQUEST_TABLE_HPP_
+#define RCLCPP__DETAIL__PENDING_REQUEST_TABLE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Table of the requests of a client waiting for a response, keyed by sequence number.
+/**
+ * It is an open addressing hash table with linear probing, the slots are allocated up front
+ * and only reallocated when the table is more than half full.
+ * The sequence numbers of a client are consecutive, so indexing by their lowest bits spreads
+ * the pending requests evenly.
+ * A value is reset to a default constructed one when it is taken, ValueT must be default
+ * constructible and move assignable without allocating, e.g. shared pointers and functions.
+ *
+ * It is not thread-safe.
+ */
+template<typename ValueT>
+class PendingRequestTable
+{
+public:
+  explicit PendingRequestTable(size_t capacity = 16)
+  : size_(0)
+  {
+    slots_.resize(round_up_capacity(capacity));
+  }
+
+  /// Insert a default constructed value for a sequence number which is not in the table.
+  /**
+   * \return the value, valid until the table is modified.
+   */
+  ValueT &
+  insert(int64_t sequence_number)
+  {
+    if (2 * (size_ + 1) > slots_.size()) {
+      rehash(2 * slots_.size());
+    }
+    size_t index = find_slot(sequence_number);
+    Slot & slot = slots_[index];
+    slot.sequence_number = sequence_number;
+    slot.used = true;
+    ++size_;
+    return slot.value;
+  }
+
+  /// Move the value of a sequence number out of the table.
+  /**
+   * \return false if the sequence number is not in the table.
+   */
+  bool
+  take(int64_t sequence_number, ValueT & value)
+  {
+    size_t index = find_slot(sequence_number);
+    if (!slots_[index].used) {
+      return false;
+    }
+    value = std::move(slots_[index].value);
+    erase_slot(index);
+    return true;
+  }
+
+  /// Remove the value of a sequence number.
+  /**
+   * \return false if the sequence number is not in the table.
+   */
+  bool
+  erase(int64_t sequence_number)
+  {
+    size_t index = find_slot(sequence_number);
+    if (!slots_[index].used) {
+      return false;
+    }
+    erase_slot(index);
+    return true;
+  }
+
+  /// Move the values for which a predicate returns true out of the table.
+  /**
+   * \param[in] predicate Called with each value, it may be called more than once for a value.
+   * \param[in] consumer Called with each value taken, as an rvalue reference.
+   * \return the number of values taken.
+   */
+  template<typename PredicateT, typename ConsumerT>
+  size_t
+  take_if(PredicateT predicate, ConsumerT consumer)
+  {
+    size_t taken = 0;
+    size_t index = 0;
+    while (index < slots_.size()) {
+      Slot & slot = slots_[index];
+      if (slot.used && predicate(static_cast<const ValueT &>(slot.value))) {
+        consumer(std::move(slot.value));
+        // A following value may be moved back to this slot.
+        erase_slot(index);
+        ++taken;
+      } else {
+        ++index;
+      }
+    }
+    return taken;
+  }
+
+  /// Make room for a number of pending requests, so that inserting them doesn't allocate.
+  void
+  reserve(size_t number_of_requests)
+  {
+    size_t capacity = round_up_capacity(2 * number_of_requests);
+    if (capacity > slots_.size()) {
+      rehash(capacity);
+    }
+  }
+
+  size_t
+  size() const
+  {
+    return size_;
+  }
+
+  /// Return the number of slots, twice the number of requests which fit without reallocating.
+  size_t
+  capacity() const
+  {
+    return slots_.size();
+  }
+
+  /// Return the bytes allocated for the slots.
+  size_t
+  memory_usage() const
+  {
+    return slots_.capacity() * sizeof(Slot);
+  }
+
+private:
+  struct Slot
+  {
+    int64_t sequence_number = 0;
+    bool used = false;
+    ValueT value;
+  };
+
+  static size_t
+  round_up_capacity(size_t capacity)
+  {
+    size_t rounded = 2;
+    while (rounded < capacity) {
+      rounded *= 2;
+    }
+    return rounded;
+  }
+
+  size_t
+  home_slot(int64_t sequence_number) const
+  {
+    return static_cast<size_t>(sequence_number) & (slots_.size() - 1);
+  }
+
+  /// Return the slot of a sequence number, or the free slot ending its probe sequence.
+  size_t
+  find_slot(int64_t sequence_number) const
+  {
+    size_t mask = slots_.size() - 1;
+    size_t index = home_slot(sequence_number);
+    while (slots_[index].used && slots_[index].sequence_number != sequence_number) {
+      index = (index + 1) & mask;
+    }
+    return index;
+  }
+
+  /// Free a slot, moving back the following values of its probe sequences, without tombstones.
+  void
+  erase_slot(size_t index)
+  {
+    size_t mask = slots_.size() - 1;
+    size_t hole = index;
+    size_t next = (hole + 1) & mask;
+    while (slots_[next].used) {
+      size_t home = home_slot(slots_[next].sequence_number);
+      // The value can fill the hole unless its home slot is cyclically in (hole, next].
+      bool home_after_hole = hole <= next ?
+        (home > hole && home <= next) :
+        (home > hole || home <= next);
+      if (!home_after_hole) {
+        slots_[hole].sequence_number = slots_[next].sequence_number;
+        slots_[hole].value = std::move(slots_[next].value);
+        hole = next;
+      }
+      next = (next + 1) & mask;
+    }
+    slots_[hole].used = false;
+    slots_[hole].value = ValueT();
+    --size_;
+  }
+
+  void
+  rehash(size_t capacity)
+  {
+    std::vector<Slot> old_slots(capacity);
+    old_slots.swap(slots_);
+    for (auto & slot : old_slots) {
+      if (slot.used) {
+        Slot & new_slot = slots_[find_slot(slot.sequence_number)];
+        new_slot.sequence_number = slot.sequence_number;
+        new_slot.used = true;
+        new_slot.value = std::move(slot.value);
+      }
+    }
+  }
+
+  std::vector<Slot> slots_;
+  size_t size_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__PENDING_REQUEST_TABLE_HPP_
@@ -0,0 +1,93 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__DETAIL__QOS_EVENT_HANDLER_GROUP_HPP_
+#define RCLCPP__DETAIL__QOS_EVENT_HANDLER_GROUP_HPP_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rcl/wait.h"
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/qos_event.hpp"
+#include "rclcpp/visibility_control.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Waitable for the QoS event handlers of the entities of a node in one callback group.
+/**
+ * The executor sees one waitable instead of one per event handler.
+ * The handlers are held weakly, the ones of destroyed publishers and subscriptions are
+ * dropped, and nothing is added to the wait set if no handler is left.
+ *
+ * The handlers waited on are taken when the executor counts the events, so that the wait set
+ * is never sized for fewer events than are added, even if handlers are added concurrently.
+ */
+class QOSEventHandlerGroup : public rclcpp::Waitable
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(QOSEventHandlerGroup)
+
+  RCLCPP_PUBLIC
+  QOSEventHandlerGroup() = default;
+
+  RCLCPP_PUBLIC
+  ~QOSEventHandlerGroup() override = default;
+
+  RCLCPP_PUBLIC
+  void
+  add_event_handler(const std::shared_ptr<rclcpp::QOSEventHandlerBase> & event_handler);
+
+  /// Return the number of event handlers whose publisher or subscription still exists.
+  RCLCPP_PUBLIC
+  size_t
+  size() const;
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_ready_events() override;
+
+  RCLCPP_PUBLIC
+  bool
+  add_to_wait_set(rcl_wait_set_t * wait_set) override;
+
+  RCLCPP_PUBLIC
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override;
+
+  /// Execute the event handlers found ready by the last call to is_ready().
+  RCLCPP_PUBLIC
+  void
+  execute() override;
+
+private:
+  using EventHandlerSharedPtr = std::shared_ptr<rclcpp::QOSEventHandlerBase>;
+
+  mutable std::mutex mutex_;
+  mutable std::vector<std::weak_ptr<rclcpp::QOSEventHandlerBase>> event_handlers_;
+  std::vector<EventHandlerSharedPtr> waited_event_handlers_;
+  std::vector<EventHandlerSharedPtr> ready_event_handlers_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__QOS_EVENT_HANDLER_GROUP_HPP_
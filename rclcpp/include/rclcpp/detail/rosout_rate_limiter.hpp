@@ -0,0 +1,46 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__ROSOUT_RATE_LIMITER_HPP_
+#define RCLCPP__DETAIL__ROSOUT_RATE_LIMITER_HPP_
+
+#include <string>
+
+#include "rclcpp/rosout_rate_limit.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Limit the logs of a logger published to /rosout.
+/**
+ * The first call wraps the rcutils output handler in place, which rcl set up to publish to
+ * /rosout, with one applying the limits.
+ * Each call must be matched by a call to remove_rosout_rate_limit().
+ * If several nodes share the logger name, the limit of the first one applies.
+ */
+RCLCPP_PUBLIC
+void
+add_rosout_rate_limit(const std::string & logger_name, const rclcpp::RosoutRateLimit & limit);
+
+RCLCPP_PUBLIC
+void
+remove_rosout_rate_limit(const std::string & logger_name);
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__ROSOUT_RATE_LIMITER_HPP_
@@ -22,6 +22,9 @@
 
 #include "rcl/allocator.h"
 #include "rcl/arguments.h"
+#include "rcl/node.h"
+#include "rmw/types.h"
+#include "rosidl_runtime_c/message_type_support_struct.h"
 
 namespace rclcpp
 {
@@ -34,6 +37,30 @@ get_unparsed_ros_arguments(
   rcl_arguments_t * arguments,
   rcl_allocator_t allocator);
 
+/// Expand and remap a topic or service name like rcl does for the entities of a node.
+/**
+ * \param[in] global_arguments The arguments of the context, nullptr if the node doesn't use
+ *   them.
+ */
+std::string
+resolve_topic_or_service_name(
+  const std::string & name,
+  const char * node_name,
+  const char * node_namespace,
+  const rcl_node_options_t & node_options,
+  const rcl_arguments_t * global_arguments,
+  bool is_service);
+
+/// Return a key identifying the resolved topic name, the message type and the QoS.
+/**
+ * Used to find the publishers or subscriptions which can share an rcl entity.
+ */
+std::string
+topic_endpoint_key(
+  const std::string & resolved_topic_name,
+  const rosidl_message_type_support_t & type_support_handle,
+  const rmw_qos_profile_t & qos);
+
 }  // namespace detail
 }  // namespace rclcpp
 
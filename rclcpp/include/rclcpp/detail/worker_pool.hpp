@@ -0,0 +1,94 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__DETAIL__WORKER_POOL_HPP_
+#define RCLCPP__DETAIL__WORKER_POOL_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace detail
+{
+
+/// Fixed number of threads running the tasks of a queue, in the order they were posted.
+/**
+ * The destructor stops the threads once they finished their current task, the tasks still in
+ * the queue are dropped.
+ * It may be called by one of the threads, e.g. when a task releases the last reference to the
+ * owner of the pool, that thread then ends after its task.
+ */
+class WorkerPool
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(WorkerPool)
+
+  using Task = std::function<void ()>;
+
+  /// Start the threads.
+  /**
+   * \throws std::invalid_argument if the number of threads is zero.
+   */
+  RCLCPP_PUBLIC
+  explicit WorkerPool(size_t number_of_threads);
+
+  RCLCPP_PUBLIC
+  ~WorkerPool();
+
+  /// Queue a task, run by the first thread available.
+  RCLCPP_PUBLIC
+  void
+  post(Task task);
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_threads() const;
+
+  /// Return the number of tasks waiting for a thread.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_queued_tasks() const;
+
+private:
+  RCLCPP_DISABLE_COPY(WorkerPool)
+
+  /// Shared with the threads, so a thread destroying the pool can still end its loop.
+  struct State
+  {
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<Task> tasks;
+    bool stopped = false;
+  };
+
+  static void
+  run(std::shared_ptr<State> state);
+
+  std::shared_ptr<State> state_;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__DETAIL__WORKER_POOL_HPP_
@@ -0,0 +1,83 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ENTITY_CAPACITIES_HPP_
+#define RCLCPP__ENTITY_CAPACITIES_HPP_
+
+#include <cstddef>
+#include <string>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Number of entities of a static system, to size their storage once at startup.
+/**
+ * Set in InitOptions::entity_capacities, the intra-process manager of the context and the
+ * executors using the context are sized for these entities, so adding them doesn't resize the
+ * tables, handle vectors and wait sets once the system runs.
+ * More entities than the capacities still work, the storage then grows.
+ *
+ * The counts include the entities added by the waitables to the wait sets, e.g. the
+ * subscriptions of the action servers, and the ones created by rclcpp for each node, e.g.
+ * its parameter services.
+ * Default constructed capacities don't preallocate anything.
+ */
+struct EntityCapacities
+{
+  size_t nodes = 0;
+  size_t publishers = 0;
+  size_t subscriptions = 0;
+  size_t timers = 0;
+  size_t services = 0;
+  size_t clients = 0;
+  size_t waitables = 0;
+  /// Guard conditions other than the one of each node and of each executor.
+  size_t guard_conditions = 0;
+  size_t events = 0;
+
+  /// Return true if no capacity is set.
+  bool
+  empty() const
+  {
+    return 0u == nodes && 0u == publishers && 0u == subscriptions && 0u == timers &&
+           0u == services && 0u == clients && 0u == waitables && 0u == guard_conditions &&
+           0u == events;
+  }
+};
+
+/// Read the capacities from the static description of a system.
+/**
+ * The file has a `name: count` line for each capacity set, with the names of the members of
+ * EntityCapacities, e.g.:
+ *
+ *     nodes: 4
+ *     publishers: 32
+ *     subscriptions: 48
+ *
+ * Empty lines and the lines starting with `#` are ignored.
+ *
+ * \param[in] path the path of the file.
+ * \return the capacities, 0 for the ones not in the file.
+ * \throws std::runtime_error if the file can't be read, or a line isn't a known capacity with
+ *   a count.
+ */
+RCLCPP_PUBLIC
+EntityCapacities
+load_entity_capacities(const std::string & path);
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ENTITY_CAPACITIES_HPP_
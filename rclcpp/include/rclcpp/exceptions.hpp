@@ -211,6 +211,23 @@ public:
   : std::runtime_error("event already registered") {}
 };
 
+/// Thrown by the future of a client request which got no response within its timeout.
+class RequestTimeoutError : public std::runtime_error
+{
+public:
+  RequestTimeoutError()
+  : std::runtime_error("the request timed out before its response arrived") {}
+};
+
+/// Thrown when an entity is created after Context::lock_entity_creation().
+class EntityCreationLockedError : public std::runtime_error
+{
+public:
+  explicit EntityCreationLockedError(const std::string & entity_kind)
+  : std::runtime_error(
+      "cannot create a " + entity_kind + ", the creation of entities is locked in this context") {}
+};
+
 /// Thrown if passed parameters are inconsistent or invalid
 class InvalidParametersException : public std::runtime_error
 {
@@ -48,6 +48,15 @@ public:
   void
   add_subscription(rclcpp::SubscriptionBase::SharedPtr subscription);
 
+  /// Add a subscription collected from a callback group, to be waited on.
+  /**
+   * A reader shared by several subscriptions is only added once, through the first of them.
+   * \sa SubscriptionBase::has_shared_reader()
+   */
+  RCLCPP_PUBLIC
+  void
+  add_collected_subscription(rclcpp::SubscriptionBase::SharedPtr subscription);
+
   RCLCPP_PUBLIC
   void
   add_timer(rclcpp::TimerBase::SharedPtr timer);
@@ -18,21 +18,33 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
 #include <cstdlib>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <list>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include "rcl/guard_condition.h"
 #include "rcl/wait.h"
 
 #include "rclcpp/contexts/default_context.hpp"
+#include "rclcpp/deferred_call_queue.hpp"
+#include "rclcpp/entity_capacities.hpp"
+#include "rclcpp/executor_instrumentation.hpp"
+#include "rclcpp/future_waiter.hpp"
 #include "rclcpp/memory_strategies.hpp"
 #include "rclcpp/memory_strategy.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/thread_options.hpp"
+#include "rclcpp/timer_manager.hpp"
 #include "rclcpp/utilities.hpp"
 #include "rclcpp/visibility_control.hpp"
 
@@ -71,12 +83,65 @@ struct ExecutorArgs
   ExecutorArgs()
   : memory_strategy(memory_strategies::create_default_strategy()),
     context(rclcpp::contexts::default_context::get_global_default_context()),
-    max_conditions(0)
+    max_conditions(0),
+    manage_timers(false),
+    timer_thread(false),
+    timer_thread_spin_threshold(std::chrono::microseconds(200)),
+    busy_poll_duration(0),
+    busy_poll_pause(false)
   {}
 
   memory_strategy::MemoryStrategy::SharedPtr memory_strategy;
   std::shared_ptr<rclcpp::Context> context;
   size_t max_conditions;
+  /// Options of the threads used by multi-threaded executors, entry i for the thread i.
+  /**
+   * Threads without an entry are left as they were created.
+   */
+  std::vector<rclcpp::ThreadOptions> thread_options;
+  /// True to schedule the steady timers with a TimerManager, instead of waiting on each of them.
+  /**
+   * The wait is only given the time until the nearest deadline, and the expired timers are
+   * executed in deadline order, which scales to a large number of timers.
+   * It is used by the executors waiting with Executor::wait_for_work(), e.g. the single and
+   * multi-threaded executors, with a memory strategy supporting it, like the default one.
+   */
+  bool manage_timers;
+  /// True to execute the managed timers in a dedicated thread of the executor, implies
+  /// manage_timers.
+  /**
+   * The thread sleeps until shortly before the nearest deadline, then spins for the remaining
+   * time, so the callbacks are called with a much lower latency and jitter than given by the
+   * sleep granularity of the OS.
+   * It executes the timers while the executor is spinning, concurrently with the threads of the
+   * executor, and respects the mutually exclusive callback groups.
+   */
+  bool timer_thread;
+  /// Time spent spinning by the timer thread before each deadline, 0 to only sleep.
+  std::chrono::nanoseconds timer_thread_spin_threshold;
+  /// Options of the timer thread, e.g. a real-time priority.
+  rclcpp::ThreadOptions timer_thread_options;
+  /// Time spent polling for work before blocking in rcl_wait(), 0 to block right away,
+  /// negative to never block.
+  /**
+   * The executor polls with zero timeout waits, which avoids the wake up latency of blocking in
+   * rcl_wait() at the cost of a busy core, so it is meant for executors pinned to isolated cores.
+   * The time spent polling is reported as ExecutorPhase::Poll by the instrumentation.
+   * It is used by the executors waiting with Executor::wait_for_work(), e.g. the single and
+   * multi-threaded executors.
+   */
+  std::chrono::nanoseconds busy_poll_duration;
+  /// True to execute a CPU pause instruction between the polls, which saves power and leaves
+  /// the resources of the core to its hyperthread.
+  bool busy_poll_pause;
+  /// Entities of a static system the executor is sized for, the
+  /// InitOptions::entity_capacities of the context if empty.
+  /**
+   * The handles of the memory strategy and the wait set are allocated for them at construction.
+   * The wait set then only grows when the entities outnumber it, instead of being resized on
+   * each wait, and its unused entries are skipped by rcl_wait().
+   */
+  EntityCapacities entity_capacities;
 };
 
 static inline ExecutorArgs create_default_executor_arguments()
@@ -84,6 +149,18 @@ static inline ExecutorArgs create_default_executor_arguments()
   return ExecutorArgs();
 }
 
+/// Limits of the work done by one call of Executor::spin_some_budgeted().
+struct SpinBudget
+{
+  /// Maximum number of executables run, 0 for no limit.
+  size_t max_executables = 0;
+  /// Maximum time spent running executables, 0 for no limit.
+  /**
+   * It is checked before each executable, so a long callback can exceed it.
+   */
+  std::chrono::nanoseconds max_duration = std::chrono::nanoseconds(0);
+};
+
 /// Coordinate the order and timing of available communication tasks.
 /**
  * Executor provides spin functions (including spin_node_once and spin_some).
@@ -206,6 +283,27 @@ public:
   virtual void
   spin_some(std::chrono::nanoseconds max_duration = std::chrono::nanoseconds(0));
 
+  /// Complete the available queued work without blocking, within a budget and in fair rounds.
+  /**
+   * Like spin_some(), the ready work is collected once, without waiting.
+   * It is then executed in rounds, where each callback group runs at most one executable, and
+   * where the kind of entity looked at first, timer, subscription, service, client or waitable,
+   * rotates after each executable, so neither a busy callback group nor a busy kind of entity
+   * can use the whole budget.
+   * The rotation carries over to the next call, so a loop calling it with a small budget, e.g.
+   * to interleave custom work, still serves all the entities in turn.
+   *
+   * The callback groups which ran in the current round can't be taken from by the other threads
+   * of the executor, e.g. the timer thread, until the round ends.
+   *
+   * \param[in] budget The limits of the work done by this call.
+   * \return The number of executables run.
+   * \throws std::runtime_error if the executor is already spinning.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  spin_some_budgeted(const SpinBudget & budget);
+
   RCLCPP_PUBLIC
   virtual void
   spin_once(std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1));
@@ -228,17 +326,170 @@ public:
   {
     // TODO(wjwwood): does not work recursively; can't call spin_node_until_future_complete
     // inside a callback executed by an executor.
+    return spin_until_done(
+      [&future]() {
+        return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+      },
+      std::chrono::duration_cast<std::chrono::nanoseconds>(timeout));
+  }
+
+  /// Spin (blocking) until all the futures are complete, it times out waiting, or rclcpp is
+  /// interrupted.
+  /**
+   * The executor wakes up as each future is completed, like in spin_until_future_complete(),
+   * and each future is checked until it is complete, but no longer, so waiting for many requests
+   * doesn't check them all every time one of them completes.
+   *
+   * \param[in] futures The futures to wait on, SUCCESS if there is none.
+   * \param[in] timeout Optional timeout, `-1` is block forever, `0` is non-blocking.
+   * \return The return code, one of `SUCCESS`, `INTERRUPTED`, or `TIMEOUT`.
+   */
+  template<typename ResponseT, typename TimeRepT = int64_t, typename TimeT = std::milli>
+  FutureReturnCode
+  spin_until_all_complete(
+    const std::vector<std::shared_future<ResponseT>> & futures,
+    std::chrono::duration<TimeRepT, TimeT> timeout = std::chrono::duration<TimeRepT, TimeT>(-1))
+  {
+    size_t first_incomplete = 0;
+    return spin_until_done(
+      [&futures, &first_incomplete]() {
+        // The futures before first_incomplete stay complete.
+        for (; first_incomplete < futures.size(); ++first_incomplete) {
+          auto status = futures[first_incomplete].wait_for(std::chrono::seconds(0));
+          if (status != std::future_status::ready) {
+            return false;
+          }
+        }
+        return true;
+      },
+      std::chrono::duration_cast<std::chrono::nanoseconds>(timeout));
+  }
+
+  /// Spin (blocking) until any of the futures is complete, it times out waiting, or rclcpp is
+  /// interrupted.
+  /**
+   * \param[in] futures The futures to wait on.
+   * \param[in] timeout Optional timeout, `-1` is block forever, `0` is non-blocking.
+   * \param[out] completed_index If not nullptr and SUCCESS is returned, set to the index of the
+   *   first complete future.
+   * \return The return code, one of `SUCCESS`, `INTERRUPTED`, or `TIMEOUT`.
+   * \throws std::invalid_argument if there is no future.
+   */
+  template<typename ResponseT, typename TimeRepT = int64_t, typename TimeT = std::milli>
+  FutureReturnCode
+  spin_until_any_complete(
+    const std::vector<std::shared_future<ResponseT>> & futures,
+    std::chrono::duration<TimeRepT, TimeT> timeout = std::chrono::duration<TimeRepT, TimeT>(-1),
+    size_t * completed_index = nullptr)
+  {
+    if (futures.empty()) {
+      throw std::invalid_argument("spin_until_any_complete() needs at least one future");
+    }
+    return spin_until_done(
+      [&futures, completed_index]() {
+        for (size_t i = 0; i < futures.size(); ++i) {
+          if (futures[i].wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            if (completed_index) {
+              *completed_index = i;
+            }
+            return true;
+          }
+        }
+        return false;
+      },
+      std::chrono::duration_cast<std::chrono::nanoseconds>(timeout));
+  }
+
+  /// Cancel any running spin* function, causing it to return.
+  /* This function can be called asynchonously from any thread. */
+  RCLCPP_PUBLIC
+  void
+  cancel();
+
+  /// Support dynamic switching of the memory strategy.
+  /**
+   * Switching the memory strategy while the executor is spinning in another threading could have
+   * unintended consequences.
+   * \param[in] memory_strategy Shared pointer to the memory strategy to set.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_memory_strategy(memory_strategy::MemoryStrategy::SharedPtr memory_strategy);
 
-    // Check the future before entering the while loop.
-    // If the future is already complete, don't try to spin.
-    std::future_status status = future.wait_for(std::chrono::seconds(0));
-    if (status == std::future_status::ready) {
+  /// Set the instrumentation recording where this executor spends its time, nullptr to disable.
+  /**
+   * \param[in] instrumentation Shared pointer to the instrumentation, may be shared by executors.
+   * \throws std::runtime_error if the executor is spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_instrumentation(ExecutorInstrumentation::SharedPtr instrumentation);
+
+  RCLCPP_PUBLIC
+  ExecutorInstrumentation::SharedPtr
+  get_instrumentation() const;
+
+  /// Enable counting the CPU time of the callbacks in their callback groups.
+  /**
+   * The time is read before and after each callback, see CallbackGroup::get_cpu_time().
+   * With instrumentation, the CPU time of each entity is recorded too, see
+   * ExecutorInstrumentation::record_cpu_time().
+   * Each reading of the thread CPU clock is a system call on Linux (a few hundred nanoseconds),
+   * so it is disabled by default.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_callback_group_cpu_time_measurement(bool enabled);
+
+  /// Call a function once after a delay, from the threads spinning the executor.
+  /**
+   * Unlike a one-shot wall timer, the call has no rcl timer, isn't added to a node and doesn't
+   * cause the entities of the executor to be collected again; it is pushed to a min-heap of
+   * the executor, and the wait is only given the time until the nearest deadline.
+   * It is used by the executors waiting with Executor::wait_for_work(), e.g. the single and
+   * multi-threaded executors.
+   *
+   * \param[in] delay the time after which the function is called, on the steady clock.
+   * \param[in] callback the function.
+   * \param[in] group the callback group the function is executed in, it respects the mutually
+   *   exclusive groups; the call is dropped if the group is destroyed before.
+   * \return the handle of the call, to be given to cancel_call().
+   * \throws std::invalid_argument if the callback or the group is null.
+   */
+  RCLCPP_PUBLIC
+  uint64_t
+  call_later(
+    std::chrono::nanoseconds delay,
+    std::function<void()> callback,
+    rclcpp::callback_group::CallbackGroup::SharedPtr group);
+
+  /// Cancel a call of call_later() which didn't start yet.
+  /**
+   * \return true if the call was canceled, false if it already started or was canceled.
+   */
+  RCLCPP_PUBLIC
+  bool
+  cancel_call(uint64_t handle);
+
+protected:
+  /// Spin until `is_done` returns true, it times out waiting, or rclcpp is interrupted.
+  /**
+   * The executor wakes up when a future is completed, see FutureWaiter, and `is_done` is called
+   * before spinning, then after each item of work.
+   */
+  template<typename DoneT>
+  FutureReturnCode
+  spin_until_done(DoneT is_done, std::chrono::nanoseconds timeout_ns)
+  {
+    // Wake up as soon as a future is completed, even from another thread.
+    FutureWaiter future_waiter(&interrupt_guard_condition_);
+
+    // If it is already done, don't try to spin.
+    if (is_done()) {
       return FutureReturnCode::SUCCESS;
     }
 
     auto end_time = std::chrono::steady_clock::now();
-    std::chrono::nanoseconds timeout_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
-      timeout);
     if (timeout_ns > std::chrono::nanoseconds::zero()) {
       end_time += timeout_ns;
     }
@@ -247,9 +498,7 @@ public:
     while (rclcpp::ok(this->context_)) {
       // Do one item of work.
       spin_once(timeout_left);
-      // Check if the future is set, return SUCCESS if it is.
-      status = future.wait_for(std::chrono::seconds(0));
-      if (status == std::future_status::ready) {
+      if (is_done()) {
         return FutureReturnCode::SUCCESS;
       }
       // If the original timeout is < 0, then this is blocking, never TIMEOUT.
@@ -265,27 +514,10 @@ public:
       timeout_left = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - now);
     }
 
-    // The future did not complete before ok() returned false, return INTERRUPTED.
+    // Not done before ok() returned false, return INTERRUPTED.
     return FutureReturnCode::INTERRUPTED;
   }
 
-  /// Cancel any running spin* function, causing it to return.
-  /* This function can be called asynchonously from any thread. */
-  RCLCPP_PUBLIC
-  void
-  cancel();
-
-  /// Support dynamic switching of the memory strategy.
-  /**
-   * Switching the memory strategy while the executor is spinning in another threading could have
-   * unintended consequences.
-   * \param[in] memory_strategy Shared pointer to the memory strategy to set.
-   */
-  RCLCPP_PUBLIC
-  void
-  set_memory_strategy(memory_strategy::MemoryStrategy::SharedPtr memory_strategy);
-
-protected:
   RCLCPP_PUBLIC
   void
   spin_node_once_nanoseconds(
@@ -303,28 +535,34 @@ protected:
   RCLCPP_PUBLIC
   static void
   execute_subscription(
-    rclcpp::SubscriptionBase::SharedPtr subscription);
+    const rclcpp::SubscriptionBase::SharedPtr & subscription);
 
   RCLCPP_PUBLIC
   static void
-  execute_timer(rclcpp::TimerBase::SharedPtr timer);
+  execute_timer(const rclcpp::TimerBase::SharedPtr & timer);
 
   RCLCPP_PUBLIC
   static void
-  execute_service(rclcpp::ServiceBase::SharedPtr service);
+  execute_service(const rclcpp::ServiceBase::SharedPtr & service);
 
   RCLCPP_PUBLIC
   static void
-  execute_client(rclcpp::ClientBase::SharedPtr client);
+  execute_client(const rclcpp::ClientBase::SharedPtr & client);
 
   RCLCPP_PUBLIC
   void
   wait_for_work(std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1));
 
+  /// Return the node of a callback group, from an index of the callback groups of the nodes.
+  /**
+   * The index is updated when nodes are added and removed, and when a callback group is not
+   * found in it, e.g. because it was created after its node was added.
+   */
   RCLCPP_PUBLIC
   rclcpp::node_interfaces::NodeBaseInterface::SharedPtr
   get_node_by_group(rclcpp::callback_group::CallbackGroup::SharedPtr group);
 
+  /// Return the callback group of a timer, from an index of the timers found so far.
   RCLCPP_PUBLIC
   rclcpp::callback_group::CallbackGroup::SharedPtr
   get_group_by_timer(rclcpp::TimerBase::SharedPtr timer);
@@ -339,6 +577,11 @@ protected:
     AnyExecutable & any_executable,
     std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1));
 
+  /// Return the options given for a thread in ExecutorArgs, or default options if there are none.
+  RCLCPP_PUBLIC
+  rclcpp::ThreadOptions
+  get_thread_options(size_t thread_index) const;
+
   /// Spinning state, used to prevent multi threaded calls to spin and to cancel blocking spins.
   std::atomic_bool spinning;
 
@@ -349,7 +592,7 @@ protected:
   rcl_wait_set_t wait_set_ = rcl_get_zero_initialized_wait_set();
 
   // Mutex to protect the subsequent memory_strategy_.
-  std::mutex memory_strategy_mutex_;
+  mutable std::mutex memory_strategy_mutex_;
 
   /// The memory strategy: an interface for handling user-defined memory allocation strategies.
   memory_strategy::MemoryStrategy::SharedPtr memory_strategy_;
@@ -357,10 +600,102 @@ protected:
   /// The context associated with this executor.
   std::shared_ptr<rclcpp::Context> context_;
 
+  /// The options for the threads of multi-threaded executors.
+  std::vector<rclcpp::ThreadOptions> thread_options_;
+
+  /// Optional instrumentation, nullptr when disabled.
+  ExecutorInstrumentation::SharedPtr instrumentation_;
+
+  /// See set_callback_group_cpu_time_measurement().
+  std::atomic_bool measure_group_cpu_time_;
+
+  /// Scheduler of the steady timers, nullptr unless ExecutorArgs::manage_timers is set.
+  TimerManager::SharedPtr timer_manager_;
+
+  /// Calls scheduled with call_later().
+  DeferredCallQueue deferred_calls_;
+
+  /// See ExecutorArgs::entity_capacities, empty if the wait set is resized on each wait.
+  EntityCapacities entity_capacities_;
+
+  /// Serialize the claims of the callback groups by the timer thread and the executor threads.
+  std::mutex claim_mutex_;
+
   RCLCPP_DISABLE_COPY(Executor)
 
   std::list<rclcpp::node_interfaces::NodeBaseInterface::WeakPtr> weak_nodes_;
   std::list<const rcl_guard_condition_t *> guard_conditions_;
+
+private:
+  struct GroupIndexEntry
+  {
+    rclcpp::callback_group::CallbackGroup::WeakPtr group;
+    rclcpp::node_interfaces::NodeBaseInterface::WeakPtr node;
+  };
+
+  struct TimerIndexEntry
+  {
+    rclcpp::TimerBase::WeakPtr timer;
+    rclcpp::callback_group::CallbackGroup::WeakPtr group;
+  };
+
+  /// Add the callback groups of the node to the group index, index_mutex_ must be locked.
+  void
+  index_callback_groups(const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr & node);
+
+  /// Set the group and node of a managed timer, if its group can be taken from.
+  bool
+  claim_managed_timer(const rclcpp::TimerBase::SharedPtr & timer, AnyExecutable & any_executable);
+
+  /// Set the group and node of an executable, if the group can be taken from.
+  bool
+  claim_group(
+    const rclcpp::callback_group::CallbackGroup::SharedPtr & group,
+    AnyExecutable & any_executable);
+
+  /// Execute the managed timers at their deadlines, until timer_thread_stop_ is set.
+  void
+  run_timer_thread();
+
+  /// Kinds of entities, in the order get_next_ready_executable() looks at them.
+  enum EntityKind : size_t
+  {
+    TimerKind,
+    SubscriptionKind,
+    ServiceKind,
+    ClientKind,
+    WaitableKind,
+    EntityKindCount
+  };
+
+  /// Take the next ready executable, looking at the kinds of entities from first_kind on.
+  /**
+   * \param[out] kind The kind of the executable taken.
+   */
+  bool
+  get_next_ready_executable_from(
+    AnyExecutable & any_executable, size_t first_kind, size_t & kind);
+
+  /// Kind of entity looked at first by the next spin_some_budgeted().
+  size_t next_entity_kind_;
+
+  /// Protects the group and timer indexes, which are also updated by the lookups.
+  std::mutex index_mutex_;
+  std::unordered_map<const rclcpp::callback_group::CallbackGroup *, GroupIndexEntry> group_index_;
+  std::unordered_map<const rclcpp::TimerBase *, TimerIndexEntry> timer_index_;
+
+  /// Dedicated thread executing the managed timers, see ExecutorArgs::timer_thread.
+  std::thread timer_thread_;
+  std::atomic_bool timer_thread_stop_;
+  std::chrono::nanoseconds timer_thread_spin_threshold_;
+
+  /// Wait with zero timeout waits for up to busy_poll_duration_, then block in rcl_wait().
+  rcl_ret_t
+  poll_for_work(std::chrono::nanoseconds timeout, ExecutorInstrumentation * instrumentation);
+
+  /// See ExecutorArgs::busy_poll_duration and ExecutorArgs::busy_poll_pause.
+  std::chrono::nanoseconds busy_poll_duration_;
+  bool busy_poll_pause_;
 };
 
 }  // namespace executor
@@ -0,0 +1,220 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTOR_INSTRUMENTATION_HPP_
+#define RCLCPP__EXECUTOR_INSTRUMENTATION_HPP_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executor
+{
+
+/// Histogram of durations with power of two buckets.
+/**
+ * Bucket i counts the durations d with 2^i <= d / 1ns < 2^(i+1), bucket 0 also counts zero.
+ * Durations which are too long for the last bucket are counted in the last bucket.
+ */
+class LatencyHistogram
+{
+public:
+  static constexpr size_t number_of_buckets = 40;
+
+  RCLCPP_PUBLIC
+  LatencyHistogram();
+
+  RCLCPP_PUBLIC
+  void
+  record(std::chrono::nanoseconds duration);
+
+  RCLCPP_PUBLIC
+  uint64_t
+  count() const;
+
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  min() const;
+
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  max() const;
+
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  mean() const;
+
+  /// Return the sum of the durations, e.g. to compare the time spent in the phases.
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  total() const;
+
+  /// Return an upper bound of the given percentile, from the bucket it falls into.
+  /**
+   * \param[in] percentile Percentile between 0 and 100.
+   */
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  percentile(double percentile) const;
+
+  RCLCPP_PUBLIC
+  const std::array<uint64_t, number_of_buckets> &
+  buckets() const;
+
+private:
+  std::array<uint64_t, number_of_buckets> buckets_;
+  uint64_t count_;
+  std::chrono::nanoseconds sum_;
+  std::chrono::nanoseconds min_;
+  std::chrono::nanoseconds max_;
+};
+
+/// Phases of the executor's hot path.
+enum class ExecutorPhase
+{
+  /// Blocked in rcl_wait().
+  Wait,
+  /// Collecting the entities of the nodes and filling the wait set.
+  Collect,
+  /// Taking messages, requests and responses from the middleware.
+  Take,
+  /// Executing an executable, including taking its data and running its callback.
+  Execute,
+  /// Polling for work with zero timeout waits, see ExecutorArgs::busy_poll_duration.
+  Poll
+};
+
+/// Records where an executor spends its time.
+/**
+ * Set it on an executor with Executor::set_instrumentation().
+ * Without instrumentation the executor only checks a null pointer at each probe, and when rclcpp
+ * is built with RCLCPP_EXECUTOR_INSTRUMENTATION=OFF the probes are compiled out entirely.
+ *
+ * The probes are in the code paths of the base Executor: wait_for_work() and
+ * execute_any_executable(), which are used by the single- and multi-threaded executors.
+ * Executors which execute entities directly only report the phases they go through.
+ *
+ * All functions are thread-safe.
+ */
+class ExecutorInstrumentation
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(ExecutorInstrumentation)
+
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  /// Histogram of the callback durations of one entity.
+  struct EntityHistogram
+  {
+    /// Kind and name of the entity, e.g. "subscription /chatter" or "timer 0x5581d2a8".
+    std::string name;
+    LatencyHistogram histogram;
+  };
+
+  RCLCPP_PUBLIC
+  ExecutorInstrumentation();
+
+  RCLCPP_PUBLIC
+  virtual ~ExecutorInstrumentation();
+
+  RCLCPP_PUBLIC
+  virtual void
+  record_phase(ExecutorPhase phase, std::chrono::nanoseconds duration);
+
+  /// Record the duration of executing the entity, the name is only used the first time.
+  RCLCPP_PUBLIC
+  virtual void
+  record_execution(
+    const void * entity, const char * kind, const char * name,
+    std::chrono::nanoseconds duration);
+
+  /// Record the CPU time the thread spent executing the entity.
+  /**
+   * Only called when the executor measures CPU time, see
+   * Executor::set_callback_group_cpu_time_measurement().
+   * The name is only used the first time.
+   */
+  RCLCPP_PUBLIC
+  virtual void
+  record_cpu_time(
+    const void * entity, const char * kind, const char * name,
+    std::chrono::nanoseconds cpu_time);
+
+  /// Record the time between the end of the wait which found a message ready and its dispatch.
+  RCLCPP_PUBLIC
+  virtual void
+  record_dispatch_latency(const char * topic_name, std::chrono::nanoseconds latency);
+
+  /// Remember when the last wait returned, see get_last_wait_end().
+  RCLCPP_PUBLIC
+  void
+  set_last_wait_end(TimePoint time);
+
+  RCLCPP_PUBLIC
+  TimePoint
+  get_last_wait_end() const;
+
+  RCLCPP_PUBLIC
+  LatencyHistogram
+  get_phase_histogram(ExecutorPhase phase) const;
+
+  RCLCPP_PUBLIC
+  std::vector<EntityHistogram>
+  get_execution_histograms() const;
+
+  /// Return the CPU time histograms of the entities, see record_cpu_time().
+  RCLCPP_PUBLIC
+  std::vector<EntityHistogram>
+  get_cpu_time_histograms() const;
+
+  /// Return the dispatch latency histograms by topic name.
+  RCLCPP_PUBLIC
+  std::unordered_map<std::string, LatencyHistogram>
+  get_dispatch_latency_histograms() const;
+
+  /// Forget everything recorded so far.
+  RCLCPP_PUBLIC
+  void
+  reset();
+
+  /// Return a human readable summary, one line per histogram.
+  RCLCPP_PUBLIC
+  std::string
+  to_string() const;
+
+private:
+  RCLCPP_DISABLE_COPY(ExecutorInstrumentation)
+
+  mutable std::mutex mutex_;
+  std::array<LatencyHistogram, 5> phase_histograms_;
+  std::unordered_map<const void *, EntityHistogram> execution_histograms_;
+  std::unordered_map<const void *, EntityHistogram> cpu_time_histograms_;
+  std::unordered_map<std::string, LatencyHistogram> dispatch_latency_histograms_;
+  std::atomic<int64_t> last_wait_end_ns_;
+};
+
+}  // namespace executor
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTOR_INSTRUMENTATION_HPP_
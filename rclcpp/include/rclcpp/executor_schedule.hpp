@@ -0,0 +1,188 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTOR_SCHEDULE_HPP_
+#define RCLCPP__EXECUTOR_SCHEDULE_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "rclcpp/executor_instrumentation.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executor
+{
+
+/// One execution of an entity by an executor, or one of its waits, in a ScheduleTrace.
+struct ScheduleEvent
+{
+  /// Entity of the waits of the executors.
+  static constexpr uint32_t wait_entity = 0xffffffff;
+
+  /// Start in nanoseconds since the start of the capture.
+  uint64_t start;
+  /// Duration in nanoseconds.
+  uint64_t duration;
+  /// Index of the entity in ScheduleTrace::entities, or wait_entity.
+  uint32_t entity;
+  /// Index of the executor thread, in the order of their first event.
+  uint32_t thread;
+};
+
+/// Dispatch decisions and callback durations captured from an executor by a ScheduleRecorder.
+struct ScheduleTrace
+{
+  /// Names of the entities, like ExecutorInstrumentation::EntityHistogram::name.
+  std::vector<std::string> entities;
+  /// Events in the order of their start.
+  std::vector<ScheduleEvent> events;
+
+  /// Write the trace to a file, in a compact binary format in the byte order of the host.
+  /**
+   * \throws std::runtime_error if the file can't be written.
+   */
+  RCLCPP_PUBLIC
+  void
+  save(const std::string & path) const;
+
+  /// Read a trace written by save().
+  /**
+   * \throws std::runtime_error if the file can't be read or isn't a trace.
+   */
+  RCLCPP_PUBLIC
+  static ScheduleTrace
+  load(const std::string & path);
+
+  /// Return the histograms of the durations of each entity, without the waits.
+  /**
+   * E.g. to compare the trace returned by ScheduleReplayer::replay() with the captured one.
+   */
+  RCLCPP_PUBLIC
+  std::vector<ExecutorInstrumentation::EntityHistogram>
+  get_execution_histograms() const;
+};
+
+/// Instrumentation capturing the schedule of an executor, see ScheduleTrace.
+/**
+ * Set it on an executor with Executor::set_instrumentation(), like ExecutorInstrumentation,
+ * whose histograms it still records.
+ * In addition it appends an event of 24 bytes for each execution and each wait to a ring of
+ * events, which keeps the last ones so a capture can run in the field until a regression shows
+ * up.
+ */
+class ScheduleRecorder : public ExecutorInstrumentation
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(ScheduleRecorder)
+
+  /// Constructor.
+  /**
+   * \param[in] max_events Number of events kept, the oldest ones are overwritten.
+   * \throws std::invalid_argument if max_events is zero.
+   */
+  RCLCPP_PUBLIC
+  explicit ScheduleRecorder(size_t max_events = 1024 * 1024);
+
+  RCLCPP_PUBLIC
+  void
+  record_phase(ExecutorPhase phase, std::chrono::nanoseconds duration) override;
+
+  RCLCPP_PUBLIC
+  void
+  record_execution(
+    const void * entity, const char * kind, const char * name,
+    std::chrono::nanoseconds duration) override;
+
+  /// Return the events kept, in the order of their start.
+  RCLCPP_PUBLIC
+  ScheduleTrace
+  get_trace() const;
+
+  /// Return the number of events overwritten since the start of the capture.
+  RCLCPP_PUBLIC
+  uint64_t
+  get_overwritten_count() const;
+
+private:
+  RCLCPP_DISABLE_COPY(ScheduleRecorder)
+
+  /// Append an event which ends now.
+  void
+  append(uint32_t entity, std::chrono::nanoseconds duration);
+
+  mutable std::mutex events_mutex_;
+  const TimePoint capture_start_;
+  const size_t max_events_;
+  std::vector<ScheduleEvent> events_;
+  /// Position of the next event once the ring is full.
+  size_t next_event_;
+  uint64_t overwritten_count_;
+  std::unordered_map<const void *, uint32_t> entity_indices_;
+  std::vector<std::string> entities_;
+  std::vector<std::thread::id> threads_;
+};
+
+/// Replays the callback sequence of a ScheduleTrace on the calling thread.
+/**
+ * Like a StaticSingleThreadedExecutor with a fixed list of entities, the replayer executes the
+ * callback bound to each entity in the order of the trace, so that the changes of a scheduler
+ * or of callbacks can be compared on a captured workload: replay() returns the trace of the
+ * replay, with the measured durations.
+ * The entities without callback are replaced by a busy loop of their captured duration.
+ * The events of all the executor threads are replayed on the calling thread.
+ */
+class ScheduleReplayer
+{
+public:
+  RCLCPP_PUBLIC
+  explicit ScheduleReplayer(ScheduleTrace trace);
+
+  /// Execute a callback for the events of an entity.
+  /**
+   * \param[in] entity_name Name of the entity in ScheduleTrace::entities.
+   * \param[in] callback Callback to execute for each event of the entity.
+   * \throws std::invalid_argument if the trace has no such entity.
+   */
+  RCLCPP_PUBLIC
+  void
+  bind(const std::string & entity_name, std::function<void()> callback);
+
+  /// Replay the events of the trace.
+  /**
+   * \param[in] keep_timing True to start each event no earlier than its captured start, after
+   *   the start of the replay, false to execute them back to back.
+   * \return The trace of the replay, without the waits.
+   */
+  RCLCPP_PUBLIC
+  ScheduleTrace
+  replay(bool keep_timing = false);
+
+private:
+  ScheduleTrace trace_;
+  std::vector<std::function<void()>> callbacks_;
+};
+
+}  // namespace executor
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTOR_SCHEDULE_HPP_
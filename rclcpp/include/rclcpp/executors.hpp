@@ -17,10 +17,20 @@
 
 #include <future>
 #include <memory>
+#include <vector>
 
+#include "rclcpp/executors/callback_group_balancer.hpp"
+#include "rclcpp/executors/earliest_deadline_first_executor.hpp"
+#include "rclcpp/executors/events_executor.hpp"
 #include "rclcpp/executors/multi_threaded_executor.hpp"
+#include "rclcpp/executors/pollable_executor.hpp"
+#include "rclcpp/executors/priority_executor.hpp"
 #include "rclcpp/executors/single_threaded_executor.hpp"
+#include "rclcpp/executors/static_multi_threaded_executor.hpp"
 #include "rclcpp/executors/static_single_threaded_executor.hpp"
+#include "rclcpp/executors/stepping_executor.hpp"
+#include "rclcpp/executors/time_triggered_executor.hpp"
+#include "rclcpp/executors/work_stealing_multi_threaded_executor.hpp"
 #include "rclcpp/node.hpp"
 #include "rclcpp/utilities.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -51,8 +61,13 @@ spin(rclcpp::Node::SharedPtr node_ptr);
 namespace executors
 {
 
+using rclcpp::executors::EarliestDeadlineFirstExecutor;
+using rclcpp::executors::EventsExecutor;
 using rclcpp::executors::MultiThreadedExecutor;
+using rclcpp::executors::PriorityExecutor;
 using rclcpp::executors::SingleThreadedExecutor;
+using rclcpp::executors::StaticMultiThreadedExecutor;
+using rclcpp::executors::WorkStealingMultiThreadedExecutor;
 
 /// Spin (blocking) until the future is complete, it times out waiting, or rclcpp is interrupted.
 /**
@@ -122,6 +137,62 @@ spin_until_future_complete(
   return rclcpp::spin_until_future_complete(node_ptr->get_node_base_interface(), future, timeout);
 }
 
+/// Spin the node until all the futures are complete, see Executor::spin_until_all_complete().
+template<typename FutureT, typename TimeRepT = int64_t, typename TimeT = std::milli>
+rclcpp::executor::FutureReturnCode
+spin_until_all_complete(
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+  const std::vector<std::shared_future<FutureT>> & futures,
+  std::chrono::duration<TimeRepT, TimeT> timeout = std::chrono::duration<TimeRepT, TimeT>(-1))
+{
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node_ptr);
+  auto retcode = executor.spin_until_all_complete(futures, timeout);
+  executor.remove_node(node_ptr);
+  return retcode;
+}
+
+template<typename NodeT = rclcpp::Node, typename FutureT, typename TimeRepT = int64_t,
+  typename TimeT = std::milli>
+rclcpp::executor::FutureReturnCode
+spin_until_all_complete(
+  std::shared_ptr<NodeT> node_ptr,
+  const std::vector<std::shared_future<FutureT>> & futures,
+  std::chrono::duration<TimeRepT, TimeT> timeout = std::chrono::duration<TimeRepT, TimeT>(-1))
+{
+  return rclcpp::spin_until_all_complete(node_ptr->get_node_base_interface(), futures, timeout);
+}
+
+/// Spin the node until any of the futures is complete, see
+/// Executor::spin_until_any_complete().
+template<typename FutureT, typename TimeRepT = int64_t, typename TimeT = std::milli>
+rclcpp::executor::FutureReturnCode
+spin_until_any_complete(
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+  const std::vector<std::shared_future<FutureT>> & futures,
+  std::chrono::duration<TimeRepT, TimeT> timeout = std::chrono::duration<TimeRepT, TimeT>(-1),
+  size_t * completed_index = nullptr)
+{
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node_ptr);
+  auto retcode = executor.spin_until_any_complete(futures, timeout, completed_index);
+  executor.remove_node(node_ptr);
+  return retcode;
+}
+
+template<typename NodeT = rclcpp::Node, typename FutureT, typename TimeRepT = int64_t,
+  typename TimeT = std::milli>
+rclcpp::executor::FutureReturnCode
+spin_until_any_complete(
+  std::shared_ptr<NodeT> node_ptr,
+  const std::vector<std::shared_future<FutureT>> & futures,
+  std::chrono::duration<TimeRepT, TimeT> timeout = std::chrono::duration<TimeRepT, TimeT>(-1),
+  size_t * completed_index = nullptr)
+{
+  return rclcpp::spin_until_any_complete(
+    node_ptr->get_node_base_interface(), futures, timeout, completed_index);
+}
+
 }  // namespace rclcpp
 
 #endif  // RCLCPP__EXECUTORS_HPP_
@@ -0,0 +1,189 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__EXECUTORS__CALLBACK_GROUP_BALANCER_HPP_
+#define RCLCPP__EXECUTORS__CALLBACK_GROUP_BALANCER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/executor.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Options of a CallbackGroupBalancer.
+struct CallbackGroupBalancerOptions
+{
+  /// Groups are moved when the load of the busiest executor exceeds the load of the idlest one
+  /// by more than this fraction of the busiest load.
+  double imbalance_threshold = 0.25;
+  /// Maximum number of groups moved by one rebalance().
+  size_t max_moves = 1;
+};
+
+/// Spread the callback groups of nodes over several executors, by the CPU time of the groups.
+/**
+ * The nodes added to the balancer are added to all of its executors, and each of their callback
+ * groups is assigned to one executor, which is the only one waiting on it, see
+ * CallbackGroup::assign_to_executor().
+ * The executors measure the CPU time of the callbacks in their groups, and rebalance() moves
+ * groups from the busiest executor to the idlest one, by the CPU time used since the previous
+ * rebalance().
+ *
+ * Moving a group doesn't lose any work: the messages and requests not taken yet are taken by the
+ * new executor, and a mutually exclusive group is not executed by the new executor before its
+ * callback running on the old one returns.
+ * The callback groups created after the node was added are waited on by all the executors until
+ * the next rebalance() assigns them.
+ *
+ * The executors are spun by the application, and must not share memory strategies.
+ */
+class CallbackGroupBalancer
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(CallbackGroupBalancer)
+
+  /// Enable the measurement of the CPU time of the callback groups on the executors.
+  /**
+   * \throws std::invalid_argument if there are no executors or one of them is nullptr.
+   */
+  RCLCPP_PUBLIC
+  explicit CallbackGroupBalancer(
+    std::vector<rclcpp::executor::Executor::SharedPtr> executors,
+    const CallbackGroupBalancerOptions & options = CallbackGroupBalancerOptions());
+
+  /// Stop rebalancing periodically, the nodes stay in the executors.
+  RCLCPP_PUBLIC
+  virtual ~CallbackGroupBalancer();
+
+  /// Add a node to all the executors, and assign each of its groups to the idlest executor.
+  /**
+   * \throws std::runtime_error if the node was already added to an executor.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_node(rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node);
+
+  RCLCPP_PUBLIC
+  void
+  add_node(std::shared_ptr<rclcpp::Node> node);
+
+  /// Remove a node from the executors, its groups are no longer assigned to an executor.
+  RCLCPP_PUBLIC
+  void
+  remove_node(rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node);
+
+  RCLCPP_PUBLIC
+  void
+  remove_node(std::shared_ptr<rclcpp::Node> node);
+
+  /// Move a callback group of one of the nodes to an executor.
+  /**
+   * \throws std::invalid_argument if the group isn't in a node of the balancer.
+   * \throws std::out_of_range if there is no executor with this index.
+   */
+  RCLCPP_PUBLIC
+  void
+  move_callback_group(
+    rclcpp::callback_group::CallbackGroup::SharedPtr group, size_t executor_index);
+
+  /// Return the index of the executor the group is assigned to, the number of executors if none.
+  RCLCPP_PUBLIC
+  size_t
+  get_executor_index(rclcpp::callback_group::CallbackGroup::SharedPtr group) const;
+
+  /// Assign the new groups, and move the groups from the busiest executors to the idlest ones.
+  /**
+   * \return The number of groups moved.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  rebalance();
+
+  /// Return the CPU time of the callbacks of each executor, between the last two rebalance().
+  RCLCPP_PUBLIC
+  std::vector<std::chrono::nanoseconds>
+  get_executor_loads() const;
+
+  /// Call rebalance() periodically from a thread of the balancer.
+  /**
+   * \throws std::runtime_error if it was already started.
+   */
+  RCLCPP_PUBLIC
+  void
+  start(std::chrono::nanoseconds period);
+
+  /// Stop calling rebalance() periodically, blocking until the thread has exited.
+  RCLCPP_PUBLIC
+  void
+  stop();
+
+private:
+  RCLCPP_DISABLE_COPY(CallbackGroupBalancer)
+
+  struct GroupEntry
+  {
+    rclcpp::callback_group::CallbackGroup::WeakPtr group;
+    rclcpp::node_interfaces::NodeBaseInterface::WeakPtr node;
+    /// CPU time of the group at the previous rebalance().
+    std::chrono::nanoseconds last_cpu_time;
+    /// CPU time of the group between the last two rebalance().
+    std::chrono::nanoseconds load;
+  };
+
+  /// Track the groups of the nodes, and assign the unassigned ones, called with mutex_ locked.
+  void
+  update_groups();
+
+  size_t
+  get_executor_index(const rclcpp::callback_group::CallbackGroup & group) const;
+
+  size_t
+  get_idlest_executor() const;
+
+  void
+  assign(GroupEntry & entry, size_t executor_index);
+
+  std::vector<rclcpp::executor::Executor::SharedPtr> executors_;
+  CallbackGroupBalancerOptions options_;
+
+  mutable std::mutex mutex_;
+  std::vector<rclcpp::node_interfaces::NodeBaseInterface::WeakPtr> nodes_;
+  std::unordered_map<const rclcpp::callback_group::CallbackGroup *, GroupEntry> groups_;
+  std::vector<std::chrono::nanoseconds> executor_loads_;
+
+  std::mutex thread_mutex_;
+  std::condition_variable thread_cv_;
+  bool stop_thread_ = false;
+  std::thread thread_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__CALLBACK_GROUP_BALANCER_HPP_
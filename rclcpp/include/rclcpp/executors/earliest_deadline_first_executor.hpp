@@ -0,0 +1,160 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTORS__EARLIEST_DEADLINE_FIRST_EXECUTOR_HPP_
+#define RCLCPP__EXECUTORS__EARLIEST_DEADLINE_FIRST_EXECUTOR_HPP_
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "rclcpp/executor.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/memory_strategies.hpp"
+#include "rclcpp/subscription_base.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Single-threaded executor which executes the ready work with the earliest deadline first.
+/**
+ * All ready executables are taken at once and ordered by their absolute deadline:
+ * - the deadline of a timer is one period after the time it was expected to be called,
+ * - the deadline of a subscription whose QoS has a deadline (see rclcpp::QoS::deadline()) is
+ *   that deadline after it was found ready,
+ * - everything else has no deadline and is executed after the work which has one, in the order
+ *   in which it became ready.
+ *
+ * Timers and subscriptions are ordered together, e.g. a subscription with a 10ms deadline found
+ * ready with a 1s timer which just became due is executed first.
+ *
+ * Before each execution the executor checks, without blocking, for newly ready work, so work
+ * with an earlier deadline which became ready in the meantime is executed next.
+ * Every execution after the deadline of its entity is counted, see
+ * get_number_of_deadline_misses().
+ */
+class EarliestDeadlineFirstExecutor : public executor::Executor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(EarliestDeadlineFirstExecutor)
+
+  /// Default constructor. See the default constructor for Executor.
+  RCLCPP_PUBLIC
+  explicit EarliestDeadlineFirstExecutor(
+    const executor::ExecutorArgs & args = executor::ExecutorArgs());
+
+  /// Default destructor.
+  RCLCPP_PUBLIC
+  virtual ~EarliestDeadlineFirstExecutor();
+
+  RCLCPP_PUBLIC
+  void
+  spin() override;
+
+  RCLCPP_PUBLIC
+  void
+  spin_some(std::chrono::nanoseconds max_duration = std::chrono::nanoseconds(0)) override;
+
+  RCLCPP_PUBLIC
+  void
+  spin_once(std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1)) override;
+
+  /// Return how often the timer was executed after its deadline by this executor.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_deadline_misses(const rclcpp::TimerBase::SharedPtr & timer) const;
+
+  /// Return how often the subscription was executed after its QoS deadline by this executor.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_deadline_misses(const rclcpp::SubscriptionBase::SharedPtr & subscription) const;
+
+  /// Return the number of executables waiting to be executed.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_queued_executables() const;
+
+protected:
+  /// Wait for work if nothing is queued, and execute the queued executable with the earliest
+  /// deadline.
+  /**
+   * \return true if something was executed.
+   */
+  RCLCPP_PUBLIC
+  bool
+  execute_next_by_deadline(std::chrono::nanoseconds timeout);
+
+  /// Move all the executables found ready by the last wait into the deadline queue.
+  RCLCPP_PUBLIC
+  void
+  collect_ready_executables();
+
+private:
+  RCLCPP_DISABLE_COPY(EarliestDeadlineFirstExecutor)
+
+  using AnyExecutablePtr = std::unique_ptr<executor::AnyExecutable>;
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  struct QueuedExecutable
+  {
+    AnyExecutablePtr any_exec;
+    const void * entity = nullptr;
+    TimePoint deadline;
+  };
+
+  struct EntityStats
+  {
+    std::weak_ptr<const void> entity;
+    /// Relative deadline of a subscription, read once from its QoS, zero if it has none.
+    std::chrono::nanoseconds relative_deadline{0};
+    bool relative_deadline_known = false;
+    size_t deadline_misses = 0;
+  };
+
+  /// Return the stats of an entity, resetting them if they belonged to a destroyed entity.
+  EntityStats &
+  get_entity_stats(const void * entity, std::shared_ptr<const void> owner);
+
+  size_t
+  get_deadline_misses(const void * entity) const;
+
+  void
+  enqueue(AnyExecutablePtr any_exec, TimePoint now);
+
+  bool
+  pop_next_executable(QueuedExecutable & next);
+
+  void
+  clear_queue();
+
+  /// Protects the queue and the stats, which are read from other threads.
+  mutable std::mutex queue_mutex_;
+  /// Ordered by the deadline of the executable, equal keys keep insertion order.
+  std::multimap<TimePoint, QueuedExecutable> queue_;
+  /// Entities which are queued, a reentrant entity stays ready until it is executed.
+  std::unordered_set<const void *> queued_entities_;
+  std::unordered_map<const void *, EntityStats> entity_stats_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__EARLIEST_DEADLINE_FIRST_EXECUTOR_HPP_
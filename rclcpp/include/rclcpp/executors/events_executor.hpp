@@ -0,0 +1,190 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTORS__EVENTS_EXECUTOR_HPP_
+#define RCLCPP__EXECUTORS__EVENTS_EXECUTOR_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/executor.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/memory_strategies.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Single-threaded executor which keeps a persistent table of the entities it waits on.
+/**
+ * The default executors walk every node, callback group and entity, and resize the wait set,
+ * before each call to rcl_wait().
+ * This executor instead builds a flat entity table once and only rebuilds it when something
+ * changed: a node was added or removed, a node was destroyed, or one of the nodes triggered its
+ * notify guard condition (which happens whenever entities are added to or removed from it).
+ *
+ * After each wait, the ready entities are pushed onto a FIFO queue and dispatched from it, so
+ * a single call to rcl_wait() can feed many callbacks.
+ *
+ * The public API is the same as SingleThreadedExecutor:
+ * rclcpp::executors::EventsExecutor exec;
+ * exec.add_node(node);
+ * exec.spin();
+ * exec.remove_node(node);
+ */
+class EventsExecutor : public executor::Executor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(EventsExecutor)
+
+  /// Default constructor. See the default constructor for Executor.
+  RCLCPP_PUBLIC
+  explicit EventsExecutor(
+    const executor::ExecutorArgs & args = executor::ExecutorArgs());
+
+  /// Default destructor.
+  RCLCPP_PUBLIC
+  virtual ~EventsExecutor();
+
+  /// Events executor implementation of spin.
+  // This function will block until work comes in, execute it, and keep blocking.
+  // It will only be interrupt by a CTRL-C (managed by the global signal handler).
+  RCLCPP_PUBLIC
+  void
+  spin() override;
+
+  RCLCPP_PUBLIC
+  void
+  spin_some(std::chrono::nanoseconds max_duration = std::chrono::nanoseconds(0)) override;
+
+  RCLCPP_PUBLIC
+  void
+  spin_once(std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1)) override;
+
+  RCLCPP_PUBLIC
+  void
+  add_node(
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+    bool notify = true) override;
+
+  /// Convenience function which takes Node and forwards NodeBaseInterface.
+  RCLCPP_PUBLIC
+  void
+  add_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify = true) override;
+
+  RCLCPP_PUBLIC
+  void
+  remove_node(
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+    bool notify = true) override;
+
+  /// Convenience function which takes Node and forwards NodeBaseInterface.
+  RCLCPP_PUBLIC
+  void
+  remove_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify = true) override;
+
+  /// Return how many times the entity table has been rebuilt since construction.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_entity_rebuilds() const;
+
+  /// Return the number of ready entities waiting in the dispatch queue.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_queued_executables() const;
+
+protected:
+  enum class EntityType
+  {
+    Subscription,
+    Timer,
+    Service,
+    Client,
+    Waitable
+  };
+
+  /// Entry of the entity table: the entity and the scope needed to execute it.
+  template<typename EntityT>
+  struct EntityEntry
+  {
+    std::weak_ptr<EntityT> weak_entity;
+    /// Strong reference held from the moment the entity is put into the wait set until the next
+    /// time the wait set is filled, so the rcl handle cannot dangle while rcl_wait() blocks.
+    std::shared_ptr<EntityT> entity;
+    rclcpp::callback_group::CallbackGroup::WeakPtr callback_group;
+    rclcpp::node_interfaces::NodeBaseInterface::WeakPtr node;
+    size_t wait_set_index;
+  };
+
+  struct ReadyExecutable
+  {
+    EntityType type;
+    size_t index;
+  };
+
+  /// Rebuild the entity table from the nodes and resize the wait set accordingly.
+  RCLCPP_PUBLIC
+  void
+  rebuild_entities();
+
+  /// Fill the wait set from the entity table, wait and push the ready entities onto the queue.
+  RCLCPP_PUBLIC
+  void
+  wait_for_ready_executables(std::chrono::nanoseconds timeout);
+
+  /// Pop the next executable from the queue and execute it.
+  /**
+   * \return true if something was executed, false if the queue was empty or
+   *   the entity was no longer valid.
+   */
+  RCLCPP_PUBLIC
+  bool
+  execute_next_queued_executable();
+
+private:
+  RCLCPP_DISABLE_COPY(EventsExecutor)
+
+  bool
+  fill_wait_set();
+
+  template<typename EntityT>
+  bool
+  take_scope(
+    EntityEntry<EntityT> & entry,
+    executor::AnyExecutable & any_exec);
+
+  std::vector<EntityEntry<rclcpp::SubscriptionBase>> subscriptions_;
+  std::vector<EntityEntry<rclcpp::TimerBase>> timers_;
+  std::vector<EntityEntry<rclcpp::ServiceBase>> services_;
+  std::vector<EntityEntry<rclcpp::ClientBase>> clients_;
+  std::vector<EntityEntry<rclcpp::Waitable>> waitables_;
+
+  std::deque<ReadyExecutable> ready_queue_;
+
+  /// Set whenever the entity table no longer reflects the nodes associated with this executor.
+  std::atomic_bool entities_need_rebuild_;
+  size_t number_of_entity_rebuilds_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__EVENTS_EXECUTOR_HPP_
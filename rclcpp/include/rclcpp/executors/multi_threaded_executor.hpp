@@ -15,12 +15,13 @@
 #ifndef RCLCPP__EXECUTORS__MULTI_THREADED_EXECUTOR_HPP_
 #define RCLCPP__EXECUTORS__MULTI_THREADED_EXECUTOR_HPP_
 
+#include <atomic>
 #include <chrono>
 #include <memory>
 #include <mutex>
-#include <set>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "rclcpp/executor.hpp"
 #include "rclcpp/macros.hpp"
@@ -37,6 +38,22 @@ class MultiThreadedExecutor : public executor::Executor
 public:
   RCLCPP_SMART_PTR_DEFINITIONS(MultiThreadedExecutor)
 
+  /// Options of the elastic thread pool, which grows during bursts and shrinks when idle.
+  struct ElasticThreadPoolOptions
+  {
+    /// Number of threads started by spin(), which keep running until it returns, at least 1.
+    size_t min_threads = 1;
+    /// Maximum number of threads, 0 for the number of cpu cores.
+    size_t max_threads = 0;
+    /// A thread is started when ready work waited longer than this for a thread.
+    /**
+     * The wait is measured from the end of the rcl_wait() which found the work ready.
+     */
+    std::chrono::nanoseconds grow_threshold = std::chrono::milliseconds(1);
+    /// A thread above min_threads stops after not executing anything for this long.
+    std::chrono::nanoseconds idle_timeout = std::chrono::seconds(1);
+  };
+
   /// Constructor for MultiThreadedExecutor.
   /**
    * For the yield_before_execute option, when true std::this_thread::yield()
@@ -45,6 +62,9 @@ public:
    * This is useful for reproducing some bugs related to taking work more than
    * once.
    *
+   * The thread options in args are applied when spin() starts its threads, before they execute
+   * any work. The last thread is the one which called spin().
+   *
    * \param args common arguments for all executors
    * \param number_of_threads number of threads to have in the thread pool,
    *   the default 0 will use the number of cpu cores found instead
@@ -57,6 +77,26 @@ public:
     bool yield_before_execute = false,
     std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1));
 
+  /// Constructor for a MultiThreadedExecutor with an elastic thread pool.
+  /**
+   * spin() starts min_threads threads, including the calling thread, and starts more threads
+   * up to max_threads when the ready work waits longer than grow_threshold for a thread.
+   * The threads above min_threads stop once they were idle for idle_timeout.
+   *
+   * The threads take the thread options in args in the order they are started.
+   *
+   * \param args common arguments for all executors
+   * \param elastic_options the bounds and thresholds of the thread pool
+   * \param yield_before_execute if true std::this_thread::yield() is called
+   * \throws std::invalid_argument if max_threads is lower than min_threads.
+   */
+  RCLCPP_PUBLIC
+  MultiThreadedExecutor(
+    const executor::ExecutorArgs & args,
+    const ElasticThreadPoolOptions & elastic_options,
+    bool yield_before_execute = false,
+    std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1));
+
   RCLCPP_PUBLIC
   virtual ~MultiThreadedExecutor();
 
@@ -64,10 +104,16 @@ public:
   void
   spin() override;
 
+  /// Return the number of threads of the pool, the maximum number of threads if it is elastic.
   RCLCPP_PUBLIC
   size_t
   get_number_of_threads();
 
+  /// Return the number of threads currently running, 0 when not spinning.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_active_threads() const;
+
 protected:
   RCLCPP_PUBLIC
   void
@@ -76,12 +122,40 @@ protected:
 private:
   RCLCPP_DISABLE_COPY(MultiThreadedExecutor)
 
+  /// Get the next executable of an elastic pool, starting a thread if it waited too long.
+  /**
+   * Called with wait_mutex_ locked.
+   */
+  bool
+  get_next_elastic_executable(executor::AnyExecutable & any_exec);
+
+  /// Start a thread of the elastic pool, called with wait_mutex_ locked.
+  void
+  add_thread();
+
+  /// Stop starting threads, and join the threads started by spin() and add_thread().
+  void
+  join_threads();
+
   std::mutex wait_mutex_;
   size_t number_of_threads_;
   bool yield_before_execute_;
   std::chrono::nanoseconds next_exec_timeout_;
 
-  std::set<TimerBase::SharedPtr> scheduled_timers_;
+  bool elastic_;
+  ElasticThreadPoolOptions elastic_options_;
+  std::atomic<size_t> active_threads_;
+  /// The number of the thread which called spin(), which never stops before spin() returns.
+  size_t spin_thread_number_;
+  /// Protected by wait_mutex_.
+  size_t next_thread_number_;
+  std::chrono::steady_clock::time_point last_wait_end_;
+
+  std::mutex threads_mutex_;
+  /// The threads started by spin() and add_thread(), protected by threads_mutex_.
+  std::vector<std::thread> threads_;
+  /// The threads of the elastic pool which stopped and can be joined.
+  std::vector<std::thread::id> finished_threads_;
 };
 
 }  // namespace executors
@@ -0,0 +1,135 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTORS__POLLABLE_EXECUTOR_HPP_
+#define RCLCPP__EXECUTORS__POLLABLE_EXECUTOR_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "rclcpp/executor.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Executor driven by an external event loop, through a pollable file descriptor.
+/**
+ * The file descriptor returned by get_fd() becomes readable when work is ready, so it can be
+ * registered with epoll, asio or any other event loop.
+ * The event loop then calls dispatch() from its own thread, which executes the ready work
+ * without blocking: the callbacks run on the thread of the event loop, and the messages are
+ * taken there.
+ *
+ * The rmw layer doesn't expose file descriptors, so start() runs a thread waiting on the
+ * entities of the executor, which only signals the file descriptor (an eventfd on Linux, a
+ * pipe on the other POSIX systems) when rcl_wait() returns.
+ * It waits again once dispatch() executed all the ready work, so the waiting thread and the
+ * thread calling dispatch() never use the wait set at the same time.
+ *
+ * spin() is provided for convenience, it polls the file descriptor and dispatches until
+ * cancel() is called.
+ */
+class PollableExecutor : public executor::Executor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(PollableExecutor)
+
+  /// Default constructor. See the default constructor for Executor.
+  /**
+   * \throws std::runtime_error if the file descriptor can't be created, or on Windows.
+   */
+  RCLCPP_PUBLIC
+  explicit PollableExecutor(
+    const executor::ExecutorArgs & args = executor::ExecutorArgs());
+
+  /// Stop the waiting thread and close the file descriptor.
+  RCLCPP_PUBLIC
+  virtual ~PollableExecutor();
+
+  /// Return the file descriptor which is readable when dispatch() has work to execute.
+  /**
+   * The file descriptor is owned by the executor and must not be read or closed by the caller.
+   */
+  RCLCPP_PUBLIC
+  int
+  get_fd() const;
+
+  /// Start the thread waiting for work, which signals the file descriptor.
+  /**
+   * \throws std::runtime_error if the executor is already spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  start();
+
+  /// Stop the thread waiting for work, blocking until it has exited.
+  /**
+   * Must not be called from a callback executed by dispatch().
+   */
+  RCLCPP_PUBLIC
+  void
+  stop();
+
+  /// Execute the ready work without blocking.
+  /**
+   * Does nothing if the file descriptor wasn't signaled.
+   * When the ready work is larger than max_executables, the file descriptor stays readable, so
+   * the event loop comes back for the rest.
+   * \param[in] max_executables Maximum number of executables to execute, 0 for no limit.
+   * \return The number of executables executed.
+   * \throws the exceptions thrown by the waiting thread, e.g. when rcl_wait() failed.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  dispatch(size_t max_executables = 0);
+
+  /// Start, then poll the file descriptor and dispatch until cancel() is called.
+  RCLCPP_PUBLIC
+  void
+  spin() override;
+
+private:
+  RCLCPP_DISABLE_COPY(PollableExecutor)
+
+  void
+  run_waiter();
+
+  void
+  signal_fd();
+
+  void
+  drain_fd();
+
+  int read_fd_ = -1;
+  int write_fd_ = -1;
+
+  std::thread waiter_thread_;
+  std::mutex waiter_mutex_;
+  std::condition_variable waiter_cv_;
+  /// True while the waiting thread is stopped, between a signal and the end of dispatch().
+  bool work_collected_ = false;
+  std::exception_ptr waiter_exception_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__POLLABLE_EXECUTOR_HPP_
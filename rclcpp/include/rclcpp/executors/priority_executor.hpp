@@ -0,0 +1,132 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTORS__PRIORITY_EXECUTOR_HPP_
+#define RCLCPP__EXECUTORS__PRIORITY_EXECUTOR_HPP_
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/executor.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/memory_strategies.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Single-threaded executor which executes ready work by callback group priority.
+/**
+ * The base Executor always looks for ready timers first, then subscriptions, services, clients
+ * and waitables, regardless of which callback group they belong to.
+ * This executor takes all ready executables at once and queues them by the priority of their
+ * callback group, see CallbackGroup::set_priority().
+ * The executable with the highest priority is executed first.
+ * Within a priority level the callback groups are served round-robin, so that a busy group
+ * cannot starve the other groups of the same priority.
+ *
+ * Before each execution the executor checks, without blocking, for newly ready work, so higher
+ * priority work which became ready in the meantime is executed next.
+ */
+class PriorityExecutor : public executor::Executor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(PriorityExecutor)
+
+  /// Default constructor. See the default constructor for Executor.
+  RCLCPP_PUBLIC
+  explicit PriorityExecutor(
+    const executor::ExecutorArgs & args = executor::ExecutorArgs());
+
+  /// Default destructor.
+  RCLCPP_PUBLIC
+  virtual ~PriorityExecutor();
+
+  RCLCPP_PUBLIC
+  void
+  spin() override;
+
+  RCLCPP_PUBLIC
+  void
+  spin_some(std::chrono::nanoseconds max_duration = std::chrono::nanoseconds(0)) override;
+
+  RCLCPP_PUBLIC
+  void
+  spin_once(std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1)) override;
+
+  /// Return the number of executables queued with the given priority.
+  RCLCPP_PUBLIC
+  size_t
+  get_queue_depth(int priority) const;
+
+  /// Return the number of queued executables of every priority which has queued work.
+  RCLCPP_PUBLIC
+  std::map<int, size_t>
+  get_queue_depths() const;
+
+protected:
+  /// Wait for work if nothing is queued, and execute the queued executable with the highest
+  /// priority.
+  /**
+   * \return true if something was executed.
+   */
+  RCLCPP_PUBLIC
+  bool
+  execute_next_prioritized(std::chrono::nanoseconds timeout);
+
+  /// Move all the executables found ready by the last wait into the priority queues.
+  RCLCPP_PUBLIC
+  void
+  collect_ready_executables();
+
+private:
+  RCLCPP_DISABLE_COPY(PriorityExecutor)
+
+  using AnyExecutablePtr = std::unique_ptr<executor::AnyExecutable>;
+  using CallbackGroupKey = const rclcpp::callback_group::CallbackGroup *;
+
+  struct PriorityLevel
+  {
+    /// Groups with queued work, in the order in which they are served.
+    std::deque<CallbackGroupKey> group_rotation;
+    std::unordered_map<CallbackGroupKey, std::deque<AnyExecutablePtr>> group_queues;
+    size_t depth = 0;
+  };
+
+  AnyExecutablePtr
+  pop_next_executable();
+
+  void
+  clear_queues();
+
+  /// Protects the queues, which are read by get_queue_depth() from other threads.
+  mutable std::mutex queue_mutex_;
+  std::map<int, PriorityLevel, std::greater<int>> levels_;
+  /// Entities which are queued, a reentrant entity stays ready until it is executed.
+  std::unordered_set<const void *> queued_entities_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__PRIORITY_EXECUTOR_HPP_
@@ -0,0 +1,200 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTORS__STATIC_MULTI_THREADED_EXECUTOR_HPP_
+#define RCLCPP__EXECUTORS__STATIC_MULTI_THREADED_EXECUTOR_HPP_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "rcl/guard_condition.h"
+#include "rcl/wait.h"
+
+#include "rclcpp/callback_group.hpp"
+#include "rclcpp/executable_list.hpp"
+#include "rclcpp/executor.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/memory_strategies.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Static executor implementation using a fixed set of threads
+/**
+ * Multi-threaded counterpart of StaticSingleThreadedExecutor.
+ * The executable lists are only rebuilt when a node is added or removed, or when a node
+ * notifies that its entities changed.
+ *
+ * Every callback group is assigned to one of the threads when it is first seen, and stays with
+ * that thread.
+ * Each thread owns its own ExecutableList and its own rcl wait set, and waits and executes
+ * independently of the others, so there is no lock on the hot path.
+ * Since all callbacks of a group are executed by the same thread, callbacks of a group never
+ * run concurrently, also for Reentrant groups.
+ * Use several callback groups to spread the work across the threads.
+ * The thread options in ExecutorArgs are applied to the threads before they execute any work,
+ * thread 0 is the thread calling spin().
+ *
+ * To run this executor instead of MultiThreadedExecutor replace:
+ * rclcpp::executors::MultiThreadedExecutor exec;
+ * by
+ * rclcpp::executors::StaticMultiThreadedExecutor exec;
+ */
+class StaticMultiThreadedExecutor : public executor::Executor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(StaticMultiThreadedExecutor)
+
+  /// Constructor for StaticMultiThreadedExecutor.
+  /**
+   * \param args common arguments for all executors
+   * \param number_of_threads number of threads to have in the thread pool,
+   *   the default 0 will use the number of cpu cores found instead
+   */
+  RCLCPP_PUBLIC
+  explicit StaticMultiThreadedExecutor(
+    const executor::ExecutorArgs & args = executor::ExecutorArgs(),
+    size_t number_of_threads = 0);
+
+  RCLCPP_PUBLIC
+  virtual ~StaticMultiThreadedExecutor();
+
+  RCLCPP_PUBLIC
+  void
+  spin() override;
+
+  RCLCPP_PUBLIC
+  void
+  add_node(
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+    bool notify = true) override;
+
+  /// Convenience function which takes Node and forwards NodeBaseInterface.
+  RCLCPP_PUBLIC
+  void
+  add_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify = true) override;
+
+  RCLCPP_PUBLIC
+  void
+  remove_node(
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr,
+    bool notify = true) override;
+
+  /// Convenience function which takes Node and forwards NodeBaseInterface.
+  RCLCPP_PUBLIC
+  void
+  remove_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify = true) override;
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_threads();
+
+  /// Dedicate a thread to a callback group.
+  /**
+   * By default a group is assigned to the thread with the least groups when it is first seen.
+   * Use this to choose the thread instead, e.g. together with ExecutorArgs::thread_options to
+   * run a group on a pinned real-time thread.
+   * A group which is already assigned can only be moved while the executor is not spinning.
+   * \param[in] group The callback group.
+   * \param[in] thread The index of the thread, 0 is the thread calling spin().
+   * \throws std::invalid_argument if the thread index is out of range.
+   * \throws std::runtime_error if the group would move to another thread while spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  assign_callback_group_to_thread(
+    rclcpp::callback_group::CallbackGroup::SharedPtr group, size_t thread);
+
+  /// Return the index of the thread a callback group was assigned to.
+  /**
+   * \return the thread index, or get_number_of_threads() if the group was not assigned yet.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_thread_of_callback_group(rclcpp::callback_group::CallbackGroup::SharedPtr group);
+
+protected:
+  RCLCPP_PUBLIC
+  void
+  run(size_t this_thread_number);
+
+  /// Collect the entities of all nodes and split them across the threads by callback group.
+  RCLCPP_PUBLIC
+  void
+  rebuild_executable_lists();
+
+private:
+  RCLCPP_DISABLE_COPY(StaticMultiThreadedExecutor)
+
+  struct ThreadState
+  {
+    /// Wait set of this thread, thread 0 uses the executor's wait_set_.
+    rcl_wait_set_t * wait_set;
+    rcl_wait_set_t owned_wait_set = rcl_get_zero_initialized_wait_set();
+    /// Guard condition to wake this thread, also on shutdown, thread 0 uses the executor's
+    /// interrupt guard.
+    rcl_guard_condition_t * interrupt_guard_condition = nullptr;
+    rcl_guard_condition_t owned_interrupt_guard_condition =
+      rcl_get_zero_initialized_guard_condition();
+    rclcpp::executor::ExecutableList exec_list;
+    /// List computed by the last rebuild, swapped into exec_list by the thread itself.
+    rclcpp::executor::ExecutableList pending_exec_list;
+    size_t generation = 0;
+    size_t number_of_node_guard_conditions = 0;
+  };
+
+  struct GroupAssignment
+  {
+    rclcpp::callback_group::CallbackGroup::WeakPtr group;
+    size_t thread;
+  };
+
+  void
+  apply_pending_exec_list(ThreadState & state, size_t this_thread_number);
+
+  bool
+  fill_wait_set(ThreadState & state, size_t this_thread_number);
+
+  void
+  execute_ready_executables(ThreadState & state);
+
+  void
+  interrupt_threads();
+
+  void
+  stop_threads(std::vector<std::thread> & threads);
+
+  size_t number_of_threads_;
+  std::vector<std::unique_ptr<ThreadState>> thread_states_;
+
+  /// Protects the assignments, the pending lists and the generation counter.
+  std::mutex entities_mutex_;
+  std::unordered_map<const rclcpp::callback_group::CallbackGroup *, GroupAssignment>
+  group_assignments_;
+  size_t generation_;
+  std::atomic_bool entities_need_rebuild_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__STATIC_MULTI_THREADED_EXECUTOR_HPP_
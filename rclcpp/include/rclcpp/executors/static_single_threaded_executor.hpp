@@ -136,6 +136,9 @@ public:
     std::shared_future<ResponseT> & future,
     std::chrono::duration<TimeRepT, TimeT> timeout = std::chrono::duration<TimeRepT, TimeT>(-1))
   {
+    // Wake up as soon as a future is completed, even from another thread.
+    rclcpp::executor::FutureWaiter future_waiter(&interrupt_guard_condition_);
+
     std::future_status status = future.wait_for(std::chrono::seconds(0));
     if (status == std::future_status::ready) {
       return rclcpp::executor::FutureReturnCode::SUCCESS;
@@ -0,0 +1,163 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__EXECUTORS__STEPPING_EXECUTOR_HPP_
+#define RCLCPP__EXECUTORS__STEPPING_EXECUTOR_HPP_
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "rclcpp/clock.hpp"
+#include "rclcpp/executor.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/time.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Executor stepping the simulated time from one timer deadline to the next.
+/**
+ * The executor is the source of the simulated time of the process: it sets the time of the
+ * clocks using the simulated time, i.e. ROS time clocks of nodes with `use_sim_time`, instead
+ * of the /clock topic, which must not be published meanwhile.
+ *
+ * Each step executes all the work ready at the current simulated time, including the work
+ * triggered by it, e.g. the messages published intra-process by the callbacks, and then
+ * advances the time to the earliest deadline of the timers of these clocks.
+ * No step waits for the wall-clock time, so the simulation runs as fast as the callbacks
+ * allow, and the callbacks are executed in the same order at each run as long as the work
+ * comes from the simulation itself.
+ * Messages received from outside of the process are executed at the step they arrive in, so
+ * the simulated nodes should communicate intra-process to be deterministic.
+ *
+ * The clocks found are those of the timers of the nodes added to the executor; other clocks,
+ * e.g. the clock of a node without timers on it, are added with add_clock().
+ * Timers on the system or steady clocks are executed when they are ready, as usual.
+ */
+class SteppingExecutor : public executor::Executor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(SteppingExecutor)
+
+  /// Default constructor. See the default constructor for Executor.
+  RCLCPP_PUBLIC
+  explicit SteppingExecutor(
+    const executor::ExecutorArgs & args = executor::ExecutorArgs());
+
+  /// Default destructor.
+  RCLCPP_PUBLIC
+  virtual ~SteppingExecutor();
+
+  /// Step until cancel() is called or rclcpp is shut down.
+  /**
+   * While no timer uses the simulated time, it blocks waiting for work like the single
+   * threaded executor.
+   */
+  RCLCPP_PUBLIC
+  void
+  spin() override;
+
+  /// Execute the work ready at the current time, then advance the time to the next deadline.
+  /**
+   * \return false if no timer uses the simulated time, so the time was not advanced.
+   * \throws std::runtime_error if the executor is already spinning.
+   */
+  RCLCPP_PUBLIC
+  bool
+  step();
+
+  /// Step until the time reaches `end_time`, at which the ready work is executed too.
+  /**
+   * It returns early if the executor is canceled or rclcpp is shut down.
+   *
+   * \param[in] end_time The simulated time to stop at.
+   * \throws std::invalid_argument if `end_time` is earlier than the current time.
+   * \throws std::runtime_error if the executor is already spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  spin_until(const rclcpp::Time & end_time);
+
+  /// Return the current simulated time.
+  RCLCPP_PUBLIC
+  rclcpp::Time
+  get_time() const;
+
+  /// Set the simulated time, e.g. the start time of the simulation, 0 by default.
+  /**
+   * The time is set on the clocks at the next step; it may go backwards.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_time(const rclcpp::Time & time);
+
+  /// Add a clock to set the simulated time on, in addition to the clocks of the timers.
+  /**
+   * The clock is only set while its ROS time override is active, and is kept weakly.
+   *
+   * \throws std::invalid_argument if the clock is not a ROS time clock.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_clock(rclcpp::Clock::SharedPtr clock);
+
+protected:
+  /// Execute the work ready now, until there is none.
+  RCLCPP_PUBLIC
+  void
+  execute_ready_work();
+
+  /// Return the clocks using the simulated time, the ones of the timers and the added ones.
+  RCLCPP_PUBLIC
+  std::vector<rclcpp::Clock::SharedPtr>
+  get_simulated_clocks();
+
+  /// Set the current time on the clocks using the simulated time.
+  RCLCPP_PUBLIC
+  void
+  update_clocks(const std::vector<rclcpp::Clock::SharedPtr> & clocks);
+
+  /// Get the earliest deadline of the timers of the clocks, return false if there is none.
+  RCLCPP_PUBLIC
+  bool
+  get_next_deadline(
+    const std::vector<rclcpp::Clock::SharedPtr> & clocks, rcl_time_point_value_t & deadline);
+
+  /// Execute the ready work and advance the time to the next deadline up to an end time.
+  /**
+   * \param[in] end_time maximum time to advance to, nullptr for no maximum.
+   * \return false if the time was not advanced to a deadline.
+   */
+  RCLCPP_PUBLIC
+  bool
+  step_until(const rcl_time_point_value_t * end_time);
+
+private:
+  RCLCPP_DISABLE_COPY(SteppingExecutor)
+
+  std::atomic<rcl_time_point_value_t> current_time_{0};
+
+  std::mutex clocks_mutex_;
+  std::vector<rclcpp::Clock::WeakPtr> added_clocks_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__STEPPING_EXECUTOR_HPP_
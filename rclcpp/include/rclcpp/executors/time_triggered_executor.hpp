@@ -0,0 +1,241 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTORS__TIME_TRIGGERED_EXECUTOR_HPP_
+#define RCLCPP__EXECUTORS__TIME_TRIGGERED_EXECUTOR_HPP_
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "rclcpp/executable_list.hpp"
+#include "rclcpp/executor.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/subscription_base.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Executor running a static, time-triggered schedule (cyclic executive).
+/**
+ * The schedule is a major frame made of consecutive minor frames, see add_minor_frame(), which
+ * is repeated while spinning.
+ * Each minor frame has a list of timers and subscriptions, which are executed in the order they
+ * were added when the frame starts:
+ * - a timer is executed if it is ready, its period should be a multiple of the major frame,
+ * - a subscription takes the messages received so far, up to its max messages per execution.
+ *
+ * The frames are scheduled against the steady clock, from the time spin() was called, and there
+ * is no rcl_wait() selecting the work: the executor only waits between the frames, to be woken
+ * up by cancel() or Ctrl-C.
+ * The timers of the schedule are reset when spin() starts, so their periods start with the
+ * first major frame.
+ *
+ * A minor frame overruns when its work ends after the start of the next frame, which then
+ * starts late; the following frames keep their start time, so the schedule recovers in the
+ * slack of the next frames.
+ * If a major frame would start one major frame late or more, the late major frames are skipped.
+ * Overruns are counted per minor frame, see get_frame_statistics(), and can be reported with
+ * set_frame_overrun_callback().
+ *
+ * The entities of the schedule don't need their node to be added to the executor, and must not
+ * be executed by another executor.
+ */
+class TimeTriggeredExecutor : public executor::Executor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(TimeTriggeredExecutor)
+
+  /// Statistics of a minor frame.
+  struct FrameStatistics
+  {
+    /// Number of times the frame was executed.
+    size_t count = 0;
+    /// Number of times its work ended after the end of the frame.
+    size_t overrun_count = 0;
+    /// Longest time from the start of the frame to the end of its work.
+    std::chrono::nanoseconds max_execution_time{0};
+    /// Longest time the work ended after the end of the frame.
+    std::chrono::nanoseconds max_overrun{0};
+  };
+
+  /// Called on the spinning thread after a minor frame overran, with the time it overran by.
+  using FrameOverrunCallback =
+    std::function<void (size_t minor_frame, std::chrono::nanoseconds overrun)>;
+
+  /// Default constructor. See the default constructor for Executor.
+  RCLCPP_PUBLIC
+  explicit TimeTriggeredExecutor(
+    const executor::ExecutorArgs & args = executor::ExecutorArgs());
+
+  /// Default destructor.
+  RCLCPP_PUBLIC
+  virtual ~TimeTriggeredExecutor();
+
+  /// Run the schedule until cancel() is called or rclcpp is shut down.
+  /**
+   * \throws std::runtime_error if the schedule has no minor frame.
+   */
+  RCLCPP_PUBLIC
+  void
+  spin() override;
+
+  /// Append a minor frame to the major frame.
+  /**
+   * \param[in] duration The duration of the frame.
+   * \return the index of the frame.
+   * \throws std::invalid_argument if the duration is not positive.
+   * \throws std::runtime_error if the executor is spinning.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  add_minor_frame(std::chrono::nanoseconds duration);
+
+  /// Append a timer to the work of a minor frame.
+  /**
+   * \throws std::out_of_range if there is no such frame.
+   * \throws std::runtime_error if the executor is spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_timer(size_t minor_frame, rclcpp::TimerBase::SharedPtr timer);
+
+  /// Append a subscription to the work of a minor frame.
+  /**
+   * \throws std::out_of_range if there is no such frame.
+   * \throws std::runtime_error if the executor is spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_subscription(size_t minor_frame, rclcpp::SubscriptionBase::SharedPtr subscription);
+
+  /// Remove all the minor frames.
+  /**
+   * \throws std::runtime_error if the executor is spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  clear_schedule();
+
+  /// Return the number of minor frames.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_minor_frames() const;
+
+  /// Return the duration of the major frame, the sum of the durations of the minor frames.
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  get_major_frame_duration() const;
+
+  /// Set the time spent spinning before the start of each frame, instead of sleeping.
+  /**
+   * It reduces the jitter of the frame starts to much less than the sleep granularity of the
+   * OS, at the cost of a busy core for `spin_threshold` before every frame, 0 by default.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_spin_threshold(std::chrono::nanoseconds spin_threshold);
+
+  /// Set the callback reporting the overruns, nullptr to remove it.
+  RCLCPP_PUBLIC
+  void
+  set_frame_overrun_callback(FrameOverrunCallback callback);
+
+  /// Return the statistics of a minor frame.
+  /**
+   * \throws std::out_of_range if there is no such frame.
+   */
+  RCLCPP_PUBLIC
+  FrameStatistics
+  get_frame_statistics(size_t minor_frame) const;
+
+  /// Return the number of overruns of all the minor frames.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_frame_overruns() const;
+
+  /// Return the number of major frames skipped because they would have started too late.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_skipped_major_frames() const;
+
+protected:
+  /// Execute the work of a minor frame, in the order of the schedule.
+  RCLCPP_PUBLIC
+  void
+  execute_minor_frame(size_t minor_frame);
+
+  /// Block until a time point, or until the executor is canceled or rclcpp is shut down.
+  /**
+   * \return false if the executor stopped spinning.
+   */
+  RCLCPP_PUBLIC
+  bool
+  wait_until(std::chrono::steady_clock::time_point time_point);
+
+private:
+  RCLCPP_DISABLE_COPY(TimeTriggeredExecutor)
+
+  enum class EntityType
+  {
+    Timer,
+    Subscription
+  };
+
+  struct Slot
+  {
+    EntityType type;
+    /// Index in the list of its type of the executable list.
+    size_t index;
+  };
+
+  struct MinorFrame
+  {
+    std::chrono::nanoseconds duration;
+    rclcpp::executor::ExecutableList executables;
+    /// Order of the executables across their types.
+    std::vector<Slot> slots;
+  };
+
+  /// Throw if the schedule can't be changed.
+  void
+  check_not_spinning() const;
+
+  /// Record the execution of a minor frame, and report it if it overran.
+  void
+  record_frame(
+    size_t minor_frame,
+    std::chrono::steady_clock::time_point start,
+    std::chrono::steady_clock::time_point end,
+    std::chrono::steady_clock::time_point now);
+
+  std::vector<MinorFrame> frames_;
+  std::chrono::nanoseconds spin_threshold_;
+
+  /// Protects the statistics and the callback, which are used from other threads.
+  mutable std::mutex statistics_mutex_;
+  std::vector<FrameStatistics> frame_statistics_;
+  size_t skipped_major_frames_;
+  FrameOverrunCallback overrun_callback_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__TIME_TRIGGERED_EXECUTOR_HPP_
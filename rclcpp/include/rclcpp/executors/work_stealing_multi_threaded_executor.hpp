@@ -0,0 +1,240 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXECUTORS__WORK_STEALING_MULTI_THREADED_EXECUTOR_HPP_
+#define RCLCPP__EXECUTORS__WORK_STEALING_MULTI_THREADED_EXECUTOR_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "rclcpp/executor.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/memory_strategies.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executors
+{
+
+/// Multi-threaded executor with per-thread work queues and work stealing.
+/**
+ * Unlike MultiThreadedExecutor, the worker threads never wait in rcl_wait() nor pick work from
+ * the memory strategy themselves.
+ * A single waiter thread (the thread calling spin()) waits for work, takes every ready
+ * executable and distributes them round-robin into per-worker deques.
+ * Each worker pops work from the front of its own deque and, when that is empty, steals from
+ * the back of the deques of the other workers.
+ *
+ * Callback groups keep their semantics: executables of a MutuallyExclusive group are only taken
+ * when CallbackGroup::can_be_taken_from() is true, and the flag is only reset once the callback
+ * has been executed, so at most one callback of such a group is queued or running at a time.
+ *
+ * A callback group can be assigned to a worker, see assign_callback_group_to_thread(), so that
+ * the waiter hands its work to that worker only.
+ *
+ * The workers also run tasks, see submit() and parallel_for(), so that callbacks split their
+ * data-parallel work on the threads of the executor instead of starting their own threads.
+ */
+class WorkStealingMultiThreadedExecutor : public executor::Executor
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(WorkStealingMultiThreadedExecutor)
+
+  /// Constructor for WorkStealingMultiThreadedExecutor.
+  /**
+   * \param args common arguments for all executors
+   * \param number_of_threads number of worker threads, the default 0 will use the number of
+   *   cpu cores found instead
+   * \param timeout maximum time the waiter thread blocks in rcl_wait() per iteration
+   */
+  RCLCPP_PUBLIC
+  WorkStealingMultiThreadedExecutor(
+    const executor::ExecutorArgs & args = executor::ExecutorArgs(),
+    size_t number_of_threads = 0,
+    std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1));
+
+  RCLCPP_PUBLIC
+  virtual ~WorkStealingMultiThreadedExecutor();
+
+  RCLCPP_PUBLIC
+  void
+  spin() override;
+
+  /// Return the number of worker threads, the waiter thread is not included.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_threads();
+
+  /// Return how many executables were stolen from another worker's queue since construction.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_steals() const;
+
+  /// Execute the callbacks of a callback group on one worker thread only.
+  /**
+   * The waiter queues the executables of the group for that worker, and the other workers never
+   * steal them, so the data used by the callbacks stays in the cache of one core.
+   * The callbacks of the group then run one at a time, even if the group is Reentrant.
+   *
+   * \param[in] group The callback group.
+   * \param[in] thread_index The index of the worker, less than get_number_of_threads().
+   * \throws std::out_of_range if the index is not the one of a worker.
+   * \throws std::runtime_error if the executor is spinning.
+   */
+  RCLCPP_PUBLIC
+  void
+  assign_callback_group_to_thread(
+    rclcpp::callback_group::CallbackGroup::SharedPtr group,
+    size_t thread_index);
+
+  /// Run a task on a worker thread.
+  /**
+   * The workers run the tasks before the ready callbacks.
+   * A task submitted by a worker is queued for that worker, the other workers steal it when
+   * they have nothing else to run.
+   * A task submitted while the executor isn't spinning runs once it spins.
+   *
+   * Waiting for the returned future in a callback blocks the worker running the callback, use
+   * parallel_for() to wait for the work split by a callback.
+   *
+   * \param[in] task The function to run.
+   * \return A future set once the task ran, holding the exception it threw if any.
+   * \throws std::invalid_argument if the task is empty.
+   */
+  RCLCPP_PUBLIC
+  std::future<void>
+  submit(std::function<void()> task);
+
+  /// Call a function on the chunks of a range of indices, in parallel on the worker threads.
+  /**
+   * The range [begin, end) is split in chunks of grain_size indices, and body is called with
+   * the bounds of each chunk, from any thread.
+   * The calling thread executes the first chunk, then runs the queued tasks until all the
+   * chunks were executed, so a callback calling it works along with the workers instead of
+   * blocking one of them.
+   * If the executor isn't spinning, the calling thread executes all the chunks.
+   *
+   * \param[in] begin The first index.
+   * \param[in] end The index after the last one.
+   * \param[in] grain_size The number of indices of a chunk, 0 to split the range in one chunk
+   *   per worker.
+   * \param[in] body The function called with the first index of a chunk and the index after
+   *   its last one.
+   * \throws the first exception thrown by body, once all the chunks were executed.
+   */
+  RCLCPP_PUBLIC
+  void
+  parallel_for(
+    size_t begin, size_t end, size_t grain_size,
+    const std::function<void(size_t, size_t)> & body);
+
+protected:
+  /// Loop of the waiter thread: wait for work and distribute it into the worker queues.
+  RCLCPP_PUBLIC
+  void
+  wait_and_distribute();
+
+  /// Loop of a worker thread: execute work from its own queue, or steal from the others.
+  RCLCPP_PUBLIC
+  void
+  run(size_t this_thread_number);
+
+private:
+  RCLCPP_DISABLE_COPY(WorkStealingMultiThreadedExecutor)
+
+  using AnyExecutablePtr = std::unique_ptr<executor::AnyExecutable>;
+  using Task = std::function<void()>;
+
+  struct WorkQueue
+  {
+    std::mutex mutex;
+    /// Tasks of submit() and parallel_for(), run before the executables.
+    std::deque<Task> tasks;
+    std::deque<AnyExecutablePtr> executables;
+    /// Executables of the callback groups assigned to the worker, never stolen.
+    std::deque<AnyExecutablePtr> assigned_executables;
+    std::atomic_size_t number_of_assigned {0};
+  };
+
+  struct GroupAssignment
+  {
+    rclcpp::callback_group::CallbackGroup::WeakPtr group;
+    size_t thread_index;
+  };
+
+  /// Return the worker a callback group is assigned to, or the number of workers if none.
+  size_t
+  get_assigned_thread(const rclcpp::callback_group::CallbackGroup::SharedPtr & group) const;
+
+  static const void *
+  get_entity(const executor::AnyExecutable & any_exec);
+
+  AnyExecutablePtr
+  pop_or_steal(size_t this_thread_number);
+
+  /// Queue tasks for the worker of the calling thread, or for the next worker if it isn't one.
+  void
+  push_tasks(std::vector<Task> & tasks);
+
+  /// Take a task of the queue of the worker, or steal one from the other queues.
+  bool
+  pop_or_steal_task(size_t this_thread_number, Task & task);
+
+  /// Return the worker of the calling thread, or the number of workers if it isn't one.
+  size_t
+  get_current_thread_number() const;
+
+  void
+  stop_workers(std::vector<std::thread> & threads);
+
+  size_t number_of_threads_;
+  std::chrono::nanoseconds next_exec_timeout_;
+
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+  size_t next_queue_;
+  /// Only modified while the executor is not spinning.
+  std::unordered_map<const rclcpp::callback_group::CallbackGroup *, GroupAssignment>
+  group_assignments_;
+
+  /// Number of executables sitting in the worker queues.
+  std::atomic_size_t number_of_queued_;
+  /// Number of tasks sitting in the worker queues.
+  std::atomic_size_t number_of_tasks_;
+  std::atomic_size_t next_task_queue_;
+  std::atomic_size_t number_of_steals_;
+  std::mutex work_mutex_;
+  std::condition_variable work_cv_;
+
+  /// Entities which were distributed and not executed yet, to avoid taking them twice.
+  std::mutex in_flight_mutex_;
+  std::condition_variable in_flight_cv_;
+  std::unordered_set<const void *> in_flight_;
+  size_t number_of_completions_;
+};
+
+}  // namespace executors
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXECUTORS__WORK_STEALING_MULTI_THREADED_EXECUTOR_HPP_
@@ -0,0 +1,92 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__ASYNC_LOGGING_HPP_
+#define RCLCPP__EXPERIMENTAL__ASYNC_LOGGING_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Configuration of the asynchronous logging.
+struct AsyncLoggingOptions
+{
+  /// Maximum number of queued log records, rounded up to the next power of two.
+  size_t queue_depth = 1024;
+};
+
+/// Statistics of the asynchronous logging.
+struct AsyncLoggingStatistics
+{
+  /// Number of log records given to the output handler.
+  uint64_t written_count = 0;
+  /// Number of log records dropped because the queue was full.
+  uint64_t dropped_count = 0;
+  /// Number of log records whose logger name or message was truncated.
+  uint64_t truncated_count = 0;
+  /// Largest number of log records which were queued at once.
+  size_t max_queue_depth = 0;
+};
+
+/// Write the logs of the process from a background thread.
+/**
+ * The rcutils output handler in place, which writes to the console, the log file and /rosout,
+ * is replaced by one formatting the message into a lock-free queue.
+ * A thread takes the records from the queue and gives them to the replaced output handler, so
+ * the logging threads don't wait for this output.
+ * When the queue is full, the records are dropped and counted, the logging thread never blocks.
+ *
+ * The messages longer than 1023 characters and the logger names longer than 127 characters are
+ * truncated.
+ * It must be called after rclcpp::init(), which sets the output handler of rcutils.
+ *
+ * \param[in] options configuration of the asynchronous logging.
+ * \throws std::runtime_error if the asynchronous logging is already enabled.
+ */
+RCLCPP_PUBLIC
+void
+enable_async_logging(const AsyncLoggingOptions & options = AsyncLoggingOptions());
+
+/// Write the queued logs, put the replaced output handler back and stop the thread.
+/**
+ * Does nothing if the asynchronous logging isn't enabled.
+ */
+RCLCPP_PUBLIC
+void
+disable_async_logging();
+
+RCLCPP_PUBLIC
+bool
+is_async_logging_enabled();
+
+/// Wait until the logs queued before the call are written.
+RCLCPP_PUBLIC
+void
+flush_async_logging();
+
+/// Return the statistics of the asynchronous logging, since it was last enabled.
+RCLCPP_PUBLIC
+AsyncLoggingStatistics
+get_async_logging_statistics();
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__ASYNC_LOGGING_HPP_
@@ -0,0 +1,85 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__ASYNC_PUBLISH_SENDER_HPP_
+#define RCLCPP__EXPERIMENTAL__ASYNC_PUBLISH_SENDER_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/experimental/async_publisher_queue.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Thread writing the messages of the asynchronous publishers of a context.
+/**
+ * There is one instance per context, see rclcpp::Context::get_sub_context().
+ * The thread is started when the first queue is added, and stopped when the context is shut
+ * down.
+ */
+class AsyncPublishSender
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(AsyncPublishSender)
+
+  RCLCPP_PUBLIC
+  explicit AsyncPublishSender(rclcpp::Context & context);
+
+  RCLCPP_PUBLIC
+  virtual ~AsyncPublishSender();
+
+  /// Add the queue of a publisher, it is removed once destroyed.
+  RCLCPP_PUBLIC
+  void
+  add_queue(std::weak_ptr<AsyncPublisherQueueBase> queue);
+
+  /// Wake up the thread to publish the queued messages.
+  /**
+   * It only locks a mutex if the thread isn't already woken up.
+   */
+  RCLCPP_PUBLIC
+  void
+  notify();
+
+  /// Stop the thread, the messages still queued are published by their publisher destructor.
+  RCLCPP_PUBLIC
+  void
+  stop();
+
+private:
+  void
+  run();
+
+  std::vector<std::weak_ptr<AsyncPublisherQueueBase>> queues_;
+  std::atomic<bool> pending_;
+  bool stop_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable condition_variable_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__ASYNC_PUBLISH_SENDER_HPP_
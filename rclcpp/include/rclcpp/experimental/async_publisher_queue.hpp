@@ -0,0 +1,222 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__ASYNC_PUBLISHER_QUEUE_HPP_
+#define RCLCPP__EXPERIMENTAL__ASYNC_PUBLISHER_QUEUE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "rcl/error_handling.h"
+#include "rcl/publisher.h"
+
+#include "rclcpp/async_publish_options.hpp"
+#include "rclcpp/experimental/lock_free_bounded_queue.hpp"
+#include "rclcpp/logging.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/publisher_base.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Non-templated part of AsyncPublisherQueue<MessageT>, used by the AsyncPublishSender.
+class AsyncPublisherQueueBase
+{
+public:
+  RCLCPP_SMART_PTR_ALIASES_ONLY(AsyncPublisherQueueBase)
+
+  virtual ~AsyncPublisherQueueBase() = default;
+
+  /// Write the queued messages to the middleware, called by the sender thread.
+  /**
+   * The messages are left queued if the publisher is being destroyed, its destructor
+   * publishes them.
+   */
+  virtual void
+  publish_queued() = 0;
+
+  AsyncPublishStatistics
+  get_statistics() const
+  {
+    AsyncPublishStatistics statistics;
+    statistics.queue_depth = get_size();
+    statistics.max_queue_depth = max_queue_depth_.load(std::memory_order_relaxed);
+    statistics.published_count = published_count_.load(std::memory_order_relaxed);
+    statistics.dropped_count = dropped_count_.load(std::memory_order_relaxed);
+    statistics.last_latency =
+      std::chrono::nanoseconds(last_latency_ns_.load(std::memory_order_relaxed));
+    statistics.max_latency =
+      std::chrono::nanoseconds(max_latency_ns_.load(std::memory_order_relaxed));
+    statistics.total_latency =
+      std::chrono::nanoseconds(total_latency_ns_.load(std::memory_order_relaxed));
+    return statistics;
+  }
+
+protected:
+  virtual size_t
+  get_size() const = 0;
+
+  void
+  record_depth(size_t depth)
+  {
+    size_t max_depth = max_queue_depth_.load(std::memory_order_relaxed);
+    while (depth > max_depth &&
+      !max_queue_depth_.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  void
+  record_published(std::chrono::steady_clock::time_point enqueue_time)
+  {
+    int64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - enqueue_time).count();
+    published_count_.fetch_add(1, std::memory_order_relaxed);
+    last_latency_ns_.store(latency, std::memory_order_relaxed);
+    total_latency_ns_.fetch_add(latency, std::memory_order_relaxed);
+    int64_t max_latency = max_latency_ns_.load(std::memory_order_relaxed);
+    while (latency > max_latency &&
+      !max_latency_ns_.compare_exchange_weak(max_latency, latency, std::memory_order_relaxed))
+    {
+    }
+  }
+
+  std::atomic<size_t> max_queue_depth_ {0};
+  std::atomic<uint64_t> published_count_ {0};
+  std::atomic<uint64_t> dropped_count_ {0};
+  std::atomic<int64_t> last_latency_ns_ {0};
+  std::atomic<int64_t> max_latency_ns_ {0};
+  std::atomic<int64_t> total_latency_ns_ {0};
+};
+
+/// Queue of the messages of an asynchronous publisher, waiting for the sender thread.
+/**
+ * publish() pushes the messages without blocking, and the AsyncPublishSender of the context
+ * calls rcl_publish() for them.
+ * It has a weak reference to its publisher, so that the publisher isn't destroyed while the
+ * sender thread uses its handle.
+ */
+template<typename MessageT>
+class AsyncPublisherQueue : public AsyncPublisherQueueBase
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(AsyncPublisherQueue<MessageT>)
+
+  using MessageSharedPtr = std::shared_ptr<const MessageT>;
+
+  AsyncPublisherQueue(
+    std::weak_ptr<rclcpp::PublisherBase> publisher,
+    const rclcpp::AsyncPublishOptions & options)
+  : publisher_(std::move(publisher)),
+    overflow_policy_(options.overflow_policy),
+    queue_(options.queue_depth)
+  {}
+
+  /// Queue a message, applying the overflow policy if the queue is full.
+  /**
+   * \return false if the message was dropped.
+   */
+  bool
+  enqueue(MessageSharedPtr msg)
+  {
+    Item item{std::move(msg), std::chrono::steady_clock::now()};
+    while (!queue_.try_push(std::move(item))) {
+      if (overflow_policy_ == rclcpp::AsyncPublishOverflowPolicy::DropNewest) {
+        dropped_count_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      Item oldest;
+      if (queue_.try_pop(oldest)) {
+        dropped_count_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+    record_depth(queue_.size());
+    return true;
+  }
+
+  void
+  publish_queued() override
+  {
+    auto publisher = publisher_.lock();
+    if (!publisher) {
+      return;
+    }
+    publish_queued(publisher->get_publisher_handle());
+  }
+
+  /// Write the queued messages with the given publisher handle.
+  /**
+   * Errors are logged, as there is no publish() call to report them to.
+   */
+  void
+  publish_queued(rcl_publisher_t * publisher_handle)
+  {
+    Item item;
+    while (queue_.try_pop(item)) {
+      auto status = rcl_publish(publisher_handle, item.msg.get(), nullptr);
+      if (RCL_RET_OK == status) {
+        record_published(item.enqueue_time);
+      } else {
+        log_publish_error(publisher_handle, status);
+      }
+      item.msg.reset();
+    }
+  }
+
+protected:
+  struct Item
+  {
+    MessageSharedPtr msg;
+    std::chrono::steady_clock::time_point enqueue_time;
+  };
+
+  size_t
+  get_size() const override
+  {
+    return queue_.size();
+  }
+
+  static void
+  log_publish_error(rcl_publisher_t * publisher_handle, rcl_ret_t status)
+  {
+    if (RCL_RET_PUBLISHER_INVALID == status) {
+      rcl_reset_error();  // next call will reset error message if not context
+      if (rcl_publisher_is_valid_except_context(publisher_handle)) {
+        rcl_context_t * context = rcl_publisher_get_context(publisher_handle);
+        if (nullptr != context && !rcl_context_is_valid(context)) {
+          // publisher is invalid due to context being shutdown
+          return;
+        }
+      }
+    }
+    RCLCPP_ERROR(
+      rclcpp::get_logger("rclcpp"),
+      "failed to publish queued message: %s", rcl_get_error_string().str);
+    rcl_reset_error();
+  }
+
+  std::weak_ptr<rclcpp::PublisherBase> publisher_;
+  const rclcpp::AsyncPublishOverflowPolicy overflow_policy_;
+  LockFreeBoundedQueue<Item> queue_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__ASYNC_PUBLISHER_QUEUE_HPP_
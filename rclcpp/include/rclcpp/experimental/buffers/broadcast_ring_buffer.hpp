@@ -0,0 +1,132 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__BUFFERS__BROADCAST_RING_BUFFER_HPP_
+#define RCLCPP__EXPERIMENTAL__BUFFERS__BROADCAST_RING_BUFFER_HPP_
+
+#include <shared_mutex>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+namespace buffers
+{
+
+/// Ring of the messages of a publisher, read by all the subscriptions taking shared messages.
+/**
+ * Publishing writes the message once in the ring, whatever the number of subscriptions, instead
+ * of giving it to the buffer of each of them.
+ * Each subscription reads the messages at its own pace with its own cursor, see
+ * SubscriptionIntraProcessBase::add_broadcast_reader(): a subscription which falls behind its
+ * depth skips the oldest messages, as its keep last buffer would have dropped them.
+ *
+ * The messages are type erased, the subscriptions cast them back to their message type.
+ * A message stays in the ring until it is overwritten, i.e. after `capacity` more messages were
+ * published, even if all the subscriptions read it.
+ */
+class BroadcastRingBuffer
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(BroadcastRingBuffer)
+
+  /// Construct a ring of the given capacity.
+  /**
+   * \throws std::invalid_argument if the capacity is 0.
+   */
+  explicit BroadcastRingBuffer(size_t capacity)
+  : slots_(capacity), write_sequence_(0)
+  {
+    if (capacity == 0) {
+      throw std::invalid_argument("capacity must be a positive, non-zero value");
+    }
+  }
+
+  /// Write a message, overwriting the oldest one if the ring is full.
+  void
+  write(std::shared_ptr<const void> message)
+  {
+    std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+    uint64_t sequence = write_sequence_.load(std::memory_order_relaxed);
+    slots_[sequence % slots_.size()] = std::move(message);
+    write_sequence_.store(sequence + 1, std::memory_order_release);
+  }
+
+  /// Return the number of messages written since the ring was constructed.
+  /**
+   * It is read without locking, to check whether a reader has messages to read.
+   */
+  uint64_t
+  get_write_sequence() const
+  {
+    return write_sequence_.load(std::memory_order_acquire);
+  }
+
+  /// Read the messages written from the cursor on, and move the cursor past them.
+  /**
+   * If more than `depth` messages weren't read, the oldest ones are skipped.
+   *
+   * \param[inout] cursor the sequence of the next message to read.
+   * \param[in] depth the number of messages kept for the reader, at most the capacity.
+   * \param[out] messages the messages read are appended to it.
+   * \param[in] max_count the maximum number of messages read.
+   * \return the number of messages skipped.
+   */
+  size_t
+  read(
+    uint64_t & cursor, size_t depth,
+    std::vector<std::shared_ptr<const void>> & messages, size_t max_count) const
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    uint64_t end = write_sequence_.load(std::memory_order_relaxed);
+    uint64_t oldest = end - std::min<uint64_t>(end, std::min(depth, slots_.size()));
+    size_t skipped = 0;
+    if (cursor < oldest) {
+      skipped = static_cast<size_t>(oldest - cursor);
+      cursor = oldest;
+    }
+    for (; cursor < end && max_count > 0; ++cursor, --max_count) {
+      messages.push_back(slots_[cursor % slots_.size()]);
+    }
+    return skipped;
+  }
+
+  size_t
+  capacity() const
+  {
+    return slots_.size();
+  }
+
+private:
+  mutable std::shared_timed_mutex mutex_;
+  std::vector<std::shared_ptr<const void>> slots_;
+  std::atomic<uint64_t> write_sequence_;
+};
+
+}  // namespace buffers
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__BUFFERS__BROADCAST_RING_BUFFER_HPP_
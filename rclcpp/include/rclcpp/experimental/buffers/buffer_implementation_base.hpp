@@ -15,6 +15,9 @@
 #ifndef RCLCPP__EXPERIMENTAL__BUFFERS__BUFFER_IMPLEMENTATION_BASE_HPP_
 #define RCLCPP__EXPERIMENTAL__BUFFERS__BUFFER_IMPLEMENTATION_BASE_HPP_
 
+#include <cstddef>
+#include <vector>
+
 namespace rclcpp
 {
 namespace experimental
@@ -31,8 +34,50 @@ public:
   virtual BufferT dequeue() = 0;
   virtual void enqueue(BufferT request) = 0;
 
+  /// Move up to max_count of the oldest messages to the end of messages, return how many.
+  /**
+   * The default implementation dequeues them one at a time, the implementations with a lock
+   * override it to take them all under one lock.
+   */
+  virtual size_t dequeue_n(std::vector<BufferT> & messages, size_t max_count)
+  {
+    size_t count = 0;
+    while (count < max_count && has_data()) {
+      messages.push_back(dequeue());
+      ++count;
+    }
+    return count;
+  }
+
   virtual void clear() = 0;
   virtual bool has_data() const = 0;
+
+  /// Return the largest number of messages the buffer held, 0 if it is not tracked.
+  virtual size_t get_high_water_mark() const
+  {
+    return 0;
+  }
+
+  /// Return the number of messages dropped because the buffer was full, 0 if it is not tracked.
+  virtual size_t get_dropped_count() const
+  {
+    return 0;
+  }
+
+  /// Return the bytes allocated by the buffer for its slots, 0 if it is not tracked.
+  /**
+   * The messages the slots point to aren't counted.
+   */
+  virtual size_t get_memory_usage() const
+  {
+    return 0;
+  }
+
+  /// Return true if enqueueing a message would drop one, false if it is not tracked.
+  virtual bool is_full() const
+  {
+    return false;
+  }
 };
 
 }  // namespace buffers
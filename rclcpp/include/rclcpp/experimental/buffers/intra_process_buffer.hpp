@@ -15,14 +15,17 @@
 #ifndef RCLCPP__EXPERIMENTAL__BUFFERS__INTRA_PROCESS_BUFFER_HPP_
 #define RCLCPP__EXPERIMENTAL__BUFFERS__INTRA_PROCESS_BUFFER_HPP_
 
+#include <atomic>
 #include <memory>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "rclcpp/allocator/allocator_common.hpp"
 #include "rclcpp/allocator/allocator_deleter.hpp"
 #include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/tracepoints.hpp"
 
 namespace rclcpp
 {
@@ -42,6 +45,21 @@ public:
 
   virtual bool has_data() const = 0;
   virtual bool use_take_shared_method() const = 0;
+
+  /// Return the number of messages copied when adding them to or consuming them from the buffer.
+  virtual size_t get_copy_count() const = 0;
+
+  /// Return the largest number of messages the buffer held, 0 if it is not tracked.
+  virtual size_t get_high_water_mark() const = 0;
+
+  /// Return the number of messages dropped because the buffer was full, 0 if it is not tracked.
+  virtual size_t get_dropped_count() const = 0;
+
+  /// Return true if adding a message would drop one.
+  virtual bool is_full() const = 0;
+
+  /// Return the bytes of the buffer and of its slots, the messages they point to aren't counted.
+  virtual size_t get_memory_usage() const = 0;
 };
 
 template<
@@ -63,6 +81,18 @@ public:
 
   virtual MessageSharedPtr consume_shared() = 0;
   virtual MessageUniquePtr consume_unique() = 0;
+
+  /// Move up to max_count of the oldest messages to the end of messages, return how many.
+  /**
+   * The messages are taken at once from the buffer, instead of one call per message.
+   */
+  virtual size_t consume_shared_n(std::vector<MessageSharedPtr> & messages, size_t max_count) = 0;
+
+  /// Move up to max_count of the oldest messages to the end of messages, return how many.
+  /**
+   * \sa consume_shared_n()
+   */
+  virtual size_t consume_unique_n(std::vector<MessageUniquePtr> & messages, size_t max_count) = 0;
 };
 
 template<
@@ -104,12 +134,14 @@ public:
 
   void add_shared(MessageSharedPtr msg) override
   {
+    RCLCPP_TRACEPOINT(IntraProcessEnqueue, this, msg.get());
     add_shared_impl<BufferT>(std::move(msg));
   }
 
   void add_unique(MessageUniquePtr msg) override
   {
-    buffer_->enqueue(std::move(msg));
+    RCLCPP_TRACEPOINT(IntraProcessEnqueue, this, msg.get());
+    add_unique_impl<BufferT>(std::move(msg));
   }
 
   MessageSharedPtr consume_shared() override
@@ -122,6 +154,16 @@ public:
     return consume_unique_impl<BufferT>();
   }
 
+  size_t consume_shared_n(std::vector<MessageSharedPtr> & messages, size_t max_count) override
+  {
+    return consume_shared_n_impl<BufferT>(messages, max_count);
+  }
+
+  size_t consume_unique_n(std::vector<MessageUniquePtr> & messages, size_t max_count) override
+  {
+    return consume_unique_n_impl<BufferT>(messages, max_count);
+  }
+
   bool has_data() const override
   {
     return buffer_->has_data();
@@ -137,11 +179,38 @@ public:
     return std::is_same<BufferT, MessageSharedPtr>::value;
   }
 
+  size_t get_copy_count() const override
+  {
+    return copy_count_.load(std::memory_order_relaxed);
+  }
+
+  size_t get_high_water_mark() const override
+  {
+    return buffer_->get_high_water_mark();
+  }
+
+  size_t get_dropped_count() const override
+  {
+    return buffer_->get_dropped_count();
+  }
+
+  bool is_full() const override
+  {
+    return buffer_->is_full();
+  }
+
+  size_t get_memory_usage() const override
+  {
+    return sizeof(*this) + buffer_->get_memory_usage();
+  }
+
 private:
   std::unique_ptr<BufferImplementationBase<BufferT>> buffer_;
 
   std::shared_ptr<MessageAlloc> message_allocator_;
 
+  std::atomic<size_t> copy_count_ {0};
+
   // MessageSharedPtr to MessageSharedPtr
   template<typename DestinationT>
   typename std::enable_if<
@@ -161,20 +230,32 @@ private:
   {
     // This should not happen: here a copy is unconditionally made, while the intra-process manager
     // can decide whether a copy is needed depending on the number and the type of buffers
+    buffer_->enqueue(copy_message(shared_msg));
+  }
 
-    MessageUniquePtr unique_msg;
-    MessageDeleter * deleter = std::get_deleter<MessageDeleter, const MessageT>(shared_msg);
-    auto ptr = MessageAllocTraits::allocate(*message_allocator_.get(), 1);
-    MessageAllocTraits::construct(*message_allocator_.get(), ptr, *shared_msg);
-    if (deleter) {
-      unique_msg = MessageUniquePtr(ptr, *deleter);
-    } else {
-      unique_msg = MessageUniquePtr(ptr);
-    }
-
+  // MessageUniquePtr to MessageUniquePtr
+  template<typename DestinationT>
+  typename std::enable_if<
+    std::is_same<DestinationT, MessageUniquePtr>::value
+  >::type
+  add_unique_impl(MessageUniquePtr unique_msg)
+  {
     buffer_->enqueue(std::move(unique_msg));
   }
 
+  // MessageUniquePtr to MessageSharedPtr
+  template<typename DestinationT>
+  typename std::enable_if<
+    std::is_same<DestinationT, MessageSharedPtr>::value
+  >::type
+  add_unique_impl(MessageUniquePtr unique_msg)
+  {
+    // The control block is allocated with the message allocator, as the message was
+    MessageSharedPtr shared_msg(
+      unique_msg.release(), unique_msg.get_deleter(), *message_allocator_.get());
+    buffer_->enqueue(std::move(shared_msg));
+  }
+
   // MessageSharedPtr to MessageSharedPtr
   template<typename OriginT>
   typename std::enable_if<
@@ -183,7 +264,9 @@ private:
   >::type
   consume_shared_impl()
   {
-    return buffer_->dequeue();
+    MessageSharedPtr shared_msg = buffer_->dequeue();
+    RCLCPP_TRACEPOINT(IntraProcessDequeue, this, shared_msg.get());
+    return shared_msg;
   }
 
   // MessageUniquePtr to MessageSharedPtr
@@ -194,11 +277,15 @@ private:
   >::type
   consume_shared_impl()
   {
-    // automatic cast from unique ptr to shared ptr
-    return buffer_->dequeue();
+    // The control block is allocated with the message allocator, as the message was
+    MessageUniquePtr unique_msg = buffer_->dequeue();
+    RCLCPP_TRACEPOINT(IntraProcessDequeue, this, unique_msg.get());
+    return MessageSharedPtr(
+      unique_msg.release(), unique_msg.get_deleter(), *message_allocator_.get());
   }
 
   // MessageSharedPtr to MessageUniquePtr
+  // The copy is made here, by the thread executing the subscription, and not when publishing.
   template<typename OriginT>
   typename std::enable_if<
     (std::is_same<OriginT, MessageSharedPtr>::value),
@@ -207,18 +294,8 @@ private:
   consume_unique_impl()
   {
     MessageSharedPtr buffer_msg = buffer_->dequeue();
-
-    MessageUniquePtr unique_msg;
-    MessageDeleter * deleter = std::get_deleter<MessageDeleter, const MessageT>(buffer_msg);
-    auto ptr = MessageAllocTraits::allocate(*message_allocator_.get(), 1);
-    MessageAllocTraits::construct(*message_allocator_.get(), ptr, *buffer_msg);
-    if (deleter) {
-      unique_msg = MessageUniquePtr(ptr, *deleter);
-    } else {
-      unique_msg = MessageUniquePtr(ptr);
-    }
-
-    return unique_msg;
+    RCLCPP_TRACEPOINT(IntraProcessDequeue, this, buffer_msg.get());
+    return copy_message(buffer_msg);
   }
 
   // MessageUniquePtr to MessageUniquePtr
@@ -229,7 +306,95 @@ private:
   >::type
   consume_unique_impl()
   {
-    return buffer_->dequeue();
+    MessageUniquePtr unique_msg = buffer_->dequeue();
+    RCLCPP_TRACEPOINT(IntraProcessDequeue, this, unique_msg.get());
+    return unique_msg;
+  }
+
+  // MessageSharedPtr to MessageSharedPtr
+  template<typename OriginT>
+  typename std::enable_if<
+    std::is_same<OriginT, MessageSharedPtr>::value,
+    size_t
+  >::type
+  consume_shared_n_impl(std::vector<MessageSharedPtr> & messages, size_t max_count)
+  {
+    size_t begin = messages.size();
+    size_t count = buffer_->dequeue_n(messages, max_count);
+    for (size_t i = begin; i < messages.size(); ++i) {
+      RCLCPP_TRACEPOINT(IntraProcessDequeue, this, messages[i].get());
+    }
+    return count;
+  }
+
+  // MessageUniquePtr to MessageSharedPtr
+  template<typename OriginT>
+  typename std::enable_if<
+    std::is_same<OriginT, MessageUniquePtr>::value,
+    size_t
+  >::type
+  consume_shared_n_impl(std::vector<MessageSharedPtr> & messages, size_t max_count)
+  {
+    std::vector<MessageUniquePtr> unique_msgs;
+    size_t count = buffer_->dequeue_n(unique_msgs, max_count);
+    messages.reserve(messages.size() + count);
+    for (auto & unique_msg : unique_msgs) {
+      RCLCPP_TRACEPOINT(IntraProcessDequeue, this, unique_msg.get());
+      messages.emplace_back(
+        unique_msg.release(), unique_msg.get_deleter(), *message_allocator_.get());
+    }
+    return count;
+  }
+
+  // MessageSharedPtr to MessageUniquePtr
+  template<typename OriginT>
+  typename std::enable_if<
+    std::is_same<OriginT, MessageSharedPtr>::value,
+    size_t
+  >::type
+  consume_unique_n_impl(std::vector<MessageUniquePtr> & messages, size_t max_count)
+  {
+    std::vector<MessageSharedPtr> buffer_msgs;
+    size_t count = buffer_->dequeue_n(buffer_msgs, max_count);
+    messages.reserve(messages.size() + count);
+    for (const auto & buffer_msg : buffer_msgs) {
+      RCLCPP_TRACEPOINT(IntraProcessDequeue, this, buffer_msg.get());
+      messages.push_back(copy_message(buffer_msg));
+    }
+    return count;
+  }
+
+  // MessageUniquePtr to MessageUniquePtr
+  template<typename OriginT>
+  typename std::enable_if<
+    std::is_same<OriginT, MessageUniquePtr>::value,
+    size_t
+  >::type
+  consume_unique_n_impl(std::vector<MessageUniquePtr> & messages, size_t max_count)
+  {
+    size_t begin = messages.size();
+    size_t count = buffer_->dequeue_n(messages, max_count);
+    for (size_t i = begin; i < messages.size(); ++i) {
+      RCLCPP_TRACEPOINT(IntraProcessDequeue, this, messages[i].get());
+    }
+    return count;
+  }
+
+  /// Return a copy of the message, owned by the caller.
+  MessageUniquePtr
+  copy_message(const MessageSharedPtr & shared_msg)
+  {
+    MessageUniquePtr unique_msg;
+    MessageDeleter * deleter = std::get_deleter<MessageDeleter, const MessageT>(shared_msg);
+    auto ptr = MessageAllocTraits::allocate(*message_allocator_.get(), 1);
+    MessageAllocTraits::construct(*message_allocator_.get(), ptr, *shared_msg);
+    if (deleter) {
+      unique_msg = MessageUniquePtr(ptr, *deleter);
+    } else {
+      unique_msg = MessageUniquePtr(ptr);
+    }
+    copy_count_.fetch_add(1, std::memory_order_relaxed);
+    return unique_msg;
   }
 };
 
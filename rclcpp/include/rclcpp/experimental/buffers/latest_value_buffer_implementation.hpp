@@ -0,0 +1,144 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__BUFFERS__LATEST_VALUE_BUFFER_IMPLEMENTATION_HPP_
+#define RCLCPP__EXPERIMENTAL__BUFFERS__LATEST_VALUE_BUFFER_IMPLEMENTATION_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+#include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
+#include "rclcpp/logger.hpp"
+#include "rclcpp/logging.hpp"
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+namespace buffers
+{
+
+/// Buffer of a single slot, which only keeps the latest message.
+/**
+ * Enqueueing replaces the message not dequeued yet, which is dropped: a consumer slower than
+ * the producers only ever gets the newest message instead of working through a backlog.
+ *
+ * The slot holds a pointer to a node which is swapped with an atomic exchange, so neither
+ * producers nor consumers take a lock, and any number of them may run concurrently.
+ * The node of a dequeued or dropped message is kept for the next enqueue, so once warmed up
+ * the buffer doesn't allocate.
+ */
+template<typename BufferT>
+class LatestValueBufferImplementation : public BufferImplementationBase<BufferT>
+{
+public:
+  LatestValueBufferImplementation()
+  : slot_(nullptr),
+    free_node_(nullptr),
+    dropped_count_(0)
+  {}
+
+  virtual ~LatestValueBufferImplementation()
+  {
+    delete slot_.load();
+    delete free_node_.load();
+  }
+
+  void enqueue(BufferT request)
+  {
+    Node * node = free_node_.exchange(nullptr, std::memory_order_acquire);
+    if (!node) {
+      node = new Node;
+    }
+    node->data = std::move(request);
+    Node * replaced = slot_.exchange(node, std::memory_order_acq_rel);
+    if (replaced) {
+      dropped_count_.fetch_add(1, std::memory_order_relaxed);
+      recycle(replaced);
+    }
+  }
+
+  BufferT dequeue()
+  {
+    Node * node = slot_.exchange(nullptr, std::memory_order_acq_rel);
+    if (!node) {
+      RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "Calling dequeue on empty intra-process buffer");
+      throw std::runtime_error("Calling dequeue on empty intra-process buffer");
+    }
+    BufferT request = std::move(node->data);
+    recycle(node);
+    return request;
+  }
+
+  bool has_data() const
+  {
+    return slot_.load(std::memory_order_acquire) != nullptr;
+  }
+
+  void clear()
+  {
+    Node * node = slot_.exchange(nullptr, std::memory_order_acq_rel);
+    if (node) {
+      recycle(node);
+    }
+  }
+
+  /// Return the number of messages replaced before being dequeued.
+  size_t get_dropped_count() const
+  {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+  /// Return true if the slot holds a message, which the next enqueue replaces.
+  bool is_full() const
+  {
+    return has_data();
+  }
+
+  /// Return the bytes of the slot holding the latest message and of the one kept for reuse.
+  size_t get_memory_usage() const
+  {
+    size_t nodes = (slot_.load(std::memory_order_acquire) ? 1 : 0) +
+      (free_node_.load(std::memory_order_acquire) ? 1 : 0);
+    return nodes * sizeof(Node);
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(LatestValueBufferImplementation)
+
+  struct Node
+  {
+    BufferT data;
+  };
+
+  /// Release the message of a node, and keep the node for the next enqueue.
+  void recycle(Node * node)
+  {
+    node->data = BufferT();
+    delete free_node_.exchange(node, std::memory_order_acq_rel);
+  }
+
+  std::atomic<Node *> slot_;
+  std::atomic<Node *> free_node_;
+  std::atomic<size_t> dropped_count_;
+};
+
+}  // namespace buffers
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__BUFFERS__LATEST_VALUE_BUFFER_IMPLEMENTATION_HPP_
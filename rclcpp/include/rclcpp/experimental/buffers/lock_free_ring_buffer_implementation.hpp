@@ -0,0 +1,256 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__BUFFERS__LOCK_FREE_RING_BUFFER_IMPLEMENTATION_HPP_
+#define RCLCPP__EXPERIMENTAL__BUFFERS__LOCK_FREE_RING_BUFFER_IMPLEMENTATION_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
+#include "rclcpp/logger.hpp"
+#include "rclcpp/logging.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+namespace buffers
+{
+
+/// Ring buffer which does not take a lock, keeping the last `capacity` messages.
+/**
+ * Every slot has a sequence number telling whether it is free or holds a message for a given
+ * lap around the buffer, so producers and consumers claim slots with atomic operations only.
+ * The slots are indexed with a mask, their number is the capacity rounded up to a power of two,
+ * and at least two.
+ * Like RingBufferImplementation, enqueueing into a full buffer drops the oldest message.
+ *
+ * Any number of threads may dequeue concurrently, since a producer which finds the buffer full
+ * drops the oldest message by dequeueing it.
+ * With MultipleProducers false, only one thread at a time may enqueue.
+ * With several producers, the buffer may briefly hold more than `capacity` messages, up to the
+ * number of slots.
+ */
+template<typename BufferT, bool MultipleProducers>
+class LockFreeRingBufferImplementation : public BufferImplementationBase<BufferT>
+{
+public:
+  explicit LockFreeRingBufferImplementation(size_t capacity)
+  : capacity_(capacity),
+    mask_(round_up_to_power_of_two(std::max<size_t>(capacity, 2)) - 1),
+    slots_(new Slot[mask_ + 1]),
+    enqueue_index_(0),
+    dequeue_index_(0),
+    dropped_count_(0)
+  {
+    if (capacity == 0) {
+      throw std::invalid_argument("capacity must be a positive, non-zero value");
+    }
+    for (size_t i = 0; i <= mask_; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  virtual ~LockFreeRingBufferImplementation() {}
+
+  void enqueue(BufferT request)
+  {
+    size_t index = enqueue_index_.load(std::memory_order_relaxed);
+    Slot * slot = nullptr;
+    for (;;) {
+      size_t dequeue_index = dequeue_index_.load(std::memory_order_acquire);
+      if (index >= dequeue_index && index - dequeue_index >= capacity_) {
+        // Full, drop the oldest message.
+        if (discard_oldest()) {
+          dropped_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+        index = enqueue_index_.load(std::memory_order_relaxed);
+        continue;
+      }
+      slot = &slots_[index & mask_];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      if (sequence == index) {
+        // The slot is free for this lap.
+        if (!MultipleProducers) {
+          enqueue_index_.store(index + 1, std::memory_order_relaxed);
+          break;
+        }
+        if (enqueue_index_.compare_exchange_weak(index, index + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (sequence < index) {
+        // The slot still holds the message of the previous lap.
+        if (index - dequeue_index_.load(std::memory_order_acquire) > mask_) {
+          // Every slot is used, only possible with several producers.
+          if (discard_oldest()) {
+            dropped_count_.fetch_add(1, std::memory_order_relaxed);
+          }
+        } else {
+          // A consumer has claimed the message but not released the slot yet.
+          std::this_thread::yield();
+        }
+        index = enqueue_index_.load(std::memory_order_relaxed);
+      } else {
+        // Another producer claimed the slot.
+        index = enqueue_index_.load(std::memory_order_relaxed);
+      }
+    }
+    slot->data = std::move(request);
+    slot->sequence.store(index + 1, std::memory_order_release);
+  }
+
+  BufferT dequeue()
+  {
+    BufferT request;
+    if (!try_dequeue(request)) {
+      RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "Calling dequeue on empty intra-process buffer");
+      throw std::runtime_error("Calling dequeue on empty intra-process buffer");
+    }
+    return request;
+  }
+
+  size_t dequeue_n(std::vector<BufferT> & messages, size_t max_count)
+  {
+    size_t count = 0;
+    BufferT request;
+    while (count < max_count && try_dequeue(request)) {
+      messages.push_back(std::move(request));
+      ++count;
+    }
+    return count;
+  }
+
+  bool has_data() const
+  {
+    size_t index = dequeue_index_.load(std::memory_order_acquire);
+    return slots_[index & mask_].sequence.load(std::memory_order_acquire) == index + 1;
+  }
+
+  void clear()
+  {
+    while (discard_oldest()) {
+    }
+  }
+
+  size_t capacity() const
+  {
+    return capacity_;
+  }
+
+  /// Return the number of messages dropped by the producers because the buffer was full.
+  size_t get_dropped_count() const
+  {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+  /// Return true if the buffer holds `capacity` messages, it may be stale when returned.
+  bool is_full() const
+  {
+    size_t dequeue_index = dequeue_index_.load(std::memory_order_acquire);
+    size_t enqueue_index = enqueue_index_.load(std::memory_order_acquire);
+    return enqueue_index >= dequeue_index && enqueue_index - dequeue_index >= capacity_;
+  }
+
+  /// Return the bytes of the slots, allocated up front.
+  size_t get_memory_usage() const
+  {
+    return (mask_ + 1) * sizeof(Slot);
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(LockFreeRingBufferImplementation)
+
+  struct Slot
+  {
+    /// index + 1 when it holds the message of `index`, index + number of slots once free again.
+    std::atomic<size_t> sequence;
+    BufferT data;
+  };
+
+  static constexpr size_t cache_line_size = 64;
+
+  static size_t
+  round_up_to_power_of_two(size_t value)
+  {
+    size_t power = 1;
+    while (power < value) {
+      power <<= 1;
+    }
+    return power;
+  }
+
+  bool try_dequeue(BufferT & request)
+  {
+    size_t index = dequeue_index_.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot & slot = slots_[index & mask_];
+      size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      if (sequence == index + 1) {
+        if (dequeue_index_.compare_exchange_weak(index, index + 1, std::memory_order_relaxed)) {
+          request = std::move(slot.data);
+          slot.sequence.store(index + mask_ + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (sequence < index + 1) {
+        // Empty, or the producer has not finished writing the message.
+        return false;
+      } else {
+        // Another consumer took the message.
+        index = dequeue_index_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool discard_oldest()
+  {
+    BufferT discarded;
+    return try_dequeue(discarded);
+  }
+
+  const size_t capacity_;
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+
+  // Keep the indices on their own cache lines, they are written by different threads.
+  char slots_padding_[cache_line_size];
+  std::atomic<size_t> enqueue_index_;
+  char enqueue_index_padding_[cache_line_size - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> dequeue_index_;
+  char dequeue_index_padding_[cache_line_size - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> dropped_count_;
+};
+
+/// Lock-free ring buffer for a single publishing thread.
+template<typename BufferT>
+using SpscRingBufferImplementation = LockFreeRingBufferImplementation<BufferT, false>;
+
+/// Lock-free ring buffer for several publishing threads.
+template<typename BufferT>
+using MpscRingBufferImplementation = LockFreeRingBufferImplementation<BufferT, true>;
+
+}  // namespace buffers
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__BUFFERS__LOCK_FREE_RING_BUFFER_IMPLEMENTATION_HPP_
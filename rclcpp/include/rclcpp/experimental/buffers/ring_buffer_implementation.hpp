@@ -46,7 +46,9 @@ public:
     ring_buffer_(capacity),
     write_index_(capacity_ - 1),
     read_index_(0),
-    size_(0)
+    size_(0),
+    high_water_mark_(0),
+    dropped_count_(0)
   {
     if (capacity == 0) {
       throw std::invalid_argument("capacity must be a positive, non-zero value");
@@ -62,10 +64,12 @@ public:
     write_index_ = next(write_index_);
     ring_buffer_[write_index_] = std::move(request);
 
-    if (is_full()) {
+    if (size_ == capacity_) {
       read_index_ = next(read_index_);
+      dropped_count_++;
     } else {
       size_++;
+      high_water_mark_ = std::max(high_water_mark_, size_);
     }
   }
 
@@ -86,6 +90,21 @@ public:
     return request;
   }
 
+  size_t dequeue_n(std::vector<BufferT> & messages, size_t max_count)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    size_t count = std::min(size_, max_count);
+    messages.reserve(messages.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+      messages.push_back(std::move(ring_buffer_[read_index_]));
+      read_index_ = next(read_index_);
+    }
+    size_ -= count;
+
+    return count;
+  }
+
   inline size_t next(size_t val)
   {
     return (val + 1) % capacity_;
@@ -96,13 +115,31 @@ public:
     return size_ != 0;
   }
 
-  inline bool is_full()
+  inline bool is_full() const
   {
+    std::lock_guard<std::mutex> lock(mutex_);
     return size_ == capacity_;
   }
 
   void clear() {}
 
+  size_t get_high_water_mark() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return high_water_mark_;
+  }
+
+  size_t get_dropped_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_count_;
+  }
+
+  size_t get_memory_usage() const
+  {
+    return ring_buffer_.capacity() * sizeof(BufferT);
+  }
+
 private:
   size_t capacity_;
 
@@ -111,8 +148,10 @@ private:
   size_t write_index_;
   size_t read_index_;
   size_t size_;
+  size_t high_water_mark_;
+  size_t dropped_count_;
 
-  std::mutex mutex_;
+  mutable std::mutex mutex_;
 };
 
 }  // namespace buffers
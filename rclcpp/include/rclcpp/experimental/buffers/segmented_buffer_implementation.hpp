@@ -0,0 +1,234 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__BUFFERS__SEGMENTED_BUFFER_IMPLEMENTATION_HPP_
+#define RCLCPP__EXPERIMENTAL__BUFFERS__SEGMENTED_BUFFER_IMPLEMENTATION_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
+#include "rclcpp/logger.hpp"
+#include "rclcpp/logging.hpp"
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+namespace buffers
+{
+
+/// FIFO buffer growing by fixed size segments, optionally bounded.
+/**
+ * The messages are stored in contiguous segments, allocated when the last one is full, so
+ * bursts are buffered instead of dropped without reallocating or moving the messages already
+ * stored.
+ * A segment emptied by the consumer is kept for reuse, so a buffer whose size oscillates
+ * doesn't allocate on each burst.
+ *
+ * With a capacity, the oldest message is dropped when the buffer is full, like with
+ * RingBufferImplementation, but the memory only grows as needed.
+ * Without a capacity, e.g. for a KEEP_ALL history, nothing is ever dropped.
+ *
+ * get_high_water_mark() reports the largest number of messages the buffer held, which can be
+ * used to size the buffers, the same way the history caches of the middleware are.
+ */
+template<typename BufferT>
+class SegmentedBufferImplementation : public BufferImplementationBase<BufferT>
+{
+public:
+  /// Number of messages of a segment when none is given.
+  static constexpr size_t default_segment_size = 64;
+
+  /// Constructor.
+  /**
+   * \param[in] segment_size Number of messages of each segment.
+   * \param[in] capacity Maximum number of messages, 0 for no maximum.
+   * \throws std::invalid_argument if the segment size is 0.
+   */
+  explicit SegmentedBufferImplementation(
+    size_t segment_size = default_segment_size, size_t capacity = 0)
+  : segment_size_(segment_size),
+    capacity_(capacity),
+    read_index_(0),
+    write_index_(0),
+    size_(0),
+    high_water_mark_(0),
+    dropped_count_(0)
+  {
+    if (segment_size == 0) {
+      throw std::invalid_argument("segment size must be a positive, non-zero value");
+    }
+  }
+
+  virtual ~SegmentedBufferImplementation() {}
+
+  void enqueue(BufferT request)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (capacity_ && size_ == capacity_) {
+      pop_front();
+      ++dropped_count_;
+    }
+    if (segments_.empty() || write_index_ == segment_size_) {
+      segments_.push_back(take_spare_segment());
+      write_index_ = 0;
+    }
+    segments_.back()[write_index_++] = std::move(request);
+    ++size_;
+    high_water_mark_ = std::max(high_water_mark_, size_);
+  }
+
+  BufferT dequeue()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (size_ == 0) {
+      RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), "Calling dequeue on empty intra-process buffer");
+      throw std::runtime_error("Calling dequeue on empty intra-process buffer");
+    }
+    return pop_front();
+  }
+
+  size_t dequeue_n(std::vector<BufferT> & messages, size_t max_count)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    size_t count = std::min(size_, max_count);
+    messages.reserve(messages.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+      messages.push_back(pop_front());
+    }
+    return count;
+  }
+
+  bool has_data() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_ != 0;
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (size_ != 0) {
+      pop_front();
+    }
+  }
+
+  /// Return the number of messages in the buffer.
+  size_t size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+  }
+
+  /// Return the largest number of messages the buffer held.
+  size_t get_high_water_mark() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return high_water_mark_;
+  }
+
+  /// Return the number of messages dropped because the buffer was full.
+  size_t get_dropped_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_count_;
+  }
+
+  /// Return true if the buffer has a capacity and holds that many messages.
+  bool is_full() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return capacity_ && size_ == capacity_;
+  }
+
+  /// Return the number of segments allocated, including the one kept for reuse.
+  size_t get_segment_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return segments_.size() + (spare_segment_.empty() ? 0 : 1);
+  }
+
+  /// Return the bytes of the segments allocated, including the one kept for reuse.
+  size_t get_memory_usage() const
+  {
+    return get_segment_count() * segment_size_ * sizeof(BufferT);
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(SegmentedBufferImplementation)
+
+  using Segment = std::vector<BufferT>;
+
+  /// Remove the oldest message, the buffer must not be empty and the mutex must be locked.
+  BufferT pop_front()
+  {
+    BufferT request = std::move(segments_.front()[read_index_]);
+    segments_.front()[read_index_] = BufferT();
+    ++read_index_;
+    --size_;
+    if (size_ == 0) {
+      // Restart at the beginning of the segment instead of moving to a new one.
+      read_index_ = 0;
+      write_index_ = 0;
+    } else if (read_index_ == segment_size_) {
+      spare_segment_ = std::move(segments_.front());
+      segments_.pop_front();
+      read_index_ = 0;
+    }
+    return request;
+  }
+
+  Segment take_spare_segment()
+  {
+    if (spare_segment_.empty()) {
+      return Segment(segment_size_);
+    }
+    return std::move(spare_segment_);
+  }
+
+  const size_t segment_size_;
+  const size_t capacity_;
+
+  std::deque<Segment> segments_;
+  /// Segment emptied by the consumer, reused by the next segment needed.
+  Segment spare_segment_;
+  /// Index of the oldest message in the first segment.
+  size_t read_index_;
+  /// Index of the next message in the last segment.
+  size_t write_index_;
+  size_t size_;
+  size_t high_water_mark_;
+  size_t dropped_count_;
+
+  mutable std::mutex mutex_;
+};
+
+template<typename BufferT>
+constexpr size_t SegmentedBufferImplementation<BufferT>::default_segment_size;
+
+}  // namespace buffers
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__BUFFERS__SEGMENTED_BUFFER_IMPLEMENTATION_HPP_
@@ -0,0 +1,151 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__BUFFERS__SHARED_MEMORY_RING_BUFFER_IMPLEMENTATION_HPP_
+#define RCLCPP__EXPERIMENTAL__BUFFERS__SHARED_MEMORY_RING_BUFFER_IMPLEMENTATION_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "rcl/types.h"
+
+#include "rclcpp/experimental/buffers/buffer_implementation_base.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+namespace buffers
+{
+
+/// Ring buffer of serialized messages in a named shared memory segment.
+/**
+ * It is used to pass serialized messages between processes on the same host.
+ * The process creating the segment is the only one which can enqueue; any number of processes
+ * can open the segment and dequeue. Each instance keeps its own read position, starting with
+ * the messages enqueued after it was constructed, so every reader gets every message.
+ *
+ * The segment has `capacity` slots of `max_message_size` bytes. The writer overwrites the
+ * oldest slot without waiting for the readers, a reader which falls behind skips the messages
+ * which were overwritten. Every slot has a sequence number which is odd while the slot is
+ * written, so a reader detects a message overwritten while it copies it out.
+ *
+ * Dequeued messages are copied out of the segment, as the slot may be reused by the writer.
+ *
+ * Only available on POSIX systems, the constructors throw std::runtime_error otherwise.
+ */
+class SharedMemoryRingBufferImplementation
+  : public BufferImplementationBase<std::shared_ptr<const rcl_serialized_message_t>>
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(SharedMemoryRingBufferImplementation)
+
+  using MessageSharedPtr = std::shared_ptr<const rcl_serialized_message_t>;
+
+  /// Create the shared memory segment, replacing any existing segment with the same name.
+  /**
+   * \param[in] name of the segment, a leading '/' is added if missing.
+   * \param[in] capacity number of messages kept in the segment.
+   * \param[in] max_message_size size in bytes of the largest message which can be enqueued.
+   * \throws std::invalid_argument if the capacity or the maximum message size are zero.
+   * \throws std::runtime_error if the segment can't be created.
+   */
+  RCLCPP_PUBLIC
+  SharedMemoryRingBufferImplementation(
+    const std::string & name,
+    size_t capacity,
+    size_t max_message_size);
+
+  /// Open an existing shared memory segment, to dequeue from it.
+  /**
+   * \param[in] name of the segment, a leading '/' is added if missing.
+   * \throws std::runtime_error if the segment doesn't exist or is not initialized.
+   */
+  RCLCPP_PUBLIC
+  explicit SharedMemoryRingBufferImplementation(const std::string & name);
+
+  /// Unmap the segment, and remove it if it was created by this instance.
+  RCLCPP_PUBLIC
+  virtual ~SharedMemoryRingBufferImplementation();
+
+  /// Copy a serialized message into the segment.
+  /**
+   * \throws std::runtime_error if this instance did not create the segment.
+   * \throws std::invalid_argument if the message is larger than the maximum message size.
+   */
+  RCLCPP_PUBLIC
+  void
+  enqueue(MessageSharedPtr request) override;
+
+  /// Copy the next message out of the segment, nullptr if there is none.
+  RCLCPP_PUBLIC
+  MessageSharedPtr
+  dequeue() override;
+
+  /// Skip all the messages which are in the segment.
+  RCLCPP_PUBLIC
+  void
+  clear() override;
+
+  RCLCPP_PUBLIC
+  bool
+  has_data() const override;
+
+  /// Return the number of messages overwritten before this instance could dequeue them.
+  RCLCPP_PUBLIC
+  size_t
+  get_dropped_count() const override;
+
+  /// Return the bytes of the shared memory segment mapped by this instance.
+  RCLCPP_PUBLIC
+  size_t
+  get_memory_usage() const override;
+
+  RCLCPP_PUBLIC
+  size_t
+  capacity() const;
+
+  RCLCPP_PUBLIC
+  size_t
+  max_message_size() const;
+
+private:
+  struct Header;
+  struct SlotHeader;
+
+  void
+  map(size_t size, bool create);
+
+  SlotHeader *
+  get_slot(uint64_t message_index) const;
+
+  std::string name_;
+  bool owner_;
+  int fd_;
+  void * memory_;
+  size_t memory_size_;
+  Header * header_;
+  uint64_t read_count_;
+  uint64_t dropped_count_;
+};
+
+}  // namespace buffers
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__BUFFERS__SHARED_MEMORY_RING_BUFFER_IMPLEMENTATION_HPP_
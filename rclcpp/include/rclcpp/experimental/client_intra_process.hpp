@@ -0,0 +1,104 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__EXPERIMENTAL__CLIENT_INTRA_PROCESS_HPP_
+#define RCLCPP__EXPERIMENTAL__CLIENT_INTRA_PROCESS_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "rcl/guard_condition.h"
+#include "rcl/wait.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+
+class ClientBase;
+
+namespace experimental
+{
+
+/// Waitable executing a client with the responses of the services of its process.
+/**
+ * It is added to the callback group of the client, see IntraProcessServiceManager, so the
+ * responses are handled by the executor spinning the client, like the ones taken from the
+ * middleware.
+ */
+class ClientIntraProcess : public rclcpp::Waitable
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(ClientIntraProcess)
+
+  /**
+   * \param[in] client The client, not kept alive by the waitable.
+   * \param[in] context The context of the guard condition waking up the executor.
+   * \throws std::runtime_error if the guard condition can't be initialized.
+   */
+  RCLCPP_PUBLIC
+  ClientIntraProcess(
+    std::shared_ptr<rclcpp::ClientBase> client,
+    rclcpp::Context::SharedPtr context);
+
+  RCLCPP_PUBLIC
+  virtual ~ClientIntraProcess();
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_ready_guard_conditions() override;
+
+  RCLCPP_PUBLIC
+  bool
+  add_to_wait_set(rcl_wait_set_t * wait_set) override;
+
+  RCLCPP_PUBLIC
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override;
+
+  /// Handle the responses queued so far.
+  RCLCPP_PUBLIC
+  void
+  execute() override;
+
+  /// Queue the response to a request and wake up the executor.
+  /**
+   * \param[in] sequence_number The sequence number of the request.
+   * \param[in] response The response, of the response type of the client.
+   */
+  RCLCPP_PUBLIC
+  void
+  provide_response(int64_t sequence_number, std::shared_ptr<void> response);
+
+private:
+  RCLCPP_DISABLE_COPY(ClientIntraProcess)
+
+  std::weak_ptr<rclcpp::ClientBase> client_;
+
+  std::mutex responses_mutex_;
+  std::vector<std::pair<int64_t, std::shared_ptr<void>>> responses_;
+  rcl_guard_condition_t gc_ = rcl_get_zero_initialized_guard_condition();
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__CLIENT_INTRA_PROCESS_HPP_
@@ -15,14 +15,19 @@
 #ifndef RCLCPP__EXPERIMENTAL__CREATE_INTRA_PROCESS_BUFFER_HPP_
 #define RCLCPP__EXPERIMENTAL__CREATE_INTRA_PROCESS_BUFFER_HPP_
 
+#include <algorithm>
 #include <memory>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
 
 #include "rcl/subscription.h"
 
 #include "rclcpp/experimental/buffers/intra_process_buffer.hpp"
+#include "rclcpp/experimental/buffers/latest_value_buffer_implementation.hpp"
+#include "rclcpp/experimental/buffers/lock_free_ring_buffer_implementation.hpp"
 #include "rclcpp/experimental/buffers/ring_buffer_implementation.hpp"
+#include "rclcpp/experimental/buffers/segmented_buffer_implementation.hpp"
 #include "rclcpp/intra_process_buffer_type.hpp"
 
 namespace rclcpp
@@ -30,6 +35,70 @@ namespace rclcpp
 namespace experimental
 {
 
+/// Return the implementation used for a QoS, a KEEP_ALL history replaces RingBuffer.
+/**
+ * The SegmentedBuffer implementation is used instead, it is unbounded with a KEEP_ALL history.
+ *
+ * \throws std::invalid_argument if the implementation can't be used with a KEEP_ALL history.
+ */
+inline
+IntraProcessBufferImplementation
+resolve_buffer_implementation(
+  IntraProcessBufferImplementation buffer_implementation,
+  const rmw_qos_profile_t & qos)
+{
+  if (qos.history != RMW_QOS_POLICY_HISTORY_KEEP_ALL) {
+    return buffer_implementation;
+  }
+  switch (buffer_implementation) {
+    case IntraProcessBufferImplementation::RingBuffer:
+      return IntraProcessBufferImplementation::SegmentedBuffer;
+    case IntraProcessBufferImplementation::SegmentedBuffer:
+    case IntraProcessBufferImplementation::LatestValue:
+      return buffer_implementation;
+    default:
+      throw std::invalid_argument(
+              "lock-free intra-process buffers are not allowed with keep all history qos policy");
+  }
+}
+
+/// Create a buffer implementation.
+/**
+ * \param buffer_implementation the implementation, already resolved for the QoS.
+ * \param buffer_size the maximum number of messages, 0 for no maximum, which is only
+ *   allowed for the SegmentedBuffer and LatestValue implementations.
+ */
+template<typename BufferT>
+std::unique_ptr<rclcpp::experimental::buffers::BufferImplementationBase<BufferT>>
+create_buffer_implementation(
+  IntraProcessBufferImplementation buffer_implementation,
+  size_t buffer_size)
+{
+  using rclcpp::experimental::buffers::LatestValueBufferImplementation;
+  using rclcpp::experimental::buffers::MpscRingBufferImplementation;
+  using rclcpp::experimental::buffers::RingBufferImplementation;
+  using rclcpp::experimental::buffers::SegmentedBufferImplementation;
+  using rclcpp::experimental::buffers::SpscRingBufferImplementation;
+  constexpr size_t default_segment_size =
+    SegmentedBufferImplementation<BufferT>::default_segment_size;
+  switch (buffer_implementation) {
+    case IntraProcessBufferImplementation::RingBuffer:
+      return std::make_unique<RingBufferImplementation<BufferT>>(buffer_size);
+    case IntraProcessBufferImplementation::SpscRingBuffer:
+      return std::make_unique<SpscRingBufferImplementation<BufferT>>(buffer_size);
+    case IntraProcessBufferImplementation::MpscRingBuffer:
+      return std::make_unique<MpscRingBufferImplementation<BufferT>>(buffer_size);
+    case IntraProcessBufferImplementation::LatestValue:
+      return std::make_unique<LatestValueBufferImplementation<BufferT>>();
+    case IntraProcessBufferImplementation::SegmentedBuffer:
+      return std::make_unique<SegmentedBufferImplementation<BufferT>>(
+        buffer_size ? std::min(buffer_size, default_segment_size) : default_segment_size,
+        buffer_size);
+    default:
+      throw std::runtime_error("Unrecognized IntraProcessBufferImplementation value");
+  }
+}
+
 template<
   typename MessageT,
   typename Alloc = std::allocator<void>,
@@ -38,12 +107,16 @@ typename rclcpp::experimental::buffers::IntraProcessBuffer<MessageT, Alloc, Dele
 create_intra_process_buffer(
   IntraProcessBufferType buffer_type,
   rmw_qos_profile_t qos,
-  std::shared_ptr<Alloc> allocator)
+  std::shared_ptr<Alloc> allocator,
+  IntraProcessBufferImplementation buffer_implementation =
+  IntraProcessBufferImplementation::RingBuffer)
 {
   using MessageSharedPtr = std::shared_ptr<const MessageT>;
   using MessageUniquePtr = std::unique_ptr<MessageT, Deleter>;
 
-  size_t buffer_size = qos.depth;
+  // A KEEP_ALL history is not bounded by its depth.
+  buffer_implementation = resolve_buffer_implementation(buffer_implementation, qos);
+  size_t buffer_size = qos.history == RMW_QOS_POLICY_HISTORY_KEEP_ALL ? 0 : qos.depth;
 
   using rclcpp::experimental::buffers::IntraProcessBuffer;
   typename IntraProcessBuffer<MessageT, Alloc, Deleter>::UniquePtr buffer;
@@ -53,15 +126,14 @@ create_intra_process_buffer(
       {
         using BufferT = MessageSharedPtr;
 
-        auto buffer_implementation =
-          std::make_unique<rclcpp::experimental::buffers::RingBufferImplementation<BufferT>>(
-          buffer_size);
+        auto implementation =
+          create_buffer_implementation<BufferT>(buffer_implementation, buffer_size);
 
         // Construct the intra_process_buffer
         buffer =
           std::make_unique<rclcpp::experimental::buffers::TypedIntraProcessBuffer<MessageT, Alloc,
             Deleter, BufferT>>(
-          std::move(buffer_implementation),
+          std::move(implementation),
           allocator);
 
         break;
@@ -70,15 +142,14 @@ create_intra_process_buffer(
       {
         using BufferT = MessageUniquePtr;
 
-        auto buffer_implementation =
-          std::make_unique<rclcpp::experimental::buffers::RingBufferImplementation<BufferT>>(
-          buffer_size);
+        auto implementation =
+          create_buffer_implementation<BufferT>(buffer_implementation, buffer_size);
 
         // Construct the intra_process_buffer
         buffer =
           std::make_unique<rclcpp::experimental::buffers::TypedIntraProcessBuffer<MessageT, Alloc,
             Deleter, BufferT>>(
-          std::move(buffer_implementation),
+          std::move(implementation),
           allocator);
 
         break;
@@ -0,0 +1,195 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__EXPERIMENTAL__FLIGHT_RECORDER_HPP_
+#define RCLCPP__EXPERIMENTAL__FLIGHT_RECORDER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rcl/types.h"
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Options of a FlightRecorder.
+struct FlightRecorderOptions
+{
+  /// Path of the file keeping the recording, replaced if it exists.
+  std::string path;
+  /// Number of messages kept, the oldest message is overwritten when it is full.
+  size_t capacity = 4096;
+  /// Size in bytes of the largest serialized message which can be recorded.
+  size_t max_message_size = 64 * 1024;
+};
+
+/// A message read from a recording.
+struct FlightRecord
+{
+  size_t topic_id;
+  std::string topic_name;
+  /// Time the message was published, in nanoseconds since the epoch of the system clock.
+  int64_t timestamp;
+  /// The serialized message.
+  std::vector<uint8_t> data;
+};
+
+/// Recording of the latest serialized messages of the publishers of a process.
+/**
+ * The messages are kept in a ring of fixed size slots, in a file mapped in memory.
+ * Recording a message copies it into the next slot, without locking nor allocating, so that
+ * publishers given the recorder by rclcpp::PublisherOptions::flight_recorder pay about the
+ * serialization of the message.
+ *
+ * As the file is mapped shared, the recording is kept by the operating system when the
+ * process crashes, and read_file() reads it afterwards. flush() writes it to the disk, against
+ * a crash of the system.
+ *
+ * Every slot has a sequence number which is odd while the slot is written, so a reader detects
+ * a message overwritten while it copies it out.
+ *
+ * Only available on POSIX systems, the constructor throws std::runtime_error otherwise.
+ */
+class FlightRecorder
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(FlightRecorder)
+
+  /// Maximum number of topics of a recording.
+  static constexpr size_t max_topics = 64;
+  /// Maximum length of the name of a recorded topic.
+  static constexpr size_t max_topic_name_length = 255;
+
+  /// Create the recording file and map it.
+  /**
+   * \throws std::invalid_argument if the path is empty, the capacity or the maximum message
+   *   size are zero.
+   * \throws std::runtime_error if the file can't be created.
+   */
+  RCLCPP_PUBLIC
+  explicit FlightRecorder(const FlightRecorderOptions & options);
+
+  /// Unmap the recording, the file is kept.
+  RCLCPP_PUBLIC
+  ~FlightRecorder();
+
+  /// Add a topic to the recording, and return its id.
+  /**
+   * Adding a topic which was already added returns the same id.
+   * \throws std::length_error if the recording has max_topics topics already.
+   * \throws std::invalid_argument if the name is longer than max_topic_name_length.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  add_topic(const std::string & topic_name);
+
+  /// Copy a serialized message of the topic into the recording.
+  /**
+   * This is lock-free, and can be called concurrently, see get_dropped_count().
+   */
+  RCLCPP_PUBLIC
+  void
+  record(size_t topic_id, const rcl_serialized_message_t & serialized_message);
+
+  /// Return the messages of the recording, oldest first.
+  /**
+   * \param[in] window if positive, only the messages published at most this duration before
+   *   the latest message are returned.
+   */
+  RCLCPP_PUBLIC
+  std::vector<FlightRecord>
+  get_records(std::chrono::nanoseconds window = std::chrono::nanoseconds::zero()) const;
+
+  /// Write the messages of the recording into a new recording file, readable by read_file().
+  /**
+   * \param[in] path of the file, replaced if it exists.
+   * \param[in] window see get_records().
+   * \throws std::runtime_error if the file can't be created.
+   */
+  RCLCPP_PUBLIC
+  void
+  dump(
+    const std::string & path,
+    std::chrono::nanoseconds window = std::chrono::nanoseconds::zero()) const;
+
+  /// Write the recording to the disk.
+  /**
+   * \throws std::runtime_error if the recording can't be written.
+   */
+  RCLCPP_PUBLIC
+  void
+  flush();
+
+  /// Read the messages of a recording file, e.g. left by a crashed process.
+  /**
+   * \param[in] path of the recording file.
+   * \param[in] window see get_records().
+   * \throws std::runtime_error if the file can't be read or is not a recording.
+   */
+  RCLCPP_PUBLIC
+  static
+  std::vector<FlightRecord>
+  read_file(
+    const std::string & path,
+    std::chrono::nanoseconds window = std::chrono::nanoseconds::zero());
+
+  /// Return the number of messages dropped by record().
+  /**
+   * A message is dropped if it is too large, or if its slot is still written by a publisher
+   * which was overtaken by the others on the whole ring.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_dropped_count() const;
+
+  RCLCPP_PUBLIC
+  const std::string &
+  get_path() const;
+
+private:
+  struct Header;
+  struct SlotHeader;
+
+  void
+  record(
+    size_t topic_id, int64_t timestamp, const uint8_t * data, size_t length);
+
+  static
+  std::vector<FlightRecord>
+  get_records(const Header * header, std::chrono::nanoseconds window);
+
+  std::string path_;
+  int fd_;
+  void * memory_;
+  size_t memory_size_;
+  Header * header_;
+  std::mutex topics_mutex_;
+  std::atomic<size_t> dropped_count_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__FLIGHT_RECORDER_HPP_
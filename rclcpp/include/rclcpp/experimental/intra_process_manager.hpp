@@ -22,15 +22,20 @@
 #include <algorithm>
 #include <atomic>
 #include <cstdint>
+#include <deque>
 #include <exception>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <typeinfo>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "rclcpp/allocator/allocator_deleter.hpp"
+#include "rclcpp/experimental/buffers/broadcast_ring_buffer.hpp"
 #include "rclcpp/experimental/subscription_intra_process.hpp"
 #include "rclcpp/experimental/subscription_intra_process_base.hpp"
 #include "rclcpp/logger.hpp"
@@ -45,6 +50,18 @@ namespace rclcpp
 namespace experimental
 {
 
+/// A publisher and a subscription on the same topic, both registered with the manager.
+struct IntraProcessConnection
+{
+  std::string topic_name;
+  uint64_t publisher_id;
+  uint64_t subscription_id;
+  /// True if the messages are given intra-process, false if they go through the middleware.
+  bool intra_process;
+  /// Why the messages aren't given intra-process, empty if they are.
+  std::string reason;
+};
+
 /// This class performs intra process communication between nodes.
 /**
  * This class is used in the creation of publishers and subscriptions.
@@ -72,6 +89,8 @@ namespace experimental
  * When the user publishes a message, if intra-process communication is enabled
  * on the publisher, the message is given to this class.
  * Using the publisher id, a list of recipients for the message is selected.
+ * The list is an immutable snapshot which is replaced when subscriptions are added or removed,
+ * and publishers keep a handle to it, so publishing does not wait for these changes.
  * For each subscription in the list, this class stores the message, whether
  * sharing ownership or making a copy, in a buffer associated with the
  * subscription helper class.
@@ -86,6 +105,18 @@ namespace experimental
  * This information allows this class to operate efficiently by performing the
  * fewest number of copies of the message required.
  *
+ * Once the message is stored, the executors of the subscriptions are woken up with a single
+ * guard condition trigger per wait set, see notify_subscriptions(), so the cost of publishing
+ * to many subscriptions of the same executor is not dominated by the triggers.
+ *
+ * A transient local publisher keeps its last messages, as many as the depth of its history, as
+ * shared pointers to const messages.
+ * They are given without copy to the transient local subscriptions added later.
+ *
+ * A publisher with PublisherOptionsBase::intra_process_broadcast_depth set writes its messages
+ * once in a ring, instead of giving them to the buffer of each subscription taking shared
+ * messages which can read the ring, see SubscriptionIntraProcessBase::can_read_broadcast().
+ *
  * This class is neither CopyConstructable nor CopyAssignable.
  */
 class IntraProcessManager
@@ -150,6 +181,111 @@ public:
   void
   remove_publisher(uint64_t intra_process_publisher_id);
 
+  /// Unregister all the publishers and subscriptions at once.
+  /**
+   * It is called when the context is shut down, so the entities destroyed afterwards are not
+   * removed one by one, which updates the subscriptions of the publishers of their topic each
+   * time.
+   * The publishers still holding a handle are left without subscriptions, and the later calls
+   * to remove_publisher() and remove_subscription() do nothing.
+   */
+  RCLCPP_PUBLIC
+  void
+  clear();
+
+  /// Size the tables for a number of publishers and subscriptions, so registering them doesn't
+  /// rehash.
+  /**
+   * Called by Context::init() with InitOptions::entity_capacities.
+   */
+  RCLCPP_PUBLIC
+  void
+  reserve(size_t publishers, size_t subscriptions);
+
+  /// Subscriptions matched with a publisher, never modified once it is shared.
+  struct SplittedSubscriptions
+  {
+    std::vector<rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr>
+    take_shared_subscriptions;
+    std::vector<rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr>
+    take_ownership_subscriptions;
+    /// Subscriptions taking shared messages which read them from broadcast_ring.
+    /**
+     * They are not in take_shared_subscriptions.
+     */
+    std::vector<rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr>
+    broadcast_subscriptions;
+    /// The take shared, take ownership and broadcast subscriptions, in this order.
+    std::vector<rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr>
+    all_subscriptions;
+    /// Subscriptions taking serialized messages, they are not in the other lists.
+    std::vector<rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr>
+    serialized_subscriptions;
+    /// Ring of the publisher, null if it doesn't use one.
+    rclcpp::experimental::buffers::BroadcastRingBuffer::SharedPtr broadcast_ring;
+  };
+
+  /// Handle of a publisher to the subscriptions it is matched with.
+  /**
+   * The subscriptions are replaced as a whole by a new snapshot when they change, so publishing
+   * only loads the current snapshot, without locking the manager or looking up the publisher.
+   *
+   * It also holds the last messages of a transient local publisher.
+   */
+  class PublisherSubscriptions
+  {
+    friend class IntraProcessManager;
+
+public:
+    RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(PublisherSubscriptions)
+
+    RCLCPP_PUBLIC
+    PublisherSubscriptions();
+
+    RCLCPP_PUBLIC
+    std::shared_ptr<const SplittedSubscriptions>
+    load() const;
+
+    RCLCPP_PUBLIC
+    void
+    store(std::shared_ptr<const SplittedSubscriptions> subscriptions);
+
+    /// Number of subscriptions of the current snapshot, read without loading it.
+    RCLCPP_PUBLIC
+    const std::atomic<size_t> &
+    count() const;
+
+    /// Return the number of messages kept for late-joining subscriptions, 0 if not latched.
+    RCLCPP_PUBLIC
+    size_t
+    get_history_depth() const;
+
+private:
+    /// Keep a published message, history_mutex_ must be locked.
+    RCLCPP_PUBLIC
+    void
+    add_to_history(std::shared_ptr<const void> message) const;
+
+    std::shared_ptr<const SplittedSubscriptions> subscriptions_;
+    std::atomic<size_t> count_;
+
+    size_t history_depth_;
+    /// Held while a message is published and kept, so that a subscription added meanwhile gets
+    /// it either from the history or from the publisher, in order.
+    mutable std::mutex history_mutex_;
+    mutable std::deque<std::shared_ptr<const void>> history_;
+  };
+
+  /// Return the handle of a publisher to its matched subscriptions, nullptr if it is unknown.
+  /**
+   * The handle stays valid after the publisher is removed, without subscriptions.
+   *
+   * \param intra_process_publisher_id id of the publisher.
+   */
+  RCLCPP_PUBLIC
+  PublisherSubscriptions::SharedPtr
+  get_publisher_subscriptions(uint64_t intra_process_publisher_id) const;
+
   /// Publishes an intra-process message, passed as a unique pointer.
   /**
    * This is one of the two methods for publishing intra-process.
@@ -183,55 +319,43 @@ public:
     std::unique_ptr<MessageT, Deleter> message,
     std::shared_ptr<typename allocator::AllocRebind<MessageT, Alloc>::allocator_type> allocator)
   {
-    using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
-    using MessageAllocatorT = typename MessageAllocTraits::allocator_type;
-
-    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-
-    auto publisher_it = pub_to_subs_.find(intra_process_publisher_id);
-    if (publisher_it == pub_to_subs_.end()) {
+    auto publisher_subscriptions = get_publisher_subscriptions(intra_process_publisher_id);
+    if (!publisher_subscriptions) {
       // Publisher is either invalid or no longer exists.
       RCLCPP_WARN(
         rclcpp::get_logger("rclcpp"),
         "Calling do_intra_process_publish for invalid or no longer existing publisher id");
       return;
     }
-    const auto & sub_ids = publisher_it->second;
-
-    if (sub_ids.take_ownership_subscriptions.empty()) {
-      // None of the buffers require ownership, so we promote the pointer
-      std::shared_ptr<MessageT> msg = std::move(message);
-
-      this->template add_shared_msg_to_buffers<MessageT>(msg, sub_ids.take_shared_subscriptions);
-    } else if (!sub_ids.take_ownership_subscriptions.empty() && // NOLINT
-      sub_ids.take_shared_subscriptions.size() <= 1)
-    {
-      // There is at maximum 1 buffer that does not require ownership.
-      // So we this case is equivalent to all the buffers requiring ownership
-
-      // Merge the two vector of ids into a unique one
-      std::vector<uint64_t> concatenated_vector(sub_ids.take_shared_subscriptions);
-      concatenated_vector.insert(
-        concatenated_vector.end(),
-        sub_ids.take_ownership_subscriptions.begin(),
-        sub_ids.take_ownership_subscriptions.end());
-
-      this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter>(
-        std::move(message),
-        concatenated_vector,
-        allocator);
-    } else if (!sub_ids.take_ownership_subscriptions.empty() && // NOLINT
-      sub_ids.take_shared_subscriptions.size() > 1)
-    {
-      // Construct a new shared pointer from the message
-      // for the buffers that do not require ownership
-      auto shared_msg = std::allocate_shared<MessageT, MessageAllocatorT>(*allocator, *message);
+    this->template do_intra_process_publish<MessageT, Alloc, Deleter>(
+      *publisher_subscriptions, std::move(message), allocator);
+  }
 
-      this->template add_shared_msg_to_buffers<MessageT>(
-        shared_msg, sub_ids.take_shared_subscriptions);
-      this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter>(
-        std::move(message), sub_ids.take_ownership_subscriptions, allocator);
+  /// Publishes an intra-process message to the subscriptions of a publisher handle.
+  /**
+   * Same as the overload taking the publisher id, but it does not lock the manager.
+   *
+   * \param publisher_subscriptions the handle returned by get_publisher_subscriptions().
+   * \param message the message that is being stored.
+   */
+  template<
+    typename MessageT,
+    typename Alloc = std::allocator<void>,
+    typename Deleter = std::default_delete<MessageT>>
+  void
+  do_intra_process_publish(
+    const PublisherSubscriptions & publisher_subscriptions,
+    std::unique_ptr<MessageT, Deleter> message,
+    std::shared_ptr<typename allocator::AllocRebind<MessageT, Alloc>::allocator_type> allocator)
+  {
+    if (publisher_subscriptions.get_history_depth() > 0) {
+      this->template do_intra_process_publish_and_return_shared<MessageT, Alloc, Deleter>(
+        publisher_subscriptions, std::move(message), allocator);
+      return;
     }
+    auto snapshot = publisher_subscriptions.load();
+    this->template publish_to_buffers<MessageT, Alloc, Deleter>(
+      *snapshot, std::move(message), allocator);
   }
 
   template<
@@ -244,60 +368,214 @@ public:
     std::unique_ptr<MessageT, Deleter> message,
     std::shared_ptr<typename allocator::AllocRebind<MessageT, Alloc>::allocator_type> allocator)
   {
-    using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
-    using MessageAllocatorT = typename MessageAllocTraits::allocator_type;
-
-    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
-
-    auto publisher_it = pub_to_subs_.find(intra_process_publisher_id);
-    if (publisher_it == pub_to_subs_.end()) {
+    auto publisher_subscriptions = get_publisher_subscriptions(intra_process_publisher_id);
+    if (!publisher_subscriptions) {
       // Publisher is either invalid or no longer exists.
       RCLCPP_WARN(
         rclcpp::get_logger("rclcpp"),
         "Calling do_intra_process_publish for invalid or no longer existing publisher id");
       return nullptr;
     }
-    const auto & sub_ids = publisher_it->second;
+    return this->template do_intra_process_publish_and_return_shared<MessageT, Alloc, Deleter>(
+      *publisher_subscriptions, std::move(message), allocator);
+  }
 
-    if (sub_ids.take_ownership_subscriptions.empty()) {
-      // If there are no owning, just convert to shared.
-      std::shared_ptr<MessageT> shared_msg = std::move(message);
-      if (!sub_ids.take_shared_subscriptions.empty()) {
-        this->template add_shared_msg_to_buffers<MessageT>(
-          shared_msg, sub_ids.take_shared_subscriptions);
-      }
-      return shared_msg;
-    } else {
-      // Construct a new shared pointer from the message for the buffers that
-      // do not require ownership and to return.
-      auto shared_msg = std::allocate_shared<MessageT, MessageAllocatorT>(*allocator, *message);
+  template<
+    typename MessageT,
+    typename Alloc = std::allocator<void>,
+    typename Deleter = std::default_delete<MessageT>>
+  std::shared_ptr<const MessageT>
+  do_intra_process_publish_and_return_shared(
+    const PublisherSubscriptions & publisher_subscriptions,
+    std::unique_ptr<MessageT, Deleter> message,
+    std::shared_ptr<typename allocator::AllocRebind<MessageT, Alloc>::allocator_type> allocator)
+  {
+    if (publisher_subscriptions.get_history_depth() > 0) {
+      std::lock_guard<std::mutex> history_lock(publisher_subscriptions.history_mutex_);
+      auto snapshot = publisher_subscriptions.load();
+      auto shared_message =
+        this->template publish_to_buffers_and_return_shared<MessageT, Alloc, Deleter>(
+        *snapshot, std::move(message), allocator);
+      publisher_subscriptions.add_to_history(shared_message);
+      return shared_message;
+    }
+    auto snapshot = publisher_subscriptions.load();
+    return this->template publish_to_buffers_and_return_shared<MessageT, Alloc, Deleter>(
+      *snapshot, std::move(message), allocator);
+  }
 
-      if (!sub_ids.take_shared_subscriptions.empty()) {
-        this->template add_shared_msg_to_buffers<MessageT>(
-          shared_msg,
-          sub_ids.take_shared_subscriptions);
+  /// Publishes a batch of intra-process messages to the subscriptions of a publisher handle.
+  /**
+   * Same as do_intra_process_publish() for each message, in order, but the subscriptions are
+   * looked up once for the whole batch, and each of them is notified once after all the
+   * messages were given to it.
+   *
+   * \param publisher_subscriptions the handle returned by get_publisher_subscriptions().
+   * \param messages the messages that are being stored, the vector is cleared.
+   * \param allocator the allocator used for the copies.
+   * \param shared_messages if not nullptr, a shared pointer to each message is appended to it,
+   *   as done by do_intra_process_publish_and_return_shared().
+   */
+  template<
+    typename MessageT,
+    typename Alloc = std::allocator<void>,
+    typename Deleter = std::default_delete<MessageT>>
+  void
+  do_intra_process_publish_batch(
+    const PublisherSubscriptions & publisher_subscriptions,
+    std::vector<std::unique_ptr<MessageT, Deleter>> & messages,
+    std::shared_ptr<typename allocator::AllocRebind<MessageT, Alloc>::allocator_type> allocator,
+    std::vector<std::shared_ptr<const MessageT>> * shared_messages = nullptr)
+  {
+    for (auto & message : messages) {
+      if (!message) {
+        throw std::runtime_error("cannot publish msg which is a null pointer");
       }
-      if (!sub_ids.take_ownership_subscriptions.empty()) {
-        this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter>(
-          std::move(message),
-          sub_ids.take_ownership_subscriptions,
-          allocator);
+    }
+    std::unique_lock<std::mutex> history_lock;
+    if (publisher_subscriptions.get_history_depth() > 0) {
+      history_lock = std::unique_lock<std::mutex>(publisher_subscriptions.history_mutex_);
+    }
+    auto snapshot = publisher_subscriptions.load();
+    const auto & sub_ids = *snapshot;
+
+    for (auto & message : messages) {
+      if (shared_messages || history_lock) {
+        auto shared_message =
+          this->template publish_to_buffers_and_return_shared<MessageT, Alloc, Deleter>(
+          sub_ids, std::move(message), allocator, false);
+        if (history_lock) {
+          publisher_subscriptions.add_to_history(shared_message);
+        }
+        if (shared_messages) {
+          shared_messages->push_back(std::move(shared_message));
+        }
+      } else {
+        this->template publish_to_buffers<MessageT, Alloc, Deleter>(
+          sub_ids, std::move(message), allocator, false);
       }
+    }
+    if (!messages.empty()) {
+      notify_subscriptions(sub_ids.all_subscriptions);
+    }
+    messages.clear();
+  }
 
-      return shared_msg;
+  /// Publishes an intra-process message, passed as a shared pointer to a const message.
+  /**
+   * The message is given as it is to the subscriptions that do not require ownership,
+   * its deleter runs when the last of them releases it.
+   * The subscriptions requiring ownership get a single copy of the message, which is copied
+   * again for all of them except the last one.
+   *
+   * This is used for messages whose memory is not owned by the publisher, e.g. loaned messages.
+   *
+   * \param publisher_subscriptions the handle returned by get_publisher_subscriptions().
+   * \param message the message that is being stored.
+   * \param allocator the allocator used for the copies.
+   * \param deleter the deleter given to the copies.
+   */
+  template<
+    typename MessageT,
+    typename Alloc = std::allocator<void>,
+    typename Deleter = std::default_delete<MessageT>>
+  void
+  do_intra_process_publish_shared(
+    const PublisherSubscriptions & publisher_subscriptions,
+    std::shared_ptr<const MessageT> message,
+    std::shared_ptr<typename allocator::AllocRebind<MessageT, Alloc>::allocator_type> allocator,
+    const Deleter & deleter = Deleter())
+  {
+    using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
+    using MessageUniquePtr = std::unique_ptr<MessageT, Deleter>;
+
+    std::unique_lock<std::mutex> history_lock;
+    if (publisher_subscriptions.get_history_depth() > 0) {
+      history_lock = std::unique_lock<std::mutex>(publisher_subscriptions.history_mutex_);
+      // A copy is kept, so that a loaned message isn't held by the history.
+      auto ptr = MessageAllocTraits::allocate(*allocator.get(), 1);
+      MessageAllocTraits::construct(*allocator.get(), ptr, *message);
+      copy_count_.fetch_add(1, std::memory_order_relaxed);
+      publisher_subscriptions.add_to_history(
+        std::shared_ptr<const MessageT>(MessageUniquePtr(ptr, deleter)));
     }
+    auto snapshot = publisher_subscriptions.load();
+    const auto & sub_ids = *snapshot;
+
+    this->template add_shared_msg_to_buffers<MessageT>(message, sub_ids);
+    if (!sub_ids.take_ownership_subscriptions.empty()) {
+      auto ptr = MessageAllocTraits::allocate(*allocator.get(), 1);
+      MessageAllocTraits::construct(*allocator.get(), ptr, *message);
+      copy_count_.fetch_add(1, std::memory_order_relaxed);
+
+      this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter>(
+        MessageUniquePtr(ptr, deleter), sub_ids.take_ownership_subscriptions, allocator);
+    }
+    notify_subscriptions(sub_ids.all_subscriptions);
   }
 
+  /// Publishes a serialized intra-process message to the serialized subscriptions.
+  /**
+   * The message is copied for all the serialized subscriptions except the last one,
+   * which gets the given message.
+   *
+   * \param publisher_subscriptions the handle returned by get_publisher_subscriptions().
+   * \param message the serialized message, not used by the caller anymore.
+   */
+  RCLCPP_PUBLIC
+  void
+  do_intra_process_publish_serialized(
+    const PublisherSubscriptions & publisher_subscriptions,
+    std::shared_ptr<rcl_serialized_message_t> message);
+
   /// Return true if the given rmw_gid_t matches any stored Publishers.
   RCLCPP_PUBLIC
   bool
   matches_any_publishers(const rmw_gid_t * id) const;
 
+  /// Return true if the given rmw_gid_t matches a publisher delivering to the subscription.
+  /**
+   * The messages of the other publishers, e.g. using another type, go through the middleware.
+   *
+   * \param intra_process_subscription_id id of the subscription.
+   * \param id gid of the publisher of a message received by the subscription.
+   */
+  RCLCPP_PUBLIC
+  bool
+  matches_any_publishers(uint64_t intra_process_subscription_id, const rmw_gid_t * id) const;
+
   /// Return the number of intraprocess subscriptions that are matched with a given publisher id.
   RCLCPP_PUBLIC
   size_t
   get_subscription_count(uint64_t intra_process_publisher_id) const;
 
+  /// Return the number of subscriptions matched with a publisher whose buffer is full.
+  /**
+   * It doesn't lock the manager, the subscriptions are read from the snapshot of the publisher.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_full_subscription_count(uint64_t intra_process_publisher_id) const;
+
+  /// Return the number of messages copied while publishing.
+  /**
+   * Copies made later by the subscriptions, e.g. by a subscription taking a unique_ptr from a
+   * buffer of shared_ptr, are counted by SubscriptionIntraProcess::get_copy_count().
+   */
+  RCLCPP_PUBLIC
+  uint64_t
+  get_copy_count() const;
+
+  /// Return the pairs of publishers and subscriptions on the same topic, and how they connect.
+  /**
+   * A pair which doesn't communicate intra-process, e.g. because of incompatible QoS, falls
+   * back to the middleware if the middleware matches them.
+   * The pairs are sorted by topic name, then publisher and subscription ids.
+   */
+  RCLCPP_PUBLIC
+  std::vector<IntraProcessConnection>
+  get_connections() const;
+
   RCLCPP_PUBLIC
   rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr
   get_subscription_intra_process(uint64_t intra_process_subscription_id);
@@ -311,6 +589,9 @@ private:
     rmw_qos_profile_t qos;
     const char * topic_name;
     bool use_take_shared_method;
+    bool is_serialized;
+    bool can_read_broadcast;
+    const std::type_info * message_type;
   };
 
   struct PublisherInfo
@@ -320,12 +601,7 @@ private:
     rclcpp::PublisherBase::WeakPtr publisher;
     rmw_qos_profile_t qos;
     const char * topic_name;
-  };
-
-  struct SplittedSubscriptions
-  {
-    std::vector<uint64_t> take_shared_subscriptions;
-    std::vector<uint64_t> take_ownership_subscriptions;
+    const std::type_info * message_type;
   };
 
   using SubscriptionMap =
@@ -334,43 +610,198 @@ private:
   using PublisherMap =
     std::unordered_map<uint64_t, PublisherInfo>;
 
-  using PublisherToSubscriptionIdsMap =
-    std::unordered_map<uint64_t, SplittedSubscriptions>;
+  using PublisherToSubscriptionsMap =
+    std::unordered_map<uint64_t, PublisherSubscriptions::SharedPtr>;
+
+  /// Ids of the publishers and subscriptions of a topic, only these can be matched together.
+  struct TopicEntities
+  {
+    std::vector<uint64_t> publisher_ids;
+    std::vector<uint64_t> subscription_ids;
+  };
+
+  using TopicMap =
+    std::unordered_map<std::string, TopicEntities>;
 
   RCLCPP_PUBLIC
   static
   uint64_t
   get_next_unique_id();
 
+  /// Replace the snapshot of a publisher by one with the subscription added or removed.
   RCLCPP_PUBLIC
   void
-  insert_sub_id_for_pub(uint64_t sub_id, uint64_t pub_id, bool use_take_shared_method);
+  update_subscriptions_of_pub(
+    uint64_t pub_id,
+    const SubscriptionInfo & subscription_info,
+    bool add);
 
+  /// Stop the broadcast subscriptions of a snapshot from reading its ring.
+  /**
+   * They still get the messages written until now.
+   */
   RCLCPP_PUBLIC
-  bool
-  can_communicate(PublisherInfo pub_info, SubscriptionInfo sub_info) const;
+  static
+  void
+  remove_broadcast_readers(const SplittedSubscriptions & subscriptions);
+
+  /// Return why a publisher and a subscription on the same topic can't communicate.
+  /**
+   * \return nullptr if they can.
+   */
+  RCLCPP_PUBLIC
+  static
+  const char *
+  get_incompatibility(const PublisherInfo & pub_info, const SubscriptionInfo & sub_info);
+
+  /// Wake up the executors of subscriptions given a message.
+  /**
+   * An executor woken up checks all the subscriptions it waits on, so only one subscription per
+   * wait set is triggered: the one most recently added to it, which is still part of it.
+   * The subscriptions not added to a wait set yet are triggered, the ones which left a wait set
+   * trigger themselves when they are added to the next one, see
+   * SubscriptionIntraProcessBase::add_to_wait_set().
+   */
+  RCLCPP_PUBLIC
+  static
+  void
+  notify_subscriptions(
+    const std::vector<rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr> &
+    subscriptions);
 
+  /// Give a message to the buffers of the subscriptions, see do_intra_process_publish().
+  /**
+   * \param notify if false, the subscriptions are not notified of the message.
+   */
+  template<
+    typename MessageT,
+    typename Alloc = std::allocator<void>,
+    typename Deleter = std::default_delete<MessageT>>
+  void
+  publish_to_buffers(
+    const SplittedSubscriptions & sub_ids,
+    std::unique_ptr<MessageT, Deleter> message,
+    std::shared_ptr<typename allocator::AllocRebind<MessageT, Alloc>::allocator_type> allocator,
+    bool notify = true)
+  {
+    using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
+    using MessageAllocatorT = typename MessageAllocTraits::allocator_type;
+
+    if (sub_ids.take_ownership_subscriptions.empty()) {
+      // None of the buffers require ownership, so we promote the pointer.
+      // The control block is allocated with the message allocator, as the message was.
+      std::shared_ptr<MessageT> msg(message.release(), message.get_deleter(), *allocator);
+
+      this->template add_shared_msg_to_buffers<MessageT>(msg, sub_ids);
+    } else if (!sub_ids.take_ownership_subscriptions.empty() && // NOLINT
+      sub_ids.broadcast_subscriptions.empty() &&
+      sub_ids.take_shared_subscriptions.size() <= 1)
+    {
+      // There is at maximum 1 buffer that does not require ownership, and no ring.
+      // So we this case is equivalent to all the buffers requiring ownership
+      this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter>(
+        std::move(message),
+        sub_ids.all_subscriptions,
+        allocator);
+    } else {
+      // Construct a new shared pointer from the message
+      // for the buffers that do not require ownership
+      auto shared_msg = std::allocate_shared<MessageT, MessageAllocatorT>(*allocator, *message);
+      copy_count_.fetch_add(1, std::memory_order_relaxed);
+
+      this->template add_shared_msg_to_buffers<MessageT>(shared_msg, sub_ids);
+      this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter>(
+        std::move(message), sub_ids.take_ownership_subscriptions, allocator);
+    }
+    if (notify) {
+      notify_subscriptions(sub_ids.all_subscriptions);
+    }
+  }
+
+  /// Same as publish_to_buffers(), also returning a shared pointer to the message.
+  template<
+    typename MessageT,
+    typename Alloc = std::allocator<void>,
+    typename Deleter = std::default_delete<MessageT>>
+  std::shared_ptr<const MessageT>
+  publish_to_buffers_and_return_shared(
+    const SplittedSubscriptions & sub_ids,
+    std::unique_ptr<MessageT, Deleter> message,
+    std::shared_ptr<typename allocator::AllocRebind<MessageT, Alloc>::allocator_type> allocator,
+    bool notify = true)
+  {
+    using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
+    using MessageAllocatorT = typename MessageAllocTraits::allocator_type;
+
+    if (sub_ids.take_ownership_subscriptions.empty()) {
+      // If there are no owning, just convert to shared.
+      std::shared_ptr<MessageT> shared_msg(message.release(), message.get_deleter(), *allocator);
+      this->template add_shared_msg_to_buffers<MessageT>(shared_msg, sub_ids);
+      if (notify) {
+        notify_subscriptions(sub_ids.all_subscriptions);
+      }
+      return shared_msg;
+    } else {
+      // Construct a new shared pointer from the message for the buffers that
+      // do not require ownership and to return.
+      auto shared_msg = std::allocate_shared<MessageT, MessageAllocatorT>(*allocator, *message);
+      copy_count_.fetch_add(1, std::memory_order_relaxed);
+
+      this->template add_shared_msg_to_buffers<MessageT>(shared_msg, sub_ids);
+      if (!sub_ids.take_ownership_subscriptions.empty()) {
+        this->template add_owned_msg_to_buffers<MessageT, Alloc, Deleter>(
+          std::move(message),
+          sub_ids.take_ownership_subscriptions,
+          allocator);
+      }
+      if (notify) {
+        notify_subscriptions(sub_ids.all_subscriptions);
+      }
+
+      return shared_msg;
+    }
+  }
+
+  /// Give a message to the subscriptions taking shared messages, they are not notified.
+  /**
+   * It is written once in the ring of the publisher, for the subscriptions reading it.
+   */
   template<typename MessageT>
   void
   add_shared_msg_to_buffers(
     std::shared_ptr<const MessageT> message,
-    std::vector<uint64_t> subscription_ids)
+    const SplittedSubscriptions & sub_ids)
   {
-    for (auto id : subscription_ids) {
-      auto subscription_it = subscriptions_.find(id);
-      if (subscription_it == subscriptions_.end()) {
-        throw std::runtime_error("subscription has unexpectedly gone out of scope");
-      }
-      auto subscription_base = subscription_it->second.subscription;
+    if (!sub_ids.broadcast_subscriptions.empty()) {
+      sub_ids.broadcast_ring->write(message);
+    }
+    if (!sub_ids.take_shared_subscriptions.empty()) {
+      this->template add_shared_msg_to_buffers<MessageT>(
+        std::move(message), sub_ids.take_shared_subscriptions);
+    }
+  }
 
+  /// Give a message to the buffers of the subscriptions, they are not notified.
+  template<typename MessageT>
+  void
+  add_shared_msg_to_buffers(
+    std::shared_ptr<const MessageT> message,
+    const std::vector<rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr> &
+    subscriptions)
+  {
+    for (auto & subscription_base : subscriptions) {
       auto subscription = std::static_pointer_cast<
         rclcpp::experimental::SubscriptionIntraProcess<MessageT>
         >(subscription_base);
 
-      subscription->provide_intra_process_message(message);
+      subscription->provide_intra_process_message(message, false);
     }
   }
 
+  /// Give a message to the buffers of the subscriptions, copying it for all but the last one.
+  /**
+   * The subscriptions are not notified.
+   */
   template<
     typename MessageT,
     typename Alloc = std::allocator<void>,
@@ -378,26 +809,21 @@ private:
   void
   add_owned_msg_to_buffers(
     std::unique_ptr<MessageT, Deleter> message,
-    std::vector<uint64_t> subscription_ids,
+    const std::vector<rclcpp::experimental::SubscriptionIntraProcessBase::SharedPtr> &
+    subscriptions,
     std::shared_ptr<typename allocator::AllocRebind<MessageT, Alloc>::allocator_type> allocator)
   {
     using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
     using MessageUniquePtr = std::unique_ptr<MessageT, Deleter>;
 
-    for (auto it = subscription_ids.begin(); it != subscription_ids.end(); it++) {
-      auto subscription_it = subscriptions_.find(*it);
-      if (subscription_it == subscriptions_.end()) {
-        throw std::runtime_error("subscription has unexpectedly gone out of scope");
-      }
-      auto subscription_base = subscription_it->second.subscription;
-
+    for (auto it = subscriptions.begin(); it != subscriptions.end(); it++) {
       auto subscription = std::static_pointer_cast<
         rclcpp::experimental::SubscriptionIntraProcess<MessageT>
-        >(subscription_base);
+        >(*it);
 
-      if (std::next(it) == subscription_ids.end()) {
+      if (std::next(it) == subscriptions.end()) {
         // If this is the last subscription, give up ownership
-        subscription->provide_intra_process_message(std::move(message));
+        subscription->provide_intra_process_message(std::move(message), false);
       } else {
         // Copy the message since we have additional subscriptions to serve
         MessageUniquePtr copy_message;
@@ -405,16 +831,21 @@ private:
         auto ptr = MessageAllocTraits::allocate(*allocator.get(), 1);
         MessageAllocTraits::construct(*allocator.get(), ptr, *message);
         copy_message = MessageUniquePtr(ptr, deleter);
+        copy_count_.fetch_add(1, std::memory_order_relaxed);
 
-        subscription->provide_intra_process_message(std::move(copy_message));
+        subscription->provide_intra_process_message(std::move(copy_message), false);
       }
     }
   }
 
-  PublisherToSubscriptionIdsMap pub_to_subs_;
+  PublisherToSubscriptionsMap pub_to_subs_;
   SubscriptionMap subscriptions_;
   PublisherMap publishers_;
+  TopicMap topics_;
+
+  std::atomic<uint64_t> copy_count_ {0};
 
+  /// Protects the maps, publishing with a PublisherSubscriptions handle does not lock it.
   mutable std::shared_timed_mutex mutex_;
 };
 
@@ -0,0 +1,140 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__EXPERIMENTAL__INTRA_PROCESS_SERVICE_MANAGER_HPP_
+#define RCLCPP__EXPERIMENTAL__INTRA_PROCESS_SERVICE_MANAGER_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include "rmw/types.h"
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+class ClientIntraProcess;
+class ServiceIntraProcess;
+
+/// The services and clients of a context which pass requests and responses within the process.
+/**
+ * A client of a node using intra-process communication, see
+ * NodeOptions::use_intra_process_comms(), gives its requests to a service of the context with
+ * the same name and type, if its node uses intra-process communication too: the request and the
+ * response are passed as shared pointers, without being serialized.
+ * If there is no such service, e.g. when the servers are in other processes, the requests are
+ * sent through the middleware as usual.
+ * If several services of the context match, the one added first gets the requests.
+ *
+ * The requests passed within the process carry a header marking them, see
+ * is_intra_process_request(), so that the service gives their response back to the client
+ * instead of sending it through the middleware.
+ *
+ * A singleton instance of this class is owned by a rclcpp::Context, like the
+ * IntraProcessManager.
+ */
+class IntraProcessServiceManager
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(IntraProcessServiceManager)
+
+  RCLCPP_PUBLIC
+  IntraProcessServiceManager();
+
+  RCLCPP_PUBLIC
+  virtual ~IntraProcessServiceManager();
+
+  /// Register a service, return the id to remove it with.
+  RCLCPP_PUBLIC
+  uint64_t
+  add_service(std::shared_ptr<ServiceIntraProcess> service);
+
+  RCLCPP_PUBLIC
+  void
+  remove_service(uint64_t service_id);
+
+  /// Return the service getting the requests of a service name and type, nullptr if none.
+  /**
+   * \param[in] service_name The fully qualified name of the service.
+   * \param[in] service_type The type of the service, e.g. typeid(ServiceT).
+   */
+  RCLCPP_PUBLIC
+  std::shared_ptr<ServiceIntraProcess>
+  get_service(const std::string & service_name, const std::type_info & service_type) const;
+
+  /// Register a client, return the id its requests are marked with.
+  RCLCPP_PUBLIC
+  uint64_t
+  add_client(std::shared_ptr<ClientIntraProcess> client);
+
+  RCLCPP_PUBLIC
+  void
+  remove_client(uint64_t client_id);
+
+  /// Fill in the header of a request passed within the process.
+  RCLCPP_PUBLIC
+  static
+  void
+  set_request_header(uint64_t client_id, int64_t sequence_number, rmw_request_id_t & header);
+
+  /// Return true if the header is the one of a request passed within the process.
+  RCLCPP_PUBLIC
+  static
+  bool
+  is_intra_process_request(const rmw_request_id_t & header);
+
+  /// Give the response to a request passed within the process to its client.
+  /**
+   * The response is dropped if the client was destroyed.
+   *
+   * \param[in] header The header of the request, see is_intra_process_request().
+   * \param[in] response The response, of the type of the service of the client.
+   */
+  RCLCPP_PUBLIC
+  void
+  send_response(const rmw_request_id_t & header, std::shared_ptr<void> response) const;
+
+private:
+  RCLCPP_DISABLE_COPY(IntraProcessServiceManager)
+
+  struct ServiceEntry
+  {
+    uint64_t id;
+    const std::type_info * type;
+    std::weak_ptr<ServiceIntraProcess> service;
+  };
+
+  mutable std::mutex mutex_;
+  /// By fully qualified service name, in the order they were added.
+  std::unordered_map<std::string, std::vector<ServiceEntry>> services_;
+  /// Name of the services, by id.
+  std::unordered_map<uint64_t, std::string> service_names_;
+  std::unordered_map<uint64_t, std::weak_ptr<ClientIntraProcess>> clients_;
+  uint64_t next_id_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__INTRA_PROCESS_SERVICE_MANAGER_HPP_
@@ -0,0 +1,162 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__LOCK_FREE_BOUNDED_QUEUE_HPP_
+#define RCLCPP__EXPERIMENTAL__LOCK_FREE_BOUNDED_QUEUE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Bounded queue with any number of producers and consumers, which never blocks.
+/**
+ * Each slot has a sequence number telling whether it is free for the push at a given position,
+ * or holds the element for the pop at that position.
+ * Producers and consumers only synchronize through the sequence numbers of the slots and the
+ * push and pop positions, so a suspended thread never blocks the others.
+ *
+ * The capacity is rounded up to the next power of two.
+ */
+template<typename T>
+class LockFreeBoundedQueue
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(LockFreeBoundedQueue<T>)
+
+  /// Constructor.
+  /**
+   * \param[in] capacity minimum number of elements the queue can hold.
+   * \throws std::invalid_argument if the capacity is zero.
+   */
+  explicit LockFreeBoundedQueue(size_t capacity)
+  : capacity_(round_up(capacity)),
+    slots_(new Slot[capacity_]),
+    push_position_(0),
+    pop_position_(0)
+  {
+    if (capacity == 0) {
+      throw std::invalid_argument("capacity must be a positive, non-zero value");
+    }
+    for (size_t i = 0; i < capacity_; ++i) {
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  /// Push an element, return false without moving from it if the queue is full.
+  bool
+  try_push(T && element)
+  {
+    size_t position = push_position_.load(std::memory_order_relaxed);
+    Slot * slot;
+    while (true) {
+      slot = &slots_[position & (capacity_ - 1)];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      if (sequence == position) {
+        if (push_position_.compare_exchange_weak(
+            position, position + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      } else if (sequence < position) {
+        // The slot still holds the element pushed one lap before.
+        return false;
+      } else {
+        position = push_position_.load(std::memory_order_relaxed);
+      }
+    }
+    slot->element = std::move(element);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Pop the oldest element, return false if the queue is empty.
+  bool
+  try_pop(T & element)
+  {
+    size_t position = pop_position_.load(std::memory_order_relaxed);
+    Slot * slot;
+    while (true) {
+      slot = &slots_[position & (capacity_ - 1)];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      if (sequence == position + 1) {
+        if (pop_position_.compare_exchange_weak(
+            position, position + 1, std::memory_order_relaxed))
+        {
+          break;
+        }
+      } else if (sequence < position + 1) {
+        // The element for this position wasn't pushed yet.
+        return false;
+      } else {
+        position = pop_position_.load(std::memory_order_relaxed);
+      }
+    }
+    element = std::move(slot->element);
+    slot->element = T();
+    slot->sequence.store(position + capacity_, std::memory_order_release);
+    return true;
+  }
+
+  /// Return the number of elements in the queue, which may be outdated once returned.
+  size_t
+  size() const
+  {
+    size_t pop_position = pop_position_.load(std::memory_order_relaxed);
+    size_t push_position = push_position_.load(std::memory_order_relaxed);
+    return push_position > pop_position ? push_position - pop_position : 0;
+  }
+
+  size_t
+  capacity() const
+  {
+    return capacity_;
+  }
+
+private:
+  struct Slot
+  {
+    std::atomic<size_t> sequence;
+    T element;
+  };
+
+  static size_t
+  round_up(size_t capacity)
+  {
+    size_t rounded = 1;
+    while (rounded < capacity) {
+      rounded <<= 1;
+    }
+    return rounded;
+  }
+
+  const size_t capacity_;
+  std::unique_ptr<Slot[]> slots_;
+  // On separate cache lines, so that producers and consumers don't slow each other down.
+  alignas(64) std::atomic<size_t> push_position_;
+  alignas(64) std::atomic<size_t> pop_position_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__LOCK_FREE_BOUNDED_QUEUE_HPP_
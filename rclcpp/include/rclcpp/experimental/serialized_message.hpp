@@ -0,0 +1,46 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__EXPERIMENTAL__SERIALIZED_MESSAGE_HPP_
+#define RCLCPP__EXPERIMENTAL__SERIALIZED_MESSAGE_HPP_
+
+#include <memory>
+
+#include "rcl/types.h"
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Create a serialized message which is finalized when the last reference to it is released.
+/**
+ * \param[in] capacity initial capacity of the buffer of the message, in bytes.
+ * \throws rclcpp::exceptions::RCLError if the buffer can't be allocated.
+ */
+RCLCPP_PUBLIC
+std::shared_ptr<rcl_serialized_message_t>
+create_serialized_message(size_t capacity);
+
+/// Create a copy of a serialized message, like create_serialized_message().
+RCLCPP_PUBLIC
+std::shared_ptr<rcl_serialized_message_t>
+copy_serialized_message(const rcl_serialized_message_t & message);
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__SERIALIZED_MESSAGE_HPP_
@@ -0,0 +1,124 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__EXPERIMENTAL__SERVICE_INTRA_PROCESS_HPP_
+#define RCLCPP__EXPERIMENTAL__SERVICE_INTRA_PROCESS_HPP_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include "rcl/guard_condition.h"
+#include "rcl/wait.h"
+#include "rmw/types.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+
+class ServiceBase;
+
+namespace experimental
+{
+
+/// Waitable executing a service with the requests of the clients of its process.
+/**
+ * It is added to the callback group of the service, see IntraProcessServiceManager, and
+ * handles the requests like the ones taken from the middleware: batched, or on the worker
+ * threads of the service, if it has some.
+ */
+class ServiceIntraProcess : public rclcpp::Waitable
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(ServiceIntraProcess)
+
+  /// The requests queued, with the headers identifying their clients.
+  using RequestQueue =
+    std::vector<std::pair<std::shared_ptr<rmw_request_id_t>, std::shared_ptr<void>>>;
+
+  /**
+   * \param[in] service The service, not kept alive by the waitable.
+   * \param[in] service_type The type of the service, e.g. typeid(ServiceT).
+   * \param[in] context The context of the guard condition waking up the executor.
+   * \throws std::runtime_error if the guard condition can't be initialized.
+   */
+  RCLCPP_PUBLIC
+  ServiceIntraProcess(
+    std::shared_ptr<rclcpp::ServiceBase> service,
+    const std::type_info & service_type,
+    rclcpp::Context::SharedPtr context);
+
+  RCLCPP_PUBLIC
+  virtual ~ServiceIntraProcess();
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_ready_guard_conditions() override;
+
+  RCLCPP_PUBLIC
+  bool
+  add_to_wait_set(rcl_wait_set_t * wait_set) override;
+
+  RCLCPP_PUBLIC
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override;
+
+  /// Handle the requests queued so far.
+  RCLCPP_PUBLIC
+  void
+  execute() override;
+
+  /// Queue a request of a client and wake up the executor.
+  /**
+   * \param[in] header The header of the request, see
+   *   IntraProcessServiceManager::set_request_header().
+   * \param[in] request The request, of the request type of the service, shared with the client.
+   */
+  RCLCPP_PUBLIC
+  void
+  provide_request(std::shared_ptr<rmw_request_id_t> header, std::shared_ptr<void> request);
+
+  /// Return the fully qualified name of the service.
+  RCLCPP_PUBLIC
+  const std::string &
+  get_service_name() const;
+
+  RCLCPP_PUBLIC
+  const std::type_info &
+  get_service_type() const;
+
+private:
+  RCLCPP_DISABLE_COPY(ServiceIntraProcess)
+
+  std::weak_ptr<rclcpp::ServiceBase> service_;
+  std::string service_name_;
+  const std::type_info & service_type_;
+
+  std::mutex requests_mutex_;
+  RequestQueue requests_;
+  rcl_guard_condition_t gc_ = rcl_get_zero_initialized_guard_condition();
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__SERVICE_INTRA_PROCESS_HPP_
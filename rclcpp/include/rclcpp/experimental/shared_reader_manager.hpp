@@ -0,0 +1,120 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__EXPERIMENTAL__SHARED_READER_MANAGER_HPP_
+#define RCLCPP__EXPERIMENTAL__SHARED_READER_MANAGER_HPP_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rcl/subscription.h"
+
+#include "rclcpp/experimental/subscription_intra_process_base.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// The rcl subscriptions shared by the identical subscriptions of a context.
+/**
+ * Subscriptions created with SubscriptionOptionsBase::share_reader, on the same topic with the
+ * same message type and QoS, share one rcl subscription: the middleware delivers a message to
+ * the process once, it is taken and deserialized once, then given to the intra-process buffer
+ * of each subscription.
+ *
+ * A singleton instance of this class is owned by a rclcpp::Context, like the
+ * IntraProcessManager.
+ * The executors wait once on a shared rcl subscription, and take from it through any of the
+ * subscriptions sharing it, see SubscriptionBase::has_shared_reader().
+ */
+class SharedReaderManager
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(SharedReaderManager)
+
+  RCLCPP_PUBLIC
+  SharedReaderManager();
+
+  RCLCPP_PUBLIC
+  virtual ~SharedReaderManager();
+
+  /// Return the rcl subscription shared for the key, calling create() if there is none.
+  /**
+   * The key identifies the topic, the message type and the QoS of the subscription.
+   * The rcl subscription is finalized when the last subscription holding it is destroyed.
+   */
+  RCLCPP_PUBLIC
+  std::shared_ptr<rcl_subscription_t>
+  get_reader(
+    const std::string & key,
+    const std::function<std::shared_ptr<rcl_subscription_t>()> & create);
+
+  /// Add a subscription receiving the messages taken from the rcl subscription.
+  RCLCPP_PUBLIC
+  void
+  add_subscription(
+    const rcl_subscription_t * reader,
+    SubscriptionIntraProcessBase::WeakPtr subscription);
+
+  /// Give a message taken from the rcl subscription to all the subscriptions sharing it.
+  /**
+   * The message is of the type given by get_message_type() of the subscriptions.
+   * It is shared by them, so it must not be modified or reused afterwards.
+   */
+  RCLCPP_PUBLIC
+  void
+  provide_message(const rcl_subscription_t * reader, std::shared_ptr<const void> message);
+
+  /// Return the number of rcl subscriptions shared.
+  RCLCPP_PUBLIC
+  size_t
+  get_reader_count() const;
+
+  /// Return the number of subscriptions receiving the messages of the rcl subscription.
+  RCLCPP_PUBLIC
+  size_t
+  get_subscription_count(const rcl_subscription_t * reader) const;
+
+private:
+  RCLCPP_DISABLE_COPY(SharedReaderManager)
+
+  struct Reader
+  {
+    std::weak_ptr<rcl_subscription_t> handle;
+    std::vector<SubscriptionIntraProcessBase::WeakPtr> subscriptions;
+  };
+
+  /// Remove the readers whose rcl subscription was finalized, mutex_ must be locked.
+  void
+  remove_finalized_readers();
+
+  mutable std::mutex mutex_;
+  /// By key.
+  std::unordered_map<std::string, Reader> readers_;
+  /// Key of the readers, by address of their rcl subscription.
+  std::unordered_map<const rcl_subscription_t *, std::string> keys_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__SHARED_READER_MANAGER_HPP_
@@ -0,0 +1,109 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__EXPERIMENTAL__SHARED_WRITER_MANAGER_HPP_
+#define RCLCPP__EXPERIMENTAL__SHARED_WRITER_MANAGER_HPP_
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "rcl/publisher.h"
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// The rcl publishers shared by the identical publishers of a context.
+/**
+ * Publishers created with PublisherOptionsBase::share_writer, on the same topic with the same
+ * message type, QoS and intra-process setting, share one rcl publisher, so the middleware
+ * announces and keeps a single writer for them.
+ *
+ * A singleton instance of this class is owned by a rclcpp::Context, like the
+ * IntraProcessManager.
+ * The middleware counts a shared rcl publisher once, the publishers sharing it are counted by
+ * this class, see get_additional_publisher_count().
+ */
+class SharedWriterManager
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(SharedWriterManager)
+
+  RCLCPP_PUBLIC
+  SharedWriterManager();
+
+  RCLCPP_PUBLIC
+  virtual ~SharedWriterManager();
+
+  /// Return the rcl publisher shared for the key, calling create() if there is none.
+  /**
+   * The key identifies the topic, the message type, the QoS and the intra-process setting of
+   * the publisher.
+   * Each call must be matched by a call to release_writer().
+   */
+  RCLCPP_PUBLIC
+  std::shared_ptr<rcl_publisher_t>
+  get_writer(
+    const std::string & key,
+    const std::function<std::shared_ptr<rcl_publisher_t>()> & create);
+
+  /// Release the rcl publisher returned by get_writer(), when the publisher is destroyed.
+  RCLCPP_PUBLIC
+  void
+  release_writer(const rcl_publisher_t * writer);
+
+  /// Return the number of publishers sharing the rcl publisher.
+  RCLCPP_PUBLIC
+  size_t
+  get_publisher_count(const rcl_publisher_t * writer) const;
+
+  /// Return the number of publishers on the topic which the middleware doesn't count.
+  /**
+   * For each rcl publisher shared on the topic, the number of publishers sharing it minus one.
+   *
+   * \param[in] topic_name The fully qualified name of the topic.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_additional_publisher_count(const std::string & topic_name) const;
+
+private:
+  RCLCPP_DISABLE_COPY(SharedWriterManager)
+
+  struct Writer
+  {
+    std::weak_ptr<rcl_publisher_t> handle;
+    std::string topic_name;
+    size_t publisher_count;
+  };
+
+  mutable std::mutex mutex_;
+  /// By key.
+  std::unordered_map<std::string, Writer> writers_;
+  /// Key of the writers, by address of their rcl publisher.
+  std::unordered_map<const rcl_publisher_t *, std::string> keys_;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__SHARED_WRITER_MANAGER_HPP_
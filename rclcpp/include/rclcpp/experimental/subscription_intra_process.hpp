@@ -17,17 +17,30 @@
 
 #include <rmw/rmw.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <typeinfo>
 #include <utility>
+#include <vector>
 
 #include "rcl/error_handling.h"
 
 #include "rclcpp/any_subscription_callback.hpp"
+#include "rclcpp/callback_group.hpp"
 #include "rclcpp/experimental/buffers/intra_process_buffer.hpp"
 #include "rclcpp/experimental/create_intra_process_buffer.hpp"
 #include "rclcpp/experimental/subscription_intra_process_base.hpp"
+#include "rclcpp/intra_process_buffer_type.hpp"
+#include "rclcpp/message_rate_limiter.hpp"
+#include "rclcpp/qos_event.hpp"
+#include "rclcpp/scope_exit.hpp"
+#include "rclcpp/topic_statistics.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/waitable.hpp"
 #include "tracetools/tracetools.h"
@@ -64,19 +77,35 @@ public:
     rclcpp::Context::SharedPtr context,
     const std::string & topic_name,
     rmw_qos_profile_t qos_profile,
-    rclcpp::IntraProcessBufferType buffer_type)
+    rclcpp::IntraProcessBufferType buffer_type,
+    rclcpp::IntraProcessBufferImplementation buffer_implementation =
+    rclcpp::IntraProcessBufferImplementation::RingBuffer,
+    size_t max_batch_size = 1)
   : SubscriptionIntraProcessBase(topic_name, qos_profile),
-    any_callback_(callback)
+    any_callback_(callback),
+    max_batch_size_(max_batch_size ? max_batch_size : 1),
+    buffer_implementation_(buffer_implementation),
+    overflow_policy_(rclcpp::IntraProcessBufferOverflowPolicy::DropOldest),
+    max_block_time_(0),
+    reported_dropped_count_(0),
+    synchronous_delivery_(false)
   {
     if (!std::is_same<MessageT, CallbackMessageT>::value) {
       throw std::runtime_error("SubscriptionIntraProcess wrong callback type");
     }
 
+    // Serialized messages are stored shared, the intra-process manager gives each
+    // subscription its own message.
+    if (is_serialized()) {
+      buffer_type = rclcpp::IntraProcessBufferType::SharedPtr;
+    }
+
     // Create the intra-process buffer.
     buffer_ = rclcpp::experimental::create_intra_process_buffer<MessageT, Alloc, Deleter>(
       buffer_type,
       qos_profile,
-      allocator);
+      allocator,
+      buffer_implementation);
 
     // Create the guard condition.
     rcl_guard_condition_options_t guard_condition_options =
@@ -106,26 +135,83 @@ public:
   is_ready(rcl_wait_set_t * wait_set)
   {
     (void)wait_set;
-    return buffer_->has_data();
+    return buffer_->has_data() || broadcast_has_data();
   }
 
   void execute()
   {
+    report_lost_messages();
+    if (!is_ready(nullptr)) {
+      // Several triggers of a buffer keeping the latest message may have been coalesced.
+      return;
+    }
     execute_impl<CallbackMessageT>();
+    // A guard condition triggered several times wakes up the executor once.
+    if (is_ready(nullptr)) {
+      trigger_guard_condition();
+    }
+  }
+
+  /// Take the oldest buffered message without calling the callback.
+  /**
+   * Used to poll the subscription without an executor, see Subscription::take_intra_process().
+   * \return false if the buffer is empty.
+   */
+  bool
+  take_message(ConstMessageSharedPtr & message)
+  {
+    report_lost_messages();
+    if (buffer_->has_data()) {
+      message = buffer_->consume_shared();
+    } else {
+      std::vector<std::shared_ptr<const void>> messages;
+      take_broadcast_messages(messages, 1);
+      if (messages.empty()) {
+        return false;
+      }
+      message = std::static_pointer_cast<const MessageT>(messages.front());
+    }
+    record_statistics(*message);
+    notify_space_available();
+    return true;
   }
 
+  /// Give a message to the buffer of the subscription.
+  /**
+   * \param notify if false, the executor is not woken up, trigger_guard_condition() must be
+   *   called once the messages of a batch were given.
+   */
   void
-  provide_intra_process_message(ConstMessageSharedPtr message)
+  provide_intra_process_message(ConstMessageSharedPtr message, bool notify = true)
   {
+    if (rate_limiter_ && !rate_limiter_->accept()) {
+      return;
+    }
+    if (synchronous_delivery_ && deliver_synchronously(message)) {
+      return;
+    }
+    wait_for_space();
     buffer_->add_shared(std::move(message));
-    trigger_guard_condition();
+    if (notify) {
+      trigger_guard_condition();
+    }
   }
 
+  /// Give a message to the buffer of the subscription, see the overload above.
   void
-  provide_intra_process_message(MessageUniquePtr message)
+  provide_intra_process_message(MessageUniquePtr message, bool notify = true)
   {
+    if (rate_limiter_ && !rate_limiter_->accept()) {
+      return;
+    }
+    if (synchronous_delivery_ && deliver_synchronously(message)) {
+      return;
+    }
+    wait_for_space();
     buffer_->add_unique(std::move(message));
-    trigger_guard_condition();
+    if (notify) {
+      trigger_guard_condition();
+    }
   }
 
   bool
@@ -134,21 +220,283 @@ public:
     return buffer_->use_take_shared_method();
   }
 
+  bool
+  is_serialized() const
+  {
+    return std::is_same<MessageT, rcl_serialized_message_t>::value;
+  }
+
+  const std::type_info &
+  get_message_type() const
+  {
+    return typeid(MessageT);
+  }
+
+  void
+  provide_serialized_intra_process_message(
+    std::shared_ptr<const rcl_serialized_message_t> message)
+  {
+    if (rate_limiter_ && !rate_limiter_->accept()) {
+      return;
+    }
+    provide_serialized_intra_process_message_impl<MessageT>(std::move(message));
+  }
+
+  void
+  provide_shared_intra_process_message(std::shared_ptr<const void> message)
+  {
+    provide_shared_intra_process_message_impl<MessageT>(std::move(message));
+  }
+
+  /// Set the collector recording the executed messages, nullptr to not record them.
+  void
+  set_topic_statistics(std::shared_ptr<rclcpp::TopicStatisticsCollector> topic_statistics)
+  {
+    topic_statistics_ = std::move(topic_statistics);
+  }
+
+  /// Set the rate limiter dropping messages before they are buffered, nullptr to keep them all.
+  /**
+   * It is shared with the subscription, so that the messages received intra-process and
+   * inter-process are downsampled together.
+   */
+  void
+  set_rate_limiter(std::shared_ptr<rclcpp::MessageRateLimiter> rate_limiter)
+  {
+    rate_limiter_ = std::move(rate_limiter);
+  }
+
+  /// Return the number of messages the buffer of this subscription had to copy.
+  size_t
+  get_copy_count() const
+  {
+    return buffer_->get_copy_count();
+  }
+
+  size_t
+  get_buffer_high_water_mark() const
+  {
+    return buffer_->get_high_water_mark();
+  }
+
+  size_t
+  get_buffer_dropped_count() const
+  {
+    return buffer_->get_dropped_count() + get_broadcast_dropped_count();
+  }
+
+  bool
+  is_buffer_full() const
+  {
+    return buffer_->is_full();
+  }
+
+  size_t
+  get_buffer_memory_usage() const
+  {
+    return sizeof(*this) + buffer_->get_memory_usage();
+  }
+
+  bool
+  can_read_broadcast() const
+  {
+    // The messages read from the rings are given like the ones of a keep last ring buffer.
+    return !is_serialized() && buffer_->use_take_shared_method() &&
+           any_callback_.use_take_shared_method() && !any_callback_.is_batch_callback() &&
+           buffer_implementation_ == rclcpp::IntraProcessBufferImplementation::RingBuffer &&
+           overflow_policy_ == rclcpp::IntraProcessBufferOverflowPolicy::DropOldest &&
+           !rate_limiter_ && !synchronous_delivery_;
+  }
+
+  /// Set what happens when a message is given while the buffer is full.
+  /**
+   * It must be set before the subscription is added to the intra-process manager.
+   *
+   * \param[in] overflow_policy drop the oldest message, or block the caller.
+   * \param[in] max_block_time maximum time the caller is blocked.
+   */
+  void
+  set_overflow_policy(
+    rclcpp::IntraProcessBufferOverflowPolicy overflow_policy,
+    std::chrono::nanoseconds max_block_time)
+  {
+    overflow_policy_ = overflow_policy;
+    max_block_time_ = max_block_time;
+  }
+
+  /// Set the callback called by execute() when the buffer dropped messages, nullptr for none.
+  void
+  set_message_lost_callback(rclcpp::QOSIntraProcessMessageLostCallbackType callback)
+  {
+    message_lost_callback_ = std::move(callback);
+  }
+
+  /// Call the callback on the publishing thread when possible, instead of buffering the message.
+  /**
+   * See SubscriptionOptionsBase::intra_process_synchronous_delivery.
+   * It must be set before the subscription is added to the intra-process manager.
+   *
+   * \param[in] group the callback group of the subscription.
+   * \param[in] wake_executor called when a mutually exclusive group is released, the executor
+   *   doesn't wait on the entities of a group while it is taken.
+   */
+  void
+  set_synchronous_delivery(
+    rclcpp::callback_group::CallbackGroup::WeakPtr group, std::function<void()> wake_executor)
+  {
+    synchronous_group_ = std::move(group);
+    wake_executor_ = std::move(wake_executor);
+    synchronous_delivery_ = true;
+  }
+
 private:
+  /// Call the callback with the message if its group is free, return false to buffer it instead.
+  template<typename MessagePtrT>
+  bool
+  deliver_synchronously(MessagePtrT & message)
+  {
+    // Batches are built from the buffer, and the buffered messages are older than this one.
+    if (any_callback_.is_batch_callback() || !can_dispatch(message) || buffer_->has_data()) {
+      return false;
+    }
+    auto group = synchronous_group_.lock();
+    if (!group) {
+      return false;
+    }
+    if (group->type() == rclcpp::callback_group::CallbackGroupType::Reentrant) {
+      record_statistics(*message);
+      dispatch_synchronously(std::move(message));
+      return true;
+    }
+    bool can_be_taken_from = true;
+    if (!group->can_be_taken_from().compare_exchange_strong(can_be_taken_from, false)) {
+      // Executing a callback of the group on another thread, or on this one.
+      return false;
+    }
+    RCLCPP_SCOPE_EXIT(group->can_be_taken_from().store(true); wake_executor_(); );
+    record_statistics(*message);
+    dispatch_synchronously(std::move(message));
+    return true;
+  }
+
+  bool
+  can_dispatch(const ConstMessageSharedPtr &) const
+  {
+    // A callback taking ownership needs a copy, which the buffer makes.
+    return any_callback_.use_take_shared_method();
+  }
+
+  bool
+  can_dispatch(const MessageUniquePtr &) const
+  {
+    return true;
+  }
+
+  void
+  dispatch_synchronously(ConstMessageSharedPtr message)
+  {
+    rmw_message_info_t msg_info;
+    msg_info.publisher_gid = {0, {0}};
+    msg_info.from_intra_process = true;
+    any_callback_.dispatch_intra_process(std::move(message), msg_info);
+  }
+
   void
-  trigger_guard_condition()
+  dispatch_synchronously(MessageUniquePtr message)
   {
-    rcl_ret_t ret = rcl_trigger_guard_condition(&gc_);
-    (void)ret;
+    if (any_callback_.use_take_shared_method()) {
+      dispatch_synchronously(ConstMessageSharedPtr(std::move(message)));
+      return;
+    }
+    rmw_message_info_t msg_info;
+    msg_info.publisher_gid = {0, {0}};
+    msg_info.from_intra_process = true;
+    any_callback_.dispatch_intra_process(std::move(message), msg_info);
+  }
+
+  /// With IntraProcessBufferOverflowPolicy::Block, wait until the buffer isn't full any longer.
+  void
+  wait_for_space()
+  {
+    if (overflow_policy_ != rclcpp::IntraProcessBufferOverflowPolicy::Block ||
+      !buffer_->is_full())
+    {
+      return;
+    }
+    std::unique_lock<std::mutex> lock(space_mutex_);
+    space_available_.wait_for(lock, max_block_time_, [this]() {return !buffer_->is_full();});
+  }
+
+  /// Call the message lost callback if the buffer dropped messages since it was last called.
+  void
+  report_lost_messages()
+  {
+    if (!message_lost_callback_) {
+      return;
+    }
+    size_t total_count = get_buffer_dropped_count();
+    size_t reported_count = reported_dropped_count_.load(std::memory_order_relaxed);
+    do {
+      if (total_count <= reported_count) {
+        return;
+      }
+    } while (!reported_dropped_count_.compare_exchange_weak(
+        reported_count, total_count, std::memory_order_relaxed));
+    rclcpp::QOSIntraProcessMessageLostInfo info;
+    info.total_count = total_count;
+    info.total_count_change = total_count - reported_count;
+    message_lost_callback_(info);
   }
 
   template<typename T>
   typename std::enable_if<std::is_same<T, rcl_serialized_message_t>::value, void>::type
-  execute_impl()
+  provide_serialized_intra_process_message_impl(
+    std::shared_ptr<const rcl_serialized_message_t> message)
+  {
+    wait_for_space();
+    buffer_->add_shared(std::move(message));
+    trigger_guard_condition();
+  }
+
+  template<typename T>
+  typename std::enable_if<!std::is_same<T, rcl_serialized_message_t>::value, void>::type
+  provide_serialized_intra_process_message_impl(
+    std::shared_ptr<const rcl_serialized_message_t> message)
   {
+    (void)message;
     throw std::runtime_error("Subscription intra-process can't handle serialized messages");
   }
 
+  template<typename T>
+  typename std::enable_if<!std::is_same<T, rcl_serialized_message_t>::value, void>::type
+  provide_shared_intra_process_message_impl(std::shared_ptr<const void> message)
+  {
+    provide_intra_process_message(std::static_pointer_cast<const MessageT>(message));
+  }
+
+  template<typename T>
+  typename std::enable_if<std::is_same<T, rcl_serialized_message_t>::value, void>::type
+  provide_shared_intra_process_message_impl(std::shared_ptr<const void> message)
+  {
+    (void)message;
+    throw std::runtime_error("Subscription intra-process can't share a deserialized message");
+  }
+
+  template<typename T>
+  typename std::enable_if<std::is_same<T, rcl_serialized_message_t>::value, void>::type
+  execute_impl()
+  {
+    rmw_message_info_t msg_info;
+    msg_info.publisher_gid = {0, {0}};
+    msg_info.from_intra_process = true;
+
+    // The message is not shared with other subscriptions, so it can be given as mutable.
+    auto msg = std::const_pointer_cast<rcl_serialized_message_t>(buffer_->consume_shared());
+    notify_space_available();
+    record_statistics(*msg);
+    any_callback_.dispatch(msg, msg_info);
+  }
+
   template<class T>
   typename std::enable_if<!std::is_same<T, rcl_serialized_message_t>::value, void>::type
   execute_impl()
@@ -157,16 +505,84 @@ private:
     msg_info.publisher_gid = {0, {0}};
     msg_info.from_intra_process = true;
 
-    if (any_callback_.use_take_shared_method()) {
-      ConstMessageSharedPtr msg = buffer_->consume_shared();
-      any_callback_.dispatch_intra_process(msg, msg_info);
+    // The buffered messages are taken at once, and the publishers blocked on the full buffer
+    // are woken up before the callbacks are called.
+    // Without a batch callback, the whole backlog is executed, bounded by the buffer depth,
+    // instead of one message per wake up of the executor.
+    if (any_callback_.is_batch_callback()) {
+      // Give all the buffered messages at once, up to the batch size.
+      std::vector<ConstMessageSharedPtr> batch;
+      buffer_->consume_shared_n(batch, max_batch_size_);
+      notify_space_available();
+      for (const auto & msg : batch) {
+        record_statistics(*msg);
+      }
+      if (!batch.empty()) {
+        any_callback_.dispatch_batch(std::move(batch));
+      }
+    } else if (any_callback_.use_take_shared_method()) {
+      std::vector<ConstMessageSharedPtr> messages;
+      buffer_->consume_shared_n(messages, std::numeric_limits<size_t>::max());
+      notify_space_available();
+      for (auto & msg : messages) {
+        record_statistics(*msg);
+        any_callback_.dispatch_intra_process(std::move(msg), msg_info);
+      }
+      // The messages given to the buffer, e.g. by a transient local publisher, came first.
+      std::vector<std::shared_ptr<const void>> broadcast_messages;
+      take_broadcast_messages(broadcast_messages, std::numeric_limits<size_t>::max());
+      for (auto & msg : broadcast_messages) {
+        auto typed_msg = std::static_pointer_cast<const MessageT>(std::move(msg));
+        record_statistics(*typed_msg);
+        any_callback_.dispatch_intra_process(std::move(typed_msg), msg_info);
+      }
     } else {
-      MessageUniquePtr msg = buffer_->consume_unique();
-      any_callback_.dispatch_intra_process(std::move(msg), msg_info);
+      std::vector<MessageUniquePtr> messages;
+      buffer_->consume_unique_n(messages, std::numeric_limits<size_t>::max());
+      notify_space_available();
+      for (auto & msg : messages) {
+        record_statistics(*msg);
+        any_callback_.dispatch_intra_process(std::move(msg), msg_info);
+      }
+    }
+  }
+
+  /// Wake up the publishers blocked on the full buffer, once a message was consumed.
+  void
+  notify_space_available()
+  {
+    if (overflow_policy_ == rclcpp::IntraProcessBufferOverflowPolicy::Block) {
+      {
+        // Taken so that a publisher can't miss the notification between its check and its wait.
+        std::lock_guard<std::mutex> lock(space_mutex_);
+      }
+      space_available_.notify_all();
+    }
+  }
+
+  template<typename T>
+  void
+  record_statistics(const T & msg)
+  {
+    if (topic_statistics_) {
+      topic_statistics_->record_message(msg);
     }
   }
 
   AnySubscriptionCallback<CallbackMessageT, Alloc> any_callback_;
+  const size_t max_batch_size_;
+  const rclcpp::IntraProcessBufferImplementation buffer_implementation_;
+  std::shared_ptr<rclcpp::TopicStatisticsCollector> topic_statistics_;
+  std::shared_ptr<rclcpp::MessageRateLimiter> rate_limiter_;
+  rclcpp::IntraProcessBufferOverflowPolicy overflow_policy_;
+  std::chrono::nanoseconds max_block_time_;
+  std::mutex space_mutex_;
+  std::condition_variable space_available_;
+  rclcpp::QOSIntraProcessMessageLostCallbackType message_lost_callback_;
+  std::atomic<size_t> reported_dropped_count_;
+  bool synchronous_delivery_;
+  rclcpp::callback_group::CallbackGroup::WeakPtr synchronous_group_;
+  std::function<void()> wake_executor_;
   BufferUniquePtr buffer_;
 };
 
@@ -17,14 +17,20 @@
 
 #include <rmw/rmw.h>
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <typeinfo>
 #include <utility>
+#include <vector>
 
 #include "rcl/error_handling.h"
+#include "rcl/types.h"
 
+#include "rclcpp/experimental/buffers/broadcast_ring_buffer.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/waitable.hpp"
 
@@ -33,14 +39,18 @@ namespace rclcpp
 namespace experimental
 {
 
-class SubscriptionIntraProcessBase : public rclcpp::Waitable
+class SubscriptionIntraProcessGroup;
+
+class SubscriptionIntraProcessBase
+  : public rclcpp::Waitable, public std::enable_shared_from_this<SubscriptionIntraProcessBase>
 {
 public:
   RCLCPP_SMART_PTR_ALIASES_ONLY(SubscriptionIntraProcessBase)
 
   RCLCPP_PUBLIC
   SubscriptionIntraProcessBase(const std::string & topic_name, rmw_qos_profile_t qos_profile)
-  : topic_name_(topic_name), qos_profile_(qos_profile)
+  : last_wait_set_(nullptr), last_wait_set_stamp_(0),
+    topic_name_(topic_name), qos_profile_(qos_profile)
   {}
 
   virtual ~SubscriptionIntraProcessBase() = default;
@@ -49,10 +59,26 @@ public:
   size_t
   get_number_of_ready_guard_conditions() {return 1;}
 
+  /// Add the guard condition to the wait set, and record the wait set, see get_last_wait_set().
+  /**
+   * The guard condition is triggered if messages are already buffered, the manager may have
+   * woken up the previous wait set of the subscription instead.
+   */
   RCLCPP_PUBLIC
   bool
   add_to_wait_set(rcl_wait_set_t * wait_set);
 
+  /// Return the wait set this subscription was last added to, nullptr if it never was.
+  /**
+   * Only the address of the wait set is recorded, it must not be dereferenced.
+   *
+   * \param[out] stamp The order in which subscriptions were added to wait sets: among the
+   *   subscriptions of a wait set, the one with the highest stamp is part of its latest fill.
+   */
+  RCLCPP_PUBLIC
+  const rcl_wait_set_t *
+  get_last_wait_set(uint64_t & stamp);
+
   virtual bool
   is_ready(rcl_wait_set_t * wait_set) = 0;
 
@@ -62,6 +88,90 @@ public:
   virtual bool
   use_take_shared_method() const = 0;
 
+  /// Return true if the subscription takes serialized messages.
+  virtual bool
+  is_serialized() const = 0;
+
+  /// Return the type of the messages buffered, the custom type if the message type is adapted.
+  virtual const std::type_info &
+  get_message_type() const = 0;
+
+  /// Give a serialized message to a subscription for which is_serialized() is true.
+  /**
+   * The subscription takes ownership of the message, it is not shared with other subscriptions.
+   */
+  virtual void
+  provide_serialized_intra_process_message(
+    std::shared_ptr<const rcl_serialized_message_t> message) = 0;
+
+  /// Give a message of the type given by get_message_type(), shared with other subscriptions.
+  /**
+   * Used for the messages taken from an rcl subscription shared by several subscriptions, see
+   * SharedReaderManager, and for the messages kept by transient local publishers.
+   */
+  virtual void
+  provide_shared_intra_process_message(std::shared_ptr<const void> message) = 0;
+
+  /// Return the largest number of messages the buffer held, 0 if it is not tracked.
+  virtual size_t
+  get_buffer_high_water_mark() const = 0;
+
+  /// Return the number of messages dropped because the buffer was full.
+  virtual size_t
+  get_buffer_dropped_count() const = 0;
+
+  /// Return true if the buffer is full, so that the next message would be dropped or blocked.
+  virtual bool
+  is_buffer_full() const = 0;
+
+  /// Return the bytes of this subscription and of its buffer, the messages aren't counted.
+  virtual size_t
+  get_buffer_memory_usage() const = 0;
+
+  /// Return true if the subscription can read the messages of a publisher from its ring.
+  /**
+   * See PublisherOptionsBase::intra_process_broadcast_depth.
+   * The subscription must take shared messages, and must keep them as its keep last buffer
+   * would, without a step between the publisher and the buffer such as a rate limiter.
+   */
+  virtual bool
+  can_read_broadcast() const = 0;
+
+  /// Read the messages of a publisher from its ring, from the next message written on.
+  /**
+   * The messages of the ring are kept up to the depth of the QoS of the subscription, the
+   * older unread ones are skipped and counted as dropped.
+   * The messages of different publishers are read one publisher after the other, not in the
+   * order they were published.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_broadcast_reader(rclcpp::experimental::buffers::BroadcastRingBuffer::SharedPtr ring);
+
+  /// Stop reading the ring, once the messages written until now are read.
+  RCLCPP_PUBLIC
+  void
+  remove_broadcast_reader(
+    const rclcpp::experimental::buffers::BroadcastRingBuffer::SharedPtr & ring);
+
+  /// Wake up the executor waiting on this subscription.
+  /**
+   * If the subscription is in a SubscriptionIntraProcessGroup, it is queued in the group
+   * instead, and the group wakes up the executor.
+   */
+  RCLCPP_PUBLIC
+  void
+  trigger_guard_condition();
+
+  /// Let the group wake up the executor for this subscription, instead of its guard condition.
+  /**
+   * The subscription must be owned by a shared pointer, and is then waited on through the
+   * group only: it isn't added to wait sets itself.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_group(std::weak_ptr<SubscriptionIntraProcessGroup> group);
+
   RCLCPP_PUBLIC
   const char *
   get_topic_name() const;
@@ -71,12 +181,50 @@ public:
   get_actual_qos() const;
 
 protected:
+  /// Return true if a ring read by the subscription has unread messages.
+  RCLCPP_PUBLIC
+  bool
+  broadcast_has_data() const;
+
+  /// Read the unread messages of the rings, up to max_count, and append them to messages.
+  RCLCPP_PUBLIC
+  void
+  take_broadcast_messages(std::vector<std::shared_ptr<const void>> & messages, size_t max_count);
+
+  /// Return the number of messages of the rings skipped because they weren't read in time.
+  RCLCPP_PUBLIC
+  size_t
+  get_broadcast_dropped_count() const;
+
   std::recursive_mutex reentrant_mutex_;
   rcl_guard_condition_t gc_;
 
 private:
-  virtual void
-  trigger_guard_condition() = 0;
+  struct BroadcastReader
+  {
+    rclcpp::experimental::buffers::BroadcastRingBuffer::SharedPtr ring;
+    /// Sequence of the next message to read.
+    uint64_t cursor;
+    /// True once the reader is removed, it is dropped when it has no more messages.
+    bool removed;
+  };
+
+  mutable std::mutex broadcast_mutex_;
+  std::vector<BroadcastReader> broadcast_readers_;
+  /// Read without locking, so that a subscription without reader doesn't lock.
+  std::atomic<bool> has_broadcast_readers_{false};
+  std::atomic<size_t> broadcast_dropped_count_{0};
+
+  friend class SubscriptionIntraProcessGroup;
+
+  /// Protected by reentrant_mutex_.
+  std::weak_ptr<SubscriptionIntraProcessGroup> group_;
+  /// True while the subscription is in the ready queue of its group.
+  std::atomic<bool> queued_in_group_{false};
+
+  /// Recorded by add_to_wait_set(), protected by reentrant_mutex_.
+  const rcl_wait_set_t * last_wait_set_;
+  uint64_t last_wait_set_stamp_;
 
   std::string topic_name_;
   rmw_qos_profile_t qos_profile_;
@@ -0,0 +1,107 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__EXPERIMENTAL__SUBSCRIPTION_INTRA_PROCESS_GROUP_HPP_
+#define RCLCPP__EXPERIMENTAL__SUBSCRIPTION_INTRA_PROCESS_GROUP_HPP_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rcl/guard_condition.h"
+#include "rcl/wait.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/experimental/subscription_intra_process_base.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Waitable for the intra-process subscriptions of a node in one callback group.
+/**
+ * The executor waits on the single guard condition of the group, whatever the number of
+ * subscriptions.
+ * A subscription given a message is queued in the group, and each call to execute() executes
+ * the subscription at the front of the queue, so that idle subscriptions cost nothing.
+ */
+class SubscriptionIntraProcessGroup
+  : public rclcpp::Waitable, public std::enable_shared_from_this<SubscriptionIntraProcessGroup>
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(SubscriptionIntraProcessGroup)
+
+  /// Construct the group, with its guard condition in the given context.
+  /**
+   * \throws rclcpp::exceptions::RCLError if the guard condition can't be created.
+   */
+  RCLCPP_PUBLIC
+  explicit SubscriptionIntraProcessGroup(rclcpp::Context::SharedPtr context);
+
+  RCLCPP_PUBLIC
+  ~SubscriptionIntraProcessGroup() override;
+
+  /// Wait on the subscription through this group, it must not be added to wait sets itself.
+  RCLCPP_PUBLIC
+  void
+  add_subscription(const SubscriptionIntraProcessBase::SharedPtr & subscription);
+
+  /// Queue the subscription to be executed, and wake up the executor.
+  RCLCPP_PUBLIC
+  void
+  notify(SubscriptionIntraProcessBase::SharedPtr subscription);
+
+  /// Return the number of subscriptions queued to be executed.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_queued_subscriptions() const;
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_ready_guard_conditions() override;
+
+  RCLCPP_PUBLIC
+  bool
+  add_to_wait_set(rcl_wait_set_t * wait_set) override;
+
+  RCLCPP_PUBLIC
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override;
+
+  /// Execute the subscription at the front of the queue.
+  RCLCPP_PUBLIC
+  void
+  execute() override;
+
+private:
+  void
+  trigger_guard_condition();
+
+  rcl_guard_condition_t gc_;
+
+  mutable std::mutex queue_mutex_;
+  /// The queue starts at queue_front_, the vector is reused so that queuing doesn't allocate.
+  std::vector<SubscriptionIntraProcessBase::WeakPtr> queue_;
+  size_t queue_front_ = 0;
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__SUBSCRIPTION_INTRA_PROCESS_GROUP_HPP_
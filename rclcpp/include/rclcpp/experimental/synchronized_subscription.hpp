@@ -0,0 +1,418 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__EXPERIMENTAL__SYNCHRONIZED_SUBSCRIPTION_HPP_
+#define RCLCPP__EXPERIMENTAL__SYNCHRONIZED_SUBSCRIPTION_HPP_
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "rcl/time.h"
+
+#include "rclcpp/create_subscription.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/subscription.hpp"
+#include "rclcpp/subscription_options.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+/// Return the time stamp of a message synchronized by a SynchronizedSubscription.
+/**
+ * The default reads the stamp of a std_msgs/Header member named header, specialize it for
+ * the messages stamped otherwise.
+ */
+template<typename MessageT>
+struct MessageStamp
+{
+  /// Return the stamp of the message, in nanoseconds.
+  static int64_t
+  get(const MessageT & msg)
+  {
+    return RCL_S_TO_NS(static_cast<int64_t>(msg.header.stamp.sec)) + msg.header.stamp.nanosec;
+  }
+};
+
+/// How the messages of the inputs of a SynchronizedSubscription are matched.
+enum class SynchronizationPolicy
+{
+  /// The matched messages have the same stamp.
+  ExactTime,
+  /// The stamps of the matched messages are at most max_interval apart.
+  /**
+   * The message just received is matched with the message of each other input with the
+   * closest stamp, so that a match is given as soon as it is complete.
+   */
+  ApproximateTime
+};
+
+/// Options of a SynchronizedSubscription.
+struct SynchronizationOptions
+{
+  SynchronizationPolicy policy = SynchronizationPolicy::ExactTime;
+  /// Number of unmatched messages kept per input, the oldest one is dropped when it is full.
+  size_t queue_size = 10;
+  /// Maximum difference between the stamps of matched messages of the ApproximateTime policy.
+  std::chrono::nanoseconds max_interval = std::chrono::nanoseconds::zero();
+};
+
+namespace detail
+{
+
+/// Fixed size ring buffer of the unmatched messages of an input, in the order of reception.
+template<typename MessageT>
+class SynchronizerInputBuffer
+{
+public:
+  using ConstMessageSharedPtr = std::shared_ptr<const MessageT>;
+
+  explicit SynchronizerInputBuffer(size_t capacity)
+  : messages_(capacity), stamps_(capacity)
+  {
+    if (0u == capacity) {
+      throw std::invalid_argument("the queue size of a synchronized subscription can't be 0");
+    }
+  }
+
+  void
+  push(ConstMessageSharedPtr message, int64_t stamp)
+  {
+    if (size_ == messages_.size()) {
+      drop_until(0);
+      ++dropped_count_;
+    }
+    size_t index = (front_ + size_) % messages_.size();
+    messages_[index] = std::move(message);
+    stamps_[index] = stamp;
+    ++size_;
+  }
+
+  size_t
+  size() const
+  {
+    return size_;
+  }
+
+  int64_t
+  stamp(size_t i) const
+  {
+    return stamps_[(front_ + i) % stamps_.size()];
+  }
+
+  /// Return the message at the given position, starting from the oldest message.
+  ConstMessageSharedPtr
+  take(size_t i)
+  {
+    ConstMessageSharedPtr message = std::move(messages_[(front_ + i) % messages_.size()]);
+    drop_until(i);
+    return message;
+  }
+
+  /// Return the position of the oldest message with the stamp, or size() if there is none.
+  size_t
+  find_exact(int64_t stamp) const
+  {
+    for (size_t i = 0; i < size_; ++i) {
+      if (this->stamp(i) == stamp) {
+        return i;
+      }
+    }
+    return size_;
+  }
+
+  /// Return the position of the message with the closest stamp, or size() if it is empty.
+  size_t
+  find_closest(int64_t stamp) const
+  {
+    size_t closest = size_;
+    uint64_t closest_distance = UINT64_MAX;
+    for (size_t i = 0; i < size_; ++i) {
+      int64_t difference = this->stamp(i) - stamp;
+      uint64_t distance = difference < 0 ?
+        0u - static_cast<uint64_t>(difference) : static_cast<uint64_t>(difference);
+      if (distance < closest_distance) {
+        closest = i;
+        closest_distance = distance;
+      }
+    }
+    return closest;
+  }
+
+  size_t
+  get_dropped_count() const
+  {
+    return dropped_count_;
+  }
+
+private:
+  /// Drop the messages up to the given position, included.
+  void
+  drop_until(size_t i)
+  {
+    for (size_t dropped = 0; dropped <= i; ++dropped) {
+      messages_[front_].reset();
+      front_ = (front_ + 1) % messages_.size();
+      --size_;
+    }
+  }
+
+  std::vector<ConstMessageSharedPtr> messages_;
+  std::vector<int64_t> stamps_;
+  size_t front_ = 0;
+  size_t size_ = 0;
+  size_t dropped_count_ = 0;
+};
+
+}  // namespace detail
+
+/// Match the messages of several inputs by stamp, and give each match to one callback.
+/**
+ * The messages are kept in the preallocated ring buffers of the inputs, by shared pointer, so
+ * that they are neither copied nor allocated again.
+ * The matched messages, and the unmatched messages received before them, are removed from the
+ * buffers.
+ * The callback is called by the thread adding the message completing the match, outside of
+ * the lock of the buffers.
+ */
+template<typename ... MessageTs>
+class MessageSynchronizer
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(MessageSynchronizer)
+
+  static constexpr size_t input_count = sizeof...(MessageTs);
+  using CallbackT = std::function<void(std::shared_ptr<const MessageTs>...)>;
+
+  MessageSynchronizer(const SynchronizationOptions & options, CallbackT callback)
+  : options_(options),
+    callback_(std::move(callback)),
+    buffers_(detail::SynchronizerInputBuffer<MessageTs>(options.queue_size)...)
+  {
+    static_assert(input_count >= 2, "at least two inputs are synchronized");
+    if (!callback_) {
+      throw std::invalid_argument("the callback of a synchronized subscription is empty");
+    }
+  }
+
+  /// Add the message received by the input I, and give the match it completes to the callback.
+  template<size_t I>
+  void
+  add(std::shared_ptr<const typename std::tuple_element<I, std::tuple<MessageTs...>>::type> msg)
+  {
+    using MessageT = typename std::tuple_element<I, std::tuple<MessageTs...>>::type;
+    int64_t stamp = MessageStamp<MessageT>::get(*msg);
+    std::tuple<std::shared_ptr<const MessageTs>...> matched;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::get<I>(buffers_).push(std::move(msg), stamp);
+      std::array<size_t, input_count> positions;
+      if (!find_match(stamp, positions, std::index_sequence_for<MessageTs...>())) {
+        return;
+      }
+      take_match(positions, matched, std::index_sequence_for<MessageTs...>());
+    }
+    call(matched, std::index_sequence_for<MessageTs...>());
+  }
+
+  /// Return the number of messages of the input I dropped unmatched from its full buffer.
+  template<size_t I>
+  size_t
+  get_dropped_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::get<I>(buffers_).get_dropped_count();
+  }
+
+private:
+  template<size_t ... Is>
+  bool
+  find_match(
+    int64_t stamp, std::array<size_t, input_count> & positions, std::index_sequence<Is...>)
+  {
+    bool found = true;
+    int64_t min_stamp = stamp;
+    int64_t max_stamp = stamp;
+    (void)std::initializer_list<int>{
+      (found = found && find_in_input<Is>(stamp, positions[Is], min_stamp, max_stamp), 0)...};
+    return found &&
+           (options_.policy == SynchronizationPolicy::ExactTime ||
+           max_stamp - min_stamp <= options_.max_interval.count());
+  }
+
+  template<size_t I>
+  bool
+  find_in_input(int64_t stamp, size_t & position, int64_t & min_stamp, int64_t & max_stamp)
+  {
+    auto & buffer = std::get<I>(buffers_);
+    position = options_.policy == SynchronizationPolicy::ExactTime ?
+      buffer.find_exact(stamp) : buffer.find_closest(stamp);
+    if (position == buffer.size()) {
+      return false;
+    }
+    min_stamp = std::min(min_stamp, buffer.stamp(position));
+    max_stamp = std::max(max_stamp, buffer.stamp(position));
+    return true;
+  }
+
+  template<size_t ... Is>
+  void
+  take_match(
+    const std::array<size_t, input_count> & positions,
+    std::tuple<std::shared_ptr<const MessageTs>...> & matched,
+    std::index_sequence<Is...>)
+  {
+    (void)std::initializer_list<int>{
+      (std::get<Is>(matched) = std::get<Is>(buffers_).take(positions[Is]), 0)...};
+  }
+
+  template<size_t ... Is>
+  void
+  call(std::tuple<std::shared_ptr<const MessageTs>...> & matched, std::index_sequence<Is...>)
+  {
+    callback_(std::move(std::get<Is>(matched))...);
+  }
+
+  const SynchronizationOptions options_;
+  CallbackT callback_;
+  mutable std::mutex mutex_;
+  std::tuple<detail::SynchronizerInputBuffer<MessageTs>...> buffers_;
+};
+
+/// Subscriptions to several topics, giving their messages matched by stamp to one callback.
+/**
+ * The callback is called by the executor executing the subscription receiving the message
+ * which completes a match.
+ */
+template<typename ... MessageTs>
+class SynchronizedSubscription
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(SynchronizedSubscription)
+
+  using SynchronizerT = MessageSynchronizer<MessageTs...>;
+  using CallbackT = typename SynchronizerT::CallbackT;
+
+  /// Subscribe to the topics, the message types being given in the order of the topics.
+  /**
+   * \param[in] node the node creating the subscriptions, see rclcpp::create_subscription().
+   * \param[in] topic_names the topic of each input.
+   * \param[in] qos the QoS of the subscriptions.
+   * \param[in] callback the callback taking the matched messages.
+   * \param[in] sync_options how the messages are matched.
+   * \param[in] options the options of the subscriptions.
+   * \throws std::invalid_argument if the queue size is 0 or the callback is empty.
+   */
+  template<typename NodeT>
+  SynchronizedSubscription(
+    NodeT && node,
+    const std::array<std::string, sizeof...(MessageTs)> & topic_names,
+    const rclcpp::QoS & qos,
+    CallbackT callback,
+    const SynchronizationOptions & sync_options = SynchronizationOptions(),
+    const rclcpp::SubscriptionOptions & options = rclcpp::SubscriptionOptions())
+  : synchronizer_(std::make_shared<SynchronizerT>(sync_options, std::move(callback))),
+    subscriptions_(
+      create_subscriptions(
+        node, topic_names, qos, options, std::index_sequence_for<MessageTs...>()))
+  {}
+
+  /// Return the subscription of the input I.
+  template<size_t I>
+  typename std::tuple_element<
+    I, std::tuple<typename rclcpp::Subscription<MessageTs>::SharedPtr...>>::type
+  get_subscription() const
+  {
+    return std::get<I>(subscriptions_);
+  }
+
+  /// Return the number of messages of the input I dropped unmatched, see queue_size.
+  template<size_t I>
+  size_t
+  get_dropped_count() const
+  {
+    return synchronizer_->template get_dropped_count<I>();
+  }
+
+private:
+  template<typename NodeT, size_t ... Is>
+  std::tuple<typename rclcpp::Subscription<MessageTs>::SharedPtr...>
+  create_subscriptions(
+    NodeT & node,
+    const std::array<std::string, sizeof...(MessageTs)> & topic_names,
+    const rclcpp::QoS & qos,
+    const rclcpp::SubscriptionOptions & options,
+    std::index_sequence<Is...>)
+  {
+    return std::make_tuple(create_input<Is, MessageTs>(node, topic_names[Is], qos, options)...);
+  }
+
+  template<size_t I, typename MessageT, typename NodeT>
+  typename rclcpp::Subscription<MessageT>::SharedPtr
+  create_input(
+    NodeT & node,
+    const std::string & topic_name,
+    const rclcpp::QoS & qos,
+    const rclcpp::SubscriptionOptions & options)
+  {
+    // The subscriptions don't keep the synchronized subscription alive.
+    std::weak_ptr<SynchronizerT> weak_synchronizer = synchronizer_;
+    return rclcpp::create_subscription<MessageT>(
+      node, topic_name, qos,
+      [weak_synchronizer](std::shared_ptr<const MessageT> msg) {
+        auto synchronizer = weak_synchronizer.lock();
+        if (synchronizer) {
+          synchronizer->template add<I>(std::move(msg));
+        }
+      },
+      options);
+  }
+
+  std::shared_ptr<SynchronizerT> synchronizer_;
+  std::tuple<typename rclcpp::Subscription<MessageTs>::SharedPtr...> subscriptions_;
+};
+
+/// Create a SynchronizedSubscription, see its constructor.
+template<typename ... MessageTs, typename NodeT>
+typename SynchronizedSubscription<MessageTs...>::SharedPtr
+create_synchronized_subscription(
+  NodeT && node,
+  const std::array<std::string, sizeof...(MessageTs)> & topic_names,
+  const rclcpp::QoS & qos,
+  typename SynchronizedSubscription<MessageTs...>::CallbackT callback,
+  const SynchronizationOptions & sync_options = SynchronizationOptions(),
+  const rclcpp::SubscriptionOptions & options = rclcpp::SubscriptionOptions())
+{
+  return std::make_shared<SynchronizedSubscription<MessageTs...>>(
+    node, topic_names, qos, std::move(callback), sync_options, options);
+}
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+#endif  // RCLCPP__EXPERIMENTAL__SYNCHRONIZED_SUBSCRIPTION_HPP_
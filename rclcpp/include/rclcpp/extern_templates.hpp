@@ -0,0 +1,67 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__EXTERN_TEMPLATES_HPP_
+#define RCLCPP__EXTERN_TEMPLATES_HPP_
+
+#include <memory>
+
+#include "rclcpp/any_subscription_callback.hpp"
+#include "rclcpp/experimental/intra_process_manager.hpp"
+#include "rclcpp/experimental/subscription_intra_process.hpp"
+#include "rclcpp/publisher.hpp"
+#include "rclcpp/subscription.hpp"
+
+/// Declare that the rclcpp templates of a message type are instantiated in another library.
+/**
+ * The translation units using the macro do not instantiate the publisher, the subscription,
+ * the callback dispatch and the intra-process delivery of the message type, which make up
+ * most of their build time.
+ * The templates are instantiated once, with RCLCPP_INSTANTIATE_MESSAGE_TEMPLATES(), in the
+ * library linked with them.
+ *
+ * Only the default allocator and deleter are covered, the publishers and subscriptions
+ * with a custom allocator are instantiated in each translation unit as before.
+ * The macro must be used at global scope, before the templates are used with the type.
+ *
+ * The CMake function rclcpp_add_message_instantiations() generates both the library and a
+ * header using this macro for the messages of a package.
+ *
+ * \param MessageT the fully qualified message type, e.g. std_msgs::msg::String.
+ */
+#define RCLCPP_EXTERN_MESSAGE_TEMPLATES(MessageT) \
+  RCLCPP_MESSAGE_TEMPLATES_(extern, MessageT)
+
+/// Instantiate the rclcpp templates of a message type declared with the macro above.
+/**
+ * \param MessageT the fully qualified message type, e.g. std_msgs::msg::String.
+ */
+#define RCLCPP_INSTANTIATE_MESSAGE_TEMPLATES(MessageT) \
+  RCLCPP_MESSAGE_TEMPLATES_(, MessageT)
+
+#define RCLCPP_MESSAGE_TEMPLATES_(prefix, MessageT) \
+  prefix template class rclcpp::Publisher<MessageT>; \
+  prefix template class rclcpp::Subscription<MessageT>; \
+  prefix template class rclcpp::AnySubscriptionCallback<MessageT, std::allocator<void>>; \
+  prefix template class rclcpp::experimental::SubscriptionIntraProcess< \
+    MessageT, std::allocator<void>, std::default_delete<MessageT>>; \
+  prefix template void \
+  rclcpp::experimental::IntraProcessManager::do_intra_process_publish< \
+    MessageT, std::allocator<void>, std::default_delete<MessageT>>( \
+    const rclcpp::experimental::IntraProcessManager::PublisherSubscriptions &, \
+    std::unique_ptr<MessageT, std::default_delete<MessageT>>, \
+    std::shared_ptr<std::allocator<MessageT>>)
+
+#endif  // RCLCPP__EXTERN_TEMPLATES_HPP_
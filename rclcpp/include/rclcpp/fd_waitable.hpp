@@ -0,0 +1,122 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__FD_WAITABLE_HPP_
+#define RCLCPP__FD_WAITABLE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "rcl/guard_condition.h"
+#include "rcl/wait.h"
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/contexts/default_context.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+
+/// Waitable executing a callback when a file descriptor, e.g. a socket, is readable.
+/**
+ * The callback is executed by the executor, in the callback group the waitable was added to,
+ * so the data read from the file descriptor is handled like the messages of the subscriptions
+ * of the group, without a thread and a queue to hand it over:
+ *
+ * \code
+ * auto waitable = std::make_shared<rclcpp::FdWaitable>(socket_fd, [](int fd) {...});
+ * node->get_node_waitables_interface()->add_waitable(waitable, group);
+ * \endcode
+ *
+ * rcl_wait() only waits on the entities of the middleware, so the file descriptors of all the
+ * waitables are polled by a single thread of the process, which triggers the guard condition of
+ * a waitable when its file descriptor becomes readable.
+ * The file descriptor isn't polled again until the callback returned: if the callback doesn't
+ * read all the data available, it is called again.
+ *
+ * The file descriptor isn't owned by the waitable, it must stay open until the waitable is
+ * destroyed.
+ * Not supported on Windows.
+ */
+class FdWaitable : public rclcpp::Waitable
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(FdWaitable)
+
+  /// Called by the executor with the file descriptor when it is readable.
+  using Callback = std::function<void (int fd)>;
+
+  /// Start polling a file descriptor.
+  /**
+   * \param[in] fd The file descriptor, preferably non-blocking.
+   * \param[in] callback Called when the file descriptor is readable.
+   * \param[in] context The context of the guard condition waking up the executor.
+   * \throws std::invalid_argument if fd is negative or the callback is empty.
+   * \throws std::runtime_error if the guard condition can't be initialized, or on Windows.
+   */
+  RCLCPP_PUBLIC
+  FdWaitable(
+    int fd,
+    Callback callback,
+    rclcpp::Context::SharedPtr context =
+    rclcpp::contexts::default_context::get_global_default_context());
+
+  /// Stop polling the file descriptor, the callback isn't called after this returns.
+  RCLCPP_PUBLIC
+  virtual ~FdWaitable();
+
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_ready_guard_conditions() override;
+
+  RCLCPP_PUBLIC
+  bool
+  add_to_wait_set(rcl_wait_set_t * wait_set) override;
+
+  RCLCPP_PUBLIC
+  bool
+  is_ready(rcl_wait_set_t * wait_set) override;
+
+  /// Call the callback, then poll the file descriptor again.
+  RCLCPP_PUBLIC
+  void
+  execute() override;
+
+  RCLCPP_PUBLIC
+  int
+  get_fd() const;
+
+private:
+  RCLCPP_DISABLE_COPY(FdWaitable)
+
+  /// Called by the polling thread when the file descriptor is readable.
+  void
+  notify_readable();
+
+  int fd_;
+  Callback callback_;
+  /// Key of the file descriptor in the polling thread.
+  uint64_t watch_id_;
+  std::atomic<bool> readable_{false};
+  rcl_guard_condition_t gc_ = rcl_get_zero_initialized_guard_condition();
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__FD_WAITABLE_HPP_
@@ -0,0 +1,62 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__FUTURE_WAITER_HPP_
+#define RCLCPP__FUTURE_WAITER_HPP_
+
+#include "rcl/guard_condition.h"
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executor
+{
+
+/// Registers a guard condition to be triggered by notify_future_waiters() while it exists.
+/**
+ * Executors create one with their interrupt guard condition in spin_until_future_complete(), so
+ * that they wake up as soon as a future is completed instead of when other work arrives.
+ */
+class FutureWaiter
+{
+public:
+  RCLCPP_PUBLIC
+  explicit FutureWaiter(rcl_guard_condition_t * guard_condition);
+
+  RCLCPP_PUBLIC
+  ~FutureWaiter();
+
+private:
+  RCLCPP_DISABLE_COPY(FutureWaiter)
+
+  rcl_guard_condition_t * guard_condition_;
+};
+
+/// Wake up the executors which are in spin_until_future_complete().
+/**
+ * Called by rclcpp::Client after completing the future of a request.
+ * Call it after completing a promise from another thread, and the executor waiting for the
+ * future will check it right away.
+ * It only checks an atomic counter when no executor is waiting for a future.
+ */
+RCLCPP_PUBLIC
+void
+notify_future_waiters();
+
+}  // namespace executor
+}  // namespace rclcpp
+
+#endif  // RCLCPP__FUTURE_WAITER_HPP_
@@ -0,0 +1,97 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__GENERIC_PUBLISHER_HPP_
+#define RCLCPP__GENERIC_PUBLISHER_HPP_
+
+#include <memory>
+#include <string>
+
+#include "rcl/types.h"
+#include "rcpputils/shared_library.hpp"
+#include "rosidl_runtime_c/message_type_support_struct.h"
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/publisher_base.hpp"
+#include "rclcpp/publisher_options.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// A publisher of serialized messages of a type only known at runtime.
+/**
+ * The type support of the messages is loaded from the name of their type, see
+ * rclcpp::create_generic_publisher().
+ * The messages are given as is to the middleware, the intra-process communication and the
+ * asynchronous publishing options aren't used by this publisher.
+ */
+class GenericPublisher : public rclcpp::PublisherBase
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(GenericPublisher)
+
+  /// Constructor.
+  /**
+   * In general, it is recommended to use rclcpp::create_generic_publisher() instead.
+   *
+   * \param[in] node_base NodeBaseInterface pointer used in parts of the setup.
+   * \param[in] typesupport_library the library the type support was taken from.
+   * \param[in] type_support the type support of the messages of the topic.
+   * \param[in] topic_name Name of the topic to publish to.
+   * \param[in] qos QoS profile of the publisher.
+   * \param[in] options options of the publisher.
+   */
+  RCLCPP_PUBLIC
+  GenericPublisher(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    std::shared_ptr<rcpputils::SharedLibrary> typesupport_library,
+    const rosidl_message_type_support_t & type_support,
+    const std::string & topic_name,
+    const rclcpp::QoS & qos,
+    const rclcpp::PublisherOptions & options);
+
+  RCLCPP_PUBLIC
+  virtual ~GenericPublisher() = default;
+
+  /// Publish a serialized message.
+  /**
+   * \param[in] message serialized message of the type of the publisher.
+   * \throws rclcpp::exceptions::RCLError if the message couldn't be published.
+   */
+  RCLCPP_PUBLIC
+  void
+  publish(const rcl_serialized_message_t & message);
+
+  /// Publish a serialized message, see the overload above.
+  RCLCPP_PUBLIC
+  void
+  publish(const rclcpp::SerializedMessage & message);
+
+  RCLCPP_PUBLIC
+  rclcpp::MemoryUsage
+  get_memory_usage() const override;
+
+private:
+  // Keeps the type support loaded while the publisher exists.
+  std::shared_ptr<rcpputils::SharedLibrary> typesupport_library_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__GENERIC_PUBLISHER_HPP_
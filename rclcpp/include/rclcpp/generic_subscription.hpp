@@ -0,0 +1,124 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__GENERIC_SUBSCRIPTION_HPP_
+#define RCLCPP__GENERIC_SUBSCRIPTION_HPP_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "rcl/types.h"
+#include "rcpputils/shared_library.hpp"
+#include "rosidl_runtime_c/message_type_support_struct.h"
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/strategies/serialized_message_pool_memory_strategy.hpp"
+#include "rclcpp/subscription_base.hpp"
+#include "rclcpp/subscription_options.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// A subscription to the serialized messages of a type only known at runtime.
+/**
+ * The type support of the messages is loaded from the name of their type, see
+ * rclcpp::create_generic_subscription().
+ * The messages are taken serialized from the middleware into buffers reused across takes,
+ * see rclcpp::strategies::serialized_message_pool_memory_strategy, and given as is to the
+ * callback.
+ * A message kept by the callback holds its buffer until it is released.
+ * The intra-process communication options aren't used by this subscription.
+ */
+class GenericSubscription : public rclcpp::SubscriptionBase
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(GenericSubscription)
+
+  using CallbackType = std::function<void (std::shared_ptr<const rcl_serialized_message_t>)>;
+
+  /// Constructor.
+  /**
+   * In general, it is recommended to use rclcpp::create_generic_subscription() instead.
+   *
+   * \param[in] node_base NodeBaseInterface pointer used in parts of the setup.
+   * \param[in] typesupport_library the library the type support was taken from.
+   * \param[in] type_support the type support of the messages of the topic.
+   * \param[in] topic_name Name of the topic to subscribe to.
+   * \param[in] qos QoS profile of the subscription.
+   * \param[in] callback called with each serialized message taken.
+   * \param[in] options options of the subscription.
+   */
+  RCLCPP_PUBLIC
+  GenericSubscription(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    std::shared_ptr<rcpputils::SharedLibrary> typesupport_library,
+    const rosidl_message_type_support_t & type_support,
+    const std::string & topic_name,
+    const rclcpp::QoS & qos,
+    CallbackType callback,
+    const rclcpp::SubscriptionOptions & options);
+
+  RCLCPP_PUBLIC
+  virtual ~GenericSubscription() = default;
+
+  /// Not supported, the messages of a generic subscription are only taken serialized.
+  /** \throws std::runtime_error always. */
+  RCLCPP_PUBLIC
+  std::shared_ptr<void>
+  create_message() override;
+
+  RCLCPP_PUBLIC
+  std::shared_ptr<rcl_serialized_message_t>
+  create_serialized_message() override;
+
+  RCLCPP_PUBLIC
+  void
+  handle_message(std::shared_ptr<void> & message, const rmw_message_info_t & message_info) override;
+
+  /// Not supported, the messages of a generic subscription are only taken serialized.
+  /** \throws std::runtime_error always. */
+  RCLCPP_PUBLIC
+  void
+  handle_loaned_message(void * loaned_message, const rmw_message_info_t & message_info) override;
+
+  RCLCPP_PUBLIC
+  void
+  return_message(std::shared_ptr<void> & message) override;
+
+  RCLCPP_PUBLIC
+  void
+  return_serialized_message(std::shared_ptr<rcl_serialized_message_t> & message) override;
+
+  RCLCPP_PUBLIC
+  rclcpp::MemoryUsage
+  get_memory_usage() const override;
+
+private:
+  using MessageMemoryStrategy = rclcpp::strategies::serialized_message_pool_memory_strategy::
+    SerializedMessagePoolMemoryStrategy<rcl_serialized_message_t>;
+
+  CallbackType callback_;
+  // Keeps the type support loaded while the subscription exists.
+  std::shared_ptr<rcpputils::SharedLibrary> typesupport_library_;
+  MessageMemoryStrategy::SharedPtr message_memory_strategy_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__GENERIC_SUBSCRIPTION_HPP_
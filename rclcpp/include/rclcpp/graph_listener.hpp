@@ -16,6 +16,7 @@
 #define RCLCPP__GRAPH_LISTENER_HPP_
 
 #include <atomic>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <thread>
@@ -146,6 +147,16 @@ public:
   bool
   is_shutdown();
 
+  /// Return the number of graph changes notified to the nodes so far.
+  /**
+   * It is incremented before the nodes are notified, so a result of a graph
+   * query made after reading it is outdated once it changes.
+   * Only the changes seen by the nodes with graph users are counted.
+   */
+  RCLCPP_PUBLIC
+  uint64_t
+  get_graph_change_count() const;
+
 protected:
   /// Main function for the listening thread.
   RCLCPP_PUBLIC
@@ -165,19 +176,30 @@ private:
   void
   __shutdown(bool);
 
+  /// Get the graph guard conditions of the nodes, called with node_graph_interfaces_mutex_.
+  void
+  update_graph_guard_conditions();
+
   rclcpp::Context::WeakPtr parent_context_;
 
   std::thread listener_thread_;
   bool is_started_;
   std::atomic_bool is_shutdown_;
+  std::atomic<uint64_t> graph_change_count_{0};
   mutable std::mutex shutdown_mutex_;
 
   mutable std::mutex node_graph_interfaces_barrier_mutex_;
   mutable std::mutex node_graph_interfaces_mutex_;
   std::vector<rclcpp::node_interfaces::NodeGraphInterface *> node_graph_interfaces_;
-
+  /// Graph guard conditions of node_graph_interfaces_, in the same order.
+  std::vector<const rcl_guard_condition_t *> graph_guard_conditions_;
+  /// Index of each graph guard condition in the wait set, 0 if the node isn't watched.
+  std::vector<size_t> graph_gc_indexes_;
+  /// Whether nodes were added or removed since graph_guard_conditions_ was updated.
+  bool graph_guard_conditions_need_update_ = true;
+
+  /// Wakes up the listener thread, triggered by the parent context on shutdown too.
   rcl_guard_condition_t interrupt_guard_condition_ = rcl_get_zero_initialized_guard_condition();
-  rcl_guard_condition_t * shutdown_guard_condition_;
   rcl_wait_set_t wait_set_ = rcl_get_zero_initialized_wait_set();
 };
 
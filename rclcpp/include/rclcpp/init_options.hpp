@@ -18,6 +18,8 @@
 #include <memory>
 
 #include "rcl/init_options.h"
+#include "rclcpp/entity_capacities.hpp"
+#include "rclcpp/realtime_options.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
@@ -30,6 +32,23 @@ public:
   /// If true, the context will be shutdown on SIGINT by the signal handler (if it was installed).
   bool shutdown_on_sigint = true;
 
+  /// If true, the nodes of the context share one rcl node, and so one middleware participant.
+  /**
+   * The middleware creates a participant, with its discovery traffic, threads and memory, for
+   * each rcl node.
+   * With this option the nodes are created on a hidden rcl node of the context instead, and
+   * keep their name, namespace, remapping and parameters in rclcpp, see
+   * NodeBaseInterface::shares_rcl_node().
+   * The middleware graph then only shows the hidden node, and the logs of the nodes are not
+   * published to /rosout.
+   * Lifecycle nodes, whose services are created by rcl, are not supported.
+   */
+  bool share_participant = false;
+  /// Preparation of the memory of the process, done by rclcpp::activate_realtime().
+  RealtimeOptions realtime;
+  /// Entities of a static system, the context and its executors are sized for them.
+  EntityCapacities entity_capacities;
+
   /// Constructor which allows you to specify the allocator used within the init options.
   RCLCPP_PUBLIC
   explicit InitOptions(rcl_allocator_t allocator = rcl_get_default_allocator());
@@ -23,6 +23,11 @@ namespace rclcpp
 enum class IntraProcessBufferType
 {
   /// Set the data type used in the intra-process buffer as std::shared_ptr<MessageT>
+  /**
+   * With a callback taking a std::unique_ptr<MessageT>, the message is copied when the
+   * subscription takes it instead of when it is published, and it is not copied for the
+   * other subscriptions.
+   */
   SharedPtr,
   /// Set the data type used in the intra-process buffer as std::unique_ptr<MessageT>
   UniquePtr,
@@ -30,6 +35,40 @@ enum class IntraProcessBufferType
   CallbackDefault
 };
 
+/// Used in SubscriptionOptions to choose the implementation of the intra-process buffer
+enum class IntraProcessBufferImplementation
+{
+  /// Ring buffer protected by a mutex, for any number of publishing threads
+  RingBuffer,
+  /// Lock-free ring buffer, for topics published by a single thread at a time
+  SpscRingBuffer,
+  /// Lock-free ring buffer, for topics published by several threads
+  MpscRingBuffer,
+  /// Lock-free single slot, keeping only the latest message whatever the depth of the QoS
+  LatestValue,
+  /// Buffer protected by a mutex growing by segments as needed, up to the depth of the QoS
+  /**
+   * The buffer is unbounded with a KEEP_ALL history, which also selects it instead of
+   * RingBuffer.
+   */
+  SegmentedBuffer
+};
+
+/// Used in SubscriptionOptions to choose what happens when the intra-process buffer is full
+enum class IntraProcessBufferOverflowPolicy
+{
+  /// Drop the oldest message, like a KEEP_LAST history
+  DropOldest,
+  /// Block the publishing thread until the subscription takes a message, up to a timeout
+  /**
+   * The publisher is slowed down to the pace of the subscription instead of losing messages.
+   * Once the timeout expires, the oldest message is dropped.
+   * The subscription must be executed by another thread than the publishing one, otherwise
+   * each publish to a full buffer waits for the whole timeout.
+   */
+  Block
+};
+
 }  // namespace rclcpp
 
 #endif  // RCLCPP__INTRA_PROCESS_BUFFER_TYPE_HPP_
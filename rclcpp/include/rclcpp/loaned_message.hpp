@@ -19,6 +19,7 @@
 #include <utility>
 
 #include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/detail/loaned_message_pool.hpp"
 #include "rclcpp/logging.hpp"
 #include "rclcpp/publisher_base.hpp"
 
@@ -107,12 +108,47 @@ public:
   : LoanedMessage(*pub, *allocator)
   {}
 
+  /// Constructor of the LoanedMessage class, recycling the messages if the middleware can't loan.
+  /**
+   * Like the other constructors, but when the middleware can not loan messages the message
+   * is taken from the pool, and given back to it by the destructor, so that borrowing a
+   * message doesn't allocate in steady state.
+   *
+   * \param pub rclcpp::Publisher instance to which the memory belongs
+   * \param message_pool Pool of the messages in case middleware can not allocate messages
+   */
+  LoanedMessage(
+    const rclcpp::PublisherBase & pub,
+    std::shared_ptr<detail::LoanedMessagePool<MessageT, AllocatorT>> message_pool)
+  : pub_(pub),
+    message_(nullptr),
+    message_allocator_(message_pool->get_allocator()),
+    message_pool_(std::move(message_pool))
+  {
+    if (pub_.can_loan_messages()) {
+      void * message_ptr = nullptr;
+      auto ret = rcl_borrow_loaned_message(
+        pub_.get_publisher_handle(),
+        rosidl_typesupport_cpp::get_message_type_support_handle<MessageT>(),
+        &message_ptr);
+      if (RCL_RET_OK != ret) {
+        rclcpp::exceptions::throw_from_rcl_error(ret);
+      }
+      message_ = static_cast<MessageT *>(message_ptr);
+    } else {
+      message_ = message_pool_->acquire();
+    }
+  }
+
   /// Move semantic for RVO
-  LoanedMessage(LoanedMessage<MessageT> && other)
+  LoanedMessage(LoanedMessage<MessageT, AllocatorT> && other)
   : pub_(std::move(other.pub_)),
     message_(std::move(other.message_)),
-    message_allocator_(std::move(other.message_allocator_))
-  {}
+    message_allocator_(std::move(other.message_allocator_)),
+    message_pool_(std::move(other.message_pool_))
+  {
+    other.message_ = nullptr;
+  }
 
   /// Destructor of the LoanedMessage class.
   /**
@@ -143,6 +179,8 @@ public:
           error_logger, "rcl_deallocate_loaned_message failed: %s", rcl_get_error_string().str);
         rcl_reset_error();
       }
+    } else if (message_pool_) {
+      message_pool_->release(message_);
     } else {
       // call destructor before deallocating
       message_->~MessageT();
@@ -198,6 +236,9 @@ protected:
 
   MessageAllocator message_allocator_;
 
+  /// Pool recycling the message if the middleware can't loan, null if none.
+  std::shared_ptr<detail::LoanedMessagePool<MessageT, AllocatorT>> message_pool_;
+
   /// Deleted copy constructor to preserve memory integrity.
   LoanedMessage(const LoanedMessage<MessageT> & other) = delete;
 };
@@ -15,12 +15,15 @@
 #ifndef RCLCPP__LOGGER_HPP_
 #define RCLCPP__LOGGER_HPP_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 
 #include "rclcpp/visibility_control.hpp"
 
 #include "rcl/node.h"
+#include "rcutils/logging.h"
 
 /**
  * \def RCLCPP_LOGGING_ENABLED
@@ -36,6 +39,19 @@
 #define RCLCPP_LOGGING_ENABLED 1
 #endif
 
+/**
+ * \def RCLCPP_LOGGING_CACHE_LEVELS
+ * When this define evaluates to true, the logging macros check the severity against the
+ * effective level cached in the logger, instead of looking it up in rcutils for each call.
+ * The cached levels are only updated when the levels are changed through
+ * `rclcpp::Logger::set_level()`, or after a call to `rclcpp::invalidate_logger_levels()`.
+ * Levels set directly with rcutils must be followed by `rclcpp::invalidate_logger_levels()`.
+ * False by default.
+ */
+#ifndef RCLCPP_LOGGING_CACHE_LEVELS
+#define RCLCPP_LOGGING_CACHE_LEVELS 0
+#endif
+
 namespace rclcpp
 {
 
@@ -47,6 +63,26 @@ class NodeLogging;
 
 class Logger;
 
+namespace detail
+{
+
+/// Name of a logger and its effective level, shared by the copies of the logger.
+struct LoggerState
+{
+  explicit LoggerState(const std::string & name)
+  : name(name), level_epoch(0), effective_level(RCUTILS_LOG_SEVERITY_UNSET) {}
+
+  const std::string name;
+  /// Value of g_logger_level_epoch when effective_level was looked up.
+  mutable std::atomic<uint64_t> level_epoch;
+  mutable std::atomic<int> effective_level;
+};
+
+/// Incremented when the logger levels change, which makes the cached effective levels stale.
+extern RCLCPP_PUBLIC std::atomic<uint64_t> g_logger_level_epoch;
+
+}  // namespace detail
+
 /// Return a named logger.
 /**
  * The returned logger's name will include any naming conventions, such as a
@@ -74,6 +110,15 @@ RCLCPP_PUBLIC
 Logger
 get_node_logger(const rcl_node_t * node);
 
+/// Make the effective levels cached by the loggers stale.
+/**
+ * To be called after changing logger levels directly with rcutils, when
+ * `RCLCPP_LOGGING_CACHE_LEVELS` is enabled.
+ */
+RCLCPP_PUBLIC
+void
+invalidate_logger_levels();
+
 class Logger
 {
 private:
@@ -86,21 +131,37 @@ private:
    * This cannot be called directly, see `rclcpp::get_logger` instead.
    */
   Logger()
-  : name_(nullptr) {}
+  : state_(nullptr) {}
 
   /// Constructor of a named logger.
   /**
    * This cannot be called directly, see `rclcpp::get_logger` instead.
    */
   explicit Logger(const std::string & name)
-  : name_(new std::string(name)) {}
+  : state_(std::make_shared<const detail::LoggerState>(name)) {}
 
-  std::shared_ptr<const std::string> name_;
+  /// Look up the effective level of the logger in rcutils and cache it.
+  RCLCPP_PUBLIC
+  void
+  update_effective_level(uint64_t epoch) const;
+
+  std::shared_ptr<const detail::LoggerState> state_;
 
 public:
   RCLCPP_PUBLIC
   Logger(const Logger &) = default;
 
+  /// Severity levels of a logger, matching the rcutils severities.
+  enum class Level
+  {
+    Unset = RCUTILS_LOG_SEVERITY_UNSET,
+    Debug = RCUTILS_LOG_SEVERITY_DEBUG,
+    Info = RCUTILS_LOG_SEVERITY_INFO,
+    Warn = RCUTILS_LOG_SEVERITY_WARN,
+    Error = RCUTILS_LOG_SEVERITY_ERROR,
+    Fatal = RCUTILS_LOG_SEVERITY_FATAL,
+  };
+
   /// Get the name of this logger.
   /**
    * \return the full name of the logger including any prefixes, or
@@ -111,10 +172,40 @@ public:
   const char *
   get_name() const
   {
-    if (!name_) {
+    if (!state_) {
       return nullptr;
     }
-    return name_->c_str();
+    return state_->name.c_str();
+  }
+
+  /// Set the level of this logger, and make the cached effective levels stale.
+  /**
+   * \param[in] level the level of the logger, Unset to inherit the level of its ancestors.
+   * \throws rclcpp::exceptions::RCLError if the level can't be set.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_level(Level level);
+
+  /// Return true if a message of the given severity would be logged.
+  /**
+   * The effective level is looked up in rcutils once, and then cached until the logger levels
+   * change, see `RCLCPP_LOGGING_CACHE_LEVELS`.
+   * Invalid loggers are always enabled, rcutils then decides what to do with their messages.
+   *
+   * \param[in] severity an rcutils severity, e.g. RCUTILS_LOG_SEVERITY_DEBUG.
+   */
+  bool
+  is_enabled_for(int severity) const
+  {
+    if (!state_) {
+      return true;
+    }
+    uint64_t epoch = detail::g_logger_level_epoch.load(std::memory_order_acquire);
+    if (state_->level_epoch.load(std::memory_order_acquire) != epoch) {
+      update_effective_level(epoch);
+    }
+    return severity >= state_->effective_level.load(std::memory_order_relaxed);
   }
 
   /// Return a logger that is a descendant of this logger.
@@ -133,10 +224,10 @@ public:
   Logger
   get_child(const std::string & suffix)
   {
-    if (!name_) {
+    if (!state_) {
       return Logger();
     }
-    return Logger(*name_ + "." + suffix);
+    return Logger(state_->name + "." + suffix);
   }
 };
 
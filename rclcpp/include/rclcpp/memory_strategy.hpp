@@ -22,13 +22,20 @@
 #include "rcl/wait.h"
 
 #include "rclcpp/any_executable.hpp"
+#include "rclcpp/entity_capacities.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/timer_manager.hpp"
 #include "rclcpp/visibility_control.hpp"
 #include "rclcpp/waitable.hpp"
 
 namespace rclcpp
 {
+namespace executor
+{
+class Executor;
+}  // namespace executor
+
 namespace memory_strategy
 {
 
@@ -93,6 +100,16 @@ public:
   virtual rcl_allocator_t
   get_allocator() = 0;
 
+  /// Size the storage of the handles for a static system, called by the executor.
+  /**
+   * The default does nothing.
+   */
+  virtual void
+  reserve(const EntityCapacities & capacities)
+  {
+    (void)capacities;
+  }
+
   static rclcpp::SubscriptionBase::SharedPtr
   get_subscription_by_handle(
     std::shared_ptr<const rcl_subscription_t> subscriber_handle,
@@ -142,6 +159,27 @@ public:
   get_group_by_waitable(
     rclcpp::Waitable::SharedPtr waitable,
     const WeakNodeList & weak_nodes);
+
+  /// Set the manager scheduling the steady timers instead of the wait set, nullptr for none.
+  /**
+   * collect_entities() gives the timers it finds to TimerManager::manage(), and only waits on
+   * the ones which are not managed.
+   * A memory strategy which ignores the manager waits on all the timers, as without it.
+   */
+  void
+  set_timer_manager(rclcpp::executor::TimerManager::SharedPtr timer_manager);
+
+  /// Set the executor using the strategy, called by the executor.
+  /**
+   * collect_entities() doesn't wait on the callback groups assigned to another executor, see
+   * CallbackGroup::assign_to_executor().
+   */
+  void
+  set_executor(const rclcpp::executor::Executor * executor);
+
+protected:
+  rclcpp::executor::TimerManager::SharedPtr timer_manager_;
+  const rclcpp::executor::Executor * executor_ = nullptr;
 };
 
 }  // namespace memory_strategy
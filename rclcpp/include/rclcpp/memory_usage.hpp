@@ -0,0 +1,96 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__MEMORY_USAGE_HPP_
+#define RCLCPP__MEMORY_USAGE_HPP_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Bytes used by an entity, broken down by what uses them.
+/**
+ * The sizes are those of the memory owned by rclcpp: the memory of the middleware handles,
+ * and the dynamic memory owned by the messages themselves, e.g. their strings and sequences,
+ * aren't counted.
+ */
+struct MemoryUsage
+{
+  /// Bytes of the entity object itself.
+  size_t entity_bytes = 0;
+  /// Bytes of the slots of the intra-process buffer of a subscription.
+  size_t intra_process_buffer_bytes = 0;
+  /// Bytes of the messages kept by the message memory strategy of a subscription.
+  size_t message_pool_bytes = 0;
+  /// Bytes of the table of the pending requests of a client.
+  size_t pending_request_bytes = 0;
+
+  /// Return the sum of all the bytes.
+  RCLCPP_PUBLIC
+  size_t
+  total_bytes() const;
+
+  RCLCPP_PUBLIC
+  MemoryUsage &
+  operator+=(const MemoryUsage & other);
+};
+
+/// Kind of entity reported in a rclcpp::NodeMemoryUsage.
+enum class MemoryUsageEntityKind
+{
+  Publisher,
+  Subscription,
+  Service,
+  Client
+};
+
+/// Bytes used by an entity of a node.
+struct EntityMemoryUsage
+{
+  MemoryUsageEntityKind kind;
+  /// Topic name of a publisher or a subscription, service name of a service or a client.
+  std::string name;
+  MemoryUsage usage;
+};
+
+/// Bytes used by the entities of a node, see NodeBaseInterface::get_memory_usage().
+struct NodeMemoryUsage
+{
+  std::vector<EntityMemoryUsage> entities;
+
+  /// Return the sum of the usage of all the entities.
+  RCLCPP_PUBLIC
+  MemoryUsage
+  total() const;
+};
+
+/// Return the name of an entity kind, e.g. "subscription".
+RCLCPP_PUBLIC
+const char *
+to_string(MemoryUsageEntityKind kind);
+
+/// Return a human readable report of the memory usage of a node, one line per entity.
+RCLCPP_PUBLIC
+std::string
+to_string(const NodeMemoryUsage & node_memory_usage);
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__MEMORY_USAGE_HPP_
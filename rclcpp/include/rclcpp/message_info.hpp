@@ -0,0 +1,94 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__MESSAGE_INFO_HPP_
+#define RCLCPP__MESSAGE_INFO_HPP_
+
+#include <chrono>
+
+#include "rcutils/time.h"
+#include "rmw/types.h"
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Information about a received message, with its source and receive timestamps.
+/**
+ * The timestamps are nanoseconds since the epoch of the system clock, 0 if unknown.
+ * They are copied from the rmw_message_info_t when the middleware provides them, otherwise
+ * the receive timestamp is taken when the message info is created, after the message was
+ * taken, and the source timestamp is unknown.
+ *
+ * A message info converts to the rmw_message_info_t it wraps, so the subscription callbacks
+ * may take either a `const rclcpp::MessageInfo &` or a `const rmw_message_info_t &`.
+ */
+class MessageInfo
+{
+public:
+  /// Construct an empty message info, with unknown timestamps.
+  RCLCPP_PUBLIC
+  MessageInfo();
+
+  /// Wrap the info of a message which was just taken.
+  /**
+   * Not explicit, so that the info given by the middleware can be passed where a message info
+   * is expected.
+   */
+  RCLCPP_PUBLIC
+  MessageInfo(const rmw_message_info_t & rmw_message_info);  // NOLINT(runtime/explicit)
+
+  /// Wrap the info of a message received at the given time.
+  RCLCPP_PUBLIC
+  MessageInfo(
+    const rmw_message_info_t & rmw_message_info,
+    rcutils_time_point_value_t received_timestamp);
+
+  RCLCPP_PUBLIC
+  const rmw_message_info_t &
+  get_rmw_message_info() const;
+
+  RCLCPP_PUBLIC
+  operator const rmw_message_info_t &() const;
+
+  /// Return the time at which the message was published, 0 if unknown.
+  RCLCPP_PUBLIC
+  rcutils_time_point_value_t
+  get_source_timestamp() const;
+
+  /// Set the time at which the message was published, e.g. from the stamp of its header.
+  RCLCPP_PUBLIC
+  void
+  set_source_timestamp(rcutils_time_point_value_t source_timestamp);
+
+  /// Return the time at which the message was received, 0 if unknown.
+  RCLCPP_PUBLIC
+  rcutils_time_point_value_t
+  get_received_timestamp() const;
+
+  /// Return the time between the publication and the reception, negative if unknown.
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  get_transport_latency() const;
+
+private:
+  rmw_message_info_t rmw_message_info_;
+  rcutils_time_point_value_t source_timestamp_;
+  rcutils_time_point_value_t received_timestamp_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__MESSAGE_INFO_HPP_
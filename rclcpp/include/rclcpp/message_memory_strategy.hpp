@@ -16,13 +16,16 @@
 #define RCLCPP__MESSAGE_MEMORY_STRATEGY_HPP_
 
 #include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <type_traits>
 
 #include "rcl/types.h"
 
 #include "rclcpp/allocator/allocator_common.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/message_take_traits.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 #include "rcutils/logging_macros.h"
@@ -35,7 +38,15 @@ namespace message_memory_strategy
 {
 
 /// Default allocation strategy for messages received by subscriptions.
-/** A message memory strategy must be templated on the type of the subscription it belongs to. */
+/**
+ * A message memory strategy must be templated on the type of the subscription it belongs to.
+ *
+ * Plain old data messages, see rclcpp::message_take_traits::is_plain_old_data_message, take the
+ * specialized take path: the last returned message is reused by the next take once no one else
+ * references it, so a subscription whose callback doesn't keep the messages neither allocates
+ * nor constructs a message for each take.
+ * Other messages are allocated for each take.
+ */
 template<typename MessageT, typename Alloc = std::allocator<void>>
 class MessageMemoryStrategy
 {
@@ -79,11 +90,11 @@ public:
     return std::make_shared<MessageMemoryStrategy<MessageT, Alloc>>(std::make_shared<Alloc>());
   }
 
-  /// By default, dynamically allocate a new message.
+  /// By default, dynamically allocate a new message, or reuse a plain old data message.
   /** \return Shared pointer to the new message. */
   virtual std::shared_ptr<MessageT> borrow_message()
   {
-    return std::allocate_shared<MessageT, MessageAlloc>(*message_allocator_.get());
+    return borrow_message_impl(message_take_traits::is_plain_old_data_message<MessageT>());
   }
 
   virtual std::shared_ptr<rcl_serialized_message_t> borrow_serialized_message(size_t capacity)
@@ -124,7 +135,7 @@ public:
   /** \param[in] msg Shared pointer to the message we are returning. */
   virtual void return_message(std::shared_ptr<MessageT> & msg)
   {
-    msg.reset();
+    return_message_impl(msg, message_take_traits::is_plain_old_data_message<MessageT>());
   }
 
   virtual void return_serialized_message(std::shared_ptr<rcl_serialized_message_t> & serialized_msg)
@@ -132,6 +143,13 @@ public:
     serialized_msg.reset();
   }
 
+  /// Return the bytes of the messages kept by the strategy for reuse.
+  virtual size_t get_memory_usage() const
+  {
+    std::lock_guard<std::mutex> lock(reusable_message_mutex_);
+    return reusable_message_ ? sizeof(MessageT) : 0u;
+  }
+
   std::shared_ptr<MessageAlloc> message_allocator_;
   MessageDeleter message_deleter_;
 
@@ -143,6 +161,47 @@ public:
   size_t default_buffer_capacity_ = 0;
 
   rcutils_allocator_t rcutils_allocator_;
+
+private:
+  std::shared_ptr<MessageT>
+  borrow_message_impl(std::false_type)
+  {
+    return std::allocate_shared<MessageT, MessageAlloc>(*message_allocator_.get());
+  }
+
+  std::shared_ptr<MessageT>
+  borrow_message_impl(std::true_type)
+  {
+    {
+      std::lock_guard<std::mutex> lock(reusable_message_mutex_);
+      if (reusable_message_ && reusable_message_.use_count() == 1) {
+        // The middleware overwrites the whole message, it doesn't need to be reset.
+        return std::move(reusable_message_);
+      }
+    }
+    return borrow_message_impl(std::false_type());
+  }
+
+  void
+  return_message_impl(std::shared_ptr<MessageT> & msg, std::false_type)
+  {
+    msg.reset();
+  }
+
+  void
+  return_message_impl(std::shared_ptr<MessageT> & msg, std::true_type)
+  {
+    std::lock_guard<std::mutex> lock(reusable_message_mutex_);
+    if (!reusable_message_ || reusable_message_.use_count() > 1) {
+      // Keep the message just returned when the one kept before is still used elsewhere.
+      reusable_message_ = std::move(msg);
+    }
+    msg.reset();
+  }
+
+  /// Message returned by the last take, reused when it is a plain old data message.
+  std::shared_ptr<MessageT> reusable_message_;
+  mutable std::mutex reusable_message_mutex_;
 };
 
 }  // namespace message_memory_strategy
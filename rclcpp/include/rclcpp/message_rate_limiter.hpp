@@ -0,0 +1,109 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__MESSAGE_RATE_LIMITER_HPP_
+#define RCLCPP__MESSAGE_RATE_LIMITER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "rclcpp/macros.hpp"
+
+namespace rclcpp
+{
+
+/// Downsampling of a topic, used in PublisherOptions and SubscriptionOptions.
+/**
+ * With both a decimation and a minimum separation, a message is kept if it is one of the
+ * messages kept by the decimation, and it is far enough from the last message kept.
+ */
+struct MessageRateLimitOptions
+{
+  /// Keep one message out of `decimation`, starting with the first one, 0 and 1 keep them all.
+  size_t decimation = 1;
+
+  /// Minimum time between two kept messages, measured with the steady clock, 0 for no minimum.
+  std::chrono::nanoseconds min_separation {0};
+
+  /// Return true if some messages may be dropped.
+  bool
+  is_enabled() const
+  {
+    return decimation > 1 || min_separation > std::chrono::nanoseconds::zero();
+  }
+};
+
+/// Decide which messages to keep according to MessageRateLimitOptions.
+/**
+ * It only uses atomic operations, so messages can be given from several threads.
+ */
+class MessageRateLimiter
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(MessageRateLimiter)
+
+  explicit MessageRateLimiter(const MessageRateLimitOptions & options)
+  : decimation_(options.decimation > 1 ? options.decimation : 1),
+    min_separation_ns_(options.min_separation.count()),
+    message_count_(0),
+    last_kept_ns_(never),
+    dropped_count_(0)
+  {}
+
+  /// Return true if the next message is kept, false if it should be dropped.
+  bool
+  accept()
+  {
+    if (decimation_ > 1 && message_count_.fetch_add(1, std::memory_order_relaxed) % decimation_) {
+      dropped_count_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    if (min_separation_ns_ > 0) {
+      int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+      int64_t last_kept = last_kept_ns_.load(std::memory_order_relaxed);
+      do {
+        if (last_kept != never && now - last_kept < min_separation_ns_) {
+          dropped_count_.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+      } while (!last_kept_ns_.compare_exchange_weak(
+          last_kept, now, std::memory_order_relaxed));
+    }
+    return true;
+  }
+
+  /// Return the number of messages dropped.
+  size_t
+  get_dropped_count() const
+  {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr int64_t never = std::numeric_limits<int64_t>::min();
+
+  const size_t decimation_;
+  const int64_t min_separation_ns_;
+  std::atomic<size_t> message_count_;
+  std::atomic<int64_t> last_kept_ns_;
+  std::atomic<size_t> dropped_count_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__MESSAGE_RATE_LIMITER_HPP_
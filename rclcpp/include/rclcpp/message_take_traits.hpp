@@ -0,0 +1,65 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__MESSAGE_TAKE_TRAITS_HPP_
+#define RCLCPP__MESSAGE_TAKE_TRAITS_HPP_
+
+#include <type_traits>
+
+#include "rosidl_generator_cpp/traits.hpp"
+
+namespace rclcpp
+{
+namespace message_take_traits
+{
+
+/// True for the message types which are plain old data.
+/**
+ * Those messages have a fixed size, according to the rosidl type traits, so they don't own
+ * any memory, and they are trivially copyable.
+ * Taking a message into a previously used instance only overwrites its memory, so it doesn't
+ * need to be reset.
+ */
+template<typename MessageT>
+struct is_plain_old_data_message
+  : std::integral_constant<bool,
+    rosidl_generator_traits::has_fixed_size<MessageT>::value &&
+    std::is_trivially_copyable<MessageT>::value &&
+    std::is_standard_layout<MessageT>::value>
+{};
+
+/// How the messages taken from the middleware are stored.
+enum class TakePath
+{
+  /// Each take deserializes into a newly allocated message.
+  Default,
+  /// Takes deserialize into a message reused once no one references it any longer.
+  PlainOldData
+};
+
+/// The take path used by the default message memory strategy of a subscription.
+/**
+ * e.g. `rclcpp::message_take_traits::take_path<sensor_msgs::msg::Imu>::value`.
+ * \sa rclcpp::message_memory_strategy::MessageMemoryStrategy.
+ */
+template<typename MessageT>
+struct take_path
+  : std::integral_constant<TakePath,
+    is_plain_old_data_message<MessageT>::value ? TakePath::PlainOldData : TakePath::Default>
+{};
+
+}  // namespace message_take_traits
+}  // namespace rclcpp
+
+#endif  // RCLCPP__MESSAGE_TAKE_TRAITS_HPP_
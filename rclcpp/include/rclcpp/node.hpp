@@ -39,6 +39,8 @@
 #include "rclcpp/clock.hpp"
 #include "rclcpp/context.hpp"
 #include "rclcpp/event.hpp"
+#include "rclcpp/generic_publisher.hpp"
+#include "rclcpp/generic_subscription.hpp"
 #include "rclcpp/logger.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/message_memory_strategy.hpp"
@@ -54,6 +56,7 @@
 #include "rclcpp/node_interfaces/node_waitables_interface.hpp"
 #include "rclcpp/node_options.hpp"
 #include "rclcpp/parameter.hpp"
+#include "rclcpp/parameter_handle.hpp"
 #include "rclcpp/publisher.hpp"
 #include "rclcpp/publisher_options.hpp"
 #include "rclcpp/qos.hpp"
@@ -198,7 +201,9 @@ public:
     typename AllocatorT = std::allocator<void>,
     typename CallbackMessageT =
     typename rclcpp::subscription_traits::has_message_type<CallbackT>::type,
-    typename SubscriptionT = rclcpp::Subscription<CallbackMessageT, AllocatorT>,
+    typename SubscriptionT = rclcpp::Subscription<
+      typename rclcpp::subscription_traits::subscribed_type<MessageT, CallbackMessageT>::type,
+      AllocatorT>,
     typename MessageMemoryStrategyT = rclcpp::message_memory_strategy::MessageMemoryStrategy<
       CallbackMessageT,
       AllocatorT
@@ -216,18 +221,60 @@ public:
     )
   );
 
+  /// Create and return a GenericPublisher.
+  /**
+   * The publisher publishes serialized messages of a type only known at runtime,
+   * see rclcpp::create_generic_publisher().
+   *
+   * \param[in] topic_name The topic for this publisher to publish on.
+   * \param[in] topic_type The name of the message type, e.g. "std_msgs/msg/String".
+   * \param[in] qos The Quality of Service settings for the publisher.
+   * \param[in] options Additional options for the creation of the publisher.
+   * \return Shared pointer to the created generic publisher.
+   */
+  RCLCPP_PUBLIC
+  std::shared_ptr<rclcpp::GenericPublisher>
+  create_generic_publisher(
+    const std::string & topic_name,
+    const std::string & topic_type,
+    const rclcpp::QoS & qos,
+    const rclcpp::PublisherOptions & options = rclcpp::PublisherOptions());
+
+  /// Create and return a GenericSubscription.
+  /**
+   * The subscription takes serialized messages of a type only known at runtime,
+   * see rclcpp::create_generic_subscription().
+   *
+   * \param[in] topic_name The topic to subscribe on.
+   * \param[in] topic_type The name of the message type, e.g. "std_msgs/msg/String".
+   * \param[in] qos QoS profile for the subscription.
+   * \param[in] callback The user-defined callback function to receive a serialized message.
+   * \param[in] options Additional options for the creation of the subscription.
+   * \return Shared pointer to the created generic subscription.
+   */
+  RCLCPP_PUBLIC
+  std::shared_ptr<rclcpp::GenericSubscription>
+  create_generic_subscription(
+    const std::string & topic_name,
+    const std::string & topic_type,
+    const rclcpp::QoS & qos,
+    rclcpp::GenericSubscription::CallbackType callback,
+    const rclcpp::SubscriptionOptions & options = rclcpp::SubscriptionOptions());
+
   /// Create a timer.
   /**
    * \param[in] period Time interval between triggers of the callback.
    * \param[in] callback User-defined callback function.
    * \param[in] group Callback group to execute this timer's callback in.
+   * \param[in] slack Tolerated lateness of the callback, see rclcpp::TimerBase::set_slack().
    */
   template<typename DurationRepT = int64_t, typename DurationT = std::milli, typename CallbackT>
   typename rclcpp::WallTimer<CallbackT>::SharedPtr
   create_wall_timer(
     std::chrono::duration<DurationRepT, DurationT> period,
     CallbackT callback,
-    rclcpp::callback_group::CallbackGroup::SharedPtr group = nullptr);
+    rclcpp::callback_group::CallbackGroup::SharedPtr group = nullptr,
+    std::chrono::nanoseconds slack = std::chrono::nanoseconds::zero());
 
   /* Create and return a Client. */
   template<typename ServiceT>
@@ -345,10 +392,13 @@ public:
    * If `ignore_overrides` is `true`, all the overrides of the parameters declared
    * by the function call will be ignored.
    *
-   * This method, if successful, will result in any callback registered with
-   * set_on_parameters_set_callback to be called, once for each parameter.
+   * The parameters are declared at once, see the non-templated
+   * declare_parameters(): any callback registered with
+   * set_on_parameters_set_callback is called once with all the parameters,
+   * and a single parameter event is published.
    * If that callback prevents the initial value for any parameter from being
-   * set then rclcpp::exceptions::InvalidParameterValueException is thrown.
+   * set then rclcpp::exceptions::InvalidParameterValueException is thrown,
+   * and none of the parameters is declared.
    *
    * \param[in] namespace_ The namespace in which to declare the parameters.
    * \param[in] parameters The parameters to set in the given namespace.
@@ -385,6 +435,69 @@ public:
     > & parameters,
     bool ignore_overrides = false);
 
+  /// Declare and initialize several parameters at once.
+  /**
+   * Like calling declare_parameter() for each parameter, except that it is
+   * atomic: all the parameters are checked first, any callback registered
+   * with set_on_parameters_set_callback is called once with all the initial
+   * values, and a single parameter event announces them.
+   * If a parameter can't be declared, none of them is.
+   *
+   * \param[in] parameters The names and default values of the parameters.
+   * \param[in] parameter_descriptors The descriptors of the parameters, in the
+   *   same order, or empty to use the default descriptors.
+   * \param[in] ignore_overrides When `true`, the parameters overrides are ignored.
+   *    Default to `false`.
+   * \return The values of the parameters, in the same order.
+   * \throws std::invalid_argument if there are descriptors, but not one for
+   *   each parameter.
+   * \throws rclcpp::exceptions::ParameterAlreadyDeclaredException if a
+   *   parameter has already been declared, or is given twice.
+   * \throws rclcpp::exceptions::InvalidParametersException if a parameter
+   *   name is invalid.
+   * \throws rclcpp::exceptions::InvalidParameterValueException if the initial
+   *   values fail to be set.
+   */
+  RCLCPP_PUBLIC
+  std::vector<rclcpp::ParameterValue>
+  declare_parameters(
+    const std::vector<rclcpp::Parameter> & parameters,
+    const std::vector<rcl_interfaces::msg::ParameterDescriptor> & parameter_descriptors =
+    std::vector<rcl_interfaces::msg::ParameterDescriptor>(),
+    bool ignore_overrides = false);
+
+  /// Declare and initialize a parameter, return a handle to read it.
+  /**
+   * See the non-templated declare_parameter() on this class for details.
+   *
+   * The handle reads the latest value without looking the parameter up, and
+   * prevents the parameter from being set to a value of another type.
+   *
+   * \sa rclcpp::ParameterHandle
+   * \throws rclcpp::ParameterTypeException if the initial value has another
+   *   type than ParameterT.
+   */
+  template<typename ParameterT>
+  typename rclcpp::ParameterHandle<ParameterT>::SharedPtr
+  declare_parameter_handle(
+    const std::string & name,
+    const ParameterT & default_value,
+    const rcl_interfaces::msg::ParameterDescriptor & parameter_descriptor =
+    rcl_interfaces::msg::ParameterDescriptor(),
+    bool ignore_override = false);
+
+  /// Return a handle to read a declared parameter.
+  /**
+   * \sa rclcpp::ParameterHandle
+   * \throws rclcpp::exceptions::ParameterNotDeclaredException if the parameter
+   *   is not declared.
+   * \throws rclcpp::ParameterTypeException if the parameter has another type
+   *   than ParameterT.
+   */
+  template<typename ParameterT>
+  typename rclcpp::ParameterHandle<ParameterT>::SharedPtr
+  get_parameter_handle(const std::string & name);
+
   /// Undeclare a previously declared parameter.
   /**
    * This method will not cause a callback registered with
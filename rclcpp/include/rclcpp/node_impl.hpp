@@ -38,6 +38,7 @@
 #include "rclcpp/create_publisher.hpp"
 #include "rclcpp/create_service.hpp"
 #include "rclcpp/create_subscription.hpp"
+#include "rclcpp/detail/make_entity_shared.hpp"
 #include "rclcpp/parameter.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/type_support_decl.hpp"
@@ -105,12 +106,15 @@ typename rclcpp::WallTimer<CallbackT>::SharedPtr
 Node::create_wall_timer(
   std::chrono::duration<DurationRepT, DurationT> period,
   CallbackT callback,
-  rclcpp::callback_group::CallbackGroup::SharedPtr group)
+  rclcpp::callback_group::CallbackGroup::SharedPtr group,
+  std::chrono::nanoseconds slack)
 {
-  auto timer = rclcpp::WallTimer<CallbackT>::make_shared(
+  auto timer = rclcpp::detail::make_entity_shared<rclcpp::WallTimer<CallbackT>>(
+    this->node_base_->get_entity_arena(),
     std::chrono::duration_cast<std::chrono::nanoseconds>(period),
     std::move(callback),
     this->node_base_->get_context());
+  timer->set_slack(slack);
   node_timers_->add_timer(timer, group);
   return timer;
 }
@@ -164,6 +168,29 @@ Node::declare_parameter(
   ).get<ParameterT>();
 }
 
+template<typename ParameterT>
+typename rclcpp::ParameterHandle<ParameterT>::SharedPtr
+Node::declare_parameter_handle(
+  const std::string & name,
+  const ParameterT & default_value,
+  const rcl_interfaces::msg::ParameterDescriptor & parameter_descriptor,
+  bool ignore_override)
+{
+  this->declare_parameter(
+    name,
+    rclcpp::ParameterValue(default_value),
+    parameter_descriptor,
+    ignore_override);
+  return this->get_parameter_handle<ParameterT>(name);
+}
+
+template<typename ParameterT>
+typename rclcpp::ParameterHandle<ParameterT>::SharedPtr
+Node::get_parameter_handle(const std::string & name)
+{
+  return std::make_shared<rclcpp::ParameterHandle<ParameterT>>(node_parameters_, name);
+}
+
 template<typename ParameterT>
 std::vector<ParameterT>
 Node::declare_parameters(
@@ -171,18 +198,20 @@ Node::declare_parameters(
   const std::map<std::string, ParameterT> & parameters,
   bool ignore_overrides)
 {
-  std::vector<ParameterT> result;
   std::string normalized_namespace = namespace_.empty() ? "" : (namespace_ + ".");
-  std::transform(
-    parameters.begin(), parameters.end(), std::back_inserter(result),
-    [this, &normalized_namespace, ignore_overrides](auto element) {
-      return this->declare_parameter(
-        normalized_namespace + element.first,
-        element.second,
-        rcl_interfaces::msg::ParameterDescriptor(),
-        ignore_overrides);
-    }
-  );
+  std::vector<rclcpp::Parameter> default_values;
+  default_values.reserve(parameters.size());
+  for (const auto & element : parameters) {
+    default_values.emplace_back(
+      normalized_namespace + element.first, rclcpp::ParameterValue(element.second));
+  }
+  auto values = this->declare_parameters(
+    default_values, std::vector<rcl_interfaces::msg::ParameterDescriptor>(), ignore_overrides);
+  std::vector<ParameterT> result;
+  result.reserve(values.size());
+  for (const auto & value : values) {
+    result.push_back(value.get<ParameterT>());
+  }
   return result;
 }
 
@@ -196,20 +225,22 @@ Node::declare_parameters(
   > & parameters,
   bool ignore_overrides)
 {
-  std::vector<ParameterT> result;
   std::string normalized_namespace = namespace_.empty() ? "" : (namespace_ + ".");
-  std::transform(
-    parameters.begin(), parameters.end(), std::back_inserter(result),
-    [this, &normalized_namespace, ignore_overrides](auto element) {
-      return static_cast<ParameterT>(
-        this->declare_parameter(
-          normalized_namespace + element.first,
-          element.second.first,
-          element.second.second,
-          ignore_overrides)
-      );
-    }
-  );
+  std::vector<rclcpp::Parameter> default_values;
+  std::vector<rcl_interfaces::msg::ParameterDescriptor> parameter_descriptors;
+  default_values.reserve(parameters.size());
+  parameter_descriptors.reserve(parameters.size());
+  for (const auto & element : parameters) {
+    default_values.emplace_back(
+      normalized_namespace + element.first, rclcpp::ParameterValue(element.second.first));
+    parameter_descriptors.push_back(element.second.second);
+  }
+  auto values = this->declare_parameters(default_values, parameter_descriptors, ignore_overrides);
+  std::vector<ParameterT> result;
+  result.reserve(values.size());
+  for (const auto & value : values) {
+    result.push_back(value.get<ParameterT>());
+  }
   return result;
 }
 
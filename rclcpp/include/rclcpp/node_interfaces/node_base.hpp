@@ -42,7 +42,10 @@ public:
     const std::string & namespace_,
     rclcpp::Context::SharedPtr context,
     const rcl_node_options_t & rcl_node_options,
-    bool use_intra_process_default);
+    bool use_intra_process_default,
+    rclcpp::allocator::Arena::SharedPtr entity_arena = nullptr,
+    rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry::SharedPtr
+    message_pools = nullptr);
 
   RCLCPP_PUBLIC
   virtual
@@ -90,6 +93,21 @@ public:
 
   RCLCPP_PUBLIC
 
+  bool
+  shares_rcl_node() const override;
+
+  RCLCPP_PUBLIC
+
+  const rcl_node_options_t *
+  get_rcl_node_options() const override;
+
+  RCLCPP_PUBLIC
+
+  std::string
+  resolve_topic_or_service_name(const std::string & name, bool is_service) const override;
+
+  RCLCPP_PUBLIC
+
   bool
   assert_liveliness() const override;
 
@@ -128,19 +146,63 @@ public:
   std::unique_lock<std::recursive_mutex>
   acquire_notify_guard_condition_lock() const override;
 
+  RCLCPP_PUBLIC
+  rcl_ret_t
+  trigger_notify_guard_condition() override;
+
+  RCLCPP_PUBLIC
+  void
+  begin_entity_creation_batch() override;
+
+  RCLCPP_PUBLIC
+  void
+  end_entity_creation_batch() override;
+
   RCLCPP_PUBLIC
 
   bool
   get_use_intra_process_default() const override;
 
+  RCLCPP_PUBLIC
+
+  const rclcpp::allocator::Arena::SharedPtr &
+  get_entity_arena() const override;
+
+  RCLCPP_PUBLIC
+  const rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry::SharedPtr &
+  get_message_pools() const override;
+
+  RCLCPP_PUBLIC
+
+  rclcpp::NodeMemoryUsage
+  get_memory_usage() const override;
+
 private:
   RCLCPP_DISABLE_COPY(NodeBase)
 
+  /// Use the rcl node of the context, keeping the name, namespace and options of this node.
+  void
+  init_shared_rcl_node(
+    const std::string & node_name,
+    const std::string & node_namespace,
+    const rcl_node_options_t & rcl_node_options);
+
   rclcpp::Context::SharedPtr context_;
   bool use_intra_process_default_;
+  rclcpp::allocator::Arena::SharedPtr entity_arena_;
+  rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry::SharedPtr
+    message_pools_;
 
   std::shared_ptr<rcl_node_t> node_handle_;
 
+  /// Set if the rcl node is shared, see shares_rcl_node().
+  bool shares_rcl_node_;
+  /// Resolved name, namespace and options of this node when the rcl node is shared.
+  std::string node_name_;
+  std::string node_namespace_;
+  std::string fully_qualified_name_;
+  rcl_node_options_t node_options_ = rcl_node_get_default_options();
+
   rclcpp::callback_group::CallbackGroup::SharedPtr default_callback_group_;
   std::vector<rclcpp::callback_group::CallbackGroup::WeakPtr> callback_groups_;
 
@@ -150,6 +212,10 @@ private:
   mutable std::recursive_mutex notify_guard_condition_mutex_;
   rcl_guard_condition_t notify_guard_condition_ = rcl_get_zero_initialized_guard_condition();
   bool notify_guard_condition_is_valid_;
+  /// Number of the entity creation batches in progress, protected by the mutex above.
+  size_t entity_creation_batch_depth_ = 0;
+  /// Set if a trigger was deferred by an entity creation batch.
+  bool notify_deferred_ = false;
 };
 
 }  // namespace node_interfaces
@@ -22,9 +22,12 @@
 
 #include "rcl/node.h"
 
+#include "rclcpp/allocator/arena_allocator.hpp"
 #include "rclcpp/callback_group.hpp"
 #include "rclcpp/context.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/memory_usage.hpp"
+#include "rclcpp/strategies/message_pool_memory_strategy.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
@@ -102,6 +105,30 @@ public:
   std::shared_ptr<const rcl_node_t>
   get_shared_rcl_node_handle() const = 0;
 
+  /// Return true if the rcl node is shared by the nodes of the context.
+  /**
+   * The rcl node then doesn't have the name, namespace and options of this node, see
+   * rclcpp::InitOptions::share_participant.
+   * The names of the entities of the node must be resolved with
+   * resolve_topic_or_service_name() before being given to rcl.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  bool
+  shares_rcl_node() const = 0;
+
+  /// Return the options of the node, even if the rcl node is shared.
+  RCLCPP_PUBLIC
+  virtual
+  const rcl_node_options_t *
+  get_rcl_node_options() const = 0;
+
+  /// Expand and remap a topic or service name with the name, namespace and options of the node.
+  RCLCPP_PUBLIC
+  virtual
+  std::string
+  resolve_topic_or_service_name(const std::string & name, bool is_service) const = 0;
+
   /// Manually assert that this Node is alive (for RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_NODE).
   RCLCPP_PUBLIC
   virtual
@@ -156,11 +183,86 @@ public:
   std::unique_lock<std::recursive_mutex>
   acquire_notify_guard_condition_lock() const = 0;
 
+  /// Trigger the notify guard condition, unless an entity creation batch defers it.
+  /**
+   * Called once an entity was added to the node, see EntityCreationBatch.
+   * \return the return code of rcl_trigger_guard_condition(), RCL_RET_OK if it is deferred.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  rcl_ret_t
+  trigger_notify_guard_condition() = 0;
+
+  /// Defer the triggers of the notify guard condition, see EntityCreationBatch.
+  RCLCPP_PUBLIC
+  virtual
+  void
+  begin_entity_creation_batch() = 0;
+
+  /// Trigger the notify guard condition once if it was deferred, at the end of the last batch.
+  /**
+   * A failure to trigger it is logged, as this is called by a destructor.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  void
+  end_entity_creation_batch() = 0;
+
   /// Return the default preference for using intra process communication.
   RCLCPP_PUBLIC
   virtual
   bool
   get_use_intra_process_default() const = 0;
+
+  /// Return the arena used to allocate the entities of the node, nullptr if none.
+  RCLCPP_PUBLIC
+  virtual
+  const rclcpp::allocator::Arena::SharedPtr &
+  get_entity_arena() const = 0;
+
+  /// Return the message pools of the subscriptions of the node, nullptr if none.
+  RCLCPP_PUBLIC
+  virtual
+  const rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry::SharedPtr &
+  get_message_pools() const = 0;
+
+  /// Return the bytes used by the publishers, subscriptions, services and clients of the node.
+  /**
+   * The entities are those of the callback groups of the node which still exist.
+   * See rclcpp::MemoryUsage for what is counted.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  rclcpp::NodeMemoryUsage
+  get_memory_usage() const = 0;
+};
+
+/// Defer the notification of the executors on the creation of entities until the scope exit.
+/**
+ * Each publisher, subscription, service, client, timer or waitable added to the node triggers
+ * its notify guard condition, and each executor spinning the node collects its entities again.
+ * Within the scope of a batch, the triggers are coalesced into one at the end of the scope.
+ *
+ * The batches of a node may be nested, and they defer the triggers of all the threads.
+ */
+class EntityCreationBatch
+{
+public:
+  explicit EntityCreationBatch(NodeBaseInterface & node_base)
+  : node_base_(node_base)
+  {
+    node_base_.begin_entity_creation_batch();
+  }
+
+  ~EntityCreationBatch()
+  {
+    node_base_.end_entity_creation_batch();
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(EntityCreationBatch)
+
+  NodeBaseInterface & node_base_;
 };
 
 }  // namespace node_interfaces
@@ -16,15 +16,18 @@
 #define RCLCPP__NODE_INTERFACES__NODE_GRAPH_HPP_
 
 #include <chrono>
+#include <condition_variable>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "rcl/guard_condition.h"
 
+#include "rclcpp/detail/expanded_name_cache.hpp"
 #include "rclcpp/event.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
@@ -49,8 +52,17 @@ class NodeGraph : public NodeGraphInterface
 public:
   RCLCPP_SMART_PTR_ALIASES_ONLY(NodeGraph)
 
+  /// Constructor.
+  /**
+   * \param[in] node_base The base interface of the node.
+   * \param[in] use_graph_cache If true, the graph queries are answered from a cache shared by
+   *   the nodes of the context, refreshed on the first query after a graph change.
+   *   The node is then watched by the graph listener for as long as it exists.
+   */
   RCLCPP_PUBLIC
-  explicit NodeGraph(rclcpp::node_interfaces::NodeBaseInterface * node_base);
+  explicit NodeGraph(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    bool use_graph_cache = false);
 
   RCLCPP_PUBLIC
   virtual
@@ -118,6 +130,12 @@ public:
   size_t
   count_graph_users() override;
 
+  RCLCPP_PUBLIC
+  bool
+  wait_for_service_in_graph(
+    const std::string & service_name,
+    std::chrono::nanoseconds timeout) override;
+
   RCLCPP_PUBLIC
   std::vector<rclcpp::TopicEndpointInfo>
   get_publishers_info_by_topic(
@@ -130,9 +148,88 @@ public:
     const std::string & topic_name,
     bool no_mangle = false) const override;
 
+  RCLCPP_PUBLIC
+  void
+  get_publishers_info_by_topic(
+    const std::string & topic_name,
+    std::vector<rclcpp::TopicEndpointInfo> & endpoints,
+    bool no_mangle = false) const override;
+
+  RCLCPP_PUBLIC
+  void
+  get_subscriptions_info_by_topic(
+    const std::string & topic_name,
+    std::vector<rclcpp::TopicEndpointInfo> & endpoints,
+    bool no_mangle = false) const override;
+
+  RCLCPP_PUBLIC
+  GraphChangeHandle::SharedPtr
+  add_graph_change_callback(
+    GraphEntityKind kind,
+    const std::string & name,
+    GraphChangeHandle::CallbackType callback) override;
+
 private:
   RCLCPP_DISABLE_COPY(NodeGraph)
 
+  /// A thread blocked in wait_for_service_in_graph().
+  struct ServiceWaiter
+  {
+    explicit ServiceWaiter(const std::string & service_name)
+    : service_name(service_name) {}
+
+    const std::string & service_name;
+    bool in_graph = false;
+    std::condition_variable condition;
+  };
+
+  /// Results of the graph queries, shared by the nodes of a context.
+  class GraphCache;
+
+  /// Query the graph from rcl, without the cache.
+  std::map<std::string, std::vector<std::string>>
+  query_topic_names_and_types(bool no_demangle) const;
+
+  std::map<std::string, std::vector<std::string>>
+  query_service_names_and_types() const;
+
+  std::vector<std::pair<std::string, std::string>>
+  query_node_names_and_namespaces() const;
+
+  /// Expand a topic or service name for the node, memoized in expanded_names_.
+  std::string
+  expand_name(const std::string & name, bool is_service) const;
+
+  size_t
+  query_publisher_count(const std::string & fully_qualified_topic_name) const;
+
+  size_t
+  query_subscriber_count(const std::string & fully_qualified_topic_name) const;
+
+  /// Return the names of the services in the graph.
+  std::set<std::string>
+  query_service_names() const;
+
+  /// Query the names of the services, and wake up the waiters whose service is in the graph.
+  void
+  update_service_waiters();
+
+  /// Query the entities watched by the graph change handles, and call those which changed.
+  void
+  update_graph_change_handles();
+
+  /// Compare the state of the entity of a handle to the graph, and update it.
+  /**
+   * The names of the nodes and of the services are only queried if needed, once.
+   * \return true if the entity changed.
+   */
+  bool
+  update_graph_change_handle(
+    GraphChangeHandle & handle,
+    std::unique_ptr<std::set<std::string>> & node_names,
+    std::unique_ptr<std::set<std::string>> & service_names,
+    rclcpp::GraphChange & change) const;
+
   /// Handle to the NodeBaseInterface given in the constructor.
   rclcpp::node_interfaces::NodeBaseInterface * node_base_;
 
@@ -150,6 +247,29 @@ private:
   /// Number of graph events out on loan, used to determine if the graph should be monitored.
   /** graph_users_count_ is atomic so that it can be accessed without acquiring the graph_mutex_ */
   std::atomic_size_t graph_users_count_;
+
+  /// Threads waiting for a service, guarded by graph_mutex_.
+  std::vector<ServiceWaiter *> service_waiters_;
+  /// Number of graph changes notified, guarded by graph_mutex_.
+  uint64_t graph_change_count_ = 0;
+  /// Names of the services at the graph change service_names_change_count_, if it's the last.
+  std::set<std::string> service_names_;
+  uint64_t service_names_change_count_ = 0;
+  bool has_service_names_ = false;
+  /// Last time the names of the services were queried.
+  std::chrono::steady_clock::time_point service_names_time_;
+
+  /// Cache of the graph queries, if enabled in the constructor.
+  std::shared_ptr<GraphCache> graph_cache_;
+
+  /// Names given to the graph queries, expanded and remapped for the node.
+  mutable rclcpp::detail::ExpandedNameCache expanded_names_;
+
+  /// Handles of the graph change callbacks, the expired ones are removed on graph changes.
+  std::mutex graph_change_handles_mutex_;
+  std::vector<GraphChangeHandle::WeakPtr> graph_change_handles_;
+  /// Number of graph change handles, counted as graph users.
+  std::atomic_size_t graph_change_handles_count_{0};
 };
 
 }  // namespace node_interfaces
@@ -18,7 +18,9 @@
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <functional>
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -129,9 +131,54 @@ private:
   rclcpp::QoS qos_profile_;
 };
 
+/// Kind of the entities of the graph which can be watched for changes.
+enum class GraphEntityKind
+{
+  Topic,
+  Service,
+  Node
+};
+
+/// Change of a watched entity of the graph, see NodeGraphInterface::add_graph_change_callback().
+struct GraphChange
+{
+  GraphEntityKind kind;
+  /// Fully qualified name of the entity.
+  std::string name;
+  /// Whether the entity was in the graph before and after the change.
+  /**
+   * A topic is in the graph while it has publishers or subscriptions, a service while it has
+   * servers or clients.
+   */
+  bool existed = false;
+  bool exists = false;
+  /// Publishers and subscriptions which appeared and disappeared, for topics only.
+  std::vector<rclcpp::TopicEndpointInfo> added_endpoints;
+  std::vector<rclcpp::TopicEndpointInfo> removed_endpoints;
+};
+
 namespace node_interfaces
 {
 
+/// Registration of a callback for the changes of one entity of the graph.
+/**
+ * The callback is unregistered when the handle is destroyed.
+ */
+struct GraphChangeHandle
+{
+  RCLCPP_SMART_PTR_DEFINITIONS(GraphChangeHandle)
+
+  using CallbackType = std::function<void (const rclcpp::GraphChange &)>;
+
+  GraphEntityKind kind;
+  /// Fully qualified name of the entity.
+  std::string name;
+  CallbackType callback;
+  /// State of the entity when last checked, for the next difference.
+  bool exists = false;
+  std::vector<rclcpp::TopicEndpointInfo> endpoints;
+};
+
 /// Pure virtual interface class for the NodeGraph part of the Node API.
 class NodeGraphInterface
 {
@@ -251,8 +298,29 @@ public:
   size_t
   count_graph_users() = 0;
 
+  /// Block until a service with a given name is in the graph, or until the timeout expires.
+  /**
+   * The names of the services are queried once per graph change, and at most every 100ms
+   * otherwise, for all the threads waiting on the node, which are only woken up when their
+   * service appears, instead of each of them querying the graph on every change.
+   * A service in the graph may still not be ready for a given client yet, e.g. if it has
+   * another type, see rclcpp::ClientBase::service_is_ready().
+   *
+   * \param[in] service_name The fully qualified name of the service.
+   * \param[in] timeout The time to wait, negative to wait forever.
+   * \return true if the service is in the graph, false on timeout or shutdown.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  bool
+  wait_for_service_in_graph(
+    const std::string & service_name,
+    std::chrono::nanoseconds timeout) = 0;
+
   /// Return the topic endpoint information about publishers on a given topic.
   /**
+   * With the graph cache of the node, the information comes from the cache.
+   *
    * \sa rclcpp::Node::get_publishers_info_by_topic
    */
   RCLCPP_PUBLIC
@@ -268,6 +336,61 @@ public:
   virtual
   std::vector<rclcpp::TopicEndpointInfo>
   get_subscriptions_info_by_topic(const std::string & topic_name, bool no_mangle = false) const = 0;
+
+  /// Get the topic endpoint information about publishers on a given topic into a vector.
+  /**
+   * With the graph cache of the node, see rclcpp::NodeOptions::use_graph_cache(), the
+   * information is copy assigned to the vector from the cache, so a vector reused across calls
+   * keeps the storage of its strings, and the graph is only queried after it changed.
+   *
+   * \param[in] topic_name The name of the topic.
+   * \param[out] endpoints The information about the publishers, replacing its content.
+   * \param[in] no_mangle If true, topic_name is used as is, see get_publishers_info_by_topic().
+   */
+  RCLCPP_PUBLIC
+  virtual
+  void
+  get_publishers_info_by_topic(
+    const std::string & topic_name,
+    std::vector<rclcpp::TopicEndpointInfo> & endpoints,
+    bool no_mangle = false) const = 0;
+
+  /// Get the topic endpoint information about subscriptions on a given topic into a vector.
+  /**
+   * \sa get_publishers_info_by_topic(const std::string &, std::vector<TopicEndpointInfo> &, bool)
+   */
+  RCLCPP_PUBLIC
+  virtual
+  void
+  get_subscriptions_info_by_topic(
+    const std::string & topic_name,
+    std::vector<rclcpp::TopicEndpointInfo> & endpoints,
+    bool no_mangle = false) const = 0;
+
+  /// Register a callback called when a topic, a service or a node changes in the graph.
+  /**
+   * On each graph change, the entities watched through the node are queried and compared to
+   * their previous state, and the callback is only called if its entity changed, with what
+   * changed: the endpoints which appeared or disappeared for a topic, whether a service or a
+   * node appeared or disappeared.
+   * Changes of the endpoints of a topic other than their number are not reported.
+   *
+   * The callbacks are called by the thread of the graph listener, they must not block.
+   * The state of the entity when registering is not reported.
+   *
+   * \param[in] kind The kind of the entity.
+   * \param[in] name The name of the entity, relative topic and service names are expanded
+   *   with the name and namespace of the node, node names must be fully qualified.
+   * \param[in] callback The callback, called with the change.
+   * \return the handle of the callback, which is unregistered when it is destroyed.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  GraphChangeHandle::SharedPtr
+  add_graph_change_callback(
+    GraphEntityKind kind,
+    const std::string & name,
+    GraphChangeHandle::CallbackType callback) = 0;
 };
 
 }  // namespace node_interfaces
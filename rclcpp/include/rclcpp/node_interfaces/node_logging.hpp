@@ -16,11 +16,13 @@
 #define RCLCPP__NODE_INTERFACES__NODE_LOGGING_HPP_
 
 #include <memory>
+#include <string>
 
 #include "rclcpp/logger.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_logging_interface.hpp"
+#include "rclcpp/rosout_rate_limit.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
@@ -34,8 +36,15 @@ class NodeLogging : public NodeLoggingInterface
 public:
   RCLCPP_SMART_PTR_ALIASES_ONLY(NodeLoggingInterface)
 
+  /// Constructor.
+  /**
+   * \param[in] node_base the base interface of the node.
+   * \param[in] rosout_rate_limit budget of the logs of the node published to /rosout.
+   */
   RCLCPP_PUBLIC
-  explicit NodeLogging(rclcpp::node_interfaces::NodeBaseInterface * node_base);
+  explicit NodeLogging(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    const rclcpp::RosoutRateLimit & rosout_rate_limit = rclcpp::RosoutRateLimit());
 
   RCLCPP_PUBLIC
   virtual
@@ -58,6 +67,10 @@ private:
   rclcpp::node_interfaces::NodeBaseInterface * node_base_;
 
   rclcpp::Logger logger_;
+  std::string logger_name_;
+
+  /// Name of the logger whose rosout output is limited, empty if not limited.
+  std::string rate_limited_logger_name_;
 };
 
 }  // namespace node_interfaces
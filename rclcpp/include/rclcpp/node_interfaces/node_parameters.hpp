@@ -15,6 +15,8 @@
 #ifndef RCLCPP__NODE_INTERFACES__NODE_PARAMETERS_HPP_
 #define RCLCPP__NODE_INTERFACES__NODE_PARAMETERS_HPP_
 
+#include <chrono>
+#include <functional>
 #include <map>
 #include <memory>
 #include <list>
@@ -31,10 +33,12 @@
 #include "rclcpp/node_interfaces/node_logging_interface.hpp"
 #include "rclcpp/node_interfaces/node_parameters_interface.hpp"
 #include "rclcpp/node_interfaces/node_services_interface.hpp"
+#include "rclcpp/node_interfaces/node_timers_interface.hpp"
 #include "rclcpp/node_interfaces/node_topics_interface.hpp"
 #include "rclcpp/parameter.hpp"
 #include "rclcpp/parameter_service.hpp"
 #include "rclcpp/publisher.hpp"
+#include "rclcpp/timer.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
@@ -82,6 +86,19 @@ class NodeParameters : public NodeParametersInterface
 public:
   RCLCPP_SMART_PTR_ALIASES_ONLY(NodeParameters)
 
+  /// Constructor.
+  /**
+   * \param[in] parameter_event_coalescing_period If greater than zero, the parameter events are
+   *   merged for this period after a change, then published by a timer of node_timers.
+   * \param[in] node_timers Needed if the coalescing period is greater than zero.
+   * \param[in] lazy_parameter_event_publisher If true, the parameter event publisher is created
+   *   by the first change or undeclaration of a parameter, the earlier declarations are published
+   *   with it.
+   * \param[in] parameter_snapshot_path If not empty and the file exists, the parameters of this
+   *   snapshot are overrides, over the ones of the arguments and under parameter_overrides.
+   * \throws std::invalid_argument if the coalescing period is greater than zero and node_timers
+   *   is nullptr.
+   */
   RCLCPP_PUBLIC
   NodeParameters(
     const node_interfaces::NodeBaseInterface::SharedPtr node_base,
@@ -95,7 +112,11 @@ public:
     const rclcpp::QoS & parameter_event_qos,
     const rclcpp::PublisherOptionsBase & parameter_event_publisher_options,
     bool allow_undeclared_parameters,
-    bool automatically_declare_parameters_from_overrides);
+    bool automatically_declare_parameters_from_overrides,
+    std::chrono::nanoseconds parameter_event_coalescing_period = std::chrono::nanoseconds(0),
+    const node_interfaces::NodeTimersInterface::SharedPtr node_timers = nullptr,
+    bool lazy_parameter_event_publisher = false,
+    const std::string & parameter_snapshot_path = "");
 
   RCLCPP_PUBLIC
   virtual
@@ -109,6 +130,13 @@ public:
     const rcl_interfaces::msg::ParameterDescriptor & parameter_descriptor,
     bool ignore_override) override;
 
+  RCLCPP_PUBLIC
+  std::vector<rclcpp::ParameterValue>
+  declare_parameters(
+    const std::vector<rclcpp::Parameter> & parameters,
+    const std::vector<rcl_interfaces::msg::ParameterDescriptor> & parameter_descriptors,
+    bool ignore_overrides) override;
+
   RCLCPP_PUBLIC
   void
   undeclare_parameter(const std::string & name) override;
@@ -175,11 +203,50 @@ public:
   const std::map<std::string, rclcpp::ParameterValue> &
   get_parameter_overrides() const override;
 
+  RCLCPP_PUBLIC
+  ParameterValueObserver::SharedPtr
+  add_parameter_value_observer(
+    const std::string & name,
+    ParameterValueObserver::CallbackType callback) override;
+
+  /// Write the declared parameters to a snapshot file, to restore them when the node restarts.
+  /**
+   * \sa rclcpp::write_parameter_snapshot()
+   * \sa rclcpp::NodeOptions::parameter_snapshot_path()
+   * \throws std::runtime_error if the file can't be written.
+   */
+  RCLCPP_PUBLIC
+  void
+  save_parameters_snapshot(const std::string & path) const;
+
   using CallbacksContainerType = std::list<OnSetParametersCallbackHandle::WeakPtr>;
 
 private:
   RCLCPP_DISABLE_COPY(NodeParameters)
 
+  using ParameterInfos = std::map<std::string, ParameterInfo>;
+
+  /// Return the parameters as of the last successful change, without locking.
+  std::shared_ptr<const ParameterInfos>
+  get_parameters_snapshot() const;
+
+  /// Replace the snapshot by a copy of the parameters, called with mutex_ locked.
+  void
+  publish_parameters_snapshot();
+
+  /// Publish a parameter event, or merge it into the pending one, called with mutex_ locked.
+  void
+  publish_parameter_event(const rcl_interfaces::msg::ParameterEvent & parameter_event);
+
+  /// Publish the pending parameter event, if any.
+  void
+  publish_pending_parameter_event();
+
+  /// Call the observers of the parameters which were declared, set or undeclared, with mutex_
+  /// locked.
+  void
+  notify_parameter_value_observers(const std::vector<rclcpp::Parameter> & parameters);
+
   mutable std::recursive_mutex mutex_;
 
   // There are times when we don't want to allow modifications to parameters
@@ -193,11 +260,28 @@ private:
 
   std::map<std::string, ParameterInfo> parameters_;
 
+  // Copy of parameters_ which is never modified, read and replaced with the atomic functions of
+  // std::shared_ptr, so getting parameters doesn't contend with setting them.
+  std::shared_ptr<const ParameterInfos> parameters_snapshot_ =
+    std::make_shared<ParameterInfos>();
+
   std::map<std::string, rclcpp::ParameterValue> parameter_overrides_;
 
+  std::map<std::string, std::list<ParameterValueObserver::WeakPtr>> parameter_value_observers_;
+
   bool allow_undeclared_ = false;
 
   Publisher<rcl_interfaces::msg::ParameterEvent>::SharedPtr events_publisher_;
+  // Creates events_publisher_, until it's created if the publisher is lazy.
+  std::function<Publisher<rcl_interfaces::msg::ParameterEvent>::SharedPtr()>
+  create_events_publisher_;
+
+  // Changes not published yet, while the node is constructed or during the coalescing period.
+  rcl_interfaces::msg::ParameterEvent pending_parameter_event_;
+  bool has_pending_parameter_event_ = false;
+  bool defer_parameter_events_ = false;
+  // Publishes the pending event, canceled while there is none.
+  rclcpp::TimerBase::SharedPtr parameter_event_timer_;
 
   std::shared_ptr<ParameterService> parameter_service_;
 
@@ -45,6 +45,16 @@ struct OnSetParametersCallbackHandle
   OnParametersSetCallbackType callback;
 };
 
+/// Registration of a function observing the value of a parameter, removed when destroyed.
+struct ParameterValueObserver
+{
+  RCLCPP_SMART_PTR_DEFINITIONS(ParameterValueObserver)
+
+  using CallbackType = std::function<void (const rclcpp::ParameterValue &)>;
+
+  CallbackType callback;
+};
+
 /// Pure virtual interface class for the NodeParameters part of the Node API.
 class NodeParametersInterface
 {
@@ -69,6 +79,19 @@ public:
     rcl_interfaces::msg::ParameterDescriptor(),
     bool ignore_override = false) = 0;
 
+  /// Declare and initialize several parameters at once.
+  /**
+   * \sa rclcpp::Node::declare_parameters
+   */
+  RCLCPP_PUBLIC
+  virtual
+  std::vector<rclcpp::ParameterValue>
+  declare_parameters(
+    const std::vector<rclcpp::Parameter> & parameters,
+    const std::vector<rcl_interfaces::msg::ParameterDescriptor> & parameter_descriptors =
+    std::vector<rcl_interfaces::msg::ParameterDescriptor>(),
+    bool ignore_overrides = false) = 0;
+
   /// Undeclare a parameter.
   /**
    * \sa rclcpp::Node::undeclare_parameter
@@ -205,6 +228,27 @@ public:
   virtual
   const std::map<std::string, rclcpp::ParameterValue> &
   get_parameter_overrides() const = 0;
+
+  /// Call a function with the value of a parameter now, and each time it is set.
+  /**
+   * The function is called with the parameters locked, after the new values are committed, it
+   * must not block nor modify parameters.
+   * It is no longer called when the returned observer is destroyed.
+   * When the parameter is undeclared, it is called with a value of type PARAMETER_NOT_SET, and
+   * with the new value if the parameter is declared again.
+   *
+   * \param[in] name The name of a declared parameter.
+   * \param[in] callback The function called with the value.
+   * \return the observer, which must be kept for the function to be called.
+   * \throws rclcpp::exceptions::ParameterNotDeclaredException if the parameter is not declared.
+   * \throws anything the first call of the function throws, it is then not registered.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  ParameterValueObserver::SharedPtr
+  add_parameter_value_observer(
+    const std::string & name,
+    ParameterValueObserver::CallbackType callback) = 0;
 };
 
 }  // namespace node_interfaces
@@ -38,6 +38,7 @@ class NodeTimeSource : public NodeTimeSourceInterface
 public:
   RCLCPP_SMART_PTR_ALIASES_ONLY(NodeTimeSource)
 
+  /// Constructor.
   RCLCPP_PUBLIC
   explicit NodeTimeSource(
     rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base,
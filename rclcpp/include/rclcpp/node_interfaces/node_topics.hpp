@@ -15,13 +15,19 @@
 #ifndef RCLCPP__NODE_INTERFACES__NODE_TOPICS_HPP_
 #define RCLCPP__NODE_INTERFACES__NODE_TOPICS_HPP_
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "rcl/publisher.h"
 #include "rcl/subscription.h"
 
+#include "rclcpp/detail/qos_event_handler_group.hpp"
+#include "rclcpp/experimental/subscription_intra_process_group.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/node_interfaces/node_graph_interface.hpp"
 #include "rclcpp/node_interfaces/node_topics_interface.hpp"
 #include "rclcpp/publisher.hpp"
 #include "rclcpp/publisher_factory.hpp"
@@ -41,6 +47,12 @@ public:
   RCLCPP_PUBLIC
   explicit NodeTopics(rclcpp::node_interfaces::NodeBaseInterface * node_base);
 
+  /// Construct with the graph interface, used by the publishers caching their subscription count.
+  RCLCPP_PUBLIC
+  NodeTopics(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    rclcpp::node_interfaces::NodeGraphInterface * node_graph);
+
   RCLCPP_PUBLIC
   ~NodeTopics() override;
 
@@ -77,7 +89,40 @@ public:
 private:
   RCLCPP_DISABLE_COPY(NodeTopics)
 
+  /// Waitables batching the entities of the node in one callback group.
+  struct CallbackGroupWaitables
+  {
+    rclcpp::callback_group::CallbackGroup::WeakPtr callback_group;
+    /// Null until the first QoS event handler of the callback group.
+    rclcpp::detail::QOSEventHandlerGroup::SharedPtr event_handlers;
+    /// Null until the first intra-process subscription of the callback group.
+    rclcpp::experimental::SubscriptionIntraProcessGroup::SharedPtr intra_process_subscriptions;
+  };
+
+  /// Return the waitables of the callback group, callback_group_waitables_mutex_ must be held.
+  CallbackGroupWaitables &
+  get_callback_group_waitables(
+    const rclcpp::callback_group::CallbackGroup::SharedPtr & callback_group);
+
+  /// Add the QoS event handlers to the waitable batching them for the callback group.
+  void
+  add_event_handlers(
+    const std::vector<std::shared_ptr<rclcpp::QOSEventHandlerBase>> & event_handlers,
+    const rclcpp::callback_group::CallbackGroup::SharedPtr & callback_group);
+
+  /// Add the intra-process subscription to the waitable batching them for the callback group.
+  void
+  add_intra_process_subscription(
+    const rclcpp::Waitable::SharedPtr & intra_process_waitable,
+    const rclcpp::callback_group::CallbackGroup::SharedPtr & callback_group);
+
   rclcpp::node_interfaces::NodeBaseInterface * node_base_;
+  /// Null if the node didn't give it, the subscription count is then never cached.
+  rclcpp::node_interfaces::NodeGraphInterface * node_graph_;
+
+  /// The callback groups only hold their waitables weakly, the node keeps these alive.
+  std::mutex callback_group_waitables_mutex_;
+  std::vector<CallbackGroupWaitables> callback_group_waitables_;
 };
 
 }  // namespace node_interfaces
@@ -15,16 +15,20 @@
 #ifndef RCLCPP__NODE_OPTIONS_HPP_
 #define RCLCPP__NODE_OPTIONS_HPP_
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "rcl/node_options.h"
+#include "rclcpp/allocator/arena_allocator.hpp"
 #include "rclcpp/context.hpp"
 #include "rclcpp/contexts/default_context.hpp"
 #include "rclcpp/parameter.hpp"
 #include "rclcpp/publisher_options.hpp"
 #include "rclcpp/qos.hpp"
+#include "rclcpp/rosout_rate_limit.hpp"
+#include "rclcpp/strategies/message_pool_memory_strategy.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
@@ -41,16 +45,23 @@ public:
    *   - context = rclcpp::contexts::default_context::get_global_default_context()
    *   - arguments = {}
    *   - parameter_overrides = {}
+   *   - parameter_snapshot_path = "", no snapshot
    *   - use_global_arguments = true
    *   - use_intra_process_comms = false
    *   - start_parameter_services = true
    *   - start_parameter_event_publisher = true
+   *   - lazy_parameter_event_publisher = false
    *   - parameter_event_qos = rclcpp::ParameterEventQoS
    *     - with history setting and depth from rmw_qos_profile_parameter_events
    *   - parameter_event_publisher_options = rclcpp::PublisherOptionsBase
+   *   - parameter_event_coalescing_period = 0, events are published right away
+   *   - use_graph_cache = false
+   *   - rosout_rate_limit = rclcpp::RosoutRateLimit, no limit
    *   - allow_undeclared_parameters = false
    *   - automatically_declare_parameters_from_overrides = false
    *   - allocator = rcl_get_default_allocator()
+   *   - entity_arena = nullptr
+   *   - message_pools = nullptr
    *
    * \param[in] allocator allocator to use in construction of NodeOptions.
    */
@@ -126,6 +137,26 @@ public:
   NodeOptions &
   parameter_overrides(const std::vector<rclcpp::Parameter> & parameter_overrides);
 
+  /// Return the path of the parameter snapshot restored by the node.
+  RCLCPP_PUBLIC
+  const std::string &
+  parameter_snapshot_path() const;
+
+  /// Set the path of a parameter snapshot to restore, return this for parameter idiom.
+  /**
+   * If the file exists, its parameters, written by rclcpp::write_parameter_snapshot()
+   * or NodeParameters::save_parameters_snapshot(), are parameter overrides of the node.
+   * They take precedence over the overrides of the arguments, and the parameter
+   * overrides of these options take precedence over them.
+   *
+   * The file is memory mapped, which is much faster than parsing YAML files
+   * for large sets of parameters.
+   * If the file doesn't exist, e.g. the first time the node is started, it's ignored.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  parameter_snapshot_path(const std::string & parameter_snapshot_path);
+
   /// Append a single parameter override, parameter idiom style.
   template<typename ParameterT>
   NodeOptions &
@@ -179,6 +210,9 @@ public:
    * this context will go through a special intra-process communication code
    * code path which can avoid serialization and deserialization, unnecessary
    * copies, and achieve lower latencies in some cases.
+   * The requests and responses between the clients and services of such nodes
+   * are passed within the process too, see
+   * rclcpp::experimental::IntraProcessServiceManager.
    *
    * Defaults to false for now, as there are still some cases where it is not
    * desirable.
@@ -222,6 +256,22 @@ public:
   NodeOptions &
   start_parameter_event_publisher(bool start_parameter_event_publisher);
 
+  /// Return the lazy_parameter_event_publisher flag.
+  RCLCPP_PUBLIC
+  bool
+  lazy_parameter_event_publisher() const;
+
+  /// Set the lazy_parameter_event_publisher flag, return this for parameter idiom.
+  /**
+   * If true, and the parameter event publisher is started, it's only created
+   * when a parameter of the node is changed or undeclared for the first time.
+   * The parameters declared before are published in the same event, so a node
+   * which only declares parameters doesn't create the publisher.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  lazy_parameter_event_publisher(bool lazy_parameter_event_publisher);
+
   /// Return a reference to the parameter_event_qos QoS.
   RCLCPP_PUBLIC
   const rclcpp::QoS &
@@ -253,6 +303,72 @@ public:
   parameter_event_publisher_options(
     const rclcpp::PublisherOptionsBase & parameter_event_publisher_options);
 
+  /// Return the parameter_event_coalescing_period.
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  parameter_event_coalescing_period() const;
+
+  /// Set the parameter_event_coalescing_period, return this for parameter idiom.
+  /**
+   * If greater than zero, the parameter events of the node are merged for
+   * this period after a change, then published as one event.
+   * The publication needs the node to be spun.
+   *
+   * Whatever the period, the parameters declared while the node is created,
+   * from the parameter overrides, are published in one event.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  parameter_event_coalescing_period(std::chrono::nanoseconds parameter_event_coalescing_period);
+
+  /// Set the options of a lightweight node, return this for parameter idiom.
+  /**
+   * For small nodes created in large numbers, this removes the entities the
+   * node creates for itself:
+   *
+   *   - enable_rosout = false, the logs are still written to the console
+   *   - start_parameter_services = false
+   *   - lazy_parameter_event_publisher = true
+   *
+   * The other options are left as they are, and can still be set afterwards.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  lightweight();
+
+  /// Return the use_graph_cache flag.
+  RCLCPP_PUBLIC
+  bool
+  use_graph_cache() const;
+
+  /// Set the use_graph_cache flag, return this for parameter idiom.
+  /**
+   * If true, the graph queries of the node, e.g. get_topic_names_and_types()
+   * and count_publishers(), are answered from a cache shared by the nodes of
+   * the context, which is refreshed on the first query after a graph change.
+   *
+   * The graph listener then wakes up on every graph change of the node, so the
+   * cache is worth it for nodes querying the graph often.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  use_graph_cache(bool use_graph_cache);
+
+  /// Return the budget of the logs the node publishes to /rosout.
+  RCLCPP_PUBLIC
+  const rclcpp::RosoutRateLimit &
+  rosout_rate_limit() const;
+
+  /// Set the budget of the logs the node publishes to /rosout, return this for parameter idiom.
+  /**
+   * The logs of the node over budget are still written to the console, unless disabled in the
+   * limit, but aren't published to /rosout.
+   * See rclcpp::RosoutRateLimit.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  rosout_rate_limit(const rclcpp::RosoutRateLimit & rosout_rate_limit);
+
   /// Return the allow_undeclared_parameters flag.
   RCLCPP_PUBLIC
   bool
@@ -293,6 +409,43 @@ public:
   automatically_declare_parameters_from_overrides(
     bool automatically_declare_parameters_from_overrides);
 
+  /// Return the arena used to allocate the entities of the node, nullptr if none.
+  RCLCPP_PUBLIC
+  const rclcpp::allocator::Arena::SharedPtr &
+  entity_arena() const;
+
+  /// Set the arena used to allocate the entities of the node, return this.
+  /**
+   * Publishers, subscriptions, services, clients, timers and callback groups created by the
+   * node are allocated from this arena instead of one by one by the global allocator, which
+   * keeps them close in memory and speeds up the creation of many entities, e.g. when loading
+   * many components in a container.
+   * Entities which don't fit anymore in the arena are allocated by the global allocator.
+   * An arena may be shared by several nodes, it is kept alive by the entities allocated in it.
+   *
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  entity_arena(rclcpp::allocator::Arena::SharedPtr entity_arena);
+
+  /// Return the message pools of the subscriptions of the node, nullptr if none.
+  RCLCPP_PUBLIC
+  const rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry::SharedPtr &
+  message_pools() const;
+
+  /// Set the message pools of the subscriptions of the node, return this for parameter idiom.
+  /**
+   * The subscriptions created with the default message memory strategy take their messages
+   * from the pool of their message type in the registry instead.
+   * A registry may be shared by several nodes, e.g. by all the components of a container, so
+   * the messages are pooled once per process rather than once per node.
+   */
+  RCLCPP_PUBLIC
+  NodeOptions &
+  message_pools(
+    rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry::SharedPtr
+    message_pools);
+
   /// Return the rcl_allocator_t to be used.
   RCLCPP_PUBLIC
   const rcl_allocator_t &
@@ -326,6 +479,8 @@ private:
 
   std::vector<rclcpp::Parameter> parameter_overrides_ {};
 
+  std::string parameter_snapshot_path_ {};
+
   bool use_global_arguments_ {true};
 
   bool enable_rosout_ {true};
@@ -336,17 +491,30 @@ private:
 
   bool start_parameter_event_publisher_ {true};
 
+  bool lazy_parameter_event_publisher_ {false};
+
   rclcpp::QoS parameter_event_qos_ = rclcpp::ParameterEventsQoS(
     rclcpp::QoSInitialization::from_rmw(rmw_qos_profile_parameter_events)
   );
 
   rclcpp::PublisherOptionsBase parameter_event_publisher_options_ = rclcpp::PublisherOptionsBase();
 
+  std::chrono::nanoseconds parameter_event_coalescing_period_ {0};
+
+  bool use_graph_cache_ {false};
+
+  rclcpp::RosoutRateLimit rosout_rate_limit_ {};
+
   bool allow_undeclared_parameters_ {false};
 
   bool automatically_declare_parameters_from_overrides_ {false};
 
   rcl_allocator_t allocator_ {rcl_get_default_allocator()};
+
+  rclcpp::allocator::Arena::SharedPtr entity_arena_ {nullptr};
+
+  rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry::SharedPtr
+    message_pools_ {nullptr};
 };
 
 }  // namespace rclcpp
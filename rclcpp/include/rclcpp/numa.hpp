@@ -0,0 +1,64 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__NUMA_HPP_
+#define RCLCPP__NUMA_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Return the number of NUMA nodes, 1 if the platform doesn't expose them.
+RCLCPP_PUBLIC
+size_t
+get_numa_node_count();
+
+/// Return the CPUs of a NUMA node, empty if the node or the platform doesn't expose them.
+RCLCPP_PUBLIC
+std::vector<size_t>
+get_numa_node_cpus(size_t numa_node);
+
+/// Return the NUMA node of the CPU the calling thread runs on, 0 if it isn't known.
+RCLCPP_PUBLIC
+size_t
+get_current_numa_node();
+
+/// Allocate memory whose pages are preferably placed on a NUMA node.
+/**
+ * The memory is page aligned and zero-initialized, and its pages are only placed when first
+ * touched, on the node if it has free memory, elsewhere otherwise.
+ * Where the placement is not supported, it is allocated with the global operator new.
+ *
+ * \param[in] size The number of bytes.
+ * \param[in] numa_node The NUMA node, negative for the default placement.
+ * \return The memory, to be released with deallocate_on_numa_node().
+ * \throws std::bad_alloc if the memory can't be allocated.
+ */
+RCLCPP_PUBLIC
+void *
+allocate_on_numa_node(size_t size, int numa_node);
+
+/// Release memory allocated with allocate_on_numa_node() with the same size.
+RCLCPP_PUBLIC
+void
+deallocate_on_numa_node(void * pointer, size_t size);
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__NUMA_HPP_
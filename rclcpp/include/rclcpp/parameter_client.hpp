@@ -15,7 +15,13 @@
 #ifndef RCLCPP__PARAMETER_CLIENT_HPP_
 #define RCLCPP__PARAMETER_CLIENT_HPP_
 
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -344,6 +350,91 @@ private:
   AsyncParametersClient::SharedPtr async_parameters_client_;
 };
 
+/// Client getting parameters of many remote nodes, with a bounded number of requests in flight.
+/**
+ * Only the get_parameters service client of each remote node is created, on its first
+ * request, and it is kept for the following ones.
+ * The requests beyond the maximum number in flight are queued and sent as responses arrive,
+ * by the executor spinning the node of the client.
+ *
+ * A request sent before the remote service is discovered may be lost, so the queries should
+ * be given a timeout.
+ */
+class MultiNodeParametersClient
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(MultiNodeParametersClient)
+
+  /// Parameters of each remote node, by the name given in the query.
+  using NodeParametersMap = std::map<std::string, std::vector<rclcpp::Parameter>>;
+  using SharedFuture = std::shared_future<NodeParametersMap>;
+  using CallbackType = std::function<void (SharedFuture)>;
+
+  /// Constructor.
+  /**
+   * \throws std::invalid_argument if max_requests_in_flight is zero.
+   */
+  RCLCPP_PUBLIC
+  MultiNodeParametersClient(
+    const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_interface,
+    const rclcpp::node_interfaces::NodeGraphInterface::SharedPtr node_graph_interface,
+    const rclcpp::node_interfaces::NodeServicesInterface::SharedPtr node_services_interface,
+    size_t max_requests_in_flight = 16,
+    const rmw_qos_profile_t & qos_profile = rmw_qos_profile_parameters,
+    rclcpp::callback_group::CallbackGroup::SharedPtr group = nullptr);
+
+  RCLCPP_PUBLIC
+  explicit MultiNodeParametersClient(
+    const rclcpp::Node::SharedPtr node,
+    size_t max_requests_in_flight = 16,
+    const rmw_qos_profile_t & qos_profile = rmw_qos_profile_parameters,
+    rclcpp::callback_group::CallbackGroup::SharedPtr group = nullptr);
+
+  RCLCPP_PUBLIC
+  ~MultiNodeParametersClient();
+
+  /// Get the same parameters of several remote nodes.
+  /**
+   * The future is completed once every node responded or failed to, the nodes which didn't
+   * respond before the timeout are not in the map.
+   *
+   * \param[in] node_names The names of the remote nodes.
+   * \param[in] names The names of the parameters.
+   * \param[in] callback Called with the future once it is completed.
+   * \param[in] timeout The time to wait for the response of each node, from when its request
+   *   is sent, negative to wait forever.
+   * \return the future of the parameters of the nodes.
+   */
+  RCLCPP_PUBLIC
+  SharedFuture
+  get_parameters(
+    const std::vector<std::string> & node_names,
+    const std::vector<std::string> & names,
+    CallbackType callback = nullptr,
+    std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1));
+
+  /// Return the number of service clients created, one per remote node queried.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_clients() const;
+
+  /// Return the number of requests sent and waiting for a response.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_requests_in_flight() const;
+
+  /// Return the number of requests waiting to be sent.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_queued_requests() const;
+
+private:
+  RCLCPP_DISABLE_COPY(MultiNodeParametersClient)
+
+  struct State;
+  std::shared_ptr<State> state_;
+};
+
 }  // namespace rclcpp
 
 #endif  // RCLCPP__PARAMETER_CLIENT_HPP_
@@ -15,8 +15,10 @@
 #ifndef RCLCPP__PARAMETER_EVENTS_FILTER_HPP_
 #define RCLCPP__PARAMETER_EVENTS_FILTER_HPP_
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -39,6 +41,93 @@ public:
   /// Used for the listed results
   using EventPair = std::pair<EventType, rcl_interfaces::msg::Parameter *>;
 
+  /// Parameter names and event types of interest, prepared once to filter many events.
+  /**
+   * The names are kept in a hash set and the types in a bit mask, so filtering an event costs
+   * one lookup per parameter of the event, whatever the number of names.
+   */
+  class Criteria
+  {
+public:
+    /// Construct the criteria.
+    /**
+     * \param[in] names A list of parameter names of interest.
+     * \param[in] types A list of the types of parameter events of interest.
+     */
+    RCLCPP_PUBLIC
+    Criteria(const std::vector<std::string> & names, const std::vector<EventType> & types);
+
+    /// Return true if the events of the given type are of interest.
+    bool
+    matches(EventType type) const
+    {
+      return (type_mask_ & type_bit(type)) != 0u;
+    }
+
+    /// Return true if the parameter is of interest.
+    bool
+    matches(const std::string & name) const
+    {
+      return names_.find(name) != names_.end();
+    }
+
+    /// Call a function for each parameter of interest in an event, without copying it.
+    /**
+     * The parameters are visited in the order of the event: new, changed then deleted.
+     *
+     * Example Usage, in a subscription callback:
+     *
+     * ```cpp
+     * criteria.for_each_match(
+     *   *event,
+     *   [](rclcpp::ParameterEventsFilter::EventType type, const rcl_interfaces::msg::Parameter & p)
+     *   {
+     *     // ...
+     *   });
+     * ```
+     *
+     * \param[in] event The parameter event message to filter.
+     * \param[in] callback A function called with the EventType and the parameter.
+     */
+    template<typename EventT, typename CallbackT>
+    void
+    for_each_match(EventT & event, CallbackT && callback) const
+    {
+      if (matches(EventType::NEW)) {
+        for (auto & parameter : event.new_parameters) {
+          if (matches(parameter.name)) {
+            callback(EventType::NEW, parameter);
+          }
+        }
+      }
+      if (matches(EventType::CHANGED)) {
+        for (auto & parameter : event.changed_parameters) {
+          if (matches(parameter.name)) {
+            callback(EventType::CHANGED, parameter);
+          }
+        }
+      }
+      if (matches(EventType::DELETED)) {
+        for (auto & parameter : event.deleted_parameters) {
+          if (matches(parameter.name)) {
+            callback(EventType::DELETED, parameter);
+          }
+        }
+      }
+    }
+
+private:
+    static
+    uint8_t
+    type_bit(EventType type)
+    {
+      return static_cast<uint8_t>(1u << static_cast<unsigned>(type));
+    }
+
+    std::unordered_set<std::string> names_;
+    uint8_t type_mask_ = 0u;
+  };
+
   /// Construct a filtered view of a parameter event.
   /**
    * \param[in] event The parameter event message to filter.
@@ -64,6 +153,16 @@ public:
     const std::vector<std::string> & names,
     const std::vector<EventType> & types);
 
+  /// Construct a filtered view of a parameter event with prepared criteria.
+  /**
+   * \param[in] event The parameter event message to filter.
+   * \param[in] criteria The parameter names and types of events of interest.
+   */
+  RCLCPP_PUBLIC
+  ParameterEventsFilter(
+    rcl_interfaces::msg::ParameterEvent::SharedPtr event,
+    const Criteria & criteria);
+
   /// Get the result of the filter
   /**
    * \return A std::vector<EventPair> of all matching parameter changes in this event.
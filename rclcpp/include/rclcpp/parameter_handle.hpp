@@ -0,0 +1,170 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__PARAMETER_HANDLE_HPP_
+#define RCLCPP__PARAMETER_HANDLE_HPP_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "rcl_interfaces/msg/set_parameters_result.hpp"
+
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/node_interfaces/node_parameters_interface.hpp"
+#include "rclcpp/parameter.hpp"
+#include "rclcpp/parameter_value.hpp"
+
+namespace rclcpp
+{
+
+namespace detail
+{
+
+/// Latest value of a parameter, shared between a handle and the function observing it.
+template<typename ParameterT, typename Enable = void>
+class ParameterHandleValue
+{
+public:
+  /// Read without copying the value, which is kept alive by the returned pointer.
+  using ReadType = std::shared_ptr<const ParameterT>;
+
+  ReadType
+  load() const
+  {
+    return std::atomic_load(&value_);
+  }
+
+  void
+  store(const ParameterT & value)
+  {
+    std::atomic_store(&value_, ReadType(std::make_shared<ParameterT>(value)));
+  }
+
+private:
+  ReadType value_;
+};
+
+/// Scalars are read by value, from an atomic.
+template<typename ParameterT>
+class ParameterHandleValue<
+  ParameterT, typename std::enable_if<std::is_arithmetic<ParameterT>::value>::type>
+{
+public:
+  using ReadType = ParameterT;
+
+  ReadType
+  load() const
+  {
+    return value_.load(std::memory_order_acquire);
+  }
+
+  void
+  store(const ParameterT & value)
+  {
+    value_.store(value, std::memory_order_release);
+  }
+
+private:
+  std::atomic<ParameterT> value_{ParameterT()};
+};
+
+}  // namespace detail
+
+/// Typed access to a declared parameter, without looking it up by name on each read.
+/**
+ * The handle observes the parameter, it is updated when new values are committed, and reads
+ * take no lock.
+ * Scalar parameters (bool, integers and floating point numbers) are read by value, the others
+ * through a std::shared_ptr to the value as of the read, which is never modified.
+ *
+ * While the handle exists, setting the parameter to a value of another type is rejected, so
+ * the parameter can't be implicitly undeclared either.
+ * If the parameter is undeclared, the handle keeps its last value, until the parameter is
+ * declared again.
+ */
+template<typename ParameterT>
+class ParameterHandle
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(ParameterHandle)
+
+  using ReadType = typename detail::ParameterHandleValue<ParameterT>::ReadType;
+
+  /// Observe a declared parameter.
+  /**
+   * \param[in] node_parameters The parameters interface of the node.
+   * \param[in] name The name of the parameter.
+   * \throws rclcpp::exceptions::ParameterNotDeclaredException if the parameter is not declared.
+   * \throws rclcpp::ParameterTypeException if the parameter has another type than ParameterT.
+   */
+  ParameterHandle(
+    rclcpp::node_interfaces::NodeParametersInterface::SharedPtr node_parameters,
+    const std::string & name)
+  : name_(name), value_(std::make_shared<detail::ParameterHandleValue<ParameterT>>())
+  {
+    const rclcpp::ParameterType type = rclcpp::ParameterValue(ParameterT()).get_type();
+    type_guard_ = node_parameters->add_on_set_parameters_callback(
+      [name, type](const std::vector<rclcpp::Parameter> & parameters) {
+        rcl_interfaces::msg::SetParametersResult result;
+        result.successful = true;
+        for (const auto & parameter : parameters) {
+          if (parameter.get_name() == name && parameter.get_type() != type) {
+            result.successful = false;
+            result.reason = "parameter '" + name + "' is read through a handle of type " +
+              rclcpp::to_string(type);
+            break;
+          }
+        }
+        return result;
+      });
+    auto value = value_;
+    observer_ = node_parameters->add_parameter_value_observer(
+      name,
+      [value](const rclcpp::ParameterValue & parameter_value) {
+        // Not set when the parameter is undeclared.
+        if (parameter_value.get_type() != rclcpp::PARAMETER_NOT_SET) {
+          value->store(static_cast<ParameterT>(parameter_value.get<ParameterT>()));
+        }
+      });
+  }
+
+  /// Return the latest value of the parameter.
+  ReadType
+  get() const
+  {
+    return value_->load();
+  }
+
+  const std::string &
+  get_name() const
+  {
+    return name_;
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(ParameterHandle)
+
+  std::string name_;
+  std::shared_ptr<detail::ParameterHandleValue<ParameterT>> value_;
+  rclcpp::node_interfaces::OnSetParametersCallbackHandle::SharedPtr type_guard_;
+  rclcpp::node_interfaces::ParameterValueObserver::SharedPtr observer_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__PARAMETER_HANDLE_HPP_
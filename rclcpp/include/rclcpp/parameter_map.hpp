@@ -48,6 +48,32 @@ RCLCPP_PUBLIC
 ParameterValue
 parameter_value_from(const rcl_variant_t * const c_value);
 
+/// Write parameters to a binary snapshot file, to be restored quickly.
+/**
+ * The file is written next to the path then renamed, so it's replaced at once.
+ * The snapshot uses the byte order of the host, it's meant to be read on the same machine,
+ * typically when a node restarts.
+ * \param[in] path Path of the snapshot file.
+ * \param[in] parameters Parameters to write.
+ * \throws std::runtime_error if the file can't be written.
+ * \throws std::length_error if a value has more than 2^32 - 1 elements.
+ */
+RCLCPP_PUBLIC
+void
+write_parameter_snapshot(const std::string & path, const std::vector<Parameter> & parameters);
+
+/// Read the parameters of a snapshot file written by write_parameter_snapshot().
+/**
+ * The file is memory mapped and the values are copied out of it, without parsing text.
+ * \param[in] path Path of the snapshot file.
+ * \return the parameters, in the order they were written.
+ * \throws std::runtime_error if the file can't be opened.
+ * \throws InvalidParametersException if the file is not a valid snapshot.
+ */
+RCLCPP_PUBLIC
+std::vector<Parameter>
+read_parameter_snapshot(const std::string & path);
+
 }  // namespace rclcpp
 
 #endif  // RCLCPP__PARAMETER_MAP_HPP_
@@ -17,6 +17,7 @@
 
 #include <exception>
 #include <iostream>
+#include <memory>
 #include <ostream>
 #include <sstream>
 #include <string>
@@ -68,6 +69,10 @@ public:
 };
 
 /// Store the type and value of a parameter.
+/**
+ * Only the member of the type of the value is stored, unlike in a
+ * rcl_interfaces::msg::ParameterValue, which is only used to convert from and to messages.
+ */
 class ParameterValue
 {
 public:
@@ -147,10 +152,10 @@ public:
   typename std::enable_if<type == ParameterType::PARAMETER_BOOL, const bool &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_BOOL) {
-      throw ParameterTypeException(ParameterType::PARAMETER_BOOL, get_type());
+    if (type_ != ParameterType::PARAMETER_BOOL) {
+      throw ParameterTypeException(ParameterType::PARAMETER_BOOL, type_);
     }
-    return value_.bool_value;
+    return scalar_.bool_value;
   }
 
   template<ParameterType type>
@@ -158,10 +163,10 @@ public:
   typename std::enable_if<type == ParameterType::PARAMETER_INTEGER, const int64_t &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER) {
-      throw ParameterTypeException(ParameterType::PARAMETER_INTEGER, get_type());
+    if (type_ != ParameterType::PARAMETER_INTEGER) {
+      throw ParameterTypeException(ParameterType::PARAMETER_INTEGER, type_);
     }
-    return value_.integer_value;
+    return scalar_.integer_value;
   }
 
   template<ParameterType type>
@@ -169,10 +174,10 @@ public:
   typename std::enable_if<type == ParameterType::PARAMETER_DOUBLE, const double &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE) {
-      throw ParameterTypeException(ParameterType::PARAMETER_DOUBLE, get_type());
+    if (type_ != ParameterType::PARAMETER_DOUBLE) {
+      throw ParameterTypeException(ParameterType::PARAMETER_DOUBLE, type_);
     }
-    return value_.double_value;
+    return scalar_.double_value;
   }
 
   template<ParameterType type>
@@ -180,10 +185,10 @@ public:
   typename std::enable_if<type == ParameterType::PARAMETER_STRING, const std::string &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_STRING) {
-      throw ParameterTypeException(ParameterType::PARAMETER_STRING, get_type());
+    if (type_ != ParameterType::PARAMETER_STRING) {
+      throw ParameterTypeException(ParameterType::PARAMETER_STRING, type_);
     }
-    return value_.string_value;
+    return string_;
   }
 
   template<ParameterType type>
@@ -192,10 +197,10 @@ public:
     type == ParameterType::PARAMETER_BYTE_ARRAY, const std::vector<uint8_t> &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_BYTE_ARRAY) {
-      throw ParameterTypeException(ParameterType::PARAMETER_BYTE_ARRAY, get_type());
+    if (type_ != ParameterType::PARAMETER_BYTE_ARRAY) {
+      throw ParameterTypeException(ParameterType::PARAMETER_BYTE_ARRAY, type_);
     }
-    return value_.byte_array_value;
+    return *static_cast<const std::vector<uint8_t> *>(array_.get());
   }
 
   template<ParameterType type>
@@ -204,10 +209,10 @@ public:
     type == ParameterType::PARAMETER_BOOL_ARRAY, const std::vector<bool> &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_BOOL_ARRAY) {
-      throw ParameterTypeException(ParameterType::PARAMETER_BOOL_ARRAY, get_type());
+    if (type_ != ParameterType::PARAMETER_BOOL_ARRAY) {
+      throw ParameterTypeException(ParameterType::PARAMETER_BOOL_ARRAY, type_);
     }
-    return value_.bool_array_value;
+    return *static_cast<const std::vector<bool> *>(array_.get());
   }
 
   template<ParameterType type>
@@ -216,10 +221,10 @@ public:
     type == ParameterType::PARAMETER_INTEGER_ARRAY, const std::vector<int64_t> &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER_ARRAY) {
-      throw ParameterTypeException(ParameterType::PARAMETER_INTEGER_ARRAY, get_type());
+    if (type_ != ParameterType::PARAMETER_INTEGER_ARRAY) {
+      throw ParameterTypeException(ParameterType::PARAMETER_INTEGER_ARRAY, type_);
     }
-    return value_.integer_array_value;
+    return *static_cast<const std::vector<int64_t> *>(array_.get());
   }
 
   template<ParameterType type>
@@ -228,10 +233,10 @@ public:
     type == ParameterType::PARAMETER_DOUBLE_ARRAY, const std::vector<double> &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY) {
-      throw ParameterTypeException(ParameterType::PARAMETER_DOUBLE_ARRAY, get_type());
+    if (type_ != ParameterType::PARAMETER_DOUBLE_ARRAY) {
+      throw ParameterTypeException(ParameterType::PARAMETER_DOUBLE_ARRAY, type_);
     }
-    return value_.double_array_value;
+    return *static_cast<const std::vector<double> *>(array_.get());
   }
 
   template<ParameterType type>
@@ -240,10 +245,10 @@ public:
     type == ParameterType::PARAMETER_STRING_ARRAY, const std::vector<std::string> &>::type
   get() const
   {
-    if (value_.type != rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY) {
-      throw ParameterTypeException(ParameterType::PARAMETER_STRING_ARRAY, get_type());
+    if (type_ != ParameterType::PARAMETER_STRING_ARRAY) {
+      throw ParameterTypeException(ParameterType::PARAMETER_STRING_ARRAY, type_);
     }
-    return value_.string_array_value;
+    return *static_cast<const std::vector<std::string> *>(array_.get());
   }
 
   // The following get() variants allow the use of primitive types
@@ -332,7 +337,21 @@ public:
   }
 
 private:
-  rcl_interfaces::msg::ParameterValue value_;
+  ParameterType type_;
+
+  union Scalar
+  {
+    bool bool_value;
+    int64_t integer_value;
+    double double_value;
+  };
+  Scalar scalar_;
+
+  // Short strings are stored inline by std::string.
+  std::string string_;
+
+  // An array is never modified once constructed, so copies of the value share it.
+  std::shared_ptr<const void> array_;
 };
 
 /// Return the value of a parameter as a string
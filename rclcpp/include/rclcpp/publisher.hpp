@@ -20,23 +20,38 @@
 
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <type_traits>
+#include <typeinfo>
 #include <utility>
+#include <vector>
 
 #include "rcl/error_handling.h"
 #include "rcl/publisher.h"
 
 #include "rclcpp/allocator/allocator_common.hpp"
 #include "rclcpp/allocator/allocator_deleter.hpp"
+#include "rclcpp/detail/loaned_message_pool.hpp"
 #include "rclcpp/detail/resolve_use_intra_process.hpp"
+#include "rclcpp/experimental/async_publish_sender.hpp"
+#include "rclcpp/experimental/async_publisher_queue.hpp"
 #include "rclcpp/experimental/intra_process_manager.hpp"
+#include "rclcpp/experimental/serialized_message.hpp"
 #include "rclcpp/loaned_message.hpp"
+#include "rclcpp/logging.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/message_rate_limiter.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/publisher_base.hpp"
 #include "rclcpp/publisher_options.hpp"
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/tracepoints.hpp"
+#include "rclcpp/type_adapter.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/visibility_control.hpp"
 
@@ -47,15 +62,25 @@ template<typename MessageT, typename AllocatorT>
 class LoanedMessage;
 
 /// A publisher publishes messages of any type to a topic.
+/**
+ * MessageT is either a ROS message type or a TypeAdapter, see rclcpp::TypeAdapter.
+ */
 template<typename MessageT, typename AllocatorT = std::allocator<void>>
 class Publisher : public PublisherBase
 {
 public:
-  using MessageAllocatorTraits = allocator::AllocRebind<MessageT, AllocatorT>;
+  /// Type of the published messages, the custom type if MessageT is adapted.
+  using PublishedType = typename rclcpp::TypeAdapter<MessageT>::custom_type;
+  /// Type of the messages given to the middleware.
+  using ROSMessageType = typename rclcpp::TypeAdapter<MessageT>::ros_message_type;
+  using IsAdapted = typename rclcpp::TypeAdapter<MessageT>::is_specialized;
+
+  using MessageAllocatorTraits = allocator::AllocRebind<PublishedType, AllocatorT>;
   using MessageAllocator = typename MessageAllocatorTraits::allocator_type;
-  using MessageDeleter = allocator::Deleter<MessageAllocator, MessageT>;
-  using MessageUniquePtr = std::unique_ptr<MessageT, MessageDeleter>;
-  using MessageSharedPtr = std::shared_ptr<const MessageT>;
+  using MessageDeleter = allocator::Deleter<MessageAllocator, PublishedType>;
+  using MessageUniquePtr = std::unique_ptr<PublishedType, MessageDeleter>;
+  using MessageSharedPtr = std::shared_ptr<const PublishedType>;
+  using LoanedMessagePool = rclcpp::detail::LoanedMessagePool<MessageT, AllocatorT>;
 
   RCLCPP_SMART_PTR_DEFINITIONS(Publisher<MessageT, AllocatorT>)
 
@@ -67,12 +92,24 @@ public:
   : PublisherBase(
       node_base,
       topic,
-      *rosidl_typesupport_cpp::get_message_type_support_handle<MessageT>(),
-      options.template to_rcl_publisher_options<MessageT>(qos)),
+      *rosidl_typesupport_cpp::get_message_type_support_handle<ROSMessageType>(),
+      options.template to_rcl_publisher_options<ROSMessageType>(qos),
+      options.share_writer,
+      rclcpp::detail::resolve_use_intra_process(options, *node_base)),
     options_(options),
     message_allocator_(new MessageAllocator(*options.get_allocator().get()))
   {
     allocator::set_allocator_for_deleter(&message_deleter_, message_allocator_.get());
+    if (options_.rate_limit.is_enabled()) {
+      rate_limiter_ = std::make_unique<rclcpp::MessageRateLimiter>(options_.rate_limit);
+    }
+    subscription_count_cache_requested_ = options_.cache_subscription_count;
+    middleware_keeps_messages_ =
+      qos.get_rmw_qos_profile().durability == RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL;
+    intra_process_broadcast_depth_ = options_.intra_process_broadcast_depth;
+    if (options_.flight_recorder) {
+      flight_recorder_topic_id_ = options_.flight_recorder->add_topic(this->get_topic_name());
+    }
 
     if (options_.event_callbacks.deadline_callback) {
       this->add_event_handler(
@@ -105,39 +142,59 @@ public:
     (void)topic;
     (void)options;
 
+    if (options_.async_publish.enabled) {
+      auto sender =
+        node_base->get_context()->get_sub_context<rclcpp::experimental::AsyncPublishSender>(
+        *node_base->get_context());
+      async_publisher_queue_ = std::make_shared<AsyncPublisherQueue>(
+        this->shared_from_this(), options_.async_publish);
+      async_publish_sender_ = sender;
+      sender->add_queue(async_publisher_queue_);
+    }
+
     // If needed, setup intra process communication.
     if (rclcpp::detail::resolve_use_intra_process(options_, *node_base)) {
       auto context = node_base->get_context();
       // Get the intra process manager instance for this context.
       auto ipm = context->get_sub_context<rclcpp::experimental::IntraProcessManager>();
       // Register the publisher with the intra process manager.
-      if (qos.get_rmw_qos_profile().history == RMW_QOS_POLICY_HISTORY_KEEP_ALL) {
-        throw std::invalid_argument(
-                "intraprocess communication is not allowed with keep all history qos policy");
-      }
-      if (qos.get_rmw_qos_profile().depth == 0) {
+      if (
+        qos.get_rmw_qos_profile().history != RMW_QOS_POLICY_HISTORY_KEEP_ALL &&
+        qos.get_rmw_qos_profile().depth == 0)
+      {
         throw std::invalid_argument(
                 "intraprocess communication is not allowed with a zero qos history depth value");
       }
-      if (qos.get_rmw_qos_profile().durability != RMW_QOS_POLICY_DURABILITY_VOLATILE) {
+      if (
+        qos.get_rmw_qos_profile().durability != RMW_QOS_POLICY_DURABILITY_VOLATILE &&
+        qos.get_rmw_qos_profile().durability != RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL)
+      {
         throw std::invalid_argument(
-                "intraprocess communication allowed only with volatile durability");
+                "intraprocess communication allowed only with volatile or transient local "
+                "durability");
       }
       uint64_t intra_process_publisher_id = ipm->add_publisher(this->shared_from_this());
       this->setup_intra_process(
         intra_process_publisher_id,
         ipm);
+      intra_process_subscriptions_ = ipm->get_publisher_subscriptions(intra_process_publisher_id);
     }
   }
 
   virtual ~Publisher()
-  {}
+  {
+    if (async_publisher_queue_) {
+      // The sender thread can't lock this publisher anymore, publish what it left queued.
+      async_publisher_queue_->publish_queued(publisher_handle_.get());
+    }
+  }
 
   /// Borrow a loaned ROS message from the middleware.
   /**
    * If the middleware is capable of loaning memory for a ROS message instance,
    * the loaned message will be directly allocated in the middleware.
-   * If not, the message allocator of this rclcpp::Publisher instance is being used.
+   * If not, the message allocator of this rclcpp::Publisher instance is being used, and the
+   * messages are recycled, see PublisherOptionsBase::loaned_message_pool_size.
    *
    * With a call to \sa `publish` the LoanedMessage instance is being returned to the middleware
    * or free'd accordingly to the allocator.
@@ -151,7 +208,16 @@ public:
   rclcpp::LoanedMessage<MessageT, AllocatorT>
   borrow_loaned_message()
   {
-    return rclcpp::LoanedMessage<MessageT, AllocatorT>(this, this->get_allocator());
+    static_assert(!IsAdapted::value, "loaned messages can't be used with an adapted type");
+    if (0u == options_.loaned_message_pool_size) {
+      return rclcpp::LoanedMessage<MessageT, AllocatorT>(this, this->get_allocator());
+    }
+    std::call_once(
+      loaned_message_pool_once_, [this]() {
+        loaned_message_pool_ = std::make_shared<LoanedMessagePool>(
+          options_.loaned_message_pool_size, message_allocator_);
+      });
+    return rclcpp::LoanedMessage<MessageT, AllocatorT>(*this, loaned_message_pool_);
   }
 
   /// Send a message to the topic for this publisher.
@@ -160,69 +226,91 @@ public:
    * \param[in] msg A shared pointer to the message to send.
    */
   virtual void
-  publish(std::unique_ptr<MessageT, MessageDeleter> msg)
+  publish(std::unique_ptr<PublishedType, MessageDeleter> msg)
   {
-    if (!intra_process_is_enabled_) {
-      this->do_inter_process_publish(*msg);
+    if (rate_limiter_ && !rate_limiter_->accept()) {
       return;
     }
-    // If an interprocess subscription exist, then the unique_ptr is promoted
-    // to a shared_ptr and published.
-    // This allows doing the intraprocess publish first and then doing the
-    // interprocess publish, resulting in lower publish-to-subscribe latency.
-    // It's not possible to do that with an unique_ptr,
-    // as do_intra_process_publish takes the ownership of the message.
-    bool inter_process_publish_needed =
-      get_subscription_count() > get_intra_process_subscription_count();
-
-    if (inter_process_publish_needed) {
-      auto shared_msg = this->do_intra_process_publish_and_return_shared(std::move(msg));
-      this->do_inter_process_publish(*shared_msg);
-    } else {
-      this->do_intra_process_publish(std::move(msg));
+    if (msg) {
+      this->record_message(*msg);
     }
+    this->do_publish(std::move(msg));
   }
 
   virtual void
-  publish(const MessageT & msg)
+  publish(const PublishedType & msg)
   {
+    if (rate_limiter_ && !rate_limiter_->accept()) {
+      return;
+    }
+    this->record_message(msg);
     // Avoid allocating when not using intra process.
-    if (!intra_process_is_enabled_) {
+    if (!intra_process_is_enabled_ && !async_publisher_queue_) {
       // In this case we're not using intra process.
       return this->do_inter_process_publish(msg);
     }
     // Otherwise we have to allocate memory in a unique_ptr and pass it along.
     // As the message is not const, a copy should be made.
-    // A shared_ptr<const MessageT> could also be constructed here.
+    // A shared_ptr<const PublishedType> could also be constructed here.
     auto ptr = MessageAllocatorTraits::allocate(*message_allocator_.get(), 1);
     MessageAllocatorTraits::construct(*message_allocator_.get(), ptr, msg);
     MessageUniquePtr unique_msg(ptr, message_deleter_);
-    this->publish(std::move(unique_msg));
+    this->do_publish(std::move(unique_msg));
   }
 
+  /// Publish a serialized message.
+  /**
+   * The intra-process subscriptions taking serialized messages get a copy of it,
+   * the other ones get the message deserialized once.
+   */
   void
   publish(const rcl_serialized_message_t & serialized_msg)
   {
+    if (rate_limiter_ && !rate_limiter_->accept()) {
+      return;
+    }
+    if (options_.flight_recorder) {
+      options_.flight_recorder->record(flight_recorder_topic_id_, serialized_msg);
+    }
     return this->do_serialized_publish(&serialized_msg);
   }
 
+  /// Publish a serialized message, see the overload above.
+  void
+  publish(const rclcpp::SerializedMessage & serialized_msg)
+  {
+    this->publish(serialized_msg.get_rcl_serialized_message());
+  }
+
   /// Publish an instance of a LoanedMessage.
   /**
    * When publishing a loaned message, the memory for this ROS message will be deallocated
    * after being published.
    * The instance of the loaned message is no longer valid after this call.
    *
+   * With intra-process subscriptions, the loaned message is shared with the ones that do not
+   * require ownership and returned to the middleware when the last of them releases it.
+   * The middleware then gets a copy of the message for the inter-process subscriptions.
+   *
+   * A loaned message dropped by the rate limit is not released by this call.
+   *
    * \param loaned_msg The LoanedMessage instance to be published.
    */
   void
   publish(rclcpp::LoanedMessage<MessageT, AllocatorT> && loaned_msg)
   {
+    static_assert(!IsAdapted::value, "loaned messages can't be used with an adapted type");
     if (!loaned_msg.is_valid()) {
       throw std::runtime_error("loaned message is not valid");
     }
-    if (intra_process_is_enabled_) {
-      // TODO(Karsten1987): support loaned message passed by intraprocess
-      throw std::runtime_error("storing loaned messages in intra process is not supported yet");
+    if (rate_limiter_ && !rate_limiter_->accept()) {
+      // The loaned message stays with the caller, which releases it.
+      return;
+    }
+    this->record_message(loaned_msg.get());
+    if (has_intra_process_receivers()) {
+      this->do_loaned_message_intra_process_publish(std::move(loaned_msg));
+      return;
     }
 
     // verify that publisher supports loaned messages
@@ -241,22 +329,212 @@ public:
     }
   }
 
+  /// Send a batch of messages to the topic for this publisher.
+  /**
+   * This is equivalent to publishing the messages one after the other, in order, but the
+   * intra-process subscriptions and the inter-process subscription count are looked up once for
+   * the whole batch, and each intra-process subscription is notified once.
+   *
+   * The iterators may refer either to messages, which are copied when published intra-process,
+   * or to unique pointers to messages, which are moved from.
+   * The messages dropped by the rate limit are skipped.
+   *
+   * \param[in] first iterator to the first message of the batch.
+   * \param[in] last iterator past the last message of the batch.
+   * \throws std::runtime_error if one of the unique pointers is null, no message is published.
+   */
+  template<typename InputIt>
+  void
+  publish_batch(InputIt first, InputIt last)
+  {
+    using ValueT = typename std::iterator_traits<InputIt>::value_type;
+    this->do_publish_batch(first, last, std::is_same<ValueT, MessageUniquePtr>());
+  }
+
   std::shared_ptr<MessageAllocator>
   get_allocator() const
   {
     return message_allocator_;
   }
 
+  /// Return true if the messages are published by the sender thread of the context.
+  /** \sa rclcpp::AsyncPublishOptions */
+  bool
+  is_async_publish_enabled() const
+  {
+    return static_cast<bool>(async_publisher_queue_);
+  }
+
+  /// Return the queue depth, drop count and latency of the asynchronous publishing.
+  /**
+   * \throws std::runtime_error if asynchronous publishing is not enabled.
+   */
+  rclcpp::AsyncPublishStatistics
+  get_async_publish_statistics() const
+  {
+    if (!async_publisher_queue_) {
+      throw std::runtime_error("asynchronous publishing is not enabled for this publisher");
+    }
+    return async_publisher_queue_->get_statistics();
+  }
+
+  const std::type_info &
+  get_intra_process_message_type() const override
+  {
+    return typeid(PublishedType);
+  }
+
+  rclcpp::MemoryUsage
+  get_memory_usage() const override
+  {
+    rclcpp::MemoryUsage usage = PublisherBase::get_memory_usage();
+    usage.entity_bytes = sizeof(*this);
+    return usage;
+  }
+
+  /// Return the number of messages dropped by PublisherOptions::rate_limit.
+  size_t
+  get_rate_limit_dropped_count() const
+  {
+    return rate_limiter_ ? rate_limiter_->get_dropped_count() : 0;
+  }
+
 protected:
+  using AsyncPublisherQueue = rclcpp::experimental::AsyncPublisherQueue<ROSMessageType>;
+
+  /// Return true if the messages are given to intra-process subscriptions, or kept for them.
+  bool
+  has_intra_process_receivers() const
+  {
+    return intra_process_is_enabled_ &&
+           (get_intra_process_subscription_count() > 0 ||
+           intra_process_subscriptions_->get_history_depth() > 0);
+  }
+
+  /// Return true if the messages given intra-process must also be given to the middleware.
+  bool
+  is_inter_process_publish_needed() const
+  {
+    // The middleware keeps the messages of a transient local publisher for other processes.
+    return get_subscription_count() > get_intra_process_subscription_count() ||
+           intra_process_subscriptions_->get_history_depth() > 0;
+  }
+
+  /// Publish a message which was not dropped by the rate limiter.
+  void
+  do_publish(MessageUniquePtr msg)
+  {
+    if (!intra_process_is_enabled_) {
+      if (async_publisher_queue_) {
+        this->do_async_inter_process_publish(MessageSharedPtr(std::move(msg)));
+        return;
+      }
+      this->do_inter_process_publish(*msg);
+      return;
+    }
+    // If an interprocess subscription exist, then the unique_ptr is promoted
+    // to a shared_ptr and published.
+    // This allows doing the intraprocess publish first and then doing the
+    // interprocess publish, resulting in lower publish-to-subscribe latency.
+    // It's not possible to do that with an unique_ptr,
+    // as do_intra_process_publish takes the ownership of the message.
+    bool inter_process_publish_needed = is_inter_process_publish_needed();
+
+    if (msg) {
+      this->do_intra_process_publish_serialized_copy(*msg);
+    }
+    if (inter_process_publish_needed) {
+      auto shared_msg = this->do_intra_process_publish_and_return_shared(std::move(msg));
+      this->do_inter_process_publish(shared_msg);
+    } else {
+      this->do_intra_process_publish(std::move(msg));
+    }
+  }
+
+  /// Publish a message shared with the intra-process subscriptions, queuing it if asynchronous.
+  void
+  do_inter_process_publish(MessageSharedPtr msg)
+  {
+    if (async_publisher_queue_) {
+      this->do_async_inter_process_publish(std::move(msg));
+      return;
+    }
+    this->do_inter_process_publish(*msg);
+  }
+
+  /// Queue a message for the sender thread of the context.
+  void
+  do_async_inter_process_publish(MessageSharedPtr msg)
+  {
+    if (!msg) {
+      throw std::runtime_error("cannot publish msg which is a null pointer");
+    }
+    if (!is_conversion_needed()) {
+      return;
+    }
+    async_publisher_queue_->enqueue(
+      rclcpp::detail::to_shared_ros_message<MessageT>(std::move(msg)));
+    this->notify_async_publish_sender();
+  }
+
+  /// Queue a batch of messages, waking up the sender thread once.
+  void
+  do_async_inter_process_publish_batch(std::vector<MessageUniquePtr> & messages)
+  {
+    if (!is_conversion_needed()) {
+      messages.clear();
+      return;
+    }
+    for (auto & msg : messages) {
+      async_publisher_queue_->enqueue(
+        rclcpp::detail::to_shared_ros_message<MessageT>(MessageSharedPtr(std::move(msg))));
+    }
+    messages.clear();
+    this->notify_async_publish_sender();
+  }
+
+  void
+  notify_async_publish_sender()
+  {
+    auto sender = async_publish_sender_.lock();
+    if (sender) {
+      sender->notify();
+    }
+  }
+
+  /// Return false if an adapted message wouldn't reach any subscription through the middleware.
+  /**
+   * Converting an adapted message may be costly, e.g. copying an image from the memory of a
+   * device to the host, so it is skipped when the middleware has no matched subscription and
+   * doesn't keep the messages for the subscriptions joining later.
+   */
+  bool
+  is_conversion_needed() const
+  {
+    return !IsAdapted::value || middleware_keeps_messages_ || get_subscription_count() > 0;
+  }
+
+  /// Publish a message to the middleware, converting it first if the type is adapted.
+  void
+  do_inter_process_publish(const PublishedType & msg)
+  {
+    if (!is_conversion_needed()) {
+      return;
+    }
+    rclcpp::detail::with_ros_message<MessageT>(
+      msg, [this](const ROSMessageType & ros_msg) {this->do_ros_message_publish(ros_msg);});
+  }
+
   void
-  do_inter_process_publish(const MessageT & msg)
+  do_ros_message_publish(const ROSMessageType & msg)
   {
-    auto status = rcl_publish(&publisher_handle_, &msg, nullptr);
+    RCLCPP_TRACEPOINT(Publish, publisher_handle_.get(), &msg);
+    auto status = rcl_publish(publisher_handle_.get(), &msg, nullptr);
 
     if (RCL_RET_PUBLISHER_INVALID == status) {
       rcl_reset_error();  // next call will reset error message if not context
-      if (rcl_publisher_is_valid_except_context(&publisher_handle_)) {
-        rcl_context_t * context = rcl_publisher_get_context(&publisher_handle_);
+      if (rcl_publisher_is_valid_except_context(publisher_handle_.get())) {
+        rcl_context_t * context = rcl_publisher_get_context(publisher_handle_.get());
         if (nullptr != context && !rcl_context_is_valid(context)) {
           // publisher is invalid due to context being shutdown
           return;
@@ -271,25 +549,30 @@ protected:
   void
   do_serialized_publish(const rcl_serialized_message_t * serialized_msg)
   {
-    if (intra_process_is_enabled_) {
-      // TODO(Karsten1987): support serialized message passed by intraprocess
-      throw std::runtime_error("storing serialized messages in intra process is not supported yet");
+    if (has_intra_process_receivers()) {
+      bool inter_process_publish_needed = is_inter_process_publish_needed();
+      this->do_serialized_intra_process_publish(*serialized_msg);
+      if (!inter_process_publish_needed) {
+        return;
+      }
     }
-    auto status = rcl_publish_serialized_message(&publisher_handle_, serialized_msg, nullptr);
+    RCLCPP_TRACEPOINT(Publish, publisher_handle_.get(), serialized_msg);
+    auto status = rcl_publish_serialized_message(publisher_handle_.get(), serialized_msg, nullptr);
     if (RCL_RET_OK != status) {
       rclcpp::exceptions::throw_from_rcl_error(status, "failed to publish serialized message");
     }
   }
 
   void
-  do_loaned_message_publish(MessageT * msg)
+  do_loaned_message_publish(ROSMessageType * msg)
   {
-    auto status = rcl_publish_loaned_message(&publisher_handle_, msg, nullptr);
+    RCLCPP_TRACEPOINT(Publish, publisher_handle_.get(), msg);
+    auto status = rcl_publish_loaned_message(publisher_handle_.get(), msg, nullptr);
 
     if (RCL_RET_PUBLISHER_INVALID == status) {
       rcl_reset_error();  // next call will reset error message if not context
-      if (rcl_publisher_is_valid_except_context(&publisher_handle_)) {
-        rcl_context_t * context = rcl_publisher_get_context(&publisher_handle_);
+      if (rcl_publisher_is_valid_except_context(publisher_handle_.get())) {
+        rcl_context_t * context = rcl_publisher_get_context(publisher_handle_.get());
         if (nullptr != context && !rcl_context_is_valid(context)) {
           // publisher is invalid due to context being shutdown
           return;
@@ -302,7 +585,7 @@ protected:
   }
 
   void
-  do_intra_process_publish(std::unique_ptr<MessageT, MessageDeleter> msg)
+  do_intra_process_publish(std::unique_ptr<PublishedType, MessageDeleter> msg)
   {
     auto ipm = weak_ipm_.lock();
     if (!ipm) {
@@ -312,15 +595,247 @@ protected:
     if (!msg) {
       throw std::runtime_error("cannot publish msg which is a null pointer");
     }
+    RCLCPP_TRACEPOINT(IntraProcessPublish, publisher_handle_.get(), msg.get());
 
-    ipm->template do_intra_process_publish<MessageT, AllocatorT>(
-      intra_process_publisher_id_,
+    ipm->template do_intra_process_publish<PublishedType, AllocatorT>(
+      *intra_process_subscriptions_,
       std::move(msg),
       message_allocator_);
   }
 
-  std::shared_ptr<const MessageT>
-  do_intra_process_publish_and_return_shared(std::unique_ptr<MessageT, MessageDeleter> msg)
+  /// Publish a batch of messages, see publish_batch().
+  template<typename InputIt>
+  void
+  do_publish_batch(InputIt first, InputIt last, std::false_type)
+  {
+    if (!intra_process_is_enabled_ && !async_publisher_queue_) {
+      for (; first != last; ++first) {
+        if (!rate_limiter_ || rate_limiter_->accept()) {
+          this->record_message(*first);
+          this->do_inter_process_publish(*first);
+        }
+      }
+      return;
+    }
+    std::vector<MessageUniquePtr> messages;
+    for (; first != last; ++first) {
+      if (rate_limiter_ && !rate_limiter_->accept()) {
+        continue;
+      }
+      this->record_message(*first);
+      auto ptr = MessageAllocatorTraits::allocate(*message_allocator_.get(), 1);
+      MessageAllocatorTraits::construct(*message_allocator_.get(), ptr, *first);
+      messages.emplace_back(ptr, message_deleter_);
+    }
+    if (!intra_process_is_enabled_) {
+      this->do_async_inter_process_publish_batch(messages);
+      return;
+    }
+    this->do_intra_process_publish_batch(messages);
+  }
+
+  /// Publish a batch of unique pointers to messages, see publish_batch().
+  template<typename InputIt>
+  void
+  do_publish_batch(InputIt first, InputIt last, std::true_type)
+  {
+    std::vector<MessageUniquePtr> messages;
+    for (; first != last; ++first) {
+      if (!rate_limiter_ || rate_limiter_->accept()) {
+        if (*first) {
+          this->record_message(**first);
+        }
+        messages.push_back(std::move(*first));
+      }
+    }
+    if (!intra_process_is_enabled_) {
+      for (auto & msg : messages) {
+        if (!msg) {
+          throw std::runtime_error("cannot publish msg which is a null pointer");
+        }
+      }
+      if (async_publisher_queue_) {
+        this->do_async_inter_process_publish_batch(messages);
+        return;
+      }
+      for (auto & msg : messages) {
+        this->do_inter_process_publish(*msg);
+      }
+      return;
+    }
+    this->do_intra_process_publish_batch(messages);
+  }
+
+  /// Copy the message serialized into PublisherOptions::flight_recorder, if it is set.
+  void
+  record_message(const PublishedType & msg)
+  {
+    if (!options_.flight_recorder) {
+      return;
+    }
+    // Reused by the publishers of the thread, so that recording doesn't allocate once warm.
+    thread_local rclcpp::SerializedMessage serialized_msg;
+    static const rclcpp::Serialization<MessageT> serialization;
+    serialization.serialize(msg, serialized_msg);
+    options_.flight_recorder->record(
+      flight_recorder_topic_id_, serialized_msg.get_rcl_serialized_message());
+  }
+
+  void
+  do_intra_process_publish_batch(std::vector<MessageUniquePtr> & messages)
+  {
+    auto ipm = weak_ipm_.lock();
+    if (!ipm) {
+      throw std::runtime_error(
+              "intra process publish called after destruction of intra process manager");
+    }
+    for (auto & msg : messages) {
+      if (!msg) {
+        throw std::runtime_error("cannot publish msg which is a null pointer");
+      }
+      RCLCPP_TRACEPOINT(IntraProcessPublish, publisher_handle_.get(), msg.get());
+    }
+    bool inter_process_publish_needed = is_inter_process_publish_needed();
+
+    for (auto & msg : messages) {
+      this->do_intra_process_publish_serialized_copy(*msg);
+    }
+    if (inter_process_publish_needed) {
+      std::vector<MessageSharedPtr> shared_messages;
+      shared_messages.reserve(messages.size());
+      ipm->template do_intra_process_publish_batch<PublishedType, AllocatorT>(
+        *intra_process_subscriptions_,
+        messages,
+        message_allocator_,
+        &shared_messages);
+      if (async_publisher_queue_) {
+        for (auto & shared_msg : shared_messages) {
+          async_publisher_queue_->enqueue(
+            rclcpp::detail::to_shared_ros_message<MessageT>(std::move(shared_msg)));
+        }
+        this->notify_async_publish_sender();
+        return;
+      }
+      for (auto & shared_msg : shared_messages) {
+        this->do_inter_process_publish(*shared_msg);
+      }
+    } else {
+      ipm->template do_intra_process_publish_batch<PublishedType, AllocatorT>(
+        *intra_process_subscriptions_,
+        messages,
+        message_allocator_);
+    }
+  }
+
+  void
+  do_loaned_message_intra_process_publish(
+    rclcpp::LoanedMessage<MessageT, AllocatorT> && loaned_msg)
+  {
+    if (!this->can_loan_messages()) {
+      // The message was allocated with the allocator of this publisher.
+      this->do_publish(MessageUniquePtr(loaned_msg.release(), message_deleter_));
+      return;
+    }
+
+    auto ipm = weak_ipm_.lock();
+    if (!ipm) {
+      throw std::runtime_error(
+              "intra process publish called after destruction of intra process manager");
+    }
+    bool inter_process_publish_needed = is_inter_process_publish_needed();
+
+    this->do_intra_process_publish_serialized_copy(loaned_msg.get());
+
+    // The loan belongs to this publisher, keep it alive until the loan is returned.
+    auto publisher = this->shared_from_this();
+    MessageSharedPtr shared_msg(
+      loaned_msg.release(),
+      [publisher](const PublishedType * msg) {
+        auto ret = rcl_return_loaned_message_from_publisher(
+          publisher->get_publisher_handle(), const_cast<PublishedType *>(msg));
+        if (RCL_RET_OK != ret) {
+          RCLCPP_ERROR(
+            rclcpp::get_logger("rclcpp"),
+            "rcl_return_loaned_message_from_publisher failed: %s", rcl_get_error_string().str);
+          rcl_reset_error();
+        }
+      });
+
+    RCLCPP_TRACEPOINT(IntraProcessPublish, publisher_handle_.get(), shared_msg.get());
+    ipm->template do_intra_process_publish_shared<PublishedType, AllocatorT>(
+      *intra_process_subscriptions_,
+      shared_msg,
+      message_allocator_,
+      message_deleter_);
+
+    if (inter_process_publish_needed) {
+      // The local subscriptions may still hold the loan, so it can't be published as loaned.
+      this->do_inter_process_publish(*shared_msg);
+    }
+  }
+
+  /// Serialize the message once for the intra-process subscriptions taking serialized messages.
+  void
+  do_intra_process_publish_serialized_copy(const PublishedType & msg)
+  {
+    if (intra_process_subscriptions_->load()->serialized_subscriptions.empty()) {
+      return;
+    }
+    auto ipm = weak_ipm_.lock();
+    if (!ipm) {
+      throw std::runtime_error(
+              "intra process publish called after destruction of intra process manager");
+    }
+
+    auto serialized_msg = rclcpp::experimental::create_serialized_message(0);
+    rclcpp::detail::with_ros_message<MessageT>(
+      msg, [&serialized_msg](const ROSMessageType & ros_msg) {
+        auto ret = rmw_serialize(
+          &ros_msg,
+          rosidl_typesupport_cpp::get_message_type_support_handle<ROSMessageType>(),
+          serialized_msg.get());
+        if (RMW_RET_OK != ret) {
+          rclcpp::exceptions::throw_from_rcl_error(ret, "failed to serialize message");
+        }
+      });
+    ipm->do_intra_process_publish_serialized(
+      *intra_process_subscriptions_, std::move(serialized_msg));
+  }
+
+  /// Give a serialized message to the intra-process subscriptions.
+  void
+  do_serialized_intra_process_publish(const rcl_serialized_message_t & serialized_msg)
+  {
+    auto ipm = weak_ipm_.lock();
+    if (!ipm) {
+      throw std::runtime_error(
+              "intra process publish called after destruction of intra process manager");
+    }
+    auto subscriptions = intra_process_subscriptions_->load();
+
+    if (
+      !subscriptions->all_subscriptions.empty() ||
+      intra_process_subscriptions_->get_history_depth() > 0)
+    {
+      // Deserialize the message once for all the other subscriptions.
+      auto ptr = MessageAllocatorTraits::allocate(*message_allocator_.get(), 1);
+      MessageAllocatorTraits::construct(*message_allocator_.get(), ptr);
+      MessageUniquePtr msg(ptr, message_deleter_);
+      this->deserialize_message(serialized_msg, *msg, IsAdapted());
+      ipm->template do_intra_process_publish<PublishedType, AllocatorT>(
+        *intra_process_subscriptions_,
+        std::move(msg),
+        message_allocator_);
+    }
+    if (!subscriptions->serialized_subscriptions.empty()) {
+      ipm->do_intra_process_publish_serialized(
+        *intra_process_subscriptions_,
+        rclcpp::experimental::copy_serialized_message(serialized_msg));
+    }
+  }
+
+  MessageSharedPtr
+  do_intra_process_publish_and_return_shared(std::unique_ptr<PublishedType, MessageDeleter> msg)
   {
     auto ipm = weak_ipm_.lock();
     if (!ipm) {
@@ -330,13 +845,36 @@ protected:
     if (!msg) {
       throw std::runtime_error("cannot publish msg which is a null pointer");
     }
+    RCLCPP_TRACEPOINT(IntraProcessPublish, publisher_handle_.get(), msg.get());
 
-    return ipm->template do_intra_process_publish_and_return_shared<MessageT, AllocatorT>(
-      intra_process_publisher_id_,
+    return ipm->template do_intra_process_publish_and_return_shared<PublishedType, AllocatorT>(
+      *intra_process_subscriptions_,
       std::move(msg),
       message_allocator_);
   }
 
+  void
+  deserialize_message(
+    const rcl_serialized_message_t & serialized_msg, ROSMessageType & msg, std::false_type)
+  {
+    auto ret = rmw_deserialize(
+      &serialized_msg,
+      rosidl_typesupport_cpp::get_message_type_support_handle<ROSMessageType>(),
+      &msg);
+    if (RMW_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to deserialize message");
+    }
+  }
+
+  void
+  deserialize_message(
+    const rcl_serialized_message_t & serialized_msg, PublishedType & msg, std::true_type)
+  {
+    ROSMessageType ros_msg;
+    this->deserialize_message(serialized_msg, ros_msg, std::false_type());
+    rclcpp::TypeAdapter<MessageT>::convert_to_custom(ros_msg, msg);
+  }
+
   /// Copy of original options passed during construction.
   /**
    * It is important to save a copy of this so that the rmw payload which it
@@ -347,6 +885,28 @@ protected:
   std::shared_ptr<MessageAllocator> message_allocator_;
 
   MessageDeleter message_deleter_;
+
+  /// Handle to the intra-process subscriptions, so publishing does not look them up.
+  rclcpp::experimental::IntraProcessManager::PublisherSubscriptions::SharedPtr
+    intra_process_subscriptions_;
+
+  /// Queue of the messages waiting for the sender thread, null if publishing synchronously.
+  std::shared_ptr<AsyncPublisherQueue> async_publisher_queue_;
+
+  std::weak_ptr<rclcpp::experimental::AsyncPublishSender> async_publish_sender_;
+
+  /// Drops the messages according to PublisherOptions::rate_limit, null if it is disabled.
+  std::unique_ptr<rclcpp::MessageRateLimiter> rate_limiter_;
+
+  /// Id of the topic in PublisherOptions::flight_recorder.
+  size_t flight_recorder_topic_id_ = 0;
+
+  /// True if the QoS is transient local, the middleware then publishes without subscription.
+  bool middleware_keeps_messages_ = false;
+
+  /// Messages recycled by borrow_loaned_message(), created by its first call.
+  std::shared_ptr<LoanedMessagePool> loaned_message_pool_;
+  std::once_flag loaned_message_pool_once_;
 };
 
 }  // namespace rclcpp
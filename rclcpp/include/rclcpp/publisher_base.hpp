@@ -18,16 +18,21 @@
 #include <rmw/error_handling.h>
 #include <rmw/rmw.h>
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <typeinfo>
 #include <vector>
 
 #include "rcl/publisher.h"
 
+#include "rclcpp/event.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/memory_usage.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/qos_event.hpp"
 #include "rclcpp/type_support_decl.hpp"
@@ -50,6 +55,7 @@ namespace experimental
  * `intra_process_manager.hpp` and `publisher_base.hpp`.
  */
 class IntraProcessManager;
+class SharedWriterManager;
 }  // namespace experimental
 
 class PublisherBase : public std::enable_shared_from_this<PublisherBase>
@@ -67,13 +73,19 @@ public:
    * \param[in] topic The topic that this publisher publishes on.
    * \param[in] type_support The type support structure for the type to be published.
    * \param[in] publisher_options QoS settings for this publisher.
+   * \param[in] share_writer is true to share the rcl publisher with the identical publishers of
+   *   the context, see PublisherOptionsBase::share_writer.
+   * \param[in] use_intra_process is true if the publisher will be set up for intra-process
+   *   communication, a writer is only shared by publishers with the same setting.
    */
   RCLCPP_PUBLIC
   PublisherBase(
     rclcpp::node_interfaces::NodeBaseInterface * node_base,
     const std::string & topic,
     const rosidl_message_type_support_t & type_support,
-    const rcl_publisher_options_t & publisher_options);
+    const rcl_publisher_options_t & publisher_options,
+    bool share_writer = false,
+    bool use_intra_process = false);
 
   RCLCPP_PUBLIC
   virtual ~PublisherBase();
@@ -91,7 +103,10 @@ public:
   get_queue_size() const;
 
   /// Get the global identifier for this publisher (used in rmw and by DDS).
-  /** \return The gid. */
+  /**
+   * The publishers sharing an rcl publisher have the same gid, see has_shared_writer().
+   * \return The gid.
+   */
   RCLCPP_PUBLIC
   const rmw_gid_t &
   get_gid() const;
@@ -108,6 +123,12 @@ public:
   const rcl_publisher_t *
   get_publisher_handle() const;
 
+  /// Return true if the rcl publisher is shared with other publishers of the context.
+  /** \sa PublisherOptionsBase::share_writer */
+  RCLCPP_PUBLIC
+  bool
+  has_shared_writer() const;
+
   /// Get all the QoS event handlers associated with this publisher.
   /** \return The vector of QoS event handlers. */
   RCLCPP_PUBLIC
@@ -115,17 +136,59 @@ public:
   get_event_handlers() const;
 
   /// Get subscription count
-  /** \return The number of subscriptions. */
+  /**
+   * Once the subscription count is cached, see enable_subscription_count_cache(), this is an
+   * atomic read, except shortly after a change of the graph.
+   *
+   * \return The number of subscriptions.
+   */
   RCLCPP_PUBLIC
   size_t
   get_subscription_count() const;
 
   /// Get intraprocess subscription count
-  /** \return The number of intraprocess subscriptions. */
+  /**
+   * This is an atomic read, which doesn't lock the intra-process manager.
+   *
+   * \return The number of intraprocess subscriptions.
+   */
   RCLCPP_PUBLIC
   size_t
   get_intra_process_subscription_count() const;
 
+  /// Get the number of intraprocess subscriptions whose buffer is full.
+  /**
+   * A publisher can throttle itself while it is not 0, instead of having its messages dropped,
+   * see SubscriptionOptionsBase::intra_process_backpressure.
+   *
+   * \return The number of full intraprocess subscriptions.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_full_intra_process_subscription_count() const;
+
+  /// Return true if PublisherOptions::cache_subscription_count was set for this publisher.
+  RCLCPP_PUBLIC
+  bool
+  is_subscription_count_cache_requested() const;
+
+  /// Return PublisherOptions::intra_process_broadcast_depth of this publisher.
+  RCLCPP_PUBLIC
+  size_t
+  get_intra_process_broadcast_depth() const;
+
+  /// Cache the subscription count, refreshing it when the graph changes.
+  /**
+   * The count is queried from the middleware again when the event is set, and during a short
+   * period after it, since the matching with the new subscriptions may complete later.
+   * This is called by the node creating the publisher, before it is used.
+   *
+   * \param[in] graph_event event of the node graph, set by the graph listener on any change.
+   */
+  RCLCPP_PUBLIC
+  void
+  enable_subscription_count_cache(rclcpp::Event::SharedPtr graph_event);
+
   /// Manually assert that this Publisher is alive (for RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC).
   /**
    * If the rmw Liveliness policy is set to RMW_QOS_POLICY_LIVELINESS_MANUAL_BY_TOPIC, the creator
@@ -183,6 +246,20 @@ public:
   bool
   operator==(const rmw_gid_t * gid) const;
 
+  /// Return the type of the messages given to the intra-process subscriptions.
+  /**
+   * It is the custom type if the message type is adapted, see rclcpp::TypeAdapter.
+   */
+  virtual
+  const std::type_info &
+  get_intra_process_message_type() const = 0;
+
+  /// Return the bytes used by the publisher, see rclcpp::MemoryUsage.
+  RCLCPP_PUBLIC
+  virtual
+  rclcpp::MemoryUsage
+  get_memory_usage() const;
+
   using IntraProcessManagerSharedPtr =
     std::shared_ptr<rclcpp::experimental::IntraProcessManager>;
 
@@ -203,14 +280,16 @@ protected:
     auto handler = std::make_shared<QOSEventHandler<EventCallbackT>>(
       callback,
       rcl_publisher_event_init,
-      &publisher_handle_,
+      publisher_handle_.get(),
       event_type);
     event_handlers_.emplace_back(handler);
   }
 
   std::shared_ptr<rcl_node_t> rcl_node_handle_;
 
-  rcl_publisher_t publisher_handle_ = rcl_get_zero_initialized_publisher();
+  std::shared_ptr<rcl_publisher_t> publisher_handle_;
+  /// Manager of the shared rcl publisher, null if it isn't shared.
+  std::shared_ptr<rclcpp::experimental::SharedWriterManager> shared_writer_manager_;
 
   std::vector<std::shared_ptr<rclcpp::QOSEventHandlerBase>> event_handlers_;
 
@@ -219,6 +298,17 @@ protected:
   bool intra_process_is_enabled_;
   IntraProcessManagerWeakPtr weak_ipm_;
   uint64_t intra_process_publisher_id_;
+  /// Count of the intra-process subscriptions, kept up to date by the manager.
+  std::shared_ptr<const std::atomic<size_t>> intra_process_subscription_count_;
+
+  /// Set by the typed publisher from its options.
+  bool subscription_count_cache_requested_ = false;
+  size_t intra_process_broadcast_depth_ = 0;
+  /// Graph event refreshing the cached subscription count, null if it isn't cached.
+  rclcpp::Event::SharedPtr graph_event_;
+  mutable std::atomic<size_t> cached_subscription_count_;
+  /// Steady time until which the count is queried, `INT64_MIN` once it settled.
+  mutable std::atomic<int64_t> subscription_count_settle_deadline_ns_;
 
   rmw_gid_t rmw_gid_;
 };
@@ -23,6 +23,7 @@
 
 #include "rosidl_typesupport_cpp/message_type_support.hpp"
 
+#include "rclcpp/detail/make_entity_shared.hpp"
 #include "rclcpp/publisher.hpp"
 #include "rclcpp/publisher_base.hpp"
 #include "rclcpp/publisher_options.hpp"
@@ -73,7 +74,8 @@ create_publisher_factory(const rclcpp::PublisherOptionsWithAllocator<AllocatorT>
       const rclcpp::QoS & qos
     ) -> std::shared_ptr<PublisherT>
     {
-      auto publisher = std::make_shared<PublisherT>(node_base, topic_name, qos, options);
+      auto publisher = rclcpp::detail::make_entity_shared<PublisherT>(
+        node_base->get_entity_arena(), node_base, topic_name, qos, options);
       // This is used for setting up things like intra process comms which
       // require this->shared_from_this() which cannot be called from
       // the constructor.
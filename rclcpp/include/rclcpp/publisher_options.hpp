@@ -22,8 +22,11 @@
 #include "rcl/publisher.h"
 
 #include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/async_publish_options.hpp"
 #include "rclcpp/detail/rmw_implementation_specific_publisher_payload.hpp"
+#include "rclcpp/experimental/flight_recorder.hpp"
 #include "rclcpp/intra_process_setting.hpp"
+#include "rclcpp/message_rate_limiter.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/qos_event.hpp"
 
@@ -50,6 +53,68 @@ struct PublisherOptionsBase
   /// Optional RMW implementation specific payload to be used during creation of the publisher.
   std::shared_ptr<rclcpp::detail::RMWImplementationSpecificPublisherPayload>
   rmw_implementation_payload = nullptr;
+
+  /// Setting to publish the messages from a thread of the context, disabled by default.
+  AsyncPublishOptions async_publish;
+
+  /// Downsampling of the published messages, disabled by default.
+  /**
+   * The dropped messages are neither serialized nor given to the intra-process subscriptions.
+   */
+  MessageRateLimitOptions rate_limit;
+
+  /// Recording of the published messages, none by default.
+  /**
+   * The messages are serialized and copied into the recorder as they are published, the
+   * messages dropped by rate_limit are not recorded.
+   * \sa rclcpp::experimental::FlightRecorder
+   */
+  std::shared_ptr<rclcpp::experimental::FlightRecorder> flight_recorder;
+
+  /// Setting to cache the subscription count, refreshed on the changes of the graph.
+  /**
+   * It suits publishers checking get_subscription_count() before each publish, the count is
+   * most of the time read without calling the middleware.
+   * This registers a graph event for the node, so the graph listener thread gets started.
+   */
+  bool cache_subscription_count = false;
+
+  /// True to share the middleware writer with the identical publishers of the context.
+  /**
+   * The publishers of a context created with this option, on the same topic with the same
+   * message type, QoS and intra-process setting, share one rcl publisher, e.g. the many
+   * publishers of /tf or /diagnostics in a process.
+   * They then have the same gid, and the middleware counts them as one publisher:
+   * Node::count_publishers() adds the publishers sharing a writer of the context, see
+   * rclcpp::experimental::SharedWriterManager.
+   * The QoS event callbacks of each publisher are called for the shared writer.
+   */
+  bool share_writer = false;
+
+  /// Number of messages of the ring read by the intra-process subscriptions, 0 to not use one.
+  /**
+   * The messages are written once in a ring of the publisher, from which each subscription
+   * taking shared messages reads them with its own cursor, instead of being given to the
+   * buffer of each subscription, so the cost of publishing doesn't grow with the number of
+   * these subscriptions.
+   * It applies to the subscriptions with a keep last QoS of a depth up to this one, using the
+   * default ring buffer, without rate limit nor synchronous delivery; the other subscriptions
+   * are given the messages as before.
+   * The ring holds the last messages published until they are overwritten, after they were
+   * read.
+   * \sa rclcpp::experimental::buffers::BroadcastRingBuffer
+   */
+  size_t intra_process_broadcast_depth = 0;
+
+  /// Number of messages recycled by borrow_loaned_message() if the middleware can't loan.
+  /**
+   * The loaned messages are then allocated with the allocator of the publisher, and given back
+   * to a pool of this size once published or destroyed, so that code written against the loan
+   * API doesn't allocate in steady state with any middleware.
+   * The messages given to the intra-process subscriptions leave the pool.
+   * 0 to allocate and destroy each loaned message.
+   */
+  size_t loaned_message_pool_size = 1;
 };
 
 /// Structure containing optional configuration for Publishers.
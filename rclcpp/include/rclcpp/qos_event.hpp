@@ -15,6 +15,7 @@
 #ifndef RCLCPP__QOS_EVENT_HPP_
 #define RCLCPP__QOS_EVENT_HPP_
 
+#include <cstddef>
 #include <functional>
 #include <string>
 
@@ -37,6 +38,15 @@ using QOSLivelinessLostInfo = rmw_liveliness_lost_status_t;
 using QOSOfferedIncompatibleQoSInfo = rmw_offered_qos_incompatible_event_status_t;
 using QOSRequestedIncompatibleQoSInfo = rmw_requested_qos_incompatible_event_status_t;
 
+/// Status of the messages dropped by the intra-process buffer of a subscription, when full.
+struct QOSIntraProcessMessageLostInfo
+{
+  /// Number of messages dropped since the subscription was created.
+  size_t total_count;
+  /// Number of messages dropped since the last time the callback was called.
+  size_t total_count_change;
+};
+
 using QOSDeadlineRequestedCallbackType = std::function<void (QOSDeadlineRequestedInfo &)>;
 using QOSDeadlineOfferedCallbackType = std::function<void (QOSDeadlineOfferedInfo &)>;
 using QOSLivelinessChangedCallbackType = std::function<void (QOSLivelinessChangedInfo &)>;
@@ -44,6 +54,8 @@ using QOSLivelinessLostCallbackType = std::function<void (QOSLivelinessLostInfo
 using QOSOfferedIncompatibleQoSCallbackType = std::function<void (QOSOfferedIncompatibleQoSInfo &)>;
 using QOSRequestedIncompatibleQoSCallbackType =
   std::function<void (QOSRequestedIncompatibleQoSInfo &)>;
+using QOSIntraProcessMessageLostCallbackType =
+  std::function<void (QOSIntraProcessMessageLostInfo &)>;
 
 /// Contains callbacks for various types of events a Publisher can receive from the middleware.
 struct PublisherEventCallbacks
@@ -59,6 +71,12 @@ struct SubscriptionEventCallbacks
   QOSDeadlineRequestedCallbackType deadline_callback;
   QOSLivelinessChangedCallbackType liveliness_callback;
   QOSRequestedIncompatibleQoSCallbackType incompatible_qos_callback;
+  /// Called by the executor when the intra-process buffer dropped messages because it was full.
+  /**
+   * It is called before executing the subscription, so at the latest with the next message.
+   * The messages dropped by SubscriptionOptionsBase::rate_limit are not reported.
+   */
+  QOSIntraProcessMessageLostCallbackType intra_process_message_lost_callback;
 };
 
 class UnsupportedEventTypeException : public exceptions::RCLErrorBase, public std::runtime_error
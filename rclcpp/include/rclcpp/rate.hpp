@@ -17,9 +17,13 @@
 
 #include <chrono>
 #include <memory>
+#include <stdexcept>
 #include <thread>
 
+#include "rclcpp/clock.hpp"
+#include "rclcpp/duration.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/time.hpp"
 #include "rclcpp/utilities.hpp"
 #include "rclcpp/visibility_control.hpp"
 
@@ -51,7 +55,7 @@ public:
       duration_cast<nanoseconds>(duration<double>(1.0 / rate)))
   {}
   explicit GenericRate(std::chrono::nanoseconds period)
-  : period_(period), last_interval_(Clock::now())
+  : period_(period), last_interval_(Clock::now()), spin_threshold_(0)
   {}
 
   virtual bool
@@ -82,7 +86,17 @@ public:
       return false;
     }
     // Sleep (will get interrupted by ctrl-c, may not sleep full time)
-    rclcpp::sleep_for(time_to_sleep);
+    if (time_to_sleep > spin_threshold_) {
+      rclcpp::sleep_for(time_to_sleep - spin_threshold_);
+    }
+    // Spin for the rest, since the sleep may end late by the granularity of the OS,
+    // unless the sleep was interrupted early
+    if (spin_threshold_ > std::chrono::nanoseconds::zero() &&
+      next_interval - Clock::now() <= spin_threshold_)
+    {
+      while (Clock::now() < next_interval) {
+      }
+    }
     return true;
   }
 
@@ -103,17 +117,113 @@ public:
     return period_;
   }
 
+  /// Set the time spent spinning at the end of each sleep, instead of sleeping, 0 by default.
+  /**
+   * sleep() then sleeps until `spin_threshold` before the next interval, and spins on the clock
+   * for the remaining time, which reduces the jitter of the loop to much less than the sleep
+   * granularity of the OS, at the cost of a busy core for `spin_threshold` every period.
+   */
+  void set_spin_threshold(std::chrono::nanoseconds spin_threshold)
+  {
+    spin_threshold_ = spin_threshold;
+  }
+
+  std::chrono::nanoseconds spin_threshold() const
+  {
+    return spin_threshold_;
+  }
+
 private:
   RCLCPP_DISABLE_COPY(GenericRate)
 
   std::chrono::nanoseconds period_;
   using ClockDurationNano = std::chrono::duration<typename Clock::rep, std::nano>;
   std::chrono::time_point<Clock, ClockDurationNano> last_interval_;
+  std::chrono::nanoseconds spin_threshold_;
 };
 
 using Rate = GenericRate<std::chrono::system_clock>;
 using WallRate = GenericRate<std::chrono::steady_clock>;
 
+/// Rate on the time of an rclcpp::Clock, e.g. a ROS clock following the simulated time.
+/**
+ * sleep() sleeps with Clock::sleep_until(), so with the ROS time override it waits for the
+ * updates of the ROS time instead of polling it, and returns early on shutdown.
+ */
+class ClockRate : public RateBase
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(ClockRate)
+
+  /// \throws std::invalid_argument if clock is nullptr.
+  explicit ClockRate(
+    double rate, Clock::SharedPtr clock = std::make_shared<Clock>(RCL_ROS_TIME))
+  : ClockRate(Duration::from_seconds(1.0 / rate), clock)
+  {}
+
+  /// \throws std::invalid_argument if clock is nullptr.
+  explicit ClockRate(
+    const Duration & period, Clock::SharedPtr clock = std::make_shared<Clock>(RCL_ROS_TIME))
+  : clock_(clock ? clock : throw std::invalid_argument("clock is nullptr")),
+    period_(period), last_interval_(clock_->now())
+  {}
+
+  /// Sleep until the next interval, see GenericRate::sleep().
+  /**
+   * \return true if the next interval was reached, false if it was already passed or if the
+   * default context was shutdown during the sleep.
+   * \throws anything Clock::sleep_until() can throw.
+   */
+  virtual bool
+  sleep()
+  {
+    Time now = clock_->now();
+    Time next_interval = last_interval_ + period_;
+    // Detect backwards time flow, e.g. a restarted simulation
+    if (now < last_interval_) {
+      next_interval = now + period_;
+    }
+    last_interval_ += period_;
+    if (next_interval <= now) {
+      // If an entire cycle was missed then reset next interval.
+      if (now > next_interval + period_) {
+        last_interval_ = now + period_;
+      }
+      return false;
+    }
+    return clock_->sleep_until(next_interval);
+  }
+
+  virtual bool
+  is_steady() const
+  {
+    return RCL_STEADY_TIME == clock_->get_clock_type();
+  }
+
+  virtual void
+  reset()
+  {
+    last_interval_ = clock_->now();
+  }
+
+  Duration period() const
+  {
+    return period_;
+  }
+
+  Clock::SharedPtr get_clock() const
+  {
+    return clock_;
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(ClockRate)
+
+  Clock::SharedPtr clock_;
+  Duration period_;
+  Time last_interval_;
+};
+
 }  // namespace rclcpp
 
 #endif  // RCLCPP__RATE_HPP_
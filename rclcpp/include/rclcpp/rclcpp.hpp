@@ -28,7 +28,9 @@
  * - Subscription
  *   - rclcpp::Node::create_subscription()
  *   - rclcpp::Subscription
+ *   - rclcpp::MessageInfo
  *   - rclcpp/subscription.hpp
+ *   - rclcpp/message_info.hpp
  * - Service Client
  *   - rclcpp::Node::create_client()
  *   - rclcpp::Client
@@ -42,6 +44,11 @@
  *   - rclcpp::WallTimer
  *   - rclcpp::TimerBase
  *   - rclcpp/timer.hpp
+ * - Coroutines awaiting responses and timers, with C++20:
+ *   - rclcpp::Task
+ *   - rclcpp::await_response()
+ *   - rclcpp::await_sleep_for()
+ *   - rclcpp/coroutine.hpp
  * - Parameters:
  *   - rclcpp::Node::set_parameters()
  *   - rclcpp::Node::get_parameters()
@@ -79,6 +86,14 @@
  *   - rclcpp/executors.hpp
  *   - rclcpp/executors/single_threaded_executor.hpp
  *   - rclcpp/executors/multi_threaded_executor.hpp
+ * - Wait sets (waiting for chosen entities without an executor):
+ *   - rclcpp::WaitSet
+ *   - rclcpp::StaticWaitSet
+ *   - rclcpp::ThreadSafeWaitSet
+ *   - rclcpp/wait_set.hpp
+ * - File descriptors (a waitable executing a callback when a file descriptor is readable):
+ *   - rclcpp::FdWaitable
+ *   - rclcpp/fd_waitable.hpp
  * - CallbackGroups (mechanism for enforcing concurrency rules for callbacks):
  *   - rclcpp::Node::create_callback_group()
  *   - rclcpp::callback_group::CallbackGroup
@@ -117,12 +132,50 @@
  * - Allocator related items:
  *   - rclcpp/allocator/allocator_common.hpp
  *   - rclcpp/allocator/allocator_deleter.hpp
+ *   - rclcpp/allocator/arena_allocator.hpp
  * - Memory management tools:
  *   - rclcpp/memory_strategies.hpp
  *   - rclcpp/memory_strategy.hpp
  *   - rclcpp/message_memory_strategy.hpp
  *   - rclcpp/strategies/allocator_memory_strategy.hpp
  *   - rclcpp/strategies/message_pool_memory_strategy.hpp
+ *   - rclcpp/strategies/serialized_message_pool_memory_strategy.hpp
+ * - Memory usage of the entities of a node:
+ *   - rclcpp::node_interfaces::NodeBaseInterface::get_memory_usage()
+ *   - rclcpp::create_memory_usage_report_timer()
+ *   - rclcpp/memory_usage.hpp
+ *   - rclcpp/create_memory_usage_report_timer.hpp
+ * - CPU time spent in the callbacks:
+ *   - rclcpp::executor::Executor::set_callback_group_cpu_time_measurement()
+ *   - rclcpp::callback_group::CallbackGroup::get_cpu_time()
+ *   - rclcpp::executor::ExecutorInstrumentation::get_cpu_time_histograms()
+ *   - rclcpp::create_cpu_time_report_timer()
+ *   - rclcpp/create_cpu_time_report_timer.hpp
+ * - Preparation of the memory of real-time processes:
+ *   - rclcpp::activate_realtime()
+ *   - rclcpp::InitOptions::realtime
+ *   - rclcpp::RealtimeWarmUpRegistry
+ *   - rclcpp/realtime.hpp
+ * - Tracepoints of the message flow, built with RCLCPP_TRACEPOINTS=ON:
+ *   - rclcpp::tracing::set_tracepoint_handler()
+ *   - rclcpp/tracepoints.hpp
+ * - Instantiation of the templates of message types in a library, to cut build times:
+ *   - RCLCPP_EXTERN_MESSAGE_TEMPLATES()
+ *   - RCLCPP_INSTANTIATE_MESSAGE_TEMPLATES()
+ *   - rclcpp/extern_templates.hpp
+ *   - rclcpp_add_message_instantiations() in CMake
+ * - Serialized messages:
+ *   - rclcpp::SerializedMessage
+ *   - rclcpp::Serialization
+ *   - rclcpp/serialization.hpp
+ *   - rclcpp/serialized_message.hpp
+ * - Publishers and subscriptions of types only known at runtime:
+ *   - rclcpp::Node::create_generic_publisher()
+ *   - rclcpp::Node::create_generic_subscription()
+ *   - rclcpp::GenericPublisher
+ *   - rclcpp::GenericSubscription
+ *   - rclcpp/generic_publisher.hpp
+ *   - rclcpp/generic_subscription.hpp
  * - Context object which is shared amongst multiple Nodes:
  *   - rclcpp::Context
  *   - rclcpp/context.hpp
@@ -130,6 +183,7 @@
  * - Various utilities:
  *   - rclcpp/function_traits.hpp
  *   - rclcpp/macros.hpp
+ *   - rclcpp/numa.hpp
  *   - rclcpp/scope_exit.hpp
  *   - rclcpp/time.hpp
  *   - rclcpp/utilities.hpp
@@ -143,15 +197,19 @@
 #include <memory>
 
 #include "rclcpp/executors.hpp"
+#include "rclcpp/fd_waitable.hpp"
 #include "rclcpp/logging.hpp"
 #include "rclcpp/node.hpp"
 #include "rclcpp/parameter.hpp"
 #include "rclcpp/parameter_client.hpp"
 #include "rclcpp/parameter_service.hpp"
 #include "rclcpp/rate.hpp"
+#include "rclcpp/realtime.hpp"
+#include "rclcpp/serialization.hpp"
 #include "rclcpp/time.hpp"
 #include "rclcpp/utilities.hpp"
 #include "rclcpp/visibility_control.hpp"
+#include "rclcpp/wait_set.hpp"
 #include "rclcpp/waitable.hpp"
 
 #endif  // RCLCPP__RCLCPP_HPP_
@@ -0,0 +1,133 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__REALTIME_HPP_
+#define RCLCPP__REALTIME_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rclcpp/context.hpp"
+#include "rclcpp/contexts/default_context.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/realtime_options.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Page faults of the process since it started.
+struct PageFaultCounts
+{
+  /// Faults served without I/O, e.g. on the first touch of a page.
+  uint64_t minor_faults = 0;
+  /// Faults which needed I/O.
+  uint64_t major_faults = 0;
+};
+
+/// Page faults of the process before and after activate_realtime().
+struct RealtimeActivationReport
+{
+  PageFaultCounts before;
+  PageFaultCounts after;
+};
+
+/// Memory to touch before going live, registered by its owners.
+/**
+ * A sub-context of the context, its warm-ups are run by activate_realtime():
+ *
+ * ```cpp
+ * auto pool = std::make_shared<rclcpp::allocator::MessagePool>(block_size, block_count);
+ * context->get_sub_context<rclcpp::RealtimeWarmUpRegistry>()->add(pool);
+ * ```
+ */
+class RealtimeWarmUpRegistry
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(RealtimeWarmUpRegistry)
+
+  RealtimeWarmUpRegistry() = default;
+
+  /// Add a function run by warm_up().
+  RCLCPP_PUBLIC
+  void
+  add_warm_up(std::function<void()> warm_up);
+
+  /// Add an object whose prefault() method is called by warm_up(), while it exists.
+  /**
+   * E.g. a rclcpp::allocator::MessagePool.
+   */
+  template<typename T>
+  void
+  add(const std::shared_ptr<T> & object)
+  {
+    std::weak_ptr<T> weak_object = object;
+    add_warm_up(
+      [weak_object]() {
+        auto object = weak_object.lock();
+        if (object) {
+          object->prefault();
+        }
+      });
+  }
+
+  /// Run the warm-ups.
+  RCLCPP_PUBLIC
+  void
+  warm_up();
+
+private:
+  std::mutex mutex_;
+  std::vector<std::function<void()>> warm_ups_;
+};
+
+/// Return the page faults of the process, zero on the platforms which don't count them.
+RCLCPP_PUBLIC
+PageFaultCounts
+get_page_fault_counts();
+
+/// Touch the given number of bytes of the stack of the calling thread, below the caller.
+/**
+ * \throws std::runtime_error on the platforms which don't support it.
+ */
+RCLCPP_PUBLIC
+void
+prefault_stack(size_t size);
+
+/// Prepare the memory of the process for real-time, before it goes live.
+/**
+ * According to rclcpp::InitOptions::realtime of the context, it locks the memory, touches the
+ * heap and the stack of the calling thread, then runs the warm-ups of the
+ * RealtimeWarmUpRegistry of the context.
+ * The threads started by the executors afterwards touch their stack when they start.
+ *
+ * The buffers of the intra-process subscriptions are initialized when the subscriptions are
+ * created, so they are already resident.
+ *
+ * \param[in] context the context, the default one if null.
+ * \return the page faults of the process before and after the preparation.
+ * \throws std::runtime_error if the memory can't be locked.
+ */
+RCLCPP_PUBLIC
+RealtimeActivationReport
+activate_realtime(rclcpp::Context::SharedPtr context = nullptr);
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__REALTIME_HPP_
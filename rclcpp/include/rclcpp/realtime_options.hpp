@@ -0,0 +1,50 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__REALTIME_OPTIONS_HPP_
+#define RCLCPP__REALTIME_OPTIONS_HPP_
+
+#include <cstddef>
+
+namespace rclcpp
+{
+
+/// Preparation of the memory of a real-time process, done by rclcpp::activate_realtime().
+/**
+ * Default constructed options don't change anything.
+ */
+struct RealtimeOptions
+{
+  /// Lock the current and future memory of the process in RAM, with mlockall().
+  /**
+   * It usually needs elevated privileges, e.g. CAP_IPC_LOCK or a large RLIMIT_MEMLOCK on Linux.
+   * The heap freed afterwards is kept by the process instead of being given back to the system.
+   */
+  bool lock_memory = false;
+  /// Bytes of stack touched by activate_realtime() and by each thread started by an executor.
+  /**
+   * It must be smaller than the stack of the threads, minus what they use already.
+   */
+  size_t stack_prefault_size = 0;
+  /// Bytes of heap allocated, touched and freed by activate_realtime().
+  /**
+   * Combined with lock_memory, the allocations of up to this size then don't fault.
+   */
+  size_t heap_prefault_size = 0;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__REALTIME_OPTIONS_HPP_
@@ -0,0 +1,59 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__ROSOUT_RATE_LIMIT_HPP_
+#define RCLCPP__ROSOUT_RATE_LIMIT_HPP_
+
+#include <chrono>
+#include <cstddef>
+
+namespace rclcpp
+{
+
+/// Budget of the logs a node publishes to /rosout, used in NodeOptions.
+/**
+ * The budget is refilled continuously at the given rates, and holds at most the budget of one
+ * burst duration, so that a node logging after a quiet period may use it at once.
+ * The messages over budget aren't published to /rosout. The next message published to /rosout
+ * is preceded by a summary of the suppressed messages.
+ *
+ * Only the logs of the node logger are limited, the logs of its child loggers aren't published
+ * to /rosout anyway.
+ */
+struct RosoutRateLimit
+{
+  /// Maximum number of messages published per second, 0 for no limit.
+  double messages_per_second = 0.0;
+  /// Maximum number of message bytes published per second, 0 for no limit.
+  size_t bytes_per_second = 0;
+  /// Duration of the budget which can be used at once.
+  std::chrono::nanoseconds burst_duration {std::chrono::seconds(1)};
+  /// If true, the messages over budget are still written to the console.
+  /**
+   * They are written with the console output handler of rcutils, even if the console output
+   * was disabled through the command line arguments, and aren't written to the log file.
+   */
+  bool console_when_suppressed = true;
+
+  /// Return true if the budget limits the messages.
+  bool
+  is_limited() const
+  {
+    return messages_per_second > 0.0 || bytes_per_second > 0;
+  }
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__ROSOUT_RATE_LIMIT_HPP_
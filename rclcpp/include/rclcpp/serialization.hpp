@@ -0,0 +1,127 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__SERIALIZATION_HPP_
+#define RCLCPP__SERIALIZATION_HPP_
+
+#include <type_traits>
+
+#include "rcl/types.h"
+#include "rosidl_runtime_c/message_type_support_struct.h"
+#include "rosidl_typesupport_cpp/message_type_support.hpp"
+
+#include "rclcpp/serialized_message.hpp"
+#include "rclcpp/type_adapter.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Serialization of the messages of a type, given by its type support.
+class SerializationBase
+{
+public:
+  RCLCPP_PUBLIC
+  explicit SerializationBase(const rosidl_message_type_support_t * type_support);
+
+  RCLCPP_PUBLIC
+  virtual ~SerializationBase() = default;
+
+  /// Serialize a ROS message into the buffer of the serialized message, which is reused.
+  /**
+   * The buffer only grows if it is smaller than the serialized message.
+   * \throws rclcpp::exceptions::RCLError if the serialization fails.
+   */
+  RCLCPP_PUBLIC
+  void
+  serialize_message(const void * ros_message, SerializedMessage & serialized_message) const;
+
+  /// Deserialize a serialized message into a ROS message.
+  /**
+   * The serialized message is only read, so a message owned by someone else, e.g. taken by a
+   * subscription, can be deserialized without copying it into a SerializedMessage.
+   * \throws rclcpp::exceptions::RCLError if the deserialization fails.
+   */
+  RCLCPP_PUBLIC
+  void
+  deserialize_message(
+    const rcl_serialized_message_t & serialized_message, void * ros_message) const;
+
+private:
+  const rosidl_message_type_support_t * type_support_;
+};
+
+/// Serialization of the messages of type MessageT.
+/**
+ * If MessageT is an adapted type, it is converted to its ROS message type first.
+ */
+template<typename MessageT>
+class Serialization : public SerializationBase
+{
+public:
+  using ROSMessageType = typename rclcpp::TypeAdapter<MessageT>::ros_message_type;
+  using PublishedType = typename rclcpp::TypeAdapter<MessageT>::custom_type;
+
+  Serialization()
+  : SerializationBase(rosidl_typesupport_cpp::get_message_type_support_handle<ROSMessageType>())
+  {}
+
+  /// Serialize the message, see SerializationBase::serialize_message().
+  void
+  serialize(const PublishedType & message, SerializedMessage & serialized_message) const
+  {
+    rclcpp::detail::with_ros_message<MessageT>(
+      message, [this, &serialized_message](const ROSMessageType & ros_message) {
+        this->serialize_message(&ros_message, serialized_message);
+      });
+  }
+
+  /// Deserialize the message, see SerializationBase::deserialize_message().
+  void
+  deserialize(const rcl_serialized_message_t & serialized_message, PublishedType & message) const
+  {
+    deserialize(
+      serialized_message, message, typename rclcpp::TypeAdapter<MessageT>::is_specialized());
+  }
+
+  void
+  deserialize(const SerializedMessage & serialized_message, PublishedType & message) const
+  {
+    deserialize(serialized_message.get_rcl_serialized_message(), message);
+  }
+
+private:
+  void
+  deserialize(
+    const rcl_serialized_message_t & serialized_message, ROSMessageType & message,
+    std::false_type) const
+  {
+    this->deserialize_message(serialized_message, &message);
+  }
+
+  void
+  deserialize(
+    const rcl_serialized_message_t & serialized_message, PublishedType & message,
+    std::true_type) const
+  {
+    ROSMessageType ros_message;
+    this->deserialize_message(serialized_message, &ros_message);
+    rclcpp::TypeAdapter<MessageT>::convert_to_custom(ros_message, message);
+  }
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__SERIALIZATION_HPP_
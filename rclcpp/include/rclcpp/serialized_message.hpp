@@ -0,0 +1,241 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__SERIALIZED_MESSAGE_HPP_
+#define RCLCPP__SERIALIZED_MESSAGE_HPP_
+
+#include <cstddef>
+#include <initializer_list>
+#include <type_traits>
+
+#include "rcl/allocator.h"
+#include "rcl/types.h"
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Copy an array of primitives, reversing the byte order of each element if asked.
+/**
+ * The plain copies are done by std::memcpy, the byte order is reversed 16 bytes at a time with
+ * SSSE3 or NEON where available, for the conversion of large arrays between the CDR byte order
+ * of a serialized message and the one of the host.
+ * The source and the destination may be the same array, to convert it in place, but must not
+ * overlap otherwise.
+ *
+ * \param[out] destination Array to copy to.
+ * \param[in] source Array to copy from.
+ * \param[in] count Number of elements.
+ * \param[in] element_size Size of an element in bytes, 1, 2, 4 or 8.
+ * \param[in] swap_byte_order True to reverse the byte order of each element.
+ * \throws std::invalid_argument if the element size isn't 1, 2, 4 or 8.
+ */
+RCLCPP_PUBLIC
+void
+copy_primitive_array(
+  void * destination, const void * source, size_t count, size_t element_size,
+  bool swap_byte_order);
+
+/// Owner of the buffer of a serialized message.
+/**
+ * The buffer is finalized on destruction, and moved without copying.
+ * Its capacity is kept when the message is cleared or serialized into again, so that a message
+ * reused for each serialization only allocates when it grows.
+ *
+ * The data can also be built and read in bulk, e.g. for a message whose payload is one large
+ * array of primitives: append_array() and read_array() copy the array at once, converting its
+ * byte order if needed, and gather() and scatter() copy the data from and to several buffers,
+ * like the header and the array of a message, instead of field by field.
+ */
+class SerializedMessage
+{
+public:
+  /// Part of the data given to gather().
+  struct ConstBuffer
+  {
+    const void * data;
+    size_t size;
+  };
+
+  /// Part of the data filled by scatter().
+  struct MutableBuffer
+  {
+    void * data;
+    size_t size;
+  };
+
+  /// Construct an empty message, which allocates nothing.
+  RCLCPP_PUBLIC
+  explicit SerializedMessage(const rcl_allocator_t & allocator = rcl_get_default_allocator());
+
+  /// Construct an empty message with a buffer of the given capacity, in bytes.
+  /**
+   * \throws rclcpp::exceptions::RCLError if the buffer can't be allocated.
+   */
+  RCLCPP_PUBLIC
+  explicit SerializedMessage(
+    size_t capacity, const rcl_allocator_t & allocator = rcl_get_default_allocator());
+
+  /// Construct a copy of the content of a serialized message, with the default allocator.
+  RCLCPP_PUBLIC
+  explicit SerializedMessage(const rcl_serialized_message_t & other);
+
+  /// Take the buffer of a serialized message, which is left zero initialized.
+  RCLCPP_PUBLIC
+  explicit SerializedMessage(rcl_serialized_message_t && other);
+
+  RCLCPP_PUBLIC
+  SerializedMessage(const SerializedMessage & other);
+
+  RCLCPP_PUBLIC
+  SerializedMessage(SerializedMessage && other) noexcept;
+
+  /// Copy the content of the other message, reusing the buffer if it is large enough.
+  RCLCPP_PUBLIC
+  SerializedMessage &
+  operator=(const SerializedMessage & other);
+
+  RCLCPP_PUBLIC
+  SerializedMessage &
+  operator=(SerializedMessage && other) noexcept;
+
+  RCLCPP_PUBLIC
+  virtual ~SerializedMessage();
+
+  /// Return the underlying message, e.g. to publish it or to give it to rmw functions.
+  RCLCPP_PUBLIC
+  rcl_serialized_message_t &
+  get_rcl_serialized_message();
+
+  RCLCPP_PUBLIC
+  const rcl_serialized_message_t &
+  get_rcl_serialized_message() const;
+
+  /// Return the size of the serialized data, in bytes.
+  RCLCPP_PUBLIC
+  size_t
+  size() const;
+
+  /// Return the capacity of the buffer, in bytes.
+  RCLCPP_PUBLIC
+  size_t
+  capacity() const;
+
+  /// Grow the buffer to at least the given capacity, keeping the data.
+  /**
+   * Nothing is allocated if the capacity is already large enough.
+   * \throws rclcpp::exceptions::RCLError if the buffer can't be allocated.
+   */
+  RCLCPP_PUBLIC
+  void
+  reserve(size_t capacity);
+
+  /// Drop the data, keeping the buffer for the next serialization.
+  RCLCPP_PUBLIC
+  void
+  clear();
+
+  /// Append bytes to the data, growing the buffer geometrically if needed.
+  RCLCPP_PUBLIC
+  void
+  append(const void * data, size_t size);
+
+  /// Append zero bytes until the size of the data after `origin` is a multiple of `alignment`.
+  /**
+   * E.g. align(sizeof(float), 4) before a CDR array of floats, whose alignment is counted from
+   * the end of the 4 bytes of the encapsulation header.
+   * \throws std::invalid_argument if the alignment is zero or the data is shorter than `origin`.
+   */
+  RCLCPP_PUBLIC
+  void
+  align(size_t alignment, size_t origin = 0);
+
+  /// Append an array of primitives at once, see copy_primitive_array().
+  RCLCPP_PUBLIC
+  void
+  append_primitive_array(
+    const void * data, size_t count, size_t element_size, bool swap_byte_order);
+
+  /// Copy an array of primitives from the data at `offset`, see copy_primitive_array().
+  /**
+   * \throws std::out_of_range if the array isn't within the data.
+   */
+  RCLCPP_PUBLIC
+  void
+  read_primitive_array(
+    size_t offset, void * data, size_t count, size_t element_size, bool swap_byte_order) const;
+
+  /// Append an array of primitives at once, reversing their byte order if asked.
+  template<typename T>
+  void
+  append_array(const T * data, size_t count, bool swap_byte_order = false)
+  {
+    static_assert(std::is_arithmetic<T>::value, "only arrays of primitives can be appended");
+    append_primitive_array(data, count, sizeof(T), swap_byte_order);
+  }
+
+  /// Copy an array of primitives from the data at `offset`, reversing their byte order if asked.
+  /**
+   * \throws std::out_of_range if the array isn't within the data.
+   */
+  template<typename T>
+  void
+  read_array(size_t offset, T * data, size_t count, bool swap_byte_order = false) const
+  {
+    static_assert(std::is_arithmetic<T>::value, "only arrays of primitives can be read");
+    read_primitive_array(offset, data, count, sizeof(T), swap_byte_order);
+  }
+
+  /// Replace the data with the concatenation of the parts, growing the buffer once.
+  RCLCPP_PUBLIC
+  void
+  gather(const ConstBuffer * parts, size_t count);
+
+  void
+  gather(std::initializer_list<ConstBuffer> parts)
+  {
+    gather(parts.begin(), parts.size());
+  }
+
+  /// Copy the data from `offset` into the parts, in order, until the parts or the data end.
+  /**
+   * \return The number of bytes copied.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  scatter(size_t offset, const MutableBuffer * parts, size_t count) const;
+
+  size_t
+  scatter(size_t offset, std::initializer_list<MutableBuffer> parts) const
+  {
+    return scatter(offset, parts.begin(), parts.size());
+  }
+
+  /// Give up the ownership of the buffer, the message is left empty.
+  /**
+   * The caller must finalize the returned message with rmw_serialized_message_fini().
+   */
+  RCLCPP_PUBLIC
+  rcl_serialized_message_t
+  release_rcl_serialized_message();
+
+private:
+  rcl_serialized_message_t serialized_message_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__SERIALIZED_MESSAGE_HPP_
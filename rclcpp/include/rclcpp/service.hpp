@@ -15,18 +15,33 @@
 #ifndef RCLCPP__SERVICE_HPP_
 #define RCLCPP__SERVICE_HPP_
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
 
 #include "rcl/error_handling.h"
 #include "rcl/service.h"
 
+#include "rclcpp/allocator/message_pool_allocator.hpp"
 #include "rclcpp/any_service_callback.hpp"
+#include "rclcpp/context.hpp"
+#include "rclcpp/detail/worker_pool.hpp"
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/experimental/intra_process_service_manager.hpp"
+#include "rclcpp/experimental/service_intra_process.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/memory_usage.hpp"
+#include "rclcpp/service_responder.hpp"
+#include "rclcpp/tracepoints.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/expand_topic_or_service_name.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -38,7 +53,7 @@
 namespace rclcpp
 {
 
-class ServiceBase
+class ServiceBase : public std::enable_shared_from_this<ServiceBase>
 {
 public:
   RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(ServiceBase)
@@ -68,9 +83,123 @@ public:
     std::shared_ptr<rmw_request_id_t> request_header,
     std::shared_ptr<void> request) = 0;
 
+  /// Requests taken at once, with the headers identifying their clients.
+  using RequestBatch =
+    std::vector<std::pair<std::shared_ptr<rmw_request_id_t>, std::shared_ptr<void>>>;
+
+  /// Return true if the callback handles batches of requests, see handle_request_batch().
+  virtual bool is_batched() const = 0;
+
+  /// Handle requests taken at once, with a single call of a batch callback.
+  virtual void handle_request_batch(const RequestBatch & batch) = 0;
+
+  /// Set the maximum number of requests given at once to a batch callback, 64 by default.
+  /**
+   * \throws std::invalid_argument if the size is zero.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_max_batch_size(size_t max_batch_size);
+
+  RCLCPP_PUBLIC
+  size_t
+  get_max_batch_size() const;
+
+  /// Handle the requests on a pool of worker threads, instead of the executor thread.
+  /**
+   * When the executor executes the service, it then takes all the requests received so far and
+   * queues them for the worker threads, which run the callback and send the responses, so
+   * several requests are handled in parallel.
+   * Each response is sent with the header of its own request, so it reaches its client whatever
+   * the order the requests complete in.
+   *
+   * The callback is then called concurrently with itself, and with the other callbacks of its
+   * callback group even if the group is mutually exclusive.
+   * It should be set before the node of the service is spun, the requests queued for the
+   * previous pool are dropped.
+   *
+   * \param[in] number_of_threads The number of worker threads, 0 to handle the requests on the
+   *   executor thread again, which is the default.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_number_of_worker_threads(size_t number_of_threads);
+
+  /// Return the number of worker threads, 0 if the requests are handled by the executor.
+  RCLCPP_PUBLIC
+  size_t
+  get_number_of_worker_threads() const;
+
+  /// Return the pool handling the requests, nullptr if the executor handles them.
+  RCLCPP_PUBLIC
+  rclcpp::detail::WorkerPool::SharedPtr
+  get_worker_pool() const;
+
+  /// Allocate the requests, the responses and the request headers from a pool.
+  /**
+   * Each request handled allocates a request, a response and a header, with the control blocks
+   * of their shared pointers; with a pool, their memory is taken from preallocated blocks and
+   * given back once the last shared pointer is released, e.g. after the response is sent.
+   * Objects larger than a block, or allocated while all the blocks are in use, fall back to the
+   * global operator new, see rclcpp::allocator::MessagePool.
+   *
+   * \param[in] pool The pool, nullptr to use the global operator new, which is the default.
+   * \sa Service::reserve_requests()
+   */
+  RCLCPP_PUBLIC
+  void
+  set_message_pool(rclcpp::allocator::MessagePool::SharedPtr pool);
+
+  RCLCPP_PUBLIC
+  rclcpp::allocator::MessagePool::SharedPtr
+  get_message_pool() const;
+
+  /// Return the bytes used by the service, see rclcpp::MemoryUsage.
+  RCLCPP_PUBLIC
+  virtual
+  rclcpp::MemoryUsage
+  get_memory_usage() const;
+
+  /// Return the type of the service, e.g. typeid(ServiceT).
+  virtual const std::type_info & get_service_type() const = 0;
+
+  /// Get the requests of the clients of the context directly, see IntraProcessServiceManager.
+  /**
+   * Called when the service is added to a node using intra-process communication.
+   * The requests are then handled by the waitable returned by get_intra_process_waitable(),
+   * which must be added to the callback group of the service.
+   *
+   * \throws std::runtime_error if the guard condition of the waitable can't be initialized.
+   */
+  RCLCPP_PUBLIC
+  void
+  setup_intra_process(rclcpp::Context::SharedPtr context);
+
+  /// Return the waitable handling the intra-process requests, nullptr if there is none.
+  RCLCPP_PUBLIC
+  rclcpp::Waitable::SharedPtr
+  get_intra_process_waitable() const;
+
 protected:
   RCLCPP_DISABLE_COPY(ServiceBase)
 
+  /// Give the response to a request of a client of the context back to it.
+  /**
+   * \return false if the request came through the middleware, its response must be sent.
+   */
+  RCLCPP_PUBLIC
+  bool
+  send_intra_process_response(const rmw_request_id_t & header, std::shared_ptr<void> response);
+
+  /// Create an object in memory from the message pool, if any, see set_message_pool().
+  template<typename T>
+  std::shared_ptr<T>
+  make_pooled() const
+  {
+    rclcpp::allocator::MessagePoolAllocator<T> allocator(std::atomic_load(&message_pool_));
+    return std::allocate_shared<T>(allocator);
+  }
+
   RCLCPP_PUBLIC
   rcl_node_t *
   get_rcl_node_handle();
@@ -83,6 +212,23 @@ protected:
 
   std::shared_ptr<rcl_service_t> service_handle_;
   bool owns_rcl_handle_ = true;
+
+  /// Serializes rcl_send_response(), which may be called by several worker threads.
+  std::mutex send_response_mutex_;
+
+  std::weak_ptr<rclcpp::experimental::IntraProcessServiceManager> intra_process_manager_;
+
+private:
+  std::atomic<size_t> max_batch_size_{64};
+
+  mutable std::mutex worker_pool_mutex_;
+  rclcpp::detail::WorkerPool::SharedPtr worker_pool_;
+
+  /// Read and replaced with the atomic functions of std::shared_ptr.
+  rclcpp::allocator::MessagePool::SharedPtr message_pool_;
+
+  rclcpp::experimental::ServiceIntraProcess::SharedPtr intra_process_service_;
+  uint64_t intra_process_service_id_ = 0;
 };
 
 template<typename ServiceT>
@@ -99,6 +245,25 @@ public:
       const std::shared_ptr<rmw_request_id_t>,
       const std::shared_ptr<typename ServiceT::Request>,
       std::shared_ptr<typename ServiceT::Response>)>;
+
+  /// Callback which sends the response later, from any thread, see ServiceResponder.
+  using DeferredCallbackType = std::function<
+    void (
+      const std::shared_ptr<typename ServiceT::Request>,
+      std::shared_ptr<ServiceResponder<ServiceT>>)>;
+
+  /// A request of a batch, with the header identifying its client.
+  using BatchRequest = typename AnyServiceCallback<ServiceT>::BatchRequest;
+
+  /// Callback handling the requests received so far at once, see handle_request_batch().
+  /**
+   * It fills in the responses, one for each request and in the same order, which are then sent
+   * together; a response reset to nullptr is not sent.
+   */
+  using BatchCallbackType = std::function<
+    void (
+      const std::vector<BatchRequest> &,
+      std::vector<std::shared_ptr<typename ServiceT::Response>> &)>;
   RCLCPP_SMART_PTR_DEFINITIONS(Service)
 
   Service(
@@ -224,14 +389,35 @@ public:
 
   std::shared_ptr<void> create_request() override
   {
-    return std::shared_ptr<void>(new typename ServiceT::Request());
+    return make_pooled<typename ServiceT::Request>();
   }
 
   std::shared_ptr<rmw_request_id_t> create_request_header() override
   {
     // TODO(wjwwood): This should probably use rmw_request_id's allocator.
     //                (since it is a C type)
-    return std::shared_ptr<rmw_request_id_t>(new rmw_request_id_t);
+    return make_pooled<rmw_request_id_t>();
+  }
+
+  /// Allocate the objects of the requests handled at the same time from a new pool.
+  /**
+   * The pool has a block for the request, the response and the header of each request, see
+   * set_message_pool().
+   *
+   * \param[in] capacity The number of requests expected to be handled at the same time, e.g.
+   *   the number of worker threads, or the maximum batch size for a batch callback.
+   * \param[in] numa_node The NUMA node the blocks are preferably placed on, negative for the
+   *   default placement.
+   * \throws std::invalid_argument if the capacity is zero.
+   */
+  void reserve_requests(size_t capacity, int numa_node = -1)
+  {
+    // Room for the control block of the shared pointer too, which holds a copy of the allocator.
+    size_t block_size = std::max(
+      {sizeof(typename ServiceT::Request), sizeof(typename ServiceT::Response),
+        sizeof(rmw_request_id_t)}) + 64;
+    set_message_pool(
+      std::make_shared<rclcpp::allocator::MessagePool>(block_size, 3 * capacity, numa_node));
   }
 
   void handle_request(
@@ -239,15 +425,88 @@ public:
     std::shared_ptr<void> request) override
   {
     auto typed_request = std::static_pointer_cast<typename ServiceT::Request>(request);
-    auto response = std::shared_ptr<typename ServiceT::Response>(new typename ServiceT::Response);
+    if (any_callback_.is_deferred()) {
+      // The callback may return before the response is sent, the executor thread is free then.
+      any_callback_.dispatch_deferred(
+        typed_request,
+        std::make_shared<ServiceResponder<ServiceT>>(
+          service_handle_, request_header, intra_process_manager_));
+      return;
+    }
+    auto response = make_pooled<typename ServiceT::Response>();
     any_callback_.dispatch(request_header, typed_request, response);
     send_response(request_header, response);
   }
 
+  bool is_batched() const override
+  {
+    return any_callback_.is_batched();
+  }
+
+  const std::type_info & get_service_type() const override
+  {
+    return typeid(ServiceT);
+  }
+
+  void handle_request_batch(const RequestBatch & batch) override
+  {
+    if (!any_callback_.is_batched()) {
+      for (const auto & request : batch) {
+        handle_request(request.first, request.second);
+      }
+      return;
+    }
+    std::vector<BatchRequest> requests;
+    std::vector<std::shared_ptr<typename ServiceT::Response>> responses;
+    requests.reserve(batch.size());
+    responses.reserve(batch.size());
+    for (const auto & request : batch) {
+      requests.emplace_back(
+        request.first, std::static_pointer_cast<typename ServiceT::Request>(request.second));
+      responses.push_back(make_pooled<typename ServiceT::Response>());
+    }
+    any_callback_.dispatch_batch(requests, responses);
+    send_responses(requests, responses);
+  }
+
+  /// Send the responses to a batch of requests, one for each request and in the same order.
+  /**
+   * The requests and responses are matched by their index, a nullptr response is not sent.
+   *
+   * \throws std::invalid_argument if there are not as many responses as requests.
+   * \throws anything rclcpp::exceptions::throw_from_rcl_error can throw.
+   */
+  void send_responses(
+    const std::vector<BatchRequest> & requests,
+    const std::vector<std::shared_ptr<typename ServiceT::Response>> & responses)
+  {
+    if (requests.size() != responses.size()) {
+      throw std::invalid_argument("a batch of responses must have one response for each request");
+    }
+    // Locked once for the whole batch.
+    std::lock_guard<std::mutex> lock(send_response_mutex_);
+    for (size_t i = 0; i < requests.size(); ++i) {
+      if (!responses[i] || send_intra_process_response(*requests[i].first, responses[i])) {
+        continue;
+      }
+      RCLCPP_TRACEPOINT(SendResponse, get_service_handle().get(), requests[i].first.get());
+      rcl_ret_t status = rcl_send_response(
+        get_service_handle().get(), requests[i].first.get(), responses[i].get());
+      if (status != RCL_RET_OK) {
+        rclcpp::exceptions::throw_from_rcl_error(status, "failed to send response");
+      }
+    }
+  }
+
   void send_response(
     std::shared_ptr<rmw_request_id_t> req_id,
     std::shared_ptr<typename ServiceT::Response> response)
   {
+    if (send_intra_process_response(*req_id, response)) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(send_response_mutex_);
+    RCLCPP_TRACEPOINT(SendResponse, get_service_handle().get(), req_id.get());
     rcl_ret_t status = rcl_send_response(get_service_handle().get(), req_id.get(), response.get());
 
     if (status != RCL_RET_OK) {
@@ -255,6 +514,14 @@ public:
     }
   }
 
+  rclcpp::MemoryUsage
+  get_memory_usage() const override
+  {
+    rclcpp::MemoryUsage usage = ServiceBase::get_memory_usage();
+    usage.entity_bytes = sizeof(*this);
+    return usage;
+  }
+
 private:
   RCLCPP_DISABLE_COPY(Service)
 
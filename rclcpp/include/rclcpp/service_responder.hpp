@@ -0,0 +1,115 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__SERVICE_RESPONDER_HPP_
+#define RCLCPP__SERVICE_RESPONDER_HPP_
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "rcl/service.h"
+
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/experimental/intra_process_service_manager.hpp"
+#include "rclcpp/macros.hpp"
+#include "rmw/types.h"
+
+namespace rclcpp
+{
+
+/// Handle to send the response to a request of a service later, from any thread.
+/**
+ * It is given to the deferred callbacks of a service, which return without a response, e.g.
+ * after forwarding the request to another node, so they don't block the executor thread.
+ * The response is sent by send_response(), once.
+ * If the responder is destroyed without sending a response, the client never gets one.
+ */
+template<typename ServiceT>
+class ServiceResponder
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(ServiceResponder)
+
+  /**
+   * \param[in] service_handle The rcl service sending the response.
+   * \param[in] request_header The header of the request.
+   * \param[in] intra_process_manager The manager giving the response back to the client, if the
+   *   request came from a client of the context, see IntraProcessServiceManager.
+   */
+  ServiceResponder(
+    std::weak_ptr<rcl_service_t> service_handle,
+    std::shared_ptr<rmw_request_id_t> request_header,
+    std::weak_ptr<rclcpp::experimental::IntraProcessServiceManager> intra_process_manager = {})
+  : service_handle_(std::move(service_handle)), request_header_(std::move(request_header)),
+    intra_process_manager_(std::move(intra_process_manager))
+  {}
+
+  /// Send the response to the request.
+  /**
+   * \param[in] response The response.
+   * \throws std::runtime_error if the response was already sent, or if the service was
+   *   destroyed.
+   * \throws anything rclcpp::exceptions::throw_from_rcl_error can throw.
+   */
+  void
+  send_response(std::shared_ptr<typename ServiceT::Response> response)
+  {
+    if (sent_.exchange(true)) {
+      throw std::runtime_error("the response to this request was already sent");
+    }
+    auto service_handle = service_handle_.lock();
+    if (!service_handle) {
+      throw std::runtime_error("the service was destroyed before the response was sent");
+    }
+    using rclcpp::experimental::IntraProcessServiceManager;
+    if (IntraProcessServiceManager::is_intra_process_request(*request_header_)) {
+      auto intra_process_manager = intra_process_manager_.lock();
+      if (intra_process_manager) {
+        intra_process_manager->send_response(*request_header_, response);
+      }
+      return;
+    }
+    rcl_ret_t status =
+      rcl_send_response(service_handle.get(), request_header_.get(), response.get());
+    if (status != RCL_RET_OK) {
+      rclcpp::exceptions::throw_from_rcl_error(status, "failed to send response");
+    }
+  }
+
+  /// Return true if send_response() was called.
+  bool
+  is_response_sent() const
+  {
+    return sent_.load();
+  }
+
+  /// Return the header of the request, which identifies the client and the request.
+  std::shared_ptr<const rmw_request_id_t>
+  get_request_header() const
+  {
+    return request_header_;
+  }
+
+private:
+  std::weak_ptr<rcl_service_t> service_handle_;
+  std::shared_ptr<rmw_request_id_t> request_header_;
+  std::weak_ptr<rclcpp::experimental::IntraProcessServiceManager> intra_process_manager_;
+  std::atomic<bool> sent_{false};
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__SERVICE_RESPONDER_HPP_
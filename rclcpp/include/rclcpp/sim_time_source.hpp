@@ -0,0 +1,144 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__SIM_TIME_SOURCE_HPP_
+#define RCLCPP__SIM_TIME_SOURCE_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rclcpp/clock.hpp"
+#include "rclcpp/context.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/node_interfaces/node_topics_interface.hpp"
+#include "rclcpp/subscription_base.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Simulated time of the /clock topic, shared by all the time sources of a context.
+/**
+ * There is a single /clock subscription per context, instead of one per node, and the time of
+ * the last message is stored once, the attached clocks read it with an atomic load.
+ * The rcl clocks are only updated for the clocks with jump callbacks, e.g. of timers using the
+ * ROS time, the other ones are updated when their handle is used, see Clock::get_clock_handle().
+ *
+ * The subscription is created with the topics interface of the first time source using the
+ * simulated time, e.g. the NodeTimeSource of the first node with `use_sim_time` set, and moved
+ * to another node when no time source of its node uses it anymore, so the /clock messages are
+ * received while that node is spun.
+ * The time is reset to 0 once no time source uses the simulated time anymore.
+ */
+class SimTimeSource : public std::enable_shared_from_this<SimTimeSource>
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(SimTimeSource)
+
+  /// Return the instance of a context, created on the first call.
+  RCLCPP_PUBLIC
+  static
+  SharedPtr
+  get_instance(const rclcpp::Context::SharedPtr & context);
+
+  /// Constructor, use get_instance() instead, except for tests.
+  RCLCPP_PUBLIC
+  SimTimeSource();
+
+  RCLCPP_PUBLIC
+  ~SimTimeSource();
+
+  /// Add a node able to host the /clock subscription, for a time source using simulated time.
+  /**
+   * \param[in] key identifies the user, e.g. the time source, to remove it later.
+   * \param[in] node_topics the topics interface of its node.
+   */
+  RCLCPP_PUBLIC
+  void
+  add_subscriber(
+    const void * key, rclcpp::node_interfaces::NodeTopicsInterface::SharedPtr node_topics);
+
+  /// Remove a node added with add_subscriber(), the subscription is moved if it hosted it.
+  RCLCPP_PUBLIC
+  void
+  remove_subscriber(const void * key);
+
+  /// Make a ROS clock follow the simulated time, and enable its ROS time override.
+  /**
+   * \throws anything rclcpp::exceptions::throw_from_rcl_error can throw.
+   */
+  RCLCPP_PUBLIC
+  void
+  attach_clock(const rclcpp::Clock::SharedPtr & clock);
+
+  /// Stop a clock from following the simulated time, its ROS time override is left as is.
+  RCLCPP_PUBLIC
+  void
+  detach_clock(const rclcpp::Clock::SharedPtr & clock);
+
+  /// Set the simulated time, as if it was received on the /clock topic.
+  /**
+   * \throws anything rclcpp::exceptions::throw_from_rcl_error can throw.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_time(int64_t nanoseconds);
+
+  /// Return the simulated time, in nanoseconds.
+  RCLCPP_PUBLIC
+  int64_t
+  get_time() const;
+
+  /// Return the number of clocks following the simulated time.
+  RCLCPP_PUBLIC
+  size_t
+  get_clock_count() const;
+
+  /// Return true if the /clock subscription exists.
+  RCLCPP_PUBLIC
+  bool
+  has_subscription() const;
+
+private:
+  struct Subscriber
+  {
+    const void * key;
+    rclcpp::node_interfaces::NodeTopicsInterface::SharedPtr node_topics;
+  };
+
+  /// Create the subscription with the first subscriber if there is none, mutex_ must be locked.
+  void
+  update_subscription();
+
+  /// Reset the time if nothing uses it anymore, mutex_ must be locked.
+  void
+  reset_if_unused();
+
+  /// Shared with the clocks, which may outlive this instance.
+  std::shared_ptr<std::atomic<int64_t>> time_;
+
+  mutable std::mutex mutex_;
+  std::vector<rclcpp::Clock::SharedPtr> clocks_;
+  std::vector<Subscriber> subscribers_;
+  /// Key of the subscriber hosting the subscription.
+  const void * host_key_;
+  rclcpp::SubscriptionBase::SharedPtr subscription_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__SIM_TIME_SOURCE_HPP_
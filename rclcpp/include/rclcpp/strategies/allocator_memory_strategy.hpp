@@ -15,7 +15,11 @@
 #ifndef RCLCPP__STRATEGIES__ALLOCATOR_MEMORY_STRATEGY_HPP_
 #define RCLCPP__STRATEGIES__ALLOCATOR_MEMORY_STRATEGY_HPP_
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "rcl/allocator.h"
@@ -41,6 +45,10 @@ namespace allocator_memory_strategy
  * By default, the memory strategy dynamically allocates memory for structures that come in from
  * the rmw implementation after the executor waits for work, based on the number of entities that
  * come through.
+ *
+ * collect_entities() also indexes every entity of the nodes by its handle, together with its
+ * callback group and node, so the get_next_*() functions find them without searching the nodes.
+ * The index is only updated when entities are created or destroyed.
  */
 template<typename Alloc = std::allocator<void>>
 class AllocatorMemoryStrategy : public memory_strategy::MemoryStrategy
@@ -152,6 +160,7 @@ public:
 
   bool collect_entities(const WeakNodeList & weak_nodes) override
   {
+    ++generation_;
     bool has_invalid_weak_nodes = false;
     for (auto & weak_node : weak_nodes) {
       auto node = weak_node.lock();
@@ -161,36 +170,82 @@ public:
       }
       for (auto & weak_group : node->get_callback_groups()) {
         auto group = weak_group.lock();
-        if (!group || !group->can_be_taken_from().load()) {
+        if (!group) {
           continue;
         }
+        // Groups which cannot be taken from, or are assigned to another executor, are still
+        // indexed, but not waited on.
+        bool wait_on_group =
+          group->can_be_taken_from().load() && group->is_assigned_to(executor_);
         group->find_subscription_ptrs_if(
-          [this](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
-            subscription_handles_.push_back(subscription->get_subscription_handle());
+          [this, &group, &node, wait_on_group](
+            const rclcpp::SubscriptionBase::SharedPtr & subscription)
+          {
+            auto handle = subscription->get_subscription_handle();
+            auto & entry =
+              index_entity(subscription_index_, handle.get(), subscription, group, node);
+            if (!wait_on_group) {
+              return false;
+            }
+            if (subscription->has_shared_reader()) {
+              // A reader shared by several subscriptions is waited on once, and taken from
+              // through one of them whose group can be taken from.
+              if (entry.waited_generation == generation_) {
+                return false;
+              }
+              entry.waited_generation = generation_;
+              entry.entity = subscription;
+              entry.group = group;
+              entry.node = node;
+            }
+            subscription_handles_.push_back(handle);
             return false;
           });
         group->find_service_ptrs_if(
-          [this](const rclcpp::ServiceBase::SharedPtr & service) {
-            service_handles_.push_back(service->get_service_handle());
+          [this, &group, &node, wait_on_group](const rclcpp::ServiceBase::SharedPtr & service) {
+            auto handle = service->get_service_handle();
+            index_entity(service_index_, handle.get(), service, group, node);
+            if (wait_on_group) {
+              service_handles_.push_back(handle);
+            }
             return false;
           });
         group->find_client_ptrs_if(
-          [this](const rclcpp::ClientBase::SharedPtr & client) {
-            client_handles_.push_back(client->get_client_handle());
+          [this, &group, &node, wait_on_group](const rclcpp::ClientBase::SharedPtr & client) {
+            auto handle = client->get_client_handle();
+            index_entity(client_index_, handle.get(), client, group, node);
+            if (wait_on_group) {
+              client_handles_.push_back(handle);
+            }
             return false;
           });
         group->find_timer_ptrs_if(
-          [this](const rclcpp::TimerBase::SharedPtr & timer) {
-            timer_handles_.push_back(timer->get_timer_handle());
+          [this, &group, &node, wait_on_group](const rclcpp::TimerBase::SharedPtr & timer) {
+            auto handle = timer->get_timer_handle();
+            index_entity(timer_index_, handle.get(), timer, group, node);
+            if (timer_manager_ && timer_manager_->manage(timer, wait_on_group)) {
+              return false;
+            }
+            if (wait_on_group) {
+              timer_handles_.push_back(handle);
+            }
             return false;
           });
         group->find_waitable_ptrs_if(
-          [this](const rclcpp::Waitable::SharedPtr & waitable) {
-            waitable_handles_.push_back(waitable);
+          [this, &group, &node, wait_on_group](const rclcpp::Waitable::SharedPtr & waitable) {
+            index_entity(waitable_index_, waitable.get(), waitable, group, node);
+            if (wait_on_group) {
+              waitable_handles_.push_back(waitable);
+            }
             return false;
           });
       }
     }
+    prune_index(subscription_index_);
+    prune_index(service_index_);
+    prune_index(client_index_);
+    prune_index(timer_index_);
+    prune_index(waitable_index_);
     return has_invalid_weak_nodes;
   }
 
@@ -268,10 +323,19 @@ public:
   {
     auto it = subscription_handles_.begin();
     while (it != subscription_handles_.end()) {
-      auto subscription = get_subscription_by_handle(*it, weak_nodes);
+      rclcpp::SubscriptionBase::SharedPtr subscription;
+      rclcpp::callback_group::CallbackGroup::SharedPtr group;
+      rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node;
+      if (!find_in_index(subscription_index_, it->get(), subscription, group, node)) {
+        // Not collected by collect_entities(), search the nodes for it
+        subscription = get_subscription_by_handle(*it, weak_nodes);
+        if (subscription) {
+          group = get_group_by_subscription(subscription, weak_nodes);
+          node = get_node_by_group(group, weak_nodes);
+        }
+      }
       if (subscription) {
-        // Find the group for this handle and see if it can be serviced
-        auto group = get_group_by_subscription(subscription, weak_nodes);
+        // Check the group of this handle to see if it can be serviced
         if (!group) {
           // Group was not found, meaning the subscription is not valid...
           // Remove it from the ready list and continue looking
@@ -285,9 +349,9 @@ public:
           continue;
         }
         // Otherwise it is safe to set and return the any_exec
-        any_exec.subscription = subscription;
-        any_exec.callback_group = group;
-        any_exec.node_base = get_node_by_group(group, weak_nodes);
+        any_exec.subscription = std::move(subscription);
+        any_exec.callback_group = std::move(group);
+        any_exec.node_base = std::move(node);
         subscription_handles_.erase(it);
         return;
       }
@@ -303,10 +367,19 @@ public:
   {
     auto it = service_handles_.begin();
     while (it != service_handles_.end()) {
-      auto service = get_service_by_handle(*it, weak_nodes);
+      rclcpp::ServiceBase::SharedPtr service;
+      rclcpp::callback_group::CallbackGroup::SharedPtr group;
+      rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node;
+      if (!find_in_index(service_index_, it->get(), service, group, node)) {
+        // Not collected by collect_entities(), search the nodes for it
+        service = get_service_by_handle(*it, weak_nodes);
+        if (service) {
+          group = get_group_by_service(service, weak_nodes);
+          node = get_node_by_group(group, weak_nodes);
+        }
+      }
       if (service) {
-        // Find the group for this handle and see if it can be serviced
-        auto group = get_group_by_service(service, weak_nodes);
+        // Check the group of this handle to see if it can be serviced
         if (!group) {
           // Group was not found, meaning the service is not valid...
           // Remove it from the ready list and continue looking
@@ -320,9 +393,9 @@ public:
           continue;
         }
         // Otherwise it is safe to set and return the any_exec
-        any_exec.service = service;
-        any_exec.callback_group = group;
-        any_exec.node_base = get_node_by_group(group, weak_nodes);
+        any_exec.service = std::move(service);
+        any_exec.callback_group = std::move(group);
+        any_exec.node_base = std::move(node);
         service_handles_.erase(it);
         return;
       }
@@ -336,10 +409,19 @@ public:
   {
     auto it = client_handles_.begin();
     while (it != client_handles_.end()) {
-      auto client = get_client_by_handle(*it, weak_nodes);
+      rclcpp::ClientBase::SharedPtr client;
+      rclcpp::callback_group::CallbackGroup::SharedPtr group;
+      rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node;
+      if (!find_in_index(client_index_, it->get(), client, group, node)) {
+        // Not collected by collect_entities(), search the nodes for it
+        client = get_client_by_handle(*it, weak_nodes);
+        if (client) {
+          group = get_group_by_client(client, weak_nodes);
+          node = get_node_by_group(group, weak_nodes);
+        }
+      }
       if (client) {
-        // Find the group for this handle and see if it can be serviced
-        auto group = get_group_by_client(client, weak_nodes);
+        // Check the group of this handle to see if it can be serviced
         if (!group) {
           // Group was not found, meaning the service is not valid...
           // Remove it from the ready list and continue looking
@@ -353,9 +435,9 @@ public:
           continue;
         }
         // Otherwise it is safe to set and return the any_exec
-        any_exec.client = client;
-        any_exec.callback_group = group;
-        any_exec.node_base = get_node_by_group(group, weak_nodes);
+        any_exec.client = std::move(client);
+        any_exec.callback_group = std::move(group);
+        any_exec.node_base = std::move(node);
         client_handles_.erase(it);
         return;
       }
@@ -371,10 +453,19 @@ public:
   {
     auto it = timer_handles_.begin();
     while (it != timer_handles_.end()) {
-      auto timer = get_timer_by_handle(*it, weak_nodes);
+      rclcpp::TimerBase::SharedPtr timer;
+      rclcpp::callback_group::CallbackGroup::SharedPtr group;
+      rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node;
+      if (!find_in_index(timer_index_, it->get(), timer, group, node)) {
+        // Not collected by collect_entities(), search the nodes for it
+        timer = get_timer_by_handle(*it, weak_nodes);
+        if (timer) {
+          group = get_group_by_timer(timer, weak_nodes);
+          node = get_node_by_group(group, weak_nodes);
+        }
+      }
       if (timer) {
-        // Find the group for this handle and see if it can be serviced
-        auto group = get_group_by_timer(timer, weak_nodes);
+        // Check the group of this handle to see if it can be serviced
         if (!group) {
           // Group was not found, meaning the timer is not valid...
           // Remove it from the ready list and continue looking
@@ -388,9 +479,9 @@ public:
           continue;
         }
         // Otherwise it is safe to set and return the any_exec
-        any_exec.timer = timer;
-        any_exec.callback_group = group;
-        any_exec.node_base = get_node_by_group(group, weak_nodes);
+        any_exec.timer = std::move(timer);
+        any_exec.callback_group = std::move(group);
+        any_exec.node_base = std::move(node);
         timer_handles_.erase(it);
         return;
       }
@@ -405,9 +496,19 @@ public:
     auto it = waitable_handles_.begin();
     while (it != waitable_handles_.end()) {
       auto waitable = *it;
+      rclcpp::Waitable::SharedPtr indexed_waitable;
+      rclcpp::callback_group::CallbackGroup::SharedPtr group;
+      rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node;
+      if (
+        waitable &&
+        !find_in_index(waitable_index_, waitable.get(), indexed_waitable, group, node))
+      {
+        // Not collected by collect_entities(), e.g. added with add_waitable_handle()
+        group = get_group_by_waitable(waitable, weak_nodes);
+        node = get_node_by_group(group, weak_nodes);
+      }
       if (waitable) {
-        // Find the group for this handle and see if it can be serviced
-        auto group = get_group_by_waitable(waitable, weak_nodes);
+        // Check the group of this handle to see if it can be serviced
         if (!group) {
           // Group was not found, meaning the waitable is not valid...
           // Remove it from the ready list and continue looking
@@ -421,9 +522,9 @@ public:
           continue;
         }
         // Otherwise it is safe to set and return the any_exec
-        any_exec.waitable = waitable;
-        any_exec.callback_group = group;
-        any_exec.node_base = get_node_by_group(group, weak_nodes);
+        any_exec.waitable = std::move(waitable);
+        any_exec.callback_group = std::move(group);
+        any_exec.node_base = std::move(node);
         waitable_handles_.erase(it);
         return;
       }
@@ -437,6 +538,22 @@ public:
     return rclcpp::allocator::get_rcl_allocator<void *, VoidAlloc>(*allocator_.get());
   }
 
+  void reserve(const EntityCapacities & capacities) override
+  {
+    // The guard conditions of the nodes and of the executor are added too.
+    guard_conditions_.reserve(capacities.guard_conditions + capacities.nodes + 1);
+    subscription_handles_.reserve(capacities.subscriptions);
+    service_handles_.reserve(capacities.services);
+    client_handles_.reserve(capacities.clients);
+    timer_handles_.reserve(capacities.timers);
+    waitable_handles_.reserve(capacities.waitables);
+    subscription_index_.entries.reserve(capacities.subscriptions);
+    service_index_.entries.reserve(capacities.services);
+    client_index_.entries.reserve(capacities.clients);
+    timer_index_.entries.reserve(capacities.timers);
+    waitable_index_.entries.reserve(capacities.waitables);
+  }
+
   size_t number_of_ready_subscriptions() const override
   {
     size_t number_of_subscriptions = subscription_handles_.size();
@@ -501,6 +618,96 @@ private:
   using VectorRebind =
     std::vector<T, typename std::allocator_traits<Alloc>::template rebind_alloc<T>>;
 
+  /// An entity with its callback group and node, indexed by the address of its handle.
+  template<typename EntityT>
+  struct IndexEntry
+  {
+    std::weak_ptr<EntityT> entity;
+    rclcpp::callback_group::CallbackGroup::WeakPtr group;
+    rclcpp::node_interfaces::NodeBaseInterface::WeakPtr node;
+    /// The last collect_entities() call which saw the entity.
+    uint64_t generation = 0;
+    /// The last collect_entities() call which waited on the shared reader of a subscription.
+    uint64_t waited_generation = 0;
+  };
+
+  template<typename EntityT>
+  struct EntityIndex
+  {
+    using Entry = IndexEntry<EntityT>;
+    using Map = std::unordered_map<
+      const void *, Entry, std::hash<const void *>, std::equal_to<const void *>,
+      typename std::allocator_traits<Alloc>::template rebind_alloc<
+        std::pair<const void * const, Entry>>>;
+
+    Map entries;
+    /// Number of entries seen by the current collect_entities() call.
+    size_t number_seen = 0;
+  };
+
+  template<typename EntityT>
+  IndexEntry<EntityT> &
+  index_entity(
+    EntityIndex<EntityT> & index,
+    const void * key,
+    const std::shared_ptr<EntityT> & entity,
+    const rclcpp::callback_group::CallbackGroup::SharedPtr & group,
+    const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr & node)
+  {
+    // Only allocates the first time an entity is seen.
+    auto & entry = index.entries[key];
+    // An entity never moves to another group, but its handle may be reused by a new entity.
+    if (entry.entity.expired()) {
+      entry.entity = entity;
+      entry.group = group;
+      entry.node = node;
+    }
+    if (entry.generation != generation_) {
+      entry.generation = generation_;
+      ++index.number_seen;
+    }
+    return entry;
+  }
+
+  /// Remove the entities which were not seen by the current collect_entities() call.
+  template<typename EntityT>
+  void
+  prune_index(EntityIndex<EntityT> & index)
+  {
+    if (index.entries.size() > index.number_seen) {
+      for (auto it = index.entries.begin(); it != index.entries.end(); ) {
+        if (it->second.generation != generation_) {
+          it = index.entries.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+    index.number_seen = 0;
+  }
+
+  template<typename EntityT>
+  static bool
+  find_in_index(
+    const EntityIndex<EntityT> & index,
+    const void * key,
+    std::shared_ptr<EntityT> & entity,
+    rclcpp::callback_group::CallbackGroup::SharedPtr & group,
+    rclcpp::node_interfaces::NodeBaseInterface::SharedPtr & node)
+  {
+    auto it = index.entries.find(key);
+    if (it == index.entries.end()) {
+      return false;
+    }
+    entity = it->second.entity.lock();
+    if (!entity) {
+      return false;
+    }
+    group = it->second.group.lock();
+    node = it->second.node.lock();
+    return true;
+  }
+
   VectorRebind<const rcl_guard_condition_t *> guard_conditions_;
 
   VectorRebind<std::shared_ptr<const rcl_subscription_t>> subscription_handles_;
@@ -509,6 +716,13 @@ private:
   VectorRebind<std::shared_ptr<const rcl_timer_t>> timer_handles_;
   VectorRebind<std::shared_ptr<Waitable>> waitable_handles_;
 
+  uint64_t generation_ = 0;
+  EntityIndex<rclcpp::SubscriptionBase> subscription_index_;
+  EntityIndex<rclcpp::ServiceBase> service_index_;
+  EntityIndex<rclcpp::ClientBase> client_index_;
+  EntityIndex<rclcpp::TimerBase> timer_index_;
+  EntityIndex<rclcpp::Waitable> waitable_index_;
+
   std::shared_ptr<VoidAlloc> allocator_;
 };
 
@@ -16,7 +16,16 @@
 #define RCLCPP__STRATEGIES__MESSAGE_POOL_MEMORY_STRATEGY_HPP_
 
 #include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "rclcpp/allocator/allocator_common.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/message_memory_strategy.hpp"
 #include "rclcpp/visibility_control.hpp"
@@ -94,6 +103,12 @@ public:
     throw std::runtime_error("Unrecognized message ptr in return_message.");
   }
 
+  /// Return the bytes of the messages of the pool.
+  size_t get_memory_usage() const override
+  {
+    return Size * sizeof(MessageT);
+  }
+
 protected:
   struct PoolMember
   {
@@ -105,6 +120,344 @@ protected:
   size_t next_array_index_;
 };
 
+/// Message pool strategy which grows on demand.
+/**
+ * Unlike MessagePoolMemoryStrategy it doesn't need to be sized at compile time, and it can be
+ * used for any message type, including the ones without a fixed size.
+ *
+ * The pool starts with `chunk_size` messages, and grows by `chunk_size` messages each time all
+ * of them are in use, up to `max_size` messages (0 for no limit).
+ * When the pool is exhausted, borrow_message() allocates the message as the default strategy
+ * does, and counts it in get_exhausted_count(), instead of throwing.
+ *
+ * The index of a message in the pool is stored with its deleter, so returning a message doesn't
+ * search the pool.
+ * A message stays out of the pool until it is returned and no one else holds a reference to it,
+ * so a subscription callback can keep the messages it receives.
+ *
+ * The strategy can be shared by several subscriptions of the same message type, see
+ * DynamicMessagePoolRegistry.
+ */
+template<typename MessageT, typename Alloc = std::allocator<void>>
+class DynamicMessagePoolMemoryStrategy
+  : public message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(DynamicMessagePoolMemoryStrategy)
+
+  using MessageAllocTraits = allocator::AllocRebind<MessageT, Alloc>;
+  using MessageAlloc = typename MessageAllocTraits::allocator_type;
+
+  /// Constructor.
+  /**
+   * \param[in] chunk_size number of messages allocated each time the pool grows.
+   * \param[in] max_size maximum number of messages in the pool, 0 for no limit.
+   * \param[in] allocator used to allocate the messages.
+   * \throws std::invalid_argument if the chunk size is zero.
+   */
+  explicit DynamicMessagePoolMemoryStrategy(
+    size_t chunk_size = 16,
+    size_t max_size = 0,
+    std::shared_ptr<Alloc> allocator = std::make_shared<Alloc>())
+  : message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>(allocator),
+    chunk_size_(chunk_size),
+    max_size_(max_size),
+    exhausted_count_(0)
+  {
+    if (chunk_size_ == 0) {
+      throw std::invalid_argument("chunk_size must be a positive, non-zero value");
+    }
+    grow();
+  }
+
+  /// Borrow a message from the pool.
+  /**
+   * The pool grows if all its messages are in use.
+   * If it can't grow anymore, a new message is allocated outside of the pool.
+   * \return Shared pointer to the borrowed message.
+   */
+  std::shared_ptr<MessageT> borrow_message() override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto message = take_free_message();
+    if (!message && grow()) {
+      message = take_free_message();
+    }
+    if (!message) {
+      exhausted_count_++;
+      return message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>::borrow_message();
+    }
+    message->~MessageT();
+    new (message.get())MessageT;
+    return message;
+  }
+
+  /// Return a message to the pool.
+  /**
+   * Messages which were allocated outside of the pool are released.
+   * \param[in] msg Shared pointer to the message to return, it is reset.
+   */
+  void return_message(std::shared_ptr<MessageT> & msg) override
+  {
+    auto deleter = std::get_deleter<SlotDeleter>(msg);
+    if (deleter) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (deleter->index < pool_.size() && pool_[deleter->index] == msg) {
+        free_indexes_.push_back(deleter->index);
+      }
+    }
+    msg.reset();
+  }
+
+  /// Return the number of messages in the pool.
+  size_t get_pool_size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pool_.size();
+  }
+
+  /// Return the number of messages of the pool which were returned.
+  size_t get_free_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_indexes_.size();
+  }
+
+  /// Return the number of messages which were allocated because the pool was exhausted.
+  size_t get_exhausted_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return exhausted_count_;
+  }
+
+  /// Return the bytes of the messages of the pool.
+  size_t get_memory_usage() const override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pool_.size() * sizeof(MessageT);
+  }
+
+protected:
+  struct SlotDeleter
+  {
+    void operator()(MessageT * msg)
+    {
+      MessageAllocTraits::destroy(*allocator, msg);
+      MessageAllocTraits::deallocate(*allocator, msg, 1);
+    }
+
+    size_t index;
+    std::shared_ptr<MessageAlloc> allocator;
+  };
+
+  /// Add a chunk of messages to the pool, return false if it reached its maximum size.
+  bool grow()
+  {
+    size_t new_size = pool_.size() + chunk_size_;
+    if (max_size_ != 0 && new_size > max_size_) {
+      new_size = max_size_;
+    }
+    if (new_size <= pool_.size()) {
+      return false;
+    }
+    pool_.reserve(new_size);
+    free_indexes_.reserve(new_size);
+    auto & message_allocator = this->message_allocator_;
+    for (size_t index = pool_.size(); index < new_size; ++index) {
+      auto ptr = MessageAllocTraits::allocate(*message_allocator.get(), 1);
+      MessageAllocTraits::construct(*message_allocator.get(), ptr);
+      pool_.emplace_back(ptr, SlotDeleter{index, message_allocator}, *message_allocator.get());
+      free_indexes_.push_back(index);
+    }
+    return true;
+  }
+
+  /// Take the most recently returned message which isn't used anymore, nullptr if none.
+  std::shared_ptr<MessageT> take_free_message()
+  {
+    for (size_t i = free_indexes_.size(); i > 0; --i) {
+      auto & message = pool_[free_indexes_[i - 1]];
+      if (message.use_count() == 1) {
+        free_indexes_[i - 1] = free_indexes_.back();
+        free_indexes_.pop_back();
+        return message;
+      }
+    }
+    return nullptr;
+  }
+
+  const size_t chunk_size_;
+  const size_t max_size_;
+  std::vector<std::shared_ptr<MessageT>> pool_;
+  std::vector<size_t> free_indexes_;
+  size_t exhausted_count_;
+  mutable std::mutex mutex_;
+};
+
+/// Strategy deserializing the messages into recycled message instances, without resetting them.
+/**
+ * Unlike the other strategies, the messages are not reconstructed when they are reused, so their
+ * sequences and strings keep their capacity: deserializing a large message, e.g. a point cloud or
+ * an image, into a recycled instance doesn't allocate once the instance has received a message
+ * of the same size.
+ * The middleware writes all the fields of the message, so no stale value is left in it.
+ *
+ * The instances can be provided by the user, preallocated with the capacity of the expected
+ * messages:
+ *
+ * ```cpp
+ * auto strategy = std::make_shared<RecycledMessageMemoryStrategy<sensor_msgs::msg::Image>>(2);
+ * for (size_t i = 0; i < 2; ++i) {
+ *   auto image = std::make_shared<sensor_msgs::msg::Image>();
+ *   image->data.reserve(1920 * 1080 * 3);
+ *   strategy->add_message(image);
+ * }
+ * auto sub = node->create_subscription<sensor_msgs::msg::Image>(
+ *   "image", 10, callback, rclcpp::SubscriptionOptions(), strategy);
+ * ```
+ *
+ * When all the instances are in use, a new message is allocated and kept for reuse, up to
+ * `max_size` instances (0 for no limit).
+ * An instance is in use while someone other than the strategy references it, so a callback can
+ * keep the messages it receives.
+ */
+template<typename MessageT, typename Alloc = std::allocator<void>>
+class RecycledMessageMemoryStrategy
+  : public message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(RecycledMessageMemoryStrategy)
+
+  /// Constructor.
+  /**
+   * \param[in] max_size maximum number of recycled instances, 0 for no limit.
+   * \param[in] allocator used to allocate the messages when no instance is free.
+   */
+  explicit RecycledMessageMemoryStrategy(
+    size_t max_size = 0,
+    std::shared_ptr<Alloc> allocator = std::make_shared<Alloc>())
+  : message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>(allocator),
+    max_size_(max_size),
+    allocated_count_(0)
+  {}
+
+  /// Add a message instance to recycle, e.g. with preallocated sequences.
+  /**
+   * \param[in] message the instance, which must not be used by anyone else afterwards.
+   * \throws std::invalid_argument if the message is null.
+   * \throws std::length_error if the strategy has already `max_size` instances.
+   */
+  void add_message(std::shared_ptr<MessageT> message)
+  {
+    if (!message) {
+      throw std::invalid_argument("message argument is null");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (max_size_ != 0 && messages_.size() >= max_size_) {
+      throw std::length_error("the strategy has already its maximum number of messages");
+    }
+    messages_.push_back(std::move(message));
+  }
+
+  /// Borrow a free instance as is, or allocate a new message if none is free.
+  std::shared_ptr<MessageT> borrow_message() override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto & message : messages_) {
+      if (message.use_count() == 1) {
+        return message;
+      }
+    }
+    allocated_count_++;
+    auto message =
+      message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>::borrow_message();
+    if (max_size_ == 0 || messages_.size() < max_size_) {
+      messages_.push_back(message);
+    }
+    return message;
+  }
+
+  /// Release the reference to the message, the instance is free once no one else references it.
+  void return_message(std::shared_ptr<MessageT> & msg) override
+  {
+    msg.reset();
+  }
+
+  /// Return the number of recycled instances.
+  size_t get_message_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return messages_.size();
+  }
+
+  /// Return the number of messages which were allocated because no instance was free.
+  size_t get_allocated_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocated_count_;
+  }
+
+  /// Return the bytes of the recycled instances, without the memory of their sequences.
+  size_t get_memory_usage() const override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return messages_.size() * sizeof(MessageT);
+  }
+
+private:
+  const size_t max_size_;
+  std::vector<std::shared_ptr<MessageT>> messages_;
+  size_t allocated_count_;
+  mutable std::mutex mutex_;
+};
+
+/// Dynamic message pools of a node, one per message type.
+/**
+ * It creates the pool of a message type the first time it is requested, with the same
+ * configuration for all the types, so all the subscriptions can use a message pool without
+ * sizing each of them:
+ *
+ * ```cpp
+ * auto pools = std::make_shared<DynamicMessagePoolRegistry>();
+ * auto sub = node->create_subscription<MsgT>(
+ *   "chatter", 10, callback, rclcpp::SubscriptionOptions(), pools->get<MsgT>());
+ * ```
+ */
+class DynamicMessagePoolRegistry
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(DynamicMessagePoolRegistry)
+
+  /// Constructor.
+  /**
+   * \param[in] chunk_size passed to the constructor of each pool.
+   * \param[in] max_size passed to the constructor of each pool.
+   */
+  explicit DynamicMessagePoolRegistry(size_t chunk_size = 16, size_t max_size = 0)
+  : chunk_size_(chunk_size), max_size_(max_size)
+  {}
+
+  /// Return the pool of a message type, creating it if needed.
+  template<typename MessageT, typename Alloc = std::allocator<void>>
+  typename DynamicMessagePoolMemoryStrategy<MessageT, Alloc>::SharedPtr
+  get()
+  {
+    using StrategyT = DynamicMessagePoolMemoryStrategy<MessageT, Alloc>;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto & strategy = strategies_[std::type_index(typeid(StrategyT))];
+    if (!strategy) {
+      strategy = std::make_shared<StrategyT>(chunk_size_, max_size_);
+    }
+    return std::static_pointer_cast<StrategyT>(strategy);
+  }
+
+private:
+  const size_t chunk_size_;
+  const size_t max_size_;
+  std::unordered_map<std::type_index, std::shared_ptr<void>> strategies_;
+  std::mutex mutex_;
+};
+
 }  // namespace message_pool_memory_strategy
 }  // namespace strategies
 }  // namespace rclcpp
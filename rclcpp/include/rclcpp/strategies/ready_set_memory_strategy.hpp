@@ -0,0 +1,508 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__STRATEGIES__READY_SET_MEMORY_STRATEGY_HPP_
+#define RCLCPP__STRATEGIES__READY_SET_MEMORY_STRATEGY_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "rcl/allocator.h"
+#include "rcl/error_handling.h"
+#include "rcl/wait.h"
+
+#include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/memory_strategy.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+#include "rcutils/logging_macros.h"
+
+namespace rclcpp
+{
+namespace memory_strategies
+{
+namespace ready_set_memory_strategy
+{
+
+/// Memory strategy which keeps the result of the wait in a bitmap of ready entities.
+/**
+ * The entities collected from the nodes are kept in the order they are added to the wait set,
+ * together with their callback group and node.
+ * After the wait, one bit per entity records whether the wait set reported it ready, and the
+ * get_next_*() functions go through the set bits with find-first-set.
+ * Nothing is erased from the collected entities, so the cost of dispatching depends on the
+ * number of ready entities rather than on the number of collected entities.
+ */
+template<typename Alloc = std::allocator<void>>
+class ReadySetMemoryStrategy : public memory_strategy::MemoryStrategy
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(ReadySetMemoryStrategy<Alloc>)
+
+  using VoidAllocTraits = typename allocator::AllocRebind<void *, Alloc>;
+  using VoidAlloc = typename VoidAllocTraits::allocator_type;
+
+  explicit ReadySetMemoryStrategy(std::shared_ptr<Alloc> allocator)
+  {
+    allocator_ = std::make_shared<VoidAlloc>(*allocator.get());
+  }
+
+  ReadySetMemoryStrategy()
+  {
+    allocator_ = std::make_shared<VoidAlloc>();
+  }
+
+  void add_guard_condition(const rcl_guard_condition_t * guard_condition) override
+  {
+    for (const auto & existing_guard_condition : guard_conditions_) {
+      if (existing_guard_condition == guard_condition) {
+        return;
+      }
+    }
+    guard_conditions_.push_back(guard_condition);
+  }
+
+  void remove_guard_condition(const rcl_guard_condition_t * guard_condition) override
+  {
+    for (auto it = guard_conditions_.begin(); it != guard_conditions_.end(); ++it) {
+      if (*it == guard_condition) {
+        guard_conditions_.erase(it);
+        break;
+      }
+    }
+  }
+
+  void clear_handles() override
+  {
+    subscriptions_.clear();
+    shared_reader_handles_.clear();
+    services_.clear();
+    clients_.clear();
+    timers_.clear();
+    waitables_.clear();
+    ready_subscriptions_.clear();
+    ready_services_.clear();
+    ready_clients_.clear();
+    ready_timers_.clear();
+    ready_waitables_.clear();
+  }
+
+  void remove_null_handles(rcl_wait_set_t * wait_set) override
+  {
+    // Only the entities collected by this strategy are looked at, Waitables may have added more
+    // entities to the end of the wait set.
+    ready_subscriptions_.reset(subscriptions_.size());
+    for (size_t i = 0; i < subscriptions_.size(); ++i) {
+      if (wait_set->subscriptions[i]) {
+        ready_subscriptions_.set(i);
+      }
+    }
+    ready_services_.reset(services_.size());
+    for (size_t i = 0; i < services_.size(); ++i) {
+      if (wait_set->services[i]) {
+        ready_services_.set(i);
+      }
+    }
+    ready_clients_.reset(clients_.size());
+    for (size_t i = 0; i < clients_.size(); ++i) {
+      if (wait_set->clients[i]) {
+        ready_clients_.set(i);
+      }
+    }
+    ready_timers_.reset(timers_.size());
+    for (size_t i = 0; i < timers_.size(); ++i) {
+      if (wait_set->timers[i]) {
+        ready_timers_.set(i);
+      }
+    }
+    ready_waitables_.reset(waitables_.size());
+    for (size_t i = 0; i < waitables_.size(); ++i) {
+      if (waitables_[i].handle->is_ready(wait_set)) {
+        ready_waitables_.set(i);
+      }
+    }
+  }
+
+  bool collect_entities(const WeakNodeList & weak_nodes) override
+  {
+    bool has_invalid_weak_nodes = false;
+    for (auto & weak_node : weak_nodes) {
+      auto node = weak_node.lock();
+      if (!node) {
+        has_invalid_weak_nodes = true;
+        continue;
+      }
+      for (auto & weak_group : node->get_callback_groups()) {
+        auto group = weak_group.lock();
+        if (!group || !group->can_be_taken_from().load() || !group->is_assigned_to(executor_)) {
+          continue;
+        }
+        group->find_subscription_ptrs_if(
+          [this, &group, &node](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
+            auto handle = subscription->get_subscription_handle();
+            // A reader shared by several subscriptions is waited on once.
+            if (subscription->has_shared_reader()) {
+              if (
+                std::find(
+                  shared_reader_handles_.begin(), shared_reader_handles_.end(), handle.get()) !=
+                shared_reader_handles_.end())
+              {
+                return false;
+              }
+              shared_reader_handles_.push_back(handle.get());
+            }
+            subscriptions_.push_back({std::move(handle), subscription, group, node});
+            return false;
+          });
+        group->find_service_ptrs_if(
+          [this, &group, &node](const rclcpp::ServiceBase::SharedPtr & service) {
+            services_.push_back({service->get_service_handle(), service, group, node});
+            return false;
+          });
+        group->find_client_ptrs_if(
+          [this, &group, &node](const rclcpp::ClientBase::SharedPtr & client) {
+            clients_.push_back({client->get_client_handle(), client, group, node});
+            return false;
+          });
+        group->find_timer_ptrs_if(
+          [this, &group, &node](const rclcpp::TimerBase::SharedPtr & timer) {
+            timers_.push_back({timer->get_timer_handle(), timer, group, node});
+            return false;
+          });
+        group->find_waitable_ptrs_if(
+          [this, &group, &node](const rclcpp::Waitable::SharedPtr & waitable) {
+            waitables_.push_back({waitable, waitable, group, node});
+            return false;
+          });
+      }
+    }
+    return has_invalid_weak_nodes;
+  }
+
+  void add_waitable_handle(const rclcpp::Waitable::SharedPtr & waitable) override
+  {
+    if (nullptr == waitable) {
+      throw std::runtime_error("waitable object unexpectedly nullptr");
+    }
+    // Without a callback group it is waited on, but never executed.
+    waitables_.push_back({waitable, waitable, {}, {}});
+  }
+
+  bool add_handles_to_wait_set(rcl_wait_set_t * wait_set) override
+  {
+    for (auto & subscription : subscriptions_) {
+      if (rcl_wait_set_add_subscription(wait_set, subscription.handle.get(), NULL) != RCL_RET_OK) {
+        RCUTILS_LOG_ERROR_NAMED(
+          "rclcpp",
+          "Couldn't add subscription to wait set: %s", rcl_get_error_string().str);
+        return false;
+      }
+    }
+
+    for (auto & client : clients_) {
+      if (rcl_wait_set_add_client(wait_set, client.handle.get(), NULL) != RCL_RET_OK) {
+        RCUTILS_LOG_ERROR_NAMED(
+          "rclcpp",
+          "Couldn't add client to wait set: %s", rcl_get_error_string().str);
+        return false;
+      }
+    }
+
+    for (auto & service : services_) {
+      if (rcl_wait_set_add_service(wait_set, service.handle.get(), NULL) != RCL_RET_OK) {
+        RCUTILS_LOG_ERROR_NAMED(
+          "rclcpp",
+          "Couldn't add service to wait set: %s", rcl_get_error_string().str);
+        return false;
+      }
+    }
+
+    for (auto & timer : timers_) {
+      if (rcl_wait_set_add_timer(wait_set, timer.handle.get(), NULL) != RCL_RET_OK) {
+        RCUTILS_LOG_ERROR_NAMED(
+          "rclcpp",
+          "Couldn't add timer to wait set: %s", rcl_get_error_string().str);
+        return false;
+      }
+    }
+
+    for (auto guard_condition : guard_conditions_) {
+      if (rcl_wait_set_add_guard_condition(wait_set, guard_condition, NULL) != RCL_RET_OK) {
+        RCUTILS_LOG_ERROR_NAMED(
+          "rclcpp",
+          "Couldn't add guard_condition to wait set: %s",
+          rcl_get_error_string().str);
+        return false;
+      }
+    }
+
+    for (auto & waitable : waitables_) {
+      if (!waitable.handle->add_to_wait_set(wait_set)) {
+        RCUTILS_LOG_ERROR_NAMED(
+          "rclcpp",
+          "Couldn't add waitable to wait set: %s", rcl_get_error_string().str);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void
+  get_next_subscription(executor::AnyExecutable & any_exec, const WeakNodeList &) override
+  {
+    any_exec.subscription = take_next_ready(subscriptions_, ready_subscriptions_, any_exec);
+  }
+
+  void
+  get_next_service(executor::AnyExecutable & any_exec, const WeakNodeList &) override
+  {
+    any_exec.service = take_next_ready(services_, ready_services_, any_exec);
+  }
+
+  void
+  get_next_client(executor::AnyExecutable & any_exec, const WeakNodeList &) override
+  {
+    any_exec.client = take_next_ready(clients_, ready_clients_, any_exec);
+  }
+
+  void
+  get_next_timer(executor::AnyExecutable & any_exec, const WeakNodeList &) override
+  {
+    any_exec.timer = take_next_ready(timers_, ready_timers_, any_exec);
+  }
+
+  void
+  get_next_waitable(executor::AnyExecutable & any_exec, const WeakNodeList &) override
+  {
+    any_exec.waitable = take_next_ready(waitables_, ready_waitables_, any_exec);
+  }
+
+  rcl_allocator_t get_allocator() override
+  {
+    return rclcpp::allocator::get_rcl_allocator<void *, VoidAlloc>(*allocator_.get());
+  }
+
+  size_t number_of_ready_subscriptions() const override
+  {
+    size_t number_of_subscriptions = subscriptions_.size();
+    for (auto & waitable : waitables_) {
+      number_of_subscriptions += waitable.handle->get_number_of_ready_subscriptions();
+    }
+    return number_of_subscriptions;
+  }
+
+  size_t number_of_ready_services() const override
+  {
+    size_t number_of_services = services_.size();
+    for (auto & waitable : waitables_) {
+      number_of_services += waitable.handle->get_number_of_ready_services();
+    }
+    return number_of_services;
+  }
+
+  size_t number_of_ready_events() const override
+  {
+    size_t number_of_events = 0;
+    for (auto & waitable : waitables_) {
+      number_of_events += waitable.handle->get_number_of_ready_events();
+    }
+    return number_of_events;
+  }
+
+  size_t number_of_ready_clients() const override
+  {
+    size_t number_of_clients = clients_.size();
+    for (auto & waitable : waitables_) {
+      number_of_clients += waitable.handle->get_number_of_ready_clients();
+    }
+    return number_of_clients;
+  }
+
+  size_t number_of_guard_conditions() const override
+  {
+    size_t number_of_guard_conditions = guard_conditions_.size();
+    for (auto & waitable : waitables_) {
+      number_of_guard_conditions += waitable.handle->get_number_of_ready_guard_conditions();
+    }
+    return number_of_guard_conditions;
+  }
+
+  size_t number_of_ready_timers() const override
+  {
+    size_t number_of_timers = timers_.size();
+    for (auto & waitable : waitables_) {
+      number_of_timers += waitable.handle->get_number_of_ready_timers();
+    }
+    return number_of_timers;
+  }
+
+  size_t number_of_waitables() const override
+  {
+    return waitables_.size();
+  }
+
+private:
+  template<typename T>
+  using VectorRebind =
+    std::vector<T, typename std::allocator_traits<Alloc>::template rebind_alloc<T>>;
+
+  /// A collected entity, with the handle added to the wait set.
+  template<typename HandleT, typename EntityT>
+  struct CollectedEntity
+  {
+    std::shared_ptr<HandleT> handle;
+    std::weak_ptr<EntityT> entity;
+    rclcpp::callback_group::CallbackGroup::WeakPtr group;
+    rclcpp::node_interfaces::NodeBaseInterface::WeakPtr node;
+  };
+
+  /// One bit per collected entity of a kind, set if the entity is ready.
+  class ReadySet
+  {
+public:
+    static constexpr size_t bits_per_word = 64;
+
+    void
+    reset(size_t size)
+    {
+      words_.assign((size + bits_per_word - 1) / bits_per_word, 0);
+      count_ = 0;
+    }
+
+    void
+    clear()
+    {
+      words_.clear();
+      count_ = 0;
+    }
+
+    void
+    set(size_t index)
+    {
+      words_[index / bits_per_word] |= uint64_t(1) << (index % bits_per_word);
+      ++count_;
+    }
+
+    void
+    unset(size_t index)
+    {
+      words_[index / bits_per_word] &= ~(uint64_t(1) << (index % bits_per_word));
+      --count_;
+    }
+
+    /// Call f(index) for the set bits in increasing order until it returns true.
+    template<typename FunctorT>
+    void
+    find_if(FunctorT f)
+    {
+      if (!count_) {
+        return;
+      }
+      for (size_t word_index = 0; word_index < words_.size(); ++word_index) {
+        uint64_t word = words_[word_index];
+        while (word) {
+          size_t index = word_index * bits_per_word + find_first_set(word);
+          // Clear the lowest set bit.
+          word &= word - 1;
+          if (f(index)) {
+            return;
+          }
+        }
+      }
+    }
+
+private:
+    /// Return the index of the lowest set bit, the word must not be zero.
+    static size_t
+    find_first_set(uint64_t word)
+    {
+#ifdef _MSC_VER
+      unsigned long index;
+      _BitScanForward64(&index, word);
+      return index;
+#else
+      return static_cast<size_t>(__builtin_ctzll(word));
+#endif
+    }
+
+    VectorRebind<uint64_t> words_;
+    size_t count_ = 0;
+  };
+
+  /// Return the first ready entity whose group can be taken from, and unset it.
+  template<typename HandleT, typename EntityT>
+  static std::shared_ptr<EntityT>
+  take_next_ready(
+    const VectorRebind<CollectedEntity<HandleT, EntityT>> & entities,
+    ReadySet & ready,
+    executor::AnyExecutable & any_exec)
+  {
+    std::shared_ptr<EntityT> next;
+    ready.find_if(
+      [&entities, &ready, &any_exec, &next](size_t index) {
+        const auto & collected = entities[index];
+        auto entity = collected.entity.lock();
+        auto group = collected.group.lock();
+        if (!entity || !group) {
+          // The entity or its group is no longer valid, forget it
+          ready.unset(index);
+          return false;
+        }
+        if (!group->can_be_taken_from().load()) {
+          // Group is mutually exclusive and is being used, so skip it for now
+          // Leave it to be checked next time, but continue searching
+          return false;
+        }
+        any_exec.callback_group = std::move(group);
+        any_exec.node_base = collected.node.lock();
+        next = std::move(entity);
+        ready.unset(index);
+        return true;
+      });
+    return next;
+  }
+
+  VectorRebind<const rcl_guard_condition_t *> guard_conditions_;
+
+  VectorRebind<CollectedEntity<rcl_subscription_t, rclcpp::SubscriptionBase>> subscriptions_;
+  /// The shared readers collected, few in general, see SubscriptionBase::has_shared_reader().
+  VectorRebind<const rcl_subscription_t *> shared_reader_handles_;
+  VectorRebind<CollectedEntity<rcl_service_t, rclcpp::ServiceBase>> services_;
+  VectorRebind<CollectedEntity<rcl_client_t, rclcpp::ClientBase>> clients_;
+  VectorRebind<CollectedEntity<const rcl_timer_t, rclcpp::TimerBase>> timers_;
+  VectorRebind<CollectedEntity<rclcpp::Waitable, rclcpp::Waitable>> waitables_;
+
+  ReadySet ready_subscriptions_;
+  ReadySet ready_services_;
+  ReadySet ready_clients_;
+  ReadySet ready_timers_;
+  ReadySet ready_waitables_;
+
+  std::shared_ptr<VoidAlloc> allocator_;
+};
+
+}  // namespace ready_set_memory_strategy
+}  // namespace memory_strategies
+}  // namespace rclcpp
+
+#endif  // RCLCPP__STRATEGIES__READY_SET_MEMORY_STRATEGY_HPP_
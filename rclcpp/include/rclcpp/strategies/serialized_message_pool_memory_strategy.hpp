@@ -0,0 +1,293 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__STRATEGIES__SERIALIZED_MESSAGE_POOL_MEMORY_STRATEGY_HPP_
+#define RCLCPP__STRATEGIES__SERIALIZED_MESSAGE_POOL_MEMORY_STRATEGY_HPP_
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "rcl/types.h"
+
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/message_memory_strategy.hpp"
+
+#include "rcutils/logging_macros.h"
+
+#include "rmw/serialized_message.h"
+
+namespace rclcpp
+{
+namespace strategies
+{
+namespace serialized_message_pool_memory_strategy
+{
+
+/// Memory strategy reusing the buffers of serialized messages across takes.
+/**
+ * Serialized messages returned to the strategy keep their buffer, and are borrowed again
+ * instead of allocating a new buffer which the middleware grows while taking a message.
+ * Up to `max_pool_size` messages are kept, the messages borrowed beyond that are released when
+ * they are returned.
+ *
+ * The strategy keeps the largest payload of the last `window_size` messages returned to it.
+ * When no capacity is requested, the buffers are sized to the next power of two of that
+ * payload, at least the default buffer capacity, so the buffers follow the size of the
+ * messages received by the subscription using the strategy.
+ * Pooled buffers which are more than 4 times larger than needed are shrunk.
+ *
+ * A message returned while still referenced elsewhere, e.g. by a callback, is reused only
+ * once it is released.
+ */
+template<typename MessageT, typename Alloc = std::allocator<void>>
+class SerializedMessagePoolMemoryStrategy
+  : public message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(SerializedMessagePoolMemoryStrategy)
+
+  /// Constructor.
+  /**
+   * \param[in] max_pool_size maximum number of serialized messages kept for reuse.
+   * \param[in] window_size number of messages over which the largest payload is kept.
+   * \param[in] allocator used to allocate the messages and the buffers.
+   * \throws std::invalid_argument if the window size is zero.
+   */
+  explicit SerializedMessagePoolMemoryStrategy(
+    size_t max_pool_size = 16,
+    size_t window_size = 64,
+    std::shared_ptr<Alloc> allocator = std::make_shared<Alloc>())
+  : message_memory_strategy::MessageMemoryStrategy<MessageT, Alloc>(allocator),
+    max_pool_size_(max_pool_size),
+    window_size_(window_size)
+  {
+    if (window_size_ == 0) {
+      throw std::invalid_argument("window_size must be a positive, non-zero value");
+    }
+    pool_.reserve(max_pool_size_);
+    free_indexes_.reserve(max_pool_size_);
+  }
+
+  /// Borrow a serialized message with a buffer of at least `capacity` bytes.
+  std::shared_ptr<rcl_serialized_message_t> borrow_serialized_message(size_t capacity) override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return borrow_serialized_message_unlocked(capacity);
+  }
+
+  /// Borrow a serialized message with a buffer sized after the recent payloads.
+  std::shared_ptr<rcl_serialized_message_t> borrow_serialized_message() override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return borrow_serialized_message_unlocked(get_capacity_hint_unlocked());
+  }
+
+  /// Give back a serialized message, keeping its buffer for the next takes.
+  /** \param[in] serialized_msg the message to return, it is reset. */
+  void return_serialized_message(
+    std::shared_ptr<rcl_serialized_message_t> & serialized_msg) override
+  {
+    auto deleter = std::get_deleter<PooledBufferDeleter>(serialized_msg);
+    if (deleter) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      observe_payload(serialized_msg->buffer_length);
+      if (serialized_msg->buffer_capacity > deleter->borrowed_capacity) {
+        take_reallocation_count_++;
+      }
+      if (deleter->index < pool_.size() && pool_[deleter->index] == serialized_msg) {
+        free_indexes_.push_back(deleter->index);
+      }
+    }
+    serialized_msg.reset();
+  }
+
+  /// Return the capacity of the buffers borrowed without requesting a capacity.
+  size_t get_capacity_hint() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return get_capacity_hint_unlocked();
+  }
+
+  /// Return the number of serialized messages allocated.
+  size_t get_allocation_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocation_count_;
+  }
+
+  /// Return the number of times a pooled buffer was resized when it was borrowed.
+  size_t get_reallocation_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reallocation_count_;
+  }
+
+  /// Return the number of buffers which were grown while they were borrowed.
+  /**
+   * It is the number of takes for which the middleware had to grow the buffer.
+   */
+  size_t get_take_reallocation_count() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return take_reallocation_count_;
+  }
+
+  /// Return the number of serialized messages kept for reuse.
+  size_t get_pool_size() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pool_.size();
+  }
+
+  /// Return the bytes of the serialized messages kept for reuse, including their buffers.
+  size_t get_memory_usage() const override
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t bytes = 0;
+    for (const auto & serialized_msg : pool_) {
+      bytes += sizeof(rcl_serialized_message_t) + serialized_msg->buffer_capacity;
+    }
+    return bytes;
+  }
+
+protected:
+  struct PooledBufferDeleter
+  {
+    void operator()(rcl_serialized_message_t * msg)
+    {
+      auto fini_ret = rmw_serialized_message_fini(msg);
+      delete msg;
+      if (fini_ret != RCL_RET_OK) {
+        RCUTILS_LOG_ERROR_NAMED(
+          "rclcpp",
+          "failed to destroy serialized message: %s", rcl_get_error_string().str);
+      }
+    }
+
+    size_t index;
+    size_t borrowed_capacity;
+  };
+
+  static constexpr size_t not_pooled = std::numeric_limits<size_t>::max();
+
+  std::shared_ptr<rcl_serialized_message_t>
+  borrow_serialized_message_unlocked(size_t capacity)
+  {
+    auto serialized_msg = take_free_message();
+    if (serialized_msg) {
+      bool too_small = serialized_msg->buffer_capacity < capacity;
+      bool too_large = capacity > 0 && serialized_msg->buffer_capacity / 4 > capacity;
+      if (too_small || too_large) {
+        auto ret = rmw_serialized_message_resize(serialized_msg.get(), capacity);
+        if (ret != RCL_RET_OK) {
+          rclcpp::exceptions::throw_from_rcl_error(ret);
+        }
+        reallocation_count_++;
+      }
+      serialized_msg->buffer_length = 0;
+    } else {
+      serialized_msg = create_serialized_message(capacity);
+    }
+    std::get_deleter<PooledBufferDeleter>(serialized_msg)->borrowed_capacity =
+      serialized_msg->buffer_capacity;
+    return serialized_msg;
+  }
+
+  std::shared_ptr<rcl_serialized_message_t>
+  create_serialized_message(size_t capacity)
+  {
+    auto msg = new rcl_serialized_message_t;
+    *msg = rmw_get_zero_initialized_serialized_message();
+    auto ret = rmw_serialized_message_init(msg, capacity, &this->rcutils_allocator_);
+    if (ret != RCL_RET_OK) {
+      delete msg;
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
+    allocation_count_++;
+
+    size_t index = pool_.size() < max_pool_size_ ? pool_.size() : not_pooled;
+    auto serialized_msg = std::shared_ptr<rcl_serialized_message_t>(
+      msg, PooledBufferDeleter{index, capacity});
+    if (index != not_pooled) {
+      pool_.push_back(serialized_msg);
+    }
+    return serialized_msg;
+  }
+
+  /// Take the most recently returned message which isn't used anymore, nullptr if none.
+  std::shared_ptr<rcl_serialized_message_t>
+  take_free_message()
+  {
+    for (size_t i = free_indexes_.size(); i > 0; --i) {
+      auto & serialized_msg = pool_[free_indexes_[i - 1]];
+      if (serialized_msg.use_count() == 1) {
+        free_indexes_[i - 1] = free_indexes_.back();
+        free_indexes_.pop_back();
+        return serialized_msg;
+      }
+    }
+    return nullptr;
+  }
+
+  void
+  observe_payload(size_t length)
+  {
+    current_window_peak_ = std::max(current_window_peak_, length);
+    if (++current_window_count_ == window_size_) {
+      previous_window_peak_ = current_window_peak_;
+      current_window_peak_ = 0;
+      current_window_count_ = 0;
+    }
+  }
+
+  size_t
+  get_capacity_hint_unlocked() const
+  {
+    size_t peak = std::max(previous_window_peak_, current_window_peak_);
+    size_t capacity = 1;
+    while (capacity < peak) {
+      capacity <<= 1;
+    }
+    return peak == 0 ? this->default_buffer_capacity_ :
+           std::max(capacity, this->default_buffer_capacity_);
+  }
+
+  const size_t max_pool_size_;
+  const size_t window_size_;
+  std::vector<std::shared_ptr<rcl_serialized_message_t>> pool_;
+  std::vector<size_t> free_indexes_;
+
+  size_t current_window_peak_ = 0;
+  size_t current_window_count_ = 0;
+  size_t previous_window_peak_ = 0;
+
+  size_t allocation_count_ = 0;
+  size_t reallocation_count_ = 0;
+  size_t take_reallocation_count_ = 0;
+  mutable std::mutex mutex_;
+};
+
+template<typename MessageT, typename Alloc>
+constexpr size_t SerializedMessagePoolMemoryStrategy<MessageT, Alloc>::not_pooled;
+
+}  // namespace serialized_message_pool_memory_strategy
+}  // namespace strategies
+}  // namespace rclcpp
+
+#endif  // RCLCPP__STRATEGIES__SERIALIZED_MESSAGE_POOL_MEMORY_STRATEGY_HPP_
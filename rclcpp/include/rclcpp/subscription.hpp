@@ -18,12 +18,16 @@
 #include <rmw/error_handling.h>
 #include <rmw/rmw.h>
 
+#include <algorithm>
+#include <chrono>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 
 #include "rcl/error_handling.h"
@@ -38,11 +42,15 @@
 #include "rclcpp/experimental/subscription_intra_process.hpp"
 #include "rclcpp/logging.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/message_info.hpp"
 #include "rclcpp/message_memory_strategy.hpp"
+#include "rclcpp/message_rate_limiter.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/subscription_base.hpp"
+#include "rclcpp/subscription_loaned_message.hpp"
 #include "rclcpp/subscription_options.hpp"
 #include "rclcpp/subscription_traits.hpp"
+#include "rclcpp/type_adapter.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/visibility_control.hpp"
 #include "rclcpp/waitable.hpp"
@@ -57,11 +65,17 @@ class NodeTopicsInterface;
 }  // namespace node_interfaces
 
 /// Subscription implementation, templated on the type of message this subscription receives.
+/**
+ * MessageT may be a TypeAdapter, or a custom type with an implicit adapter, the callback then
+ * takes the custom type.
+ * The messages taken from the middleware are converted from the ROS message type, the ones
+ * given by intra-process publishers of the custom type are not.
+ */
 template<
-  typename CallbackMessageT,
+  typename MessageT,
   typename AllocatorT = std::allocator<void>,
   typename MessageMemoryStrategyT = rclcpp::message_memory_strategy::MessageMemoryStrategy<
-    CallbackMessageT,
+    typename rclcpp::TypeAdapter<MessageT>::custom_type,
     AllocatorT
   >>
 class Subscription : public SubscriptionBase
@@ -69,6 +83,12 @@ class Subscription : public SubscriptionBase
   friend class rclcpp::node_interfaces::NodeTopicsInterface;
 
 public:
+  /// Type of the messages given to the callback.
+  using CallbackMessageT = typename rclcpp::TypeAdapter<MessageT>::custom_type;
+  /// Type of the messages taken from the middleware.
+  using ROSMessageType = typename rclcpp::TypeAdapter<MessageT>::ros_message_type;
+  using IsAdapted = typename rclcpp::TypeAdapter<MessageT>::is_specialized;
+
   using MessageAllocatorTraits = allocator::AllocRebind<CallbackMessageT, AllocatorT>;
   using MessageAllocator = typename MessageAllocatorTraits::allocator_type;
   using MessageDeleter = allocator::Deleter<MessageAllocator, CallbackMessageT>;
@@ -102,12 +122,45 @@ public:
       node_base,
       type_support_handle,
       topic_name,
-      options.template to_rcl_subscription_options<CallbackMessageT>(qos),
-      rclcpp::subscription_traits::is_serialized_subscription_argument<CallbackMessageT>::value),
+      options.template to_rcl_subscription_options<ROSMessageType>(qos),
+      rclcpp::subscription_traits::is_serialized_subscription_argument<CallbackMessageT>::value,
+      options.share_reader),
     any_callback_(callback),
     options_(options),
     message_memory_strategy_(message_memory_strategy)
   {
+    if (options.share_reader && (IsAdapted::value || this->is_serialized())) {
+      throw std::invalid_argument(
+              "sharing the reader is not allowed with a type adapted or serialized message type");
+    }
+    if (IsAdapted::value) {
+      // The messages are taken as ROS messages, then converted to the custom type.
+      ros_message_memory_strategy_ = message_memory_strategy::MessageMemoryStrategy<
+        ROSMessageType, AllocatorT>::create_default();
+    }
+    this->set_max_messages_per_execution(options.max_messages_per_execution);
+    if (any_callback_.is_batch_callback()) {
+      if (options.keep_latest) {
+        throw std::invalid_argument(
+                "keeping the latest message is not allowed with a callback taking a batch");
+      }
+      // Take enough messages in an execution to fill a batch.
+      this->set_max_messages_per_execution(
+        std::max(options.max_messages_per_execution, options.batching.max_count));
+    }
+    if (options.keep_latest) {
+      // Drain the history of the subscription, so that only its newest message is given.
+      this->set_max_messages_per_execution(
+        std::max(options.max_messages_per_execution, get_actual_qos().get_rmw_qos_profile().depth));
+    }
+    this->set_content_filter(options.content_filter);
+    if (options.topic_statistics.enabled) {
+      topic_statistics_ = std::make_shared<rclcpp::TopicStatisticsCollector>(
+        node_base, this->get_topic_name(), options.topic_statistics);
+    }
+    if (options.rate_limit.is_enabled()) {
+      rate_limiter_ = std::make_shared<rclcpp::MessageRateLimiter>(options.rate_limit);
+    }
     if (options.event_callbacks.deadline_callback) {
       this->add_event_handler(
         options.event_callbacks.deadline_callback,
@@ -124,23 +177,28 @@ public:
         RCL_SUBSCRIPTION_REQUESTED_INCOMPATIBLE_QOS);
     }
 
-    // Setup intra process publishing if requested.
-    if (rclcpp::detail::resolve_use_intra_process(options, *node_base)) {
+    // Setup intra process publishing if requested, a shared reader gives its messages through it.
+    if (options.share_reader || rclcpp::detail::resolve_use_intra_process(options, *node_base)) {
       using rclcpp::detail::resolve_intra_process_buffer_type;
 
       // Check if the QoS is compatible with intra-process.
       rmw_qos_profile_t qos_profile = get_actual_qos().get_rmw_qos_profile();
-      if (qos_profile.history == RMW_QOS_POLICY_HISTORY_KEEP_ALL) {
+      // A KEEP_ALL history is buffered without limit, see resolve_buffer_implementation().
+      if (qos_profile.history != RMW_QOS_POLICY_HISTORY_KEEP_ALL && qos_profile.depth == 0) {
         throw std::invalid_argument(
-                "intraprocess communication is not allowed with keep all history qos policy");
+                "intraprocess communication is not allowed with 0 depth qos policy");
       }
-      if (qos_profile.depth == 0) {
+      if (
+        qos_profile.durability != RMW_QOS_POLICY_DURABILITY_VOLATILE &&
+        qos_profile.durability != RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL)
+      {
         throw std::invalid_argument(
-                "intraprocess communication is not allowed with 0 depth qos policy");
+                "intraprocess communication allowed only with volatile or transient local "
+                "durability");
       }
-      if (qos_profile.durability != RMW_QOS_POLICY_DURABILITY_VOLATILE) {
+      if (options.content_filter) {
         throw std::invalid_argument(
-                "intraprocess communication allowed only with volatile durability");
+                "intraprocess communication is not allowed with a content filter");
       }
 
       // First create a SubscriptionIntraProcess which will be given to the intra-process manager.
@@ -156,8 +214,37 @@ public:
         context,
         this->get_topic_name(),    // important to get like this, as it has the fully-qualified name
         qos_profile,
-        resolve_intra_process_buffer_type(options.intra_process_buffer_type, callback)
+        resolve_intra_process_buffer_type(options.intra_process_buffer_type, callback),
+        options.keep_latest ?
+        rclcpp::IntraProcessBufferImplementation::LatestValue :
+        options.intra_process_buffer_implementation,
+        options.batching.max_count
         );
+      subscription_intra_process->set_topic_statistics(topic_statistics_);
+      subscription_intra_process->set_rate_limiter(rate_limiter_);
+      subscription_intra_process->set_overflow_policy(
+        options.intra_process_backpressure.overflow_policy,
+        options.intra_process_backpressure.max_block_time);
+      subscription_intra_process->set_message_lost_callback(
+        options.event_callbacks.intra_process_message_lost_callback);
+      if (options.intra_process_synchronous_delivery) {
+        auto group = options.callback_group ?
+          options.callback_group : node_base->get_default_callback_group();
+        subscription_intra_process->set_synchronous_delivery(
+          group, [node_base]() {
+            auto notify_guard_condition_lock = node_base->acquire_notify_guard_condition_lock();
+            if (
+              rcl_trigger_guard_condition(node_base->get_notify_guard_condition()) !=
+              RCL_RET_OK)
+            {
+              RCLCPP_ERROR(
+                rclcpp::get_logger("rclcpp"),
+                "failed to wake up the executor after a synchronous delivery: %s",
+                rcl_get_error_string().str);
+              rcl_reset_error();
+            }
+          });
+      }
       TRACEPOINT(
         rclcpp_subscription_init,
         (const void *)get_subscription_handle().get(),
@@ -168,6 +255,9 @@ public:
       auto ipm = context->get_sub_context<IntraProcessManager>();
       uint64_t intra_process_subscription_id = ipm->add_subscription(subscription_intra_process);
       this->setup_intra_process(intra_process_subscription_id, ipm);
+      if (options.share_reader) {
+        this->add_to_shared_reader(subscription_intra_process);
+      }
     }
 
     TRACEPOINT(
@@ -209,12 +299,38 @@ public:
     message_memory_strategy_ = message_memory_strategy;
   }
 
+  /// Return the number of messages dropped by SubscriptionOptions::rate_limit.
+  size_t
+  get_rate_limit_dropped_count() const
+  {
+    return rate_limiter_ ? rate_limiter_->get_dropped_count() : 0;
+  }
+
+  rclcpp::MemoryUsage
+  get_memory_usage() const override
+  {
+    rclcpp::MemoryUsage usage = SubscriptionBase::get_memory_usage();
+    usage.entity_bytes = sizeof(*this);
+    usage.message_pool_bytes = message_memory_strategy_->get_memory_usage();
+    if (ros_message_memory_strategy_) {
+      usage.message_pool_bytes += ros_message_memory_strategy_->get_memory_usage();
+    }
+    return usage;
+  }
+
   std::shared_ptr<void> create_message() override
   {
     /* The default message memory strategy provides a dynamically allocated message on each call to
      * create_message, though alternative memory strategies that re-use a preallocated message may be
      * used (see rclcpp/strategies/message_pool_memory_strategy.hpp).
      */
+    if (this->has_shared_reader()) {
+      // The message is shared by the subscriptions, a pool can't reuse it once returned.
+      return std::make_shared<ROSMessageType>();
+    }
+    if (ros_message_memory_strategy_) {
+      return ros_message_memory_strategy_->borrow_message();
+    }
     return message_memory_strategy_->borrow_message();
   }
 
@@ -231,25 +347,125 @@ public:
       // we should ignore this copy of the message.
       return;
     }
-    auto typed_message = std::static_pointer_cast<CallbackMessageT>(message);
-    any_callback_.dispatch(typed_message, message_info);
+    if (this->has_shared_reader()) {
+      // Given to the intra-process buffers of all the subscriptions sharing the reader,
+      // including this one.
+      this->provide_shared_reader_message(message);
+      return;
+    }
+    rclcpp::MessageInfo info(message_info);
+    if (rate_limiter_ && !rate_limiter_->accept()) {
+      return;
+    }
+    auto typed_message = this->to_callback_message(message, IsAdapted());
+    if (topic_statistics_) {
+      topic_statistics_->record_message(*typed_message, info);
+    }
+    if (any_callback_.is_batch_callback()) {
+      this->add_to_message_batch(std::move(typed_message));
+      return;
+    }
+    if (options_.keep_latest) {
+      // Replace the message taken before in this execution, dispatch_message_batch() gives it.
+      std::lock_guard<std::mutex> lock(message_batch_mutex_);
+      latest_message_ = std::move(typed_message);
+      latest_message_info_ = info;
+      return;
+    }
+    any_callback_.dispatch(typed_message, info);
   }
 
   void
   handle_loaned_message(
     void * loaned_message, const rmw_message_info_t & message_info) override
   {
+    if (IsAdapted::value) {
+      // The loaned ROS message is only read by the conversion, the loan is never kept.
+      std::shared_ptr<void> message(loaned_message, [](void *) {});
+      this->handle_message(message, message_info);
+      return;
+    }
+    rclcpp::MessageInfo info(message_info);
     auto typed_message = static_cast<CallbackMessageT *>(loaned_message);
+    SubscriptionLoanedMessage<CallbackMessageT> loan;
+    if (any_callback_.is_loaned_message_callback()) {
+      // Own the loan right away, see keeps_loaned_messages(), so that it is returned if the
+      // messages taken before throw.
+      loan = SubscriptionLoanedMessage<CallbackMessageT>(
+        this->get_subscription_handle(), typed_message);
+    }
+    if (rate_limiter_ && !rate_limiter_->accept()) {
+      // The loan, if owned, is returned when leaving.
+      return;
+    }
+    // The loan can't be kept for a later batch, give it alone after the messages taken before.
+    // The loan is newer than a message kept as the latest, which gets dropped.
+    if (options_.keep_latest) {
+      std::lock_guard<std::mutex> lock(message_batch_mutex_);
+      latest_message_.reset();
+    }
+    this->dispatch_message_batch();
+    if (topic_statistics_) {
+      topic_statistics_->record_message(*typed_message, info);
+    }
+    if (loan.is_valid()) {
+      any_callback_.dispatch_loaned(std::move(loan), info);
+      return;
+    }
     // message is loaned, so we have to make sure that the deleter does not deallocate the message
     auto sptr = std::shared_ptr<CallbackMessageT>(
       typed_message, [](CallbackMessageT * msg) {(void) msg;});
-    any_callback_.dispatch(sptr, message_info);
+    any_callback_.dispatch(sptr, info);
+  }
+
+  bool
+  keeps_loaned_messages() const override
+  {
+    return !IsAdapted::value && any_callback_.is_loaned_message_callback();
+  }
+
+  void
+  dispatch_message_batch() override
+  {
+    if (options_.keep_latest) {
+      std::shared_ptr<CallbackMessageT> latest_message;
+      rclcpp::MessageInfo latest_message_info;
+      {
+        std::lock_guard<std::mutex> lock(message_batch_mutex_);
+        if (!latest_message_) {
+          return;
+        }
+        latest_message.swap(latest_message_);
+        latest_message_info = latest_message_info_;
+      }
+      any_callback_.dispatch(latest_message, latest_message_info);
+      return;
+    }
+    std::vector<std::shared_ptr<const CallbackMessageT>> batch;
+    {
+      std::lock_guard<std::mutex> lock(message_batch_mutex_);
+      if (message_batch_.empty()) {
+        return;
+      }
+      batch.swap(message_batch_);
+    }
+    any_callback_.dispatch_batch(std::move(batch));
   }
 
   /// Return the borrowed message.
   /** \param message message to be returned */
   void return_message(std::shared_ptr<void> & message) override
   {
+    if (this->has_shared_reader()) {
+      // See create_message().
+      message.reset();
+      return;
+    }
+    if (ros_message_memory_strategy_) {
+      auto ros_message = std::static_pointer_cast<ROSMessageType>(message);
+      ros_message_memory_strategy_->return_message(ros_message);
+      return;
+    }
     auto typed_message = std::static_pointer_cast<CallbackMessageT>(message);
     message_memory_strategy_->return_message(typed_message);
   }
@@ -264,9 +480,98 @@ public:
     return any_callback_.use_take_shared_method();
   }
 
+  /// Take the next message from the middleware, without an executor.
+  /**
+   * The message is deserialized into the storage of the caller, so that polling the
+   * subscription from a control loop doesn't allocate a message each time.
+   * The callback isn't called and the content filter isn't applied.
+   * The subscription shouldn't be added to an executor, which would take the messages too.
+   *
+   * With intra-process communication, the messages of the publishers of the same context are
+   * only in the intra-process buffer, see take_intra_process().
+   * \param[out] message_out the message, reused if it was already filled.
+   * \param[out] message_info_out the info of the taken message.
+   * \return false if no message was available.
+   * \throws rclcpp::exceptions::RCLError if the middleware failed to take the message.
+   */
+  bool
+  take(ROSMessageType & message_out, rmw_message_info_t & message_info_out)
+  {
+    return this->take_type_erased(&message_out, message_info_out);
+  }
+
+  /// Take the oldest message of the intra-process buffer, without an executor.
+  /**
+   * The message is the one given by the intra-process publisher, it is neither copied nor
+   * deserialized.
+   * The subscription shouldn't be added to an executor, which would take the messages too.
+   * \param[out] message_out the message.
+   * \param[out] message_info_out the info of the message, from_intra_process is true.
+   * \return false if no message was buffered, or if the subscription doesn't use intra-process
+   *   communication.
+   */
+  bool
+  take_intra_process(ConstMessageSharedPtr & message_out, rmw_message_info_t & message_info_out)
+  {
+    using SubscriptionIntraProcessT = rclcpp::experimental::SubscriptionIntraProcess<
+      CallbackMessageT, AllocatorT, typename MessageUniquePtr::deleter_type>;
+    auto waitable = this->get_intra_process_waitable();
+    if (!waitable) {
+      return false;
+    }
+    auto subscription_intra_process = std::static_pointer_cast<SubscriptionIntraProcessT>(
+      waitable);
+    if (!subscription_intra_process->take_message(message_out)) {
+      return false;
+    }
+    message_info_out.publisher_gid = {0, {0}};
+    message_info_out.from_intra_process = true;
+    return true;
+  }
+
 private:
   RCLCPP_DISABLE_COPY(Subscription)
 
+  /// Return the message given by create_message() as the type taken by the callback.
+  std::shared_ptr<CallbackMessageT>
+  to_callback_message(std::shared_ptr<void> & message, std::false_type)
+  {
+    return std::static_pointer_cast<CallbackMessageT>(message);
+  }
+
+  std::shared_ptr<CallbackMessageT>
+  to_callback_message(std::shared_ptr<void> & message, std::true_type)
+  {
+    auto custom_message = message_memory_strategy_->borrow_message();
+    rclcpp::TypeAdapter<MessageT>::convert_to_custom(
+      *std::static_pointer_cast<ROSMessageType>(message), *custom_message);
+    return custom_message;
+  }
+
+  /// Add a message to the batch, giving the batch to the callback if it is full or too old.
+  void
+  add_to_message_batch(std::shared_ptr<const CallbackMessageT> message)
+  {
+    const auto & batching = options_.batching;
+    bool batch_ready;
+    {
+      std::lock_guard<std::mutex> lock(message_batch_mutex_);
+      bool check_age = batching.max_age > std::chrono::nanoseconds::zero();
+      if (message_batch_.empty()) {
+        message_batch_.reserve(std::max<size_t>(batching.max_count, 1));
+        if (check_age) {
+          message_batch_start_ = std::chrono::steady_clock::now();
+        }
+      }
+      message_batch_.push_back(std::move(message));
+      batch_ready = message_batch_.size() >= batching.max_count ||
+        (check_age && std::chrono::steady_clock::now() - message_batch_start_ >= batching.max_age);
+    }
+    if (batch_ready) {
+      this->dispatch_message_batch();
+    }
+  }
+
   AnySubscriptionCallback<CallbackMessageT, AllocatorT> any_callback_;
   /// Copy of original options passed during construction.
   /**
@@ -276,6 +581,19 @@ private:
   const rclcpp::SubscriptionOptionsWithAllocator<AllocatorT> options_;
   typename message_memory_strategy::MessageMemoryStrategy<CallbackMessageT, AllocatorT>::SharedPtr
     message_memory_strategy_;
+  /// Strategy of the ROS messages taken from the middleware, only set if MessageT is adapted.
+  typename message_memory_strategy::MessageMemoryStrategy<ROSMessageType, AllocatorT>::SharedPtr
+    ros_message_memory_strategy_;
+
+  /// Messages taken for a callback taking a batch, which were not given to it yet.
+  std::vector<std::shared_ptr<const CallbackMessageT>> message_batch_;
+  std::chrono::steady_clock::time_point message_batch_start_;
+  /// Latest message taken by the execution in progress, if keeping only the latest message.
+  std::shared_ptr<CallbackMessageT> latest_message_;
+  rclcpp::MessageInfo latest_message_info_;
+  std::mutex message_batch_mutex_;
+  /// Drops the messages according to SubscriptionOptions::rate_limit, null if it is disabled.
+  std::shared_ptr<rclcpp::MessageRateLimiter> rate_limiter_;
 };
 
 }  // namespace rclcpp
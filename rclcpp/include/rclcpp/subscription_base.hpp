@@ -15,6 +15,7 @@
 #ifndef RCLCPP__SUBSCRIPTION_BASE_HPP_
 #define RCLCPP__SUBSCRIPTION_BASE_HPP_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
@@ -25,10 +26,14 @@
 
 #include "rclcpp/any_subscription_callback.hpp"
 #include "rclcpp/experimental/intra_process_manager.hpp"
+#include "rclcpp/experimental/shared_reader_manager.hpp"
 #include "rclcpp/experimental/subscription_intra_process_base.hpp"
 #include "rclcpp/macros.hpp"
+#include "rclcpp/memory_usage.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/qos_event.hpp"
+#include "rclcpp/subscription_content_filter.hpp"
+#include "rclcpp/topic_statistics.hpp"
 #include "rclcpp/type_support_decl.hpp"
 #include "rclcpp/visibility_control.hpp"
 
@@ -63,6 +68,8 @@ public:
    * \param[in] topic_name Name of the topic to subscribe to.
    * \param[in] subscription_options options for the subscription.
    * \param[in] is_serialized is true if the message will be delivered still serialized
+   * \param[in] share_reader is true to share the rcl subscription with the identical
+   *   subscriptions of the context, see SubscriptionOptionsBase::share_reader.
    */
   RCLCPP_PUBLIC
   SubscriptionBase(
@@ -70,7 +77,8 @@ public:
     const rosidl_message_type_support_t & type_support_handle,
     const std::string & topic_name,
     const rcl_subscription_options_t & subscription_options,
-    bool is_serialized = false);
+    bool is_serialized = false,
+    bool share_reader = false);
 
   /// Default destructor.
   RCLCPP_PUBLIC
@@ -139,6 +147,28 @@ public:
   void
   handle_loaned_message(void * loaned_message, const rmw_message_info_t & message_info) = 0;
 
+  /// Return true if handle_loaned_message() takes the ownership of the loaned messages.
+  /**
+   * It is the case when the callback takes a rclcpp::SubscriptionLoanedMessage, which returns
+   * the loan once it is destroyed. Otherwise the executor returns the loan once the message
+   * was handled.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  bool
+  keeps_loaned_messages() const;
+
+  /// Give the messages accumulated by handle_message() to the callback.
+  /**
+   * Called by the executor once it took the messages of an execution of the subscription.
+   * It gives the batch to a callback taking a batch, or the latest message to a subscription
+   * keeping only the latest message, and it does nothing otherwise.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  void
+  dispatch_message_batch();
+
   /// Return the message borrowed in create_message.
   /** \param[in] message Shared pointer to the returned message. */
   RCLCPP_PUBLIC
@@ -153,6 +183,31 @@ public:
   void
   return_serialized_message(std::shared_ptr<rcl_serialized_message_t> & message) = 0;
 
+  /// Take the next message from the middleware into storage owned by the caller.
+  /**
+   * See Subscription::take(), which is the typed version of this method.
+   * \param[out] message_out pointer to a message of the type of the subscription.
+   * \param[out] message_info_out the info of the taken message.
+   * \return false if no message was available.
+   * \throws rclcpp::exceptions::RCLError if the middleware failed to take the message.
+   */
+  RCLCPP_PUBLIC
+  bool
+  take_type_erased(void * message_out, rmw_message_info_t & message_info_out);
+
+  /// Take the next message from the middleware without deserializing it.
+  /**
+   * The serialized message is resized by the middleware if it is too small for the message, a
+   * message preallocated by the caller is otherwise reused.
+   * \param[out] message_out the serialized message, initialized by the caller.
+   * \param[out] message_info_out the info of the taken message.
+   * \return false if no message was available.
+   * \throws rclcpp::exceptions::RCLError if the middleware failed to take the message.
+   */
+  RCLCPP_PUBLIC
+  bool
+  take_serialized(rcl_serialized_message_t & message_out, rmw_message_info_t & message_info_out);
+
   RCLCPP_PUBLIC
   const rosidl_message_type_support_t &
   get_message_type_support_handle() const;
@@ -172,12 +227,62 @@ public:
    * Depending on the middleware and the message type, this will return true if the middleware
    * can allocate a ROS message instance.
    *
+   * It is false if the rcl subscription is shared, see has_shared_reader().
+   *
    * \return boolean flag indicating if middleware can loan messages.
    */
   RCLCPP_PUBLIC
   bool
   can_loan_messages() const;
 
+  /// Return true if the rcl subscription is shared with other subscriptions of the context.
+  /**
+   * The executors must then wait on the rcl subscription once, through any of the
+   * subscriptions sharing it, since the messages taken are given to all of them.
+   * \sa SubscriptionOptionsBase::share_reader
+   */
+  RCLCPP_PUBLIC
+  bool
+  has_shared_reader() const;
+
+  /// Get the maximum number of messages taken each time an executor executes this subscription.
+  RCLCPP_PUBLIC
+  size_t
+  get_max_messages_per_execution() const;
+
+  /// Set the maximum number of messages taken each time an executor executes this subscription.
+  /**
+   * \param[in] max_messages The maximum number of messages, 0 is treated as 1.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_max_messages_per_execution(size_t max_messages);
+
+  /// Return true if the messages are taken serialized, and filtered before being deserialized.
+  RCLCPP_PUBLIC
+  bool
+  has_content_filter() const;
+
+  /// Evaluate the content filter on a serialized message, counting the rejected messages.
+  /**
+   * \param[in] serialized_msg The message, as taken from the middleware.
+   * \return true if the message should be given to the callback.
+   */
+  RCLCPP_PUBLIC
+  bool
+  accepts_serialized_message(const rcl_serialized_message_t & serialized_msg);
+
+  /// Return the number of messages which the content filter rejected.
+  RCLCPP_PUBLIC
+  size_t
+  get_content_filter_rejected_count() const;
+
+  /// Return the statistics collector, or nullptr if the statistics are not enabled.
+  /** \sa rclcpp::TopicStatisticsOptions */
+  RCLCPP_PUBLIC
+  std::shared_ptr<rclcpp::TopicStatisticsCollector>
+  get_topic_statistics() const;
+
   using IntraProcessManagerWeakPtr =
     std::weak_ptr<rclcpp::experimental::IntraProcessManager>;
 
@@ -193,6 +298,35 @@ public:
   rclcpp::Waitable::SharedPtr
   get_intra_process_waitable() const;
 
+  /// Return the largest number of messages the intra-process buffer held.
+  /**
+   * It can be used to size the depth of the QoS, e.g. after running with a KEEP_ALL history.
+   *
+   * \return 0 if intra-process is not setup, or the buffer implementation, e.g. a lock-free
+   *   one, doesn't track it.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_intra_process_buffer_high_water_mark() const;
+
+  /// Return the number of messages the intra-process buffer dropped because it was full.
+  /**
+   * \return 0 if intra-process is not setup.
+   * \sa SubscriptionEventCallbacks::intra_process_message_lost_callback
+   */
+  RCLCPP_PUBLIC
+  size_t
+  get_intra_process_dropped_count() const;
+
+  /// Return the bytes used by the subscription, see rclcpp::MemoryUsage.
+  /**
+   * It includes the intra-process subscription and its buffer, if intra-process is setup.
+   */
+  RCLCPP_PUBLIC
+  virtual
+  rclcpp::MemoryUsage
+  get_memory_usage() const;
+
 protected:
   template<typename EventCallbackT>
   void
@@ -212,6 +346,22 @@ protected:
   bool
   matches_any_intra_process_publishers(const rmw_gid_t * sender_gid) const;
 
+  /// Receive the messages taken from the shared rcl subscription in the intra-process buffer.
+  RCLCPP_PUBLIC
+  void
+  add_to_shared_reader(
+    rclcpp::experimental::SubscriptionIntraProcessBase::WeakPtr subscription_intra_process);
+
+  /// Give a message taken from the shared rcl subscription to all the subscriptions sharing it.
+  RCLCPP_PUBLIC
+  void
+  provide_shared_reader_message(std::shared_ptr<const void> message);
+
+  /// Set the content filter, it must not be changed while the subscription may be executed.
+  RCLCPP_PUBLIC
+  void
+  set_content_filter(SubscriptionContentFilter content_filter);
+
   rclcpp::node_interfaces::NodeBaseInterface * const node_base_;
 
   std::shared_ptr<rcl_node_t> node_handle_;
@@ -224,11 +374,20 @@ protected:
   IntraProcessManagerWeakPtr weak_ipm_;
   uint64_t intra_process_subscription_id_;
 
+  /// Statistics of the received messages, null if they are not collected.
+  std::shared_ptr<rclcpp::TopicStatisticsCollector> topic_statistics_;
+
+  /// Manager of the shared rcl subscription, null if it isn't shared.
+  std::shared_ptr<rclcpp::experimental::SharedReaderManager> shared_reader_manager_;
+
 private:
   RCLCPP_DISABLE_COPY(SubscriptionBase)
 
   rosidl_message_type_support_t type_support_;
   bool is_serialized_;
+  std::atomic_size_t max_messages_per_execution_;
+  SubscriptionContentFilter content_filter_;
+  std::atomic_size_t content_filter_rejected_count_;
 };
 
 }  // namespace rclcpp
@@ -0,0 +1,36 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__SUBSCRIPTION_CONTENT_FILTER_HPP_
+#define RCLCPP__SUBSCRIPTION_CONTENT_FILTER_HPP_
+
+#include <functional>
+
+#include "rcl/types.h"
+
+namespace rclcpp
+{
+
+/// Predicate on the serialized form of a message, returning true to accept the message.
+/**
+ * A subscription with a content filter takes its messages serialized, and only deserializes
+ * the ones the filter accepts, the other ones are neither deserialized nor given to the
+ * callback.
+ * The buffer holds the CDR encapsulation header followed by the serialized fields.
+ */
+using SubscriptionContentFilter = std::function<bool (const rcl_serialized_message_t &)>;
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__SUBSCRIPTION_CONTENT_FILTER_HPP_
@@ -18,6 +18,8 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <type_traits>
+#include <typeinfo>
 #include <utility>
 
 #include "rcl/subscription.h"
@@ -25,8 +27,10 @@
 #include "rosidl_typesupport_cpp/message_type_support.hpp"
 
 #include "rclcpp/any_subscription_callback.hpp"
+#include "rclcpp/detail/make_entity_shared.hpp"
 #include "rclcpp/intra_process_buffer_type.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/message_memory_strategy.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/subscription.hpp"
 #include "rclcpp/subscription_options.hpp"
@@ -62,6 +66,43 @@ struct SubscriptionFactory
   const SubscriptionFactoryFunction create_typed_subscription;
 };
 
+namespace detail
+{
+
+/// Return the pool of the node for the messages if the strategy is the default one.
+/**
+ * A strategy of exactly the default type is the one created by default, a strategy given by
+ * the user is kept.
+ */
+template<typename CallbackMessageT, typename AllocatorT, typename MessageMemoryStrategyT>
+typename MessageMemoryStrategyT::SharedPtr
+get_message_memory_strategy(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  const typename MessageMemoryStrategyT::SharedPtr & msg_mem_strat,
+  std::true_type /* uses the default strategy type */)
+{
+  const auto & message_pools = node_base->get_message_pools();
+  if (
+    !message_pools || !msg_mem_strat ||
+    typeid(*msg_mem_strat) != typeid(MessageMemoryStrategyT))
+  {
+    return msg_mem_strat;
+  }
+  return message_pools->template get<CallbackMessageT, AllocatorT>();
+}
+
+template<typename CallbackMessageT, typename AllocatorT, typename MessageMemoryStrategyT>
+typename MessageMemoryStrategyT::SharedPtr
+get_message_memory_strategy(
+  rclcpp::node_interfaces::NodeBaseInterface *,
+  const typename MessageMemoryStrategyT::SharedPtr & msg_mem_strat,
+  std::false_type /* uses the default strategy type */)
+{
+  return msg_mem_strat;
+}
+
+}  // namespace detail
+
 /// Return a SubscriptionFactory setup to create a SubscriptionT<MessageT, AllocatorT>.
 template<
   typename MessageT,
@@ -69,7 +110,9 @@ template<
   typename AllocatorT,
   typename CallbackMessageT =
   typename rclcpp::subscription_traits::has_message_type<CallbackT>::type,
-  typename SubscriptionT = rclcpp::Subscription<CallbackMessageT, AllocatorT>,
+  typename SubscriptionT = rclcpp::Subscription<
+    typename rclcpp::subscription_traits::subscribed_type<MessageT, CallbackMessageT>::type,
+    AllocatorT>,
   typename MessageMemoryStrategyT = rclcpp::message_memory_strategy::MessageMemoryStrategy<
     CallbackMessageT,
     AllocatorT
@@ -96,15 +139,28 @@ create_subscription_factory(
     {
       using rclcpp::Subscription;
       using rclcpp::SubscriptionBase;
+      using SubscribedT =
+        typename rclcpp::subscription_traits::subscribed_type<MessageT, CallbackMessageT>::type;
+      using ROSMessageType = typename rclcpp::TypeAdapter<MessageT>::ros_message_type;
+      // Serialized messages are not pooled, they are taken with borrow_serialized_message().
+      using UsesDefaultStrategy = std::integral_constant<
+        bool,
+        std::is_same<
+          MessageMemoryStrategyT,
+          rclcpp::message_memory_strategy::MessageMemoryStrategy<CallbackMessageT, AllocatorT>
+        >::value &&
+        !rclcpp::subscription_traits::is_serialized_subscription<CallbackMessageT>::value>;
 
-      auto sub = Subscription<CallbackMessageT, AllocatorT>::make_shared(
+      auto sub = rclcpp::detail::make_entity_shared<Subscription<SubscribedT, AllocatorT>>(
+        node_base->get_entity_arena(),
         node_base,
-        *rosidl_typesupport_cpp::get_message_type_support_handle<MessageT>(),
+        *rosidl_typesupport_cpp::get_message_type_support_handle<ROSMessageType>(),
         topic_name,
         qos,
         any_subscription_callback,
         options,
-        msg_mem_strat);
+        detail::get_message_memory_strategy<CallbackMessageT, AllocatorT, MessageMemoryStrategyT>(
+          node_base, msg_mem_strat, UsesDefaultStrategy()));
       // This is used for setting up things like intra process comms which
       // require this->shared_from_this() which cannot be called from
       // the constructor.
@@ -0,0 +1,142 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__SUBSCRIPTION_LOANED_MESSAGE_HPP_
+#define RCLCPP__SUBSCRIPTION_LOANED_MESSAGE_HPP_
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "rcl/error_handling.h"
+#include "rcl/subscription.h"
+
+#include "rcutils/logging_macros.h"
+
+namespace rclcpp
+{
+
+/// Message received by a subscription, which may be loaned by the middleware.
+/**
+ * A callback taking a SubscriptionLoanedMessage by value gets the ownership of the message,
+ * it can move it out of the callback and keep it as long as needed.
+ *
+ * When the middleware can loan messages, the message is the memory loaned by the middleware,
+ * nothing is copied, and the loan is returned to the middleware when the instance is destroyed.
+ * The loan keeps the rcl subscription alive until then.
+ * Middlewares usually only loan a limited number of messages, keeping too many of them may
+ * prevent taking new ones.
+ *
+ * Otherwise, e.g. with intra-process communication or a middleware which can't loan messages,
+ * the instance owns a message allocated by the subscription.
+ */
+template<typename MessageT>
+class SubscriptionLoanedMessage
+{
+public:
+  /// Construct an instance without a message.
+  SubscriptionLoanedMessage()
+  : message_(nullptr, [](MessageT *) {}),
+    loaned_(false)
+  {}
+
+  /// Construct an instance owning a message loaned by the middleware.
+  /**
+   * \param[in] subscription_handle The subscription from which the message was taken.
+   * \param[in] loaned_message The loaned message, as given by rcl_take_loaned_message().
+   */
+  SubscriptionLoanedMessage(
+    std::shared_ptr<rcl_subscription_t> subscription_handle, MessageT * loaned_message)
+  : message_(
+      loaned_message,
+      [subscription_handle](MessageT * msg) {
+        rcl_ret_t ret =
+        rcl_return_loaned_message_from_subscription(subscription_handle.get(), msg);
+        if (RCL_RET_OK != ret) {
+          RCUTILS_LOG_ERROR_NAMED(
+            "rclcpp",
+            "return_loaned_message failed for subscription: %s", rcl_get_error_string().str);
+          rcl_reset_error();
+        }
+      }),
+    loaned_(true)
+  {}
+
+  /// Construct an instance owning a message which isn't loaned.
+  template<typename Deleter>
+  explicit SubscriptionLoanedMessage(std::unique_ptr<MessageT, Deleter> message)
+  : message_(message.get(), message.get_deleter()),
+    loaned_(false)
+  {
+    message.release();
+  }
+
+  SubscriptionLoanedMessage(SubscriptionLoanedMessage && other) = default;
+
+  SubscriptionLoanedMessage &
+  operator=(SubscriptionLoanedMessage && other) = default;
+
+  SubscriptionLoanedMessage(const SubscriptionLoanedMessage &) = delete;
+
+  SubscriptionLoanedMessage &
+  operator=(const SubscriptionLoanedMessage &) = delete;
+
+  /// Return true if there is a message.
+  bool
+  is_valid() const
+  {
+    return message_ != nullptr;
+  }
+
+  /// Return true if the message is loaned by the middleware, false if it was copied.
+  bool
+  is_loaned() const
+  {
+    return is_valid() && loaned_;
+  }
+
+  /// Access the message, the instance must be valid.
+  MessageT &
+  get() const
+  {
+    return *message_;
+  }
+
+  MessageT &
+  operator*() const
+  {
+    return *message_;
+  }
+
+  MessageT *
+  operator->() const
+  {
+    return message_.get();
+  }
+
+  /// Give back the message, returning the loan to the middleware.
+  void
+  reset()
+  {
+    message_.reset();
+  }
+
+private:
+  std::unique_ptr<MessageT, std::function<void (MessageT *)>> message_;
+  bool loaned_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__SUBSCRIPTION_LOANED_MESSAGE_HPP_
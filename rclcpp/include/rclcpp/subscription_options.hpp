@@ -15,6 +15,8 @@
 #ifndef RCLCPP__SUBSCRIPTION_OPTIONS_HPP_
 #define RCLCPP__SUBSCRIPTION_OPTIONS_HPP_
 
+#include <chrono>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -23,13 +25,46 @@
 #include "rclcpp/detail/rmw_implementation_specific_subscription_payload.hpp"
 #include "rclcpp/intra_process_buffer_type.hpp"
 #include "rclcpp/intra_process_setting.hpp"
+#include "rclcpp/message_rate_limiter.hpp"
 #include "rclcpp/qos.hpp"
 #include "rclcpp/qos_event.hpp"
+#include "rclcpp/subscription_content_filter.hpp"
+#include "rclcpp/topic_statistics.hpp"
 #include "rclcpp/visibility_control.hpp"
 
 namespace rclcpp
 {
 
+/// Batching of the messages given to a callback taking a std::vector of messages.
+/**
+ * The messages taken by an execution of the subscription are accumulated, and given to the
+ * callback at the end of the execution, or as soon as the batch is full or its first message
+ * is too old.
+ * Batches are never kept across executions, so that no message waits for the next one.
+ */
+struct SubscriptionBatchingOptions
+{
+  /// Maximum number of messages in a batch, 0 is treated as 1.
+  /**
+   * The subscription takes at least that many messages each time it is executed, see
+   * SubscriptionOptionsBase::max_messages_per_execution.
+   */
+  size_t max_count = 64;
+
+  /// Maximum time between taking the first message of a batch and giving it, 0 for no limit.
+  std::chrono::nanoseconds max_age {0};
+};
+
+/// Behavior of the intra-process buffer of a subscription when it is full.
+struct IntraProcessBackpressureOptions
+{
+  /// What to do with a message published while the buffer is full.
+  IntraProcessBufferOverflowPolicy overflow_policy = IntraProcessBufferOverflowPolicy::DropOldest;
+
+  /// Maximum time a publisher is blocked with IntraProcessBufferOverflowPolicy::Block.
+  std::chrono::nanoseconds max_block_time {std::chrono::milliseconds(100)};
+};
+
 /// Non-template base class for subscription options.
 struct SubscriptionOptionsBase
 {
@@ -48,6 +83,84 @@ struct SubscriptionOptionsBase
   /// Setting the data-type stored in the intraprocess buffer
   IntraProcessBufferType intra_process_buffer_type = IntraProcessBufferType::CallbackDefault;
 
+  /// Setting the implementation of the intraprocess buffer
+  IntraProcessBufferImplementation intra_process_buffer_implementation =
+    IntraProcessBufferImplementation::RingBuffer;
+
+  /// Behavior of the intraprocess buffer when it is full, dropping the oldest message by default.
+  /**
+   * The publishers can check for full buffers with
+   * PublisherBase::get_full_intra_process_subscription_count().
+   */
+  IntraProcessBackpressureOptions intra_process_backpressure;
+
+  /// True to call the callback on the publishing thread, instead of buffering the message.
+  /**
+   * Intra-process messages are then given to the callback within publish(), without the hop
+   * through the buffer and the executor.
+   * The callback group of the subscription is taken for the duration of the callback, so it
+   * doesn't run concurrently with the other callbacks of a mutually exclusive group.
+   * The message is buffered as usual if the group is taken by another thread, if messages are
+   * already buffered, for a callback taking a batch, or if the callback takes ownership of a
+   * message shared with other subscriptions.
+   * An exception thrown by the callback is thrown by publish().
+   */
+  bool intra_process_synchronous_delivery = false;
+
+  /// True to share the middleware reader with the identical subscriptions of the context.
+  /**
+   * The subscriptions of a context created with this option, on the same topic with the same
+   * message type and QoS, share one rcl subscription: a message is received and deserialized
+   * once, then given to each subscription as an intra-process message, see
+   * rclcpp::experimental::SharedReaderManager.
+   * It implies intra-process communication for the subscription, so it has the same QoS
+   * restrictions, and it is not supported with a type adapted or serialized message type, nor
+   * with a content filter.
+   * Loaned messages are not used, and the message memory strategy isn't used for the messages
+   * taken, since they are shared by the subscriptions.
+   */
+  bool share_reader = false;
+
+  /// Maximum number of messages taken each time an executor finds the subscription ready.
+  /**
+   * With a value above 1 the executor drains a deep history without going through a full wait
+   * for every message, it stops early when there are no more messages. 0 is treated as 1.
+   */
+  size_t max_messages_per_execution = 1;
+
+  /// True to only give the latest message to the callback, dropping the older ones.
+  /**
+   * Meant for topics carrying a state, e.g. odometry, for which only the newest message matters.
+   * Each execution of the subscription takes all the queued messages, up to the depth of the
+   * QoS, and calls the callback once with the last one.
+   * With intra-process communication the buffer is a single slot, see
+   * IntraProcessBufferImplementation::LatestValue.
+   * Loaned messages can't be kept, each of them is given to the callback.
+   * It is not supported with a callback taking a batch of messages.
+   */
+  bool keep_latest = false;
+
+  /// Batching policy, used only if the callback takes a batch of messages.
+  SubscriptionBatchingOptions batching;
+
+  /// Optional filter evaluated on the serialized messages, before deserializing them.
+  /**
+   * It is not supported with intra-process communication, the messages published
+   * intra-process are never serialized.
+   */
+  SubscriptionContentFilter content_filter = nullptr;
+
+  /// Statistics of the received messages, disabled by default.
+  TopicStatisticsOptions topic_statistics;
+
+  /// Downsampling of the received messages, disabled by default.
+  /**
+   * The messages published intra-process are dropped before being buffered, the ones taken
+   * from the middleware are dropped before being given to the callback.
+   * A publisher shared by all the subscriptions should rather use PublisherOptions::rate_limit.
+   */
+  MessageRateLimitOptions rate_limit;
+
   /// Optional RMW implementation specific payload to be used during creation of the subscription.
   std::shared_ptr<rclcpp::detail::RMWImplementationSpecificSubscriptionPayload>
   rmw_implementation_payload = nullptr;
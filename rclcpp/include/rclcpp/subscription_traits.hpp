@@ -16,8 +16,10 @@
 #define RCLCPP__SUBSCRIPTION_TRAITS_HPP_
 
 #include <memory>
+#include <vector>
 
 #include "rclcpp/function_traits.hpp"
+#include "rclcpp/type_adapter.hpp"
 #include "rcl/types.h"
 
 namespace rclcpp
@@ -25,6 +27,9 @@ namespace rclcpp
 
 class QoS;
 
+template<typename MessageT>
+class SubscriptionLoanedMessage;
+
 namespace subscription_traits
 {
 
@@ -73,6 +78,17 @@ template<typename MessageT, typename Deleter>
 struct extract_message_type<std::unique_ptr<MessageT, Deleter>>: extract_message_type<MessageT>
 {};
 
+// Callbacks taking a batch of messages
+template<typename MessageT, typename Alloc>
+struct extract_message_type<std::vector<MessageT, Alloc>>: extract_message_type<MessageT>
+{};
+
+// Callbacks taking the ownership of messages which may be loaned
+template<typename MessageT>
+struct extract_message_type<rclcpp::SubscriptionLoanedMessage<MessageT>>
+  : extract_message_type<MessageT>
+{};
+
 template<
   typename CallbackT,
   // Do not attempt if CallbackT is an integer (mistaken for depth)
@@ -91,6 +107,22 @@ struct has_message_type : extract_message_type<
     typename rclcpp::function_traits::function_traits<CallbackT>::template argument_type<0>>
 {};
 
+/// The message type of the Subscription created for a topic type and a callback message type.
+/**
+ * It is the adapted MessageT if the callback takes its custom type, otherwise the callback
+ * message type, e.g. a ROS message or a serialized message.
+ */
+template<typename MessageT, typename CallbackMessageT>
+struct subscribed_type
+{
+  using type = typename std::conditional<
+    rclcpp::TypeAdapter<MessageT>::is_specialized::value &&
+    std::is_same<typename rclcpp::TypeAdapter<MessageT>::custom_type, CallbackMessageT>::value,
+    MessageT,
+    CallbackMessageT
+  >::type;
+};
+
 }  // namespace subscription_traits
 }  // namespace rclcpp
 
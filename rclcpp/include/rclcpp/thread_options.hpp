@@ -0,0 +1,90 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__THREAD_OPTIONS_HPP_
+#define RCLCPP__THREAD_OPTIONS_HPP_
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+enum class ThreadSchedulingPolicy
+{
+  /// Keep the policy and priority the thread was created with.
+  Inherit,
+  /// Default time sharing policy (SCHED_OTHER).
+  Other,
+  /// Real-time first in, first out policy (SCHED_FIFO).
+  Fifo,
+  /// Real-time round robin policy (SCHED_RR).
+  RoundRobin
+};
+
+/// Configuration of a thread started by an executor.
+/**
+ * Default constructed options leave the thread as it was created.
+ */
+struct ThreadOptions
+{
+  /// Name of the thread, shown by tools like top, truncated to 15 characters on Linux.
+  std::string name;
+  /// CPUs the thread may run on, empty to not change the affinity.
+  std::vector<size_t> cpu_set;
+  /// NUMA node whose CPUs the thread may run on, negative to not restrict it to a node.
+  /**
+   * Combined with cpu_set, the thread may run on the CPUs of cpu_set which are on the node.
+   * The memory the thread touches first is then usually placed on that node, see rclcpp/numa.hpp.
+   */
+  int numa_node = -1;
+  ThreadSchedulingPolicy scheduling_policy = ThreadSchedulingPolicy::Inherit;
+  /// Priority for the scheduling policy, only used if the policy is not Inherit.
+  int priority = 0;
+  /// Bytes of stack touched by an executor thread when it starts, see rclcpp::prefault_stack().
+  /**
+   * If zero, rclcpp::RealtimeOptions::stack_prefault_size of the context is used.
+   * It is applied by the thread itself, not by apply_thread_options().
+   */
+  size_t stack_prefault_size = 0;
+};
+
+/// Apply the options to a thread.
+/**
+ * Real-time policies usually need elevated privileges, e.g. CAP_SYS_NICE on Linux.
+ * \param[in] thread The thread to configure, it must be joinable.
+ * \param[in] options The options to apply.
+ * \throws std::runtime_error if an option could not be applied or is not supported on this
+ *   platform.
+ */
+RCLCPP_PUBLIC
+void
+apply_thread_options(std::thread & thread, const ThreadOptions & options);
+
+/// Apply the options to the calling thread.
+/**
+ * \param[in] options The options to apply.
+ * \throws std::runtime_error if an option could not be applied or is not supported on this
+ *   platform.
+ */
+RCLCPP_PUBLIC
+void
+apply_thread_options_to_current_thread(const ThreadOptions & options);
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__THREAD_OPTIONS_HPP_
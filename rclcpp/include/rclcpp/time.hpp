@@ -15,6 +15,8 @@
 #ifndef RCLCPP__TIME_HPP_
 #define RCLCPP__TIME_HPP_
 
+#include <chrono>
+
 #include "builtin_interfaces/msg/time.hpp"
 
 #include "rclcpp/visibility_control.hpp"
@@ -48,6 +50,22 @@ public:
   RCLCPP_PUBLIC
   explicit Time(const rcl_time_point_t & time_point);
 
+  /// Construct from a std::chrono time point, counted from the epoch of its clock.
+  /**
+   * e.g. `rclcpp::Time(std::chrono::steady_clock::now(), RCL_STEADY_TIME)`.
+   *
+   * \param[in] time_point the time point, truncated to nanoseconds.
+   * \param[in] clock_type the clock type of the time, matching the clock of the time point.
+   */
+  template<class ClockT, class DurationT>
+  explicit Time(
+    const std::chrono::time_point<ClockT, DurationT> & time_point,
+    rcl_clock_type_t clock_type = RCL_SYSTEM_TIME)
+  : Time(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(time_point.time_since_epoch()).count(),
+      clock_type)
+  {}
+
   RCLCPP_PUBLIC
   virtual ~Time();
 
@@ -121,6 +139,14 @@ public:
   double
   seconds() const;
 
+  /// \return the time since the epoch of its clock as a std::chrono duration.
+  template<class DurationT = std::chrono::nanoseconds>
+  DurationT
+  to_chrono() const
+  {
+    return std::chrono::duration_cast<DurationT>(std::chrono::nanoseconds(rcl_time_.nanoseconds));
+  }
+
   RCLCPP_PUBLIC
   rcl_clock_type_t
   get_clock_type() const;
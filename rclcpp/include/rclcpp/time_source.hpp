@@ -22,10 +22,10 @@
 
 #include "builtin_interfaces/msg/time.hpp"
 #include "rosgraph_msgs/msg/clock.hpp"
-#include "rcl_interfaces/msg/parameter_event.hpp"
 
 #include "rclcpp/node.hpp"
 #include "rclcpp/node_interfaces/node_parameters_interface.hpp"
+#include "rclcpp/sim_time_source.hpp"
 
 
 namespace rclcpp
@@ -44,6 +44,11 @@ public:
   RCLCPP_PUBLIC
   void attachNode(rclcpp::Node::SharedPtr node);
 
+  /// Attach the interfaces of a node.
+  /**
+   * The changes of the use_sim_time parameter are observed locally, the node doesn't
+   * subscribe to the parameter events.
+   */
   RCLCPP_PUBLIC
   void attachNode(
     rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_interface,
@@ -83,29 +88,23 @@ private:
   // Store (and update on node attach) logger for logging.
   Logger logger_;
 
-  // The subscription for the clock callback
-  using MessageT = rosgraph_msgs::msg::Clock;
-  using Alloc = std::allocator<void>;
-  using SubscriptionT = rclcpp::Subscription<MessageT, Alloc>;
-  std::shared_ptr<SubscriptionT> clock_subscription_;
+  // The simulated time of the context, shared with the other time sources
+  rclcpp::SimTimeSource::SharedPtr sim_time_source_;
+  // True if the node may host the subscription for the clock topic
+  bool clock_subscriber_;
   std::mutex clock_sub_lock_;
 
-  // The clock callback itself
-  void clock_cb(const rosgraph_msgs::msg::Clock::SharedPtr msg);
-
-  // Create the subscription for the clock topic
+  // Offer the node to the shared time source to host the subscription for the clock topic
   void create_clock_sub();
 
-  // Destroy the subscription for the clock topic
+  // Withdraw the node from hosting the subscription for the clock topic
   void destroy_clock_sub();
 
-  // Parameter Event subscription
-  using ParamMessageT = rcl_interfaces::msg::ParameterEvent;
-  using ParamSubscriptionT = rclcpp::Subscription<ParamMessageT, Alloc>;
-  std::shared_ptr<ParamSubscriptionT> parameter_subscription_;
+  // Follow a new value of the use_sim_time parameter
+  void on_use_sim_time(bool use_sim_time);
 
-  // Callback for parameter updates
-  void on_parameter_event(const rcl_interfaces::msg::ParameterEvent::SharedPtr event);
+  // Observer of the use_sim_time parameter
+  rclcpp::node_interfaces::ParameterValueObserver::SharedPtr use_sim_time_observer_;
 
   // An enum to hold the parameter state
   enum UseSimTimeParameterState {UNSET, SET_TRUE, SET_FALSE};
@@ -127,8 +126,6 @@ private:
   // Local storage of validity of ROS time
   // This is needed when new clocks are added.
   bool ros_time_active_;
-  // Last set message to be passed to newly registered clocks
-  rosgraph_msgs::msg::Clock::SharedPtr last_msg_set_;
 
   // A lock to protect iterating the associated_clocks_ field.
   std::mutex clock_list_lock_;
@@ -15,9 +15,12 @@
 #ifndef RCLCPP__TIMER_HPP_
 #define RCLCPP__TIMER_HPP_
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <thread>
 #include <type_traits>
@@ -42,6 +45,34 @@
 namespace rclcpp
 {
 
+/// Latency of the callbacks of a timer, i.e. how late they were called after their deadline.
+struct TimerStatistics
+{
+  /// Number of executions of the timer measured, including the ones skipping the callback.
+  uint64_t count = 0;
+  std::chrono::nanoseconds min_latency {0};
+  /// Worst-case lateness.
+  std::chrono::nanoseconds max_latency {0};
+  std::chrono::nanoseconds mean_latency {0};
+  /// Standard deviation of the latency.
+  std::chrono::nanoseconds jitter {0};
+  /// Number of times the timer was executed at least one period late.
+  uint64_t overrun_count = 0;
+  /// Number of periods for which no callback was called, because of overruns.
+  uint64_t missed_count = 0;
+};
+
+/// What a timer does when it is executed at least one period late, e.g. after a long callback.
+enum class TimerOverrunPolicy
+{
+  /// Call the callback once, the next deadlines stay on the schedule of the timer.
+  FireOnce,
+  /// Don't call the callback, wait for the next deadline of the schedule.
+  SkipMissed,
+  /// Call the callback once for each period missed, up to a maximum, in a burst.
+  CatchUp,
+};
+
 class TimerBase
 {
 public:
@@ -101,9 +132,101 @@ public:
   RCLCPP_PUBLIC
   bool is_ready();
 
+  /// Exchange the "in use by an executor" state of this timer.
+  /**
+   * Executors using several threads claim the timer with `true` before handing it to a
+   * thread and release it with `false` once the callback returned, so that a timer which is
+   * still ready while its callback runs is not executed a second time concurrently.
+   *
+   * \param[in] in_use_state the new state, true to claim the timer.
+   * \return the previous state, true if the timer was already claimed.
+   */
+  RCLCPP_PUBLIC
+  bool
+  exchange_in_use_by_executor_state(bool in_use_state);
+
+  /// Return the latency statistics of the callbacks, since creation or reset_statistics().
+  /**
+   * The latency of a callback is the time between its deadline and the moment the executor
+   * called it, the jitter is its standard deviation.
+   * It is measured with the clock of the timer.
+   */
+  RCLCPP_PUBLIC
+  TimerStatistics
+  get_statistics() const;
+
+  /// Reset the latency statistics.
+  RCLCPP_PUBLIC
+  void
+  reset_statistics();
+
+  /// Set what the timer does when it is executed at least one period late.
+  /**
+   * \param[in] policy the overrun policy, TimerOverrunPolicy::FireOnce by default.
+   * \param[in] max_catch_up maximum number of additional callbacks called by
+   *   TimerOverrunPolicy::CatchUp, the other missed periods are skipped.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_overrun_policy(TimerOverrunPolicy policy, size_t max_catch_up = 10);
+
+  RCLCPP_PUBLIC
+  TimerOverrunPolicy
+  get_overrun_policy() const;
+
+  /// Set how late the timer may be executed, so its wake-up can be shared with other timers.
+  /**
+   * The executors scheduling their timers, see ExecutorArgs::manage_timers, wake up at the
+   * latest time allowed by the slack of the timers, and execute all the timers expired by then
+   * at once, instead of waking up for each of them.
+   * It is meant for low-rate timers which tolerate some lateness, e.g. watchdogs or
+   * diagnostics, and is ignored by the executors waiting on the timers with rcl_wait().
+   *
+   * \param[in] slack the tolerated lateness, 0 by default.
+   * \throws std::invalid_argument if the slack is negative.
+   */
+  RCLCPP_PUBLIC
+  void
+  set_slack(std::chrono::nanoseconds slack);
+
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  get_slack() const;
+
+  /// Return the clock of the timer.
+  RCLCPP_PUBLIC
+  Clock::SharedPtr
+  get_clock() const;
+
 protected:
+  /// Record the latency of the callback about to be called, before rcl_timer_call().
+  /**
+   * It applies the overrun policy.
+   * \return the number of times to call the callback, 0 to skip it.
+   */
+  RCLCPP_PUBLIC
+  size_t
+  record_callback_latency();
+
   Clock::SharedPtr clock_;
   std::shared_ptr<rcl_timer_t> timer_handle_;
+
+  std::atomic<bool> in_use_by_executor_{false};
+
+private:
+  std::atomic<int64_t> slack_ns_{0};
+
+  mutable std::mutex statistics_mutex_;
+  uint64_t latency_count_ = 0;
+  int64_t min_latency_ns_ = 0;
+  int64_t max_latency_ns_ = 0;
+  /// Running mean and sum of the squared differences to it, see Welford's algorithm.
+  double latency_mean_ns_ = 0.0;
+  double latency_m2_ = 0.0;
+  uint64_t overrun_count_ = 0;
+  uint64_t missed_count_ = 0;
+  TimerOverrunPolicy overrun_policy_ = TimerOverrunPolicy::FireOnce;
+  size_t max_catch_up_ = 10;
 };
 
 
@@ -155,6 +278,7 @@ public:
   void
   execute_callback() override
   {
+    size_t call_count = record_callback_latency();
     rcl_ret_t ret = rcl_timer_call(timer_handle_.get());
     if (ret == RCL_RET_TIMER_CANCELED) {
       return;
@@ -162,9 +286,11 @@ public:
     if (ret != RCL_RET_OK) {
       throw std::runtime_error("Failed to notify timer that callback occurred");
     }
-    TRACEPOINT(callback_start, (const void *)&callback_, false);
-    execute_callback_delegate<>();
-    TRACEPOINT(callback_end, (const void *)&callback_);
+    for (size_t i = 0; i < call_count; ++i) {
+      TRACEPOINT(callback_start, (const void *)&callback_, false);
+      execute_callback_delegate<>();
+      TRACEPOINT(callback_end, (const void *)&callback_);
+    }
   }
 
   // void specialization
@@ -0,0 +1,219 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__TIMER_MANAGER_HPP_
+#define RCLCPP__TIMER_MANAGER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace executor
+{
+
+/// Schedule the steady timers of an executor, instead of waiting on each of them.
+/**
+ * The timers are kept in a min-heap ordered by their next deadline, so the executor only gives
+ * the time until the nearest deadline to the wait, and takes the expired timers in deadline
+ * order, without rcl_wait() going through all the timers on every iteration.
+ *
+ * The memory strategy gives the manager the timers it collects, see manage().
+ * Only the timers using a steady clock are managed, e.g. the wall timers; the ones using the
+ * ROS time are still waited on, since the wait is woken up when the ROS time jumps.
+ *
+ * A deadline in the heap is never later than the actual one: a timer reset since it was pushed
+ * is checked once its old deadline has passed, and pushed again with its new deadline.
+ * Canceled timers are not in the heap, they are pushed again once reset.
+ *
+ * The wake-ups of the timers with a slack, see TimerBase::set_slack(), are coalesced: the
+ * executor wakes up at the earliest deadline plus slack of all the scheduled timers, and takes
+ * all the timers expired by then.
+ *
+ * All the methods are thread-safe.
+ */
+class TimerManager
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(TimerManager)
+
+  RCLCPP_PUBLIC
+  TimerManager();
+
+  /// Start a new collection of the timers, the ones not given to manage() after it are dropped.
+  RCLCPP_PUBLIC
+  void
+  start_collection();
+
+  /// Take charge of a timer found by the current collection, if it uses a steady clock.
+  /**
+   * \param[in] timer the timer.
+   * \param[in] can_execute false if its callback group can't be taken from, the timer is then
+   *   kept out of the heap until the next collection.
+   * \return true if the manager schedules the timer, so it must not be waited on.
+   */
+  RCLCPP_PUBLIC
+  bool
+  manage(const rclcpp::TimerBase::SharedPtr & timer, bool can_execute = true);
+
+  /// Return the time until the next wake-up, negative if there is no timer.
+  /**
+   * It is the time until the nearest deadline if the timers have no slack, and 0 if a timer is
+   * already expired.
+   */
+  RCLCPP_PUBLIC
+  std::chrono::nanoseconds
+  get_time_until_next_deadline();
+
+  /// Take the expired timer with the earliest deadline.
+  /**
+   * The timer stays scheduled with a provisional deadline one period later, and is pushed with
+   * its actual deadline by reschedule() once its callback was executed.
+   *
+   * \param[in] can_take called for the expired timers in deadline order, the first one for which
+   *   it returns true is taken, e.g. whose callback group can be taken from.
+   * \param[out] next_deadline if not nullptr, set to the next wake-up for the timers which were
+   *   not skipped by `can_take`, time_point::max() if there is none.
+   * \return the timer, nullptr if no expired timer could be taken.
+   */
+  RCLCPP_PUBLIC
+  rclcpp::TimerBase::SharedPtr
+  get_next_ready_timer(
+    const std::function<bool(const rclcpp::TimerBase::SharedPtr &)> & can_take,
+    std::chrono::steady_clock::time_point * next_deadline = nullptr);
+
+  /// Push a timer again with its actual deadline, after its callback was executed.
+  /**
+   * Timers which are not managed are ignored.
+   */
+  RCLCPP_PUBLIC
+  void
+  reschedule(const rclcpp::TimerBase::SharedPtr & timer);
+
+  /// Return the number of timers managed, scheduled or not.
+  RCLCPP_PUBLIC
+  size_t
+  size() const;
+
+  /// Wake up the threads blocked in wait_until().
+  /**
+   * Pushing a timer with an earlier deadline than all the others also wakes them up.
+   */
+  RCLCPP_PUBLIC
+  void
+  notify();
+
+  /// Return the number of notifications so far, to be given to wait_until().
+  RCLCPP_PUBLIC
+  uint64_t
+  get_notification_count() const;
+
+  /// Block until a deadline, or until a notification.
+  /**
+   * The thread sleeps until `spin_threshold` before the deadline, then spins on the steady clock
+   * for the remaining time, which wakes it up much closer to the deadline than the sleep
+   * granularity of the OS, at the cost of a busy core for `spin_threshold`.
+   *
+   * \param[in] deadline the time to wake up at, time_point::max() to only wait for a
+   *   notification.
+   * \param[in] spin_threshold the time spent spinning before the deadline, 0 to only sleep.
+   * \param[in] notification_count the count returned by get_notification_count() before the
+   *   deadline was computed, so the notifications given since then are not missed.
+   * \return true if the deadline was reached, false if there was a notification.
+   */
+  RCLCPP_PUBLIC
+  bool
+  wait_until(
+    std::chrono::steady_clock::time_point deadline,
+    std::chrono::nanoseconds spin_threshold,
+    uint64_t notification_count);
+
+private:
+  struct Entry
+  {
+    rclcpp::TimerBase::WeakPtr timer;
+    /// Last collection which found the timer.
+    uint64_t collection;
+    /// Version of the last item pushed for the timer, the older ones are ignored.
+    uint64_t version;
+    /// True if an item of the current version is in the heap.
+    bool scheduled;
+  };
+
+  struct HeapItem
+  {
+    std::chrono::steady_clock::time_point deadline;
+    std::chrono::nanoseconds slack;
+    const rclcpp::TimerBase * key;
+    uint64_t version;
+  };
+
+  struct LaterDeadline
+  {
+    bool
+    operator()(const HeapItem & a, const HeapItem & b) const
+    {
+      return a.deadline > b.deadline;
+    }
+  };
+
+  /// Push a new item for the timer, mutex_ must be locked.
+  void
+  push(Entry & entry, rclcpp::TimerBase & timer, std::chrono::steady_clock::time_point deadline);
+
+  /// Pop the outdated items, or of timers not found by the collection, mutex_ must be locked.
+  /**
+   * \return the entry of the valid top item, nullptr if the heap is empty.
+   */
+  Entry *
+  prune_top();
+
+  /// Return true if the item is the current one of a timer found by the collection.
+  bool
+  is_current(const HeapItem & item) const;
+
+  /// Return the latest time at which no timer is later than its slack, mutex_ must be locked.
+  /**
+   * The heap must not be empty, and its top item must be current.
+   */
+  std::chrono::steady_clock::time_point
+  get_wake_up_time();
+
+  mutable std::mutex mutex_;
+  std::unordered_map<const rclcpp::TimerBase *, Entry> entries_;
+  std::vector<HeapItem> heap_;
+  /// Indexes of the heap items to visit in get_wake_up_time(), kept to reuse its memory.
+  std::vector<size_t> wake_up_stack_;
+  uint64_t collection_;
+  /// Versions are unique to all the items, even when a timer is forgotten and managed again.
+  uint64_t last_version_;
+  /// Incremented under mutex_, and read without it by the threads spinning in wait_until().
+  std::atomic<uint64_t> notification_count_;
+  std::condition_variable notification_cv_;
+};
+
+}  // namespace executor
+}  // namespace rclcpp
+
+#endif  // RCLCPP__TIMER_MANAGER_HPP_
@@ -0,0 +1,232 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__TOPIC_STATISTICS_HPP_
+#define RCLCPP__TOPIC_STATISTICS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "rcl/types.h"
+
+#include "rclcpp/macros.hpp"
+#include "rclcpp/message_info.hpp"
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+class PublisherBase;
+
+namespace node_interfaces
+{
+class NodeBaseInterface;
+}  // namespace node_interfaces
+
+/// Configuration of the statistics a subscription collects, used in SubscriptionOptions.
+struct TopicStatisticsOptions
+{
+  /// If false, nothing is collected and the subscription only checks a null pointer.
+  bool enabled = false;
+  /// Duration of the windows over which the statistics are computed and published.
+  std::chrono::milliseconds publish_period {1000};
+  /// Topic on which the statistics are published, empty to only collect them.
+  std::string publish_topic = "/statistics";
+};
+
+/// Statistics of the messages received by a subscription during a window.
+/**
+ * The age of a message is its transport latency when the middleware gives its source
+ * timestamp, otherwise the time between the stamp of its header and its dispatch, which is
+ * only known for the messages which have a std_msgs/Header like `header.stamp` field.
+ * The size is only known for the subscriptions taking serialized messages.
+ */
+struct TopicStatisticsWindow
+{
+  std::chrono::nanoseconds window_duration {0};
+  uint64_t message_count = 0;
+  /// Messages per second over the window.
+  double message_rate = 0.0;
+
+  /// Number of messages of which the age is known.
+  uint64_t age_count = 0;
+  std::chrono::nanoseconds age_min {0};
+  std::chrono::nanoseconds age_max {0};
+  std::chrono::nanoseconds age_mean {0};
+
+  /// Number of messages of which the size is known.
+  uint64_t size_count = 0;
+  uint64_t size_min = 0;
+  uint64_t size_max = 0;
+  uint64_t size_mean = 0;
+};
+
+namespace detail
+{
+
+template<typename MessageT, typename = void>
+struct has_header_stamp : std::false_type
+{};
+
+template<typename MessageT>
+struct has_header_stamp<
+  MessageT, decltype((void)std::declval<const MessageT &>().header.stamp.nanosec)>
+  : std::true_type
+{};
+
+}  // namespace detail
+
+/// Collects the statistics of a subscription with atomic counters, and publishes them.
+/**
+ * Recording a message doesn't lock, the window is closed by the first message recorded after
+ * the publish period elapsed, which also publishes it.
+ * A window without any message is therefore only reported with the next message.
+ * Messages recorded while a window is being closed may be counted in the next window.
+ *
+ * The statistics are published as rcl_interfaces/msg/ParameterEvent messages, which hold
+ * named values: the node field is the name of the subscribing node, and each statistics is a
+ * new parameter named after the topic, e.g. `/chatter/message_rate`.
+ */
+class TopicStatisticsCollector
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(TopicStatisticsCollector)
+
+  /// Constructor.
+  /**
+   * \param[in] node_base The node of the subscription, used to create the publisher.
+   * \param[in] topic_name Name of the topic of the subscription.
+   * \param[in] options Statistics options.
+   * \throws std::invalid_argument if the publish period is not positive.
+   */
+  RCLCPP_PUBLIC
+  TopicStatisticsCollector(
+    rclcpp::node_interfaces::NodeBaseInterface * node_base,
+    const std::string & topic_name,
+    const TopicStatisticsOptions & options);
+
+  RCLCPP_PUBLIC
+  virtual ~TopicStatisticsCollector();
+
+  /// Record a message, its age is computed if it has a header.
+  template<typename MessageT>
+  void
+  record_message(const MessageT & msg)
+  {
+    record(get_age(msg, detail::has_header_stamp<MessageT>()), get_size(msg));
+  }
+
+  /// Record a message, its age is its transport latency if the message info has it.
+  template<typename MessageT>
+  void
+  record_message(const MessageT & msg, const rclcpp::MessageInfo & message_info)
+  {
+    auto age = message_info.get_transport_latency();
+    if (age.count() < 0) {
+      age = get_age(msg, detail::has_header_stamp<MessageT>());
+    }
+    record(age, get_size(msg));
+  }
+
+  /// Record a message.
+  /**
+   * \param[in] age Age of the message, negative if unknown.
+   * \param[in] size Size of the message in bytes, 0 if unknown.
+   */
+  RCLCPP_PUBLIC
+  void
+  record(std::chrono::nanoseconds age, uint64_t size);
+
+  /// Return the statistics of the window in progress.
+  RCLCPP_PUBLIC
+  TopicStatisticsWindow
+  get_current_window() const;
+
+  /// Return the statistics of the last window which was closed.
+  RCLCPP_PUBLIC
+  TopicStatisticsWindow
+  get_last_window() const;
+
+  /// Close the window in progress, publish it, and return it.
+  RCLCPP_PUBLIC
+  TopicStatisticsWindow
+  close_window();
+
+private:
+  template<typename MessageT>
+  static std::chrono::nanoseconds
+  get_age(const MessageT & msg, std::true_type)
+  {
+    auto stamp = std::chrono::seconds(msg.header.stamp.sec) +
+      std::chrono::nanoseconds(msg.header.stamp.nanosec);
+    return std::chrono::system_clock::now().time_since_epoch() - stamp;
+  }
+
+  template<typename MessageT>
+  static std::chrono::nanoseconds
+  get_age(const MessageT &, std::false_type)
+  {
+    return std::chrono::nanoseconds(-1);
+  }
+
+  template<typename MessageT>
+  static uint64_t
+  get_size(const MessageT &)
+  {
+    return 0;
+  }
+
+  static uint64_t
+  get_size(const rcl_serialized_message_t & serialized_msg)
+  {
+    return serialized_msg.buffer_length;
+  }
+
+  TopicStatisticsWindow
+  read_window(int64_t now_ns) const;
+
+  void
+  publish(const TopicStatisticsWindow & window);
+
+  const std::string topic_name_;
+  const int64_t publish_period_ns_;
+
+  std::atomic<uint64_t> message_count_;
+  std::atomic<uint64_t> age_count_;
+  std::atomic<int64_t> age_sum_;
+  std::atomic<int64_t> age_min_;
+  std::atomic<int64_t> age_max_;
+  std::atomic<uint64_t> size_count_;
+  std::atomic<uint64_t> size_sum_;
+  std::atomic<uint64_t> size_min_;
+  std::atomic<uint64_t> size_max_;
+  std::atomic<int64_t> window_start_ns_;
+
+  /// Publisher of rcl_interfaces/msg/ParameterEvent, null if the statistics aren't published.
+  std::shared_ptr<rclcpp::PublisherBase> publisher_;
+  std::string node_name_;
+
+  TopicStatisticsWindow last_window_;
+  mutable std::mutex last_window_mutex_;
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__TOPIC_STATISTICS_HPP_
@@ -0,0 +1,108 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__TRACEPOINTS_HPP_
+#define RCLCPP__TRACEPOINTS_HPP_
+
+#include <atomic>
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+namespace tracing
+{
+
+/// Points of the message flow where rclcpp emits a tracepoint.
+/**
+ * Each tracepoint carries a handle, which is stable for the lifetime of the entity, and a data
+ * pointer identifying the message, request or response.
+ * The handles are the ones of the tracetools initialization events, e.g. rcl_publisher_init, so
+ * the tracepoints can be attached to the entities when rebuilding the message flows offline.
+ */
+enum class Tracepoint
+{
+  /// A message is given to the middleware, handle: rcl_publisher_t, data: the message.
+  Publish,
+  /// A message is given to the intra process manager, handle: rcl_publisher_t, data: the message.
+  IntraProcessPublish,
+  /// A message is stored in an intra process buffer, handle: the buffer, data: the message.
+  IntraProcessEnqueue,
+  /// A message is taken from an intra process buffer, handle: the buffer, data: the message.
+  IntraProcessDequeue,
+  /// A message was taken from the middleware, handle: rcl_subscription_t, data: the message.
+  Take,
+  /// The executor starts executing an entity, handle: the rclcpp entity, data: nullptr.
+  ExecuteStart,
+  /// The executor finished executing an entity, handle: the rclcpp entity, data: nullptr.
+  ExecuteEnd,
+  /// A request was sent, handle: rcl_client_t, data: its int64_t sequence number.
+  SendRequest,
+  /// A request was taken, handle: rcl_service_t, data: its rmw_request_id_t.
+  TakeRequest,
+  /// A response is sent, handle: rcl_service_t, data: the rmw_request_id_t of the request.
+  SendResponse,
+  /// A response was taken, handle: rcl_client_t, data: the rmw_request_id_t of the request.
+  TakeResponse
+};
+
+/// Function called at each tracepoint, on the thread going through it.
+using TracepointHandler = void (*)(Tracepoint tracepoint, const void * handle, const void * data);
+
+/// Set the function called at each tracepoint, nullptr to stop tracing.
+/**
+ * The tracepoints are only compiled in when rclcpp is built with RCLCPP_TRACEPOINTS=ON,
+ * otherwise they cost nothing and the handler is never called.
+ * When compiled in, a tracepoint without handler costs an atomic load and a branch.
+ *
+ * The handler is typically an LTTng tracepoint provider, or records the events in memory.
+ * It must be thread-safe, and must not throw.
+ */
+RCLCPP_PUBLIC
+void
+set_tracepoint_handler(TracepointHandler handler);
+
+/// Return true if rclcpp was built with the tracepoints.
+RCLCPP_PUBLIC
+bool
+tracepoints_enabled();
+
+namespace detail
+{
+
+RCLCPP_PUBLIC
+extern std::atomic<TracepointHandler> tracepoint_handler;
+
+}  // namespace detail
+}  // namespace tracing
+}  // namespace rclcpp
+
+#ifdef RCLCPP_TRACEPOINTS_ENABLED
+#define RCLCPP_TRACEPOINT(tracepoint, handle, data) \
+  do { \
+    rclcpp::tracing::TracepointHandler rclcpp_tracepoint_handler = \
+      rclcpp::tracing::detail::tracepoint_handler.load(std::memory_order_relaxed); \
+    if (rclcpp_tracepoint_handler) { \
+      rclcpp_tracepoint_handler( \
+        rclcpp::tracing::Tracepoint::tracepoint, \
+        static_cast<const void *>(handle), static_cast<const void *>(data)); \
+    } \
+  } while (0)
+#else
+// The arguments are not evaluated.
+#define RCLCPP_TRACEPOINT(tracepoint, handle, data) do {} while (0)
+#endif
+
+#endif  // RCLCPP__TRACEPOINTS_HPP_
@@ -0,0 +1,204 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP__TYPE_ADAPTER_HPP_
+#define RCLCPP__TYPE_ADAPTER_HPP_
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace rclcpp
+{
+
+/// Template structure used to adapt custom, user-defined types to ROS types.
+/**
+ * Adapting a type lets publishers and subscriptions use it in place of the ROS message type of
+ * the topic, e.g. an image type of a vision library in place of `sensor_msgs::msg::Image`.
+ * The intra-process subscriptions get the custom type without any conversion, the messages are
+ * only converted from or to the ROS message type when they go through the middleware.
+ *
+ * A type is adapted by specializing TypeAdapter for it, e.g.:
+ *
+ *   template<>
+ *   struct rclcpp::TypeAdapter<cv::Mat, sensor_msgs::msg::Image>
+ *   {
+ *     using is_specialized = std::true_type;
+ *     using custom_type = cv::Mat;
+ *     using ros_message_type = sensor_msgs::msg::Image;
+ *
+ *     static void
+ *     convert_to_ros_message(const custom_type & source, ros_message_type & destination);
+ *
+ *     static void
+ *     convert_to_custom(const ros_message_type & source, custom_type & destination);
+ *   };
+ *
+ * The adapter is then given as the message type of the publishers and subscriptions, the
+ * subscription callbacks take the custom type:
+ *
+ *   using AdaptedType = rclcpp::TypeAdapter<cv::Mat, sensor_msgs::msg::Image>;
+ *   auto pub = node->create_publisher<AdaptedType>("image", 10);
+ *   auto sub = node->create_subscription<AdaptedType>(
+ *     "image", 10, [](std::shared_ptr<const cv::Mat> image) {...});
+ *
+ * The custom type must be copyable and default constructible, like messages are.
+ * The intra-process publishers and subscriptions only communicate if they use the same type,
+ * custom or not, otherwise the messages go through the middleware.
+ * The messages published asynchronously and the ones loaned to subscriptions are converted too,
+ * but rclcpp::LoanedMessage can't be used to publish an adapted type.
+ *
+ * A custom type can hold a handle to memory that isn't accessible from the host, e.g. an image
+ * in the memory of a GPU with the stream it is written on.
+ * The intra-process subscriptions get the handle as it was published, or a copy of it made by
+ * the copy constructor of the custom type for the subscriptions taking ownership, so the memory
+ * stays on the device along a pipeline of nodes in the same process.
+ * A publisher only converts the messages of an adapted type, e.g. copying them to the host, if
+ * the middleware has a matched subscription or the QoS is transient local.
+ * The custom type is allocated with the allocator of the publisher options, which can be a pool
+ * of pinned memory, its own memory on the device is managed by the custom type.
+ *
+ * \sa adapt_type, RCLCPP_USING_CUSTOM_TYPE_AS_ROS_MESSAGE_TYPE.
+ */
+template<typename CustomType, typename ROSMessageType = void, class Enable = void>
+struct TypeAdapter
+{
+  using is_specialized = std::false_type;
+  using custom_type = CustomType;
+  // In this case, the CustomType is the only thing given, or there is no specialization.
+  // Assign ros_message_type to CustomType for the former case.
+  using ros_message_type = CustomType;
+};
+
+/// Helper template to determine if a type is a TypeAdapter, false specialization.
+template<typename T>
+struct is_type_adapter : std::false_type {};
+
+/// Helper template to determine if a type is a TypeAdapter, true specialization.
+template<typename ... Ts>
+struct is_type_adapter<TypeAdapter<Ts...>>: std::true_type {};
+
+/// Identity specialization for TypeAdapter, so that TypeAdapter<AdapterT> is AdapterT.
+template<typename T>
+struct TypeAdapter<T, void, std::enable_if_t<is_type_adapter<T>::value>>: T {};
+
+/// Template structure used to declare a TypeAdapter as the adapter of its custom type.
+/**
+ * It is specialized by RCLCPP_USING_CUSTOM_TYPE_AS_ROS_MESSAGE_TYPE(), TypeAdapter<CustomType>
+ * is then the adapter it was given, so the custom type can be used directly as message type.
+ */
+template<typename CustomType>
+struct ImplicitTypeAdapter
+{
+  using is_specialized = std::false_type;
+};
+
+/// Specialization of TypeAdapter for the custom types with an implicit adapter.
+template<typename T>
+struct TypeAdapter<T, void, std::enable_if_t<ImplicitTypeAdapter<T>::is_specialized::value>>
+  : ImplicitTypeAdapter<T>
+{};
+
+/// Assigns the custom type implicitly to the given custom type/ros message type pair.
+/**
+ * It must be used at global scope, e.g.:
+ *
+ *   RCLCPP_USING_CUSTOM_TYPE_AS_ROS_MESSAGE_TYPE(cv::Mat, sensor_msgs::msg::Image);
+ *   auto pub = node->create_publisher<cv::Mat>("image", 10);
+ *
+ * \sa TypeAdapter
+ */
+#define RCLCPP_USING_CUSTOM_TYPE_AS_ROS_MESSAGE_TYPE(CustomType, ROSMessageType) \
+  template<> \
+  struct rclcpp::ImplicitTypeAdapter<CustomType> \
+    : public rclcpp::TypeAdapter<CustomType, ROSMessageType> \
+  { \
+    static_assert( \
+      is_specialized::value, \
+      "Cannot use custom type as ros type if there is no TypeAdapter for that pair"); \
+  }
+
+/// Template metafunction that can make the type being adapted explicit.
+/**
+ * e.g. `rclcpp::adapt_type<cv::Mat>::as<sensor_msgs::msg::Image>`, which is the same as
+ * `rclcpp::TypeAdapter<cv::Mat, sensor_msgs::msg::Image>`.
+ */
+template<typename CustomType>
+struct adapt_type
+{
+  template<typename ROSMessageType>
+  using as = TypeAdapter<CustomType, ROSMessageType>;
+};
+
+namespace detail
+{
+
+/// Call `f` with the message, converted to the ROS message type if `MessageT` is adapted.
+template<typename MessageT, typename FunctorT>
+void
+with_ros_message(
+  const typename TypeAdapter<MessageT>::custom_type & msg, FunctorT && f, std::false_type)
+{
+  f(msg);
+}
+
+template<typename MessageT, typename FunctorT>
+void
+with_ros_message(
+  const typename TypeAdapter<MessageT>::custom_type & msg, FunctorT && f, std::true_type)
+{
+  typename TypeAdapter<MessageT>::ros_message_type ros_msg;
+  TypeAdapter<MessageT>::convert_to_ros_message(msg, ros_msg);
+  f(ros_msg);
+}
+
+template<typename MessageT, typename FunctorT>
+void
+with_ros_message(const typename TypeAdapter<MessageT>::custom_type & msg, FunctorT && f)
+{
+  with_ros_message<MessageT>(
+    msg, std::forward<FunctorT>(f), typename TypeAdapter<MessageT>::is_specialized());
+}
+
+/// Return a ROS message shared pointer, converting the message if `MessageT` is adapted.
+template<typename MessageT>
+std::shared_ptr<const typename TypeAdapter<MessageT>::ros_message_type>
+to_shared_ros_message(
+  std::shared_ptr<const typename TypeAdapter<MessageT>::custom_type> msg, std::false_type)
+{
+  return msg;
+}
+
+template<typename MessageT>
+std::shared_ptr<const typename TypeAdapter<MessageT>::ros_message_type>
+to_shared_ros_message(
+  std::shared_ptr<const typename TypeAdapter<MessageT>::custom_type> msg, std::true_type)
+{
+  auto ros_msg = std::make_shared<typename TypeAdapter<MessageT>::ros_message_type>();
+  TypeAdapter<MessageT>::convert_to_ros_message(*msg, *ros_msg);
+  return ros_msg;
+}
+
+template<typename MessageT>
+std::shared_ptr<const typename TypeAdapter<MessageT>::ros_message_type>
+to_shared_ros_message(std::shared_ptr<const typename TypeAdapter<MessageT>::custom_type> msg)
+{
+  return to_shared_ros_message<MessageT>(
+    std::move(msg), typename TypeAdapter<MessageT>::is_specialized());
+}
+
+}  // namespace detail
+}  // namespace rclcpp
+
+#endif  // RCLCPP__TYPE_ADAPTER_HPP_
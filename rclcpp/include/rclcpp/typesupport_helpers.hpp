@@ -0,0 +1,77 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__TYPESUPPORT_HELPERS_HPP_
+#define RCLCPP__TYPESUPPORT_HELPERS_HPP_
+
+#include <memory>
+#include <string>
+#include <tuple>
+
+#include "rcpputils/shared_library.hpp"
+#include "rosidl_runtime_c/message_type_support_struct.h"
+
+#include "rclcpp/visibility_control.hpp"
+
+namespace rclcpp
+{
+
+/// Split a message type name into its package, its interface directory and its type.
+/**
+ * Both the "package/msg/Type" and the "package/Type" forms are accepted, the interface
+ * directory of the latter is "msg".
+ *
+ * \param[in] full_type the name of the message type, e.g. "std_msgs/msg/String".
+ * \return a tuple of the package name, the interface directory and the type name.
+ * \throws std::invalid_argument if the type name is malformed.
+ */
+RCLCPP_PUBLIC
+std::tuple<std::string, std::string, std::string>
+extract_type_identifier(const std::string & full_type);
+
+/// Load the type support library of the package of a message type.
+/**
+ * The library, e.g. "libstd_msgs__rosidl_typesupport_cpp.so" for "std_msgs/msg/String", is
+ * found through the library search path of the process.
+ *
+ * \param[in] type the name of the message type, e.g. "std_msgs/msg/String".
+ * \param[in] typesupport_identifier the type support, e.g. "rosidl_typesupport_cpp".
+ * \return the loaded library, which must outlive the type supports taken from it.
+ * \throws std::invalid_argument if the type name is malformed.
+ * \throws std::runtime_error if the library can't be loaded.
+ */
+RCLCPP_PUBLIC
+std::shared_ptr<rcpputils::SharedLibrary>
+get_typesupport_library(const std::string & type, const std::string & typesupport_identifier);
+
+/// Get the type support of a message type from its loaded type support library.
+/**
+ * \param[in] type the name of the message type, e.g. "std_msgs/msg/String".
+ * \param[in] typesupport_identifier the type support, e.g. "rosidl_typesupport_cpp".
+ * \param[in] library the library returned by get_typesupport_library() for the type.
+ * \return the type support of the message type.
+ * \throws std::invalid_argument if the type name is malformed.
+ * \throws std::runtime_error if the library has no type support for the type.
+ */
+RCLCPP_PUBLIC
+const rosidl_message_type_support_t *
+get_typesupport_handle(
+  const std::string & type,
+  const std::string & typesupport_identifier,
+  rcpputils::SharedLibrary & library);
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__TYPESUPPORT_HELPERS_HPP_
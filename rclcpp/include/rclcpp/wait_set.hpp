@@ -0,0 +1,72 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__WAIT_SET_HPP_
+#define RCLCPP__WAIT_SET_HPP_
+
+#include <cstddef>
+
+#include "rclcpp/wait_set_policies/dynamic_storage.hpp"
+#include "rclcpp/wait_set_policies/sequential_synchronization.hpp"
+#include "rclcpp/wait_set_policies/static_storage.hpp"
+#include "rclcpp/wait_set_policies/thread_safe_synchronization.hpp"
+#include "rclcpp/wait_set_template.hpp"
+
+namespace rclcpp
+{
+
+/// Wait set whose entities can be added and removed, used by one thread at a time.
+using WaitSet = rclcpp::WaitSetTemplate<
+  rclcpp::wait_set_policies::DynamicStorage,
+  rclcpp::wait_set_policies::SequentialSynchronization
+>;
+
+/// Wait set with a fixed number of each entity, which doesn't allocate after construction.
+/**
+ * For example, a wait set for one subscription and one timer:
+ *
+ * ```cpp
+ * rclcpp::StaticWaitSet<1, 0, 1, 0, 0, 0> wait_set({{subscription}}, {}, {{timer}});
+ * ```
+ */
+template<
+  std::size_t NumberOfSubscriptions,
+  std::size_t NumberOfGuardConditions,
+  std::size_t NumberOfTimers,
+  std::size_t NumberOfClients,
+  std::size_t NumberOfServices,
+  std::size_t NumberOfWaitables
+>
+using StaticWaitSet = rclcpp::WaitSetTemplate<
+  rclcpp::wait_set_policies::StaticStorage<
+    NumberOfSubscriptions,
+    NumberOfGuardConditions,
+    NumberOfTimers,
+    NumberOfClients,
+    NumberOfServices,
+    NumberOfWaitables
+  >,
+  rclcpp::wait_set_policies::SequentialSynchronization
+>;
+
+/// Wait set whose entities can be added and removed while another thread waits on it.
+using ThreadSafeWaitSet = rclcpp::WaitSetTemplate<
+  rclcpp::wait_set_policies::DynamicStorage,
+  rclcpp::wait_set_policies::ThreadSafeSynchronization
+>;
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__WAIT_SET_HPP_
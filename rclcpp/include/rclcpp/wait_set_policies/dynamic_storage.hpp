@@ -0,0 +1,62 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__WAIT_SET_POLICIES__DYNAMIC_STORAGE_HPP_
+#define RCLCPP__WAIT_SET_POLICIES__DYNAMIC_STORAGE_HPP_
+
+#include <memory>
+#include <vector>
+
+#include "rcl/guard_condition.h"
+
+#include "rclcpp/client.hpp"
+#include "rclcpp/service.hpp"
+#include "rclcpp/subscription_base.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+namespace wait_set_policies
+{
+
+/// Storage of the entities of a wait set which can be added and removed after construction.
+/**
+ * The rcl wait set is resized when the number of entities changes.
+ */
+class DynamicStorage
+{
+public:
+  static constexpr bool is_mutable = true;
+
+  using SubscriptionSequence = std::vector<rclcpp::SubscriptionBase::SharedPtr>;
+  using GuardConditionSequence = std::vector<rcl_guard_condition_t *>;
+  using TimerSequence = std::vector<rclcpp::TimerBase::SharedPtr>;
+  using ClientSequence = std::vector<rclcpp::ClientBase::SharedPtr>;
+  using ServiceSequence = std::vector<rclcpp::ServiceBase::SharedPtr>;
+  using WaitableSequence = std::vector<rclcpp::Waitable::SharedPtr>;
+
+  SubscriptionSequence subscriptions;
+  GuardConditionSequence guard_conditions;
+  TimerSequence timers;
+  ClientSequence clients;
+  ServiceSequence services;
+  WaitableSequence waitables;
+};
+
+}  // namespace wait_set_policies
+}  // namespace rclcpp
+
+#endif  // RCLCPP__WAIT_SET_POLICIES__DYNAMIC_STORAGE_HPP_
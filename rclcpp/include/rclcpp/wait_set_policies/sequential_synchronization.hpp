@@ -0,0 +1,54 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__WAIT_SET_POLICIES__SEQUENTIAL_SYNCHRONIZATION_HPP_
+#define RCLCPP__WAIT_SET_POLICIES__SEQUENTIAL_SYNCHRONIZATION_HPP_
+
+#include "rcl/guard_condition.h"
+
+namespace rclcpp
+{
+namespace wait_set_policies
+{
+
+/// Synchronization of a wait set used by one thread at a time, which does nothing.
+class SequentialSynchronization
+{
+public:
+  void
+  lock_for_change(rcl_guard_condition_t *)
+  {}
+
+  void
+  unlock_after_change()
+  {}
+
+  void
+  lock_for_wait()
+  {}
+
+  void
+  unlock_after_wait()
+  {}
+
+  void
+  yield_to_changes()
+  {}
+};
+
+}  // namespace wait_set_policies
+}  // namespace rclcpp
+
+#endif  // RCLCPP__WAIT_SET_POLICIES__SEQUENTIAL_SYNCHRONIZATION_HPP_
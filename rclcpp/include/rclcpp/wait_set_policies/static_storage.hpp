@@ -0,0 +1,74 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__WAIT_SET_POLICIES__STATIC_STORAGE_HPP_
+#define RCLCPP__WAIT_SET_POLICIES__STATIC_STORAGE_HPP_
+
+#include <array>
+#include <cstddef>
+
+#include "rcl/guard_condition.h"
+
+#include "rclcpp/client.hpp"
+#include "rclcpp/service.hpp"
+#include "rclcpp/subscription_base.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/waitable.hpp"
+
+namespace rclcpp
+{
+namespace wait_set_policies
+{
+
+/// Storage of a fixed set of entities, given when the wait set is constructed.
+/**
+ * The number of each kind of entity is part of the type, the entities are kept in std::array
+ * and can't be added or removed afterwards, so the rcl wait set is allocated once with the
+ * right size and waiting allocates nothing.
+ * nullptr entries are skipped.
+ */
+template<
+  std::size_t NumberOfSubscriptions,
+  std::size_t NumberOfGuardConditions,
+  std::size_t NumberOfTimers,
+  std::size_t NumberOfClients,
+  std::size_t NumberOfServices,
+  std::size_t NumberOfWaitables
+>
+class StaticStorage
+{
+public:
+  static constexpr bool is_mutable = false;
+
+  using SubscriptionSequence = std::array<rclcpp::SubscriptionBase::SharedPtr,
+      NumberOfSubscriptions>;
+  using GuardConditionSequence = std::array<rcl_guard_condition_t *, NumberOfGuardConditions>;
+  using TimerSequence = std::array<rclcpp::TimerBase::SharedPtr, NumberOfTimers>;
+  using ClientSequence = std::array<rclcpp::ClientBase::SharedPtr, NumberOfClients>;
+  using ServiceSequence = std::array<rclcpp::ServiceBase::SharedPtr, NumberOfServices>;
+  using WaitableSequence = std::array<rclcpp::Waitable::SharedPtr, NumberOfWaitables>;
+
+  SubscriptionSequence subscriptions;
+  GuardConditionSequence guard_conditions;
+  TimerSequence timers;
+  ClientSequence clients;
+  ServiceSequence services;
+  WaitableSequence waitables;
+};
+
+}  // namespace wait_set_policies
+}  // namespace rclcpp
+
+#endif  // RCLCPP__WAIT_SET_POLICIES__STATIC_STORAGE_HPP_
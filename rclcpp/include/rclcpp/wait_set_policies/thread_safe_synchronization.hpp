@@ -0,0 +1,94 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__WAIT_SET_POLICIES__THREAD_SAFE_SYNCHRONIZATION_HPP_
+#define RCLCPP__WAIT_SET_POLICIES__THREAD_SAFE_SYNCHRONIZATION_HPP_
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include "rcl/guard_condition.h"
+
+#include "rclcpp/exceptions.hpp"
+
+namespace rclcpp
+{
+namespace wait_set_policies
+{
+
+/// Synchronization of a wait set whose entities can be changed while another thread waits.
+/**
+ * The thread changing the entities wakes up the waiting thread with the interrupt guard
+ * condition of the wait set, which lets the change in and waits again.
+ */
+class ThreadSafeSynchronization
+{
+public:
+  void
+  lock_for_change(rcl_guard_condition_t * interrupt_guard_condition)
+  {
+    pending_changes_.fetch_add(1);
+    rcl_ret_t ret = rcl_trigger_guard_condition(interrupt_guard_condition);
+    if (RCL_RET_OK != ret) {
+      pending_changes_.fetch_sub(1);
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to interrupt the wait set");
+    }
+    mutex_.lock();
+    pending_changes_.fetch_sub(1);
+  }
+
+  void
+  unlock_after_change()
+  {
+    mutex_.unlock();
+  }
+
+  void
+  lock_for_wait()
+  {
+    mutex_.lock();
+  }
+
+  void
+  unlock_after_wait()
+  {
+    mutex_.unlock();
+  }
+
+  /// Called by the waiting thread between two waits, with the lock held.
+  void
+  yield_to_changes()
+  {
+    if (0u == pending_changes_.load()) {
+      return;
+    }
+    mutex_.unlock();
+    while (pending_changes_.load() > 0u) {
+      std::this_thread::yield();
+    }
+    mutex_.lock();
+  }
+
+private:
+  std::mutex mutex_;
+  /// Number of threads waiting to change the entities.
+  std::atomic<size_t> pending_changes_{0};
+};
+
+}  // namespace wait_set_policies
+}  // namespace rclcpp
+
+#endif  // RCLCPP__WAIT_SET_POLICIES__THREAD_SAFE_SYNCHRONIZATION_HPP_
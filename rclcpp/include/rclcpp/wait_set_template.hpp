@@ -0,0 +1,552 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP__WAIT_SET_TEMPLATE_HPP_
+#define RCLCPP__WAIT_SET_TEMPLATE_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "rcl/guard_condition.h"
+#include "rcl/wait.h"
+
+#include "rclcpp/client.hpp"
+#include "rclcpp/context.hpp"
+#include "rclcpp/contexts/default_context.hpp"
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/macros.hpp"
+#include "rclcpp/scope_exit.hpp"
+#include "rclcpp/service.hpp"
+#include "rclcpp/subscription_base.hpp"
+#include "rclcpp/timer.hpp"
+#include "rclcpp/waitable.hpp"
+#include "rcutils/logging_macros.h"
+
+namespace rclcpp
+{
+
+/// Outcome of WaitSetTemplate::wait().
+enum class WaitResultKind
+{
+  /// At least one entity of the wait set is ready.
+  Ready,
+  /// The timeout elapsed before an entity was ready.
+  Timeout,
+  /// The wait set has no entity, it didn't wait.
+  Empty,
+  /// The context of the wait set is shutdown.
+  Shutdown,
+};
+
+/// Wait for a chosen set of entities to be ready, without an executor.
+/**
+ * The entities are kept by the StoragePolicy, either a fixed set given at construction
+ * (wait_set_policies::StaticStorage) or one which can be changed afterwards
+ * (wait_set_policies::DynamicStorage).
+ * The SynchronizationPolicy decides if the entities can be changed while another thread is
+ * waiting, see wait_set_policies::ThreadSafeSynchronization.
+ *
+ * The wait set also holds a guard condition triggered by the shutdown of its context, so that
+ * wait() returns WaitResultKind::Shutdown instead of blocking forever.
+ *
+ * After wait() returned WaitResultKind::Ready, is_ready() tells which entities are ready, until
+ * the next call to wait().
+ * Nothing is executed: the user takes the messages, requests or responses, and calls the timers.
+ */
+template<class StoragePolicy, class SynchronizationPolicy>
+class WaitSetTemplate final
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS_NOT_COPYABLE(WaitSetTemplate)
+
+  using SubscriptionSequence = typename StoragePolicy::SubscriptionSequence;
+  using GuardConditionSequence = typename StoragePolicy::GuardConditionSequence;
+  using TimerSequence = typename StoragePolicy::TimerSequence;
+  using ClientSequence = typename StoragePolicy::ClientSequence;
+  using ServiceSequence = typename StoragePolicy::ServiceSequence;
+  using WaitableSequence = typename StoragePolicy::WaitableSequence;
+
+  /// Construct a wait set with the given entities.
+  /**
+   * The guard conditions aren't owned by the wait set, they must outlive it.
+   *
+   * \throws std::runtime_error if the context isn't initialized.
+   * \throws rclcpp::exceptions::RCLError if the rcl wait set can't be created.
+   */
+  explicit WaitSetTemplate(
+    const SubscriptionSequence & subscriptions = {},
+    const GuardConditionSequence & guard_conditions = {},
+    const TimerSequence & timers = {},
+    const ClientSequence & clients = {},
+    const ServiceSequence & services = {},
+    const WaitableSequence & waitables = {},
+    rclcpp::Context::SharedPtr context =
+    rclcpp::contexts::default_context::get_global_default_context())
+  : context_(std::move(context))
+  {
+    if (!context_ || !context_->get_rcl_context()) {
+      throw std::runtime_error("the context of a wait set must be initialized");
+    }
+    storage_.subscriptions = subscriptions;
+    storage_.guard_conditions = guard_conditions;
+    storage_.timers = timers;
+    storage_.clients = clients;
+    storage_.services = services;
+    storage_.waitables = waitables;
+
+    rcl_ret_t ret = rcl_guard_condition_init(
+      &interrupt_guard_condition_, context_->get_rcl_context().get(),
+      rcl_guard_condition_get_default_options());
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to create interrupt guard condition");
+    }
+    Sizes sizes = count_entities();
+    ret = rcl_wait_set_init(
+      &rcl_wait_set_, sizes.subscriptions, sizes.guard_conditions, sizes.timers, sizes.clients,
+      sizes.services, sizes.events, context_->get_rcl_context().get(),
+      rcl_get_default_allocator());
+    if (RCL_RET_OK != ret) {
+      rcl_ret_t fini_ret = rcl_guard_condition_fini(&interrupt_guard_condition_);
+      (void)fini_ret;
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to create wait set");
+    }
+    context_->add_interrupt_guard_condition(&interrupt_guard_condition_);
+  }
+
+  ~WaitSetTemplate()
+  {
+    context_->remove_interrupt_guard_condition(&interrupt_guard_condition_);
+    if (RCL_RET_OK != rcl_wait_set_fini(&rcl_wait_set_)) {
+      RCUTILS_LOG_ERROR_NAMED(
+        "rclcpp", "failed to destroy wait set: %s", rcl_get_error_string().str);
+      rcl_reset_error();
+    }
+    if (RCL_RET_OK != rcl_guard_condition_fini(&interrupt_guard_condition_)) {
+      RCUTILS_LOG_ERROR_NAMED(
+        "rclcpp", "failed to destroy guard condition: %s", rcl_get_error_string().str);
+      rcl_reset_error();
+    }
+  }
+
+  /// Add a subscription, only for a dynamic storage.
+  /**
+   * \throws std::invalid_argument if subscription is nullptr.
+   * \throws std::runtime_error if the subscription was already added.
+   */
+  void
+  add_subscription(rclcpp::SubscriptionBase::SharedPtr subscription)
+  {
+    add_entity(storage_.subscriptions, std::move(subscription), "subscription");
+  }
+
+  /// Remove a subscription, only for a dynamic storage.
+  /** \throws std::runtime_error if the subscription isn't in the wait set. */
+  void
+  remove_subscription(const rclcpp::SubscriptionBase::SharedPtr & subscription)
+  {
+    remove_entity(storage_.subscriptions, subscription, "subscription");
+  }
+
+  /// Add a guard condition, not owned by the wait set, only for a dynamic storage.
+  void
+  add_guard_condition(rcl_guard_condition_t * guard_condition)
+  {
+    add_entity(storage_.guard_conditions, guard_condition, "guard condition");
+  }
+
+  /// Remove a guard condition, only for a dynamic storage.
+  void
+  remove_guard_condition(rcl_guard_condition_t * guard_condition)
+  {
+    remove_entity(storage_.guard_conditions, guard_condition, "guard condition");
+  }
+
+  /// Add a timer, only for a dynamic storage.
+  void
+  add_timer(rclcpp::TimerBase::SharedPtr timer)
+  {
+    add_entity(storage_.timers, std::move(timer), "timer");
+  }
+
+  /// Remove a timer, only for a dynamic storage.
+  void
+  remove_timer(const rclcpp::TimerBase::SharedPtr & timer)
+  {
+    remove_entity(storage_.timers, timer, "timer");
+  }
+
+  /// Add a client, only for a dynamic storage.
+  void
+  add_client(rclcpp::ClientBase::SharedPtr client)
+  {
+    add_entity(storage_.clients, std::move(client), "client");
+  }
+
+  /// Remove a client, only for a dynamic storage.
+  void
+  remove_client(const rclcpp::ClientBase::SharedPtr & client)
+  {
+    remove_entity(storage_.clients, client, "client");
+  }
+
+  /// Add a service, only for a dynamic storage.
+  void
+  add_service(rclcpp::ServiceBase::SharedPtr service)
+  {
+    add_entity(storage_.services, std::move(service), "service");
+  }
+
+  /// Remove a service, only for a dynamic storage.
+  void
+  remove_service(const rclcpp::ServiceBase::SharedPtr & service)
+  {
+    remove_entity(storage_.services, service, "service");
+  }
+
+  /// Add a waitable, only for a dynamic storage.
+  void
+  add_waitable(rclcpp::Waitable::SharedPtr waitable)
+  {
+    add_entity(storage_.waitables, std::move(waitable), "waitable");
+  }
+
+  /// Remove a waitable, only for a dynamic storage.
+  void
+  remove_waitable(const rclcpp::Waitable::SharedPtr & waitable)
+  {
+    remove_entity(storage_.waitables, waitable, "waitable");
+  }
+
+  /// Wait until an entity is ready, the timeout elapsed, or the context is shutdown.
+  /**
+   * \param[in] timeout Maximum time to wait, negative to wait without limit, zero to only check
+   *   the entities.
+   * \throws rclcpp::exceptions::RCLError if waiting fails.
+   */
+  template<typename Rep = int64_t, typename Period = std::milli>
+  WaitResultKind
+  wait(std::chrono::duration<Rep, Period> timeout = std::chrono::duration<Rep, Period>(-1))
+  {
+    auto timeout_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(timeout);
+    auto deadline = std::chrono::steady_clock::now() + timeout_ns;
+
+    synchronization_.lock_for_wait();
+    RCLCPP_SCOPE_EXIT(synchronization_.unlock_after_wait(); );
+    while (true) {
+      if (!context_->is_valid()) {
+        return WaitResultKind::Shutdown;
+      }
+      if (!fill_wait_set()) {
+        return WaitResultKind::Empty;
+      }
+
+      rcl_ret_t ret = rcl_wait(&rcl_wait_set_, timeout_ns.count());
+      if (RCL_RET_TIMEOUT == ret) {
+        return WaitResultKind::Timeout;
+      }
+      if (RCL_RET_OK != ret) {
+        rclcpp::exceptions::throw_from_rcl_error(ret, "failed to wait on wait set");
+      }
+      // The interrupt guard condition is at index 0, the entities are ready if anything else is.
+      if (has_ready_entity()) {
+        return WaitResultKind::Ready;
+      }
+      if (!context_->is_valid()) {
+        return WaitResultKind::Shutdown;
+      }
+      // Woken up to change the entities, let the change in and wait for the remaining time.
+      synchronization_.yield_to_changes();
+      if (timeout_ns >= std::chrono::nanoseconds::zero()) {
+        timeout_ns = std::max(
+          std::chrono::nanoseconds::zero(), std::chrono::duration_cast<std::chrono::nanoseconds>(
+            deadline - std::chrono::steady_clock::now()));
+      }
+    }
+  }
+
+  /// Return true if the subscription was ready in the last wait().
+  bool
+  is_ready(const rclcpp::SubscriptionBase::SharedPtr & subscription) const
+  {
+    const rcl_subscription_t * handle = subscription->get_subscription_handle().get();
+    return contains(rcl_wait_set_.subscriptions, rcl_wait_set_.size_of_subscriptions, handle);
+  }
+
+  /// Return true if the guard condition was triggered before the last wait() returned.
+  bool
+  is_ready(const rcl_guard_condition_t * guard_condition) const
+  {
+    return contains(
+      rcl_wait_set_.guard_conditions, rcl_wait_set_.size_of_guard_conditions, guard_condition);
+  }
+
+  /// Return true if the timer was ready in the last wait().
+  bool
+  is_ready(const rclcpp::TimerBase::SharedPtr & timer) const
+  {
+    const rcl_timer_t * handle = timer->get_timer_handle().get();
+    return contains(rcl_wait_set_.timers, rcl_wait_set_.size_of_timers, handle);
+  }
+
+  /// Return true if the client had a response in the last wait().
+  bool
+  is_ready(const rclcpp::ClientBase::SharedPtr & client) const
+  {
+    const rcl_client_t * handle = client->get_client_handle().get();
+    return contains(rcl_wait_set_.clients, rcl_wait_set_.size_of_clients, handle);
+  }
+
+  /// Return true if the service had a request in the last wait().
+  bool
+  is_ready(const rclcpp::ServiceBase::SharedPtr & service) const
+  {
+    const rcl_service_t * handle = service->get_service_handle().get();
+    return contains(rcl_wait_set_.services, rcl_wait_set_.size_of_services, handle);
+  }
+
+  /// Return true if the waitable was ready in the last wait().
+  bool
+  is_ready(const rclcpp::Waitable::SharedPtr & waitable)
+  {
+    return waitable->is_ready(&rcl_wait_set_);
+  }
+
+  /// Return the context of the wait set.
+  rclcpp::Context::SharedPtr
+  get_context() const
+  {
+    return context_;
+  }
+
+  /// Return the rcl wait set, as filled by the last wait().
+  const rcl_wait_set_t &
+  get_rcl_wait_set() const
+  {
+    return rcl_wait_set_;
+  }
+
+private:
+  RCLCPP_DISABLE_COPY(WaitSetTemplate)
+
+  struct Sizes
+  {
+    size_t subscriptions = 0;
+    size_t guard_conditions = 0;
+    size_t timers = 0;
+    size_t clients = 0;
+    size_t services = 0;
+    size_t events = 0;
+  };
+
+  template<typename SequenceT, typename EntityT>
+  void
+  add_entity(SequenceT & sequence, EntityT entity, const char * kind)
+  {
+    static_assert(
+      StoragePolicy::is_mutable, "the entities of a wait set with a static storage can't change");
+    if (!entity) {
+      throw std::invalid_argument(std::string(kind) + " is nullptr");
+    }
+    synchronization_.lock_for_change(&interrupt_guard_condition_);
+    RCLCPP_SCOPE_EXIT(synchronization_.unlock_after_change(); );
+    if (std::find(sequence.begin(), sequence.end(), entity) != sequence.end()) {
+      throw std::runtime_error(std::string(kind) + " already in the wait set");
+    }
+    sequence.push_back(std::move(entity));
+  }
+
+  template<typename SequenceT, typename EntityT>
+  void
+  remove_entity(SequenceT & sequence, const EntityT & entity, const char * kind)
+  {
+    static_assert(
+      StoragePolicy::is_mutable, "the entities of a wait set with a static storage can't change");
+    synchronization_.lock_for_change(&interrupt_guard_condition_);
+    RCLCPP_SCOPE_EXIT(synchronization_.unlock_after_change(); );
+    auto it = std::find(sequence.begin(), sequence.end(), entity);
+    if (it == sequence.end()) {
+      throw std::runtime_error(std::string(kind) + " not in the wait set");
+    }
+    sequence.erase(it);
+  }
+
+  template<typename HandleT>
+  static bool
+  contains(HandleT * const * handles, size_t size, const HandleT * handle)
+  {
+    if (!handle) {
+      return false;
+    }
+    for (size_t i = 0; i < size; ++i) {
+      if (handles[i] == handle) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  template<typename SequenceT>
+  static size_t
+  count_non_null(const SequenceT & sequence)
+  {
+    return static_cast<size_t>(
+      std::count_if(
+        sequence.begin(), sequence.end(), [](const auto & entity) {return entity != nullptr;}));
+  }
+
+  Sizes
+  count_entities() const
+  {
+    Sizes sizes;
+    sizes.subscriptions = count_non_null(storage_.subscriptions);
+    // The interrupt guard condition comes first.
+    sizes.guard_conditions = 1 + count_non_null(storage_.guard_conditions);
+    sizes.timers = count_non_null(storage_.timers);
+    sizes.clients = count_non_null(storage_.clients);
+    sizes.services = count_non_null(storage_.services);
+    for (const auto & waitable : storage_.waitables) {
+      if (waitable) {
+        sizes.subscriptions += waitable->get_number_of_ready_subscriptions();
+        sizes.guard_conditions += waitable->get_number_of_ready_guard_conditions();
+        sizes.timers += waitable->get_number_of_ready_timers();
+        sizes.clients += waitable->get_number_of_ready_clients();
+        sizes.services += waitable->get_number_of_ready_services();
+        sizes.events += waitable->get_number_of_ready_events();
+      }
+    }
+    return sizes;
+  }
+
+  /// Put the interrupt guard condition and the entities in the rcl wait set.
+  /** \return false if there is no entity to wait for. */
+  bool
+  fill_wait_set()
+  {
+    Sizes sizes = count_entities();
+    if (
+      1u == sizes.guard_conditions && 0u == sizes.subscriptions && 0u == sizes.timers &&
+      0u == sizes.clients && 0u == sizes.services && 0u == sizes.events)
+    {
+      return false;
+    }
+    rcl_ret_t ret;
+    if (
+      rcl_wait_set_.size_of_subscriptions != sizes.subscriptions ||
+      rcl_wait_set_.size_of_guard_conditions != sizes.guard_conditions ||
+      rcl_wait_set_.size_of_timers != sizes.timers ||
+      rcl_wait_set_.size_of_clients != sizes.clients ||
+      rcl_wait_set_.size_of_services != sizes.services ||
+      rcl_wait_set_.size_of_events != sizes.events)
+    {
+      ret = rcl_wait_set_resize(
+        &rcl_wait_set_, sizes.subscriptions, sizes.guard_conditions, sizes.timers, sizes.clients,
+        sizes.services, sizes.events);
+      if (RCL_RET_OK != ret) {
+        rclcpp::exceptions::throw_from_rcl_error(ret, "failed to resize wait set");
+      }
+    }
+    ret = rcl_wait_set_clear(&rcl_wait_set_);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to clear wait set");
+    }
+    ret = rcl_wait_set_add_guard_condition(&rcl_wait_set_, &interrupt_guard_condition_, NULL);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to add guard condition to wait set");
+    }
+    for (const auto & subscription : storage_.subscriptions) {
+      if (subscription) {
+        ret = rcl_wait_set_add_subscription(
+          &rcl_wait_set_, subscription->get_subscription_handle().get(), NULL);
+        if (RCL_RET_OK != ret) {
+          rclcpp::exceptions::throw_from_rcl_error(ret, "failed to add subscription to wait set");
+        }
+      }
+    }
+    for (const auto & guard_condition : storage_.guard_conditions) {
+      if (guard_condition) {
+        ret = rcl_wait_set_add_guard_condition(&rcl_wait_set_, guard_condition, NULL);
+        if (RCL_RET_OK != ret) {
+          rclcpp::exceptions::throw_from_rcl_error(
+            ret, "failed to add guard condition to wait set");
+        }
+      }
+    }
+    for (const auto & timer : storage_.timers) {
+      if (timer) {
+        ret = rcl_wait_set_add_timer(&rcl_wait_set_, timer->get_timer_handle().get(), NULL);
+        if (RCL_RET_OK != ret) {
+          rclcpp::exceptions::throw_from_rcl_error(ret, "failed to add timer to wait set");
+        }
+      }
+    }
+    for (const auto & client : storage_.clients) {
+      if (client) {
+        ret = rcl_wait_set_add_client(&rcl_wait_set_, client->get_client_handle().get(), NULL);
+        if (RCL_RET_OK != ret) {
+          rclcpp::exceptions::throw_from_rcl_error(ret, "failed to add client to wait set");
+        }
+      }
+    }
+    for (const auto & service : storage_.services) {
+      if (service) {
+        ret = rcl_wait_set_add_service(&rcl_wait_set_, service->get_service_handle().get(), NULL);
+        if (RCL_RET_OK != ret) {
+          rclcpp::exceptions::throw_from_rcl_error(ret, "failed to add service to wait set");
+        }
+      }
+    }
+    for (const auto & waitable : storage_.waitables) {
+      if (waitable && !waitable->add_to_wait_set(&rcl_wait_set_)) {
+        throw std::runtime_error("failed to add waitable to wait set");
+      }
+    }
+    return true;
+  }
+
+  /// Return true if an entity other than the interrupt guard condition is ready.
+  bool
+  has_ready_entity() const
+  {
+    auto any = [](auto handles, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+          if (handles[i]) {
+            return true;
+          }
+        }
+        return false;
+      };
+    return
+      any(rcl_wait_set_.subscriptions, rcl_wait_set_.size_of_subscriptions) ||
+      any(rcl_wait_set_.guard_conditions + 1, rcl_wait_set_.size_of_guard_conditions - 1) ||
+      any(rcl_wait_set_.timers, rcl_wait_set_.size_of_timers) ||
+      any(rcl_wait_set_.clients, rcl_wait_set_.size_of_clients) ||
+      any(rcl_wait_set_.services, rcl_wait_set_.size_of_services) ||
+      any(rcl_wait_set_.events, rcl_wait_set_.size_of_events);
+  }
+
+  rclcpp::Context::SharedPtr context_;
+  StoragePolicy storage_;
+  SynchronizationPolicy synchronization_;
+  rcl_guard_condition_t interrupt_guard_condition_ = rcl_get_zero_initialized_guard_condition();
+  rcl_wait_set_t rcl_wait_set_ = rcl_get_zero_initialized_wait_set();
+};
+
+}  // namespace rclcpp
+
+#endif  // RCLCPP__WAIT_SET_TEMPLATE_HPP_
@@ -35,6 +35,13 @@
 #define RCLCPP_FIRST_ARG(N, ...) N
 #define RCLCPP_ALL_BUT_FIRST_ARGS(N, ...) __VA_ARGS__
 
+// Checks the severity against the level cached in the logger, see RCLCPP_LOGGING_CACHE_LEVELS.
+#if RCLCPP_LOGGING_CACHE_LEVELS
+#define RCLCPP_LOG_IS_ENABLED_FOR(logger, severity) (logger).is_enabled_for(severity)
+#else
+#define RCLCPP_LOG_IS_ENABLED_FOR(logger, severity) true
+#endif
+
 /**
  * \def RCLCPP_LOG_MIN_SEVERITY
  * Define RCLCPP_LOG_MIN_SEVERITY=RCLCPP_LOG_MIN_SEVERITY_[DEBUG|INFO|WARN|ERROR|FATAL]
@@ -128,6 +135,9 @@ def get_rclcpp_suffix_from_features(features):
       ::std::is_same<typename std::remove_cv<typename std::remove_reference<decltype(logger)>::type>::type, \
       typename ::rclcpp::Logger>::value, \
       "First argument to logging macros must be an rclcpp::Logger"); \
+    if (!RCLCPP_LOG_IS_ENABLED_FOR(logger, RCUTILS_LOG_SEVERITY_@(severity))) { \
+      break; \
+    } \
 @[ if 'throttle' in feature_combination]@ \
     auto get_time_point = [&c=clock](rcutils_time_point_value_t * time_point) -> rcutils_ret_t { \
       try { \
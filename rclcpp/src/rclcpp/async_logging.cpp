@@ -0,0 +1,309 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/experimental/async_logging.hpp"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/experimental/lock_free_bounded_queue.hpp"
+#include "rcutils/logging.h"
+
+using rclcpp::experimental::AsyncLoggingOptions;
+using rclcpp::experimental::AsyncLoggingStatistics;
+
+namespace
+{
+
+struct LogRecord
+{
+  // Points to the static location of a logging macro
+  const rcutils_log_location_t * location = nullptr;
+  int severity = 0;
+  rcutils_time_point_value_t timestamp = 0;
+  std::array<char, 128> name;
+  std::array<char, 1024> message;
+};
+
+void
+call_output_handler(
+  rcutils_logging_output_handler_t output_handler,
+  const rcutils_log_location_t * location,
+  int severity, const char * name, rcutils_time_point_value_t timestamp,
+  const char * format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  output_handler(location, severity, name, timestamp, format, &args);
+  va_end(args);
+}
+
+class AsyncLogger
+{
+public:
+  AsyncLogger(size_t queue_depth, rcutils_logging_output_handler_t output_handler)
+  : output_handler_(output_handler), queue_(queue_depth)
+  {
+    thread_ = std::thread(&AsyncLogger::run, this);
+  }
+
+  ~AsyncLogger()
+  {
+    stop();
+  }
+
+  rcutils_logging_output_handler_t
+  get_output_handler() const
+  {
+    return output_handler_;
+  }
+
+  void
+  log(
+    const rcutils_log_location_t * location,
+    int severity, const char * name, rcutils_time_point_value_t timestamp,
+    const char * format, va_list * args)
+  {
+    if (stopped_.load(std::memory_order_acquire)) {
+      // Logged while the asynchronous logging was being disabled.
+      output_handler_(location, severity, name, timestamp, format, args);
+      return;
+    }
+    LogRecord record;
+    record.location = location;
+    record.severity = severity;
+    record.timestamp = timestamp;
+    bool truncated = false;
+    const char * record_name = name ? name : "";
+    size_t name_length = std::strlen(record_name);
+    if (name_length >= record.name.size()) {
+      name_length = record.name.size() - 1;
+      truncated = true;
+    }
+    std::memcpy(record.name.data(), record_name, name_length);
+    record.name[name_length] = '\0';
+    int message_length = std::vsnprintf(
+      record.message.data(), record.message.size(), format, *args);
+    if (message_length < 0) {
+      record.message[0] = '\0';
+    } else if (static_cast<size_t>(message_length) >= record.message.size()) {
+      truncated = true;
+    }
+    if (truncated) {
+      truncated_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (!queue_.try_push(std::move(record))) {
+      dropped_count_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    pushed_count_.fetch_add(1, std::memory_order_release);
+    size_t depth = queue_.size();
+    size_t max_depth = max_queue_depth_.load(std::memory_order_relaxed);
+    while (depth > max_depth &&
+      !max_queue_depth_.compare_exchange_weak(max_depth, depth, std::memory_order_relaxed))
+    {
+    }
+    // Only lock the mutex if the thread isn't already woken up.
+    if (!pending_.exchange(true)) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      condition_variable_.notify_one();
+    }
+  }
+
+  void
+  flush()
+  {
+    uint64_t pushed_count = pushed_count_.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(mutex_);
+    drained_condition_variable_.wait(
+      lock, [this, pushed_count]() {
+        return written_count_.load() >= pushed_count || stop_;
+      });
+  }
+
+  void
+  stop()
+  {
+    stopped_.store(true, std::memory_order_release);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    condition_variable_.notify_one();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+    // The records queued while the thread was stopping.
+    write_queued();
+    drained_condition_variable_.notify_all();
+  }
+
+  AsyncLoggingStatistics
+  get_statistics() const
+  {
+    AsyncLoggingStatistics statistics;
+    statistics.written_count = written_count_.load(std::memory_order_relaxed);
+    statistics.dropped_count = dropped_count_.load(std::memory_order_relaxed);
+    statistics.truncated_count = truncated_count_.load(std::memory_order_relaxed);
+    statistics.max_queue_depth = max_queue_depth_.load(std::memory_order_relaxed);
+    return statistics;
+  }
+
+private:
+  void
+  run()
+  {
+    while (true) {
+      bool stop;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_variable_.wait(lock, [this]() {return pending_.load() || stop_;});
+        // Reset before writing, so that the records queued meanwhile wake the thread again.
+        pending_.store(false);
+        stop = stop_;
+      }
+      write_queued();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        drained_condition_variable_.notify_all();
+      }
+      if (stop) {
+        return;
+      }
+    }
+  }
+
+  void
+  write_queued()
+  {
+    LogRecord record;
+    while (queue_.try_pop(record)) {
+      call_output_handler(
+        output_handler_, record.location, record.severity, record.name.data(), record.timestamp,
+        "%s", record.message.data());
+      written_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  const rcutils_logging_output_handler_t output_handler_;
+  rclcpp::experimental::LockFreeBoundedQueue<LogRecord> queue_;
+  std::atomic<bool> stopped_{false};
+  std::atomic<bool> pending_{false};
+  std::atomic<uint64_t> pushed_count_{0};
+  std::atomic<uint64_t> written_count_{0};
+  std::atomic<uint64_t> dropped_count_{0};
+  std::atomic<uint64_t> truncated_count_{0};
+  std::atomic<size_t> max_queue_depth_{0};
+  bool stop_ = false;
+  std::mutex mutex_;
+  std::condition_variable condition_variable_;
+  std::condition_variable drained_condition_variable_;
+  std::thread thread_;
+};
+
+std::mutex g_async_logging_mutex;
+// The logger in use, nullptr if the asynchronous logging is disabled
+AsyncLogger * g_async_logger = nullptr;
+// The last logger, used by the output handler. A thread may still be in the output handler when
+// the logging is disabled, so the loggers are kept until the process exits.
+std::atomic<AsyncLogger *> g_last_async_logger{nullptr};
+std::vector<std::unique_ptr<AsyncLogger>> g_async_loggers;
+
+void
+async_output_handler(
+  const rcutils_log_location_t * location,
+  int severity, const char * name, rcutils_time_point_value_t timestamp,
+  const char * format, va_list * args)
+{
+  AsyncLogger * logger = g_last_async_logger.load(std::memory_order_acquire);
+  if (logger) {
+    logger->log(location, severity, name, timestamp, format, args);
+  }
+}
+
+}  // namespace
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+void
+enable_async_logging(const AsyncLoggingOptions & options)
+{
+  std::lock_guard<std::mutex> lock(g_async_logging_mutex);
+  if (g_async_logger) {
+    throw std::runtime_error("asynchronous logging is already enabled");
+  }
+  rcutils_logging_output_handler_t output_handler = rcutils_logging_get_output_handler();
+  if (!output_handler) {
+    throw std::runtime_error("no logging output handler to write the logs asynchronously");
+  }
+  g_async_loggers.emplace_back(new AsyncLogger(options.queue_depth, output_handler));
+  g_async_logger = g_async_loggers.back().get();
+  g_last_async_logger.store(g_async_logger, std::memory_order_release);
+  rcutils_logging_set_output_handler(&async_output_handler);
+}
+
+void
+disable_async_logging()
+{
+  std::lock_guard<std::mutex> lock(g_async_logging_mutex);
+  if (!g_async_logger) {
+    return;
+  }
+  rcutils_logging_set_output_handler(g_async_logger->get_output_handler());
+  g_async_logger->stop();
+  g_async_logger = nullptr;
+}
+
+bool
+is_async_logging_enabled()
+{
+  std::lock_guard<std::mutex> lock(g_async_logging_mutex);
+  return nullptr != g_async_logger;
+}
+
+void
+flush_async_logging()
+{
+  AsyncLogger * logger = g_last_async_logger.load(std::memory_order_acquire);
+  if (logger) {
+    logger->flush();
+  }
+}
+
+AsyncLoggingStatistics
+get_async_logging_statistics()
+{
+  AsyncLogger * logger = g_last_async_logger.load(std::memory_order_acquire);
+  if (!logger) {
+    return AsyncLoggingStatistics();
+  }
+  return logger->get_statistics();
+}
+
+}  // namespace experimental
+}  // namespace rclcpp
@@ -0,0 +1,99 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/experimental/async_publish_sender.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using rclcpp::experimental::AsyncPublishSender;
+
+AsyncPublishSender::AsyncPublishSender(rclcpp::Context & context)
+: pending_(false), stop_(false)
+{
+  context.on_shutdown([this]() {this->stop();});
+}
+
+AsyncPublishSender::~AsyncPublishSender()
+{
+  stop();
+}
+
+void
+AsyncPublishSender::add_queue(std::weak_ptr<AsyncPublisherQueueBase> queue)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  queues_.push_back(std::move(queue));
+  if (!stop_ && !thread_.joinable()) {
+    thread_ = std::thread(&AsyncPublishSender::run, this);
+  }
+}
+
+void
+AsyncPublishSender::notify()
+{
+  if (pending_.exchange(true)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  condition_variable_.notify_one();
+}
+
+void
+AsyncPublishSender::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  condition_variable_.notify_one();
+  if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+    thread_.join();
+  }
+}
+
+void
+AsyncPublishSender::run()
+{
+  std::vector<std::shared_ptr<AsyncPublisherQueueBase>> queues;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_variable_.wait(lock, [this]() {return pending_.load() || stop_;});
+      if (stop_) {
+        return;
+      }
+      // Reset before draining, so that the messages queued meanwhile wake the thread again.
+      pending_.store(false);
+      queues_.erase(
+        std::remove_if(
+          queues_.begin(), queues_.end(),
+          [](const std::weak_ptr<AsyncPublisherQueueBase> & queue) {return queue.expired();}),
+        queues_.end());
+      for (auto & queue : queues_) {
+        auto locked_queue = queue.lock();
+        if (locked_queue) {
+          queues.push_back(std::move(locked_queue));
+        }
+      }
+    }
+    for (auto & queue : queues) {
+      queue->publish_queued();
+    }
+    queues.clear();
+  }
+}
@@ -20,7 +20,8 @@ using rclcpp::callback_group::CallbackGroup;
 using rclcpp::callback_group::CallbackGroupType;
 
 CallbackGroup::CallbackGroup(CallbackGroupType group_type)
-: type_(group_type), can_be_taken_from_(true)
+: type_(group_type), can_be_taken_from_(true), priority_(0), assigned_executor_(nullptr),
+  cpu_time_ns_(0)
 {}
 
 
@@ -36,6 +37,62 @@ CallbackGroup::type() const
   return type_;
 }
 
+void
+CallbackGroup::set_priority(int priority)
+{
+  priority_.store(priority);
+}
+
+int
+CallbackGroup::get_priority() const
+{
+  return priority_.load();
+}
+
+void
+CallbackGroup::assign_to_executor(const rclcpp::executor::Executor * executor)
+{
+  assigned_executor_.store(executor);
+}
+
+const rclcpp::executor::Executor *
+CallbackGroup::get_assigned_executor() const
+{
+  return assigned_executor_.load();
+}
+
+bool
+CallbackGroup::is_assigned_to(const rclcpp::executor::Executor * executor) const
+{
+  const rclcpp::executor::Executor * assigned_executor = assigned_executor_.load();
+  return !assigned_executor || assigned_executor == executor;
+}
+
+void
+CallbackGroup::add_cpu_time(std::chrono::nanoseconds cpu_time)
+{
+  cpu_time_ns_.fetch_add(cpu_time.count(), std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds
+CallbackGroup::get_cpu_time() const
+{
+  return std::chrono::nanoseconds(cpu_time_ns_.load(std::memory_order_relaxed));
+}
+
+void
+CallbackGroup::add_publisher(const rclcpp::PublisherBase::SharedPtr publisher_ptr)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  publisher_ptrs_.push_back(publisher_ptr);
+  publisher_ptrs_.erase(
+    std::remove_if(
+      publisher_ptrs_.begin(),
+      publisher_ptrs_.end(),
+      [](rclcpp::PublisherBase::WeakPtr x) {return x.expired();}),
+    publisher_ptrs_.end());
+}
+
 void
 CallbackGroup::add_subscription(
   const rclcpp::SubscriptionBase::SharedPtr subscription_ptr)
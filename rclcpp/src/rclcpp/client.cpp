@@ -17,13 +17,16 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdio>
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "rcl/graph.h"
 #include "rcl/node.h"
 #include "rcl/wait.h"
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/future_waiter.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_graph_interface.hpp"
 #include "rclcpp/utilities.hpp"
@@ -66,6 +69,10 @@ ClientBase::ClientBase(
 
 ClientBase::~ClientBase()
 {
+  auto intra_process_manager = intra_process_manager_.lock();
+  if (intra_process_manager && intra_process_client_) {
+    intra_process_manager->remove_client(intra_process_client_id_);
+  }
   // Make sure the client handle is destructed as early as possible and before the node handle
   client_handle_.reset();
 }
@@ -126,6 +133,16 @@ ClientBase::wait_for_service_nanoseconds(std::chrono::nanoseconds timeout)
     // check was non-blocking, return immediately
     return false;
   }
+  // Wait without querying the graph until the service is in it, the query on graph changes is
+  // shared by all the clients of the node waiting for a service.
+  if (!node_ptr->wait_for_service_in_graph(this->get_service_name(), timeout)) {
+    return false;
+  }
+  if (this->service_is_ready()) {
+    return true;
+  }
+  // The service is in the graph but not ready for this client yet, e.g. it has another type or
+  // the graph change was reported early, so the readiness of the client is polled.
   auto event = node_ptr->get_graph_event();
   // update the time even on the first loop to account for time spent in the first call
   // to this->server_is_ready()
@@ -177,3 +194,111 @@ ClientBase::get_rcl_node_handle() const
 {
   return node_handle_.get();
 }
+
+rclcpp::TimerBase::SharedPtr
+ClientBase::get_timeout_timer()
+{
+  std::lock_guard<std::mutex> lock(timeout_timer_mutex_);
+  if (!timeout_timer_) {
+    std::weak_ptr<ClientBase> weak_client = shared_from_this();
+    rclcpp::VoidCallbackType callback = [weak_client]() {
+        auto client = weak_client.lock();
+        if (client) {
+          client->expire_pending_requests();
+        }
+      };
+    // The period is replaced by the time until the nearest deadline when the timer is armed.
+    timeout_timer_ = std::make_shared<rclcpp::WallTimer<rclcpp::VoidCallbackType>>(
+      std::chrono::seconds(1), std::move(callback), context_);
+    arm_timeout_timer();
+  }
+  return timeout_timer_;
+}
+
+rclcpp::MemoryUsage
+ClientBase::get_memory_usage() const
+{
+  rclcpp::MemoryUsage usage;
+  usage.entity_bytes = sizeof(*this);
+  return usage;
+}
+
+void
+ClientBase::update_timeout_timer(
+  std::chrono::steady_clock::time_point deadline, bool earlier_only)
+{
+  {
+    std::lock_guard<std::mutex> lock(timeout_timer_mutex_);
+    if (earlier_only && deadline >= timeout_deadline_) {
+      return;
+    }
+    timeout_deadline_ = deadline;
+    if (!timeout_timer_) {
+      return;
+    }
+    arm_timeout_timer();
+  }
+  if (deadline != std::chrono::steady_clock::time_point::max()) {
+    rclcpp::executor::notify_future_waiters();
+  }
+}
+
+void
+ClientBase::arm_timeout_timer()
+{
+  if (timeout_deadline_ == std::chrono::steady_clock::time_point::max()) {
+    timeout_timer_->cancel();
+    return;
+  }
+  auto period = std::max(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      timeout_deadline_ - std::chrono::steady_clock::now()),
+    std::chrono::nanoseconds(1));
+  int64_t old_period = 0;
+  rcl_ret_t ret = rcl_timer_exchange_period(
+    timeout_timer_->get_timer_handle().get(), period.count(), &old_period);
+  if (ret != RCL_RET_OK) {
+    throw_from_rcl_error(ret, "Couldn't set the period of the timeout timer");
+  }
+  // The next call is now + period.
+  timeout_timer_->reset();
+}
+
+void
+ClientBase::setup_intra_process()
+{
+  auto intra_process_manager =
+    context_->get_sub_context<rclcpp::experimental::IntraProcessServiceManager>();
+  intra_process_client_ = std::make_shared<rclcpp::experimental::ClientIntraProcess>(
+    shared_from_this(), context_);
+  intra_process_client_id_ = intra_process_manager->add_client(intra_process_client_);
+  intra_process_manager_ = intra_process_manager;
+}
+
+rclcpp::Waitable::SharedPtr
+ClientBase::get_intra_process_waitable() const
+{
+  return intra_process_client_;
+}
+
+bool
+ClientBase::send_intra_process_request(
+  const std::type_info & service_type,
+  std::shared_ptr<void> request,
+  int64_t & sequence_number)
+{
+  auto intra_process_manager = intra_process_manager_.lock();
+  if (!intra_process_manager) {
+    return false;
+  }
+  auto service = intra_process_manager->get_service(get_service_name(), service_type);
+  if (!service) {
+    return false;
+  }
+  sequence_number = next_intra_process_sequence_number_.fetch_sub(1);
+  auto request_header = std::make_shared<rmw_request_id_t>();
+  rclcpp::experimental::IntraProcessServiceManager::set_request_header(
+    intra_process_client_id_, sequence_number, *request_header);
+  service->provide_request(std::move(request_header), std::move(request));
+  return true;
+}
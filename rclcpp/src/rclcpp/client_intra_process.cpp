@@ -0,0 +1,109 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/experimental/client_intra_process.hpp"
+
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rcl/error_handling.h"
+
+#include "rclcpp/client.hpp"
+
+using rclcpp::experimental::ClientIntraProcess;
+
+ClientIntraProcess::ClientIntraProcess(
+  std::shared_ptr<rclcpp::ClientBase> client,
+  rclcpp::Context::SharedPtr context)
+: client_(client)
+{
+  rcl_ret_t ret = rcl_guard_condition_init(
+    &gc_, context->get_rcl_context().get(), rcl_guard_condition_get_default_options());
+  if (RCL_RET_OK != ret) {
+    std::string error = rcl_get_error_string().str;
+    rcl_reset_error();
+    throw std::runtime_error(
+            "ClientIntraProcess init error initializing guard condition: " + error);
+  }
+}
+
+ClientIntraProcess::~ClientIntraProcess()
+{
+  if (rcl_guard_condition_fini(&gc_) != RCL_RET_OK) {
+    rcl_reset_error();
+  }
+}
+
+size_t
+ClientIntraProcess::get_number_of_ready_guard_conditions()
+{
+  return 1;
+}
+
+bool
+ClientIntraProcess::add_to_wait_set(rcl_wait_set_t * wait_set)
+{
+  if (rcl_wait_set_add_guard_condition(wait_set, &gc_, NULL) != RCL_RET_OK) {
+    return false;
+  }
+  // The trigger may have woken up another wait set, e.g. after the client was moved.
+  if (is_ready(wait_set)) {
+    rcl_ret_t ret = rcl_trigger_guard_condition(&gc_);
+    (void)ret;
+  }
+  return true;
+}
+
+bool
+ClientIntraProcess::is_ready(rcl_wait_set_t * wait_set)
+{
+  (void)wait_set;
+  std::lock_guard<std::mutex> lock(responses_mutex_);
+  return !responses_.empty();
+}
+
+void
+ClientIntraProcess::execute()
+{
+  std::vector<std::pair<int64_t, std::shared_ptr<void>>> responses;
+  {
+    std::lock_guard<std::mutex> lock(responses_mutex_);
+    responses.swap(responses_);
+  }
+  auto client = client_.lock();
+  if (!client) {
+    return;
+  }
+  for (auto & response : responses) {
+    auto request_header = client->create_request_header();
+    request_header->sequence_number = response.first;
+    client->handle_response(request_header, std::move(response.second));
+  }
+}
+
+void
+ClientIntraProcess::provide_response(int64_t sequence_number, std::shared_ptr<void> response)
+{
+  {
+    std::lock_guard<std::mutex> lock(responses_mutex_);
+    responses_.emplace_back(sequence_number, std::move(response));
+  }
+  rcl_ret_t ret = rcl_trigger_guard_condition(&gc_);
+  (void)ret;
+}
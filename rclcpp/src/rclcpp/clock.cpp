@@ -14,13 +14,45 @@
 
 #include "rclcpp/clock.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <stdexcept>
 #include <thread>
+#include <utility>
+#include <vector>
+
+#include "rcl/error_handling.h"
 
 #include "rclcpp/exceptions.hpp"
 
 #include "rcutils/logging_macros.h"
 
+namespace
+{
+
+// rcutils reads the same clocks as the std::chrono ones on Linux, CLOCK_REALTIME and
+// CLOCK_MONOTONIC, so now() can read them directly instead of going through rcl.
+#ifdef __linux__
+constexpr bool direct_now_available = true;
+#else
+constexpr bool direct_now_available = false;
+#endif
+
+int64_t
+direct_now(rcl_clock_type_t clock_type)
+{
+  if (RCL_STEADY_TIME == clock_type) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
 namespace rclcpp
 {
 
@@ -34,6 +66,26 @@ public:
     if (ret != RCL_RET_OK) {
       exceptions::throw_from_rcl_error(ret, "could not get current time stamp");
     }
+    if (RCL_ROS_TIME == clock_type) {
+      // Track the ROS time override, whoever changes it with the rcl clock handle, and wake up
+      // the sleepers on any change of the ROS time.
+      rcl_jump_threshold_t threshold;
+      threshold.on_clock_change = true;
+      threshold.min_forward.nanoseconds = 1;
+      threshold.min_backward.nanoseconds = -1;
+      ret = rcl_clock_add_jump_callback(&rcl_clock_, threshold, Impl::on_clock_change, this);
+      if (ret != RCL_RET_OK) {
+        if (rcl_clock_fini(&rcl_clock_) != RCL_RET_OK) {
+          RCUTILS_LOG_ERROR("Failed to fini rcl clock.");
+        }
+        exceptions::throw_from_rcl_error(ret, "Failed to add the ROS time override callback");
+      }
+      tracks_override_ = true;
+    }
+    direct_now_.store(
+      direct_now_available &&
+      (RCL_ROS_TIME == clock_type || RCL_SYSTEM_TIME == clock_type ||
+      RCL_STEADY_TIME == clock_type));
   }
 
   ~Impl()
@@ -44,9 +96,64 @@ public:
     }
   }
 
+  /// Return true if the rcl clock has jump callbacks other than the one of the override.
+  bool
+  has_user_jump_callbacks() const
+  {
+    return rcl_clock_.num_jump_callbacks > (tracks_override_ ? 1u : 0u);
+  }
+
+  static void
+  on_clock_change(const rcl_time_jump_t * time_jump, bool before_jump, void * user_data)
+  {
+    auto impl = static_cast<Impl *>(user_data);
+    if (before_jump) {
+      return;
+    }
+    if (direct_now_available) {
+      if (RCL_ROS_TIME_ACTIVATED == time_jump->clock_change) {
+        impl->direct_now_.store(false, std::memory_order_release);
+      } else if (RCL_ROS_TIME_DEACTIVATED == time_jump->clock_change) {
+        impl->direct_now_.store(true, std::memory_order_release);
+      }
+    }
+    impl->notify_sleepers();
+  }
+
+  /// Wake up the threads in sleep_until(), after a change of the time or of its source.
+  void
+  notify_sleepers()
+  {
+    // Pairs with the fence of the sleepers, after their increment of sleepers_: either they see
+    // the new time, or this sees them.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (0u == sleepers_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    sleep_cv_.notify_all();
+  }
+
   rcl_clock_t rcl_clock_;
   rcl_allocator_t allocator_;
   std::mutex clock_mutex_;
+  bool tracks_override_ = false;
+  /// True if now() can read the system or steady clock without rcl, i.e. the clock is not a ROS
+  /// clock with its override enabled.
+  std::atomic<bool> direct_now_{false};
+
+  /// Time of the SimTimeSource followed, nullptr if none.
+  std::atomic<const std::atomic<int64_t> *> sim_time_{nullptr};
+  /// Keep the times followed alive, now() may still read one after set_sim_time() changed it.
+  std::vector<std::shared_ptr<const std::atomic<int64_t>>> sim_time_owners_;
+  /// Last time given to the ROS time override by sync_sim_time().
+  std::atomic<int64_t> synced_sim_time_{-1};
+
+  /// Number of threads in sleep_until(), the time updates only notify them if there are any.
+  std::atomic<size_t> sleepers_{0};
+  std::mutex sleep_mutex_;
+  /// Notified on the updates of the ROS time, and by the contexts of the sleepers on shutdown.
+  std::condition_variable sleep_cv_;
 };
 
 JumpHandler::JumpHandler(
@@ -66,6 +173,14 @@ Clock::~Clock() {}
 Time
 Clock::now()
 {
+  const std::atomic<int64_t> * sim_time = impl_->sim_time_.load(std::memory_order_acquire);
+  if (sim_time) {
+    return Time(sim_time->load(std::memory_order_relaxed), RCL_ROS_TIME);
+  }
+  if (impl_->direct_now_.load(std::memory_order_acquire)) {
+    return Time(direct_now(impl_->rcl_clock_.type), impl_->rcl_clock_.type);
+  }
+
   Time now(0, 0, impl_->rcl_clock_.type);
 
   auto ret = rcl_clock_get_now(&impl_->rcl_clock_, &now.rcl_time_.nanoseconds);
@@ -76,6 +191,59 @@ Clock::now()
   return now;
 }
 
+bool
+Clock::sleep_until(Time until, Context::SharedPtr context)
+{
+  if (!context || !context->is_valid()) {
+    throw std::runtime_error("context cannot be slept with because it's invalid");
+  }
+  const rcl_clock_type_t clock_type = get_clock_type();
+  if (until.get_clock_type() != clock_type) {
+    throw std::invalid_argument("until's clock type does not match this clock's type");
+  }
+
+  // Registered before checking the time, see Impl::notify_sleepers().
+  context->add_interrupt_condition_variable(&impl_->sleep_cv_, &impl_->sleep_mutex_);
+  impl_->sleepers_.fetch_add(1u, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  struct SleepGuard
+  {
+    ~SleepGuard()
+    {
+      impl->sleepers_.fetch_sub(1u, std::memory_order_relaxed);
+      context->remove_interrupt_condition_variable(&impl->sleep_cv_);
+    }
+    Impl * impl;
+    Context * context;
+  } sleep_guard{impl_.get(), context.get()};
+
+  bool reached = false;
+  std::unique_lock<std::mutex> lock(impl_->sleep_mutex_);
+  while (context->is_valid()) {
+    const Time time = now();
+    if (time >= until) {
+      reached = true;
+      break;
+    }
+    const std::chrono::nanoseconds time_left((until - time).nanoseconds());
+    if (RCL_STEADY_TIME == clock_type) {
+      impl_->sleep_cv_.wait_until(lock, std::chrono::steady_clock::now() + time_left);
+    } else if (RCL_ROS_TIME == clock_type && ros_time_is_active()) {
+      // Woken up by the updates of the ROS time, which may never reach `until`.
+      impl_->sleep_cv_.wait(lock);
+    } else {
+      impl_->sleep_cv_.wait_until(lock, std::chrono::system_clock::now() + time_left);
+    }
+  }
+  return reached;
+}
+
+bool
+Clock::sleep_for(Duration rel_time, Context::SharedPtr context)
+{
+  return sleep_until(now() + rel_time, context);
+}
+
 bool
 Clock::ros_time_is_active()
 {
@@ -96,6 +264,10 @@ Clock::ros_time_is_active()
 rcl_clock_t *
 Clock::get_clock_handle() noexcept
 {
+  if (sync_sim_time() != RCL_RET_OK) {
+    RCUTILS_LOG_ERROR("Failed to set the simulated time: %s", rcl_get_error_string().str);
+    rcl_reset_error();
+  }
   return &impl_->rcl_clock_;
 }
 
@@ -111,6 +283,46 @@ Clock::get_clock_mutex() noexcept
   return impl_->clock_mutex_;
 }
 
+void
+Clock::set_sim_time(std::shared_ptr<const std::atomic<int64_t>> sim_time)
+{
+  std::lock_guard<std::mutex> clock_guard(impl_->clock_mutex_);
+  auto & owners = impl_->sim_time_owners_;
+  if (sim_time && std::find(owners.begin(), owners.end(), sim_time) == owners.end()) {
+    owners.push_back(sim_time);
+  }
+  impl_->synced_sim_time_.store(-1);
+  impl_->sim_time_.store(sim_time.get(), std::memory_order_release);
+  impl_->notify_sleepers();
+}
+
+void
+Clock::on_sim_time_update()
+{
+  impl_->notify_sleepers();
+  if (!impl_->has_user_jump_callbacks()) {
+    return;
+  }
+  rcl_ret_t ret = sync_sim_time();
+  if (ret != RCL_RET_OK) {
+    exceptions::throw_from_rcl_error(ret, "Failed to set ros_time_override");
+  }
+}
+
+rcl_ret_t
+Clock::sync_sim_time()
+{
+  const std::atomic<int64_t> * sim_time = impl_->sim_time_.load(std::memory_order_acquire);
+  if (!sim_time) {
+    return RCL_RET_OK;
+  }
+  int64_t time = sim_time->load(std::memory_order_relaxed);
+  if (impl_->synced_sim_time_.exchange(time) == time) {
+    return RCL_RET_OK;
+  }
+  return rcl_set_ros_time_override(&impl_->rcl_clock_, time);
+}
+
 void
 Clock::on_time_jump(
   const struct rcl_time_jump_t * time_jump,
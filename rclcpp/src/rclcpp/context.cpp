@@ -14,6 +14,8 @@
 
 #include "rclcpp/context.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <sstream>
@@ -24,13 +26,34 @@
 #include "rcl/init.h"
 #include "rclcpp/detail/utilities.hpp"
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/experimental/intra_process_manager.hpp"
 #include "rclcpp/logging.hpp"
 #include "rmw/impl/cpp/demangle.hpp"
 
-/// Mutex to protect initialized contexts.
+using WeakContexts = std::vector<std::weak_ptr<rclcpp::Context>>;
+
+/// Mutex to serialize the updates of g_contexts, the readers don't take it.
 static std::mutex g_contexts_mutex;
-/// Weak list of context to be shutdown by the signal handler.
-static std::vector<std::weak_ptr<rclcpp::Context>> g_contexts;
+/// Weak list of context to be shutdown by the signal handler, replaced on each update.
+static std::shared_ptr<const WeakContexts> g_contexts = std::make_shared<const WeakContexts>();
+
+/// Replace the list of contexts with a copy without expired contexts, nor `removed`, plus `added`.
+static void
+update_contexts(const rclcpp::Context * removed, std::weak_ptr<rclcpp::Context> added)
+{
+  std::lock_guard<std::mutex> lock(g_contexts_mutex);
+  auto contexts = std::make_shared<WeakContexts>();
+  for (const auto & weak_context : *std::atomic_load(&g_contexts)) {
+    auto shared_context = weak_context.lock();
+    if (shared_context && shared_context.get() != removed) {
+      contexts->push_back(weak_context);
+    }
+  }
+  if (!added.expired()) {
+    contexts->push_back(std::move(added));
+  }
+  std::atomic_store(&g_contexts, std::shared_ptr<const WeakContexts>(std::move(contexts)));
+}
 
 using rclcpp::Context;
 
@@ -101,10 +124,20 @@ Context::init(
       throw exceptions::UnknownROSArgsError(std::move(unparsed_ros_arguments));
     }
 
+    // rcl_init() may have set logger levels from the command line arguments.
+    rclcpp::invalidate_logger_levels();
+
     init_options_ = init_options;
+    entity_creation_locked_.store(false);
+
+    const EntityCapacities & capacities = init_options.entity_capacities;
+    if (!capacities.empty()) {
+      get_sub_context<rclcpp::experimental::IntraProcessManager>()->reserve(
+        capacities.publishers, capacities.subscriptions);
+    }
 
-    std::lock_guard<std::mutex> lock(g_contexts_mutex);
-    g_contexts.push_back(this->shared_from_this());
+    update_contexts(nullptr, this->shared_from_this());
+    valid_.store(true, std::memory_order_relaxed);
   } catch (const std::exception & e) {
     ret = rcl_shutdown(rcl_context_.get());
     rcl_context_.reset();
@@ -121,12 +154,7 @@ Context::init(
 bool
 Context::is_valid() const
 {
-  // Take a local copy of the shared pointer to avoid it getting nulled under our feet.
-  auto local_rcl_context = rcl_context_;
-  if (!local_rcl_context) {
-    return false;
-  }
-  return rcl_context_is_valid(local_rcl_context.get());
+  return valid_.load(std::memory_order_relaxed);
 }
 
 const rclcpp::InitOptions &
@@ -163,26 +191,23 @@ Context::shutdown(const std::string & reason)
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret);
   }
+  valid_.store(false, std::memory_order_relaxed);
   // set shutdown reason
   shutdown_reason_ = reason;
   // call each shutdown callback
   for (const auto & callback : on_shutdown_callbacks_) {
     callback();
   }
+  // detach all the intra-process entities at once, before they are destroyed one by one
+  auto ipm = find_sub_context<rclcpp::experimental::IntraProcessManager>();
+  if (ipm) {
+    ipm->clear();
+  }
   // interrupt all blocking sleep_for() and all blocking executors or wait sets
   this->interrupt_all_sleep_for();
   this->interrupt_all_wait_sets();
   // remove self from the global contexts
-  std::lock_guard<std::mutex> context_lock(g_contexts_mutex);
-  for (auto it = g_contexts.begin(); it != g_contexts.end(); ) {
-    auto shared_context = it->lock();
-    if (shared_context.get() == this) {
-      it = g_contexts.erase(it);
-      break;
-    } else {
-      ++it;
-    }
-  }
+  update_contexts(this, {});
   return true;
 }
 
@@ -232,7 +257,38 @@ Context::sleep_for(const std::chrono::nanoseconds & nanoseconds)
 void
 Context::interrupt_all_sleep_for()
 {
+  std::lock_guard<std::mutex> lock(interrupt_mutex_);
   interrupt_condition_variable_.notify_all();
+  for (const auto & condition_variable : interrupt_condition_variables_) {
+    // Lock the mutex of the waiters so none is between its check of is_valid() and its wait.
+    { std::lock_guard<std::mutex> waiter_lock(*condition_variable.second); }
+    condition_variable.first->notify_all();
+  }
+}
+
+void
+Context::add_interrupt_condition_variable(
+  std::condition_variable * condition_variable, std::mutex * mutex)
+{
+  if (!condition_variable || !mutex) {
+    throw std::invalid_argument("condition_variable or mutex is nullptr");
+  }
+  std::lock_guard<std::mutex> lock(interrupt_mutex_);
+  interrupt_condition_variables_.emplace_back(condition_variable, mutex);
+}
+
+void
+Context::remove_interrupt_condition_variable(std::condition_variable * condition_variable)
+{
+  std::lock_guard<std::mutex> lock(interrupt_mutex_);
+  auto it = std::find_if(
+    interrupt_condition_variables_.begin(), interrupt_condition_variables_.end(),
+    [condition_variable](const std::pair<std::condition_variable *, std::mutex *> & added) {
+      return added.first == condition_variable;
+    });
+  if (it != interrupt_condition_variables_.end()) {
+    interrupt_condition_variables_.erase(it);
+  }
 }
 
 rcl_guard_condition_t *
@@ -289,18 +345,69 @@ Context::release_interrupt_guard_condition(
   }
 }
 
+void
+Context::add_interrupt_guard_condition(rcl_guard_condition_t * guard_condition)
+{
+  if (!guard_condition) {
+    throw std::invalid_argument("guard_condition is nullptr");
+  }
+  std::lock_guard<std::mutex> lock(interrupt_guard_cond_handles_mutex_);
+  added_interrupt_guard_conditions_.push_back(guard_condition);
+}
+
+void
+Context::remove_interrupt_guard_condition(rcl_guard_condition_t * guard_condition)
+{
+  std::lock_guard<std::mutex> lock(interrupt_guard_cond_handles_mutex_);
+  auto it = std::find(
+    added_interrupt_guard_conditions_.begin(), added_interrupt_guard_conditions_.end(),
+    guard_condition);
+  if (it != added_interrupt_guard_conditions_.end()) {
+    added_interrupt_guard_conditions_.erase(it);
+  }
+}
+
+static void
+trigger_interrupt_guard_condition(rcl_guard_condition_t * guard_condition)
+{
+  rcl_ret_t status = rcl_trigger_guard_condition(guard_condition);
+  if (status != RCL_RET_OK) {
+    RCUTILS_LOG_ERROR_NAMED(
+      "rclcpp",
+      "failed to trigger guard condition in Context::interrupt_all_wait_sets(): %s",
+      rcl_get_error_string().str);
+  }
+}
+
 void
 Context::interrupt_all_wait_sets()
 {
   std::lock_guard<std::mutex> lock(interrupt_guard_cond_handles_mutex_);
   for (auto & kv : interrupt_guard_cond_handles_) {
-    rcl_ret_t status = rcl_trigger_guard_condition(&(kv.second));
-    if (status != RCL_RET_OK) {
-      RCUTILS_LOG_ERROR_NAMED(
-        "rclcpp",
-        "failed to trigger guard condition in Context::interrupt_all_wait_sets(): %s",
-        rcl_get_error_string().str);
-    }
+    trigger_interrupt_guard_condition(&(kv.second));
+  }
+  for (auto guard_condition : added_interrupt_guard_conditions_) {
+    trigger_interrupt_guard_condition(guard_condition);
+  }
+}
+
+void
+Context::lock_entity_creation()
+{
+  entity_creation_locked_.store(true);
+}
+
+bool
+Context::is_entity_creation_locked() const
+{
+  return entity_creation_locked_.load(std::memory_order_relaxed);
+}
+
+void
+Context::check_entity_creation(const char * entity_kind) const
+{
+  if (is_entity_creation_locked()) {
+    throw rclcpp::exceptions::EntityCreationLockedError(entity_kind);
   }
 }
 
@@ -315,15 +422,13 @@ Context::clean_up()
 std::vector<Context::SharedPtr>
 rclcpp::get_contexts()
 {
-  std::lock_guard<std::mutex> lock(g_contexts_mutex);
+  auto contexts = std::atomic_load(&g_contexts);
   std::vector<Context::SharedPtr> shared_contexts;
-  for (auto it = g_contexts.begin(); it != g_contexts.end(); /* noop */) {
-    auto context_ptr = it->lock();
-    if (!context_ptr) {
-      // remove invalid weak context pointers
-      it = g_contexts.erase(it);
-    } else {
-      ++it;
+  shared_contexts.reserve(contexts->size());
+  for (const auto & weak_context : *contexts) {
+    // the expired contexts are removed on the next update
+    auto context_ptr = weak_context.lock();
+    if (context_ptr) {
       shared_contexts.push_back(context_ptr);
     }
   }
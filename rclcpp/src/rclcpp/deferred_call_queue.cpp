@@ -0,0 +1,126 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/deferred_call_queue.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using rclcpp::executor::DeferredCallQueue;
+
+DeferredCallQueue::DeferredCallQueue()
+: last_handle_(0)
+{}
+
+uint64_t
+DeferredCallQueue::push(
+  std::chrono::steady_clock::time_point deadline,
+  Callback callback,
+  rclcpp::callback_group::CallbackGroup::WeakPtr group)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t handle = ++last_handle_;
+  calls_.emplace(handle, Call {std::move(callback), std::move(group)});
+  heap_.push_back(HeapItem {deadline, handle});
+  std::push_heap(heap_.begin(), heap_.end(), LaterDeadline());
+  return handle;
+}
+
+bool
+DeferredCallQueue::cancel(uint64_t handle)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (0u == calls_.erase(handle)) {
+    return false;
+  }
+  // Calls canceled long before their deadline, like timeouts, would otherwise pile up.
+  if (heap_.size() > 2 * calls_.size() + 64) {
+    auto canceled = [this](const HeapItem & item) {
+        return calls_.find(item.handle) == calls_.end();
+      };
+    heap_.erase(std::remove_if(heap_.begin(), heap_.end(), canceled), heap_.end());
+    std::make_heap(heap_.begin(), heap_.end(), LaterDeadline());
+  }
+  return true;
+}
+
+std::chrono::steady_clock::time_point
+DeferredCallQueue::get_next_deadline()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!prune_top()) {
+    return std::chrono::steady_clock::time_point::max();
+  }
+  return heap_.front().deadline;
+}
+
+bool
+DeferredCallQueue::take_next_ready(
+  const std::function<bool(const rclcpp::callback_group::CallbackGroup::SharedPtr &)> & can_take,
+  Callback & callback)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto now = std::chrono::steady_clock::now();
+  std::vector<HeapItem> skipped;
+  bool taken = false;
+  while (prune_top()) {
+    HeapItem item = heap_.front();
+    if (item.deadline > now) {
+      break;
+    }
+    std::pop_heap(heap_.begin(), heap_.end(), LaterDeadline());
+    heap_.pop_back();
+
+    auto it = calls_.find(item.handle);
+    auto call_group = it->second.group.lock();
+    if (!call_group) {
+      calls_.erase(it);
+      continue;
+    }
+    if (!can_take(call_group)) {
+      skipped.push_back(item);
+      continue;
+    }
+    callback = std::move(it->second.callback);
+    calls_.erase(it);
+    taken = true;
+    break;
+  }
+  for (const auto & item : skipped) {
+    heap_.push_back(item);
+    std::push_heap(heap_.begin(), heap_.end(), LaterDeadline());
+  }
+  return taken;
+}
+
+size_t
+DeferredCallQueue::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return calls_.size();
+}
+
+bool
+DeferredCallQueue::prune_top()
+{
+  while (!heap_.empty()) {
+    if (calls_.find(heap_.front().handle) != calls_.end()) {
+      return true;
+    }
+    std::pop_heap(heap_.begin(), heap_.end(), LaterDeadline());
+    heap_.pop_back();
+  }
+  return false;
+}
@@ -0,0 +1,104 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/detail/qos_event_handler_group.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace rclcpp
+{
+namespace detail
+{
+
+void
+QOSEventHandlerGroup::add_event_handler(
+  const std::shared_ptr<rclcpp::QOSEventHandlerBase> & event_handler)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  event_handlers_.push_back(event_handler);
+}
+
+size_t
+QOSEventHandlerGroup::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  event_handlers_.erase(
+    std::remove_if(
+      event_handlers_.begin(), event_handlers_.end(),
+      [](const std::weak_ptr<rclcpp::QOSEventHandlerBase> & x) {return x.expired();}),
+    event_handlers_.end());
+  return event_handlers_.size();
+}
+
+size_t
+QOSEventHandlerGroup::get_number_of_ready_events()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  waited_event_handlers_.clear();
+  auto iter = event_handlers_.begin();
+  while (iter != event_handlers_.end()) {
+    auto event_handler = iter->lock();
+    if (!event_handler) {
+      iter = event_handlers_.erase(iter);
+      continue;
+    }
+    waited_event_handlers_.push_back(std::move(event_handler));
+    ++iter;
+  }
+  return waited_event_handlers_.size();
+}
+
+bool
+QOSEventHandlerGroup::add_to_wait_set(rcl_wait_set_t * wait_set)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto & event_handler : waited_event_handlers_) {
+    event_handler->add_to_wait_set(wait_set);
+  }
+  return true;
+}
+
+bool
+QOSEventHandlerGroup::is_ready(rcl_wait_set_t * wait_set)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  ready_event_handlers_.clear();
+  for (auto & event_handler : waited_event_handlers_) {
+    if (event_handler->is_ready(wait_set)) {
+      ready_event_handlers_.push_back(event_handler);
+    }
+  }
+  return !ready_event_handlers_.empty();
+}
+
+void
+QOSEventHandlerGroup::execute()
+{
+  std::vector<EventHandlerSharedPtr> ready_event_handlers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready_event_handlers.swap(ready_event_handlers_);
+  }
+  for (auto & event_handler : ready_event_handlers) {
+    event_handler->execute();
+  }
+}
+
+}  // namespace detail
+}  // namespace rclcpp
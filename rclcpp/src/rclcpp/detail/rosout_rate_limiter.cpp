@@ -0,0 +1,212 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/detail/rosout_rate_limiter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "rcutils/logging.h"
+
+namespace
+{
+
+// Budget of the logs of a logger published to /rosout
+struct RosoutBudget
+{
+  rclcpp::RosoutRateLimit limit;
+  // Number of nodes using the logger name
+  size_t references = 1;
+  double messages = 0.0;
+  double bytes = 0.0;
+  std::chrono::steady_clock::time_point last_refill;
+  uint64_t suppressed_messages = 0;
+  uint64_t suppressed_bytes = 0;
+
+  double
+  message_capacity() const
+  {
+    return std::max(
+      limit.messages_per_second * std::chrono::duration<double>(limit.burst_duration).count(),
+      1.0);
+  }
+
+  double
+  byte_capacity() const
+  {
+    return static_cast<double>(limit.bytes_per_second) *
+           std::chrono::duration<double>(limit.burst_duration).count();
+  }
+
+  void
+  refill(std::chrono::steady_clock::time_point now)
+  {
+    double elapsed = std::chrono::duration<double>(now - last_refill).count();
+    last_refill = now;
+    messages = std::min(messages + elapsed * limit.messages_per_second, message_capacity());
+    bytes = std::min(
+      bytes + elapsed * static_cast<double>(limit.bytes_per_second), byte_capacity());
+  }
+
+  // Return true if the message fits in the budget, and take it from the budget
+  bool
+  consume(size_t message_size)
+  {
+    if (limit.messages_per_second > 0.0 && messages < 1.0) {
+      return false;
+    }
+    // A message larger than the whole budget is published once the budget is full.
+    double size = std::min(static_cast<double>(message_size), byte_capacity());
+    if (limit.bytes_per_second > 0 && bytes < size) {
+      return false;
+    }
+    messages -= 1.0;
+    bytes -= size;
+    return true;
+  }
+};
+
+std::mutex g_rosout_budgets_mutex;
+std::map<std::string, RosoutBudget, std::less<>> g_rosout_budgets;
+// Read by the output handler without locking, to skip the loggers of the nodes without limit
+std::atomic<size_t> g_rosout_budget_count{0};
+std::atomic<rcutils_logging_output_handler_t> g_previous_output_handler{nullptr};
+
+void
+call_output_handler(
+  rcutils_logging_output_handler_t output_handler,
+  const rcutils_log_location_t * location,
+  int severity, const char * name, rcutils_time_point_value_t timestamp,
+  const char * format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  output_handler(location, severity, name, timestamp, format, &args);
+  va_end(args);
+}
+
+void
+rate_limited_output_handler(
+  const rcutils_log_location_t * location,
+  int severity, const char * name, rcutils_time_point_value_t timestamp,
+  const char * format, va_list * args)
+{
+  rcutils_logging_output_handler_t previous_output_handler = g_previous_output_handler.load();
+  if (0u == g_rosout_budget_count.load(std::memory_order_relaxed) || !name) {
+    previous_output_handler(location, severity, name, timestamp, format, args);
+    return;
+  }
+
+  bool published;
+  bool console_when_suppressed = false;
+  uint64_t suppressed_messages = 0;
+  uint64_t suppressed_bytes = 0;
+  {
+    std::lock_guard<std::mutex> lock(g_rosout_budgets_mutex);
+    auto iter = g_rosout_budgets.find(name);
+    if (iter == g_rosout_budgets.end()) {
+      published = true;
+    } else {
+      RosoutBudget & budget = iter->second;
+      size_t message_size = 0;
+      if (budget.limit.bytes_per_second > 0) {
+        va_list args_copy;
+        va_copy(args_copy, *args);
+        int length = std::vsnprintf(nullptr, 0, format, args_copy);
+        va_end(args_copy);
+        message_size = length > 0 ? static_cast<size_t>(length) : 0u;
+      }
+      budget.refill(std::chrono::steady_clock::now());
+      published = budget.consume(message_size);
+      console_when_suppressed = budget.limit.console_when_suppressed;
+      if (published) {
+        suppressed_messages = budget.suppressed_messages;
+        suppressed_bytes = budget.suppressed_bytes;
+        budget.suppressed_messages = 0;
+        budget.suppressed_bytes = 0;
+      } else {
+        budget.suppressed_messages += 1;
+        budget.suppressed_bytes += message_size;
+      }
+    }
+  }
+
+  if (published) {
+    if (suppressed_messages > 0) {
+      call_output_handler(
+        previous_output_handler, location, RCUTILS_LOG_SEVERITY_WARN, name, timestamp,
+        "%" PRIu64 " messages (%" PRIu64 " bytes) were not published to /rosout, "
+        "over the rosout rate limit of the node",
+        suppressed_messages, suppressed_bytes);
+    }
+    previous_output_handler(location, severity, name, timestamp, format, args);
+  } else if (console_when_suppressed) {
+    rcutils_logging_console_output_handler(location, severity, name, timestamp, format, args);
+  }
+}
+
+}  // namespace
+
+namespace rclcpp
+{
+namespace detail
+{
+
+void
+add_rosout_rate_limit(const std::string & logger_name, const rclcpp::RosoutRateLimit & limit)
+{
+  std::lock_guard<std::mutex> lock(g_rosout_budgets_mutex);
+  if (!g_previous_output_handler.load()) {
+    g_previous_output_handler.store(rcutils_logging_get_output_handler());
+    rcutils_logging_set_output_handler(&rate_limited_output_handler);
+  }
+  auto iter = g_rosout_budgets.find(logger_name);
+  if (iter != g_rosout_budgets.end()) {
+    iter->second.references += 1;
+    return;
+  }
+  RosoutBudget budget;
+  budget.limit = limit;
+  budget.messages = budget.message_capacity();
+  budget.bytes = budget.byte_capacity();
+  budget.last_refill = std::chrono::steady_clock::now();
+  g_rosout_budgets.emplace(logger_name, budget);
+  g_rosout_budget_count.store(g_rosout_budgets.size(), std::memory_order_relaxed);
+}
+
+void
+remove_rosout_rate_limit(const std::string & logger_name)
+{
+  std::lock_guard<std::mutex> lock(g_rosout_budgets_mutex);
+  auto iter = g_rosout_budgets.find(logger_name);
+  if (iter == g_rosout_budgets.end()) {
+    return;
+  }
+  iter->second.references -= 1;
+  if (0u == iter->second.references) {
+    g_rosout_budgets.erase(iter);
+  }
+  g_rosout_budget_count.store(g_rosout_budgets.size(), std::memory_order_relaxed);
+}
+
+}  // namespace detail
+}  // namespace rclcpp
@@ -15,14 +15,17 @@
 #include "rclcpp/detail/utilities.hpp"
 
 #include <cassert>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/expand_topic_or_service_name.hpp"
 
 #include "rcl/allocator.h"
 #include "rcl/arguments.h"
+#include "rcl/remap.h"
 
 namespace rclcpp
 {
@@ -60,5 +63,55 @@ get_unparsed_ros_arguments(
   return unparsed_ros_arguments;
 }
 
+std::string
+resolve_topic_or_service_name(
+  const std::string & name,
+  const char * node_name,
+  const char * node_namespace,
+  const rcl_node_options_t & node_options,
+  const rcl_arguments_t * global_arguments,
+  bool is_service)
+{
+  std::string fqdn =
+    rclcpp::expand_topic_or_service_name(name, node_name, node_namespace, is_service);
+
+  auto remap = is_service ? &rcl_remap_service_name : &rcl_remap_topic_name;
+  char * remapped_name = nullptr;
+  rcl_ret_t ret = remap(
+    &(node_options.arguments),
+    global_arguments,
+    fqdn.c_str(),
+    node_name,
+    node_namespace,
+    node_options.allocator,
+    &remapped_name);
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(
+      ret, std::string("Failed to remap ") + (is_service ? "service" : "topic") + " name " + fqdn);
+  } else if (nullptr != remapped_name) {
+    fqdn = remapped_name;
+    node_options.allocator.deallocate(remapped_name, node_options.allocator.state);
+  }
+  return fqdn;
+}
+
+std::string
+topic_endpoint_key(
+  const std::string & resolved_topic_name,
+  const rosidl_message_type_support_t & type_support_handle,
+  const rmw_qos_profile_t & qos)
+{
+  std::ostringstream key;
+  key << resolved_topic_name << ' ' <<
+    // The type support of a message type is a single static object.
+    static_cast<const void *>(&type_support_handle) << ' ' <<
+    qos.history << ' ' << qos.depth << ' ' << qos.reliability << ' ' << qos.durability << ' ' <<
+    qos.deadline.sec << '.' << qos.deadline.nsec << ' ' <<
+    qos.lifespan.sec << '.' << qos.lifespan.nsec << ' ' << qos.liveliness << ' ' <<
+    qos.liveliness_lease_duration.sec << '.' << qos.liveliness_lease_duration.nsec << ' ' <<
+    qos.avoid_ros_namespace_conventions;
+  return key.str();
+}
+
 }  // namespace detail
 }  // namespace rclcpp
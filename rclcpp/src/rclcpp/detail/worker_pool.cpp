@@ -0,0 +1,101 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/detail/worker_pool.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "rclcpp/logging.hpp"
+
+using rclcpp::detail::WorkerPool;
+
+WorkerPool::WorkerPool(size_t number_of_threads)
+: state_(std::make_shared<State>())
+{
+  if (number_of_threads == 0) {
+    throw std::invalid_argument("a worker pool needs at least one thread");
+  }
+  threads_.reserve(number_of_threads);
+  for (size_t i = 0; i < number_of_threads; ++i) {
+    threads_.emplace_back(&WorkerPool::run, state_);
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->stopped = true;
+    state_->tasks.clear();
+  }
+  state_->condition.notify_all();
+  for (auto & thread : threads_) {
+    if (thread.get_id() == std::this_thread::get_id()) {
+      // Destroyed by one of its tasks, the thread ends when the task returns.
+      thread.detach();
+    } else {
+      thread.join();
+    }
+  }
+}
+
+void
+WorkerPool::post(Task task)
+{
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->tasks.push_back(std::move(task));
+  }
+  state_->condition.notify_one();
+}
+
+size_t
+WorkerPool::get_number_of_threads() const
+{
+  return threads_.size();
+}
+
+size_t
+WorkerPool::get_number_of_queued_tasks() const
+{
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->tasks.size();
+}
+
+void
+WorkerPool::run(std::shared_ptr<State> state)
+{
+  std::unique_lock<std::mutex> lock(state->mutex);
+  while (true) {
+    state->condition.wait(lock, [&state]() {return state->stopped || !state->tasks.empty();});
+    if (state->stopped) {
+      return;
+    }
+    Task task = std::move(state->tasks.front());
+    state->tasks.pop_front();
+    lock.unlock();
+    try {
+      task();
+    } catch (const std::exception & exception) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger("rclcpp"), "exception in a task of a worker pool: %s",
+        exception.what());
+    }
+    // The task, and what it holds, is released before waiting for the next one.
+    task = nullptr;
+    lock.lock();
+  }
+}
@@ -15,6 +15,8 @@
 #include <cmath>
 #include <cstdlib>
 #include <limits>
+#include <stdexcept>
+#include <string>
 #include <utility>
 
 #include "rclcpp/clock.hpp"
@@ -24,6 +26,7 @@
 
 #include "rcl/time.h"
 
+#include "rclcpp/detail/checked_arithmetic.hpp"
 #include "rclcpp/exceptions.hpp"
 
 #include "rcutils/logging_macros.h"
@@ -120,61 +123,24 @@ Duration::operator>(const rclcpp::Duration & rhs) const
   return rcl_duration_.nanoseconds > rhs.rcl_duration_.nanoseconds;
 }
 
-void
-bounds_check_duration_sum(int64_t lhsns, int64_t rhsns, uint64_t max)
-{
-  auto abs_lhs = static_cast<uint64_t>(std::abs(lhsns));
-  auto abs_rhs = static_cast<uint64_t>(std::abs(rhsns));
-
-  if (lhsns > 0 && rhsns > 0) {
-    if (abs_lhs + abs_rhs > max) {
-      throw std::overflow_error("addition leads to int64_t overflow");
-    }
-  } else if (lhsns < 0 && rhsns < 0) {
-    if (abs_lhs + abs_rhs > max) {
-      throw std::underflow_error("addition leads to int64_t underflow");
-    }
-  }
-}
-
 Duration
 Duration::operator+(const rclcpp::Duration & rhs) const
 {
-  bounds_check_duration_sum(
-    this->rcl_duration_.nanoseconds,
-    rhs.rcl_duration_.nanoseconds,
-    std::numeric_limits<rcl_duration_value_t>::max());
-  return Duration(
-    rcl_duration_.nanoseconds + rhs.rcl_duration_.nanoseconds);
-}
-
-void
-bounds_check_duration_difference(int64_t lhsns, int64_t rhsns, uint64_t max)
-{
-  auto abs_lhs = static_cast<uint64_t>(std::abs(lhsns));
-  auto abs_rhs = static_cast<uint64_t>(std::abs(rhsns));
-
-  if (lhsns > 0 && rhsns < 0) {
-    if (abs_lhs + abs_rhs > max) {
-      throw std::overflow_error("duration subtraction leads to int64_t overflow");
-    }
-  } else if (lhsns < 0 && rhsns > 0) {
-    if (abs_lhs + abs_rhs > max) {
-      throw std::underflow_error("duration subtraction leads to int64_t underflow");
-    }
+  rcl_duration_value_t sum;
+  if (!detail::checked_add(rcl_duration_.nanoseconds, rhs.rcl_duration_.nanoseconds, sum)) {
+    detail::throw_int64_overflow("addition", rhs.rcl_duration_.nanoseconds > 0);
   }
+  return Duration(sum);
 }
 
 Duration
 Duration::operator-(const rclcpp::Duration & rhs) const
 {
-  bounds_check_duration_difference(
-    this->rcl_duration_.nanoseconds,
-    rhs.rcl_duration_.nanoseconds,
-    std::numeric_limits<rcl_duration_value_t>::max());
-
-  return Duration(
-    rcl_duration_.nanoseconds - rhs.rcl_duration_.nanoseconds);
+  rcl_duration_value_t difference;
+  if (!detail::checked_sub(rcl_duration_.nanoseconds, rhs.rcl_duration_.nanoseconds, difference)) {
+    detail::throw_int64_overflow("duration subtraction", rhs.rcl_duration_.nanoseconds < 0);
+  }
+  return Duration(difference);
 }
 
 void
@@ -244,4 +210,17 @@ Duration::from_seconds(double seconds)
   return Duration(static_cast<int64_t>(RCL_S_TO_NS(seconds)));
 }
 
+namespace detail
+{
+
+void
+throw_int64_overflow(const char * operation, bool overflow)
+{
+  if (overflow) {
+    throw std::overflow_error(std::string(operation) + " leads to int64_t overflow");
+  }
+  throw std::underflow_error(std::string(operation) + " leads to int64_t underflow");
+}
+
+}  // namespace detail
 }  // namespace rclcpp
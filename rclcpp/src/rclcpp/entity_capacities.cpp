@@ -0,0 +1,119 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/entity_capacities.hpp"
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+
+std::string
+trim(const std::string & text)
+{
+  size_t begin = 0;
+  size_t end = text.size();
+  while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) {
+    ++begin;
+  }
+  while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1]))) {
+    --end;
+  }
+  return text.substr(begin, end - begin);
+}
+
+size_t *
+find_capacity(rclcpp::EntityCapacities & capacities, const std::string & name)
+{
+  if ("nodes" == name) {
+    return &capacities.nodes;
+  } else if ("publishers" == name) {
+    return &capacities.publishers;
+  } else if ("subscriptions" == name) {
+    return &capacities.subscriptions;
+  } else if ("timers" == name) {
+    return &capacities.timers;
+  } else if ("services" == name) {
+    return &capacities.services;
+  } else if ("clients" == name) {
+    return &capacities.clients;
+  } else if ("waitables" == name) {
+    return &capacities.waitables;
+  } else if ("guard_conditions" == name) {
+    return &capacities.guard_conditions;
+  } else if ("events" == name) {
+    return &capacities.events;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+namespace rclcpp
+{
+
+EntityCapacities
+load_entity_capacities(const std::string & path)
+{
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error("failed to open the entity capacities file '" + path + "'");
+  }
+  EntityCapacities capacities;
+  std::string line;
+  size_t line_number = 0;
+  while (std::getline(file, line)) {
+    ++line_number;
+    line = trim(line);
+    if (line.empty() || '#' == line[0]) {
+      continue;
+    }
+    auto error = [&path, line_number](const std::string & reason) {
+        return std::runtime_error(
+          "invalid entity capacities file '" + path + "', line " + std::to_string(line_number) +
+          ": " + reason);
+      };
+    size_t colon = line.find(':');
+    if (std::string::npos == colon) {
+      throw error("expected 'name: count'");
+    }
+    std::string name = trim(line.substr(0, colon));
+    std::string count = trim(line.substr(colon + 1));
+    size_t * capacity = find_capacity(capacities, name);
+    if (!capacity) {
+      throw error("unknown capacity '" + name + "'");
+    }
+    if (count.empty() || !std::isdigit(static_cast<unsigned char>(count[0]))) {
+      throw error("the count of '" + name + "' isn't a valid count");
+    }
+    char * end = nullptr;
+    errno = 0;
+    unsigned long long value = std::strtoull(count.c_str(), &end, 10);  // NOLINT(runtime/int)
+    if (ERANGE == errno || *end != '\0') {
+      throw error("the count of '" + name + "' isn't a valid count");
+    }
+    *capacity = static_cast<size_t>(value);
+  }
+  if (file.bad()) {
+    throw std::runtime_error("failed to read the entity capacities file '" + path + "'");
+  }
+  return capacities;
+}
+
+}  // namespace rclcpp
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <utility>
 
 #include "rclcpp/executable_list.hpp"
@@ -55,6 +56,23 @@ ExecutableList::add_subscription(rclcpp::SubscriptionBase::SharedPtr subscriptio
   this->number_of_subscriptions++;
 }
 
+void
+ExecutableList::add_collected_subscription(rclcpp::SubscriptionBase::SharedPtr subscription)
+{
+  if (subscription->has_shared_reader()) {
+    auto handle = subscription->get_subscription_handle();
+    auto it = std::find_if(
+      this->subscription.begin(), this->subscription.end(),
+      [&handle](const rclcpp::SubscriptionBase::SharedPtr & other) {
+        return other->get_subscription_handle() == handle;
+      });
+    if (it != this->subscription.end()) {
+      return;
+    }
+  }
+  add_subscription(std::move(subscription));
+}
+
 void
 ExecutableList::add_timer(rclcpp::TimerBase::SharedPtr timer)
 {
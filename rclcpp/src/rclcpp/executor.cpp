@@ -12,8 +12,17 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
 #include <algorithm>
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <type_traits>
 
@@ -22,21 +31,136 @@
 
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/executor.hpp"
+#include "rclcpp/executor_instrumentation.hpp"
 #include "rclcpp/node.hpp"
 #include "rclcpp/scope_exit.hpp"
+#include "rclcpp/tracepoints.hpp"
 #include "rclcpp/utilities.hpp"
 
 #include "rcutils/logging_macros.h"
 
+#include "rmw/error_handling.h"
+#include "rmw/rmw.h"
+
 using rclcpp::exceptions::throw_from_rcl_error;
 using rclcpp::executor::AnyExecutable;
 using rclcpp::executor::Executor;
 using rclcpp::executor::ExecutorArgs;
 using rclcpp::executor::FutureReturnCode;
 
+namespace
+{
+
+#ifdef RCLCPP_DISABLE_EXECUTOR_INSTRUMENTATION
+constexpr bool instrumentation_built = false;
+#else
+constexpr bool instrumentation_built = true;
+#endif
+
+/// Instrumentation of the executor executing on this thread, for the static execute functions.
+thread_local rclcpp::executor::ExecutorInstrumentation * current_instrumentation = nullptr;
+
+/// Record the duration of the scope as a phase, if there is instrumentation.
+class ScopedPhase
+{
+public:
+  ScopedPhase(
+    rclcpp::executor::ExecutorInstrumentation * instrumentation,
+    rclcpp::executor::ExecutorPhase phase)
+  : instrumentation_(instrumentation_built ? instrumentation : nullptr), phase_(phase)
+  {
+    if (instrumentation_) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~ScopedPhase()
+  {
+    if (instrumentation_) {
+      instrumentation_->record_phase(phase_, std::chrono::steady_clock::now() - start_);
+    }
+  }
+
+private:
+  rclcpp::executor::ExecutorInstrumentation * instrumentation_;
+  rclcpp::executor::ExecutorPhase phase_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Hint the CPU that this is a spin loop.
+inline void
+cpu_pause()
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_ia32_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+  __asm__ __volatile__ ("yield");
+#endif
+}
+
+/// Return the CPU time used by the calling thread since it started.
+std::chrono::nanoseconds
+get_current_thread_cpu_time()
+{
+#ifdef _WIN32
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+    return std::chrono::nanoseconds(0);
+  }
+  auto to_100ns = [](const FILETIME & time) {
+      return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+  return std::chrono::nanoseconds(100 * (to_100ns(kernel_time) + to_100ns(user_time)));
+#else
+  struct timespec time;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) {
+    return std::chrono::nanoseconds(0);
+  }
+  return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+#endif
+}
+
+/// Find the entity of the executable, and its kind and name for the instrumentation.
+void
+describe_executable(
+  const AnyExecutable & any_exec,
+  const void * & entity, const char * & kind, const char * & name)
+{
+  entity = nullptr;
+  kind = nullptr;
+  name = nullptr;
+  if (any_exec.timer) {
+    entity = any_exec.timer.get();
+    kind = "timer";
+  } else if (any_exec.subscription) {
+    entity = any_exec.subscription.get();
+    kind = "subscription";
+    name = any_exec.subscription->get_topic_name();
+  } else if (any_exec.service) {
+    entity = any_exec.service.get();
+    kind = "service";
+    name = any_exec.service->get_service_name();
+  } else if (any_exec.client) {
+    entity = any_exec.client.get();
+    kind = "client";
+    name = any_exec.client->get_service_name();
+  } else if (any_exec.waitable) {
+    entity = any_exec.waitable.get();
+    kind = "waitable";
+  }
+}
+
+}  // namespace
+
 Executor::Executor(const ExecutorArgs & args)
 : spinning(false),
-  memory_strategy_(args.memory_strategy)
+  memory_strategy_(args.memory_strategy),
+  measure_group_cpu_time_(false),
+  timer_thread_stop_(false),
+  timer_thread_spin_threshold_(args.timer_thread_spin_threshold),
+  busy_poll_duration_(args.busy_poll_duration),
+  busy_poll_pause_(args.busy_poll_pause),
+  next_entity_kind_(TimerKind)
 {
   rcl_guard_condition_options_t guard_condition_options = rcl_guard_condition_get_default_options();
   rcl_ret_t ret = rcl_guard_condition_init(
@@ -45,22 +169,36 @@ Executor::Executor(const ExecutorArgs & args)
     throw_from_rcl_error(ret, "Failed to create interrupt guard condition in Executor constructor");
   }
 
-  // The number of guard conditions is always at least 2: 1 for the ctrl-c guard cond,
-  // and one for the executor's guard cond (interrupt_guard_condition_)
-
-  // Put the global ctrl-c guard condition in
-  memory_strategy_->add_guard_condition(args.context->get_interrupt_guard_condition(&wait_set_));
-
-  // Put the executor's guard condition in
+  // The number of guard conditions is always at least 1, the executor's guard cond
+  // (interrupt_guard_condition_), which the context also triggers on ctrl-c or shutdown.
   memory_strategy_->add_guard_condition(&interrupt_guard_condition_);
+  memory_strategy_->set_executor(this);
   rcl_allocator_t allocator = memory_strategy_->get_allocator();
 
   // Store the context for later use.
   context_ = args.context;
+  thread_options_ = args.thread_options;
+
+  entity_capacities_ = args.entity_capacities;
+  if (entity_capacities_.empty()) {
+    entity_capacities_ = context_->get_init_options().entity_capacities;
+  }
+  memory_strategy_->reserve(entity_capacities_);
 
+  if (args.manage_timers || args.timer_thread) {
+    timer_manager_ = std::make_shared<TimerManager>();
+    memory_strategy_->set_timer_manager(timer_manager_);
+  }
+
+  // At least the interrupt guard condition, and the entities of a static system.
   ret = rcl_wait_set_init(
     &wait_set_,
-    0, 2, 0, 0, 0, 0,
+    entity_capacities_.subscriptions,
+    entity_capacities_.guard_conditions + entity_capacities_.nodes + 1,
+    entity_capacities_.timers,
+    entity_capacities_.clients,
+    entity_capacities_.services,
+    entity_capacities_.events,
     context_->get_rcl_context().get(),
     allocator);
   if (RCL_RET_OK != ret) {
@@ -76,10 +214,38 @@ Executor::Executor(const ExecutorArgs & args)
     }
     throw std::runtime_error("Failed to create wait set in Executor constructor");
   }
+
+  if (args.timer_thread) {
+    timer_thread_ = std::thread([this]() {run_timer_thread();});
+    try {
+      rclcpp::apply_thread_options(timer_thread_, args.timer_thread_options);
+    } catch (...) {
+      timer_thread_stop_.store(true);
+      timer_manager_->notify();
+      timer_thread_.join();
+      if (rcl_wait_set_fini(&wait_set_) != RCL_RET_OK) {
+        rcl_reset_error();
+      }
+      if (rcl_guard_condition_fini(&interrupt_guard_condition_) != RCL_RET_OK) {
+        rcl_reset_error();
+      }
+      throw;
+    }
+  }
+
+  context_->add_interrupt_guard_condition(&interrupt_guard_condition_);
 }
 
 Executor::~Executor()
 {
+  // Stop being interrupted by the context before the guard condition is finalized
+  context_->remove_interrupt_guard_condition(&interrupt_guard_condition_);
+  // Stop the timer thread, before anything it uses is destroyed
+  if (timer_thread_.joinable()) {
+    timer_thread_stop_.store(true);
+    timer_manager_->notify();
+    timer_thread_.join();
+  }
   // Disassocate all nodes
   for (auto & weak_node : weak_nodes_) {
     auto node = weak_node.lock();
@@ -108,9 +274,6 @@ Executor::~Executor()
       "failed to destroy guard condition: %s", rcl_get_error_string().str);
     rcl_reset_error();
   }
-  // Remove and release the sigint guard condition
-  memory_strategy_->remove_guard_condition(context_->get_interrupt_guard_condition(&wait_set_));
-  context_->release_interrupt_guard_condition(&wait_set_, std::nothrow);
 }
 
 void
@@ -131,6 +294,10 @@ Executor::add_node(rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_pt
   }
   weak_nodes_.push_back(node_ptr);
   guard_conditions_.push_back(node_ptr->get_notify_guard_condition());
+  {
+    std::lock_guard<std::mutex> index_lock(index_mutex_);
+    index_callback_groups(node_ptr);
+  }
   if (notify) {
     // Interrupt waiting to handle new node
     if (rcl_trigger_guard_condition(&interrupt_guard_condition_) != RCL_RET_OK) {
@@ -167,6 +334,18 @@ Executor::remove_node(rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node
       }
     }
   }
+  if (node_removed) {
+    // The timer index entries of the groups are dropped when they are looked up next.
+    std::lock_guard<std::mutex> index_lock(index_mutex_);
+    for (auto it = group_index_.begin(); it != group_index_.end(); ) {
+      auto indexed_node = it->second.node.lock();
+      if (!indexed_node || indexed_node == node_ptr) {
+        it = group_index_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
   std::atomic_bool & has_executor = node_ptr->get_associated_with_executor_atomic();
   has_executor.store(false);
   if (notify) {
@@ -244,6 +423,68 @@ Executor::spin_some(std::chrono::nanoseconds max_duration)
   }
 }
 
+size_t
+Executor::spin_some_budgeted(const SpinBudget & budget)
+{
+  auto start = std::chrono::steady_clock::now();
+  auto budget_left = [&budget, start](size_t executed) {
+      if (budget.max_executables != 0 && executed >= budget.max_executables) {
+        return false;
+      }
+      return std::chrono::nanoseconds(0) == budget.max_duration ||
+             std::chrono::steady_clock::now() - start < budget.max_duration;
+    };
+
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin_some_budgeted() called while already spinning");
+  }
+  RCLCPP_SCOPE_EXIT(this->spinning.store(false); );
+
+  // The groups which ran in the current round, held back until it ends.
+  std::vector<rclcpp::callback_group::CallbackGroup::SharedPtr> served_groups;
+  auto end_round = [this, &served_groups]() {
+      for (auto & group : served_groups) {
+        group->can_be_taken_from().store(true);
+      }
+      served_groups.clear();
+      if (timer_thread_.joinable()) {
+        timer_manager_->notify();
+      }
+    };
+  RCLCPP_SCOPE_EXIT(end_round(); );
+
+  size_t executed = 0;
+  // non-blocking call to pre-load all available work
+  wait_for_work(std::chrono::milliseconds::zero());
+  while (spinning.load() && budget_left(executed)) {
+    AnyExecutable any_exec;
+    size_t kind;
+    if (!get_next_ready_executable_from(any_exec, next_entity_kind_, kind)) {
+      if (served_groups.empty()) {
+        break;
+      }
+      // The remaining work belongs to groups which already ran in this round.
+      end_round();
+      continue;
+    }
+    next_entity_kind_ = (kind + 1) % EntityKindCount;
+    execute_any_executable(any_exec);
+    if (!spinning.load()) {
+      // Canceled, it may not have run, its destructor releases the group.
+      break;
+    }
+    ++executed;
+    // Taken out so that the destructor of any_exec doesn't release the group.
+    auto group = std::move(any_exec.callback_group);
+    // Hold the group back, unless another thread took from it in the meantime.
+    bool can_be_taken_from = true;
+    if (group->can_be_taken_from().compare_exchange_strong(can_be_taken_from, false)) {
+      served_groups.push_back(std::move(group));
+    }
+  }
+  return executed;
+}
+
 void
 Executor::spin_once(std::chrono::nanoseconds timeout)
 {
@@ -273,6 +514,62 @@ Executor::set_memory_strategy(rclcpp::memory_strategy::MemoryStrategy::SharedPtr
     throw std::runtime_error("Received NULL memory strategy in executor.");
   }
   memory_strategy_ = memory_strategy;
+  memory_strategy_->set_executor(this);
+  memory_strategy_->reserve(entity_capacities_);
+  if (timer_manager_) {
+    memory_strategy_->set_timer_manager(timer_manager_);
+  }
+}
+
+void
+Executor::set_callback_group_cpu_time_measurement(bool enabled)
+{
+  measure_group_cpu_time_.store(enabled);
+}
+
+uint64_t
+Executor::call_later(
+  std::chrono::nanoseconds delay,
+  std::function<void()> callback,
+  rclcpp::callback_group::CallbackGroup::SharedPtr group)
+{
+  if (!callback) {
+    throw std::invalid_argument("the callback of a deferred call can't be null");
+  }
+  if (!group) {
+    throw std::invalid_argument("the callback group of a deferred call can't be null");
+  }
+  auto deadline = std::chrono::steady_clock::now() + delay;
+  auto next_deadline = deferred_calls_.get_next_deadline();
+  uint64_t handle = deferred_calls_.push(deadline, std::move(callback), group);
+  if (deadline < next_deadline) {
+    // The executor may be waiting for a later deadline.
+    if (rcl_trigger_guard_condition(&interrupt_guard_condition_) != RCL_RET_OK) {
+      throw std::runtime_error(rcl_get_error_string().str);
+    }
+  }
+  return handle;
+}
+
+bool
+Executor::cancel_call(uint64_t handle)
+{
+  return deferred_calls_.cancel(handle);
+}
+
+void
+Executor::set_instrumentation(ExecutorInstrumentation::SharedPtr instrumentation)
+{
+  if (spinning.load()) {
+    throw std::runtime_error("set_instrumentation() called while spinning");
+  }
+  instrumentation_ = instrumentation;
+}
+
+ExecutorInstrumentation::SharedPtr
+Executor::get_instrumentation() const
+{
+  return instrumentation_;
 }
 
 void
@@ -281,8 +578,36 @@ Executor::execute_any_executable(AnyExecutable & any_exec)
   if (!spinning.load()) {
     return;
   }
+  ExecutorInstrumentation * instrumentation =
+    instrumentation_built ? instrumentation_.get() : nullptr;
+  std::chrono::steady_clock::time_point start;
+  if (instrumentation) {
+    start = std::chrono::steady_clock::now();
+    if (any_exec.subscription) {
+      instrumentation->record_dispatch_latency(
+        any_exec.subscription->get_topic_name(), start - instrumentation->get_last_wait_end());
+    }
+    current_instrumentation = instrumentation;
+  }
+  RCLCPP_SCOPE_EXIT(current_instrumentation = nullptr; );
+  bool measure_group_cpu_time =
+    measure_group_cpu_time_.load(std::memory_order_relaxed) && any_exec.callback_group;
+  std::chrono::nanoseconds cpu_time_start(0);
+  if (measure_group_cpu_time) {
+    cpu_time_start = get_current_thread_cpu_time();
+  }
+#ifdef RCLCPP_TRACEPOINTS_ENABLED
+  const void * trace_entity;
+  const char * trace_kind;
+  const char * trace_name;
+  describe_executable(any_exec, trace_entity, trace_kind, trace_name);
+  RCLCPP_TRACEPOINT(ExecuteStart, trace_entity, nullptr);
+#endif
   if (any_exec.timer) {
     execute_timer(any_exec.timer);
+    if (timer_manager_) {
+      timer_manager_->reschedule(any_exec.timer);
+    }
   }
   if (any_exec.subscription) {
     execute_subscription(any_exec.subscription);
@@ -296,6 +621,29 @@ Executor::execute_any_executable(AnyExecutable & any_exec)
   if (any_exec.waitable) {
     any_exec.waitable->execute();
   }
+  if (any_exec.deferred_call) {
+    any_exec.deferred_call();
+  }
+  RCLCPP_TRACEPOINT(ExecuteEnd, trace_entity, nullptr);
+  std::chrono::nanoseconds cpu_time(0);
+  if (measure_group_cpu_time) {
+    cpu_time = get_current_thread_cpu_time() - cpu_time_start;
+    any_exec.callback_group->add_cpu_time(cpu_time);
+  }
+  if (instrumentation) {
+    auto duration = std::chrono::steady_clock::now() - start;
+    instrumentation->record_phase(ExecutorPhase::Execute, duration);
+    const void * entity;
+    const char * kind;
+    const char * name;
+    describe_executable(any_exec, entity, kind, name);
+    if (entity) {
+      instrumentation->record_execution(entity, kind, name, duration);
+      if (measure_group_cpu_time) {
+        instrumentation->record_cpu_time(entity, kind, name, cpu_time);
+      }
+    }
+  }
   // Reset the callback_group, regardless of type
   any_exec.callback_group->can_be_taken_from().store(true);
   // Wake the wait, because it may need to be recalculated or work that
@@ -303,21 +651,95 @@ Executor::execute_any_executable(AnyExecutable & any_exec)
   if (rcl_trigger_guard_condition(&interrupt_guard_condition_) != RCL_RET_OK) {
     throw std::runtime_error(rcl_get_error_string().str);
   }
+  if (timer_thread_.joinable()) {
+    // The timers skipped by the timer thread because of this group can be taken now.
+    timer_manager_->notify();
+  }
 }
 
-void
-Executor::execute_subscription(
-  rclcpp::SubscriptionBase::SharedPtr subscription)
+namespace
+{
+
+/// Take one serialized message, and deserialize and handle it if the content filter accepts it.
+bool
+take_and_handle_filtered_message(const rclcpp::SubscriptionBase::SharedPtr & subscription)
 {
   rmw_message_info_t message_info;
   message_info.from_intra_process = false;
 
-  if (subscription->is_serialized()) {
-    auto serialized_msg = subscription->create_serialized_message();
-    auto ret = rcl_take_serialized_message(
+  auto serialized_msg = subscription->create_serialized_message();
+  rcl_ret_t ret;
+  {
+    ScopedPhase take_phase(current_instrumentation, rclcpp::executor::ExecutorPhase::Take);
+    ret = rcl_take_serialized_message(
       subscription->get_subscription_handle().get(),
       serialized_msg.get(), &message_info, nullptr);
+  }
+  if (RCL_RET_OK == ret) {
+    RCLCPP_TRACEPOINT(Take, subscription->get_subscription_handle().get(), serialized_msg.get());
+  }
+  if (RCL_RET_OK != ret) {
+    if (RCL_RET_SUBSCRIPTION_TAKE_FAILED != ret) {
+      RCUTILS_LOG_ERROR_NAMED(
+        "rclcpp",
+        "take_serialized failed for subscription on topic '%s': %s",
+        subscription->get_topic_name(), rcl_get_error_string().str);
+      rcl_reset_error();
+    }
+    subscription->return_serialized_message(serialized_msg);
+    return false;
+  }
+
+  // Rejected messages are neither deserialized nor given to the callback.
+  if (subscription->accepts_serialized_message(*serialized_msg)) {
+    if (subscription->is_serialized()) {
+      auto void_serialized_msg = std::static_pointer_cast<void>(serialized_msg);
+      subscription->handle_message(void_serialized_msg, message_info);
+    } else {
+      std::shared_ptr<void> message = subscription->create_message();
+      auto rmw_ret = rmw_deserialize(
+        serialized_msg.get(), &subscription->get_message_type_support_handle(), message.get());
+      if (RMW_RET_OK == rmw_ret) {
+        subscription->handle_message(message, message_info);
+      } else {
+        RCUTILS_LOG_ERROR_NAMED(
+          "rclcpp",
+          "could not deserialize serialized message on topic '%s': %s",
+          subscription->get_topic_name(), rmw_get_error_string().str);
+        rmw_reset_error();
+      }
+      subscription->return_message(message);
+    }
+  }
+  subscription->return_serialized_message(serialized_msg);
+  return true;
+}
+
+/// Take one message and handle it, return false if there was no message to take.
+bool
+take_and_handle_message(const rclcpp::SubscriptionBase::SharedPtr & subscription)
+{
+  if (subscription->has_content_filter()) {
+    return take_and_handle_filtered_message(subscription);
+  }
+
+  bool taken = false;
+  rmw_message_info_t message_info;
+  message_info.from_intra_process = false;
+
+  if (subscription->is_serialized()) {
+    auto serialized_msg = subscription->create_serialized_message();
+    rcl_ret_t ret;
+    {
+      ScopedPhase take_phase(current_instrumentation, rclcpp::executor::ExecutorPhase::Take);
+      ret = rcl_take_serialized_message(
+        subscription->get_subscription_handle().get(),
+        serialized_msg.get(), &message_info, nullptr);
+    }
+    taken = RCL_RET_OK == ret;
     if (RCL_RET_OK == ret) {
+      RCLCPP_TRACEPOINT(
+        Take, subscription->get_subscription_handle().get(), serialized_msg.get());
       auto void_serialized_msg = std::static_pointer_cast<void>(serialized_msg);
       subscription->handle_message(void_serialized_msg, message_info);
     } else if (RCL_RET_SUBSCRIPTION_TAKE_FAILED != ret) {
@@ -330,13 +752,24 @@ Executor::execute_subscription(
     subscription->return_serialized_message(serialized_msg);
   } else if (subscription->can_loan_messages()) {
     void * loaned_msg = nullptr;
-    auto ret = rcl_take_loaned_message(
-      subscription->get_subscription_handle().get(),
-      &loaned_msg,
-      &message_info,
-      nullptr);
+    rcl_ret_t ret;
+    {
+      ScopedPhase take_phase(current_instrumentation, rclcpp::executor::ExecutorPhase::Take);
+      ret = rcl_take_loaned_message(
+        subscription->get_subscription_handle().get(),
+        &loaned_msg,
+        &message_info,
+        nullptr);
+    }
+    taken = RCL_RET_OK == ret;
     if (RCL_RET_OK == ret) {
+      RCLCPP_TRACEPOINT(Take, subscription->get_subscription_handle().get(), loaned_msg);
+      bool keeps_loaned_message = subscription->keeps_loaned_messages();
       subscription->handle_loaned_message(loaned_msg, message_info);
+      if (keeps_loaned_message) {
+        // The loan belongs to the callback now, it is returned once the callback releases it.
+        return taken;
+      }
     } else if (RCL_RET_SUBSCRIPTION_TAKE_FAILED != ret) {
       RCUTILS_LOG_ERROR_NAMED(
         "rclcpp",
@@ -356,10 +789,16 @@ Executor::execute_subscription(
     loaned_msg = nullptr;
   } else {
     std::shared_ptr<void> message = subscription->create_message();
-    auto ret = rcl_take(
-      subscription->get_subscription_handle().get(),
-      message.get(), &message_info, nullptr);
+    rcl_ret_t ret;
+    {
+      ScopedPhase take_phase(current_instrumentation, rclcpp::executor::ExecutorPhase::Take);
+      ret = rcl_take(
+        subscription->get_subscription_handle().get(),
+        message.get(), &message_info, nullptr);
+    }
+    taken = RCL_RET_OK == ret;
     if (RCL_RET_OK == ret) {
+      RCLCPP_TRACEPOINT(Take, subscription->get_subscription_handle().get(), message.get());
       subscription->handle_message(message, message_info);
     } else if (RCL_RET_SUBSCRIPTION_TAKE_FAILED != ret) {
       RCUTILS_LOG_ERROR_NAMED(
@@ -370,47 +809,126 @@ Executor::execute_subscription(
     }
     subscription->return_message(message);
   }
+  return taken;
+}
+
+/// Take a request of a service, return false if there was none or the take failed.
+bool
+take_request(
+  const rclcpp::ServiceBase::SharedPtr & service,
+  const std::shared_ptr<rmw_request_id_t> & request_header,
+  const std::shared_ptr<void> & request)
+{
+  rcl_ret_t status;
+  {
+    ScopedPhase take_phase(current_instrumentation, rclcpp::executor::ExecutorPhase::Take);
+    status = rcl_take_request(
+      service->get_service_handle().get(),
+      request_header.get(),
+      request.get());
+  }
+  if (status == RCL_RET_OK) {
+    RCLCPP_TRACEPOINT(TakeRequest, service->get_service_handle().get(), request_header.get());
+    return true;
+  }
+  if (status != RCL_RET_SERVICE_TAKE_FAILED) {
+    RCUTILS_LOG_ERROR_NAMED(
+      "rclcpp",
+      "take request failed for server of service '%s': %s",
+      service->get_service_name(), rcl_get_error_string().str);
+    rcl_reset_error();
+  }
+  return false;
+}
+
+}  // namespace
+
+void
+Executor::execute_subscription(
+  const rclcpp::SubscriptionBase::SharedPtr & subscription)
+{
+  // Drain up to the configured number of messages, stop at the first take which finds none.
+  size_t max_messages = subscription->get_max_messages_per_execution();
+  for (size_t i = 0; i < max_messages; ++i) {
+    if (!take_and_handle_message(subscription)) {
+      break;
+    }
+  }
+  subscription->dispatch_message_batch();
 }
 
 void
 Executor::execute_timer(
-  rclcpp::TimerBase::SharedPtr timer)
+  const rclcpp::TimerBase::SharedPtr & timer)
 {
   timer->execute_callback();
 }
 
 void
 Executor::execute_service(
-  rclcpp::ServiceBase::SharedPtr service)
-{
-  auto request_header = service->create_request_header();
-  std::shared_ptr<void> request = service->create_request();
-  rcl_ret_t status = rcl_take_request(
-    service->get_service_handle().get(),
-    request_header.get(),
-    request.get());
-  if (status == RCL_RET_OK) {
-    service->handle_request(request_header, request);
-  } else if (status != RCL_RET_SERVICE_TAKE_FAILED) {
-    RCUTILS_LOG_ERROR_NAMED(
-      "rclcpp",
-      "take request failed for server of service '%s': %s",
-      service->get_service_name(), rcl_get_error_string().str);
-    rcl_reset_error();
+  const rclcpp::ServiceBase::SharedPtr & service)
+{
+  auto worker_pool = service->get_worker_pool();
+  if (service->is_batched()) {
+    // The requests received so far are taken at once, up to the maximum batch size.
+    auto batch = std::make_shared<rclcpp::ServiceBase::RequestBatch>();
+    size_t max_batch_size = service->get_max_batch_size();
+    while (batch->size() < max_batch_size) {
+      auto request_header = service->create_request_header();
+      std::shared_ptr<void> request = service->create_request();
+      if (!take_request(service, request_header, request)) {
+        break;
+      }
+      batch->emplace_back(std::move(request_header), std::move(request));
+    }
+    if (batch->empty()) {
+      return;
+    }
+    if (!worker_pool) {
+      service->handle_request_batch(*batch);
+      return;
+    }
+    worker_pool->post(
+      [service, batch]() {
+        service->handle_request_batch(*batch);
+      });
+    return;
+  }
+  // With worker threads, all the requests received so far are taken and handled in parallel.
+  while (true) {
+    auto request_header = service->create_request_header();
+    std::shared_ptr<void> request = service->create_request();
+    if (!take_request(service, request_header, request)) {
+      return;
+    }
+    if (!worker_pool) {
+      service->handle_request(request_header, request);
+      return;
+    }
+    // The task keeps the service alive until its response is sent.
+    worker_pool->post(
+      [service, request_header, request]() {
+        service->handle_request(request_header, request);
+      });
   }
 }
 
 void
 Executor::execute_client(
-  rclcpp::ClientBase::SharedPtr client)
+  const rclcpp::ClientBase::SharedPtr & client)
 {
   auto request_header = client->create_request_header();
   std::shared_ptr<void> response = client->create_response();
-  rcl_ret_t status = rcl_take_response(
-    client->get_client_handle().get(),
-    request_header.get(),
-    response.get());
+  rcl_ret_t status;
+  {
+    ScopedPhase take_phase(current_instrumentation, ExecutorPhase::Take);
+    status = rcl_take_response(
+      client->get_client_handle().get(),
+      request_header.get(),
+      response.get());
+  }
   if (status == RCL_RET_OK) {
+    RCLCPP_TRACEPOINT(TakeResponse, client->get_client_handle().get(), request_header.get());
     client->handle_response(request_header, response);
   } else if (status != RCL_RET_CLIENT_TAKE_FAILED) {
     RCUTILS_LOG_ERROR_NAMED(
@@ -424,15 +942,23 @@ Executor::execute_client(
 void
 Executor::wait_for_work(std::chrono::nanoseconds timeout)
 {
+  ExecutorInstrumentation * instrumentation =
+    instrumentation_built ? instrumentation_.get() : nullptr;
   {
     std::unique_lock<std::mutex> lock(memory_strategy_mutex_);
+    ScopedPhase collect_phase(instrumentation, ExecutorPhase::Collect);
 
     // Collect the subscriptions and timers to be waited on
     memory_strategy_->clear_handles();
+    if (timer_manager_) {
+      timer_manager_->start_collection();
+    }
     bool has_invalid_weak_nodes = memory_strategy_->collect_entities(weak_nodes_);
 
     // Clean up any invalid nodes, if they were detected
     if (has_invalid_weak_nodes) {
+      // The timer thread goes through the nodes when it claims a group.
+      std::lock_guard<std::mutex> claim_lock(claim_mutex_);
       auto node_it = weak_nodes_.begin();
       auto gc_it = guard_conditions_.begin();
       while (node_it != weak_nodes_.end()) {
@@ -452,22 +978,75 @@ Executor::wait_for_work(std::chrono::nanoseconds timeout)
     }
 
     // The size of waitables are accounted for in size of the other entities
-    rcl_ret_t ret = rcl_wait_set_resize(
-      &wait_set_, memory_strategy_->number_of_ready_subscriptions(),
-      memory_strategy_->number_of_guard_conditions(), memory_strategy_->number_of_ready_timers(),
-      memory_strategy_->number_of_ready_clients(), memory_strategy_->number_of_ready_services(),
-      memory_strategy_->number_of_ready_events());
-    if (RCL_RET_OK != ret) {
-      throw std::runtime_error(
-              std::string("Couldn't resize the wait set : ") + rcl_get_error_string().str);
+    size_t subscriptions = memory_strategy_->number_of_ready_subscriptions();
+    size_t guard_conditions = memory_strategy_->number_of_guard_conditions();
+    size_t timers = memory_strategy_->number_of_ready_timers();
+    size_t clients = memory_strategy_->number_of_ready_clients();
+    size_t services = memory_strategy_->number_of_ready_services();
+    size_t events = memory_strategy_->number_of_ready_events();
+    bool resize = true;
+    if (!entity_capacities_.empty()) {
+      // The preallocated wait set only grows, its unused entries stay null.
+      resize = subscriptions > wait_set_.size_of_subscriptions ||
+        guard_conditions > wait_set_.size_of_guard_conditions ||
+        timers > wait_set_.size_of_timers || clients > wait_set_.size_of_clients ||
+        services > wait_set_.size_of_services || events > wait_set_.size_of_events;
+      subscriptions = std::max(subscriptions, wait_set_.size_of_subscriptions);
+      guard_conditions = std::max(guard_conditions, wait_set_.size_of_guard_conditions);
+      timers = std::max(timers, wait_set_.size_of_timers);
+      clients = std::max(clients, wait_set_.size_of_clients);
+      services = std::max(services, wait_set_.size_of_services);
+      events = std::max(events, wait_set_.size_of_events);
+    }
+    if (resize) {
+      rcl_ret_t ret = rcl_wait_set_resize(
+        &wait_set_, subscriptions, guard_conditions, timers, clients, services, events);
+      if (RCL_RET_OK != ret) {
+        throw std::runtime_error(
+                std::string("Couldn't resize the wait set : ") + rcl_get_error_string().str);
+      }
     }
 
     if (!memory_strategy_->add_handles_to_wait_set(&wait_set_)) {
       throw std::runtime_error("Couldn't fill wait set");
     }
   }
-  rcl_ret_t status =
-    rcl_wait(&wait_set_, std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count());
+  if (timer_thread_.joinable()) {
+    // The collection may have pushed timers, or the executor just started spinning.
+    timer_manager_->notify();
+  } else if (timer_manager_) {
+    // Wake up for the nearest deadline of the managed timers.
+    auto time_until_deadline = timer_manager_->get_time_until_next_deadline();
+    if (time_until_deadline >= std::chrono::nanoseconds::zero() &&
+      (timeout < std::chrono::nanoseconds::zero() || time_until_deadline < timeout))
+    {
+      timeout = time_until_deadline;
+    }
+  }
+  // Wake up for the nearest deferred call.
+  auto next_call_deadline = deferred_calls_.get_next_deadline();
+  if (next_call_deadline != std::chrono::steady_clock::time_point::max()) {
+    auto time_until_call = std::max(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+        next_call_deadline - std::chrono::steady_clock::now()),
+      std::chrono::nanoseconds::zero());
+    if (timeout < std::chrono::nanoseconds::zero() || time_until_call < timeout) {
+      timeout = time_until_call;
+    }
+  }
+  rcl_ret_t status;
+  if (busy_poll_duration_ != std::chrono::nanoseconds::zero() &&
+    timeout != std::chrono::nanoseconds::zero())
+  {
+    status = poll_for_work(timeout, instrumentation);
+  } else {
+    ScopedPhase wait_phase(instrumentation, ExecutorPhase::Wait);
+    status =
+      rcl_wait(&wait_set_, std::chrono::duration_cast<std::chrono::nanoseconds>(timeout).count());
+  }
+  if (instrumentation) {
+    instrumentation->set_last_wait_end(std::chrono::steady_clock::now());
+  }
   if (status == RCL_RET_WAIT_SET_EMPTY) {
     RCUTILS_LOG_WARN_NAMED(
       "rclcpp",
@@ -482,30 +1061,112 @@ Executor::wait_for_work(std::chrono::nanoseconds timeout)
   memory_strategy_->remove_null_handles(&wait_set_);
 }
 
+rcl_ret_t
+Executor::poll_for_work(
+  std::chrono::nanoseconds timeout, ExecutorInstrumentation * instrumentation)
+{
+  auto start = std::chrono::steady_clock::now();
+  bool wait_forever = timeout < std::chrono::nanoseconds::zero();
+  bool poll_forever = busy_poll_duration_ < std::chrono::nanoseconds::zero();
+  std::chrono::steady_clock::time_point now;
+  {
+    ScopedPhase poll_phase(instrumentation, ExecutorPhase::Poll);
+    while (true) {
+      rcl_ret_t status = rcl_wait(&wait_set_, 0);
+      if (status != RCL_RET_TIMEOUT) {
+        return status;
+      }
+      now = std::chrono::steady_clock::now();
+      if (!wait_forever && now - start >= timeout) {
+        return status;
+      }
+      // rcl_wait() removed the entities which weren't ready from the wait set, put them back.
+      {
+        std::lock_guard<std::mutex> lock(memory_strategy_mutex_);
+        if (rcl_wait_set_clear(&wait_set_) != RCL_RET_OK) {
+          throw std::runtime_error("Couldn't clear wait set");
+        }
+        if (!memory_strategy_->add_handles_to_wait_set(&wait_set_)) {
+          throw std::runtime_error("Couldn't fill wait set");
+        }
+      }
+      if (!poll_forever && now - start >= busy_poll_duration_) {
+        break;
+      }
+      if (busy_poll_pause_) {
+        cpu_pause();
+      }
+    }
+  }
+  ScopedPhase wait_phase(instrumentation, ExecutorPhase::Wait);
+  std::chrono::nanoseconds timeout_left(-1);
+  if (!wait_forever) {
+    timeout_left =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(timeout - (now - start));
+  }
+  return rcl_wait(&wait_set_, timeout_left.count());
+}
+
+void
+Executor::index_callback_groups(
+  const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr & node)
+{
+  for (auto & weak_group : node->get_callback_groups()) {
+    auto group = weak_group.lock();
+    if (group) {
+      group_index_[group.get()] = GroupIndexEntry{group, node};
+    }
+  }
+}
+
 rclcpp::node_interfaces::NodeBaseInterface::SharedPtr
 Executor::get_node_by_group(rclcpp::callback_group::CallbackGroup::SharedPtr group)
 {
   if (!group) {
     return nullptr;
   }
-  for (auto & weak_node : weak_nodes_) {
-    auto node = weak_node.lock();
-    if (!node) {
-      continue;
-    }
-    for (auto & weak_group : node->get_callback_groups()) {
-      auto callback_group = weak_group.lock();
-      if (callback_group == group) {
-        return node;
+  std::lock_guard<std::mutex> index_lock(index_mutex_);
+  auto it = group_index_.find(group.get());
+  if (it == group_index_.end() || it->second.group.lock() != group) {
+    // The group may have been created after its node was added, index the nodes again.
+    for (auto & weak_node : weak_nodes_) {
+      auto node = weak_node.lock();
+      if (node) {
+        index_callback_groups(node);
       }
     }
+    it = group_index_.find(group.get());
+    if (it == group_index_.end() || it->second.group.lock() != group) {
+      return nullptr;
+    }
   }
-  return nullptr;
+  return it->second.node.lock();
 }
 
 rclcpp::callback_group::CallbackGroup::SharedPtr
 Executor::get_group_by_timer(rclcpp::TimerBase::SharedPtr timer)
 {
+  if (!timer) {
+    return nullptr;
+  }
+  std::unique_lock<std::mutex> index_lock(index_mutex_);
+  auto it = timer_index_.find(timer.get());
+  if (it != timer_index_.end() && it->second.timer.lock() == timer) {
+    auto group = it->second.group.lock();
+    // A timer never changes its group, but the group's node may have been removed.
+    if (group && group_index_.count(group.get())) {
+      return group;
+    }
+  }
+  // Forget the timers which are gone, and search the groups of the nodes for this one.
+  for (auto timer_it = timer_index_.begin(); timer_it != timer_index_.end(); ) {
+    if (timer_it->second.timer.expired() || timer_it->second.group.expired()) {
+      timer_it = timer_index_.erase(timer_it);
+    } else {
+      ++timer_it;
+    }
+  }
+  index_lock.unlock();
   for (auto & weak_node : weak_nodes_) {
     auto node = weak_node.lock();
     if (!node) {
@@ -521,6 +1182,9 @@ Executor::get_group_by_timer(rclcpp::TimerBase::SharedPtr timer)
           return timer_ptr == timer;
         });
       if (timer_ref) {
+        index_lock.lock();
+        timer_index_[timer.get()] = TimerIndexEntry{timer, group};
+        group_index_[group.get()] = GroupIndexEntry{group, node};
         return group;
       }
     }
@@ -529,45 +1193,122 @@ Executor::get_group_by_timer(rclcpp::TimerBase::SharedPtr timer)
 }
 
 bool
-Executor::get_next_ready_executable(AnyExecutable & any_executable)
+Executor::claim_managed_timer(
+  const rclcpp::TimerBase::SharedPtr & timer, AnyExecutable & any_executable)
 {
-  bool success = false;
-  // Check the timers to see if there are any that are ready
-  memory_strategy_->get_next_timer(any_executable, weak_nodes_);
-  if (any_executable.timer) {
-    success = true;
+  return claim_group(get_group_by_timer(timer), any_executable);
+}
+
+bool
+Executor::claim_group(
+  const rclcpp::callback_group::CallbackGroup::SharedPtr & group,
+  AnyExecutable & any_executable)
+{
+  if (!group) {
+    return false;
   }
-  if (!success) {
-    // Check the subscriptions to see if there are any that are ready
-    memory_strategy_->get_next_subscription(any_executable, weak_nodes_);
-    if (any_executable.subscription) {
-      success = true;
+  if (group->type() == callback_group::CallbackGroupType::MutuallyExclusive) {
+    // Taken atomically, a publisher delivering a message synchronously may take it too.
+    bool can_be_taken_from = true;
+    if (!group->can_be_taken_from().compare_exchange_strong(can_be_taken_from, false)) {
+      return false;
     }
+  } else if (!group->can_be_taken_from().load()) {
+    return false;
   }
-  if (!success) {
-    // Check the services to see if there are any that are ready
-    memory_strategy_->get_next_service(any_executable, weak_nodes_);
-    if (any_executable.service) {
-      success = true;
+  any_executable.callback_group = group;
+  any_executable.node_base = get_node_by_group(group);
+  return true;
+}
+
+void
+Executor::run_timer_thread()
+{
+  while (!timer_thread_stop_.load()) {
+    uint64_t notification_count = timer_manager_->get_notification_count();
+    auto next_deadline = std::chrono::steady_clock::time_point::max();
+    AnyExecutable any_executable;
+    if (spinning.load()) {
+      std::lock_guard<std::mutex> claim_lock(claim_mutex_);
+      any_executable.timer = timer_manager_->get_next_ready_timer(
+        [this, &any_executable](const rclcpp::TimerBase::SharedPtr & timer) {
+          return claim_managed_timer(timer, any_executable);
+        }, &next_deadline);
     }
-  }
-  if (!success) {
-    // Check the clients to see if there are any that are ready
-    memory_strategy_->get_next_client(any_executable, weak_nodes_);
-    if (any_executable.client) {
-      success = true;
+    if (any_executable.timer) {
+      execute_any_executable(any_executable);
+    } else {
+      // Woken up early when the executor starts spinning, or a group is released.
+      timer_manager_->wait_until(next_deadline, timer_thread_spin_threshold_, notification_count);
     }
   }
-  if (!success) {
-    // Check the waitables to see if there are any that are ready
-    memory_strategy_->get_next_waitable(any_executable, weak_nodes_);
-    if (any_executable.waitable) {
-      success = true;
+}
+
+bool
+Executor::get_next_ready_executable(AnyExecutable & any_executable)
+{
+  size_t kind;
+  return get_next_ready_executable_from(any_executable, TimerKind, kind);
+}
+
+bool
+Executor::get_next_ready_executable_from(
+  AnyExecutable & any_executable, size_t first_kind, size_t & kind)
+{
+  bool success = false;
+  // The managed timers are claimed with their group.
+  bool claimed = false;
+  std::lock_guard<std::mutex> claim_lock(claim_mutex_);
+  for (size_t i = 0; i < EntityKindCount && !success; ++i) {
+    kind = (first_kind + i) % EntityKindCount;
+    switch (kind) {
+      case TimerKind:
+        if (timer_manager_ && !timer_thread_.joinable()) {
+          // Take the expired managed timers first, in deadline order
+          any_executable.timer = timer_manager_->get_next_ready_timer(
+            [this, &any_executable](const rclcpp::TimerBase::SharedPtr & timer) {
+              return claim_managed_timer(timer, any_executable);
+            });
+          claimed = static_cast<bool>(any_executable.timer);
+        }
+        if (!any_executable.timer) {
+          // Then the expired deferred calls, in deadline order
+          claimed = deferred_calls_.take_next_ready(
+            [this, &any_executable](const rclcpp::callback_group::CallbackGroup::SharedPtr & g) {
+              return claim_group(g, any_executable);
+            }, any_executable.deferred_call);
+        }
+        if (!any_executable.timer && !claimed) {
+          // Check the timers to see if there are any that are ready
+          memory_strategy_->get_next_timer(any_executable, weak_nodes_);
+        }
+        success = any_executable.timer || any_executable.deferred_call;
+        break;
+      case SubscriptionKind:
+        // Check the subscriptions to see if there are any that are ready
+        memory_strategy_->get_next_subscription(any_executable, weak_nodes_);
+        success = static_cast<bool>(any_executable.subscription);
+        break;
+      case ServiceKind:
+        // Check the services to see if there are any that are ready
+        memory_strategy_->get_next_service(any_executable, weak_nodes_);
+        success = static_cast<bool>(any_executable.service);
+        break;
+      case ClientKind:
+        // Check the clients to see if there are any that are ready
+        memory_strategy_->get_next_client(any_executable, weak_nodes_);
+        success = static_cast<bool>(any_executable.client);
+        break;
+      default:
+        // Check the waitables to see if there are any that are ready
+        memory_strategy_->get_next_waitable(any_executable, weak_nodes_);
+        success = static_cast<bool>(any_executable.waitable);
+        break;
     }
   }
   // At this point any_exec should be valid with either a valid subscription
   // or a valid timer, or it should be a null shared_ptr
-  if (success) {
+  if (success && !claimed) {
     // If it is valid, check to see if the group is mutually exclusive or
     // not, then mark it accordingly
     using callback_group::CallbackGroupType;
@@ -575,12 +1316,19 @@ Executor::get_next_ready_executable(AnyExecutable & any_executable)
       any_executable.callback_group &&
       any_executable.callback_group->type() == CallbackGroupType::MutuallyExclusive)
     {
-      // It should not have been taken otherwise
-      assert(any_executable.callback_group->can_be_taken_from().load());
       // Set to false to indicate something is being run from this group
       // This is reset to true either when the any_exec is executed or when the
       // any_exec is destructued
-      any_executable.callback_group->can_be_taken_from().store(false);
+      bool can_be_taken_from = true;
+      if (
+        !any_executable.callback_group->can_be_taken_from().compare_exchange_strong(
+          can_be_taken_from, false))
+      {
+        // Taken since it was checked by a publisher delivering a message synchronously, which
+        // wakes the executor up once done. The entity is reported again by the next wait.
+        any_executable = AnyExecutable();
+        success = false;
+      }
     }
   }
   // If there is no ready executable, return a null ptr
@@ -607,6 +1355,19 @@ Executor::get_next_executable(AnyExecutable & any_executable, std::chrono::nanos
   return success;
 }
 
+rclcpp::ThreadOptions
+Executor::get_thread_options(size_t thread_index) const
+{
+  rclcpp::ThreadOptions options;
+  if (thread_index < thread_options_.size()) {
+    options = thread_options_[thread_index];
+  }
+  if (0u == options.stack_prefault_size) {
+    options.stack_prefault_size = context_->get_init_options().realtime.stack_prefault_size;
+  }
+  return options;
+}
+
 std::ostream &
 rclcpp::executor::operator<<(std::ostream & os, const FutureReturnCode & future_return_code)
 {
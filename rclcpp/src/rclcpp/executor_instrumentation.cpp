@@ -0,0 +1,276 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executor_instrumentation.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using rclcpp::executor::ExecutorInstrumentation;
+using rclcpp::executor::ExecutorPhase;
+using rclcpp::executor::LatencyHistogram;
+
+constexpr size_t LatencyHistogram::number_of_buckets;
+
+LatencyHistogram::LatencyHistogram()
+: count_(0),
+  sum_(0),
+  min_(std::chrono::nanoseconds::max()),
+  max_(0)
+{
+  buckets_.fill(0);
+}
+
+void
+LatencyHistogram::record(std::chrono::nanoseconds duration)
+{
+  if (duration < std::chrono::nanoseconds::zero()) {
+    duration = std::chrono::nanoseconds::zero();
+  }
+  uint64_t value = static_cast<uint64_t>(duration.count());
+  size_t bucket = 0;
+  while (value > 1 && bucket < number_of_buckets - 1) {
+    value >>= 1;
+    ++bucket;
+  }
+  buckets_[bucket]++;
+  count_++;
+  sum_ += duration;
+  min_ = std::min(min_, duration);
+  max_ = std::max(max_, duration);
+}
+
+uint64_t
+LatencyHistogram::count() const
+{
+  return count_;
+}
+
+std::chrono::nanoseconds
+LatencyHistogram::min() const
+{
+  return count_ ? min_ : std::chrono::nanoseconds::zero();
+}
+
+std::chrono::nanoseconds
+LatencyHistogram::max() const
+{
+  return max_;
+}
+
+std::chrono::nanoseconds
+LatencyHistogram::mean() const
+{
+  return count_ ? sum_ / static_cast<int64_t>(count_) : std::chrono::nanoseconds::zero();
+}
+
+std::chrono::nanoseconds
+LatencyHistogram::total() const
+{
+  return sum_;
+}
+
+std::chrono::nanoseconds
+LatencyHistogram::percentile(double percentile) const
+{
+  if (!count_) {
+    return std::chrono::nanoseconds::zero();
+  }
+  uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(count_));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < number_of_buckets; ++i) {
+    seen += buckets_[i];
+    if (seen > rank || seen == count_) {
+      // The bucket's upper bound, but never more than what was actually recorded.
+      return std::min(max_, std::chrono::nanoseconds((int64_t(1) << (i + 1)) - 1));
+    }
+  }
+  return max_;
+}
+
+const std::array<uint64_t, LatencyHistogram::number_of_buckets> &
+LatencyHistogram::buckets() const
+{
+  return buckets_;
+}
+
+ExecutorInstrumentation::ExecutorInstrumentation()
+: last_wait_end_ns_(0) {}
+
+ExecutorInstrumentation::~ExecutorInstrumentation() {}
+
+void
+ExecutorInstrumentation::record_phase(ExecutorPhase phase, std::chrono::nanoseconds duration)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  phase_histograms_[static_cast<size_t>(phase)].record(duration);
+}
+
+namespace
+{
+
+void
+record_entity(
+  std::unordered_map<const void *, ExecutorInstrumentation::EntityHistogram> & histograms,
+  const void * entity, const char * kind, const char * name,
+  std::chrono::nanoseconds duration)
+{
+  auto it = histograms.find(entity);
+  if (it == histograms.end()) {
+    std::ostringstream entity_name;
+    entity_name << kind << " ";
+    if (name) {
+      entity_name << name;
+    } else {
+      entity_name << entity;
+    }
+    it = histograms.emplace(
+      entity, ExecutorInstrumentation::EntityHistogram{entity_name.str(), {}}).first;
+  }
+  it->second.histogram.record(duration);
+}
+
+std::vector<ExecutorInstrumentation::EntityHistogram>
+to_vector(
+  const std::unordered_map<const void *, ExecutorInstrumentation::EntityHistogram> & histograms)
+{
+  std::vector<ExecutorInstrumentation::EntityHistogram> result;
+  result.reserve(histograms.size());
+  for (auto & entry : histograms) {
+    result.push_back(entry.second);
+  }
+  return result;
+}
+
+}  // namespace
+
+void
+ExecutorInstrumentation::record_execution(
+  const void * entity, const char * kind, const char * name,
+  std::chrono::nanoseconds duration)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  record_entity(execution_histograms_, entity, kind, name, duration);
+}
+
+void
+ExecutorInstrumentation::record_cpu_time(
+  const void * entity, const char * kind, const char * name,
+  std::chrono::nanoseconds cpu_time)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  record_entity(cpu_time_histograms_, entity, kind, name, cpu_time);
+}
+
+void
+ExecutorInstrumentation::record_dispatch_latency(
+  const char * topic_name, std::chrono::nanoseconds latency)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  dispatch_latency_histograms_[topic_name].record(latency);
+}
+
+void
+ExecutorInstrumentation::set_last_wait_end(TimePoint time)
+{
+  last_wait_end_ns_.store(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+}
+
+ExecutorInstrumentation::TimePoint
+ExecutorInstrumentation::get_last_wait_end() const
+{
+  return TimePoint(
+    std::chrono::duration_cast<TimePoint::duration>(
+      std::chrono::nanoseconds(last_wait_end_ns_.load())));
+}
+
+LatencyHistogram
+ExecutorInstrumentation::get_phase_histogram(ExecutorPhase phase) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return phase_histograms_[static_cast<size_t>(phase)];
+}
+
+std::vector<ExecutorInstrumentation::EntityHistogram>
+ExecutorInstrumentation::get_execution_histograms() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return to_vector(execution_histograms_);
+}
+
+std::vector<ExecutorInstrumentation::EntityHistogram>
+ExecutorInstrumentation::get_cpu_time_histograms() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return to_vector(cpu_time_histograms_);
+}
+
+std::unordered_map<std::string, LatencyHistogram>
+ExecutorInstrumentation::get_dispatch_latency_histograms() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dispatch_latency_histograms_;
+}
+
+void
+ExecutorInstrumentation::reset()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  phase_histograms_.fill(LatencyHistogram());
+  execution_histograms_.clear();
+  cpu_time_histograms_.clear();
+  dispatch_latency_histograms_.clear();
+}
+
+namespace
+{
+
+void
+print_histogram(
+  std::ostringstream & out, const std::string & name, const LatencyHistogram & histogram)
+{
+  out << name << ": count " << histogram.count() <<
+    " min " << histogram.min().count() <<
+    "ns mean " << histogram.mean().count() <<
+    "ns p99 " << histogram.percentile(99.0).count() <<
+    "ns max " << histogram.max().count() <<
+    "ns total " << histogram.total().count() << "ns\n";
+}
+
+}  // namespace
+
+std::string
+ExecutorInstrumentation::to_string() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ostringstream out;
+  const char * phase_names[] = {"wait", "collect", "take", "execute", "poll"};
+  for (size_t i = 0; i < phase_histograms_.size(); ++i) {
+    print_histogram(out, std::string("phase ") + phase_names[i], phase_histograms_[i]);
+  }
+  for (auto & entry : execution_histograms_) {
+    print_histogram(out, entry.second.name, entry.second.histogram);
+  }
+  for (auto & entry : cpu_time_histograms_) {
+    print_histogram(out, "cpu time " + entry.second.name, entry.second.histogram);
+  }
+  for (auto & entry : dispatch_latency_histograms_) {
+    print_histogram(out, "dispatch latency " + entry.first, entry.second);
+  }
+  return out.str();
+}
@@ -0,0 +1,282 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executor_schedule.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using rclcpp::executor::ExecutorInstrumentation;
+using rclcpp::executor::ExecutorPhase;
+using rclcpp::executor::ScheduleEvent;
+using rclcpp::executor::ScheduleRecorder;
+using rclcpp::executor::ScheduleReplayer;
+using rclcpp::executor::ScheduleTrace;
+
+constexpr uint32_t ScheduleEvent::wait_entity;
+
+namespace
+{
+
+static_assert(sizeof(ScheduleEvent) == 24, "the events are saved as they are in memory");
+
+constexpr char trace_magic[8] = {'R', 'C', 'L', 'S', 'C', 'H', 'E', 'D'};
+constexpr uint32_t trace_version = 1;
+
+template<typename T>
+void
+write_value(std::ofstream & file, const T & value)
+{
+  file.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template<typename T>
+T
+read_value(std::ifstream & file)
+{
+  T value;
+  if (!file.read(reinterpret_cast<char *>(&value), sizeof(T))) {
+    throw std::runtime_error("truncated schedule trace");
+  }
+  return value;
+}
+
+}  // namespace
+
+void
+ScheduleTrace::save(const std::string & path) const
+{
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw std::runtime_error("failed to open '" + path + "' to save the schedule trace");
+  }
+  file.write(trace_magic, sizeof(trace_magic));
+  write_value(file, trace_version);
+  write_value(file, static_cast<uint32_t>(entities.size()));
+  for (const auto & entity : entities) {
+    write_value(file, static_cast<uint32_t>(entity.size()));
+    file.write(entity.data(), static_cast<std::streamsize>(entity.size()));
+  }
+  write_value(file, static_cast<uint64_t>(events.size()));
+  file.write(
+    reinterpret_cast<const char *>(events.data()),
+    static_cast<std::streamsize>(events.size() * sizeof(ScheduleEvent)));
+  if (!file) {
+    throw std::runtime_error("failed to save the schedule trace to '" + path + "'");
+  }
+}
+
+ScheduleTrace
+ScheduleTrace::load(const std::string & path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("failed to open the schedule trace '" + path + "'");
+  }
+  char magic[sizeof(trace_magic)];
+  if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, trace_magic, sizeof(magic)) != 0) {
+    throw std::runtime_error("'" + path + "' is not a schedule trace");
+  }
+  if (read_value<uint32_t>(file) != trace_version) {
+    throw std::runtime_error("unsupported version of the schedule trace '" + path + "'");
+  }
+  ScheduleTrace trace;
+  trace.entities.resize(read_value<uint32_t>(file));
+  for (auto & entity : trace.entities) {
+    entity.resize(read_value<uint32_t>(file));
+    if (!file.read(&entity[0], static_cast<std::streamsize>(entity.size()))) {
+      throw std::runtime_error("truncated schedule trace");
+    }
+  }
+  uint64_t event_count = read_value<uint64_t>(file);
+  // Read by chunks, so that a corrupted count doesn't allocate it at once.
+  constexpr uint64_t chunk_size = 4096;
+  while (trace.events.size() < event_count) {
+    size_t begin = trace.events.size();
+    trace.events.resize(begin + static_cast<size_t>(std::min(chunk_size, event_count - begin)));
+    if (!file.read(
+        reinterpret_cast<char *>(&trace.events[begin]),
+        static_cast<std::streamsize>((trace.events.size() - begin) * sizeof(ScheduleEvent))))
+    {
+      throw std::runtime_error("truncated schedule trace");
+    }
+  }
+  for (const auto & event : trace.events) {
+    if (event.entity != ScheduleEvent::wait_entity && event.entity >= trace.entities.size()) {
+      throw std::runtime_error("invalid entity in the schedule trace '" + path + "'");
+    }
+  }
+  return trace;
+}
+
+std::vector<ExecutorInstrumentation::EntityHistogram>
+ScheduleTrace::get_execution_histograms() const
+{
+  std::vector<ExecutorInstrumentation::EntityHistogram> histograms(entities.size());
+  for (size_t i = 0; i < entities.size(); ++i) {
+    histograms[i].name = entities[i];
+  }
+  for (const auto & event : events) {
+    if (event.entity != ScheduleEvent::wait_entity) {
+      histograms[event.entity].histogram.record(std::chrono::nanoseconds(event.duration));
+    }
+  }
+  return histograms;
+}
+
+ScheduleRecorder::ScheduleRecorder(size_t max_events)
+: capture_start_(std::chrono::steady_clock::now()),
+  max_events_(max_events),
+  next_event_(0),
+  overwritten_count_(0)
+{
+  if (max_events == 0) {
+    throw std::invalid_argument("max_events must be a positive, non-zero value");
+  }
+}
+
+void
+ScheduleRecorder::record_phase(ExecutorPhase phase, std::chrono::nanoseconds duration)
+{
+  ExecutorInstrumentation::record_phase(phase, duration);
+  if (ExecutorPhase::Wait == phase) {
+    std::lock_guard<std::mutex> lock(events_mutex_);
+    append(ScheduleEvent::wait_entity, duration);
+  }
+}
+
+void
+ScheduleRecorder::record_execution(
+  const void * entity, const char * kind, const char * name,
+  std::chrono::nanoseconds duration)
+{
+  ExecutorInstrumentation::record_execution(entity, kind, name, duration);
+  std::lock_guard<std::mutex> lock(events_mutex_);
+  auto it = entity_indices_.find(entity);
+  if (it == entity_indices_.end()) {
+    std::ostringstream entity_name;
+    entity_name << kind << " ";
+    if (name) {
+      entity_name << name;
+    } else {
+      entity_name << entity;
+    }
+    it = entity_indices_.emplace(entity, static_cast<uint32_t>(entities_.size())).first;
+    entities_.push_back(entity_name.str());
+  }
+  append(it->second, duration);
+}
+
+void
+ScheduleRecorder::append(uint32_t entity, std::chrono::nanoseconds duration)
+{
+  auto end = std::chrono::steady_clock::now() - capture_start_;
+  auto thread_id = std::this_thread::get_id();
+  auto thread = std::find(threads_.begin(), threads_.end(), thread_id);
+  if (thread == threads_.end()) {
+    thread = threads_.insert(threads_.end(), thread_id);
+  }
+  ScheduleEvent event;
+  event.start = static_cast<uint64_t>(std::max((end - duration).count(), int64_t(0)));
+  event.duration = static_cast<uint64_t>(std::max(duration.count(), int64_t(0)));
+  event.entity = entity;
+  event.thread = static_cast<uint32_t>(thread - threads_.begin());
+  if (events_.size() < max_events_) {
+    events_.push_back(event);
+    return;
+  }
+  events_[next_event_] = event;
+  next_event_ = (next_event_ + 1) % max_events_;
+  overwritten_count_++;
+}
+
+ScheduleTrace
+ScheduleRecorder::get_trace() const
+{
+  ScheduleTrace trace;
+  {
+    std::lock_guard<std::mutex> lock(events_mutex_);
+    trace.entities = entities_;
+    trace.events.reserve(events_.size());
+    trace.events.insert(trace.events.end(), events_.begin() + next_event_, events_.end());
+    trace.events.insert(trace.events.end(), events_.begin(), events_.begin() + next_event_);
+  }
+  // The events are appended when they end, and the threads end them out of order.
+  std::stable_sort(
+    trace.events.begin(), trace.events.end(),
+    [](const ScheduleEvent & lhs, const ScheduleEvent & rhs) {
+      return lhs.start < rhs.start;
+    });
+  return trace;
+}
+
+uint64_t
+ScheduleRecorder::get_overwritten_count() const
+{
+  std::lock_guard<std::mutex> lock(events_mutex_);
+  return overwritten_count_;
+}
+
+ScheduleReplayer::ScheduleReplayer(ScheduleTrace trace)
+: trace_(std::move(trace)),
+  callbacks_(trace_.entities.size())
+{}
+
+void
+ScheduleReplayer::bind(const std::string & entity_name, std::function<void()> callback)
+{
+  auto it = std::find(trace_.entities.begin(), trace_.entities.end(), entity_name);
+  if (it == trace_.entities.end()) {
+    throw std::invalid_argument("no entity '" + entity_name + "' in the schedule trace");
+  }
+  callbacks_[static_cast<size_t>(it - trace_.entities.begin())] = std::move(callback);
+}
+
+ScheduleTrace
+ScheduleReplayer::replay(bool keep_timing)
+{
+  ScheduleTrace replayed;
+  replayed.entities = trace_.entities;
+  replayed.events.reserve(trace_.events.size());
+  auto replay_start = std::chrono::steady_clock::now();
+  for (const auto & event : trace_.events) {
+    if (ScheduleEvent::wait_entity == event.entity) {
+      continue;
+    }
+    if (keep_timing) {
+      std::this_thread::sleep_until(replay_start + std::chrono::nanoseconds(event.start));
+    }
+    auto start = std::chrono::steady_clock::now();
+    const auto & callback = callbacks_[event.entity];
+    if (callback) {
+      callback();
+    } else {
+      auto end = start + std::chrono::nanoseconds(event.duration);
+      while (std::chrono::steady_clock::now() < end) {
+      }
+    }
+    auto end = std::chrono::steady_clock::now();
+    ScheduleEvent replayed_event = event;
+    replayed_event.start = static_cast<uint64_t>((start - replay_start).count());
+    replayed_event.duration = static_cast<uint64_t>((end - start).count());
+    replayed.events.push_back(replayed_event);
+  }
+  return replayed;
+}
@@ -0,0 +1,336 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/executors/callback_group_balancer.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rcl/error_handling.h"
+#include "rcutils/logging_macros.h"
+
+using rclcpp::callback_group::CallbackGroup;
+using rclcpp::executors::CallbackGroupBalancer;
+using rclcpp::node_interfaces::NodeBaseInterface;
+
+CallbackGroupBalancer::CallbackGroupBalancer(
+  std::vector<rclcpp::executor::Executor::SharedPtr> executors,
+  const CallbackGroupBalancerOptions & options)
+: executors_(std::move(executors)),
+  options_(options),
+  executor_loads_(executors_.size(), std::chrono::nanoseconds(0))
+{
+  if (executors_.empty()) {
+    throw std::invalid_argument("CallbackGroupBalancer requires executors");
+  }
+  for (auto & executor : executors_) {
+    if (!executor) {
+      throw std::invalid_argument("CallbackGroupBalancer received a null executor");
+    }
+    executor->set_callback_group_cpu_time_measurement(true);
+  }
+}
+
+CallbackGroupBalancer::~CallbackGroupBalancer()
+{
+  stop();
+}
+
+void
+CallbackGroupBalancer::add_node(NodeBaseInterface::SharedPtr node)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::atomic_bool & has_executor = node->get_associated_with_executor_atomic();
+  if (has_executor.load()) {
+    throw std::runtime_error("Node has already been added to an executor.");
+  }
+  nodes_.push_back(node);
+  // Assigned before the executors wait on them.
+  update_groups();
+  // A node is normally added to a single executor, here it is shared by the executors of the
+  // balancer, which only wait on the groups assigned to them.
+  for (auto & executor : executors_) {
+    has_executor.store(false);
+    executor->add_node(node);
+  }
+}
+
+void
+CallbackGroupBalancer::add_node(std::shared_ptr<rclcpp::Node> node)
+{
+  add_node(node->get_node_base_interface());
+}
+
+void
+CallbackGroupBalancer::remove_node(NodeBaseInterface::SharedPtr node)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto node_iter = std::find_if(
+    nodes_.begin(), nodes_.end(),
+    [&node](const NodeBaseInterface::WeakPtr & weak_node) {return weak_node.lock() == node;});
+  if (node_iter == nodes_.end()) {
+    return;
+  }
+  nodes_.erase(node_iter);
+  for (auto & executor : executors_) {
+    executor->remove_node(node);
+  }
+  for (auto iter = groups_.begin(); iter != groups_.end(); ) {
+    if (iter->second.node.lock() == node) {
+      auto group = iter->second.group.lock();
+      if (group) {
+        group->assign_to_executor(nullptr);
+      }
+      iter = groups_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+void
+CallbackGroupBalancer::remove_node(std::shared_ptr<rclcpp::Node> node)
+{
+  remove_node(node->get_node_base_interface());
+}
+
+void
+CallbackGroupBalancer::move_callback_group(CallbackGroup::SharedPtr group, size_t executor_index)
+{
+  if (executor_index >= executors_.size()) {
+    throw std::out_of_range("no executor with index " + std::to_string(executor_index));
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  update_groups();
+  auto iter = groups_.find(group.get());
+  if (iter == groups_.end()) {
+    throw std::invalid_argument("callback group not in a node of the balancer");
+  }
+  assign(iter->second, executor_index);
+}
+
+size_t
+CallbackGroupBalancer::get_executor_index(CallbackGroup::SharedPtr group) const
+{
+  return get_executor_index(*group);
+}
+
+size_t
+CallbackGroupBalancer::rebalance()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  update_groups();
+
+  std::vector<std::chrono::nanoseconds> loads(executors_.size(), std::chrono::nanoseconds(0));
+  for (auto & entry : groups_) {
+    auto group = entry.second.group.lock();
+    if (!group) {
+      continue;
+    }
+    std::chrono::nanoseconds cpu_time = group->get_cpu_time();
+    entry.second.load = cpu_time - entry.second.last_cpu_time;
+    entry.second.last_cpu_time = cpu_time;
+    size_t executor_index = get_executor_index(*group);
+    if (executor_index < executors_.size()) {
+      loads[executor_index] += entry.second.load;
+    }
+  }
+  executor_loads_ = loads;
+
+  size_t moves = 0;
+  while (moves < options_.max_moves) {
+    size_t busiest =
+      static_cast<size_t>(std::max_element(loads.begin(), loads.end()) - loads.begin());
+    size_t idlest =
+      static_cast<size_t>(std::min_element(loads.begin(), loads.end()) - loads.begin());
+    std::chrono::nanoseconds gap = loads[busiest] - loads[idlest];
+    if (gap <= std::chrono::nanoseconds(0) ||
+      static_cast<double>(gap.count()) <=
+      options_.imbalance_threshold * static_cast<double>(loads[busiest].count()))
+    {
+      break;
+    }
+    // Move the group which leaves the smallest gap, if it makes the gap smaller.
+    GroupEntry * best_entry = nullptr;
+    std::chrono::nanoseconds best_gap = gap;
+    for (auto & entry : groups_) {
+      auto group = entry.second.group.lock();
+      if (!group || entry.second.load <= std::chrono::nanoseconds(0) ||
+        get_executor_index(*group) != busiest)
+      {
+        continue;
+      }
+      std::chrono::nanoseconds new_gap = gap - 2 * entry.second.load;
+      if (new_gap < std::chrono::nanoseconds(0)) {
+        new_gap = -new_gap;
+      }
+      if (new_gap < best_gap) {
+        best_gap = new_gap;
+        best_entry = &entry.second;
+      }
+    }
+    if (!best_entry) {
+      break;
+    }
+    loads[busiest] -= best_entry->load;
+    loads[idlest] += best_entry->load;
+    assign(*best_entry, idlest);
+    ++moves;
+  }
+  return moves;
+}
+
+std::vector<std::chrono::nanoseconds>
+CallbackGroupBalancer::get_executor_loads() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return executor_loads_;
+}
+
+void
+CallbackGroupBalancer::start(std::chrono::nanoseconds period)
+{
+  std::lock_guard<std::mutex> lock(thread_mutex_);
+  if (thread_.joinable()) {
+    throw std::runtime_error("CallbackGroupBalancer already started");
+  }
+  stop_thread_ = false;
+  thread_ = std::thread(
+    [this, period]() {
+      std::unique_lock<std::mutex> thread_lock(thread_mutex_);
+      while (!thread_cv_.wait_for(thread_lock, period, [this]() {return stop_thread_;})) {
+        thread_lock.unlock();
+        try {
+          rebalance();
+        } catch (const std::exception & exception) {
+          RCUTILS_LOG_ERROR_NAMED(
+            "rclcpp", "failed to rebalance the callback groups: %s", exception.what());
+        }
+        thread_lock.lock();
+      }
+    });
+}
+
+void
+CallbackGroupBalancer::stop()
+{
+  std::thread thread;
+  {
+    std::lock_guard<std::mutex> lock(thread_mutex_);
+    stop_thread_ = true;
+    thread = std::move(thread_);
+  }
+  thread_cv_.notify_one();
+  if (thread.joinable()) {
+    thread.join();
+  }
+}
+
+void
+CallbackGroupBalancer::update_groups()
+{
+  nodes_.erase(
+    std::remove_if(
+      nodes_.begin(), nodes_.end(),
+      [](const NodeBaseInterface::WeakPtr & node) {return node.expired();}),
+    nodes_.end());
+  for (auto iter = groups_.begin(); iter != groups_.end(); ) {
+    if (iter->second.group.expired()) {
+      iter = groups_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  for (auto & weak_node : nodes_) {
+    auto node = weak_node.lock();
+    if (!node) {
+      continue;
+    }
+    for (auto & weak_group : node->get_callback_groups()) {
+      auto group = weak_group.lock();
+      if (!group) {
+        continue;
+      }
+      auto inserted = groups_.emplace(
+        group.get(),
+        GroupEntry {group, node, group->get_cpu_time(), std::chrono::nanoseconds(0)});
+      if (get_executor_index(*group) >= executors_.size()) {
+        assign(inserted.first->second, get_idlest_executor());
+      }
+    }
+  }
+}
+
+size_t
+CallbackGroupBalancer::get_executor_index(const CallbackGroup & group) const
+{
+  const rclcpp::executor::Executor * executor = group.get_assigned_executor();
+  for (size_t i = 0; i < executors_.size(); ++i) {
+    if (executors_[i].get() == executor) {
+      return i;
+    }
+  }
+  return executors_.size();
+}
+
+size_t
+CallbackGroupBalancer::get_idlest_executor() const
+{
+  // By load, then by number of groups, to spread the groups which didn't run yet.
+  std::vector<size_t> group_counts(executors_.size(), 0);
+  for (const auto & entry : groups_) {
+    auto group = entry.second.group.lock();
+    if (group) {
+      size_t executor_index = get_executor_index(*group);
+      if (executor_index < executors_.size()) {
+        group_counts[executor_index]++;
+      }
+    }
+  }
+  size_t idlest = 0;
+  for (size_t i = 1; i < executors_.size(); ++i) {
+    if (executor_loads_[i] < executor_loads_[idlest] ||
+      (executor_loads_[i] == executor_loads_[idlest] && group_counts[i] < group_counts[idlest]))
+    {
+      idlest = i;
+    }
+  }
+  return idlest;
+}
+
+void
+CallbackGroupBalancer::assign(GroupEntry & entry, size_t executor_index)
+{
+  auto group = entry.group.lock();
+  if (!group) {
+    return;
+  }
+  group->assign_to_executor(executors_[executor_index].get());
+  // Wake up the executors of the node, so they collect its groups again.
+  auto node = entry.node.lock();
+  if (!node) {
+    return;
+  }
+  auto notify_lock = node->acquire_notify_guard_condition_lock();
+  if (rcl_trigger_guard_condition(node->get_notify_guard_condition()) != RCL_RET_OK) {
+    std::string error = rcl_get_error_string().str;
+    rcl_reset_error();
+    throw std::runtime_error("failed to wake up the executors of the node: " + error);
+  }
+}
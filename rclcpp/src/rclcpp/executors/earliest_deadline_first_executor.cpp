@@ -0,0 +1,254 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executors/earliest_deadline_first_executor.hpp"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "rcl/error_handling.h"
+#include "rcl/timer.h"
+
+#include "rclcpp/scope_exit.hpp"
+#include "rclcpp/utilities.hpp"
+
+using rclcpp::executors::EarliestDeadlineFirstExecutor;
+using rclcpp::executor::AnyExecutable;
+
+EarliestDeadlineFirstExecutor::EarliestDeadlineFirstExecutor(
+  const rclcpp::executor::ExecutorArgs & args)
+: executor::Executor(args) {}
+
+EarliestDeadlineFirstExecutor::~EarliestDeadlineFirstExecutor() {}
+
+void
+EarliestDeadlineFirstExecutor::spin()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin() called while already spinning");
+  }
+  RCLCPP_SCOPE_EXIT(this->spinning.store(false); this->clear_queue(); );
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    execute_next_by_deadline(std::chrono::nanoseconds(-1));
+  }
+}
+
+void
+EarliestDeadlineFirstExecutor::spin_some(std::chrono::nanoseconds max_duration)
+{
+  auto start = std::chrono::steady_clock::now();
+  auto max_duration_not_elapsed = [max_duration, start]() {
+      if (std::chrono::nanoseconds(0) == max_duration) {
+        // told to spin forever if need be
+        return true;
+      } else if (std::chrono::steady_clock::now() - start < max_duration) {
+        // told to spin only for some maximum amount of time
+        return true;
+      }
+      // spun too long
+      return false;
+    };
+
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin_some() called while already spinning");
+  }
+  RCLCPP_SCOPE_EXIT(this->spinning.store(false); this->clear_queue(); );
+  wait_for_work(std::chrono::milliseconds::zero());
+  collect_ready_executables();
+  while (spinning.load() && max_duration_not_elapsed()) {
+    QueuedExecutable next;
+    if (!pop_next_executable(next)) {
+      break;
+    }
+    execute_any_executable(*next.any_exec);
+    // Executing may have freed a mutually exclusive group, take what it was blocking.
+    collect_ready_executables();
+  }
+}
+
+void
+EarliestDeadlineFirstExecutor::spin_once(std::chrono::nanoseconds timeout)
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin_once() called while already spinning");
+  }
+  RCLCPP_SCOPE_EXIT(this->spinning.store(false); this->clear_queue(); );
+  execute_next_by_deadline(timeout);
+}
+
+size_t
+EarliestDeadlineFirstExecutor::get_number_of_deadline_misses(
+  const rclcpp::TimerBase::SharedPtr & timer) const
+{
+  return get_deadline_misses(timer.get());
+}
+
+size_t
+EarliestDeadlineFirstExecutor::get_number_of_deadline_misses(
+  const rclcpp::SubscriptionBase::SharedPtr & subscription) const
+{
+  return get_deadline_misses(subscription.get());
+}
+
+size_t
+EarliestDeadlineFirstExecutor::get_number_of_queued_executables() const
+{
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  return queue_.size();
+}
+
+size_t
+EarliestDeadlineFirstExecutor::get_deadline_misses(const void * entity) const
+{
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  auto it = entity_stats_.find(entity);
+  if (it == entity_stats_.end() || it->second.entity.expired()) {
+    return 0;
+  }
+  return it->second.deadline_misses;
+}
+
+bool
+EarliestDeadlineFirstExecutor::execute_next_by_deadline(std::chrono::nanoseconds timeout)
+{
+  bool has_queued_work;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    has_queued_work = !queue_.empty();
+  }
+  // With queued work only poll, so work with an earlier deadline which became ready is seen.
+  wait_for_work(has_queued_work ? std::chrono::nanoseconds(0) : timeout);
+  collect_ready_executables();
+
+  QueuedExecutable next;
+  if (!pop_next_executable(next)) {
+    return false;
+  }
+  execute_any_executable(*next.any_exec);
+  return true;
+}
+
+void
+EarliestDeadlineFirstExecutor::collect_ready_executables()
+{
+  TimePoint now = std::chrono::steady_clock::now();
+  while (true) {
+    AnyExecutablePtr any_exec(new AnyExecutable());
+    if (!get_next_ready_executable(*any_exec)) {
+      break;
+    }
+    enqueue(std::move(any_exec), now);
+  }
+}
+
+EarliestDeadlineFirstExecutor::EntityStats &
+EarliestDeadlineFirstExecutor::get_entity_stats(
+  const void * entity, std::shared_ptr<const void> owner)
+{
+  EntityStats & stats = entity_stats_[entity];
+  if (stats.entity.expired()) {
+    // New entity, or a new one at the address of a destroyed one.
+    stats = EntityStats();
+    stats.entity = owner;
+  }
+  return stats;
+}
+
+void
+EarliestDeadlineFirstExecutor::enqueue(AnyExecutablePtr any_exec, TimePoint now)
+{
+  QueuedExecutable queued;
+  if (any_exec->timer) {
+    queued.entity = any_exec->timer.get();
+  } else if (any_exec->subscription) {
+    queued.entity = any_exec->subscription.get();
+  } else if (any_exec->service) {
+    queued.entity = any_exec->service.get();
+  } else if (any_exec->client) {
+    queued.entity = any_exec->client.get();
+  } else {
+    queued.entity = any_exec->waitable.get();
+  }
+
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  if (!queued_entities_.insert(queued.entity).second) {
+    // Already queued, destroying any_exec resets its (reentrant) callback group.
+    return;
+  }
+
+  // Every entity is ordered by its absolute deadline, the entities without one come last.
+  queued.deadline = TimePoint::max();
+  if (any_exec->timer) {
+    int64_t period = 0;
+    if (rcl_timer_get_period(any_exec->timer->get_timer_handle().get(), &period) != RCL_RET_OK) {
+      queued_entities_.erase(queued.entity);
+      throw std::runtime_error(
+              std::string("Failed to get timer period: ") + rcl_get_error_string().str);
+    }
+    // The time until trigger is negative or zero for a ready timer, the timer must be called
+    // before it is due again.
+    queued.deadline =
+      now + any_exec->timer->time_until_trigger() + std::chrono::nanoseconds(period);
+  } else if (any_exec->subscription) {
+    EntityStats & stats = get_entity_stats(queued.entity, any_exec->subscription);
+    if (!stats.relative_deadline_known) {
+      rmw_time_t deadline =
+        any_exec->subscription->get_actual_qos().get_rmw_qos_profile().deadline;
+      stats.relative_deadline =
+        std::chrono::seconds(deadline.sec) + std::chrono::nanoseconds(deadline.nsec);
+      stats.relative_deadline_known = true;
+    }
+    if (stats.relative_deadline > std::chrono::nanoseconds::zero()) {
+      queued.deadline = now + stats.relative_deadline;
+    }
+  }
+  TimePoint deadline = queued.deadline;
+  queued.any_exec = std::move(any_exec);
+  queue_.emplace(deadline, std::move(queued));
+}
+
+bool
+EarliestDeadlineFirstExecutor::pop_next_executable(QueuedExecutable & next)
+{
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  if (queue_.empty()) {
+    return false;
+  }
+  auto it = queue_.begin();
+  next = std::move(it->second);
+  queue_.erase(it);
+  queued_entities_.erase(next.entity);
+
+  if (next.deadline != TimePoint::max() && std::chrono::steady_clock::now() > next.deadline) {
+    std::shared_ptr<const void> owner;
+    if (next.any_exec->timer) {
+      owner = next.any_exec->timer;
+    } else {
+      owner = next.any_exec->subscription;
+    }
+    get_entity_stats(next.entity, owner).deadline_misses++;
+  }
+  return true;
+}
+
+void
+EarliestDeadlineFirstExecutor::clear_queue()
+{
+  // Work which was taken but not executed is discarded, resetting its callback group.
+  // The entities are still ready and are taken again by the next wait.
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  queue_.clear();
+  queued_entities_.clear();
+}
@@ -0,0 +1,533 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executors/events_executor.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rcl/error_handling.h"
+
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/scope_exit.hpp"
+
+#include "rcutils/logging_macros.h"
+
+using rclcpp::executors::EventsExecutor;
+
+EventsExecutor::EventsExecutor(const rclcpp::executor::ExecutorArgs & args)
+: executor::Executor(args),
+  entities_need_rebuild_(true),
+  number_of_entity_rebuilds_(0)
+{}
+
+EventsExecutor::~EventsExecutor() {}
+
+void
+EventsExecutor::spin()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin() called while already spinning");
+  }
+  RCLCPP_SCOPE_EXIT(this->spinning.store(false); );
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    if (ready_queue_.empty()) {
+      wait_for_ready_executables(std::chrono::nanoseconds(-1));
+    }
+    execute_next_queued_executable();
+  }
+}
+
+void
+EventsExecutor::spin_some(std::chrono::nanoseconds max_duration)
+{
+  auto start = std::chrono::steady_clock::now();
+  auto max_duration_not_elapsed = [max_duration, start]() {
+      if (std::chrono::nanoseconds(0) == max_duration) {
+        // told to spin forever if need be
+        return true;
+      } else if (std::chrono::steady_clock::now() - start < max_duration) {
+        // told to spin only for some maximum amount of time
+        return true;
+      }
+      // spun too long
+      return false;
+    };
+
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin_some() called while already spinning");
+  }
+  RCLCPP_SCOPE_EXIT(this->spinning.store(false); );
+  // Only wait when the queue was drained, otherwise finish the previously harvested work first.
+  if (ready_queue_.empty()) {
+    wait_for_ready_executables(std::chrono::milliseconds::zero());
+  }
+  while (spinning.load() && max_duration_not_elapsed()) {
+    if (!execute_next_queued_executable()) {
+      break;
+    }
+  }
+}
+
+void
+EventsExecutor::spin_once(std::chrono::nanoseconds timeout)
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin_once() called while already spinning");
+  }
+  RCLCPP_SCOPE_EXIT(this->spinning.store(false); );
+  if (ready_queue_.empty()) {
+    wait_for_ready_executables(timeout);
+  }
+  execute_next_queued_executable();
+}
+
+void
+EventsExecutor::add_node(
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr, bool notify)
+{
+  Executor::add_node(node_ptr, notify);
+  entities_need_rebuild_.store(true);
+}
+
+void
+EventsExecutor::add_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify)
+{
+  this->add_node(node_ptr->get_node_base_interface(), notify);
+}
+
+void
+EventsExecutor::remove_node(
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr, bool notify)
+{
+  Executor::remove_node(node_ptr, notify);
+  entities_need_rebuild_.store(true);
+
+  // Drop already harvested work of the removed node, it may be added to another executor.
+  std::lock_guard<std::mutex> lock(memory_strategy_mutex_);
+  auto belongs_to_node = [this, &node_ptr](const ReadyExecutable & ready) {
+      switch (ready.type) {
+        case EntityType::Subscription:
+          return subscriptions_[ready.index].node.lock() == node_ptr;
+        case EntityType::Timer:
+          return timers_[ready.index].node.lock() == node_ptr;
+        case EntityType::Service:
+          return services_[ready.index].node.lock() == node_ptr;
+        case EntityType::Client:
+          return clients_[ready.index].node.lock() == node_ptr;
+        case EntityType::Waitable:
+          return waitables_[ready.index].node.lock() == node_ptr;
+      }
+      return false;
+    };
+  ready_queue_.erase(
+    std::remove_if(ready_queue_.begin(), ready_queue_.end(), belongs_to_node),
+    ready_queue_.end());
+}
+
+void
+EventsExecutor::remove_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify)
+{
+  this->remove_node(node_ptr->get_node_base_interface(), notify);
+}
+
+size_t
+EventsExecutor::get_number_of_entity_rebuilds() const
+{
+  return number_of_entity_rebuilds_;
+}
+
+size_t
+EventsExecutor::get_number_of_queued_executables() const
+{
+  std::lock_guard<std::mutex> lock(memory_strategy_mutex_);
+  return ready_queue_.size();
+}
+
+void
+EventsExecutor::rebuild_entities()
+{
+  entities_need_rebuild_.store(false);
+  ready_queue_.clear();
+  subscriptions_.clear();
+  timers_.clear();
+  services_.clear();
+  clients_.clear();
+  waitables_.clear();
+
+  bool has_invalid_weak_nodes = false;
+  // A reader shared by several subscriptions is waited on once, through the first of them.
+  std::vector<const rcl_subscription_t *> shared_reader_handles;
+  for (auto & weak_node : weak_nodes_) {
+    auto node = weak_node.lock();
+    if (!node) {
+      has_invalid_weak_nodes = true;
+      continue;
+    }
+    for (auto & weak_group : node->get_callback_groups()) {
+      auto group = weak_group.lock();
+      if (!group) {
+        continue;
+      }
+      group->find_subscription_ptrs_if(
+        [this, &weak_group, &weak_node, &shared_reader_handles](
+          const rclcpp::SubscriptionBase::SharedPtr & subscription)
+        {
+          if (subscription->has_shared_reader()) {
+            const rcl_subscription_t * handle = subscription->get_subscription_handle().get();
+            if (
+              std::find(shared_reader_handles.begin(), shared_reader_handles.end(), handle) !=
+              shared_reader_handles.end())
+            {
+              return false;
+            }
+            shared_reader_handles.push_back(handle);
+          }
+          subscriptions_.push_back({subscription, nullptr, weak_group, weak_node, 0});
+          return false;
+        });
+      group->find_timer_ptrs_if(
+        [this, &weak_group, &weak_node](const rclcpp::TimerBase::SharedPtr & timer) {
+          timers_.push_back({timer, nullptr, weak_group, weak_node, 0});
+          return false;
+        });
+      group->find_service_ptrs_if(
+        [this, &weak_group, &weak_node](const rclcpp::ServiceBase::SharedPtr & service) {
+          services_.push_back({service, nullptr, weak_group, weak_node, 0});
+          return false;
+        });
+      group->find_client_ptrs_if(
+        [this, &weak_group, &weak_node](const rclcpp::ClientBase::SharedPtr & client) {
+          clients_.push_back({client, nullptr, weak_group, weak_node, 0});
+          return false;
+        });
+      group->find_waitable_ptrs_if(
+        [this, &weak_group, &weak_node](const rclcpp::Waitable::SharedPtr & waitable) {
+          waitables_.push_back({waitable, nullptr, weak_group, weak_node, 0});
+          return false;
+        });
+    }
+  }
+
+  // Clean up any invalid nodes, if they were detected
+  if (has_invalid_weak_nodes) {
+    auto node_it = weak_nodes_.begin();
+    auto gc_it = guard_conditions_.begin();
+    while (node_it != weak_nodes_.end()) {
+      if (node_it->expired()) {
+        node_it = weak_nodes_.erase(node_it);
+        memory_strategy_->remove_guard_condition(*gc_it);
+        gc_it = guard_conditions_.erase(gc_it);
+      } else {
+        ++node_it;
+        ++gc_it;
+      }
+    }
+  }
+
+  // The interrupt guard condition, also triggered on sigint, comes first, then one per node.
+  size_t number_of_subscriptions = subscriptions_.size();
+  size_t number_of_guard_conditions = 1 + guard_conditions_.size();
+  size_t number_of_timers = timers_.size();
+  size_t number_of_clients = clients_.size();
+  size_t number_of_services = services_.size();
+  size_t number_of_events = 0;
+  for (auto & entry : waitables_) {
+    auto waitable = entry.weak_entity.lock();
+    if (!waitable) {
+      continue;
+    }
+    number_of_subscriptions += waitable->get_number_of_ready_subscriptions();
+    number_of_guard_conditions += waitable->get_number_of_ready_guard_conditions();
+    number_of_timers += waitable->get_number_of_ready_timers();
+    number_of_clients += waitable->get_number_of_ready_clients();
+    number_of_services += waitable->get_number_of_ready_services();
+    number_of_events += waitable->get_number_of_ready_events();
+  }
+
+  rcl_ret_t ret = rcl_wait_set_resize(
+    &wait_set_, number_of_subscriptions, number_of_guard_conditions, number_of_timers,
+    number_of_clients, number_of_services, number_of_events);
+  if (RCL_RET_OK != ret) {
+    throw std::runtime_error(
+            std::string("Couldn't resize the wait set : ") + rcl_get_error_string().str);
+  }
+  ++number_of_entity_rebuilds_;
+}
+
+bool
+EventsExecutor::fill_wait_set()
+{
+  // A destroyed node finalizes its notify guard condition, so it must not be put in the wait set.
+  for (auto & weak_node : weak_nodes_) {
+    if (weak_node.expired()) {
+      return false;
+    }
+  }
+
+  if (rcl_wait_set_clear(&wait_set_) != RCL_RET_OK) {
+    throw std::runtime_error("Couldn't clear wait set");
+  }
+
+  if (
+    rcl_wait_set_add_guard_condition(&wait_set_, &interrupt_guard_condition_, NULL) !=
+    RCL_RET_OK)
+  {
+    throw std::runtime_error(
+            std::string("Couldn't add guard condition to wait set: ") + rcl_get_error_string().str);
+  }
+  for (auto guard_condition : guard_conditions_) {
+    if (rcl_wait_set_add_guard_condition(&wait_set_, guard_condition, NULL) != RCL_RET_OK) {
+      throw std::runtime_error(
+              std::string("Couldn't add guard condition to wait set: ") +
+              rcl_get_error_string().str);
+    }
+  }
+
+  for (auto & entry : subscriptions_) {
+    entry.entity = entry.weak_entity.lock();
+    if (!entry.entity) {
+      return false;
+    }
+    if (
+      rcl_wait_set_add_subscription(
+        &wait_set_, entry.entity->get_subscription_handle().get(),
+        &entry.wait_set_index) != RCL_RET_OK)
+    {
+      throw std::runtime_error(
+              std::string("Couldn't add subscription to wait set: ") +
+              rcl_get_error_string().str);
+    }
+  }
+  for (auto & entry : timers_) {
+    entry.entity = entry.weak_entity.lock();
+    if (!entry.entity) {
+      return false;
+    }
+    if (
+      rcl_wait_set_add_timer(
+        &wait_set_, entry.entity->get_timer_handle().get(),
+        &entry.wait_set_index) != RCL_RET_OK)
+    {
+      throw std::runtime_error(
+              std::string("Couldn't add timer to wait set: ") + rcl_get_error_string().str);
+    }
+  }
+  for (auto & entry : services_) {
+    entry.entity = entry.weak_entity.lock();
+    if (!entry.entity) {
+      return false;
+    }
+    if (
+      rcl_wait_set_add_service(
+        &wait_set_, entry.entity->get_service_handle().get(),
+        &entry.wait_set_index) != RCL_RET_OK)
+    {
+      throw std::runtime_error(
+              std::string("Couldn't add service to wait set: ") + rcl_get_error_string().str);
+    }
+  }
+  for (auto & entry : clients_) {
+    entry.entity = entry.weak_entity.lock();
+    if (!entry.entity) {
+      return false;
+    }
+    if (
+      rcl_wait_set_add_client(
+        &wait_set_, entry.entity->get_client_handle().get(),
+        &entry.wait_set_index) != RCL_RET_OK)
+    {
+      throw std::runtime_error(
+              std::string("Couldn't add client to wait set: ") + rcl_get_error_string().str);
+    }
+  }
+  // Waitables add their entities after the ones owned by the entity table.
+  for (auto & entry : waitables_) {
+    entry.entity = entry.weak_entity.lock();
+    if (!entry.entity) {
+      return false;
+    }
+    if (!entry.entity->add_to_wait_set(&wait_set_)) {
+      throw std::runtime_error("Couldn't add waitable to wait set");
+    }
+  }
+  return true;
+}
+
+void
+EventsExecutor::wait_for_ready_executables(std::chrono::nanoseconds timeout)
+{
+  {
+    std::lock_guard<std::mutex> lock(memory_strategy_mutex_);
+    if (entities_need_rebuild_.load()) {
+      rebuild_entities();
+    }
+    // An entity or node went away since the last rebuild, the table is stale.
+    while (!fill_wait_set()) {
+      rebuild_entities();
+    }
+  }
+
+  rcl_ret_t status = rcl_wait(&wait_set_, timeout.count());
+  if (status == RCL_RET_WAIT_SET_EMPTY) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rclcpp",
+      "empty wait set received in rcl_wait(). This should never happen.");
+  } else if (status != RCL_RET_OK && status != RCL_RET_TIMEOUT) {
+    using rclcpp::exceptions::throw_from_rcl_error;
+    throw_from_rcl_error(status, "rcl_wait() failed");
+  }
+
+  std::lock_guard<std::mutex> lock(memory_strategy_mutex_);
+  // The node guard conditions follow the interrupt guard condition.
+  for (size_t i = 1; i < 1 + guard_conditions_.size(); ++i) {
+    if (wait_set_.guard_conditions[i]) {
+      entities_need_rebuild_.store(true);
+      break;
+    }
+  }
+
+  // Keep the same precedence as Executor::get_next_ready_executable().
+  for (size_t i = 0; i < timers_.size(); ++i) {
+    if (wait_set_.timers[timers_[i].wait_set_index]) {
+      ready_queue_.push_back({EntityType::Timer, i});
+    }
+  }
+  for (size_t i = 0; i < subscriptions_.size(); ++i) {
+    if (wait_set_.subscriptions[subscriptions_[i].wait_set_index]) {
+      ready_queue_.push_back({EntityType::Subscription, i});
+    }
+  }
+  for (size_t i = 0; i < services_.size(); ++i) {
+    if (wait_set_.services[services_[i].wait_set_index]) {
+      ready_queue_.push_back({EntityType::Service, i});
+    }
+  }
+  for (size_t i = 0; i < clients_.size(); ++i) {
+    if (wait_set_.clients[clients_[i].wait_set_index]) {
+      ready_queue_.push_back({EntityType::Client, i});
+    }
+  }
+  for (size_t i = 0; i < waitables_.size(); ++i) {
+    if (waitables_[i].entity->is_ready(&wait_set_)) {
+      ready_queue_.push_back({EntityType::Waitable, i});
+    }
+  }
+}
+
+template<typename EntityT>
+bool
+EventsExecutor::take_scope(
+  EntityEntry<EntityT> & entry,
+  executor::AnyExecutable & any_exec)
+{
+  auto group = entry.callback_group.lock();
+  auto node = entry.node.lock();
+  if (!entry.entity || !group || !node) {
+    return false;
+  }
+  // Only possible when re-entered from a callback of the same group, or while a publisher
+  // delivers a message synchronously, the wait set will report the entity again.
+  using callback_group::CallbackGroupType;
+  if (group->type() == CallbackGroupType::MutuallyExclusive) {
+    bool can_be_taken_from = true;
+    if (!group->can_be_taken_from().compare_exchange_strong(can_be_taken_from, false)) {
+      return false;
+    }
+  } else if (!group->can_be_taken_from().load()) {
+    return false;
+  }
+  any_exec.callback_group = std::move(group);
+  any_exec.node_base = std::move(node);
+  return true;
+}
+
+bool
+EventsExecutor::execute_next_queued_executable()
+{
+  executor::AnyExecutable any_exec;
+  {
+    std::lock_guard<std::mutex> lock(memory_strategy_mutex_);
+    bool taken = false;
+    while (!taken && !ready_queue_.empty()) {
+      ReadyExecutable ready = ready_queue_.front();
+      ready_queue_.pop_front();
+      switch (ready.type) {
+        case EntityType::Subscription:
+          if (take_scope(subscriptions_[ready.index], any_exec)) {
+            any_exec.subscription = subscriptions_[ready.index].entity;
+            taken = true;
+          }
+          break;
+        case EntityType::Timer:
+          if (take_scope(timers_[ready.index], any_exec)) {
+            any_exec.timer = timers_[ready.index].entity;
+            taken = true;
+          }
+          break;
+        case EntityType::Service:
+          if (take_scope(services_[ready.index], any_exec)) {
+            any_exec.service = services_[ready.index].entity;
+            taken = true;
+          }
+          break;
+        case EntityType::Client:
+          if (take_scope(clients_[ready.index], any_exec)) {
+            any_exec.client = clients_[ready.index].entity;
+            taken = true;
+          }
+          break;
+        case EntityType::Waitable:
+          if (take_scope(waitables_[ready.index], any_exec)) {
+            any_exec.waitable = waitables_[ready.index].entity;
+            taken = true;
+          }
+          break;
+      }
+    }
+    if (!taken) {
+      return false;
+    }
+  }
+
+  if (!spinning.load()) {
+    // cancel() arrived after the take, release the group so the next spin can take from it.
+    any_exec.callback_group->can_be_taken_from().store(true);
+    return false;
+  }
+  // Unlike Executor::execute_any_executable() the interrupt guard condition is not triggered
+  // here, the wait set does not need to be recalculated after executing an entity.
+  if (any_exec.timer) {
+    execute_timer(any_exec.timer);
+  }
+  if (any_exec.subscription) {
+    execute_subscription(any_exec.subscription);
+  }
+  if (any_exec.service) {
+    execute_service(any_exec.service);
+  }
+  if (any_exec.client) {
+    execute_client(any_exec.client);
+  }
+  if (any_exec.waitable) {
+    any_exec.waitable->execute();
+  }
+  any_exec.callback_group->can_be_taken_from().store(true);
+  any_exec.callback_group.reset();
+  return true;
+}
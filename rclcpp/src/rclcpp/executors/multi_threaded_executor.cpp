@@ -15,10 +15,16 @@
 #include "rclcpp/executors/multi_threaded_executor.hpp"
 
 #include <chrono>
+#include <exception>
 #include <functional>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 
+#include "rcutils/logging_macros.h"
+
+#include "rclcpp/realtime.hpp"
+#include "rclcpp/thread_options.hpp"
 #include "rclcpp/utilities.hpp"
 #include "rclcpp/scope_exit.hpp"
 
@@ -31,7 +37,11 @@ MultiThreadedExecutor::MultiThreadedExecutor(
   std::chrono::nanoseconds next_exec_timeout)
 : executor::Executor(args),
   yield_before_execute_(yield_before_execute),
-  next_exec_timeout_(next_exec_timeout)
+  next_exec_timeout_(next_exec_timeout),
+  elastic_(false),
+  active_threads_(0),
+  spin_thread_number_(0),
+  next_thread_number_(0)
 {
   number_of_threads_ = number_of_threads ? number_of_threads : std::thread::hardware_concurrency();
   if (number_of_threads_ == 0) {
@@ -39,6 +49,28 @@ MultiThreadedExecutor::MultiThreadedExecutor(
   }
 }
 
+MultiThreadedExecutor::MultiThreadedExecutor(
+  const rclcpp::executor::ExecutorArgs & args,
+  const ElasticThreadPoolOptions & elastic_options,
+  bool yield_before_execute,
+  std::chrono::nanoseconds next_exec_timeout)
+: MultiThreadedExecutor(args, elastic_options.max_threads, yield_before_execute, next_exec_timeout)
+{
+  elastic_ = true;
+  elastic_options_ = elastic_options;
+  if (elastic_options_.min_threads == 0) {
+    elastic_options_.min_threads = 1;
+  }
+  if (number_of_threads_ < elastic_options_.min_threads) {
+    if (elastic_options.max_threads != 0) {
+      throw std::invalid_argument("max_threads is lower than min_threads");
+    }
+    // Fewer cores than the minimum.
+    number_of_threads_ = elastic_options_.min_threads;
+  }
+  elastic_options_.max_threads = number_of_threads_;
+}
+
 MultiThreadedExecutor::~MultiThreadedExecutor() {}
 
 void
@@ -48,20 +80,38 @@ MultiThreadedExecutor::spin()
     throw std::runtime_error("spin() called while already spinning");
   }
   RCLCPP_SCOPE_EXIT(this->spinning.store(false); );
-  std::vector<std::thread> threads;
+  size_t number_of_started_threads = elastic_ ? elastic_options_.min_threads : number_of_threads_;
   size_t thread_id = 0;
+  std::exception_ptr thread_options_error;
   {
     std::lock_guard<std::mutex> wait_lock(wait_mutex_);
-    for (; thread_id < number_of_threads_ - 1; ++thread_id) {
-      auto func = std::bind(&MultiThreadedExecutor::run, this, thread_id);
-      threads.emplace_back(func);
+    std::lock_guard<std::mutex> threads_lock(threads_mutex_);
+    spin_thread_number_ = number_of_started_threads - 1;
+    next_thread_number_ = number_of_started_threads;
+    last_wait_end_ = std::chrono::steady_clock::now();
+    for (; thread_id < number_of_started_threads - 1; ++thread_id) {
+      active_threads_++;
+      threads_.emplace_back(&MultiThreadedExecutor::run, this, thread_id);
+    }
+    // The threads block on the wait mutex, so they are configured before they execute anything.
+    try {
+      for (size_t i = 0; i < threads_.size(); ++i) {
+        rclcpp::apply_thread_options(threads_[i], get_thread_options(i));
+      }
+      rclcpp::apply_thread_options_to_current_thread(get_thread_options(thread_id));
+    } catch (...) {
+      spinning.store(false);
+      thread_options_error = std::current_exception();
     }
   }
+  if (thread_options_error) {
+    join_threads();
+    std::rethrow_exception(thread_options_error);
+  }
 
+  active_threads_++;
   run(thread_id);
-  for (auto & thread : threads) {
-    thread.join();
-  }
+  join_threads();
 }
 
 size_t
@@ -70,9 +120,20 @@ MultiThreadedExecutor::get_number_of_threads()
   return number_of_threads_;
 }
 
+size_t
+MultiThreadedExecutor::get_number_of_active_threads() const
+{
+  return active_threads_.load();
+}
+
 void
-MultiThreadedExecutor::run(size_t)
+MultiThreadedExecutor::run(size_t this_thread_number)
 {
+  // The active thread count was incremented when the thread was started.
+  bool counted = true;
+  RCLCPP_SCOPE_EXIT(if (counted) {active_threads_--;});
+  rclcpp::prefault_stack(get_thread_options(this_thread_number).stack_prefault_size);
+  auto last_execution = std::chrono::steady_clock::now();
   while (rclcpp::ok(this->context_) && spinning.load()) {
     executor::AnyExecutable any_exec;
     {
@@ -80,12 +141,27 @@ MultiThreadedExecutor::run(size_t)
       if (!rclcpp::ok(this->context_) || !spinning.load()) {
         return;
       }
-      if (!get_next_executable(any_exec, next_exec_timeout_)) {
+      if (elastic_) {
+        if (!get_next_elastic_executable(any_exec)) {
+          if (this_thread_number != spin_thread_number_ &&
+            active_threads_.load() > elastic_options_.min_threads &&
+            std::chrono::steady_clock::now() - last_execution >= elastic_options_.idle_timeout)
+          {
+            // Uncounted with the wait mutex locked, so the threads don't all stop at once.
+            counted = false;
+            active_threads_--;
+            std::lock_guard<std::mutex> threads_lock(threads_mutex_);
+            finished_threads_.push_back(std::this_thread::get_id());
+            return;
+          }
+          continue;
+        }
+      } else if (!get_next_executable(any_exec, next_exec_timeout_)) {
         continue;
       }
       if (any_exec.timer) {
         // Guard against multiple threads getting the same timer.
-        if (scheduled_timers_.count(any_exec.timer) != 0) {
+        if (any_exec.timer->exchange_in_use_by_executor_state(true)) {
           // Make sure that any_exec's callback group is reset before
           // the lock is released.
           if (any_exec.callback_group) {
@@ -93,7 +169,6 @@ MultiThreadedExecutor::run(size_t)
           }
           continue;
         }
-        scheduled_timers_.insert(any_exec.timer);
       }
     }
     if (yield_before_execute_) {
@@ -103,14 +178,87 @@ MultiThreadedExecutor::run(size_t)
     execute_any_executable(any_exec);
 
     if (any_exec.timer) {
-      std::lock_guard<std::mutex> wait_lock(wait_mutex_);
-      auto it = scheduled_timers_.find(any_exec.timer);
-      if (it != scheduled_timers_.end()) {
-        scheduled_timers_.erase(it);
-      }
+      // Releasing the claim does not need the wait mutex.
+      any_exec.timer->exchange_in_use_by_executor_state(false);
     }
     // Clear the callback_group to prevent the AnyExecutable destructor from
     // resetting the callback group `can_be_taken_from`
     any_exec.callback_group.reset();
+    if (elastic_) {
+      last_execution = std::chrono::steady_clock::now();
+    }
+  }
+}
+
+bool
+MultiThreadedExecutor::get_next_elastic_executable(executor::AnyExecutable & any_exec)
+{
+  if (get_next_ready_executable(any_exec)) {
+    // The work was ready since the last wait, and no thread was free to take it until now.
+    if (std::chrono::steady_clock::now() - last_wait_end_ > elastic_options_.grow_threshold &&
+      active_threads_.load() < elastic_options_.max_threads)
+    {
+      add_thread();
+    }
+    return true;
+  }
+  // Wake up to let the idle threads stop.
+  std::chrono::nanoseconds timeout = elastic_options_.idle_timeout;
+  if (next_exec_timeout_ >= std::chrono::nanoseconds::zero() && next_exec_timeout_ < timeout) {
+    timeout = next_exec_timeout_;
+  }
+  wait_for_work(timeout);
+  last_wait_end_ = std::chrono::steady_clock::now();
+  if (!spinning.load()) {
+    return false;
+  }
+  return get_next_ready_executable(any_exec);
+}
+
+void
+MultiThreadedExecutor::add_thread()
+{
+  std::lock_guard<std::mutex> threads_lock(threads_mutex_);
+  if (!spinning.load()) {
+    return;
+  }
+  // Join the threads which stopped since the last start.
+  for (const auto & id : finished_threads_) {
+    for (auto iter = threads_.begin(); iter != threads_.end(); ++iter) {
+      if (iter->get_id() == id) {
+        iter->join();
+        threads_.erase(iter);
+        break;
+      }
+    }
+  }
+  finished_threads_.clear();
+
+  size_t thread_number = next_thread_number_++;
+  active_threads_++;
+  threads_.emplace_back(&MultiThreadedExecutor::run, this, thread_number);
+  // The thread blocks on the wait mutex, held by the caller, until it is configured.
+  try {
+    rclcpp::apply_thread_options(threads_.back(), get_thread_options(thread_number));
+  } catch (const std::exception & exception) {
+    RCUTILS_LOG_WARN_NAMED(
+      "rclcpp", "couldn't apply the thread options to a new executor thread: %s",
+      exception.what());
+  }
+}
+
+void
+MultiThreadedExecutor::join_threads()
+{
+  std::vector<std::thread> threads;
+  {
+    std::lock_guard<std::mutex> threads_lock(threads_mutex_);
+    // No thread is started after this, see add_thread().
+    spinning.store(false);
+    threads.swap(threads_);
+    finished_threads_.clear();
+  }
+  for (auto & thread : threads) {
+    thread.join();
   }
 }
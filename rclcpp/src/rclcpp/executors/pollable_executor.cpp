@@ -0,0 +1,224 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/executors/pollable_executor.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <system_error>
+
+#include "rclcpp/any_executable.hpp"
+#include "rclcpp/scope_exit.hpp"
+#include "rclcpp/utilities.hpp"
+
+using rclcpp::executors::PollableExecutor;
+
+PollableExecutor::PollableExecutor(const rclcpp::executor::ExecutorArgs & args)
+: executor::Executor(args)
+{
+#if defined(__linux__)
+  read_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (read_fd_ < 0) {
+    throw std::system_error(errno, std::generic_category(), "eventfd() failed");
+  }
+  write_fd_ = read_fd_;
+#elif !defined(_WIN32)
+  int fds[2];
+  if (pipe(fds) != 0) {
+    throw std::system_error(errno, std::generic_category(), "pipe() failed");
+  }
+  for (int fd : fds) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+  }
+  read_fd_ = fds[0];
+  write_fd_ = fds[1];
+#else
+  throw std::runtime_error("PollableExecutor is not supported on Windows");
+#endif
+}
+
+PollableExecutor::~PollableExecutor()
+{
+  stop();
+#ifndef _WIN32
+  if (write_fd_ != read_fd_) {
+    close(write_fd_);
+  }
+  close(read_fd_);
+#endif
+}
+
+int
+PollableExecutor::get_fd() const
+{
+  return read_fd_;
+}
+
+void
+PollableExecutor::start()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("start() called while already spinning");
+  }
+  // A previous waiting thread may have stopped while the file descriptor was signaled.
+  drain_fd();
+  {
+    std::lock_guard<std::mutex> lock(waiter_mutex_);
+    work_collected_ = false;
+    waiter_exception_ = nullptr;
+  }
+  waiter_thread_ = std::thread(&PollableExecutor::run_waiter, this);
+}
+
+void
+PollableExecutor::stop()
+{
+  if (!waiter_thread_.joinable()) {
+    spinning.store(false);
+    return;
+  }
+  // Wake up the waiting thread, in rcl_wait() or waiting for the end of dispatch().
+  cancel();
+  {
+    std::lock_guard<std::mutex> lock(waiter_mutex_);
+  }
+  waiter_cv_.notify_one();
+  waiter_thread_.join();
+}
+
+size_t
+PollableExecutor::dispatch(size_t max_executables)
+{
+  {
+    std::lock_guard<std::mutex> lock(waiter_mutex_);
+    if (waiter_exception_) {
+      std::exception_ptr exception = waiter_exception_;
+      waiter_exception_ = nullptr;
+      work_collected_ = false;
+      std::rethrow_exception(exception);
+    }
+    if (!work_collected_) {
+      return 0;
+    }
+  }
+  drain_fd();
+
+  // The waiting thread is stopped until the end of the round, so the wait set is ours.
+  size_t executed = 0;
+  bool work_left = true;
+  try {
+    while (0u == max_executables || executed < max_executables) {
+      rclcpp::executor::AnyExecutable any_exec;
+      if (!get_next_ready_executable(any_exec)) {
+        work_left = false;
+        break;
+      }
+      execute_any_executable(any_exec);
+      ++executed;
+    }
+  } catch (...) {
+    // Let the event loop come back for the rest of the work.
+    signal_fd();
+    throw;
+  }
+  if (work_left) {
+    signal_fd();
+    return executed;
+  }
+  {
+    std::lock_guard<std::mutex> lock(waiter_mutex_);
+    work_collected_ = false;
+  }
+  waiter_cv_.notify_one();
+  return executed;
+}
+
+void
+PollableExecutor::spin()
+{
+#ifndef _WIN32
+  start();
+  RCLCPP_SCOPE_EXIT(this->stop(); );
+  pollfd poll_fd {read_fd_, POLLIN, 0};
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    if (poll(&poll_fd, 1, -1) < 0 && errno != EINTR) {
+      throw std::system_error(errno, std::generic_category(), "poll() failed");
+    }
+    dispatch();
+  }
+#endif
+}
+
+void
+PollableExecutor::run_waiter()
+{
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    std::exception_ptr exception;
+    try {
+      wait_for_work();
+    } catch (...) {
+      exception = std::current_exception();
+    }
+    std::unique_lock<std::mutex> lock(waiter_mutex_);
+    work_collected_ = true;
+    waiter_exception_ = exception;
+    signal_fd();
+    if (exception) {
+      return;
+    }
+    waiter_cv_.wait(lock, [this]() {return !work_collected_ || !spinning.load();});
+  }
+}
+
+void
+PollableExecutor::signal_fd()
+{
+#if defined(__linux__)
+  uint64_t value = 1;
+  // Fails only when the counter would overflow, it is readable anyway.
+  ssize_t ret = write(write_fd_, &value, sizeof(value));
+  (void)ret;
+#elif !defined(_WIN32)
+  char value = 1;
+  // Fails only when the pipe is full, it is readable anyway.
+  ssize_t ret = write(write_fd_, &value, sizeof(value));
+  (void)ret;
+#endif
+}
+
+void
+PollableExecutor::drain_fd()
+{
+#if defined(__linux__)
+  uint64_t value;
+  ssize_t ret = read(read_fd_, &value, sizeof(value));
+  (void)ret;
+#elif !defined(_WIN32)
+  char buffer[64];
+  while (read(read_fd_, buffer, sizeof(buffer)) > 0) {
+  }
+#endif
+}
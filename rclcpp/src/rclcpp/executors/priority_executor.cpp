@@ -0,0 +1,212 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executors/priority_executor.hpp"
+
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "rclcpp/scope_exit.hpp"
+#include "rclcpp/utilities.hpp"
+
+using rclcpp::executors::PriorityExecutor;
+using rclcpp::executor::AnyExecutable;
+
+namespace
+{
+
+const void *
+get_entity(const AnyExecutable & any_exec)
+{
+  if (any_exec.timer) {
+    return any_exec.timer.get();
+  }
+  if (any_exec.subscription) {
+    return any_exec.subscription.get();
+  }
+  if (any_exec.service) {
+    return any_exec.service.get();
+  }
+  if (any_exec.client) {
+    return any_exec.client.get();
+  }
+  return any_exec.waitable.get();
+}
+
+}  // namespace
+
+PriorityExecutor::PriorityExecutor(const rclcpp::executor::ExecutorArgs & args)
+: executor::Executor(args) {}
+
+PriorityExecutor::~PriorityExecutor() {}
+
+void
+PriorityExecutor::spin()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin() called while already spinning");
+  }
+  RCLCPP_SCOPE_EXIT(this->spinning.store(false); this->clear_queues(); );
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    execute_next_prioritized(std::chrono::nanoseconds(-1));
+  }
+}
+
+void
+PriorityExecutor::spin_some(std::chrono::nanoseconds max_duration)
+{
+  auto start = std::chrono::steady_clock::now();
+  auto max_duration_not_elapsed = [max_duration, start]() {
+      if (std::chrono::nanoseconds(0) == max_duration) {
+        // told to spin forever if need be
+        return true;
+      } else if (std::chrono::steady_clock::now() - start < max_duration) {
+        // told to spin only for some maximum amount of time
+        return true;
+      }
+      // spun too long
+      return false;
+    };
+
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin_some() called while already spinning");
+  }
+  RCLCPP_SCOPE_EXIT(this->spinning.store(false); this->clear_queues(); );
+  wait_for_work(std::chrono::milliseconds::zero());
+  collect_ready_executables();
+  while (spinning.load() && max_duration_not_elapsed()) {
+    AnyExecutablePtr any_exec = pop_next_executable();
+    if (!any_exec) {
+      break;
+    }
+    execute_any_executable(*any_exec);
+    // Executing may have freed a mutually exclusive group, take what it was blocking.
+    collect_ready_executables();
+  }
+}
+
+void
+PriorityExecutor::spin_once(std::chrono::nanoseconds timeout)
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin_once() called while already spinning");
+  }
+  RCLCPP_SCOPE_EXIT(this->spinning.store(false); this->clear_queues(); );
+  execute_next_prioritized(timeout);
+}
+
+size_t
+PriorityExecutor::get_queue_depth(int priority) const
+{
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  auto it = levels_.find(priority);
+  if (it == levels_.end()) {
+    return 0;
+  }
+  return it->second.depth;
+}
+
+std::map<int, size_t>
+PriorityExecutor::get_queue_depths() const
+{
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  std::map<int, size_t> depths;
+  for (auto & level : levels_) {
+    depths[level.first] = level.second.depth;
+  }
+  return depths;
+}
+
+bool
+PriorityExecutor::execute_next_prioritized(std::chrono::nanoseconds timeout)
+{
+  bool has_queued_work;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    has_queued_work = !levels_.empty();
+  }
+  // With queued work only poll, so higher priority work which became ready is seen.
+  wait_for_work(has_queued_work ? std::chrono::nanoseconds(0) : timeout);
+  collect_ready_executables();
+
+  AnyExecutablePtr any_exec = pop_next_executable();
+  if (!any_exec) {
+    return false;
+  }
+  execute_any_executable(*any_exec);
+  return true;
+}
+
+void
+PriorityExecutor::collect_ready_executables()
+{
+  while (true) {
+    AnyExecutablePtr any_exec(new AnyExecutable());
+    if (!get_next_ready_executable(*any_exec)) {
+      break;
+    }
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    if (!queued_entities_.insert(get_entity(*any_exec)).second) {
+      // Already queued, destroying any_exec resets its (reentrant) callback group.
+      continue;
+    }
+    CallbackGroupKey group = any_exec->callback_group.get();
+    PriorityLevel & level = levels_[any_exec->callback_group->get_priority()];
+    auto & group_queue = level.group_queues[group];
+    if (group_queue.empty()) {
+      level.group_rotation.push_back(group);
+    }
+    group_queue.push_back(std::move(any_exec));
+    level.depth++;
+  }
+}
+
+PriorityExecutor::AnyExecutablePtr
+PriorityExecutor::pop_next_executable()
+{
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  if (levels_.empty()) {
+    return nullptr;
+  }
+  // levels_ is sorted by descending priority.
+  auto level_it = levels_.begin();
+  PriorityLevel & level = level_it->second;
+  CallbackGroupKey group = level.group_rotation.front();
+  level.group_rotation.pop_front();
+  auto queue_it = level.group_queues.find(group);
+  AnyExecutablePtr any_exec = std::move(queue_it->second.front());
+  queue_it->second.pop_front();
+  if (queue_it->second.empty()) {
+    level.group_queues.erase(queue_it);
+  } else {
+    // Serve the other groups of this priority before coming back to this one.
+    level.group_rotation.push_back(group);
+  }
+  if (--level.depth == 0) {
+    levels_.erase(level_it);
+  }
+  queued_entities_.erase(get_entity(*any_exec));
+  return any_exec;
+}
+
+void
+PriorityExecutor::clear_queues()
+{
+  // Work which was taken but not executed is discarded, resetting its callback group.
+  // The entities are still ready and are taken again by the next wait.
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  levels_.clear();
+  queued_entities_.clear();
+}
@@ -119,7 +119,7 @@ StaticExecutorEntitiesCollector::fill_executable_list()
       group->find_subscription_ptrs_if(
         [this](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
           if (subscription) {
-            exec_list_.add_subscription(subscription);
+            exec_list_.add_collected_subscription(subscription);
           }
           return false;
         });
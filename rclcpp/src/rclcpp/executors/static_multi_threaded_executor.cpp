@@ -0,0 +1,504 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executors/static_multi_threaded_executor.hpp"
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rcl/error_handling.h"
+
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/realtime.hpp"
+#include "rclcpp/scope_exit.hpp"
+#include "rclcpp/thread_options.hpp"
+#include "rclcpp/utilities.hpp"
+
+#include "rcutils/logging_macros.h"
+
+using rclcpp::executors::StaticMultiThreadedExecutor;
+using rclcpp::executor::ExecutableList;
+
+StaticMultiThreadedExecutor::StaticMultiThreadedExecutor(
+  const rclcpp::executor::ExecutorArgs & args,
+  size_t number_of_threads)
+: executor::Executor(args),
+  generation_(0),
+  entities_need_rebuild_(true)
+{
+  number_of_threads_ = number_of_threads ? number_of_threads : std::thread::hardware_concurrency();
+  if (number_of_threads_ == 0) {
+    number_of_threads_ = 1;
+  }
+
+  rcl_allocator_t allocator = memory_strategy_->get_allocator();
+  for (size_t i = 0; i < number_of_threads_; ++i) {
+    thread_states_.emplace_back(new ThreadState());
+    ThreadState & state = *thread_states_.back();
+    if (0 == i) {
+      // The first thread is the one calling spin(), it uses the executor's own handles.
+      state.wait_set = &wait_set_;
+      state.interrupt_guard_condition = &interrupt_guard_condition_;
+      continue;
+    }
+    rcl_ret_t ret = rcl_guard_condition_init(
+      &state.owned_interrupt_guard_condition, context_->get_rcl_context().get(),
+      rcl_guard_condition_get_default_options());
+    if (RCL_RET_OK != ret) {
+      throw_from_rcl_error(ret, "Failed to create interrupt guard condition in executor thread");
+    }
+    state.interrupt_guard_condition = &state.owned_interrupt_guard_condition;
+    context_->add_interrupt_guard_condition(state.interrupt_guard_condition);
+    ret = rcl_wait_set_init(
+      &state.owned_wait_set, 0, 1, 0, 0, 0, 0, context_->get_rcl_context().get(), allocator);
+    if (RCL_RET_OK != ret) {
+      throw_from_rcl_error(ret, "Failed to create wait set in executor thread");
+    }
+    state.wait_set = &state.owned_wait_set;
+  }
+}
+
+StaticMultiThreadedExecutor::~StaticMultiThreadedExecutor()
+{
+  for (size_t i = 1; i < thread_states_.size(); ++i) {
+    ThreadState & state = *thread_states_[i];
+    if (state.interrupt_guard_condition) {
+      context_->remove_interrupt_guard_condition(state.interrupt_guard_condition);
+    }
+    if (rcl_wait_set_fini(&state.owned_wait_set) != RCL_RET_OK) {
+      RCUTILS_LOG_ERROR_NAMED(
+        "rclcpp",
+        "failed to destroy wait set: %s", rcl_get_error_string().str);
+      rcl_reset_error();
+    }
+    if (rcl_guard_condition_fini(&state.owned_interrupt_guard_condition) != RCL_RET_OK) {
+      RCUTILS_LOG_ERROR_NAMED(
+        "rclcpp",
+        "failed to destroy guard condition: %s", rcl_get_error_string().str);
+      rcl_reset_error();
+    }
+  }
+}
+
+void
+StaticMultiThreadedExecutor::spin()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin() called while already spinning");
+  }
+  std::vector<std::thread> threads;
+  RCLCPP_SCOPE_EXIT(this->stop_threads(threads); );
+  rebuild_executable_lists();
+
+  {
+    // The threads block on the entities mutex, so they are configured before they execute
+    // anything.
+    std::lock_guard<std::mutex> lock(entities_mutex_);
+    for (size_t thread_id = 1; thread_id < number_of_threads_; ++thread_id) {
+      auto func = std::bind(&StaticMultiThreadedExecutor::run, this, thread_id);
+      threads.emplace_back(func);
+      rclcpp::apply_thread_options(threads.back(), get_thread_options(thread_id));
+    }
+    rclcpp::apply_thread_options_to_current_thread(get_thread_options(0));
+  }
+  run(0);
+}
+
+void
+StaticMultiThreadedExecutor::add_node(
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr, bool notify)
+{
+  Executor::add_node(node_ptr, notify);
+  entities_need_rebuild_.store(true);
+}
+
+void
+StaticMultiThreadedExecutor::add_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify)
+{
+  this->add_node(node_ptr->get_node_base_interface(), notify);
+}
+
+void
+StaticMultiThreadedExecutor::remove_node(
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_ptr, bool notify)
+{
+  Executor::remove_node(node_ptr, notify);
+  entities_need_rebuild_.store(true);
+}
+
+void
+StaticMultiThreadedExecutor::remove_node(std::shared_ptr<rclcpp::Node> node_ptr, bool notify)
+{
+  this->remove_node(node_ptr->get_node_base_interface(), notify);
+}
+
+size_t
+StaticMultiThreadedExecutor::get_number_of_threads()
+{
+  return number_of_threads_;
+}
+
+void
+StaticMultiThreadedExecutor::assign_callback_group_to_thread(
+  rclcpp::callback_group::CallbackGroup::SharedPtr group, size_t thread)
+{
+  if (!group) {
+    throw std::invalid_argument("group is nullptr");
+  }
+  if (thread >= number_of_threads_) {
+    throw std::invalid_argument(
+            "thread " + std::to_string(thread) + " is out of range, the executor has " +
+            std::to_string(number_of_threads_) + " threads");
+  }
+  {
+    std::lock_guard<std::mutex> lock(entities_mutex_);
+    auto it = group_assignments_.find(group.get());
+    if (it != group_assignments_.end() && !it->second.group.expired()) {
+      if (it->second.thread == thread) {
+        return;
+      }
+      // Its old thread may still be executing it, moving it could run the group concurrently.
+      if (spinning.load()) {
+        throw std::runtime_error("cannot move a callback group to another thread while spinning");
+      }
+    }
+    group_assignments_[group.get()] = GroupAssignment{group, thread};
+  }
+  entities_need_rebuild_.store(true);
+  // Wake the first thread, which rebuilds the executable lists.
+  if (rcl_trigger_guard_condition(&interrupt_guard_condition_) != RCL_RET_OK) {
+    throw std::runtime_error(rcl_get_error_string().str);
+  }
+}
+
+size_t
+StaticMultiThreadedExecutor::get_thread_of_callback_group(
+  rclcpp::callback_group::CallbackGroup::SharedPtr group)
+{
+  std::lock_guard<std::mutex> lock(entities_mutex_);
+  auto it = group_assignments_.find(group.get());
+  if (it == group_assignments_.end() || it->second.group.expired()) {
+    return number_of_threads_;
+  }
+  return it->second.thread;
+}
+
+void
+StaticMultiThreadedExecutor::rebuild_executable_lists()
+{
+  std::lock_guard<std::mutex> lock(entities_mutex_);
+  entities_need_rebuild_.store(false);
+
+  // Forget groups which were destroyed, their address may be reused by a new group.
+  std::vector<size_t> groups_per_thread(number_of_threads_, 0);
+  for (auto it = group_assignments_.begin(); it != group_assignments_.end(); ) {
+    if (it->second.group.expired()) {
+      it = group_assignments_.erase(it);
+    } else {
+      groups_per_thread[it->second.thread]++;
+      ++it;
+    }
+  }
+
+  std::vector<ExecutableList> exec_lists(number_of_threads_);
+  bool has_invalid_weak_nodes = false;
+  for (auto & weak_node : weak_nodes_) {
+    auto node = weak_node.lock();
+    if (!node) {
+      has_invalid_weak_nodes = true;
+      continue;
+    }
+    for (auto & weak_group : node->get_callback_groups()) {
+      auto group = weak_group.lock();
+      if (!group) {
+        continue;
+      }
+      auto it = group_assignments_.find(group.get());
+      if (it == group_assignments_.end()) {
+        // New groups go to the thread with the least groups, and stay there.
+        size_t thread = 0;
+        for (size_t i = 1; i < number_of_threads_; ++i) {
+          if (groups_per_thread[i] < groups_per_thread[thread]) {
+            thread = i;
+          }
+        }
+        groups_per_thread[thread]++;
+        it = group_assignments_.emplace(group.get(), GroupAssignment{group, thread}).first;
+      }
+      ExecutableList & exec_list = exec_lists[it->second.thread];
+
+      group->find_timer_ptrs_if(
+        [&exec_list](const rclcpp::TimerBase::SharedPtr & timer) {
+          exec_list.add_timer(timer);
+          return false;
+        });
+      group->find_subscription_ptrs_if(
+        [&exec_list](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
+          exec_list.add_collected_subscription(subscription);
+          return false;
+        });
+      group->find_service_ptrs_if(
+        [&exec_list](const rclcpp::ServiceBase::SharedPtr & service) {
+          exec_list.add_service(service);
+          return false;
+        });
+      group->find_client_ptrs_if(
+        [&exec_list](const rclcpp::ClientBase::SharedPtr & client) {
+          exec_list.add_client(client);
+          return false;
+        });
+      group->find_waitable_ptrs_if(
+        [&exec_list](const rclcpp::Waitable::SharedPtr & waitable) {
+          exec_list.add_waitable(waitable);
+          return false;
+        });
+    }
+  }
+
+  // Clean up any invalid nodes, if they were detected
+  if (has_invalid_weak_nodes) {
+    auto node_it = weak_nodes_.begin();
+    auto gc_it = guard_conditions_.begin();
+    while (node_it != weak_nodes_.end()) {
+      if (node_it->expired()) {
+        node_it = weak_nodes_.erase(node_it);
+        memory_strategy_->remove_guard_condition(*gc_it);
+        gc_it = guard_conditions_.erase(gc_it);
+      } else {
+        ++node_it;
+        ++gc_it;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < number_of_threads_; ++i) {
+    thread_states_[i]->pending_exec_list = std::move(exec_lists[i]);
+  }
+  ++generation_;
+  // The other threads pick up their new list when they wake up.
+  interrupt_threads();
+}
+
+void
+StaticMultiThreadedExecutor::apply_pending_exec_list(
+  ThreadState & state, size_t this_thread_number)
+{
+  {
+    std::lock_guard<std::mutex> lock(entities_mutex_);
+    if (state.generation == generation_) {
+      return;
+    }
+    state.exec_list = std::move(state.pending_exec_list);
+    state.pending_exec_list = ExecutableList();
+    state.generation = generation_;
+  }
+  state.number_of_node_guard_conditions = 0 == this_thread_number ? guard_conditions_.size() : 0;
+
+  // Only the first thread waits on the notify guard conditions of the nodes.
+  size_t number_of_guard_conditions = 1 + state.number_of_node_guard_conditions;
+  size_t number_of_subscriptions = state.exec_list.number_of_subscriptions;
+  size_t number_of_timers = state.exec_list.number_of_timers;
+  size_t number_of_clients = state.exec_list.number_of_clients;
+  size_t number_of_services = state.exec_list.number_of_services;
+  size_t number_of_events = 0;
+  for (auto & waitable : state.exec_list.waitable) {
+    number_of_subscriptions += waitable->get_number_of_ready_subscriptions();
+    number_of_guard_conditions += waitable->get_number_of_ready_guard_conditions();
+    number_of_timers += waitable->get_number_of_ready_timers();
+    number_of_clients += waitable->get_number_of_ready_clients();
+    number_of_services += waitable->get_number_of_ready_services();
+    number_of_events += waitable->get_number_of_ready_events();
+  }
+  rcl_ret_t ret = rcl_wait_set_resize(
+    state.wait_set, number_of_subscriptions, number_of_guard_conditions, number_of_timers,
+    number_of_clients, number_of_services, number_of_events);
+  if (RCL_RET_OK != ret) {
+    throw std::runtime_error(
+            std::string("Couldn't resize the wait set : ") + rcl_get_error_string().str);
+  }
+}
+
+bool
+StaticMultiThreadedExecutor::fill_wait_set(ThreadState & state, size_t this_thread_number)
+{
+  if (rcl_wait_set_clear(state.wait_set) != RCL_RET_OK) {
+    throw std::runtime_error("Couldn't clear wait set");
+  }
+  if (rcl_wait_set_add_guard_condition(state.wait_set, state.interrupt_guard_condition, NULL) !=
+    RCL_RET_OK)
+  {
+    throw std::runtime_error(
+            std::string("Couldn't add guard condition to wait set: ") + rcl_get_error_string().str);
+  }
+  if (0 == this_thread_number) {
+    for (auto & weak_node : weak_nodes_) {
+      // A destroyed node finalized its notify guard condition.
+      if (weak_node.expired()) {
+        return false;
+      }
+    }
+    // Nodes added since the last rebuild are picked up by the next one, the wait set was only
+    // sized for the guard conditions known back then.
+    if (guard_conditions_.size() < state.number_of_node_guard_conditions) {
+      state.number_of_node_guard_conditions = guard_conditions_.size();
+    }
+    auto gc_it = guard_conditions_.begin();
+    for (size_t i = 0; i < state.number_of_node_guard_conditions; ++i, ++gc_it) {
+      if (rcl_wait_set_add_guard_condition(state.wait_set, *gc_it, NULL) != RCL_RET_OK) {
+        throw std::runtime_error(
+                std::string("Couldn't add guard condition to wait set: ") +
+                rcl_get_error_string().str);
+      }
+    }
+  }
+
+  // Entities are added in the order of the executable list, so index i in the wait set
+  // corresponds to index i in the list.
+  for (auto & subscription : state.exec_list.subscription) {
+    if (
+      rcl_wait_set_add_subscription(
+        state.wait_set, subscription->get_subscription_handle().get(), NULL) != RCL_RET_OK)
+    {
+      throw std::runtime_error(
+              std::string("Couldn't add subscription to wait set: ") +
+              rcl_get_error_string().str);
+    }
+  }
+  for (auto & timer : state.exec_list.timer) {
+    if (rcl_wait_set_add_timer(state.wait_set, timer->get_timer_handle().get(), NULL) !=
+      RCL_RET_OK)
+    {
+      throw std::runtime_error(
+              std::string("Couldn't add timer to wait set: ") + rcl_get_error_string().str);
+    }
+  }
+  for (auto & service : state.exec_list.service) {
+    if (rcl_wait_set_add_service(state.wait_set, service->get_service_handle().get(), NULL) !=
+      RCL_RET_OK)
+    {
+      throw std::runtime_error(
+              std::string("Couldn't add service to wait set: ") + rcl_get_error_string().str);
+    }
+  }
+  for (auto & client : state.exec_list.client) {
+    if (rcl_wait_set_add_client(state.wait_set, client->get_client_handle().get(), NULL) !=
+      RCL_RET_OK)
+    {
+      throw std::runtime_error(
+              std::string("Couldn't add client to wait set: ") + rcl_get_error_string().str);
+    }
+  }
+  for (auto & waitable : state.exec_list.waitable) {
+    if (!waitable->add_to_wait_set(state.wait_set)) {
+      throw std::runtime_error("Couldn't add waitable to wait set");
+    }
+  }
+  return true;
+}
+
+void
+StaticMultiThreadedExecutor::execute_ready_executables(ThreadState & state)
+{
+  rcl_wait_set_t * wait_set = state.wait_set;
+  ExecutableList & exec_list = state.exec_list;
+  for (size_t i = 0; i < exec_list.number_of_timers; ++i) {
+    if (wait_set->timers[i] && exec_list.timer[i]->is_ready()) {
+      execute_timer(exec_list.timer[i]);
+    }
+  }
+  for (size_t i = 0; i < exec_list.number_of_subscriptions; ++i) {
+    if (wait_set->subscriptions[i]) {
+      execute_subscription(exec_list.subscription[i]);
+    }
+  }
+  for (size_t i = 0; i < exec_list.number_of_services; ++i) {
+    if (wait_set->services[i]) {
+      execute_service(exec_list.service[i]);
+    }
+  }
+  for (size_t i = 0; i < exec_list.number_of_clients; ++i) {
+    if (wait_set->clients[i]) {
+      execute_client(exec_list.client[i]);
+    }
+  }
+  for (size_t i = 0; i < exec_list.number_of_waitables; ++i) {
+    if (exec_list.waitable[i]->is_ready(wait_set)) {
+      exec_list.waitable[i]->execute();
+    }
+  }
+}
+
+void
+StaticMultiThreadedExecutor::run(size_t this_thread_number)
+{
+  ThreadState & state = *thread_states_[this_thread_number];
+  rclcpp::prefault_stack(get_thread_options(this_thread_number).stack_prefault_size);
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    if (0 == this_thread_number && entities_need_rebuild_.load()) {
+      rebuild_executable_lists();
+    }
+    apply_pending_exec_list(state, this_thread_number);
+    if (!fill_wait_set(state, this_thread_number)) {
+      entities_need_rebuild_.store(true);
+      continue;
+    }
+
+    rcl_ret_t status = rcl_wait(state.wait_set, -1);
+    if (status == RCL_RET_WAIT_SET_EMPTY) {
+      RCUTILS_LOG_WARN_NAMED(
+        "rclcpp",
+        "empty wait set received in rcl_wait(). This should never happen.");
+    } else if (status != RCL_RET_OK && status != RCL_RET_TIMEOUT) {
+      throw_from_rcl_error(status, "rcl_wait() failed");
+    }
+    if (!spinning.load()) {
+      break;
+    }
+
+    // The node guard conditions follow the interrupt guard condition.
+    for (size_t i = 1; i < 1 + state.number_of_node_guard_conditions; ++i) {
+      if (state.wait_set->guard_conditions[i]) {
+        entities_need_rebuild_.store(true);
+        break;
+      }
+    }
+    // The current list stays valid until this thread applies a new one, entities are kept
+    // alive by the list and their group is never moved to another thread.
+    execute_ready_executables(state);
+  }
+}
+
+void
+StaticMultiThreadedExecutor::interrupt_threads()
+{
+  for (size_t i = 1; i < thread_states_.size(); ++i) {
+    if (rcl_trigger_guard_condition(thread_states_[i]->interrupt_guard_condition) != RCL_RET_OK) {
+      throw std::runtime_error(rcl_get_error_string().str);
+    }
+  }
+}
+
+void
+StaticMultiThreadedExecutor::stop_threads(std::vector<std::thread> & threads)
+{
+  spinning.store(false);
+  interrupt_threads();
+  for (auto & thread : threads) {
+    thread.join();
+  }
+}
@@ -0,0 +1,231 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/executors/stepping_executor.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "rcl/time.h"
+
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/scope_exit.hpp"
+#include "rclcpp/utilities.hpp"
+
+using rclcpp::executors::SteppingExecutor;
+using rclcpp::executor::AnyExecutable;
+
+SteppingExecutor::SteppingExecutor(const rclcpp::executor::ExecutorArgs & args)
+: executor::Executor(args)
+{}
+
+SteppingExecutor::~SteppingExecutor() {}
+
+void
+SteppingExecutor::spin()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin() called while already spinning");
+  }
+  RCLCPP_SCOPE_EXIT(this->spinning.store(false); );
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    if (!step_until(nullptr)) {
+      // Nothing to step to, wait for work from outside of the simulation.
+      AnyExecutable any_exec;
+      if (get_next_executable(any_exec)) {
+        execute_any_executable(any_exec);
+      }
+    }
+  }
+}
+
+bool
+SteppingExecutor::step()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("step() called while already spinning");
+  }
+  RCLCPP_SCOPE_EXIT(this->spinning.store(false); );
+  return step_until(nullptr);
+}
+
+void
+SteppingExecutor::spin_until(const rclcpp::Time & end_time)
+{
+  rcl_time_point_value_t end = end_time.nanoseconds();
+  if (end < current_time_.load()) {
+    throw std::invalid_argument("end_time is earlier than the current time");
+  }
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin_until() called while already spinning");
+  }
+  RCLCPP_SCOPE_EXIT(this->spinning.store(false); );
+  while (rclcpp::ok(this->context_) && spinning.load() && step_until(&end)) {
+  }
+}
+
+rclcpp::Time
+SteppingExecutor::get_time() const
+{
+  return rclcpp::Time(current_time_.load(), RCL_ROS_TIME);
+}
+
+void
+SteppingExecutor::set_time(const rclcpp::Time & time)
+{
+  current_time_.store(time.nanoseconds());
+}
+
+void
+SteppingExecutor::add_clock(rclcpp::Clock::SharedPtr clock)
+{
+  if (!clock || clock->get_clock_type() != RCL_ROS_TIME) {
+    throw std::invalid_argument("the clock must be a ROS time clock");
+  }
+  std::lock_guard<std::mutex> lock(clocks_mutex_);
+  added_clocks_.push_back(clock);
+}
+
+void
+SteppingExecutor::execute_ready_work()
+{
+  AnyExecutable any_exec;
+  while (spinning.load() && get_next_executable(any_exec, std::chrono::nanoseconds(0))) {
+    execute_any_executable(any_exec);
+    any_exec = AnyExecutable();
+  }
+}
+
+std::vector<rclcpp::Clock::SharedPtr>
+SteppingExecutor::get_simulated_clocks()
+{
+  std::vector<rclcpp::Clock::SharedPtr> clocks;
+  auto add = [&clocks](const rclcpp::Clock::SharedPtr & clock) {
+      if (
+        clock && clock->get_clock_type() == RCL_ROS_TIME && clock->ros_time_is_active() &&
+        std::find(clocks.begin(), clocks.end(), clock) == clocks.end())
+      {
+        clocks.push_back(clock);
+      }
+    };
+  for (auto & weak_node : weak_nodes_) {
+    auto node = weak_node.lock();
+    if (!node) {
+      continue;
+    }
+    for (auto & weak_group : node->get_callback_groups()) {
+      auto group = weak_group.lock();
+      if (!group) {
+        continue;
+      }
+      group->find_timer_ptrs_if(
+        [&add](const rclcpp::TimerBase::SharedPtr & timer) {
+          add(timer->get_clock());
+          return false;
+        });
+    }
+  }
+  std::lock_guard<std::mutex> lock(clocks_mutex_);
+  auto expired = std::remove_if(
+    added_clocks_.begin(), added_clocks_.end(),
+    [](const rclcpp::Clock::WeakPtr & clock) {return clock.expired();});
+  added_clocks_.erase(expired, added_clocks_.end());
+  for (auto & weak_clock : added_clocks_) {
+    add(weak_clock.lock());
+  }
+  return clocks;
+}
+
+void
+SteppingExecutor::update_clocks(const std::vector<rclcpp::Clock::SharedPtr> & clocks)
+{
+  rcl_time_point_value_t time = current_time_.load();
+  for (auto & clock : clocks) {
+    std::lock_guard<std::mutex> clock_guard(clock->get_clock_mutex());
+    rcl_ret_t ret = rcl_set_ros_time_override(clock->get_clock_handle(), time);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to set the simulated time");
+    }
+  }
+}
+
+bool
+SteppingExecutor::get_next_deadline(
+  const std::vector<rclcpp::Clock::SharedPtr> & clocks, rcl_time_point_value_t & deadline)
+{
+  bool found = false;
+  rcl_time_point_value_t now = current_time_.load();
+  for (auto & weak_node : weak_nodes_) {
+    auto node = weak_node.lock();
+    if (!node) {
+      continue;
+    }
+    for (auto & weak_group : node->get_callback_groups()) {
+      auto group = weak_group.lock();
+      if (!group) {
+        continue;
+      }
+      group->find_timer_ptrs_if(
+        [&](const rclcpp::TimerBase::SharedPtr & timer) {
+          if (
+            timer->is_canceled() ||
+            std::find(clocks.begin(), clocks.end(), timer->get_clock()) == clocks.end())
+          {
+            return false;
+          }
+          rcl_time_point_value_t timer_deadline = now + timer->time_until_trigger().count();
+          if (!found || timer_deadline < deadline) {
+            deadline = timer_deadline;
+            found = true;
+          }
+          return false;
+        });
+    }
+  }
+  return found;
+}
+
+bool
+SteppingExecutor::step_until(const rcl_time_point_value_t * end_time)
+{
+  auto clocks = get_simulated_clocks();
+  update_clocks(clocks);
+  execute_ready_work();
+  if (!spinning.load()) {
+    return false;
+  }
+
+  rcl_time_point_value_t deadline = 0;
+  // A timer created by the work just executed may use a clock not found yet.
+  clocks = get_simulated_clocks();
+  bool found = get_next_deadline(clocks, deadline);
+  if (found && end_time && deadline > *end_time) {
+    found = false;
+  }
+  if (!found) {
+    if (end_time) {
+      current_time_.store(*end_time);
+      update_clocks(clocks);
+      execute_ready_work();
+    }
+    return false;
+  }
+  // The deadline of a timer executed late may be in the past, the time never goes back.
+  current_time_.store(std::max(deadline, current_time_.load()));
+  update_clocks(clocks);
+  return true;
+}
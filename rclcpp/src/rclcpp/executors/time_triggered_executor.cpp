@@ -0,0 +1,277 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executors/time_triggered_executor.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "rcl/error_handling.h"
+#include "rcl/wait.h"
+
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/scope_exit.hpp"
+#include "rclcpp/utilities.hpp"
+
+using rclcpp::executors::TimeTriggeredExecutor;
+
+TimeTriggeredExecutor::TimeTriggeredExecutor(const rclcpp::executor::ExecutorArgs & args)
+: executor::Executor(args),
+  spin_threshold_(0),
+  skipped_major_frames_(0)
+{}
+
+TimeTriggeredExecutor::~TimeTriggeredExecutor() {}
+
+void
+TimeTriggeredExecutor::spin()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin() called while already spinning");
+  }
+  RCLCPP_SCOPE_EXIT(this->spinning.store(false); );
+  if (frames_.empty()) {
+    throw std::runtime_error("spin() called with a schedule without minor frames");
+  }
+
+  // Only the guard condition waking up the executor is waited on.
+  rcl_ret_t ret = rcl_wait_set_resize(&wait_set_, 0, 1, 0, 0, 0, 0);
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "Couldn't resize the wait set");
+  }
+
+  for (auto & frame : frames_) {
+    for (auto & timer : frame.executables.timer) {
+      timer->reset();
+    }
+  }
+
+  const std::chrono::nanoseconds major_frame = get_major_frame_duration();
+  auto major_frame_start = std::chrono::steady_clock::now();
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    auto lateness = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - major_frame_start);
+    if (lateness >= major_frame) {
+      auto skipped = lateness / major_frame;
+      major_frame_start += skipped * major_frame;
+      std::lock_guard<std::mutex> lock(statistics_mutex_);
+      skipped_major_frames_ += static_cast<size_t>(skipped);
+    }
+
+    auto frame_start = major_frame_start;
+    for (size_t i = 0; i < frames_.size(); ++i) {
+      auto frame_end = frame_start + frames_[i].duration;
+      if (!wait_until(frame_start)) {
+        return;
+      }
+      execute_minor_frame(i);
+      record_frame(i, frame_start, frame_end, std::chrono::steady_clock::now());
+      frame_start = frame_end;
+    }
+    major_frame_start = frame_start;
+  }
+}
+
+size_t
+TimeTriggeredExecutor::add_minor_frame(std::chrono::nanoseconds duration)
+{
+  if (duration <= std::chrono::nanoseconds::zero()) {
+    throw std::invalid_argument("the duration of a minor frame must be positive");
+  }
+  check_not_spinning();
+  frames_.emplace_back();
+  frames_.back().duration = duration;
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  frame_statistics_.emplace_back();
+  return frames_.size() - 1;
+}
+
+void
+TimeTriggeredExecutor::add_timer(size_t minor_frame, rclcpp::TimerBase::SharedPtr timer)
+{
+  if (!timer) {
+    throw std::invalid_argument("timer is nullptr");
+  }
+  check_not_spinning();
+  auto & frame = frames_.at(minor_frame);
+  frame.slots.push_back(Slot {EntityType::Timer, frame.executables.number_of_timers});
+  frame.executables.add_timer(std::move(timer));
+}
+
+void
+TimeTriggeredExecutor::add_subscription(
+  size_t minor_frame, rclcpp::SubscriptionBase::SharedPtr subscription)
+{
+  if (!subscription) {
+    throw std::invalid_argument("subscription is nullptr");
+  }
+  check_not_spinning();
+  auto & frame = frames_.at(minor_frame);
+  frame.slots.push_back(
+    Slot {EntityType::Subscription, frame.executables.number_of_subscriptions});
+  frame.executables.add_subscription(std::move(subscription));
+}
+
+void
+TimeTriggeredExecutor::clear_schedule()
+{
+  check_not_spinning();
+  frames_.clear();
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  frame_statistics_.clear();
+}
+
+size_t
+TimeTriggeredExecutor::get_number_of_minor_frames() const
+{
+  return frames_.size();
+}
+
+std::chrono::nanoseconds
+TimeTriggeredExecutor::get_major_frame_duration() const
+{
+  std::chrono::nanoseconds duration(0);
+  for (const auto & frame : frames_) {
+    duration += frame.duration;
+  }
+  return duration;
+}
+
+void
+TimeTriggeredExecutor::set_spin_threshold(std::chrono::nanoseconds spin_threshold)
+{
+  spin_threshold_ = spin_threshold;
+}
+
+void
+TimeTriggeredExecutor::set_frame_overrun_callback(FrameOverrunCallback callback)
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  overrun_callback_ = std::move(callback);
+}
+
+TimeTriggeredExecutor::FrameStatistics
+TimeTriggeredExecutor::get_frame_statistics(size_t minor_frame) const
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  return frame_statistics_.at(minor_frame);
+}
+
+size_t
+TimeTriggeredExecutor::get_number_of_frame_overruns() const
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  size_t overruns = 0;
+  for (const auto & statistics : frame_statistics_) {
+    overruns += statistics.overrun_count;
+  }
+  return overruns;
+}
+
+size_t
+TimeTriggeredExecutor::get_number_of_skipped_major_frames() const
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  return skipped_major_frames_;
+}
+
+void
+TimeTriggeredExecutor::execute_minor_frame(size_t minor_frame)
+{
+  auto & frame = frames_[minor_frame];
+  for (const auto & slot : frame.slots) {
+    if (EntityType::Timer == slot.type) {
+      const auto & timer = frame.executables.timer[slot.index];
+      if (timer->is_ready()) {
+        execute_timer(timer);
+      }
+    } else {
+      execute_subscription(frame.executables.subscription[slot.index]);
+    }
+  }
+}
+
+bool
+TimeTriggeredExecutor::wait_until(std::chrono::steady_clock::time_point time_point)
+{
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    auto time_to_wait = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      time_point - spin_threshold_ - std::chrono::steady_clock::now());
+    if (time_to_wait <= std::chrono::nanoseconds::zero()) {
+      break;
+    }
+    if (rcl_wait_set_clear(&wait_set_) != RCL_RET_OK) {
+      throw std::runtime_error("Couldn't clear wait set");
+    }
+    if (
+      rcl_wait_set_add_guard_condition(&wait_set_, &interrupt_guard_condition_, NULL) !=
+      RCL_RET_OK)
+    {
+      throw std::runtime_error(
+              std::string("Couldn't add guard condition to wait set: ") +
+              rcl_get_error_string().str);
+    }
+    // Woken up early by a guard condition, e.g. a node was added, which is not a reason to start
+    // the frame: the loop waits again unless the executor stopped.
+    rcl_ret_t status = rcl_wait(&wait_set_, time_to_wait.count());
+    if (RCL_RET_OK != status && RCL_RET_TIMEOUT != status) {
+      rclcpp::exceptions::throw_from_rcl_error(status, "rcl_wait() failed");
+    }
+  }
+  // The sleep may end late by the granularity of the OS, so the last part of the wait spins.
+  while (std::chrono::steady_clock::now() < time_point) {
+    if (!spinning.load()) {
+      return false;
+    }
+  }
+  return rclcpp::ok(this->context_) && spinning.load();
+}
+
+void
+TimeTriggeredExecutor::check_not_spinning() const
+{
+  if (spinning.load()) {
+    throw std::runtime_error("the schedule can't be changed while the executor is spinning");
+  }
+}
+
+void
+TimeTriggeredExecutor::record_frame(
+  size_t minor_frame,
+  std::chrono::steady_clock::time_point start,
+  std::chrono::steady_clock::time_point end,
+  std::chrono::steady_clock::time_point now)
+{
+  auto execution_time = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start);
+  auto overrun = std::chrono::duration_cast<std::chrono::nanoseconds>(now - end);
+  FrameOverrunCallback callback;
+  {
+    std::lock_guard<std::mutex> lock(statistics_mutex_);
+    auto & statistics = frame_statistics_[minor_frame];
+    ++statistics.count;
+    statistics.max_execution_time = std::max(statistics.max_execution_time, execution_time);
+    if (overrun <= std::chrono::nanoseconds::zero()) {
+      return;
+    }
+    ++statistics.overrun_count;
+    statistics.max_overrun = std::max(statistics.max_overrun, overrun);
+    callback = overrun_callback_;
+  }
+  if (callback) {
+    callback(minor_frame, overrun);
+  }
+}
@@ -0,0 +1,478 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/executors/work_stealing_multi_threaded_executor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/scope_exit.hpp"
+#include "rclcpp/utilities.hpp"
+
+using rclcpp::executors::WorkStealingMultiThreadedExecutor;
+
+namespace
+{
+
+/// The executor and the number of the worker running on this thread, if any.
+struct CurrentWorker
+{
+  const WorkStealingMultiThreadedExecutor * executor = nullptr;
+  size_t thread_number = 0;
+};
+
+thread_local CurrentWorker g_current_worker;
+
+/// Longest time the waiter waits for an in-flight entity before polling the other entities.
+constexpr std::chrono::milliseconds g_in_flight_poll_period(1);
+
+}  // namespace
+
+WorkStealingMultiThreadedExecutor::WorkStealingMultiThreadedExecutor(
+  const rclcpp::executor::ExecutorArgs & args,
+  size_t number_of_threads,
+  std::chrono::nanoseconds next_exec_timeout)
+: executor::Executor(args),
+  next_exec_timeout_(next_exec_timeout),
+  next_queue_(0),
+  number_of_queued_(0),
+  number_of_tasks_(0),
+  next_task_queue_(0),
+  number_of_steals_(0),
+  number_of_completions_(0)
+{
+  number_of_threads_ = number_of_threads ? number_of_threads : std::thread::hardware_concurrency();
+  if (number_of_threads_ == 0) {
+    number_of_threads_ = 1;
+  }
+  for (size_t i = 0; i < number_of_threads_; ++i) {
+    queues_.emplace_back(new WorkQueue());
+  }
+}
+
+WorkStealingMultiThreadedExecutor::~WorkStealingMultiThreadedExecutor() {}
+
+void
+WorkStealingMultiThreadedExecutor::spin()
+{
+  if (spinning.exchange(true)) {
+    throw std::runtime_error("spin() called while already spinning");
+  }
+  std::vector<std::thread> threads;
+  // Also stop the workers when the waiter loop throws.
+  RCLCPP_SCOPE_EXIT(this->stop_workers(threads); );
+  for (size_t thread_id = 0; thread_id < number_of_threads_; ++thread_id) {
+    auto func = std::bind(&WorkStealingMultiThreadedExecutor::run, this, thread_id);
+    threads.emplace_back(func);
+  }
+
+  wait_and_distribute();
+}
+
+void
+WorkStealingMultiThreadedExecutor::stop_workers(std::vector<std::thread> & threads)
+{
+  spinning.store(false);
+  {
+    std::lock_guard<std::mutex> lock(work_mutex_);
+  }
+  work_cv_.notify_all();
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  // Work which was distributed but not executed is discarded, resetting its callback group.
+  // The tasks are kept, a caller of parallel_for() may be waiting for them.
+  for (auto & queue : queues_) {
+    queue->executables.clear();
+    queue->assigned_executables.clear();
+    queue->number_of_assigned.store(0);
+  }
+  number_of_queued_.store(0);
+  std::lock_guard<std::mutex> lock(in_flight_mutex_);
+  in_flight_.clear();
+}
+
+size_t
+WorkStealingMultiThreadedExecutor::get_number_of_threads()
+{
+  return number_of_threads_;
+}
+
+size_t
+WorkStealingMultiThreadedExecutor::get_number_of_steals() const
+{
+  return number_of_steals_.load();
+}
+
+void
+WorkStealingMultiThreadedExecutor::assign_callback_group_to_thread(
+  rclcpp::callback_group::CallbackGroup::SharedPtr group,
+  size_t thread_index)
+{
+  if (thread_index >= number_of_threads_) {
+    throw std::out_of_range("thread_index is not the index of a worker thread");
+  }
+  if (spinning.load()) {
+    throw std::runtime_error(
+            "assign_callback_group_to_thread() called while spinning");
+  }
+  // Forget the groups which were destroyed, their address may be reused.
+  for (auto it = group_assignments_.begin(); it != group_assignments_.end(); ) {
+    if (it->second.group.expired()) {
+      it = group_assignments_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  group_assignments_[group.get()] = GroupAssignment{group, thread_index};
+}
+
+size_t
+WorkStealingMultiThreadedExecutor::get_assigned_thread(
+  const rclcpp::callback_group::CallbackGroup::SharedPtr & group) const
+{
+  auto it = group_assignments_.find(group.get());
+  if (it == group_assignments_.end() || it->second.group.lock() != group) {
+    return number_of_threads_;
+  }
+  return it->second.thread_index;
+}
+
+std::future<void>
+WorkStealingMultiThreadedExecutor::submit(std::function<void()> task)
+{
+  if (!task) {
+    throw std::invalid_argument("task is empty");
+  }
+  auto packaged_task = std::make_shared<std::packaged_task<void()>>(std::move(task));
+  std::future<void> future = packaged_task->get_future();
+  std::vector<Task> tasks;
+  tasks.emplace_back([packaged_task]() {(*packaged_task)();});
+  push_tasks(tasks);
+  return future;
+}
+
+void
+WorkStealingMultiThreadedExecutor::parallel_for(
+  size_t begin, size_t end, size_t grain_size,
+  const std::function<void(size_t, size_t)> & body)
+{
+  if (begin >= end) {
+    return;
+  }
+  size_t count = end - begin;
+  if (grain_size == 0) {
+    grain_size = (count + number_of_threads_ - 1) / number_of_threads_;
+  }
+  size_t number_of_chunks = (count - 1) / grain_size + 1;
+
+  struct State
+  {
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t remaining;
+    std::exception_ptr error;
+  };
+  auto state = std::make_shared<State>();
+  state->remaining = number_of_chunks;
+  // The body outlives the chunks, this call returns once they were all executed.
+  auto run_chunk = [state, &body](size_t chunk_begin, size_t chunk_end) {
+      std::exception_ptr error;
+      try {
+        body(chunk_begin, chunk_end);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (error && !state->error) {
+        state->error = error;
+      }
+      if (--state->remaining == 0) {
+        state->done.notify_all();
+      }
+    };
+
+  std::vector<Task> tasks;
+  for (size_t chunk_begin = begin + grain_size; chunk_begin < end; chunk_begin += grain_size) {
+    size_t chunk_end = chunk_begin + std::min(grain_size, end - chunk_begin);
+    tasks.emplace_back([run_chunk, chunk_begin, chunk_end]() {run_chunk(chunk_begin, chunk_end);});
+  }
+  push_tasks(tasks);
+  run_chunk(begin, begin + std::min(grain_size, count));
+
+  size_t this_thread_number = get_current_thread_number() % number_of_threads_;
+  std::unique_lock<std::mutex> lock(state->mutex);
+  while (state->remaining > 0) {
+    lock.unlock();
+    Task task;
+    bool popped = pop_or_steal_task(this_thread_number, task);
+    if (popped) {
+      task();
+    }
+    lock.lock();
+    if (!popped) {
+      // The chunks left are executed by other threads.
+      state->done.wait(lock, [&state]() {return state->remaining == 0;});
+    }
+  }
+  if (state->error) {
+    std::rethrow_exception(state->error);
+  }
+}
+
+void
+WorkStealingMultiThreadedExecutor::push_tasks(std::vector<Task> & tasks)
+{
+  if (tasks.empty()) {
+    return;
+  }
+  size_t queue_number = get_current_thread_number();
+  if (queue_number == number_of_threads_) {
+    queue_number = next_task_queue_.fetch_add(1) % number_of_threads_;
+  }
+  {
+    WorkQueue & queue = *queues_[queue_number];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    for (auto & task : tasks) {
+      queue.tasks.push_back(std::move(task));
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(work_mutex_);
+    number_of_tasks_ += tasks.size();
+  }
+  if (tasks.size() == 1) {
+    work_cv_.notify_one();
+  } else {
+    work_cv_.notify_all();
+  }
+  tasks.clear();
+}
+
+bool
+WorkStealingMultiThreadedExecutor::pop_or_steal_task(size_t this_thread_number, Task & task)
+{
+  if (number_of_tasks_.load() == 0) {
+    return false;
+  }
+  {
+    WorkQueue & own_queue = *queues_[this_thread_number];
+    std::lock_guard<std::mutex> lock(own_queue.mutex);
+    if (!own_queue.tasks.empty()) {
+      task = std::move(own_queue.tasks.front());
+      own_queue.tasks.pop_front();
+      --number_of_tasks_;
+      return true;
+    }
+  }
+  for (size_t offset = 1; offset < queues_.size(); ++offset) {
+    WorkQueue & victim = *queues_[(this_thread_number + offset) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.back());
+      victim.tasks.pop_back();
+      --number_of_tasks_;
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t
+WorkStealingMultiThreadedExecutor::get_current_thread_number() const
+{
+  if (g_current_worker.executor != this) {
+    return number_of_threads_;
+  }
+  return g_current_worker.thread_number;
+}
+
+const void *
+WorkStealingMultiThreadedExecutor::get_entity(const executor::AnyExecutable & any_exec)
+{
+  if (any_exec.timer) {
+    return any_exec.timer.get();
+  }
+  if (any_exec.subscription) {
+    return any_exec.subscription.get();
+  }
+  if (any_exec.service) {
+    return any_exec.service.get();
+  }
+  if (any_exec.client) {
+    return any_exec.client.get();
+  }
+  return any_exec.waitable.get();
+}
+
+void
+WorkStealingMultiThreadedExecutor::wait_and_distribute()
+{
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    bool distributed = false;
+    bool skipped_in_flight = false;
+    size_t completions_before = 0;
+    while (spinning.load()) {
+      AnyExecutablePtr any_exec(new executor::AnyExecutable());
+      if (!get_next_ready_executable(*any_exec)) {
+        break;
+      }
+      {
+        std::lock_guard<std::mutex> lock(in_flight_mutex_);
+        // Reentrant entities stay ready until a worker executed them, don't take them twice.
+        // Destroying any_exec resets its callback group.
+        if (!in_flight_.insert(get_entity(*any_exec)).second) {
+          skipped_in_flight = true;
+          completions_before = number_of_completions_;
+          continue;
+        }
+      }
+      size_t assigned_thread = group_assignments_.empty() ?
+        number_of_threads_ : get_assigned_thread(any_exec->callback_group);
+      if (assigned_thread < number_of_threads_) {
+        WorkQueue & queue = *queues_[assigned_thread];
+        {
+          std::lock_guard<std::mutex> lock(queue.mutex);
+          queue.assigned_executables.push_back(std::move(any_exec));
+        }
+        {
+          std::lock_guard<std::mutex> lock(work_mutex_);
+          ++queue.number_of_assigned;
+        }
+        // Only the assigned worker can take it, wake them all to be sure to wake it.
+        work_cv_.notify_all();
+        distributed = true;
+        continue;
+      }
+      {
+        WorkQueue & queue = *queues_[next_queue_];
+        next_queue_ = (next_queue_ + 1) % queues_.size();
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.executables.push_back(std::move(any_exec));
+      }
+      {
+        std::lock_guard<std::mutex> lock(work_mutex_);
+        ++number_of_queued_;
+      }
+      work_cv_.notify_one();
+      distributed = true;
+    }
+    if (distributed) {
+      continue;
+    }
+    if (skipped_in_flight) {
+      // Waiting in rcl now would return immediately, wait until a worker finished something
+      // instead, but not longer than the poll period so the other entities aren't starved.
+      std::chrono::nanoseconds timeout = g_in_flight_poll_period;
+      if (next_exec_timeout_ >= std::chrono::nanoseconds::zero() && next_exec_timeout_ < timeout) {
+        timeout = next_exec_timeout_;
+      }
+      std::unique_lock<std::mutex> lock(in_flight_mutex_);
+      in_flight_cv_.wait_for(
+        lock, timeout, [this, completions_before]() {
+          return number_of_completions_ != completions_before ||
+                 !spinning.load() || !rclcpp::ok(this->context_);
+        });
+      continue;
+    }
+    wait_for_work(next_exec_timeout_);
+  }
+}
+
+WorkStealingMultiThreadedExecutor::AnyExecutablePtr
+WorkStealingMultiThreadedExecutor::pop_or_steal(size_t this_thread_number)
+{
+  {
+    WorkQueue & own_queue = *queues_[this_thread_number];
+    std::lock_guard<std::mutex> lock(own_queue.mutex);
+    if (!own_queue.assigned_executables.empty()) {
+      AnyExecutablePtr any_exec = std::move(own_queue.assigned_executables.front());
+      own_queue.assigned_executables.pop_front();
+      --own_queue.number_of_assigned;
+      return any_exec;
+    }
+    if (!own_queue.executables.empty()) {
+      AnyExecutablePtr any_exec = std::move(own_queue.executables.front());
+      own_queue.executables.pop_front();
+      --number_of_queued_;
+      return any_exec;
+    }
+  }
+  for (size_t offset = 1; offset < queues_.size(); ++offset) {
+    WorkQueue & victim = *queues_[(this_thread_number + offset) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.executables.empty()) {
+      AnyExecutablePtr any_exec = std::move(victim.executables.back());
+      victim.executables.pop_back();
+      --number_of_queued_;
+      ++number_of_steals_;
+      return any_exec;
+    }
+  }
+  return nullptr;
+}
+
+void
+WorkStealingMultiThreadedExecutor::run(size_t this_thread_number)
+{
+  g_current_worker.executor = this;
+  g_current_worker.thread_number = this_thread_number;
+  RCLCPP_SCOPE_EXIT(g_current_worker.executor = nullptr; );
+  while (rclcpp::ok(this->context_) && spinning.load()) {
+    // The tasks first, a callback may be waiting for them.
+    Task task;
+    if (pop_or_steal_task(this_thread_number, task)) {
+      task();
+      continue;
+    }
+    AnyExecutablePtr any_exec = pop_or_steal(this_thread_number);
+    if (!any_exec) {
+      WorkQueue & own_queue = *queues_[this_thread_number];
+      std::unique_lock<std::mutex> lock(work_mutex_);
+      work_cv_.wait(
+        lock, [this, &own_queue]() {
+          return number_of_queued_.load() > 0 || own_queue.number_of_assigned.load() > 0 ||
+                 number_of_tasks_.load() > 0 || !spinning.load();
+        });
+      continue;
+    }
+
+    execute_any_executable(*any_exec);
+
+    {
+      std::lock_guard<std::mutex> lock(in_flight_mutex_);
+      in_flight_.erase(get_entity(*any_exec));
+      ++number_of_completions_;
+    }
+    in_flight_cv_.notify_one();
+    // Clear the callback_group to prevent the AnyExecutable destructor from
+    // resetting the callback group `can_be_taken_from`
+    any_exec->callback_group.reset();
+  }
+  // The waiter may be waiting for this worker to complete work it will never execute.
+  {
+    std::lock_guard<std::mutex> lock(in_flight_mutex_);
+  }
+  in_flight_cv_.notify_all();
+}
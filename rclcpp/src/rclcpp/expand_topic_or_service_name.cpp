@@ -29,47 +29,89 @@
 
 using rclcpp::exceptions::throw_from_rcl_error;
 
-std::string
-rclcpp::expand_topic_or_service_name(
-  const std::string & name,
-  const std::string & node_name,
-  const std::string & namespace_,
-  bool is_service)
+namespace
 {
-  char * expanded_topic = nullptr;
-  rcl_allocator_t allocator = rcl_get_default_allocator();
-  rcutils_allocator_t rcutils_allocator = rcutils_get_default_allocator();
-  rcutils_string_map_t substitutions_map = rcutils_get_zero_initialized_string_map();
 
-  rcutils_ret_t rcutils_ret = rcutils_string_map_init(&substitutions_map, 0, rcutils_allocator);
-  if (rcutils_ret != RCUTILS_RET_OK) {
-    if (rcutils_ret == RCUTILS_RET_BAD_ALLOC) {
-      throw_from_rcl_error(RCL_RET_BAD_ALLOC, "", rcutils_get_error_state(), rcutils_reset_error);
-    } else {
-      throw_from_rcl_error(RCL_RET_ERROR, "", rcutils_get_error_state(), rcutils_reset_error);
+/// Default substitutions of the topic names, which don't depend on the name expanded.
+class DefaultSubstitutions
+{
+public:
+  DefaultSubstitutions()
+  : map_(rcutils_get_zero_initialized_string_map())
+  {
+    rcutils_ret_t rcutils_ret =
+      rcutils_string_map_init(&map_, 0, rcutils_get_default_allocator());
+    if (rcutils_ret != RCUTILS_RET_OK) {
+      if (rcutils_ret == RCUTILS_RET_BAD_ALLOC) {
+        throw_from_rcl_error(RCL_RET_BAD_ALLOC, "", rcutils_get_error_state(), rcutils_reset_error);
+      } else {
+        throw_from_rcl_error(RCL_RET_ERROR, "", rcutils_get_error_state(), rcutils_reset_error);
+      }
+    }
+    rcl_ret_t ret = rcl_get_default_topic_name_substitutions(&map_);
+    if (ret != RCL_RET_OK) {
+      const rcutils_error_state_t * error_state = rcl_get_error_state();
+      // finalize the string map before throwing
+      fini();
+      throw_from_rcl_error(ret, "", error_state);
     }
   }
-  rcl_ret_t ret = rcl_get_default_topic_name_substitutions(&substitutions_map);
-  if (ret != RCL_RET_OK) {
-    const rcutils_error_state_t * error_state = rcl_get_error_state();
-    // finalize the string map before throwing
-    rcutils_ret = rcutils_string_map_fini(&substitutions_map);
+
+  ~DefaultSubstitutions()
+  {
+    fini();
+  }
+
+  const rcutils_string_map_t *
+  get() const
+  {
+    return &map_;
+  }
+
+private:
+  void
+  fini()
+  {
+    rcutils_ret_t rcutils_ret = rcutils_string_map_fini(&map_);
     if (rcutils_ret != RCUTILS_RET_OK) {
       RCUTILS_LOG_ERROR_NAMED(
         "rclcpp",
-        "failed to fini string_map (%d) during error handling: %s",
+        "failed to fini string_map (%d): %s",
         rcutils_ret,
         rcutils_get_error_string().str);
       rcutils_reset_error();
     }
-    throw_from_rcl_error(ret, "", error_state);
   }
 
-  ret = rcl_expand_topic_name(
+  rcutils_string_map_t map_;
+};
+
+/// Return the default substitutions, built on the first call and only read afterwards.
+const rcutils_string_map_t *
+get_default_substitutions()
+{
+  static const DefaultSubstitutions substitutions;
+  return substitutions.get();
+}
+
+}  // namespace
+
+std::string
+rclcpp::expand_topic_or_service_name(
+  const std::string & name,
+  const std::string & node_name,
+  const std::string & namespace_,
+  bool is_service)
+{
+  char * expanded_topic = nullptr;
+  rcl_allocator_t allocator = rcl_get_default_allocator();
+  const rcutils_string_map_t * substitutions_map = get_default_substitutions();
+
+  rcl_ret_t ret = rcl_expand_topic_name(
     name.c_str(),
     node_name.c_str(),
     namespace_.c_str(),
-    &substitutions_map,
+    substitutions_map,
     allocator,
     &expanded_topic);
 
@@ -79,11 +121,6 @@ rclcpp::expand_topic_or_service_name(
     allocator.deallocate(expanded_topic, allocator.state);
   }
 
-  rcutils_ret = rcutils_string_map_fini(&substitutions_map);
-  if (rcutils_ret != RCUTILS_RET_OK) {
-    throw_from_rcl_error(RCL_RET_ERROR, "", rcutils_get_error_state(), rcutils_reset_error);
-  }
-
   // expansion failed
   if (ret != RCL_RET_OK) {
     // if invalid topic or unknown substitution
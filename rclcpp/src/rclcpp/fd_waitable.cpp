@@ -0,0 +1,271 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/fd_waitable.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rcl/error_handling.h"
+
+#include "rclcpp/scope_exit.hpp"
+
+namespace
+{
+
+#ifndef _WIN32
+// Thread polling the file descriptors of the waitables of the process.
+class FdWatcher
+{
+public:
+  static FdWatcher &
+  get()
+  {
+    static FdWatcher watcher;
+    return watcher;
+  }
+
+  // Poll a file descriptor, notify is called on the polling thread when it is readable.
+  uint64_t
+  add(int fd, std::function<void()> notify)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t id = next_id_++;
+    watches_.emplace(id, Watch{fd, true, std::move(notify)});
+    wake();
+    return id;
+  }
+
+  // Poll the file descriptor again, after it was notified.
+  void
+  arm(uint64_t id)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = watches_.find(id);
+    if (iter != watches_.end() && !iter->second.armed) {
+      iter->second.armed = true;
+      wake();
+    }
+  }
+
+  // Stop polling the file descriptor, it isn't notified after this returns.
+  void
+  remove(uint64_t id)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (watches_.erase(id) > 0) {
+      wake();
+    }
+  }
+
+private:
+  struct Watch
+  {
+    int fd;
+    // False from the notification until the callback of the waitable returned.
+    bool armed;
+    std::function<void()> notify;
+  };
+
+  FdWatcher()
+  {
+    if (pipe(wake_fds_) != 0) {
+      throw std::system_error(errno, std::generic_category(), "pipe() failed");
+    }
+    for (int fd : wake_fds_) {
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+      fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    thread_ = std::thread(&FdWatcher::run, this);
+  }
+
+  ~FdWatcher()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+      wake();
+    }
+    thread_.join();
+    close(wake_fds_[0]);
+    close(wake_fds_[1]);
+  }
+
+  // Interrupt poll() to update the polled file descriptors, called with the mutex locked.
+  void
+  wake()
+  {
+    char value = 1;
+    // Fails only when the pipe is full, poll() is woken up anyway.
+    ssize_t ret = write(wake_fds_[1], &value, sizeof(value));
+    (void)ret;
+  }
+
+  void
+  run()
+  {
+    std::vector<pollfd> poll_fds;
+    std::vector<uint64_t> ids;
+    while (true) {
+      poll_fds.assign(1, pollfd {wake_fds_[0], POLLIN, 0});
+      ids.clear();
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopped_) {
+          return;
+        }
+        for (const auto & watch : watches_) {
+          if (watch.second.armed) {
+            poll_fds.push_back(pollfd {watch.second.fd, POLLIN, 0});
+            ids.push_back(watch.first);
+          }
+        }
+      }
+      if (poll(poll_fds.data(), poll_fds.size(), -1) < 0) {
+        continue;
+      }
+      if (poll_fds[0].revents != 0) {
+        char buffer[64];
+        while (read(wake_fds_[0], buffer, sizeof(buffer)) > 0) {
+        }
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (size_t i = 1; i < poll_fds.size(); ++i) {
+        // Errors and hang ups are notified too, the callback sees them when reading.
+        if (0 == poll_fds[i].revents) {
+          continue;
+        }
+        auto iter = watches_.find(ids[i - 1]);
+        if (iter != watches_.end() && iter->second.armed) {
+          iter->second.armed = false;
+          iter->second.notify();
+        }
+      }
+    }
+  }
+
+  std::mutex mutex_;
+  std::map<uint64_t, Watch> watches_;
+  uint64_t next_id_ = 0;
+  bool stopped_ = false;
+  int wake_fds_[2];
+  std::thread thread_;
+};
+#endif
+
+}  // namespace
+
+using rclcpp::FdWaitable;
+
+FdWaitable::FdWaitable(int fd, Callback callback, rclcpp::Context::SharedPtr context)
+: fd_(fd), callback_(std::move(callback)), watch_id_(0)
+{
+#ifdef _WIN32
+  (void)context;
+  throw std::runtime_error("FdWaitable is not supported on Windows");
+#else
+  if (fd_ < 0) {
+    throw std::invalid_argument("FdWaitable requires a valid file descriptor");
+  }
+  if (!callback_) {
+    throw std::invalid_argument("FdWaitable requires a callback");
+  }
+  rcl_ret_t ret = rcl_guard_condition_init(
+    &gc_, context->get_rcl_context().get(), rcl_guard_condition_get_default_options());
+  if (RCL_RET_OK != ret) {
+    std::string error = rcl_get_error_string().str;
+    rcl_reset_error();
+    throw std::runtime_error("FdWaitable init error initializing guard condition: " + error);
+  }
+  watch_id_ = FdWatcher::get().add(fd_, [this]() {notify_readable();});
+#endif
+}
+
+FdWaitable::~FdWaitable()
+{
+#ifndef _WIN32
+  FdWatcher::get().remove(watch_id_);
+  if (rcl_guard_condition_fini(&gc_) != RCL_RET_OK) {
+    rcl_reset_error();
+  }
+#endif
+}
+
+size_t
+FdWaitable::get_number_of_ready_guard_conditions()
+{
+  return 1;
+}
+
+bool
+FdWaitable::add_to_wait_set(rcl_wait_set_t * wait_set)
+{
+  if (rcl_wait_set_add_guard_condition(wait_set, &gc_, NULL) != RCL_RET_OK) {
+    return false;
+  }
+  // The trigger may have woken up another wait set, e.g. after the waitable was moved.
+  if (readable_.load()) {
+    rcl_ret_t ret = rcl_trigger_guard_condition(&gc_);
+    (void)ret;
+  }
+  return true;
+}
+
+bool
+FdWaitable::is_ready(rcl_wait_set_t * wait_set)
+{
+  (void)wait_set;
+  return readable_.load();
+}
+
+void
+FdWaitable::execute()
+{
+  // Executed once per notification, even if several threads found the waitable ready.
+  if (!readable_.exchange(false)) {
+    return;
+  }
+#ifndef _WIN32
+  RCLCPP_SCOPE_EXIT(FdWatcher::get().arm(watch_id_); );
+#endif
+  callback_(fd_);
+}
+
+int
+FdWaitable::get_fd() const
+{
+  return fd_;
+}
+
+void
+FdWaitable::notify_readable()
+{
+  readable_.store(true);
+  rcl_ret_t ret = rcl_trigger_guard_condition(&gc_);
+  (void)ret;
+}
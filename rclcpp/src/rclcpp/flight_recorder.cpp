@@ -0,0 +1,370 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/experimental/flight_recorder.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+static_assert(
+  ATOMIC_LLONG_LOCK_FREE == 2,
+  "the flight recorder requires lock-free 64 bits atomics, to keep them in a file");
+
+namespace
+{
+
+constexpr uint64_t recording_magic = 0x72636c6370706672;  // "rclcppfr"
+constexpr size_t slot_alignment = 64;
+
+size_t
+align_up(size_t size)
+{
+  return (size + slot_alignment - 1) & ~(slot_alignment - 1);
+}
+
+}  // namespace
+
+struct FlightRecorder::Header
+{
+  /// Set last, once the recording is initialized.
+  std::atomic<uint64_t> magic;
+  uint64_t capacity;
+  uint64_t max_message_size;
+  uint64_t slot_size;
+  /// Number of slots taken by the recorded messages so far.
+  std::atomic<uint64_t> write_count;
+  /// Incremented once the name of the topic is written.
+  std::atomic<uint64_t> topic_count;
+  char topic_names[max_topics][max_topic_name_length + 1];
+
+  const SlotHeader *
+  get_slot(uint64_t message_index) const
+  {
+    auto offset = align_up(sizeof(Header)) + (message_index % capacity) * slot_size;
+    return reinterpret_cast<const SlotHeader *>(reinterpret_cast<const char *>(this) + offset);
+  }
+
+  SlotHeader *
+  get_slot(uint64_t message_index)
+  {
+    return const_cast<SlotHeader *>(static_cast<const Header *>(this)->get_slot(message_index));
+  }
+};
+
+struct FlightRecorder::SlotHeader
+{
+  /// 2 * message index + 1 while the message is written, + 2 once it is.
+  std::atomic<uint64_t> sequence;
+  int64_t timestamp;
+  uint64_t topic_id;
+  uint64_t length;
+};
+
+FlightRecorder::FlightRecorder(const FlightRecorderOptions & options)
+: path_(options.path), fd_(-1), memory_(nullptr), memory_size_(0), header_(nullptr),
+  dropped_count_(0)
+{
+  if (options.path.empty()) {
+    throw std::invalid_argument("the path of a flight recorder can't be empty");
+  }
+  if (options.capacity == 0) {
+    throw std::invalid_argument("capacity must be a positive, non-zero value");
+  }
+  if (options.max_message_size == 0) {
+    throw std::invalid_argument("max_message_size must be a positive, non-zero value");
+  }
+#ifdef _WIN32
+  throw std::runtime_error("flight recorders are only supported on POSIX systems");
+#else
+  size_t slot_size = align_up(sizeof(SlotHeader) + options.max_message_size);
+  size_t size = align_up(sizeof(Header)) + options.capacity * slot_size;
+  fd_ = open(path_.c_str(), O_CREAT | O_TRUNC | O_RDWR, 0644);
+  if (fd_ < 0 || ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+    auto error = std::string(std::strerror(errno));
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+    throw std::runtime_error(
+            "failed to create flight recording '" + path_ + "': " + error);
+  }
+  memory_ = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (memory_ == MAP_FAILED) {
+    auto error = std::string(std::strerror(errno));
+    memory_ = nullptr;
+    close(fd_);
+    throw std::runtime_error(
+            "failed to map flight recording '" + path_ + "': " + error);
+  }
+  memory_size_ = size;
+
+  // The file was truncated, so it is zeroed and the slots are free.
+  header_ = new (memory_) Header();
+  header_->capacity = options.capacity;
+  header_->max_message_size = options.max_message_size;
+  header_->slot_size = slot_size;
+  header_->write_count.store(0, std::memory_order_relaxed);
+  header_->topic_count.store(0, std::memory_order_relaxed);
+  for (uint64_t i = 0; i < options.capacity; ++i) {
+    new (header_->get_slot(i)) SlotHeader();
+  }
+  header_->magic.store(recording_magic, std::memory_order_release);
+#endif
+}
+
+FlightRecorder::~FlightRecorder()
+{
+#ifndef _WIN32
+  if (memory_) {
+    munmap(memory_, memory_size_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+#endif
+}
+
+size_t
+FlightRecorder::add_topic(const std::string & topic_name)
+{
+  if (topic_name.size() > max_topic_name_length) {
+    throw std::invalid_argument(
+            "the name of the recorded topic '" + topic_name + "' is too long");
+  }
+  std::lock_guard<std::mutex> lock(topics_mutex_);
+  size_t topic_count = header_->topic_count.load(std::memory_order_relaxed);
+  for (size_t id = 0; id < topic_count; ++id) {
+    if (topic_name == header_->topic_names[id]) {
+      return id;
+    }
+  }
+  if (topic_count == max_topics) {
+    throw std::length_error("the flight recording has the maximum number of topics");
+  }
+  std::memcpy(header_->topic_names[topic_count], topic_name.c_str(), topic_name.size() + 1);
+  header_->topic_count.store(topic_count + 1, std::memory_order_release);
+  return topic_count;
+}
+
+void
+FlightRecorder::record(size_t topic_id, const rcl_serialized_message_t & serialized_message)
+{
+  auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+  record(topic_id, timestamp, serialized_message.buffer, serialized_message.buffer_length);
+}
+
+void
+FlightRecorder::record(
+  size_t topic_id, int64_t timestamp, const uint8_t * data, size_t length)
+{
+  if (length > header_->max_message_size) {
+    dropped_count_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  uint64_t index = header_->write_count.fetch_add(1, std::memory_order_relaxed);
+  auto slot = header_->get_slot(index);
+  // The slot is taken unless a writer overtaken on the whole ring is still writing it.
+  uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+  if (
+    (sequence & 1u) != 0 || sequence > 2 * index ||
+    !slot->sequence.compare_exchange_strong(
+      sequence, 2 * index + 1, std::memory_order_relaxed))
+  {
+    dropped_count_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  slot->timestamp = timestamp;
+  slot->topic_id = topic_id;
+  slot->length = length;
+  if (length > 0) {
+    std::memcpy(slot + 1, data, length);
+  }
+  slot->sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+std::vector<FlightRecord>
+FlightRecorder::get_records(std::chrono::nanoseconds window) const
+{
+  return get_records(header_, window);
+}
+
+std::vector<FlightRecord>
+FlightRecorder::get_records(const Header * header, std::chrono::nanoseconds window)
+{
+  std::vector<std::string> topic_names;
+  size_t topic_count = std::min<size_t>(
+    header->topic_count.load(std::memory_order_acquire), max_topics);
+  for (size_t id = 0; id < topic_count; ++id) {
+    topic_names.emplace_back(
+      header->topic_names[id], strnlen(header->topic_names[id], max_topic_name_length + 1));
+  }
+
+  std::vector<FlightRecord> records;
+  uint64_t write_count = header->write_count.load(std::memory_order_acquire);
+  uint64_t first = write_count > header->capacity ? write_count - header->capacity : 0;
+  for (uint64_t index = first; index < write_count; ++index) {
+    auto slot = header->get_slot(index);
+    uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+    if (sequence != 2 * index + 2) {
+      // Dropped, being written or already overwritten.
+      continue;
+    }
+    FlightRecord record;
+    record.topic_id = slot->topic_id;
+    record.timestamp = slot->timestamp;
+    size_t length = std::min<size_t>(slot->length, header->max_message_size);
+    auto data = reinterpret_cast<const uint8_t *>(slot + 1);
+    record.data.assign(data, data + length);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->sequence.load(std::memory_order_relaxed) != sequence) {
+      // Overwritten while it was copied.
+      continue;
+    }
+    if (record.topic_id < topic_names.size()) {
+      record.topic_name = topic_names[record.topic_id];
+    }
+    records.push_back(std::move(record));
+  }
+
+  if (window > std::chrono::nanoseconds::zero() && !records.empty()) {
+    int64_t latest = records.front().timestamp;
+    for (const auto & record : records) {
+      latest = std::max(latest, record.timestamp);
+    }
+    records.erase(
+      std::remove_if(
+        records.begin(), records.end(),
+        [latest, window](const FlightRecord & record) {
+          return latest - record.timestamp > window.count();
+        }),
+      records.end());
+  }
+  return records;
+}
+
+void
+FlightRecorder::dump(const std::string & path, std::chrono::nanoseconds window) const
+{
+  auto records = get_records(window);
+  FlightRecorderOptions options;
+  options.path = path;
+  options.capacity = std::max<size_t>(records.size(), 1);
+  options.max_message_size = header_->max_message_size;
+  FlightRecorder dumped(options);
+  // The topics are added in the same order, so that they keep their id.
+  size_t topic_count = header_->topic_count.load(std::memory_order_acquire);
+  for (size_t id = 0; id < topic_count; ++id) {
+    dumped.add_topic(header_->topic_names[id]);
+  }
+  for (const auto & record : records) {
+    dumped.record(record.topic_id, record.timestamp, record.data.data(), record.data.size());
+  }
+  dumped.flush();
+}
+
+void
+FlightRecorder::flush()
+{
+#ifndef _WIN32
+  if (msync(memory_, memory_size_, MS_SYNC) != 0) {
+    throw std::runtime_error(
+            "failed to write flight recording '" + path_ + "': " + std::strerror(errno));
+  }
+#endif
+}
+
+std::vector<FlightRecord>
+FlightRecorder::read_file(const std::string & path, std::chrono::nanoseconds window)
+{
+#ifdef _WIN32
+  (void)path;
+  (void)window;
+  throw std::runtime_error("flight recorders are only supported on POSIX systems");
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  struct stat file_stat;
+  if (fd < 0 || fstat(fd, &file_stat) != 0) {
+    auto error = std::string(std::strerror(errno));
+    if (fd >= 0) {
+      close(fd);
+    }
+    throw std::runtime_error("failed to open flight recording '" + path + "': " + error);
+  }
+  auto size = static_cast<size_t>(file_stat.st_size);
+  if (size < sizeof(Header)) {
+    close(fd);
+    throw std::runtime_error("'" + path + "' is not a flight recording");
+  }
+  void * memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    throw std::runtime_error(
+            "failed to map flight recording '" + path + "': " + std::strerror(errno));
+  }
+  auto header = static_cast<const Header *>(memory);
+  bool valid = header->magic.load(std::memory_order_acquire) == recording_magic &&
+    header->capacity > 0 &&
+    header->slot_size >= sizeof(SlotHeader) + header->max_message_size &&
+    align_up(sizeof(Header)) + header->capacity * header->slot_size <= size;
+  if (!valid) {
+    munmap(memory, size);
+    throw std::runtime_error("'" + path + "' is not a flight recording");
+  }
+  std::vector<FlightRecord> records;
+  try {
+    records = get_records(header, window);
+  } catch (...) {
+    munmap(memory, size);
+    throw;
+  }
+  munmap(memory, size);
+  return records;
+#endif
+}
+
+size_t
+FlightRecorder::get_dropped_count() const
+{
+  return dropped_count_.load(std::memory_order_relaxed);
+}
+
+const std::string &
+FlightRecorder::get_path() const
+{
+  return path_;
+}
+
+}  // namespace experimental
+}  // namespace rclcpp
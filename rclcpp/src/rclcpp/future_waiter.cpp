@@ -0,0 +1,84 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/future_waiter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "rcl/error_handling.h"
+
+#include "rcutils/logging_macros.h"
+
+using rclcpp::executor::FutureWaiter;
+
+namespace
+{
+
+struct FutureWaiters
+{
+  std::mutex mutex;
+  std::vector<rcl_guard_condition_t *> guard_conditions;
+  std::atomic_size_t count {0};
+};
+
+FutureWaiters &
+get_future_waiters()
+{
+  static FutureWaiters waiters;
+  return waiters;
+}
+
+}  // namespace
+
+FutureWaiter::FutureWaiter(rcl_guard_condition_t * guard_condition)
+: guard_condition_(guard_condition)
+{
+  auto & waiters = get_future_waiters();
+  std::lock_guard<std::mutex> lock(waiters.mutex);
+  waiters.guard_conditions.push_back(guard_condition_);
+  waiters.count++;
+}
+
+FutureWaiter::~FutureWaiter()
+{
+  auto & waiters = get_future_waiters();
+  std::lock_guard<std::mutex> lock(waiters.mutex);
+  auto it = std::find(
+    waiters.guard_conditions.begin(), waiters.guard_conditions.end(), guard_condition_);
+  if (it != waiters.guard_conditions.end()) {
+    waiters.guard_conditions.erase(it);
+    waiters.count--;
+  }
+}
+
+void
+rclcpp::executor::notify_future_waiters()
+{
+  auto & waiters = get_future_waiters();
+  if (!waiters.count.load()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(waiters.mutex);
+  for (auto guard_condition : waiters.guard_conditions) {
+    if (rcl_trigger_guard_condition(guard_condition) != RCL_RET_OK) {
+      RCUTILS_LOG_ERROR_NAMED(
+        "rclcpp",
+        "failed to wake up executor waiting for a future: %s", rcl_get_error_string().str);
+      rcl_reset_error();
+    }
+  }
+}
@@ -0,0 +1,83 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/generic_publisher.hpp"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "rcl/publisher.h"
+
+#include "rclcpp/exceptions.hpp"
+
+namespace rclcpp
+{
+
+GenericPublisher::GenericPublisher(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  std::shared_ptr<rcpputils::SharedLibrary> typesupport_library,
+  const rosidl_message_type_support_t & type_support,
+  const std::string & topic_name,
+  const rclcpp::QoS & qos,
+  const rclcpp::PublisherOptions & options)
+: PublisherBase(
+    node_base,
+    topic_name,
+    type_support,
+    options.to_rcl_publisher_options<rcl_serialized_message_t>(qos)),
+  typesupport_library_(std::move(typesupport_library))
+{
+  if (options.event_callbacks.deadline_callback) {
+    this->add_event_handler(
+      options.event_callbacks.deadline_callback,
+      RCL_PUBLISHER_OFFERED_DEADLINE_MISSED);
+  }
+  if (options.event_callbacks.liveliness_callback) {
+    this->add_event_handler(
+      options.event_callbacks.liveliness_callback,
+      RCL_PUBLISHER_LIVELINESS_LOST);
+  }
+  if (options.event_callbacks.incompatible_qos_callback) {
+    this->add_event_handler(
+      options.event_callbacks.incompatible_qos_callback,
+      RCL_PUBLISHER_OFFERED_INCOMPATIBLE_QOS);
+  }
+}
+
+void
+GenericPublisher::publish(const rcl_serialized_message_t & message)
+{
+  auto ret = rcl_publish_serialized_message(publisher_handle_.get(), &message, nullptr);
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to publish serialized message");
+  }
+}
+
+void
+GenericPublisher::publish(const rclcpp::SerializedMessage & message)
+{
+  this->publish(message.get_rcl_serialized_message());
+}
+
+rclcpp::MemoryUsage
+GenericPublisher::get_memory_usage() const
+{
+  rclcpp::MemoryUsage usage = PublisherBase::get_memory_usage();
+  usage.entity_bytes = sizeof(*this);
+  return usage;
+}
+
+}  // namespace rclcpp
@@ -0,0 +1,116 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/generic_subscription.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace rclcpp
+{
+
+GenericSubscription::GenericSubscription(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  std::shared_ptr<rcpputils::SharedLibrary> typesupport_library,
+  const rosidl_message_type_support_t & type_support,
+  const std::string & topic_name,
+  const rclcpp::QoS & qos,
+  CallbackType callback,
+  const rclcpp::SubscriptionOptions & options)
+: SubscriptionBase(
+    node_base,
+    type_support,
+    topic_name,
+    options.to_rcl_subscription_options<rcl_serialized_message_t>(qos),
+    true),
+  callback_(std::move(callback)),
+  typesupport_library_(std::move(typesupport_library)),
+  message_memory_strategy_(std::make_shared<MessageMemoryStrategy>())
+{
+  if (!callback_) {
+    throw std::invalid_argument("the callback of a generic subscription can't be empty");
+  }
+  this->set_max_messages_per_execution(options.max_messages_per_execution);
+  this->set_content_filter(options.content_filter);
+  if (options.event_callbacks.deadline_callback) {
+    this->add_event_handler(
+      options.event_callbacks.deadline_callback,
+      RCL_SUBSCRIPTION_REQUESTED_DEADLINE_MISSED);
+  }
+  if (options.event_callbacks.liveliness_callback) {
+    this->add_event_handler(
+      options.event_callbacks.liveliness_callback,
+      RCL_SUBSCRIPTION_LIVELINESS_CHANGED);
+  }
+  if (options.event_callbacks.incompatible_qos_callback) {
+    this->add_event_handler(
+      options.event_callbacks.incompatible_qos_callback,
+      RCL_SUBSCRIPTION_REQUESTED_INCOMPATIBLE_QOS);
+  }
+}
+
+std::shared_ptr<void>
+GenericSubscription::create_message()
+{
+  throw std::runtime_error("the messages of a generic subscription are only taken serialized");
+}
+
+std::shared_ptr<rcl_serialized_message_t>
+GenericSubscription::create_serialized_message()
+{
+  return message_memory_strategy_->borrow_serialized_message();
+}
+
+void
+GenericSubscription::handle_message(
+  std::shared_ptr<void> & message, const rmw_message_info_t & message_info)
+{
+  (void)message_info;
+  callback_(std::static_pointer_cast<const rcl_serialized_message_t>(message));
+}
+
+void
+GenericSubscription::handle_loaned_message(
+  void * loaned_message, const rmw_message_info_t & message_info)
+{
+  (void)loaned_message;
+  (void)message_info;
+  throw std::runtime_error("the messages of a generic subscription are only taken serialized");
+}
+
+void
+GenericSubscription::return_message(std::shared_ptr<void> & message)
+{
+  message.reset();
+}
+
+void
+GenericSubscription::return_serialized_message(std::shared_ptr<rcl_serialized_message_t> & message)
+{
+  message_memory_strategy_->return_serialized_message(message);
+}
+
+rclcpp::MemoryUsage
+GenericSubscription::get_memory_usage() const
+{
+  rclcpp::MemoryUsage usage = SubscriptionBase::get_memory_usage();
+  usage.entity_bytes = sizeof(*this);
+  usage.message_pool_bytes = message_memory_strategy_->get_memory_usage();
+  return usage;
+}
+
+}  // namespace rclcpp
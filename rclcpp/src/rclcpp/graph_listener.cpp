@@ -39,8 +39,7 @@ namespace graph_listener
 GraphListener::GraphListener(std::shared_ptr<rclcpp::Context> parent_context)
 : parent_context_(parent_context),
   is_started_(false),
-  is_shutdown_(false),
-  shutdown_guard_condition_(nullptr)
+  is_shutdown_(false)
 {
   // TODO(wjwwood): make a guard condition class in rclcpp so this can be tracked
   //   automatically with the rcl guard condition
@@ -54,7 +53,8 @@ GraphListener::GraphListener(std::shared_ptr<rclcpp::Context> parent_context)
     throw_from_rcl_error(ret, "failed to create interrupt guard condition");
   }
 
-  shutdown_guard_condition_ = parent_context->get_interrupt_guard_condition(&wait_set_);
+  // The context wakes up the listener on shutdown with the same guard condition.
+  parent_context->add_interrupt_guard_condition(&interrupt_guard_condition_);
 }
 
 GraphListener::~GraphListener()
@@ -129,6 +129,7 @@ GraphListener::run()
 void
 GraphListener::run_loop()
 {
+  bool notified_shutdown = false;
   while (true) {
     // If shutdown() was called, exit.
     if (is_shutdown_.load()) {
@@ -152,46 +153,38 @@ GraphListener::run_loop()
       return;
     }
 
-    // Resize the wait set if necessary.
-    const size_t node_graph_interfaces_size = node_graph_interfaces_.size();
-    // Add 2 for the interrupt and shutdown guard conditions
-    if (wait_set_.size_of_guard_conditions < (node_graph_interfaces_size + 2)) {
-      ret = rcl_wait_set_resize(&wait_set_, 0, node_graph_interfaces_size + 2, 0, 0, 0, 0);
+    // The guard conditions of the nodes only change when nodes are added or removed.
+    if (graph_guard_conditions_need_update_) {
+      update_graph_guard_conditions();
+    }
+    // Add 1 for the interrupt guard condition, also triggered on shutdown
+    const size_t number_of_guard_conditions = graph_guard_conditions_.size() + 1;
+    if (wait_set_.size_of_guard_conditions < number_of_guard_conditions) {
+      ret = rcl_wait_set_resize(&wait_set_, 0, number_of_guard_conditions, 0, 0, 0, 0);
       if (RCL_RET_OK != ret) {
         throw_from_rcl_error(ret, "failed to resize wait set");
       }
     }
-    // Clear the wait set.
+    // Clear the wait set, rcl_wait() removed the guard conditions which weren't triggered.
     ret = rcl_wait_set_clear(&wait_set_);
     if (RCL_RET_OK != ret) {
       throw_from_rcl_error(ret, "failed to clear wait set");
     }
-    // Put the interrupt guard condition in the wait set.
+    // Put the interrupt guard condition in the wait set, at index 0.
     ret = rcl_wait_set_add_guard_condition(&wait_set_, &interrupt_guard_condition_, NULL);
     if (RCL_RET_OK != ret) {
       throw_from_rcl_error(ret, "failed to add interrupt guard condition to wait set");
     }
-    // Put the shutdown guard condition in the wait set.
-    size_t shutdown_guard_condition_index = 0u;
-    ret = rcl_wait_set_add_guard_condition(
-      &wait_set_, shutdown_guard_condition_, &shutdown_guard_condition_index);
-    if (RCL_RET_OK != ret) {
-      throw_from_rcl_error(ret, "failed to add shutdown guard condition to wait set");
-    }
     // Put graph guard conditions for each node into the wait set.
-    std::vector<size_t> graph_gc_indexes(node_graph_interfaces_size, 0u);
-    for (size_t i = 0u; i < node_graph_interfaces_size; ++i) {
-      auto node_ptr = node_graph_interfaces_[i];
-      // Only wait on graph changes if some user of the node is watching.
-      if (node_ptr->count_graph_users() == 0) {
+    for (size_t i = 0u; i < graph_guard_conditions_.size(); ++i) {
+      // Only wait on graph changes if some user of the node is watching, 0 is not an index of
+      // a graph guard condition.
+      graph_gc_indexes_[i] = 0u;
+      if (node_graph_interfaces_[i]->count_graph_users() == 0) {
         continue;
       }
-      // Add the graph guard condition for the node to the wait set.
-      auto graph_gc = node_ptr->get_graph_guard_condition();
-      if (!graph_gc) {
-        throw_from_rcl_error(RCL_RET_ERROR, "failed to get graph guard condition");
-      }
-      ret = rcl_wait_set_add_guard_condition(&wait_set_, graph_gc, &graph_gc_indexes[i]);
+      ret = rcl_wait_set_add_guard_condition(
+        &wait_set_, graph_guard_conditions_[i], &graph_gc_indexes_[i]);
       if (RCL_RET_OK != ret) {
         throw_from_rcl_error(ret, "failed to add graph guard condition to wait set");
       }
@@ -206,27 +199,39 @@ GraphListener::run_loop()
       throw_from_rcl_error(ret, "failed to wait on wait set");
     }
 
-    // Check to see if the shutdown guard condition has been triggered.
-    bool shutdown_guard_condition_triggered =
-      (shutdown_guard_condition_ == wait_set_.guard_conditions[shutdown_guard_condition_index]);
-    // Notify nodes who's guard conditions are set (triggered).
-    for (size_t i = 0u; i < node_graph_interfaces_size; ++i) {
-      const auto node_ptr = node_graph_interfaces_[i];
-      auto graph_gc = node_ptr->get_graph_guard_condition();
-      if (!graph_gc) {
-        throw_from_rcl_error(RCL_RET_ERROR, "failed to get graph guard condition");
-      }
-      if (graph_gc == wait_set_.guard_conditions[graph_gc_indexes[i]]) {
-        node_ptr->notify_graph_change();
+    // Notify the nodes whose guard conditions are set (triggered).
+    for (size_t i = 0u; i < graph_guard_conditions_.size(); ++i) {
+      if (graph_gc_indexes_[i] != 0u && wait_set_.guard_conditions[graph_gc_indexes_[i]]) {
+        graph_change_count_.fetch_add(1);
+        node_graph_interfaces_[i]->notify_graph_change();
       }
-      if (shutdown_guard_condition_triggered) {
-        // If shutdown, then notify the node of this as well.
+    }
+    // Check to see if the interrupt guard condition was triggered by the shutdown of the context.
+    if (wait_set_.guard_conditions[0] && !notified_shutdown && !parent_context->is_valid()) {
+      // If shutdown, then notify all the nodes of this as well.
+      notified_shutdown = true;
+      for (const auto node_ptr : node_graph_interfaces_) {
         node_ptr->notify_shutdown();
       }
     }
   }  // while (true)
 }
 
+void
+GraphListener::update_graph_guard_conditions()
+{
+  graph_guard_conditions_.clear();
+  for (const auto node_ptr : node_graph_interfaces_) {
+    auto graph_gc = node_ptr->get_graph_guard_condition();
+    if (!graph_gc) {
+      throw_from_rcl_error(RCL_RET_ERROR, "failed to get graph guard condition");
+    }
+    graph_guard_conditions_.push_back(graph_gc);
+  }
+  graph_gc_indexes_.resize(graph_guard_conditions_.size());
+  graph_guard_conditions_need_update_ = false;
+}
+
 static void
 interrupt_(rcl_guard_condition_t * interrupt_guard_condition)
 {
@@ -305,6 +310,7 @@ GraphListener::add_node(rclcpp::node_interfaces::NodeGraphInterface * node_graph
     throw NodeAlreadyAddedError();
   }
   node_graph_interfaces_.push_back(node_graph);
+  graph_guard_conditions_need_update_ = true;
   // The run loop has already been interrupted by acquire_nodes_lock_() and
   // will evaluate the new node when nodes_lock releases the node_graph_interfaces_mutex_.
 }
@@ -348,6 +354,7 @@ GraphListener::remove_node(rclcpp::node_interfaces::NodeGraphInterface * node_gr
   // Store the now acquired node_graph_interfaces_mutex_ in the scoped lock using adopt_lock.
   std::lock_guard<std::mutex> nodes_lock(node_graph_interfaces_mutex_, std::adopt_lock);
   remove_node_(&node_graph_interfaces_, node_graph);
+  graph_guard_conditions_need_update_ = true;
 }
 
 void
@@ -359,32 +366,14 @@ GraphListener::__shutdown(bool should_throw)
       interrupt_(&interrupt_guard_condition_);
       listener_thread_.join();
     }
+    auto parent_context_ptr = parent_context_.lock();
+    if (parent_context_ptr) {
+      parent_context_ptr->remove_interrupt_guard_condition(&interrupt_guard_condition_);
+    }
     rcl_ret_t ret = rcl_guard_condition_fini(&interrupt_guard_condition_);
     if (RCL_RET_OK != ret) {
       throw_from_rcl_error(ret, "failed to finalize interrupt guard condition");
     }
-    if (shutdown_guard_condition_) {
-      auto parent_context_ptr = parent_context_.lock();
-      if (parent_context_ptr) {
-        if (should_throw) {
-          parent_context_ptr->release_interrupt_guard_condition(&wait_set_);
-        } else {
-          parent_context_ptr->release_interrupt_guard_condition(&wait_set_, std::nothrow);
-        }
-      } else {
-        ret = rcl_guard_condition_fini(shutdown_guard_condition_);
-        if (RCL_RET_OK != ret) {
-          if (should_throw) {
-            throw_from_rcl_error(ret, "failed to finalize shutdown guard condition");
-          } else {
-            RCLCPP_ERROR(
-              rclcpp::get_logger("rclcpp"),
-              "failed to finalize shutdown guard condition");
-          }
-        }
-      }
-      shutdown_guard_condition_ = nullptr;
-    }
     if (is_started_) {
       ret = rcl_wait_set_fini(&wait_set_);
       if (RCL_RET_OK != ret) {
@@ -423,5 +412,11 @@ GraphListener::is_shutdown()
   return is_shutdown_.load();
 }
 
+uint64_t
+GraphListener::get_graph_change_count() const
+{
+  return graph_change_count_.load();
+}
+
 }  // namespace graph_listener
 }  // namespace rclcpp
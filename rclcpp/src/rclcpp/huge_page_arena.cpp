@@ -0,0 +1,233 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/allocator/huge_page_allocator.hpp"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+
+constexpr size_t default_huge_page_size = 2 * 1024 * 1024;
+
+#if defined(__linux__)
+// Read the size of the huge pages from /proc/meminfo.
+size_t
+read_huge_page_size()
+{
+  std::ifstream file("/proc/meminfo");
+  std::string line;
+  while (std::getline(file, line)) {
+    unsigned long long kilobytes = 0;  // NOLINT(runtime/int)
+    if (std::sscanf(line.c_str(), "Hugepagesize: %llu kB", &kilobytes) == 1 && kilobytes > 0) {
+      return static_cast<size_t>(kilobytes) * 1024;
+    }
+  }
+  return default_huge_page_size;
+}
+
+// Read the size of the transparent huge pages of the mapping starting at `address`.
+size_t
+read_anon_huge_pages(const void * address)
+{
+  std::ifstream file("/proc/self/smaps");
+  std::string line;
+  bool in_mapping = false;
+  while (std::getline(file, line)) {
+    uintptr_t start = 0;
+    uintptr_t end = 0;
+    if (std::sscanf(line.c_str(), "%" SCNxPTR "-%" SCNxPTR " ", &start, &end) == 2) {
+      in_mapping = start == reinterpret_cast<uintptr_t>(address);
+      continue;
+    }
+    unsigned long long kilobytes = 0;  // NOLINT(runtime/int)
+    if (in_mapping &&
+      std::sscanf(line.c_str(), "AnonHugePages: %llu kB", &kilobytes) == 1)
+    {
+      return static_cast<size_t>(kilobytes) * 1024;
+    }
+  }
+  return 0;
+}
+#endif
+
+}  // namespace
+
+namespace rclcpp
+{
+namespace allocator
+{
+
+HugePageArena::HugePageArena(const HugePageArenaOptions & options)
+: min_allocation_size_(options.min_allocation_size),
+  capacity_(0),
+  storage_(nullptr),
+  mapped_size_(0),
+  hugetlbfs_(false),
+  used_(0),
+  arena_allocations_(0),
+  overflow_allocations_(0),
+  small_allocations_(0)
+{
+  if (options.capacity == 0) {
+    throw std::invalid_argument("capacity must be a positive, non-zero value");
+  }
+  free_blocks_.fill(nullptr);
+#if defined(__linux__)
+  const size_t huge_page_size = read_huge_page_size();
+  if (options.capacity > std::numeric_limits<size_t>::max() - 2 * huge_page_size) {
+    throw std::bad_alloc();
+  }
+  capacity_ = (options.capacity + huge_page_size - 1) / huge_page_size * huge_page_size;
+  if (options.use_hugetlbfs) {
+    void * pointer = mmap(
+      nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+      -1, 0);
+    if (MAP_FAILED != pointer) {
+      storage_ = static_cast<char *>(pointer);
+      mapped_size_ = capacity_;
+      hugetlbfs_ = true;
+      return;
+    }
+  }
+  // Map a huge page more, to keep only the part aligned on huge pages, which the kernel can back
+  // with transparent huge pages.
+  size_t size = capacity_ + huge_page_size;
+  void * pointer = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (MAP_FAILED == pointer) {
+    throw std::bad_alloc();
+  }
+  auto begin = static_cast<char *>(pointer);
+  auto aligned = reinterpret_cast<char *>(
+    (reinterpret_cast<uintptr_t>(begin) + huge_page_size - 1) / huge_page_size * huge_page_size);
+  if (aligned != begin) {
+    munmap(begin, static_cast<size_t>(aligned - begin));
+  }
+  size_t tail = size - static_cast<size_t>(aligned - begin) - capacity_;
+  if (tail > 0) {
+    munmap(aligned + capacity_, tail);
+  }
+  storage_ = aligned;
+  mapped_size_ = capacity_;
+  // Only a hint: without transparent huge pages, the arena has normal pages.
+  (void)madvise(storage_, capacity_, MADV_HUGEPAGE);
+#else
+  capacity_ = (options.capacity + default_huge_page_size - 1) / default_huge_page_size *
+    default_huge_page_size;
+  storage_ = static_cast<char *>(::operator new(capacity_));
+#endif
+}
+
+HugePageArena::~HugePageArena()
+{
+#if defined(__linux__)
+  munmap(storage_, mapped_size_);
+#else
+  ::operator delete(storage_);
+#endif
+}
+
+size_t
+HugePageArena::get_size_class(size_t size, size_t & block_size)
+{
+  size_t base = min_block_size;
+  for (size_t size_class = 0; size_class < size_class_count; base *= 2) {
+    for (size_t step = 0; step < 4; ++step, ++size_class) {
+      block_size = base + base / 4 * step;
+      if (block_size >= size) {
+        return size_class;
+      }
+    }
+    if (base > std::numeric_limits<size_t>::max() / 4) {
+      break;
+    }
+  }
+  throw std::bad_alloc();
+}
+
+void *
+HugePageArena::allocate(size_t size)
+{
+  if (size < min_allocation_size_) {
+    small_allocations_.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+  }
+  size_t block_size = 0;
+  size_t size_class = get_size_class(size + sizeof(Header), block_size);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Header * block = free_blocks_[size_class];
+    if (block) {
+      free_blocks_[size_class] = block->next;
+    } else if (capacity_ - used_ >= block_size) {
+      block = reinterpret_cast<Header *>(storage_ + used_);
+      used_ += block_size;
+    }
+    if (block) {
+      block->size_class = size_class;
+      arena_allocations_++;
+      return block + 1;
+    }
+  }
+  overflow_allocations_.fetch_add(1, std::memory_order_relaxed);
+  return ::operator new(size);
+}
+
+void
+HugePageArena::deallocate(void * pointer)
+{
+  if (!pointer) {
+    return;
+  }
+  if (!owns(pointer)) {
+    ::operator delete(pointer);
+    return;
+  }
+  Header * block = static_cast<Header *>(pointer) - 1;
+  size_t size_class = block->size_class;
+  std::lock_guard<std::mutex> lock(mutex_);
+  block->next = free_blocks_[size_class];
+  free_blocks_[size_class] = block;
+}
+
+HugePageArenaStatistics
+HugePageArena::get_statistics() const
+{
+  HugePageArenaStatistics statistics;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    statistics.arena_allocations = arena_allocations_;
+    statistics.used_size = used_;
+  }
+  statistics.overflow_allocations = overflow_allocations_.load(std::memory_order_relaxed);
+  statistics.small_allocations = small_allocations_.load(std::memory_order_relaxed);
+#if defined(__linux__)
+  // The pages of hugetlbfs are all huge, but only reserved once touched, as the used blocks.
+  statistics.huge_page_size = hugetlbfs_ ? statistics.used_size : read_anon_huge_pages(storage_);
+#endif
+  return statistics;
+}
+
+}  // namespace allocator
+}  // namespace rclcpp
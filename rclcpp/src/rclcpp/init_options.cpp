@@ -44,6 +44,8 @@ InitOptions::InitOptions(const InitOptions & other)
 : InitOptions(*other.get_rcl_init_options())
 {
   shutdown_on_sigint = other.shutdown_on_sigint;
+  share_participant = other.share_participant;
+  realtime = other.realtime;
 }
 
 InitOptions &
@@ -56,6 +58,8 @@ InitOptions::operator=(const InitOptions & other)
       rclcpp::exceptions::throw_from_rcl_error(ret, "failed to copy rcl init options");
     }
     this->shutdown_on_sigint = other.shutdown_on_sigint;
+    this->share_participant = other.share_participant;
+    this->realtime = other.realtime;
   }
   return *this;
 }
@@ -14,9 +14,16 @@
 
 #include "rclcpp/experimental/intra_process_manager.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/experimental/serialized_message.hpp"
 
 namespace rclcpp
 {
@@ -25,6 +32,53 @@ namespace experimental
 
 static std::atomic<uint64_t> _next_unique_id {1};
 
+IntraProcessManager::PublisherSubscriptions::PublisherSubscriptions()
+: subscriptions_(std::make_shared<const SplittedSubscriptions>()),
+  count_(0),
+  history_depth_(0)
+{}
+
+std::shared_ptr<const IntraProcessManager::SplittedSubscriptions>
+IntraProcessManager::PublisherSubscriptions::load() const
+{
+  return std::atomic_load(&subscriptions_);
+}
+
+void
+IntraProcessManager::PublisherSubscriptions::store(
+  std::shared_ptr<const SplittedSubscriptions> subscriptions)
+{
+  size_t count =
+    subscriptions->take_shared_subscriptions.size() +
+    subscriptions->take_ownership_subscriptions.size() +
+    subscriptions->broadcast_subscriptions.size() +
+    subscriptions->serialized_subscriptions.size();
+  std::atomic_store(&subscriptions_, std::move(subscriptions));
+  count_.store(count);
+}
+
+const std::atomic<size_t> &
+IntraProcessManager::PublisherSubscriptions::count() const
+{
+  return count_;
+}
+
+size_t
+IntraProcessManager::PublisherSubscriptions::get_history_depth() const
+{
+  return history_depth_;
+}
+
+void
+IntraProcessManager::PublisherSubscriptions::add_to_history(
+  std::shared_ptr<const void> message) const
+{
+  history_.push_back(std::move(message));
+  if (history_.size() > history_depth_) {
+    history_.pop_front();
+  }
+}
+
 IntraProcessManager::IntraProcessManager()
 {}
 
@@ -41,14 +95,30 @@ IntraProcessManager::add_publisher(rclcpp::PublisherBase::SharedPtr publisher)
   publishers_[id].publisher = publisher;
   publishers_[id].topic_name = publisher->get_topic_name();
   publishers_[id].qos = publisher->get_actual_qos().get_rmw_qos_profile();
+  publishers_[id].message_type = &publisher->get_intra_process_message_type();
 
   // Initialize the subscriptions storage for this publisher.
-  pub_to_subs_[id] = SplittedSubscriptions();
+  pub_to_subs_[id] = PublisherSubscriptions::make_shared();
+  size_t broadcast_depth = publisher->get_intra_process_broadcast_depth();
+  if (broadcast_depth > 0) {
+    auto subscriptions = std::make_shared<SplittedSubscriptions>();
+    subscriptions->broadcast_ring =
+      std::make_shared<buffers::BroadcastRingBuffer>(broadcast_depth);
+    pub_to_subs_[id]->store(std::move(subscriptions));
+  }
+  const auto & qos = publishers_[id].qos;
+  if (qos.durability == RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL) {
+    // A keep all history is kept like a keep last one of the same depth.
+    pub_to_subs_[id]->history_depth_ = std::max<size_t>(qos.depth, 1u);
+  }
 
   // create an entry for the publisher id and populate with already existing subscriptions
-  for (auto & pair : subscriptions_) {
-    if (can_communicate(publishers_[id], pair.second)) {
-      insert_sub_id_for_pub(pair.first, id, pair.second.use_take_shared_method);
+  auto & topic = topics_[publishers_[id].topic_name];
+  topic.publisher_ids.push_back(id);
+  for (uint64_t subscription_id : topic.subscription_ids) {
+    const auto & subscription_info = subscriptions_[subscription_id];
+    if (get_incompatibility(publishers_[id], subscription_info) == nullptr) {
+      update_subscriptions_of_pub(id, subscription_info, true);
     }
   }
 
@@ -66,11 +136,29 @@ IntraProcessManager::add_subscription(SubscriptionIntraProcessBase::SharedPtr su
   subscriptions_[id].topic_name = subscription->get_topic_name();
   subscriptions_[id].qos = subscription->get_actual_qos();
   subscriptions_[id].use_take_shared_method = subscription->use_take_shared_method();
+  subscriptions_[id].is_serialized = subscription->is_serialized();
+  subscriptions_[id].can_read_broadcast = subscription->can_read_broadcast();
+  subscriptions_[id].message_type = &subscription->get_message_type();
 
   // adds the subscription id to all the matchable publishers
-  for (auto & pair : publishers_) {
-    if (can_communicate(pair.second, subscriptions_[id])) {
-      insert_sub_id_for_pub(id, pair.first, subscriptions_[id].use_take_shared_method);
+  auto & topic = topics_[subscriptions_[id].topic_name];
+  topic.subscription_ids.push_back(id);
+  for (uint64_t publisher_id : topic.publisher_ids) {
+    if (get_incompatibility(publishers_[publisher_id], subscriptions_[id]) != nullptr) {
+      continue;
+    }
+    const auto & publisher_subscriptions = pub_to_subs_[publisher_id];
+    if (publisher_subscriptions->get_history_depth() == 0) {
+      update_subscriptions_of_pub(publisher_id, subscriptions_[id], true);
+      continue;
+    }
+    // A late joiner gets the messages kept by a transient local publisher, before the next ones.
+    std::lock_guard<std::mutex> history_lock(publisher_subscriptions->history_mutex_);
+    update_subscriptions_of_pub(publisher_id, subscriptions_[id], true);
+    if (!subscriptions_[id].is_serialized) {
+      for (const auto & message : publisher_subscriptions->history_) {
+        subscription->provide_shared_intra_process_message(message);
+      }
     }
   }
 
@@ -82,22 +170,30 @@ IntraProcessManager::remove_subscription(uint64_t intra_process_subscription_id)
 {
   std::unique_lock<std::shared_timed_mutex> lock(mutex_);
 
-  subscriptions_.erase(intra_process_subscription_id);
-
-  for (auto & pair : pub_to_subs_) {
-    pair.second.take_shared_subscriptions.erase(
-      std::remove(
-        pair.second.take_shared_subscriptions.begin(),
-        pair.second.take_shared_subscriptions.end(),
-        intra_process_subscription_id),
-      pair.second.take_shared_subscriptions.end());
+  auto subscription_it = subscriptions_.find(intra_process_subscription_id);
+  if (subscription_it == subscriptions_.end()) {
+    return;
+  }
+  auto subscription_info = subscription_it->second;
+  subscriptions_.erase(subscription_it);
 
-    pair.second.take_ownership_subscriptions.erase(
-      std::remove(
-        pair.second.take_ownership_subscriptions.begin(),
-        pair.second.take_ownership_subscriptions.end(),
-        intra_process_subscription_id),
-      pair.second.take_ownership_subscriptions.end());
+  auto topic_it = topics_.find(subscription_info.topic_name);
+  if (topic_it == topics_.end()) {
+    return;
+  }
+  auto & topic = topic_it->second;
+  topic.subscription_ids.erase(
+    std::remove(
+      topic.subscription_ids.begin(), topic.subscription_ids.end(),
+      intra_process_subscription_id),
+    topic.subscription_ids.end());
+  for (uint64_t publisher_id : topic.publisher_ids) {
+    if (get_incompatibility(publishers_[publisher_id], subscription_info) == nullptr) {
+      update_subscriptions_of_pub(publisher_id, subscription_info, false);
+    }
+  }
+  if (topic.publisher_ids.empty() && topic.subscription_ids.empty()) {
+    topics_.erase(topic_it);
   }
 }
 
@@ -106,8 +202,67 @@ IntraProcessManager::remove_publisher(uint64_t intra_process_publisher_id)
 {
   std::unique_lock<std::shared_timed_mutex> lock(mutex_);
 
-  publishers_.erase(intra_process_publisher_id);
-  pub_to_subs_.erase(intra_process_publisher_id);
+  auto publisher_it = publishers_.find(intra_process_publisher_id);
+  if (publisher_it != publishers_.end()) {
+    auto topic_it = topics_.find(publisher_it->second.topic_name);
+    if (topic_it != topics_.end()) {
+      auto & topic = topic_it->second;
+      topic.publisher_ids.erase(
+        std::remove(
+          topic.publisher_ids.begin(), topic.publisher_ids.end(), intra_process_publisher_id),
+        topic.publisher_ids.end());
+      if (topic.publisher_ids.empty() && topic.subscription_ids.empty()) {
+        topics_.erase(topic_it);
+      }
+    }
+    publishers_.erase(publisher_it);
+  }
+  auto pub_it = pub_to_subs_.find(intra_process_publisher_id);
+  if (pub_it != pub_to_subs_.end()) {
+    remove_broadcast_readers(*pub_it->second->load());
+    // The publisher may still hold its handle, leave it without subscriptions.
+    pub_it->second->store(std::make_shared<const SplittedSubscriptions>());
+    {
+      std::lock_guard<std::mutex> history_lock(pub_it->second->history_mutex_);
+      pub_it->second->history_.clear();
+    }
+    pub_to_subs_.erase(pub_it);
+  }
+}
+
+void
+IntraProcessManager::reserve(size_t publishers, size_t subscriptions)
+{
+  std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+  publishers_.reserve(publishers);
+  pub_to_subs_.reserve(publishers);
+  subscriptions_.reserve(subscriptions);
+  // At most one topic for each publisher and subscription.
+  topics_.reserve(publishers + subscriptions);
+}
+
+void
+IntraProcessManager::clear()
+{
+  PublisherToSubscriptionsMap pub_to_subs;
+  SubscriptionMap subscriptions;
+  PublisherMap publishers;
+  TopicMap topics;
+  {
+    std::unique_lock<std::shared_timed_mutex> lock(mutex_);
+    pub_to_subs.swap(pub_to_subs_);
+    subscriptions.swap(subscriptions_);
+    publishers.swap(publishers_);
+    topics.swap(topics_);
+  }
+  // Released without the lock, as it may destroy subscriptions, which remove themselves.
+  auto no_subscriptions = std::make_shared<const SplittedSubscriptions>();
+  for (auto & pub_pair : pub_to_subs) {
+    remove_broadcast_readers(*pub_pair.second->load());
+    pub_pair.second->store(no_subscriptions);
+    std::lock_guard<std::mutex> history_lock(pub_pair.second->history_mutex_);
+    pub_pair.second->history_.clear();
+  }
 }
 
 bool
@@ -127,6 +282,33 @@ IntraProcessManager::matches_any_publishers(const rmw_gid_t * id) const
   return false;
 }
 
+bool
+IntraProcessManager::matches_any_publishers(
+  uint64_t intra_process_subscription_id, const rmw_gid_t * id) const
+{
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+
+  auto subscription_it = subscriptions_.find(intra_process_subscription_id);
+  if (subscription_it == subscriptions_.end()) {
+    return false;
+  }
+  auto topic_it = topics_.find(subscription_it->second.topic_name);
+  if (topic_it == topics_.end()) {
+    return false;
+  }
+  for (uint64_t publisher_id : topic_it->second.publisher_ids) {
+    const auto & publisher_info = publishers_.at(publisher_id);
+    auto publisher = publisher_info.publisher.lock();
+    if (!publisher) {
+      continue;
+    }
+    if (*publisher.get() == id) {
+      return get_incompatibility(publisher_info, subscription_it->second) == nullptr;
+    }
+  }
+  return false;
+}
+
 size_t
 IntraProcessManager::get_subscription_count(uint64_t intra_process_publisher_id) const
 {
@@ -141,13 +323,98 @@ IntraProcessManager::get_subscription_count(uint64_t intra_process_publisher_id)
     return 0;
   }
 
-  auto count =
-    publisher_it->second.take_shared_subscriptions.size() +
-    publisher_it->second.take_ownership_subscriptions.size();
+  return publisher_it->second->count().load();
+}
 
+size_t
+IntraProcessManager::get_full_subscription_count(uint64_t intra_process_publisher_id) const
+{
+  auto publisher_subscriptions = get_publisher_subscriptions(intra_process_publisher_id);
+  if (!publisher_subscriptions) {
+    return 0;
+  }
+  auto snapshot = publisher_subscriptions->load();
+  size_t count = 0;
+  for (const auto & subscription : snapshot->all_subscriptions) {
+    count += subscription->is_buffer_full() ? 1 : 0;
+  }
+  for (const auto & subscription : snapshot->serialized_subscriptions) {
+    count += subscription->is_buffer_full() ? 1 : 0;
+  }
   return count;
 }
 
+void
+IntraProcessManager::do_intra_process_publish_serialized(
+  const PublisherSubscriptions & publisher_subscriptions,
+  std::shared_ptr<rcl_serialized_message_t> message)
+{
+  auto snapshot = publisher_subscriptions.load();
+  const auto & subscriptions = snapshot->serialized_subscriptions;
+
+  for (auto it = subscriptions.begin(); it != subscriptions.end(); it++) {
+    if (std::next(it) == subscriptions.end()) {
+      // If this is the last subscription, give up ownership
+      (*it)->provide_serialized_intra_process_message(std::move(message));
+    } else {
+      // Copy the message since we have additional subscriptions to serve
+      (*it)->provide_serialized_intra_process_message(copy_serialized_message(*message));
+      copy_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+uint64_t
+IntraProcessManager::get_copy_count() const
+{
+  return copy_count_.load(std::memory_order_relaxed);
+}
+
+std::vector<IntraProcessConnection>
+IntraProcessManager::get_connections() const
+{
+  std::vector<IntraProcessConnection> connections;
+  {
+    std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+    for (const auto & topic_pair : topics_) {
+      for (uint64_t publisher_id : topic_pair.second.publisher_ids) {
+        for (uint64_t subscription_id : topic_pair.second.subscription_ids) {
+          IntraProcessConnection connection;
+          connection.topic_name = topic_pair.first;
+          connection.publisher_id = publisher_id;
+          connection.subscription_id = subscription_id;
+          const char * incompatibility = get_incompatibility(
+            publishers_.at(publisher_id), subscriptions_.at(subscription_id));
+          connection.intra_process = incompatibility == nullptr;
+          if (incompatibility) {
+            connection.reason = incompatibility;
+          }
+          connections.push_back(std::move(connection));
+        }
+      }
+    }
+  }
+  std::sort(
+    connections.begin(), connections.end(),
+    [](const IntraProcessConnection & a, const IntraProcessConnection & b) {
+      return std::tie(a.topic_name, a.publisher_id, a.subscription_id) <
+      std::tie(b.topic_name, b.publisher_id, b.subscription_id);
+    });
+  return connections;
+}
+
+IntraProcessManager::PublisherSubscriptions::SharedPtr
+IntraProcessManager::get_publisher_subscriptions(uint64_t intra_process_publisher_id) const
+{
+  std::shared_lock<std::shared_timed_mutex> lock(mutex_);
+
+  auto publisher_it = pub_to_subs_.find(intra_process_publisher_id);
+  if (publisher_it == pub_to_subs_.end()) {
+    return nullptr;
+  }
+  return publisher_it->second;
+}
+
 SubscriptionIntraProcessBase::SharedPtr
 IntraProcessManager::get_subscription_intra_process(uint64_t intra_process_subscription_id)
 {
@@ -184,43 +451,122 @@ IntraProcessManager::get_next_unique_id()
 }
 
 void
-IntraProcessManager::insert_sub_id_for_pub(
-  uint64_t sub_id,
+IntraProcessManager::update_subscriptions_of_pub(
   uint64_t pub_id,
-  bool use_take_shared_method)
+  const SubscriptionInfo & subscription_info,
+  bool add)
 {
-  if (use_take_shared_method) {
-    pub_to_subs_[pub_id].take_shared_subscriptions.push_back(sub_id);
+  const auto & subscription = subscription_info.subscription;
+  auto & publisher_subscriptions = pub_to_subs_[pub_id];
+  // Copy the current snapshot, publishers may be reading it.
+  auto subscriptions = std::make_shared<SplittedSubscriptions>(*publisher_subscriptions->load());
+  const auto & ring = subscriptions->broadcast_ring;
+  bool broadcast =
+    ring && subscription_info.can_read_broadcast &&
+    subscription_info.qos.history != RMW_QOS_POLICY_HISTORY_KEEP_ALL &&
+    subscription_info.qos.depth > 0 && subscription_info.qos.depth <= ring->capacity();
+  auto * subscription_list = &subscriptions->take_ownership_subscriptions;
+  if (subscription_info.is_serialized) {
+    subscription_list = &subscriptions->serialized_subscriptions;
+  } else if (broadcast) {
+    subscription_list = &subscriptions->broadcast_subscriptions;
+  } else if (subscription_info.use_take_shared_method) {
+    subscription_list = &subscriptions->take_shared_subscriptions;
+  }
+  if (add) {
+    if (broadcast) {
+      subscription->add_broadcast_reader(ring);
+    }
+    subscription_list->push_back(subscription);
   } else {
-    pub_to_subs_[pub_id].take_ownership_subscriptions.push_back(sub_id);
+    subscription_list->erase(
+      std::remove(subscription_list->begin(), subscription_list->end(), subscription),
+      subscription_list->end());
+    if (broadcast) {
+      subscription->remove_broadcast_reader(ring);
+    }
   }
+  subscriptions->all_subscriptions = subscriptions->take_shared_subscriptions;
+  subscriptions->all_subscriptions.insert(
+    subscriptions->all_subscriptions.end(),
+    subscriptions->take_ownership_subscriptions.begin(),
+    subscriptions->take_ownership_subscriptions.end());
+  subscriptions->all_subscriptions.insert(
+    subscriptions->all_subscriptions.end(),
+    subscriptions->broadcast_subscriptions.begin(),
+    subscriptions->broadcast_subscriptions.end());
+  publisher_subscriptions->store(std::move(subscriptions));
 }
 
-bool
-IntraProcessManager::can_communicate(
-  PublisherInfo pub_info,
-  SubscriptionInfo sub_info) const
+void
+IntraProcessManager::remove_broadcast_readers(const SplittedSubscriptions & subscriptions)
 {
-  // publisher and subscription must be on the same topic
-  if (strcmp(pub_info.topic_name, sub_info.topic_name) != 0) {
-    return false;
+  for (const auto & subscription : subscriptions.broadcast_subscriptions) {
+    subscription->remove_broadcast_reader(subscriptions.broadcast_ring);
   }
+}
 
+const char *
+IntraProcessManager::get_incompatibility(
+  const PublisherInfo & pub_info,
+  const SubscriptionInfo & sub_info)
+{
   // TODO(alsora): the following checks for qos compatibility should be provided by the RMW
   // a reliable subscription can't be connected with a best effort publisher
   if (
     sub_info.qos.reliability == RMW_QOS_POLICY_RELIABILITY_RELIABLE &&
     pub_info.qos.reliability == RMW_QOS_POLICY_RELIABILITY_BEST_EFFORT)
   {
-    return false;
+    return "reliable subscription and best effort publisher";
   }
 
   // a publisher and a subscription with different durability can't communicate
   if (sub_info.qos.durability != pub_info.qos.durability) {
-    return false;
+    return "different durability";
+  }
+
+  // the messages are given as they are, unless the subscription takes them serialized
+  if (!sub_info.is_serialized && *sub_info.message_type != *pub_info.message_type) {
+    return "different message types";
   }
 
-  return true;
+  return nullptr;
+}
+
+void
+IntraProcessManager::notify_subscriptions(
+  const std::vector<SubscriptionIntraProcessBase::SharedPtr> & subscriptions)
+{
+  struct WakeUp
+  {
+    const rcl_wait_set_t * wait_set;
+    uint64_t stamp;
+    SubscriptionIntraProcessBase * subscription;
+  };
+  // Reused by the publishing thread, so that notifying doesn't allocate once warmed up.
+  thread_local std::vector<WakeUp> wake_ups;
+
+  for (auto & subscription : subscriptions) {
+    uint64_t stamp = 0;
+    const rcl_wait_set_t * wait_set = subscription->get_last_wait_set(stamp);
+    if (!wait_set) {
+      subscription->trigger_guard_condition();
+      continue;
+    }
+    auto it = std::find_if(
+      wake_ups.begin(), wake_ups.end(),
+      [wait_set](const WakeUp & wake_up) {return wake_up.wait_set == wait_set;});
+    if (it == wake_ups.end()) {
+      wake_ups.push_back({wait_set, stamp, subscription.get()});
+    } else if (stamp > it->stamp) {
+      it->stamp = stamp;
+      it->subscription = subscription.get();
+    }
+  }
+  for (auto & wake_up : wake_ups) {
+    wake_up.subscription->trigger_guard_condition();
+  }
+  wake_ups.clear();
 }
 
 }  // namespace experimental
@@ -0,0 +1,161 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/experimental/intra_process_service_manager.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "rclcpp/experimental/client_intra_process.hpp"
+#include "rclcpp/experimental/service_intra_process.hpp"
+
+namespace
+{
+
+// Start of the writer guid of the requests passed within the process, followed by the client id.
+constexpr char kIntraProcessGuidPrefix[] = {'r', 'c', 'l', 'c', 'p', 'p', 'i', 'p'};
+
+}  // namespace
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+static_assert(
+  sizeof(rmw_request_id_t::writer_guid) >= sizeof(kIntraProcessGuidPrefix) + sizeof(uint64_t),
+  "the writer guid can't hold the client id");
+
+IntraProcessServiceManager::IntraProcessServiceManager()
+: next_id_(1)
+{}
+
+IntraProcessServiceManager::~IntraProcessServiceManager()
+{}
+
+uint64_t
+IntraProcessServiceManager::add_service(std::shared_ptr<ServiceIntraProcess> service)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t id = next_id_++;
+  std::string service_name = service->get_service_name();
+  services_[service_name].push_back(ServiceEntry{id, &service->get_service_type(), service});
+  service_names_[id] = std::move(service_name);
+  return id;
+}
+
+void
+IntraProcessServiceManager::remove_service(uint64_t service_id)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto name_it = service_names_.find(service_id);
+  if (name_it == service_names_.end()) {
+    return;
+  }
+  auto it = services_.find(name_it->second);
+  auto & entries = it->second;
+  entries.erase(
+    std::remove_if(
+      entries.begin(), entries.end(),
+      [service_id](const ServiceEntry & entry) {return entry.id == service_id;}),
+    entries.end());
+  if (entries.empty()) {
+    services_.erase(it);
+  }
+  service_names_.erase(name_it);
+}
+
+std::shared_ptr<ServiceIntraProcess>
+IntraProcessServiceManager::get_service(
+  const std::string & service_name, const std::type_info & service_type) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = services_.find(service_name);
+  if (it == services_.end()) {
+    return nullptr;
+  }
+  for (const auto & entry : it->second) {
+    if (*entry.type != service_type) {
+      continue;
+    }
+    auto service = entry.service.lock();
+    if (service) {
+      return service;
+    }
+  }
+  return nullptr;
+}
+
+uint64_t
+IntraProcessServiceManager::add_client(std::shared_ptr<ClientIntraProcess> client)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  uint64_t id = next_id_++;
+  clients_[id] = client;
+  return id;
+}
+
+void
+IntraProcessServiceManager::remove_client(uint64_t client_id)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  clients_.erase(client_id);
+}
+
+void
+IntraProcessServiceManager::set_request_header(
+  uint64_t client_id, int64_t sequence_number, rmw_request_id_t & header)
+{
+  std::memset(header.writer_guid, 0, sizeof(header.writer_guid));
+  std::memcpy(header.writer_guid, kIntraProcessGuidPrefix, sizeof(kIntraProcessGuidPrefix));
+  std::memcpy(
+    header.writer_guid + sizeof(kIntraProcessGuidPrefix), &client_id, sizeof(client_id));
+  header.sequence_number = sequence_number;
+}
+
+bool
+IntraProcessServiceManager::is_intra_process_request(const rmw_request_id_t & header)
+{
+  return 0 == std::memcmp(
+    header.writer_guid, kIntraProcessGuidPrefix, sizeof(kIntraProcessGuidPrefix));
+}
+
+void
+IntraProcessServiceManager::send_response(
+  const rmw_request_id_t & header, std::shared_ptr<void> response) const
+{
+  uint64_t client_id;
+  std::memcpy(
+    &client_id, header.writer_guid + sizeof(kIntraProcessGuidPrefix), sizeof(client_id));
+  std::shared_ptr<ClientIntraProcess> client;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = clients_.find(client_id);
+    if (it == clients_.end()) {
+      return;
+    }
+    client = it->second.lock();
+  }
+  if (client) {
+    client->provide_response(header.sequence_number, std::move(response));
+  }
+}
+
+}  // namespace experimental
+}  // namespace rclcpp
@@ -16,11 +16,19 @@
 
 #include "rclcpp/logger.hpp"
 
+#include "rclcpp/exceptions.hpp"
 #include "rclcpp/logging.hpp"
+#include "rcutils/error_handling.h"
 
 namespace rclcpp
 {
 
+namespace detail
+{
+// Starts above the epoch of new loggers, so that they look their level up first.
+std::atomic<uint64_t> g_logger_level_epoch{1};
+}  // namespace detail
+
 Logger
 get_logger(const std::string & name)
 {
@@ -44,4 +52,38 @@ get_node_logger(const rcl_node_t * node)
   return rclcpp::get_logger(logger_name);
 }
 
+void
+invalidate_logger_levels()
+{
+  detail::g_logger_level_epoch.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void
+Logger::update_effective_level(uint64_t epoch) const
+{
+  int level = rcutils_logging_get_logger_effective_level(state_->name.c_str());
+  if (level < 0) {
+    // Logging isn't initialized yet, let rcutils decide until the levels change.
+    rcutils_reset_error();
+    level = RCUTILS_LOG_SEVERITY_UNSET;
+  }
+  state_->effective_level.store(level, std::memory_order_relaxed);
+  state_->level_epoch.store(epoch, std::memory_order_release);
+}
+
+void
+Logger::set_level(Level level)
+{
+  if (!state_) {
+    return;
+  }
+  rcutils_ret_t ret = rcutils_logging_set_logger_level(
+    state_->name.c_str(), static_cast<int>(level));
+  if (RCUTILS_RET_OK != ret) {
+    exceptions::throw_from_rcl_error(
+      ret, "failed to set logger level", rcutils_get_error_state(), rcutils_reset_error);
+  }
+  invalidate_logger_levels();
+}
+
 }  // namespace rclcpp
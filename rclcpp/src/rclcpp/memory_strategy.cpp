@@ -14,6 +14,7 @@
 
 #include "rclcpp/memory_strategy.hpp"
 #include <memory>
+#include <utility>
 
 using rclcpp::memory_strategy::MemoryStrategy;
 
@@ -282,3 +283,15 @@ MemoryStrategy::get_group_by_waitable(
   }
   return nullptr;
 }
+
+void
+MemoryStrategy::set_timer_manager(rclcpp::executor::TimerManager::SharedPtr timer_manager)
+{
+  timer_manager_ = std::move(timer_manager);
+}
+
+void
+MemoryStrategy::set_executor(const rclcpp::executor::Executor * executor)
+{
+  executor_ = executor;
+}
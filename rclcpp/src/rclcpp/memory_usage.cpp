@@ -0,0 +1,100 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/memory_usage.hpp"
+
+#include <sstream>
+#include <string>
+
+namespace rclcpp
+{
+
+size_t
+MemoryUsage::total_bytes() const
+{
+  return entity_bytes + intra_process_buffer_bytes + message_pool_bytes + pending_request_bytes;
+}
+
+MemoryUsage &
+MemoryUsage::operator+=(const MemoryUsage & other)
+{
+  entity_bytes += other.entity_bytes;
+  intra_process_buffer_bytes += other.intra_process_buffer_bytes;
+  message_pool_bytes += other.message_pool_bytes;
+  pending_request_bytes += other.pending_request_bytes;
+  return *this;
+}
+
+MemoryUsage
+NodeMemoryUsage::total() const
+{
+  MemoryUsage total;
+  for (const auto & entity : entities) {
+    total += entity.usage;
+  }
+  return total;
+}
+
+const char *
+to_string(MemoryUsageEntityKind kind)
+{
+  switch (kind) {
+    case MemoryUsageEntityKind::Publisher:
+      return "publisher";
+    case MemoryUsageEntityKind::Subscription:
+      return "subscription";
+    case MemoryUsageEntityKind::Service:
+      return "service";
+    case MemoryUsageEntityKind::Client:
+      return "client";
+  }
+  return "unknown";
+}
+
+namespace
+{
+
+void
+write_usage(std::ostringstream & stream, const MemoryUsage & usage)
+{
+  stream << usage.total_bytes() << " bytes (entity " << usage.entity_bytes;
+  if (usage.intra_process_buffer_bytes > 0) {
+    stream << ", intra-process buffer " << usage.intra_process_buffer_bytes;
+  }
+  if (usage.message_pool_bytes > 0) {
+    stream << ", message pool " << usage.message_pool_bytes;
+  }
+  if (usage.pending_request_bytes > 0) {
+    stream << ", pending requests " << usage.pending_request_bytes;
+  }
+  stream << ")";
+}
+
+}  // namespace
+
+std::string
+to_string(const NodeMemoryUsage & node_memory_usage)
+{
+  std::ostringstream stream;
+  stream << "memory usage: ";
+  write_usage(stream, node_memory_usage.total());
+  for (const auto & entity : node_memory_usage.entities) {
+    stream << "\n  " << to_string(entity.kind) << " '" << entity.name << "': ";
+    write_usage(stream, entity.usage);
+  }
+  return stream.str();
+}
+
+}  // namespace rclcpp
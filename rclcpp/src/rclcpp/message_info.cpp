@@ -0,0 +1,150 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/message_info.hpp"
+
+#include <type_traits>
+#include <utility>
+
+namespace
+{
+
+// The timestamps were added to rmw_message_info_t by later versions of rmw.
+template<typename InfoT, typename = void>
+struct has_source_timestamp : std::false_type
+{};
+
+template<typename InfoT>
+struct has_source_timestamp<
+  InfoT, decltype((void)std::declval<const InfoT &>().source_timestamp)>
+  : std::true_type
+{};
+
+template<typename InfoT, typename = void>
+struct has_received_timestamp : std::false_type
+{};
+
+template<typename InfoT>
+struct has_received_timestamp<
+  InfoT, decltype((void)std::declval<const InfoT &>().received_timestamp)>
+  : std::true_type
+{};
+
+template<typename InfoT>
+rcutils_time_point_value_t
+get_source_timestamp(const InfoT & info, std::true_type)
+{
+  return static_cast<rcutils_time_point_value_t>(info.source_timestamp);
+}
+
+template<typename InfoT>
+rcutils_time_point_value_t
+get_source_timestamp(const InfoT &, std::false_type)
+{
+  return 0;
+}
+
+template<typename InfoT>
+rcutils_time_point_value_t
+get_received_timestamp(const InfoT & info, std::true_type)
+{
+  return static_cast<rcutils_time_point_value_t>(info.received_timestamp);
+}
+
+template<typename InfoT>
+rcutils_time_point_value_t
+get_received_timestamp(const InfoT &, std::false_type)
+{
+  return 0;
+}
+
+rcutils_time_point_value_t
+system_now()
+{
+  rcutils_time_point_value_t now = 0;
+  if (RCUTILS_RET_OK != rcutils_system_time_now(&now)) {
+    return 0;
+  }
+  return now;
+}
+
+}  // namespace
+
+namespace rclcpp
+{
+
+MessageInfo::MessageInfo()
+: rmw_message_info_(),
+  source_timestamp_(0),
+  received_timestamp_(0)
+{}
+
+MessageInfo::MessageInfo(const rmw_message_info_t & rmw_message_info)
+: MessageInfo(
+    rmw_message_info,
+    get_received_timestamp(rmw_message_info, has_received_timestamp<rmw_message_info_t>()))
+{
+  if (0 == received_timestamp_) {
+    received_timestamp_ = system_now();
+  }
+}
+
+MessageInfo::MessageInfo(
+  const rmw_message_info_t & rmw_message_info,
+  rcutils_time_point_value_t received_timestamp)
+: rmw_message_info_(rmw_message_info),
+  source_timestamp_(
+    get_source_timestamp(rmw_message_info, has_source_timestamp<rmw_message_info_t>())),
+  received_timestamp_(received_timestamp)
+{}
+
+const rmw_message_info_t &
+MessageInfo::get_rmw_message_info() const
+{
+  return rmw_message_info_;
+}
+
+MessageInfo::operator const rmw_message_info_t &() const
+{
+  return rmw_message_info_;
+}
+
+rcutils_time_point_value_t
+MessageInfo::get_source_timestamp() const
+{
+  return source_timestamp_;
+}
+
+void
+MessageInfo::set_source_timestamp(rcutils_time_point_value_t source_timestamp)
+{
+  source_timestamp_ = source_timestamp;
+}
+
+rcutils_time_point_value_t
+MessageInfo::get_received_timestamp() const
+{
+  return received_timestamp_;
+}
+
+std::chrono::nanoseconds
+MessageInfo::get_transport_latency() const
+{
+  if (0 == source_timestamp_ || 0 == received_timestamp_) {
+    return std::chrono::nanoseconds(-1);
+  }
+  return std::chrono::nanoseconds(received_timestamp_ - source_timestamp_);
+}
+
+}  // namespace rclcpp
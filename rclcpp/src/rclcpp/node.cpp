@@ -20,6 +20,8 @@
 #include <utility>
 #include <vector>
 
+#include "rclcpp/create_generic_publisher.hpp"
+#include "rclcpp/create_generic_subscription.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/graph_listener.hpp"
 #include "rclcpp/node.hpp"
@@ -103,11 +105,15 @@ Node::Node(
       namespace_,
       options.context(),
       *(options.get_rcl_node_options()),
-      options.use_intra_process_comms())),
-  node_graph_(new rclcpp::node_interfaces::NodeGraph(node_base_.get())),
-  node_logging_(new rclcpp::node_interfaces::NodeLogging(node_base_.get())),
+      options.use_intra_process_comms(),
+      options.entity_arena(),
+      options.message_pools())),
+  node_graph_(
+    new rclcpp::node_interfaces::NodeGraph(node_base_.get(), options.use_graph_cache())),
+  node_logging_(new rclcpp::node_interfaces::NodeLogging(
+      node_base_.get(), options.rosout_rate_limit())),
   node_timers_(new rclcpp::node_interfaces::NodeTimers(node_base_.get())),
-  node_topics_(new rclcpp::node_interfaces::NodeTopics(node_base_.get())),
+  node_topics_(new rclcpp::node_interfaces::NodeTopics(node_base_.get(), node_graph_.get())),
   node_services_(new rclcpp::node_interfaces::NodeServices(node_base_.get())),
   node_clock_(new rclcpp::node_interfaces::NodeClock(
       node_base_,
@@ -128,7 +134,11 @@ Node::Node(
       options.parameter_event_qos(),
       options.parameter_event_publisher_options(),
       options.allow_undeclared_parameters(),
-      options.automatically_declare_parameters_from_overrides()
+      options.automatically_declare_parameters_from_overrides(),
+      options.parameter_event_coalescing_period(),
+      node_timers_,
+      options.lazy_parameter_event_publisher(),
+      options.parameter_snapshot_path()
     )),
   node_time_source_(new rclcpp::node_interfaces::NodeTimeSource(
       node_base_,
@@ -222,6 +232,38 @@ Node::group_in_node(rclcpp::callback_group::CallbackGroup::SharedPtr group)
   return node_base_->callback_group_in_node(group);
 }
 
+std::shared_ptr<rclcpp::GenericPublisher>
+Node::create_generic_publisher(
+  const std::string & topic_name,
+  const std::string & topic_type,
+  const rclcpp::QoS & qos,
+  const rclcpp::PublisherOptions & options)
+{
+  return rclcpp::create_generic_publisher(
+    node_topics_,
+    extend_name_with_sub_namespace(topic_name, this->get_sub_namespace()),
+    topic_type,
+    qos,
+    options);
+}
+
+std::shared_ptr<rclcpp::GenericSubscription>
+Node::create_generic_subscription(
+  const std::string & topic_name,
+  const std::string & topic_type,
+  const rclcpp::QoS & qos,
+  rclcpp::GenericSubscription::CallbackType callback,
+  const rclcpp::SubscriptionOptions & options)
+{
+  return rclcpp::create_generic_subscription(
+    node_topics_,
+    extend_name_with_sub_namespace(topic_name, this->get_sub_namespace()),
+    topic_type,
+    qos,
+    std::move(callback),
+    options);
+}
+
 const rclcpp::ParameterValue &
 Node::declare_parameter(
   const std::string & name,
@@ -236,6 +278,18 @@ Node::declare_parameter(
     ignore_override);
 }
 
+std::vector<rclcpp::ParameterValue>
+Node::declare_parameters(
+  const std::vector<rclcpp::Parameter> & parameters,
+  const std::vector<rcl_interfaces::msg::ParameterDescriptor> & parameter_descriptors,
+  bool ignore_overrides)
+{
+  return this->node_parameters_->declare_parameters(
+    parameters,
+    parameter_descriptors,
+    ignore_overrides);
+}
+
 void
 Node::undeclare_parameter(const std::string & name)
 {
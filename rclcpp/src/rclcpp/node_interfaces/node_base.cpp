@@ -15,11 +15,17 @@
 #include <string>
 #include <limits>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include "rclcpp/node_interfaces/node_base.hpp"
 
 #include "rcl/arguments.h"
+#include "rcl/remap.h"
+#include "rclcpp/detail/make_entity_shared.hpp"
+#include "rclcpp/detail/utilities.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rcutils/logging_macros.h"
 #include "rmw/validate_namespace.h"
@@ -29,19 +35,145 @@ using rclcpp::exceptions::throw_from_rcl_error;
 
 using rclcpp::node_interfaces::NodeBase;
 
+namespace
+{
+
+void
+finalize_rcl_node(rcl_node_t * node)
+{
+  if (rcl_node_fini(node) != RCL_RET_OK) {
+    RCUTILS_LOG_ERROR_NAMED(
+      "rclcpp",
+      "Error in destruction of rcl node handle: %s", rcl_get_error_string().str);
+  }
+  delete node;
+}
+
+void
+throw_if_invalid_node_name(const std::string & node_name)
+{
+  int validation_result;
+  size_t invalid_index;
+  rmw_ret_t rmw_ret =
+    rmw_validate_node_name(node_name.c_str(), &validation_result, &invalid_index);
+  if (rmw_ret != RMW_RET_OK) {
+    if (rmw_ret == RMW_RET_INVALID_ARGUMENT) {
+      throw_from_rcl_error(RCL_RET_INVALID_ARGUMENT, "failed to validate node name");
+    }
+    throw_from_rcl_error(RCL_RET_ERROR, "failed to validate node name");
+  }
+
+  if (validation_result != RMW_NODE_NAME_VALID) {
+    throw rclcpp::exceptions::InvalidNodeNameError(
+            node_name.c_str(),
+            rmw_node_name_validation_result_string(validation_result),
+            invalid_index);
+  }
+}
+
+void
+throw_if_invalid_namespace(const std::string & namespace_)
+{
+  int validation_result;
+  size_t invalid_index;
+  rmw_ret_t rmw_ret =
+    rmw_validate_namespace(namespace_.c_str(), &validation_result, &invalid_index);
+  if (rmw_ret != RMW_RET_OK) {
+    if (rmw_ret == RMW_RET_INVALID_ARGUMENT) {
+      throw_from_rcl_error(RCL_RET_INVALID_ARGUMENT, "failed to validate namespace");
+    }
+    throw_from_rcl_error(RCL_RET_ERROR, "failed to validate namespace");
+  }
+
+  if (validation_result != RMW_NAMESPACE_VALID) {
+    throw rclcpp::exceptions::InvalidNamespaceError(
+            namespace_.c_str(),
+            rmw_namespace_validation_result_string(validation_result),
+            invalid_index);
+  }
+}
+
+// Apply rcl_remap_node_name() or rcl_remap_node_namespace(), which have the same signature.
+template<typename RemapT>
+std::string
+remap_node(
+  RemapT remap,
+  const rcl_node_options_t & options,
+  const rcl_arguments_t * global_arguments,
+  const std::string & node_name,
+  const std::string & value)
+{
+  char * remapped = nullptr;
+  rcl_ret_t ret = remap(
+    &options.arguments, global_arguments, node_name.c_str(), options.allocator, &remapped);
+  if (RCL_RET_OK != ret) {
+    throw_from_rcl_error(ret, "failed to remap the node name or namespace");
+  }
+  if (nullptr == remapped) {
+    return value;
+  }
+  std::string result(remapped);
+  options.allocator.deallocate(remapped, options.allocator.state);
+  return result;
+}
+
+/// The rcl node shared by the nodes of a context, see InitOptions::share_participant.
+class SharedRclNode
+{
+public:
+  std::shared_ptr<rcl_node_t>
+  get(rclcpp::Context & context)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto node = node_.lock();
+    if (node) {
+      return node;
+    }
+    rcl_node_options_t options = rcl_node_get_default_options();
+    // The names given to rcl are already resolved with the arguments of each node.
+    options.use_global_arguments = false;
+    // The logs of the nodes use their own loggers.
+    options.enable_rosout = false;
+    std::unique_ptr<rcl_node_t> rcl_node(new rcl_node_t(rcl_get_zero_initialized_node()));
+    rcl_ret_t ret = rcl_node_init(
+      rcl_node.get(), "_rclcpp_shared_participant", "/",
+      context.get_rcl_context().get(), &options);
+    if (ret != RCL_RET_OK) {
+      throw_from_rcl_error(ret, "failed to initialize the shared rcl node");
+    }
+    node.reset(rcl_node.release(), &finalize_rcl_node);
+    node_ = node;
+    return node;
+  }
+
+private:
+  std::mutex mutex_;
+  std::weak_ptr<rcl_node_t> node_;
+};
+
+}  // namespace
+
 NodeBase::NodeBase(
   const std::string & node_name,
   const std::string & namespace_,
   rclcpp::Context::SharedPtr context,
   const rcl_node_options_t & rcl_node_options,
-  bool use_intra_process_default)
+  bool use_intra_process_default,
+  rclcpp::allocator::Arena::SharedPtr entity_arena,
+  rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry::SharedPtr
+  message_pools)
 : context_(context),
   use_intra_process_default_(use_intra_process_default),
+  entity_arena_(std::move(entity_arena)),
+  message_pools_(std::move(message_pools)),
   node_handle_(nullptr),
+  shares_rcl_node_(false),
   default_callback_group_(nullptr),
   associated_with_executor_(false),
   notify_guard_condition_is_valid_(false)
 {
+  context_->check_entity_creation("node");
+
   // Setup the guard condition that is notified when changes occur in the graph.
   rcl_guard_condition_options_t guard_condition_options = rcl_guard_condition_get_default_options();
   rcl_ret_t ret = rcl_guard_condition_init(
@@ -60,75 +192,41 @@ NodeBase::NodeBase(
       }
     };
 
-  // Create the rcl node and store it in a shared_ptr with a custom destructor.
-  std::unique_ptr<rcl_node_t> rcl_node(new rcl_node_t(rcl_get_zero_initialized_node()));
-
-  ret = rcl_node_init(
-    rcl_node.get(),
-    node_name.c_str(), namespace_.c_str(),
-    context_->get_rcl_context().get(), &rcl_node_options);
-  if (ret != RCL_RET_OK) {
-    // Finalize the interrupt guard condition.
-    finalize_notify_guard_condition();
-
-    if (ret == RCL_RET_NODE_INVALID_NAME) {
-      rcl_reset_error();  // discard rcl_node_init error
-      int validation_result;
-      size_t invalid_index;
-      rmw_ret_t rmw_ret =
-        rmw_validate_node_name(node_name.c_str(), &validation_result, &invalid_index);
-      if (rmw_ret != RMW_RET_OK) {
-        if (rmw_ret == RMW_RET_INVALID_ARGUMENT) {
-          throw_from_rcl_error(RCL_RET_INVALID_ARGUMENT, "failed to validate node name");
-        }
-        throw_from_rcl_error(RCL_RET_ERROR, "failed to validate node name");
-      }
-
-      if (validation_result != RMW_NODE_NAME_VALID) {
-        throw rclcpp::exceptions::InvalidNodeNameError(
-                node_name.c_str(),
-                rmw_node_name_validation_result_string(validation_result),
-                invalid_index);
-      } else {
-        throw std::runtime_error("valid rmw node name but invalid rcl node name");
-      }
+  if (context_->get_init_options().share_participant) {
+    try {
+      init_shared_rcl_node(node_name, namespace_, rcl_node_options);
+    } catch (...) {
+      finalize_notify_guard_condition();
+      throw;
     }
+  } else {
+    // Create the rcl node and store it in a shared_ptr with a custom destructor.
+    std::unique_ptr<rcl_node_t> rcl_node(new rcl_node_t(rcl_get_zero_initialized_node()));
+
+    ret = rcl_node_init(
+      rcl_node.get(),
+      node_name.c_str(), namespace_.c_str(),
+      context_->get_rcl_context().get(), &rcl_node_options);
+    if (ret != RCL_RET_OK) {
+      // Finalize the interrupt guard condition.
+      finalize_notify_guard_condition();
 
-    if (ret == RCL_RET_NODE_INVALID_NAMESPACE) {
-      rcl_reset_error();  // discard rcl_node_init error
-      int validation_result;
-      size_t invalid_index;
-      rmw_ret_t rmw_ret =
-        rmw_validate_namespace(namespace_.c_str(), &validation_result, &invalid_index);
-      if (rmw_ret != RMW_RET_OK) {
-        if (rmw_ret == RMW_RET_INVALID_ARGUMENT) {
-          throw_from_rcl_error(RCL_RET_INVALID_ARGUMENT, "failed to validate namespace");
-        }
-        throw_from_rcl_error(RCL_RET_ERROR, "failed to validate namespace");
+      if (ret == RCL_RET_NODE_INVALID_NAME) {
+        rcl_reset_error();  // discard rcl_node_init error
+        throw_if_invalid_node_name(node_name);
+        throw std::runtime_error("valid rmw node name but invalid rcl node name");
       }
 
-      if (validation_result != RMW_NAMESPACE_VALID) {
-        throw rclcpp::exceptions::InvalidNamespaceError(
-                namespace_.c_str(),
-                rmw_namespace_validation_result_string(validation_result),
-                invalid_index);
-      } else {
+      if (ret == RCL_RET_NODE_INVALID_NAMESPACE) {
+        rcl_reset_error();  // discard rcl_node_init error
+        throw_if_invalid_namespace(namespace_);
         throw std::runtime_error("valid rmw node namespace but invalid rcl node namespace");
       }
+      throw_from_rcl_error(ret, "failed to initialize rcl node");
     }
-    throw_from_rcl_error(ret, "failed to initialize rcl node");
-  }
 
-  node_handle_.reset(
-    rcl_node.release(),
-    [](rcl_node_t * node) -> void {
-      if (rcl_node_fini(node) != RCL_RET_OK) {
-        RCUTILS_LOG_ERROR_NAMED(
-          "rclcpp",
-          "Error in destruction of rcl node handle: %s", rcl_get_error_string().str);
-      }
-      delete node;
-    });
+    node_handle_.reset(rcl_node.release(), &finalize_rcl_node);
+  }
 
   // Create the default callback group.
   using rclcpp::callback_group::CallbackGroupType;
@@ -138,8 +236,56 @@ NodeBase::NodeBase(
   notify_guard_condition_is_valid_ = true;
 }
 
+void
+NodeBase::init_shared_rcl_node(
+  const std::string & node_name,
+  const std::string & node_namespace,
+  const rcl_node_options_t & rcl_node_options)
+{
+  // Resolved like rcl_node_init() does, and kept in rclcpp.
+  throw_if_invalid_node_name(node_name);
+  std::string absolute_namespace = node_namespace;
+  if (absolute_namespace.empty() || absolute_namespace.front() != '/') {
+    absolute_namespace = "/" + absolute_namespace;
+  }
+  throw_if_invalid_namespace(absolute_namespace);
+
+  rcl_ret_t ret = rcl_node_options_copy(&rcl_node_options, &node_options_);
+  if (ret != RCL_RET_OK) {
+    throw_from_rcl_error(ret, "failed to copy the node options");
+  }
+  try {
+    const rcl_arguments_t * global_arguments = nullptr;
+    if (node_options_.use_global_arguments) {
+      global_arguments = &(context_->get_rcl_context()->global_arguments);
+    }
+    node_name_ = remap_node(
+      &rcl_remap_node_name, node_options_, global_arguments, node_name, node_name);
+    node_namespace_ = remap_node(
+      &rcl_remap_node_namespace, node_options_, global_arguments, node_name, absolute_namespace);
+    throw_if_invalid_node_name(node_name_);
+    throw_if_invalid_namespace(node_namespace_);
+
+    node_handle_ = context_->get_sub_context<SharedRclNode>()->get(*context_);
+  } catch (...) {
+    if (rcl_node_options_fini(&node_options_) != RCL_RET_OK) {
+      rcl_reset_error();
+    }
+    throw;
+  }
+  fully_qualified_name_ =
+    (node_namespace_ == "/" ? "" : node_namespace_) + "/" + node_name_;
+  shares_rcl_node_ = true;
+}
+
 NodeBase::~NodeBase()
 {
+  if (shares_rcl_node_ && rcl_node_options_fini(&node_options_) != RCL_RET_OK) {
+    RCUTILS_LOG_ERROR_NAMED(
+      "rclcpp",
+      "failed to finalize the node options: %s", rcl_get_error_string().str);
+    rcl_reset_error();
+  }
   // Finalize the interrupt guard condition after removing self from graph listener.
   {
     std::lock_guard<std::recursive_mutex> notify_condition_lock(notify_guard_condition_mutex_);
@@ -155,18 +301,27 @@ NodeBase::~NodeBase()
 const char *
 NodeBase::get_name() const
 {
+  if (shares_rcl_node_) {
+    return node_name_.c_str();
+  }
   return rcl_node_get_name(node_handle_.get());
 }
 
 const char *
 NodeBase::get_namespace() const
 {
+  if (shares_rcl_node_) {
+    return node_namespace_.c_str();
+  }
   return rcl_node_get_namespace(node_handle_.get());
 }
 
 const char *
 NodeBase::get_fully_qualified_name() const
 {
+  if (shares_rcl_node_) {
+    return fully_qualified_name_.c_str();
+  }
   return rcl_node_get_fully_qualified_name(node_handle_.get());
 }
 
@@ -200,6 +355,36 @@ NodeBase::get_shared_rcl_node_handle() const
   return node_handle_;
 }
 
+bool
+NodeBase::shares_rcl_node() const
+{
+  return shares_rcl_node_;
+}
+
+const rcl_node_options_t *
+NodeBase::get_rcl_node_options() const
+{
+  if (shares_rcl_node_) {
+    return &node_options_;
+  }
+  return rcl_node_get_options(node_handle_.get());
+}
+
+std::string
+NodeBase::resolve_topic_or_service_name(const std::string & name, bool is_service) const
+{
+  const rcl_node_options_t * node_options = get_rcl_node_options();
+  if (nullptr == node_options) {
+    throw std::runtime_error("Need valid node options to resolve a name");
+  }
+  const rcl_arguments_t * global_arguments = nullptr;
+  if (node_options->use_global_arguments) {
+    global_arguments = &(context_->get_rcl_context()->global_arguments);
+  }
+  return rclcpp::detail::resolve_topic_or_service_name(
+    name, get_name(), get_namespace(), *node_options, global_arguments, is_service);
+}
+
 bool
 NodeBase::assert_liveliness() const
 {
@@ -211,7 +396,7 @@ NodeBase::create_callback_group(rclcpp::callback_group::CallbackGroupType group_
 {
   using rclcpp::callback_group::CallbackGroup;
   using rclcpp::callback_group::CallbackGroupType;
-  auto group = CallbackGroup::SharedPtr(new CallbackGroup(group_type));
+  auto group = rclcpp::detail::make_entity_shared<CallbackGroup>(entity_arena_, group_type);
   callback_groups_.push_back(group);
   return group;
 }
@@ -263,8 +448,100 @@ NodeBase::acquire_notify_guard_condition_lock() const
   return std::unique_lock<std::recursive_mutex>(notify_guard_condition_mutex_);
 }
 
+rcl_ret_t
+NodeBase::trigger_notify_guard_condition()
+{
+  std::lock_guard<std::recursive_mutex> notify_condition_lock(notify_guard_condition_mutex_);
+  if (entity_creation_batch_depth_ > 0) {
+    notify_deferred_ = true;
+    return RCL_RET_OK;
+  }
+  return rcl_trigger_guard_condition(get_notify_guard_condition());
+}
+
+void
+NodeBase::begin_entity_creation_batch()
+{
+  std::lock_guard<std::recursive_mutex> notify_condition_lock(notify_guard_condition_mutex_);
+  ++entity_creation_batch_depth_;
+}
+
+void
+NodeBase::end_entity_creation_batch()
+{
+  std::lock_guard<std::recursive_mutex> notify_condition_lock(notify_guard_condition_mutex_);
+  if (0u == entity_creation_batch_depth_ || --entity_creation_batch_depth_ > 0 ||
+    !notify_deferred_)
+  {
+    return;
+  }
+  notify_deferred_ = false;
+  if (rcl_trigger_guard_condition(get_notify_guard_condition()) != RCL_RET_OK) {
+    RCUTILS_LOG_ERROR_NAMED(
+      "rclcpp",
+      "failed to notify wait set at the end of an entity creation batch: %s",
+      rcl_get_error_string().str);
+    rcl_reset_error();
+  }
+}
+
 bool
 NodeBase::get_use_intra_process_default() const
 {
   return use_intra_process_default_;
 }
+
+const rclcpp::allocator::Arena::SharedPtr &
+NodeBase::get_entity_arena() const
+{
+  return entity_arena_;
+}
+
+const rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry::SharedPtr &
+NodeBase::get_message_pools() const
+{
+  return message_pools_;
+}
+
+rclcpp::NodeMemoryUsage
+NodeBase::get_memory_usage() const
+{
+  rclcpp::NodeMemoryUsage node_memory_usage;
+  auto & entities = node_memory_usage.entities;
+  for (const auto & weak_group : callback_groups_) {
+    auto group = weak_group.lock();
+    if (!group) {
+      continue;
+    }
+    // The predicates return false to visit all the entities of the group.
+    group->find_publisher_ptrs_if(
+      [&entities](const rclcpp::PublisherBase::SharedPtr & publisher) {
+        entities.push_back(
+          {rclcpp::MemoryUsageEntityKind::Publisher, publisher->get_topic_name(),
+            publisher->get_memory_usage()});
+        return false;
+      });
+    group->find_subscription_ptrs_if(
+      [&entities](const rclcpp::SubscriptionBase::SharedPtr & subscription) {
+        entities.push_back(
+          {rclcpp::MemoryUsageEntityKind::Subscription, subscription->get_topic_name(),
+            subscription->get_memory_usage()});
+        return false;
+      });
+    group->find_service_ptrs_if(
+      [&entities](const rclcpp::ServiceBase::SharedPtr & service) {
+        entities.push_back(
+          {rclcpp::MemoryUsageEntityKind::Service, service->get_service_name(),
+            service->get_memory_usage()});
+        return false;
+      });
+    group->find_client_ptrs_if(
+      [&entities](const rclcpp::ClientBase::SharedPtr & client) {
+        entities.push_back(
+          {rclcpp::MemoryUsageEntityKind::Client, client->get_service_name(),
+            client->get_memory_usage()});
+        return false;
+      });
+  }
+  return node_memory_usage;
+}
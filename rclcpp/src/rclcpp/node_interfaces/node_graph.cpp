@@ -16,30 +16,149 @@
 
 #include <algorithm>
 #include <map>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "rcl/graph.h"
-#include "rcl/remap.h"
 #include "rclcpp/event.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/expand_topic_or_service_name.hpp"
+#include "rclcpp/experimental/shared_writer_manager.hpp"
 #include "rclcpp/graph_listener.hpp"
+#include "rclcpp/logging.hpp"
 #include "rclcpp/node_interfaces/node_graph_interface.hpp"
 
 using rclcpp::node_interfaces::NodeGraph;
 using rclcpp::exceptions::throw_from_rcl_error;
 using rclcpp::graph_listener::GraphListener;
 
-NodeGraph::NodeGraph(rclcpp::node_interfaces::NodeBaseInterface * node_base)
+class NodeGraph::GraphCache
+{
+public:
+  template<typename T>
+  struct Entry
+  {
+    /// Graph change count of the listener when the value was queried.
+    uint64_t change_count = 0;
+    bool valid = false;
+    T value;
+  };
+
+  /// Return the value of an entry, queried again if the graph changed since.
+  /**
+   * The query runs without the lock, so concurrent misses may query the graph more than once.
+   */
+  template<typename T, typename QueryT>
+  T
+  get(Entry<T> & entry, uint64_t change_count, QueryT query)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (entry.valid && entry.change_count == change_count) {
+        return entry.value;
+      }
+    }
+    T value = query();
+    std::lock_guard<std::mutex> lock(mutex_);
+    // A query which started before a newer one doesn't replace its result.
+    if (!entry.valid || entry.change_count <= change_count) {
+      entry.change_count = change_count;
+      entry.valid = true;
+      entry.value = value;
+    }
+    return value;
+  }
+
+  /// Copy a value of a topic to result, the values of the topics are dropped on graph changes.
+  /**
+   * The value is copy assigned to result, so e.g. the strings of a result reused across calls
+   * keep their storage.
+   */
+  template<typename T, typename QueryT>
+  void
+  get_topic_value(
+    std::map<std::string, T> & values, const std::string & topic_name,
+    uint64_t change_count, QueryT query, T & result)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      update_topic_values_locked(change_count);
+      auto it = values.find(topic_name);
+      if (it != values.end()) {
+        result = it->second;
+        return;
+      }
+    }
+    T value = query();
+    result = value;
+    std::lock_guard<std::mutex> lock(mutex_);
+    update_topic_values_locked(change_count);
+    if (topic_values_change_count_ == change_count) {
+      values[topic_name] = std::move(value);
+    }
+  }
+
+  template<typename QueryT>
+  size_t
+  get_count(
+    std::map<std::string, size_t> & counts, const std::string & topic_name,
+    uint64_t change_count, QueryT query)
+  {
+    size_t count = 0;
+    get_topic_value(counts, topic_name, change_count, query, count);
+    return count;
+  }
+
+  /// Indexed by the no_demangle argument.
+  Entry<std::map<std::string, std::vector<std::string>>> topic_names_and_types[2];
+  Entry<std::map<std::string, std::vector<std::string>>> service_names_and_types;
+  Entry<std::vector<std::pair<std::string, std::string>>> node_names_and_namespaces;
+  std::map<std::string, size_t> publisher_counts;
+  std::map<std::string, size_t> subscriber_counts;
+  /// Indexed by the no_mangle argument.
+  std::map<std::string, std::vector<rclcpp::TopicEndpointInfo>> publishers_info[2];
+  std::map<std::string, std::vector<rclcpp::TopicEndpointInfo>> subscriptions_info[2];
+
+private:
+  void
+  update_topic_values_locked(uint64_t change_count)
+  {
+    if (change_count > topic_values_change_count_) {
+      publisher_counts.clear();
+      subscriber_counts.clear();
+      for (size_t i = 0; i < 2; ++i) {
+        publishers_info[i].clear();
+        subscriptions_info[i].clear();
+      }
+      topic_values_change_count_ = change_count;
+    }
+  }
+
+  std::mutex mutex_;
+  uint64_t topic_values_change_count_ = 0;
+};
+
+NodeGraph::NodeGraph(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  bool use_graph_cache)
 : node_base_(node_base),
   graph_listener_(
     node_base->get_context()->get_sub_context<GraphListener>(node_base->get_context())
   ),
   should_add_to_graph_listener_(true),
   graph_users_count_(0)
-{}
+{
+  if (use_graph_cache) {
+    graph_cache_ = node_base->get_context()->get_sub_context<GraphCache>();
+    // The changes of the graph are only seen through the nodes watched by the graph listener,
+    // the cache counts as a graph user, see count_graph_users().
+    should_add_to_graph_listener_ = false;
+    graph_listener_->add_node(this);
+    graph_listener_->start_if_not_started();
+  }
+}
 
 NodeGraph::~NodeGraph()
 {
@@ -54,6 +173,18 @@ NodeGraph::~NodeGraph()
 
 std::map<std::string, std::vector<std::string>>
 NodeGraph::get_topic_names_and_types(bool no_demangle) const
+{
+  if (!graph_cache_) {
+    return query_topic_names_and_types(no_demangle);
+  }
+  return graph_cache_->get(
+    graph_cache_->topic_names_and_types[no_demangle ? 1 : 0],
+    graph_listener_->get_graph_change_count(),
+    [this, no_demangle]() {return query_topic_names_and_types(no_demangle);});
+}
+
+std::map<std::string, std::vector<std::string>>
+NodeGraph::query_topic_names_and_types(bool no_demangle) const
 {
   rcl_names_and_types_t topic_names_and_types = rcl_get_zero_initialized_names_and_types();
 
@@ -95,6 +226,18 @@ NodeGraph::get_topic_names_and_types(bool no_demangle) const
 
 std::map<std::string, std::vector<std::string>>
 NodeGraph::get_service_names_and_types() const
+{
+  if (!graph_cache_) {
+    return query_service_names_and_types();
+  }
+  return graph_cache_->get(
+    graph_cache_->service_names_and_types,
+    graph_listener_->get_graph_change_count(),
+    [this]() {return query_service_names_and_types();});
+}
+
+std::map<std::string, std::vector<std::string>>
+NodeGraph::query_service_names_and_types() const
 {
   rcl_names_and_types_t service_names_and_types = rcl_get_zero_initialized_names_and_types();
 
@@ -164,6 +307,18 @@ NodeGraph::get_node_names() const
 
 std::vector<std::pair<std::string, std::string>>
 NodeGraph::get_node_names_and_namespaces() const
+{
+  if (!graph_cache_) {
+    return query_node_names_and_namespaces();
+  }
+  return graph_cache_->get(
+    graph_cache_->node_names_and_namespaces,
+    graph_listener_->get_graph_change_count(),
+    [this]() {return query_node_names_and_namespaces();});
+}
+
+std::vector<std::pair<std::string, std::string>>
+NodeGraph::query_node_names_and_namespaces() const
 {
   rcutils_string_array_t node_names_c =
     rcutils_get_zero_initialized_string_array();
@@ -228,16 +383,37 @@ NodeGraph::get_node_names_and_namespaces() const
 size_t
 NodeGraph::count_publishers(const std::string & topic_name) const
 {
-  auto rcl_node_handle = node_base_->get_rcl_node_handle();
+  auto fqdn = expand_name(topic_name, false);    // false = not a service
 
-  auto fqdn = rclcpp::expand_topic_or_service_name(
-    topic_name,
-    rcl_node_get_name(rcl_node_handle),
-    rcl_node_get_namespace(rcl_node_handle),
-    false);    // false = not a service
+  // The middleware counts a shared writer once, and sharing it doesn't change the graph.
+  size_t count = node_base_->get_context()->get_sub_context<
+    rclcpp::experimental::SharedWriterManager>()->get_additional_publisher_count(fqdn);
+  if (!graph_cache_) {
+    return count + query_publisher_count(fqdn);
+  }
+  return count + graph_cache_->get_count(
+    graph_cache_->publisher_counts, fqdn, graph_listener_->get_graph_change_count(),
+    [this, &fqdn]() {return query_publisher_count(fqdn);});
+}
+
+std::string
+NodeGraph::expand_name(const std::string & name, bool is_service) const
+{
+  using Kind = rclcpp::detail::ExpandedNameCache::Kind;
+  return expanded_names_.get(
+    name, is_service ? Kind::Service : Kind::Topic,
+    [this, &name, is_service]() {
+      return rclcpp::expand_topic_or_service_name(
+        name, node_base_->get_name(), node_base_->get_namespace(), is_service);
+    });
+}
 
+size_t
+NodeGraph::query_publisher_count(const std::string & fully_qualified_topic_name) const
+{
   size_t count;
-  auto ret = rcl_count_publishers(rcl_node_handle, fqdn.c_str(), &count);
+  auto ret = rcl_count_publishers(
+    node_base_->get_rcl_node_handle(), fully_qualified_topic_name.c_str(), &count);
   if (ret != RMW_RET_OK) {
     // *INDENT-OFF*
     throw std::runtime_error(
@@ -250,16 +426,22 @@ NodeGraph::count_publishers(const std::string & topic_name) const
 size_t
 NodeGraph::count_subscribers(const std::string & topic_name) const
 {
-  auto rcl_node_handle = node_base_->get_rcl_node_handle();
+  auto fqdn = expand_name(topic_name, false);    // false = not a service
 
-  auto fqdn = rclcpp::expand_topic_or_service_name(
-    topic_name,
-    rcl_node_get_name(rcl_node_handle),
-    rcl_node_get_namespace(rcl_node_handle),
-    false);    // false = not a service
+  if (!graph_cache_) {
+    return query_subscriber_count(fqdn);
+  }
+  return graph_cache_->get_count(
+    graph_cache_->subscriber_counts, fqdn, graph_listener_->get_graph_change_count(),
+    [this, &fqdn]() {return query_subscriber_count(fqdn);});
+}
 
+size_t
+NodeGraph::query_subscriber_count(const std::string & fully_qualified_topic_name) const
+{
   size_t count;
-  auto ret = rcl_count_subscribers(rcl_node_handle, fqdn.c_str(), &count);
+  auto ret = rcl_count_subscribers(
+    node_base_->get_rcl_node_handle(), fully_qualified_topic_name.c_str(), &count);
   if (ret != RMW_RET_OK) {
     // *INDENT-OFF*
     throw std::runtime_error(
@@ -278,6 +460,7 @@ NodeGraph::get_graph_guard_condition() const
 void
 NodeGraph::notify_graph_change()
 {
+  bool has_service_waiters;
   {
     std::lock_guard<std::mutex> graph_changed_lock(graph_mutex_);
     bool bad_ptr_encountered = false;
@@ -302,8 +485,16 @@ NodeGraph::notify_graph_change()
       // update graph_users_count_
       graph_users_count_.store(graph_events_.size());
     }
+    ++graph_change_count_;
+    has_service_waiters = !service_waiters_.empty();
   }
   graph_cv_.notify_all();
+  if (has_service_waiters) {
+    update_service_waiters();
+  }
+  if (graph_change_handles_count_.load() > 0) {
+    update_graph_change_handles();
+  }
   {
     auto notify_condition_lock = node_base_->acquire_notify_guard_condition_lock();
     rcl_ret_t ret = rcl_trigger_guard_condition(node_base_->get_notify_guard_condition());
@@ -318,6 +509,10 @@ NodeGraph::notify_shutdown()
 {
   // notify here anything that will not be woken up by ctrl-c or rclcpp::shutdown().
   graph_cv_.notify_all();
+  std::lock_guard<std::mutex> graph_lock(graph_mutex_);
+  for (auto waiter : service_waiters_) {
+    waiter->condition.notify_one();
+  }
 }
 
 rclcpp::Event::SharedPtr
@@ -370,7 +565,120 @@ NodeGraph::wait_for_graph_change(
 size_t
 NodeGraph::count_graph_users()
 {
-  return graph_users_count_.load();
+  return graph_users_count_.load() + graph_change_handles_count_.load() + (graph_cache_ ? 1 : 0);
+}
+
+bool
+NodeGraph::wait_for_service_in_graph(
+  const std::string & service_name,
+  std::chrono::nanoseconds timeout)
+{
+  // The node is watched by the graph listener while the event is on loan.
+  auto event = get_graph_event();
+  ServiceWaiter waiter(service_name);
+  std::unique_lock<std::mutex> graph_lock(graph_mutex_);
+  // Registered first, so the graph changes during the query below update the waiter.
+  service_waiters_.push_back(&waiter);
+  auto unregister = [this, &waiter]() {
+      service_waiters_.erase(
+        std::find(service_waiters_.begin(), service_waiters_.end(), &waiter));
+    };
+  if (has_service_names_ && service_names_change_count_ == graph_change_count_) {
+    waiter.in_graph = service_names_.count(service_name) > 0;
+  } else {
+    // The first waiter since the last graph change queries the graph for the others.
+    uint64_t change_count = graph_change_count_;
+    graph_lock.unlock();
+    std::set<std::string> service_names;
+    try {
+      service_names = query_service_names();
+    } catch (...) {
+      graph_lock.lock();
+      unregister();
+      throw;
+    }
+    graph_lock.lock();
+    waiter.in_graph = waiter.in_graph || service_names.count(service_name) > 0;
+    service_names_time_ = std::chrono::steady_clock::now();
+    if (change_count == graph_change_count_) {
+      service_names_ = std::move(service_names);
+      service_names_change_count_ = change_count;
+      has_service_names_ = true;
+    }
+  }
+
+  auto context = node_base_->get_context();
+  auto pred = [&waiter, &context]() {
+      return waiter.in_graph || !rclcpp::ok(context);
+    };
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!pred()) {
+    auto now = std::chrono::steady_clock::now();
+    if (timeout >= std::chrono::nanoseconds::zero() && now >= deadline) {
+      break;
+    }
+    // Some rmw implementations report a service only after its graph change was notified, so
+    // one of the waiters refreshes the names at most every 100ms.
+    if (now - service_names_time_ >= std::chrono::milliseconds(100)) {
+      service_names_time_ = now;
+      graph_lock.unlock();
+      update_service_waiters();
+      graph_lock.lock();
+      continue;
+    }
+    auto wait_until = service_names_time_ + std::chrono::milliseconds(100);
+    if (timeout >= std::chrono::nanoseconds::zero()) {
+      wait_until = std::min(wait_until, deadline);
+    }
+    waiter.condition.wait_until(graph_lock, wait_until, pred);
+  }
+  unregister();
+  return waiter.in_graph;
+}
+
+std::set<std::string>
+NodeGraph::query_service_names() const
+{
+  std::set<std::string> service_names;
+  for (const auto & service_name_and_types : get_service_names_and_types()) {
+    service_names.insert(service_name_and_types.first);
+  }
+  return service_names;
+}
+
+void
+NodeGraph::update_service_waiters()
+{
+  uint64_t change_count;
+  {
+    std::lock_guard<std::mutex> graph_lock(graph_mutex_);
+    change_count = graph_change_count_;
+  }
+  std::set<std::string> service_names;
+  bool queried = true;
+  try {
+    service_names = query_service_names();
+  } catch (const std::exception & exception) {
+    // The waiters are woken up to check their service themselves.
+    RCLCPP_ERROR(
+      rclcpp::get_logger("rclcpp"), "failed to update the waiters of services: %s",
+      exception.what());
+    queried = false;
+  }
+
+  std::lock_guard<std::mutex> graph_lock(graph_mutex_);
+  for (auto waiter : service_waiters_) {
+    if (!queried || service_names.count(waiter->service_name) > 0) {
+      waiter->in_graph = true;
+      waiter->condition.notify_one();
+    }
+  }
+  service_names_time_ = std::chrono::steady_clock::now();
+  if (queried && change_count == graph_change_count_) {
+    service_names_ = std::move(service_names);
+    service_names_change_count_ = change_count;
+    has_service_names_ = true;
+  }
 }
 
 static
@@ -386,51 +694,13 @@ convert_to_topic_info_list(const rcl_topic_endpoint_info_array_t & info_array)
 
 template<const char * EndpointType, typename FunctionT>
 static std::vector<rclcpp::TopicEndpointInfo>
-get_info_by_topic(
+query_info_by_topic(
   rclcpp::node_interfaces::NodeBaseInterface * node_base,
-  const std::string & topic_name,
+  const std::string & fqdn,
   bool no_mangle,
   FunctionT rcl_get_info_by_topic)
 {
-  std::string fqdn;
   auto rcl_node_handle = node_base->get_rcl_node_handle();
-
-  if (no_mangle) {
-    fqdn = topic_name;
-  } else {
-    fqdn = rclcpp::expand_topic_or_service_name(
-      topic_name,
-      rcl_node_get_name(rcl_node_handle),
-      rcl_node_get_namespace(rcl_node_handle),
-      false);    // false = not a service
-
-    // Get the node options
-    const rcl_node_options_t * node_options = rcl_node_get_options(rcl_node_handle);
-    if (nullptr == node_options) {
-      throw std::runtime_error("Need valid node options in get_info_by_topic()");
-    }
-    const rcl_arguments_t * global_args = nullptr;
-    if (node_options->use_global_arguments) {
-      global_args = &(rcl_node_handle->context->global_arguments);
-    }
-
-    char * remapped_topic_name = nullptr;
-    rcl_ret_t ret = rcl_remap_topic_name(
-      &(node_options->arguments),
-      global_args,
-      fqdn.c_str(),
-      rcl_node_get_name(rcl_node_handle),
-      rcl_node_get_namespace(rcl_node_handle),
-      node_options->allocator,
-      &remapped_topic_name);
-    if (RCL_RET_OK != ret) {
-      throw_from_rcl_error(ret, std::string("Failed to remap topic name ") + fqdn);
-    } else if (nullptr != remapped_topic_name) {
-      fqdn = remapped_topic_name;
-      node_options->allocator.deallocate(remapped_topic_name, node_options->allocator.state);
-    }
-  }
-
   rcutils_allocator_t allocator = rcutils_get_default_allocator();
   rcl_topic_endpoint_info_array_t info_array = rcl_get_zero_initialized_topic_endpoint_info_array();
   rcl_ret_t ret =
@@ -467,11 +737,33 @@ NodeGraph::get_publishers_info_by_topic(
   const std::string & topic_name,
   bool no_mangle) const
 {
-  return get_info_by_topic<kPublisherEndpointTypeName>(
-    node_base_,
-    topic_name,
-    no_mangle,
-    rcl_get_publishers_info_by_topic);
+  std::vector<rclcpp::TopicEndpointInfo> endpoints;
+  get_publishers_info_by_topic(topic_name, endpoints, no_mangle);
+  return endpoints;
+}
+
+void
+NodeGraph::get_publishers_info_by_topic(
+  const std::string & topic_name,
+  std::vector<rclcpp::TopicEndpointInfo> & endpoints,
+  bool no_mangle) const
+{
+  auto fqdn = no_mangle ? topic_name : expanded_names_.get(
+    topic_name, rclcpp::detail::ExpandedNameCache::Kind::RemappedTopic,
+    [this, &topic_name]() {
+      return node_base_->resolve_topic_or_service_name(topic_name, false);
+    });
+  auto query = [this, &fqdn, no_mangle]() {
+      return query_info_by_topic<kPublisherEndpointTypeName>(
+        node_base_, fqdn, no_mangle, rcl_get_publishers_info_by_topic);
+    };
+  if (!graph_cache_) {
+    endpoints = query();
+    return;
+  }
+  graph_cache_->get_topic_value(
+    graph_cache_->publishers_info[no_mangle ? 1 : 0], fqdn,
+    graph_listener_->get_graph_change_count(), query, endpoints);
 }
 
 static const char kSubscriptionEndpointTypeName[] = "subscriptions";
@@ -480,11 +772,172 @@ NodeGraph::get_subscriptions_info_by_topic(
   const std::string & topic_name,
   bool no_mangle) const
 {
-  return get_info_by_topic<kSubscriptionEndpointTypeName>(
-    node_base_,
-    topic_name,
-    no_mangle,
-    rcl_get_subscriptions_info_by_topic);
+  std::vector<rclcpp::TopicEndpointInfo> endpoints;
+  get_subscriptions_info_by_topic(topic_name, endpoints, no_mangle);
+  return endpoints;
+}
+
+void
+NodeGraph::get_subscriptions_info_by_topic(
+  const std::string & topic_name,
+  std::vector<rclcpp::TopicEndpointInfo> & endpoints,
+  bool no_mangle) const
+{
+  auto fqdn = no_mangle ? topic_name : expanded_names_.get(
+    topic_name, rclcpp::detail::ExpandedNameCache::Kind::RemappedTopic,
+    [this, &topic_name]() {
+      return node_base_->resolve_topic_or_service_name(topic_name, false);
+    });
+  auto query = [this, &fqdn, no_mangle]() {
+      return query_info_by_topic<kSubscriptionEndpointTypeName>(
+        node_base_, fqdn, no_mangle, rcl_get_subscriptions_info_by_topic);
+    };
+  if (!graph_cache_) {
+    endpoints = query();
+    return;
+  }
+  graph_cache_->get_topic_value(
+    graph_cache_->subscriptions_info[no_mangle ? 1 : 0], fqdn,
+    graph_listener_->get_graph_change_count(), query, endpoints);
+}
+
+rclcpp::node_interfaces::GraphChangeHandle::SharedPtr
+NodeGraph::add_graph_change_callback(
+  GraphEntityKind kind,
+  const std::string & name,
+  GraphChangeHandle::CallbackType callback)
+{
+  auto handle = std::make_shared<GraphChangeHandle>();
+  handle->kind = kind;
+  handle->callback = callback;
+  if (kind == GraphEntityKind::Node) {
+    handle->name = name;
+  } else {
+    handle->name = expand_name(name, kind == GraphEntityKind::Service);
+  }
+  // The initial state is the reference of the first change.
+  std::unique_ptr<std::set<std::string>> node_names;
+  std::unique_ptr<std::set<std::string>> service_names;
+  rclcpp::GraphChange change;
+  update_graph_change_handle(*handle, node_names, service_names, change);
+
+  {
+    std::lock_guard<std::mutex> lock(graph_change_handles_mutex_);
+    graph_change_handles_.push_back(handle);
+    graph_change_handles_count_.store(graph_change_handles_.size());
+  }
+  // The node is watched by the graph listener while it has graph users.
+  if (should_add_to_graph_listener_.exchange(false)) {
+    graph_listener_->add_node(this);
+    graph_listener_->start_if_not_started();
+  }
+  return handle;
+}
+
+void
+NodeGraph::update_graph_change_handles()
+{
+  std::vector<GraphChangeHandle::SharedPtr> handles;
+  {
+    std::lock_guard<std::mutex> lock(graph_change_handles_mutex_);
+    graph_change_handles_.erase(
+      std::remove_if(
+        graph_change_handles_.begin(),
+        graph_change_handles_.end(),
+        [&handles](const GraphChangeHandle::WeakPtr & weak_handle) {
+          auto handle = weak_handle.lock();
+          if (!handle) {
+            return true;
+          }
+          handles.push_back(handle);
+          return false;
+        }),
+      graph_change_handles_.end());
+    graph_change_handles_count_.store(graph_change_handles_.size());
+  }
+
+  // The names are queried once for all the handles.
+  std::unique_ptr<std::set<std::string>> node_names;
+  std::unique_ptr<std::set<std::string>> service_names;
+  for (const auto & handle : handles) {
+    rclcpp::GraphChange change;
+    try {
+      if (!update_graph_change_handle(*handle, node_names, service_names, change)) {
+        continue;
+      }
+      handle->callback(change);
+    } catch (const std::exception & exception) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger("rclcpp"), "failed to notify the change of '%s' in the graph: %s",
+        handle->name.c_str(), exception.what());
+    }
+  }
+}
+
+static bool
+is_same_endpoint(const rclcpp::TopicEndpointInfo & a, const rclcpp::TopicEndpointInfo & b)
+{
+  return a.endpoint_type() == b.endpoint_type() && a.endpoint_gid() == b.endpoint_gid();
+}
+
+/// Append the endpoints of `from` which are not in `other` to `to`.
+static void
+append_missing_endpoints(
+  const std::vector<rclcpp::TopicEndpointInfo> & from,
+  const std::vector<rclcpp::TopicEndpointInfo> & other,
+  std::vector<rclcpp::TopicEndpointInfo> & to)
+{
+  for (const auto & endpoint : from) {
+    auto it = std::find_if(
+      other.begin(), other.end(),
+      [&endpoint](const rclcpp::TopicEndpointInfo & other_endpoint) {
+        return is_same_endpoint(endpoint, other_endpoint);
+      });
+    if (it == other.end()) {
+      to.push_back(endpoint);
+    }
+  }
+}
+
+bool
+NodeGraph::update_graph_change_handle(
+  GraphChangeHandle & handle,
+  std::unique_ptr<std::set<std::string>> & node_names,
+  std::unique_ptr<std::set<std::string>> & service_names,
+  rclcpp::GraphChange & change) const
+{
+  change.kind = handle.kind;
+  change.name = handle.name;
+  change.existed = handle.exists;
+  switch (handle.kind) {
+    case GraphEntityKind::Topic:
+      {
+        auto endpoints = get_publishers_info_by_topic(handle.name, true);
+        auto subscriptions = get_subscriptions_info_by_topic(handle.name, true);
+        endpoints.insert(endpoints.end(), subscriptions.begin(), subscriptions.end());
+        append_missing_endpoints(endpoints, handle.endpoints, change.added_endpoints);
+        append_missing_endpoints(handle.endpoints, endpoints, change.removed_endpoints);
+        change.exists = !endpoints.empty();
+        handle.endpoints = std::move(endpoints);
+        break;
+      }
+    case GraphEntityKind::Service:
+      if (!service_names) {
+        service_names.reset(new std::set<std::string>(query_service_names()));
+      }
+      change.exists = service_names->count(handle.name) > 0;
+      break;
+    case GraphEntityKind::Node:
+      if (!node_names) {
+        auto names = get_node_names();
+        node_names.reset(new std::set<std::string>(names.begin(), names.end()));
+      }
+      change.exists = node_names->count(handle.name) > 0;
+      break;
+  }
+  handle.exists = change.exists;
+  return change.existed != change.exists ||
+         !change.added_endpoints.empty() || !change.removed_endpoints.empty();
 }
 
 std::string &
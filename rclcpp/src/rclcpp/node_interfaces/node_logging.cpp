@@ -14,16 +14,43 @@
 
 #include "rclcpp/node_interfaces/node_logging.hpp"
 
+#include <algorithm>
+#include <string>
+
+#include "rclcpp/detail/rosout_rate_limiter.hpp"
+
 using rclcpp::node_interfaces::NodeLogging;
 
-NodeLogging::NodeLogging(rclcpp::node_interfaces::NodeBaseInterface * node_base)
+NodeLogging::NodeLogging(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  const rclcpp::RosoutRateLimit & rosout_rate_limit)
 : node_base_(node_base)
 {
-  logger_ = rclcpp::get_logger(this->get_logger_name());
+  if (node_base_->shares_rcl_node()) {
+    // Named like rcl names the logger of a node, e.g. "ns.talker" for "/ns/talker".
+    logger_name_ = node_base_->get_fully_qualified_name() + 1;
+    std::replace(logger_name_.begin(), logger_name_.end(), '/', '.');
+  } else {
+    logger_name_ = rcl_node_get_logger_name(node_base_->get_rcl_node_handle());
+  }
+  logger_ = rclcpp::get_logger(logger_name_);
+
+  const rcl_node_options_t * node_options = node_base_->get_rcl_node_options();
+  // The logs of a node sharing the rcl node aren't published to /rosout.
+  if (
+    rosout_rate_limit.is_limited() && node_options && node_options->enable_rosout &&
+    !node_base_->shares_rcl_node())
+  {
+    rate_limited_logger_name_ = this->get_logger_name();
+    rclcpp::detail::add_rosout_rate_limit(rate_limited_logger_name_, rosout_rate_limit);
+  }
 }
 
 NodeLogging::~NodeLogging()
 {
+  if (!rate_limited_logger_name_.empty()) {
+    rclcpp::detail::remove_rosout_rate_limit(rate_limited_logger_name_);
+  }
 }
 
 rclcpp::Logger
@@ -35,5 +62,5 @@ NodeLogging::get_logger() const
 const char *
 NodeLogging::get_logger_name() const
 {
-  return rcl_node_get_logger_name(node_base_->get_rcl_node_handle());
+  return logger_name_.c_str();
 }
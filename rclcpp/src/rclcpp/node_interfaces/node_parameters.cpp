@@ -16,14 +16,21 @@
 
 #include <rcl_yaml_param_parser/parser.h>
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
 #include <cstdlib>
+#include <fstream>
 #include <functional>
 #include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -36,6 +43,72 @@
 
 using rclcpp::node_interfaces::NodeParameters;
 
+// Return the parameter overrides of arguments, by fully qualified node name.
+RCLCPP_LOCAL
+rclcpp::ParameterMap
+__get_parameter_map(const rcl_arguments_t * arguments)
+{
+  rcl_params_t * params = NULL;
+  rcl_ret_t ret = rcl_arguments_get_param_overrides(arguments, &params);
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret);
+  }
+  if (!params) {
+    return rclcpp::ParameterMap();
+  }
+  auto cleanup_params = rclcpp::make_scope_exit(
+    [params]() {
+      rcl_yaml_node_struct_fini(params);
+    });
+  return rclcpp::parameter_map_from(params);
+}
+
+// Add the overrides of a node, overwriting the ones already there.
+RCLCPP_LOCAL
+void
+__add_parameter_overrides(
+  const rclcpp::ParameterMap & parameter_map,
+  const std::string & node_name,
+  std::map<std::string, rclcpp::ParameterValue> & overrides)
+{
+  // TODO(cottsay) implement further wildcard matching
+  for (const std::string & key : {std::string("/**"), node_name}) {
+    auto it = parameter_map.find(key);
+    if (it == parameter_map.end()) {
+      continue;
+    }
+    for (const auto & param : it->second) {
+      overrides[param.get_name()] = param.get_parameter_value();
+    }
+  }
+}
+
+namespace
+{
+
+/// Parameter overrides of the global arguments of a context, converted once for all its nodes.
+class GlobalParameterOverrides
+{
+public:
+  const rclcpp::ParameterMap &
+  get(const rcl_arguments_t * global_arguments)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!converted_) {
+      parameter_map_ = __get_parameter_map(global_arguments);
+      converted_ = true;
+    }
+    return parameter_map_;
+  }
+
+private:
+  std::mutex mutex_;
+  bool converted_ = false;
+  rclcpp::ParameterMap parameter_map_;
+};
+
+}  // namespace
+
 NodeParameters::NodeParameters(
   const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base,
   const rclcpp::node_interfaces::NodeLoggingInterface::SharedPtr node_logging,
@@ -48,7 +121,11 @@ NodeParameters::NodeParameters(
   const rclcpp::QoS & parameter_event_qos,
   const rclcpp::PublisherOptionsBase & parameter_event_publisher_options,
   bool allow_undeclared_parameters,
-  bool automatically_declare_parameters_from_overrides)
+  bool automatically_declare_parameters_from_overrides,
+  std::chrono::nanoseconds parameter_event_coalescing_period,
+  const rclcpp::node_interfaces::NodeTimersInterface::SharedPtr node_timers,
+  bool lazy_parameter_event_publisher,
+  const std::string & parameter_snapshot_path)
 : allow_undeclared_(allow_undeclared_parameters),
   events_publisher_(nullptr),
   node_logging_(node_logging),
@@ -67,11 +144,31 @@ NodeParameters::NodeParameters(
   }
 
   if (start_parameter_event_publisher) {
-    events_publisher_ = rclcpp::create_publisher<MessageT, AllocatorT, PublisherT>(
-      node_topics,
-      "/parameter_events",
-      parameter_event_qos,
-      publisher_options);
+    create_events_publisher_ = [node_topics, parameter_event_qos, publisher_options]() {
+        return rclcpp::create_publisher<MessageT, AllocatorT, PublisherT>(
+          node_topics,
+          "/parameter_events",
+          parameter_event_qos,
+          publisher_options);
+      };
+    if (!lazy_parameter_event_publisher) {
+      events_publisher_ = create_events_publisher_();
+      create_events_publisher_ = nullptr;
+    }
+  }
+
+  if (parameter_event_coalescing_period > std::chrono::nanoseconds::zero()) {
+    if (!node_timers) {
+      throw std::invalid_argument("coalescing parameter events needs the timers interface");
+    }
+    if (start_parameter_event_publisher) {
+      parameter_event_timer_ = std::make_shared<rclcpp::WallTimer<rclcpp::VoidCallbackType>>(
+        parameter_event_coalescing_period,
+        [this]() {this->publish_pending_parameter_event();},
+        node_base->get_context());
+      parameter_event_timer_->cancel();
+      node_timers->add_timer(parameter_event_timer_, nullptr);
+    }
   }
 
   // Get the node options
@@ -79,44 +176,31 @@ NodeParameters::NodeParameters(
   if (nullptr == node) {
     throw std::runtime_error("Need valid node handle in NodeParameters");
   }
-  const rcl_node_options_t * options = rcl_node_get_options(node);
+  const rcl_node_options_t * options = node_base->get_rcl_node_options();
   if (nullptr == options) {
     throw std::runtime_error("Need valid node options in NodeParameters");
   }
 
-  std::vector<const rcl_arguments_t *> argument_sources;
+  // Get fully qualified node name post-remapping to use to find node's params in yaml files
+  combined_name_ = node_base->get_fully_qualified_name();
+
   // global before local so that local overwrites global
   if (options->use_global_arguments) {
-    auto context_ptr = node_base->get_context()->get_rcl_context();
-    argument_sources.push_back(&(context_ptr->global_arguments));
+    // The global arguments are the same for all the nodes of the context.
+    auto context = node_base->get_context();
+    auto global_overrides = context->get_sub_context<GlobalParameterOverrides>();
+    __add_parameter_overrides(
+      global_overrides->get(&(context->get_rcl_context()->global_arguments)),
+      combined_name_,
+      parameter_overrides_);
   }
-  argument_sources.push_back(&options->arguments);
+  __add_parameter_overrides(
+    __get_parameter_map(&options->arguments), combined_name_, parameter_overrides_);
 
-  // Get fully qualified node name post-remapping to use to find node's params in yaml files
-  combined_name_ = node_base->get_fully_qualified_name();
-
-  for (const rcl_arguments_t * source : argument_sources) {
-    rcl_params_t * params = NULL;
-    rcl_ret_t ret = rcl_arguments_get_param_overrides(source, &params);
-    if (RCL_RET_OK != ret) {
-      rclcpp::exceptions::throw_from_rcl_error(ret);
-    }
-    if (params) {
-      auto cleanup_params = make_scope_exit(
-        [params]() {
-          rcl_yaml_node_struct_fini(params);
-        });
-      rclcpp::ParameterMap initial_map = rclcpp::parameter_map_from(params);
-      for (auto iter = initial_map.begin(); initial_map.end() != iter; iter++) {
-        // TODO(cottsay) implement further wildcard matching
-        if (iter->first == "/**" || iter->first == combined_name_) {
-          // Combine parameter yaml files, overwriting values in older ones
-          for (auto & param : iter->second) {
-            parameter_overrides_[param.get_name()] =
-              rclcpp::ParameterValue(param.get_value_message());
-          }
-        }
-      }
+  // A missing snapshot is not an error, the node may have never saved one.
+  if (!parameter_snapshot_path.empty() && std::ifstream(parameter_snapshot_path).good()) {
+    for (auto & param : rclcpp::read_parameter_snapshot(parameter_snapshot_path)) {
+      parameter_overrides_[param.get_name()] = param.get_parameter_value();
     }
   }
 
@@ -128,7 +212,9 @@ NodeParameters::NodeParameters(
 
   // If asked, initialize any parameters that ended up in the initial parameter values,
   // but did not get declared explcitily by this point.
+  // They are published in one event.
   if (automatically_declare_parameters_from_overrides) {
+    defer_parameter_events_ = true;
     for (const auto & pair : this->get_parameter_overrides()) {
       if (!this->has_parameter(pair.first)) {
         this->declare_parameter(
@@ -138,12 +224,73 @@ NodeParameters::NodeParameters(
           true);
       }
     }
+    defer_parameter_events_ = false;
+    publish_pending_parameter_event();
   }
 }
 
 NodeParameters::~NodeParameters()
 {}
 
+std::shared_ptr<const NodeParameters::ParameterInfos>
+NodeParameters::get_parameters_snapshot() const
+{
+  return std::atomic_load(&parameters_snapshot_);
+}
+
+void
+NodeParameters::save_parameters_snapshot(const std::string & path) const
+{
+  auto parameters = get_parameters_snapshot();
+  std::vector<rclcpp::Parameter> snapshot;
+  snapshot.reserve(parameters->size());
+  for (const auto & pair : *parameters) {
+    snapshot.emplace_back(pair.first, pair.second.value);
+  }
+  rclcpp::write_parameter_snapshot(path, snapshot);
+}
+
+void
+NodeParameters::publish_parameters_snapshot()
+{
+  std::atomic_store(
+    &parameters_snapshot_, std::shared_ptr<const ParameterInfos>(
+      std::make_shared<ParameterInfos>(parameters_)));
+}
+
+void
+NodeParameters::notify_parameter_value_observers(
+  const std::vector<rclcpp::Parameter> & parameters)
+{
+  if (parameter_value_observers_.empty()) {
+    return;
+  }
+  // The observers of an undeclared parameter are kept, and called with a value not set.
+  const rclcpp::ParameterValue not_set;
+  for (const auto & parameter : parameters) {
+    auto observers = parameter_value_observers_.find(parameter.get_name());
+    if (observers == parameter_value_observers_.end()) {
+      continue;
+    }
+    auto parameter_info = parameters_.find(parameter.get_name());
+    const rclcpp::ParameterValue & value =
+      parameter_info == parameters_.end() ? not_set : parameter_info->second.value;
+    auto it = observers->second.begin();
+    while (it != observers->second.end()) {
+      auto observer = it->lock();
+      if (observer) {
+        observer->callback(value);
+        ++it;
+      } else {
+        it = observers->second.erase(it);
+      }
+    }
+    if (observers->second.empty()) {
+      parameter_value_observers_.erase(observers);
+    }
+  }
+}
+
 RCLCPP_LOCAL
 bool
 __lockless_has_parameter(
@@ -399,17 +546,85 @@ NodeParameters::declare_parameter(
     throw rclcpp::exceptions::InvalidParameterValueException(
             "parameter '" + name + "' could not be set: " + result.reason);
   }
+  publish_parameters_snapshot();
+  notify_parameter_value_observers({rclcpp::Parameter(name)});
 
-  // Publish if events_publisher_ is not nullptr, which may be if disabled in the constructor.
-  if (nullptr != events_publisher_) {
-    parameter_event.node = combined_name_;
-    parameter_event.stamp = node_clock_->get_clock()->now();
-    events_publisher_->publish(parameter_event);
-  }
+  publish_parameter_event(parameter_event);
 
   return parameters_.at(name).value;
 }
 
+std::vector<rclcpp::ParameterValue>
+NodeParameters::declare_parameters(
+  const std::vector<rclcpp::Parameter> & parameters,
+  const std::vector<rcl_interfaces::msg::ParameterDescriptor> & parameter_descriptors,
+  bool ignore_overrides)
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+
+  ParameterMutationRecursionGuard guard(parameter_modification_enabled_);
+
+  if (!parameter_descriptors.empty() && parameter_descriptors.size() != parameters.size()) {
+    throw std::invalid_argument("there must be one parameter descriptor for each parameter");
+  }
+
+  // All the parameters are checked before any is declared.
+  std::map<std::string, ParameterInfo> parameter_infos;
+  std::vector<rclcpp::Parameter> initial_values;
+  initial_values.reserve(parameters.size());
+  for (size_t i = 0; i < parameters.size(); ++i) {
+    const std::string & name = parameters[i].get_name();
+    // TODO(sloretz) parameter name validation
+    if (name.empty()) {
+      throw rclcpp::exceptions::InvalidParametersException("parameter name must not be empty");
+    }
+    if (__lockless_has_parameter(parameters_, name) || parameter_infos.count(name) > 0) {
+      throw rclcpp::exceptions::ParameterAlreadyDeclaredException(
+              "parameter '" + name + "' has already been declared");
+    }
+    parameter_infos[name].descriptor = parameter_descriptors.empty() ?
+      rcl_interfaces::msg::ParameterDescriptor() : parameter_descriptors[i];
+
+    // Use the value from the overrides if available, otherwise use the default.
+    auto overrides_it = parameter_overrides_.find(name);
+    if (!ignore_overrides && overrides_it != parameter_overrides_.end()) {
+      initial_values.emplace_back(name, overrides_it->second);
+    } else {
+      initial_values.emplace_back(name, parameters[i].get_parameter_value());
+    }
+  }
+  if (initial_values.empty()) {
+    return {};
+  }
+
+  // The callbacks are called once, with all the initial values.
+  auto result = __set_parameters_atomically_common(
+    initial_values,
+    parameter_infos,
+    on_parameters_set_callback_container_,
+    on_parameters_set_callback_);
+  if (!result.successful) {
+    throw rclcpp::exceptions::InvalidParameterValueException(
+            "parameters could not be set: " + result.reason);
+  }
+
+  rcl_interfaces::msg::ParameterEvent parameter_event;
+  std::vector<rclcpp::ParameterValue> values;
+  values.reserve(initial_values.size());
+  for (const auto & initial_value : initial_values) {
+    const auto & parameter_info = parameter_infos.at(initial_value.get_name());
+    parameters_[initial_value.get_name()] = parameter_info;
+    parameter_event.new_parameters.push_back(initial_value.to_parameter_msg());
+    values.push_back(parameter_info.value);
+  }
+  publish_parameters_snapshot();
+  notify_parameter_value_observers(initial_values);
+
+  publish_parameter_event(parameter_event);
+
+  return values;
+}
+
 void
 NodeParameters::undeclare_parameter(const std::string & name)
 {
@@ -429,14 +644,14 @@ NodeParameters::undeclare_parameter(const std::string & name)
   }
 
   parameters_.erase(parameter_info);
+  publish_parameters_snapshot();
+  notify_parameter_value_observers({rclcpp::Parameter(name)});
 }
 
 bool
 NodeParameters::has_parameter(const std::string & name) const
 {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
-
-  return __lockless_has_parameter(parameters_, name);
+  return __lockless_has_parameter(*get_parameters_snapshot(), name);
 }
 
 std::vector<rcl_interfaces::msg::SetParametersResult>
@@ -621,6 +836,9 @@ NodeParameters::set_parameters_atomically(const std::vector<rclcpp::Parameter> &
     }
   }
 
+  publish_parameters_snapshot();
+  notify_parameter_value_observers(*parameters_to_be_set);
+
   // Update the parameter event message for any parameters which were only set,
   // and not either declared or undeclared.
   for (const auto & parameter : *parameters_to_be_set) {
@@ -640,11 +858,7 @@ NodeParameters::set_parameters_atomically(const std::vector<rclcpp::Parameter> &
     parameter_event_msg.changed_parameters.push_back(parameter.to_parameter_msg());
   }
 
-  // Publish if events_publisher_ is not nullptr, which may be if disabled in the constructor.
-  if (nullptr != events_publisher_) {
-    parameter_event_msg.stamp = node_clock_->get_clock()->now();
-    events_publisher_->publish(parameter_event_msg);
-  }
+  publish_parameter_event(parameter_event_msg);
 
   return result;
 }
@@ -652,13 +866,13 @@ NodeParameters::set_parameters_atomically(const std::vector<rclcpp::Parameter> &
 std::vector<rclcpp::Parameter>
 NodeParameters::get_parameters(const std::vector<std::string> & names) const
 {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto snapshot = get_parameters_snapshot();
   std::vector<rclcpp::Parameter> results;
   results.reserve(names.size());
 
   for (auto & name : names) {
-    auto found_parameter = parameters_.find(name);
-    if (found_parameter != parameters_.cend()) {
+    auto found_parameter = snapshot->find(name);
+    if (found_parameter != snapshot->cend()) {
       // found
       results.emplace_back(name, found_parameter->second.value);
     } else if (this->allow_undeclared_) {
@@ -691,11 +905,11 @@ NodeParameters::get_parameter(
   const std::string & name,
   rclcpp::Parameter & parameter) const
 {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto snapshot = get_parameters_snapshot();
 
-  auto param_iter = parameters_.find(name);
+  auto param_iter = snapshot->find(name);
   if (
-    parameters_.end() != param_iter &&
+    snapshot->end() != param_iter &&
     param_iter->second.value.get_type() != rclcpp::ParameterType::PARAMETER_NOT_SET)
   {
     parameter = {name, param_iter->second.value};
@@ -710,12 +924,12 @@ NodeParameters::get_parameters_by_prefix(
   const std::string & prefix,
   std::map<std::string, rclcpp::Parameter> & parameters) const
 {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto snapshot = get_parameters_snapshot();
 
   std::string prefix_with_dot = prefix.empty() ? prefix : prefix + ".";
   bool ret = false;
 
-  for (const auto & param : parameters_) {
+  for (const auto & param : *snapshot) {
     if (param.first.find(prefix_with_dot) == 0 && param.first.length() > prefix_with_dot.length()) {
       // Found one!
       parameters[param.first.substr(prefix_with_dot.length())] = rclcpp::Parameter(param.second);
@@ -729,13 +943,13 @@ NodeParameters::get_parameters_by_prefix(
 std::vector<rcl_interfaces::msg::ParameterDescriptor>
 NodeParameters::describe_parameters(const std::vector<std::string> & names) const
 {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto snapshot = get_parameters_snapshot();
   std::vector<rcl_interfaces::msg::ParameterDescriptor> results;
   results.reserve(names.size());
 
   for (const auto & name : names) {
-    auto it = parameters_.find(name);
-    if (it != parameters_.cend()) {
+    auto it = snapshot->find(name);
+    if (it != snapshot->cend()) {
       results.push_back(it->second.descriptor);
     } else if (allow_undeclared_) {
       // parameter not found, but undeclared allowed, so return empty
@@ -757,13 +971,13 @@ NodeParameters::describe_parameters(const std::vector<std::string> & names) cons
 std::vector<uint8_t>
 NodeParameters::get_parameter_types(const std::vector<std::string> & names) const
 {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto snapshot = get_parameters_snapshot();
   std::vector<uint8_t> results;
   results.reserve(names.size());
 
   for (const auto & name : names) {
-    auto it = parameters_.find(name);
-    if (it != parameters_.cend()) {
+    auto it = snapshot->find(name);
+    if (it != snapshot->cend()) {
       results.push_back(it->second.value.get_type());
     } else if (allow_undeclared_) {
       // parameter not found, but undeclared allowed, so return not set
@@ -783,43 +997,63 @@ NodeParameters::get_parameter_types(const std::vector<std::string> & names) cons
 rcl_interfaces::msg::ListParametersResult
 NodeParameters::list_parameters(const std::vector<std::string> & prefixes, uint64_t depth) const
 {
-  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  auto snapshot = get_parameters_snapshot();
   rcl_interfaces::msg::ListParametersResult result;
 
   // TODO(mikaelarguedas) define parameter separator different from "/" to avoid ambiguity
   // using "." for now
   const char * separator = ".";
-  for (auto & kv : parameters_) {
-    bool get_all = (prefixes.size() == 0) &&
-      ((depth == rcl_interfaces::srv::ListParameters::Request::DEPTH_RECURSIVE) ||
-      (static_cast<uint64_t>(std::count(kv.first.begin(), kv.first.end(), *separator)) < depth));
-    bool prefix_matches = std::any_of(
-      prefixes.cbegin(), prefixes.cend(),
-      [&kv, &depth, &separator](const std::string & prefix) {
-        if (kv.first == prefix) {
-          return true;
-        } else if (kv.first.find(prefix + separator) == 0) {
-          size_t length = prefix.length();
-          std::string substr = kv.first.substr(length);
-          // Cast as unsigned integer to avoid warning
-          return (depth == rcl_interfaces::srv::ListParameters::Request::DEPTH_RECURSIVE) ||
-          (static_cast<uint64_t>(std::count(substr.begin(), substr.end(), *separator)) < depth);
-        }
-        return false;
-      });
-    if (get_all || prefix_matches) {
-      result.names.push_back(kv.first);
-      size_t last_separator = kv.first.find_last_of(separator);
-      if (std::string::npos != last_separator) {
-        std::string prefix = kv.first.substr(0, last_separator);
-        if (
-          std::find(result.prefixes.cbegin(), result.prefixes.cend(), prefix) ==
-          result.prefixes.cend())
-        {
-          result.prefixes.push_back(prefix);
+  // Whether the name has less than `depth` separators from the given position on.
+  auto within_depth = [depth, separator](const std::string & name, size_t position) {
+      if (depth == rcl_interfaces::srv::ListParameters::Request::DEPTH_RECURSIVE) {
+        return true;
+      }
+      auto begin = name.begin() + static_cast<std::ptrdiff_t>(position);
+      // Cast as unsigned integer to avoid warning
+      return static_cast<uint64_t>(std::count(begin, name.end(), *separator)) < depth;
+    };
+
+  std::vector<const std::string *> names;
+  if (prefixes.empty()) {
+    for (auto & kv : *snapshot) {
+      if (within_depth(kv.first, 0)) {
+        names.push_back(&kv.first);
+      }
+    }
+  } else {
+    // The parameters are sorted by name, so the names under a prefix are a range of them, found
+    // without looking at the others.
+    for (const auto & prefix : prefixes) {
+      auto exact_match = snapshot->find(prefix);
+      if (exact_match != snapshot->end()) {
+        names.push_back(&exact_match->first);
+      }
+      auto range_end = snapshot->lower_bound(prefix + static_cast<char>(*separator + 1));
+      for (auto it = snapshot->lower_bound(prefix + separator); it != range_end; ++it) {
+        if (within_depth(it->first, prefix.length())) {
+          names.push_back(&it->first);
         }
       }
     }
+    if (prefixes.size() > 1) {
+      // Overlapping prefixes match the same names, which are listed once and in order.
+      auto less = [](const std::string * a, const std::string * b) {return *a < *b;};
+      std::sort(names.begin(), names.end(), less);
+      names.erase(std::unique(names.begin(), names.end()), names.end());
+    }
+  }
+
+  result.names.reserve(names.size());
+  std::unordered_set<std::string> listed_prefixes;
+  for (const std::string * name : names) {
+    result.names.push_back(*name);
+    size_t last_separator = name->find_last_of(separator);
+    if (std::string::npos != last_separator) {
+      std::string prefix = name->substr(0, last_separator);
+      if (listed_prefixes.insert(prefix).second) {
+        result.prefixes.push_back(std::move(prefix));
+      }
+    }
   }
   return result;
 }
@@ -888,3 +1122,142 @@ NodeParameters::get_parameter_overrides() const
 {
   return parameter_overrides_;
 }
+
+ParameterValueObserver::SharedPtr
+NodeParameters::add_parameter_value_observer(
+  const std::string & name,
+  ParameterValueObserver::CallbackType callback)
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+
+  auto parameter_info = parameters_.find(name);
+  if (parameter_info == parameters_.end()) {
+    throw rclcpp::exceptions::ParameterNotDeclaredException(name);
+  }
+  auto observer = std::make_shared<ParameterValueObserver>();
+  observer->callback = std::move(callback);
+  observer->callback(parameter_info->second.value);
+  parameter_value_observers_[name].emplace_back(observer);
+  return observer;
+}
+
+// Merge a parameter event into one describing the changes since the one before it.
+RCLCPP_LOCAL
+void
+__merge_parameter_event(
+  rcl_interfaces::msg::ParameterEvent & merged,
+  const rcl_interfaces::msg::ParameterEvent & event)
+{
+  using ParameterMsgs = std::vector<rcl_interfaces::msg::Parameter>;
+  auto find = [](ParameterMsgs & parameters, const std::string & name) {
+      return std::find_if(
+        parameters.begin(), parameters.end(),
+        [&name](const rcl_interfaces::msg::Parameter & p) {return p.name == name;});
+    };
+  for (const auto & parameter : event.new_parameters) {
+    auto deleted = find(merged.deleted_parameters, parameter.name);
+    if (deleted != merged.deleted_parameters.end()) {
+      // It existed before the merged changes.
+      merged.deleted_parameters.erase(deleted);
+      merged.changed_parameters.push_back(parameter);
+    } else {
+      merged.new_parameters.push_back(parameter);
+    }
+  }
+  for (const auto & parameter : event.changed_parameters) {
+    auto added = find(merged.new_parameters, parameter.name);
+    auto changed = find(merged.changed_parameters, parameter.name);
+    if (added != merged.new_parameters.end()) {
+      added->value = parameter.value;
+    } else if (changed != merged.changed_parameters.end()) {
+      changed->value = parameter.value;
+    } else {
+      merged.changed_parameters.push_back(parameter);
+    }
+  }
+  for (const auto & parameter : event.deleted_parameters) {
+    auto added = find(merged.new_parameters, parameter.name);
+    if (added != merged.new_parameters.end()) {
+      // It didn't exist before the merged changes.
+      merged.new_parameters.erase(added);
+      continue;
+    }
+    auto changed = find(merged.changed_parameters, parameter.name);
+    if (changed != merged.changed_parameters.end()) {
+      merged.changed_parameters.erase(changed);
+    }
+    merged.deleted_parameters.push_back(parameter);
+  }
+}
+
+void
+NodeParameters::publish_parameter_event(const rcl_interfaces::msg::ParameterEvent & parameter_event)
+{
+  if (nullptr == events_publisher_) {
+    // events_publisher_ is nullptr if disabled in the constructor, or not created yet if lazy.
+    if (!create_events_publisher_) {
+      return;
+    }
+    // Declarations alone don't create the publisher, they are published with the first change.
+    if (parameter_event.changed_parameters.empty() && parameter_event.deleted_parameters.empty()) {
+      __merge_parameter_event(pending_parameter_event_, parameter_event);
+      has_pending_parameter_event_ = true;
+      return;
+    }
+    events_publisher_ = create_events_publisher_();
+    create_events_publisher_ = nullptr;
+    if (has_pending_parameter_event_) {
+      __merge_parameter_event(pending_parameter_event_, parameter_event);
+      if (defer_parameter_events_) {
+        return;
+      }
+      if (parameter_event_timer_) {
+        parameter_event_timer_->reset();
+      } else {
+        publish_pending_parameter_event();
+      }
+      return;
+    }
+  }
+  if (!defer_parameter_events_ && !parameter_event_timer_) {
+    auto event = parameter_event;
+    event.node = combined_name_;
+    event.stamp = node_clock_->get_clock()->now();
+    events_publisher_->publish(event);
+    return;
+  }
+  __merge_parameter_event(pending_parameter_event_, parameter_event);
+  if (!has_pending_parameter_event_) {
+    has_pending_parameter_event_ = true;
+    if (parameter_event_timer_ && !defer_parameter_events_) {
+      // The coalescing period starts with the first change.
+      parameter_event_timer_->reset();
+    }
+  }
+}
+
+void
+NodeParameters::publish_pending_parameter_event()
+{
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+
+  if (parameter_event_timer_) {
+    parameter_event_timer_->cancel();
+  }
+  if (!has_pending_parameter_event_ || nullptr == events_publisher_) {
+    return;
+  }
+  rcl_interfaces::msg::ParameterEvent event;
+  std::swap(event, pending_parameter_event_);
+  has_pending_parameter_event_ = false;
+  if (
+    event.new_parameters.empty() && event.changed_parameters.empty() &&
+    event.deleted_parameters.empty())
+  {
+    // The changes cancelled out.
+    return;
+  }
+  event.node = combined_name_;
+  event.stamp = node_clock_->get_clock()->now();
+  events_publisher_->publish(event);
+}
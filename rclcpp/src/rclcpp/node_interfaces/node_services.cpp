@@ -30,25 +30,28 @@ NodeServices::add_service(
   rclcpp::ServiceBase::SharedPtr service_base_ptr,
   rclcpp::callback_group::CallbackGroup::SharedPtr group)
 {
+  node_base_->get_context()->check_entity_creation("service");
   if (group) {
     if (!node_base_->callback_group_in_node(group)) {
       // TODO(jacquelinekay): use custom exception
       throw std::runtime_error("Cannot create service, group not in node.");
     }
-    group->add_service(service_base_ptr);
   } else {
-    node_base_->get_default_callback_group()->add_service(service_base_ptr);
+    group = node_base_->get_default_callback_group();
+  }
+  group->add_service(service_base_ptr);
+  if (node_base_->get_use_intra_process_default()) {
+    // The requests of the clients of the context are executed with the service.
+    service_base_ptr->setup_intra_process(node_base_->get_context());
+    group->add_waitable(service_base_ptr->get_intra_process_waitable());
   }
 
   // Notify the executor that a new service was created using the parent Node.
-  {
-    auto notify_guard_condition_lock = node_base_->acquire_notify_guard_condition_lock();
-    if (rcl_trigger_guard_condition(node_base_->get_notify_guard_condition()) != RCL_RET_OK) {
-      throw std::runtime_error(
-              std::string("Failed to notify wait set on service creation: ") +
-              rmw_get_error_string().str
-      );
-    }
+  if (node_base_->trigger_notify_guard_condition() != RCL_RET_OK) {
+    throw std::runtime_error(
+            std::string("Failed to notify wait set on service creation: ") +
+            rmw_get_error_string().str
+    );
   }
 }
 
@@ -57,24 +60,29 @@ NodeServices::add_client(
   rclcpp::ClientBase::SharedPtr client_base_ptr,
   rclcpp::callback_group::CallbackGroup::SharedPtr group)
 {
+  node_base_->get_context()->check_entity_creation("client");
   if (group) {
     if (!node_base_->callback_group_in_node(group)) {
       // TODO(jacquelinekay): use custom exception
       throw std::runtime_error("Cannot create client, group not in node.");
     }
-    group->add_client(client_base_ptr);
   } else {
-    node_base_->get_default_callback_group()->add_client(client_base_ptr);
+    group = node_base_->get_default_callback_group();
+  }
+  group->add_client(client_base_ptr);
+  // The timer enforcing the timeouts of the requests is executed with the client.
+  group->add_timer(client_base_ptr->get_timeout_timer());
+  if (node_base_->get_use_intra_process_default()) {
+    // The responses of the services of the context are executed with the client.
+    client_base_ptr->setup_intra_process();
+    group->add_waitable(client_base_ptr->get_intra_process_waitable());
   }
 
   // Notify the executor that a new client was created using the parent Node.
-  {
-    auto notify_guard_condition_lock = node_base_->acquire_notify_guard_condition_lock();
-    if (rcl_trigger_guard_condition(node_base_->get_notify_guard_condition()) != RCL_RET_OK) {
-      throw std::runtime_error(
-              std::string("Failed to notify wait set on client creation: ") +
-              rmw_get_error_string().str
-      );
-    }
+  if (node_base_->trigger_notify_guard_condition() != RCL_RET_OK) {
+    throw std::runtime_error(
+            std::string("Failed to notify wait set on client creation: ") +
+            rmw_get_error_string().str
+    );
   }
 }
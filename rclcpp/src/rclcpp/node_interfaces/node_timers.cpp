@@ -30,6 +30,7 @@ NodeTimers::add_timer(
   rclcpp::TimerBase::SharedPtr timer,
   rclcpp::callback_group::CallbackGroup::SharedPtr callback_group)
 {
+  node_base_->get_context()->check_entity_creation("timer");
   if (callback_group) {
     if (!node_base_->callback_group_in_node(callback_group)) {
       // TODO(jacquelinekay): use custom exception
@@ -39,7 +40,7 @@ NodeTimers::add_timer(
   } else {
     node_base_->get_default_callback_group()->add_timer(timer);
   }
-  if (rcl_trigger_guard_condition(node_base_->get_notify_guard_condition()) != RCL_RET_OK) {
+  if (node_base_->trigger_notify_guard_condition() != RCL_RET_OK) {
     throw std::runtime_error(
             std::string("Failed to notify wait set on timer creation: ") +
             rmw_get_error_string().str);
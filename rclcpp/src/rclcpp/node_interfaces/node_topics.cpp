@@ -14,7 +14,11 @@
 
 #include "rclcpp/node_interfaces/node_topics.hpp"
 
+#include <algorithm>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "rclcpp/exceptions.hpp"
 
@@ -23,7 +27,13 @@ using rclcpp::exceptions::throw_from_rcl_error;
 using rclcpp::node_interfaces::NodeTopics;
 
 NodeTopics::NodeTopics(rclcpp::node_interfaces::NodeBaseInterface * node_base)
-: node_base_(node_base)
+: node_base_(node_base), node_graph_(nullptr)
+{}
+
+NodeTopics::NodeTopics(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  rclcpp::node_interfaces::NodeGraphInterface * node_graph)
+: node_base_(node_base), node_graph_(node_graph)
 {}
 
 NodeTopics::~NodeTopics()
@@ -35,6 +45,7 @@ NodeTopics::create_publisher(
   const rclcpp::PublisherFactory & publisher_factory,
   const rclcpp::QoS & qos)
 {
+  node_base_->get_context()->check_entity_creation("publisher");
   // Create the MessageT specific Publisher using the factory, but return it as PublisherBase.
   return publisher_factory.create_typed_publisher(node_base_, topic_name, qos);
 }
@@ -53,18 +64,19 @@ NodeTopics::add_publisher(
     callback_group = node_base_->get_default_callback_group();
   }
 
-  for (auto & publisher_event : publisher->get_event_handlers()) {
-    callback_group->add_waitable(publisher_event);
+  callback_group->add_publisher(publisher);
+
+  add_event_handlers(publisher->get_event_handlers(), callback_group);
+
+  if (node_graph_ && publisher->is_subscription_count_cache_requested()) {
+    publisher->enable_subscription_count_cache(node_graph_->get_graph_event());
   }
 
   // Notify the executor that a new publisher was created using the parent Node.
-  {
-    auto notify_guard_condition_lock = node_base_->acquire_notify_guard_condition_lock();
-    if (rcl_trigger_guard_condition(node_base_->get_notify_guard_condition()) != RCL_RET_OK) {
-      throw std::runtime_error(
-              std::string("Failed to notify wait set on publisher creation: ") +
-              rmw_get_error_string().str);
-    }
+  if (node_base_->trigger_notify_guard_condition() != RCL_RET_OK) {
+    throw std::runtime_error(
+            std::string("Failed to notify wait set on publisher creation: ") +
+            rmw_get_error_string().str);
   }
 }
 
@@ -74,6 +86,7 @@ NodeTopics::create_subscription(
   const rclcpp::SubscriptionFactory & subscription_factory,
   const rclcpp::QoS & qos)
 {
+  node_base_->get_context()->check_entity_creation("subscription");
   // Create the MessageT specific Subscription using the factory, but return a SubscriptionBase.
   return subscription_factory.create_typed_subscription(node_base_, topic_name, qos);
 }
@@ -95,25 +108,83 @@ NodeTopics::add_subscription(
 
   callback_group->add_subscription(subscription);
 
-  for (auto & subscription_event : subscription->get_event_handlers()) {
-    callback_group->add_waitable(subscription_event);
-  }
+  add_event_handlers(subscription->get_event_handlers(), callback_group);
 
   auto intra_process_waitable = subscription->get_intra_process_waitable();
   if (nullptr != intra_process_waitable) {
     // Add to the callback group to be notified about intra-process msgs.
-    callback_group->add_waitable(intra_process_waitable);
+    add_intra_process_subscription(intra_process_waitable, callback_group);
   }
 
   // Notify the executor that a new subscription was created using the parent Node.
-  {
-    auto notify_guard_condition_lock = node_base_->acquire_notify_guard_condition_lock();
-    auto ret = rcl_trigger_guard_condition(node_base_->get_notify_guard_condition());
-    if (ret != RCL_RET_OK) {
-      using rclcpp::exceptions::throw_from_rcl_error;
-      throw_from_rcl_error(ret, "failed to notify wait set on subscription creation");
-    }
+  auto ret = node_base_->trigger_notify_guard_condition();
+  if (ret != RCL_RET_OK) {
+    using rclcpp::exceptions::throw_from_rcl_error;
+    throw_from_rcl_error(ret, "failed to notify wait set on subscription creation");
+  }
+}
+
+NodeTopics::CallbackGroupWaitables &
+NodeTopics::get_callback_group_waitables(
+  const rclcpp::callback_group::CallbackGroup::SharedPtr & callback_group)
+{
+  callback_group_waitables_.erase(
+    std::remove_if(
+      callback_group_waitables_.begin(), callback_group_waitables_.end(),
+      [](const CallbackGroupWaitables & entry) {return entry.callback_group.expired();}),
+    callback_group_waitables_.end());
+  auto iter = std::find_if(
+    callback_group_waitables_.begin(), callback_group_waitables_.end(),
+    [&callback_group](const CallbackGroupWaitables & entry) {
+      return entry.callback_group.lock() == callback_group;
+    });
+  if (iter != callback_group_waitables_.end()) {
+    return *iter;
+  }
+  callback_group_waitables_.push_back({callback_group, nullptr, nullptr});
+  return callback_group_waitables_.back();
+}
+
+void
+NodeTopics::add_event_handlers(
+  const std::vector<std::shared_ptr<rclcpp::QOSEventHandlerBase>> & event_handlers,
+  const rclcpp::callback_group::CallbackGroup::SharedPtr & callback_group)
+{
+  if (event_handlers.empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(callback_group_waitables_mutex_);
+  auto & waitables = get_callback_group_waitables(callback_group);
+  if (!waitables.event_handlers) {
+    waitables.event_handlers = std::make_shared<rclcpp::detail::QOSEventHandlerGroup>();
+    callback_group->add_waitable(waitables.event_handlers);
+  }
+  for (auto & event_handler : event_handlers) {
+    waitables.event_handlers->add_event_handler(event_handler);
+  }
+}
+
+void
+NodeTopics::add_intra_process_subscription(
+  const rclcpp::Waitable::SharedPtr & intra_process_waitable,
+  const rclcpp::callback_group::CallbackGroup::SharedPtr & callback_group)
+{
+  auto subscription =
+    std::dynamic_pointer_cast<rclcpp::experimental::SubscriptionIntraProcessBase>(
+    intra_process_waitable);
+  if (!subscription) {
+    callback_group->add_waitable(intra_process_waitable);
+    return;
+  }
+  std::lock_guard<std::mutex> lock(callback_group_waitables_mutex_);
+  auto & waitables = get_callback_group_waitables(callback_group);
+  if (!waitables.intra_process_subscriptions) {
+    waitables.intra_process_subscriptions =
+      std::make_shared<rclcpp::experimental::SubscriptionIntraProcessGroup>(
+      node_base_->get_context());
+    callback_group->add_waitable(waitables.intra_process_subscriptions);
   }
+  waitables.intra_process_subscriptions->add_subscription(subscription);
 }
 
 rclcpp::node_interfaces::NodeBaseInterface *
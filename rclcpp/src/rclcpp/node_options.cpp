@@ -70,14 +70,24 @@ NodeOptions::operator=(const NodeOptions & other)
     this->context_ = other.context_;
     this->arguments_ = other.arguments_;
     this->parameter_overrides_ = other.parameter_overrides_;
+    this->parameter_snapshot_path_ = other.parameter_snapshot_path_;
     this->use_global_arguments_ = other.use_global_arguments_;
     this->enable_rosout_ = other.enable_rosout_;
     this->use_intra_process_comms_ = other.use_intra_process_comms_;
     this->start_parameter_services_ = other.start_parameter_services_;
+    this->start_parameter_event_publisher_ = other.start_parameter_event_publisher_;
+    this->lazy_parameter_event_publisher_ = other.lazy_parameter_event_publisher_;
+    this->parameter_event_qos_ = other.parameter_event_qos_;
+    this->parameter_event_publisher_options_ = other.parameter_event_publisher_options_;
+    this->parameter_event_coalescing_period_ = other.parameter_event_coalescing_period_;
+    this->use_graph_cache_ = other.use_graph_cache_;
+    this->rosout_rate_limit_ = other.rosout_rate_limit_;
     this->allocator_ = other.allocator_;
     this->allow_undeclared_parameters_ = other.allow_undeclared_parameters_;
     this->automatically_declare_parameters_from_overrides_ =
       other.automatically_declare_parameters_from_overrides_;
+    this->entity_arena_ = other.entity_arena_;
+    this->message_pools_ = other.message_pools_;
   }
   return *this;
 }
@@ -172,6 +182,19 @@ NodeOptions::parameter_overrides(const std::vector<rclcpp::Parameter> & paramete
   return *this;
 }
 
+const std::string &
+NodeOptions::parameter_snapshot_path() const
+{
+  return this->parameter_snapshot_path_;
+}
+
+NodeOptions &
+NodeOptions::parameter_snapshot_path(const std::string & parameter_snapshot_path)
+{
+  this->parameter_snapshot_path_ = parameter_snapshot_path;
+  return *this;
+}
+
 bool
 NodeOptions::use_global_arguments() const
 {
@@ -239,6 +262,19 @@ NodeOptions::start_parameter_event_publisher(bool start_parameter_event_publishe
   return *this;
 }
 
+bool
+NodeOptions::lazy_parameter_event_publisher() const
+{
+  return this->lazy_parameter_event_publisher_;
+}
+
+NodeOptions &
+NodeOptions::lazy_parameter_event_publisher(bool lazy_parameter_event_publisher)
+{
+  this->lazy_parameter_event_publisher_ = lazy_parameter_event_publisher;
+  return *this;
+}
+
 const rclcpp::QoS &
 NodeOptions::parameter_event_qos() const
 {
@@ -266,6 +302,41 @@ NodeOptions::parameter_event_publisher_options(
   return *this;
 }
 
+std::chrono::nanoseconds
+NodeOptions::parameter_event_coalescing_period() const
+{
+  return this->parameter_event_coalescing_period_;
+}
+
+NodeOptions &
+NodeOptions::parameter_event_coalescing_period(
+  std::chrono::nanoseconds parameter_event_coalescing_period)
+{
+  this->parameter_event_coalescing_period_ = parameter_event_coalescing_period;
+  return *this;
+}
+
+NodeOptions &
+NodeOptions::lightweight()
+{
+  return this->enable_rosout(false)
+         .start_parameter_services(false)
+         .lazy_parameter_event_publisher(true);
+}
+
+bool
+NodeOptions::use_graph_cache() const
+{
+  return this->use_graph_cache_;
+}
+
+NodeOptions &
+NodeOptions::use_graph_cache(bool use_graph_cache)
+{
+  this->use_graph_cache_ = use_graph_cache;
+  return *this;
+}
+
 bool
 NodeOptions::allow_undeclared_parameters() const
 {
@@ -294,6 +365,47 @@ NodeOptions::automatically_declare_parameters_from_overrides(
   return *this;
 }
 
+const rclcpp::RosoutRateLimit &
+NodeOptions::rosout_rate_limit() const
+{
+  return this->rosout_rate_limit_;
+}
+
+NodeOptions &
+NodeOptions::rosout_rate_limit(const rclcpp::RosoutRateLimit & rosout_rate_limit)
+{
+  this->rosout_rate_limit_ = rosout_rate_limit;
+  return *this;
+}
+
+const rclcpp::allocator::Arena::SharedPtr &
+NodeOptions::entity_arena() const
+{
+  return this->entity_arena_;
+}
+
+NodeOptions &
+NodeOptions::entity_arena(rclcpp::allocator::Arena::SharedPtr entity_arena)
+{
+  this->entity_arena_ = std::move(entity_arena);
+  return *this;
+}
+
+const rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry::SharedPtr &
+NodeOptions::message_pools() const
+{
+  return this->message_pools_;
+}
+
+NodeOptions &
+NodeOptions::message_pools(
+  rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry::SharedPtr
+  message_pools)
+{
+  this->message_pools_ = std::move(message_pools);
+  return *this;
+}
+
 const rcl_allocator_t &
 NodeOptions::allocator() const
 {
@@ -0,0 +1,163 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/numa.hpp"
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+#if defined(__linux__)
+// Parse a list of the sysfs format, e.g. "0-3,8,10-11".
+std::vector<size_t>
+parse_list(const std::string & list)
+{
+  std::vector<size_t> values;
+  std::istringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    if (range.empty() || range == "\n") {
+      continue;
+    }
+    size_t dash = range.find('-');
+    try {
+      size_t first = std::stoul(range.substr(0, dash));
+      size_t last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+      for (size_t value = first; value <= last; ++value) {
+        values.push_back(value);
+      }
+    } catch (const std::exception &) {
+      return {};
+    }
+  }
+  return values;
+}
+
+std::vector<size_t>
+read_list(const std::string & path)
+{
+  std::ifstream file(path);
+  std::string list;
+  if (!file || !std::getline(file, list)) {
+    return {};
+  }
+  return parse_list(list);
+}
+
+// From linux/mempolicy.h, which is not always installed.
+constexpr int mpol_preferred = 1;
+#endif
+
+}  // namespace
+
+size_t
+rclcpp::get_numa_node_count()
+{
+#if defined(__linux__)
+  auto nodes = read_list("/sys/devices/system/node/online");
+  if (!nodes.empty()) {
+    return *std::max_element(nodes.begin(), nodes.end()) + 1;
+  }
+#endif
+  return 1;
+}
+
+std::vector<size_t>
+rclcpp::get_numa_node_cpus(size_t numa_node)
+{
+#if defined(__linux__)
+  return read_list("/sys/devices/system/node/node" + std::to_string(numa_node) + "/cpulist");
+#else
+  (void)numa_node;
+  return {};
+#endif
+}
+
+size_t
+rclcpp::get_current_numa_node()
+{
+#if defined(__linux__)
+  int cpu = sched_getcpu();
+  if (cpu < 0) {
+    return 0;
+  }
+  size_t count = get_numa_node_count();
+  for (size_t numa_node = 0; numa_node < count; ++numa_node) {
+    auto cpus = get_numa_node_cpus(numa_node);
+    if (std::find(cpus.begin(), cpus.end(), static_cast<size_t>(cpu)) != cpus.end()) {
+      return numa_node;
+    }
+  }
+#endif
+  return 0;
+}
+
+void *
+rclcpp::allocate_on_numa_node(size_t size, int numa_node)
+{
+#if defined(__linux__)
+  void * pointer = mmap(
+    nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (MAP_FAILED == pointer) {
+    throw std::bad_alloc();
+  }
+  if (numa_node >= 0) {
+    constexpr size_t bits_per_mask = 8 * sizeof(unsigned long);  // NOLINT(runtime/int)
+    std::vector<unsigned long> node_mask(  // NOLINT(runtime/int)
+      static_cast<size_t>(numa_node) / bits_per_mask + 1, 0);
+    node_mask[static_cast<size_t>(numa_node) / bits_per_mask] |=
+      1ul << (static_cast<size_t>(numa_node) % bits_per_mask);
+    // Only a preference: without NUMA support, e.g. in some containers, the placement is the
+    // default one.
+    (void)syscall(
+      SYS_mbind, pointer, size, mpol_preferred, node_mask.data(),
+      node_mask.size() * bits_per_mask + 1, 0);
+  }
+  return pointer;
+#else
+  (void)numa_node;
+  void * pointer = ::operator new(size);
+  std::memset(pointer, 0, size);
+  return pointer;
+#endif
+}
+
+void
+rclcpp::deallocate_on_numa_node(void * pointer, size_t size)
+{
+  if (!pointer) {
+    return;
+  }
+#if defined(__linux__)
+  munmap(pointer, size);
+#else
+  (void)size;
+  ::operator delete(pointer);
+#endif
+}
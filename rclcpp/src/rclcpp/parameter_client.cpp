@@ -15,13 +15,20 @@
 #include "rclcpp/parameter_client.hpp"
 
 #include <algorithm>
+#include <map>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "rclcpp/future_waiter.hpp"
+#include "rclcpp/logging.hpp"
+
 #include "./parameter_service_names.hpp"
 
 using rclcpp::AsyncParametersClient;
+using rclcpp::MultiNodeParametersClient;
 using rclcpp::SyncParametersClient;
 
 AsyncParametersClient::AsyncParametersClient(
@@ -503,3 +510,240 @@ SyncParametersClient::list_parameters(
 
   throw std::runtime_error("Unable to get result of list parameters service call.");
 }
+
+namespace
+{
+
+using GetParametersClient = rclcpp::Client<rcl_interfaces::srv::GetParameters>;
+
+/// Result of one call to MultiNodeParametersClient::get_parameters().
+struct Batch
+{
+  std::promise<MultiNodeParametersClient::NodeParametersMap> promise;
+  MultiNodeParametersClient::SharedFuture future;
+  MultiNodeParametersClient::CallbackType callback;
+  std::mutex mutex;
+  size_t remaining = 0;
+  MultiNodeParametersClient::NodeParametersMap result;
+
+  /// Record the response of a node, or its failure if parameters is null.
+  void
+  complete_one(const std::string & node_name, std::vector<rclcpp::Parameter> * parameters)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (parameters) {
+        result[node_name] = std::move(*parameters);
+      }
+      if (--remaining > 0) {
+        return;
+      }
+    }
+    promise.set_value(std::move(result));
+    rclcpp::executor::notify_future_waiters();
+    if (callback) {
+      callback(future);
+    }
+  }
+};
+
+}  // namespace
+
+struct MultiNodeParametersClient::State
+{
+  struct Job
+  {
+    std::string node_name;
+    std::shared_ptr<rcl_interfaces::srv::GetParameters::Request> request;
+    std::chrono::nanoseconds timeout;
+    std::shared_ptr<Batch> batch;
+  };
+
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base;
+  rclcpp::node_interfaces::NodeGraphInterface::SharedPtr node_graph;
+  rclcpp::node_interfaces::NodeServicesInterface::SharedPtr node_services;
+  rcl_client_options_t options;
+  rclcpp::callback_group::CallbackGroup::SharedPtr group;
+  size_t max_requests_in_flight;
+
+  mutable std::mutex mutex;
+  std::map<std::string, GetParametersClient::SharedPtr> clients;
+  std::deque<Job> queue;
+  size_t requests_in_flight = 0;
+
+  GetParametersClient::SharedPtr
+  get_client_locked(const std::string & node_name)
+  {
+    auto it = clients.find(node_name);
+    if (it != clients.end()) {
+      return it->second;
+    }
+    auto client = GetParametersClient::make_shared(
+      node_base.get(),
+      node_graph,
+      node_name + "/" + parameter_service_names::get_parameters,
+      options);
+    node_services->add_client(std::dynamic_pointer_cast<rclcpp::ClientBase>(client), group);
+    clients.emplace(node_name, client);
+    return client;
+  }
+
+  /// Send the queued requests while there is room in flight, called without the lock.
+  static void
+  dispatch(const std::shared_ptr<State> & state)
+  {
+    while (true) {
+      Job job;
+      GetParametersClient::SharedPtr client;
+      {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->queue.empty() || state->requests_in_flight >= state->max_requests_in_flight) {
+          return;
+        }
+        job = std::move(state->queue.front());
+        state->queue.pop_front();
+        ++state->requests_in_flight;
+        client = state->get_client_locked(job.node_name);
+      }
+      std::weak_ptr<State> weak_state = state;
+      auto request = job.request;
+      auto node_name = job.node_name;
+      auto batch = job.batch;
+      try {
+        client->async_send_request(
+          request,
+          [weak_state, request, node_name, batch](GetParametersClient::SharedFuture future) {
+            std::vector<rclcpp::Parameter> parameters;
+            bool responded = false;
+            try {
+              auto & values = future.get()->values;
+              for (size_t i = 0; i < values.size() && i < request->names.size(); ++i) {
+                rcl_interfaces::msg::Parameter parameter;
+                parameter.name = request->names[i];
+                parameter.value = values[i];
+                parameters.push_back(rclcpp::Parameter::from_parameter_msg(parameter));
+              }
+              responded = true;
+            } catch (const rclcpp::exceptions::RequestTimeoutError &) {
+              // The node is left out of the result.
+            }
+            auto state = weak_state.lock();
+            if (state) {
+              {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                --state->requests_in_flight;
+              }
+              dispatch(state);
+            }
+            batch->complete_one(node_name, responded ? &parameters : nullptr);
+          },
+          job.timeout);
+      } catch (const std::exception & exception) {
+        RCLCPP_ERROR(
+          rclcpp::get_logger("rclcpp"), "failed to get the parameters of node '%s': %s",
+          node_name.c_str(), exception.what());
+        {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          --state->requests_in_flight;
+        }
+        batch->complete_one(node_name, nullptr);
+      }
+    }
+  }
+};
+
+MultiNodeParametersClient::MultiNodeParametersClient(
+  const rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_interface,
+  const rclcpp::node_interfaces::NodeGraphInterface::SharedPtr node_graph_interface,
+  const rclcpp::node_interfaces::NodeServicesInterface::SharedPtr node_services_interface,
+  size_t max_requests_in_flight,
+  const rmw_qos_profile_t & qos_profile,
+  rclcpp::callback_group::CallbackGroup::SharedPtr group)
+: state_(std::make_shared<State>())
+{
+  if (max_requests_in_flight == 0) {
+    throw std::invalid_argument("at least one request must be allowed in flight");
+  }
+  state_->node_base = node_base_interface;
+  state_->node_graph = node_graph_interface;
+  state_->node_services = node_services_interface;
+  state_->options = rcl_client_get_default_options();
+  state_->options.qos = qos_profile;
+  state_->group = group;
+  state_->max_requests_in_flight = max_requests_in_flight;
+}
+
+MultiNodeParametersClient::MultiNodeParametersClient(
+  const rclcpp::Node::SharedPtr node,
+  size_t max_requests_in_flight,
+  const rmw_qos_profile_t & qos_profile,
+  rclcpp::callback_group::CallbackGroup::SharedPtr group)
+: MultiNodeParametersClient(
+    node->get_node_base_interface(),
+    node->get_node_graph_interface(),
+    node->get_node_services_interface(),
+    max_requests_in_flight,
+    qos_profile,
+    group)
+{}
+
+MultiNodeParametersClient::~MultiNodeParametersClient()
+{
+  // The queued requests are dropped, their futures are completed with std::future_error.
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  state_->queue.clear();
+}
+
+MultiNodeParametersClient::SharedFuture
+MultiNodeParametersClient::get_parameters(
+  const std::vector<std::string> & node_names,
+  const std::vector<std::string> & names,
+  CallbackType callback,
+  std::chrono::nanoseconds timeout)
+{
+  auto batch = std::make_shared<Batch>();
+  batch->future = batch->promise.get_future().share();
+  batch->callback = callback;
+  if (node_names.empty()) {
+    batch->promise.set_value(NodeParametersMap());
+    if (callback) {
+      callback(batch->future);
+    }
+    return batch->future;
+  }
+  batch->remaining = node_names.size();
+
+  // The request is shared by the nodes, it isn't modified once sent.
+  auto request = std::make_shared<rcl_interfaces::srv::GetParameters::Request>();
+  request->names = names;
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    for (const auto & node_name : node_names) {
+      state_->queue.push_back(State::Job {node_name, request, timeout, batch});
+    }
+  }
+  auto future = batch->future;
+  State::dispatch(state_);
+  return future;
+}
+
+size_t
+MultiNodeParametersClient::get_number_of_clients() const
+{
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->clients.size();
+}
+
+size_t
+MultiNodeParametersClient::get_number_of_requests_in_flight() const
+{
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->requests_in_flight;
+}
+
+size_t
+MultiNodeParametersClient::get_number_of_queued_requests() const
+{
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->queue.size();
+}
@@ -21,36 +21,33 @@ using rclcpp::ParameterEventsFilter;
 using EventType = rclcpp::ParameterEventsFilter::EventType;
 using EventPair = rclcpp::ParameterEventsFilter::EventPair;
 
+ParameterEventsFilter::Criteria::Criteria(
+  const std::vector<std::string> & names,
+  const std::vector<EventType> & types)
+: names_(names.begin(), names.end())
+{
+  for (auto type : types) {
+    type_mask_ |= type_bit(type);
+  }
+}
+
 ParameterEventsFilter::ParameterEventsFilter(
   rcl_interfaces::msg::ParameterEvent::SharedPtr event,
   const std::vector<std::string> & names,
   const std::vector<EventType> & types)
+: ParameterEventsFilter(event, Criteria(names, types))
+{}
+
+ParameterEventsFilter::ParameterEventsFilter(
+  rcl_interfaces::msg::ParameterEvent::SharedPtr event,
+  const Criteria & criteria)
 : event_(event)
 {
-  if (std::find(types.begin(), types.end(), EventType::NEW) != types.end()) {
-    for (auto & new_parameter : event->new_parameters) {
-      if (std::find(names.begin(), names.end(), new_parameter.name) != names.end()) {
-        result_.push_back(
-          EventPair(EventType::NEW, &new_parameter));
-      }
-    }
-  }
-  if (std::find(types.begin(), types.end(), EventType::CHANGED) != types.end()) {
-    for (auto & changed_parameter : event->changed_parameters) {
-      if (std::find(names.begin(), names.end(), changed_parameter.name) != names.end()) {
-        result_.push_back(
-          EventPair(EventType::CHANGED, &changed_parameter));
-      }
-    }
-  }
-  if (std::find(types.begin(), types.end(), EventType::DELETED) != types.end()) {
-    for (auto & deleted_parameter : event->deleted_parameters) {
-      if (std::find(names.begin(), names.end(), deleted_parameter.name) != names.end()) {
-        result_.push_back(
-          EventPair(EventType::DELETED, &deleted_parameter));
-      }
-    }
-  }
+  criteria.for_each_match(
+    *event,
+    [this](EventType type, rcl_interfaces::msg::Parameter & parameter) {
+      result_.push_back(EventPair(type, &parameter));
+    });
 }
 
 const std::vector<EventPair> &
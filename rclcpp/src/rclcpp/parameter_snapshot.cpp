@@ -0,0 +1,340 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "rclcpp/parameter_map.hpp"
+
+using rclcpp::exceptions::InvalidParametersException;
+using rclcpp::Parameter;
+using rclcpp::ParameterType;
+using rclcpp::ParameterValue;
+
+namespace
+{
+
+// The snapshot is written in the byte order of the host, it's meant to be read where it was
+// written, and starts with the magic, the format version and the number of parameters.
+// Each parameter is its name, its type on one byte, then its value:
+//   - bool: one byte
+//   - integer and double: 8 bytes
+//   - string: the length on 4 bytes, then the characters
+//   - arrays: the number of elements on 4 bytes, then the elements as above
+constexpr char snapshot_magic[8] = {'r', 'c', 'l', 'c', 'p', 'p', 'p', 's'};
+constexpr uint32_t snapshot_version = 1;
+
+class SnapshotWriter
+{
+public:
+  explicit SnapshotWriter(std::ofstream & stream)
+  : stream_(stream)
+  {}
+
+  template<typename T>
+  void
+  write(const T & value)
+  {
+    stream_.write(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  void
+  write_size(size_t size)
+  {
+    if (size > UINT32_MAX) {
+      throw std::length_error("parameter value too large for a parameter snapshot");
+    }
+    write(static_cast<uint32_t>(size));
+  }
+
+  void
+  write_string(const std::string & value)
+  {
+    write_size(value.size());
+    stream_.write(value.data(), static_cast<std::streamsize>(value.size()));
+  }
+
+  template<typename T>
+  void
+  write_array(const std::vector<T> & values)
+  {
+    write_size(values.size());
+    stream_.write(
+      reinterpret_cast<const char *>(values.data()),
+      static_cast<std::streamsize>(values.size() * sizeof(T)));
+  }
+
+  void
+  write_value(const ParameterValue & value)
+  {
+    write(static_cast<uint8_t>(value.get_type()));
+    switch (value.get_type()) {
+      case ParameterType::PARAMETER_NOT_SET:
+        break;
+      case ParameterType::PARAMETER_BOOL:
+        write(static_cast<uint8_t>(value.get<bool>()));
+        break;
+      case ParameterType::PARAMETER_INTEGER:
+        write(value.get<int64_t>());
+        break;
+      case ParameterType::PARAMETER_DOUBLE:
+        write(value.get<double>());
+        break;
+      case ParameterType::PARAMETER_STRING:
+        write_string(value.get<std::string>());
+        break;
+      case ParameterType::PARAMETER_BYTE_ARRAY:
+        write_array(value.get<std::vector<uint8_t>>());
+        break;
+      case ParameterType::PARAMETER_BOOL_ARRAY:
+        {
+          const auto & bools = value.get<std::vector<bool>>();
+          write_size(bools.size());
+          for (bool b : bools) {
+            write(static_cast<uint8_t>(b));
+          }
+          break;
+        }
+      case ParameterType::PARAMETER_INTEGER_ARRAY:
+        write_array(value.get<std::vector<int64_t>>());
+        break;
+      case ParameterType::PARAMETER_DOUBLE_ARRAY:
+        write_array(value.get<std::vector<double>>());
+        break;
+      case ParameterType::PARAMETER_STRING_ARRAY:
+        {
+          const auto & strings = value.get<std::vector<std::string>>();
+          write_size(strings.size());
+          for (const auto & s : strings) {
+            write_string(s);
+          }
+          break;
+        }
+      default:
+        throw std::invalid_argument("unknown type of the parameter value");
+    }
+  }
+
+private:
+  std::ofstream & stream_;
+};
+
+// Reads the snapshot in place, checking each read against the end of the data.
+class SnapshotReader
+{
+public:
+  SnapshotReader(const char * data, size_t size, const std::string & path)
+  : position_(data), end_(data + size), path_(path)
+  {}
+
+  const char *
+  take(size_t size)
+  {
+    if (size > static_cast<size_t>(end_ - position_)) {
+      throw InvalidParametersException("parameter snapshot '" + path_ + "' is truncated");
+    }
+    const char * data = position_;
+    position_ += size;
+    return data;
+  }
+
+  template<typename T>
+  T
+  read()
+  {
+    T value;
+    std::memcpy(&value, take(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string
+  read_string()
+  {
+    auto size = read<uint32_t>();
+    return std::string(take(size), size);
+  }
+
+  template<typename T>
+  std::vector<T>
+  read_array()
+  {
+    auto count = read<uint32_t>();
+    const char * data = take(static_cast<size_t>(count) * sizeof(T));
+    std::vector<T> values(count);
+    if (count > 0) {
+      std::memcpy(values.data(), data, count * sizeof(T));
+    }
+    return values;
+  }
+
+  ParameterValue
+  read_value()
+  {
+    switch (static_cast<ParameterType>(read<uint8_t>())) {
+      case ParameterType::PARAMETER_NOT_SET:
+        return ParameterValue();
+      case ParameterType::PARAMETER_BOOL:
+        return ParameterValue(read<uint8_t>() != 0);
+      case ParameterType::PARAMETER_INTEGER:
+        return ParameterValue(read<int64_t>());
+      case ParameterType::PARAMETER_DOUBLE:
+        return ParameterValue(read<double>());
+      case ParameterType::PARAMETER_STRING:
+        return ParameterValue(read_string());
+      case ParameterType::PARAMETER_BYTE_ARRAY:
+        return ParameterValue(read_array<uint8_t>());
+      case ParameterType::PARAMETER_BOOL_ARRAY:
+        {
+          auto bytes = read_array<uint8_t>();
+          return ParameterValue(std::vector<bool>(bytes.begin(), bytes.end()));
+        }
+      case ParameterType::PARAMETER_INTEGER_ARRAY:
+        return ParameterValue(read_array<int64_t>());
+      case ParameterType::PARAMETER_DOUBLE_ARRAY:
+        return ParameterValue(read_array<double>());
+      case ParameterType::PARAMETER_STRING_ARRAY:
+        {
+          auto count = read<uint32_t>();
+          std::vector<std::string> strings;
+          strings.reserve(count);
+          for (uint32_t i = 0; i < count; ++i) {
+            strings.push_back(read_string());
+          }
+          return ParameterValue(strings);
+        }
+      default:
+        throw InvalidParametersException(
+                "parameter snapshot '" + path_ + "' has a value of unknown type");
+    }
+  }
+
+  std::vector<Parameter>
+  read_parameters()
+  {
+    if (std::memcmp(take(sizeof(snapshot_magic)), snapshot_magic, sizeof(snapshot_magic)) != 0) {
+      throw InvalidParametersException("'" + path_ + "' is not a parameter snapshot");
+    }
+    if (read<uint32_t>() != snapshot_version) {
+      throw InvalidParametersException(
+              "parameter snapshot '" + path_ + "' has an unsupported version");
+    }
+    auto count = read<uint32_t>();
+    std::vector<Parameter> parameters;
+    parameters.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+      std::string name = read_string();
+      parameters.emplace_back(name, read_value());
+    }
+    return parameters;
+  }
+
+private:
+  const char * position_;
+  const char * end_;
+  const std::string & path_;
+};
+
+}  // namespace
+
+void
+rclcpp::write_parameter_snapshot(
+  const std::string & path, const std::vector<Parameter> & parameters)
+{
+  // Write a temporary file renamed at the end, so a crash never leaves a partial snapshot.
+  std::string temporary_path = path + ".tmp";
+  {
+    std::ofstream stream(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+      throw std::runtime_error(
+              "failed to create parameter snapshot '" + path + "': " + std::strerror(errno));
+    }
+    SnapshotWriter writer(stream);
+    stream.write(snapshot_magic, sizeof(snapshot_magic));
+    writer.write(snapshot_version);
+    writer.write_size(parameters.size());
+    for (const auto & parameter : parameters) {
+      writer.write_string(parameter.get_name());
+      writer.write_value(parameter.get_parameter_value());
+    }
+    stream.close();
+    if (!stream) {
+      std::remove(temporary_path.c_str());
+      throw std::runtime_error("failed to write parameter snapshot '" + path + "'");
+    }
+  }
+  if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+    auto error = std::string(std::strerror(errno));
+    std::remove(temporary_path.c_str());
+    throw std::runtime_error("failed to write parameter snapshot '" + path + "': " + error);
+  }
+}
+
+std::vector<Parameter>
+rclcpp::read_parameter_snapshot(const std::string & path)
+{
+#ifdef _WIN32
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) {
+    throw std::runtime_error("failed to open parameter snapshot '" + path + "'");
+  }
+  std::vector<char> data(
+    (std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+  return SnapshotReader(data.data(), data.size(), path).read_parameters();
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  struct stat file_stat;
+  if (fd < 0 || fstat(fd, &file_stat) != 0) {
+    auto error = std::string(std::strerror(errno));
+    if (fd >= 0) {
+      close(fd);
+    }
+    throw std::runtime_error("failed to open parameter snapshot '" + path + "': " + error);
+  }
+  auto size = static_cast<size_t>(file_stat.st_size);
+  if (0u == size) {
+    close(fd);
+    throw InvalidParametersException("'" + path + "' is not a parameter snapshot");
+  }
+  void * memory = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping stays valid once the file is closed.
+  close(fd);
+  if (memory == MAP_FAILED) {
+    throw std::runtime_error(
+            "failed to map parameter snapshot '" + path + "': " + std::strerror(errno));
+  }
+  try {
+    auto parameters =
+      SnapshotReader(static_cast<const char *>(memory), size, path).read_parameters();
+    munmap(memory, size);
+    return parameters;
+  } catch (...) {
+    munmap(memory, size);
+    throw;
+  }
+#endif
+}
@@ -109,23 +109,42 @@ rclcpp::to_string(const ParameterValue & value)
 }
 
 ParameterValue::ParameterValue()
+: type_(ParameterType::PARAMETER_NOT_SET)
 {
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_NOT_SET;
+  scalar_.integer_value = 0;
 }
 
 ParameterValue::ParameterValue(const rcl_interfaces::msg::ParameterValue & value)
+: ParameterValue()
 {
-  value_ = value;
   switch (value.type) {
     case PARAMETER_BOOL:
+      *this = ParameterValue(value.bool_value);
+      break;
     case PARAMETER_INTEGER:
+      *this = ParameterValue(value.integer_value);
+      break;
     case PARAMETER_DOUBLE:
+      *this = ParameterValue(value.double_value);
+      break;
     case PARAMETER_STRING:
+      *this = ParameterValue(value.string_value);
+      break;
     case PARAMETER_BYTE_ARRAY:
+      *this = ParameterValue(value.byte_array_value);
+      break;
     case PARAMETER_BOOL_ARRAY:
+      *this = ParameterValue(value.bool_array_value);
+      break;
     case PARAMETER_INTEGER_ARRAY:
+      *this = ParameterValue(value.integer_array_value);
+      break;
     case PARAMETER_DOUBLE_ARRAY:
+      *this = ParameterValue(value.double_array_value);
+      break;
     case PARAMETER_STRING_ARRAY:
+      *this = ParameterValue(value.string_array_value);
+      break;
     case PARAMETER_NOT_SET:
       break;
     default:
@@ -135,39 +154,36 @@ ParameterValue::ParameterValue(const rcl_interfaces::msg::ParameterValue & value
 }
 
 ParameterValue::ParameterValue(const bool bool_value)
+: type_(ParameterType::PARAMETER_BOOL)
 {
-  value_.bool_value = bool_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL;
+  scalar_.bool_value = bool_value;
 }
 
 ParameterValue::ParameterValue(const int int_value)
-{
-  value_.integer_value = int_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
-}
+: ParameterValue(static_cast<int64_t>(int_value))
+{}
 
 ParameterValue::ParameterValue(const int64_t int_value)
+: type_(ParameterType::PARAMETER_INTEGER)
 {
-  value_.integer_value = int_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER;
+  scalar_.integer_value = int_value;
 }
 
 ParameterValue::ParameterValue(const float double_value)
-{
-  value_.double_value = static_cast<double>(double_value);
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
-}
+: ParameterValue(static_cast<double>(double_value))
+{}
 
 ParameterValue::ParameterValue(const double double_value)
+: type_(ParameterType::PARAMETER_DOUBLE)
 {
-  value_.double_value = double_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE;
+  scalar_.double_value = double_value;
 }
 
 ParameterValue::ParameterValue(const std::string & string_value)
+: type_(ParameterType::PARAMETER_STRING),
+  string_(string_value)
 {
-  value_.string_value = string_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING;
+  scalar_.integer_value = 0;
 }
 
 ParameterValue::ParameterValue(const char * string_value)
@@ -175,67 +191,133 @@ ParameterValue::ParameterValue(const char * string_value)
 {}
 
 ParameterValue::ParameterValue(const std::vector<uint8_t> & byte_array_value)
+: type_(ParameterType::PARAMETER_BYTE_ARRAY),
+  array_(std::make_shared<std::vector<uint8_t>>(byte_array_value))
 {
-  value_.byte_array_value = byte_array_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_BYTE_ARRAY;
+  scalar_.integer_value = 0;
 }
 
 ParameterValue::ParameterValue(const std::vector<bool> & bool_array_value)
+: type_(ParameterType::PARAMETER_BOOL_ARRAY),
+  array_(std::make_shared<std::vector<bool>>(bool_array_value))
 {
-  value_.bool_array_value = bool_array_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_BOOL_ARRAY;
+  scalar_.integer_value = 0;
 }
 
 ParameterValue::ParameterValue(const std::vector<int> & int_array_value)
+: type_(ParameterType::PARAMETER_INTEGER_ARRAY),
+  array_(std::make_shared<std::vector<int64_t>>(
+      int_array_value.cbegin(), int_array_value.cend()))
 {
-  value_.integer_array_value.assign(int_array_value.cbegin(), int_array_value.cend());
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER_ARRAY;
+  scalar_.integer_value = 0;
 }
 
 ParameterValue::ParameterValue(const std::vector<int64_t> & int_array_value)
+: type_(ParameterType::PARAMETER_INTEGER_ARRAY),
+  array_(std::make_shared<std::vector<int64_t>>(int_array_value))
 {
-  value_.integer_array_value = int_array_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_INTEGER_ARRAY;
+  scalar_.integer_value = 0;
 }
 
 ParameterValue::ParameterValue(const std::vector<float> & float_array_value)
+: type_(ParameterType::PARAMETER_DOUBLE_ARRAY),
+  array_(std::make_shared<std::vector<double>>(
+      float_array_value.cbegin(), float_array_value.cend()))
 {
-  value_.double_array_value.assign(float_array_value.cbegin(), float_array_value.cend());
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  scalar_.integer_value = 0;
 }
 
 ParameterValue::ParameterValue(const std::vector<double> & double_array_value)
+: type_(ParameterType::PARAMETER_DOUBLE_ARRAY),
+  array_(std::make_shared<std::vector<double>>(double_array_value))
 {
-  value_.double_array_value = double_array_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_DOUBLE_ARRAY;
+  scalar_.integer_value = 0;
 }
 
 ParameterValue::ParameterValue(const std::vector<std::string> & string_array_value)
+: type_(ParameterType::PARAMETER_STRING_ARRAY),
+  array_(std::make_shared<std::vector<std::string>>(string_array_value))
 {
-  value_.string_array_value = string_array_value;
-  value_.type = rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY;
+  scalar_.integer_value = 0;
 }
 
 ParameterType
 ParameterValue::get_type() const
 {
-  return static_cast<ParameterType>(value_.type);
+  return type_;
 }
 
 rcl_interfaces::msg::ParameterValue
 ParameterValue::to_value_msg() const
 {
-  return value_;
+  rcl_interfaces::msg::ParameterValue value;
+  value.type = type_;
+  switch (type_) {
+    case PARAMETER_BOOL:
+      value.bool_value = scalar_.bool_value;
+      break;
+    case PARAMETER_INTEGER:
+      value.integer_value = scalar_.integer_value;
+      break;
+    case PARAMETER_DOUBLE:
+      value.double_value = scalar_.double_value;
+      break;
+    case PARAMETER_STRING:
+      value.string_value = string_;
+      break;
+    case PARAMETER_BYTE_ARRAY:
+      value.byte_array_value = get<PARAMETER_BYTE_ARRAY>();
+      break;
+    case PARAMETER_BOOL_ARRAY:
+      value.bool_array_value = get<PARAMETER_BOOL_ARRAY>();
+      break;
+    case PARAMETER_INTEGER_ARRAY:
+      value.integer_array_value = get<PARAMETER_INTEGER_ARRAY>();
+      break;
+    case PARAMETER_DOUBLE_ARRAY:
+      value.double_array_value = get<PARAMETER_DOUBLE_ARRAY>();
+      break;
+    case PARAMETER_STRING_ARRAY:
+      value.string_array_value = get<PARAMETER_STRING_ARRAY>();
+      break;
+    default:
+      break;
+  }
+  return value;
 }
 
 bool
 ParameterValue::operator==(const ParameterValue & rhs) const
 {
-  return this->value_ == rhs.value_;
+  if (type_ != rhs.type_) {
+    return false;
+  }
+  switch (type_) {
+    case PARAMETER_BOOL:
+      return scalar_.bool_value == rhs.scalar_.bool_value;
+    case PARAMETER_INTEGER:
+      return scalar_.integer_value == rhs.scalar_.integer_value;
+    case PARAMETER_DOUBLE:
+      return scalar_.double_value == rhs.scalar_.double_value;
+    case PARAMETER_STRING:
+      return string_ == rhs.string_;
+    case PARAMETER_BYTE_ARRAY:
+      return get<PARAMETER_BYTE_ARRAY>() == rhs.get<PARAMETER_BYTE_ARRAY>();
+    case PARAMETER_BOOL_ARRAY:
+      return get<PARAMETER_BOOL_ARRAY>() == rhs.get<PARAMETER_BOOL_ARRAY>();
+    case PARAMETER_INTEGER_ARRAY:
+      return get<PARAMETER_INTEGER_ARRAY>() == rhs.get<PARAMETER_INTEGER_ARRAY>();
+    case PARAMETER_DOUBLE_ARRAY:
+      return get<PARAMETER_DOUBLE_ARRAY>() == rhs.get<PARAMETER_DOUBLE_ARRAY>();
+    case PARAMETER_STRING_ARRAY:
+      return get<PARAMETER_STRING_ARRAY>() == rhs.get<PARAMETER_STRING_ARRAY>();
+    default:
+      return true;
+  }
 }
 
 bool
 ParameterValue::operator!=(const ParameterValue & rhs) const
 {
-  return this->value_ != rhs.value_;
+  return !(*this == rhs);
 }
@@ -17,10 +17,13 @@
 #include <rmw/error_handling.h>
 #include <rmw/rmw.h>
 
+#include <chrono>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -29,9 +32,11 @@
 
 #include "rclcpp/allocator/allocator_common.hpp"
 #include "rclcpp/allocator/allocator_deleter.hpp"
+#include "rclcpp/detail/utilities.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/expand_topic_or_service_name.hpp"
 #include "rclcpp/experimental/intra_process_manager.hpp"
+#include "rclcpp/experimental/shared_writer_manager.hpp"
 #include "rclcpp/logging.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/node.hpp"
@@ -42,31 +47,68 @@ PublisherBase::PublisherBase(
   rclcpp::node_interfaces::NodeBaseInterface * node_base,
   const std::string & topic,
   const rosidl_message_type_support_t & type_support,
-  const rcl_publisher_options_t & publisher_options)
+  const rcl_publisher_options_t & publisher_options,
+  bool share_writer,
+  bool use_intra_process)
 : rcl_node_handle_(node_base->get_shared_rcl_node_handle()),
-  intra_process_is_enabled_(false), intra_process_publisher_id_(0)
-{
-  rcl_ret_t ret = rcl_publisher_init(
-    &publisher_handle_,
-    rcl_node_handle_.get(),
-    &type_support,
-    topic.c_str(),
-    &publisher_options);
-  if (ret != RCL_RET_OK) {
-    if (ret == RCL_RET_TOPIC_NAME_INVALID) {
-      auto rcl_node_handle = rcl_node_handle_.get();
-      // this will throw on any validation problem
-      rcl_reset_error();
-      expand_topic_or_service_name(
-        topic,
-        rcl_node_get_name(rcl_node_handle),
-        rcl_node_get_namespace(rcl_node_handle));
-    }
+  intra_process_is_enabled_(false), intra_process_publisher_id_(0),
+  cached_subscription_count_(0),
+  subscription_count_settle_deadline_ns_(std::numeric_limits<int64_t>::min())
+{
+  // A shared rcl node has none of the names and arguments of this node.
+  const std::string rcl_topic =
+    node_base->shares_rcl_node() ? node_base->resolve_topic_or_service_name(topic, false) : topic;
+  auto create_publisher_handle =
+    [this, node_base, &type_support, &rcl_topic, &publisher_options]() {
+      auto publisher_handle = std::shared_ptr<rcl_publisher_t>(
+        new rcl_publisher_t,
+        [rcl_node_handle = rcl_node_handle_](rcl_publisher_t * rcl_publisher) {
+          if (rcl_publisher_fini(rcl_publisher, rcl_node_handle.get()) != RCL_RET_OK) {
+            RCUTILS_LOG_ERROR_NAMED(
+              "rclcpp",
+              "Error in destruction of rcl publisher handle: %s",
+              rcl_get_error_string().str);
+            rcl_reset_error();
+          }
+          delete rcl_publisher;
+        });
+      *publisher_handle = rcl_get_zero_initialized_publisher();
 
-    rclcpp::exceptions::throw_from_rcl_error(ret, "could not create publisher");
+      rcl_ret_t ret = rcl_publisher_init(
+        publisher_handle.get(),
+        rcl_node_handle_.get(),
+        &type_support,
+        rcl_topic.c_str(),
+        &publisher_options);
+      if (ret != RCL_RET_OK) {
+        if (ret == RCL_RET_TOPIC_NAME_INVALID) {
+          // this will throw on any validation problem
+          rcl_reset_error();
+          expand_topic_or_service_name(
+            rcl_topic, node_base->get_name(), node_base->get_namespace());
+        }
+
+        rclcpp::exceptions::throw_from_rcl_error(ret, "could not create publisher");
+      }
+      return publisher_handle;
+    };
+
+  if (share_writer) {
+    // The handle is finalized with the node of the publisher which created it, the rcl node is
+    // kept alive until then.
+    auto shared_writer_manager =
+      node_base->get_context()->get_sub_context<rclcpp::experimental::SharedWriterManager>();
+    std::string key = rclcpp::detail::topic_endpoint_key(
+      node_base->resolve_topic_or_service_name(topic, false), type_support,
+      publisher_options.qos) +
+      (use_intra_process ? " intra_process" : "");
+    publisher_handle_ = shared_writer_manager->get_writer(key, create_publisher_handle);
+    shared_writer_manager_ = shared_writer_manager;
+  } else {
+    publisher_handle_ = create_publisher_handle();
   }
   // Life time of this object is tied to the publisher handle.
-  rmw_publisher_t * publisher_rmw_handle = rcl_publisher_get_rmw_handle(&publisher_handle_);
+  rmw_publisher_t * publisher_rmw_handle = rcl_publisher_get_rmw_handle(publisher_handle_.get());
   if (!publisher_rmw_handle) {
     auto msg = std::string("failed to get rmw handle: ") + rcl_get_error_string().str;
     rcl_reset_error();
@@ -84,13 +126,11 @@ PublisherBase::~PublisherBase()
   // must fini the events before fini-ing the publisher
   event_handlers_.clear();
 
-  if (rcl_publisher_fini(&publisher_handle_, rcl_node_handle_.get()) != RCL_RET_OK) {
-    RCUTILS_LOG_ERROR_NAMED(
-      "rclcpp",
-      "Error in destruction of rcl publisher handle: %s",
-      rcl_get_error_string().str);
-    rcl_reset_error();
+  if (shared_writer_manager_) {
+    shared_writer_manager_->release_writer(publisher_handle_.get());
   }
+  // Finalized here unless other publishers share it.
+  publisher_handle_.reset();
 
   auto ipm = weak_ipm_.lock();
 
@@ -110,13 +150,14 @@ PublisherBase::~PublisherBase()
 const char *
 PublisherBase::get_topic_name() const
 {
-  return rcl_publisher_get_topic_name(&publisher_handle_);
+  return rcl_publisher_get_topic_name(publisher_handle_.get());
 }
 
 size_t
 PublisherBase::get_queue_size() const
 {
-  const rcl_publisher_options_t * publisher_options = rcl_publisher_get_options(&publisher_handle_);
+  const rcl_publisher_options_t * publisher_options =
+    rcl_publisher_get_options(publisher_handle_.get());
   if (!publisher_options) {
     auto msg = std::string("failed to get publisher options: ") + rcl_get_error_string().str;
     rcl_reset_error();
@@ -134,13 +175,19 @@ PublisherBase::get_gid() const
 rcl_publisher_t *
 PublisherBase::get_publisher_handle()
 {
-  return &publisher_handle_;
+  return publisher_handle_.get();
 }
 
 const rcl_publisher_t *
 PublisherBase::get_publisher_handle() const
 {
-  return &publisher_handle_;
+  return publisher_handle_.get();
+}
+
+bool
+PublisherBase::has_shared_writer() const
+{
+  return shared_writer_manager_ != nullptr;
 }
 
 const std::vector<std::shared_ptr<rclcpp::QOSEventHandlerBase>> &
@@ -149,19 +196,20 @@ PublisherBase::get_event_handlers() const
   return event_handlers_;
 }
 
+static
 size_t
-PublisherBase::get_subscription_count() const
+query_subscription_count(const rcl_publisher_t * publisher_handle)
 {
   size_t inter_process_subscription_count = 0;
 
   rcl_ret_t status = rcl_publisher_get_subscription_count(
-    &publisher_handle_,
+    publisher_handle,
     &inter_process_subscription_count);
 
   if (RCL_RET_PUBLISHER_INVALID == status) {
     rcl_reset_error();  /* next call will reset error message if not context */
-    if (rcl_publisher_is_valid_except_context(&publisher_handle_)) {
-      rcl_context_t * context = rcl_publisher_get_context(&publisher_handle_);
+    if (rcl_publisher_is_valid_except_context(publisher_handle)) {
+      rcl_context_t * context = rcl_publisher_get_context(publisher_handle);
       if (nullptr != context && !rcl_context_is_valid(context)) {
         /* publisher is invalid due to context being shutdown */
         return 0;
@@ -174,27 +222,100 @@ PublisherBase::get_subscription_count() const
   return inter_process_subscription_count;
 }
 
+/// Period during which the subscription count is queried after a graph change.
+static constexpr std::chrono::milliseconds subscription_count_settle_period(100);
+
+size_t
+PublisherBase::get_subscription_count() const
+{
+  if (!graph_event_) {
+    return query_subscription_count(publisher_handle_.get());
+  }
+  constexpr int64_t settled = std::numeric_limits<int64_t>::min();
+  if (graph_event_->check_and_clear()) {
+    auto deadline = std::chrono::steady_clock::now() + subscription_count_settle_period;
+    subscription_count_settle_deadline_ns_.store(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count());
+  }
+  int64_t deadline_ns = subscription_count_settle_deadline_ns_.load();
+  if (settled == deadline_ns) {
+    return cached_subscription_count_.load(std::memory_order_relaxed);
+  }
+  int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+  if (now_ns >= deadline_ns) {
+    // Query a last time, the cached count is used from now on.
+    subscription_count_settle_deadline_ns_.compare_exchange_strong(deadline_ns, settled);
+  }
+  size_t count = query_subscription_count(publisher_handle_.get());
+  cached_subscription_count_.store(count, std::memory_order_relaxed);
+  return count;
+}
+
 size_t
 PublisherBase::get_intra_process_subscription_count() const
 {
-  auto ipm = weak_ipm_.lock();
   if (!intra_process_is_enabled_) {
     return 0;
   }
-  if (!ipm) {
+  if (weak_ipm_.expired()) {
     // TODO(ivanpauno): should this just return silently? Or maybe return with a warning?
     //                  Same as wjwwood comment in publisher_factory create_shared_publish_callback.
     throw std::runtime_error(
             "intra process subscriber count called after "
             "destruction of intra process manager");
   }
-  return ipm->get_subscription_count(intra_process_publisher_id_);
+  if (!intra_process_subscription_count_) {
+    return 0;
+  }
+  return intra_process_subscription_count_->load();
+}
+
+size_t
+PublisherBase::get_full_intra_process_subscription_count() const
+{
+  if (!intra_process_is_enabled_) {
+    return 0;
+  }
+  auto ipm = weak_ipm_.lock();
+  if (!ipm) {
+    throw std::runtime_error(
+            "intra process full subscription count called after "
+            "destruction of intra process manager");
+  }
+  return ipm->get_full_subscription_count(intra_process_publisher_id_);
+}
+
+bool
+PublisherBase::is_subscription_count_cache_requested() const
+{
+  return subscription_count_cache_requested_;
+}
+
+size_t
+PublisherBase::get_intra_process_broadcast_depth() const
+{
+  return intra_process_broadcast_depth_;
+}
+
+void
+PublisherBase::enable_subscription_count_cache(rclcpp::Event::SharedPtr graph_event)
+{
+  if (!graph_event) {
+    throw std::invalid_argument("graph event is null");
+  }
+  cached_subscription_count_.store(query_subscription_count(publisher_handle_.get()));
+  // Changes before the event was registered are not signaled, let the count settle.
+  auto deadline = std::chrono::steady_clock::now() + subscription_count_settle_period;
+  subscription_count_settle_deadline_ns_.store(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count());
+  graph_event_ = std::move(graph_event);
 }
 
 rclcpp::QoS
 PublisherBase::get_actual_qos() const
 {
-  const rmw_qos_profile_t * qos = rcl_publisher_get_actual_qos(&publisher_handle_);
+  const rmw_qos_profile_t * qos = rcl_publisher_get_actual_qos(publisher_handle_.get());
   if (!qos) {
     auto msg = std::string("failed to get qos settings: ") + rcl_get_error_string().str;
     rcl_reset_error();
@@ -207,13 +328,13 @@ PublisherBase::get_actual_qos() const
 bool
 PublisherBase::assert_liveliness() const
 {
-  return RCL_RET_OK == rcl_publisher_assert_liveliness(&publisher_handle_);
+  return RCL_RET_OK == rcl_publisher_assert_liveliness(publisher_handle_.get());
 }
 
 bool
 PublisherBase::can_loan_messages() const
 {
-  return rcl_publisher_can_loan_messages(&publisher_handle_);
+  return rcl_publisher_can_loan_messages(publisher_handle_.get());
 }
 
 bool
@@ -242,5 +363,19 @@ PublisherBase::setup_intra_process(
 {
   intra_process_publisher_id_ = intra_process_publisher_id;
   weak_ipm_ = ipm;
+  auto subscriptions = ipm->get_publisher_subscriptions(intra_process_publisher_id);
+  if (subscriptions) {
+    // Share the ownership of the handle, to read its count without the manager.
+    intra_process_subscription_count_ = std::shared_ptr<const std::atomic<size_t>>(
+      subscriptions, &subscriptions->count());
+  }
   intra_process_is_enabled_ = true;
 }
+
+rclcpp::MemoryUsage
+PublisherBase::get_memory_usage() const
+{
+  rclcpp::MemoryUsage usage;
+  usage.entity_bytes = sizeof(*this);
+  return usage;
+}
@@ -0,0 +1,150 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/realtime.hpp"
+
+#ifndef _WIN32
+#include <alloca.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+size_t
+get_page_size()
+{
+#ifndef _WIN32
+  long page_size = sysconf(_SC_PAGESIZE);  // NOLINT(runtime/int): type of sysconf
+  if (page_size > 0) {
+    return static_cast<size_t>(page_size);
+  }
+#endif
+  return 4096u;
+}
+
+void
+touch_pages(volatile char * memory, size_t size, size_t page_size)
+{
+  for (size_t offset = 0; offset < size; offset += page_size) {
+    memory[offset] = 0;
+  }
+}
+
+}  // namespace
+
+void
+rclcpp::RealtimeWarmUpRegistry::add_warm_up(std::function<void()> warm_up)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  warm_ups_.push_back(std::move(warm_up));
+}
+
+void
+rclcpp::RealtimeWarmUpRegistry::warm_up()
+{
+  std::vector<std::function<void()>> warm_ups;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    warm_ups = warm_ups_;
+  }
+  for (const auto & warm_up : warm_ups) {
+    warm_up();
+  }
+}
+
+rclcpp::PageFaultCounts
+rclcpp::get_page_fault_counts()
+{
+  PageFaultCounts counts;
+#ifndef _WIN32
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    counts.minor_faults = static_cast<uint64_t>(usage.ru_minflt);
+    counts.major_faults = static_cast<uint64_t>(usage.ru_majflt);
+  }
+#endif
+  return counts;
+}
+
+void
+rclcpp::prefault_stack(size_t size)
+{
+  if (size == 0) {
+    return;
+  }
+#ifdef _WIN32
+  throw std::runtime_error("stack prefaulting is not supported on this platform");
+#else
+  // The frame is released on return, the pages stay mapped, and locked with mlockall().
+  touch_pages(static_cast<volatile char *>(alloca(size)), size, get_page_size());
+#endif
+}
+
+rclcpp::RealtimeActivationReport
+rclcpp::activate_realtime(rclcpp::Context::SharedPtr context)
+{
+  if (!context) {
+    context = rclcpp::contexts::default_context::get_global_default_context();
+  }
+  const RealtimeOptions & options = context->get_init_options().realtime;
+  RealtimeActivationReport report;
+  report.before = get_page_fault_counts();
+
+  if (options.lock_memory) {
+#ifdef _WIN32
+    throw std::runtime_error("memory locking is not supported on this platform");
+#else
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+      throw std::runtime_error(
+              std::string("failed to lock the memory of the process: ") + std::strerror(errno));
+    }
+#if defined(__GLIBC__)
+    // Keep the freed heap, and serve the large allocations from it rather than new mappings.
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+#endif
+#endif
+  }
+  if (options.heap_prefault_size > 0) {
+    void * heap = std::malloc(options.heap_prefault_size);
+    if (!heap) {
+      throw std::bad_alloc();
+    }
+    touch_pages(static_cast<volatile char *>(heap), options.heap_prefault_size, get_page_size());
+    std::free(heap);
+  }
+  prefault_stack(options.stack_prefault_size);
+  context->get_sub_context<RealtimeWarmUpRegistry>()->warm_up();
+
+  report.after = get_page_fault_counts();
+  return report;
+}
@@ -0,0 +1,62 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/serialization.hpp"
+
+#include <stdexcept>
+
+#include "rmw/rmw.h"
+
+#include "rclcpp/exceptions.hpp"
+
+namespace rclcpp
+{
+
+SerializationBase::SerializationBase(const rosidl_message_type_support_t * type_support)
+: type_support_(type_support)
+{
+  if (!type_support_) {
+    throw std::invalid_argument("type support of a serialization can't be nullptr");
+  }
+}
+
+void
+SerializationBase::serialize_message(
+  const void * ros_message, SerializedMessage & serialized_message) const
+{
+  if (!ros_message) {
+    throw std::invalid_argument("message to serialize can't be nullptr");
+  }
+  auto ret = rmw_serialize(
+    ros_message, type_support_, &serialized_message.get_rcl_serialized_message());
+  if (RMW_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to serialize message");
+  }
+}
+
+void
+SerializationBase::deserialize_message(
+  const rcl_serialized_message_t & serialized_message, void * ros_message) const
+{
+  if (!ros_message) {
+    throw std::invalid_argument("message to deserialize into can't be nullptr");
+  }
+  auto ret = rmw_deserialize(&serialized_message, type_support_, ros_message);
+  if (RMW_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to deserialize message");
+  }
+}
+
+}  // namespace rclcpp
@@ -0,0 +1,451 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/serialized_message.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define RCLCPP_SERIALIZED_MESSAGE_SSSE3
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RCLCPP_SERIALIZED_MESSAGE_NEON
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "rcl/allocator.h"
+#include "rcl/error_handling.h"
+#include "rcutils/logging_macros.h"
+#include "rmw/serialized_message.h"
+
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/experimental/serialized_message.hpp"
+
+namespace
+{
+
+/// Reverse the byte order of the elements one by one, the source may be the destination.
+template<size_t ElementSize>
+void
+reverse_byte_order(uint8_t * destination, const uint8_t * source, size_t count)
+{
+  for (size_t i = 0; i < count; ++i) {
+    uint8_t element[ElementSize];
+    std::memcpy(element, source + i * ElementSize, ElementSize);
+    for (size_t byte = 0; byte < ElementSize; ++byte) {
+      destination[i * ElementSize + byte] = element[ElementSize - 1 - byte];
+    }
+  }
+}
+
+#if defined(RCLCPP_SERIALIZED_MESSAGE_SSSE3)
+/// Reverse the byte order of the elements 16 bytes at a time, return the number of elements done.
+__attribute__((target("ssse3")))
+size_t
+swap_byte_order_simd(
+  uint8_t * destination, const uint8_t * source, size_t count, size_t element_size)
+{
+  __m128i shuffle;
+  if (2 == element_size) {
+    shuffle = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+  } else if (4 == element_size) {
+    shuffle = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  } else {
+    shuffle = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+  }
+  const size_t size = count * element_size;
+  size_t offset = 0;
+  for (; offset + 16 <= size; offset += 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + offset));
+    _mm_storeu_si128(
+      reinterpret_cast<__m128i *>(destination + offset), _mm_shuffle_epi8(block, shuffle));
+  }
+  return offset / element_size;
+}
+
+bool
+has_simd()
+{
+  static const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+  return has_ssse3;
+}
+#elif defined(RCLCPP_SERIALIZED_MESSAGE_NEON)
+size_t
+swap_byte_order_simd(
+  uint8_t * destination, const uint8_t * source, size_t count, size_t element_size)
+{
+  const size_t size = count * element_size;
+  size_t offset = 0;
+  for (; offset + 16 <= size; offset += 16) {
+    uint8x16_t block = vld1q_u8(source + offset);
+    if (2 == element_size) {
+      block = vrev16q_u8(block);
+    } else if (4 == element_size) {
+      block = vrev32q_u8(block);
+    } else {
+      block = vrev64q_u8(block);
+    }
+    vst1q_u8(destination + offset, block);
+  }
+  return offset / element_size;
+}
+
+bool
+has_simd()
+{
+  return true;
+}
+#else
+size_t
+swap_byte_order_simd(uint8_t *, const uint8_t *, size_t, size_t)
+{
+  return 0;
+}
+
+bool
+has_simd()
+{
+  return false;
+}
+#endif
+
+/// Grow the buffer of the message geometrically, to append `size` bytes.
+void
+reserve_to_append(rclcpp::SerializedMessage & message, size_t size)
+{
+  if (size > std::numeric_limits<size_t>::max() - message.size()) {
+    throw std::bad_alloc();
+  }
+  size_t required = message.size() + size;
+  if (required > message.capacity()) {
+    message.reserve(std::max(required, 2 * message.capacity()));
+  }
+}
+
+}  // namespace
+
+namespace rclcpp
+{
+
+void
+copy_primitive_array(
+  void * destination, const void * source, size_t count, size_t element_size,
+  bool swap_byte_order)
+{
+  if (element_size != 1 && element_size != 2 && element_size != 4 && element_size != 8) {
+    throw std::invalid_argument("element_size must be 1, 2, 4 or 8");
+  }
+  if (0u == count) {
+    return;
+  }
+  if (!swap_byte_order || 1 == element_size) {
+    if (destination != source) {
+      std::memcpy(destination, source, count * element_size);
+    }
+    return;
+  }
+  auto destination_bytes = static_cast<uint8_t *>(destination);
+  auto source_bytes = static_cast<const uint8_t *>(source);
+  size_t done = has_simd() ?
+    swap_byte_order_simd(destination_bytes, source_bytes, count, element_size) : 0;
+  destination_bytes += done * element_size;
+  source_bytes += done * element_size;
+  count -= done;
+  if (2 == element_size) {
+    reverse_byte_order<2>(destination_bytes, source_bytes, count);
+  } else if (4 == element_size) {
+    reverse_byte_order<4>(destination_bytes, source_bytes, count);
+  } else {
+    reverse_byte_order<8>(destination_bytes, source_bytes, count);
+  }
+}
+
+SerializedMessage::SerializedMessage(const rcl_allocator_t & allocator)
+: serialized_message_(rmw_get_zero_initialized_serialized_message())
+{
+  serialized_message_.allocator = allocator;
+}
+
+SerializedMessage::SerializedMessage(size_t capacity, const rcl_allocator_t & allocator)
+: serialized_message_(rmw_get_zero_initialized_serialized_message())
+{
+  rcl_allocator_t message_allocator = allocator;
+  auto ret = rmw_serialized_message_init(&serialized_message_, capacity, &message_allocator);
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to initialize serialized message");
+  }
+}
+
+SerializedMessage::SerializedMessage(const rcl_serialized_message_t & other)
+: SerializedMessage(rcl_get_default_allocator())
+{
+  reserve(other.buffer_length);
+  if (other.buffer_length > 0) {
+    std::memcpy(serialized_message_.buffer, other.buffer, other.buffer_length);
+  }
+  serialized_message_.buffer_length = other.buffer_length;
+}
+
+SerializedMessage::SerializedMessage(rcl_serialized_message_t && other)
+: serialized_message_(other)
+{
+  other = rmw_get_zero_initialized_serialized_message();
+}
+
+SerializedMessage::SerializedMessage(const SerializedMessage & other)
+: SerializedMessage(other.serialized_message_.allocator)
+{
+  *this = other;
+}
+
+SerializedMessage::SerializedMessage(SerializedMessage && other) noexcept
+: serialized_message_(other.serialized_message_)
+{
+  other.serialized_message_ = rmw_get_zero_initialized_serialized_message();
+  other.serialized_message_.allocator = serialized_message_.allocator;
+}
+
+SerializedMessage &
+SerializedMessage::operator=(const SerializedMessage & other)
+{
+  if (this == &other) {
+    return *this;
+  }
+  const rcl_serialized_message_t & other_message = other.serialized_message_;
+  reserve(other_message.buffer_length);
+  if (other_message.buffer_length > 0) {
+    std::memcpy(serialized_message_.buffer, other_message.buffer, other_message.buffer_length);
+  }
+  serialized_message_.buffer_length = other_message.buffer_length;
+  return *this;
+}
+
+SerializedMessage &
+SerializedMessage::operator=(SerializedMessage && other) noexcept
+{
+  if (this == &other) {
+    return *this;
+  }
+  // The other message now owns the previous buffer of this one, and finalizes it.
+  std::swap(serialized_message_, other.serialized_message_);
+  other.clear();
+  return *this;
+}
+
+SerializedMessage::~SerializedMessage()
+{
+  if (!serialized_message_.buffer) {
+    return;
+  }
+  if (RCL_RET_OK != rmw_serialized_message_fini(&serialized_message_)) {
+    RCUTILS_LOG_ERROR_NAMED(
+      "rclcpp",
+      "failed to destroy serialized message: %s", rcl_get_error_string().str);
+    rcl_reset_error();
+  }
+}
+
+rcl_serialized_message_t &
+SerializedMessage::get_rcl_serialized_message()
+{
+  return serialized_message_;
+}
+
+const rcl_serialized_message_t &
+SerializedMessage::get_rcl_serialized_message() const
+{
+  return serialized_message_;
+}
+
+size_t
+SerializedMessage::size() const
+{
+  return serialized_message_.buffer_length;
+}
+
+size_t
+SerializedMessage::capacity() const
+{
+  return serialized_message_.buffer_capacity;
+}
+
+void
+SerializedMessage::reserve(size_t capacity)
+{
+  if (capacity <= serialized_message_.buffer_capacity) {
+    return;
+  }
+  auto ret = rmw_serialized_message_resize(&serialized_message_, capacity);
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to resize serialized message");
+  }
+}
+
+void
+SerializedMessage::clear()
+{
+  serialized_message_.buffer_length = 0;
+}
+
+void
+SerializedMessage::append(const void * data, size_t size)
+{
+  if (0u == size) {
+    return;
+  }
+  reserve_to_append(*this, size);
+  std::memcpy(serialized_message_.buffer + serialized_message_.buffer_length, data, size);
+  serialized_message_.buffer_length += size;
+}
+
+void
+SerializedMessage::align(size_t alignment, size_t origin)
+{
+  if (0u == alignment) {
+    throw std::invalid_argument("alignment must be a positive, non-zero value");
+  }
+  if (serialized_message_.buffer_length < origin) {
+    throw std::invalid_argument("the data is shorter than the origin of the alignment");
+  }
+  size_t misalignment = (serialized_message_.buffer_length - origin) % alignment;
+  if (0u == misalignment) {
+    return;
+  }
+  size_t padding = alignment - misalignment;
+  reserve_to_append(*this, padding);
+  std::memset(serialized_message_.buffer + serialized_message_.buffer_length, 0, padding);
+  serialized_message_.buffer_length += padding;
+}
+
+void
+SerializedMessage::append_primitive_array(
+  const void * data, size_t count, size_t element_size, bool swap_byte_order)
+{
+  if (count > std::numeric_limits<size_t>::max() / 8) {
+    throw std::bad_alloc();
+  }
+  size_t size = count * element_size;
+  reserve_to_append(*this, size);
+  copy_primitive_array(
+    serialized_message_.buffer + serialized_message_.buffer_length, data, count, element_size,
+    swap_byte_order);
+  serialized_message_.buffer_length += size;
+}
+
+void
+SerializedMessage::read_primitive_array(
+  size_t offset, void * data, size_t count, size_t element_size, bool swap_byte_order) const
+{
+  const size_t length = serialized_message_.buffer_length;
+  if (offset > length || count > (length - offset) / std::max(element_size, size_t(1))) {
+    throw std::out_of_range("the array isn't within the serialized data");
+  }
+  copy_primitive_array(
+    data, serialized_message_.buffer + offset, count, element_size, swap_byte_order);
+}
+
+void
+SerializedMessage::gather(const ConstBuffer * parts, size_t count)
+{
+  size_t size = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (parts[i].size > std::numeric_limits<size_t>::max() - size) {
+      throw std::bad_alloc();
+    }
+    size += parts[i].size;
+  }
+  clear();
+  reserve(size);
+  for (size_t i = 0; i < count; ++i) {
+    if (parts[i].size > 0) {
+      std::memcpy(
+        serialized_message_.buffer + serialized_message_.buffer_length, parts[i].data,
+        parts[i].size);
+      serialized_message_.buffer_length += parts[i].size;
+    }
+  }
+}
+
+size_t
+SerializedMessage::scatter(size_t offset, const MutableBuffer * parts, size_t count) const
+{
+  size_t copied = 0;
+  for (size_t i = 0; i < count && offset < serialized_message_.buffer_length; ++i) {
+    size_t size = std::min(parts[i].size, serialized_message_.buffer_length - offset);
+    if (size > 0) {
+      std::memcpy(parts[i].data, serialized_message_.buffer + offset, size);
+    }
+    offset += size;
+    copied += size;
+  }
+  return copied;
+}
+
+rcl_serialized_message_t
+SerializedMessage::release_rcl_serialized_message()
+{
+  rcl_serialized_message_t released = serialized_message_;
+  serialized_message_ = rmw_get_zero_initialized_serialized_message();
+  serialized_message_.allocator = released.allocator;
+  return released;
+}
+
+namespace experimental
+{
+
+std::shared_ptr<rcl_serialized_message_t>
+create_serialized_message(size_t capacity)
+{
+  auto msg = new rcl_serialized_message_t;
+  *msg = rmw_get_zero_initialized_serialized_message();
+  auto allocator = rcl_get_default_allocator();
+  auto ret = rmw_serialized_message_init(msg, capacity, &allocator);
+  if (ret != RCL_RET_OK) {
+    delete msg;
+    rclcpp::exceptions::throw_from_rcl_error(ret);
+  }
+
+  return std::shared_ptr<rcl_serialized_message_t>(
+    msg,
+    [](rcl_serialized_message_t * msg) {
+      auto fini_ret = rmw_serialized_message_fini(msg);
+      delete msg;
+      if (fini_ret != RCL_RET_OK) {
+        RCUTILS_LOG_ERROR_NAMED(
+          "rclcpp",
+          "failed to destroy serialized message: %s", rcl_get_error_string().str);
+      }
+    });
+}
+
+std::shared_ptr<rcl_serialized_message_t>
+copy_serialized_message(const rcl_serialized_message_t & message)
+{
+  auto copy = create_serialized_message(message.buffer_length);
+  if (message.buffer_length > 0) {
+    std::memcpy(copy->buffer, message.buffer, message.buffer_length);
+  }
+  copy->buffer_length = message.buffer_length;
+  return copy;
+}
+
+}  // namespace experimental
+}  // namespace rclcpp
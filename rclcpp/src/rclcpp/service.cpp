@@ -18,7 +18,9 @@
 #include <iostream>
 #include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
 
 #include "rclcpp/any_service_callback.hpp"
 #include "rclcpp/macros.hpp"
@@ -32,7 +34,12 @@ ServiceBase::ServiceBase(std::shared_ptr<rcl_node_t> node_handle)
 {}
 
 ServiceBase::~ServiceBase()
-{}
+{
+  auto intra_process_manager = intra_process_manager_.lock();
+  if (intra_process_manager && intra_process_service_) {
+    intra_process_manager->remove_service(intra_process_service_id_);
+  }
+}
 
 const char *
 ServiceBase::get_service_name()
@@ -63,3 +70,99 @@ ServiceBase::get_rcl_node_handle() const
 {
   return node_handle_.get();
 }
+
+void
+ServiceBase::set_number_of_worker_threads(size_t number_of_threads)
+{
+  rclcpp::detail::WorkerPool::SharedPtr worker_pool;
+  if (number_of_threads > 0) {
+    worker_pool = std::make_shared<rclcpp::detail::WorkerPool>(number_of_threads);
+  }
+  std::lock_guard<std::mutex> lock(worker_pool_mutex_);
+  worker_pool_.swap(worker_pool);
+}
+
+size_t
+ServiceBase::get_number_of_worker_threads() const
+{
+  std::lock_guard<std::mutex> lock(worker_pool_mutex_);
+  return worker_pool_ ? worker_pool_->get_number_of_threads() : 0;
+}
+
+rclcpp::detail::WorkerPool::SharedPtr
+ServiceBase::get_worker_pool() const
+{
+  std::lock_guard<std::mutex> lock(worker_pool_mutex_);
+  return worker_pool_;
+}
+
+void
+ServiceBase::set_max_batch_size(size_t max_batch_size)
+{
+  if (max_batch_size == 0) {
+    throw std::invalid_argument("max_batch_size must be positive");
+  }
+  max_batch_size_.store(max_batch_size);
+}
+
+size_t
+ServiceBase::get_max_batch_size() const
+{
+  return max_batch_size_.load();
+}
+
+void
+ServiceBase::set_message_pool(rclcpp::allocator::MessagePool::SharedPtr pool)
+{
+  std::atomic_store(&message_pool_, std::move(pool));
+}
+
+rclcpp::allocator::MessagePool::SharedPtr
+ServiceBase::get_message_pool() const
+{
+  return std::atomic_load(&message_pool_);
+}
+
+rclcpp::MemoryUsage
+ServiceBase::get_memory_usage() const
+{
+  rclcpp::MemoryUsage usage;
+  usage.entity_bytes = sizeof(*this);
+  auto message_pool = get_message_pool();
+  if (message_pool) {
+    usage.message_pool_bytes = message_pool->get_block_size() * message_pool->get_block_count();
+  }
+  return usage;
+}
+
+void
+ServiceBase::setup_intra_process(rclcpp::Context::SharedPtr context)
+{
+  auto intra_process_manager =
+    context->get_sub_context<rclcpp::experimental::IntraProcessServiceManager>();
+  intra_process_service_ = std::make_shared<rclcpp::experimental::ServiceIntraProcess>(
+    shared_from_this(), get_service_type(), context);
+  intra_process_service_id_ = intra_process_manager->add_service(intra_process_service_);
+  intra_process_manager_ = intra_process_manager;
+}
+
+rclcpp::Waitable::SharedPtr
+ServiceBase::get_intra_process_waitable() const
+{
+  return intra_process_service_;
+}
+
+bool
+ServiceBase::send_intra_process_response(
+  const rmw_request_id_t & header, std::shared_ptr<void> response)
+{
+  if (!rclcpp::experimental::IntraProcessServiceManager::is_intra_process_request(header)) {
+    return false;
+  }
+  // The client is gone with the manager, the response is dropped then.
+  auto intra_process_manager = intra_process_manager_.lock();
+  if (intra_process_manager) {
+    intra_process_manager->send_response(header, std::move(response));
+  }
+  return true;
+}
@@ -0,0 +1,149 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/experimental/service_intra_process.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "rcl/error_handling.h"
+
+#include "rclcpp/service.hpp"
+
+using rclcpp::experimental::ServiceIntraProcess;
+
+ServiceIntraProcess::ServiceIntraProcess(
+  std::shared_ptr<rclcpp::ServiceBase> service,
+  const std::type_info & service_type,
+  rclcpp::Context::SharedPtr context)
+: service_(service), service_name_(service->get_service_name()), service_type_(service_type)
+{
+  rcl_ret_t ret = rcl_guard_condition_init(
+    &gc_, context->get_rcl_context().get(), rcl_guard_condition_get_default_options());
+  if (RCL_RET_OK != ret) {
+    std::string error = rcl_get_error_string().str;
+    rcl_reset_error();
+    throw std::runtime_error(
+            "ServiceIntraProcess init error initializing guard condition: " + error);
+  }
+}
+
+ServiceIntraProcess::~ServiceIntraProcess()
+{
+  if (rcl_guard_condition_fini(&gc_) != RCL_RET_OK) {
+    rcl_reset_error();
+  }
+}
+
+size_t
+ServiceIntraProcess::get_number_of_ready_guard_conditions()
+{
+  return 1;
+}
+
+bool
+ServiceIntraProcess::add_to_wait_set(rcl_wait_set_t * wait_set)
+{
+  if (rcl_wait_set_add_guard_condition(wait_set, &gc_, NULL) != RCL_RET_OK) {
+    return false;
+  }
+  // The trigger may have woken up another wait set, e.g. after the service was moved.
+  if (is_ready(wait_set)) {
+    rcl_ret_t ret = rcl_trigger_guard_condition(&gc_);
+    (void)ret;
+  }
+  return true;
+}
+
+bool
+ServiceIntraProcess::is_ready(rcl_wait_set_t * wait_set)
+{
+  (void)wait_set;
+  std::lock_guard<std::mutex> lock(requests_mutex_);
+  return !requests_.empty();
+}
+
+void
+ServiceIntraProcess::execute()
+{
+  RequestQueue requests;
+  {
+    std::lock_guard<std::mutex> lock(requests_mutex_);
+    requests.swap(requests_);
+  }
+  auto service = service_.lock();
+  if (!service || requests.empty()) {
+    return;
+  }
+  auto worker_pool = service->get_worker_pool();
+  if (!service->is_batched()) {
+    for (auto & request : requests) {
+      if (!worker_pool) {
+        service->handle_request(request.first, request.second);
+        continue;
+      }
+      // The task keeps the service alive until its response is sent.
+      worker_pool->post(
+        [service, request]() {
+          service->handle_request(request.first, request.second);
+        });
+    }
+    return;
+  }
+  // Split in batches of the maximum size, as the requests taken from the middleware.
+  size_t max_batch_size = service->get_max_batch_size();
+  for (size_t begin = 0; begin < requests.size(); begin += max_batch_size) {
+    size_t end = std::min(begin + max_batch_size, requests.size());
+    auto batch = std::make_shared<rclcpp::ServiceBase::RequestBatch>(
+      std::make_move_iterator(requests.begin() + begin),
+      std::make_move_iterator(requests.begin() + end));
+    if (!worker_pool) {
+      service->handle_request_batch(*batch);
+      continue;
+    }
+    worker_pool->post(
+      [service, batch]() {
+        service->handle_request_batch(*batch);
+      });
+  }
+}
+
+void
+ServiceIntraProcess::provide_request(
+  std::shared_ptr<rmw_request_id_t> header, std::shared_ptr<void> request)
+{
+  {
+    std::lock_guard<std::mutex> lock(requests_mutex_);
+    requests_.emplace_back(std::move(header), std::move(request));
+  }
+  rcl_ret_t ret = rcl_trigger_guard_condition(&gc_);
+  (void)ret;
+}
+
+const std::string &
+ServiceIntraProcess::get_service_name() const
+{
+  return service_name_;
+}
+
+const std::type_info &
+ServiceIntraProcess::get_service_type() const
+{
+  return service_type_;
+}
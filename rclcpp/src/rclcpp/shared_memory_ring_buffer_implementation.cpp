@@ -0,0 +1,318 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/experimental/buffers/shared_memory_ring_buffer_implementation.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+
+#include "rclcpp/experimental/serialized_message.hpp"
+
+namespace rclcpp
+{
+namespace experimental
+{
+namespace buffers
+{
+
+static_assert(
+  ATOMIC_LLONG_LOCK_FREE == 2,
+  "the shared memory ring buffer requires lock-free 64 bits atomics, to share them");
+
+namespace
+{
+
+constexpr uint64_t segment_magic = 0x72636c6370707368;  // "rclcppsh"
+constexpr size_t slot_alignment = 64;
+
+size_t
+align_up(size_t size)
+{
+  return (size + slot_alignment - 1) & ~(slot_alignment - 1);
+}
+
+std::string
+segment_name(const std::string & name)
+{
+  if (!name.empty() && name[0] == '/') {
+    return name;
+  }
+  return "/" + name;
+}
+
+}  // namespace
+
+struct SharedMemoryRingBufferImplementation::Header
+{
+  /// Set last by the writer, once the segment is initialized.
+  std::atomic<uint64_t> magic;
+  uint64_t capacity;
+  uint64_t max_message_size;
+  uint64_t slot_size;
+  /// Number of messages enqueued so far.
+  std::atomic<uint64_t> write_count;
+};
+
+struct SharedMemoryRingBufferImplementation::SlotHeader
+{
+  /// 2 * message index + 1 while the message is written, + 2 once it is.
+  std::atomic<uint64_t> sequence;
+  uint64_t length;
+};
+
+SharedMemoryRingBufferImplementation::SharedMemoryRingBufferImplementation(
+  const std::string & name,
+  size_t capacity,
+  size_t max_message_size)
+: name_(segment_name(name)), owner_(true), fd_(-1), memory_(nullptr), memory_size_(0),
+  header_(nullptr), read_count_(0), dropped_count_(0)
+{
+  if (capacity == 0) {
+    throw std::invalid_argument("capacity must be a positive, non-zero value");
+  }
+  if (max_message_size == 0) {
+    throw std::invalid_argument("max_message_size must be a positive, non-zero value");
+  }
+  size_t slot_size = align_up(sizeof(SlotHeader) + max_message_size);
+  map(align_up(sizeof(Header)) + capacity * slot_size, true);
+
+  header_ = new (memory_) Header();
+  header_->capacity = capacity;
+  header_->max_message_size = max_message_size;
+  header_->slot_size = slot_size;
+  header_->write_count.store(0, std::memory_order_relaxed);
+  for (uint64_t i = 0; i < capacity; ++i) {
+    auto slot = new (get_slot(i)) SlotHeader();
+    slot->sequence.store(0, std::memory_order_relaxed);
+    slot->length = 0;
+  }
+  header_->magic.store(segment_magic, std::memory_order_release);
+}
+
+SharedMemoryRingBufferImplementation::SharedMemoryRingBufferImplementation(
+  const std::string & name)
+: name_(segment_name(name)), owner_(false), fd_(-1), memory_(nullptr), memory_size_(0),
+  header_(nullptr), read_count_(0), dropped_count_(0)
+{
+  map(0, false);
+  header_ = static_cast<Header *>(memory_);
+  read_count_ = header_->write_count.load(std::memory_order_acquire);
+}
+
+SharedMemoryRingBufferImplementation::~SharedMemoryRingBufferImplementation()
+{
+#ifndef _WIN32
+  if (memory_) {
+    munmap(memory_, memory_size_);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+  if (owner_) {
+    shm_unlink(name_.c_str());
+  }
+#endif
+}
+
+void
+SharedMemoryRingBufferImplementation::map(size_t size, bool create)
+{
+#ifdef _WIN32
+  (void)size;
+  (void)create;
+  throw std::runtime_error("shared memory ring buffers are only supported on POSIX systems");
+#else
+  if (create) {
+    // Readers of a previous segment keep their mapping, new ones open this segment.
+    shm_unlink(name_.c_str());
+    fd_ = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd_ < 0 || ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+      auto error = std::string(std::strerror(errno));
+      if (fd_ >= 0) {
+        close(fd_);
+        shm_unlink(name_.c_str());
+      }
+      owner_ = false;
+      throw std::runtime_error(
+              "failed to create shared memory segment '" + name_ + "': " + error);
+    }
+  } else {
+    fd_ = shm_open(name_.c_str(), O_RDWR, 0600);
+    struct stat segment_stat;
+    if (fd_ < 0 || fstat(fd_, &segment_stat) != 0) {
+      auto error = std::string(std::strerror(errno));
+      if (fd_ >= 0) {
+        close(fd_);
+      }
+      throw std::runtime_error(
+              "failed to open shared memory segment '" + name_ + "': " + error);
+    }
+    size = static_cast<size_t>(segment_stat.st_size);
+    if (size < sizeof(Header)) {
+      close(fd_);
+      throw std::runtime_error("shared memory segment '" + name_ + "' is not initialized");
+    }
+  }
+
+  memory_ = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (memory_ == MAP_FAILED) {
+    auto error = std::string(std::strerror(errno));
+    memory_ = nullptr;
+    close(fd_);
+    if (owner_) {
+      shm_unlink(name_.c_str());
+      owner_ = false;
+    }
+    throw std::runtime_error(
+            "failed to map shared memory segment '" + name_ + "': " + error);
+  }
+  memory_size_ = size;
+
+  if (!create) {
+    auto header = static_cast<Header *>(memory_);
+    bool valid = header->magic.load(std::memory_order_acquire) == segment_magic &&
+      align_up(sizeof(Header)) + header->capacity * header->slot_size <= size;
+    if (!valid) {
+      munmap(memory_, memory_size_);
+      memory_ = nullptr;
+      close(fd_);
+      throw std::runtime_error("shared memory segment '" + name_ + "' is not initialized");
+    }
+  }
+#endif
+}
+
+SharedMemoryRingBufferImplementation::SlotHeader *
+SharedMemoryRingBufferImplementation::get_slot(uint64_t message_index) const
+{
+  auto offset = align_up(sizeof(Header)) +
+    (message_index % header_->capacity) * header_->slot_size;
+  return reinterpret_cast<SlotHeader *>(static_cast<char *>(memory_) + offset);
+}
+
+void
+SharedMemoryRingBufferImplementation::enqueue(MessageSharedPtr request)
+{
+  if (!owner_) {
+    throw std::runtime_error("only the creator of a shared memory segment can enqueue");
+  }
+  if (request->buffer_length > header_->max_message_size) {
+    throw std::invalid_argument("message larger than the slots of the shared memory segment");
+  }
+
+  uint64_t index = header_->write_count.load(std::memory_order_relaxed);
+  auto slot = get_slot(index);
+  slot->sequence.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot->length = request->buffer_length;
+  if (request->buffer_length > 0) {
+    std::memcpy(slot + 1, request->buffer, request->buffer_length);
+  }
+  slot->sequence.store(2 * index + 2, std::memory_order_release);
+  header_->write_count.store(index + 1, std::memory_order_release);
+}
+
+SharedMemoryRingBufferImplementation::MessageSharedPtr
+SharedMemoryRingBufferImplementation::dequeue()
+{
+  for (;;) {
+    uint64_t write_count = header_->write_count.load(std::memory_order_acquire);
+    if (read_count_ >= write_count) {
+      return nullptr;
+    }
+    if (write_count - read_count_ > header_->capacity) {
+      // The oldest messages were overwritten.
+      dropped_count_ += write_count - header_->capacity - read_count_;
+      read_count_ = write_count - header_->capacity;
+    }
+
+    uint64_t index = read_count_++;
+    auto slot = get_slot(index);
+    uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+    if (sequence != 2 * index + 2) {
+      ++dropped_count_;
+      continue;
+    }
+    size_t length = slot->length;
+    if (length > header_->max_message_size) {
+      ++dropped_count_;
+      continue;
+    }
+    auto message = rclcpp::experimental::create_serialized_message(length);
+    if (length > 0) {
+      std::memcpy(message->buffer, slot + 1, length);
+    }
+    message->buffer_length = length;
+
+    // Discard the copy if the writer started to overwrite the slot meanwhile.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->sequence.load(std::memory_order_relaxed) != sequence) {
+      ++dropped_count_;
+      continue;
+    }
+    return message;
+  }
+}
+
+void
+SharedMemoryRingBufferImplementation::clear()
+{
+  read_count_ = header_->write_count.load(std::memory_order_acquire);
+}
+
+bool
+SharedMemoryRingBufferImplementation::has_data() const
+{
+  return header_->write_count.load(std::memory_order_acquire) > read_count_;
+}
+
+size_t
+SharedMemoryRingBufferImplementation::get_dropped_count() const
+{
+  return static_cast<size_t>(dropped_count_);
+}
+
+size_t
+SharedMemoryRingBufferImplementation::get_memory_usage() const
+{
+  return memory_size_;
+}
+
+size_t
+SharedMemoryRingBufferImplementation::capacity() const
+{
+  return header_->capacity;
+}
+
+size_t
+SharedMemoryRingBufferImplementation::max_message_size() const
+{
+  return header_->max_message_size;
+}
+
+}  // namespace buffers
+}  // namespace experimental
+}  // namespace rclcpp
@@ -0,0 +1,153 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/experimental/shared_reader_manager.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+SharedReaderManager::SharedReaderManager()
+{}
+
+SharedReaderManager::~SharedReaderManager()
+{}
+
+std::shared_ptr<rcl_subscription_t>
+SharedReaderManager::get_reader(
+  const std::string & key,
+  const std::function<std::shared_ptr<rcl_subscription_t>()> & create)
+{
+  // Locked while creating, so that subscriptions created concurrently share the same reader.
+  std::lock_guard<std::mutex> lock(mutex_);
+  remove_finalized_readers();
+  auto it = readers_.find(key);
+  if (it != readers_.end()) {
+    auto handle = it->second.handle.lock();
+    if (handle) {
+      return handle;
+    }
+  }
+  auto handle = create();
+  Reader & reader = readers_[key];
+  reader.handle = handle;
+  reader.subscriptions.clear();
+  keys_[handle.get()] = key;
+  return handle;
+}
+
+void
+SharedReaderManager::add_subscription(
+  const rcl_subscription_t * reader,
+  SubscriptionIntraProcessBase::WeakPtr subscription)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto key_it = keys_.find(reader);
+  if (key_it == keys_.end()) {
+    throw std::runtime_error("add_subscription() called for a reader which isn't shared");
+  }
+  auto & subscriptions = readers_[key_it->second].subscriptions;
+  subscriptions.erase(
+    std::remove_if(
+      subscriptions.begin(), subscriptions.end(),
+      [](const SubscriptionIntraProcessBase::WeakPtr & weak) {return weak.expired();}),
+    subscriptions.end());
+  subscriptions.push_back(std::move(subscription));
+}
+
+void
+SharedReaderManager::provide_message(
+  const rcl_subscription_t * reader,
+  std::shared_ptr<const void> message)
+{
+  std::vector<SubscriptionIntraProcessBase::SharedPtr> subscriptions;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto key_it = keys_.find(reader);
+    if (key_it == keys_.end()) {
+      return;
+    }
+    for (auto & weak : readers_[key_it->second].subscriptions) {
+      auto subscription = weak.lock();
+      if (subscription) {
+        subscriptions.push_back(std::move(subscription));
+      }
+    }
+  }
+  // Not locked, a subscription may block on a full buffer or run its callback right away.
+  for (auto & subscription : subscriptions) {
+    subscription->provide_shared_intra_process_message(message);
+  }
+}
+
+size_t
+SharedReaderManager::get_reader_count() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t count = 0;
+  for (auto & pair : readers_) {
+    if (!pair.second.handle.expired()) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+size_t
+SharedReaderManager::get_subscription_count(const rcl_subscription_t * reader) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto key_it = keys_.find(reader);
+  if (key_it == keys_.end()) {
+    return 0u;
+  }
+  auto & subscriptions = readers_.at(key_it->second).subscriptions;
+  return static_cast<size_t>(
+    std::count_if(
+      subscriptions.begin(), subscriptions.end(),
+      [](const SubscriptionIntraProcessBase::WeakPtr & weak) {return !weak.expired();}));
+}
+
+void
+SharedReaderManager::remove_finalized_readers()
+{
+  for (auto it = readers_.begin(); it != readers_.end(); ) {
+    if (it->second.handle.expired()) {
+      // The address of a finalized rcl subscription may be reused, forget it.
+      for (auto key_it = keys_.begin(); key_it != keys_.end(); ++key_it) {
+        if (key_it->second == it->first) {
+          keys_.erase(key_it);
+          break;
+        }
+      }
+      it = readers_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace experimental
+}  // namespace rclcpp
@@ -0,0 +1,98 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/experimental/shared_writer_manager.hpp"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+SharedWriterManager::SharedWriterManager()
+{}
+
+SharedWriterManager::~SharedWriterManager()
+{}
+
+std::shared_ptr<rcl_publisher_t>
+SharedWriterManager::get_writer(
+  const std::string & key,
+  const std::function<std::shared_ptr<rcl_publisher_t>()> & create)
+{
+  // Locked while creating, so that publishers created concurrently share the same writer.
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = writers_.find(key);
+  if (it != writers_.end()) {
+    auto handle = it->second.handle.lock();
+    if (handle) {
+      it->second.publisher_count += 1;
+      return handle;
+    }
+  }
+  auto handle = create();
+  const char * topic_name = rcl_publisher_get_topic_name(handle.get());
+  writers_[key] = Writer{handle, topic_name ? topic_name : "", 1u};
+  keys_[handle.get()] = key;
+  return handle;
+}
+
+void
+SharedWriterManager::release_writer(const rcl_publisher_t * writer)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto key_it = keys_.find(writer);
+  if (key_it == keys_.end()) {
+    return;
+  }
+  auto it = writers_.find(key_it->second);
+  it->second.publisher_count -= 1;
+  if (0u == it->second.publisher_count) {
+    // The address of the rcl publisher may be reused once it is finalized.
+    writers_.erase(it);
+    keys_.erase(key_it);
+  }
+}
+
+size_t
+SharedWriterManager::get_publisher_count(const rcl_publisher_t * writer) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto key_it = keys_.find(writer);
+  if (key_it == keys_.end()) {
+    return 0u;
+  }
+  return writers_.at(key_it->second).publisher_count;
+}
+
+size_t
+SharedWriterManager::get_additional_publisher_count(const std::string & topic_name) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t count = 0;
+  for (auto & pair : writers_) {
+    if (pair.second.topic_name == topic_name) {
+      count += pair.second.publisher_count - 1;
+    }
+  }
+  return count;
+}
+
+}  // namespace experimental
+}  // namespace rclcpp
@@ -0,0 +1,183 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/sim_time_source.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "rcl/time.h"
+
+#include "rosgraph_msgs/msg/clock.hpp"
+
+#include "rclcpp/create_subscription.hpp"
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/qos.hpp"
+#include "rclcpp/time.hpp"
+
+using rclcpp::SimTimeSource;
+
+SimTimeSource::SharedPtr
+SimTimeSource::get_instance(const rclcpp::Context::SharedPtr & context)
+{
+  return context->get_sub_context<SimTimeSource>();
+}
+
+SimTimeSource::SimTimeSource()
+: time_(std::make_shared<std::atomic<int64_t>>(0)),
+  host_key_(nullptr)
+{}
+
+SimTimeSource::~SimTimeSource()
+{
+  for (auto & clock : clocks_) {
+    clock->set_sim_time(nullptr);
+  }
+}
+
+void
+SimTimeSource::add_subscriber(
+  const void * key, rclcpp::node_interfaces::NodeTopicsInterface::SharedPtr node_topics)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  subscribers_.push_back(Subscriber {key, std::move(node_topics)});
+  update_subscription();
+}
+
+void
+SimTimeSource::remove_subscriber(const void * key)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = std::find_if(
+    subscribers_.begin(), subscribers_.end(),
+    [key](const Subscriber & subscriber) {return subscriber.key == key;});
+  if (it == subscribers_.end()) {
+    return;
+  }
+  auto node_topics = it->node_topics;
+  subscribers_.erase(it);
+  if (host_key_ == key) {
+    // Keep the subscription if another time source of the same node uses it, e.g. the one of
+    // the node and one created by the user, so no message is lost.
+    auto same_node = std::find_if(
+      subscribers_.begin(), subscribers_.end(),
+      [&node_topics](const Subscriber & subscriber) {
+        return subscriber.node_topics == node_topics;
+      });
+    if (same_node != subscribers_.end()) {
+      host_key_ = same_node->key;
+    } else {
+      subscription_.reset();
+      host_key_ = nullptr;
+      update_subscription();
+    }
+  }
+  reset_if_unused();
+}
+
+void
+SimTimeSource::attach_clock(const rclcpp::Clock::SharedPtr & clock)
+{
+  if (clock->get_clock_type() != RCL_ROS_TIME) {
+    throw std::invalid_argument("Cannot attach clock to a time source that's not a ROS clock");
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (std::find(clocks_.begin(), clocks_.end(), clock) != clocks_.end()) {
+    return;
+  }
+  auto ret = rcl_enable_ros_time_override(clock->get_clock_handle());
+  if (ret != RCL_RET_OK) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "Failed to enable ros_time_override_status");
+  }
+  clock->set_sim_time(time_);
+  clock->on_sim_time_update();
+  clocks_.push_back(clock);
+}
+
+void
+SimTimeSource::detach_clock(const rclcpp::Clock::SharedPtr & clock)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = std::find(clocks_.begin(), clocks_.end(), clock);
+  if (it == clocks_.end()) {
+    return;
+  }
+  // Leave the ROS time override at the last time, it may not have been updated yet.
+  if (clock->sync_sim_time() != RCL_RET_OK) {
+    rcl_reset_error();
+  }
+  clock->set_sim_time(nullptr);
+  clocks_.erase(it);
+  reset_if_unused();
+}
+
+void
+SimTimeSource::set_time(int64_t nanoseconds)
+{
+  time_->store(nanoseconds, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto & clock : clocks_) {
+    clock->on_sim_time_update();
+  }
+}
+
+int64_t
+SimTimeSource::get_time() const
+{
+  return time_->load(std::memory_order_relaxed);
+}
+
+size_t
+SimTimeSource::get_clock_count() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return clocks_.size();
+}
+
+bool
+SimTimeSource::has_subscription() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return subscription_ != nullptr;
+}
+
+void
+SimTimeSource::update_subscription()
+{
+  if (subscription_ || subscribers_.empty()) {
+    return;
+  }
+  std::weak_ptr<SimTimeSource> weak_this = shared_from_this();
+  subscription_ = rclcpp::create_subscription<rosgraph_msgs::msg::Clock>(
+    subscribers_.front().node_topics,
+    "/clock",
+    rclcpp::QoS(QoSInitialization::from_rmw(rmw_qos_profile_default)),
+    [weak_this](const rosgraph_msgs::msg::Clock::SharedPtr msg) {
+      auto self = weak_this.lock();
+      if (self) {
+        self->set_time(rclcpp::Time(msg->clock).nanoseconds());
+      }
+    });
+  host_key_ = subscribers_.front().key;
+}
+
+void
+SimTimeSource::reset_if_unused()
+{
+  if (clocks_.empty() && subscribers_.empty()) {
+    time_->store(0, std::memory_order_relaxed);
+  }
+}
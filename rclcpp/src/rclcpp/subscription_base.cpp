@@ -17,8 +17,10 @@
 #include <cstdio>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "rclcpp/detail/utilities.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/expand_topic_or_service_name.hpp"
 #include "rclcpp/experimental/intra_process_manager.hpp"
@@ -35,13 +37,16 @@ SubscriptionBase::SubscriptionBase(
   const rosidl_message_type_support_t & type_support_handle,
   const std::string & topic_name,
   const rcl_subscription_options_t & subscription_options,
-  bool is_serialized)
+  bool is_serialized,
+  bool share_reader)
 : node_base_(node_base),
   node_handle_(node_base_->get_shared_rcl_node_handle()),
   use_intra_process_(false),
   intra_process_subscription_id_(0),
   type_support_(type_support_handle),
-  is_serialized_(is_serialized)
+  is_serialized_(is_serialized),
+  max_messages_per_execution_(1),
+  content_filter_rejected_count_(0)
 {
   auto custom_deletor = [node_handle = this->node_handle_](rcl_subscription_t * rcl_subs)
     {
@@ -55,29 +60,47 @@ SubscriptionBase::SubscriptionBase(
       delete rcl_subs;
     };
 
-  subscription_handle_ = std::shared_ptr<rcl_subscription_t>(
-    new rcl_subscription_t, custom_deletor);
-  *subscription_handle_.get() = rcl_get_zero_initialized_subscription();
+  // A shared rcl node has none of the names and arguments of this node.
+  const std::string rcl_topic_name = node_base_->shares_rcl_node() ?
+    node_base_->resolve_topic_or_service_name(topic_name, false) : topic_name;
+  auto create_subscription_handle =
+    [this, custom_deletor, &type_support_handle, &rcl_topic_name, &subscription_options]() {
+      auto subscription_handle = std::shared_ptr<rcl_subscription_t>(
+        new rcl_subscription_t, custom_deletor);
+      *subscription_handle.get() = rcl_get_zero_initialized_subscription();
 
-  rcl_ret_t ret = rcl_subscription_init(
-    subscription_handle_.get(),
-    node_handle_.get(),
-    &type_support_handle,
-    topic_name.c_str(),
-    &subscription_options);
-  if (ret != RCL_RET_OK) {
-    if (ret == RCL_RET_TOPIC_NAME_INVALID) {
-      auto rcl_node_handle = node_handle_.get();
-      // this will throw on any validation problem
-      rcl_reset_error();
-      expand_topic_or_service_name(
-        topic_name,
-        rcl_node_get_name(rcl_node_handle),
-        rcl_node_get_namespace(rcl_node_handle));
-    }
+      rcl_ret_t ret = rcl_subscription_init(
+        subscription_handle.get(),
+        node_handle_.get(),
+        &type_support_handle,
+        rcl_topic_name.c_str(),
+        &subscription_options);
+      if (ret != RCL_RET_OK) {
+        if (ret == RCL_RET_TOPIC_NAME_INVALID) {
+          // this will throw on any validation problem
+          rcl_reset_error();
+          expand_topic_or_service_name(
+            rcl_topic_name, node_base_->get_name(), node_base_->get_namespace());
+        }
+
+        rclcpp::exceptions::throw_from_rcl_error(ret, "could not create subscription");
+      }
+      return subscription_handle;
+    };
 
-    rclcpp::exceptions::throw_from_rcl_error(ret, "could not create subscription");
+  if (!share_reader) {
+    subscription_handle_ = create_subscription_handle();
+    return;
   }
+  // The handle is finalized with the node of the subscription which created it, the rcl node
+  // is kept alive until then.
+  shared_reader_manager_ =
+    node_base_->get_context()->get_sub_context<rclcpp::experimental::SharedReaderManager>();
+  std::string key = rclcpp::detail::topic_endpoint_key(
+    node_base_->resolve_topic_or_service_name(topic_name, false), type_support_handle,
+    subscription_options.qos) +
+    (subscription_options.ignore_local_publications ? " ignore_local" : "");
+  subscription_handle_ = shared_reader_manager_->get_reader(key, create_subscription_handle);
 }
 
 SubscriptionBase::~SubscriptionBase()
@@ -139,12 +162,97 @@ SubscriptionBase::get_message_type_support_handle() const
   return type_support_;
 }
 
+bool
+SubscriptionBase::take_type_erased(void * message_out, rmw_message_info_t & message_info_out)
+{
+  rcl_ret_t ret = rcl_take(
+    subscription_handle_.get(), message_out, &message_info_out, nullptr);
+  if (RCL_RET_SUBSCRIPTION_TAKE_FAILED == ret) {
+    return false;
+  }
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to take a message");
+  }
+  return true;
+}
+
+bool
+SubscriptionBase::take_serialized(
+  rcl_serialized_message_t & message_out, rmw_message_info_t & message_info_out)
+{
+  rcl_ret_t ret = rcl_take_serialized_message(
+    subscription_handle_.get(), &message_out, &message_info_out, nullptr);
+  if (RCL_RET_SUBSCRIPTION_TAKE_FAILED == ret) {
+    return false;
+  }
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to take a serialized message");
+  }
+  return true;
+}
+
 bool
 SubscriptionBase::is_serialized() const
 {
   return is_serialized_;
 }
 
+bool
+SubscriptionBase::keeps_loaned_messages() const
+{
+  return false;
+}
+
+void
+SubscriptionBase::dispatch_message_batch()
+{}
+
+size_t
+SubscriptionBase::get_max_messages_per_execution() const
+{
+  return max_messages_per_execution_.load();
+}
+
+void
+SubscriptionBase::set_max_messages_per_execution(size_t max_messages)
+{
+  max_messages_per_execution_.store(max_messages ? max_messages : 1);
+}
+
+bool
+SubscriptionBase::has_content_filter() const
+{
+  return static_cast<bool>(content_filter_);
+}
+
+bool
+SubscriptionBase::accepts_serialized_message(const rcl_serialized_message_t & serialized_msg)
+{
+  if (!content_filter_ || content_filter_(serialized_msg)) {
+    return true;
+  }
+  content_filter_rejected_count_++;
+  return false;
+}
+
+size_t
+SubscriptionBase::get_content_filter_rejected_count() const
+{
+  return content_filter_rejected_count_.load();
+}
+
+std::shared_ptr<rclcpp::TopicStatisticsCollector>
+SubscriptionBase::get_topic_statistics() const
+{
+  return topic_statistics_;
+}
+
+void
+SubscriptionBase::set_content_filter(SubscriptionContentFilter content_filter)
+{
+  content_filter_ = std::move(content_filter);
+}
+
 size_t
 SubscriptionBase::get_publisher_count() const
 {
@@ -173,7 +281,28 @@ SubscriptionBase::setup_intra_process(
 bool
 SubscriptionBase::can_loan_messages() const
 {
-  return rcl_subscription_can_loan_messages(subscription_handle_.get());
+  // A loaned message can't outlive the take, it can't be shared with other subscriptions.
+  return !shared_reader_manager_ && rcl_subscription_can_loan_messages(subscription_handle_.get());
+}
+
+bool
+SubscriptionBase::has_shared_reader() const
+{
+  return shared_reader_manager_ != nullptr;
+}
+
+void
+SubscriptionBase::add_to_shared_reader(
+  rclcpp::experimental::SubscriptionIntraProcessBase::WeakPtr subscription_intra_process)
+{
+  shared_reader_manager_->add_subscription(
+    subscription_handle_.get(), std::move(subscription_intra_process));
+}
+
+void
+SubscriptionBase::provide_shared_reader_message(std::shared_ptr<const void> message)
+{
+  shared_reader_manager_->provide_message(subscription_handle_.get(), std::move(message));
 }
 
 rclcpp::Waitable::SharedPtr
@@ -195,6 +324,64 @@ SubscriptionBase::get_intra_process_waitable() const
   return ipm->get_subscription_intra_process(intra_process_subscription_id_);
 }
 
+size_t
+SubscriptionBase::get_intra_process_buffer_high_water_mark() const
+{
+  if (!use_intra_process_) {
+    return 0;
+  }
+  auto ipm = weak_ipm_.lock();
+  if (!ipm) {
+    throw std::runtime_error(
+            "SubscriptionBase::get_intra_process_buffer_high_water_mark() called "
+            "after destruction of intra process manager");
+  }
+  auto subscription_intra_process =
+    ipm->get_subscription_intra_process(intra_process_subscription_id_);
+  return subscription_intra_process ?
+         subscription_intra_process->get_buffer_high_water_mark() : 0;
+}
+
+size_t
+SubscriptionBase::get_intra_process_dropped_count() const
+{
+  if (!use_intra_process_) {
+    return 0;
+  }
+  auto ipm = weak_ipm_.lock();
+  if (!ipm) {
+    throw std::runtime_error(
+            "SubscriptionBase::get_intra_process_dropped_count() called "
+            "after destruction of intra process manager");
+  }
+  auto subscription_intra_process =
+    ipm->get_subscription_intra_process(intra_process_subscription_id_);
+  return subscription_intra_process ?
+         subscription_intra_process->get_buffer_dropped_count() : 0;
+}
+
+rclcpp::MemoryUsage
+SubscriptionBase::get_memory_usage() const
+{
+  rclcpp::MemoryUsage usage;
+  usage.entity_bytes = sizeof(*this);
+  if (!use_intra_process_) {
+    return usage;
+  }
+  auto ipm = weak_ipm_.lock();
+  if (!ipm) {
+    throw std::runtime_error(
+            "SubscriptionBase::get_memory_usage() called "
+            "after destruction of intra process manager");
+  }
+  auto subscription_intra_process =
+    ipm->get_subscription_intra_process(intra_process_subscription_id_);
+  if (subscription_intra_process) {
+    usage.intra_process_buffer_bytes = subscription_intra_process->get_buffer_memory_usage();
+  }
+  return usage;
+}
+
 bool
 SubscriptionBase::matches_any_intra_process_publishers(const rmw_gid_t * sender_gid) const
 {
@@ -207,5 +394,5 @@ SubscriptionBase::matches_any_intra_process_publishers(const rmw_gid_t * sender_
             "intra process publisher check called "
             "after destruction of intra process manager");
   }
-  return ipm->matches_any_publishers(sender_gid);
+  return ipm->matches_any_publishers(intra_process_subscription_id_, sender_gid);
 }
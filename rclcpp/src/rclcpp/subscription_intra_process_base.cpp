@@ -14,15 +14,142 @@
 
 #include "rclcpp/experimental/subscription_intra_process_base.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/experimental/subscription_intra_process_group.hpp"
+
 using rclcpp::experimental::SubscriptionIntraProcessBase;
 
+static std::atomic<uint64_t> _next_wait_set_stamp {1};
+
 bool
 SubscriptionIntraProcessBase::add_to_wait_set(rcl_wait_set_t * wait_set)
 {
   std::lock_guard<std::recursive_mutex> lock(reentrant_mutex_);
 
   rcl_ret_t ret = rcl_wait_set_add_guard_condition(wait_set, &gc_, NULL);
-  return RCL_RET_OK == ret;
+  if (RCL_RET_OK != ret) {
+    return false;
+  }
+  last_wait_set_ = wait_set;
+  last_wait_set_stamp_ = _next_wait_set_stamp.fetch_add(1, std::memory_order_relaxed);
+  if (is_ready(wait_set)) {
+    trigger_guard_condition();
+  }
+  return true;
+}
+
+const rcl_wait_set_t *
+SubscriptionIntraProcessBase::get_last_wait_set(uint64_t & stamp)
+{
+  std::lock_guard<std::recursive_mutex> lock(reentrant_mutex_);
+
+  stamp = last_wait_set_stamp_;
+  return last_wait_set_;
+}
+
+void
+SubscriptionIntraProcessBase::trigger_guard_condition()
+{
+  std::shared_ptr<SubscriptionIntraProcessGroup> group;
+  {
+    std::lock_guard<std::recursive_mutex> lock(reentrant_mutex_);
+    group = group_.lock();
+  }
+  if (group) {
+    group->notify(shared_from_this());
+    return;
+  }
+  rcl_ret_t ret = rcl_trigger_guard_condition(&gc_);
+  (void)ret;
+}
+
+void
+SubscriptionIntraProcessBase::set_group(std::weak_ptr<SubscriptionIntraProcessGroup> group)
+{
+  {
+    std::lock_guard<std::recursive_mutex> lock(reentrant_mutex_);
+    group_ = std::move(group);
+  }
+  // Messages given before may have only triggered the guard condition of the subscription.
+  if (is_ready(nullptr)) {
+    trigger_guard_condition();
+  }
+}
+
+void
+SubscriptionIntraProcessBase::add_broadcast_reader(
+  rclcpp::experimental::buffers::BroadcastRingBuffer::SharedPtr ring)
+{
+  std::lock_guard<std::mutex> lock(broadcast_mutex_);
+  uint64_t cursor = ring->get_write_sequence();
+  broadcast_readers_.push_back({std::move(ring), cursor, false});
+  has_broadcast_readers_.store(true);
+}
+
+void
+SubscriptionIntraProcessBase::remove_broadcast_reader(
+  const rclcpp::experimental::buffers::BroadcastRingBuffer::SharedPtr & ring)
+{
+  std::lock_guard<std::mutex> lock(broadcast_mutex_);
+  for (auto & reader : broadcast_readers_) {
+    if (reader.ring == ring && !reader.removed) {
+      reader.removed = true;
+      break;
+    }
+  }
+}
+
+bool
+SubscriptionIntraProcessBase::broadcast_has_data() const
+{
+  if (!has_broadcast_readers_.load()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(broadcast_mutex_);
+  for (const auto & reader : broadcast_readers_) {
+    if (reader.cursor < reader.ring->get_write_sequence()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void
+SubscriptionIntraProcessBase::take_broadcast_messages(
+  std::vector<std::shared_ptr<const void>> & messages, size_t max_count)
+{
+  if (!has_broadcast_readers_.load()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(broadcast_mutex_);
+  for (auto & reader : broadcast_readers_) {
+    if (messages.size() >= max_count) {
+      break;
+    }
+    size_t skipped = reader.ring->read(
+      reader.cursor, qos_profile_.depth, messages, max_count - messages.size());
+    broadcast_dropped_count_.fetch_add(skipped, std::memory_order_relaxed);
+  }
+  // The readers removed are kept until their messages are read.
+  broadcast_readers_.erase(
+    std::remove_if(
+      broadcast_readers_.begin(), broadcast_readers_.end(),
+      [](const BroadcastReader & reader) {
+        return reader.removed && reader.cursor >= reader.ring->get_write_sequence();
+      }),
+    broadcast_readers_.end());
+  has_broadcast_readers_.store(!broadcast_readers_.empty());
+}
+
+size_t
+SubscriptionIntraProcessBase::get_broadcast_dropped_count() const
+{
+  return broadcast_dropped_count_.load(std::memory_order_relaxed);
 }
 
 const char *
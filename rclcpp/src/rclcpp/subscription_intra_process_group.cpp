@@ -0,0 +1,147 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/experimental/subscription_intra_process_group.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "rcl/error_handling.h"
+#include "rcutils/logging_macros.h"
+
+#include "rclcpp/exceptions.hpp"
+
+using rclcpp::experimental::SubscriptionIntraProcessBase;
+using rclcpp::experimental::SubscriptionIntraProcessGroup;
+
+SubscriptionIntraProcessGroup::SubscriptionIntraProcessGroup(rclcpp::Context::SharedPtr context)
+{
+  gc_ = rcl_get_zero_initialized_guard_condition();
+  rcl_ret_t ret = rcl_guard_condition_init(
+    &gc_, context->get_rcl_context().get(), rcl_guard_condition_get_default_options());
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(
+      ret, "failed to create guard condition of intra-process subscriptions");
+  }
+}
+
+SubscriptionIntraProcessGroup::~SubscriptionIntraProcessGroup()
+{
+  if (RCL_RET_OK != rcl_guard_condition_fini(&gc_)) {
+    RCUTILS_LOG_ERROR_NAMED(
+      "rclcpp",
+      "failed to destroy guard condition of intra-process subscriptions: %s",
+      rcl_get_error_string().str);
+    rcl_reset_error();
+  }
+}
+
+void
+SubscriptionIntraProcessGroup::add_subscription(
+  const SubscriptionIntraProcessBase::SharedPtr & subscription)
+{
+  subscription->set_group(shared_from_this());
+}
+
+void
+SubscriptionIntraProcessGroup::notify(SubscriptionIntraProcessBase::SharedPtr subscription)
+{
+  // A subscription already queued is executed as long as it has messages.
+  if (subscription->queued_in_group_.exchange(true)) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    queue_.push_back(std::move(subscription));
+  }
+  trigger_guard_condition();
+}
+
+size_t
+SubscriptionIntraProcessGroup::get_number_of_queued_subscriptions() const
+{
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  return queue_.size() - queue_front_;
+}
+
+size_t
+SubscriptionIntraProcessGroup::get_number_of_ready_guard_conditions()
+{
+  return 1;
+}
+
+bool
+SubscriptionIntraProcessGroup::add_to_wait_set(rcl_wait_set_t * wait_set)
+{
+  rcl_ret_t ret = rcl_wait_set_add_guard_condition(wait_set, &gc_, NULL);
+  if (RCL_RET_OK != ret) {
+    return false;
+  }
+  // The trigger may have woken up the previous wait, before all the queue was executed.
+  if (is_ready(wait_set)) {
+    trigger_guard_condition();
+  }
+  return true;
+}
+
+bool
+SubscriptionIntraProcessGroup::is_ready(rcl_wait_set_t * wait_set)
+{
+  (void)wait_set;
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  return queue_front_ < queue_.size();
+}
+
+void
+SubscriptionIntraProcessGroup::execute()
+{
+  SubscriptionIntraProcessBase::SharedPtr subscription;
+  bool more_queued;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    while (!subscription && queue_front_ < queue_.size()) {
+      subscription = queue_[queue_front_].lock();
+      queue_[queue_front_].reset();
+      ++queue_front_;
+    }
+    more_queued = queue_front_ < queue_.size();
+    if (!more_queued) {
+      queue_.clear();
+      queue_front_ = 0;
+    } else if (queue_front_ > queue_.size() / 2) {
+      // Drop the executed entries, so that a queue never empty doesn't grow.
+      queue_.erase(queue_.begin(), queue_.begin() + static_cast<std::ptrdiff_t>(queue_front_));
+      queue_front_ = 0;
+    }
+  }
+  if (more_queued) {
+    trigger_guard_condition();
+  }
+  if (!subscription) {
+    return;
+  }
+  // Cleared first, so that the subscription is queued again if it still has messages.
+  subscription->queued_in_group_.store(false);
+  subscription->execute();
+}
+
+void
+SubscriptionIntraProcessGroup::trigger_guard_condition()
+{
+  rcl_ret_t ret = rcl_trigger_guard_condition(&gc_);
+  (void)ret;
+}
@@ -0,0 +1,149 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/thread_options.hpp"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/numa.hpp"
+
+namespace
+{
+
+bool
+has_options(const rclcpp::ThreadOptions & options)
+{
+  return !options.name.empty() || !options.cpu_set.empty() || options.numa_node >= 0 ||
+         options.scheduling_policy != rclcpp::ThreadSchedulingPolicy::Inherit;
+}
+
+#if defined(__linux__)
+void
+throw_from_errno(int error, const std::string & what)
+{
+  throw std::runtime_error(what + ": " + std::strerror(error));
+}
+
+void
+apply_to_pthread(pthread_t thread, const rclcpp::ThreadOptions & options)
+{
+  if (!options.name.empty()) {
+    // The kernel limits names to 16 bytes, including the terminating null byte.
+    std::string name = options.name.substr(0, 15);
+    int error = pthread_setname_np(thread, name.c_str());
+    if (error) {
+      throw_from_errno(error, "failed to set thread name '" + name + "'");
+    }
+  }
+
+  std::vector<size_t> cpus = options.cpu_set;
+  if (options.numa_node >= 0) {
+    auto numa_node_cpus = rclcpp::get_numa_node_cpus(static_cast<size_t>(options.numa_node));
+    if (!cpus.empty()) {
+      cpus.erase(
+        std::remove_if(
+          cpus.begin(), cpus.end(), [&numa_node_cpus](size_t cpu) {
+            return std::find(numa_node_cpus.begin(), numa_node_cpus.end(), cpu) ==
+            numa_node_cpus.end();
+          }),
+        cpus.end());
+    } else {
+      cpus = numa_node_cpus;
+    }
+    if (cpus.empty()) {
+      throw std::runtime_error(
+              "no cpu of the cpu set is on numa node " + std::to_string(options.numa_node));
+    }
+  }
+
+  if (!cpus.empty()) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (size_t cpu : cpus) {
+      if (cpu >= CPU_SETSIZE) {
+        throw std::runtime_error("cpu " + std::to_string(cpu) + " is out of range");
+      }
+      CPU_SET(cpu, &cpu_set);
+    }
+    int error = pthread_setaffinity_np(thread, sizeof(cpu_set), &cpu_set);
+    if (error) {
+      throw_from_errno(error, "failed to set thread affinity");
+    }
+  }
+
+  if (options.scheduling_policy != rclcpp::ThreadSchedulingPolicy::Inherit) {
+    int policy = SCHED_OTHER;
+    switch (options.scheduling_policy) {
+      case rclcpp::ThreadSchedulingPolicy::Fifo:
+        policy = SCHED_FIFO;
+        break;
+      case rclcpp::ThreadSchedulingPolicy::RoundRobin:
+        policy = SCHED_RR;
+        break;
+      default:
+        break;
+    }
+    sched_param param;
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = options.priority;
+    int error = pthread_setschedparam(thread, policy, &param);
+    if (error) {
+      throw_from_errno(
+        error, "failed to set thread scheduling policy with priority " +
+        std::to_string(options.priority));
+    }
+  }
+}
+#endif
+
+}  // namespace
+
+void
+rclcpp::apply_thread_options(std::thread & thread, const ThreadOptions & options)
+{
+  if (!has_options(options)) {
+    return;
+  }
+  if (!thread.joinable()) {
+    throw std::runtime_error("cannot apply thread options to a thread which is not running");
+  }
+#if defined(__linux__)
+  apply_to_pthread(thread.native_handle(), options);
+#else
+  throw std::runtime_error("thread options are not supported on this platform");
+#endif
+}
+
+void
+rclcpp::apply_thread_options_to_current_thread(const ThreadOptions & options)
+{
+  if (!has_options(options)) {
+    return;
+  }
+#if defined(__linux__)
+  apply_to_pthread(pthread_self(), options);
+#else
+  throw std::runtime_error("thread options are not supported on this platform");
+#endif
+}
@@ -23,12 +23,11 @@
 
 #include "rcl/time.h"
 
+#include "rclcpp/detail/checked_arithmetic.hpp"
 #include "rclcpp/exceptions.hpp"
 
 #include "rcutils/logging_macros.h"
 
-#include "rclcpp/utilities.hpp"
-
 namespace
 {
 
@@ -66,7 +65,6 @@ Time::Time(int64_t nanoseconds, rcl_clock_type_t clock_type)
 Time::Time(const Time & rhs)
 : rcl_time_(rhs.rcl_time_)
 {
-  rcl_time_.nanoseconds = rhs.rcl_time_.nanoseconds;
 }
 
 Time::Time(
@@ -152,43 +150,25 @@ Time::operator<(const rclcpp::Time & rhs) const
 bool
 Time::operator<=(const rclcpp::Time & rhs) const
 {
-  if (rcl_time_.clock_type != rhs.rcl_time_.clock_type) {
-    throw std::runtime_error("can't compare times with different time sources");
-  }
-
-  return rcl_time_.nanoseconds <= rhs.rcl_time_.nanoseconds;
+  return !(rhs < *this);
 }
 
 bool
 Time::operator>=(const rclcpp::Time & rhs) const
 {
-  if (rcl_time_.clock_type != rhs.rcl_time_.clock_type) {
-    throw std::runtime_error("can't compare times with different time sources");
-  }
-
-  return rcl_time_.nanoseconds >= rhs.rcl_time_.nanoseconds;
+  return !(*this < rhs);
 }
 
 bool
 Time::operator>(const rclcpp::Time & rhs) const
 {
-  if (rcl_time_.clock_type != rhs.rcl_time_.clock_type) {
-    throw std::runtime_error("can't compare times with different time sources");
-  }
-
-  return rcl_time_.nanoseconds > rhs.rcl_time_.nanoseconds;
+  return rhs < *this;
 }
 
 Time
 Time::operator+(const rclcpp::Duration & rhs) const
 {
-  if (rclcpp::add_will_overflow(rhs.nanoseconds(), this->nanoseconds())) {
-    throw std::overflow_error("addition leads to int64_t overflow");
-  }
-  if (rclcpp::add_will_underflow(rhs.nanoseconds(), this->nanoseconds())) {
-    throw std::underflow_error("addition leads to int64_t underflow");
-  }
-  return Time(this->nanoseconds() + rhs.nanoseconds(), this->get_clock_type());
+  return Time(*this) += rhs;
 }
 
 Duration
@@ -201,31 +181,42 @@ Time::operator-(const rclcpp::Time & rhs) const
             std::to_string(rhs.rcl_time_.clock_type) + "]");
   }
 
-  if (rclcpp::sub_will_overflow(rcl_time_.nanoseconds, rhs.rcl_time_.nanoseconds)) {
-    throw std::overflow_error("time subtraction leads to int64_t overflow");
-  }
-
-  if (rclcpp::sub_will_underflow(rcl_time_.nanoseconds, rhs.rcl_time_.nanoseconds)) {
-    throw std::underflow_error("time subtraction leads to int64_t underflow");
+  int64_t difference;
+  if (!detail::checked_sub(rcl_time_.nanoseconds, rhs.rcl_time_.nanoseconds, difference)) {
+    detail::throw_int64_overflow("time subtraction", rhs.rcl_time_.nanoseconds < 0);
   }
-
-  return Duration(rcl_time_.nanoseconds - rhs.rcl_time_.nanoseconds);
+  return Duration(difference);
 }
 
 Time
 Time::operator-(const rclcpp::Duration & rhs) const
 {
-  if (rclcpp::sub_will_overflow(rcl_time_.nanoseconds, rhs.nanoseconds())) {
-    throw std::overflow_error("time subtraction leads to int64_t overflow");
-  }
-  if (rclcpp::sub_will_underflow(rcl_time_.nanoseconds, rhs.nanoseconds())) {
-    throw std::underflow_error("time subtraction leads to int64_t underflow");
+  return Time(*this) -= rhs;
+}
+
+Time &
+Time::operator+=(const rclcpp::Duration & rhs)
+{
+  int64_t sum;
+  if (!detail::checked_add(rcl_time_.nanoseconds, rhs.nanoseconds(), sum)) {
+    detail::throw_int64_overflow("addition", rhs.nanoseconds() > 0);
   }
+  rcl_time_.nanoseconds = sum;
+  return *this;
+}
 
-  return Time(rcl_time_.nanoseconds - rhs.nanoseconds(), rcl_time_.clock_type);
+Time &
+Time::operator-=(const rclcpp::Duration & rhs)
+{
+  int64_t difference;
+  if (!detail::checked_sub(rcl_time_.nanoseconds, rhs.nanoseconds(), difference)) {
+    detail::throw_int64_overflow("time subtraction", rhs.nanoseconds() < 0);
+  }
+  rcl_time_.nanoseconds = difference;
+  return *this;
 }
 
-int64_t
+rcl_time_point_value_t
 Time::nanoseconds() const
 {
   return rcl_time_.nanoseconds;
@@ -246,43 +237,7 @@ Time::get_clock_type() const
 Time
 operator+(const rclcpp::Duration & lhs, const rclcpp::Time & rhs)
 {
-  if (rclcpp::add_will_overflow(rhs.nanoseconds(), lhs.nanoseconds())) {
-    throw std::overflow_error("addition leads to int64_t overflow");
-  }
-  if (rclcpp::add_will_underflow(rhs.nanoseconds(), lhs.nanoseconds())) {
-    throw std::underflow_error("addition leads to int64_t underflow");
-  }
-  return Time(lhs.nanoseconds() + rhs.nanoseconds(), rhs.get_clock_type());
-}
-
-Time &
-Time::operator+=(const rclcpp::Duration & rhs)
-{
-  if (rclcpp::add_will_overflow(rhs.nanoseconds(), this->nanoseconds())) {
-    throw std::overflow_error("addition leads to int64_t overflow");
-  }
-  if (rclcpp::add_will_underflow(rhs.nanoseconds(), this->nanoseconds())) {
-    throw std::underflow_error("addition leads to int64_t underflow");
-  }
-
-  rcl_time_.nanoseconds += rhs.nanoseconds();
-
-  return *this;
-}
-
-Time &
-Time::operator-=(const rclcpp::Duration & rhs)
-{
-  if (rclcpp::sub_will_overflow(rcl_time_.nanoseconds, rhs.nanoseconds())) {
-    throw std::overflow_error("time subtraction leads to int64_t overflow");
-  }
-  if (rclcpp::sub_will_underflow(rcl_time_.nanoseconds, rhs.nanoseconds())) {
-    throw std::underflow_error("time subtraction leads to int64_t underflow");
-  }
-
-  rcl_time_.nanoseconds -= rhs.nanoseconds();
-
-  return *this;
+  return rhs + lhs;
 }
 
 Time
@@ -291,5 +246,4 @@ Time::max()
   return Time(std::numeric_limits<int32_t>::max(), 999999999);
 }
 
-
 }  // namespace rclcpp
@@ -25,8 +25,6 @@
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/logging.hpp"
 #include "rclcpp/node.hpp"
-#include "rclcpp/parameter_client.hpp"
-#include "rclcpp/parameter_events_filter.hpp"
 #include "rclcpp/time.hpp"
 #include "rclcpp/time_source.hpp"
 
@@ -35,7 +33,7 @@ namespace rclcpp
 
 TimeSource::TimeSource(std::shared_ptr<rclcpp::Node> node)
 : logger_(rclcpp::get_logger("rclcpp")),
-  clock_subscription_(nullptr),
+  clock_subscriber_(false),
   ros_time_active_(false)
 {
   this->attachNode(node);
@@ -43,6 +41,7 @@ TimeSource::TimeSource(std::shared_ptr<rclcpp::Node> node)
 
 TimeSource::TimeSource()
 : logger_(rclcpp::get_logger("rclcpp")),
+  clock_subscriber_(false),
   ros_time_active_(false)
 {
 }
@@ -78,6 +77,7 @@ void TimeSource::attachNode(
   // TODO(tfoote): Update QOS
 
   logger_ = node_logging_->get_logger();
+  sim_time_source_ = rclcpp::SimTimeSource::get_instance(node_base_->get_context());
 
   // Though this defaults to false, it can be overridden by initial parameter values for the node,
   // which may be given by the user at the node's construction or even by command-line arguments.
@@ -119,17 +119,35 @@ void TimeSource::attachNode(
       return result;
     });
 
-  // TODO(tfoote) use parameters interface not subscribe to events via topic ticketed #609
-  parameter_subscription_ = rclcpp::AsyncParametersClient::on_parameter_event(
-    node_topics_,
-    std::bind(&TimeSource::on_parameter_event, this, std::placeholders::_1));
+  // The changes are observed in the node itself, rather than through a subscription to the
+  // parameter events which would receive the events of all the nodes of the system.
+  // The set-parameters callback above guarantees the type, the observer is kept if the
+  // parameter is undeclared and follows it again when it is redeclared.
+  use_sim_time_observer_ = node_parameters_->add_parameter_value_observer(
+    use_sim_time_name,
+    [this](const rclcpp::ParameterValue & value) {
+      if (value.get_type() == rclcpp::PARAMETER_BOOL) {
+        on_use_sim_time(value.get<bool>());
+      } else if (value.get_type() == rclcpp::PARAMETER_NOT_SET) {
+        // If the parameter is undeclared mark it as unset but don't change state.
+        parameter_state_ = UNSET;
+      }
+    });
 }
 
 void TimeSource::detachNode()
 {
+  if (ros_time_active_) {
+    // The clocks keep the last simulated time, but stop following it.
+    std::lock_guard<std::mutex> guard(clock_list_lock_);
+    for (auto & clock : associated_clocks_) {
+      sim_time_source_->detach_clock(clock);
+    }
+  }
   this->ros_time_active_ = false;
-  clock_subscription_.reset();
-  parameter_subscription_.reset();
+  destroy_clock_sub();
+  sim_time_source_.reset();
+  use_sim_time_observer_.reset();
   node_base_.reset();
   node_topics_.reset();
   node_graph_.reset();
@@ -152,12 +170,12 @@ void TimeSource::attachClock(std::shared_ptr<rclcpp::Clock> clock)
 
   std::lock_guard<std::mutex> guard(clock_list_lock_);
   associated_clocks_.push_back(clock);
-  // Set the clock to zero unless there's a recently received message
-  auto time_msg = std::make_shared<builtin_interfaces::msg::Time>();
-  if (last_msg_set_) {
-    time_msg = std::make_shared<builtin_interfaces::msg::Time>(last_msg_set_->clock);
+  if (ros_time_active_) {
+    // Follow the simulated time, from the last message received in the context
+    sim_time_source_->attach_clock(clock);
+  } else {
+    set_clock(std::make_shared<builtin_interfaces::msg::Time>(), false, clock);
   }
-  set_clock(time_msg, ros_time_active_, clock);
 }
 
 void TimeSource::detachClock(std::shared_ptr<rclcpp::Clock> clock)
@@ -165,6 +183,9 @@ void TimeSource::detachClock(std::shared_ptr<rclcpp::Clock> clock)
   std::lock_guard<std::mutex> guard(clock_list_lock_);
   auto result = std::find(associated_clocks_.begin(), associated_clocks_.end(), clock);
   if (result != associated_clocks_.end()) {
+    if (ros_time_active_) {
+      sim_time_source_->detach_clock(clock);
+    }
     associated_clocks_.erase(result);
   } else {
     RCLCPP_ERROR(logger_, "failed to remove clock");
@@ -199,77 +220,38 @@ void TimeSource::set_clock(
   }
 }
 
-void TimeSource::clock_cb(const rosgraph_msgs::msg::Clock::SharedPtr msg)
-{
-  if (!this->ros_time_active_ && SET_TRUE == this->parameter_state_) {
-    enable_ros_time();
-  }
-  // Cache the last message in case a new clock is attached.
-  last_msg_set_ = msg;
-  auto time_msg = std::make_shared<builtin_interfaces::msg::Time>(msg->clock);
-
-  if (SET_TRUE == this->parameter_state_) {
-    std::lock_guard<std::mutex> guard(clock_list_lock_);
-    for (auto it = associated_clocks_.begin(); it != associated_clocks_.end(); ++it) {
-      set_clock(time_msg, true, *it);
-    }
-  }
-}
-
 void TimeSource::create_clock_sub()
 {
   std::lock_guard<std::mutex> guard(clock_sub_lock_);
-  if (clock_subscription_) {
-    // Subscription already created.
+  if (clock_subscriber_) {
+    // Already offered.
     return;
   }
-
-  clock_subscription_ = rclcpp::create_subscription<rosgraph_msgs::msg::Clock>(
-    node_topics_,
-    "/clock",
-    rclcpp::QoS(QoSInitialization::from_rmw(rmw_qos_profile_default)),
-    std::bind(&TimeSource::clock_cb, this, std::placeholders::_1)
-  );
+  // The subscription is only created if no other node of the context hosts it.
+  sim_time_source_->add_subscriber(this, node_topics_);
+  clock_subscriber_ = true;
 }
 
 void TimeSource::destroy_clock_sub()
 {
   std::lock_guard<std::mutex> guard(clock_sub_lock_);
-  clock_subscription_.reset();
+  if (!clock_subscriber_) {
+    return;
+  }
+  sim_time_source_->remove_subscriber(this);
+  clock_subscriber_ = false;
 }
 
-void TimeSource::on_parameter_event(const rcl_interfaces::msg::ParameterEvent::SharedPtr event)
+void TimeSource::on_use_sim_time(bool use_sim_time)
 {
-  // Filter out events on 'use_sim_time' parameter instances in other nodes.
-  if (event->node != node_base_->get_fully_qualified_name()) {
-    return;
-  }
-  // Filter for only 'use_sim_time' being added or changed.
-  rclcpp::ParameterEventsFilter filter(event, {"use_sim_time"},
-    {rclcpp::ParameterEventsFilter::EventType::NEW,
-      rclcpp::ParameterEventsFilter::EventType::CHANGED});
-  for (auto & it : filter.get_events()) {
-    if (it.second->value.type != ParameterType::PARAMETER_BOOL) {
-      RCLCPP_ERROR(logger_, "use_sim_time parameter cannot be set to anything but a bool");
-      continue;
-    }
-    if (it.second->value.bool_value) {
-      parameter_state_ = SET_TRUE;
-      enable_ros_time();
-      create_clock_sub();
-    } else {
-      parameter_state_ = SET_FALSE;
-      disable_ros_time();
-      destroy_clock_sub();
-    }
-  }
-  // Handle the case that use_sim_time was deleted.
-  rclcpp::ParameterEventsFilter deleted(event, {"use_sim_time"},
-    {rclcpp::ParameterEventsFilter::EventType::DELETED});
-  for (auto & it : deleted.get_events()) {
-    (void) it;  // if there is a match it's already matched, don't bother reading it.
-    // If the parameter is deleted mark it as unset but dont' change state.
-    parameter_state_ = UNSET;
+  if (use_sim_time) {
+    parameter_state_ = SET_TRUE;
+    enable_ros_time();
+    create_clock_sub();
+  } else {
+    parameter_state_ = SET_FALSE;
+    disable_ros_time();
+    destroy_clock_sub();
   }
 }
 
@@ -301,14 +283,10 @@ void TimeSource::enable_ros_time()
   // Local storage
   ros_time_active_ = true;
 
-  // Update all attached clocks to zero or last recorded time
+  // Make all attached clocks follow the simulated time, zero until a message is received
   std::lock_guard<std::mutex> guard(clock_list_lock_);
-  auto time_msg = std::make_shared<builtin_interfaces::msg::Time>();
-  if (last_msg_set_) {
-    time_msg = std::make_shared<builtin_interfaces::msg::Time>(last_msg_set_->clock);
-  }
   for (auto it = associated_clocks_.begin(); it != associated_clocks_.end(); ++it) {
-    set_clock(time_msg, true, *it);
+    sim_time_source_->attach_clock(*it);
   }
 }
 
@@ -325,6 +303,7 @@ void TimeSource::disable_ros_time()
   // Update all attached clocks
   std::lock_guard<std::mutex> guard(clock_list_lock_);
   for (auto it = associated_clocks_.begin(); it != associated_clocks_.end(); ++it) {
+    sim_time_source_->detach_clock(*it);
     auto msg = std::make_shared<builtin_interfaces::msg::Time>();
     set_clock(msg, false, *it);
   }
@@ -14,7 +14,10 @@
 
 #include "rclcpp/timer.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <stdexcept>
 #include <string>
 #include <memory>
 #include <thread>
@@ -114,6 +117,12 @@ TimerBase::is_ready()
   return ready;
 }
 
+bool
+TimerBase::exchange_in_use_by_executor_state(bool in_use_state)
+{
+  return in_use_by_executor_.exchange(in_use_state);
+}
+
 std::chrono::nanoseconds
 TimerBase::time_until_trigger()
 {
@@ -130,8 +139,135 @@ TimerBase::time_until_trigger()
   return std::chrono::nanoseconds(time_until_next_call);
 }
 
+rclcpp::Clock::SharedPtr
+TimerBase::get_clock() const
+{
+  return clock_;
+}
+
 std::shared_ptr<const rcl_timer_t>
 TimerBase::get_timer_handle()
 {
   return timer_handle_;
 }
+
+rclcpp::TimerStatistics
+TimerBase::get_statistics() const
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  rclcpp::TimerStatistics statistics;
+  statistics.count = latency_count_;
+  if (latency_count_ > 0) {
+    statistics.min_latency = std::chrono::nanoseconds(min_latency_ns_);
+    statistics.max_latency = std::chrono::nanoseconds(max_latency_ns_);
+    statistics.mean_latency =
+      std::chrono::nanoseconds(static_cast<int64_t>(std::llround(latency_mean_ns_)));
+    statistics.jitter = std::chrono::nanoseconds(
+      static_cast<int64_t>(std::llround(std::sqrt(latency_m2_ / latency_count_))));
+  }
+  statistics.overrun_count = overrun_count_;
+  statistics.missed_count = missed_count_;
+  return statistics;
+}
+
+void
+TimerBase::reset_statistics()
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  latency_count_ = 0;
+  min_latency_ns_ = 0;
+  max_latency_ns_ = 0;
+  latency_mean_ns_ = 0.0;
+  latency_m2_ = 0.0;
+  overrun_count_ = 0;
+  missed_count_ = 0;
+}
+
+void
+TimerBase::set_overrun_policy(TimerOverrunPolicy policy, size_t max_catch_up)
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  overrun_policy_ = policy;
+  max_catch_up_ = max_catch_up;
+}
+
+rclcpp::TimerOverrunPolicy
+TimerBase::get_overrun_policy() const
+{
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  return overrun_policy_;
+}
+
+void
+TimerBase::set_slack(std::chrono::nanoseconds slack)
+{
+  if (slack < std::chrono::nanoseconds::zero()) {
+    throw std::invalid_argument("timer slack must not be negative");
+  }
+  slack_ns_.store(slack.count());
+}
+
+std::chrono::nanoseconds
+TimerBase::get_slack() const
+{
+  return std::chrono::nanoseconds(slack_ns_.load());
+}
+
+size_t
+TimerBase::record_callback_latency()
+{
+  int64_t time_until_next_call = 0;
+  rcl_ret_t ret =
+    rcl_timer_get_time_until_next_call(timer_handle_.get(), &time_until_next_call);
+  if (ret != RCL_RET_OK) {
+    // Canceled, the callback is not called, or the error is reported by rcl_timer_call().
+    rcl_reset_error();
+    return 1;
+  }
+  if (time_until_next_call > 0) {
+    // Called before its deadline, e.g. directly by the user.
+    return 1;
+  }
+  int64_t latency = -time_until_next_call;
+  int64_t period = 0;
+  if (rcl_timer_get_period(timer_handle_.get(), &period) != RCL_RET_OK) {
+    rcl_reset_error();
+  }
+  // rcl_timer_call() moves the next deadline after the current time, skipping these periods.
+  uint64_t missed = period > 0 ? static_cast<uint64_t>(latency / period) : 0;
+
+  std::lock_guard<std::mutex> lock(statistics_mutex_);
+  size_t call_count = 1;
+  if (missed > 0) {
+    ++overrun_count_;
+    switch (overrun_policy_) {
+      case TimerOverrunPolicy::FireOnce:
+        missed_count_ += missed;
+        break;
+      case TimerOverrunPolicy::SkipMissed:
+        // The deadline the timer is executed for is missed too.
+        missed_count_ += missed + 1;
+        call_count = 0;
+        break;
+      case TimerOverrunPolicy::CatchUp:
+        {
+          uint64_t catch_up = std::min<uint64_t>(missed, max_catch_up_);
+          missed_count_ += missed - catch_up;
+          call_count += static_cast<size_t>(catch_up);
+        }
+        break;
+    }
+  }
+  if (latency_count_ == 0) {
+    min_latency_ns_ = latency;
+    max_latency_ns_ = latency;
+  } else {
+    min_latency_ns_ = std::min(min_latency_ns_, latency);
+    max_latency_ns_ = std::max(max_latency_ns_, latency);
+  }
+  ++latency_count_;
+  double delta = static_cast<double>(latency) - latency_mean_ns_;
+  latency_mean_ns_ += delta / static_cast<double>(latency_count_);
+  latency_m2_ += delta * (static_cast<double>(latency) - latency_mean_ns_);
+  return call_count;
+}
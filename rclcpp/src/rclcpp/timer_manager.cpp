@@ -0,0 +1,319 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/timer_manager.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "rcl/timer.h"
+
+#include "rclcpp/exceptions.hpp"
+
+using rclcpp::executor::TimerManager;
+
+namespace
+{
+
+/// Get the deadline of a timer from its time until the next call.
+/**
+ * \return false if the timer is canceled.
+ */
+bool
+get_deadline(
+  rclcpp::TimerBase & timer,
+  std::chrono::steady_clock::time_point now,
+  std::chrono::steady_clock::time_point & deadline)
+{
+  int64_t time_until_next_call = 0;
+  rcl_ret_t ret =
+    rcl_timer_get_time_until_next_call(timer.get_timer_handle().get(), &time_until_next_call);
+  if (RCL_RET_TIMER_CANCELED == ret) {
+    rcl_reset_error();
+    return false;
+  }
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "Timer could not get time until next call");
+  }
+  deadline = now + std::chrono::nanoseconds(time_until_next_call);
+  return true;
+}
+
+std::chrono::nanoseconds
+get_period(rclcpp::TimerBase & timer)
+{
+  int64_t period = 0;
+  rcl_ret_t ret = rcl_timer_get_period(timer.get_timer_handle().get(), &period);
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "Timer could not get its period");
+  }
+  return std::chrono::nanoseconds(period);
+}
+
+}  // namespace
+
+TimerManager::TimerManager()
+: collection_(0),
+  last_version_(0),
+  notification_count_(0)
+{}
+
+void
+TimerManager::start_collection()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Forget the timers which were not found by the previous collection, their heap items are
+  // dropped once they reach the top, like the ones of the timers not found by this collection.
+  for (auto it = entries_.begin(); it != entries_.end(); ) {
+    if (it->second.collection != collection_ || it->second.timer.expired()) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  ++collection_;
+}
+
+bool
+TimerManager::manage(const rclcpp::TimerBase::SharedPtr & timer, bool can_execute)
+{
+  if (!timer->is_steady()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto inserted = entries_.emplace(timer.get(), Entry {timer, collection_, 0, false});
+  Entry & entry = inserted.first->second;
+  if (!inserted.second && entry.timer.lock() != timer) {
+    // Another timer was destroyed, and this one was allocated at the same address.
+    entry = Entry {timer, collection_, 0, false};
+  }
+  entry.collection = collection_;
+  if (!can_execute) {
+    entry.scheduled = false;
+  } else if (!entry.scheduled) {
+    std::chrono::steady_clock::time_point deadline;
+    if (get_deadline(*timer, std::chrono::steady_clock::now(), deadline)) {
+      push(entry, *timer, deadline);
+    }
+  }
+  return true;
+}
+
+std::chrono::nanoseconds
+TimerManager::get_time_until_next_deadline()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!prune_top()) {
+    return std::chrono::nanoseconds(-1);
+  }
+  auto now = std::chrono::steady_clock::now();
+  if (heap_.front().deadline <= now) {
+    return std::chrono::nanoseconds::zero();
+  }
+  auto time_until_wake_up = get_wake_up_time() - now;
+  return std::max(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(time_until_wake_up),
+    std::chrono::nanoseconds::zero());
+}
+
+rclcpp::TimerBase::SharedPtr
+TimerManager::get_next_ready_timer(
+  const std::function<bool(const rclcpp::TimerBase::SharedPtr &)> & can_take,
+  std::chrono::steady_clock::time_point * next_deadline)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto now = std::chrono::steady_clock::now();
+  std::vector<HeapItem> skipped;
+  rclcpp::TimerBase::SharedPtr taken;
+  while (Entry * entry = prune_top()) {
+    HeapItem item = heap_.front();
+    if (item.deadline > now) {
+      break;
+    }
+    std::pop_heap(heap_.begin(), heap_.end(), LaterDeadline());
+    heap_.pop_back();
+
+    auto timer = entry->timer.lock();
+    if (!timer) {
+      entries_.erase(item.key);
+      continue;
+    }
+    std::chrono::steady_clock::time_point deadline;
+    if (!get_deadline(*timer, now, deadline)) {
+      // Canceled, it is pushed again by the first collection after it was reset.
+      entry->scheduled = false;
+      continue;
+    }
+    if (deadline > now) {
+      // Reset since it was pushed.
+      push(*entry, *timer, deadline);
+      continue;
+    }
+    if (!can_take(timer)) {
+      skipped.push_back(item);
+      continue;
+    }
+    // In case the callback is not executed, the timer gets ready again a period later.
+    push(*entry, *timer, now + get_period(*timer));
+    taken = std::move(timer);
+    break;
+  }
+  if (next_deadline) {
+    *next_deadline =
+      prune_top() ? get_wake_up_time() : std::chrono::steady_clock::time_point::max();
+  }
+  for (const auto & item : skipped) {
+    heap_.push_back(item);
+    std::push_heap(heap_.begin(), heap_.end(), LaterDeadline());
+  }
+  return taken;
+}
+
+void
+TimerManager::reschedule(const rclcpp::TimerBase::SharedPtr & timer)
+{
+  if (!timer->is_steady()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(timer.get());
+  if (it == entries_.end() || !it->second.scheduled || it->second.timer.lock() != timer) {
+    return;
+  }
+  std::chrono::steady_clock::time_point deadline;
+  if (get_deadline(*timer, std::chrono::steady_clock::now(), deadline)) {
+    push(it->second, *timer, deadline);
+  } else {
+    it->second.scheduled = false;
+  }
+}
+
+size_t
+TimerManager::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+void
+TimerManager::notify()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  notification_count_.fetch_add(1);
+  notification_cv_.notify_all();
+}
+
+uint64_t
+TimerManager::get_notification_count() const
+{
+  return notification_count_.load();
+}
+
+bool
+TimerManager::wait_until(
+  std::chrono::steady_clock::time_point deadline,
+  std::chrono::nanoseconds spin_threshold,
+  uint64_t notification_count)
+{
+  auto notified = [this, notification_count]() {
+      return notification_count_.load() != notification_count;
+    };
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (deadline == std::chrono::steady_clock::time_point::max()) {
+      notification_cv_.wait(lock, notified);
+      return false;
+    }
+    if (notification_cv_.wait_until(lock, deadline - spin_threshold, notified)) {
+      return false;
+    }
+  }
+  // The sleep may end late by the granularity of the OS, so the last part of the wait spins.
+  while (std::chrono::steady_clock::now() < deadline) {
+    if (notified()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void
+TimerManager::push(
+  Entry & entry, rclcpp::TimerBase & timer, std::chrono::steady_clock::time_point deadline)
+{
+  entry.version = ++last_version_;
+  entry.scheduled = true;
+  auto slack = timer.get_slack();
+  heap_.push_back(HeapItem {deadline, slack, &timer, entry.version});
+  std::push_heap(heap_.begin(), heap_.end(), LaterDeadline());
+  const HeapItem & top = heap_.front();
+  if (top.version == entry.version || deadline + slack < top.deadline + top.slack) {
+    // The wake-up may be earlier, the waiting threads have to wait for this one instead.
+    notification_count_.fetch_add(1);
+    notification_cv_.notify_all();
+  }
+}
+
+bool
+TimerManager::is_current(const HeapItem & item) const
+{
+  auto it = entries_.find(item.key);
+  return it != entries_.end() && it->second.scheduled && it->second.version == item.version &&
+         it->second.collection == collection_;
+}
+
+std::chrono::steady_clock::time_point
+TimerManager::get_wake_up_time()
+{
+  auto wake_up = heap_.front().deadline + heap_.front().slack;
+  // The heap is ordered by deadline, so only the items with a deadline before the wake-up found
+  // so far can make it earlier, and the subtrees of the others are skipped.
+  wake_up_stack_.clear();
+  wake_up_stack_.push_back(1);
+  wake_up_stack_.push_back(2);
+  while (!wake_up_stack_.empty()) {
+    size_t index = wake_up_stack_.back();
+    wake_up_stack_.pop_back();
+    if (index >= heap_.size() || heap_[index].deadline >= wake_up) {
+      continue;
+    }
+    const HeapItem & item = heap_[index];
+    if (item.deadline + item.slack < wake_up && is_current(item)) {
+      wake_up = item.deadline + item.slack;
+    }
+    wake_up_stack_.push_back(2 * index + 1);
+    wake_up_stack_.push_back(2 * index + 2);
+  }
+  return wake_up;
+}
+
+TimerManager::Entry *
+TimerManager::prune_top()
+{
+  while (!heap_.empty()) {
+    const HeapItem & top = heap_.front();
+    auto it = entries_.find(top.key);
+    if (it != entries_.end() && it->second.scheduled && it->second.version == top.version) {
+      if (it->second.collection == collection_) {
+        return &it->second;
+      }
+      // Not found yet by a collection running in another thread, which pushes it again.
+      it->second.scheduled = false;
+    }
+    std::pop_heap(heap_.begin(), heap_.end(), LaterDeadline());
+    heap_.pop_back();
+  }
+  return nullptr;
+}
@@ -0,0 +1,227 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp/topic_statistics.hpp"
+
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include "rcl_interfaces/msg/parameter_event.hpp"
+
+#include "rclcpp/node_interfaces/node_base_interface.hpp"
+#include "rclcpp/parameter.hpp"
+#include "rclcpp/publisher.hpp"
+#include "rclcpp/qos.hpp"
+
+using rclcpp::TopicStatisticsCollector;
+using rclcpp::TopicStatisticsWindow;
+
+using StatisticsPublisher = rclcpp::Publisher<rcl_interfaces::msg::ParameterEvent>;
+
+namespace
+{
+
+int64_t
+steady_now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template<typename T>
+void
+update_min(std::atomic<T> & minimum, T value)
+{
+  T current = minimum.load(std::memory_order_relaxed);
+  while (value < current &&
+    !minimum.compare_exchange_weak(current, value, std::memory_order_relaxed))
+  {
+  }
+}
+
+template<typename T>
+void
+update_max(std::atomic<T> & maximum, T value)
+{
+  T current = maximum.load(std::memory_order_relaxed);
+  while (value > current &&
+    !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed))
+  {
+  }
+}
+
+}  // namespace
+
+TopicStatisticsCollector::TopicStatisticsCollector(
+  rclcpp::node_interfaces::NodeBaseInterface * node_base,
+  const std::string & topic_name,
+  const TopicStatisticsOptions & options)
+: topic_name_(topic_name),
+  publish_period_ns_(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      options.publish_period).count()),
+  message_count_(0),
+  age_count_(0),
+  age_sum_(0),
+  age_min_(std::numeric_limits<int64_t>::max()),
+  age_max_(0),
+  size_count_(0),
+  size_sum_(0),
+  size_min_(std::numeric_limits<uint64_t>::max()),
+  size_max_(0),
+  window_start_ns_(steady_now_ns()),
+  node_name_(node_base->get_fully_qualified_name())
+{
+  if (publish_period_ns_ <= 0) {
+    throw std::invalid_argument("topic statistics publish period must be positive");
+  }
+  if (!options.publish_topic.empty()) {
+    rclcpp::PublisherOptionsWithAllocator<std::allocator<void>> publisher_options;
+    rclcpp::QoS qos(10);
+    auto publisher = std::make_shared<StatisticsPublisher>(
+      node_base, options.publish_topic, qos, publisher_options);
+    publisher->post_init_setup(node_base, options.publish_topic, qos, publisher_options);
+    publisher_ = publisher;
+  }
+}
+
+TopicStatisticsCollector::~TopicStatisticsCollector()
+{}
+
+void
+TopicStatisticsCollector::record(std::chrono::nanoseconds age, uint64_t size)
+{
+  message_count_.fetch_add(1, std::memory_order_relaxed);
+  if (age.count() >= 0) {
+    age_count_.fetch_add(1, std::memory_order_relaxed);
+    age_sum_.fetch_add(age.count(), std::memory_order_relaxed);
+    update_min(age_min_, static_cast<int64_t>(age.count()));
+    update_max(age_max_, static_cast<int64_t>(age.count()));
+  }
+  if (size > 0) {
+    size_count_.fetch_add(1, std::memory_order_relaxed);
+    size_sum_.fetch_add(size, std::memory_order_relaxed);
+    update_min(size_min_, size);
+    update_max(size_max_, size);
+  }
+
+  int64_t window_start = window_start_ns_.load(std::memory_order_relaxed);
+  if (steady_now_ns() - window_start >= publish_period_ns_) {
+    close_window();
+  }
+}
+
+TopicStatisticsWindow
+TopicStatisticsCollector::get_current_window() const
+{
+  return read_window(steady_now_ns());
+}
+
+TopicStatisticsWindow
+TopicStatisticsCollector::get_last_window() const
+{
+  std::lock_guard<std::mutex> lock(last_window_mutex_);
+  return last_window_;
+}
+
+TopicStatisticsWindow
+TopicStatisticsCollector::close_window()
+{
+  std::unique_lock<std::mutex> lock(last_window_mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    // Another thread is closing the window.
+    return get_current_window();
+  }
+  int64_t now = steady_now_ns();
+  TopicStatisticsWindow window = read_window(now);
+  message_count_.store(0, std::memory_order_relaxed);
+  age_count_.store(0, std::memory_order_relaxed);
+  age_sum_.store(0, std::memory_order_relaxed);
+  age_min_.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+  age_max_.store(0, std::memory_order_relaxed);
+  size_count_.store(0, std::memory_order_relaxed);
+  size_sum_.store(0, std::memory_order_relaxed);
+  size_min_.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+  size_max_.store(0, std::memory_order_relaxed);
+  window_start_ns_.store(now, std::memory_order_relaxed);
+  last_window_ = window;
+  lock.unlock();
+
+  publish(window);
+  return window;
+}
+
+TopicStatisticsWindow
+TopicStatisticsCollector::read_window(int64_t now_ns) const
+{
+  TopicStatisticsWindow window;
+  window.window_duration =
+    std::chrono::nanoseconds(now_ns - window_start_ns_.load(std::memory_order_relaxed));
+  window.message_count = message_count_.load(std::memory_order_relaxed);
+  if (window.window_duration.count() > 0) {
+    window.message_rate = static_cast<double>(window.message_count) * 1e9 /
+      static_cast<double>(window.window_duration.count());
+  }
+  window.age_count = age_count_.load(std::memory_order_relaxed);
+  if (window.age_count > 0) {
+    window.age_min = std::chrono::nanoseconds(age_min_.load(std::memory_order_relaxed));
+    window.age_max = std::chrono::nanoseconds(age_max_.load(std::memory_order_relaxed));
+    window.age_mean = std::chrono::nanoseconds(
+      age_sum_.load(std::memory_order_relaxed) / static_cast<int64_t>(window.age_count));
+  }
+  window.size_count = size_count_.load(std::memory_order_relaxed);
+  if (window.size_count > 0) {
+    window.size_min = size_min_.load(std::memory_order_relaxed);
+    window.size_max = size_max_.load(std::memory_order_relaxed);
+    window.size_mean = size_sum_.load(std::memory_order_relaxed) / window.size_count;
+  }
+  return window;
+}
+
+void
+TopicStatisticsCollector::publish(const TopicStatisticsWindow & window)
+{
+  if (!publisher_) {
+    return;
+  }
+  rcl_interfaces::msg::ParameterEvent msg;
+  auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+  msg.stamp.sec = static_cast<int32_t>(now / 1000000000);
+  msg.stamp.nanosec = static_cast<uint32_t>(now % 1000000000);
+  msg.node = node_name_;
+
+  auto add = [this, &msg](const char * name, const rclcpp::ParameterValue & value) {
+      msg.new_parameters.push_back(
+        rclcpp::Parameter(topic_name_ + "/" + name, value).to_parameter_msg());
+    };
+  auto add_integer = [&add](const char * name, int64_t value) {
+      add(name, rclcpp::ParameterValue(value));
+    };
+  add_integer("window_duration_ns", window.window_duration.count());
+  add_integer("message_count", static_cast<int64_t>(window.message_count));
+  add("message_rate", rclcpp::ParameterValue(window.message_rate));
+  add_integer("message_age_count", static_cast<int64_t>(window.age_count));
+  add_integer("message_age_min_ns", window.age_min.count());
+  add_integer("message_age_max_ns", window.age_max.count());
+  add_integer("message_age_mean_ns", window.age_mean.count());
+  add_integer("message_size_count", static_cast<int64_t>(window.size_count));
+  add_integer("message_size_min", static_cast<int64_t>(window.size_min));
+  add_integer("message_size_max", static_cast<int64_t>(window.size_max));
+  add_integer("message_size_mean", static_cast<int64_t>(window.size_mean));
+
+  std::static_pointer_cast<StatisticsPublisher>(publisher_)->publish(msg);
+}
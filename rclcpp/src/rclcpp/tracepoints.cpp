@@ -0,0 +1,47 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/tracepoints.hpp"
+
+namespace rclcpp
+{
+namespace tracing
+{
+
+namespace detail
+{
+
+std::atomic<TracepointHandler> tracepoint_handler{nullptr};
+
+}  // namespace detail
+
+void
+set_tracepoint_handler(TracepointHandler handler)
+{
+  detail::tracepoint_handler.store(handler);
+}
+
+bool
+tracepoints_enabled()
+{
+#ifdef RCLCPP_TRACEPOINTS_ENABLED
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace tracing
+}  // namespace rclcpp
@@ -0,0 +1,99 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "rclcpp/typesupport_helpers.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+namespace rclcpp
+{
+
+std::tuple<std::string, std::string, std::string>
+extract_type_identifier(const std::string & full_type)
+{
+  const char separator = '/';
+  auto first_separator = full_type.find(separator);
+  auto last_separator = full_type.rfind(separator);
+  if (
+    first_separator == std::string::npos ||
+    first_separator == 0 ||
+    last_separator == full_type.size() - 1 ||
+    full_type.find(separator, first_separator + 1) != last_separator)
+  {
+    throw std::invalid_argument(
+            "message type '" + full_type + "' is not of the form 'package/msg/Type'");
+  }
+
+  std::string package_name = full_type.substr(0, first_separator);
+  std::string type_name = full_type.substr(last_separator + 1);
+  std::string middle_module = "msg";
+  if (last_separator != first_separator) {
+    middle_module = full_type.substr(first_separator + 1, last_separator - first_separator - 1);
+    if (middle_module.empty()) {
+      throw std::invalid_argument(
+              "message type '" + full_type + "' is not of the form 'package/msg/Type'");
+    }
+  }
+  return std::make_tuple(package_name, middle_module, type_name);
+}
+
+std::shared_ptr<rcpputils::SharedLibrary>
+get_typesupport_library(const std::string & type, const std::string & typesupport_identifier)
+{
+  std::string package_name = std::get<0>(extract_type_identifier(type));
+  std::string library_name =
+    rcpputils::get_platform_library_name(package_name + "__" + typesupport_identifier);
+  try {
+    return std::make_shared<rcpputils::SharedLibrary>(library_name);
+  } catch (const std::exception & e) {
+    throw std::runtime_error(
+            "failed to load the type support library '" + library_name + "' of message type '" +
+            type + "': " + e.what());
+  }
+}
+
+const rosidl_message_type_support_t *
+get_typesupport_handle(
+  const std::string & type,
+  const std::string & typesupport_identifier,
+  rcpputils::SharedLibrary & library)
+{
+  std::string package_name;
+  std::string middle_module;
+  std::string type_name;
+  std::tie(package_name, middle_module, type_name) = extract_type_identifier(type);
+
+  std::string symbol_name = typesupport_identifier + "__get_message_type_support_handle__" +
+    package_name + "__" + middle_module + "__" + type_name;
+  if (!library.has_symbol(symbol_name)) {
+    throw std::runtime_error(
+            "type support library '" + library.get_library_path() +
+            "' has no type support for message type '" + type + "'");
+  }
+
+  using GetTypeSupportHandleFunction = const rosidl_message_type_support_t * (*)();
+  auto get_type_support_handle =
+    reinterpret_cast<GetTypeSupportHandleFunction>(library.get_symbol(symbol_name));
+  const rosidl_message_type_support_t * type_support = get_type_support_handle();
+  if (!type_support) {
+    throw std::runtime_error("no type support returned for message type '" + type + "'");
+  }
+  return type_support;
+}
+
+}  // namespace rclcpp
@@ -14,7 +14,11 @@
 
 #include "rclcpp/utilities.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "./signal_handler.hpp"
@@ -173,6 +177,35 @@ sleep_for(const std::chrono::nanoseconds & nanoseconds, Context::SharedPtr conte
   return context->sleep_for(nanoseconds);
 }
 
+void
+destroy_in_parallel(std::vector<std::shared_ptr<void>> & objects, size_t number_of_threads)
+{
+  if (0u == number_of_threads) {
+    number_of_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  number_of_threads = std::min(number_of_threads, objects.size());
+  if (number_of_threads <= 1u) {
+    objects.clear();
+    return;
+  }
+  std::atomic<size_t> next_index{0};
+  auto release = [&objects, &next_index]() {
+      for (size_t i = next_index++; i < objects.size(); i = next_index++) {
+        objects[i].reset();
+      }
+    };
+  std::vector<std::thread> threads;
+  threads.reserve(number_of_threads - 1);
+  for (size_t i = 1; i < number_of_threads; ++i) {
+    threads.emplace_back(release);
+  }
+  release();
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  objects.clear();
+}
+
 const char *
 get_c_string(const char * string_in)
 {
@@ -0,0 +1,67 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "allocation_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<bool> count_allocations(false);
+static std::atomic<size_t> allocation_count(0);
+
+void *
+operator new(size_t size)
+{
+  if (count_allocations.load()) {
+    allocation_count++;
+  }
+  void * pointer = std::malloc(size ? size : 1);
+  if (!pointer) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void
+operator delete(void * pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void
+operator delete(void * pointer, size_t size) noexcept
+{
+  (void)size;
+  std::free(pointer);
+}
+
+namespace allocation_counter
+{
+
+void
+start()
+{
+  allocation_count = 0;
+  count_allocations = true;
+}
+
+size_t
+stop()
+{
+  count_allocations = false;
+  return allocation_count.load();
+}
+
+}  // namespace allocation_counter
@@ -0,0 +1,40 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ALLOCATION_COUNTER_HPP_
+#define ALLOCATION_COUNTER_HPP_
+
+#include <cstddef>
+
+/// Count the calls of the global operator new, replaced in allocation_counter.cpp.
+/**
+ * The allocations of rclcpp all go through operator new, the containers and std::make_shared
+ * with std::allocator as well as the rcl allocators made from a std::allocator.
+ * malloc isn't counted: it is what rcl and the middleware use with their default allocators,
+ * so a budget of malloc calls would measure the rmw implementation rather than rclcpp.
+ */
+namespace allocation_counter
+{
+
+/// Reset the count and start counting.
+void
+start();
+
+/// Stop counting, and return the number of allocations counted since start().
+size_t
+stop();
+
+}  // namespace allocation_counter
+
+#endif  // ALLOCATION_COUNTER_HPP_
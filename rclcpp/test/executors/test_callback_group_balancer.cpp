@@ -0,0 +1,181 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/executors.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+using rclcpp::callback_group::CallbackGroupType;
+
+class TestCallbackGroupBalancer : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  void SetUp()
+  {
+    node = std::make_shared<rclcpp::Node>("test_callback_group_balancer");
+    for (auto & executor : executors) {
+      executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+    }
+  }
+
+  void TearDown()
+  {
+    for (auto & executor : executors) {
+      executor->cancel();
+    }
+    for (auto & thread : threads) {
+      thread.join();
+    }
+    node.reset();
+  }
+
+  void spin()
+  {
+    for (size_t i = 0; i < executors.size(); ++i) {
+      threads.emplace_back(
+        [this, i]() {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            thread_ids[i] = std::this_thread::get_id();
+          }
+          executors[i]->spin();
+        });
+    }
+  }
+
+  // Create a timer in a new group, which burns CPU and records the thread executing it.
+  rclcpp::callback_group::CallbackGroup::SharedPtr
+  create_busy_group(std::chrono::milliseconds busy_time, std::thread::id & thread_id)
+  {
+    auto group = node->create_callback_group(CallbackGroupType::MutuallyExclusive);
+    timers.push_back(
+      node->create_wall_timer(
+        5ms, [this, busy_time, &thread_id]() {
+          {
+            std::lock_guard<std::mutex> lock(mutex);
+            thread_id = std::this_thread::get_id();
+          }
+          auto end = std::chrono::steady_clock::now() + busy_time;
+          while (std::chrono::steady_clock::now() < end) {
+          }
+        }, group));
+    return group;
+  }
+
+  // Wait until the group is executed by the thread of the executor.
+  bool wait_executed_by(const std::thread::id & thread_id, size_t executor_index)
+  {
+    auto end = std::chrono::steady_clock::now() + 5s;
+    while (std::chrono::steady_clock::now() < end) {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (thread_id == thread_ids[executor_index]) {
+          return true;
+        }
+      }
+      std::this_thread::sleep_for(10ms);
+    }
+    return false;
+  }
+
+  rclcpp::Node::SharedPtr node;
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  std::vector<rclcpp::executor::Executor::SharedPtr> executors{2};
+  std::vector<std::thread> threads;
+  std::mutex mutex;
+  std::thread::id thread_ids[2];
+};
+
+TEST_F(TestCallbackGroupBalancer, construction) {
+  using Executors = std::vector<rclcpp::executor::Executor::SharedPtr>;
+  EXPECT_THROW(rclcpp::executors::CallbackGroupBalancer(Executors()), std::invalid_argument);
+  EXPECT_THROW(
+    rclcpp::executors::CallbackGroupBalancer(Executors(1, nullptr)), std::invalid_argument);
+
+  rclcpp::executors::SingleThreadedExecutor other_executor;
+  other_executor.add_node(node);
+  rclcpp::executors::CallbackGroupBalancer balancer(executors);
+  EXPECT_THROW(balancer.add_node(node), std::runtime_error);
+}
+
+// The groups are spread over the executors, and moved between them without stopping them
+TEST_F(TestCallbackGroupBalancer, move_callback_group) {
+  std::thread::id first_thread;
+  std::thread::id second_thread;
+  auto first_group = create_busy_group(1ms, first_thread);
+  auto second_group = create_busy_group(1ms, second_thread);
+  rclcpp::executors::CallbackGroupBalancer balancer(executors);
+  balancer.add_node(node);
+  EXPECT_NE(balancer.get_executor_index(first_group), balancer.get_executor_index(second_group));
+  EXPECT_LT(balancer.get_executor_index(first_group), 2u);
+  EXPECT_LT(balancer.get_executor_index(second_group), 2u);
+  EXPECT_THROW(balancer.move_callback_group(first_group, 2), std::out_of_range);
+
+  spin();
+  balancer.move_callback_group(first_group, 0);
+  balancer.move_callback_group(second_group, 0);
+  EXPECT_TRUE(wait_executed_by(first_thread, 0));
+  EXPECT_TRUE(wait_executed_by(second_thread, 0));
+
+  balancer.move_callback_group(second_group, 1);
+  EXPECT_TRUE(wait_executed_by(second_thread, 1));
+  EXPECT_EQ(1u, balancer.get_executor_index(second_group));
+}
+
+// rebalance() moves a group from the busiest executor to the idlest one
+TEST_F(TestCallbackGroupBalancer, rebalance) {
+  std::thread::id first_thread;
+  std::thread::id second_thread;
+  auto first_group = create_busy_group(2ms, first_thread);
+  auto second_group = create_busy_group(2ms, second_thread);
+  rclcpp::executors::CallbackGroupBalancer balancer(executors);
+  balancer.add_node(node);
+  balancer.move_callback_group(first_group, 0);
+  balancer.move_callback_group(second_group, 0);
+  spin();
+
+  std::this_thread::sleep_for(200ms);
+  EXPECT_EQ(1u, balancer.rebalance());
+  auto loads = balancer.get_executor_loads();
+  ASSERT_EQ(2u, loads.size());
+  EXPECT_GT(loads[0], std::chrono::nanoseconds(0));
+  EXPECT_EQ(std::chrono::nanoseconds(0), loads[1]);
+  EXPECT_NE(balancer.get_executor_index(first_group), balancer.get_executor_index(second_group));
+
+  // A group created later is assigned by the next rebalance().
+  std::thread::id third_thread;
+  auto third_group = create_busy_group(1ms, third_thread);
+  EXPECT_EQ(2u, balancer.get_executor_index(third_group));
+  balancer.rebalance();
+  EXPECT_LT(balancer.get_executor_index(third_group), 2u);
+
+  balancer.remove_node(node);
+  EXPECT_EQ(2u, balancer.get_executor_index(first_group));
+}
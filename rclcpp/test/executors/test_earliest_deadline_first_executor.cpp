@@ -0,0 +1,117 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/executors.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+
+class TestEarliestDeadlineFirstExecutor : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+};
+
+/*
+   Test that the most overdue timer runs first and that late timers are counted as misses.
+ */
+TEST_F(TestEarliestDeadlineFirstExecutor, timers_by_expected_call_time) {
+  rclcpp::executors::EarliestDeadlineFirstExecutor executor;
+  auto node = std::make_shared<rclcpp::Node>("test_edf_executor_timers");
+
+  std::vector<std::string> order;
+  // Created first, so the base executor would execute it first.
+  rclcpp::TimerBase::SharedPtr slow_timer;
+  slow_timer = node->create_wall_timer(
+    100ms, [&]() {
+      order.push_back("slow");
+      slow_timer->cancel();
+    });
+  rclcpp::TimerBase::SharedPtr fast_timer;
+  fast_timer = node->create_wall_timer(
+    1ms, [&]() {
+      order.push_back("fast");
+      fast_timer->cancel();
+    });
+
+  executor.add_node(node);
+  std::this_thread::sleep_for(150ms);
+  executor.spin_some();
+
+  ASSERT_EQ(2u, order.size());
+  EXPECT_EQ("fast", order[0]);
+  EXPECT_EQ("slow", order[1]);
+  // The fast timer is executed more than one period after it was due, the slow one is not.
+  EXPECT_EQ(1u, executor.get_number_of_deadline_misses(fast_timer));
+  EXPECT_EQ(0u, executor.get_number_of_deadline_misses(slow_timer));
+  EXPECT_EQ(0u, executor.get_number_of_queued_executables());
+}
+
+/*
+   Test that timers and subscriptions are ordered together by their absolute deadline.
+ */
+TEST_F(TestEarliestDeadlineFirstExecutor, timers_and_subscriptions_by_deadline) {
+  rclcpp::executors::EarliestDeadlineFirstExecutor executor;
+  auto node = std::make_shared<rclcpp::Node>("test_edf_executor_mixed");
+
+  std::vector<std::string> order;
+  // Created first, so the base executor would execute it first.
+  rclcpp::TimerBase::SharedPtr timer;
+  timer = node->create_wall_timer(
+    200ms, [&]() {
+      order.push_back("timer");
+      timer->cancel();
+    });
+  auto plain_subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "edf_plain_topic", 10, [&](test_msgs::msg::Empty::SharedPtr) {
+      order.push_back("plain");
+    });
+  auto deadline_qos = rclcpp::QoS(10).deadline(50ms);
+  auto deadline_subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "edf_deadline_topic", deadline_qos, [&](test_msgs::msg::Empty::SharedPtr) {
+      order.push_back("deadline");
+    });
+  auto plain_publisher = node->create_publisher<test_msgs::msg::Empty>("edf_plain_topic", 10);
+  auto deadline_publisher =
+    node->create_publisher<test_msgs::msg::Empty>("edf_deadline_topic", deadline_qos);
+
+  executor.add_node(node);
+  plain_publisher->publish(test_msgs::msg::Empty());
+  deadline_publisher->publish(test_msgs::msg::Empty());
+  // The timer is due 200ms after its creation, its deadline is 400ms after it.
+  // The deadline of the subscription is 50ms after it is found ready, around 300ms.
+  std::this_thread::sleep_for(250ms);
+  executor.spin_some();
+
+  ASSERT_EQ(3u, order.size());
+  EXPECT_EQ("deadline", order[0]);
+  EXPECT_EQ("timer", order[1]);
+  EXPECT_EQ("plain", order[2]);
+  EXPECT_EQ(0u, executor.get_number_of_deadline_misses(timer));
+  EXPECT_EQ(0u, executor.get_number_of_deadline_misses(deadline_subscription));
+}
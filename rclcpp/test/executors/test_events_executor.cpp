@@ -0,0 +1,109 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <memory>
+
+#include "rclcpp/executors.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+
+class TestEventsExecutor : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  void SetUp()
+  {
+    node = std::make_shared<rclcpp::Node>("test_events_executor");
+  }
+
+  void TearDown()
+  {
+    node.reset();
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+// The entity table is only rebuilt when something changed
+TEST_F(TestEventsExecutor, rebuild_only_on_change) {
+  rclcpp::executors::EventsExecutor executor;
+  int timer_count = 0;
+  auto timer = node->create_wall_timer(1ms, [&timer_count]() {timer_count++;});
+  executor.add_node(node);
+
+  while (timer_count < 5) {
+    executor.spin_once(100ms);
+  }
+  // The first wait builds the table, the timer creation was already accounted for.
+  EXPECT_LE(executor.get_number_of_entity_rebuilds(), 2u);
+  size_t rebuilds = executor.get_number_of_entity_rebuilds();
+
+  // Adding an entity triggers the node's notify guard condition
+  int second_timer_count = 0;
+  auto second_timer = node->create_wall_timer(
+    1ms, [&second_timer_count]() {second_timer_count++;});
+  while (second_timer_count < 1) {
+    executor.spin_once(100ms);
+  }
+  EXPECT_GT(executor.get_number_of_entity_rebuilds(), rebuilds);
+}
+
+// Entities which go out of scope are dropped from the table
+TEST_F(TestEventsExecutor, remove_expired_entities) {
+  rclcpp::executors::EventsExecutor executor;
+  int timer_count = 0;
+  auto timer = node->create_wall_timer(1ms, [&timer_count]() {timer_count++;});
+  executor.add_node(node);
+  while (timer_count < 1) {
+    executor.spin_once(100ms);
+  }
+  timer.reset();
+  EXPECT_NO_THROW(executor.spin_some());
+  EXPECT_EQ(0u, executor.get_number_of_queued_executables());
+}
+
+// Make sure that the executor can automatically remove expired nodes correctly
+TEST_F(TestEventsExecutor, add_temporary_node) {
+  rclcpp::executors::EventsExecutor executor;
+  executor.add_node(std::make_shared<rclcpp::Node>("temporary_node"));
+  EXPECT_NO_THROW(executor.spin_some());
+}
+
+TEST_F(TestEventsExecutor, spin_until_future_complete) {
+  rclcpp::executors::EventsExecutor executor;
+  std::promise<void> promise;
+  std::shared_future<void> future = promise.get_future().share();
+  bool promise_set = false;
+  auto timer = node->create_wall_timer(
+    1ms, [&promise, &promise_set]() {
+      if (!promise_set) {
+        promise.set_value();
+        promise_set = true;
+      }
+    });
+  executor.add_node(node);
+  auto ret = executor.spin_until_future_complete(future, 1s);
+  EXPECT_EQ(rclcpp::executor::FutureReturnCode::SUCCESS, ret);
+  executor.remove_node(node);
+}
@@ -14,9 +14,13 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <chrono>
 #include <string>
 #include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/node.hpp"
@@ -96,3 +100,122 @@ TEST_F(TestMultiThreadedExecutor, timer_over_take) {
   executor.add_node(node);
   executor.spin();
 }
+
+#ifdef __linux__
+/*
+   Test that the thread options of ExecutorArgs are applied to the executor threads.
+ */
+TEST_F(TestMultiThreadedExecutor, thread_options) {
+  rclcpp::executor::ExecutorArgs args = rclcpp::executor::create_default_executor_arguments();
+  rclcpp::ThreadOptions worker_options;
+  worker_options.name = "test_mte_worker";
+  worker_options.cpu_set = {0};
+  args.thread_options.push_back(worker_options);
+  rclcpp::executors::MultiThreadedExecutor executor(args, 2u);
+
+  std::shared_ptr<rclcpp::Node> node =
+    std::make_shared<rclcpp::Node>("test_multi_threaded_executor_thread_options");
+  auto cbg = node->create_callback_group(rclcpp::callback_group::CallbackGroupType::Reentrant);
+
+  const std::thread::id spin_thread_id = std::this_thread::get_id();
+  std::atomic_int count {0};
+  std::atomic_bool worker_ran {false};
+  std::atomic_bool wrong_name {false};
+  std::atomic_bool wrong_affinity {false};
+  auto callback = [&]() {
+      if (std::this_thread::get_id() != spin_thread_id) {
+        worker_ran.store(true);
+        char name[16];
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        if (std::string(name) != "test_mte_worker") {
+          wrong_name.store(true);
+        }
+        if (sched_getcpu() != 0) {
+          wrong_affinity.store(true);
+        }
+      }
+      std::this_thread::sleep_for(1ms);
+      if (++count > 20) {
+        executor.cancel();
+      }
+    };
+  auto timer1 = node->create_wall_timer(1ms, callback, cbg);
+  auto timer2 = node->create_wall_timer(1ms, callback, cbg);
+
+  executor.add_node(node);
+  executor.spin();
+  EXPECT_TRUE(worker_ran.load());
+  EXPECT_FALSE(wrong_name.load());
+  EXPECT_FALSE(wrong_affinity.load());
+}
+#endif
+
+/*
+   Test that the elastic thread pool grows while the work waits, and shrinks when idle.
+ */
+TEST_F(TestMultiThreadedExecutor, elastic_thread_pool) {
+  using Options = rclcpp::executors::MultiThreadedExecutor::ElasticThreadPoolOptions;
+  Options invalid_options;
+  invalid_options.min_threads = 4;
+  invalid_options.max_threads = 2;
+  EXPECT_THROW(
+    rclcpp::executors::MultiThreadedExecutor(
+      rclcpp::executor::create_default_executor_arguments(), invalid_options),
+    std::invalid_argument);
+
+  Options options;
+  options.min_threads = 1;
+  options.max_threads = 4;
+  options.grow_threshold = 1ms;
+  options.idle_timeout = 100ms;
+  rclcpp::executors::MultiThreadedExecutor executor(
+    rclcpp::executor::create_default_executor_arguments(), options);
+  EXPECT_EQ(4u, executor.get_number_of_threads());
+  EXPECT_EQ(0u, executor.get_number_of_active_threads());
+
+  auto node = std::make_shared<rclcpp::Node>("test_multi_threaded_executor_elastic");
+  auto group = node->create_callback_group(rclcpp::callback_group::CallbackGroupType::Reentrant);
+  std::atomic<bool> busy{true};
+  std::atomic<size_t> max_concurrency{0};
+  std::atomic<size_t> concurrency{0};
+  auto busy_callback = [&]() {
+      if (!busy.load()) {
+        return;
+      }
+      size_t current = ++concurrency;
+      size_t previous = max_concurrency.load();
+      while (previous < current && !max_concurrency.compare_exchange_weak(previous, current)) {
+      }
+      std::this_thread::sleep_for(20ms);
+      --concurrency;
+    };
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  for (size_t i = 0; i < 4; ++i) {
+    timers.push_back(node->create_wall_timer(1ms, busy_callback, group));
+  }
+  executor.add_node(node);
+
+  std::thread spin_thread([&executor]() {executor.spin();});
+  auto end = std::chrono::steady_clock::now() + 5s;
+  while (executor.get_number_of_active_threads() < 2u && std::chrono::steady_clock::now() < end) {
+    std::this_thread::sleep_for(5ms);
+  }
+  EXPECT_GE(executor.get_number_of_active_threads(), 2u);
+  EXPECT_LE(executor.get_number_of_active_threads(), 4u);
+
+  // Once idle, the pool goes back to its minimum.
+  busy.store(false);
+  for (auto & timer : timers) {
+    timer->cancel();
+  }
+  end = std::chrono::steady_clock::now() + 5s;
+  while (executor.get_number_of_active_threads() > 1u && std::chrono::steady_clock::now() < end) {
+    std::this_thread::sleep_for(10ms);
+  }
+  EXPECT_EQ(1u, executor.get_number_of_active_threads());
+
+  executor.cancel();
+  spin_thread.join();
+  EXPECT_EQ(0u, executor.get_number_of_active_threads());
+  EXPECT_GE(max_concurrency.load(), 2u);
+}
@@ -0,0 +1,135 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+#include <poll.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "rclcpp/executors.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+
+class TestPollableExecutor : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  void SetUp()
+  {
+    node = std::make_shared<rclcpp::Node>("test_pollable_executor");
+  }
+
+  void TearDown()
+  {
+    node.reset();
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+static bool
+wait_readable(int fd, std::chrono::milliseconds timeout)
+{
+  pollfd poll_fd {fd, POLLIN, 0};
+  return poll(&poll_fd, 1, static_cast<int>(timeout.count())) > 0;
+}
+
+// The callbacks run on the thread calling dispatch(), once the file descriptor is readable
+TEST_F(TestPollableExecutor, dispatch_on_event_loop_thread) {
+  rclcpp::executors::PollableExecutor executor;
+  std::thread::id callback_thread;
+  int received = 0;
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "pollable_topic", 10,
+    [&callback_thread, &received](test_msgs::msg::Empty::SharedPtr) {
+      callback_thread = std::this_thread::get_id();
+      received++;
+    });
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("pollable_topic", 10);
+  executor.add_node(node);
+
+  // Nothing was signaled yet, dispatch() doesn't block.
+  EXPECT_EQ(0u, executor.dispatch());
+  executor.start();
+  EXPECT_THROW(executor.start(), std::runtime_error);
+
+  publisher->publish(test_msgs::msg::Empty());
+  auto end = std::chrono::steady_clock::now() + 5s;
+  while (received == 0 && std::chrono::steady_clock::now() < end) {
+    if (wait_readable(executor.get_fd(), 100ms)) {
+      executor.dispatch();
+    }
+  }
+  EXPECT_EQ(1, received);
+  EXPECT_EQ(std::this_thread::get_id(), callback_thread);
+
+  // The work was executed, the waiting thread is back in rcl_wait().
+  EXPECT_FALSE(wait_readable(executor.get_fd(), 50ms));
+  executor.stop();
+}
+
+// The file descriptor stays readable while work is left after a partial dispatch()
+TEST_F(TestPollableExecutor, partial_dispatch) {
+  rclcpp::executors::PollableExecutor executor;
+  int first_count = 0;
+  int second_count = 0;
+  auto first = node->create_wall_timer(1ms, [&first_count]() {first_count++;});
+  auto second = node->create_wall_timer(1ms, [&second_count]() {second_count++;});
+  executor.add_node(node);
+  std::this_thread::sleep_for(5ms);
+  executor.start();
+
+  size_t executed = 0;
+  auto end = std::chrono::steady_clock::now() + 5s;
+  while (executed == 0 && std::chrono::steady_clock::now() < end) {
+    if (wait_readable(executor.get_fd(), 100ms)) {
+      executed = executor.dispatch(1);
+    }
+  }
+  // Both timers were ready when the waiting thread collected them.
+  ASSERT_EQ(1u, executed);
+  EXPECT_EQ(1, first_count + second_count);
+  EXPECT_TRUE(wait_readable(executor.get_fd(), 0ms));
+  EXPECT_LE(1u, executor.dispatch());
+  EXPECT_EQ(1, first_count);
+  EXPECT_EQ(1, second_count);
+  executor.stop();
+}
+
+// spin() polls and dispatches until cancel()
+TEST_F(TestPollableExecutor, spin_and_cancel) {
+  rclcpp::executors::PollableExecutor executor;
+  int timer_count = 0;
+  auto timer = node->create_wall_timer(
+    1ms, [&timer_count, &executor]() {
+      if (++timer_count == 5) {
+        executor.cancel();
+      }
+    });
+  executor.add_node(node);
+
+  std::thread spin_thread([&executor]() {executor.spin();});
+  spin_thread.join();
+  EXPECT_EQ(5, timer_count);
+}
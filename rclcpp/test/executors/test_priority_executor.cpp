@@ -0,0 +1,107 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/executors.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+
+class TestPriorityExecutor : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+};
+
+/*
+   Test that ready work of a higher priority group is executed first.
+ */
+TEST_F(TestPriorityExecutor, higher_priority_first) {
+  rclcpp::executors::PriorityExecutor executor;
+  auto node = std::make_shared<rclcpp::Node>("test_priority_executor_order");
+  auto low = node->create_callback_group(rclcpp::callback_group::CallbackGroupType::Reentrant);
+  auto high = node->create_callback_group(rclcpp::callback_group::CallbackGroupType::Reentrant);
+  high->set_priority(10);
+  EXPECT_EQ(0, low->get_priority());
+  EXPECT_EQ(10, high->get_priority());
+
+  std::vector<std::string> order;
+  // Created first, so the base executor would execute it first.
+  rclcpp::TimerBase::SharedPtr low_timer;
+  low_timer = node->create_wall_timer(
+    1ms, [&]() {
+      order.push_back("low");
+      low_timer->cancel();
+    }, low);
+  rclcpp::TimerBase::SharedPtr high_timer;
+  high_timer = node->create_wall_timer(
+    1ms, [&]() {
+      order.push_back("high");
+      high_timer->cancel();
+    }, high);
+
+  executor.add_node(node);
+  std::this_thread::sleep_for(5ms);
+  executor.spin_some();
+  ASSERT_EQ(2u, order.size());
+  EXPECT_EQ("high", order[0]);
+  EXPECT_EQ("low", order[1]);
+  EXPECT_TRUE(executor.get_queue_depths().empty());
+}
+
+/*
+   Test that groups of the same priority are served round-robin.
+ */
+TEST_F(TestPriorityExecutor, round_robin_within_priority) {
+  rclcpp::executors::PriorityExecutor executor;
+  auto node = std::make_shared<rclcpp::Node>("test_priority_executor_round_robin");
+  auto cbg_a = node->create_callback_group(rclcpp::callback_group::CallbackGroupType::Reentrant);
+  auto cbg_b = node->create_callback_group(rclcpp::callback_group::CallbackGroupType::Reentrant);
+
+  std::vector<std::string> order;
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  auto make_timer = [&](
+    const std::string & name, rclcpp::callback_group::CallbackGroup::SharedPtr cbg)
+    {
+      size_t index = timers.size();
+      timers.push_back(
+        node->create_wall_timer(
+          1ms, [&order, &timers, name, index]() {
+            order.push_back(name);
+            timers[index]->cancel();
+          }, cbg));
+    };
+  make_timer("a1", cbg_a);
+  make_timer("a2", cbg_a);
+  make_timer("b1", cbg_b);
+
+  executor.add_node(node);
+  std::this_thread::sleep_for(5ms);
+  executor.spin_some();
+  ASSERT_EQ(3u, order.size());
+  EXPECT_EQ("a1", order[0]);
+  EXPECT_EQ("b1", order[1]);
+  EXPECT_EQ("a2", order[2]);
+}
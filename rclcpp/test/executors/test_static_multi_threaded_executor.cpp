@@ -0,0 +1,144 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include "rclcpp/executors.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+
+class TestStaticMultiThreadedExecutor : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+};
+
+/*
+   Test that each callback group runs on a single thread, and two groups on different threads.
+ */
+TEST_F(TestStaticMultiThreadedExecutor, groups_are_pinned_to_threads) {
+  rclcpp::executors::StaticMultiThreadedExecutor executor(
+    rclcpp::executor::create_default_executor_arguments(), 2u);
+  ASSERT_EQ(2u, executor.get_number_of_threads());
+
+  auto node = std::make_shared<rclcpp::Node>("test_static_multi_threaded_groups");
+  auto cbg1 = node->create_callback_group(rclcpp::callback_group::CallbackGroupType::Reentrant);
+  auto cbg2 = node->create_callback_group(rclcpp::callback_group::CallbackGroupType::Reentrant);
+
+  std::mutex mutex;
+  std::set<std::thread::id> threads1;
+  std::set<std::thread::id> threads2;
+  std::atomic_int count1 {0};
+  std::atomic_int count2 {0};
+  auto check_done = [&]() {
+      if (count1.load() > 10 && count2.load() > 10) {
+        executor.cancel();
+      }
+    };
+  auto timer1 = node->create_wall_timer(
+    1ms, [&]() {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        threads1.insert(std::this_thread::get_id());
+      }
+      ++count1;
+      check_done();
+    }, cbg1);
+  auto timer2 = node->create_wall_timer(
+    1ms, [&]() {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        threads2.insert(std::this_thread::get_id());
+      }
+      ++count2;
+      check_done();
+    }, cbg2);
+
+  executor.add_node(node);
+  executor.spin();
+
+  EXPECT_EQ(1u, threads1.size());
+  EXPECT_EQ(1u, threads2.size());
+  EXPECT_NE(*threads1.begin(), *threads2.begin());
+  EXPECT_NE(
+    executor.get_thread_of_callback_group(cbg1), executor.get_thread_of_callback_group(cbg2));
+}
+
+/*
+   Test that entities added while spinning are picked up.
+ */
+TEST_F(TestStaticMultiThreadedExecutor, add_timer_while_spinning) {
+  rclcpp::executors::StaticMultiThreadedExecutor executor(
+    rclcpp::executor::create_default_executor_arguments(), 2u);
+
+  auto node = std::make_shared<rclcpp::Node>("test_static_multi_threaded_add_timer");
+  auto cbg = node->create_callback_group(
+    rclcpp::callback_group::CallbackGroupType::MutuallyExclusive);
+  EXPECT_EQ(2u, executor.get_thread_of_callback_group(cbg));
+
+  rclcpp::TimerBase::SharedPtr late_timer;
+  auto timer = node->create_wall_timer(
+    1ms, [&]() {
+      if (!late_timer) {
+        late_timer = node->create_wall_timer(1ms, [&]() {executor.cancel();}, cbg);
+      }
+    }, cbg);
+
+  executor.add_node(node);
+  executor.spin();
+  EXPECT_LT(executor.get_thread_of_callback_group(cbg), 2u);
+}
+
+/*
+   Test that a callback group can be dedicated to a thread.
+ */
+TEST_F(TestStaticMultiThreadedExecutor, assign_callback_group_to_thread) {
+  rclcpp::executors::StaticMultiThreadedExecutor executor(
+    rclcpp::executor::create_default_executor_arguments(), 3u);
+
+  auto node = std::make_shared<rclcpp::Node>("test_static_multi_threaded_assign_group");
+  auto cbg = node->create_callback_group(
+    rclcpp::callback_group::CallbackGroupType::MutuallyExclusive);
+  EXPECT_THROW(executor.assign_callback_group_to_thread(cbg, 3u), std::invalid_argument);
+  executor.assign_callback_group_to_thread(cbg, 2u);
+  EXPECT_EQ(2u, executor.get_thread_of_callback_group(cbg));
+
+  const std::thread::id spin_thread_id = std::this_thread::get_id();
+  std::atomic_bool ran_on_spin_thread {false};
+  auto timer = node->create_wall_timer(
+    1ms, [&]() {
+      if (std::this_thread::get_id() == spin_thread_id) {
+        ran_on_spin_thread.store(true);
+      }
+      executor.cancel();
+    }, cbg);
+
+  executor.add_node(node);
+  executor.spin();
+  EXPECT_FALSE(ran_on_spin_thread.load());
+  EXPECT_EQ(2u, executor.get_thread_of_callback_group(cbg));
+}
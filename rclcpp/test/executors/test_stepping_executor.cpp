@@ -0,0 +1,129 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/executors.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+
+class TestSteppingExecutor : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  rclcpp::Node::SharedPtr
+  make_sim_time_node(const std::string & name)
+  {
+    return std::make_shared<rclcpp::Node>(
+      name,
+      rclcpp::NodeOptions()
+      .use_intra_process_comms(true)
+      .parameter_overrides({rclcpp::Parameter("use_sim_time", true)}));
+  }
+};
+
+/*
+   The timers on the simulated time are executed in deadline order, without waiting.
+ */
+TEST_F(TestSteppingExecutor, timers_in_deadline_order) {
+  auto node = make_sim_time_node("test_stepping_executor_timers");
+  std::vector<std::pair<int64_t, int>> calls;
+  auto clock = node->get_clock();
+  auto fast_timer = rclcpp::create_timer(
+    node, clock, rclcpp::Duration(30ms),
+    [&calls, clock]() {calls.emplace_back(clock->now().nanoseconds(), 30);});
+  auto slow_timer = rclcpp::create_timer(
+    node, clock, rclcpp::Duration(50ms),
+    [&calls, clock]() {calls.emplace_back(clock->now().nanoseconds(), 50);});
+
+  rclcpp::executors::SteppingExecutor executor;
+  executor.add_node(node);
+  auto start = std::chrono::steady_clock::now();
+  executor.spin_until(rclcpp::Time(100000000, RCL_ROS_TIME));
+  // 100 ms of simulated time take much less than that.
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 100ms);
+
+  std::vector<std::pair<int64_t, int>> expected = {
+    {30000000, 30}, {50000000, 50}, {60000000, 30}, {90000000, 30}, {100000000, 50}};
+  EXPECT_EQ(expected, calls);
+  EXPECT_EQ(100000000, executor.get_time().nanoseconds());
+  EXPECT_EQ(100000000, node->now().nanoseconds());
+
+  EXPECT_THROW(executor.spin_until(rclcpp::Time(50000000, RCL_ROS_TIME)), std::invalid_argument);
+}
+
+/*
+   The messages published by a callback are executed at the same simulated time.
+ */
+TEST_F(TestSteppingExecutor, messages_at_the_same_time) {
+  auto node = make_sim_time_node("test_stepping_executor_messages");
+  auto clock = node->get_clock();
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>(
+    "stepping_topic", 10);
+  std::vector<int64_t> publish_times;
+  std::vector<int64_t> receive_times;
+  auto timer = rclcpp::create_timer(
+    node, clock, rclcpp::Duration(10ms),
+    [&publish_times, &publisher, clock]() {
+      publish_times.push_back(clock->now().nanoseconds());
+      publisher->publish(test_msgs::msg::Empty());
+    });
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "stepping_topic", 10,
+    [&receive_times, clock](test_msgs::msg::Empty::SharedPtr) {
+      receive_times.push_back(clock->now().nanoseconds());
+    });
+
+  rclcpp::executors::SteppingExecutor executor;
+  executor.add_node(node);
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_TRUE(executor.step());
+  }
+  executor.spin_until(executor.get_time());
+  EXPECT_EQ(3u, publish_times.size());
+  EXPECT_EQ(publish_times, receive_times);
+}
+
+/*
+   Without timers on the simulated time, a step doesn't advance the time.
+ */
+TEST_F(TestSteppingExecutor, no_simulated_timer) {
+  auto node = make_sim_time_node("test_stepping_executor_no_timer");
+  rclcpp::executors::SteppingExecutor executor;
+  executor.add_node(node);
+  executor.add_clock(node->get_clock());
+  EXPECT_THROW(
+    executor.add_clock(std::make_shared<rclcpp::Clock>(RCL_STEADY_TIME)), std::invalid_argument);
+
+  executor.set_time(rclcpp::Time(5000000000, RCL_ROS_TIME));
+  EXPECT_FALSE(executor.step());
+  EXPECT_EQ(5000000000, executor.get_time().nanoseconds());
+  EXPECT_EQ(5000000000, node->now().nanoseconds());
+}
@@ -0,0 +1,150 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/executors.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+
+class TestTimeTriggeredExecutor : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+};
+
+/*
+   Test that the schedule is validated, and can't be changed while spinning.
+ */
+TEST_F(TestTimeTriggeredExecutor, schedule) {
+  rclcpp::executors::TimeTriggeredExecutor executor;
+  auto node = std::make_shared<rclcpp::Node>("test_time_triggered_executor_schedule");
+  auto timer = node->create_wall_timer(10ms, []() {});
+
+  EXPECT_THROW(executor.spin(), std::runtime_error);
+  EXPECT_THROW(executor.add_minor_frame(0ms), std::invalid_argument);
+  EXPECT_THROW(executor.add_timer(0, timer), std::out_of_range);
+
+  EXPECT_EQ(0u, executor.add_minor_frame(4ms));
+  EXPECT_EQ(1u, executor.add_minor_frame(6ms));
+  EXPECT_EQ(2u, executor.get_number_of_minor_frames());
+  EXPECT_EQ(10ms, executor.get_major_frame_duration());
+  EXPECT_THROW(executor.add_timer(0, nullptr), std::invalid_argument);
+  executor.add_timer(1, timer);
+
+  std::thread spin_thread([&executor]() {executor.spin();});
+  std::this_thread::sleep_for(20ms);
+  EXPECT_THROW(executor.add_minor_frame(1ms), std::runtime_error);
+  executor.cancel();
+  spin_thread.join();
+
+  executor.clear_schedule();
+  EXPECT_EQ(0u, executor.get_number_of_minor_frames());
+}
+
+/*
+   Test that the work of the frames is executed in the order of the schedule, once per period.
+ */
+TEST_F(TestTimeTriggeredExecutor, execution_order) {
+  rclcpp::executors::TimeTriggeredExecutor executor;
+  auto node = std::make_shared<rclcpp::Node>("test_time_triggered_executor_order");
+
+  std::mutex order_mutex;
+  std::vector<std::string> order;
+  auto record = [&order_mutex, &order](const std::string & name) {
+      std::lock_guard<std::mutex> lock(order_mutex);
+      order.push_back(name);
+    };
+  // Created in another order than the one of the schedule.
+  auto third = node->create_wall_timer(20ms, [&record]() {record("third");});
+  auto second = node->create_wall_timer(20ms, [&record]() {record("second");});
+  auto first = node->create_wall_timer(20ms, [&record]() {record("first");});
+
+  size_t sense = executor.add_minor_frame(10ms);
+  size_t act = executor.add_minor_frame(10ms);
+  executor.add_timer(sense, first);
+  executor.add_timer(sense, second);
+  executor.add_timer(act, third);
+
+  std::thread spin_thread([&executor]() {executor.spin();});
+  std::this_thread::sleep_for(110ms);
+  executor.cancel();
+  spin_thread.join();
+
+  // The timers run from the second major frame on, once per major frame.
+  std::lock_guard<std::mutex> lock(order_mutex);
+  ASSERT_LE(6u, order.size());
+  EXPECT_GE(15u, order.size());
+  for (size_t i = 0; i + 3 <= order.size(); i += 3) {
+    EXPECT_EQ("first", order[i]);
+    EXPECT_EQ("second", order[i + 1]);
+    EXPECT_EQ("third", order[i + 2]);
+  }
+  EXPECT_LE(5u, executor.get_frame_statistics(sense).count);
+  EXPECT_LE(5u, executor.get_frame_statistics(act).count);
+}
+
+/*
+   Test that a frame whose work takes longer than the frame is reported as an overrun.
+ */
+TEST_F(TestTimeTriggeredExecutor, frame_overrun) {
+  rclcpp::executors::TimeTriggeredExecutor executor;
+  auto node = std::make_shared<rclcpp::Node>("test_time_triggered_executor_overrun");
+  auto slow = node->create_wall_timer(
+    20ms, []() {std::this_thread::sleep_for(15ms);});
+
+  size_t slow_frame = executor.add_minor_frame(10ms);
+  size_t idle_frame = executor.add_minor_frame(10ms);
+  executor.add_timer(slow_frame, slow);
+
+  std::atomic<size_t> reported(0);
+  std::atomic<bool> overrun_in_time(true);
+  executor.set_frame_overrun_callback(
+    [&](size_t minor_frame, std::chrono::nanoseconds overrun) {
+      reported++;
+      if (minor_frame != slow_frame || overrun < 5ms) {
+        overrun_in_time = false;
+      }
+    });
+
+  std::thread spin_thread([&executor]() {executor.spin();});
+  std::this_thread::sleep_for(110ms);
+  executor.cancel();
+  spin_thread.join();
+
+  auto statistics = executor.get_frame_statistics(slow_frame);
+  EXPECT_LE(3u, statistics.overrun_count);
+  EXPECT_LE(15ms, statistics.max_execution_time);
+  EXPECT_LE(5ms, statistics.max_overrun);
+  EXPECT_EQ(statistics.overrun_count, reported.load());
+  EXPECT_TRUE(overrun_in_time.load());
+  // The late idle frames still end in time.
+  EXPECT_EQ(0u, executor.get_frame_statistics(idle_frame).overrun_count);
+  EXPECT_EQ(statistics.overrun_count, executor.get_number_of_frame_overruns());
+  EXPECT_EQ(0u, executor.get_number_of_skipped_major_frames());
+}
@@ -0,0 +1,217 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/executors.hpp"
+#include "rclcpp/node.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+
+class TestWorkStealingMultiThreadedExecutor : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+};
+
+/*
+   Test that callbacks of a mutually exclusive group never run concurrently.
+ */
+TEST_F(TestWorkStealingMultiThreadedExecutor, mutually_exclusive_group) {
+  rclcpp::executors::WorkStealingMultiThreadedExecutor executor(
+    rclcpp::executor::create_default_executor_arguments(), 4u);
+  ASSERT_EQ(4u, executor.get_number_of_threads());
+
+  auto node = std::make_shared<rclcpp::Node>("test_work_stealing_mutually_exclusive");
+  auto cbg = node->create_callback_group(
+    rclcpp::callback_group::CallbackGroupType::MutuallyExclusive);
+
+  std::atomic_int running {0};
+  std::atomic_int count {0};
+  std::atomic_bool overlapped {false};
+  auto callback = [&]() {
+      if (running.fetch_add(1) != 0) {
+        overlapped.store(true);
+      }
+      std::this_thread::sleep_for(1ms);
+      running.fetch_sub(1);
+      if (++count > 20) {
+        executor.cancel();
+      }
+    };
+
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  for (size_t i = 0; i < 4; ++i) {
+    timers.push_back(node->create_wall_timer(1ms, callback, cbg));
+  }
+  executor.add_node(node);
+  executor.spin();
+  EXPECT_FALSE(overlapped.load());
+  EXPECT_GT(count.load(), 20);
+}
+
+/*
+   Test that reentrant callbacks are executed in parallel by several workers.
+ */
+TEST_F(TestWorkStealingMultiThreadedExecutor, reentrant_group) {
+  rclcpp::executors::WorkStealingMultiThreadedExecutor executor(
+    rclcpp::executor::create_default_executor_arguments(), 2u);
+
+  auto node = std::make_shared<rclcpp::Node>("test_work_stealing_reentrant");
+  auto cbg = node->create_callback_group(rclcpp::callback_group::CallbackGroupType::Reentrant);
+
+  std::atomic_int running {0};
+  std::atomic_int max_running {0};
+  std::atomic_int count {0};
+  auto callback = [&]() {
+      int now_running = ++running;
+      int previous_max = max_running.load();
+      while (now_running > previous_max &&
+        !max_running.compare_exchange_weak(previous_max, now_running))
+      {
+      }
+      std::this_thread::sleep_for(10ms);
+      --running;
+      if (++count > 10) {
+        executor.cancel();
+      }
+    };
+
+  auto timer1 = node->create_wall_timer(1ms, callback, cbg);
+  auto timer2 = node->create_wall_timer(1ms, callback, cbg);
+  executor.add_node(node);
+  executor.spin();
+  EXPECT_EQ(2, max_running.load());
+}
+
+/*
+   Test that the callbacks of a group assigned to a worker only run on that worker, one at a time.
+ */
+TEST_F(TestWorkStealingMultiThreadedExecutor, assigned_group) {
+  rclcpp::executors::WorkStealingMultiThreadedExecutor executor(
+    rclcpp::executor::create_default_executor_arguments(), 3u);
+
+  auto node = std::make_shared<rclcpp::Node>("test_work_stealing_assigned");
+  auto assigned_cbg =
+    node->create_callback_group(rclcpp::callback_group::CallbackGroupType::Reentrant);
+  auto other_cbg =
+    node->create_callback_group(rclcpp::callback_group::CallbackGroupType::Reentrant);
+  EXPECT_THROW(executor.assign_callback_group_to_thread(assigned_cbg, 3u), std::out_of_range);
+  executor.assign_callback_group_to_thread(assigned_cbg, 1u);
+
+  std::mutex threads_mutex;
+  std::set<std::thread::id> assigned_threads;
+  std::atomic_int running {0};
+  std::atomic_bool overlapped {false};
+  std::atomic_int count {0};
+  auto assigned_callback = [&]() {
+      {
+        std::lock_guard<std::mutex> lock(threads_mutex);
+        assigned_threads.insert(std::this_thread::get_id());
+      }
+      if (running.fetch_add(1) != 0) {
+        overlapped.store(true);
+      }
+      std::this_thread::sleep_for(1ms);
+      running.fetch_sub(1);
+      if (++count > 20) {
+        executor.cancel();
+      }
+    };
+  std::atomic_int other_count {0};
+  auto other_callback = [&]() {
+      std::this_thread::sleep_for(1ms);
+      ++other_count;
+    };
+
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  for (size_t i = 0; i < 3; ++i) {
+    timers.push_back(node->create_wall_timer(1ms, assigned_callback, assigned_cbg));
+    timers.push_back(node->create_wall_timer(1ms, other_callback, other_cbg));
+  }
+  executor.add_node(node);
+  executor.spin();
+  EXPECT_FALSE(overlapped.load());
+  EXPECT_EQ(1u, assigned_threads.size());
+  EXPECT_GT(other_count.load(), 0);
+}
+
+/*
+   Test that parallel_for() splits the work of a callback on the workers, and that submitted
+   tasks run on the workers.
+ */
+TEST_F(TestWorkStealingMultiThreadedExecutor, parallel_for) {
+  rclcpp::executors::WorkStealingMultiThreadedExecutor executor(
+    rclcpp::executor::create_default_executor_arguments(), 4u);
+
+  // Without spinning, the calling thread executes all the chunks.
+  std::vector<int> values(100, 0);
+  executor.parallel_for(
+    0u, values.size(), 7u, [&values](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        values[i] += 1;
+      }
+    });
+  EXPECT_EQ(std::vector<int>(100, 1), values);
+
+  auto node = std::make_shared<rclcpp::Node>("test_work_stealing_parallel_for");
+  std::mutex threads_mutex;
+  std::set<std::thread::id> chunk_threads;
+  std::atomic_int chunk_count {0};
+  std::atomic_bool exception_caught {false};
+  std::future<void> submitted;
+  rclcpp::TimerBase::SharedPtr timer;
+  timer = node->create_wall_timer(
+    1ms, [&]() {
+      executor.parallel_for(
+        0u, 64u, 1u, [&](size_t begin, size_t end) {
+          EXPECT_EQ(begin + 1, end);
+          {
+            std::lock_guard<std::mutex> lock(threads_mutex);
+            chunk_threads.insert(std::this_thread::get_id());
+          }
+          std::this_thread::sleep_for(1ms);
+          ++chunk_count;
+        });
+      try {
+        executor.parallel_for(
+          0u, 8u, 0u, [](size_t, size_t) {throw std::runtime_error("chunk failed");});
+      } catch (const std::runtime_error &) {
+        exception_caught.store(true);
+      }
+      submitted = executor.submit([&executor]() {executor.cancel();});
+      timer->cancel();
+    });
+  executor.add_node(node);
+  executor.spin();
+  EXPECT_EQ(64, chunk_count.load());
+  EXPECT_GT(chunk_threads.size(), 1u);
+  EXPECT_TRUE(exception_caught.load());
+  ASSERT_TRUE(submitted.valid());
+  EXPECT_EQ(std::future_status::ready, submitted.wait_for(0s));
+}
@@ -0,0 +1,184 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/strategies/allocator_memory_strategy.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+#include "allocation_counter.hpp"
+
+using namespace std::chrono_literals;
+
+using test_msgs::msg::BasicTypes;
+
+/*
+   Budgets of the global operator new calls per message, or per timer call, once warmed up.
+   The allocations made by rcl and the middleware through malloc aren't counted, see
+   allocation_counter.hpp.
+   The intra-process cases don't involve the middleware, the inter-process case counts its
+   operator new calls too, none are expected once it is warmed up for a fixed size message.
+ */
+// The control block of the message shared with the subscription.
+constexpr size_t publish_unique_to_shared_budget = 1;
+constexpr size_t publish_unique_to_owned_budget = 0;
+// The copy of the message given by reference.
+constexpr size_t publish_reference_to_owned_budget = 1;
+constexpr size_t timer_dispatch_budget = 0;
+// The message created by the subscription to take into, in Executor::execute_subscription().
+constexpr size_t publish_and_take_inter_process_budget = 1;
+
+class TestAllocationBudget : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+
+  void SetUp()
+  {
+    node = std::make_shared<rclcpp::Node>(
+      "test_allocation_budget", rclcpp::NodeOptions().use_intra_process_comms(true));
+    rclcpp::executor::ExecutorArgs args;
+    args.memory_strategy = std::make_shared<
+      rclcpp::memory_strategies::allocator_memory_strategy::AllocatorMemoryStrategy<>>();
+    executor = std::make_shared<rclcpp::executors::SingleThreadedExecutor>(args);
+    executor->add_node(node);
+  }
+
+  void TearDown()
+  {
+    executor.reset();
+    node.reset();
+  }
+
+  /// Return the highest number of allocations made by a call to step and spinning for its work.
+  /**
+   * prepare is called before each step, its allocations aren't counted.
+   * The steps are first run without counting, so that the buffers of the executor and of the
+   * entities reach their steady state.
+   */
+  size_t
+  max_allocations(
+    std::function<void()> prepare, std::function<void()> step, const size_t & executed)
+  {
+    const size_t warm_up_steps = 10;
+    const size_t counted_steps = 100;
+    size_t max_count = 0;
+    for (size_t i = 0; i < warm_up_steps + counted_steps; ++i) {
+      size_t target = executed + 1;
+      bool counted = i >= warm_up_steps;
+      prepare();
+      if (counted) {
+        allocation_counter::start();
+      }
+      step();
+      auto start = std::chrono::steady_clock::now();
+      while (executed < target && std::chrono::steady_clock::now() - start < 5s) {
+        executor->spin_some();
+      }
+      size_t count = allocation_counter::stop();
+      EXPECT_EQ(target, executed);
+      if (counted) {
+        max_count = std::max(max_count, count);
+      }
+    }
+    return max_count;
+  }
+
+  rclcpp::Node::SharedPtr node;
+  std::shared_ptr<rclcpp::executors::SingleThreadedExecutor> executor;
+};
+
+TEST_F(TestAllocationBudget, publish_unique_to_shared_subscription) {
+  size_t received = 0;
+  auto subscription = node->create_subscription<BasicTypes>(
+    "allocation_budget_topic", 10, [&received](BasicTypes::ConstSharedPtr) {received++;});
+  auto publisher = node->create_publisher<BasicTypes>("allocation_budget_topic", 10);
+
+  // The message itself is allocated by prepare, outside of the counted section.
+  std::unique_ptr<BasicTypes> message;
+  auto prepare = [&message]() {message = std::make_unique<BasicTypes>();};
+  auto step = [&]() {publisher->publish(std::move(message));};
+  EXPECT_LE(max_allocations(prepare, step, received), publish_unique_to_shared_budget);
+}
+
+TEST_F(TestAllocationBudget, publish_unique_to_owned_subscription) {
+  size_t received = 0;
+  auto subscription = node->create_subscription<BasicTypes>(
+    "allocation_budget_topic", 10, [&received](BasicTypes::UniquePtr) {received++;});
+  auto publisher = node->create_publisher<BasicTypes>("allocation_budget_topic", 10);
+
+  std::unique_ptr<BasicTypes> message;
+  auto prepare = [&message]() {message = std::make_unique<BasicTypes>();};
+  auto step = [&]() {publisher->publish(std::move(message));};
+  EXPECT_LE(max_allocations(prepare, step, received), publish_unique_to_owned_budget);
+}
+
+TEST_F(TestAllocationBudget, publish_reference_to_owned_subscription) {
+  size_t received = 0;
+  auto subscription = node->create_subscription<BasicTypes>(
+    "allocation_budget_topic", 10, [&received](BasicTypes::UniquePtr) {received++;});
+  auto publisher = node->create_publisher<BasicTypes>("allocation_budget_topic", 10);
+
+  BasicTypes message;
+  auto step = [&]() {publisher->publish(message);};
+  EXPECT_LE(max_allocations([]() {}, step, received), publish_reference_to_owned_budget);
+}
+
+TEST_F(TestAllocationBudget, timer_dispatch) {
+  size_t called = 0;
+  auto timer = node->create_wall_timer(1ms, [&called]() {called++;});
+
+  EXPECT_LE(max_allocations([]() {}, []() {}, called), timer_dispatch_budget);
+}
+
+TEST_F(TestAllocationBudget, publish_and_take_inter_process) {
+  auto inter_process_node = std::make_shared<rclcpp::Node>(
+    "test_allocation_budget_inter_process", rclcpp::NodeOptions().use_intra_process_comms(false));
+  executor->add_node(inter_process_node);
+  size_t received = 0;
+  auto subscription = inter_process_node->create_subscription<BasicTypes>(
+    "allocation_budget_inter_process_topic", 10,
+    [&received](BasicTypes::ConstSharedPtr) {received++;});
+  auto publisher = inter_process_node->create_publisher<BasicTypes>(
+    "allocation_budget_inter_process_topic", 10);
+  // The messages published before the subscription is matched would be lost.
+  auto start = std::chrono::steady_clock::now();
+  while (publisher->get_subscription_count() == 0 &&
+    std::chrono::steady_clock::now() - start < 5s)
+  {
+    std::this_thread::sleep_for(10ms);
+  }
+  ASSERT_EQ(1u, publisher->get_subscription_count());
+
+  BasicTypes message;
+  auto step = [&]() {publisher->publish(message);};
+  EXPECT_LE(max_allocations([]() {}, step, received), publish_and_take_inter_process_budget);
+  executor->remove_node(inter_process_node);
+}
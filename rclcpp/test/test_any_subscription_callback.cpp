@@ -0,0 +1,226 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/any_subscription_callback.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+using test_msgs::msg::BasicTypes;
+using AnySubscriptionCallback = rclcpp::AnySubscriptionCallback<BasicTypes, std::allocator<void>>;
+using MessageUniquePtr = std::unique_ptr<BasicTypes>;
+
+class TestAnySubscriptionCallback : public ::testing::Test
+{
+protected:
+  void SetUp()
+  {
+    allocator_ = std::make_shared<std::allocator<void>>();
+    message_ = std::make_shared<BasicTypes>();
+    message_->int32_value = 1;
+    message_info_.from_intra_process = false;
+  }
+
+  MessageUniquePtr make_unique_message()
+  {
+    return MessageUniquePtr(new BasicTypes(*message_));
+  }
+
+  std::shared_ptr<std::allocator<void>> allocator_;
+  std::shared_ptr<BasicTypes> message_;
+  rmw_message_info_t message_info_;
+};
+
+/*
+   Each kind of callback receives the messages dispatched to it.
+ */
+TEST_F(TestAnySubscriptionCallback, dispatch) {
+  int received = 0;
+  AnySubscriptionCallback shared_callback(allocator_);
+  shared_callback.set(
+    [&received](std::shared_ptr<BasicTypes> msg) {received += msg->int32_value;});
+  AnySubscriptionCallback const_shared_callback(allocator_);
+  const_shared_callback.set(
+    [&received](std::shared_ptr<const BasicTypes> msg, const rmw_message_info_t &) {
+      received += 10 * msg->int32_value;
+    });
+  AnySubscriptionCallback unique_callback(allocator_);
+  unique_callback.set(
+    [&received](MessageUniquePtr msg) {received += 100 * msg->int32_value;});
+
+  shared_callback.dispatch(message_, message_info_);
+  const_shared_callback.dispatch(message_, message_info_);
+  unique_callback.dispatch(message_, message_info_);
+  EXPECT_EQ(111, received);
+
+  const_shared_callback.dispatch_intra_process(
+    std::shared_ptr<const BasicTypes>(message_), message_info_);
+  shared_callback.dispatch_intra_process(make_unique_message(), message_info_);
+  unique_callback.dispatch_intra_process(make_unique_message(), message_info_);
+  EXPECT_EQ(222, received);
+
+  EXPECT_FALSE(shared_callback.use_take_shared_method());
+  EXPECT_TRUE(const_shared_callback.use_take_shared_method());
+  EXPECT_FALSE(unique_callback.use_take_shared_method());
+}
+
+/*
+   Dispatching a message the callback can't take throws.
+ */
+TEST_F(TestAnySubscriptionCallback, unexpected_dispatch) {
+  AnySubscriptionCallback no_callback(allocator_);
+  EXPECT_THROW(no_callback.dispatch(message_, message_info_), std::runtime_error);
+  EXPECT_FALSE(no_callback.use_take_shared_method());
+
+  AnySubscriptionCallback shared_callback(allocator_);
+  shared_callback.set([](std::shared_ptr<BasicTypes>) {});
+  EXPECT_THROW(
+    shared_callback.dispatch_intra_process(
+      std::shared_ptr<const BasicTypes>(message_), message_info_),
+    std::runtime_error);
+
+  AnySubscriptionCallback const_shared_callback(allocator_);
+  const_shared_callback.set([](std::shared_ptr<const BasicTypes>) {});
+  EXPECT_THROW(
+    const_shared_callback.dispatch_intra_process(make_unique_message(), message_info_),
+    std::runtime_error);
+}
+
+/*
+   Callbacks too large to be stored inline, and copies of the callbacks, are dispatched to.
+ */
+TEST_F(TestAnySubscriptionCallback, copy_and_large_callbacks) {
+  int received = 0;
+  std::array<int, 32> large_capture;
+  large_capture.fill(1);
+  auto large_callback = std::make_shared<AnySubscriptionCallback>(allocator_);
+  large_callback->set(
+    [&received, large_capture](std::shared_ptr<BasicTypes> msg) {
+      received += msg->int32_value * large_capture[0];
+    });
+
+  AnySubscriptionCallback copy(*large_callback);
+  large_callback.reset();
+  copy.dispatch(message_, message_info_);
+  EXPECT_EQ(1, received);
+
+  AnySubscriptionCallback small_callback(allocator_);
+  small_callback.set(
+    [&received](MessageUniquePtr msg) {received += 10 * msg->int32_value;});
+  copy = small_callback;
+  copy.dispatch_intra_process(make_unique_message(), message_info_);
+  EXPECT_EQ(11, received);
+}
+
+/*
+   A callback taking a batch gets the batches, and single messages as batches of one.
+ */
+TEST_F(TestAnySubscriptionCallback, batch_callback) {
+  std::vector<size_t> batch_sizes;
+  AnySubscriptionCallback batch_callback(allocator_);
+  batch_callback.set(
+    [&batch_sizes](std::vector<std::shared_ptr<const BasicTypes>> msgs) {
+      batch_sizes.push_back(msgs.size());
+    });
+  EXPECT_TRUE(batch_callback.is_batch_callback());
+  EXPECT_TRUE(batch_callback.use_take_shared_method());
+
+  batch_callback.dispatch_batch({message_, message_, message_});
+  batch_callback.dispatch(message_, message_info_);
+  batch_callback.dispatch_intra_process(make_unique_message(), message_info_);
+  EXPECT_EQ(std::vector<size_t>({3, 1, 1}), batch_sizes);
+
+  AnySubscriptionCallback shared_callback(allocator_);
+  shared_callback.set([](std::shared_ptr<BasicTypes>) {});
+  EXPECT_FALSE(shared_callback.is_batch_callback());
+  EXPECT_THROW(shared_callback.dispatch_batch({message_}), std::runtime_error);
+}
+
+/*
+   A callback taking a SubscriptionLoanedMessage can keep the messages it receives.
+ */
+TEST_F(TestAnySubscriptionCallback, loaned_message_callback) {
+  std::vector<rclcpp::SubscriptionLoanedMessage<BasicTypes>> kept;
+  AnySubscriptionCallback loaned_callback(allocator_);
+  loaned_callback.set(
+    [&kept](rclcpp::SubscriptionLoanedMessage<BasicTypes> msg) {kept.push_back(std::move(msg));});
+  EXPECT_TRUE(loaned_callback.is_loaned_message_callback());
+  EXPECT_FALSE(loaned_callback.use_take_shared_method());
+
+  loaned_callback.dispatch(message_, message_info_);
+  auto unique_message = make_unique_message();
+  auto unique_message_ptr = unique_message.get();
+  loaned_callback.dispatch_intra_process(std::move(unique_message), message_info_);
+  loaned_callback.dispatch_loaned(
+    rclcpp::SubscriptionLoanedMessage<BasicTypes>(make_unique_message()), message_info_);
+  ASSERT_EQ(3u, kept.size());
+  for (const auto & msg : kept) {
+    ASSERT_TRUE(msg.is_valid());
+    EXPECT_FALSE(msg.is_loaned());
+    EXPECT_EQ(1, msg->int32_value);
+  }
+  // The message taken from the middleware is copied, the intra-process one is moved.
+  EXPECT_NE(message_.get(), &kept[0].get());
+  EXPECT_EQ(unique_message_ptr, &kept[1].get());
+  kept[0].reset();
+  EXPECT_FALSE(kept[0].is_valid());
+
+  AnySubscriptionCallback shared_callback(allocator_);
+  shared_callback.set([](std::shared_ptr<BasicTypes>) {});
+  EXPECT_FALSE(shared_callback.is_loaned_message_callback());
+  EXPECT_THROW(
+    shared_callback.dispatch_loaned(
+      rclcpp::SubscriptionLoanedMessage<BasicTypes>(make_unique_message()), message_info_),
+    std::runtime_error);
+  EXPECT_THROW(loaned_callback.dispatch_batch({message_}), std::runtime_error);
+}
+
+/*
+   The callbacks taking an rclcpp::MessageInfo receive the timestamps of the message.
+ */
+TEST_F(TestAnySubscriptionCallback, message_info_callback) {
+  rclcpp::MessageInfo message_info(message_info_, 2000);
+  message_info.set_source_timestamp(1500);
+  int64_t latency = 0;
+  AnySubscriptionCallback shared_callback(allocator_);
+  shared_callback.set(
+    [&latency](std::shared_ptr<BasicTypes>, const rclcpp::MessageInfo & info) {
+      latency += info.get_transport_latency().count();
+    });
+  AnySubscriptionCallback unique_callback(allocator_);
+  unique_callback.set(
+    [&latency](MessageUniquePtr, const rclcpp::MessageInfo & info) {
+      latency += info.get_transport_latency().count();
+    });
+  shared_callback.dispatch(message_, message_info);
+  unique_callback.dispatch_intra_process(make_unique_message(), message_info);
+  EXPECT_EQ(1000, latency);
+
+  // The callbacks taking the rmw message info get the info wrapped by the message info.
+  bool from_intra_process = true;
+  AnySubscriptionCallback rmw_info_callback(allocator_);
+  rmw_info_callback.set(
+    [&from_intra_process](std::shared_ptr<BasicTypes>, const rmw_message_info_t & info) {
+      from_intra_process = info.from_intra_process;
+    });
+  rmw_info_callback.dispatch(message_, message_info);
+  EXPECT_FALSE(from_intra_process);
+}
@@ -0,0 +1,181 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include "rclcpp/allocator/arena_allocator.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/strategies/allocator_memory_strategy.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+#include "allocation_counter.hpp"
+
+using rclcpp::allocator::Arena;
+using rclcpp::allocator::ArenaAllocator;
+
+/*
+   Freed blocks are reused by the allocations of the same size class.
+ */
+TEST(TestArena, reuse_blocks) {
+  Arena arena(4096);
+  EXPECT_EQ(4096u, arena.get_capacity());
+
+  void * first = arena.allocate(10);
+  void * second = arena.allocate(10);
+  EXPECT_TRUE(arena.owns(first));
+  EXPECT_NE(first, second);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(first) % alignof(std::max_align_t));
+  EXPECT_EQ(2u, arena.get_block_count());
+  size_t used_size = arena.get_used_size();
+
+  arena.deallocate(first);
+  EXPECT_EQ(1u, arena.get_block_count());
+  EXPECT_EQ(first, arena.allocate(10));
+  EXPECT_EQ(used_size, arena.get_used_size());
+
+  void * large = arena.allocate(1000);
+  EXPECT_TRUE(arena.owns(large));
+  EXPECT_LT(used_size, arena.get_used_size());
+
+  arena.deallocate(large);
+  arena.deallocate(first);
+  arena.deallocate(second);
+  EXPECT_EQ(0u, arena.get_block_count());
+
+  EXPECT_THROW(Arena(0), std::invalid_argument);
+}
+
+/*
+   A used up arena throws std::bad_alloc.
+ */
+TEST(TestArena, used_up) {
+  Arena arena(256);
+  EXPECT_THROW(arena.allocate(256), std::bad_alloc);
+
+  std::vector<void *> blocks;
+  try {
+    while (blocks.size() < 256) {
+      blocks.push_back(arena.allocate(1));
+    }
+  } catch (const std::bad_alloc &) {
+  }
+  EXPECT_FALSE(blocks.empty());
+  EXPECT_LT(blocks.size(), 256u);
+  EXPECT_EQ(arena.get_capacity(), arena.get_used_size());
+  for (auto block : blocks) {
+    arena.deallocate(block);
+  }
+  EXPECT_EQ(0u, arena.get_block_count());
+}
+
+/*
+   Containers using the allocator take their memory from the arena.
+ */
+TEST(TestArenaAllocator, containers) {
+  auto arena = std::make_shared<Arena>(64 * 1024);
+  ArenaAllocator<void> allocator(arena);
+
+  {
+    std::vector<int, ArenaAllocator<int>> values(allocator);
+    for (int i = 0; i < 100; ++i) {
+      values.push_back(i);
+    }
+    EXPECT_TRUE(arena->owns(values.data()));
+    auto shared_value = std::allocate_shared<int>(ArenaAllocator<int>(allocator), 42);
+    EXPECT_TRUE(arena->owns(shared_value.get()));
+    EXPECT_EQ(2u, arena->get_block_count());
+  }
+  EXPECT_EQ(0u, arena->get_block_count());
+  EXPECT_TRUE(allocator == ArenaAllocator<int>(allocator));
+  EXPECT_TRUE(allocator != ArenaAllocator<void>());
+}
+
+class TestArenaAllocatorSpin : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+/*
+   Once warmed up, spinning a single threaded executor to execute a message uses no global
+   operator new, when the executor memory strategy, the publisher, the subscription and its
+   message memory strategy all use the arena.
+   Messages are published intra-process, the memory allocated by rcl and the middleware is
+   not checked.
+ */
+TEST_F(TestArenaAllocatorSpin, no_allocation_when_spinning) {
+  using test_msgs::msg::BasicTypes;
+  using rclcpp::memory_strategies::allocator_memory_strategy::AllocatorMemoryStrategy;
+  using MessageMemoryStrategy =
+    rclcpp::message_memory_strategy::MessageMemoryStrategy<BasicTypes, ArenaAllocator<void>>;
+
+  auto arena = std::make_shared<Arena>(1024 * 1024);
+  auto allocator = std::make_shared<ArenaAllocator<void>>(arena);
+
+  auto node = std::make_shared<rclcpp::Node>(
+    "arena_allocator_node", rclcpp::NodeOptions().use_intra_process_comms(true));
+
+  rclcpp::PublisherOptionsWithAllocator<ArenaAllocator<void>> publisher_options;
+  publisher_options.allocator = allocator;
+  auto publisher = node->create_publisher<BasicTypes>("arena_topic", 10, publisher_options);
+
+  size_t received = 0;
+  rclcpp::SubscriptionOptionsWithAllocator<ArenaAllocator<void>> subscription_options;
+  subscription_options.allocator = allocator;
+  auto subscription = node->create_subscription<BasicTypes>(
+    "arena_topic", 10,
+    [&received](std::shared_ptr<const BasicTypes> msg) {
+      (void)msg;
+      received++;
+    },
+    subscription_options,
+    std::make_shared<MessageMemoryStrategy>(allocator));
+
+  rclcpp::executor::ExecutorArgs args;
+  args.memory_strategy = std::make_shared<AllocatorMemoryStrategy<ArenaAllocator<void>>>(allocator);
+  rclcpp::executors::SingleThreadedExecutor executor(args);
+  executor.add_node(node);
+
+  BasicTypes msg;
+  // Warm up, so that the executor and the entities reach their steady state before counting.
+  for (size_t i = 0; i < 3; ++i) {
+    publisher->publish(msg);
+    executor.spin_some();
+  }
+  ASSERT_EQ(3u, received);
+
+  for (size_t i = 0; i < 5; ++i) {
+    publisher->publish(msg);
+
+    allocation_counter::start();
+    executor.spin_some();
+    EXPECT_EQ(0u, allocation_counter::stop());
+  }
+  EXPECT_EQ(8u, received);
+}
@@ -0,0 +1,134 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/experimental/async_logging.hpp"
+#include "rclcpp/logger.hpp"
+#include "rclcpp/logging.hpp"
+#include "rcutils/logging.h"
+
+std::mutex g_log_mutex;
+std::vector<std::string> g_messages;
+std::vector<std::thread::id> g_thread_ids;
+std::shared_future<void> g_release;
+
+class TestAsyncLogging : public ::testing::Test
+{
+public:
+  rcutils_logging_output_handler_t previous_output_handler;
+  void SetUp()
+  {
+    g_messages.clear();
+    g_thread_ids.clear();
+    std::promise<void> released;
+    released.set_value();
+    g_release = released.get_future().share();
+    ASSERT_EQ(RCUTILS_RET_OK, rcutils_logging_initialize());
+
+    auto output_handler = [](
+      const rcutils_log_location_t *, int, const char *, rcutils_time_point_value_t,
+      const char * format, va_list * args) -> void
+      {
+        g_release.wait();
+        char buffer[1024];
+        vsnprintf(buffer, sizeof(buffer), format, *args);
+        std::lock_guard<std::mutex> lock(g_log_mutex);
+        g_messages.push_back(buffer);
+        g_thread_ids.push_back(std::this_thread::get_id());
+      };
+
+    this->previous_output_handler = rcutils_logging_get_output_handler();
+    rcutils_logging_set_output_handler(output_handler);
+  }
+
+  void TearDown()
+  {
+    rclcpp::experimental::disable_async_logging();
+    rcutils_logging_set_output_handler(this->previous_output_handler);
+    ASSERT_EQ(RCUTILS_RET_OK, rcutils_logging_shutdown());
+  }
+};
+
+TEST_F(TestAsyncLogging, write_from_thread) {
+  rclcpp::experimental::enable_async_logging();
+  EXPECT_TRUE(rclcpp::experimental::is_async_logging_enabled());
+  EXPECT_THROW(rclcpp::experimental::enable_async_logging(), std::runtime_error);
+
+  auto logger = rclcpp::get_logger("async");
+  for (int i = 0; i < 10; ++i) {
+    RCLCPP_INFO(logger, "message %d", i);
+  }
+  rclcpp::experimental::flush_async_logging();
+
+  {
+    std::lock_guard<std::mutex> lock(g_log_mutex);
+    ASSERT_EQ(10u, g_messages.size());
+    for (size_t i = 0; i < g_messages.size(); ++i) {
+      EXPECT_EQ("message " + std::to_string(i), g_messages[i]);
+      EXPECT_NE(std::this_thread::get_id(), g_thread_ids[i]);
+    }
+  }
+  auto statistics = rclcpp::experimental::get_async_logging_statistics();
+  EXPECT_EQ(10u, statistics.written_count);
+  EXPECT_EQ(0u, statistics.dropped_count);
+
+  rclcpp::experimental::disable_async_logging();
+  EXPECT_FALSE(rclcpp::experimental::is_async_logging_enabled());
+  RCLCPP_INFO(logger, "synchronous");
+  std::lock_guard<std::mutex> lock(g_log_mutex);
+  ASSERT_EQ(11u, g_messages.size());
+  EXPECT_EQ(std::this_thread::get_id(), g_thread_ids.back());
+}
+
+TEST_F(TestAsyncLogging, drop_when_full) {
+  std::promise<void> released;
+  g_release = released.get_future().share();
+  rclcpp::experimental::AsyncLoggingOptions options;
+  options.queue_depth = 2;
+  rclcpp::experimental::enable_async_logging(options);
+
+  // The output handler blocks, so at most one record is being written and two are queued.
+  auto logger = rclcpp::get_logger("async");
+  for (int i = 0; i < 10; ++i) {
+    RCLCPP_WARN(logger, "message %d", i);
+  }
+  released.set_value();
+  rclcpp::experimental::flush_async_logging();
+
+  auto statistics = rclcpp::experimental::get_async_logging_statistics();
+  EXPECT_LE(7u, statistics.dropped_count);
+  EXPECT_EQ(10u, statistics.written_count + statistics.dropped_count);
+  EXPECT_LE(statistics.max_queue_depth, 2u);
+}
+
+TEST_F(TestAsyncLogging, truncate_long_message) {
+  rclcpp::experimental::enable_async_logging();
+  RCLCPP_INFO(rclcpp::get_logger("async"), "%s", std::string(2000, 'x').c_str());
+  rclcpp::experimental::flush_async_logging();
+
+  EXPECT_EQ(1u, rclcpp::experimental::get_async_logging_statistics().truncated_count);
+  std::lock_guard<std::mutex> lock(g_log_mutex);
+  ASSERT_EQ(1u, g_messages.size());
+  EXPECT_EQ(1023u, g_messages[0].size());
+}
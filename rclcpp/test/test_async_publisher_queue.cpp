@@ -0,0 +1,128 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/experimental/async_publisher_queue.hpp"
+#include "rclcpp/experimental/lock_free_bounded_queue.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+using rclcpp::experimental::AsyncPublisherQueue;
+using rclcpp::experimental::LockFreeBoundedQueue;
+
+/*
+   Elements are popped in order, and pushing to a full queue fails.
+ */
+TEST(TestLockFreeBoundedQueue, push_and_pop) {
+  LockFreeBoundedQueue<int> queue(3);
+  EXPECT_EQ(4u, queue.capacity());
+
+  int element = 0;
+  EXPECT_FALSE(queue.try_pop(element));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.try_push(static_cast<int>(i)));
+  }
+  EXPECT_FALSE(queue.try_push(4));
+  EXPECT_EQ(4u, queue.size());
+
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.try_pop(element));
+    EXPECT_EQ(i, element);
+  }
+  EXPECT_FALSE(queue.try_pop(element));
+  EXPECT_EQ(0u, queue.size());
+
+  EXPECT_THROW(LockFreeBoundedQueue<int>(0), std::invalid_argument);
+}
+
+/*
+   Every element pushed by several producers is popped once by several consumers.
+ */
+TEST(TestLockFreeBoundedQueue, producers_and_consumers) {
+  LockFreeBoundedQueue<size_t> queue(64);
+  const size_t producer_count = 4;
+  const size_t element_count = 10000;
+  std::vector<std::atomic<size_t>> pop_counts(producer_count * element_count);
+
+  std::vector<std::thread> threads;
+  for (size_t producer = 0; producer < producer_count; ++producer) {
+    threads.emplace_back(
+      [&queue, producer, element_count]() {
+        for (size_t i = 0; i < element_count; ++i) {
+          size_t element = producer * element_count + i;
+          while (!queue.try_push(std::move(element))) {
+            std::this_thread::yield();
+          }
+        }
+      });
+  }
+  std::atomic<size_t> popped(0);
+  for (size_t consumer = 0; consumer < 2; ++consumer) {
+    threads.emplace_back(
+      [&queue, &pop_counts, &popped]() {
+        size_t element;
+        while (popped.load() < pop_counts.size()) {
+          if (queue.try_pop(element)) {
+            pop_counts[element]++;
+            popped++;
+          } else {
+            std::this_thread::yield();
+          }
+        }
+      });
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  for (auto & pop_count : pop_counts) {
+    EXPECT_EQ(1u, pop_count.load());
+  }
+}
+
+/*
+   A full queue drops the new message or the oldest one, depending on the overflow policy.
+   Messages are left queued while the publisher can't be locked.
+ */
+TEST(TestAsyncPublisherQueue, overflow_policies) {
+  using test_msgs::msg::BasicTypes;
+  rclcpp::AsyncPublishOptions options;
+  options.queue_depth = 2;
+  AsyncPublisherQueue<BasicTypes> drop_newest({}, options);
+  options.overflow_policy = rclcpp::AsyncPublishOverflowPolicy::DropOldest;
+  AsyncPublisherQueue<BasicTypes> drop_oldest({}, options);
+
+  for (size_t i = 0; i < 3; ++i) {
+    auto msg = std::make_shared<BasicTypes>();
+    EXPECT_EQ(i < 2, drop_newest.enqueue(msg));
+    EXPECT_TRUE(drop_oldest.enqueue(msg));
+  }
+  drop_newest.publish_queued();
+
+  auto statistics = drop_newest.get_statistics();
+  EXPECT_EQ(2u, statistics.queue_depth);
+  EXPECT_EQ(2u, statistics.max_queue_depth);
+  EXPECT_EQ(1u, statistics.dropped_count);
+  EXPECT_EQ(0u, statistics.published_count);
+
+  statistics = drop_oldest.get_statistics();
+  EXPECT_EQ(2u, statistics.queue_depth);
+  EXPECT_EQ(1u, statistics.dropped_count);
+}
@@ -0,0 +1,104 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rclcpp/experimental/buffers/broadcast_ring_buffer.hpp"
+
+using rclcpp::experimental::buffers::BroadcastRingBuffer;
+
+namespace
+{
+
+int
+value(const std::shared_ptr<const void> & message)
+{
+  return *std::static_pointer_cast<const int>(message);
+}
+
+}  // namespace
+
+/*
+   Constructor
+ */
+TEST(TestBroadcastRingBuffer, constructor) {
+  EXPECT_THROW(BroadcastRingBuffer ring(0), std::invalid_argument);
+
+  BroadcastRingBuffer ring(3);
+  EXPECT_EQ(3u, ring.capacity());
+  EXPECT_EQ(0u, ring.get_write_sequence());
+}
+
+/*
+   Readers
+   - two readers with their own cursor get the same messages, without copy
+   - a reader reading less than the available messages reads the rest later
+ */
+TEST(TestBroadcastRingBuffer, readers) {
+  BroadcastRingBuffer ring(4);
+  auto message = std::make_shared<const int>(1);
+  ring.write(message);
+  ring.write(std::make_shared<const int>(2));
+  EXPECT_EQ(2u, ring.get_write_sequence());
+
+  uint64_t cursor_1 = 0;
+  uint64_t cursor_2 = 0;
+  std::vector<std::shared_ptr<const void>> messages_1;
+  std::vector<std::shared_ptr<const void>> messages_2;
+  EXPECT_EQ(0u, ring.read(cursor_1, 4, messages_1, 10));
+  EXPECT_EQ(0u, ring.read(cursor_2, 4, messages_2, 1));
+  ASSERT_EQ(2u, messages_1.size());
+  ASSERT_EQ(1u, messages_2.size());
+  EXPECT_EQ(message.get(), messages_1[0].get());
+  EXPECT_EQ(message.get(), messages_2[0].get());
+  EXPECT_EQ(2, value(messages_1[1]));
+  EXPECT_EQ(2u, cursor_1);
+  EXPECT_EQ(1u, cursor_2);
+
+  EXPECT_EQ(0u, ring.read(cursor_2, 4, messages_2, 10));
+  ASSERT_EQ(2u, messages_2.size());
+  EXPECT_EQ(2, value(messages_2[1]));
+  EXPECT_EQ(0u, ring.read(cursor_1, 4, messages_1, 10));
+  EXPECT_EQ(2u, messages_1.size());
+}
+
+/*
+   Falling behind
+   - a reader keeps the last messages up to its depth, the older ones are skipped
+   - the depth is bounded by the capacity of the ring
+ */
+TEST(TestBroadcastRingBuffer, skip_oldest) {
+  BroadcastRingBuffer ring(3);
+  for (int i = 0; i < 5; ++i) {
+    ring.write(std::make_shared<const int>(i));
+  }
+
+  uint64_t cursor = 0;
+  std::vector<std::shared_ptr<const void>> messages;
+  EXPECT_EQ(3u, ring.read(cursor, 2, messages, 10));
+  ASSERT_EQ(2u, messages.size());
+  EXPECT_EQ(3, value(messages[0]));
+  EXPECT_EQ(4, value(messages[1]));
+
+  cursor = 0;
+  messages.clear();
+  EXPECT_EQ(2u, ring.read(cursor, 10, messages, 10));
+  ASSERT_EQ(3u, messages.size());
+  EXPECT_EQ(2, value(messages[0]));
+  EXPECT_EQ(5u, cursor);
+}
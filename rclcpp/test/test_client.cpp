@@ -14,14 +14,19 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <string>
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/rclcpp.hpp"
 
 #include "rcl_interfaces/srv/list_parameters.hpp"
 
+using namespace std::chrono_literals;
+
 class TestClient : public ::testing::Test
 {
 protected:
@@ -123,3 +128,128 @@ TEST_F(TestClientSub, construction_and_destruction) {
     }, rclcpp::exceptions::InvalidServiceNameError);
   }
 }
+
+/*
+   Testing requests sent with a response callback only, and the reserved pending requests.
+ */
+TEST_F(TestClient, response_callback) {
+  using rcl_interfaces::srv::ListParameters;
+  auto service = node->create_service<ListParameters>(
+    "service",
+    [](
+      const ListParameters::Request::SharedPtr,
+      ListParameters::Response::SharedPtr response) {
+      response->result.names.push_back("answer");
+    });
+  auto client = node->create_client<ListParameters>("service");
+  ASSERT_TRUE(client->wait_for_service(5s));
+  client->reserve_pending_requests(4);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  size_t responses = 0;
+  for (size_t i = 0; i < 3; ++i) {
+    client->async_send_request(
+      std::make_shared<ListParameters::Request>(),
+      [&responses](ListParameters::Response::SharedPtr response) {
+        ASSERT_EQ(1u, response->result.names.size());
+        EXPECT_EQ("answer", response->result.names[0]);
+        ++responses;
+      });
+  }
+  auto future = client->async_send_request(std::make_shared<ListParameters::Request>());
+  EXPECT_EQ(4u, client->get_number_of_pending_requests());
+  ASSERT_EQ(
+    rclcpp::executor::FutureReturnCode::SUCCESS,
+    executor.spin_until_future_complete(future, 5s));
+  auto start = std::chrono::steady_clock::now();
+  while (responses < 3 && std::chrono::steady_clock::now() - start < 5s) {
+    executor.spin_once(10ms);
+  }
+  EXPECT_EQ(3u, responses);
+  EXPECT_EQ(0u, client->get_number_of_pending_requests());
+
+  int64_t sequence_number = client->async_send_request(
+    std::make_shared<ListParameters::Request>(),
+    [](ListParameters::Response::SharedPtr) {});
+  EXPECT_TRUE(client->remove_pending_request(sequence_number));
+  EXPECT_FALSE(client->remove_pending_request(sequence_number));
+  EXPECT_EQ(0u, client->get_number_of_pending_requests());
+}
+
+/*
+   Testing requests which get no response before their timeout.
+ */
+TEST_F(TestClient, request_timeout) {
+  using rcl_interfaces::srv::ListParameters;
+  // No service answers the requests.
+  auto client = node->create_client<ListParameters>("unanswered_service");
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  bool callback_called = false;
+  auto future = client->async_send_request(
+    std::make_shared<ListParameters::Request>(),
+    [&callback_called](rclcpp::Client<ListParameters>::SharedFuture) {
+      callback_called = true;
+    },
+    50ms);
+  client->async_send_request(
+    std::make_shared<ListParameters::Request>(),
+    [](ListParameters::Response::SharedPtr) {
+      ADD_FAILURE() << "the request should have timed out";
+    },
+    50ms);
+  client->async_send_request(std::make_shared<ListParameters::Request>());
+  EXPECT_EQ(3u, client->get_number_of_pending_requests());
+
+  ASSERT_EQ(
+    rclcpp::executor::FutureReturnCode::SUCCESS,
+    executor.spin_until_future_complete(future, 5s));
+  EXPECT_THROW(future.get(), rclcpp::exceptions::RequestTimeoutError);
+  EXPECT_TRUE(callback_called);
+  auto start = std::chrono::steady_clock::now();
+  while (client->get_number_of_expired_requests() < 2 &&
+    std::chrono::steady_clock::now() - start < 5s)
+  {
+    executor.spin_once(10ms);
+  }
+  EXPECT_EQ(2u, client->get_number_of_expired_requests());
+  // The request without a timeout is still pending.
+  EXPECT_EQ(1u, client->get_number_of_pending_requests());
+}
+
+/*
+   Testing clients waiting for a service which is created later.
+ */
+TEST_F(TestClient, wait_for_service_created_later) {
+  using rcl_interfaces::srv::ListParameters;
+  std::vector<rclcpp::Client<ListParameters>::SharedPtr> clients;
+  for (size_t i = 0; i < 5; ++i) {
+    clients.push_back(node->create_client<ListParameters>("late_service"));
+  }
+  auto other_client = node->create_client<ListParameters>("other_service");
+  EXPECT_FALSE(other_client->wait_for_service(0s));
+
+  std::vector<std::thread> threads;
+  std::vector<int> ready(clients.size(), 0);
+  for (size_t i = 0; i < clients.size(); ++i) {
+    threads.emplace_back(
+      [&clients, &ready, i]() {
+        ready[i] = clients[i]->wait_for_service(10s);
+      });
+  }
+  std::this_thread::sleep_for(100ms);
+  auto service = node->create_service<ListParameters>(
+    "late_service",
+    [](
+      const ListParameters::Request::SharedPtr,
+      ListParameters::Response::SharedPtr) {});
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  for (size_t i = 0; i < clients.size(); ++i) {
+    EXPECT_TRUE(ready[i]);
+  }
+  EXPECT_FALSE(other_client->wait_for_service(100ms));
+}
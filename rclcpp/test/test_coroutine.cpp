@@ -0,0 +1,147 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "rclcpp/coroutine.hpp"
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "rcl_interfaces/srv/list_parameters.hpp"
+
+// The coroutines need C++20.
+#ifdef RCLCPP_HAS_COROUTINES
+
+using namespace std::chrono_literals;
+using rcl_interfaces::srv::ListParameters;
+
+class TestCoroutine : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+
+  void SetUp()
+  {
+    node = std::make_shared<rclcpp::Node>("test_coroutine_node");
+    service = node->create_service<ListParameters>(
+      "service",
+      [](
+        const ListParameters::Request::SharedPtr request,
+        ListParameters::Response::SharedPtr response) {
+        response->result.names = request->prefixes;
+      });
+    client = node->create_client<ListParameters>("service");
+    ASSERT_TRUE(client->wait_for_service(5s));
+    executor.add_node(node);
+  }
+
+  template<typename T>
+  bool
+  spin_until_done(const rclcpp::Task<T> & task)
+  {
+    auto start = std::chrono::steady_clock::now();
+    while (!task.done() && std::chrono::steady_clock::now() - start < 5s) {
+      executor.spin_once(10ms);
+    }
+    return task.done();
+  }
+
+  rclcpp::Node::SharedPtr node;
+  rclcpp::Service<ListParameters>::SharedPtr service;
+  rclcpp::Client<ListParameters>::SharedPtr client;
+  rclcpp::executors::SingleThreadedExecutor executor;
+};
+
+rclcpp::Task<std::string>
+echo(rclcpp::Client<ListParameters>::SharedPtr client, std::string name)
+{
+  auto request = std::make_shared<ListParameters::Request>();
+  request->prefixes.push_back(name);
+  auto response = co_await rclcpp::await_response(client, request);
+  co_return response->result.names.at(0);
+}
+
+rclcpp::Task<std::string>
+echo_twice(
+  rclcpp::Node::SharedPtr node, rclcpp::Client<ListParameters>::SharedPtr client,
+  std::chrono::nanoseconds sleep)
+{
+  std::string first = co_await echo(client, "first");
+  co_await rclcpp::await_sleep_for(node, sleep);
+  std::string second = co_await echo(client, "second");
+  co_return first + " " + second;
+}
+
+rclcpp::Task<>
+time_out(rclcpp::Client<ListParameters>::SharedPtr client)
+{
+  co_await rclcpp::await_response(client, std::make_shared<ListParameters::Request>(), 50ms);
+}
+
+/*
+   Testing coroutines resumed by the executor with responses and timers.
+ */
+TEST_F(TestCoroutine, await_response_and_sleep) {
+  auto start = std::chrono::steady_clock::now();
+  auto task = echo_twice(node, client, 100ms);
+  // The coroutine is suspended until the executor spins.
+  EXPECT_FALSE(task.done());
+  EXPECT_THROW(task.get(), std::logic_error);
+  ASSERT_TRUE(spin_until_done(task));
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 100ms);
+  EXPECT_EQ("first second", task.get());
+}
+
+/*
+   Testing the exceptions thrown in a coroutine, e.g. a request timing out.
+ */
+TEST_F(TestCoroutine, request_timeout) {
+  auto unanswered_client = node->create_client<ListParameters>("unanswered_service");
+  auto task = time_out(unanswered_client);
+  ASSERT_TRUE(spin_until_done(task));
+  EXPECT_THROW(task.get(), rclcpp::exceptions::RequestTimeoutError);
+}
+
+/*
+   Testing coroutines left running after their task is dropped.
+ */
+TEST_F(TestCoroutine, dropped_task) {
+  std::string result;
+  auto run = [](
+    rclcpp::Node::SharedPtr node, rclcpp::Client<ListParameters>::SharedPtr client,
+    std::string & result) -> rclcpp::Task<> {
+      result = co_await echo_twice(node, client, 0ms);
+    };
+  run(node, client, result);
+  auto start = std::chrono::steady_clock::now();
+  while (result.empty() && std::chrono::steady_clock::now() - start < 5s) {
+    executor.spin_once(10ms);
+  }
+  EXPECT_EQ("first second", result);
+}
+
+#endif  // RCLCPP_HAS_COROUTINES
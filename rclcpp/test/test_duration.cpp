@@ -97,6 +97,11 @@ TEST(TestDuration, overflows) {
   EXPECT_THROW(min - one, std::underflow_error);
   EXPECT_THROW(negative_one + min, std::underflow_error);
   EXPECT_THROW(negative_one - max, std::underflow_error);
+  EXPECT_THROW(min + negative_one, std::underflow_error);
+  EXPECT_THROW(max - negative_one, std::overflow_error);
+  EXPECT_THROW(one - min, std::overflow_error);
+  EXPECT_EQ(negative_one, min + max);
+  EXPECT_EQ(negative_one, negative_one - (max - max));
 
   rclcpp::Duration base_d = max * 0.3;
   EXPECT_THROW(base_d * 4, std::overflow_error);
@@ -0,0 +1,128 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "rclcpp/entity_capacities.hpp"
+#include "rclcpp/exceptions.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+std::string
+write_file(const std::string & name, const std::string & content)
+{
+  const std::string path = ::testing::TempDir() + name;
+  std::ofstream file(path);
+  file << content;
+  return path;
+}
+
+}  // namespace
+
+TEST(TestEntityCapacities, load) {
+  const std::string path = write_file(
+    "entity_capacities.yaml",
+    "# Static description\n"
+    "nodes: 2\n"
+    "\n"
+    "  publishers : 8\n"
+    "subscriptions: 16\n"
+    "timers: 4\n");
+  auto capacities = rclcpp::load_entity_capacities(path);
+  std::remove(path.c_str());
+  EXPECT_EQ(2u, capacities.nodes);
+  EXPECT_EQ(8u, capacities.publishers);
+  EXPECT_EQ(16u, capacities.subscriptions);
+  EXPECT_EQ(4u, capacities.timers);
+  EXPECT_EQ(0u, capacities.services);
+  EXPECT_FALSE(capacities.empty());
+  EXPECT_TRUE(rclcpp::EntityCapacities().empty());
+
+  for (const char * content : {"publishers 8\n", "actions: 2\n", "timers: -1\n", "timers: 4x\n"}) {
+    const std::string invalid_path = write_file("invalid_entity_capacities.yaml", content);
+    EXPECT_THROW(rclcpp::load_entity_capacities(invalid_path), std::runtime_error) << content;
+    std::remove(invalid_path.c_str());
+  }
+  EXPECT_THROW(
+    rclcpp::load_entity_capacities(::testing::TempDir() + "missing_capacities.yaml"),
+    std::runtime_error);
+}
+
+/*
+   The executors of a preallocated context work, and the entities are refused once locked
+ */
+TEST(TestEntityCapacities, preallocate_and_lock) {
+  rclcpp::InitOptions init_options;
+  init_options.entity_capacities.nodes = 1;
+  init_options.entity_capacities.publishers = 4;
+  init_options.entity_capacities.subscriptions = 8;
+  init_options.entity_capacities.timers = 2;
+  init_options.entity_capacities.services = 8;
+  init_options.entity_capacities.waitables = 4;
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr, init_options);
+
+  auto node = std::make_shared<rclcpp::Node>(
+    "entity_capacities_node", rclcpp::NodeOptions().context(context));
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("capacities", 10);
+  size_t received = 0;
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "capacities", 10, [&received](test_msgs::msg::Empty::SharedPtr) {received++;});
+  size_t fired = 0;
+  auto timer = node->create_wall_timer(1ms, [&fired]() {fired++;});
+
+  context->lock_entity_creation();
+  EXPECT_TRUE(context->is_entity_creation_locked());
+  EXPECT_THROW(
+    node->create_publisher<test_msgs::msg::Empty>("refused", 10),
+    rclcpp::exceptions::EntityCreationLockedError);
+  EXPECT_THROW(
+    node->create_wall_timer(1ms, []() {}), rclcpp::exceptions::EntityCreationLockedError);
+  EXPECT_THROW(
+    std::make_shared<rclcpp::Node>("refused_node", rclcpp::NodeOptions().context(context)),
+    rclcpp::exceptions::EntityCreationLockedError);
+
+  rclcpp::executor::ExecutorArgs args;
+  args.context = context;
+  rclcpp::executors::SingleThreadedExecutor executor(args);
+  executor.add_node(node);
+  auto start = std::chrono::steady_clock::now();
+  while ((0u == received || fired < 3) && std::chrono::steady_clock::now() - start < 5s) {
+    publisher->publish(test_msgs::msg::Empty());
+    executor.spin_some();
+    std::this_thread::sleep_for(1ms);
+  }
+  EXPECT_LT(0u, received);
+  EXPECT_LE(3u, fired);
+  executor.remove_node(node);
+
+  // The entities can still be destroyed.
+  timer.reset();
+  subscription.reset();
+  rclcpp::shutdown(context);
+}
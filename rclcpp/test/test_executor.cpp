@@ -16,14 +16,21 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdio>
+#include <future>
 #include <limits>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "rcl/error_handling.h"
 #include "rcl/time.h"
 #include "rclcpp/clock.hpp"
+#include "rclcpp/create_cpu_time_report_timer.hpp"
 #include "rclcpp/duration.hpp"
+#include "rclcpp/executor_schedule.hpp"
 #include "rclcpp/rclcpp.hpp"
 
 using namespace std::chrono_literals;
@@ -67,3 +74,389 @@ TEST_F(TestExecutors, addTemporaryNode) {
   executor.add_node(std::make_shared<rclcpp::Node>("temporary_node"));
   EXPECT_NO_THROW(executor.spin_some());
 }
+
+// Make sure that a future completed from another thread wakes up spin_until_future_complete
+TEST_F(TestExecutors, spinUntilFutureCompleteWakesUp) {
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  std::promise<bool> promise;
+  std::shared_future<bool> future(promise.get_future());
+  std::thread completer([&promise]() {
+      std::this_thread::sleep_for(50ms);
+      promise.set_value(true);
+      rclcpp::executor::notify_future_waiters();
+    });
+
+  auto start = std::chrono::steady_clock::now();
+  auto ret = executor.spin_until_future_complete(future, 10s);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  completer.join();
+  EXPECT_EQ(rclcpp::executor::FutureReturnCode::SUCCESS, ret);
+  EXPECT_LT(elapsed, 5s);
+}
+
+TEST_F(TestExecutors, spinUntilAllAndAnyComplete) {
+  using rclcpp::executor::FutureReturnCode;
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  std::vector<std::promise<int>> promises(3);
+  std::vector<std::shared_future<int>> futures;
+  for (auto & promise : promises) {
+    futures.push_back(promise.get_future().share());
+  }
+  EXPECT_EQ(FutureReturnCode::TIMEOUT, executor.spin_until_any_complete(futures, 0ms));
+
+  std::thread completer([&promises]() {
+      for (size_t i = promises.size(); i-- > 0; ) {
+        std::this_thread::sleep_for(20ms);
+        promises[i].set_value(static_cast<int>(i));
+        rclcpp::executor::notify_future_waiters();
+      }
+    });
+  size_t completed_index = futures.size();
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(
+    FutureReturnCode::SUCCESS, executor.spin_until_any_complete(futures, 10s, &completed_index));
+  EXPECT_EQ(2u, completed_index);
+  EXPECT_EQ(FutureReturnCode::SUCCESS, executor.spin_until_all_complete(futures, 10s));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+  completer.join();
+  for (size_t i = 0; i < futures.size(); ++i) {
+    EXPECT_EQ(static_cast<int>(i), futures[i].get());
+  }
+
+  EXPECT_EQ(
+    FutureReturnCode::SUCCESS,
+    executor.spin_until_all_complete(std::vector<std::shared_future<int>>(), 0ms));
+  EXPECT_THROW(
+    executor.spin_until_any_complete(std::vector<std::shared_future<int>>()),
+    std::invalid_argument);
+}
+
+class IndexedExecutor : public rclcpp::executors::SingleThreadedExecutor
+{
+public:
+  using rclcpp::executors::SingleThreadedExecutor::get_group_by_timer;
+  using rclcpp::executors::SingleThreadedExecutor::get_node_by_group;
+};
+
+// Make sure that the group and timer lookups follow the nodes being added and removed
+TEST_F(TestExecutors, groupAndTimerLookup) {
+  IndexedExecutor executor;
+  auto node_base = node->get_node_base_interface();
+  auto group = node->create_callback_group(rclcpp::callback_group::CallbackGroupType::Reentrant);
+  executor.add_node(node);
+  EXPECT_EQ(node_base, executor.get_node_by_group(group));
+
+  // Created after the node was added
+  auto late_group =
+    node->create_callback_group(rclcpp::callback_group::CallbackGroupType::MutuallyExclusive);
+  auto timer = node->create_wall_timer(1s, []() {}, late_group);
+  EXPECT_EQ(node_base, executor.get_node_by_group(late_group));
+  EXPECT_EQ(late_group, executor.get_group_by_timer(timer));
+  EXPECT_EQ(late_group, executor.get_group_by_timer(timer));
+
+  executor.remove_node(node);
+  EXPECT_EQ(nullptr, executor.get_node_by_group(group));
+  EXPECT_EQ(nullptr, executor.get_group_by_timer(timer));
+}
+
+// Make sure that the memory strategy hands out the group and node of the collected entities
+TEST_F(TestExecutors, memoryStrategyIndex) {
+  auto memory_strategy = rclcpp::memory_strategies::create_default_strategy();
+  rclcpp::memory_strategy::MemoryStrategy::WeakNodeList weak_nodes;
+  weak_nodes.push_back(node->get_node_base_interface());
+  auto group = node->create_callback_group(rclcpp::callback_group::CallbackGroupType::Reentrant);
+  auto timer = node->create_wall_timer(1s, []() {}, group);
+
+  for (int i = 0; i < 2; ++i) {
+    memory_strategy->clear_handles();
+    memory_strategy->collect_entities(weak_nodes);
+    rclcpp::executor::AnyExecutable any_exec;
+    memory_strategy->get_next_timer(any_exec, weak_nodes);
+    EXPECT_EQ(timer, any_exec.timer);
+    EXPECT_EQ(group, any_exec.callback_group);
+    EXPECT_EQ(node->get_node_base_interface(), any_exec.node_base);
+  }
+
+  // A timer destroyed after the collection is not handed out
+  memory_strategy->clear_handles();
+  memory_strategy->collect_entities(weak_nodes);
+  timer.reset();
+  rclcpp::executor::AnyExecutable any_exec;
+  memory_strategy->get_next_timer(any_exec, weak_nodes);
+  EXPECT_EQ(nullptr, any_exec.timer);
+}
+
+// Make sure that the instrumentation records the phases and the callbacks
+TEST_F(TestExecutors, instrumentation) {
+  auto instrumentation = std::make_shared<rclcpp::executor::ExecutorInstrumentation>();
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.set_instrumentation(instrumentation);
+  EXPECT_EQ(instrumentation, executor.get_instrumentation());
+
+  size_t count = 0;
+  auto timer = node->create_wall_timer(1ms, [&count]() {count++;});
+  executor.add_node(node);
+  while (count < 3) {
+    executor.spin_once(100ms);
+  }
+
+  using rclcpp::executor::ExecutorPhase;
+  EXPECT_GT(instrumentation->get_phase_histogram(ExecutorPhase::Wait).count(), 0u);
+  EXPECT_GT(instrumentation->get_phase_histogram(ExecutorPhase::Collect).count(), 0u);
+  EXPECT_GE(instrumentation->get_phase_histogram(ExecutorPhase::Execute).count(), 3u);
+  auto histograms = instrumentation->get_execution_histograms();
+  ASSERT_EQ(1u, histograms.size());
+  EXPECT_EQ(0u, histograms[0].name.find("timer "));
+  EXPECT_EQ(count, histograms[0].histogram.count());
+  EXPECT_FALSE(instrumentation->to_string().empty());
+
+  instrumentation->reset();
+  EXPECT_EQ(0u, instrumentation->get_phase_histogram(ExecutorPhase::Wait).count());
+  EXPECT_TRUE(instrumentation->get_execution_histograms().empty());
+}
+
+TEST_F(TestExecutors, cpuTimeMeasurement) {
+  auto instrumentation = std::make_shared<rclcpp::executor::ExecutorInstrumentation>();
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.set_instrumentation(instrumentation);
+
+  size_t count = 0;
+  auto busy = [&count]() {
+      auto start = std::chrono::steady_clock::now();
+      while (std::chrono::steady_clock::now() - start < 1ms) {
+      }
+      count++;
+    };
+  auto timer = node->create_wall_timer(1ms, busy);
+  executor.add_node(node);
+  executor.spin_once(100ms);
+  // Not measured by default.
+  auto group = node->get_node_base_interface()->get_default_callback_group();
+  EXPECT_EQ(0ms, group->get_cpu_time());
+  EXPECT_TRUE(instrumentation->get_cpu_time_histograms().empty());
+
+  executor.set_callback_group_cpu_time_measurement(true);
+  count = 0;
+  while (count < 3) {
+    executor.spin_once(100ms);
+  }
+  auto group_cpu_time = group->get_cpu_time();
+  EXPECT_GT(group_cpu_time, 0ms);
+  auto histograms = instrumentation->get_cpu_time_histograms();
+  ASSERT_EQ(1u, histograms.size());
+  EXPECT_EQ(0u, histograms[0].name.find("timer "));
+  EXPECT_EQ(count, histograms[0].histogram.count());
+  EXPECT_EQ(group_cpu_time, histograms[0].histogram.total());
+  EXPECT_NE(std::string::npos, instrumentation->to_string().find("cpu time timer "));
+
+  auto report_timer = rclcpp::create_cpu_time_report_timer(node, 1ms, instrumentation);
+  ASSERT_NE(nullptr, report_timer);
+  std::this_thread::sleep_for(5ms);
+  EXPECT_NO_THROW(executor.spin_some());
+  report_timer->cancel();
+}
+
+// Make sure that the schedule of an executor is captured, saved and replayed
+TEST_F(TestExecutors, scheduleCaptureAndReplay) {
+  using rclcpp::executor::ScheduleEvent;
+  auto recorder = std::make_shared<rclcpp::executor::ScheduleRecorder>();
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.set_instrumentation(recorder);
+
+  size_t count = 0;
+  auto timer = node->create_wall_timer(1ms, [&count]() {count++;});
+  executor.add_node(node);
+  while (count < 3) {
+    executor.spin_once(100ms);
+  }
+  // The recorder still records the histograms
+  ASSERT_EQ(1u, recorder->get_execution_histograms().size());
+
+  auto trace = recorder->get_trace();
+  ASSERT_EQ(1u, trace.entities.size());
+  EXPECT_EQ(0u, trace.entities[0].find("timer "));
+  size_t executions = 0;
+  size_t waits = 0;
+  for (size_t i = 0; i < trace.events.size(); ++i) {
+    const auto & event = trace.events[i];
+    EXPECT_EQ(0u, event.thread);
+    if (i > 0) {
+      EXPECT_LE(trace.events[i - 1].start, event.start);
+    }
+    if (event.entity == ScheduleEvent::wait_entity) {
+      waits++;
+    } else {
+      executions++;
+    }
+  }
+  EXPECT_EQ(count, executions);
+  EXPECT_LE(count, waits);
+
+  const std::string path = ::testing::TempDir() + "schedule_trace.bin";
+  trace.save(path);
+  auto loaded = rclcpp::executor::ScheduleTrace::load(path);
+  std::remove(path.c_str());
+  EXPECT_EQ(trace.entities, loaded.entities);
+  ASSERT_EQ(trace.events.size(), loaded.events.size());
+  EXPECT_EQ(trace.events.back().start, loaded.events.back().start);
+  EXPECT_THROW(rclcpp::executor::ScheduleTrace::load(path), std::runtime_error);
+
+  rclcpp::executor::ScheduleReplayer replayer(loaded);
+  EXPECT_THROW(replayer.bind("timer unknown", []() {}), std::invalid_argument);
+  size_t replayed_count = 0;
+  replayer.bind(loaded.entities[0], [&replayed_count]() {replayed_count++;});
+  auto replayed = replayer.replay(true);
+  EXPECT_EQ(executions, replayed_count);
+  EXPECT_EQ(executions, replayed.events.size());
+  EXPECT_EQ(executions, replayed.get_execution_histograms()[0].histogram.count());
+  // Kept timing, the events start no earlier than captured
+  for (size_t i = 0, j = 0; i < loaded.events.size(); ++i) {
+    if (loaded.events[i].entity != ScheduleEvent::wait_entity) {
+      EXPECT_LE(loaded.events[i].start, replayed.events[j++].start);
+    }
+  }
+
+  // Only the last events are kept
+  auto small_recorder = std::make_shared<rclcpp::executor::ScheduleRecorder>(2);
+  for (int i = 0; i < 5; ++i) {
+    small_recorder->record_execution(&count, "timer", nullptr, std::chrono::nanoseconds(i));
+  }
+  EXPECT_EQ(3u, small_recorder->get_overwritten_count());
+  auto small_trace = small_recorder->get_trace();
+  ASSERT_EQ(2u, small_trace.events.size());
+  EXPECT_EQ(7u, small_trace.events[0].duration + small_trace.events[1].duration);
+  EXPECT_THROW(rclcpp::executor::ScheduleRecorder(0), std::invalid_argument);
+}
+
+// Make sure that busy polling finds the work, and is reported apart from the blocking waits
+TEST_F(TestExecutors, busyPoll) {
+  using rclcpp::executor::ExecutorPhase;
+  for (auto busy_poll_duration : {std::chrono::nanoseconds(-1), std::chrono::nanoseconds(2ms)}) {
+    auto instrumentation = std::make_shared<rclcpp::executor::ExecutorInstrumentation>();
+    rclcpp::executor::ExecutorArgs args;
+    args.busy_poll_duration = busy_poll_duration;
+    args.busy_poll_pause = true;
+    rclcpp::executors::SingleThreadedExecutor executor(args);
+    executor.set_instrumentation(instrumentation);
+
+    size_t count = 0;
+    auto timer = node->create_wall_timer(5ms, [&count]() {count++;});
+    executor.add_node(node);
+    while (count < 3) {
+      executor.spin_once(100ms);
+    }
+    executor.remove_node(node);
+
+    auto poll = instrumentation->get_phase_histogram(ExecutorPhase::Poll);
+    EXPECT_GT(poll.count(), 0u);
+    EXPECT_GT(poll.total().count(), 0);
+    auto wait = instrumentation->get_phase_histogram(ExecutorPhase::Wait);
+    if (busy_poll_duration < std::chrono::nanoseconds::zero()) {
+      // Never blocks.
+      EXPECT_EQ(0u, wait.count());
+    } else {
+      // Polls for 2ms, then blocks until the timer is ready.
+      EXPECT_GT(wait.count(), 0u);
+    }
+  }
+}
+
+// The timeout of spin_once() bounds the polling
+TEST_F(TestExecutors, busyPollTimeout) {
+  rclcpp::executor::ExecutorArgs args;
+  args.busy_poll_duration = std::chrono::nanoseconds(-1);
+  rclcpp::executors::SingleThreadedExecutor executor(args);
+  executor.add_node(node);
+  auto start = std::chrono::steady_clock::now();
+  executor.spin_once(10ms);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 10ms);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+}
+
+// Deferred calls run once in deadline order, without a timer in the node
+TEST_F(TestExecutors, callLater) {
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  auto group = node->get_node_base_interface()->get_default_callback_group();
+
+  std::vector<int> calls;
+  executor.call_later(20ms, [&calls]() {calls.push_back(2);}, group);
+  executor.call_later(5ms, [&calls]() {calls.push_back(1);}, group);
+  uint64_t canceled = executor.call_later(10ms, [&calls]() {calls.push_back(3);}, group);
+  EXPECT_TRUE(executor.cancel_call(canceled));
+  EXPECT_FALSE(executor.cancel_call(canceled));
+  EXPECT_THROW(executor.call_later(0ms, nullptr, group), std::invalid_argument);
+  EXPECT_THROW(executor.call_later(0ms, []() {}, nullptr), std::invalid_argument);
+
+  auto start = std::chrono::steady_clock::now();
+  while (calls.size() < 2 && std::chrono::steady_clock::now() - start < 5s) {
+    executor.spin_once(1s);
+  }
+  EXPECT_EQ((std::vector<int>{1, 2}), calls);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+
+  // Canceling a call which ran fails.
+  uint64_t handle = executor.call_later(0ms, [&calls]() {calls.push_back(4);}, group);
+  executor.spin_some();
+  EXPECT_EQ(4, calls.back());
+  EXPECT_FALSE(executor.cancel_call(handle));
+  executor.remove_node(node);
+}
+
+TEST(TestLatencyHistogram, record) {
+  rclcpp::executor::LatencyHistogram histogram;
+  EXPECT_EQ(0u, histogram.count());
+  EXPECT_EQ(0, histogram.percentile(50.0).count());
+  histogram.record(std::chrono::nanoseconds(1));
+  histogram.record(std::chrono::nanoseconds(3));
+  histogram.record(std::chrono::nanoseconds(1000));
+  EXPECT_EQ(3u, histogram.count());
+  EXPECT_EQ(1, histogram.min().count());
+  EXPECT_EQ(1000, histogram.max().count());
+  EXPECT_EQ(334, histogram.mean().count());
+  EXPECT_EQ(1004, histogram.total().count());
+  EXPECT_EQ(1u, histogram.buckets()[0]);
+  EXPECT_EQ(1u, histogram.buckets()[1]);
+  // 1000 is between 2^9 and 2^10.
+  EXPECT_EQ(1u, histogram.buckets()[9]);
+  EXPECT_EQ(3, histogram.percentile(50.0).count());
+  EXPECT_EQ(1000, histogram.percentile(100.0).count());
+}
+
+// Make sure that spin_some_budgeted() stops at its budget, and serves the groups in turn
+TEST_F(TestExecutors, spinSomeBudgeted) {
+  using rclcpp::callback_group::CallbackGroupType;
+  auto busy_group = node->create_callback_group(CallbackGroupType::MutuallyExclusive);
+  auto quiet_group = node->create_callback_group(CallbackGroupType::MutuallyExclusive);
+  size_t busy_count = 0;
+  size_t quiet_count = 0;
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  for (size_t i = 0; i < 3; ++i) {
+    timers.push_back(node->create_wall_timer(1ms, [&busy_count]() {busy_count++;}, busy_group));
+  }
+  timers.push_back(node->create_wall_timer(1ms, [&quiet_count]() {quiet_count++;}, quiet_group));
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  std::this_thread::sleep_for(10ms);
+
+  rclcpp::executor::SpinBudget budget;
+  budget.max_executables = 2;
+  EXPECT_EQ(2u, executor.spin_some_budgeted(budget));
+  // The busy group ran once in the first round, so the quiet one ran too.
+  EXPECT_EQ(1u, busy_count);
+  EXPECT_EQ(1u, quiet_count);
+
+  // The groups held back by the previous call can be taken from again.
+  EXPECT_TRUE(busy_group->can_be_taken_from().load());
+  EXPECT_TRUE(quiet_group->can_be_taken_from().load());
+
+  budget.max_executables = 0;
+  budget.max_duration = 1s;
+  std::this_thread::sleep_for(10ms);
+  EXPECT_GE(executor.spin_some_budgeted(budget), 3u);
+  EXPECT_GE(busy_count, 3u);
+}
@@ -14,6 +14,9 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
+
+#include "rclcpp/detail/expanded_name_cache.hpp"
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/expand_topic_or_service_name.hpp"
 
@@ -78,3 +81,43 @@ TEST(TestExpandTopicOrServiceName, exceptions) {
     }, rclcpp::exceptions::InvalidServiceNameError);
   }
 }
+
+/*
+   Testing the memoization of the expanded names.
+ */
+TEST(TestExpandTopicOrServiceName, expanded_name_cache) {
+  using rclcpp::detail::ExpandedNameCache;
+  using rclcpp::expand_topic_or_service_name;
+  using Kind = ExpandedNameCache::Kind;
+  ExpandedNameCache cache(2);
+  size_t expansions = 0;
+  auto expand = [&expansions](const std::string & name, bool is_service) {
+      return [&expansions, &name, is_service]() {
+               ++expansions;
+               return expand_topic_or_service_name(name, "node", "/ns", is_service);
+             };
+    };
+
+  EXPECT_EQ("/ns/chatter", cache.get("chatter", Kind::Topic, expand("chatter", false)));
+  EXPECT_EQ("/ns/chatter", cache.get("chatter", Kind::Topic, expand("chatter", false)));
+  EXPECT_EQ(1u, expansions);
+
+  // The kind of the name is part of the key.
+  EXPECT_EQ("/ns/chatter", cache.get("chatter", Kind::Service, expand("chatter", true)));
+  EXPECT_EQ(2u, expansions);
+  EXPECT_EQ(2u, cache.size());
+
+  // Invalid names aren't cached.
+  EXPECT_THROW(
+    cache.get("42invalid", Kind::Topic, expand("42invalid", false)),
+    rclcpp::exceptions::InvalidTopicNameError);
+  EXPECT_THROW(
+    cache.get("42invalid", Kind::Topic, expand("42invalid", false)),
+    rclcpp::exceptions::InvalidTopicNameError);
+  EXPECT_EQ(4u, expansions);
+  EXPECT_EQ(2u, cache.size());
+
+  // The cache is cleared when it's full.
+  EXPECT_EQ("/ns/node", cache.get("~", Kind::Topic, expand("~", false)));
+  EXPECT_EQ(1u, cache.size());
+}
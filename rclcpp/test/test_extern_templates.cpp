@@ -0,0 +1,69 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+
+#include "rclcpp/extern_templates.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+// Instantiated in extern_templates_instantiation.cpp
+RCLCPP_EXTERN_MESSAGE_TEMPLATES(test_msgs::msg::BasicTypes);
+
+class TestExternTemplates : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+/*
+   The publisher and subscription of a message type instantiated in another translation unit
+ */
+TEST_F(TestExternTemplates, publish_and_take) {
+  using test_msgs::msg::BasicTypes;
+  for (bool intra_process : {false, true}) {
+    auto node = std::make_shared<rclcpp::Node>(
+      "test_extern_templates", rclcpp::NodeOptions().use_intra_process_comms(intra_process));
+    int64_t received = 0;
+    auto sub = node->create_subscription<BasicTypes>(
+      "extern_templates_topic", 10,
+      [&received](BasicTypes::ConstSharedPtr msg) {received = msg->int64_value;});
+    auto pub = node->create_publisher<BasicTypes>("extern_templates_topic", 10);
+
+    auto msg = std::make_unique<BasicTypes>();
+    msg->int64_value = 42;
+    pub->publish(std::move(msg));
+
+    rclcpp::executors::SingleThreadedExecutor executor;
+    executor.add_node(node);
+    auto start = std::chrono::steady_clock::now();
+    while (0 == received && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+      executor.spin_some(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(42, received) << "intra_process: " << intra_process;
+  }
+}
@@ -0,0 +1,127 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "rclcpp/fd_waitable.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+using namespace std::chrono_literals;
+
+class TestFdWaitable : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  void SetUp()
+  {
+    node = std::make_shared<rclcpp::Node>("test_fd_waitable");
+    ASSERT_EQ(0, pipe(fds));
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+  }
+
+  void TearDown()
+  {
+    node.reset();
+    close(fds[0]);
+    close(fds[1]);
+  }
+
+  // Spin until the count reaches the expected value, or a timeout.
+  void spin_until(
+    rclcpp::executors::SingleThreadedExecutor & executor, const int & count, int expected)
+  {
+    auto end = std::chrono::steady_clock::now() + 5s;
+    while (count < expected && std::chrono::steady_clock::now() < end) {
+      executor.spin_once(100ms);
+    }
+  }
+
+  rclcpp::Node::SharedPtr node;
+  int fds[2];
+};
+
+TEST_F(TestFdWaitable, construction) {
+  EXPECT_THROW(rclcpp::FdWaitable(-1, [](int) {}), std::invalid_argument);
+  EXPECT_THROW(rclcpp::FdWaitable(fds[0], nullptr), std::invalid_argument);
+  rclcpp::FdWaitable waitable(fds[0], [](int) {});
+  EXPECT_EQ(fds[0], waitable.get_fd());
+  EXPECT_FALSE(waitable.is_ready(nullptr));
+}
+
+// The callback is executed by the executor when data is available, until it is all read
+TEST_F(TestFdWaitable, read_in_executor) {
+  int calls = 0;
+  int bytes = 0;
+  std::thread::id callback_thread;
+  auto waitable = std::make_shared<rclcpp::FdWaitable>(
+    fds[0], [&calls, &bytes, &callback_thread](int fd) {
+      callback_thread = std::this_thread::get_id();
+      calls++;
+      // Read one byte per call, the callback is called again for the rest.
+      char value;
+      if (read(fd, &value, 1) == 1) {
+        bytes++;
+      }
+    });
+  node->get_node_waitables_interface()->add_waitable(waitable, nullptr);
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+
+  executor.spin_once(10ms);
+  EXPECT_EQ(0, calls);
+
+  ASSERT_EQ(3, write(fds[1], "abc", 3));
+  spin_until(executor, bytes, 3);
+  EXPECT_EQ(3, bytes);
+  EXPECT_EQ(3, calls);
+  EXPECT_EQ(std::this_thread::get_id(), callback_thread);
+
+  // Everything was read, the callback isn't called anymore.
+  executor.spin_once(50ms);
+  EXPECT_EQ(3, calls);
+
+  ASSERT_EQ(1, write(fds[1], "d", 1));
+  spin_until(executor, bytes, 4);
+  EXPECT_EQ(4, bytes);
+}
+
+// The callback isn't called after the waitable is destroyed
+TEST_F(TestFdWaitable, destruction) {
+  int calls = 0;
+  auto waitable = std::make_shared<rclcpp::FdWaitable>(fds[0], [&calls](int) {calls++;});
+  ASSERT_EQ(1, write(fds[1], "a", 1));
+  auto end = std::chrono::steady_clock::now() + 5s;
+  while (!waitable->is_ready(nullptr) && std::chrono::steady_clock::now() < end) {
+    std::this_thread::sleep_for(1ms);
+  }
+  EXPECT_TRUE(waitable->is_ready(nullptr));
+  waitable->execute();
+  EXPECT_EQ(1, calls);
+  // Executed once per notification.
+  waitable->execute();
+  EXPECT_EQ(1, calls);
+  waitable.reset();
+}
@@ -0,0 +1,196 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rclcpp/experimental/flight_recorder.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rmw/serialized_message.h"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+#ifndef _WIN32
+#include <unistd.h>
+
+using rclcpp::experimental::FlightRecord;
+using rclcpp::experimental::FlightRecorder;
+using rclcpp::experimental::FlightRecorderOptions;
+
+namespace
+{
+
+std::string
+unique_path(const std::string & test_name)
+{
+  const char * tmpdir = std::getenv("TMPDIR");
+  return std::string(tmpdir ? tmpdir : "/tmp") + "/rclcpp_test_" + test_name + "_" +
+         std::to_string(getpid()) + ".rec";
+}
+
+rcl_serialized_message_t
+make_message(std::string & content)
+{
+  rcl_serialized_message_t message = rmw_get_zero_initialized_serialized_message();
+  message.buffer = reinterpret_cast<uint8_t *>(&content[0]);
+  message.buffer_length = content.size();
+  message.buffer_capacity = content.size();
+  return message;
+}
+
+std::string
+record_content(const FlightRecord & record)
+{
+  return std::string(record.data.begin(), record.data.end());
+}
+
+}  // namespace
+
+/*
+   Construction and topics
+ */
+TEST(TestFlightRecorder, constructor) {
+  FlightRecorderOptions options;
+  EXPECT_THROW(FlightRecorder{options}, std::invalid_argument);
+  options.path = unique_path("constructor");
+  options.capacity = 0;
+  EXPECT_THROW(FlightRecorder{options}, std::invalid_argument);
+  options.capacity = 4;
+  options.max_message_size = 0;
+  EXPECT_THROW(FlightRecorder{options}, std::invalid_argument);
+  options.max_message_size = 16;
+
+  FlightRecorder recorder(options);
+  EXPECT_EQ(0u, recorder.add_topic("/a"));
+  EXPECT_EQ(1u, recorder.add_topic("/b"));
+  EXPECT_EQ(0u, recorder.add_topic("/a"));
+  EXPECT_THROW(
+    recorder.add_topic(std::string(FlightRecorder::max_topic_name_length + 1, 'a')),
+    std::invalid_argument);
+  EXPECT_TRUE(recorder.get_records().empty());
+  std::remove(options.path.c_str());
+}
+
+/*
+   The recording keeps the latest messages, and drops the ones too large
+ */
+TEST(TestFlightRecorder, record) {
+  FlightRecorderOptions options;
+  options.path = unique_path("record");
+  options.capacity = 2;
+  options.max_message_size = 8;
+  FlightRecorder recorder(options);
+  auto topic_a = recorder.add_topic("/a");
+  auto topic_b = recorder.add_topic("/b");
+
+  std::string contents[] = {"one", "two", "three", "too large message"};
+  recorder.record(topic_a, make_message(contents[0]));
+  recorder.record(topic_b, make_message(contents[1]));
+  recorder.record(topic_a, make_message(contents[2]));
+  recorder.record(topic_a, make_message(contents[3]));
+  EXPECT_EQ(1u, recorder.get_dropped_count());
+
+  auto records = recorder.get_records();
+  ASSERT_EQ(2u, records.size());
+  EXPECT_EQ("/b", records[0].topic_name);
+  EXPECT_EQ("two", record_content(records[0]));
+  EXPECT_EQ("/a", records[1].topic_name);
+  EXPECT_EQ(topic_a, records[1].topic_id);
+  EXPECT_EQ("three", record_content(records[1]));
+  EXPECT_LE(records[0].timestamp, records[1].timestamp);
+  std::remove(options.path.c_str());
+}
+
+/*
+   The recording is read from its file, e.g. after a crash, and dumped
+ */
+TEST(TestFlightRecorder, read_file_and_dump) {
+  FlightRecorderOptions options;
+  options.path = unique_path("read_file");
+  options.capacity = 8;
+  options.max_message_size = 8;
+  std::string dump_path = unique_path("dump");
+  {
+    FlightRecorder recorder(options);
+    auto topic = recorder.add_topic("/a");
+    std::string content = "old";
+    recorder.record(topic, make_message(content));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    content = "new";
+    recorder.record(topic, make_message(content));
+    recorder.dump(dump_path, std::chrono::milliseconds(100));
+  }
+
+  auto records = FlightRecorder::read_file(options.path);
+  ASSERT_EQ(2u, records.size());
+  EXPECT_EQ("old", record_content(records[0]));
+  EXPECT_EQ("new", record_content(records[1]));
+  records = FlightRecorder::read_file(options.path, std::chrono::milliseconds(100));
+  ASSERT_EQ(1u, records.size());
+  EXPECT_EQ("new", record_content(records[0]));
+
+  records = FlightRecorder::read_file(dump_path);
+  ASSERT_EQ(1u, records.size());
+  EXPECT_EQ("/a", records[0].topic_name);
+  EXPECT_EQ("new", record_content(records[0]));
+
+  EXPECT_THROW(FlightRecorder::read_file(unique_path("missing")), std::runtime_error);
+  std::remove(options.path.c_str());
+  std::remove(dump_path.c_str());
+}
+
+/*
+   A publisher given the recorder records the messages it publishes
+ */
+TEST(TestFlightRecorder, publisher) {
+  rclcpp::init(0, nullptr);
+  FlightRecorderOptions recorder_options;
+  recorder_options.path = unique_path("publisher");
+  {
+    auto recorder = std::make_shared<FlightRecorder>(recorder_options);
+    auto node = std::make_shared<rclcpp::Node>("recorded_node", "ns");
+    rclcpp::PublisherOptions options;
+    options.flight_recorder = recorder;
+    auto publisher = node->create_publisher<test_msgs::msg::BasicTypes>(
+      "recorded_topic", 10, options);
+    test_msgs::msg::BasicTypes msg;
+    msg.int32_value = 42;
+    publisher->publish(msg);
+
+    auto records = recorder->get_records();
+    ASSERT_EQ(1u, records.size());
+    EXPECT_EQ("/ns/recorded_topic", records[0].topic_name);
+    rcl_serialized_message_t serialized_msg = rmw_get_zero_initialized_serialized_message();
+    serialized_msg.buffer = records[0].data.data();
+    serialized_msg.buffer_length = records[0].data.size();
+    serialized_msg.buffer_capacity = records[0].data.size();
+    test_msgs::msg::BasicTypes recorded_msg;
+    rclcpp::Serialization<test_msgs::msg::BasicTypes>().deserialize(serialized_msg, recorded_msg);
+    EXPECT_EQ(42, recorded_msg.int32_value);
+  }
+  rclcpp::shutdown();
+  std::remove(recorder_options.path.c_str());
+}
+
+#endif  // _WIN32
@@ -0,0 +1,194 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/typesupport_helpers.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+using namespace std::chrono_literals;
+using test_msgs::msg::BasicTypes;
+
+class TestGenericPubSub : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+
+  void SetUp()
+  {
+    node = std::make_shared<rclcpp::Node>("test_generic_pubsub", "/ns");
+  }
+
+  void TearDown()
+  {
+    node.reset();
+  }
+
+  // Call step() and spin the node until the condition holds, false on timeout.
+  template<typename StepT, typename ConditionT>
+  bool
+  spin_until(StepT step, ConditionT condition)
+  {
+    rclcpp::executors::SingleThreadedExecutor executor;
+    executor.add_node(node);
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (!condition() && std::chrono::steady_clock::now() < deadline) {
+      step();
+      executor.spin_some();
+      std::this_thread::sleep_for(10ms);
+    }
+    return condition();
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST(TestTypesupportHelpers, extract_type_identifier) {
+  EXPECT_EQ(
+    std::make_tuple(std::string("test_msgs"), std::string("msg"), std::string("BasicTypes")),
+    rclcpp::extract_type_identifier("test_msgs/msg/BasicTypes"));
+  EXPECT_EQ(
+    std::make_tuple(std::string("test_msgs"), std::string("msg"), std::string("BasicTypes")),
+    rclcpp::extract_type_identifier("test_msgs/BasicTypes"));
+  for (const char * type : {"BasicTypes", "/BasicTypes", "test_msgs/", "test_msgs//BasicTypes",
+      "test_msgs/msg/sub/BasicTypes"})
+  {
+    EXPECT_THROW(rclcpp::extract_type_identifier(type), std::invalid_argument) << type;
+  }
+}
+
+TEST(TestTypesupportHelpers, load_type_support) {
+  auto library = rclcpp::get_typesupport_library(
+    "test_msgs/msg/BasicTypes", "rosidl_typesupport_cpp");
+  ASSERT_NE(nullptr, library);
+  auto type_support = rclcpp::get_typesupport_handle(
+    "test_msgs/msg/BasicTypes", "rosidl_typesupport_cpp", *library);
+  EXPECT_EQ(
+    rosidl_typesupport_cpp::get_message_type_support_handle<BasicTypes>(), type_support);
+
+  EXPECT_THROW(
+    rclcpp::get_typesupport_handle("test_msgs/msg/NotAType", "rosidl_typesupport_cpp", *library),
+    std::runtime_error);
+  EXPECT_THROW(
+    rclcpp::get_typesupport_library("not_a_package/msg/BasicTypes", "rosidl_typesupport_cpp"),
+    std::runtime_error);
+}
+
+TEST_F(TestGenericPubSub, unknown_type) {
+  EXPECT_THROW(
+    node->create_generic_publisher("topic", "not_a_package/msg/BasicTypes", 10),
+    std::runtime_error);
+  EXPECT_THROW(
+    node->create_generic_subscription(
+      "topic", "test_msgs/msg/NotAType", 10,
+      [](std::shared_ptr<const rcl_serialized_message_t>) {}),
+    std::runtime_error);
+}
+
+TEST_F(TestGenericPubSub, generic_publisher_to_typed_subscription) {
+  auto publisher = node->create_generic_publisher("topic", "test_msgs/msg/BasicTypes", 10);
+  EXPECT_STREQ("/ns/topic", publisher->get_topic_name());
+
+  std::vector<BasicTypes> received;
+  auto subscription = node->create_subscription<BasicTypes>(
+    "topic", 10, [&received](BasicTypes::SharedPtr message) {received.push_back(*message);});
+
+  BasicTypes message;
+  message.int32_value = 42;
+  rclcpp::SerializedMessage serialized_message;
+  rclcpp::Serialization<BasicTypes>().serialize(message, serialized_message);
+
+  ASSERT_TRUE(
+    spin_until(
+      [&]() {publisher->publish(serialized_message);},
+      [&]() {return !received.empty();}));
+  EXPECT_EQ(message, received.front());
+}
+
+TEST_F(TestGenericPubSub, typed_publisher_to_generic_subscription) {
+  auto publisher = node->create_publisher<BasicTypes>("topic", 10);
+
+  std::vector<BasicTypes> received;
+  rclcpp::Serialization<BasicTypes> serialization;
+  auto subscription = node->create_generic_subscription(
+    "topic", "test_msgs/BasicTypes", 10,
+    [&](std::shared_ptr<const rcl_serialized_message_t> serialized_message) {
+      BasicTypes message;
+      serialization.deserialize(*serialized_message, message);
+      received.push_back(message);
+    });
+  EXPECT_STREQ("/ns/topic", subscription->get_topic_name());
+  EXPECT_TRUE(subscription->is_serialized());
+  EXPECT_THROW(subscription->create_message(), std::runtime_error);
+
+  BasicTypes message;
+  message.float64_value = 1.5;
+  ASSERT_TRUE(
+    spin_until(
+      [&]() {publisher->publish(message);},
+      [&]() {return received.size() >= 3u;}));
+  for (const auto & received_message : received) {
+    EXPECT_EQ(message, received_message);
+  }
+}
+
+TEST_F(TestGenericPubSub, generic_publisher_to_generic_subscription) {
+  auto publisher = node->create_generic_publisher("topic", "test_msgs/msg/BasicTypes", 10);
+
+  // The messages kept by the callback hold their buffer, the other ones are reused.
+  std::vector<std::shared_ptr<const rcl_serialized_message_t>> kept;
+  size_t received = 0;
+  auto subscription = node->create_generic_subscription(
+    "topic", "test_msgs/msg/BasicTypes", 10,
+    [&](std::shared_ptr<const rcl_serialized_message_t> serialized_message) {
+      if (received++ % 2 == 0) {
+        kept.push_back(serialized_message);
+      }
+    });
+
+  BasicTypes message;
+  message.uint8_value = 7;
+  rclcpp::SerializedMessage serialized_message;
+  rclcpp::Serialization<BasicTypes>().serialize(message, serialized_message);
+
+  ASSERT_TRUE(
+    spin_until(
+      [&]() {publisher->publish(serialized_message.get_rcl_serialized_message());},
+      [&]() {return received >= 4u;}));
+  rclcpp::Serialization<BasicTypes> serialization;
+  for (const auto & kept_message : kept) {
+    BasicTypes deserialized;
+    serialization.deserialize(*kept_message, deserialized);
+    EXPECT_EQ(message, deserialized);
+  }
+}
@@ -0,0 +1,149 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "rclcpp/allocator/huge_page_allocator.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+using rclcpp::allocator::HugePageAllocator;
+using rclcpp::allocator::HugePageArena;
+using rclcpp::allocator::HugePageArenaOptions;
+
+namespace
+{
+constexpr size_t mebibyte = 1024 * 1024;
+}  // namespace
+
+/*
+   Large allocations come from the arena and are reused, the small ones and the ones which don't
+   fit anymore use the global operator new.
+ */
+TEST(TestHugePageArena, allocations) {
+  HugePageArenaOptions options;
+  options.capacity = 5 * mebibyte;
+  options.min_allocation_size = 4096;
+  HugePageArena arena(options);
+  // Rounded up to huge pages
+  EXPECT_LE(5 * mebibyte, arena.get_capacity());
+  void * empty = arena.allocate(0);
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(empty) % alignof(std::max_align_t));
+  arena.deallocate(empty);
+
+  void * large = arena.allocate(3 * mebibyte);
+  EXPECT_TRUE(arena.owns(large));
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(large) % alignof(std::max_align_t));
+  std::memset(large, 0xff, 3 * mebibyte);
+  void * small = arena.allocate(100);
+  EXPECT_FALSE(arena.owns(small));
+  arena.deallocate(small);
+
+  arena.deallocate(large);
+  EXPECT_EQ(large, arena.allocate(3 * mebibyte));
+  void * overflow = arena.allocate(arena.get_capacity());
+  EXPECT_FALSE(arena.owns(overflow));
+  arena.deallocate(overflow);
+  arena.deallocate(large);
+
+  auto statistics = arena.get_statistics();
+  EXPECT_EQ(2u, statistics.arena_allocations);
+  EXPECT_EQ(1u, statistics.overflow_allocations);
+  EXPECT_EQ(2u, statistics.small_allocations);
+  EXPECT_LE(3 * mebibyte, statistics.used_size);
+  EXPECT_LE(statistics.huge_page_size, arena.get_capacity());
+  EXPECT_DOUBLE_EQ(2.0 / 3.0, statistics.get_hit_rate());
+
+  options.capacity = 0;
+  EXPECT_THROW(HugePageArena{options}, std::invalid_argument);
+}
+
+/*
+   Without a pool of huge pages reserved by the system, hugetlbfs falls back to transparent
+   huge pages.
+ */
+TEST(TestHugePageArena, hugetlbfs) {
+  HugePageArenaOptions options;
+  options.capacity = 2 * mebibyte;
+  options.use_hugetlbfs = true;
+  HugePageArena arena(options);
+  void * pointer = arena.allocate(mebibyte);
+  EXPECT_TRUE(arena.owns(pointer));
+  std::memset(pointer, 0, mebibyte);
+  arena.deallocate(pointer);
+  if (arena.uses_hugetlbfs()) {
+    EXPECT_LE(mebibyte, arena.get_statistics().huge_page_size);
+  }
+}
+
+TEST(TestHugePageAllocator, containers) {
+  auto arena = std::make_shared<HugePageArena>();
+  HugePageAllocator<uint8_t> allocator(arena);
+  EXPECT_TRUE(allocator == HugePageAllocator<int>(allocator));
+  EXPECT_TRUE(allocator != HugePageAllocator<int>());
+
+  std::vector<uint8_t, HugePageAllocator<uint8_t>> buffer(4 * mebibyte, 0, allocator);
+  EXPECT_TRUE(arena->owns(buffer.data()));
+  std::vector<uint8_t, HugePageAllocator<uint8_t>> small_buffer(16, 0, allocator);
+  EXPECT_FALSE(arena->owns(small_buffer.data()));
+
+  // Without arena, the global operator new is used
+  std::vector<int, HugePageAllocator<int>> default_buffer(1000);
+  EXPECT_FALSE(arena->owns(default_buffer.data()));
+}
+
+/*
+   The messages published intra-process are allocated from the arena of the publisher.
+ */
+TEST(TestHugePageAllocator, intra_process_publisher) {
+  using test_msgs::msg::BasicTypes;
+  rclcpp::init(0, nullptr);
+
+  HugePageArenaOptions options;
+  options.capacity = 2 * mebibyte;
+  options.min_allocation_size = 0;
+  auto arena = std::make_shared<HugePageArena>(options);
+  auto allocator = std::make_shared<HugePageAllocator<void>>(arena);
+
+  auto node = std::make_shared<rclcpp::Node>(
+    "huge_page_allocator_node", rclcpp::NodeOptions().use_intra_process_comms(true));
+  rclcpp::PublisherOptionsWithAllocator<HugePageAllocator<void>> publisher_options;
+  publisher_options.allocator = allocator;
+  auto publisher = node->create_publisher<BasicTypes>("huge_page_topic", 10, publisher_options);
+
+  size_t received = 0;
+  rclcpp::SubscriptionOptionsWithAllocator<HugePageAllocator<void>> subscription_options;
+  subscription_options.allocator = allocator;
+  auto subscription = node->create_subscription<BasicTypes>(
+    "huge_page_topic", 10,
+    [&received, &arena](std::shared_ptr<const BasicTypes> msg) {
+      EXPECT_TRUE(arena->owns(msg.get()));
+      received++;
+    },
+    subscription_options);
+
+  publisher->publish(BasicTypes());
+  rclcpp::spin_some(node);
+  EXPECT_EQ(1u, received);
+  EXPECT_LE(1u, arena->get_statistics().arena_allocations);
+
+  rclcpp::shutdown();
+}
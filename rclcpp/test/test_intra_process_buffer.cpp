@@ -15,6 +15,7 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -177,6 +178,7 @@ TEST(TestIntraProcessBuffer, shared_buffer_consume) {
   EXPECT_EQ(original_shared_msg.use_count(), popped_shared_msg.use_count());
   EXPECT_EQ(*original_shared_msg, *popped_shared_msg);
   EXPECT_EQ(original_message_pointer, popped_message_pointer);
+  EXPECT_EQ(0u, intra_process_buffer.get_copy_count());
 
   original_shared_msg = std::make_shared<char>('b');
   original_message_pointer = reinterpret_cast<std::uintptr_t>(original_shared_msg.get());
@@ -190,6 +192,7 @@ TEST(TestIntraProcessBuffer, shared_buffer_consume) {
   EXPECT_EQ(1L, original_shared_msg.use_count());
   EXPECT_EQ(*original_shared_msg, *popped_unique_msg);
   EXPECT_NE(original_message_pointer, popped_message_pointer);
+  EXPECT_EQ(1u, intra_process_buffer.get_copy_count());
 }
 
 /*
@@ -238,3 +241,52 @@ TEST(TestIntraProcessBuffer, unique_buffer_consume) {
   EXPECT_EQ(original_value, *popped_unique_msg);
   EXPECT_EQ(original_message_pointer, popped_message_pointer);
 }
+
+/*
+  Consume several messages at once, from buffers storing shared_ptr and unique_ptr
+  - the messages are taken in order, up to the requested number
+  - a copy is only made to give a unique_ptr from a buffer of shared_ptr
+ */
+TEST(TestIntraProcessBuffer, consume_n) {
+  using MessageT = char;
+  using Alloc = std::allocator<void>;
+  using Deleter = std::default_delete<MessageT>;
+  using SharedMessageT = std::shared_ptr<const MessageT>;
+  using UniqueMessageT = std::unique_ptr<MessageT, Deleter>;
+  using SharedIntraProcessBufferT = rclcpp::experimental::buffers::TypedIntraProcessBuffer<
+    MessageT, Alloc, Deleter, SharedMessageT>;
+  using UniqueIntraProcessBufferT = rclcpp::experimental::buffers::TypedIntraProcessBuffer<
+    MessageT, Alloc, Deleter, UniqueMessageT>;
+
+  SharedIntraProcessBufferT shared_buffer(
+    std::make_unique<rclcpp::experimental::buffers::RingBufferImplementation<SharedMessageT>>(4));
+  auto first = std::make_shared<char>('a');
+  shared_buffer.add_shared(first);
+  shared_buffer.add_shared(std::make_shared<char>('b'));
+  shared_buffer.add_shared(std::make_shared<char>('c'));
+
+  std::vector<SharedMessageT> shared_msgs;
+  EXPECT_EQ(1u, shared_buffer.consume_shared_n(shared_msgs, 1));
+  ASSERT_EQ(1u, shared_msgs.size());
+  EXPECT_EQ(first.get(), shared_msgs[0].get());
+  std::vector<UniqueMessageT> unique_msgs;
+  EXPECT_EQ(2u, shared_buffer.consume_unique_n(unique_msgs, 10));
+  ASSERT_EQ(2u, unique_msgs.size());
+  EXPECT_EQ('b', *unique_msgs[0]);
+  EXPECT_EQ('c', *unique_msgs[1]);
+  EXPECT_EQ(2u, shared_buffer.get_copy_count());
+  EXPECT_FALSE(shared_buffer.has_data());
+
+  UniqueIntraProcessBufferT unique_buffer(
+    std::make_unique<rclcpp::experimental::buffers::RingBufferImplementation<UniqueMessageT>>(4));
+  unique_buffer.add_unique(std::make_unique<char>('d'));
+  unique_buffer.add_unique(std::make_unique<char>('e'));
+
+  shared_msgs.clear();
+  EXPECT_EQ(2u, unique_buffer.consume_shared_n(shared_msgs, 10));
+  ASSERT_EQ(2u, shared_msgs.size());
+  EXPECT_EQ('d', *shared_msgs[0]);
+  EXPECT_EQ('e', *shared_msgs[1]);
+  EXPECT_EQ(0u, unique_buffer.get_copy_count());
+  EXPECT_EQ(0u, unique_buffer.consume_unique_n(unique_msgs, 10));
+}
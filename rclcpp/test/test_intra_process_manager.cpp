@@ -16,14 +16,19 @@
 
 #include <cstdint>
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <typeinfo>
 #include <utility>
 #include <vector>
 
 #define RCLCPP_BUILDING_LIBRARY 1
 #include "rclcpp/allocator/allocator_common.hpp"
+#include "rclcpp/experimental/buffers/broadcast_ring_buffer.hpp"
 #include "rclcpp/macros.hpp"
 #include "rclcpp/qos.hpp"
+#include "rcl/types.h"
+#include "rcl/wait.h"
 #include "rmw/types.h"
 #include "rmw/qos_profiles.h"
 
@@ -54,7 +59,9 @@ public:
 
   PublisherBase()
   : qos(rclcpp::QoS(10)),
-    topic_name("topic")
+    topic_name("topic"),
+    message_type(&typeid(void)),
+    broadcast_depth(0)
   {}
 
   virtual ~PublisherBase()
@@ -79,6 +86,18 @@ public:
     return qos;
   }
 
+  const std::type_info &
+  get_intra_process_message_type() const
+  {
+    return *message_type;
+  }
+
+  size_t
+  get_intra_process_broadcast_depth() const
+  {
+    return broadcast_depth;
+  }
+
   bool
   operator==(const rmw_gid_t & gid) const
   {
@@ -95,6 +114,8 @@ public:
 
   rclcpp::QoS qos;
   std::string topic_name;
+  const std::type_info * message_type;
+  size_t broadcast_depth;
   uint64_t intra_process_publisher_id_;
   IntraProcessManagerWeakPtr weak_ipm_;
 };
@@ -192,7 +213,9 @@ public:
   RCLCPP_SMART_PTR_ALIASES_ONLY(SubscriptionIntraProcessBase)
 
   SubscriptionIntraProcessBase()
-  : qos_profile(rmw_qos_profile_default), topic_name("topic")
+  : qos_profile(rmw_qos_profile_default), topic_name("topic"), serialized(false),
+    message_type(&typeid(void)), last_wait_set(nullptr), last_wait_set_stamp(0),
+    notify_count(0), buffer_full(false), broadcast(false), broadcast_cursor(0)
   {}
 
   virtual ~SubscriptionIntraProcessBase() {}
@@ -200,6 +223,21 @@ public:
   virtual bool
   use_take_shared_method() const = 0;
 
+  bool
+  is_serialized() const
+  {
+    return serialized;
+  }
+
+  void
+  provide_serialized_intra_process_message(std::shared_ptr<const rcl_serialized_message_t> msg)
+  {
+    serialized_messages.push_back(msg);
+  }
+
+  virtual void
+  provide_shared_intra_process_message(std::shared_ptr<const void> msg) = 0;
+
   rmw_qos_profile_t
   get_actual_qos()
   {
@@ -212,8 +250,65 @@ public:
     return topic_name;
   }
 
+  const std::type_info &
+  get_message_type() const
+  {
+    return *message_type;
+  }
+
+  const rcl_wait_set_t *
+  get_last_wait_set(uint64_t & stamp)
+  {
+    stamp = last_wait_set_stamp;
+    return last_wait_set;
+  }
+
+  void
+  trigger_guard_condition()
+  {
+    notify_count++;
+  }
+
+  bool
+  is_buffer_full() const
+  {
+    return buffer_full;
+  }
+
+  bool
+  can_read_broadcast() const
+  {
+    return broadcast;
+  }
+
+  void
+  add_broadcast_reader(rclcpp::experimental::buffers::BroadcastRingBuffer::SharedPtr ring)
+  {
+    broadcast_cursor = ring->get_write_sequence();
+    broadcast_ring = std::move(ring);
+  }
+
+  void
+  remove_broadcast_reader(
+    const rclcpp::experimental::buffers::BroadcastRingBuffer::SharedPtr & ring)
+  {
+    if (broadcast_ring == ring) {
+      broadcast_ring.reset();
+    }
+  }
+
   rmw_qos_profile_t qos_profile;
   const char * topic_name;
+  bool serialized;
+  const std::type_info * message_type;
+  const rcl_wait_set_t * last_wait_set;
+  uint64_t last_wait_set_stamp;
+  size_t notify_count;
+  bool buffer_full;
+  bool broadcast;
+  rclcpp::experimental::buffers::BroadcastRingBuffer::SharedPtr broadcast_ring;
+  uint64_t broadcast_cursor;
+  std::vector<std::shared_ptr<const rcl_serialized_message_t>> serialized_messages;
 };
 
 template<typename MessageT>
@@ -223,21 +318,38 @@ public:
   RCLCPP_SMART_PTR_DEFINITIONS(SubscriptionIntraProcess)
 
   SubscriptionIntraProcess()
-  : take_shared_method(false)
+  : take_shared_method(false), provided_count(0)
   {
     buffer = std::make_unique<rclcpp::experimental::buffers::mock::IntraProcessBuffer<MessageT>>();
   }
 
   void
-  provide_intra_process_message(std::shared_ptr<const MessageT> msg)
+  provide_intra_process_message(std::shared_ptr<const MessageT> msg, bool notify = true)
   {
     buffer->add(msg);
+    provided(notify);
   }
 
   void
-  provide_intra_process_message(std::unique_ptr<MessageT> msg)
+  provide_intra_process_message(std::unique_ptr<MessageT> msg, bool notify = true)
   {
     buffer->add(std::move(msg));
+    provided(notify);
+  }
+
+  void
+  provide_shared_intra_process_message(std::shared_ptr<const void> msg) override
+  {
+    provide_intra_process_message(std::static_pointer_cast<const MessageT>(msg));
+  }
+
+  void
+  provided(bool notify)
+  {
+    provided_count++;
+    if (notify) {
+      trigger_guard_condition();
+    }
   }
 
   std::uintptr_t
@@ -255,6 +367,7 @@ public:
   }
 
   bool take_shared_method;
+  size_t provided_count;
 
   typename rclcpp::experimental::buffers::mock::IntraProcessBuffer<MessageT>::UniquePtr buffer;
 };
@@ -381,6 +494,435 @@ TEST(TestIntraProcessManager, add_pub_sub) {
   ASSERT_EQ(1u, p3_subs);
 }
 
+/*
+   This tests the number of full subscriptions matched with a publisher:
+   - Only the matched subscriptions with a full buffer are counted.
+   - A publisher which doesn't exist has none.
+ */
+TEST(TestIntraProcessManager, get_full_subscription_count) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>();
+  auto s3 = std::make_shared<SubscriptionIntraProcessT>();
+  s3->topic_name = "different_topic_name";
+
+  auto p1_id = ipm->add_publisher(p1);
+  ipm->add_subscription(s1);
+  ipm->add_subscription(s2);
+  ipm->add_subscription(s3);
+  EXPECT_EQ(0u, ipm->get_full_subscription_count(p1_id));
+
+  s1->buffer_full = true;
+  s3->buffer_full = true;
+  EXPECT_EQ(1u, ipm->get_full_subscription_count(p1_id));
+
+  s2->buffer_full = true;
+  EXPECT_EQ(2u, ipm->get_full_subscription_count(p1_id));
+  EXPECT_EQ(0u, ipm->get_full_subscription_count(42));
+}
+
+/*
+   This tests that only the entities using the same message type are connected:
+   - A publisher and a subscription of different types on the same topic don't communicate.
+   - A serialized subscription communicates with a publisher of any type.
+ */
+TEST(TestIntraProcessManager, add_pub_sub_message_types) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  p1->message_type = &typeid(int);
+
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  s1->message_type = &typeid(double);
+
+  auto p1_id = ipm->add_publisher(p1);
+  auto s1_id = ipm->add_subscription(s1);
+  ASSERT_EQ(0u, ipm->get_subscription_count(p1_id));
+
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>();
+  s2->message_type = &typeid(int);
+  ipm->add_subscription(s2);
+  ASSERT_EQ(1u, ipm->get_subscription_count(p1_id));
+
+  auto s3 = std::make_shared<SubscriptionIntraProcessT>();
+  s3->serialized = true;
+  ipm->add_subscription(s3);
+  ASSERT_EQ(2u, ipm->get_subscription_count(p1_id));
+
+  ipm->remove_subscription(s1_id);
+  ASSERT_EQ(2u, ipm->get_subscription_count(p1_id));
+}
+
+/*
+   This tests the report of the connections between publishers and subscriptions:
+   - Only the pairs on the same topic are reported, sorted by topic and ids.
+   - A compatible pair communicates intra-process.
+   - An incompatible pair is reported with the reason it doesn't.
+ */
+TEST(TestIntraProcessManager, get_connections) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  p1->qos.get_rmw_qos_profile().durability = RMW_QOS_POLICY_DURABILITY_VOLATILE;
+
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  s1->qos_profile.durability = RMW_QOS_POLICY_DURABILITY_VOLATILE;
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>();
+  s2->qos_profile.durability = RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL;
+  auto s3 = std::make_shared<SubscriptionIntraProcessT>();
+  s3->topic_name = "different_topic_name";
+
+  auto p1_id = ipm->add_publisher(p1);
+  auto s1_id = ipm->add_subscription(s1);
+  auto s2_id = ipm->add_subscription(s2);
+  ipm->add_subscription(s3);
+
+  auto connections = ipm->get_connections();
+  ASSERT_EQ(2u, connections.size());
+  EXPECT_EQ("topic", connections[0].topic_name);
+  EXPECT_EQ(p1_id, connections[0].publisher_id);
+  EXPECT_EQ(s1_id, connections[0].subscription_id);
+  EXPECT_TRUE(connections[0].intra_process);
+  EXPECT_EQ("", connections[0].reason);
+  EXPECT_EQ(p1_id, connections[1].publisher_id);
+  EXPECT_EQ(s2_id, connections[1].subscription_id);
+  EXPECT_FALSE(connections[1].intra_process);
+  EXPECT_EQ("different durability", connections[1].reason);
+}
+
+/*
+   This tests the matching of the entities removed and added again on a topic:
+   - The entities of other topics are not affected by a removal.
+   - A topic left without entities can be used again.
+ */
+TEST(TestIntraProcessManager, topic_index) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  auto p2 = std::make_shared<PublisherT>();
+  p2->topic_name = "different_topic_name";
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>();
+  s2->topic_name = "different_topic_name";
+
+  auto p1_id = ipm->add_publisher(p1);
+  auto p2_id = ipm->add_publisher(p2);
+  auto s1_id = ipm->add_subscription(s1);
+  auto s2_id = ipm->add_subscription(s2);
+  ASSERT_EQ(1u, ipm->get_subscription_count(p1_id));
+  ASSERT_EQ(1u, ipm->get_subscription_count(p2_id));
+
+  ipm->remove_subscription(s1_id);
+  ipm->remove_publisher(p1_id);
+  ASSERT_EQ(1u, ipm->get_subscription_count(p2_id));
+  ASSERT_EQ(1u, ipm->get_connections().size());
+
+  auto s3 = std::make_shared<SubscriptionIntraProcessT>();
+  auto s3_id = ipm->add_subscription(s3);
+  auto p3 = std::make_shared<PublisherT>();
+  auto p3_id = ipm->add_publisher(p3);
+  ASSERT_EQ(1u, ipm->get_subscription_count(p3_id));
+
+  auto connections = ipm->get_connections();
+  ASSERT_EQ(2u, connections.size());
+  EXPECT_EQ("different_topic_name", connections[0].topic_name);
+  EXPECT_EQ(p2_id, connections[0].publisher_id);
+  EXPECT_EQ(s2_id, connections[0].subscription_id);
+  EXPECT_EQ("topic", connections[1].topic_name);
+  EXPECT_EQ(p3_id, connections[1].publisher_id);
+  EXPECT_EQ(s3_id, connections[1].subscription_id);
+}
+
+/*
+   This tests the subscriptions handle returned for a publisher:
+   - The handle of an unknown publisher is null.
+   - A handle obtained before a subscription is added sees the new subscription.
+   - Removing the subscription or the publisher empties the snapshot held by the handle.
+ */
+TEST(TestIntraProcessManager, publisher_subscriptions_handle) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+  ASSERT_EQ(nullptr, ipm->get_publisher_subscriptions(42));
+
+  auto p1 = std::make_shared<PublisherT>();
+  auto p1_id = ipm->add_publisher(p1);
+  auto handle = ipm->get_publisher_subscriptions(p1_id);
+  ASSERT_NE(nullptr, handle);
+  auto snapshot = handle->load();
+  ASSERT_EQ(0u, snapshot->all_subscriptions.size());
+
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  s1->take_shared_method = false;
+  auto s1_id = ipm->add_subscription(s1);
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>();
+  s2->take_shared_method = true;
+  auto s2_id = ipm->add_subscription(s2);
+  (void)s2_id;
+
+  // The previous snapshot is immutable.
+  ASSERT_EQ(0u, snapshot->all_subscriptions.size());
+  snapshot = handle->load();
+  ASSERT_EQ(1u, snapshot->take_ownership_subscriptions.size());
+  ASSERT_EQ(1u, snapshot->take_shared_subscriptions.size());
+  ASSERT_EQ(2u, snapshot->all_subscriptions.size());
+  // Subscriptions taking a shared message are listed first.
+  ASSERT_EQ(s2, snapshot->all_subscriptions[0]);
+  ASSERT_EQ(s1, snapshot->all_subscriptions[1]);
+
+  ipm->remove_subscription(s1_id);
+  snapshot = handle->load();
+  ASSERT_EQ(0u, snapshot->take_ownership_subscriptions.size());
+  ASSERT_EQ(1u, snapshot->all_subscriptions.size());
+
+  ipm->remove_publisher(p1_id);
+  ASSERT_EQ(nullptr, ipm->get_publisher_subscriptions(p1_id));
+  ASSERT_EQ(0u, handle->load()->all_subscriptions.size());
+}
+
+/*
+   Clearing the manager leaves the publishers without subscriptions, and the later removals
+   do nothing.
+ */
+TEST(TestIntraProcessManager, clear) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+  auto p1 = std::make_shared<PublisherT>();
+  auto p1_id = ipm->add_publisher(p1);
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  auto s1_id = ipm->add_subscription(s1);
+  auto handle = ipm->get_publisher_subscriptions(p1_id);
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(1u, handle->load()->all_subscriptions.size());
+
+  ipm->clear();
+  EXPECT_EQ(0u, handle->load()->all_subscriptions.size());
+  EXPECT_EQ(nullptr, ipm->get_publisher_subscriptions(p1_id));
+  EXPECT_EQ(0u, ipm->get_subscription_count(p1_id));
+  ipm->remove_subscription(s1_id);
+  ipm->remove_publisher(p1_id);
+
+  // The manager is still usable.
+  auto p2_id = ipm->add_publisher(p1);
+  ipm->add_subscription(s1);
+  EXPECT_EQ(1u, ipm->get_subscription_count(p2_id));
+}
+
+/*
+   This tests publishing a shared message, e.g. a loaned one:
+   - The subscription not requiring ownership receives the message.
+   - The subscription requiring ownership receives a copy.
+ */
+TEST(TestIntraProcessManager, publish_shared) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  auto p1_id = ipm->add_publisher(p1);
+  auto handle = ipm->get_publisher_subscriptions(p1_id);
+
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  s1->take_shared_method = true;
+  ipm->add_subscription(s1);
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>();
+  s2->take_shared_method = false;
+  ipm->add_subscription(s2);
+
+  std::shared_ptr<const MessageT> shared_msg = std::make_shared<MessageT>();
+  auto original_message_pointer = reinterpret_cast<std::uintptr_t>(shared_msg.get());
+  ipm->do_intra_process_publish_shared<MessageT>(
+    *handle, shared_msg, std::make_shared<std::allocator<MessageT>>());
+
+  ASSERT_EQ(original_message_pointer, s1->pop());
+  auto received_message_pointer_2 = s2->pop();
+  ASSERT_NE(0u, received_message_pointer_2);
+  ASSERT_NE(original_message_pointer, received_message_pointer_2);
+  ASSERT_EQ(1u, ipm->get_copy_count());
+}
+
+/*
+   This tests publishing a batch of messages:
+   - Both subscriptions receive all the messages, and are notified once.
+   - The subscription requiring ownership receives the last message without copy.
+   - The shared messages returned for inter-process publishing are the ones the subscription
+     not requiring ownership received.
+ */
+TEST(TestIntraProcessManager, publish_batch) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  auto p1_id = ipm->add_publisher(p1);
+  auto handle = ipm->get_publisher_subscriptions(p1_id);
+
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  s1->take_shared_method = true;
+  ipm->add_subscription(s1);
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>();
+  s2->take_shared_method = false;
+  ipm->add_subscription(s2);
+
+  std::vector<std::unique_ptr<MessageT>> messages;
+  for (size_t i = 0; i < 3; ++i) {
+    messages.emplace_back(new MessageT());
+  }
+  auto last_message_pointer = reinterpret_cast<std::uintptr_t>(messages.back().get());
+  std::vector<std::shared_ptr<const MessageT>> shared_messages;
+  ipm->do_intra_process_publish_batch<MessageT>(
+    *handle, messages, std::make_shared<std::allocator<MessageT>>(), &shared_messages);
+
+  ASSERT_TRUE(messages.empty());
+  ASSERT_EQ(3u, shared_messages.size());
+  ASSERT_EQ(3u, s1->provided_count);
+  ASSERT_EQ(3u, s2->provided_count);
+  ASSERT_EQ(1u, s1->notify_count);
+  ASSERT_EQ(1u, s2->notify_count);
+  ASSERT_EQ(reinterpret_cast<std::uintptr_t>(shared_messages.back().get()), s1->pop());
+  ASSERT_EQ(last_message_pointer, s2->pop());
+  ASSERT_EQ(3u, ipm->get_copy_count());
+
+  messages.emplace_back(nullptr);
+  ASSERT_THROW(
+    ipm->do_intra_process_publish_batch<MessageT>(
+      *handle, messages, std::make_shared<std::allocator<MessageT>>()),
+    std::runtime_error);
+}
+
+/*
+   This tests the history of a transient local publisher:
+   - The last messages, as many as the depth, are kept without subscriptions.
+   - A transient local subscription added later receives them without copy, then the next ones.
+   - A volatile subscription doesn't receive them.
+ */
+TEST(TestIntraProcessManager, transient_local_history) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  p1->qos = rclcpp::QoS(2).transient_local();
+  auto p1_id = ipm->add_publisher(p1);
+  p1->set_intra_process_manager(p1_id, ipm);
+  ASSERT_EQ(2u, ipm->get_publisher_subscriptions(p1_id)->get_history_depth());
+
+  std::uintptr_t last_message_pointer = 0;
+  for (size_t i = 0; i < 3; ++i) {
+    auto unique_msg = std::make_unique<MessageT>();
+    last_message_pointer = reinterpret_cast<std::uintptr_t>(unique_msg.get());
+    p1->publish(std::move(unique_msg));
+  }
+
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  s1->qos_profile.durability = RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL;
+  ipm->add_subscription(s1);
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>();
+  ipm->add_subscription(s2);
+
+  ASSERT_EQ(2u, s1->provided_count);
+  ASSERT_EQ(last_message_pointer, s1->pop());
+  ASSERT_EQ(0u, s2->provided_count);
+  ASSERT_EQ(0u, ipm->get_copy_count());
+
+  p1->publish(std::make_unique<MessageT>());
+  ASSERT_EQ(3u, s1->provided_count);
+
+  ipm->remove_publisher(p1_id);
+  auto s3 = std::make_shared<SubscriptionIntraProcessT>();
+  s3->qos_profile.durability = RMW_QOS_POLICY_DURABILITY_TRANSIENT_LOCAL;
+  ipm->add_subscription(s3);
+  ASSERT_EQ(0u, s3->provided_count);
+}
+
+/*
+   This tests the subscriptions taking serialized messages:
+   - They are counted, but are not in the lists of subscriptions taking typed messages.
+   - All of them receive a serialized message, one of them without copy.
+ */
+TEST(TestIntraProcessManager, serialized_subscriptions) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  auto p1_id = ipm->add_publisher(p1);
+  p1->set_intra_process_manager(p1_id, ipm);
+
+  auto s1 = std::make_shared<SubscriptionIntraProcessT>();
+  s1->serialized = true;
+  auto s1_id = ipm->add_subscription(s1);
+  auto s2 = std::make_shared<SubscriptionIntraProcessT>();
+  s2->serialized = true;
+  ipm->add_subscription(s2);
+
+  ASSERT_EQ(2u, ipm->get_subscription_count(p1_id));
+  auto handle = ipm->get_publisher_subscriptions(p1_id);
+  ASSERT_EQ(0u, handle->load()->all_subscriptions.size());
+  ASSERT_EQ(2u, handle->load()->serialized_subscriptions.size());
+
+  auto serialized_msg = rclcpp::experimental::create_serialized_message(4);
+  serialized_msg->buffer[0] = 42;
+  serialized_msg->buffer_length = 1;
+  const rcl_serialized_message_t * original_message_pointer = serialized_msg.get();
+  ipm->do_intra_process_publish_serialized(*handle, serialized_msg);
+
+  ASSERT_EQ(1u, s1->serialized_messages.size());
+  ASSERT_EQ(1u, s2->serialized_messages.size());
+  bool received_original_1 = s1->serialized_messages[0].get() == original_message_pointer;
+  bool received_original_2 = s2->serialized_messages[0].get() == original_message_pointer;
+  std::vector<bool> received_original_vec = {received_original_1, received_original_2};
+  ASSERT_THAT(received_original_vec, UnorderedElementsAre(true, false));
+  ASSERT_EQ(1u, s1->serialized_messages[0]->buffer_length);
+  ASSERT_EQ(42, s1->serialized_messages[0]->buffer[0]);
+  ASSERT_EQ(42, s2->serialized_messages[0]->buffer[0]);
+  ASSERT_EQ(1u, ipm->get_copy_count());
+
+  ipm->remove_subscription(s1_id);
+  ASSERT_EQ(1u, ipm->get_subscription_count(p1_id));
+}
+
 /*
    This tests the minimal usage of the class where there is a single subscription per publisher:
    - Publishes a unique_ptr message with a subscription requesting ownership.
@@ -434,6 +976,51 @@ TEST(TestIntraProcessManager, single_subscription) {
   ASSERT_EQ(original_message_pointer, received_message_pointer_2);
 }
 
+/*
+   This tests that the subscriptions are notified once per wait set:
+   - Only the subscription most recently added to a wait set is notified for it.
+   - The subscriptions of another wait set, or not added to any, are notified on their own.
+ */
+TEST(TestIntraProcessManager, notify_once_per_wait_set) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  auto p1_id = ipm->add_publisher(p1);
+  p1->set_intra_process_manager(p1_id, ipm);
+
+  rcl_wait_set_t wait_set_1 = rcl_get_zero_initialized_wait_set();
+  rcl_wait_set_t wait_set_2 = rcl_get_zero_initialized_wait_set();
+  std::vector<std::shared_ptr<SubscriptionIntraProcessT>> subscriptions;
+  for (size_t i = 0; i < 5; ++i) {
+    auto subscription = std::make_shared<SubscriptionIntraProcessT>();
+    subscription->take_shared_method = i % 2 == 0;
+    subscriptions.push_back(subscription);
+    ipm->add_subscription(subscription);
+  }
+  subscriptions[0]->last_wait_set = &wait_set_1;
+  subscriptions[0]->last_wait_set_stamp = 3;
+  subscriptions[1]->last_wait_set = &wait_set_1;
+  subscriptions[1]->last_wait_set_stamp = 4;
+  subscriptions[2]->last_wait_set = &wait_set_1;
+  subscriptions[2]->last_wait_set_stamp = 1;
+  subscriptions[3]->last_wait_set = &wait_set_2;
+  subscriptions[3]->last_wait_set_stamp = 2;
+
+  p1->publish(std::make_unique<MessageT>());
+
+  std::vector<size_t> notify_counts;
+  for (auto & subscription : subscriptions) {
+    ASSERT_EQ(1u, subscription->provided_count);
+    notify_counts.push_back(subscription->notify_count);
+  }
+  ASSERT_EQ(std::vector<size_t>({0, 1, 0, 1, 1}), notify_counts);
+}
+
 /*
    This tests the usage of the class where there are multiple subscriptions of the same type:
    - Publishes a unique_ptr message with 2 subscriptions requesting ownership.
@@ -473,6 +1060,7 @@ TEST(TestIntraProcessManager, multiple_subscriptions_same_type) {
   std::vector<bool> received_original_vec =
   {received_original_1, received_original_2};
   ASSERT_THAT(received_original_vec, UnorderedElementsAre(true, false));
+  ASSERT_EQ(1u, ipm->get_copy_count());
 
   ipm->remove_subscription(s1_id);
   ipm->remove_subscription(s2_id);
@@ -492,6 +1080,7 @@ TEST(TestIntraProcessManager, multiple_subscriptions_same_type) {
   auto received_message_pointer_4 = s4->pop();
   ASSERT_EQ(original_message_pointer, received_message_pointer_3);
   ASSERT_EQ(original_message_pointer, received_message_pointer_4);
+  ASSERT_EQ(1u, ipm->get_copy_count());
 
   ipm->remove_subscription(s3_id);
   ipm->remove_subscription(s4_id);
@@ -670,3 +1259,68 @@ TEST(TestIntraProcessManager, multiple_subscriptions_different_type) {
   EXPECT_EQ(original_message_pointer, received_message_pointer_10);
   EXPECT_NE(original_message_pointer, received_message_pointer_11);
 }
+
+/*
+   This tests the subscriptions reading the ring of a publisher:
+   - Adds a publisher with a ring and 4 subscriptions: 2 taking shared messages which can read
+     the ring, 1 taking shared messages which can't and 1 requesting ownership.
+   - Publishes a message, which is written once in the ring and given to the other two.
+   - The subscriptions reading the ring are notified and read the published message.
+   - Removes the publisher, the subscriptions stop reading the ring.
+ */
+TEST(TestIntraProcessManager, broadcast_subscriptions) {
+  using IntraProcessManagerT = rclcpp::experimental::IntraProcessManager;
+  using MessageT = rcl_interfaces::msg::Log;
+  using PublisherT = rclcpp::mock::Publisher<MessageT>;
+  using SubscriptionIntraProcessT = rclcpp::experimental::mock::SubscriptionIntraProcess<MessageT>;
+
+  auto ipm = std::make_shared<IntraProcessManagerT>();
+
+  auto p1 = std::make_shared<PublisherT>();
+  p1->broadcast_depth = 10;
+  auto p1_id = ipm->add_publisher(p1);
+  p1->set_intra_process_manager(p1_id, ipm);
+
+  std::vector<std::shared_ptr<SubscriptionIntraProcessT>> subscriptions;
+  for (size_t i = 0; i < 4; ++i) {
+    auto subscription = std::make_shared<SubscriptionIntraProcessT>();
+    subscription->take_shared_method = i < 3;
+    subscription->broadcast = i < 2;
+    subscriptions.push_back(subscription);
+    ipm->add_subscription(subscription);
+  }
+  ASSERT_NE(nullptr, subscriptions[0]->broadcast_ring);
+  EXPECT_EQ(subscriptions[0]->broadcast_ring, subscriptions[1]->broadcast_ring);
+  EXPECT_EQ(nullptr, subscriptions[2]->broadcast_ring);
+  EXPECT_EQ(4u, ipm->get_subscription_count(p1_id));
+
+  auto unique_msg = std::make_unique<MessageT>();
+  auto original_message_pointer = reinterpret_cast<std::uintptr_t>(unique_msg.get());
+  p1->publish(std::move(unique_msg));
+
+  auto ring = subscriptions[0]->broadcast_ring;
+  EXPECT_EQ(1u, ring->get_write_sequence());
+  std::vector<size_t> provided_counts;
+  for (auto & subscription : subscriptions) {
+    EXPECT_EQ(1u, subscription->notify_count);
+    provided_counts.push_back(subscription->provided_count);
+  }
+  EXPECT_EQ(std::vector<size_t>({0, 0, 1, 1}), provided_counts);
+
+  // The subscriptions taking shared messages get the same copy.
+  auto shared_message_pointer = subscriptions[2]->pop();
+  EXPECT_NE(original_message_pointer, shared_message_pointer);
+  for (size_t i = 0; i < 2; ++i) {
+    std::vector<std::shared_ptr<const void>> messages;
+    auto & subscription = subscriptions[i];
+    EXPECT_EQ(0u, ring->read(subscription->broadcast_cursor, 10, messages, 10));
+    ASSERT_EQ(1u, messages.size());
+    EXPECT_EQ(shared_message_pointer, reinterpret_cast<std::uintptr_t>(messages[0].get()));
+    EXPECT_EQ(1u, subscription->broadcast_cursor);
+  }
+  EXPECT_EQ(original_message_pointer, subscriptions[3]->pop());
+
+  ipm->remove_publisher(p1_id);
+  EXPECT_EQ(nullptr, subscriptions[0]->broadcast_ring);
+  EXPECT_EQ(nullptr, subscriptions[1]->broadcast_ring);
+}
@@ -0,0 +1,115 @@
+// Copyright 2019 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rclcpp/experimental/buffers/latest_value_buffer_implementation.hpp"
+
+using rclcpp::experimental::buffers::LatestValueBufferImplementation;
+
+/*
+   Only the latest message is kept, the older ones are dropped.
+ */
+TEST(TestLatestValueBufferImplementation, keep_latest) {
+  LatestValueBufferImplementation<int> buffer;
+  EXPECT_FALSE(buffer.has_data());
+  EXPECT_THROW(buffer.dequeue(), std::runtime_error);
+
+  buffer.enqueue(1);
+  EXPECT_TRUE(buffer.has_data());
+  EXPECT_EQ(1, buffer.dequeue());
+  EXPECT_FALSE(buffer.has_data());
+
+  buffer.enqueue(2);
+  buffer.enqueue(3);
+  buffer.enqueue(4);
+  EXPECT_EQ(2u, buffer.get_dropped_count());
+  EXPECT_EQ(4, buffer.dequeue());
+  EXPECT_FALSE(buffer.has_data());
+
+  buffer.enqueue(5);
+  buffer.clear();
+  EXPECT_FALSE(buffer.has_data());
+}
+
+/*
+   Dropped and cleared messages are released, the dequeued ones are given to the caller.
+ */
+TEST(TestLatestValueBufferImplementation, release_messages) {
+  LatestValueBufferImplementation<std::shared_ptr<int>> buffer;
+  auto msg = std::make_shared<int>(1);
+  std::weak_ptr<int> observer = msg;
+  buffer.enqueue(std::move(msg));
+  EXPECT_FALSE(observer.expired());
+  buffer.enqueue(std::make_shared<int>(2));
+  EXPECT_TRUE(observer.expired());
+
+  msg = buffer.dequeue();
+  observer = msg;
+  ASSERT_NE(nullptr, msg);
+  EXPECT_EQ(2, *msg);
+  EXPECT_EQ(1, msg.use_count());
+
+  buffer.enqueue(std::move(msg));
+  buffer.clear();
+  EXPECT_TRUE(observer.expired());
+}
+
+/*
+   Several producers and a consumer, the consumer never sees an older message after a newer one
+   of the same producer.
+ */
+TEST(TestLatestValueBufferImplementation, concurrent_producers) {
+  LatestValueBufferImplementation<std::pair<size_t, size_t>> buffer;
+  constexpr size_t producer_count = 4;
+  constexpr size_t message_count = 10000;
+  std::atomic<size_t> done_count(0);
+
+  std::vector<std::thread> producers;
+  for (size_t producer = 0; producer < producer_count; ++producer) {
+    producers.emplace_back(
+      [&buffer, &done_count, producer]() {
+        for (size_t i = 1; i <= message_count; ++i) {
+          buffer.enqueue(std::make_pair(producer, i));
+        }
+        done_count++;
+      });
+  }
+
+  std::vector<size_t> last_seen(producer_count, 0);
+  bool in_order = true;
+  auto consume = [&]() {
+      if (buffer.has_data()) {
+        auto msg = buffer.dequeue();
+        in_order = in_order && msg.second > last_seen[msg.first];
+        last_seen[msg.first] = msg.second;
+      }
+    };
+  while (done_count.load() < producer_count) {
+    consume();
+  }
+  for (auto & thread : producers) {
+    thread.join();
+  }
+  consume();
+  EXPECT_TRUE(in_order);
+  EXPECT_FALSE(buffer.has_data());
+}
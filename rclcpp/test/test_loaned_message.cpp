@@ -81,3 +81,70 @@ TEST_F(TestLoanedMessage, release) {
 
   SUCCEED();
 }
+
+TEST_F(TestLoanedMessage, publish_intra_process) {
+  auto node = std::make_shared<rclcpp::Node>(
+    "loaned_message_test_node", rclcpp::NodeOptions().use_intra_process_comms(true));
+  auto pub = node->create_publisher<MessageT>("loaned_message_test_topic", 1);
+
+  double shared_value = 0.0;
+  auto shared_sub = node->create_subscription<MessageT>(
+    "loaned_message_test_topic", 1,
+    [&shared_value](MessageT::ConstSharedPtr msg) {shared_value = msg->float64_value;});
+  double unique_value = 0.0;
+  auto unique_sub = node->create_subscription<MessageT>(
+    "loaned_message_test_topic", 1,
+    [&unique_value](MessageT::UniquePtr msg) {unique_value = msg->float64_value;});
+
+  auto loaned_msg = pub->borrow_loaned_message();
+  ASSERT_TRUE(loaned_msg.is_valid());
+  loaned_msg.get().float64_value = 42.0;
+  ASSERT_NO_THROW(pub->publish(std::move(loaned_msg)));
+  ASSERT_FALSE(loaned_msg.is_valid());
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_some();
+  EXPECT_EQ(42.0, shared_value);
+  EXPECT_EQ(42.0, unique_value);
+}
+
+TEST_F(TestLoanedMessage, recycle_without_middleware_loans) {
+  auto node = std::make_shared<rclcpp::Node>("loaned_message_test_node");
+  auto pub = node->create_publisher<MessageT>("loaned_message_test_topic", 1);
+  if (pub->can_loan_messages()) {
+    // The messages are loaned by the middleware, there is nothing to recycle.
+    return;
+  }
+
+  MessageT * msg = nullptr;
+  {
+    auto loaned_msg = pub->borrow_loaned_message();
+    ASSERT_TRUE(loaned_msg.is_valid());
+    msg = &loaned_msg.get();
+    loaned_msg.get().float64_value = 42.0;
+  }
+  // The message destroyed unpublished is recycled, with its content
+  auto loaned_msg = pub->borrow_loaned_message();
+  EXPECT_EQ(msg, &loaned_msg.get());
+  EXPECT_EQ(42.0, loaned_msg.get().float64_value);
+
+  // Like the published one, the middleware taking a copy
+  ASSERT_NO_THROW(pub->publish(std::move(loaned_msg)));
+  EXPECT_EQ(msg, &pub->borrow_loaned_message().get());
+
+  // Only one message is recycled by default
+  auto first_msg = pub->borrow_loaned_message();
+  auto second_msg = pub->borrow_loaned_message();
+  EXPECT_NE(&first_msg.get(), &second_msg.get());
+
+  // Nor any with an empty pool
+  rclcpp::PublisherOptions options;
+  options.loaned_message_pool_size = 0;
+  auto unpooled_pub = node->create_publisher<MessageT>("loaned_message_test_topic", 1, options);
+  {
+    auto unpooled_msg = unpooled_pub->borrow_loaned_message();
+    unpooled_msg.get().float64_value = 42.0;
+  }
+  EXPECT_EQ(0.0, unpooled_pub->borrow_loaned_message().get().float64_value);
+}
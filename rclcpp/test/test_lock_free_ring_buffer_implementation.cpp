@@ -0,0 +1,158 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rclcpp/experimental/buffers/lock_free_ring_buffer_implementation.hpp"
+
+using rclcpp::experimental::buffers::MpscRingBufferImplementation;
+using rclcpp::experimental::buffers::SpscRingBufferImplementation;
+
+template<typename BufferT>
+class TestLockFreeRingBufferImplementation : public ::testing::Test
+{
+};
+
+using BufferTypes = ::testing::Types<
+  SpscRingBufferImplementation<int>,
+  MpscRingBufferImplementation<int>>;
+TYPED_TEST_CASE(TestLockFreeRingBufferImplementation, BufferTypes);
+
+/*
+   Constructor
+ */
+TYPED_TEST(TestLockFreeRingBufferImplementation, constructor) {
+  EXPECT_THROW(TypeParam rb(0), std::invalid_argument);
+
+  TypeParam rb(1);
+  EXPECT_FALSE(rb.has_data());
+  EXPECT_EQ(1u, rb.capacity());
+  EXPECT_THROW(rb.dequeue(), std::runtime_error);
+}
+
+/*
+   Basic usage
+   - insert data and check that it has data
+   - extract data
+   - overwrite old data writing over the buffer capacity
+ */
+TYPED_TEST(TestLockFreeRingBufferImplementation, basic_usage) {
+  TypeParam rb(2);
+
+  rb.enqueue(1);
+  EXPECT_TRUE(rb.has_data());
+  EXPECT_EQ(1, rb.dequeue());
+  EXPECT_FALSE(rb.has_data());
+
+  rb.enqueue(2);
+  rb.enqueue(3);
+  EXPECT_TRUE(rb.is_full());
+  EXPECT_EQ(0u, rb.get_dropped_count());
+  rb.enqueue(4);
+  EXPECT_EQ(1u, rb.get_dropped_count());
+  EXPECT_EQ(3, rb.dequeue());
+  EXPECT_FALSE(rb.is_full());
+  EXPECT_EQ(4, rb.dequeue());
+  EXPECT_FALSE(rb.has_data());
+}
+
+/*
+   The capacity is kept when it is not a power of two
+ */
+TYPED_TEST(TestLockFreeRingBufferImplementation, capacity_not_power_of_two) {
+  TypeParam rb(3);
+  for (int i = 0; i < 10; ++i) {
+    rb.enqueue(i);
+  }
+  EXPECT_EQ(7, rb.dequeue());
+  EXPECT_EQ(8, rb.dequeue());
+  EXPECT_EQ(9, rb.dequeue());
+  EXPECT_FALSE(rb.has_data());
+
+  rb.enqueue(10);
+  rb.clear();
+  EXPECT_FALSE(rb.has_data());
+}
+
+/*
+   One thread enqueues while another dequeues, the messages arrive in order
+ */
+TYPED_TEST(TestLockFreeRingBufferImplementation, concurrent_producer_and_consumer) {
+  TypeParam rb(8);
+  const int number_of_messages = 100000;
+  std::atomic_bool done {false};
+  std::thread producer([&rb, &done, number_of_messages]() {
+      for (int i = 0; i < number_of_messages; ++i) {
+        rb.enqueue(i);
+      }
+      done.store(true);
+    });
+
+  int last = -1;
+  bool in_order = true;
+  while (!done.load() || rb.has_data()) {
+    if (rb.has_data()) {
+      int value = rb.dequeue();
+      in_order = in_order && value > last;
+      last = value;
+    }
+  }
+  producer.join();
+  EXPECT_TRUE(in_order);
+  EXPECT_EQ(number_of_messages - 1, last);
+}
+
+/*
+   Several threads enqueue while another dequeues, the messages of each thread arrive in order
+ */
+TEST(TestMpscRingBufferImplementation, concurrent_producers) {
+  MpscRingBufferImplementation<std::unique_ptr<int>> rb(16);
+  const int number_of_producers = 4;
+  const int messages_per_producer = 20000;
+  std::atomic_int producers_done {0};
+  std::vector<std::thread> producers;
+  for (int p = 0; p < number_of_producers; ++p) {
+    producers.emplace_back(
+      [&rb, &producers_done, p, messages_per_producer]() {
+        for (int i = 0; i < messages_per_producer; ++i) {
+          rb.enqueue(std::make_unique<int>(p * messages_per_producer + i));
+        }
+        producers_done++;
+      });
+  }
+
+  std::vector<int> last(number_of_producers, -1);
+  bool in_order = true;
+  while (producers_done.load() < number_of_producers || rb.has_data()) {
+    if (rb.has_data()) {
+      auto value = rb.dequeue();
+      ASSERT_NE(nullptr, value);
+      int producer = *value / messages_per_producer;
+      in_order = in_order && *value > last[producer];
+      last[producer] = *value;
+    }
+  }
+  for (auto & producer : producers) {
+    producer.join();
+  }
+  // The last messages of a producer may be dropped to make room for the others'.
+  EXPECT_TRUE(in_order);
+  EXPECT_FALSE(rb.has_data());
+}
@@ -0,0 +1,90 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#define RCLCPP_LOGGING_CACHE_LEVELS 1
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+
+#include "rclcpp/logger.hpp"
+#include "rclcpp/logging.hpp"
+#include "rcutils/logging.h"
+
+size_t g_log_calls = 0;
+
+class TestLoggingCachedLevels : public ::testing::Test
+{
+public:
+  rcutils_logging_output_handler_t previous_output_handler;
+  void SetUp()
+  {
+    g_log_calls = 0;
+    ASSERT_EQ(RCUTILS_RET_OK, rcutils_logging_initialize());
+    rcutils_logging_set_default_logger_level(RCUTILS_LOG_SEVERITY_INFO);
+    rclcpp::invalidate_logger_levels();
+
+    auto output_handler = [](
+      const rcutils_log_location_t *, int, const char *, rcutils_time_point_value_t,
+      const char *, va_list *) -> void
+      {
+        g_log_calls += 1;
+      };
+
+    this->previous_output_handler = rcutils_logging_get_output_handler();
+    rcutils_logging_set_output_handler(output_handler);
+  }
+
+  void TearDown()
+  {
+    rcutils_logging_set_output_handler(this->previous_output_handler);
+    ASSERT_EQ(RCUTILS_RET_OK, rcutils_logging_shutdown());
+  }
+};
+
+TEST_F(TestLoggingCachedLevels, set_level) {
+  auto logger = rclcpp::get_logger("cached");
+  EXPECT_FALSE(logger.is_enabled_for(RCUTILS_LOG_SEVERITY_DEBUG));
+  EXPECT_TRUE(logger.is_enabled_for(RCUTILS_LOG_SEVERITY_INFO));
+  RCLCPP_DEBUG(logger, "disabled");
+  RCLCPP_INFO(logger, "enabled");
+  EXPECT_EQ(1u, g_log_calls);
+
+  // The copies of a logger and its children see the new levels.
+  auto copy = logger;
+  auto child = logger.get_child("child");
+  logger.set_level(rclcpp::Logger::Level::Debug);
+  EXPECT_TRUE(copy.is_enabled_for(RCUTILS_LOG_SEVERITY_DEBUG));
+  RCLCPP_DEBUG(copy, "enabled");
+  RCLCPP_DEBUG_STREAM(child, "enabled");
+  EXPECT_EQ(3u, g_log_calls);
+
+  logger.set_level(rclcpp::Logger::Level::Error);
+  RCLCPP_WARN(logger, "disabled");
+  RCLCPP_WARN(child, "disabled");
+  EXPECT_EQ(3u, g_log_calls);
+}
+
+TEST_F(TestLoggingCachedLevels, invalidate_logger_levels) {
+  auto logger = rclcpp::get_logger("invalidated");
+  EXPECT_FALSE(logger.is_enabled_for(RCUTILS_LOG_SEVERITY_DEBUG));
+
+  // Levels set with rcutils are only seen once the cached levels are invalidated.
+  rcutils_logging_set_logger_level("invalidated", RCUTILS_LOG_SEVERITY_DEBUG);
+  EXPECT_FALSE(logger.is_enabled_for(RCUTILS_LOG_SEVERITY_DEBUG));
+  rclcpp::invalidate_logger_levels();
+  EXPECT_TRUE(logger.is_enabled_for(RCUTILS_LOG_SEVERITY_DEBUG));
+  RCLCPP_DEBUG(logger, "enabled");
+  EXPECT_EQ(1u, g_log_calls);
+}
@@ -0,0 +1,180 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "rclcpp/create_memory_usage_report_timer.hpp"
+#include "rclcpp/experimental/buffers/latest_value_buffer_implementation.hpp"
+#include "rclcpp/experimental/buffers/ring_buffer_implementation.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/strategies/message_pool_memory_strategy.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+#include "test_msgs/srv/empty.hpp"
+
+using namespace std::chrono_literals;
+using test_msgs::msg::BasicTypes;
+
+class TestMemoryUsage : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+
+  void SetUp()
+  {
+    node = std::make_shared<rclcpp::Node>(
+      "test_memory_usage", "/ns", rclcpp::NodeOptions().use_intra_process_comms(true));
+  }
+
+  void TearDown()
+  {
+    node.reset();
+  }
+
+  // Return the usage of the only entity of a kind and a name, fail if there isn't exactly one.
+  static rclcpp::MemoryUsage
+  find_usage(
+    const rclcpp::NodeMemoryUsage & node_memory_usage,
+    rclcpp::MemoryUsageEntityKind kind, const std::string & name)
+  {
+    rclcpp::MemoryUsage usage;
+    size_t count = 0;
+    for (const auto & entity : node_memory_usage.entities) {
+      if (entity.kind == kind && entity.name == name) {
+        usage = entity.usage;
+        ++count;
+      }
+    }
+    EXPECT_EQ(1u, count) << rclcpp::to_string(kind) << " " << name;
+    return usage;
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST(TestMemoryUsageBuffers, buffer_implementations) {
+  rclcpp::experimental::buffers::RingBufferImplementation<int> ring_buffer(8);
+  EXPECT_EQ(8 * sizeof(int), ring_buffer.get_memory_usage());
+
+  rclcpp::experimental::buffers::LatestValueBufferImplementation<
+    std::unique_ptr<int>> latest_value_buffer;
+  EXPECT_EQ(0u, latest_value_buffer.get_memory_usage());
+  latest_value_buffer.enqueue(std::make_unique<int>(1));
+  EXPECT_GT(latest_value_buffer.get_memory_usage(), 0u);
+}
+
+TEST(TestMemoryUsageBuffers, message_memory_strategies) {
+  rclcpp::strategies::message_pool_memory_strategy::MessagePoolMemoryStrategy<BasicTypes, 4>
+    static_pool;
+  EXPECT_EQ(4 * sizeof(BasicTypes), static_pool.get_memory_usage());
+
+  rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolMemoryStrategy<BasicTypes>
+    dynamic_pool(2);
+  EXPECT_EQ(2 * sizeof(BasicTypes), dynamic_pool.get_memory_usage());
+  auto first = dynamic_pool.borrow_message();
+  auto second = dynamic_pool.borrow_message();
+  auto third = dynamic_pool.borrow_message();
+  EXPECT_EQ(4 * sizeof(BasicTypes), dynamic_pool.get_memory_usage());
+}
+
+TEST_F(TestMemoryUsage, entities) {
+  auto publisher = node->create_publisher<BasicTypes>("topic", 10);
+  auto subscription = node->create_subscription<BasicTypes>(
+    "topic", 10, [](BasicTypes::SharedPtr) {});
+  auto pool = std::make_shared<
+    rclcpp::strategies::message_pool_memory_strategy::MessagePoolMemoryStrategy<BasicTypes, 4>>();
+  auto pooled_subscription = node->create_subscription<BasicTypes>(
+    "pooled_topic", 10, [](BasicTypes::SharedPtr) {},
+    rclcpp::SubscriptionOptions(), pool);
+  auto service = node->create_service<test_msgs::srv::Empty>(
+    "service",
+    [](
+      const std::shared_ptr<test_msgs::srv::Empty::Request>,
+      std::shared_ptr<test_msgs::srv::Empty::Response>) {});
+  auto client = node->create_client<test_msgs::srv::Empty>("service");
+
+  auto node_memory_usage = node->get_node_base_interface()->get_memory_usage();
+
+  auto publisher_usage = find_usage(
+    node_memory_usage, rclcpp::MemoryUsageEntityKind::Publisher, "/ns/topic");
+  EXPECT_EQ(publisher_usage.entity_bytes, publisher_usage.total_bytes());
+  EXPECT_GT(publisher_usage.entity_bytes, 0u);
+
+  auto subscription_usage = find_usage(
+    node_memory_usage, rclcpp::MemoryUsageEntityKind::Subscription, "/ns/topic");
+  EXPECT_GT(subscription_usage.entity_bytes, 0u);
+  // A keep last intra-process buffer of depth 10.
+  EXPECT_GT(subscription_usage.intra_process_buffer_bytes, 0u);
+
+  auto pooled_usage = find_usage(
+    node_memory_usage, rclcpp::MemoryUsageEntityKind::Subscription, "/ns/pooled_topic");
+  EXPECT_EQ(4 * sizeof(BasicTypes), pooled_usage.message_pool_bytes);
+
+  auto service_usage = find_usage(
+    node_memory_usage, rclcpp::MemoryUsageEntityKind::Service, "/ns/service");
+  EXPECT_GT(service_usage.entity_bytes, 0u);
+
+  auto client_usage = find_usage(
+    node_memory_usage, rclcpp::MemoryUsageEntityKind::Client, "/ns/service");
+  EXPECT_GT(client_usage.pending_request_bytes, 0u);
+  size_t table_bytes = client_usage.pending_request_bytes;
+  client->reserve_pending_requests(64);
+  EXPECT_GT(client->get_memory_usage().pending_request_bytes, table_bytes);
+
+  auto total = node_memory_usage.total();
+  EXPECT_GE(
+    total.total_bytes(),
+    publisher_usage.total_bytes() + subscription_usage.total_bytes() +
+    pooled_usage.total_bytes() + service_usage.total_bytes() + client_usage.total_bytes());
+
+  std::string report = rclcpp::to_string(node_memory_usage);
+  EXPECT_NE(std::string::npos, report.find("/ns/pooled_topic"));
+  EXPECT_NE(std::string::npos, report.find("client"));
+}
+
+TEST_F(TestMemoryUsage, released_entities_are_not_reported) {
+  {
+    auto publisher = node->create_publisher<BasicTypes>("released_topic", 10);
+    auto node_memory_usage = node->get_node_base_interface()->get_memory_usage();
+    find_usage(node_memory_usage, rclcpp::MemoryUsageEntityKind::Publisher, "/ns/released_topic");
+  }
+  auto node_memory_usage = node->get_node_base_interface()->get_memory_usage();
+  for (const auto & entity : node_memory_usage.entities) {
+    EXPECT_NE("/ns/released_topic", entity.name);
+  }
+}
+
+TEST_F(TestMemoryUsage, report_timer) {
+  auto publisher = node->create_publisher<BasicTypes>("topic", 10);
+  auto timer = rclcpp::create_memory_usage_report_timer(node, 1ms);
+  ASSERT_NE(nullptr, timer);
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  std::this_thread::sleep_for(5ms);
+  EXPECT_NO_THROW(executor.spin_some());
+  timer->cancel();
+}
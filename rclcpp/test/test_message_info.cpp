@@ -0,0 +1,61 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "rcutils/time.h"
+
+#include "rclcpp/message_info.hpp"
+
+/*
+   The receive timestamp is taken when the info is created, if the middleware has none.
+ */
+TEST(TestMessageInfo, timestamps) {
+  rmw_message_info_t rmw_message_info;
+  rmw_message_info.from_intra_process = true;
+  rcutils_time_point_value_t before = 0;
+  ASSERT_EQ(RCUTILS_RET_OK, rcutils_system_time_now(&before));
+  rclcpp::MessageInfo message_info(rmw_message_info);
+  rcutils_time_point_value_t after = 0;
+  ASSERT_EQ(RCUTILS_RET_OK, rcutils_system_time_now(&after));
+
+  EXPECT_TRUE(message_info.get_rmw_message_info().from_intra_process);
+  const rmw_message_info_t & converted = message_info;
+  EXPECT_EQ(&message_info.get_rmw_message_info(), &converted);
+  EXPECT_LE(before, message_info.get_received_timestamp());
+  EXPECT_GE(after, message_info.get_received_timestamp());
+
+  message_info.set_source_timestamp(message_info.get_received_timestamp() - 1000);
+  EXPECT_EQ(std::chrono::nanoseconds(1000), message_info.get_transport_latency());
+}
+
+/*
+   The transport latency is unknown without both timestamps.
+ */
+TEST(TestMessageInfo, unknown_latency) {
+  rclcpp::MessageInfo empty;
+  EXPECT_EQ(0, empty.get_source_timestamp());
+  EXPECT_EQ(0, empty.get_received_timestamp());
+  EXPECT_GT(0, empty.get_transport_latency().count());
+
+  rmw_message_info_t rmw_message_info;
+  rmw_message_info.from_intra_process = false;
+  rclcpp::MessageInfo message_info(rmw_message_info, 2000);
+  EXPECT_EQ(2000, message_info.get_received_timestamp());
+  EXPECT_GT(0, message_info.get_transport_latency().count());
+  message_info.set_source_timestamp(1500);
+  EXPECT_EQ(std::chrono::nanoseconds(500), message_info.get_transport_latency());
+}
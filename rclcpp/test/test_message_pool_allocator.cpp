@@ -0,0 +1,179 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include "rclcpp/allocator/message_pool_allocator.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+#include "allocation_counter.hpp"
+
+using rclcpp::allocator::MessagePool;
+using rclcpp::allocator::MessagePoolAllocator;
+
+/*
+   Blocks are given back to the pool, and reused.
+ */
+TEST(TestMessagePool, recycle_blocks) {
+  auto pool = std::make_shared<MessagePool>(100, 2);
+  EXPECT_EQ(0u, pool->get_block_size() % alignof(std::max_align_t));
+  EXPECT_LE(100u, pool->get_block_size());
+  EXPECT_EQ(2u, pool->get_block_count());
+  EXPECT_EQ(2u, pool->get_free_block_count());
+
+  void * first = pool->allocate(100);
+  void * second = pool->allocate(1);
+  EXPECT_TRUE(pool->owns(first));
+  EXPECT_TRUE(pool->owns(second));
+  EXPECT_NE(first, second);
+  EXPECT_EQ(0u, pool->get_free_block_count());
+
+  pool->deallocate(first);
+  EXPECT_EQ(1u, pool->get_free_block_count());
+  EXPECT_EQ(first, pool->allocate(100));
+
+  pool->deallocate(first);
+  pool->deallocate(second);
+  EXPECT_EQ(2u, pool->get_free_block_count());
+  EXPECT_EQ(0u, pool->get_fallback_count());
+
+  EXPECT_THROW(MessagePool(0, 1), std::invalid_argument);
+  EXPECT_THROW(MessagePool(1, 0), std::invalid_argument);
+}
+
+/*
+   Allocations that don't fit in a free block use the global operator new.
+ */
+TEST(TestMessagePool, fallback) {
+  auto pool = std::make_shared<MessagePool>(16, 1);
+
+  void * large = pool->allocate(pool->get_block_size() + 1);
+  EXPECT_FALSE(pool->owns(large));
+  EXPECT_EQ(1u, pool->get_fallback_count());
+  EXPECT_EQ(1u, pool->get_free_block_count());
+
+  void * block = pool->allocate(1);
+  void * exhausted = pool->allocate(1);
+  EXPECT_TRUE(pool->owns(block));
+  EXPECT_FALSE(pool->owns(exhausted));
+  EXPECT_EQ(2u, pool->get_fallback_count());
+
+  pool->deallocate(large);
+  pool->deallocate(exhausted);
+  pool->deallocate(block);
+  EXPECT_EQ(1u, pool->get_free_block_count());
+}
+
+/*
+   Blocks placed on the NUMA node of the calling thread work like the others.
+ */
+TEST(TestMessagePool, numa_node) {
+  EXPECT_LE(1u, rclcpp::get_numa_node_count());
+  size_t numa_node = rclcpp::get_current_numa_node();
+  EXPECT_LT(numa_node, rclcpp::get_numa_node_count());
+
+  auto pool = std::make_shared<MessagePool>(100, 2, static_cast<int>(numa_node));
+  EXPECT_EQ(static_cast<int>(numa_node), pool->get_numa_node());
+  EXPECT_EQ(-1, MessagePool(100, 2).get_numa_node());
+  void * block = pool->allocate(100);
+  EXPECT_TRUE(pool->owns(block));
+  std::memset(block, 0xff, 100);
+  pool->deallocate(block);
+  EXPECT_EQ(2u, pool->get_free_block_count());
+  EXPECT_EQ(0u, pool->get_fallback_count());
+}
+
+/*
+   Rebound allocators share the pool of the allocator they are constructed from.
+ */
+TEST(TestMessagePoolAllocator, rebind) {
+  auto pool = std::make_shared<MessagePool>(64, 4);
+  MessagePoolAllocator<void> allocator(pool);
+  MessagePoolAllocator<int> int_allocator(allocator);
+  EXPECT_EQ(pool, int_allocator.get_pool());
+  EXPECT_TRUE(allocator == int_allocator);
+  EXPECT_TRUE(allocator != MessagePoolAllocator<void>());
+
+  {
+    auto shared_int = std::allocate_shared<int>(int_allocator, 42);
+    EXPECT_EQ(3u, pool->get_free_block_count());
+  }
+  EXPECT_EQ(4u, pool->get_free_block_count());
+  EXPECT_EQ(0u, pool->get_fallback_count());
+}
+
+class TestMessagePoolAllocatorPublish : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+};
+
+/*
+   Once warmed up, publishing intra-process with a pool allocator doesn't allocate.
+ */
+TEST_F(TestMessagePoolAllocatorPublish, no_allocation_when_publishing) {
+  using test_msgs::msg::BasicTypes;
+
+  auto pool = std::make_shared<MessagePool>(256, 16);
+  auto node = std::make_shared<rclcpp::Node>(
+    "message_pool_allocator_node", rclcpp::NodeOptions().use_intra_process_comms(true));
+
+  rclcpp::PublisherOptionsWithAllocator<MessagePoolAllocator<void>> options;
+  options.allocator = std::make_shared<MessagePoolAllocator<void>>(pool);
+  auto publisher = node->create_publisher<BasicTypes>("message_pool_topic", 10, options);
+
+  size_t received = 0;
+  auto subscription = node->create_subscription<BasicTypes>(
+    "message_pool_topic", 10,
+    [&received](std::shared_ptr<const BasicTypes> msg) {
+      (void)msg;
+      received++;
+    });
+
+  BasicTypes msg;
+  msg.int32_value = 42;
+
+  // Warm up, so that any lazy initialization happens before counting.
+  for (size_t i = 0; i < 3; ++i) {
+    publisher->publish(msg);
+    rclcpp::spin_some(node);
+  }
+  ASSERT_EQ(3u, received);
+  size_t fallback_count = pool->get_fallback_count();
+
+  for (size_t i = 0; i < 5; ++i) {
+    allocation_counter::start();
+    publisher->publish(msg);
+    EXPECT_EQ(0u, allocation_counter::stop());
+
+    rclcpp::spin_some(node);
+  }
+  EXPECT_EQ(8u, received);
+  EXPECT_EQ(fallback_count, pool->get_fallback_count());
+  EXPECT_EQ(pool->get_block_count(), pool->get_free_block_count());
+}
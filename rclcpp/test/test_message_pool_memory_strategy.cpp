@@ -0,0 +1,173 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "rclcpp/strategies/message_pool_memory_strategy.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+#include "test_msgs/msg/strings.hpp"
+
+using rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolMemoryStrategy;
+using rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry;
+using rclcpp::strategies::message_pool_memory_strategy::RecycledMessageMemoryStrategy;
+
+/*
+   Returned messages are reused, and reset.
+ */
+TEST(TestDynamicMessagePoolMemoryStrategy, reuse_messages) {
+  DynamicMessagePoolMemoryStrategy<test_msgs::msg::BasicTypes> strategy(2);
+  EXPECT_EQ(2u, strategy.get_pool_size());
+  EXPECT_EQ(2u, strategy.get_free_count());
+
+  auto msg = strategy.borrow_message();
+  auto msg_ptr = msg.get();
+  msg->int32_value = 42;
+  EXPECT_EQ(1u, strategy.get_free_count());
+
+  strategy.return_message(msg);
+  EXPECT_EQ(nullptr, msg);
+  EXPECT_EQ(2u, strategy.get_free_count());
+
+  msg = strategy.borrow_message();
+  EXPECT_EQ(msg_ptr, msg.get());
+  EXPECT_EQ(0, msg->int32_value);
+  strategy.return_message(msg);
+
+  EXPECT_THROW(
+    DynamicMessagePoolMemoryStrategy<test_msgs::msg::BasicTypes>(0), std::invalid_argument);
+}
+
+/*
+   The pool grows by chunks up to its maximum size, and then allocates messages without
+   throwing.
+ */
+TEST(TestDynamicMessagePoolMemoryStrategy, grow_and_exhaust) {
+  DynamicMessagePoolMemoryStrategy<test_msgs::msg::Strings> strategy(2, 3);
+
+  std::vector<std::shared_ptr<test_msgs::msg::Strings>> messages;
+  for (size_t i = 0; i < 3; ++i) {
+    messages.push_back(strategy.borrow_message());
+  }
+  EXPECT_EQ(3u, strategy.get_pool_size());
+  EXPECT_EQ(0u, strategy.get_exhausted_count());
+
+  std::shared_ptr<test_msgs::msg::Strings> extra;
+  EXPECT_NO_THROW(extra = strategy.borrow_message());
+  ASSERT_NE(nullptr, extra);
+  EXPECT_EQ(3u, strategy.get_pool_size());
+  EXPECT_EQ(1u, strategy.get_exhausted_count());
+
+  strategy.return_message(extra);
+  EXPECT_EQ(0u, strategy.get_free_count());
+  for (auto & msg : messages) {
+    strategy.return_message(msg);
+  }
+  EXPECT_EQ(3u, strategy.get_free_count());
+}
+
+/*
+   A returned message which is still referenced is not reused.
+ */
+TEST(TestDynamicMessagePoolMemoryStrategy, message_kept_by_callback) {
+  DynamicMessagePoolMemoryStrategy<test_msgs::msg::BasicTypes> strategy(1, 1);
+
+  auto msg = strategy.borrow_message();
+  msg->int32_value = 42;
+  auto kept = msg;
+  strategy.return_message(msg);
+
+  auto other = strategy.borrow_message();
+  EXPECT_NE(kept.get(), other.get());
+  EXPECT_EQ(42, kept->int32_value);
+  EXPECT_EQ(1u, strategy.get_exhausted_count());
+
+  kept.reset();
+  other = strategy.borrow_message();
+  EXPECT_EQ(1u, strategy.get_exhausted_count());
+}
+
+/*
+   The registry has one pool per message type.
+ */
+TEST(TestDynamicMessagePoolRegistry, one_pool_per_type) {
+  DynamicMessagePoolRegistry registry(4);
+
+  auto basic_types_pool = registry.get<test_msgs::msg::BasicTypes>();
+  auto strings_pool = registry.get<test_msgs::msg::Strings>();
+  ASSERT_NE(nullptr, basic_types_pool);
+  ASSERT_NE(nullptr, strings_pool);
+  EXPECT_EQ(basic_types_pool, registry.get<test_msgs::msg::BasicTypes>());
+  EXPECT_EQ(strings_pool, registry.get<test_msgs::msg::Strings>());
+  EXPECT_EQ(4u, basic_types_pool->get_pool_size());
+  EXPECT_EQ(4u, strings_pool->get_pool_size());
+}
+
+/*
+   Recycled messages are reused as is, keeping the capacity of their sequences.
+ */
+TEST(TestRecycledMessageMemoryStrategy, keep_capacity) {
+  RecycledMessageMemoryStrategy<test_msgs::msg::Strings> strategy(1);
+  auto preallocated = std::make_shared<test_msgs::msg::Strings>();
+  preallocated->string_value.reserve(1024);
+  auto preallocated_ptr = preallocated.get();
+  strategy.add_message(std::move(preallocated));
+  EXPECT_EQ(1u, strategy.get_message_count());
+  EXPECT_THROW(strategy.add_message(nullptr), std::invalid_argument);
+  EXPECT_THROW(
+    strategy.add_message(std::make_shared<test_msgs::msg::Strings>()), std::length_error);
+
+  for (size_t i = 0; i < 3; ++i) {
+    auto msg = strategy.borrow_message();
+    EXPECT_EQ(preallocated_ptr, msg.get());
+    EXPECT_LE(1024u, msg->string_value.capacity());
+    msg->string_value.assign(512, 'a');
+    strategy.return_message(msg);
+    EXPECT_EQ(nullptr, msg);
+  }
+  EXPECT_EQ(0u, strategy.get_allocated_count());
+}
+
+/*
+   A message is allocated, and recycled up to the maximum size, while the instances are in use.
+ */
+TEST(TestRecycledMessageMemoryStrategy, allocate_when_in_use) {
+  RecycledMessageMemoryStrategy<test_msgs::msg::BasicTypes> strategy(2);
+
+  auto first = strategy.borrow_message();
+  auto second = strategy.borrow_message();
+  auto third = strategy.borrow_message();
+  EXPECT_NE(first.get(), second.get());
+  EXPECT_EQ(3u, strategy.get_allocated_count());
+  EXPECT_EQ(2u, strategy.get_message_count());
+
+  auto kept = second;
+  auto kept_ptr = kept.get();
+  strategy.return_message(second);
+  strategy.return_message(third);
+  auto fourth = strategy.borrow_message();
+  EXPECT_NE(first.get(), fourth.get());
+  EXPECT_NE(kept_ptr, fourth.get());
+  EXPECT_EQ(4u, strategy.get_allocated_count());
+  strategy.return_message(fourth);
+
+  kept.reset();
+  EXPECT_EQ(kept_ptr, strategy.borrow_message().get());
+  EXPECT_EQ(4u, strategy.get_allocated_count());
+  EXPECT_EQ(2u, strategy.get_message_count());
+}
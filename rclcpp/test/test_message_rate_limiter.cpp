@@ -0,0 +1,76 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/message_rate_limiter.hpp"
+
+using rclcpp::MessageRateLimiter;
+using rclcpp::MessageRateLimitOptions;
+
+/*
+   Default options keep all the messages.
+ */
+TEST(TestMessageRateLimiter, disabled) {
+  MessageRateLimitOptions options;
+  EXPECT_FALSE(options.is_enabled());
+  options.decimation = 0;
+  EXPECT_FALSE(options.is_enabled());
+
+  MessageRateLimiter limiter(options);
+  for (size_t i = 0; i < 10; ++i) {
+    EXPECT_TRUE(limiter.accept());
+  }
+  EXPECT_EQ(0u, limiter.get_dropped_count());
+}
+
+/*
+   A decimation keeps the first message, then one message out of `decimation`.
+ */
+TEST(TestMessageRateLimiter, decimation) {
+  MessageRateLimitOptions options;
+  options.decimation = 3;
+  EXPECT_TRUE(options.is_enabled());
+
+  MessageRateLimiter limiter(options);
+  std::vector<bool> accepted;
+  for (size_t i = 0; i < 7; ++i) {
+    accepted.push_back(limiter.accept());
+  }
+  EXPECT_EQ(std::vector<bool>({true, false, false, true, false, false, true}), accepted);
+  EXPECT_EQ(4u, limiter.get_dropped_count());
+}
+
+/*
+   A minimum separation drops the messages coming too soon after the last kept one.
+ */
+TEST(TestMessageRateLimiter, min_separation) {
+  MessageRateLimitOptions options;
+  options.min_separation = std::chrono::milliseconds(50);
+  EXPECT_TRUE(options.is_enabled());
+
+  MessageRateLimiter limiter(options);
+  EXPECT_TRUE(limiter.accept());
+  EXPECT_FALSE(limiter.accept());
+  EXPECT_EQ(1u, limiter.get_dropped_count());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  EXPECT_TRUE(limiter.accept());
+  EXPECT_FALSE(limiter.accept());
+  EXPECT_EQ(2u, limiter.get_dropped_count());
+}
@@ -0,0 +1,69 @@
+// Copyright 2017 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "rclcpp/message_memory_strategy.hpp"
+#include "rclcpp/message_take_traits.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+#include "test_msgs/msg/strings.hpp"
+
+using rclcpp::message_memory_strategy::MessageMemoryStrategy;
+using rclcpp::message_take_traits::TakePath;
+using rclcpp::message_take_traits::is_plain_old_data_message;
+using rclcpp::message_take_traits::take_path;
+
+TEST(TestMessageTakeTraits, is_plain_old_data_message) {
+  static_assert(
+    is_plain_old_data_message<test_msgs::msg::BasicTypes>::value,
+    "BasicTypes has only fields of primitive types");
+  static_assert(
+    !is_plain_old_data_message<test_msgs::msg::Strings>::value,
+    "Strings has fields owning memory");
+  static_assert(
+    take_path<test_msgs::msg::BasicTypes>::value == TakePath::PlainOldData,
+    "BasicTypes takes the plain old data path");
+  static_assert(
+    take_path<test_msgs::msg::Strings>::value == TakePath::Default,
+    "Strings takes the default path");
+}
+
+/*
+   The default strategy reuses a returned plain old data message, unless it is still used.
+ */
+TEST(TestMessageTakeTraits, reuse_plain_old_data_message) {
+  auto strategy = MessageMemoryStrategy<test_msgs::msg::BasicTypes>::create_default();
+  auto msg = strategy->borrow_message();
+  auto msg_ptr = msg.get();
+  strategy->return_message(msg);
+  EXPECT_EQ(nullptr, msg);
+
+  msg = strategy->borrow_message();
+  EXPECT_EQ(msg_ptr, msg.get());
+  auto kept = msg;
+  strategy->return_message(msg);
+  msg = strategy->borrow_message();
+  EXPECT_NE(msg_ptr, msg.get());
+  strategy->return_message(msg);
+
+  auto strings_strategy = MessageMemoryStrategy<test_msgs::msg::Strings>::create_default();
+  auto strings_msg = strings_strategy->borrow_message();
+  std::weak_ptr<test_msgs::msg::Strings> observer = strings_msg;
+  strings_strategy->return_message(strings_msg);
+  EXPECT_TRUE(observer.expired());
+}
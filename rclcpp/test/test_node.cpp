@@ -14,17 +14,27 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/node.hpp"
+#include "rclcpp/node_interfaces/node_parameters.hpp"
 #include "rclcpp/scope_exit.hpp"
 #include "rclcpp/rclcpp.hpp"
 
+#include "rcl_interfaces/srv/list_parameters.hpp"
 #include "rcpputils/filesystem_helper.hpp"
 #include "test_msgs/msg/basic_types.hpp"
 
@@ -292,6 +302,57 @@ TEST_F(TestNode, now) {
   EXPECT_LT(now_external - now_builtin, 5000000L);
 }
 
+TEST_F(TestNode, entity_arena) {
+  auto arena = std::make_shared<rclcpp::allocator::Arena>(1024 * 1024);
+  auto node = std::make_shared<rclcpp::Node>(
+    "my_node", "/ns", rclcpp::NodeOptions().entity_arena(arena));
+  EXPECT_EQ(arena, node->get_node_base_interface()->get_entity_arena());
+
+  auto publisher = node->create_publisher<test_msgs::msg::BasicTypes>("topic", 10);
+  auto subscription = node->create_subscription<test_msgs::msg::BasicTypes>(
+    "topic", 10, [](std::shared_ptr<const test_msgs::msg::BasicTypes>) {});
+  auto timer = node->create_wall_timer(std::chrono::seconds(1), []() {});
+  auto group = node->create_callback_group(rclcpp::callback_group::CallbackGroupType::Reentrant);
+  EXPECT_TRUE(arena->owns(publisher.get()));
+  EXPECT_TRUE(arena->owns(subscription.get()));
+  EXPECT_TRUE(arena->owns(timer.get()));
+  EXPECT_TRUE(arena->owns(group.get()));
+
+  auto other_node = std::make_shared<rclcpp::Node>("other_node", "/ns");
+  EXPECT_EQ(nullptr, other_node->get_node_base_interface()->get_entity_arena());
+  auto other_publisher = other_node->create_publisher<test_msgs::msg::BasicTypes>("topic", 10);
+  EXPECT_FALSE(arena->owns(other_publisher.get()));
+}
+
+TEST_F(TestNode, message_pools) {
+  using rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry;
+  using test_msgs::msg::BasicTypes;
+  auto message_pools = std::make_shared<DynamicMessagePoolRegistry>(4);
+  auto options = rclcpp::NodeOptions().message_pools(message_pools);
+  auto node = std::make_shared<rclcpp::Node>("my_node", "/ns", options);
+  auto other_node = std::make_shared<rclcpp::Node>("other_node", "/ns", options);
+  EXPECT_EQ(message_pools, node->get_node_base_interface()->get_message_pools());
+
+  // The subscriptions of both nodes use the pool of the message type.
+  auto callback = [](std::shared_ptr<const BasicTypes>) {};
+  auto subscription = node->create_subscription<BasicTypes>("topic", 10, callback);
+  auto other_subscription = other_node->create_subscription<BasicTypes>("topic", 10, callback);
+  EXPECT_EQ(4u * sizeof(BasicTypes), subscription->get_memory_usage().message_pool_bytes);
+  EXPECT_EQ(4u * sizeof(BasicTypes), other_subscription->get_memory_usage().message_pool_bytes);
+  EXPECT_EQ(4u, message_pools->get<BasicTypes>()->get_pool_size());
+
+  // A strategy given by the user is kept.
+  auto strategy = std::make_shared<
+    rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolMemoryStrategy<
+      BasicTypes>>(2);
+  auto custom_subscription = node->create_subscription<BasicTypes>(
+    "topic", 10, callback, rclcpp::SubscriptionOptions(), strategy);
+  EXPECT_EQ(2u * sizeof(BasicTypes), custom_subscription->get_memory_usage().message_pool_bytes);
+
+  auto default_node = std::make_shared<rclcpp::Node>("default_node", "/ns");
+  EXPECT_EQ(nullptr, default_node->get_node_base_interface()->get_message_pools());
+}
+
 std::string
 operator"" _unq(const char * prefix, size_t prefix_length)
 {
@@ -683,6 +744,68 @@ TEST_F(TestNode, declare_parameters_with_no_initial_values) {
   }
 }
 
+TEST_F(TestNode, declare_parameters_at_once) {
+  auto node = std::make_shared<rclcpp::Node>("test_declare_parameters_node"_unq);
+  size_t callback_calls = 0;
+  size_t parameters_in_last_call = 0;
+  bool reject = false;
+  auto handle = node->add_on_set_parameters_callback(
+    [&](const std::vector<rclcpp::Parameter> & parameters) {
+      ++callback_calls;
+      parameters_in_last_call = parameters.size();
+      rcl_interfaces::msg::SetParametersResult result;
+      result.successful = !reject;
+      return result;
+    });
+  {
+    // the callback is called once with all the parameters
+    rcl_interfaces::msg::ParameterDescriptor descriptor;
+    descriptor.read_only = true;
+    auto values = node->declare_parameters(
+      {rclcpp::Parameter("bulk_a", 1), rclcpp::Parameter("bulk_b", "two")},
+      {rcl_interfaces::msg::ParameterDescriptor(), descriptor});
+    ASSERT_EQ(2u, values.size());
+    EXPECT_EQ(1, values[0].get<int>());
+    EXPECT_EQ("two", values[1].get<std::string>());
+    EXPECT_EQ(1u, callback_calls);
+    EXPECT_EQ(2u, parameters_in_last_call);
+    EXPECT_TRUE(node->has_parameter("bulk_a"));
+    EXPECT_TRUE(node->describe_parameter("bulk_b").read_only);
+  }
+  {
+    // the templated overload declares the parameters at once too
+    auto values = node->declare_parameters<int64_t>(
+      "bulk", {{"c", 3}, {"d", 4}, {"e", 5}});
+    std::vector<int64_t> expected = {3, 4, 5};
+    EXPECT_EQ(values, expected);
+    EXPECT_EQ(2u, callback_calls);
+    EXPECT_EQ(3u, parameters_in_last_call);
+  }
+  {
+    // nothing is declared if one of the parameters can't be
+    EXPECT_THROW(
+      node->declare_parameters({rclcpp::Parameter("bulk_f", 6), rclcpp::Parameter("bulk_a", 1)}),
+      rclcpp::exceptions::ParameterAlreadyDeclaredException);
+    EXPECT_FALSE(node->has_parameter("bulk_f"));
+    EXPECT_THROW(
+      node->declare_parameters({rclcpp::Parameter("bulk_g", 7), rclcpp::Parameter("bulk_g", 7)}),
+      rclcpp::exceptions::ParameterAlreadyDeclaredException);
+    EXPECT_FALSE(node->has_parameter("bulk_g"));
+    EXPECT_THROW(
+      node->declare_parameters(
+        {rclcpp::Parameter("bulk_h", 8)},
+        std::vector<rcl_interfaces::msg::ParameterDescriptor>(2)),
+      std::invalid_argument);
+    EXPECT_EQ(2u, callback_calls);
+    reject = true;
+    EXPECT_THROW(
+      node->declare_parameters({rclcpp::Parameter("bulk_i", 9), rclcpp::Parameter("bulk_j", 10)}),
+      rclcpp::exceptions::InvalidParameterValueException);
+    EXPECT_FALSE(node->has_parameter("bulk_i"));
+    EXPECT_FALSE(node->has_parameter("bulk_j"));
+  }
+}
+
 TEST_F(TestNode, declare_parameter_with_cli_overrides) {
   const std::string parameters_filepath = (
     test_resources_path / "test_parameters.yaml").string();
@@ -1774,6 +1897,215 @@ TEST_F(TestNode, get_parameter_undeclared_parameters_allowed) {
   }
 }
 
+// test get_parameter while the parameter is set from another thread
+TEST_F(TestNode, get_parameter_while_set_concurrently) {
+  auto node = std::make_shared<rclcpp::Node>("test_get_parameter_node"_unq);
+  auto name = "parameter"_unq;
+  node->declare_parameter(name, 0);
+
+  // The callbacks validating a change still see the previous value.
+  auto handle = node->add_on_set_parameters_callback(
+    [&node, &name](const std::vector<rclcpp::Parameter> & parameters) {
+      rcl_interfaces::msg::SetParametersResult result;
+      result.successful =
+        parameters[0].get_value<int>() == node->get_parameter(name).get_value<int>() + 1;
+      return result;
+    });
+
+  std::atomic<bool> done(false);
+  std::atomic<bool> in_order(true);
+  std::thread reader([&]() {
+      int last = 0;
+      while (!done) {
+        int value = node->get_parameter(name).get_value<int>();
+        if (value < last || !node->has_parameter(name)) {
+          in_order = false;
+        }
+        last = value;
+      }
+    });
+  for (int i = 1; i <= 1000; ++i) {
+    EXPECT_TRUE(node->set_parameter(rclcpp::Parameter(name, i)).successful);
+  }
+  done = true;
+  reader.join();
+  EXPECT_TRUE(in_order);
+  EXPECT_EQ(1000, node->get_parameter(name).get_value<int>());
+
+  node->remove_on_set_parameters_callback(handle.get());
+  node->undeclare_parameter(name);
+  EXPECT_FALSE(node->has_parameter(name));
+}
+
+// test parameter handles
+TEST_F(TestNode, parameter_handle) {
+  auto node = std::make_shared<rclcpp::Node>("test_parameter_handle_node"_unq);
+  auto gain_name = "gain"_unq;
+  auto frame_name = "frame"_unq;
+  auto gain = node->declare_parameter_handle(gain_name, 1.5);
+  auto frame = node->declare_parameter_handle(frame_name, std::string("base"));
+  EXPECT_EQ(gain_name, gain->get_name());
+  EXPECT_EQ(1.5, gain->get());
+  EXPECT_EQ("base", *frame->get());
+
+  // The handles follow the values set.
+  auto previous_frame = frame->get();
+  EXPECT_TRUE(node->set_parameter(rclcpp::Parameter(gain_name, 2.5)).successful);
+  EXPECT_TRUE(node->set_parameter(rclcpp::Parameter(frame_name, "map")).successful);
+  EXPECT_EQ(2.5, gain->get());
+  EXPECT_EQ("map", *frame->get());
+  EXPECT_EQ("base", *previous_frame);
+
+  // A rejected value isn't seen by the handle.
+  rcl_interfaces::msg::ParameterDescriptor descriptor;
+  rcl_interfaces::msg::IntegerRange range;
+  range.from_value = 0;
+  range.to_value = 10;
+  descriptor.integer_range.push_back(range);
+  auto count = node->declare_parameter_handle<int64_t>("count"_unq, 5, descriptor);
+  EXPECT_FALSE(node->set_parameter(rclcpp::Parameter(count->get_name(), 11)).successful);
+  EXPECT_EQ(5, count->get());
+
+  // The type can't change while a handle exists.
+  EXPECT_FALSE(node->set_parameter(rclcpp::Parameter(gain_name, "high")).successful);
+  EXPECT_FALSE(node->set_parameter(rclcpp::Parameter(gain_name)).successful);
+  EXPECT_EQ(2.5, gain->get());
+  EXPECT_THROW(node->get_parameter_handle<bool>(gain_name), rclcpp::ParameterTypeException);
+  EXPECT_THROW(
+    node->get_parameter_handle<double>("not_declared"_unq),
+    rclcpp::exceptions::ParameterNotDeclaredException);
+
+  auto same_gain = node->get_parameter_handle<double>(gain_name);
+  EXPECT_EQ(2.5, same_gain->get());
+  gain.reset();
+  same_gain.reset();
+  EXPECT_TRUE(node->set_parameter(rclcpp::Parameter(gain_name, "high")).successful);
+}
+
+// test coalescing parameter events
+TEST_F(TestNode, parameter_events_coalesced) {
+  auto listener = std::make_shared<rclcpp::Node>("test_parameter_events_listener"_unq);
+  auto node_name = "test_parameter_events_node"_unq;
+  std::vector<rcl_interfaces::msg::ParameterEvent> events;
+  auto subscription = listener->create_subscription<rcl_interfaces::msg::ParameterEvent>(
+    "/parameter_events", rclcpp::ParameterEventsQoS(),
+    [&events, &node_name](rcl_interfaces::msg::ParameterEvent::SharedPtr event) {
+      if (event->node == "/" + node_name) {
+        events.push_back(*event);
+      }
+    });
+
+  auto node = std::make_shared<rclcpp::Node>(
+    node_name,
+    rclcpp::NodeOptions()
+    .parameter_event_coalescing_period(std::chrono::milliseconds(100))
+    .parameter_overrides({{"from_override_1", 1}, {"from_override_2", 2}})
+    .automatically_declare_parameters_from_overrides(true));
+  node->declare_parameter("declared", 3);
+  node->set_parameter(rclcpp::Parameter("declared", 4));
+  node->set_parameter(rclcpp::Parameter("from_override_1", 5));
+
+  // The changes are pending until the node is spun, wait for the listener to discover it.
+  auto start = std::chrono::steady_clock::now();
+  while (
+    listener->count_publishers("/parameter_events") < 2 &&
+    std::chrono::steady_clock::now() - start < std::chrono::seconds(2))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.add_node(listener);
+  auto merged_received = [&events]() {
+      return !events.empty() && !events.back().changed_parameters.empty();
+    };
+  start = std::chrono::steady_clock::now();
+  while (!merged_received() && std::chrono::steady_clock::now() - start < std::chrono::seconds(2)) {
+    executor.spin_once(std::chrono::milliseconds(10));
+  }
+  executor.spin_some();
+
+  // The declarations from the overrides, published by the constructor before the listener
+  // could discover the node, then the changes of the coalescing period in one event.
+  ASSERT_TRUE(merged_received());
+  ASSERT_GE(2u, events.size());
+  if (events.size() == 2) {
+    EXPECT_EQ(2u, events[0].new_parameters.size());
+    EXPECT_TRUE(events[0].changed_parameters.empty());
+  }
+  const auto & merged = events.back();
+  ASSERT_EQ(1u, merged.changed_parameters.size());
+  EXPECT_EQ("from_override_1", merged.changed_parameters[0].name);
+  EXPECT_EQ(5, merged.changed_parameters[0].value.integer_value);
+  // The time source declared use_sim_time.
+  ASSERT_EQ(2u, merged.new_parameters.size());
+  for (const auto & parameter : merged.new_parameters) {
+    if (parameter.name == "declared") {
+      EXPECT_EQ(4, parameter.value.integer_value);
+    } else {
+      EXPECT_EQ("use_sim_time", parameter.name);
+    }
+  }
+}
+
+// test the lazy parameter event publisher of lightweight nodes
+TEST_F(TestNode, lightweight_node_lazy_parameter_events) {
+  auto node_name = "test_lightweight_node"_unq;
+  auto node = std::make_shared<rclcpp::Node>(
+    node_name, rclcpp::NodeOptions().lightweight());
+  auto listener = std::make_shared<rclcpp::Node>("test_lightweight_listener"_unq);
+  std::vector<rcl_interfaces::msg::ParameterEvent> events;
+  auto subscription = listener->create_subscription<rcl_interfaces::msg::ParameterEvent>(
+    "/parameter_events", rclcpp::ParameterEventsQoS(),
+    [&events, &node_name](rcl_interfaces::msg::ParameterEvent::SharedPtr event) {
+      if (event->node == "/" + node_name) {
+        events.push_back(*event);
+      }
+    });
+  auto count_node_publishers = [&listener, &node_name]() {
+      size_t count = 0;
+      for (const auto & info : listener->get_publishers_info_by_topic("/parameter_events")) {
+        count += info.node_name() == node_name ? 1u : 0u;
+      }
+      return count;
+    };
+  auto wait_for = [&listener](std::function<bool()> predicate) {
+      auto start = std::chrono::steady_clock::now();
+      while (!predicate() && std::chrono::steady_clock::now() - start < std::chrono::seconds(2)) {
+        rclcpp::spin_some(listener);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      return predicate();
+    };
+
+  // Declaring parameters doesn't create the publisher, nor are there parameter services.
+  node->declare_parameter("declared", 1);
+  EXPECT_FALSE(wait_for([&count_node_publishers]() {return count_node_publishers() > 0;}));
+  for (const auto & service : node->get_service_names_and_types()) {
+    EXPECT_EQ(std::string::npos, service.first.find(node_name));
+  }
+
+  // The first change creates the publisher, the declarations are published with it, possibly
+  // before the listener discovers the publisher.
+  node->set_parameter(rclcpp::Parameter("declared", 2));
+  ASSERT_TRUE(wait_for([&count_node_publishers]() {return count_node_publishers() == 1;}));
+  wait_for([&events]() {return !events.empty();});
+  if (!events.empty()) {
+    ASSERT_EQ(1u, events.size());
+    // The time source declared use_sim_time.
+    EXPECT_EQ(2u, events[0].new_parameters.size());
+    EXPECT_TRUE(events[0].changed_parameters.empty());
+  }
+
+  // The next changes are published right away.
+  events.clear();
+  node->set_parameter(rclcpp::Parameter("declared", 3));
+  ASSERT_TRUE(wait_for([&events]() {return !events.empty();}));
+  ASSERT_EQ(1u, events[0].changed_parameters.size());
+  EXPECT_EQ("declared", events[0].changed_parameters[0].name);
+  EXPECT_EQ(3, events[0].changed_parameters[0].value.integer_value);
+}
+
 // test get_parameter_or with undeclared not allowed
 TEST_F(TestNode, get_parameter_or_undeclared_parameters_not_allowed) {
   auto node = std::make_shared<rclcpp::Node>(
@@ -1999,6 +2331,39 @@ TEST_F(TestNode, get_parameters_undeclared_parameters_allowed) {
 }
 
 // test describe parameter with undeclared not allowed
+TEST_F(TestNode, list_parameters_by_prefix) {
+  auto node = std::make_shared<rclcpp::Node>("test_list_parameters_node"_unq);
+  for (const char * name : {"a", "a.b", "a.b.c", "a-b", "ab.c", "b.c"}) {
+    node->declare_parameter(name, 0);
+  }
+  const uint64_t recursive = rcl_interfaces::srv::ListParameters::Request::DEPTH_RECURSIVE;
+  {
+    // the names which only start like the prefix aren't listed
+    auto result = node->list_parameters({"a"}, recursive);
+    std::vector<std::string> expected_names = {"a", "a.b", "a.b.c"};
+    std::vector<std::string> expected_prefixes = {"a", "a.b"};
+    EXPECT_EQ(expected_names, result.names);
+    EXPECT_EQ(expected_prefixes, result.prefixes);
+  }
+  {
+    // the names below the depth aren't listed
+    auto result = node->list_parameters({"a"}, 2);
+    std::vector<std::string> expected_names = {"a", "a.b"};
+    EXPECT_EQ(expected_names, result.names);
+  }
+  {
+    // the names matching several prefixes are listed once, in order
+    auto result = node->list_parameters({"b", "a.b", "a"}, recursive);
+    std::vector<std::string> expected_names = {"a", "a.b", "a.b.c", "b.c"};
+    EXPECT_EQ(expected_names, result.names);
+  }
+  {
+    auto result = node->list_parameters({"c"}, recursive);
+    EXPECT_TRUE(result.names.empty());
+    EXPECT_TRUE(result.prefixes.empty());
+  }
+}
+
 TEST_F(TestNode, describe_parameter_undeclared_parameters_not_allowed) {
   auto node = std::make_shared<rclcpp::Node>(
     "test_get_parameter_node"_unq,
@@ -2638,3 +3003,271 @@ TEST_F(TestNode, get_publishers_subscriptions_info_by_topic) {
     subscription_list = node->get_subscriptions_info_by_topic("13");
   }, rclcpp::exceptions::InvalidTopicNameError);
 }
+
+TEST_F(TestNode, graph_queries_from_graph_cache) {
+  auto node = std::make_shared<rclcpp::Node>(
+    "graph_cache_node", "/ns", rclcpp::NodeOptions().use_graph_cache(true));
+  auto other_node = std::make_shared<rclcpp::Node>("graph_cache_other_node", "/ns");
+  const std::string topic_name = "/ns/graph_cache_topic";
+  EXPECT_EQ(0u, node->count_publishers(topic_name));
+  EXPECT_EQ(0u, node->get_topic_names_and_types().count(topic_name));
+
+  // The cached results are updated after the graph changes.
+  auto publisher = other_node->create_publisher<test_msgs::msg::BasicTypes>(topic_name, 10);
+  auto start = std::chrono::steady_clock::now();
+  while (node->count_publishers(topic_name) == 0 &&
+    std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(1u, node->count_publishers(topic_name));
+  EXPECT_EQ(1u, node->get_topic_names_and_types().count(topic_name));
+  EXPECT_EQ(0u, node->count_subscribers(topic_name));
+
+  auto node_names = node->get_node_names();
+  EXPECT_NE(
+    node_names.end(),
+    std::find(node_names.begin(), node_names.end(), "/ns/graph_cache_other_node"));
+
+  publisher.reset();
+  start = std::chrono::steady_clock::now();
+  while (node->count_publishers(topic_name) != 0 &&
+    std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(0u, node->count_publishers(topic_name));
+}
+
+TEST_F(TestNode, graph_change_callbacks) {
+  auto node = std::make_shared<rclcpp::Node>("graph_change_node", "/ns");
+  auto graph = node->get_node_graph_interface();
+  std::mutex mutex;
+  std::vector<rclcpp::GraphChange> topic_changes;
+  size_t other_topic_changes = 0;
+  auto topic_handle = graph->add_graph_change_callback(
+    rclcpp::GraphEntityKind::Topic, "graph_change_topic",
+    [&mutex, &topic_changes](const rclcpp::GraphChange & change) {
+      std::lock_guard<std::mutex> lock(mutex);
+      topic_changes.push_back(change);
+    });
+  EXPECT_EQ("/ns/graph_change_topic", topic_handle->name);
+  auto other_topic_handle = graph->add_graph_change_callback(
+    rclcpp::GraphEntityKind::Topic, "graph_change_other_topic",
+    [&mutex, &other_topic_changes](const rclcpp::GraphChange &) {
+      std::lock_guard<std::mutex> lock(mutex);
+      ++other_topic_changes;
+    });
+
+  auto wait_for_changes = [&mutex, &topic_changes](size_t number_of_changes) {
+      auto start = std::chrono::steady_clock::now();
+      while (std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (topic_changes.size() >= number_of_changes) {
+            return;
+          }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    };
+
+  auto publisher = node->create_publisher<test_msgs::msg::BasicTypes>("graph_change_topic", 10);
+  wait_for_changes(1);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(1u, topic_changes.size());
+    EXPECT_EQ(rclcpp::GraphEntityKind::Topic, topic_changes[0].kind);
+    EXPECT_FALSE(topic_changes[0].existed);
+    EXPECT_TRUE(topic_changes[0].exists);
+    ASSERT_EQ(1u, topic_changes[0].added_endpoints.size());
+    EXPECT_EQ(rclcpp::EndpointType::Publisher, topic_changes[0].added_endpoints[0].endpoint_type());
+    EXPECT_TRUE(topic_changes[0].removed_endpoints.empty());
+    EXPECT_EQ(0u, other_topic_changes);
+  }
+
+  publisher.reset();
+  wait_for_changes(2);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(2u, topic_changes.size());
+    EXPECT_TRUE(topic_changes[1].existed);
+    EXPECT_FALSE(topic_changes[1].exists);
+    EXPECT_EQ(1u, topic_changes[1].removed_endpoints.size());
+    EXPECT_EQ(0u, other_topic_changes);
+  }
+
+  // The callback isn't called once its handle is destroyed.
+  topic_handle.reset();
+  publisher = node->create_publisher<test_msgs::msg::BasicTypes>("graph_change_topic", 10);
+  auto subscription = node->create_subscription<test_msgs::msg::BasicTypes>(
+    "graph_change_other_topic", 10, [](test_msgs::msg::BasicTypes::SharedPtr) {});
+  auto start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (other_topic_changes > 0) {
+        break;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ(1u, other_topic_changes);
+  EXPECT_EQ(2u, topic_changes.size());
+}
+
+TEST_F(TestNode, endpoint_info_from_graph_cache) {
+  auto node = std::make_shared<rclcpp::Node>(
+    "endpoint_info_node", "/ns", rclcpp::NodeOptions().use_graph_cache(true));
+  std::vector<rclcpp::TopicEndpointInfo> endpoints;
+  node->get_node_graph_interface()->get_publishers_info_by_topic("endpoint_info_topic", endpoints);
+  EXPECT_TRUE(endpoints.empty());
+
+  auto publisher = node->create_publisher<test_msgs::msg::BasicTypes>(
+    "endpoint_info_topic", rclcpp::QoS(10).reliable());
+  auto start = std::chrono::steady_clock::now();
+  while (endpoints.empty() &&
+    std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    node->get_node_graph_interface()->get_publishers_info_by_topic(
+      "endpoint_info_topic", endpoints);
+  }
+  ASSERT_EQ(1u, endpoints.size());
+  EXPECT_EQ("endpoint_info_node", endpoints[0].node_name());
+  EXPECT_EQ(
+    RMW_QOS_POLICY_RELIABILITY_RELIABLE,
+    endpoints[0].qos_profile().get_rmw_qos_profile().reliability);
+  EXPECT_EQ(1u, node->get_publishers_info_by_topic("endpoint_info_topic").size());
+
+  // The content of the vector is replaced.
+  node->get_node_graph_interface()->get_subscriptions_info_by_topic(
+    "endpoint_info_topic", endpoints);
+  EXPECT_TRUE(endpoints.empty());
+}
+
+TEST_F(TestNode, share_participant) {
+  rclcpp::InitOptions init_options;
+  init_options.share_participant = true;
+  auto context = rclcpp::Context::make_shared();
+  context->init(0, nullptr, init_options);
+  RCLCPP_SCOPE_EXIT({context->shutdown("test finished");});
+
+  auto talker = std::make_shared<rclcpp::Node>(
+    "talker", "ns", rclcpp::NodeOptions().context(context)
+    .arguments({"--ros-args", "-r", "chatter:=remapped_chatter"}));
+  auto listener = std::make_shared<rclcpp::Node>(
+    "listener", "/other_ns", rclcpp::NodeOptions().context(context)
+    .arguments({"--ros-args", "-r", "__node:=renamed_listener"}));
+  EXPECT_TRUE(talker->get_node_base_interface()->shares_rcl_node());
+  EXPECT_EQ(
+    talker->get_node_base_interface()->get_rcl_node_handle(),
+    listener->get_node_base_interface()->get_rcl_node_handle());
+  EXPECT_STREQ("talker", talker->get_name());
+  EXPECT_STREQ("/ns", talker->get_namespace());
+  EXPECT_STREQ("/ns/talker", talker->get_fully_qualified_name());
+  EXPECT_STREQ("ns.talker", talker->get_logger().get_name());
+  EXPECT_STREQ("renamed_listener", listener->get_name());
+  EXPECT_STREQ("/other_ns/renamed_listener", listener->get_fully_qualified_name());
+
+  // The names of the entities are resolved with the node which creates them.
+  auto publisher = talker->create_publisher<test_msgs::msg::BasicTypes>("chatter", 10);
+  EXPECT_STREQ("/ns/remapped_chatter", publisher->get_topic_name());
+  std::atomic<size_t> received{0};
+  auto subscription = listener->create_subscription<test_msgs::msg::BasicTypes>(
+    "/ns/remapped_chatter", 10,
+    [&received](const test_msgs::msg::BasicTypes::SharedPtr) {received++;});
+  EXPECT_STREQ("/ns/remapped_chatter", subscription->get_topic_name());
+
+  rclcpp::executor::ExecutorArgs executor_args;
+  executor_args.context = context;
+  rclcpp::executors::SingleThreadedExecutor executor(executor_args);
+  executor.add_node(listener);
+  auto start = std::chrono::steady_clock::now();
+  while (received == 0u && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    publisher->publish(test_msgs::msg::BasicTypes());
+    executor.spin_some(std::chrono::milliseconds(10));
+  }
+  EXPECT_NE(0u, received.load());
+
+  // The participant is released with the last node.
+  std::weak_ptr<const rcl_node_t> rcl_node =
+    talker->get_node_base_interface()->get_shared_rcl_node_handle();
+  executor.remove_node(listener);
+  publisher.reset();
+  subscription.reset();
+  talker.reset();
+  EXPECT_FALSE(rcl_node.expired());
+  listener.reset();
+  EXPECT_TRUE(rcl_node.expired());
+}
+
+TEST_F(TestNode, entity_creation_batch) {
+  auto node = std::make_shared<rclcpp::Node>("node", "ns");
+  auto node_base = node->get_node_base_interface();
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  ASSERT_EQ(
+    RCL_RET_OK, rcl_wait_set_init(
+      &wait_set, 0, 1, 0, 0, 0, 0, node_base->get_context()->get_rcl_context().get(),
+      rcl_get_default_allocator()));
+  auto wait = [&wait_set, &node_base]() {
+      EXPECT_EQ(RCL_RET_OK, rcl_wait_set_clear(&wait_set));
+      EXPECT_EQ(
+        RCL_RET_OK,
+        rcl_wait_set_add_guard_condition(
+          &wait_set, node_base->get_notify_guard_condition(), NULL));
+      return rcl_wait(&wait_set, RCL_MS_TO_NS(10));
+    };
+  // Consume the triggers of the creation of the node.
+  wait();
+
+  std::vector<rclcpp::Publisher<test_msgs::msg::BasicTypes>::SharedPtr> publishers;
+  {
+    rclcpp::node_interfaces::EntityCreationBatch outer_batch(*node_base);
+    {
+      rclcpp::node_interfaces::EntityCreationBatch inner_batch(*node_base);
+      publishers.push_back(node->create_publisher<test_msgs::msg::BasicTypes>("topic_a", 1));
+    }
+    publishers.push_back(node->create_publisher<test_msgs::msg::BasicTypes>("topic_b", 1));
+    EXPECT_EQ(RCL_RET_TIMEOUT, wait());
+  }
+  EXPECT_EQ(RCL_RET_OK, wait());
+  EXPECT_EQ(RCL_RET_TIMEOUT, wait());
+
+  // Without a batch, each creation triggers it.
+  publishers.push_back(node->create_publisher<test_msgs::msg::BasicTypes>("topic_c", 1));
+  EXPECT_EQ(RCL_RET_OK, wait());
+  EXPECT_EQ(RCL_RET_OK, rcl_wait_set_fini(&wait_set));
+}
+
+TEST_F(TestNode, restore_parameter_snapshot) {
+  const char * tmpdir = std::getenv("TMPDIR");
+  std::string path = std::string(tmpdir ? tmpdir : "/tmp") + "/rclcpp_test_node_snapshot";
+  std::remove(path.c_str());
+  auto scope_exit = rclcpp::make_scope_exit(
+    [&path]() {
+      std::remove(path.c_str());
+    });
+
+  // Without a snapshot, the node starts from the defaults.
+  auto options = rclcpp::NodeOptions()
+    .parameter_snapshot_path(path)
+    .parameter_overrides({{"overridden", 1}});
+  {
+    auto node = std::make_shared<rclcpp::Node>("snapshot_node", "/ns", options);
+    EXPECT_EQ(0, node->declare_parameter("calibration", 0));
+    EXPECT_EQ(1, node->declare_parameter("overridden", 0));
+    node->set_parameter(rclcpp::Parameter("calibration", 42));
+    node->set_parameter(rclcpp::Parameter("overridden", 2));
+    auto node_parameters = std::dynamic_pointer_cast<rclcpp::node_interfaces::NodeParameters>(
+      node->get_node_parameters_interface());
+    ASSERT_NE(nullptr, node_parameters);
+    node_parameters->save_parameters_snapshot(path);
+  }
+
+  // The snapshot overrides the defaults, and the parameter overrides of the options win.
+  auto node = std::make_shared<rclcpp::Node>("snapshot_node", "/ns", options);
+  EXPECT_EQ(42, node->declare_parameter("calibration", 0));
+  EXPECT_EQ(1, node->declare_parameter("overridden", 0));
+}
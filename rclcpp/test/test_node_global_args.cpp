@@ -28,7 +28,8 @@ class TestNodeWithGlobalArgs : public ::testing::Test
 protected:
   static void SetUpTestCase()
   {
-    const char * const args[] = {"proc", "--ros-args", "-r", "__node:=global_node_name"};
+    const char * const args[] = {
+      "proc", "--ros-args", "-r", "__node:=global_node_name", "-p", "global_parameter:=42"};
     const int argc = sizeof(args) / sizeof(const char *);
     rclcpp::init(argc, args);
   }
@@ -58,3 +59,23 @@ TEST_F(TestNodeWithGlobalArgs, use_or_ignore_global_arguments) {
     EXPECT_STREQ("global_node_name", node->get_name());
   }
 }
+
+TEST_F(TestNodeWithGlobalArgs, global_parameter_overrides) {
+  // The global overrides are converted once, and given to each node of the context.
+  for (int i = 0; i < 2; ++i) {
+    auto node = rclcpp::Node::make_shared("orig_name");
+    EXPECT_EQ(42, node->declare_parameter("global_parameter", 0));
+  }
+  {  // Local arguments overwrite them
+    auto options = rclcpp::NodeOptions()
+      .arguments({"--ros-args", "-p", "global_parameter:=43"});
+    auto node = rclcpp::Node::make_shared("orig_name", options);
+    EXPECT_EQ(43, node->declare_parameter("global_parameter", 0));
+  }
+  {  // Or are ignored with them
+    auto options = rclcpp::NodeOptions()
+      .use_global_arguments(false);
+    auto node = rclcpp::Node::make_shared("orig_name", options);
+    EXPECT_EQ(0, node->declare_parameter("global_parameter", 0));
+  }
+}
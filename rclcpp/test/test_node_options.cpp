@@ -14,6 +14,7 @@
 
 #include <gtest/gtest.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -136,3 +137,28 @@ TEST(TestNodeOptions, enable_rosout) {
     EXPECT_TRUE(options.get_rcl_node_options()->enable_rosout);
   }
 }
+
+TEST(TestNodeOptions, entity_arena) {
+  auto options = rclcpp::NodeOptions();
+  EXPECT_EQ(nullptr, options.entity_arena());
+
+  auto arena = std::make_shared<rclcpp::allocator::Arena>(1024);
+  options.entity_arena(arena);
+  EXPECT_EQ(arena, options.entity_arena());
+  EXPECT_EQ(arena, rclcpp::NodeOptions(options).entity_arena());
+}
+
+TEST(TestNodeOptions, lightweight) {
+  auto options = rclcpp::NodeOptions().use_intra_process_comms(true).lightweight();
+  EXPECT_FALSE(options.enable_rosout());
+  EXPECT_FALSE(options.get_rcl_node_options()->enable_rosout);
+  EXPECT_FALSE(options.start_parameter_services());
+  EXPECT_TRUE(options.start_parameter_event_publisher());
+  EXPECT_TRUE(options.lazy_parameter_event_publisher());
+  // The other options are kept.
+  EXPECT_TRUE(options.use_intra_process_comms());
+
+  auto copy = rclcpp::NodeOptions(options);
+  EXPECT_FALSE(copy.start_parameter_services());
+  EXPECT_TRUE(copy.lazy_parameter_event_publisher());
+}
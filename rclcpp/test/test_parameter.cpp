@@ -767,3 +767,27 @@ TEST(TestParameter, string_array_variant) {
     rcl_interfaces::msg::ParameterType::PARAMETER_STRING_ARRAY,
     from_msg.get_value_message().type);
 }
+
+TEST(TestParameter, value_copies) {
+  const std::vector<std::string> names {"a", "b", "a string longer than the inline storage"};
+  rclcpp::ParameterValue value(names);
+  rclcpp::ParameterValue copy = value;
+  EXPECT_EQ(value, copy);
+  // The copies of an array share it.
+  EXPECT_EQ(
+    &value.get<rclcpp::PARAMETER_STRING_ARRAY>(), &copy.get<rclcpp::PARAMETER_STRING_ARRAY>());
+  EXPECT_EQ(names, copy.get<rclcpp::PARAMETER_STRING_ARRAY>());
+
+  // Equality compares the member of the type only.
+  EXPECT_NE(rclcpp::ParameterValue(0), rclcpp::ParameterValue(false));
+  EXPECT_NE(rclcpp::ParameterValue(std::vector<double>{}), rclcpp::ParameterValue());
+  EXPECT_EQ(
+    rclcpp::ParameterValue(std::vector<int>{1, 2}),
+    rclcpp::ParameterValue(std::vector<int64_t>{1, 2}));
+
+  rcl_interfaces::msg::ParameterValue message = value.to_value_msg();
+  EXPECT_EQ(rclcpp::PARAMETER_STRING_ARRAY, message.type);
+  EXPECT_EQ(names, message.string_array_value);
+  EXPECT_TRUE(message.string_value.empty());
+  EXPECT_EQ(value, rclcpp::ParameterValue(message));
+}
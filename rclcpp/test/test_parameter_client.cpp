@@ -14,8 +14,11 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <string>
 #include <memory>
+#include <stdexcept>
+#include <vector>
 
 #include "rclcpp/rclcpp.hpp"
 
@@ -159,3 +162,64 @@ TEST_F(TestParameterClient, sync_parameter_event_subscription) {
     (void)event_sub;
   }
 }
+
+/*
+   Testing a multi-node client getting parameters of several nodes, some requests queued.
+ */
+TEST_F(TestParameterClient, multi_node_get_parameters) {
+  std::vector<rclcpp::Node::SharedPtr> remote_nodes;
+  std::vector<std::string> node_names;
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  for (int i = 0; i < 3; ++i) {
+    auto remote_node = std::make_shared<rclcpp::Node>("remote_" + std::to_string(i), "/ns");
+    remote_node->declare_parameter("index", i);
+    remote_nodes.push_back(remote_node);
+    node_names.push_back(remote_node->get_fully_qualified_name());
+    executor.add_node(remote_node);
+  }
+  node_names.push_back("/ns/missing");
+
+  EXPECT_THROW(rclcpp::MultiNodeParametersClient(node, 0), std::invalid_argument);
+
+  rclcpp::MultiNodeParametersClient client(node, 2);
+  for (const auto & remote_node : remote_nodes) {
+    auto names = node->get_node_graph_interface()->get_service_names_and_types();
+    while (names.count(std::string(remote_node->get_fully_qualified_name()) +
+      "/get_parameters") == 0)
+    {
+      executor.spin_some();
+      names = node->get_node_graph_interface()->get_service_names_and_types();
+    }
+  }
+
+  bool called = false;
+  auto future = client.get_parameters(
+    node_names, {"index"},
+    [&called](rclcpp::MultiNodeParametersClient::SharedFuture) {called = true;},
+    std::chrono::seconds(1));
+  EXPECT_EQ(2u, client.get_number_of_requests_in_flight());
+  EXPECT_EQ(2u, client.get_number_of_queued_requests());
+
+  ASSERT_EQ(
+    rclcpp::executor::FutureReturnCode::SUCCESS,
+    executor.spin_until_future_complete(future, std::chrono::seconds(5)));
+  EXPECT_TRUE(called);
+  auto result = future.get();
+  ASSERT_EQ(3u, result.size());
+  for (int i = 0; i < 3; ++i) {
+    const auto & parameters = result.at(node_names[i]);
+    ASSERT_EQ(1u, parameters.size());
+    EXPECT_EQ(i, parameters[0].as_int());
+  }
+  EXPECT_EQ(0u, client.get_number_of_requests_in_flight());
+  EXPECT_EQ(4u, client.get_number_of_clients());
+
+  // The clients are reused.
+  future = client.get_parameters({node_names[0]}, {"index"});
+  ASSERT_EQ(
+    rclcpp::executor::FutureReturnCode::SUCCESS,
+    executor.spin_until_future_complete(future, std::chrono::seconds(5)));
+  EXPECT_EQ(1u, future.get().size());
+  EXPECT_EQ(4u, client.get_number_of_clients());
+}
@@ -16,6 +16,8 @@
 
 #include <string>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/parameter_events_filter.hpp"
@@ -203,3 +205,30 @@ TEST_F(TestParameterEventFilter, validate_data) {
   EXPECT_EQ(1, res.get_events()[0].second->value.integer_value);
   EXPECT_EQ(2, res.get_events()[1].second->value.integer_value);
 }
+
+TEST_F(TestParameterEventFilter, criteria) {
+  rclcpp::ParameterEventsFilter::Criteria criteria({"new", "deleted"}, {nt, dt});
+  EXPECT_TRUE(criteria.matches(nt));
+  EXPECT_FALSE(criteria.matches(ct));
+  EXPECT_TRUE(criteria.matches(dt));
+  EXPECT_TRUE(criteria.matches(std::string("new")));
+  EXPECT_FALSE(criteria.matches(std::string("changed")));
+
+  // The same criteria filter several events.
+  EXPECT_EQ(2u, rclcpp::ParameterEventsFilter(full, criteria).get_events().size());
+  EXPECT_EQ(1u, rclcpp::ParameterEventsFilter(multiple, criteria).get_events().size());
+  EXPECT_EQ(0u, rclcpp::ParameterEventsFilter(cp, criteria).get_events().size());
+
+  std::vector<std::pair<rclcpp::ParameterEventsFilter::EventType, std::string>> matches;
+  criteria.for_each_match(
+    *full,
+    [&matches](
+      rclcpp::ParameterEventsFilter::EventType type, const rcl_interfaces::msg::Parameter & p) {
+      matches.emplace_back(type, p.name);
+    });
+  ASSERT_EQ(2u, matches.size());
+  EXPECT_EQ(nt, matches[0].first);
+  EXPECT_EQ("new", matches[0].second);
+  EXPECT_EQ(dt, matches[1].first);
+  EXPECT_EQ("deleted", matches[1].second);
+}
@@ -18,6 +18,9 @@
 #include <rcutils/strdup.h>
 
 #include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
 #include <string>
 #include <vector>
 
@@ -353,3 +356,69 @@ TEST(Test_parameter_map_from, string_array_param_value)
   c_params->params[0].parameter_values[0].string_array_value = NULL;
   rcl_yaml_node_struct_fini(c_params);
 }
+
+namespace
+{
+
+std::string
+snapshot_path(const std::string & test_name)
+{
+  const char * tmpdir = std::getenv("TMPDIR");
+  return std::string(tmpdir ? tmpdir : "/tmp") + "/rclcpp_test_parameter_snapshot_" + test_name;
+}
+
+}  // namespace
+
+TEST(Test_parameter_snapshot, round_trip)
+{
+  std::vector<rclcpp::Parameter> parameters = {
+    rclcpp::Parameter("bool", true),
+    rclcpp::Parameter("integer", int64_t(-42)),
+    rclcpp::Parameter("double", 3.5),
+    rclcpp::Parameter("string", "value"),
+    rclcpp::Parameter("empty_string", ""),
+    rclcpp::Parameter("bytes", std::vector<uint8_t>{0, 255}),
+    rclcpp::Parameter("bools", std::vector<bool>{true, false, true}),
+    rclcpp::Parameter("integers", std::vector<int64_t>{1, 2, 3}),
+    rclcpp::Parameter("doubles", std::vector<double>{}),
+    rclcpp::Parameter("strings", std::vector<std::string>{"Hello", "", "World"}),
+  };
+  std::string path = snapshot_path("round_trip");
+  rclcpp::write_parameter_snapshot(path, parameters);
+  std::vector<rclcpp::Parameter> restored = rclcpp::read_parameter_snapshot(path);
+  std::remove(path.c_str());
+
+  ASSERT_EQ(parameters.size(), restored.size());
+  for (size_t i = 0; i < parameters.size(); ++i) {
+    EXPECT_EQ(parameters[i], restored[i]) << parameters[i].get_name();
+  }
+}
+
+TEST(Test_parameter_snapshot, invalid_file)
+{
+  std::string path = snapshot_path("invalid_file");
+  EXPECT_THROW(rclcpp::read_parameter_snapshot(path), std::runtime_error);
+
+  {
+    std::ofstream stream(path);
+    stream << "foo: 1";
+  }
+  EXPECT_THROW(
+    rclcpp::read_parameter_snapshot(path), rclcpp::exceptions::InvalidParametersException);
+
+  // A truncated snapshot is rejected, not read past its end.
+  rclcpp::write_parameter_snapshot(
+    path, {rclcpp::Parameter("strings", std::vector<std::string>{"Hello", "World"})});
+  std::string content;
+  {
+    std::ifstream stream(path, std::ios::binary);
+    content.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream.write(content.data(), static_cast<std::streamsize>(content.size() - 1));
+  }
+  EXPECT_THROW(
+    rclcpp::read_parameter_snapshot(path), rclcpp::exceptions::InvalidParametersException);
+  std::remove(path.c_str());
+}
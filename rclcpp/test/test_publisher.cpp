@@ -14,13 +14,18 @@
 
 #include <gtest/gtest.h>
 
-#include <string>
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/rclcpp.hpp"
 
+#include "test_msgs/msg/basic_types.hpp"
 #include "test_msgs/msg/empty.hpp"
 
 class TestPublisher : public ::testing::Test
@@ -143,6 +148,207 @@ TEST_F(TestPublisher, various_creation_signatures) {
   }
 }
 
+/*
+   Testing serialized messages with intraprocess enabled.
+ */
+TEST_F(TestPublisher, intra_process_serialized_messages) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  auto publisher = node->create_publisher<BasicTypes>("topic", 10);
+
+  std::vector<std::shared_ptr<rcl_serialized_message_t>> serialized_msgs;
+  auto serialized_subscription = node->create_subscription<BasicTypes>(
+    "topic", 10,
+    [&serialized_msgs](std::shared_ptr<rcl_serialized_message_t> msg) {
+      serialized_msgs.push_back(msg);
+    });
+  std::vector<int32_t> values;
+  auto subscription = node->create_subscription<BasicTypes>(
+    "topic", 10,
+    [&values](BasicTypes::ConstSharedPtr msg) {values.push_back(msg->int32_value);});
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+
+  // A typed message is serialized once for the serialized subscription.
+  BasicTypes msg;
+  msg.int32_value = 42;
+  publisher->publish(msg);
+  executor.spin_some();
+  ASSERT_EQ(1u, serialized_msgs.size());
+  ASSERT_EQ(1u, values.size());
+  EXPECT_EQ(42, values[0]);
+
+  // A serialized message is deserialized once for the typed subscription.
+  publisher->publish(*serialized_msgs[0]);
+  executor.spin_some();
+  ASSERT_EQ(2u, serialized_msgs.size());
+  EXPECT_EQ(serialized_msgs[0]->buffer_length, serialized_msgs[1]->buffer_length);
+  ASSERT_EQ(2u, values.size());
+  EXPECT_EQ(42, values[1]);
+}
+
+/*
+   Testing publishing a batch of messages and of unique pointers intra-process.
+ */
+TEST_F(TestPublisher, intra_process_publish_batch) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  auto publisher = node->create_publisher<BasicTypes>("topic", 10);
+
+  std::vector<int32_t> shared_values;
+  auto shared_subscription = node->create_subscription<BasicTypes>(
+    "topic", 10,
+    [&shared_values](BasicTypes::ConstSharedPtr msg) {
+      shared_values.push_back(msg->int32_value);
+    });
+  std::vector<int32_t> unique_values;
+  auto unique_subscription = node->create_subscription<BasicTypes>(
+    "topic", 10,
+    [&unique_values](BasicTypes::UniquePtr msg) {unique_values.push_back(msg->int32_value);});
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+
+  std::vector<BasicTypes> msgs(3);
+  for (size_t i = 0; i < msgs.size(); ++i) {
+    msgs[i].int32_value = static_cast<int32_t>(i);
+  }
+  publisher->publish_batch(msgs.begin(), msgs.end());
+  executor.spin_some();
+  EXPECT_EQ(std::vector<int32_t>({0, 1, 2}), shared_values);
+  EXPECT_EQ(std::vector<int32_t>({0, 1, 2}), unique_values);
+
+  std::vector<BasicTypes::UniquePtr> unique_msgs;
+  for (int32_t i = 3; i < 5; ++i) {
+    unique_msgs.emplace_back(new BasicTypes());
+    unique_msgs.back()->int32_value = i;
+  }
+  publisher->publish_batch(unique_msgs.begin(), unique_msgs.end());
+  EXPECT_EQ(nullptr, unique_msgs[0]);
+  executor.spin_some();
+  EXPECT_EQ(std::vector<int32_t>({0, 1, 2, 3, 4}), shared_values);
+  EXPECT_EQ(std::vector<int32_t>({0, 1, 2, 3, 4}), unique_values);
+
+  unique_msgs.clear();
+  unique_msgs.emplace_back(nullptr);
+  EXPECT_THROW(
+    publisher->publish_batch(unique_msgs.begin(), unique_msgs.end()), std::runtime_error);
+}
+
+/*
+   Asynchronous publishers queue the messages, which the sender thread of the context writes.
+ */
+TEST_F(TestPublisher, async_publish) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  auto sync_publisher = node->create_publisher<BasicTypes>("topic", 10);
+  EXPECT_FALSE(sync_publisher->is_async_publish_enabled());
+  EXPECT_THROW(sync_publisher->get_async_publish_statistics(), std::runtime_error);
+
+  rclcpp::PublisherOptions options;
+  options.async_publish.enabled = true;
+  options.async_publish.queue_depth = 16;
+  auto publisher = node->create_publisher<BasicTypes>("topic", 10, options);
+  EXPECT_TRUE(publisher->is_async_publish_enabled());
+
+  BasicTypes msg;
+  for (int32_t i = 0; i < 5; ++i) {
+    msg.int32_value = i;
+    publisher->publish(msg);
+  }
+  publisher->publish(std::make_unique<BasicTypes>(msg));
+  std::vector<BasicTypes> msgs(2);
+  publisher->publish_batch(msgs.begin(), msgs.end());
+
+  auto start = std::chrono::steady_clock::now();
+  auto statistics = publisher->get_async_publish_statistics();
+  while (statistics.published_count + statistics.dropped_count < 8u &&
+    std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    statistics = publisher->get_async_publish_statistics();
+  }
+  EXPECT_EQ(8u, statistics.published_count);
+  EXPECT_EQ(0u, statistics.dropped_count);
+  EXPECT_EQ(0u, statistics.queue_depth);
+  EXPECT_LE(1u, statistics.max_queue_depth);
+  EXPECT_LE(statistics.last_latency, statistics.max_latency);
+  EXPECT_LE(statistics.max_latency, statistics.total_latency);
+}
+
+/*
+   A cached subscription count follows the subscriptions created and destroyed later.
+ */
+TEST_F(TestPublisher, cached_subscription_count) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::Empty;
+  rclcpp::PublisherOptions options;
+  options.cache_subscription_count = true;
+  auto publisher = node->create_publisher<Empty>("cached_count_topic", 10, options);
+  EXPECT_TRUE(publisher->is_subscription_count_cache_requested());
+  EXPECT_EQ(0u, publisher->get_subscription_count());
+  EXPECT_EQ(0u, publisher->get_intra_process_subscription_count());
+
+  auto wait_for_count = [&publisher](size_t count) {
+      auto start = std::chrono::steady_clock::now();
+      while (publisher->get_subscription_count() != count &&
+        std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      return publisher->get_subscription_count();
+    };
+  {
+    auto subscription = node->create_subscription<Empty>(
+      "cached_count_topic", 10, [](Empty::SharedPtr) {});
+    EXPECT_EQ(1u, publisher->get_intra_process_subscription_count());
+    EXPECT_EQ(1u, wait_for_count(1u));
+  }
+  EXPECT_EQ(0u, publisher->get_intra_process_subscription_count());
+  EXPECT_EQ(0u, wait_for_count(0u));
+}
+
+/*
+   Testing that identical publishers share the writer, and are counted separately.
+ */
+TEST_F(TestPublisher, share_writer) {
+  initialize();
+  using test_msgs::msg::Empty;
+  auto other_node = std::make_shared<rclcpp::Node>("test_publisher_other", "/ns");
+  rclcpp::PublisherOptions options;
+  options.share_writer = true;
+  auto publisher1 = node->create_publisher<Empty>("shared_writer_topic", 10, options);
+  auto publisher2 = other_node->create_publisher<Empty>("shared_writer_topic", 10, options);
+  auto other_qos_publisher = node->create_publisher<Empty>("shared_writer_topic", 5, options);
+  EXPECT_TRUE(publisher1->has_shared_writer());
+  EXPECT_EQ(publisher1->get_publisher_handle(), publisher2->get_publisher_handle());
+  EXPECT_NE(publisher1->get_publisher_handle(), other_qos_publisher->get_publisher_handle());
+
+  auto start = std::chrono::steady_clock::now();
+  while (node->count_publishers("shared_writer_topic") != 3u &&
+    std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(3u, node->count_publishers("shared_writer_topic"));
+
+  // The writer is kept by the remaining publisher.
+  publisher1.reset();
+  EXPECT_EQ(2u, node->count_publishers("shared_writer_topic"));
+  std::atomic<size_t> received{0};
+  auto subscription = node->create_subscription<Empty>(
+    "shared_writer_topic", 10, [&received](Empty::SharedPtr) {received++;});
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  start = std::chrono::steady_clock::now();
+  while (received == 0u && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    publisher2->publish(Empty());
+    executor.spin_some(std::chrono::milliseconds(100));
+  }
+  EXPECT_LT(0u, received.load());
+}
+
 /*
    Testing publisher with intraprocess enabled and invalid QoS
  */
@@ -161,15 +367,11 @@ static std::vector<TestParameters> invalid_qos_profiles()
 {
   std::vector<TestParameters> parameters;
 
-  parameters.reserve(2);
-  parameters.push_back(
-    TestParameters(
-      rclcpp::QoS(rclcpp::KeepLast(10)).transient_local(),
-      "transient_local_qos"));
+  parameters.reserve(1);
   parameters.push_back(
     TestParameters(
-      rclcpp::QoS(rclcpp::KeepAll()),
-      "keep_all_qos"));
+      rclcpp::QoS(rclcpp::KeepLast(0)),
+      "zero_depth_qos"));
 
   return parameters;
 }
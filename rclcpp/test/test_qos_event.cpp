@@ -16,7 +16,9 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "rclcpp/detail/qos_event_handler_group.hpp"
 #include "rclcpp/rclcpp.hpp"
 #include "rmw/rmw.h"
 #include "test_msgs/msg/empty.hpp"
@@ -150,3 +152,41 @@ TEST_F(TestQosEvent, test_subscription_constructor)
     EXPECT_TRUE(is_fastrtps);
   }
 }
+
+/*
+   Testing the event handlers of the entities of a node are batched in one waitable.
+ */
+TEST_F(TestQosEvent, test_event_handlers_batched)
+{
+  rclcpp::PublisherOptions options;
+  options.event_callbacks.deadline_callback = [](rclcpp::QOSDeadlineOfferedInfo &) {};
+  options.event_callbacks.liveliness_callback = [](rclcpp::QOSLivelinessLostInfo &) {};
+
+  std::vector<rclcpp::Publisher<test_msgs::msg::Empty>::SharedPtr> publishers;
+  for (size_t i = 0; i < 3; ++i) {
+    publishers.push_back(
+      node->create_publisher<test_msgs::msg::Empty>(topic_name, 10, options));
+  }
+
+  auto callback_group = node->get_node_base_interface()->get_default_callback_group();
+  size_t number_of_waitables = 0;
+  rclcpp::detail::QOSEventHandlerGroup::SharedPtr event_handler_group;
+  callback_group->find_waitable_ptrs_if(
+    [&](const rclcpp::Waitable::SharedPtr & waitable) {
+      number_of_waitables++;
+      event_handler_group =
+      std::dynamic_pointer_cast<rclcpp::detail::QOSEventHandlerGroup>(waitable);
+      return false;
+    });
+  EXPECT_EQ(1u, number_of_waitables);
+  ASSERT_NE(nullptr, event_handler_group);
+  EXPECT_EQ(6u, event_handler_group->size());
+  EXPECT_EQ(6u, event_handler_group->get_number_of_ready_events());
+
+  // The handlers of a destroyed publisher aren't waited on anymore.
+  publishers.pop_back();
+  EXPECT_EQ(4u, event_handler_group->size());
+  EXPECT_EQ(4u, event_handler_group->get_number_of_ready_events());
+  publishers.clear();
+  EXPECT_EQ(0u, event_handler_group->get_number_of_ready_events());
+}
@@ -98,3 +98,22 @@ TEST(TestRate, wall_rate_basics) {
   delta = five - four;
   ASSERT_TRUE(epsilon > delta);
 }
+
+TEST(TestRate, spin_threshold) {
+  auto period = std::chrono::milliseconds(10);
+  auto spin_threshold = std::chrono::milliseconds(2);
+
+  auto start = std::chrono::steady_clock::now();
+  rclcpp::WallRate r(period);
+  EXPECT_EQ(std::chrono::nanoseconds::zero(), r.spin_threshold());
+  r.set_spin_threshold(spin_threshold);
+  EXPECT_EQ(spin_threshold, r.spin_threshold());
+
+  for (int i = 1; i <= 5; ++i) {
+    ASSERT_TRUE(r.sleep());
+    // The spin ends as soon as the interval is reached
+    auto delta = std::chrono::steady_clock::now() - start;
+    ASSERT_TRUE(i * period <= delta);
+    ASSERT_TRUE(i * period + spin_threshold > delta);
+  }
+}
@@ -0,0 +1,117 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/strategies/ready_set_memory_strategy.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+
+using rclcpp::memory_strategies::ready_set_memory_strategy::ReadySetMemoryStrategy;
+
+class TestReadySetMemoryStrategy : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  void SetUp()
+  {
+    node = std::make_shared<rclcpp::Node>("test_ready_set_memory_strategy");
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST_F(TestReadySetMemoryStrategy, with_weak_nodes) {
+  auto memory_strategy = std::make_shared<ReadySetMemoryStrategy<>>();
+  auto dead_node = rclcpp::Node::make_shared("dead_node");
+  rclcpp::memory_strategy::MemoryStrategy::WeakNodeList weak_nodes;
+  weak_nodes.push_back(node->get_node_base_interface());
+  weak_nodes.push_back(dead_node->get_node_base_interface());
+  dead_node.reset();
+
+  EXPECT_TRUE(memory_strategy->collect_entities(weak_nodes));
+  memory_strategy->clear_handles();
+}
+
+/*
+   Make sure that all the ready entities are executed, more of them than fit in one word of
+   the ready set.
+ */
+TEST_F(TestReadySetMemoryStrategy, execute_ready_entities) {
+  rclcpp::executor::ExecutorArgs args;
+  args.memory_strategy = std::make_shared<ReadySetMemoryStrategy<>>();
+  rclcpp::executors::SingleThreadedExecutor executor(args);
+
+  const size_t number_of_timers = 100;
+  std::vector<size_t> timer_calls(number_of_timers, 0);
+  std::vector<rclcpp::TimerBase::SharedPtr> timers;
+  for (size_t i = 0; i < number_of_timers; ++i) {
+    timers.push_back(node->create_wall_timer(1ms, [&timer_calls, i]() {timer_calls[i]++;}));
+  }
+  size_t messages = 0;
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "ready_set_topic", 10, [&messages](test_msgs::msg::Empty::SharedPtr) {messages++;});
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("ready_set_topic", 10);
+  executor.add_node(node);
+
+  auto all_called = [&timer_calls, &messages]() {
+      for (size_t calls : timer_calls) {
+        if (!calls) {
+          return false;
+        }
+      }
+      return messages > 0;
+    };
+  auto start = std::chrono::steady_clock::now();
+  while (!all_called() && std::chrono::steady_clock::now() - start < 10s) {
+    publisher->publish(test_msgs::msg::Empty());
+    executor.spin_once(10ms);
+  }
+  EXPECT_TRUE(all_called());
+}
+
+// Make sure that an entity destroyed after the wait is not executed
+TEST_F(TestReadySetMemoryStrategy, destroyed_after_wait) {
+  rclcpp::executor::ExecutorArgs args;
+  args.memory_strategy = std::make_shared<ReadySetMemoryStrategy<>>();
+  rclcpp::executors::SingleThreadedExecutor executor(args);
+
+  size_t first_calls = 0;
+  rclcpp::TimerBase::SharedPtr second;
+  auto first = node->create_wall_timer(1ms, [&first_calls, &second]() {
+        first_calls++;
+        second.reset();
+      });
+  second = node->create_wall_timer(1ms, []() {FAIL() << "timer destroyed before execution";});
+  executor.add_node(node);
+
+  std::this_thread::sleep_for(5ms);
+  auto start = std::chrono::steady_clock::now();
+  while (first_calls < 3 && std::chrono::steady_clock::now() - start < 10s) {
+    executor.spin_once(10ms);
+  }
+  EXPECT_GE(first_calls, 3u);
+}
@@ -0,0 +1,86 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "rclcpp/allocator/message_pool_allocator.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/realtime.hpp"
+
+namespace
+{
+
+struct Prefaultable
+{
+  void
+  prefault()
+  {
+    ++prefault_count;
+  }
+
+  size_t prefault_count = 0;
+};
+
+}  // namespace
+
+/*
+   The warm-ups of the registry are run while the objects exist
+ */
+TEST(TestRealtime, warm_up_registry) {
+  rclcpp::RealtimeWarmUpRegistry registry;
+  auto object = std::make_shared<Prefaultable>();
+  size_t warm_up_count = 0;
+  registry.add(object);
+  registry.add_warm_up([&warm_up_count]() {++warm_up_count;});
+  registry.warm_up();
+  EXPECT_EQ(1u, object->prefault_count);
+  EXPECT_EQ(1u, warm_up_count);
+
+  std::weak_ptr<Prefaultable> weak_object = object;
+  object.reset();
+  registry.warm_up();
+  EXPECT_TRUE(weak_object.expired());
+  EXPECT_EQ(2u, warm_up_count);
+}
+
+/*
+   The options of the context are applied, and the registered pools warmed up
+ */
+TEST(TestRealtime, activate_realtime) {
+  rclcpp::InitOptions init_options;
+  init_options.realtime.stack_prefault_size = 64 * 1024;
+  init_options.realtime.heap_prefault_size = 1024 * 1024;
+  EXPECT_EQ(64u * 1024u, rclcpp::InitOptions(init_options).realtime.stack_prefault_size);
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr, init_options);
+
+  auto pool = std::make_shared<rclcpp::allocator::MessagePool>(4096, 16);
+  void * block = pool->allocate(16);
+  context->get_sub_context<rclcpp::RealtimeWarmUpRegistry>()->add(pool);
+
+  auto report = rclcpp::activate_realtime(context);
+  EXPECT_LE(report.before.minor_faults, report.after.minor_faults);
+  EXPECT_LE(report.before.major_faults, report.after.major_faults);
+  EXPECT_LE(report.after.minor_faults, rclcpp::get_page_fault_counts().minor_faults);
+  EXPECT_EQ(15u, pool->get_free_block_count());
+  pool->deallocate(block);
+
+  // A second activation touches memory which is already resident.
+  report = rclcpp::activate_realtime(context);
+  EXPECT_LE(report.before.minor_faults, report.after.minor_faults);
+  rclcpp::shutdown(context);
+}
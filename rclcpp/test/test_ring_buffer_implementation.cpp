@@ -15,6 +15,7 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -62,10 +63,13 @@ TEST(TestRingBufferImplementation, basic_usage) {
   EXPECT_EQ(true, rb.has_data());
   EXPECT_EQ(true, rb.is_full());
 
+  EXPECT_EQ(0u, rb.get_dropped_count());
+
   rb.enqueue('d');
 
   EXPECT_EQ(true, rb.has_data());
   EXPECT_EQ(true, rb.is_full());
+  EXPECT_EQ(1u, rb.get_dropped_count());
 
   v = rb.dequeue();
 
@@ -79,3 +83,34 @@ TEST(TestRingBufferImplementation, basic_usage) {
   EXPECT_EQ(false, rb.has_data());
   EXPECT_EQ(false, rb.is_full());
 }
+
+/*
+   Dequeue several elements at once
+   - take at most the requested number of elements, appended in order
+   - take the whole backlog, after the buffer wrapped around
+ */
+TEST(TestRingBufferImplementation, dequeue_n) {
+  rclcpp::experimental::buffers::RingBufferImplementation<char> rb(3);
+  std::vector<char> values;
+
+  EXPECT_EQ(0u, rb.dequeue_n(values, 2));
+  EXPECT_TRUE(values.empty());
+
+  rb.enqueue('a');
+  rb.enqueue('b');
+  rb.enqueue('c');
+  EXPECT_EQ(2u, rb.dequeue_n(values, 2));
+  EXPECT_EQ((std::vector<char>{'a', 'b'}), values);
+  EXPECT_EQ(true, rb.has_data());
+
+  rb.enqueue('d');
+  rb.enqueue('e');
+  rb.enqueue('f');
+  EXPECT_EQ(1u, rb.get_dropped_count());
+  EXPECT_EQ(3u, rb.dequeue_n(values, 10));
+  EXPECT_EQ((std::vector<char>{'a', 'b', 'd', 'e', 'f'}), values);
+  EXPECT_EQ(false, rb.has_data());
+
+  rb.enqueue('g');
+  EXPECT_EQ('g', rb.dequeue());
+}
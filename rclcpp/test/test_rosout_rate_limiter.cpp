@@ -0,0 +1,97 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rclcpp/detail/rosout_rate_limiter.hpp"
+#include "rclcpp/logger.hpp"
+#include "rclcpp/logging.hpp"
+#include "rcutils/logging.h"
+
+std::vector<std::string> g_messages;
+
+class TestRosoutRateLimiter : public ::testing::Test
+{
+public:
+  // The rate limiter wraps the output handler in place once per process.
+  static void SetUpTestCase()
+  {
+    ASSERT_EQ(RCUTILS_RET_OK, rcutils_logging_initialize());
+
+    auto output_handler = [](
+      const rcutils_log_location_t *, int, const char *, rcutils_time_point_value_t,
+      const char * format, va_list * args) -> void
+      {
+        char buffer[1024];
+        vsnprintf(buffer, sizeof(buffer), format, *args);
+        g_messages.push_back(buffer);
+      };
+    rcutils_logging_set_output_handler(output_handler);
+  }
+
+  void SetUp()
+  {
+    g_messages.clear();
+  }
+};
+
+TEST_F(TestRosoutRateLimiter, message_rate) {
+  rclcpp::RosoutRateLimit limit;
+  limit.messages_per_second = 1.0;
+  limit.burst_duration = std::chrono::seconds(1);
+  limit.console_when_suppressed = false;
+  rclcpp::detail::add_rosout_rate_limit("limited", limit);
+
+  auto logger = rclcpp::get_logger("limited");
+  for (int i = 0; i < 5; ++i) {
+    RCLCPP_INFO(logger, "message %d", i);
+  }
+  // Other loggers aren't limited.
+  RCLCPP_INFO(rclcpp::get_logger("unlimited"), "unlimited");
+  ASSERT_EQ(2u, g_messages.size());
+  EXPECT_EQ("message 0", g_messages[0]);
+  EXPECT_EQ("unlimited", g_messages[1]);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  RCLCPP_INFO(logger, "message 5");
+  ASSERT_EQ(4u, g_messages.size());
+  EXPECT_EQ(0u, g_messages[2].find("4 messages (0 bytes) were not published to /rosout"));
+  EXPECT_EQ("message 5", g_messages[3]);
+
+  rclcpp::detail::remove_rosout_rate_limit("limited");
+  RCLCPP_INFO(logger, "message 6");
+  EXPECT_EQ(5u, g_messages.size());
+}
+
+TEST_F(TestRosoutRateLimiter, byte_rate) {
+  rclcpp::RosoutRateLimit limit;
+  limit.bytes_per_second = 10;
+  limit.burst_duration = std::chrono::seconds(1);
+  limit.console_when_suppressed = false;
+  rclcpp::detail::add_rosout_rate_limit("bytes", limit);
+
+  auto logger = rclcpp::get_logger("bytes");
+  RCLCPP_INFO(logger, "12345");
+  RCLCPP_INFO(logger, "12345");
+  RCLCPP_INFO(logger, "1");
+  ASSERT_EQ(2u, g_messages.size());
+
+  rclcpp::detail::remove_rosout_rate_limit("bytes");
+}
@@ -0,0 +1,105 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+#include "rclcpp/experimental/buffers/segmented_buffer_implementation.hpp"
+
+using rclcpp::experimental::buffers::SegmentedBufferImplementation;
+
+/*
+   Constructor
+ */
+TEST(TestSegmentedBufferImplementation, constructor) {
+  // Cannot create segments of size zero.
+  EXPECT_THROW(SegmentedBufferImplementation<int> buffer(0), std::invalid_argument);
+
+  SegmentedBufferImplementation<int> buffer(4);
+  EXPECT_FALSE(buffer.has_data());
+  EXPECT_EQ(0u, buffer.size());
+  EXPECT_EQ(0u, buffer.get_segment_count());
+  EXPECT_THROW(buffer.dequeue(), std::runtime_error);
+}
+
+/*
+   Unbounded usage
+   - a burst larger than a segment is kept in order, spread over several segments
+   - the high-water mark is the size of the burst
+   - the emptied segments are reused
+ */
+TEST(TestSegmentedBufferImplementation, unbounded) {
+  SegmentedBufferImplementation<int> buffer(4);
+
+  for (int i = 0; i < 10; ++i) {
+    buffer.enqueue(i);
+  }
+  EXPECT_EQ(10u, buffer.size());
+  EXPECT_EQ(3u, buffer.get_segment_count());
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(i, buffer.dequeue());
+  }
+  EXPECT_FALSE(buffer.has_data());
+  EXPECT_EQ(10u, buffer.get_high_water_mark());
+  EXPECT_EQ(0u, buffer.get_dropped_count());
+
+  for (int i = 0; i < 6; ++i) {
+    buffer.enqueue(i);
+  }
+  EXPECT_EQ(2u, buffer.get_segment_count());
+  EXPECT_EQ(0, buffer.dequeue());
+  buffer.clear();
+  EXPECT_FALSE(buffer.has_data());
+  EXPECT_EQ(10u, buffer.get_high_water_mark());
+}
+
+/*
+   Bounded usage
+   - the oldest messages are dropped once the capacity is reached
+ */
+TEST(TestSegmentedBufferImplementation, bounded) {
+  SegmentedBufferImplementation<int> buffer(2, 3);
+
+  for (int i = 0; i < 5; ++i) {
+    buffer.enqueue(i);
+  }
+  EXPECT_EQ(3u, buffer.size());
+  EXPECT_EQ(2u, buffer.get_dropped_count());
+  EXPECT_EQ(3u, buffer.get_high_water_mark());
+  EXPECT_TRUE(buffer.is_full());
+  EXPECT_EQ(2, buffer.dequeue());
+  EXPECT_FALSE(buffer.is_full());
+  EXPECT_EQ(3, buffer.dequeue());
+  EXPECT_EQ(4, buffer.dequeue());
+  EXPECT_FALSE(buffer.has_data());
+}
+
+/*
+   The messages are released when they are dequeued or cleared
+ */
+TEST(TestSegmentedBufferImplementation, releases_messages) {
+  SegmentedBufferImplementation<std::shared_ptr<int>> buffer(2);
+  auto message = std::make_shared<int>(42);
+
+  buffer.enqueue(message);
+  buffer.enqueue(message);
+  buffer.enqueue(message);
+  EXPECT_EQ(4, message.use_count());
+  buffer.dequeue();
+  EXPECT_EQ(3, message.use_count());
+  buffer.clear();
+  EXPECT_EQ(1, message.use_count());
+}
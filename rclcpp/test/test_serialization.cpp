@@ -0,0 +1,172 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/serialization.hpp"
+#include "rclcpp/serialized_message.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+#include "test_msgs/msg/unbounded_sequences.hpp"
+
+using test_msgs::msg::BasicTypes;
+using test_msgs::msg::UnboundedSequences;
+
+TEST(TestSerializedMessage, capacity_and_moves) {
+  rclcpp::SerializedMessage empty;
+  EXPECT_EQ(0u, empty.size());
+  EXPECT_EQ(0u, empty.capacity());
+  EXPECT_EQ(nullptr, empty.get_rcl_serialized_message().buffer);
+
+  rclcpp::SerializedMessage message(16);
+  EXPECT_EQ(0u, message.size());
+  EXPECT_EQ(16u, message.capacity());
+  message.reserve(8);
+  EXPECT_EQ(16u, message.capacity());
+  message.reserve(64);
+  EXPECT_EQ(64u, message.capacity());
+
+  auto & rcl_message = message.get_rcl_serialized_message();
+  rcl_message.buffer[0] = 42;
+  rcl_message.buffer_length = 1;
+  const uint8_t * buffer = rcl_message.buffer;
+
+  rclcpp::SerializedMessage copy(message);
+  EXPECT_EQ(1u, copy.size());
+  EXPECT_EQ(42, copy.get_rcl_serialized_message().buffer[0]);
+  EXPECT_NE(buffer, copy.get_rcl_serialized_message().buffer);
+
+  rclcpp::SerializedMessage moved(std::move(message));
+  EXPECT_EQ(buffer, moved.get_rcl_serialized_message().buffer);
+  EXPECT_EQ(1u, moved.size());
+  EXPECT_EQ(0u, message.capacity());  // NOLINT(bugprone-use-after-move)
+
+  moved.clear();
+  EXPECT_EQ(0u, moved.size());
+  EXPECT_EQ(64u, moved.capacity());
+
+  rcl_serialized_message_t released = moved.release_rcl_serialized_message();
+  EXPECT_EQ(buffer, released.buffer);
+  EXPECT_EQ(nullptr, moved.get_rcl_serialized_message().buffer);
+  rclcpp::SerializedMessage adopted(std::move(released));
+  EXPECT_EQ(buffer, adopted.get_rcl_serialized_message().buffer);
+  EXPECT_EQ(nullptr, released.buffer);
+}
+
+TEST(TestSerializedMessage, primitive_arrays) {
+  std::vector<uint32_t> values(37);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = 0x01020304u * static_cast<uint32_t>(i + 1);
+  }
+
+  rclcpp::SerializedMessage message;
+  const uint8_t tag = 7;
+  message.append(&tag, 1);
+  message.align(4);
+  EXPECT_EQ(4u, message.size());
+  message.append_array(values.data(), values.size());
+  message.append_array(values.data(), values.size(), true);
+  EXPECT_EQ(4u + 2u * values.size() * sizeof(uint32_t), message.size());
+  EXPECT_EQ(0, message.get_rcl_serialized_message().buffer[1]);
+
+  std::vector<uint32_t> read(values.size());
+  message.read_array(4, read.data(), read.size());
+  EXPECT_EQ(values, read);
+  const size_t swapped_offset = 4 + values.size() * sizeof(uint32_t);
+  message.read_array(swapped_offset, read.data(), read.size(), true);
+  EXPECT_EQ(values, read);
+  message.read_array(swapped_offset, read.data(), read.size());
+  EXPECT_EQ(0x04030201u, read[0]);
+
+  EXPECT_THROW(
+    message.read_array(swapped_offset + 4, read.data(), read.size()), std::out_of_range);
+  EXPECT_THROW(message.align(0), std::invalid_argument);
+  EXPECT_THROW(
+    rclcpp::copy_primitive_array(read.data(), values.data(), 1, 3, false),
+    std::invalid_argument);
+
+  uint16_t halves[9] = {0x0102, 0x0304, 0x0506, 0x0708, 0x090a, 0x0b0c, 0x0d0e, 0x0f10, 0x1112};
+  rclcpp::copy_primitive_array(halves, halves, 9, sizeof(uint16_t), true);
+  EXPECT_EQ(0x0201, halves[0]);
+  EXPECT_EQ(0x1211, halves[8]);
+}
+
+TEST(TestSerializedMessage, gather_and_scatter) {
+  const char header[] = "head";
+  const char body[] = "body-data";
+  rclcpp::SerializedMessage message;
+  message.gather({{header, 4}, {nullptr, 0}, {body, 9}});
+  EXPECT_EQ(13u, message.size());
+  EXPECT_EQ(13u, message.capacity());
+
+  char first[6] = {};
+  char second[16] = {};
+  EXPECT_EQ(11u, message.scatter(2, {{first, 5}, {second, sizeof(second)}}));
+  EXPECT_EQ(std::string("adbod"), std::string(first, 5));
+  EXPECT_EQ(std::string("y-data"), std::string(second, 6));
+  EXPECT_EQ(0u, message.scatter(13, {{first, 5}}));
+}
+
+TEST(TestSerialization, round_trip) {
+  rclcpp::Serialization<BasicTypes> serialization;
+  BasicTypes message;
+  message.int32_value = 42;
+  message.float64_value = 1.5;
+
+  rclcpp::SerializedMessage serialized_message;
+  serialization.serialize(message, serialized_message);
+  EXPECT_GT(serialized_message.size(), 0u);
+
+  BasicTypes deserialized;
+  serialization.deserialize(serialized_message, deserialized);
+  EXPECT_EQ(message, deserialized);
+
+  // A message owned by someone else is read in place.
+  BasicTypes from_view;
+  serialization.deserialize(serialized_message.get_rcl_serialized_message(), from_view);
+  EXPECT_EQ(message, from_view);
+}
+
+TEST(TestSerialization, reuse_buffer) {
+  rclcpp::Serialization<UnboundedSequences> serialization;
+  UnboundedSequences message;
+  message.uint8_values.resize(1024);
+
+  rclcpp::SerializedMessage serialized_message;
+  serialization.serialize(message, serialized_message);
+  size_t capacity = serialized_message.capacity();
+  const uint8_t * buffer = serialized_message.get_rcl_serialized_message().buffer;
+  ASSERT_GE(capacity, 1024u);
+
+  // Smaller and equal messages are serialized in the same buffer.
+  message.uint8_values.resize(16);
+  serialization.serialize(message, serialized_message);
+  message.uint8_values.resize(1024);
+  serialization.serialize(message, serialized_message);
+  EXPECT_EQ(capacity, serialized_message.capacity());
+  EXPECT_EQ(buffer, serialized_message.get_rcl_serialized_message().buffer);
+
+  UnboundedSequences deserialized;
+  serialization.deserialize(serialized_message, deserialized);
+  EXPECT_EQ(1024u, deserialized.uint8_values.size());
+}
@@ -18,6 +18,7 @@
 #include <memory>
 
 #include "rclcpp/rclcpp.hpp"
+#include "rclcpp/strategies/serialized_message_pool_memory_strategy.hpp"
 
 #include "rcl/types.h"
 
@@ -51,6 +52,55 @@ TEST(TestSerializedMessageAllocator, default_allocator) {
   mem_strategy->return_serialized_message(msg1000);
 }
 
+TEST(TestSerializedMessageAllocator, pooled_buffers) {
+  using DummyMessageT = float;
+  namespace strategy = rclcpp::strategies::serialized_message_pool_memory_strategy;
+  auto mem_strategy =
+    std::make_shared<strategy::SerializedMessagePoolMemoryStrategy<DummyMessageT>>(2, 4);
+
+  auto msg100 = mem_strategy->borrow_serialized_message(100);
+  auto buffer = msg100->buffer;
+  EXPECT_EQ(100u, msg100->buffer_capacity);
+  msg100->buffer_length = 50;
+  mem_strategy->return_serialized_message(msg100);
+  EXPECT_EQ(1u, mem_strategy->get_allocation_count());
+  EXPECT_EQ(64u, mem_strategy->get_capacity_hint());
+
+  // The buffer is reused, and it is large enough.
+  auto msg = mem_strategy->borrow_serialized_message();
+  EXPECT_EQ(buffer, msg->buffer);
+  EXPECT_EQ(0u, msg->buffer_length);
+  EXPECT_EQ(100u, msg->buffer_capacity);
+
+  // Grown while it was borrowed, as the middleware does when taking a large message.
+  auto ret = rmw_serialized_message_resize(msg.get(), 1000);
+  ASSERT_EQ(RCL_RET_OK, ret);
+  msg->buffer_length = 1000;
+  mem_strategy->return_serialized_message(msg);
+  EXPECT_EQ(1u, mem_strategy->get_take_reallocation_count());
+  EXPECT_EQ(1024u, mem_strategy->get_capacity_hint());
+
+  msg = mem_strategy->borrow_serialized_message();
+  EXPECT_EQ(1024u, msg->buffer_capacity);
+  EXPECT_EQ(1u, mem_strategy->get_reallocation_count());
+  EXPECT_EQ(1u, mem_strategy->get_allocation_count());
+
+  // A message still referenced is not reused, and the pool is bounded.
+  auto other = mem_strategy->borrow_serialized_message(10);
+  auto extra = mem_strategy->borrow_serialized_message(10);
+  EXPECT_EQ(3u, mem_strategy->get_allocation_count());
+  EXPECT_EQ(2u, mem_strategy->get_pool_size());
+  auto kept = other;
+  mem_strategy->return_serialized_message(other);
+  mem_strategy->return_serialized_message(extra);
+  auto borrowed = mem_strategy->borrow_serialized_message(10);
+  EXPECT_NE(kept, borrowed);
+  EXPECT_EQ(4u, mem_strategy->get_allocation_count());
+
+  mem_strategy->return_serialized_message(borrowed);
+  mem_strategy->return_serialized_message(msg);
+}
+
 TEST(TestSerializedMessageAllocator, borrow_from_subscription) {
   rclcpp::init(0, NULL);
 
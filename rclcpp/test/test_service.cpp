@@ -14,8 +14,13 @@
 
 #include <gtest/gtest.h>
 
-#include <string>
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "rclcpp/exceptions.hpp"
 #include "rclcpp/rclcpp.hpp"
@@ -105,3 +110,221 @@ TEST_F(TestServiceSub, construction_and_destruction) {
     }, rclcpp::exceptions::InvalidServiceNameError);
   }
 }
+
+/*
+   Testing a deferred response, sent from another thread after the callback returned.
+ */
+TEST_F(TestService, deferred_response) {
+  using rcl_interfaces::srv::ListParameters;
+  using namespace std::chrono_literals;
+  rclcpp::ServiceResponder<ListParameters>::SharedPtr responder;
+  auto service = node->create_service<ListParameters>(
+    "deferred_service",
+    [&responder](
+      const ListParameters::Request::SharedPtr,
+      rclcpp::ServiceResponder<ListParameters>::SharedPtr request_responder) {
+      responder = request_responder;
+    });
+  auto client = node->create_client<ListParameters>("deferred_service");
+  ASSERT_TRUE(client->wait_for_service(5s));
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  auto future = client->async_send_request(std::make_shared<ListParameters::Request>());
+  auto start = std::chrono::steady_clock::now();
+  while (!responder && std::chrono::steady_clock::now() - start < 5s) {
+    executor.spin_once(10ms);
+  }
+  ASSERT_NE(nullptr, responder);
+  EXPECT_FALSE(responder->is_response_sent());
+
+  std::thread responder_thread([&responder]() {
+      auto response = std::make_shared<ListParameters::Response>();
+      response->result.names.push_back("deferred");
+      responder->send_response(response);
+    });
+  responder_thread.join();
+  EXPECT_TRUE(responder->is_response_sent());
+  EXPECT_THROW(
+    responder->send_response(std::make_shared<ListParameters::Response>()), std::runtime_error);
+
+  ASSERT_EQ(
+    rclcpp::executor::FutureReturnCode::SUCCESS,
+    executor.spin_until_future_complete(future, 5s));
+  ASSERT_EQ(1u, future.get()->result.names.size());
+  EXPECT_EQ("deferred", future.get()->result.names[0]);
+}
+
+/*
+   Testing requests handled in parallel by worker threads.
+ */
+TEST_F(TestService, worker_threads) {
+  using rcl_interfaces::srv::ListParameters;
+  using namespace std::chrono_literals;
+  std::atomic<size_t> running(0);
+  std::atomic<size_t> max_running(0);
+  auto service = node->create_service<ListParameters>(
+    "worker_service",
+    [&running, &max_running](
+      const ListParameters::Request::SharedPtr request,
+      ListParameters::Response::SharedPtr response) {
+      size_t now_running = ++running;
+      size_t previous = max_running.load();
+      while (previous < now_running && !max_running.compare_exchange_weak(previous, now_running)) {
+      }
+      std::this_thread::sleep_for(100ms);
+      response->result.names = request->prefixes;
+      --running;
+    });
+  EXPECT_EQ(0u, service->get_number_of_worker_threads());
+  service->set_number_of_worker_threads(4);
+  EXPECT_EQ(4u, service->get_number_of_worker_threads());
+
+  auto client = node->create_client<ListParameters>("worker_service");
+  ASSERT_TRUE(client->wait_for_service(5s));
+  std::vector<rclcpp::Client<ListParameters>::SharedFuture> futures;
+  for (size_t i = 0; i < 4; ++i) {
+    auto request = std::make_shared<ListParameters::Request>();
+    request->prefixes.push_back("request_" + std::to_string(i));
+    futures.push_back(client->async_send_request(request));
+  }
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  for (size_t i = 0; i < futures.size(); ++i) {
+    ASSERT_EQ(
+      rclcpp::executor::FutureReturnCode::SUCCESS,
+      executor.spin_until_future_complete(futures[i], 5s));
+    // Each response answers its own request.
+    ASSERT_EQ(1u, futures[i].get()->result.names.size());
+    EXPECT_EQ("request_" + std::to_string(i), futures[i].get()->result.names[0]);
+  }
+  EXPECT_LT(1u, max_running.load());
+}
+
+/*
+   Testing a callback handling the requests in batches.
+ */
+TEST_F(TestService, batch_callback) {
+  using rcl_interfaces::srv::ListParameters;
+  using namespace std::chrono_literals;
+  std::vector<size_t> batch_sizes;
+  auto service = node->create_service<ListParameters>(
+    "batch_service",
+    [&batch_sizes](
+      const std::vector<rclcpp::Service<ListParameters>::BatchRequest> & requests,
+      std::vector<ListParameters::Response::SharedPtr> & responses) {
+      ASSERT_EQ(requests.size(), responses.size());
+      batch_sizes.push_back(requests.size());
+      for (size_t i = 0; i < requests.size(); ++i) {
+        responses[i]->result.names = requests[i].second->prefixes;
+      }
+    });
+  EXPECT_TRUE(service->is_batched());
+  EXPECT_THROW(service->set_max_batch_size(0), std::invalid_argument);
+  service->set_max_batch_size(2);
+
+  auto client = node->create_client<ListParameters>("batch_service");
+  ASSERT_TRUE(client->wait_for_service(5s));
+  std::vector<rclcpp::Client<ListParameters>::SharedFuture> futures;
+  for (size_t i = 0; i < 5; ++i) {
+    auto request = std::make_shared<ListParameters::Request>();
+    request->prefixes.push_back("request_" + std::to_string(i));
+    futures.push_back(client->async_send_request(request));
+  }
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  for (size_t i = 0; i < futures.size(); ++i) {
+    ASSERT_EQ(
+      rclcpp::executor::FutureReturnCode::SUCCESS,
+      executor.spin_until_future_complete(futures[i], 5s));
+    ASSERT_EQ(1u, futures[i].get()->result.names.size());
+    EXPECT_EQ("request_" + std::to_string(i), futures[i].get()->result.names[0]);
+  }
+  size_t total = 0;
+  for (size_t batch_size : batch_sizes) {
+    EXPECT_GE(2u, batch_size);
+    total += batch_size;
+  }
+  EXPECT_EQ(5u, total);
+}
+
+/*
+   Testing requests and responses passed within the process.
+ */
+TEST_F(TestService, intra_process_request) {
+  using rcl_interfaces::srv::ListParameters;
+  using namespace std::chrono_literals;
+  auto intra_process_node = std::make_shared<rclcpp::Node>(
+    "intra_process_node", "/ns", rclcpp::NodeOptions().use_intra_process_comms(true));
+  ListParameters::Request::SharedPtr received_request;
+  auto service = intra_process_node->create_service<ListParameters>(
+    "intra_process_service",
+    [&received_request](
+      const ListParameters::Request::SharedPtr request,
+      ListParameters::Response::SharedPtr response) {
+      received_request = request;
+      response->result.names = request->prefixes;
+    });
+  ASSERT_NE(nullptr, service->get_intra_process_waitable());
+
+  auto client = intra_process_node->create_client<ListParameters>("intra_process_service");
+  ASSERT_NE(nullptr, client->get_intra_process_waitable());
+  auto request = std::make_shared<ListParameters::Request>();
+  request->prefixes.push_back("intra_process");
+  auto future = client->async_send_request(request);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(intra_process_node);
+  ASSERT_EQ(
+    rclcpp::executor::FutureReturnCode::SUCCESS,
+    executor.spin_until_future_complete(future, 5s));
+  // The service got the request of the client, not a copy taken from the middleware.
+  EXPECT_EQ(request, received_request);
+  ASSERT_EQ(1u, future.get()->result.names.size());
+  EXPECT_EQ("intra_process", future.get()->result.names[0]);
+  EXPECT_EQ(0u, client->get_number_of_pending_requests());
+}
+
+/*
+   Testing requests, responses and headers allocated from a pool.
+ */
+TEST_F(TestService, message_pool) {
+  using rcl_interfaces::srv::ListParameters;
+  using namespace std::chrono_literals;
+  auto service = node->create_service<ListParameters>(
+    "pooled_service",
+    [](
+      const ListParameters::Request::SharedPtr request,
+      ListParameters::Response::SharedPtr response) {
+      response->result.names = request->prefixes;
+    });
+  EXPECT_EQ(nullptr, service->get_message_pool());
+  EXPECT_THROW(service->reserve_requests(0), std::invalid_argument);
+  service->reserve_requests(1);
+  auto pool = service->get_message_pool();
+  ASSERT_NE(nullptr, pool);
+  EXPECT_EQ(3u, pool->get_block_count());
+  EXPECT_LT(0u, service->get_memory_usage().message_pool_bytes);
+
+  auto client = node->create_client<ListParameters>("pooled_service");
+  client->reserve_pending_requests(1);
+  EXPECT_LT(0u, client->get_memory_usage().message_pool_bytes);
+  ASSERT_TRUE(client->wait_for_service(5s));
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  for (size_t i = 0; i < 3; ++i) {
+    auto request = std::make_shared<ListParameters::Request>();
+    request->prefixes.push_back("request_" + std::to_string(i));
+    auto future = client->async_send_request(request);
+    ASSERT_EQ(
+      rclcpp::executor::FutureReturnCode::SUCCESS,
+      executor.spin_until_future_complete(future, 5s));
+    ASSERT_EQ(1u, future.get()->result.names.size());
+    EXPECT_EQ("request_" + std::to_string(i), future.get()->result.names[0]);
+  }
+  // The blocks were recycled for each request.
+  EXPECT_EQ(0u, pool->get_fallback_count());
+  EXPECT_EQ(pool->get_block_count(), pool->get_free_block_count());
+}
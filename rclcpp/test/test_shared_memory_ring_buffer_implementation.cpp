@@ -0,0 +1,148 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "rclcpp/experimental/buffers/shared_memory_ring_buffer_implementation.hpp"
+#include "rclcpp/experimental/serialized_message.hpp"
+
+#ifndef _WIN32
+#include <unistd.h>
+
+using rclcpp::experimental::buffers::SharedMemoryRingBufferImplementation;
+
+namespace
+{
+
+std::string
+unique_segment_name(const std::string & test_name)
+{
+  return "rclcpp_test_" + test_name + "_" + std::to_string(getpid());
+}
+
+std::shared_ptr<const rcl_serialized_message_t>
+make_message(const std::string & content)
+{
+  auto message = rclcpp::experimental::create_serialized_message(content.size());
+  std::memcpy(message->buffer, content.data(), content.size());
+  message->buffer_length = content.size();
+  return message;
+}
+
+std::string
+message_content(const std::shared_ptr<const rcl_serialized_message_t> & message)
+{
+  return std::string(reinterpret_cast<const char *>(message->buffer), message->buffer_length);
+}
+
+}  // namespace
+
+/*
+   Constructors
+ */
+TEST(TestSharedMemoryRingBufferImplementation, constructor) {
+  auto name = unique_segment_name("constructor");
+  EXPECT_THROW(SharedMemoryRingBufferImplementation(name, 0, 16), std::invalid_argument);
+  EXPECT_THROW(SharedMemoryRingBufferImplementation(name, 2, 0), std::invalid_argument);
+  EXPECT_THROW(SharedMemoryRingBufferImplementation reader(name), std::runtime_error);
+
+  SharedMemoryRingBufferImplementation writer(name, 2, 16);
+  EXPECT_EQ(2u, writer.capacity());
+  EXPECT_EQ(16u, writer.max_message_size());
+  EXPECT_FALSE(writer.has_data());
+
+  SharedMemoryRingBufferImplementation reader(name);
+  EXPECT_EQ(2u, reader.capacity());
+  EXPECT_EQ(16u, reader.max_message_size());
+  EXPECT_FALSE(reader.has_data());
+  EXPECT_EQ(nullptr, reader.dequeue());
+}
+
+/*
+   Basic usage
+   - a reader gets the messages enqueued after it was constructed
+   - messages larger than a slot are rejected
+   - only the writer can enqueue
+ */
+TEST(TestSharedMemoryRingBufferImplementation, basic_usage) {
+  auto name = unique_segment_name("basic_usage");
+  SharedMemoryRingBufferImplementation writer(name, 4, 8);
+  writer.enqueue(make_message("before"));
+
+  SharedMemoryRingBufferImplementation reader(name);
+  EXPECT_FALSE(reader.has_data());
+
+  writer.enqueue(make_message("first"));
+  writer.enqueue(make_message(""));
+  EXPECT_TRUE(reader.has_data());
+  EXPECT_EQ("first", message_content(reader.dequeue()));
+  EXPECT_EQ("", message_content(reader.dequeue()));
+  EXPECT_FALSE(reader.has_data());
+  EXPECT_EQ(nullptr, reader.dequeue());
+
+  EXPECT_THROW(writer.enqueue(make_message("too large")), std::invalid_argument);
+  EXPECT_THROW(reader.enqueue(make_message("reader")), std::runtime_error);
+  EXPECT_FALSE(reader.has_data());
+
+  writer.enqueue(make_message("cleared"));
+  reader.clear();
+  EXPECT_FALSE(reader.has_data());
+}
+
+/*
+   Readers are independent, and falling behind drops the oldest messages
+ */
+TEST(TestSharedMemoryRingBufferImplementation, overwrite) {
+  auto name = unique_segment_name("overwrite");
+  SharedMemoryRingBufferImplementation writer(name, 2, 8);
+  SharedMemoryRingBufferImplementation reader_1(name);
+  SharedMemoryRingBufferImplementation reader_2(name);
+
+  writer.enqueue(make_message("1"));
+  writer.enqueue(make_message("2"));
+  writer.enqueue(make_message("3"));
+
+  EXPECT_EQ("2", message_content(reader_1.dequeue()));
+  EXPECT_EQ(1u, reader_1.get_dropped_count());
+  EXPECT_EQ("3", message_content(reader_1.dequeue()));
+  EXPECT_EQ(nullptr, reader_1.dequeue());
+
+  EXPECT_EQ("2", message_content(reader_2.dequeue()));
+  writer.enqueue(make_message("4"));
+  EXPECT_EQ("3", message_content(reader_2.dequeue()));
+  EXPECT_EQ("4", message_content(reader_2.dequeue()));
+  EXPECT_EQ("4", message_content(reader_1.dequeue()));
+  EXPECT_EQ(1u, reader_1.get_dropped_count());
+  EXPECT_EQ(1u, reader_2.get_dropped_count());
+}
+
+/*
+   The segment is removed with its writer
+ */
+TEST(TestSharedMemoryRingBufferImplementation, lifetime) {
+  auto name = unique_segment_name("lifetime");
+  {
+    SharedMemoryRingBufferImplementation writer(name, 2, 8);
+    SharedMemoryRingBufferImplementation reader(name);
+    (void)reader;
+  }
+  EXPECT_THROW(SharedMemoryRingBufferImplementation reader(name), std::runtime_error);
+}
+
+#endif  // _WIN32
@@ -14,13 +14,18 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <memory>
+#include <thread>
 #include <vector>
 
 #include "rclcpp/exceptions.hpp"
+#include "rclcpp/experimental/subscription_intra_process_group.hpp"
 #include "rclcpp/rclcpp.hpp"
 
+#include "test_msgs/msg/basic_types.hpp"
 #include "test_msgs/msg/empty.hpp"
 
 class TestSubscription : public ::testing::Test
@@ -50,25 +55,6 @@ protected:
   rclcpp::Node::SharedPtr node;
 };
 
-struct TestParameters
-{
-  TestParameters(rclcpp::QoS qos, std::string description)
-  : qos(qos), description(description) {}
-  rclcpp::QoS qos;
-  std::string description;
-};
-
-std::ostream & operator<<(std::ostream & out, const TestParameters & params)
-{
-  out << params.description;
-  return out;
-}
-
-class TestSubscriptionInvalidIntraprocessQos
-  : public TestSubscription,
-  public ::testing::WithParamInterface<TestParameters>
-{};
-
 class TestSubscriptionSub : public ::testing::Test
 {
 public:
@@ -253,45 +239,685 @@ TEST_F(TestSubscription, callback_bind) {
 }
 
 /*
-   Testing subscription with intraprocess enabled and invalid QoS
+   Testing that several messages are taken each time the subscription is executed.
+ */
+TEST_F(TestSubscription, max_messages_per_execution) {
+  initialize();
+  using test_msgs::msg::Empty;
+  {
+    auto sub = node->create_subscription<Empty>("topic", 10, [](Empty::SharedPtr) {});
+    EXPECT_EQ(1u, sub->get_max_messages_per_execution());
+    sub->set_max_messages_per_execution(0);
+    EXPECT_EQ(1u, sub->get_max_messages_per_execution());
+  }
+  {
+    size_t received = 0;
+    rclcpp::SubscriptionOptions options;
+    options.max_messages_per_execution = 10;
+    auto sub = node->create_subscription<Empty>(
+      "batch_topic", 10, [&received](Empty::SharedPtr) {received++;}, options);
+    EXPECT_EQ(10u, sub->get_max_messages_per_execution());
+    auto pub = node->create_publisher<Empty>("batch_topic", 10);
+
+    rclcpp::executors::SingleThreadedExecutor executor;
+    executor.add_node(node);
+    for (size_t i = 0; i < 3; ++i) {
+      pub->publish(Empty());
+    }
+    // spin_some() executes a ready subscription once, which takes all three messages.
+    auto start = std::chrono::steady_clock::now();
+    while (received == 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      executor.spin_some();
+    }
+    EXPECT_EQ(3u, received);
+  }
+}
+
+/*
+   Testing that a callback taking a batch gets the messages taken by an execution at once.
  */
-TEST_P(TestSubscriptionInvalidIntraprocessQos, test_subscription_throws) {
+TEST_F(TestSubscription, batch_callback) {
+  initialize();
+  using test_msgs::msg::Empty;
+  std::vector<size_t> batch_sizes;
+  rclcpp::SubscriptionOptions options;
+  options.batching.max_count = 2;
+  auto sub = node->create_subscription<Empty>(
+    "batch_callback_topic", 10,
+    [&batch_sizes](std::vector<Empty::ConstSharedPtr> msgs) {batch_sizes.push_back(msgs.size());},
+    options);
+  EXPECT_EQ(2u, sub->get_max_messages_per_execution());
+  auto pub = node->create_publisher<Empty>("batch_callback_topic", 10);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  for (size_t i = 0; i < 3; ++i) {
+    pub->publish(Empty());
+  }
+  size_t received = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (received < 3u && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    executor.spin_some();
+    received = 0;
+    for (auto batch_size : batch_sizes) {
+      received += batch_size;
+    }
+  }
+  EXPECT_EQ(3u, received);
+  for (auto batch_size : batch_sizes) {
+    EXPECT_LE(batch_size, 2u);
+  }
+}
+
+/*
+   Testing that a callback taking a batch gets the messages published intra-process at once.
+ */
+TEST_F(TestSubscription, intra_process_batch_callback) {
   initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
-  rclcpp::QoS qos = GetParam().qos;
   using test_msgs::msg::Empty;
+  std::vector<size_t> batch_sizes;
+  auto sub = node->create_subscription<Empty>(
+    "intra_process_batch_topic", 10,
+    [&batch_sizes](std::vector<Empty::ConstSharedPtr> msgs) {batch_sizes.push_back(msgs.size());});
+  auto pub = node->create_publisher<Empty>("intra_process_batch_topic", 10);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  for (size_t i = 0; i < 3; ++i) {
+    pub->publish(Empty());
+  }
+  executor.spin_some();
+  EXPECT_EQ(std::vector<size_t>({3}), batch_sizes);
+}
+
+/*
+   Testing that a subscription keeping the latest message only gives the newest one.
+ */
+TEST_F(TestSubscription, keep_latest) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  rclcpp::SubscriptionOptions options;
+  options.keep_latest = true;
+  std::vector<int32_t> received;
+  auto sub = node->create_subscription<BasicTypes>(
+    "keep_latest_topic", 10,
+    [&received](BasicTypes::SharedPtr msg) {received.push_back(msg->int32_value);},
+    options);
+  EXPECT_EQ(10u, sub->get_max_messages_per_execution());
+  auto pub = node->create_publisher<BasicTypes>("keep_latest_topic", 10);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  for (int32_t i = 0; i < 3; ++i) {
+    BasicTypes msg;
+    msg.int32_value = i;
+    pub->publish(msg);
+  }
+  auto start = std::chrono::steady_clock::now();
+  while ((received.empty() || received.back() != 2) &&
+    std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
   {
-    auto callback = std::bind(
-      &TestSubscriptionInvalidIntraprocessQos::OnMessage,
-      this,
-      std::placeholders::_1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    executor.spin_some();
+  }
+  ASSERT_FALSE(received.empty());
+  EXPECT_EQ(2, received.back());
+  EXPECT_GE(3u, received.size());
+
+  EXPECT_THROW(
+    node->create_subscription<BasicTypes>(
+      "keep_latest_topic", 10, [](std::vector<BasicTypes::ConstSharedPtr>) {}, options),
+    std::invalid_argument);
+}
 
-    ASSERT_THROW(
-      {auto subscription = node->create_subscription<Empty>(
-          "topic",
-          qos,
-          callback);},
-      std::invalid_argument);
+/*
+   Testing that an intra-process subscription keeping the latest message drops the backlog.
+ */
+TEST_F(TestSubscription, intra_process_keep_latest) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  rclcpp::SubscriptionOptions options;
+  options.keep_latest = true;
+  std::vector<int32_t> received;
+  auto sub = node->create_subscription<BasicTypes>(
+    "intra_process_keep_latest_topic", 10,
+    [&received](BasicTypes::SharedPtr msg) {received.push_back(msg->int32_value);},
+    options);
+  auto pub = node->create_publisher<BasicTypes>("intra_process_keep_latest_topic", 10);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  for (int32_t i = 0; i < 3; ++i) {
+    BasicTypes msg;
+    msg.int32_value = i;
+    pub->publish(msg);
   }
+  executor.spin_some();
+  EXPECT_EQ(std::vector<int32_t>({2}), received);
+  executor.spin_some();
+  EXPECT_EQ(std::vector<int32_t>({2}), received);
 }
 
-static std::vector<TestParameters> invalid_qos_profiles()
-{
-  std::vector<TestParameters> parameters;
-
-  parameters.reserve(3);
-  parameters.push_back(
-    TestParameters(
-      rclcpp::QoS(rclcpp::KeepLast(10)).transient_local(),
-      "transient_local_qos"));
-  parameters.push_back(
-    TestParameters(
-      rclcpp::QoS(rclcpp::KeepAll()),
-      "keep_all_qos"));
-
-  return parameters;
+/*
+   Testing that the rate limits of an intra-process publisher and subscription both apply.
+ */
+TEST_F(TestSubscription, intra_process_rate_limit) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  rclcpp::SubscriptionOptions subscription_options;
+  subscription_options.rate_limit.decimation = 2;
+  std::vector<int32_t> received;
+  auto sub = node->create_subscription<BasicTypes>(
+    "intra_process_rate_limit_topic", 10,
+    [&received](BasicTypes::SharedPtr msg) {received.push_back(msg->int32_value);},
+    subscription_options);
+  rclcpp::PublisherOptions publisher_options;
+  publisher_options.rate_limit.decimation = 2;
+  auto pub = node->create_publisher<BasicTypes>(
+    "intra_process_rate_limit_topic", 10, publisher_options);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  for (int32_t i = 0; i < 8; ++i) {
+    BasicTypes msg;
+    msg.int32_value = i;
+    pub->publish(msg);
+  }
+  auto start = std::chrono::steady_clock::now();
+  while (received.size() < 2u &&
+    std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+  {
+    executor.spin_some();
+  }
+  executor.spin_some();
+  EXPECT_EQ(std::vector<int32_t>({0, 4}), received);
+  EXPECT_EQ(4u, pub->get_rate_limit_dropped_count());
+  EXPECT_EQ(2u, sub->get_rate_limit_dropped_count());
 }
 
-INSTANTIATE_TEST_CASE_P(
-  TestSubscriptionThrows, TestSubscriptionInvalidIntraprocessQos,
-  ::testing::ValuesIn(invalid_qos_profiles()),
-  ::testing::PrintToStringParamName());
+/*
+   Testing that an intra-process subscription with a KEEP_ALL history keeps a whole burst.
+ */
+TEST_F(TestSubscription, intra_process_keep_all) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  std::vector<int32_t> received;
+  auto sub = node->create_subscription<BasicTypes>(
+    "intra_process_keep_all_topic", rclcpp::QoS(rclcpp::KeepAll()),
+    [&received](BasicTypes::SharedPtr msg) {received.push_back(msg->int32_value);});
+  auto pub = node->create_publisher<BasicTypes>(
+    "intra_process_keep_all_topic", rclcpp::QoS(rclcpp::KeepAll()));
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  std::vector<int32_t> expected;
+  for (int32_t i = 0; i < 100; ++i) {
+    BasicTypes msg;
+    msg.int32_value = i;
+    pub->publish(msg);
+    expected.push_back(i);
+  }
+  auto start = std::chrono::steady_clock::now();
+  while (received.size() < expected.size() &&
+    std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+  {
+    executor.spin_some();
+  }
+  EXPECT_EQ(expected, received);
+  EXPECT_EQ(100u, sub->get_intra_process_buffer_high_water_mark());
+
+  rclcpp::SubscriptionOptions options;
+  options.intra_process_buffer_implementation =
+    rclcpp::IntraProcessBufferImplementation::SpscRingBuffer;
+  EXPECT_THROW(
+    node->create_subscription<BasicTypes>(
+      "intra_process_keep_all_topic", rclcpp::QoS(rclcpp::KeepAll()),
+      [](BasicTypes::SharedPtr) {}, options),
+    std::invalid_argument);
+}
+
+/*
+   Testing that the intra-process subscriptions of a callback group are waited on together.
+ */
+TEST_F(TestSubscription, intra_process_subscription_group) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  std::vector<int32_t> received;
+  std::vector<rclcpp::Subscription<BasicTypes>::SharedPtr> subs;
+  for (size_t i = 0; i < 3; ++i) {
+    subs.push_back(
+      node->create_subscription<BasicTypes>(
+        "intra_process_subscription_group_topic", 10,
+        [&received](BasicTypes::SharedPtr msg) {received.push_back(msg->int32_value);}));
+  }
+  auto idle_sub = node->create_subscription<BasicTypes>(
+    "intra_process_subscription_group_idle_topic", 10, [](BasicTypes::SharedPtr) {});
+  auto pub = node->create_publisher<BasicTypes>("intra_process_subscription_group_topic", 10);
+
+  auto callback_group = node->get_node_base_interface()->get_default_callback_group();
+  size_t number_of_waitables = 0;
+  rclcpp::experimental::SubscriptionIntraProcessGroup::SharedPtr group;
+  callback_group->find_waitable_ptrs_if(
+    [&](const rclcpp::Waitable::SharedPtr & waitable) {
+      number_of_waitables++;
+      group =
+      std::dynamic_pointer_cast<rclcpp::experimental::SubscriptionIntraProcessGroup>(waitable);
+      return false;
+    });
+  EXPECT_EQ(1u, number_of_waitables);
+  ASSERT_NE(nullptr, group);
+  EXPECT_EQ(1u, group->get_number_of_ready_guard_conditions());
+
+  // Executes what the node may have received on its own, the parameter events.
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_some();
+  EXPECT_EQ(0u, group->get_number_of_queued_subscriptions());
+
+  for (int32_t i = 0; i < 2; ++i) {
+    BasicTypes msg;
+    msg.int32_value = i;
+    pub->publish(msg);
+  }
+  // Each subscription given messages is queued once, the idle one isn't.
+  EXPECT_EQ(3u, group->get_number_of_queued_subscriptions());
+
+  auto start = std::chrono::steady_clock::now();
+  while (received.size() < 6u &&
+    std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+  {
+    executor.spin_some();
+  }
+  EXPECT_EQ(6u, received.size());
+  EXPECT_EQ(0u, group->get_number_of_queued_subscriptions());
+}
+
+/*
+   Testing that the messages dropped by a full intra-process buffer are reported.
+ */
+TEST_F(TestSubscription, intra_process_message_lost) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  std::vector<rclcpp::QOSIntraProcessMessageLostInfo> lost;
+  size_t received = 0;
+  rclcpp::SubscriptionOptions options;
+  options.event_callbacks.intra_process_message_lost_callback =
+    [&lost](rclcpp::QOSIntraProcessMessageLostInfo & info) {lost.push_back(info);};
+  auto sub = node->create_subscription<BasicTypes>(
+    "intra_process_message_lost_topic", 2,
+    [&received](BasicTypes::SharedPtr) {received++;}, options);
+  auto pub = node->create_publisher<BasicTypes>("intra_process_message_lost_topic", 10);
+
+  pub->publish(BasicTypes());
+  EXPECT_EQ(0u, pub->get_full_intra_process_subscription_count());
+  for (int i = 0; i < 4; ++i) {
+    pub->publish(BasicTypes());
+  }
+  EXPECT_EQ(1u, pub->get_full_intra_process_subscription_count());
+  EXPECT_EQ(3u, sub->get_intra_process_dropped_count());
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  auto start = std::chrono::steady_clock::now();
+  while (received < 2u && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    executor.spin_some();
+  }
+  EXPECT_EQ(2u, received);
+  ASSERT_EQ(1u, lost.size());
+  EXPECT_EQ(3u, lost[0].total_count);
+  EXPECT_EQ(3u, lost[0].total_count_change);
+  EXPECT_EQ(0u, pub->get_full_intra_process_subscription_count());
+}
+
+/*
+   Testing that a publisher is blocked instead of dropping messages with the block policy.
+ */
+TEST_F(TestSubscription, intra_process_block_overflow_policy) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  std::atomic<size_t> received(0);
+  rclcpp::SubscriptionOptions options;
+  options.intra_process_backpressure.overflow_policy =
+    rclcpp::IntraProcessBufferOverflowPolicy::Block;
+  options.intra_process_backpressure.max_block_time = std::chrono::seconds(5);
+  auto sub = node->create_subscription<BasicTypes>(
+    "intra_process_block_topic", 2,
+    [&received](BasicTypes::SharedPtr) {received++;}, options);
+  auto pub = node->create_publisher<BasicTypes>("intra_process_block_topic", 10);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  std::thread spinner([&executor]() {executor.spin();});
+  for (int i = 0; i < 20; ++i) {
+    pub->publish(BasicTypes());
+  }
+  auto start = std::chrono::steady_clock::now();
+  while (received < 20u && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  executor.cancel();
+  spinner.join();
+  EXPECT_EQ(20u, received.load());
+  EXPECT_EQ(0u, sub->get_intra_process_dropped_count());
+}
+
+/*
+   Testing that the callback is called by publish() with synchronous delivery.
+ */
+TEST_F(TestSubscription, intra_process_synchronous_delivery) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  size_t received = 0;
+  std::thread::id callback_thread;
+  rclcpp::SubscriptionOptions options;
+  options.intra_process_synchronous_delivery = true;
+  auto sub = node->create_subscription<BasicTypes>(
+    "intra_process_synchronous_topic", 10,
+    [&received, &callback_thread](BasicTypes::UniquePtr) {
+      received++;
+      callback_thread = std::this_thread::get_id();
+    }, options);
+  auto pub = node->create_publisher<BasicTypes>("intra_process_synchronous_topic", 10);
+
+  pub->publish(std::make_unique<BasicTypes>());
+  EXPECT_EQ(1u, received);
+  EXPECT_EQ(std::this_thread::get_id(), callback_thread);
+
+  // Buffered while the group is taken, e.g. by an executor thread.
+  auto group = node->get_node_base_interface()->get_default_callback_group();
+  group->can_be_taken_from().store(false);
+  pub->publish(std::make_unique<BasicTypes>());
+  EXPECT_EQ(1u, received);
+  group->can_be_taken_from().store(true);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  auto start = std::chrono::steady_clock::now();
+  while (received < 2u && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    executor.spin_some();
+  }
+  EXPECT_EQ(2u, received);
+
+  // A callback throwing releases the group.
+  auto throwing_sub = node->create_subscription<BasicTypes>(
+    "intra_process_synchronous_throwing_topic", 10,
+    [](BasicTypes::UniquePtr) {throw std::runtime_error("callback failed");}, options);
+  auto throwing_pub =
+    node->create_publisher<BasicTypes>("intra_process_synchronous_throwing_topic", 10);
+  EXPECT_THROW(throwing_pub->publish(std::make_unique<BasicTypes>()), std::runtime_error);
+  EXPECT_TRUE(group->can_be_taken_from().load());
+}
+
+/*
+   Testing that identical subscriptions share the reader, and each get the message taken once.
+ */
+TEST_F(TestSubscription, share_reader) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  auto other_node = std::make_shared<rclcpp::Node>("test_subscription_other", "/ns");
+  std::vector<const BasicTypes *> received;
+  auto callback = [&received](BasicTypes::ConstSharedPtr msg) {received.push_back(msg.get());};
+  rclcpp::SubscriptionOptions options;
+  options.share_reader = true;
+  auto sub1 = node->create_subscription<BasicTypes>(
+    "shared_reader_topic", 10, callback, options);
+  auto sub2 = other_node->create_subscription<BasicTypes>(
+    "shared_reader_topic", 10, callback, options);
+  auto other_qos_sub = node->create_subscription<BasicTypes>(
+    "shared_reader_topic", 5, callback, options);
+  EXPECT_TRUE(sub1->has_shared_reader());
+  EXPECT_FALSE(sub1->can_loan_messages());
+  EXPECT_EQ(sub1->get_subscription_handle(), sub2->get_subscription_handle());
+  EXPECT_NE(sub1->get_subscription_handle(), other_qos_sub->get_subscription_handle());
+  other_qos_sub.reset();
+
+  // Published without intra-process, the message is taken from the middleware once.
+  auto pub = node->create_publisher<BasicTypes>("shared_reader_topic", 10);
+  pub->publish(BasicTypes());
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.add_node(other_node);
+  auto start = std::chrono::steady_clock::now();
+  while (received.size() < 2u && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+  {
+    executor.spin_some(std::chrono::milliseconds(100));
+  }
+  ASSERT_EQ(2u, received.size());
+  EXPECT_EQ(received[0], received[1]);
+
+  // The reader is kept by the remaining subscription.
+  auto handle = sub2->get_subscription_handle();
+  sub1.reset();
+  received.clear();
+  pub->publish(BasicTypes());
+  start = std::chrono::steady_clock::now();
+  while (received.empty() && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    executor.spin_some(std::chrono::milliseconds(100));
+  }
+  EXPECT_EQ(1u, received.size());
+
+  EXPECT_THROW(
+    node->create_subscription<test_msgs::msg::Empty>(
+      "shared_reader_serialized_topic", 10,
+      [](std::shared_ptr<rcl_serialized_message_t>) {}, options),
+    std::invalid_argument);
+}
+
+/*
+   Testing that a callback taking a SubscriptionLoanedMessage can keep the messages.
+ */
+TEST_F(TestSubscription, loaned_message_callback) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  std::vector<rclcpp::SubscriptionLoanedMessage<BasicTypes>> kept;
+  auto sub = node->create_subscription<BasicTypes>(
+    "loaned_message_topic", 10,
+    [&kept](rclcpp::SubscriptionLoanedMessage<BasicTypes> msg) {kept.push_back(std::move(msg));});
+  EXPECT_EQ(sub->can_loan_messages(), sub->keeps_loaned_messages());
+  auto pub = node->create_publisher<BasicTypes>("loaned_message_topic", 10);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  for (int32_t i = 0; i < 2; ++i) {
+    BasicTypes msg;
+    msg.int32_value = i;
+    pub->publish(msg);
+  }
+  auto start = std::chrono::steady_clock::now();
+  while (kept.size() < 2u && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    executor.spin_some();
+  }
+  ASSERT_EQ(2u, kept.size());
+  for (int32_t i = 0; i < 2; ++i) {
+    ASSERT_TRUE(kept[i].is_valid());
+    EXPECT_EQ(sub->can_loan_messages(), kept[i].is_loaned());
+    EXPECT_EQ(i, kept[i]->int32_value);
+  }
+  kept.clear();
+}
+
+/*
+   Testing that the messages rejected by the content filter are not given to the callback.
+ */
+TEST_F(TestSubscription, content_filter) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  rclcpp::SubscriptionOptions options;
+  // bool_value is the first field, right after the 4 bytes of the CDR encapsulation header.
+  options.content_filter = [](const rcl_serialized_message_t & serialized_msg) {
+      return serialized_msg.buffer_length > 4 && serialized_msg.buffer[4] != 0;
+    };
+  std::vector<int32_t> received;
+  auto sub = node->create_subscription<BasicTypes>(
+    "content_filter_topic", 10,
+    [&received](BasicTypes::SharedPtr msg) {received.push_back(msg->int32_value);},
+    options);
+  EXPECT_TRUE(sub->has_content_filter());
+  auto pub = node->create_publisher<BasicTypes>("content_filter_topic", 10);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  for (int32_t i = 0; i < 4; ++i) {
+    BasicTypes msg;
+    msg.bool_value = i % 2 == 1;
+    msg.int32_value = i;
+    pub->publish(msg);
+  }
+  auto start = std::chrono::steady_clock::now();
+  while (sub->get_content_filter_rejected_count() + received.size() < 4u &&
+    std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    executor.spin_some();
+  }
+  EXPECT_EQ(std::vector<int32_t>({1, 3}), received);
+  EXPECT_EQ(2u, sub->get_content_filter_rejected_count());
+
+  rclcpp::NodeOptions node_options;
+  auto intra_process_node = std::make_shared<rclcpp::Node>(
+    "content_filter_node", "/ns", node_options.use_intra_process_comms(true));
+  EXPECT_THROW(
+    intra_process_node->create_subscription<BasicTypes>(
+      "content_filter_topic", 10, [](BasicTypes::SharedPtr) {}, options),
+    std::invalid_argument);
+}
+
+/*
+   Testing the intra-process delivery of the messages kept by a transient local publisher
+ */
+TEST_F(TestSubscription, intra_process_transient_local) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  auto qos = rclcpp::QoS(rclcpp::KeepLast(2)).transient_local();
+  auto publisher = node->create_publisher<BasicTypes>("latched_topic", qos);
+  for (int32_t i = 0; i < 3; ++i) {
+    BasicTypes msg;
+    msg.int32_value = i;
+    publisher->publish(msg);
+  }
+
+  // The late joiner gets the kept messages, given intra-process and not again by the middleware.
+  std::vector<int32_t> received;
+  auto subscription = node->create_subscription<BasicTypes>(
+    "latched_topic", qos,
+    [&received](BasicTypes::ConstSharedPtr msg) {received.push_back(msg->int32_value);});
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  auto start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(500)) {
+    executor.spin_some(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(std::vector<int32_t>({1, 2}), received);
+}
+
+TEST_F(TestSubscription, take_without_executor) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  auto subscription = node->create_subscription<BasicTypes>(
+    "take_topic", 10, [](BasicTypes::ConstSharedPtr) {FAIL() << "callback called";});
+  auto publisher = node->create_publisher<BasicTypes>("take_topic", 10);
+
+  BasicTypes msg;
+  rmw_message_info_t message_info;
+  EXPECT_FALSE(subscription->take(msg, message_info));
+
+  BasicTypes published;
+  published.int32_value = 42;
+  publisher->publish(published);
+  bool taken = false;
+  auto start = std::chrono::steady_clock::now();
+  while (!taken && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    taken = subscription->take(msg, message_info);
+    if (!taken) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+  ASSERT_TRUE(taken);
+  EXPECT_EQ(42, msg.int32_value);
+  EXPECT_FALSE(subscription->take(msg, message_info));
+}
+
+TEST_F(TestSubscription, intra_process_backlog_executed_at_once) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  std::vector<int32_t> received;
+  auto subscription = node->create_subscription<BasicTypes>(
+    "backlog_topic", 10, [&received](BasicTypes::ConstSharedPtr msg) {
+      received.push_back(msg->int32_value);
+    });
+  auto publisher = node->create_publisher<BasicTypes>("backlog_topic", 10);
+  for (int32_t i = 0; i < 5; ++i) {
+    BasicTypes published;
+    published.int32_value = i;
+    publisher->publish(published);
+  }
+
+  // The messages published before the executor woke up are executed in one go.
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_some();
+  EXPECT_EQ((std::vector<int32_t>{0, 1, 2, 3, 4}), received);
+}
+
+TEST_F(TestSubscription, intra_process_broadcast_ring) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  std::vector<BasicTypes::ConstSharedPtr> received_1;
+  std::vector<BasicTypes::ConstSharedPtr> received_2;
+  auto subscription_1 = node->create_subscription<BasicTypes>(
+    "broadcast_topic", 10, [&received_1](BasicTypes::ConstSharedPtr msg) {
+      received_1.push_back(msg);
+    });
+  // Keeps the last two messages read from the ring.
+  auto subscription_2 = node->create_subscription<BasicTypes>(
+    "broadcast_topic", 2, [&received_2](BasicTypes::ConstSharedPtr msg) {
+      received_2.push_back(msg);
+    });
+  rclcpp::PublisherOptions options;
+  options.intra_process_broadcast_depth = 10;
+  auto publisher = node->create_publisher<BasicTypes>("broadcast_topic", 10, options);
+  for (int32_t i = 0; i < 3; ++i) {
+    BasicTypes published;
+    published.int32_value = i;
+    publisher->publish(published);
+  }
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  executor.spin_some();
+  ASSERT_EQ(3u, received_1.size());
+  ASSERT_EQ(2u, received_2.size());
+  for (int32_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(i, received_1[i]->int32_value);
+  }
+  // Both subscriptions got the message written once in the ring.
+  EXPECT_EQ(received_1[1].get(), received_2[0].get());
+  EXPECT_EQ(received_1[2].get(), received_2[1].get());
+}
+
+TEST_F(TestSubscription, take_intra_process_without_executor) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  using test_msgs::msg::BasicTypes;
+  auto subscription = node->create_subscription<BasicTypes>(
+    "take_topic", 10, [](BasicTypes::ConstSharedPtr) {FAIL() << "callback called";});
+  auto publisher = node->create_publisher<BasicTypes>("take_topic", 10);
+
+  BasicTypes::ConstSharedPtr msg;
+  rmw_message_info_t message_info;
+  EXPECT_FALSE(subscription->take_intra_process(msg, message_info));
+  for (int32_t i = 0; i < 2; ++i) {
+    BasicTypes published;
+    published.int32_value = i;
+    publisher->publish(published);
+  }
+  for (int32_t i = 0; i < 2; ++i) {
+    ASSERT_TRUE(subscription->take_intra_process(msg, message_info));
+    EXPECT_EQ(i, msg->int32_value);
+    EXPECT_TRUE(message_info.from_intra_process);
+  }
+  EXPECT_FALSE(subscription->take_intra_process(msg, message_info));
+}
@@ -0,0 +1,195 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "rclcpp/experimental/synchronized_subscription.hpp"
+#include "rclcpp/rclcpp.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+#include "test_msgs/msg/builtins.hpp"
+
+using test_msgs::msg::BasicTypes;
+using test_msgs::msg::Builtins;
+
+namespace rclcpp
+{
+namespace experimental
+{
+
+// BasicTypes has no stamp, the test uses int64_value.
+template<>
+struct MessageStamp<BasicTypes>
+{
+  static int64_t
+  get(const BasicTypes & msg)
+  {
+    return msg.int64_value;
+  }
+};
+
+template<>
+struct MessageStamp<Builtins>
+{
+  static int64_t
+  get(const Builtins & msg)
+  {
+    return RCL_S_TO_NS(static_cast<int64_t>(msg.time_value.sec)) + msg.time_value.nanosec;
+  }
+};
+
+}  // namespace experimental
+}  // namespace rclcpp
+
+using rclcpp::experimental::MessageSynchronizer;
+using rclcpp::experimental::SynchronizationOptions;
+using rclcpp::experimental::SynchronizationPolicy;
+
+namespace
+{
+
+std::shared_ptr<const BasicTypes>
+make_basic_types(int64_t stamp)
+{
+  auto msg = std::make_shared<BasicTypes>();
+  msg->int64_value = stamp;
+  return msg;
+}
+
+std::shared_ptr<const Builtins>
+make_builtins(int64_t stamp)
+{
+  auto msg = std::make_shared<Builtins>();
+  msg->time_value.sec = static_cast<int32_t>(stamp / RCL_S_TO_NS(1));
+  msg->time_value.nanosec = static_cast<uint32_t>(stamp % RCL_S_TO_NS(1));
+  return msg;
+}
+
+}  // namespace
+
+/*
+   Messages with the same stamp are matched, the older unmatched messages are dropped.
+ */
+TEST(TestSynchronizedSubscription, exact_time) {
+  std::vector<std::pair<int64_t, int64_t>> matches;
+  MessageSynchronizer<BasicTypes, Builtins> synchronizer(
+    SynchronizationOptions(),
+    [&matches](std::shared_ptr<const BasicTypes> a, std::shared_ptr<const Builtins> b) {
+      matches.emplace_back(a->int64_value, b->time_value.nanosec);
+    });
+
+  synchronizer.add<0>(make_basic_types(10));
+  synchronizer.add<0>(make_basic_types(20));
+  synchronizer.add<1>(make_builtins(15));
+  EXPECT_TRUE(matches.empty());
+  synchronizer.add<1>(make_builtins(20));
+  ASSERT_EQ(1u, matches.size());
+  EXPECT_EQ(std::pair<int64_t, int64_t>(20, 20), matches[0]);
+
+  // The message with the stamp 10 was dropped with the match.
+  synchronizer.add<1>(make_builtins(10));
+  EXPECT_EQ(1u, matches.size());
+  synchronizer.add<1>(make_builtins(30));
+  synchronizer.add<0>(make_basic_types(30));
+  ASSERT_EQ(2u, matches.size());
+  EXPECT_EQ(std::pair<int64_t, int64_t>(30, 30), matches[1]);
+}
+
+/*
+   Messages with stamps at most max_interval apart are matched.
+ */
+TEST(TestSynchronizedSubscription, approximate_time) {
+  SynchronizationOptions options;
+  options.policy = SynchronizationPolicy::ApproximateTime;
+  options.max_interval = std::chrono::nanoseconds(5);
+  std::vector<std::pair<int64_t, int64_t>> matches;
+  MessageSynchronizer<BasicTypes, Builtins> synchronizer(
+    options,
+    [&matches](std::shared_ptr<const BasicTypes> a, std::shared_ptr<const Builtins> b) {
+      matches.emplace_back(a->int64_value, b->time_value.nanosec);
+    });
+
+  synchronizer.add<0>(make_basic_types(100));
+  synchronizer.add<1>(make_builtins(110));
+  EXPECT_TRUE(matches.empty());
+  synchronizer.add<0>(make_basic_types(107));
+  ASSERT_EQ(1u, matches.size());
+  EXPECT_EQ(std::pair<int64_t, int64_t>(107, 110), matches[0]);
+}
+
+/*
+   The oldest message of a full queue is dropped.
+ */
+TEST(TestSynchronizedSubscription, queue_size) {
+  SynchronizationOptions options;
+  options.queue_size = 2;
+  size_t match_count = 0;
+  MessageSynchronizer<BasicTypes, Builtins> synchronizer(
+    options,
+    [&match_count](std::shared_ptr<const BasicTypes>, std::shared_ptr<const Builtins>) {
+      ++match_count;
+    });
+
+  for (int64_t stamp = 1; stamp <= 3; ++stamp) {
+    synchronizer.add<0>(make_basic_types(stamp));
+  }
+  EXPECT_EQ(1u, synchronizer.get_dropped_count<0>());
+  synchronizer.add<1>(make_builtins(1));
+  EXPECT_EQ(0u, match_count);
+  synchronizer.add<1>(make_builtins(3));
+  EXPECT_EQ(1u, match_count);
+
+  options.queue_size = 0;
+  EXPECT_THROW(
+    (MessageSynchronizer<BasicTypes, Builtins>(
+      options, [](std::shared_ptr<const BasicTypes>, std::shared_ptr<const Builtins>) {})),
+    std::invalid_argument);
+}
+
+/*
+   The subscriptions give the matched messages to the callback from the executor.
+ */
+TEST(TestSynchronizedSubscription, subscriptions) {
+  rclcpp::init(0, nullptr);
+  {
+    auto node = std::make_shared<rclcpp::Node>(
+      "synchronized_node", "ns", rclcpp::NodeOptions().use_intra_process_comms(true));
+    std::vector<int64_t> matches;
+    auto subscription = rclcpp::experimental::create_synchronized_subscription<
+      BasicTypes, Builtins>(
+      node, {{"basic_types", "builtins"}}, 10,
+      [&matches](std::shared_ptr<const BasicTypes> a, std::shared_ptr<const Builtins>) {
+        matches.push_back(a->int64_value);
+      });
+    auto basic_types_publisher = node->create_publisher<BasicTypes>("basic_types", 10);
+    auto builtins_publisher = node->create_publisher<Builtins>("builtins", 10);
+    basic_types_publisher->publish(*make_basic_types(RCL_S_TO_NS(1)));
+    builtins_publisher->publish(*make_builtins(RCL_S_TO_NS(1)));
+
+    rclcpp::executors::SingleThreadedExecutor executor;
+    executor.add_node(node);
+    auto start = std::chrono::steady_clock::now();
+    while (matches.empty() && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+      executor.spin_some(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(std::vector<int64_t>({RCL_S_TO_NS(1)}), matches);
+  }
+  rclcpp::shutdown();
+}
@@ -15,6 +15,7 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <chrono>
 #include <limits>
 #include <string>
 
@@ -251,6 +252,14 @@ TEST(TestTime, overflows) {
   EXPECT_NO_THROW(max_time - max_time);
   EXPECT_NO_THROW(min_time - min_time);
 
+  // A throwing operation leaves the time unchanged
+  rclcpp::Time changed_time(max_time);
+  EXPECT_THROW(changed_time += one, std::overflow_error);
+  EXPECT_EQ(max_time, changed_time);
+  changed_time = min_time;
+  EXPECT_THROW(changed_time -= one, std::underflow_error);
+  EXPECT_EQ(min_time, changed_time);
+
   // Cross zero in both directions
   rclcpp::Time one_time(1);
   EXPECT_NO_THROW(one_time - two);
@@ -267,8 +276,57 @@ TEST(TestTime, overflows) {
   EXPECT_NO_THROW(one_time - two_time);
 }
 
+TEST(TestTime, chrono_conversions) {
+  auto steady_now = std::chrono::steady_clock::now();
+  rclcpp::Time steady_time(steady_now, RCL_STEADY_TIME);
+  EXPECT_EQ(RCL_STEADY_TIME, steady_time.get_clock_type());
+  EXPECT_EQ(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(steady_now.time_since_epoch()),
+    steady_time.to_chrono<std::chrono::nanoseconds>());
+
+  std::chrono::system_clock::time_point system_point(std::chrono::milliseconds(1500));
+  rclcpp::Time system_time(system_point);
+  EXPECT_EQ(RCL_SYSTEM_TIME, system_time.get_clock_type());
+  EXPECT_EQ(1500000000, system_time.nanoseconds());
+  EXPECT_EQ(std::chrono::seconds(1), system_time.to_chrono<std::chrono::seconds>());
+  EXPECT_EQ(std::chrono::milliseconds(1500), system_time.to_chrono<std::chrono::milliseconds>());
+
+  // The overflow checks can be evaluated at compile time.
+  static_assert(rclcpp::add_will_overflow<int64_t>(INT64_MAX, 1), "constexpr overflow check");
+  static_assert(!rclcpp::sub_will_underflow<int64_t>(0, 1), "constexpr underflow check");
+}
+
 TEST(TestTime, seconds) {
   EXPECT_DOUBLE_EQ(0.0, rclcpp::Time(0, 0).seconds());
   EXPECT_DOUBLE_EQ(4.5, rclcpp::Time(4, 500000000).seconds());
   EXPECT_DOUBLE_EQ(2.5, rclcpp::Time(0, 2500000000).seconds());
 }
+
+TEST(TestTime, now_matches_rcl) {
+  rclcpp::Clock ros_clock(RCL_ROS_TIME);
+  rcl_time_point_value_t rcl_before = 0;
+  ASSERT_EQ(RCL_RET_OK, rcl_clock_get_now(ros_clock.get_clock_handle(), &rcl_before));
+  rcl_time_point_value_t now = ros_clock.now().nanoseconds();
+  rcl_time_point_value_t rcl_after = 0;
+  ASSERT_EQ(RCL_RET_OK, rcl_clock_get_now(ros_clock.get_clock_handle(), &rcl_after));
+  EXPECT_LE(rcl_before, now);
+  EXPECT_GE(rcl_after, now);
+
+  rclcpp::Clock steady_clock(RCL_STEADY_TIME);
+  ASSERT_EQ(RCL_RET_OK, rcl_clock_get_now(steady_clock.get_clock_handle(), &rcl_before));
+  now = steady_clock.now().nanoseconds();
+  ASSERT_EQ(RCL_RET_OK, rcl_clock_get_now(steady_clock.get_clock_handle(), &rcl_after));
+  EXPECT_LE(rcl_before, now);
+  EXPECT_GE(rcl_after, now);
+}
+
+// The ROS time override may be changed with rcl directly, now() has to follow it.
+TEST(TestTime, now_follows_rcl_override) {
+  rclcpp::Clock ros_clock(RCL_ROS_TIME);
+  ASSERT_EQ(RCL_RET_OK, rcl_enable_ros_time_override(ros_clock.get_clock_handle()));
+  ASSERT_EQ(RCL_RET_OK, rcl_set_ros_time_override(ros_clock.get_clock_handle(), 42));
+  EXPECT_EQ(42, ros_clock.now().nanoseconds());
+
+  ASSERT_EQ(RCL_RET_OK, rcl_disable_ros_time_override(ros_clock.get_clock_handle()));
+  EXPECT_LT(42, ros_clock.now().nanoseconds());
+}
@@ -16,13 +16,16 @@
 
 #include <algorithm>
 #include <chrono>
+#include <future>
 #include <limits>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "rcl/error_handling.h"
 #include "rcl/time.h"
 #include "rclcpp/clock.hpp"
+#include "rclcpp/rate.hpp"
 #include "rclcpp/rclcpp.hpp"
 #include "rclcpp/time.hpp"
 #include "rclcpp/time_source.hpp"
@@ -484,6 +487,42 @@ TEST_F(TestTimeSource, parameter_activation) {
   EXPECT_TRUE(ros_clock->ros_time_is_active());
 }
 
+TEST_F(TestTimeSource, parameter_activation_without_spinning) {
+  auto local_node = std::make_shared<rclcpp::Node>("local_parameters_node");
+  auto ros_clock = local_node->get_clock();
+  EXPECT_FALSE(ros_clock->ros_time_is_active());
+
+  // The change is observed as soon as it is set, without spinning.
+  EXPECT_TRUE(local_node->set_parameter(rclcpp::Parameter("use_sim_time", true)).successful);
+  EXPECT_TRUE(ros_clock->ros_time_is_active());
+  EXPECT_FALSE(local_node->set_parameter(rclcpp::Parameter("use_sim_time", 1)).successful);
+  EXPECT_TRUE(ros_clock->ros_time_is_active());
+  EXPECT_TRUE(local_node->set_parameter(rclcpp::Parameter("use_sim_time", false)).successful);
+  EXPECT_FALSE(ros_clock->ros_time_is_active());
+}
+
+TEST_F(TestTimeSource, parameter_redeclaration) {
+  auto local_node = std::make_shared<rclcpp::Node>("redeclared_parameters_node");
+  auto ros_clock = local_node->get_clock();
+  EXPECT_TRUE(local_node->set_parameter(rclcpp::Parameter("use_sim_time", true)).successful);
+  EXPECT_TRUE(ros_clock->ros_time_is_active());
+
+  // Undeclaring the parameter doesn't change the time source, redeclaring it does.
+  local_node->undeclare_parameter("use_sim_time");
+  EXPECT_TRUE(ros_clock->ros_time_is_active());
+  local_node->declare_parameter("use_sim_time", rclcpp::ParameterValue(false));
+  EXPECT_FALSE(ros_clock->ros_time_is_active());
+
+  // The redeclared parameter is still followed.
+  EXPECT_TRUE(local_node->set_parameter(rclcpp::Parameter("use_sim_time", true)).successful);
+  EXPECT_TRUE(ros_clock->ros_time_is_active());
+  local_node->undeclare_parameter("use_sim_time");
+  local_node->declare_parameter("use_sim_time", rclcpp::ParameterValue(true));
+  EXPECT_TRUE(ros_clock->ros_time_is_active());
+  EXPECT_TRUE(local_node->set_parameter(rclcpp::Parameter("use_sim_time", false)).successful);
+  EXPECT_FALSE(ros_clock->ros_time_is_active());
+}
+
 TEST_F(TestTimeSource, no_pre_jump_callback) {
   CallbackObject cbo;
   rcl_jump_threshold_t jump_threshold;
@@ -513,3 +552,189 @@ TEST_F(TestTimeSource, no_pre_jump_callback) {
   EXPECT_EQ(1, cbo.last_postcallback_id_);
   EXPECT_EQ(1, cbo.post_callback_calls_);
 }
+
+TEST_F(TestTimeSource, shared_sim_time) {
+  auto sim_time_source =
+    rclcpp::SimTimeSource::get_instance(node->get_node_base_interface()->get_context());
+  EXPECT_FALSE(sim_time_source->has_subscription());
+
+  rclcpp::TimeSource ts(node);
+  auto other_node = std::make_shared<rclcpp::Node>("my_other_node");
+  rclcpp::TimeSource other_ts(other_node);
+  auto ros_clock = std::make_shared<rclcpp::Clock>(RCL_ROS_TIME);
+  auto other_ros_clock = std::make_shared<rclcpp::Clock>(RCL_ROS_TIME);
+  ts.attachClock(ros_clock);
+  other_ts.attachClock(other_ros_clock);
+
+  set_use_sim_time_parameter(node, rclcpp::ParameterValue(true), ros_clock);
+  spin_until_ros_time_updated(node->get_clock(), node, rclcpp::ParameterValue(true));
+  set_use_sim_time_parameter(other_node, rclcpp::ParameterValue(true), other_ros_clock);
+  spin_until_ros_time_updated(other_node->get_clock(), other_node, rclcpp::ParameterValue(true));
+  EXPECT_TRUE(sim_time_source->has_subscription());
+  // Both clocks plus the ones of the nodes
+  EXPECT_EQ(4u, sim_time_source->get_clock_count());
+
+  // The first node hosts the only subscription, which updates the clocks of both nodes
+  trigger_clock_changes(node, ros_clock);
+  EXPECT_EQ(ros_clock->now(), other_ros_clock->now());
+  EXPECT_EQ(4, static_cast<int>(other_ros_clock->now().seconds()));
+
+  // The subscription moves to the other node, without losing the time
+  set_use_sim_time_parameter(node, rclcpp::ParameterValue(false), ros_clock);
+  spin_until_ros_time_updated(node->get_clock(), node, rclcpp::ParameterValue(false));
+  EXPECT_EQ(2u, sim_time_source->get_clock_count());
+  EXPECT_TRUE(sim_time_source->has_subscription());
+  EXPECT_EQ(4, static_cast<int>(other_ros_clock->now().seconds()));
+  trigger_clock_changes(other_node, other_ros_clock);
+
+  set_use_sim_time_parameter(other_node, rclcpp::ParameterValue(false), other_ros_clock);
+  spin_until_ros_time_updated(other_node->get_clock(), other_node, rclcpp::ParameterValue(false));
+  EXPECT_FALSE(sim_time_source->has_subscription());
+  EXPECT_EQ(0u, sim_time_source->get_clock_count());
+  EXPECT_EQ(0, sim_time_source->get_time());
+}
+
+TEST_F(TestTimeSource, sim_time_updates_rcl_clock) {
+  auto sim_time_source = std::make_shared<rclcpp::SimTimeSource>();
+  auto ros_clock = std::make_shared<rclcpp::Clock>(RCL_ROS_TIME);
+  sim_time_source->attach_clock(ros_clock);
+  EXPECT_TRUE(ros_clock->ros_time_is_active());
+
+  sim_time_source->set_time(RCUTILS_S_TO_NS(5));
+  EXPECT_EQ(RCUTILS_S_TO_NS(5), ros_clock->now().nanoseconds());
+
+  // The rcl clock is updated before its handle is used
+  rcl_time_point_value_t rcl_now = 0;
+  EXPECT_EQ(RCL_RET_OK, rcl_clock_get_now(ros_clock->get_clock_handle(), &rcl_now));
+  EXPECT_EQ(RCUTILS_S_TO_NS(5), rcl_now);
+
+  // Clocks with jump callbacks are updated on each change
+  CallbackObject cbo;
+  rcl_jump_threshold_t jump_threshold;
+  jump_threshold.min_forward.nanoseconds = 1;
+  jump_threshold.min_backward.nanoseconds = -1;
+  jump_threshold.on_clock_change = true;
+  auto callback_handler = ros_clock->create_jump_callback(
+    nullptr,
+    std::bind(&CallbackObject::post_callback, &cbo, std::placeholders::_1, 1),
+    jump_threshold);
+  sim_time_source->set_time(RCUTILS_S_TO_NS(6));
+  EXPECT_EQ(1, cbo.post_callback_calls_);
+  EXPECT_EQ(RCUTILS_S_TO_NS(1), cbo.last_timejump_.delta.nanoseconds);
+
+  sim_time_source->detach_clock(ros_clock);
+  sim_time_source->set_time(RCUTILS_S_TO_NS(7));
+  EXPECT_EQ(RCUTILS_S_TO_NS(6), ros_clock->now().nanoseconds());
+}
+
+TEST_F(TestTimeSource, clock_sleep_until_sim_time) {
+  auto sim_time_source = std::make_shared<rclcpp::SimTimeSource>();
+  auto ros_clock = std::make_shared<rclcpp::Clock>(RCL_ROS_TIME);
+  sim_time_source->attach_clock(ros_clock);
+  sim_time_source->set_time(RCUTILS_S_TO_NS(1));
+
+  // The time of another clock type is rejected
+  EXPECT_THROW(
+    ros_clock->sleep_until(rclcpp::Time(RCUTILS_S_TO_NS(2), RCL_STEADY_TIME)),
+    std::invalid_argument);
+  // A time already reached doesn't sleep
+  EXPECT_TRUE(ros_clock->sleep_until(rclcpp::Time(RCUTILS_S_TO_NS(1), RCL_ROS_TIME)));
+
+  // The sleep ends with the update of the simulated time reaching it, whatever the wall time
+  auto sleep = std::async(
+    std::launch::async, [ros_clock]() {
+      return ros_clock->sleep_until(rclcpp::Time(RCUTILS_S_TO_NS(3), RCL_ROS_TIME));
+    });
+  sim_time_source->set_time(RCUTILS_S_TO_NS(2));
+  EXPECT_EQ(std::future_status::timeout, sleep.wait_for(50ms));
+  sim_time_source->set_time(RCUTILS_S_TO_NS(3));
+  ASSERT_EQ(std::future_status::ready, sleep.wait_for(5s));
+  EXPECT_TRUE(sleep.get());
+
+  // The updates through the rcl clock wake it up too
+  sleep = std::async(
+    std::launch::async, [ros_clock]() {
+      return ros_clock->sleep_for(rclcpp::Duration::from_seconds(1.0));
+    });
+  sim_time_source->detach_clock(ros_clock);
+  EXPECT_EQ(std::future_status::timeout, sleep.wait_for(50ms));
+  EXPECT_EQ(
+    RCL_RET_OK, rcl_set_ros_time_override(ros_clock->get_clock_handle(), RCUTILS_S_TO_NS(5)));
+  ASSERT_EQ(std::future_status::ready, sleep.wait_for(5s));
+  EXPECT_TRUE(sleep.get());
+
+  // The shutdown of the context interrupts it
+  auto context = std::make_shared<rclcpp::Context>();
+  context->init(0, nullptr);
+  sleep = std::async(
+    std::launch::async, [ros_clock, context]() {
+      return ros_clock->sleep_until(rclcpp::Time(RCUTILS_S_TO_NS(10), RCL_ROS_TIME), context);
+    });
+  EXPECT_EQ(std::future_status::timeout, sleep.wait_for(50ms));
+  context->shutdown("test");
+  ASSERT_EQ(std::future_status::ready, sleep.wait_for(5s));
+  EXPECT_FALSE(sleep.get());
+  EXPECT_THROW(
+    ros_clock->sleep_until(rclcpp::Time(RCUTILS_S_TO_NS(10), RCL_ROS_TIME), context),
+    std::runtime_error);
+}
+
+TEST_F(TestTimeSource, clock_rate_sim_time) {
+  auto sim_time_source = std::make_shared<rclcpp::SimTimeSource>();
+  auto ros_clock = std::make_shared<rclcpp::Clock>(RCL_ROS_TIME);
+  sim_time_source->attach_clock(ros_clock);
+  sim_time_source->set_time(RCUTILS_S_TO_NS(1));
+
+  rclcpp::ClockRate rate(10.0, ros_clock);
+  EXPECT_FALSE(rate.is_steady());
+  EXPECT_EQ(RCUTILS_MS_TO_NS(100), rate.period().nanoseconds());
+
+  auto sleep = std::async(std::launch::async, [&rate]() {return rate.sleep();});
+  EXPECT_EQ(std::future_status::timeout, sleep.wait_for(50ms));
+  sim_time_source->set_time(RCUTILS_S_TO_NS(1) + RCUTILS_MS_TO_NS(100));
+  ASSERT_EQ(std::future_status::ready, sleep.wait_for(5s));
+  EXPECT_TRUE(sleep.get());
+
+  // A missed interval doesn't sleep
+  sim_time_source->set_time(RCUTILS_S_TO_NS(2));
+  EXPECT_FALSE(rate.sleep());
+
+  rclcpp::ClockRate steady_rate(
+    rclcpp::Duration::from_seconds(0.01), std::make_shared<rclcpp::Clock>(RCL_STEADY_TIME));
+  EXPECT_TRUE(steady_rate.is_steady());
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(steady_rate.sleep());
+  EXPECT_LE(10ms, std::chrono::steady_clock::now() - start);
+  EXPECT_THROW(rclcpp::ClockRate(10.0, nullptr), std::invalid_argument);
+}
+
+TEST_F(TestTimeSource, many_nodes_one_subscription) {
+  auto sim_time_source =
+    rclcpp::SimTimeSource::get_instance(node->get_node_base_interface()->get_context());
+  rclcpp::NodeOptions options;
+  options.parameter_overrides({rclcpp::Parameter("use_sim_time", true)});
+  rclcpp::executors::SingleThreadedExecutor executor;
+  std::vector<rclcpp::Node::SharedPtr> nodes;
+  for (int i = 0; i < 20; ++i) {
+    nodes.push_back(std::make_shared<rclcpp::Node>("sim_node_" + std::to_string(i), options));
+    executor.add_node(nodes.back());
+  }
+  EXPECT_TRUE(sim_time_source->has_subscription());
+  EXPECT_EQ(nodes.size(), sim_time_source->get_clock_count());
+
+  auto clock_pub = node->create_publisher<rosgraph_msgs::msg::Clock>("clock", 10);
+  rosgraph_msgs::msg::Clock msg;
+  msg.clock.sec = 42;
+  auto start = std::chrono::steady_clock::now();
+  while (nodes.back()->now().seconds() != 42 && std::chrono::steady_clock::now() - start < 1s) {
+    clock_pub->publish(msg);
+    executor.spin_once(10ms);
+  }
+  for (auto & sim_node : nodes) {
+    EXPECT_EQ(42, static_cast<int>(sim_node->now().seconds()));
+  }
+
+  nodes.clear();
+  EXPECT_FALSE(sim_time_source->has_subscription());
+  EXPECT_EQ(0u, sim_time_source->get_clock_count());
+}
@@ -18,6 +18,7 @@
 #include <chrono>
 #include <exception>
 #include <memory>
+#include <thread>
 
 #include "rcl/timer.h"
 
@@ -151,3 +152,76 @@ TEST_F(TestTimer, test_run_cancel_timer)
   EXPECT_TRUE(has_timer_run.load());
   EXPECT_TRUE(timer->is_canceled());
 }
+
+/// Claiming a timer for an executor thread returns the previous state
+TEST_F(TestTimer, test_exchange_in_use_by_executor_state)
+{
+  EXPECT_FALSE(timer->exchange_in_use_by_executor_state(true));
+  EXPECT_TRUE(timer->exchange_in_use_by_executor_state(true));
+  EXPECT_TRUE(timer->exchange_in_use_by_executor_state(false));
+  EXPECT_FALSE(timer->exchange_in_use_by_executor_state(false));
+}
+
+/// The latency of the callbacks is measured from their deadline
+TEST_F(TestTimer, test_statistics)
+{
+  auto statistics = timer->get_statistics();
+  EXPECT_EQ(0u, statistics.count);
+  EXPECT_EQ(0, statistics.max_latency.count());
+
+  std::this_thread::sleep_for(110ms);
+  timer->execute_callback();
+  std::this_thread::sleep_for(120ms);
+  timer->execute_callback();
+  statistics = timer->get_statistics();
+  EXPECT_EQ(2u, statistics.count);
+  EXPECT_LE(statistics.min_latency, statistics.mean_latency);
+  EXPECT_LE(statistics.mean_latency, statistics.max_latency);
+  EXPECT_LE(0, statistics.min_latency.count());
+  EXPECT_LE(0, statistics.jitter.count());
+
+  // Called before its deadline, not measured
+  timer->execute_callback();
+  EXPECT_EQ(2u, timer->get_statistics().count);
+
+  timer->reset_statistics();
+  EXPECT_EQ(0u, timer->get_statistics().count);
+}
+
+/// The overrun policy decides how many callbacks are called for the missed periods
+TEST_F(TestTimer, test_overrun_policy)
+{
+  size_t call_count = 0;
+  auto counting_timer = test_node->create_wall_timer(
+    50ms, [&call_count]() {++call_count;});
+  EXPECT_EQ(rclcpp::TimerOverrunPolicy::FireOnce, counting_timer->get_overrun_policy());
+
+  // About 2.6 periods late, 2 periods are missed
+  std::this_thread::sleep_for(180ms);
+  counting_timer->execute_callback();
+  EXPECT_EQ(1u, call_count);
+  auto statistics = counting_timer->get_statistics();
+  EXPECT_EQ(1u, statistics.overrun_count);
+  EXPECT_EQ(2u, statistics.missed_count);
+  EXPECT_LE(130ms, statistics.max_latency);
+
+  counting_timer->set_overrun_policy(rclcpp::TimerOverrunPolicy::SkipMissed);
+  std::this_thread::sleep_for(180ms);
+  counting_timer->execute_callback();
+  EXPECT_EQ(1u, call_count);
+  statistics = counting_timer->get_statistics();
+  EXPECT_EQ(2u, statistics.overrun_count);
+  EXPECT_LE(5u, statistics.missed_count);
+
+  counting_timer->set_overrun_policy(rclcpp::TimerOverrunPolicy::CatchUp, 1);
+  std::this_thread::sleep_for(180ms);
+  counting_timer->execute_callback();
+  EXPECT_EQ(3u, call_count);
+  EXPECT_EQ(3u, counting_timer->get_statistics().overrun_count);
+
+  // Not late, called once whatever the policy
+  std::this_thread::sleep_for(60ms);
+  counting_timer->execute_callback();
+  EXPECT_EQ(4u, call_count);
+  EXPECT_EQ(3u, counting_timer->get_statistics().overrun_count);
+}
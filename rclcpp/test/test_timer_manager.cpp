@@ -0,0 +1,249 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "rclcpp/executors/single_threaded_executor.hpp"
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/timer_manager.hpp"
+
+using namespace std::chrono_literals;
+
+class TestTimerManager : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("test_timer_manager_node");
+  }
+
+  void TearDown() override
+  {
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+static bool
+take_any(const rclcpp::TimerBase::SharedPtr &)
+{
+  return true;
+}
+
+/*
+   The expired timers are taken in deadline order, and rescheduled once executed
+ */
+TEST_F(TestTimerManager, deadline_order) {
+  rclcpp::executor::TimerManager manager;
+  EXPECT_GT(0, manager.get_time_until_next_deadline().count());
+
+  auto late = node->create_wall_timer(50ms, []() {});
+  auto early = node->create_wall_timer(30ms, []() {});
+  manager.start_collection();
+  EXPECT_TRUE(manager.manage(late));
+  EXPECT_TRUE(manager.manage(early));
+  EXPECT_EQ(2u, manager.size());
+
+  auto time_until_deadline = manager.get_time_until_next_deadline();
+  EXPECT_LE(0, time_until_deadline.count());
+  EXPECT_GE(30ms, time_until_deadline);
+  EXPECT_EQ(nullptr, manager.get_next_ready_timer(take_any));
+
+  std::this_thread::sleep_for(60ms);
+  EXPECT_EQ(0, manager.get_time_until_next_deadline().count());
+  EXPECT_EQ(early, manager.get_next_ready_timer(take_any));
+  EXPECT_EQ(late, manager.get_next_ready_timer(take_any));
+  EXPECT_EQ(nullptr, manager.get_next_ready_timer(take_any));
+
+  early->execute_callback();
+  manager.reschedule(early);
+  EXPECT_LT(0, manager.get_time_until_next_deadline().count());
+}
+
+/*
+   Timers which can't be taken are skipped, and stay expired
+ */
+TEST_F(TestTimerManager, skip_timers) {
+  rclcpp::executor::TimerManager manager;
+  auto first = node->create_wall_timer(10ms, []() {});
+  auto second = node->create_wall_timer(20ms, []() {});
+  manager.start_collection();
+  manager.manage(first);
+  manager.manage(second);
+
+  std::this_thread::sleep_for(30ms);
+  auto not_first = [&first](const rclcpp::TimerBase::SharedPtr & timer) {
+      return timer != first;
+    };
+  EXPECT_EQ(second, manager.get_next_ready_timer(not_first));
+  EXPECT_EQ(first, manager.get_next_ready_timer(take_any));
+}
+
+/*
+   Canceled timers, and the ones not found by the last collection, are not scheduled
+ */
+TEST_F(TestTimerManager, canceled_and_removed_timers) {
+  rclcpp::executor::TimerManager manager;
+  auto canceled = node->create_wall_timer(10ms, []() {});
+  auto removed = node->create_wall_timer(10ms, []() {});
+  manager.start_collection();
+  manager.manage(canceled);
+  manager.manage(removed);
+
+  canceled->cancel();
+  manager.start_collection();
+  manager.manage(canceled);
+  std::this_thread::sleep_for(20ms);
+  EXPECT_EQ(nullptr, manager.get_next_ready_timer(take_any));
+  EXPECT_GT(0, manager.get_time_until_next_deadline().count());
+
+  canceled->reset();
+  manager.start_collection();
+  manager.manage(canceled);
+  EXPECT_EQ(1u, manager.size());
+  std::this_thread::sleep_for(20ms);
+  EXPECT_EQ(canceled, manager.get_next_ready_timer(take_any));
+}
+
+/*
+   The timers using the ROS time are not managed
+ */
+TEST_F(TestTimerManager, ros_time_timer) {
+  rclcpp::executor::TimerManager manager;
+  auto timer = std::make_shared<rclcpp::GenericTimer<std::function<void()>>>(
+    std::make_shared<rclcpp::Clock>(RCL_ROS_TIME), 10ms, []() {},
+    node->get_node_base_interface()->get_context());
+  manager.start_collection();
+  EXPECT_FALSE(manager.manage(timer));
+  EXPECT_EQ(0u, manager.size());
+}
+
+/*
+   The wake-ups of timers with a slack are coalesced
+ */
+TEST_F(TestTimerManager, slack) {
+  rclcpp::executor::TimerManager manager;
+  auto first = node->create_wall_timer(10ms, []() {}, nullptr, 50ms);
+  auto second = node->create_wall_timer(30ms, []() {}, nullptr, 50ms);
+  EXPECT_EQ(50ms, first->get_slack());
+  EXPECT_THROW(first->set_slack(-1ms), std::invalid_argument);
+  manager.start_collection();
+  manager.manage(first);
+  manager.manage(second);
+
+  // Woken up by the first deadline plus its slack, once both timers expired
+  auto time_until_wake_up = manager.get_time_until_next_deadline();
+  EXPECT_LT(30ms, time_until_wake_up);
+  EXPECT_GE(60ms, time_until_wake_up);
+
+  // A timer without slack brings the wake-up forward
+  auto strict = node->create_wall_timer(20ms, []() {});
+  manager.manage(strict);
+  EXPECT_GE(20ms, manager.get_time_until_next_deadline());
+
+  std::this_thread::sleep_for(35ms);
+  EXPECT_EQ(0, manager.get_time_until_next_deadline().count());
+  EXPECT_EQ(first, manager.get_next_ready_timer(take_any));
+  EXPECT_EQ(strict, manager.get_next_ready_timer(take_any));
+  EXPECT_EQ(second, manager.get_next_ready_timer(take_any));
+}
+
+/*
+   An executor with managed timers executes them periodically
+ */
+TEST_F(TestTimerManager, executor_manage_timers) {
+  rclcpp::executor::ExecutorArgs args;
+  args.manage_timers = true;
+  rclcpp::executors::SingleThreadedExecutor executor(args);
+
+  size_t fast_count = 0;
+  size_t slow_count = 0;
+  auto fast = node->create_wall_timer(10ms, [&fast_count]() {fast_count++;});
+  auto slow = node->create_wall_timer(30ms, [&slow_count]() {slow_count++;});
+  executor.add_node(node);
+
+  auto start = std::chrono::steady_clock::now();
+  while (std::chrono::steady_clock::now() - start < 200ms) {
+    executor.spin_once(10ms);
+  }
+  EXPECT_LE(10u, fast_count);
+  EXPECT_GE(21u, fast_count);
+  EXPECT_LE(3u, slow_count);
+  EXPECT_GE(7u, slow_count);
+  EXPECT_GT(fast_count, slow_count);
+}
+
+/*
+   Waiting ends at the deadline, or as soon as there is a notification
+ */
+TEST_F(TestTimerManager, wait_until) {
+  rclcpp::executor::TimerManager manager;
+  auto deadline = std::chrono::steady_clock::now() + 20ms;
+  EXPECT_TRUE(manager.wait_until(deadline, 5ms, manager.get_notification_count()));
+  EXPECT_LE(deadline, std::chrono::steady_clock::now());
+
+  // A notification given since the count was read is not missed
+  auto count = manager.get_notification_count();
+  manager.notify();
+  EXPECT_FALSE(manager.wait_until(std::chrono::steady_clock::time_point::max(), 0ms, count));
+
+  // Pushing a nearer deadline notifies
+  count = manager.get_notification_count();
+  auto timer = node->create_wall_timer(10ms, []() {});
+  manager.start_collection();
+  manager.manage(timer);
+  EXPECT_NE(count, manager.get_notification_count());
+}
+
+/*
+   The timer thread executes the managed timers close to their deadline
+ */
+TEST_F(TestTimerManager, executor_timer_thread) {
+  rclcpp::executor::ExecutorArgs args;
+  args.timer_thread = true;
+  args.timer_thread_spin_threshold = 1ms;
+  rclcpp::executors::SingleThreadedExecutor executor(args);
+
+  std::atomic<size_t> count(0);
+  auto timer = node->create_wall_timer(5ms, [&count]() {count++;});
+  executor.add_node(node);
+
+  std::thread spin_thread([&executor]() {executor.spin();});
+  std::this_thread::sleep_for(200ms);
+  executor.cancel();
+  spin_thread.join();
+  // Let a callback taken before the cancel complete
+  std::this_thread::sleep_for(10ms);
+
+  EXPECT_LE(20u, count.load());
+  EXPECT_GE(41u, count.load());
+  auto statistics = timer->get_statistics();
+  EXPECT_EQ(count.load(), statistics.count);
+  EXPECT_LE(statistics.min_latency, statistics.max_latency);
+
+  // Nothing is executed while the executor is not spinning
+  size_t stopped_count = count.load();
+  std::this_thread::sleep_for(20ms);
+  EXPECT_EQ(stopped_count, count.load());
+}
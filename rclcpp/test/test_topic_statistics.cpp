@@ -0,0 +1,176 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "rcl_interfaces/msg/parameter_event.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/topic_statistics.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+using rclcpp::TopicStatisticsCollector;
+using rclcpp::TopicStatisticsOptions;
+
+class TestTopicStatistics : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+
+  void SetUp()
+  {
+    node = std::make_shared<rclcpp::Node>("test_topic_statistics", "/ns");
+  }
+
+  void TearDown()
+  {
+    node.reset();
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+struct StampedMessage
+{
+  struct
+  {
+    struct
+    {
+      int32_t sec;
+      uint32_t nanosec;
+    } stamp;
+  } header;
+};
+
+/*
+   The age is only known for messages with a header, and closing a window resets the counters.
+ */
+TEST_F(TestTopicStatistics, collect_window) {
+  TopicStatisticsOptions options;
+  options.enabled = true;
+  options.publish_period = std::chrono::hours(1);
+  options.publish_topic = "";
+  TopicStatisticsCollector collector(node->get_node_base_interface().get(), "/topic", options);
+
+  collector.record_message(test_msgs::msg::BasicTypes());
+  auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+  StampedMessage stamped;
+  stamped.header.stamp.sec = static_cast<int32_t>(now / 1000000000 - 1);
+  stamped.header.stamp.nanosec = static_cast<uint32_t>(now % 1000000000);
+  collector.record_message(stamped);
+  collector.record(std::chrono::nanoseconds(-1), 100);
+  collector.record(std::chrono::nanoseconds(-1), 300);
+
+  auto window = collector.get_current_window();
+  EXPECT_EQ(4u, window.message_count);
+  EXPECT_EQ(1u, window.age_count);
+  EXPECT_LE(std::chrono::nanoseconds(std::chrono::seconds(1)), window.age_min);
+  EXPECT_EQ(window.age_min, window.age_max);
+  EXPECT_EQ(2u, window.size_count);
+  EXPECT_EQ(100u, window.size_min);
+  EXPECT_EQ(300u, window.size_max);
+  EXPECT_EQ(200u, window.size_mean);
+  EXPECT_LT(0.0, window.message_rate);
+
+  auto closed_window = collector.close_window();
+  EXPECT_EQ(4u, closed_window.message_count);
+  EXPECT_EQ(4u, collector.get_last_window().message_count);
+  EXPECT_EQ(0u, collector.get_current_window().message_count);
+  EXPECT_EQ(0u, collector.get_current_window().size_count);
+
+  options.publish_period = std::chrono::milliseconds(0);
+  EXPECT_THROW(
+    TopicStatisticsCollector(node->get_node_base_interface().get(), "/topic", options),
+    std::invalid_argument);
+}
+
+/*
+   The transport latency of the message info is used as the age when it is known.
+ */
+TEST_F(TestTopicStatistics, transport_latency) {
+  TopicStatisticsOptions options;
+  options.enabled = true;
+  options.publish_period = std::chrono::hours(1);
+  options.publish_topic = "";
+  TopicStatisticsCollector collector(node->get_node_base_interface().get(), "/topic", options);
+
+  rmw_message_info_t rmw_message_info;
+  rmw_message_info.from_intra_process = false;
+  rclcpp::MessageInfo message_info(rmw_message_info, 5000);
+  collector.record_message(test_msgs::msg::BasicTypes(), message_info);
+  EXPECT_EQ(0u, collector.get_current_window().age_count);
+
+  message_info.set_source_timestamp(3000);
+  collector.record_message(test_msgs::msg::BasicTypes(), message_info);
+  auto window = collector.get_current_window();
+  EXPECT_EQ(2u, window.message_count);
+  EXPECT_EQ(1u, window.age_count);
+  EXPECT_EQ(std::chrono::nanoseconds(2000), window.age_min);
+}
+
+/*
+   A subscription with statistics enabled publishes them periodically on the statistics topic.
+ */
+TEST_F(TestTopicStatistics, publish_statistics) {
+  using test_msgs::msg::BasicTypes;
+  rclcpp::SubscriptionOptions options;
+  options.topic_statistics.enabled = true;
+  options.topic_statistics.publish_period = std::chrono::milliseconds(50);
+  options.topic_statistics.publish_topic = "/test_statistics";
+  auto sub = node->create_subscription<BasicTypes>(
+    "statistics_topic", 10, [](BasicTypes::SharedPtr) {}, options);
+  ASSERT_NE(nullptr, sub->get_topic_statistics());
+  EXPECT_EQ(
+    nullptr,
+    node->create_subscription<BasicTypes>(
+      "statistics_topic", 10, [](BasicTypes::SharedPtr) {})->get_topic_statistics());
+
+  bool received = false;
+  auto statistics_sub = node->create_subscription<rcl_interfaces::msg::ParameterEvent>(
+    "/test_statistics", 10,
+    [&received](rcl_interfaces::msg::ParameterEvent::SharedPtr msg) {
+      EXPECT_EQ("/ns/test_topic_statistics", msg->node);
+      ASSERT_FALSE(msg->new_parameters.empty());
+      EXPECT_EQ("/ns/statistics_topic/window_duration_ns", msg->new_parameters[0].name);
+      received = true;
+    });
+  auto pub = node->create_publisher<BasicTypes>("statistics_topic", 10);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  auto start = std::chrono::steady_clock::now();
+  while (!received && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    pub->publish(BasicTypes());
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    executor.spin_some();
+  }
+  EXPECT_TRUE(received);
+  EXPECT_LT(0u, sub->get_topic_statistics()->get_last_window().message_count);
+}
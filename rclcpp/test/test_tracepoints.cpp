@@ -0,0 +1,167 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/tracepoints.hpp"
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+using rclcpp::tracing::Tracepoint;
+
+namespace
+{
+
+struct Event
+{
+  Tracepoint tracepoint;
+  const void * handle;
+  const void * data;
+};
+
+std::mutex g_events_mutex;
+std::vector<Event> g_events;
+
+void
+record_event(Tracepoint tracepoint, const void * handle, const void * data)
+{
+  std::lock_guard<std::mutex> lock(g_events_mutex);
+  g_events.push_back({tracepoint, handle, data});
+}
+
+}  // namespace
+
+class TestTracepoints : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+  static void TearDownTestCase()
+  {
+    rclcpp::shutdown();
+  }
+
+  void SetUp()
+  {
+    node = std::make_shared<rclcpp::Node>("test_tracepoints");
+    g_events.clear();
+  }
+
+  void TearDown()
+  {
+    rclcpp::tracing::set_tracepoint_handler(nullptr);
+    node.reset();
+  }
+
+  // Return the events of a tracepoint, in order.
+  std::vector<Event> events(Tracepoint tracepoint)
+  {
+    std::lock_guard<std::mutex> lock(g_events_mutex);
+    std::vector<Event> result;
+    for (auto & event : g_events) {
+      if (event.tracepoint == tracepoint) {
+        result.push_back(event);
+      }
+    }
+    return result;
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST_F(TestTracepoints, publish_take_and_execute) {
+  int count = 0;
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "topic", 10, [&count](test_msgs::msg::Empty::SharedPtr) {count++;});
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("topic", 10);
+  rclcpp::tracing::set_tracepoint_handler(&record_event);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  publisher->publish(test_msgs::msg::Empty());
+  auto end = std::chrono::steady_clock::now() + 5s;
+  while (count < 1 && std::chrono::steady_clock::now() < end) {
+    executor.spin_once(100ms);
+  }
+  ASSERT_EQ(1, count);
+
+  if (!rclcpp::tracing::tracepoints_enabled()) {
+    // Compiled out, the handler is never called.
+    std::lock_guard<std::mutex> lock(g_events_mutex);
+    EXPECT_TRUE(g_events.empty());
+    return;
+  }
+  auto publish = events(Tracepoint::Publish);
+  ASSERT_EQ(1u, publish.size());
+  EXPECT_EQ(publisher->get_publisher_handle(), publish[0].handle);
+  auto take = events(Tracepoint::Take);
+  ASSERT_EQ(1u, take.size());
+  EXPECT_EQ(subscription->get_subscription_handle().get(), take[0].handle);
+  EXPECT_NE(nullptr, take[0].data);
+  auto start = events(Tracepoint::ExecuteStart);
+  ASSERT_FALSE(start.empty());
+  EXPECT_EQ(subscription.get(), start.back().handle);
+  auto end_events = events(Tracepoint::ExecuteEnd);
+  ASSERT_EQ(start.size(), end_events.size());
+  EXPECT_EQ(subscription.get(), end_events.back().handle);
+}
+
+TEST_F(TestTracepoints, intra_process) {
+  int count = 0;
+  auto options = rclcpp::SubscriptionOptions();
+  options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "topic", 10, [&count](test_msgs::msg::Empty::UniquePtr) {count++;}, options);
+  auto publisher_options = rclcpp::PublisherOptions();
+  publisher_options.use_intra_process_comm = rclcpp::IntraProcessSetting::Enable;
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>(
+    "topic", 10, publisher_options);
+  rclcpp::tracing::set_tracepoint_handler(&record_event);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  auto msg = std::make_unique<test_msgs::msg::Empty>();
+  const void * msg_ptr = msg.get();
+  publisher->publish(std::move(msg));
+  auto end = std::chrono::steady_clock::now() + 5s;
+  while (count < 1 && std::chrono::steady_clock::now() < end) {
+    executor.spin_once(100ms);
+  }
+  ASSERT_EQ(1, count);
+
+  if (!rclcpp::tracing::tracepoints_enabled()) {
+    return;
+  }
+  auto publish = events(Tracepoint::IntraProcessPublish);
+  ASSERT_EQ(1u, publish.size());
+  EXPECT_EQ(publisher->get_publisher_handle(), publish[0].handle);
+  EXPECT_EQ(msg_ptr, publish[0].data);
+  auto enqueue = events(Tracepoint::IntraProcessEnqueue);
+  ASSERT_EQ(1u, enqueue.size());
+  EXPECT_EQ(msg_ptr, enqueue[0].data);
+  auto dequeue = events(Tracepoint::IntraProcessDequeue);
+  ASSERT_EQ(1u, dequeue.size());
+  EXPECT_EQ(enqueue[0].handle, dequeue[0].handle);
+  EXPECT_EQ(msg_ptr, dequeue[0].data);
+}
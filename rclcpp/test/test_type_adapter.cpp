@@ -0,0 +1,206 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/type_adapter.hpp"
+
+#include "test_msgs/msg/basic_types.hpp"
+
+struct CustomInt
+{
+  int32_t value = 0;
+};
+
+static size_t g_conversion_count = 0;
+
+template<>
+struct rclcpp::TypeAdapter<CustomInt, test_msgs::msg::BasicTypes>
+{
+  using is_specialized = std::true_type;
+  using custom_type = CustomInt;
+  using ros_message_type = test_msgs::msg::BasicTypes;
+
+  static void
+  convert_to_ros_message(const custom_type & source, ros_message_type & destination)
+  {
+    ++g_conversion_count;
+    destination.int32_value = source.value;
+  }
+
+  static void
+  convert_to_custom(const ros_message_type & source, custom_type & destination)
+  {
+    ++g_conversion_count;
+    destination.value = source.int32_value;
+  }
+};
+
+using AdaptedInt = rclcpp::TypeAdapter<CustomInt, test_msgs::msg::BasicTypes>;
+
+class TestTypeAdapter : public ::testing::Test
+{
+public:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+
+protected:
+  void initialize(const rclcpp::NodeOptions & node_options = rclcpp::NodeOptions())
+  {
+    g_conversion_count = 0;
+    node = std::make_shared<rclcpp::Node>("test_type_adapter", "/ns", node_options);
+  }
+
+  void TearDown()
+  {
+    node.reset();
+  }
+
+  template<typename ConditionT>
+  void
+  spin_until(rclcpp::executors::SingleThreadedExecutor & executor, ConditionT condition)
+  {
+    auto start = std::chrono::steady_clock::now();
+    while (!condition() && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      executor.spin_some();
+    }
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+/*
+   Testing the types deduced for adapted and not adapted message types.
+ */
+TEST_F(TestTypeAdapter, traits) {
+  using test_msgs::msg::BasicTypes;
+  static_assert(AdaptedInt::is_specialized::value, "the adapter should be specialized");
+  static_assert(
+    std::is_same<rclcpp::TypeAdapter<AdaptedInt>::custom_type, CustomInt>::value,
+    "the adapter of an adapter should be itself");
+  static_assert(
+    std::is_same<rclcpp::adapt_type<CustomInt>::as<BasicTypes>, AdaptedInt>::value,
+    "adapt_type should give the adapter");
+  static_assert(
+    !rclcpp::TypeAdapter<BasicTypes>::is_specialized::value,
+    "a ROS message should not be adapted");
+  static_assert(
+    std::is_same<rclcpp::Publisher<AdaptedInt>::ROSMessageType, BasicTypes>::value,
+    "an adapted publisher should publish the ROS message type");
+  static_assert(
+    std::is_same<rclcpp::Subscription<AdaptedInt>::CallbackMessageT, CustomInt>::value,
+    "an adapted subscription should give the custom type");
+  static_assert(
+    std::is_same<
+      rclcpp::subscription_traits::subscribed_type<AdaptedInt, BasicTypes>::type,
+      BasicTypes>::value,
+    "a callback taking the ROS message should create a ROS message subscription");
+}
+
+/*
+   Testing that intra-process messages of an adapted type are given without any conversion.
+ */
+TEST_F(TestTypeAdapter, intra_process_without_conversion) {
+  initialize(rclcpp::NodeOptions().use_intra_process_comms(true));
+  std::vector<int32_t> received;
+  auto sub = node->create_subscription<AdaptedInt>(
+    "type_adapter_intra_process_topic", 10,
+    [&received](std::shared_ptr<const CustomInt> msg) {received.push_back(msg->value);});
+  auto pub = node->create_publisher<AdaptedInt>("type_adapter_intra_process_topic", 10);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  for (int32_t i = 0; i < 3; ++i) {
+    auto msg = std::make_unique<CustomInt>();
+    msg->value = i;
+    pub->publish(std::move(msg));
+  }
+  spin_until(executor, [&received]() {return received.size() >= 3u;});
+  EXPECT_EQ(std::vector<int32_t>({0, 1, 2}), received);
+  EXPECT_EQ(0u, g_conversion_count);
+}
+
+/*
+   Testing that an adapted publisher and a subscription of the ROS message type communicate,
+   the messages being converted for the middleware.
+ */
+TEST_F(TestTypeAdapter, adapted_publisher_ros_subscription) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  std::vector<int32_t> received;
+  auto sub = node->create_subscription<BasicTypes>(
+    "type_adapter_ros_topic", 10,
+    [&received](BasicTypes::SharedPtr msg) {received.push_back(msg->int32_value);});
+  auto pub = node->create_publisher<AdaptedInt>("type_adapter_ros_topic", 10);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  CustomInt msg;
+  msg.value = 42;
+  pub->publish(msg);
+  spin_until(executor, [&received]() {return !received.empty();});
+  EXPECT_EQ(std::vector<int32_t>({42}), received);
+  EXPECT_EQ(1u, g_conversion_count);
+}
+
+/*
+   Testing that an adapted publisher doesn't convert the messages without any subscription.
+ */
+TEST_F(TestTypeAdapter, no_conversion_without_subscription) {
+  initialize();
+  auto pub = node->create_publisher<AdaptedInt>("type_adapter_unused_topic", 10);
+  CustomInt msg;
+  msg.value = 3;
+  pub->publish(msg);
+  pub->publish(std::make_unique<CustomInt>(msg));
+  EXPECT_EQ(0u, g_conversion_count);
+
+  // A transient local publisher publishes for the subscriptions joining later.
+  auto latched_pub = node->create_publisher<AdaptedInt>(
+    "type_adapter_latched_topic", rclcpp::QoS(1).transient_local());
+  latched_pub->publish(msg);
+  EXPECT_EQ(1u, g_conversion_count);
+}
+
+/*
+   Testing that an adapted subscription converts the ROS messages taken from the middleware.
+ */
+TEST_F(TestTypeAdapter, ros_publisher_adapted_subscription) {
+  initialize();
+  using test_msgs::msg::BasicTypes;
+  std::vector<int32_t> received;
+  auto sub = node->create_subscription<AdaptedInt>(
+    "type_adapter_custom_topic", 10,
+    [&received](std::shared_ptr<const CustomInt> msg) {received.push_back(msg->value);});
+  auto pub = node->create_publisher<BasicTypes>("type_adapter_custom_topic", 10);
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  BasicTypes msg;
+  msg.int32_value = 7;
+  pub->publish(msg);
+  spin_until(executor, [&received]() {return !received.empty();});
+  EXPECT_EQ(std::vector<int32_t>({7}), received);
+  EXPECT_EQ(1u, g_conversion_count);
+}
@@ -14,8 +14,14 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <memory>
+#include <vector>
+
+#include "rcl/guard_condition.h"
+#include "rcl/wait.h"
 
 #include "rclcpp/contexts/default_context.hpp"
 #include "rclcpp/exceptions.hpp"
@@ -78,3 +84,98 @@ TEST(TestUtilities, multi_init) {
   EXPECT_FALSE(rclcpp::ok(context1));
   EXPECT_FALSE(rclcpp::ok(context2));
 }
+
+TEST(TestUtilities, get_contexts) {
+  auto context1 = std::make_shared<rclcpp::contexts::default_context::DefaultContext>();
+  auto context2 = std::make_shared<rclcpp::contexts::default_context::DefaultContext>();
+  auto contains = [](const rclcpp::Context::SharedPtr & context) {
+      auto contexts = rclcpp::get_contexts();
+      return std::find(contexts.begin(), contexts.end(), context) != contexts.end();
+    };
+
+  context1->init(0, nullptr);
+  context2->init(0, nullptr);
+  EXPECT_TRUE(contains(context1));
+  EXPECT_TRUE(contains(context2));
+
+  rclcpp::shutdown(context1);
+  EXPECT_FALSE(contains(context1));
+  EXPECT_TRUE(contains(context2));
+
+  // A context destroyed without shutdown isn't returned either.
+  auto context3 = std::make_shared<rclcpp::contexts::default_context::DefaultContext>();
+  context3->init(0, nullptr);
+  rclcpp::Context * context3_ptr = context3.get();
+  context3.reset();
+  for (const auto & context : rclcpp::get_contexts()) {
+    EXPECT_NE(context3_ptr, context.get());
+  }
+
+  // Re-initializing a context registers it again.
+  context1->init(0, nullptr);
+  EXPECT_TRUE(contains(context1));
+
+  rclcpp::shutdown(context1);
+  rclcpp::shutdown(context2);
+  EXPECT_FALSE(contains(context1));
+  EXPECT_FALSE(contains(context2));
+}
+
+TEST(TestUtilities, add_interrupt_guard_condition) {
+  auto context = std::make_shared<rclcpp::contexts::default_context::DefaultContext>();
+  context->init(0, nullptr);
+
+  rcl_guard_condition_t guard_condition = rcl_get_zero_initialized_guard_condition();
+  ASSERT_EQ(
+    RCL_RET_OK, rcl_guard_condition_init(
+      &guard_condition, context->get_rcl_context().get(),
+      rcl_guard_condition_get_default_options()));
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  ASSERT_EQ(
+    RCL_RET_OK, rcl_wait_set_init(
+      &wait_set, 0, 1, 0, 0, 0, 0, context->get_rcl_context().get(),
+      rcl_get_default_allocator()));
+  auto wait = [&wait_set, &guard_condition]() {
+      EXPECT_EQ(RCL_RET_OK, rcl_wait_set_clear(&wait_set));
+      EXPECT_EQ(RCL_RET_OK, rcl_wait_set_add_guard_condition(&wait_set, &guard_condition, NULL));
+      return rcl_wait(&wait_set, RCL_MS_TO_NS(10));
+    };
+
+  context->add_interrupt_guard_condition(&guard_condition);
+  EXPECT_EQ(RCL_RET_TIMEOUT, wait());
+  context->interrupt_all_wait_sets();
+  EXPECT_EQ(RCL_RET_OK, wait());
+
+  // Once removed, it's not triggered anymore.
+  context->remove_interrupt_guard_condition(&guard_condition);
+  rclcpp::shutdown(context);
+  EXPECT_EQ(RCL_RET_TIMEOUT, wait());
+
+  EXPECT_EQ(RCL_RET_OK, rcl_wait_set_fini(&wait_set));
+  EXPECT_EQ(RCL_RET_OK, rcl_guard_condition_fini(&guard_condition));
+}
+
+TEST(TestUtilities, destroy_in_parallel) {
+  std::atomic<size_t> destroyed{0};
+  std::vector<std::shared_ptr<void>> objects;
+  for (size_t i = 0; i < 16; ++i) {
+    objects.push_back(std::shared_ptr<void>(new int(0), [&destroyed](void * object) {
+        delete static_cast<int *>(object);
+        ++destroyed;
+      }));
+  }
+  // An object still referenced elsewhere is only released.
+  auto kept = objects[0];
+  rclcpp::destroy_in_parallel(objects, 4);
+  EXPECT_TRUE(objects.empty());
+  EXPECT_EQ(15u, destroyed.load());
+  kept.reset();
+  EXPECT_EQ(16u, destroyed.load());
+
+  // Fewer objects than threads, or a single thread.
+  objects.push_back(std::make_shared<int>(0));
+  rclcpp::destroy_in_parallel(objects);
+  EXPECT_TRUE(objects.empty());
+  rclcpp::destroy_in_parallel(objects, 1);
+  EXPECT_TRUE(objects.empty());
+}
@@ -0,0 +1,123 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "rcl/guard_condition.h"
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp/wait_set.hpp"
+
+#include "test_msgs/msg/empty.hpp"
+
+using namespace std::chrono_literals;
+
+class TestWaitSet : public ::testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    rclcpp::init(0, nullptr);
+    node = std::make_shared<rclcpp::Node>("test_wait_set_node");
+  }
+
+  void TearDown() override
+  {
+    node.reset();
+    rclcpp::shutdown();
+  }
+
+  rclcpp::Node::SharedPtr node;
+};
+
+TEST_F(TestWaitSet, empty) {
+  rclcpp::WaitSet wait_set;
+  EXPECT_EQ(rclcpp::WaitResultKind::Empty, wait_set.wait(10ms));
+}
+
+TEST_F(TestWaitSet, dynamic_subscription) {
+  auto subscription = node->create_subscription<test_msgs::msg::Empty>(
+    "~/wait_set_topic", 10, [](test_msgs::msg::Empty::SharedPtr) {});
+  auto publisher = node->create_publisher<test_msgs::msg::Empty>("~/wait_set_topic", 10);
+
+  rclcpp::WaitSet wait_set;
+  wait_set.add_subscription(subscription);
+  EXPECT_THROW(wait_set.add_subscription(subscription), std::runtime_error);
+  EXPECT_THROW(wait_set.add_subscription(nullptr), std::invalid_argument);
+  EXPECT_EQ(rclcpp::WaitResultKind::Timeout, wait_set.wait(10ms));
+
+  publisher->publish(test_msgs::msg::Empty());
+  ASSERT_EQ(rclcpp::WaitResultKind::Ready, wait_set.wait(5s));
+  EXPECT_TRUE(wait_set.is_ready(subscription));
+
+  wait_set.remove_subscription(subscription);
+  EXPECT_THROW(wait_set.remove_subscription(subscription), std::runtime_error);
+  EXPECT_EQ(rclcpp::WaitResultKind::Empty, wait_set.wait(10ms));
+}
+
+TEST_F(TestWaitSet, static_timer_and_guard_condition) {
+  auto timer = node->create_wall_timer(10ms, []() {});
+  rcl_guard_condition_t guard_condition = rcl_get_zero_initialized_guard_condition();
+  ASSERT_EQ(
+    RCL_RET_OK, rcl_guard_condition_init(
+      &guard_condition, node->get_node_base_interface()->get_context()->get_rcl_context().get(),
+      rcl_guard_condition_get_default_options()));
+  {
+    rclcpp::StaticWaitSet<0, 1, 1, 0, 0, 0> wait_set({}, {{&guard_condition}}, {{timer}});
+
+    ASSERT_EQ(rclcpp::WaitResultKind::Ready, wait_set.wait(5s));
+    EXPECT_TRUE(wait_set.is_ready(timer));
+    EXPECT_FALSE(wait_set.is_ready(&guard_condition));
+
+    timer->cancel();
+    EXPECT_EQ(rclcpp::WaitResultKind::Timeout, wait_set.wait(10ms));
+    ASSERT_EQ(RCL_RET_OK, rcl_trigger_guard_condition(&guard_condition));
+    ASSERT_EQ(rclcpp::WaitResultKind::Ready, wait_set.wait(5s));
+    EXPECT_TRUE(wait_set.is_ready(&guard_condition));
+    EXPECT_FALSE(wait_set.is_ready(timer));
+  }
+  EXPECT_EQ(RCL_RET_OK, rcl_guard_condition_fini(&guard_condition));
+}
+
+TEST_F(TestWaitSet, shutdown_interrupts_wait) {
+  auto timer = node->create_wall_timer(1h, []() {});
+  rclcpp::WaitSet wait_set({}, {}, {timer});
+  std::thread shutdown_thread([]() {
+      std::this_thread::sleep_for(50ms);
+      rclcpp::shutdown();
+    });
+  EXPECT_EQ(rclcpp::WaitResultKind::Shutdown, wait_set.wait());
+  shutdown_thread.join();
+  EXPECT_EQ(rclcpp::WaitResultKind::Shutdown, wait_set.wait(10ms));
+}
+
+TEST_F(TestWaitSet, thread_safe_add_while_waiting) {
+  auto long_timer = node->create_wall_timer(1h, []() {});
+  auto short_timer = node->create_wall_timer(10ms, []() {});
+  rclcpp::ThreadSafeWaitSet wait_set({}, {}, {long_timer});
+  std::thread add_thread([&wait_set, &short_timer]() {
+      std::this_thread::sleep_for(50ms);
+      wait_set.add_timer(short_timer);
+    });
+  // The waiting thread lets the timer in, then wakes up for it before the timeout.
+  EXPECT_EQ(rclcpp::WaitResultKind::Ready, wait_set.wait(5s));
+  add_thread.join();
+  EXPECT_TRUE(wait_set.is_ready(short_timer));
+  EXPECT_FALSE(wait_set.is_ready(long_timer));
+}
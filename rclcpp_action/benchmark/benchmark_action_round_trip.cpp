@@ -0,0 +1,310 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <benchmark/benchmark.h>
+
+#ifndef _WIN32
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_action/rclcpp_action.hpp"
+
+#include "test_msgs/action/fibonacci.hpp"
+
+using Fibonacci = test_msgs::action::Fibonacci;
+using ClientT = rclcpp_action::Client<Fibonacci>;
+using ServerGoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+
+namespace
+{
+
+using LocalServer = std::false_type;
+using RemoteServer = std::true_type;
+
+constexpr char local_action_name[] = "benchmark_action_round_trip_local";
+constexpr char remote_action_name[] = "benchmark_action_round_trip_remote";
+
+// Number of feedback messages published for a goal of a positive order.
+constexpr int feedback_per_goal = 100;
+
+/// Return the server accepting all the goals.
+/**
+ * A goal of order 0 succeeds right away, a goal of order N publishes feedback_per_goal
+ * feedback messages of N integers first.
+ */
+rclcpp_action::Server<Fibonacci>::SharedPtr
+create_benchmark_server(rclcpp::Node::SharedPtr node, const std::string & action_name)
+{
+  return rclcpp_action::create_server<Fibonacci>(
+    node, action_name,
+    [](const rclcpp_action::GoalUUID &, std::shared_ptr<const Fibonacci::Goal>) {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    },
+    [](std::shared_ptr<ServerGoalHandle>) {
+      return rclcpp_action::CancelResponse::REJECT;
+    },
+    [](std::shared_ptr<ServerGoalHandle> goal_handle) {
+      int32_t order = goal_handle->get_goal()->order;
+      if (order > 0) {
+        auto feedback = std::make_shared<Fibonacci::Feedback>();
+        feedback->sequence.resize(static_cast<size_t>(order));
+        for (int i = 0; i < feedback_per_goal; ++i) {
+          goal_handle->publish_feedback(feedback);
+        }
+      }
+      goal_handle->succeed(std::make_shared<Fibonacci::Result>());
+    });
+}
+
+/// Report the percentiles of the latencies as counters, in microseconds.
+void
+report_latencies(
+  benchmark::State & state, const std::string & name, std::vector<int64_t> & latencies_ns)
+{
+  if (latencies_ns.empty()) {
+    return;
+  }
+  std::sort(latencies_ns.begin(), latencies_ns.end());
+  auto percentile = [&latencies_ns](double p) {
+      size_t index = static_cast<size_t>(p * static_cast<double>(latencies_ns.size() - 1));
+      return static_cast<double>(latencies_ns[index]) / 1000.0;
+    };
+  state.counters[name + "_p50_us"] = percentile(0.5);
+  state.counters[name + "_p99_us"] = percentile(0.99);
+  state.counters[name + "_max_us"] = static_cast<double>(latencies_ns.back()) / 1000.0;
+}
+
+int64_t
+now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// A client and a server, local or in the child process, spun by an executor.
+template<typename ExecutorT, typename ServerT>
+class ActionFixture
+{
+public:
+  ActionFixture()
+  : node_(std::make_shared<rclcpp::Node>("benchmark_action_round_trip"))
+  {
+    std::string action_name = remote_action_name;
+    if (!ServerT::value) {
+      action_name = local_action_name;
+      server_ = create_benchmark_server(node_, action_name);
+    }
+    client_ = rclcpp_action::create_client<Fibonacci>(node_, action_name);
+    ready_ = client_->wait_for_action_server(std::chrono::seconds(10));
+    executor_.add_node(node_);
+    spinner_ = std::thread([this]() {executor_.spin();});
+  }
+
+  ~ActionFixture()
+  {
+    executor_.cancel();
+    spinner_.join();
+  }
+
+  bool
+  ready() const
+  {
+    return ready_;
+  }
+
+  ClientT &
+  client()
+  {
+    return *client_;
+  }
+
+private:
+  rclcpp::Node::SharedPtr node_;
+  rclcpp_action::Server<Fibonacci>::SharedPtr server_;
+  ClientT::SharedPtr client_;
+  bool ready_;
+  ExecutorT executor_;
+  std::thread spinner_;
+};
+
+}  // namespace
+
+/// Latencies of the goal response and the result of goals, in the same process or not.
+/**
+ * One iteration sends a goal, which the server accepts and succeeds right away, and waits
+ * for its result.
+ * The latencies from the send to the acceptance and to the result are reported as percentiles.
+ * The remote server runs in a child process, forked by main() before rclcpp is initialized.
+ */
+template<typename ExecutorT, typename ServerT>
+static void
+BM_goal_latency(benchmark::State & state)
+{
+  ActionFixture<ExecutorT, ServerT> fixture;
+  if (!fixture.ready()) {
+    state.SkipWithError("the action server isn't ready");
+    return;
+  }
+
+  std::atomic<int64_t> accepted_ns{0};
+  std::atomic<size_t> results{0};
+  ClientT::SendGoalOptions options;
+  options.goal_response_callback =
+    [&accepted_ns](std::shared_future<ClientT::GoalHandle::SharedPtr>) {
+      accepted_ns.store(now_ns());
+    };
+  options.result_callback = [&results](const ClientT::WrappedResult &) {++results;};
+  Fibonacci::Goal goal;
+  goal.order = 0;
+  std::vector<int64_t> accept_latencies_ns;
+  std::vector<int64_t> result_latencies_ns;
+  for (auto _ : state) {
+    size_t target = results.load() + 1;
+    int64_t start_ns = now_ns();
+    fixture.client().async_send_goal(goal, options);
+    while (results.load() < target) {
+    }
+    int64_t end_ns = now_ns();
+    accept_latencies_ns.push_back(accepted_ns.load() - start_ns);
+    result_latencies_ns.push_back(end_ns - start_ns);
+    state.SetIterationTime(static_cast<double>(end_ns - start_ns) / 1e9);
+  }
+
+  report_latencies(state, "accept", accept_latencies_ns);
+  report_latencies(state, "result", result_latencies_ns);
+  state.SetItemsProcessed(state.iterations());
+}
+
+/// Feedback messages per second, in the same process or not.
+/**
+ * The argument is the number of integers of the feedback messages.
+ * One iteration sends a goal, whose execution publishes feedback_per_goal feedback messages,
+ * and waits for its result and its feedback.
+ * Feedback messages which didn't arrive shortly after the result are counted as lost.
+ */
+template<typename ExecutorT, typename ServerT>
+static void
+BM_feedback_throughput(benchmark::State & state)
+{
+  ActionFixture<ExecutorT, ServerT> fixture;
+  if (!fixture.ready()) {
+    state.SkipWithError("the action server isn't ready");
+    return;
+  }
+
+  std::atomic<size_t> feedback{0};
+  std::atomic<size_t> results{0};
+  ClientT::SendGoalOptions options;
+  options.feedback_callback =
+    [&feedback](ClientT::GoalHandle::SharedPtr, const std::shared_ptr<const Fibonacci::Feedback>) {
+      ++feedback;
+    };
+  options.result_callback = [&results](const ClientT::WrappedResult &) {++results;};
+  Fibonacci::Goal goal;
+  goal.order = static_cast<int32_t>(state.range(0));
+  size_t lost = 0;
+  for (auto _ : state) {
+    size_t target_results = results.load() + 1;
+    size_t target_feedback = feedback.load() + feedback_per_goal;
+    auto start = std::chrono::steady_clock::now();
+    fixture.client().async_send_goal(goal, options);
+    while (results.load() < target_results) {
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    while (feedback.load() < target_feedback && std::chrono::steady_clock::now() < deadline) {
+    }
+    state.SetIterationTime(
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    // Late feedback messages of this goal are counted with the next one.
+    lost += target_feedback - std::min(feedback.load(), target_feedback);
+  }
+
+  state.counters["lost_feedback"] = static_cast<double>(lost);
+  state.SetItemsProcessed(state.iterations() * feedback_per_goal - static_cast<int64_t>(lost));
+  state.SetBytesProcessed(
+    (state.iterations() * feedback_per_goal - static_cast<int64_t>(lost)) *
+    state.range(0) * static_cast<int64_t>(sizeof(int32_t)));
+}
+
+using rclcpp::executors::MultiThreadedExecutor;
+using rclcpp::executors::SingleThreadedExecutor;
+
+/// Feedback messages from 16 integers to 256 k integers (1 MB).
+static void
+feedback_sizes(benchmark::internal::Benchmark * benchmark)
+{
+  for (int64_t size : {16, 1 << 10, 16 << 10, 256 << 10}) {
+    benchmark->Arg(size);
+  }
+  benchmark->UseManualTime()->Unit(benchmark::kMicrosecond);
+}
+
+BENCHMARK_TEMPLATE(BM_goal_latency, SingleThreadedExecutor, LocalServer)->
+  UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_goal_latency, MultiThreadedExecutor, LocalServer)->
+  UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_goal_latency, SingleThreadedExecutor, RemoteServer)->
+  UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_goal_latency, MultiThreadedExecutor, RemoteServer)->
+  UseManualTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_feedback_throughput, SingleThreadedExecutor, LocalServer)->
+  Apply(feedback_sizes);
+BENCHMARK_TEMPLATE(BM_feedback_throughput, MultiThreadedExecutor, LocalServer)->
+  Apply(feedback_sizes);
+BENCHMARK_TEMPLATE(BM_feedback_throughput, SingleThreadedExecutor, RemoteServer)->
+  Apply(feedback_sizes);
+BENCHMARK_TEMPLATE(BM_feedback_throughput, MultiThreadedExecutor, RemoteServer)->
+  Apply(feedback_sizes);
+
+int main(int argc, char ** argv)
+{
+#ifndef _WIN32
+  // The remote server is forked before any thread is started.
+  pid_t server_pid = fork();
+  if (0 == server_pid) {
+    rclcpp::init(argc, argv);
+    auto node = std::make_shared<rclcpp::Node>("benchmark_action_round_trip_server");
+    auto server = create_benchmark_server(node, remote_action_name);
+    // Spins until the benchmarks interrupt it.
+    rclcpp::spin(node);
+    rclcpp::shutdown();
+    return 0;
+  }
+#endif
+  rclcpp::init(argc, argv);
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  rclcpp::shutdown();
+#ifndef _WIN32
+  if (server_pid > 0) {
+    kill(server_pid, SIGINT);
+    waitpid(server_pid, nullptr, 0);
+  }
+#endif
+  return 0;
+}
@@ -0,0 +1,113 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_action/rclcpp_action.hpp"
+
+#include "test_msgs/action/fibonacci.hpp"
+
+using Fibonacci = test_msgs::action::Fibonacci;
+using ClientT = rclcpp_action::Client<Fibonacci>;
+using ServerGoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+
+using FutureMode = std::false_type;
+using CallbackMode = std::true_type;
+
+static void
+send_goal(
+  ClientT & client, const Fibonacci::Goal & goal, const ClientT::SendGoalOptions & options,
+  FutureMode)
+{
+  client.async_send_goal(goal, options);
+}
+
+static void
+send_goal(
+  ClientT & client, const Fibonacci::Goal & goal, const ClientT::SendGoalOptions & options,
+  CallbackMode)
+{
+  client.async_send_goal(goal, options, [](ClientT::GoalHandle::SharedPtr) {});
+}
+
+/// Goals per second through a client and a server of the same process.
+/**
+ * One iteration sends a goal, which the server accepts and succeeds right away, and waits
+ * for its result callback.
+ * The goal response is either given through a future, or only to a callback.
+ */
+template<typename ModeT>
+static void
+BM_goal_round_trip(benchmark::State & state)
+{
+  auto node = std::make_shared<rclcpp::Node>("benchmark_goal_round_trip");
+  auto server = rclcpp_action::create_server<Fibonacci>(
+    node, "benchmark_goal_round_trip",
+    [](const rclcpp_action::GoalUUID &, std::shared_ptr<const Fibonacci::Goal>) {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    },
+    [](std::shared_ptr<ServerGoalHandle>) {
+      return rclcpp_action::CancelResponse::REJECT;
+    },
+    [](std::shared_ptr<ServerGoalHandle> goal_handle) {
+      goal_handle->succeed(std::make_shared<Fibonacci::Result>());
+    });
+  auto client = rclcpp_action::create_client<Fibonacci>(node, "benchmark_goal_round_trip");
+
+  rclcpp::executors::SingleThreadedExecutor executor;
+  executor.add_node(node);
+  std::thread spinner([&executor]() {executor.spin();});
+  if (!client->wait_for_action_server(std::chrono::seconds(10))) {
+    executor.cancel();
+    spinner.join();
+    state.SkipWithError("the action server isn't ready");
+    return;
+  }
+
+  std::atomic<size_t> results{0};
+  ClientT::SendGoalOptions options;
+  options.result_callback = [&results](const ClientT::WrappedResult &) {++results;};
+  Fibonacci::Goal goal;
+  goal.order = 1;
+  for (auto _ : state) {
+    size_t target = results.load() + 1;
+    send_goal(*client, goal, options, ModeT());
+    while (results.load() < target) {
+    }
+  }
+  executor.cancel();
+  spinner.join();
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_goal_round_trip, FutureMode)->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_goal_round_trip, CallbackMode)->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char ** argv)
+{
+  rclcpp::init(argc, argv);
+  ::benchmark::Initialize(&argc, argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  rclcpp::shutdown();
+  return 0;
+}
@@ -0,0 +1,120 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "rclcpp_action/types.hpp"
+
+using rclcpp_action::GoalUUID;
+
+/// The goal id hash used before, 64 bit FNV-1a over the bytes, for comparison.
+struct Fnv1aGoalUUIDHash
+{
+  size_t operator()(const GoalUUID & uuid) const noexcept
+  {
+    uint64_t result = 14695981039346656037ULL;
+    for (size_t i = 0; i < uuid.size(); ++i) {
+      result ^= uuid[i];
+      result *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(result);
+  }
+};
+
+/// Random goal ids, as generated by the action clients.
+static std::vector<GoalUUID>
+make_random_goal_ids(size_t count)
+{
+  std::mt19937_64 generator(42);
+  std::vector<GoalUUID> goal_ids(count);
+  for (auto & goal_id : goal_ids) {
+    for (auto & byte : goal_id) {
+      byte = static_cast<uint8_t>(generator());
+    }
+  }
+  return goal_ids;
+}
+
+/// Goal ids which only differ by a counter in their last bytes.
+static std::vector<GoalUUID>
+make_sequential_goal_ids(size_t count)
+{
+  std::vector<GoalUUID> goal_ids(count);
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t counter = static_cast<uint32_t>(i);
+    auto * last_bytes = goal_ids[i].data() + goal_ids[i].size() - sizeof(counter);
+    std::memcpy(last_bytes, &counter, sizeof(counter));
+  }
+  return goal_ids;
+}
+
+/// Cost of hashing a goal id.
+template<typename HashT>
+static void
+BM_goal_uuid_hash(benchmark::State & state)
+{
+  auto goal_ids = make_random_goal_ids(1024);
+  HashT hash;
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hash(goal_ids[i++ & 1023u]));
+  }
+}
+
+/// Cost of looking up a goal in a map keyed by goal id, like the ones of the action server,
+/// given the number of outstanding goals.
+template<typename HashT, bool Sequential>
+static void
+BM_goal_lookup(benchmark::State & state)
+{
+  size_t goal_count = static_cast<size_t>(state.range(0));
+  auto goal_ids = Sequential ?
+    make_sequential_goal_ids(goal_count) : make_random_goal_ids(goal_count);
+  std::unordered_map<GoalUUID, std::shared_ptr<void>, HashT> goal_results;
+  for (const auto & goal_id : goal_ids) {
+    goal_results[goal_id] = nullptr;
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    auto it = goal_results.find(goal_ids[i]);
+    benchmark::DoNotOptimize(it);
+    if (++i == goal_count) {
+      i = 0;
+    }
+  }
+  // Average number of goals compared per lookup, 1 without collisions.
+  double probes = 0.0;
+  for (size_t bucket = 0; bucket < goal_results.bucket_count(); ++bucket) {
+    double size = static_cast<double>(goal_results.bucket_size(bucket));
+    probes += size * (size + 1.0) / 2.0;
+  }
+  state.counters["probes"] = probes / static_cast<double>(goal_count);
+}
+
+BENCHMARK_TEMPLATE(BM_goal_uuid_hash, std::hash<GoalUUID>);
+BENCHMARK_TEMPLATE(BM_goal_uuid_hash, Fnv1aGoalUUIDHash);
+BENCHMARK_TEMPLATE(BM_goal_lookup, std::hash<GoalUUID>, false)->Arg(100)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_goal_lookup, Fnv1aGoalUUIDHash, false)->Arg(100)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_goal_lookup, std::hash<GoalUUID>, true)->Arg(100)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_goal_lookup, Fnv1aGoalUUIDHash, true)->Arg(100)->Arg(10000);
+
+BENCHMARK_MAIN();
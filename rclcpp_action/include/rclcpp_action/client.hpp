@@ -20,6 +20,7 @@
 #include <rclcpp/node_interfaces/node_logging_interface.hpp>
 #include <rclcpp/node_interfaces/node_graph_interface.hpp>
 #include <rclcpp/logger.hpp>
+#include <rclcpp/strategies/message_pool_memory_strategy.hpp>
 #include <rclcpp/time.hpp>
 #include <rclcpp/waitable.hpp>
 
@@ -30,10 +31,10 @@
 #include <chrono>
 #include <functional>
 #include <future>
-#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <utility>
 
 #include "rclcpp_action/client_goal_handle.hpp"
@@ -268,6 +269,7 @@ public:
   using CancelRequest = typename ActionT::Impl::CancelGoalService::Request;
   using CancelResponse = typename ActionT::Impl::CancelGoalService::Response;
   using CancelCallback = std::function<void (typename CancelResponse::SharedPtr)>;
+  using GoalHandleCallback = std::function<void (typename GoalHandle::SharedPtr)>;
 
   /// Options for sending a goal.
   /**
@@ -345,50 +347,38 @@ public:
     // Put promise in the heap to move it around.
     auto promise = std::make_shared<std::promise<typename GoalHandle::SharedPtr>>();
     std::shared_future<typename GoalHandle::SharedPtr> future(promise->get_future());
-    using GoalRequest = typename ActionT::Impl::SendGoalService::Request;
-    auto goal_request = std::make_shared<GoalRequest>();
-    goal_request->goal_id.uuid = this->generate_goal_id();
-    goal_request->goal = goal;
-    this->send_goal_request(
-      std::static_pointer_cast<void>(goal_request),
-      [this, goal_request, options, promise, future](std::shared_ptr<void> response) mutable
+    auto goal_response_callback = options.goal_response_callback;
+    this->send_goal(
+      goal, options,
+      [promise, future, goal_response_callback](typename GoalHandle::SharedPtr goal_handle)
       {
-        using GoalResponse = typename ActionT::Impl::SendGoalService::Response;
-        auto goal_response = std::static_pointer_cast<GoalResponse>(response);
-        if (!goal_response->accepted) {
-          promise->set_value(nullptr);
-          if (options.goal_response_callback) {
-            options.goal_response_callback(future);
-          }
-          return;
-        }
-        GoalInfo goal_info;
-        goal_info.goal_id.uuid = goal_request->goal_id.uuid;
-        goal_info.stamp = goal_response->stamp;
-        // Do not use std::make_shared as friendship cannot be forwarded.
-        std::shared_ptr<GoalHandle> goal_handle(
-          new GoalHandle(goal_info, options.feedback_callback, options.result_callback));
-        {
-          std::lock_guard<std::mutex> guard(goal_handles_mutex_);
-          goal_handles_[goal_handle->get_goal_id()] = goal_handle;
-        }
         promise->set_value(goal_handle);
-        if (options.goal_response_callback) {
-          options.goal_response_callback(future);
-        }
-
-        if (options.result_callback) {
-          try {
-            this->make_result_aware(goal_handle);
-          } catch (...) {
-            promise->set_exception(std::current_exception());
-            return;
-          }
+        if (goal_response_callback) {
+          goal_response_callback(future);
         }
       });
     return future;
   }
 
+  /// Send an action goal, and give its goal handle to a callback instead of a future.
+  /**
+   * This is cheaper than the overload returning a future, for the callers sending many goals:
+   * no promise or future is created for the goal response.
+   * The goal response callback of the options isn't called, as it takes a future.
+   *
+   * \param[in] goal The goal request.
+   * \param[in] options Options for sending the goal request, its feedback and result callbacks
+   *   are used.
+   * \param[in] goal_handle_callback Called with the goal handle once the goal is accepted, or
+   *   with `nullptr` if it is rejected.
+   */
+  void
+  async_send_goal(
+    const Goal & goal, const SendGoalOptions & options, GoalHandleCallback goal_handle_callback)
+  {
+    this->send_goal(goal, options, std::move(goal_handle_callback));
+  }
+
   /// Asynchronously get the result for an active goal.
   /**
    * \throws exceptions::UnknownGoalHandleError If the goal unknown or already reached a terminal
@@ -540,15 +530,16 @@ private:
     typename FeedbackMessage::SharedPtr feedback_message =
       std::static_pointer_cast<FeedbackMessage>(message);
     const GoalUUID & goal_id = feedback_message->goal_id.uuid;
-    if (goal_handles_.count(goal_id) == 0) {
+    auto it = goal_handles_.find(goal_id);
+    if (it == goal_handles_.end()) {
       RCLCPP_DEBUG(
         this->get_logger(),
         "Received feedback for unknown goal. Ignoring...");
       return;
     }
-    typename GoalHandle::SharedPtr goal_handle = goal_handles_[goal_id];
-    auto feedback = std::make_shared<Feedback>();
-    *feedback = feedback_message->feedback;
+    typename GoalHandle::SharedPtr goal_handle = it->second;
+    // The message may be shared with other clients of the process, the feedback isn't copied.
+    std::shared_ptr<const Feedback> feedback(feedback_message, &feedback_message->feedback);
     goal_handle->call_feedback_callback(goal_handle, feedback);
   }
 
@@ -567,27 +558,69 @@ private:
     std::lock_guard<std::mutex> guard(goal_handles_mutex_);
     using GoalStatusMessage = typename ActionT::Impl::GoalStatusMessage;
     auto status_message = std::static_pointer_cast<GoalStatusMessage>(message);
+    // Each status costs one lookup, the statuses of other clients' goals are skipped by it.
     for (const GoalStatus & status : status_message->status_list) {
+      if (goal_handles_.empty()) {
+        break;
+      }
       const GoalUUID & goal_id = status.goal_info.goal_id.uuid;
-      if (goal_handles_.count(goal_id) == 0) {
+      auto it = goal_handles_.find(goal_id);
+      if (it == goal_handles_.end()) {
         RCLCPP_DEBUG(
           this->get_logger(),
           "Received status for unknown goal. Ignoring...");
         continue;
       }
-      typename GoalHandle::SharedPtr goal_handle = goal_handles_[goal_id];
-      goal_handle->set_status(status.status);
-      const int8_t goal_status = goal_handle->get_status();
+      const int8_t goal_status = status.status;
+      it->second->set_status(goal_status);
       if (
         goal_status == GoalStatus::STATUS_SUCCEEDED ||
         goal_status == GoalStatus::STATUS_CANCELED ||
         goal_status == GoalStatus::STATUS_ABORTED)
       {
-        goal_handles_.erase(goal_id);
+        goal_handles_.erase(it);
       }
     }
   }
 
+  /// Send a goal request, and call on_goal_handle with the goal handle once it is answered.
+  template<typename GoalHandleCallbackT>
+  void
+  send_goal(
+    const Goal & goal, const SendGoalOptions & options, GoalHandleCallbackT on_goal_handle)
+  {
+    GoalUUID goal_id = this->generate_goal_id();
+    // The request is serialized when it is sent, so the instance is free again afterwards.
+    auto goal_request = goal_request_pool_.borrow_message();
+    goal_request->goal_id.uuid = goal_id;
+    goal_request->goal = goal;
+    this->send_goal_request(
+      std::static_pointer_cast<void>(goal_request),
+      [this, goal_id, options, on_goal_handle](std::shared_ptr<void> response) mutable
+      {
+        using GoalResponse = typename ActionT::Impl::SendGoalService::Response;
+        auto goal_response = std::static_pointer_cast<GoalResponse>(response);
+        if (!goal_response->accepted) {
+          on_goal_handle(nullptr);
+          return;
+        }
+        GoalInfo goal_info;
+        goal_info.goal_id.uuid = goal_id;
+        goal_info.stamp = goal_response->stamp;
+        // Do not use std::make_shared as friendship cannot be forwarded.
+        std::shared_ptr<GoalHandle> goal_handle(
+          new GoalHandle(goal_info, options.feedback_callback, options.result_callback));
+        {
+          std::lock_guard<std::mutex> guard(goal_handles_mutex_);
+          goal_handles_[goal_handle->get_goal_id()] = goal_handle;
+        }
+        on_goal_handle(goal_handle);
+        if (options.result_callback) {
+          this->make_result_aware(goal_handle);
+        }
+      });
+  }
+
   /// \internal
   void
   make_result_aware(typename GoalHandle::SharedPtr goal_handle)
@@ -639,8 +672,11 @@ private:
     return future;
   }
 
-  std::map<GoalUUID, typename GoalHandle::SharedPtr> goal_handles_;
+  std::unordered_map<GoalUUID, typename GoalHandle::SharedPtr> goal_handles_;
   std::mutex goal_handles_mutex_;
+  /// Goal requests reused by the goals sent one after the other, keeping their sequences.
+  rclcpp::strategies::message_pool_memory_strategy::RecycledMessageMemoryStrategy<
+    typename ActionT::Impl::SendGoalService::Request> goal_request_pool_{4};
 };
 }  // namespace rclcpp_action
 
@@ -70,11 +70,16 @@ template<typename ActionT>
 void
 ClientGoalHandle<ActionT>::set_result(const WrappedResult & wrapped_result)
 {
-  std::lock_guard<std::mutex> guard(handle_mutex_);
-  status_ = static_cast<int8_t>(wrapped_result.code);
-  result_promise_.set_value(wrapped_result);
-  if (result_callback_) {
-    result_callback_(wrapped_result);
+  ResultCallback result_callback;
+  {
+    std::lock_guard<std::mutex> guard(handle_mutex_);
+    status_ = static_cast<int8_t>(wrapped_result.code);
+    result_promise_.set_value(wrapped_result);
+    result_callback = result_callback_;
+  }
+  // Called unlocked, so that the callback can use the goal handle.
+  if (result_callback) {
+    result_callback(wrapped_result);
   }
 }
 
@@ -0,0 +1,173 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef RCLCPP_ACTION__COROUTINE_HPP_
+#define RCLCPP_ACTION__COROUTINE_HPP_
+
+#include <rclcpp/coroutine.hpp>
+
+// The coroutines need C++20, this header is empty for the earlier standards.
+#ifdef RCLCPP_HAS_COROUTINES
+
+#include <coroutine>
+#include <future>
+#include <memory>
+#include <utility>
+
+#include "rclcpp_action/client.hpp"
+
+namespace rclcpp_action
+{
+
+/// Awaitable sending a goal, see rclcpp_action::await_goal_response().
+template<typename ActionT>
+class GoalResponseAwaiter
+{
+public:
+  using ClientT = rclcpp_action::Client<ActionT>;
+  using GoalHandleSharedPtr = typename ClientT::GoalHandle::SharedPtr;
+
+  GoalResponseAwaiter(
+    std::shared_ptr<ClientT> client,
+    const typename ClientT::Goal & goal,
+    typename ClientT::SendGoalOptions options)
+  : client_(std::move(client)), goal_(goal), options_(std::move(options))
+  {}
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> handle)
+  {
+    auto user_callback = std::move(options_.goal_response_callback);
+    options_.goal_response_callback =
+      [this, handle, user_callback](std::shared_future<GoalHandleSharedPtr> future) {
+        if (user_callback) {
+          user_callback(future);
+        }
+        future_ = future;
+        handle.resume();
+      };
+    // The coroutine may be resumed, and this awaiter destroyed, before the call returns.
+    auto client = client_;
+    client->async_send_goal(goal_, options_);
+  }
+
+  /// Return the goal handle, nullptr if the goal was rejected.
+  GoalHandleSharedPtr
+  await_resume()
+  {
+    return future_.get();
+  }
+
+private:
+  std::shared_ptr<ClientT> client_;
+  typename ClientT::Goal goal_;
+  typename ClientT::SendGoalOptions options_;
+  std::shared_future<GoalHandleSharedPtr> future_;
+};
+
+/// Send a goal, and resume the awaiting coroutine with its goal handle once it is answered.
+/**
+ * The coroutine is resumed by the executor spinning the action client.
+ *
+ * \param[in] client The action client.
+ * \param[in] goal The goal.
+ * \param[in] options The options of the goal, its goal response callback is still called.
+ * \return the awaitable, which gives the goal handle, or nullptr if the goal was rejected.
+ */
+template<typename ActionT>
+GoalResponseAwaiter<ActionT>
+await_goal_response(
+  std::shared_ptr<rclcpp_action::Client<ActionT>> client,
+  const typename rclcpp_action::Client<ActionT>::Goal & goal,
+  typename rclcpp_action::Client<ActionT>::SendGoalOptions options = {})
+{
+  return GoalResponseAwaiter<ActionT>(std::move(client), goal, std::move(options));
+}
+
+/// Awaitable getting the result of a goal, see rclcpp_action::await_result().
+template<typename ActionT>
+class ResultAwaiter
+{
+public:
+  using ClientT = rclcpp_action::Client<ActionT>;
+  using WrappedResult = typename ClientT::WrappedResult;
+
+  ResultAwaiter(
+    std::shared_ptr<ClientT> client, typename ClientT::GoalHandle::SharedPtr goal_handle)
+  : client_(std::move(client)), goal_handle_(std::move(goal_handle))
+  {}
+
+  bool
+  await_ready() const noexcept
+  {
+    return false;
+  }
+
+  void
+  await_suspend(std::coroutine_handle<> handle)
+  {
+    // The coroutine may be resumed, and this awaiter destroyed, before the call returns.
+    auto client = client_;
+    client->async_get_result(
+      goal_handle_,
+      [this, handle](const WrappedResult & result) {
+        result_ = result;
+        handle.resume();
+      });
+  }
+
+  WrappedResult
+  await_resume()
+  {
+    return std::move(result_);
+  }
+
+private:
+  std::shared_ptr<ClientT> client_;
+  typename ClientT::GoalHandle::SharedPtr goal_handle_;
+  WrappedResult result_;
+};
+
+/// Resume the awaiting coroutine with the result of a goal.
+/**
+ * The coroutine is resumed by the executor spinning the action client.
+ * This replaces the result callback of the goal handle.
+ *
+ * \param[in] client The action client.
+ * \param[in] goal_handle The goal handle.
+ * \return the awaitable, which gives the result.
+ *   Awaiting it throws exceptions::UnknownGoalHandleError if the goal is unknown or already
+ *   reached a terminal state.
+ */
+template<typename ActionT>
+ResultAwaiter<ActionT>
+await_result(
+  std::shared_ptr<rclcpp_action::Client<ActionT>> client,
+  typename rclcpp_action::Client<ActionT>::GoalHandle::SharedPtr goal_handle)
+{
+  return ResultAwaiter<ActionT>(std::move(client), std::move(goal_handle));
+}
+
+}  // namespace rclcpp_action
+
+#endif  // RCLCPP_HAS_COROUTINES
+
+#endif  // RCLCPP_ACTION__COROUTINE_HPP_
@@ -52,6 +52,8 @@ namespace rclcpp_action
  * \param[in] options options to pass to the underlying `rcl_action_server_t`.
  * \param group[in] The action server will be added to this callback group.
  *   If `nullptr`, then the action server is added to the default callback group.
+ *   In a reentrant group, a multi-threaded executor handles the goal, cancel and result
+ *   requests concurrently, so a slow callback doesn't delay the requests of other goals.
  */
 template<typename ActionT>
 typename Server<ActionT>::SharedPtr
@@ -127,6 +129,8 @@ create_server(
  * \param[in] options options to pass to the underlying `rcl_action_server_t`.
  * \param group[in] The action server will be added to this callback group.
  *   If `nullptr`, then the action server is added to the default callback group.
+ *   In a reentrant group, a multi-threaded executor handles the goal, cancel and result
+ *   requests concurrently, so a slow callback doesn't delay the requests of other goals.
  */
 template<typename ActionT, typename NodeT>
 typename Server<ActionT>::SharedPtr
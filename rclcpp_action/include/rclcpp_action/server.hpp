@@ -18,16 +18,26 @@
 #include <rcl_action/action_server.h>
 #include <rosidl_generator_c/action_type_support_struct.h>
 #include <rosidl_typesupport_cpp/action_type_support.hpp>
+#include <rosidl_typesupport_cpp/message_type_support.hpp>
+#include <rmw/rmw.h>
+#include <rclcpp/detail/worker_pool.hpp>
+#include <rclcpp/exceptions.hpp>
+#include <rclcpp/experimental/serialized_message.hpp>
+#include <rclcpp/logging.hpp>
 #include <rclcpp/node_interfaces/node_base_interface.hpp>
 #include <rclcpp/node_interfaces/node_clock_interface.hpp>
 #include <rclcpp/node_interfaces/node_logging_interface.hpp>
 #include <rclcpp/waitable.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <stdexcept>
 #include <utility>
 
 #include "rclcpp_action/visibility_control.hpp"
@@ -59,6 +69,15 @@ enum class CancelResponse : int8_t
   ACCEPT = 2,
 };
 
+/// How an action server limits the rate of the feedback of each goal.
+struct FeedbackPolicy
+{
+  /// Minimum period between two feedback messages of a goal, 0 to publish all of them.
+  std::chrono::nanoseconds min_period{0};
+  /// Publish the latest feedback received during the period at its end, instead of dropping it.
+  bool coalesce = false;
+};
+
 /// Base Action Server implementation
 /// \internal
 /**
@@ -127,6 +146,72 @@ public:
   // End Waitables API
   // -----------------
 
+  /// Set the minimum period between two publishes of the goal statuses.
+  /**
+   * With a period of 0, the default, the statuses are published each time a goal changes state.
+   * Otherwise a change is published right away if there was no publish during the last period,
+   * and the changes during a period are published together at its end, e.g. so that a server
+   * with many goals doesn't publish the statuses of all of them on each transition.
+   *
+   * \param[in] period The minimum period, must not be negative.
+   * \throws std::invalid_argument if the period is negative.
+   */
+  RCLCPP_ACTION_PUBLIC
+  void
+  set_status_publish_period(std::chrono::nanoseconds period);
+
+  /// Set how the feedback of each goal is rate limited, before it is serialized.
+  /**
+   * Within the minimum period after the feedback of a goal was published, its new feedback is
+   * dropped, or with coalescing only the latest one is kept and published once the period
+   * ended, so it may be delayed by up to two periods.
+   * Feedback still pending when the goal reaches a result is dropped.
+   * Feedback pending when the policy is changed is published right away.
+   *
+   * \param[in] policy The feedback policy, its period must not be negative.
+   * \throws std::invalid_argument if the period is negative.
+   */
+  RCLCPP_ACTION_PUBLIC
+  void
+  set_feedback_policy(const FeedbackPolicy & policy);
+
+  RCLCPP_ACTION_PUBLIC
+  FeedbackPolicy
+  get_feedback_policy() const;
+
+  /// Return the number of feedback messages dropped by the feedback policy.
+  RCLCPP_ACTION_PUBLIC
+  uint64_t
+  get_dropped_feedback_count() const;
+
+  /// Return the number of feedback messages replaced by a later one of the same goal.
+  RCLCPP_ACTION_PUBLIC
+  uint64_t
+  get_coalesced_feedback_count() const;
+
+  /// Limit the memory of the results kept until their goals expire.
+  /**
+   * The size of each result published while there is a budget is estimated by its serialized
+   * size.
+   * When the results exceed the budget, the oldest ones are evicted before their goals expire,
+   * requests for an evicted result get a response with STATUS_UNKNOWN.
+   *
+   * \param[in] bytes The memory budget, 0 for no budget, the default.
+   */
+  RCLCPP_ACTION_PUBLIC
+  void
+  set_result_memory_budget(size_t bytes);
+
+  /// Return the estimated memory of the results within the budget.
+  RCLCPP_ACTION_PUBLIC
+  size_t
+  get_result_memory_usage() const;
+
+  /// Return the number of results evicted to stay within the memory budget.
+  RCLCPP_ACTION_PUBLIC
+  uint64_t
+  get_evicted_result_count() const;
+
 protected:
   RCLCPP_ACTION_PUBLIC
   ServerBase(
@@ -201,11 +286,18 @@ protected:
   std::shared_ptr<void>
   create_result_response(decltype(action_msgs::msg::GoalStatus::status) status) = 0;
 
+  /// Refresh the statuses of all goals, and publish them.
   /// \internal
   RCLCPP_ACTION_PUBLIC
   void
   publish_status();
 
+  /// Update the status of a goal which changed state, and publish the statuses.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  publish_status(const GoalUUID & uuid);
+
   /// \internal
   RCLCPP_ACTION_PUBLIC
   void
@@ -216,11 +308,24 @@ protected:
   void
   publish_result(const GoalUUID & uuid, std::shared_ptr<void> result_msg);
 
+  /// Return the memory used by a result response, for the result memory budget.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  virtual
+  size_t
+  estimate_result_size(const std::shared_ptr<void> & result_msg);
+
   /// \internal
   RCLCPP_ACTION_PUBLIC
   void
   publish_feedback(std::shared_ptr<void> feedback_msg);
 
+  /// Publish the feedback of a goal, as allowed by the feedback policy.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  publish_feedback(const GoalUUID & uuid, std::shared_ptr<void> feedback_msg);
+
   // End API for communication between ServerBase and Server<>
   // ---------------------------------------------------------
 
@@ -249,6 +354,36 @@ private:
   void
   execute_check_expired_goals();
 
+  /// Publish the statuses, or wait for the end of the publish period.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  publish_status_array();
+
+  /// Publish the statuses which changed during the publish period which ended.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  execute_status_timer();
+
+  /// Evict the oldest results until they are within the memory budget.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  evict_results();
+
+  /// Publish the coalesced feedback whose period ended, or all of it.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  publish_pending_feedback(bool all);
+
+  /// Publish the coalesced feedback whose period ended.
+  /// \internal
+  RCLCPP_ACTION_PUBLIC
+  void
+  execute_feedback_timer();
+
   /// Private implementation
   /// \internal
   std::unique_ptr<ServerBaseImpl> pimpl_;
@@ -277,6 +412,8 @@ public:
   using CancelCallback = std::function<CancelResponse(std::shared_ptr<ServerGoalHandle<ActionT>>)>;
   /// Signature of a callback that is used to notify when the goal has been accepted.
   using AcceptedCallback = std::function<void (std::shared_ptr<ServerGoalHandle<ActionT>>)>;
+  /// Signature of a callback that executes a goal on a thread of the goal execution pool.
+  using ExecuteCallback = std::function<void (std::shared_ptr<ServerGoalHandle<ActionT>>)>;
 
   /// Construct an action server.
   /**
@@ -329,6 +466,50 @@ public:
 
   virtual ~Server() = default;
 
+  /// Execute the accepted goals on a pool of threads, instead of one thread per goal.
+  /**
+   * Each accepted goal is queued after handle_accepted was called, and the execute callback is
+   * called with its goal handle by the first thread available, in the order the goals were
+   * accepted.
+   * The callback may block until the goal reaches a result; a deferred goal is executed by it
+   * too, so it may call execute() on the handle.
+   * A goal still queued when it is canceled is not executed, it is set to canceled with a
+   * default result once it leaves the queue.
+   * When max_queued_goals goals are waiting for a thread, new goals are rejected before
+   * handle_goal is called.
+   *
+   * It must be called before the server receives goals, and only once.
+   * The server waits for the running callbacks when it is destroyed, the queued goals are not
+   * executed.
+   *
+   * \param[in] number_of_threads The number of goals executed at the same time.
+   * \param[in] max_queued_goals The maximum number of goals waiting for a thread, 0 for no limit.
+   * \param[in] handle_execute The callback executing a goal.
+   * \throws std::invalid_argument if the number of threads is zero or the callback is empty.
+   * \throws std::runtime_error if the server already has a goal execution pool.
+   */
+  void
+  set_goal_execution_pool(
+    size_t number_of_threads, size_t max_queued_goals, ExecuteCallback handle_execute)
+  {
+    if (!handle_execute) {
+      throw std::invalid_argument("the execute callback of a goal execution pool is empty");
+    }
+    if (goal_pool_) {
+      throw std::runtime_error("the server already has a goal execution pool");
+    }
+    max_queued_goals_ = max_queued_goals;
+    handle_execute_ = handle_execute;
+    goal_pool_ = std::make_unique<rclcpp::detail::WorkerPool>(number_of_threads);
+  }
+
+  /// Return the number of accepted goals waiting for a thread of the goal execution pool.
+  size_t
+  get_number_of_queued_goals() const
+  {
+    return queued_goals_.load();
+  }
+
 protected:
   // -----------------------------------------------------
   // API for communication between ServerBase and Server<>
@@ -340,7 +521,14 @@ protected:
     auto request = std::static_pointer_cast<
       typename ActionT::Impl::SendGoalService::Request>(message);
     auto goal = std::shared_ptr<typename ActionT::Goal>(request, &request->goal);
-    GoalResponse user_response = handle_goal_(uuid, goal);
+    GoalResponse user_response = GoalResponse::REJECT;
+    if (goal_pool_ && max_queued_goals_ > 0 && queued_goals_.load() >= max_queued_goals_) {
+      RCLCPP_DEBUG(
+        rclcpp::get_logger("rclcpp_action"),
+        "Rejected goal %s, the goal execution queue is full", to_string(uuid).c_str());
+    } else {
+      user_response = handle_goal_(uuid, goal);
+    }
 
     auto ros_response = std::make_shared<typename ActionT::Impl::SendGoalService::Response>();
     ros_response->accepted = GoalResponse::ACCEPT_AND_EXECUTE == user_response ||
@@ -386,7 +574,7 @@ protected:
         // Send result message to anyone that asked
         shared_this->publish_result(uuid, result_message);
         // Publish a status message any time a goal handle changes state
-        shared_this->publish_status();
+        shared_this->publish_status(uuid);
         // notify base so it can recalculate the expired goal timer
         shared_this->notify_goal_terminal_state();
         // Delete data now (ServerBase and rcl_action_server_t keep data until goal handle expires)
@@ -401,9 +589,8 @@ protected:
         if (!shared_this) {
           return;
         }
-        (void)uuid;
         // Publish a status message any time a goal handle changes state
-        shared_this->publish_status();
+        shared_this->publish_status(uuid);
       };
 
     std::function<void(std::shared_ptr<typename ActionT::Impl::FeedbackMessage>)> publish_feedback =
@@ -413,7 +600,8 @@ protected:
         if (!shared_this) {
           return;
         }
-        shared_this->publish_feedback(std::static_pointer_cast<void>(feedback_msg));
+        shared_this->publish_feedback(
+          feedback_msg->goal_id.uuid, std::static_pointer_cast<void>(feedback_msg));
       };
 
     auto request = std::static_pointer_cast<
@@ -427,6 +615,9 @@ protected:
       goal_handles_[uuid] = goal_handle;
     }
     handle_accepted_(goal_handle);
+    if (goal_pool_) {
+      queue_goal(goal_handle);
+    }
   }
 
   /// \internal
@@ -468,19 +659,66 @@ protected:
     return std::static_pointer_cast<void>(result);
   }
 
+  /// \internal
+  size_t
+  estimate_result_size(const std::shared_ptr<void> & result_msg) override
+  {
+    using ResultResponse = typename ActionT::Impl::GetResultService::Response;
+    auto serialized_msg = rclcpp::experimental::create_serialized_message(0);
+    rmw_ret_t ret = rmw_serialize(
+      result_msg.get(),
+      rosidl_typesupport_cpp::get_message_type_support_handle<ResultResponse>(),
+      serialized_msg.get());
+    if (RMW_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to serialize result");
+    }
+    return sizeof(ResultResponse) + serialized_msg->buffer_length;
+  }
+
   // End API for communication between ServerBase and Server<>
   // ---------------------------------------------------------
 
 private:
+  /// Run the execute callback of a goal on the goal execution pool.
+  void
+  queue_goal(std::shared_ptr<ServerGoalHandle<ActionT>> goal_handle)
+  {
+    std::weak_ptr<Server<ActionT>> weak_this = this->shared_from_this();
+    ++queued_goals_;
+    goal_pool_->post(
+      [weak_this, goal_handle]() {
+        std::shared_ptr<Server<ActionT>> shared_this = weak_this.lock();
+        if (!shared_this) {
+          return;
+        }
+        --shared_this->queued_goals_;
+        if (!goal_handle->is_active()) {
+          return;
+        }
+        if (goal_handle->is_canceling()) {
+          // Canceled while queued, it is not worth executing.
+          goal_handle->canceled(std::make_shared<typename ActionT::Result>());
+          return;
+        }
+        shared_this->handle_execute_(goal_handle);
+      });
+  }
+
   GoalCallback handle_goal_;
   CancelCallback handle_cancel_;
   AcceptedCallback handle_accepted_;
+  ExecuteCallback handle_execute_;
 
   using GoalHandleWeakPtr = std::weak_ptr<ServerGoalHandle<ActionT>>;
   /// A map of goal id to goal handle weak pointers.
   /// This is used to provide a goal handle to handle_cancel.
   std::unordered_map<GoalUUID, GoalHandleWeakPtr> goal_handles_;
   std::mutex goal_handles_mutex_;
+
+  size_t max_queued_goals_ = 0;
+  std::atomic<size_t> queued_goals_{0};
+  /// Destroyed first, so running callbacks end before the rest of the server is destroyed.
+  std::unique_ptr<rclcpp::detail::WorkerPool> goal_pool_;
 };
 }  // namespace rclcpp_action
 #endif  // RCLCPP_ACTION__SERVER_HPP_
@@ -20,7 +20,9 @@
 #include <action_msgs/msg/goal_status.hpp>
 #include <action_msgs/msg/goal_info.hpp>
 
-#include <climits>
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <string>
 
@@ -68,16 +70,16 @@ struct hash<rclcpp_action::GoalUUID>
 {
   size_t operator()(const rclcpp_action::GoalUUID & uuid) const noexcept
   {
-    // TODO(sloretz) Use someone else's hash function and cite it
-    size_t result = 0;
-    for (size_t i = 0; i < uuid.size(); ++i) {
-      for (size_t b = 0; b < sizeof(size_t); ++b) {
-        size_t part = uuid[i];
-        part <<= CHAR_BIT * b;
-        result ^= part;
-      }
-    }
-    return result;
+    static_assert(sizeof(uuid) == 2 * sizeof(uint64_t), "goal ids are expected to be 128 bits");
+    // Goal ids are random, folding their two halves is enough. The mixing still spreads the
+    // ids which only differ in a few bytes, e.g. built from a counter.
+    uint64_t low;
+    uint64_t high;
+    std::memcpy(&low, uuid.data(), sizeof(low));
+    std::memcpy(&high, uuid.data() + sizeof(low), sizeof(high));
+    uint64_t result = low ^ (high * 0x9E3779B97F4A7C15ULL);
+    result = (result ^ (result >> 32)) * 0xBF58476D1CE4E5B9ULL;
+    return static_cast<size_t>(result ^ (result >> 29));
   }
 };
 }  // namespace std
@@ -12,23 +12,104 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <rcl/guard_condition.h>
 #include <rcl_action/action_client.h>
 #include <rcl_action/wait.h>
 #include <rclcpp/node_interfaces/node_base_interface.hpp>
 #include <rclcpp/node_interfaces/node_logging_interface.hpp>
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
 #include <map>
 #include <memory>
 #include <random>
 #include <string>
+#include <utility>
 
 #include "rclcpp_action/client.hpp"
 #include "rclcpp_action/exceptions.hpp"
 
+#include "intra_process_feedback.hpp"
+
 namespace rclcpp_action
 {
 
+namespace
+{
+// Feedback of the servers of the same process, taken by the executor of the client
+class FeedbackQueue : public detail::IntraProcessFeedbackSink
+{
+public:
+  explicit FeedbackQueue(std::shared_ptr<rcl_context_t> context)
+  : context_(context),
+    guard_condition_(rcl_get_zero_initialized_guard_condition())
+  {
+    rcl_ret_t ret = rcl_guard_condition_init(
+      &guard_condition_, context_.get(), rcl_guard_condition_get_default_options());
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(
+        ret, "could not initialize intra-process feedback guard condition");
+    }
+  }
+
+  ~FeedbackQueue()
+  {
+    if (RCL_RET_OK != rcl_guard_condition_fini(&guard_condition_)) {
+      RCLCPP_ERROR(
+        rclcpp::get_logger("rclcpp_action"),
+        "Error in destruction of intra-process feedback guard condition: %s",
+        rcl_get_error_string().str);
+      rcl_reset_error();
+    }
+  }
+
+  void
+  deliver(std::shared_ptr<void> feedback_message) override
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      messages_.push_back(std::move(feedback_message));
+    }
+    rcl_ret_t ret = rcl_trigger_guard_condition(&guard_condition_);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(
+        ret, "failed to trigger intra-process feedback guard condition");
+    }
+  }
+
+  std::deque<std::shared_ptr<void>>
+  take_all()
+  {
+    std::deque<std::shared_ptr<void>> messages;
+    std::lock_guard<std::mutex> lock(mutex_);
+    messages.swap(messages_);
+    return messages;
+  }
+
+  rcl_guard_condition_t *
+  get_guard_condition()
+  {
+    return &guard_condition_;
+  }
+
+private:
+  std::shared_ptr<rcl_context_t> context_;
+  rcl_guard_condition_t guard_condition_;
+  std::mutex mutex_;
+  std::deque<std::shared_ptr<void>> messages_;
+};
+
+std::mt19937_64
+make_goal_id_generator()
+{
+  std::random_device device;
+  std::seed_seq seed{device(), device(), device(), device()};
+  return std::mt19937_64(seed);
+}
+}  // namespace
+
 class ClientBaseImpl
 {
 public:
@@ -41,8 +122,7 @@ public:
     const rcl_action_client_options_t & client_options)
   : node_graph_(node_graph),
     node_handle(node_base->get_shared_rcl_node_handle()),
-    logger(node_logging->get_logger().get_child("rclcpp_action")),
-    random_bytes_generator(std::random_device{} ())
+    logger(node_logging->get_logger().get_child("rclcpp_action"))
   {
     std::weak_ptr<rcl_node_t> weak_node_handle(node_handle);
     client_handle = std::shared_ptr<rcl_action_client_t>(
@@ -65,9 +145,13 @@ public:
         delete client;
       });
     *client_handle = rcl_action_get_zero_initialized_client();
+    // A shared rcl node has none of the names of this node.
+    const std::string rcl_action_name = node_base->shares_rcl_node() ?
+      detail::expand_action_name(action_name, node_base->get_name(), node_base->get_namespace()) :
+      action_name;
     rcl_ret_t ret = rcl_action_client_init(
       client_handle.get(), node_handle.get(), type_support,
-      action_name.c_str(), &client_options);
+      rcl_action_name.c_str(), &client_options);
     if (RCL_RET_OK != ret) {
       rclcpp::exceptions::throw_from_rcl_error(
         ret, "could not initialize rcl action client");
@@ -84,6 +168,14 @@ public:
       rclcpp::exceptions::throw_from_rcl_error(
         ret, "could not retrieve rcl action client details");
     }
+
+    auto rcl_context = node_base->get_context()->get_rcl_context();
+    intra_process_feedback = std::make_shared<FeedbackQueue>(rcl_context);
+    detail::get_intra_process_feedback_channel(
+      rcl_context.get(),
+      detail::expand_action_name(
+        action_name, node_base->get_name(), node_base->get_namespace()),
+      type_support)->add_sink(intra_process_feedback);
   }
 
   size_t num_subscriptions{0u};
@@ -97,6 +189,11 @@ public:
   bool is_goal_response_ready{false};
   bool is_cancel_response_ready{false};
   bool is_result_response_ready{false};
+  bool is_intra_process_feedback_ready{false};
+
+  // Registered in the channel of the action, which only keeps a weak pointer to it
+  std::shared_ptr<FeedbackQueue> intra_process_feedback;
+  size_t intra_process_feedback_index{0u};
 
   rclcpp::Context::SharedPtr context_;
   rclcpp::node_interfaces::NodeGraphInterface::WeakPtr node_graph_;
@@ -114,9 +211,6 @@ public:
 
   std::map<int64_t, ResponseCallback> pending_cancel_responses;
   std::mutex cancel_requests_mutex;
-
-  std::independent_bits_engine<
-    std::default_random_engine, 8, unsigned int> random_bytes_generator;
 };
 
 ClientBase::ClientBase(
@@ -228,7 +322,8 @@ ClientBase::get_number_of_ready_subscriptions()
 size_t
 ClientBase::get_number_of_ready_guard_conditions()
 {
-  return pimpl_->num_guard_conditions;
+  // The intra-process feedback guard condition.
+  return pimpl_->num_guard_conditions + 1;
 }
 
 size_t
@@ -254,6 +349,12 @@ ClientBase::add_to_wait_set(rcl_wait_set_t * wait_set)
 {
   rcl_ret_t ret = rcl_action_wait_set_add_action_client(
     wait_set, pimpl_->client_handle.get(), nullptr, nullptr);
+  if (RCL_RET_OK != ret) {
+    return false;
+  }
+  ret = rcl_wait_set_add_guard_condition(
+    wait_set, pimpl_->intra_process_feedback->get_guard_condition(),
+    &pimpl_->intra_process_feedback_index);
   return RCL_RET_OK == ret;
 }
 
@@ -271,7 +372,12 @@ ClientBase::is_ready(rcl_wait_set_t * wait_set)
     rclcpp::exceptions::throw_from_rcl_error(
       ret, "failed to check for any ready entities");
   }
+  pimpl_->is_intra_process_feedback_ready =
+    pimpl_->intra_process_feedback_index < wait_set->size_of_guard_conditions &&
+    wait_set->guard_conditions[pimpl_->intra_process_feedback_index] ==
+    pimpl_->intra_process_feedback->get_guard_condition();
   return
+    pimpl_->is_intra_process_feedback_ready ||
     pimpl_->is_feedback_ready ||
     pimpl_->is_status_ready ||
     pimpl_->is_goal_response_ready ||
@@ -284,14 +390,18 @@ ClientBase::handle_goal_response(
   const rmw_request_id_t & response_header,
   std::shared_ptr<void> response)
 {
-  std::lock_guard<std::mutex> guard(pimpl_->goal_requests_mutex);
+  std::unique_lock<std::mutex> guard(pimpl_->goal_requests_mutex);
   const int64_t & sequence_number = response_header.sequence_number;
-  if (pimpl_->pending_goal_responses.count(sequence_number) == 0) {
+  auto it = pimpl_->pending_goal_responses.find(sequence_number);
+  if (it == pimpl_->pending_goal_responses.end()) {
     RCLCPP_ERROR(pimpl_->logger, "unknown goal response, ignoring...");
     return;
   }
-  pimpl_->pending_goal_responses[sequence_number](response);
-  pimpl_->pending_goal_responses.erase(sequence_number);
+  ResponseCallback callback = std::move(it->second);
+  pimpl_->pending_goal_responses.erase(it);
+  // Unlock, so that the callback can send another request, e.g. from a resumed coroutine.
+  guard.unlock();
+  callback(response);
 }
 
 void
@@ -313,14 +423,18 @@ ClientBase::handle_result_response(
   const rmw_request_id_t & response_header,
   std::shared_ptr<void> response)
 {
-  std::lock_guard<std::mutex> guard(pimpl_->result_requests_mutex);
+  std::unique_lock<std::mutex> guard(pimpl_->result_requests_mutex);
   const int64_t & sequence_number = response_header.sequence_number;
-  if (pimpl_->pending_result_responses.count(sequence_number) == 0) {
+  auto it = pimpl_->pending_result_responses.find(sequence_number);
+  if (it == pimpl_->pending_result_responses.end()) {
     RCLCPP_ERROR(pimpl_->logger, "unknown result response, ignoring...");
     return;
   }
-  pimpl_->pending_result_responses[sequence_number](response);
-  pimpl_->pending_result_responses.erase(sequence_number);
+  ResponseCallback callback = std::move(it->second);
+  pimpl_->pending_result_responses.erase(it);
+  // Unlock, so that the callback can send another request, e.g. from a resumed coroutine.
+  guard.unlock();
+  callback(response);
 }
 
 void
@@ -342,14 +456,18 @@ ClientBase::handle_cancel_response(
   const rmw_request_id_t & response_header,
   std::shared_ptr<void> response)
 {
-  std::lock_guard<std::mutex> guard(pimpl_->cancel_requests_mutex);
+  std::unique_lock<std::mutex> guard(pimpl_->cancel_requests_mutex);
   const int64_t & sequence_number = response_header.sequence_number;
-  if (pimpl_->pending_cancel_responses.count(sequence_number) == 0) {
+  auto it = pimpl_->pending_cancel_responses.find(sequence_number);
+  if (it == pimpl_->pending_cancel_responses.end()) {
     RCLCPP_ERROR(pimpl_->logger, "unknown cancel response, ignoring...");
     return;
   }
-  pimpl_->pending_cancel_responses[sequence_number](response);
-  pimpl_->pending_cancel_responses.erase(sequence_number);
+  ResponseCallback callback = std::move(it->second);
+  pimpl_->pending_cancel_responses.erase(it);
+  // Unlock, so that the callback can send another request, e.g. from a resumed coroutine.
+  guard.unlock();
+  callback(response);
 }
 
 void
@@ -369,21 +487,26 @@ ClientBase::send_cancel_request(std::shared_ptr<void> request, ResponseCallback
 GoalUUID
 ClientBase::generate_goal_id()
 {
+  // One generator per thread, so that the clients sending goals from several threads don't
+  // share its state, and it is seeded once per thread rather than once per client.
+  thread_local std::mt19937_64 generator = make_goal_id_generator();
+  static_assert(sizeof(GoalUUID) == 2 * sizeof(uint64_t), "unexpected size of a goal id");
+  uint64_t random_bits[2] = {generator(), generator()};
   GoalUUID goal_id;
-  // TODO(hidmic): Do something better than this for UUID generation.
-  // std::generate(
-  //   goal_id.uuid.begin(), goal_id.uuid.end(),
-  //   std::ref(pimpl_->random_bytes_generator));
-  std::generate(
-    goal_id.begin(), goal_id.end(),
-    std::ref(pimpl_->random_bytes_generator));
+  std::memcpy(goal_id.data(), random_bits, sizeof(random_bits));
   return goal_id;
 }
 
 void
 ClientBase::execute()
 {
-  if (pimpl_->is_feedback_ready) {
+  if (pimpl_->is_intra_process_feedback_ready) {
+    pimpl_->is_intra_process_feedback_ready = false;
+    // Triggers while the guard condition was ready are not counted, everything is taken.
+    for (auto & feedback_message : pimpl_->intra_process_feedback->take_all()) {
+      this->handle_feedback_message(feedback_message);
+    }
+  } else if (pimpl_->is_feedback_ready) {
     std::shared_ptr<void> feedback_message = this->create_feedback_message();
     rcl_ret_t ret = rcl_action_take_feedback(
       pimpl_->client_handle.get(), feedback_message.get());
@@ -0,0 +1,100 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "intra_process_feedback.hpp"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace rclcpp_action
+{
+namespace detail
+{
+
+void
+IntraProcessFeedbackChannel::add_sink(std::weak_ptr<IntraProcessFeedbackSink> sink)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  sinks_.push_back(sink);
+}
+
+std::vector<std::shared_ptr<IntraProcessFeedbackSink>>
+IntraProcessFeedbackChannel::get_sinks()
+{
+  std::vector<std::shared_ptr<IntraProcessFeedbackSink>> sinks;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = sinks_.begin();
+  while (iter != sinks_.end()) {
+    auto sink = iter->lock();
+    if (sink) {
+      sinks.push_back(sink);
+      ++iter;
+    } else {
+      iter = sinks_.erase(iter);
+    }
+  }
+  return sinks;
+}
+
+std::shared_ptr<IntraProcessFeedbackChannel>
+get_intra_process_feedback_channel(
+  const rcl_context_t * context,
+  const std::string & action_name,
+  const rosidl_action_type_support_t * type_support)
+{
+  using Key = std::tuple<const rcl_context_t *, std::string, const rosidl_action_type_support_t *>;
+  static std::mutex mutex;
+  static std::map<Key, std::weak_ptr<IntraProcessFeedbackChannel>> channels;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  // Channels of destroyed servers and clients are removed as new ones are created.
+  auto iter = channels.begin();
+  while (iter != channels.end()) {
+    if (iter->second.expired()) {
+      iter = channels.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  std::weak_ptr<IntraProcessFeedbackChannel> & weak_channel =
+    channels[Key(context, action_name, type_support)];
+  auto channel = weak_channel.lock();
+  if (!channel) {
+    channel = std::make_shared<IntraProcessFeedbackChannel>();
+    weak_channel = channel;
+  }
+  return channel;
+}
+
+std::string
+expand_action_name(
+  const std::string & action_name, const std::string & node_name,
+  const std::string & node_namespace)
+{
+  if (!action_name.empty() && '/' == action_name[0]) {
+    return action_name;
+  }
+  std::string prefix = "/" == node_namespace ? "" : node_namespace;
+  if (!action_name.empty() && '~' == action_name[0]) {
+    return prefix + "/" + node_name + action_name.substr(1);
+  }
+  return prefix + "/" + action_name;
+}
+
+}  // namespace detail
+}  // namespace rclcpp_action
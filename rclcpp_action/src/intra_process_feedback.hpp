@@ -0,0 +1,81 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef INTRA_PROCESS_FEEDBACK_HPP_
+#define INTRA_PROCESS_FEEDBACK_HPP_
+
+#include <rcl/context.h>
+#include <rosidl_generator_c/action_type_support_struct.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace rclcpp_action
+{
+namespace detail
+{
+
+/// Receives the feedback an action server of the same process published.
+class IntraProcessFeedbackSink
+{
+public:
+  virtual ~IntraProcessFeedbackSink() = default;
+
+  /// Take a feedback message, shared with the other sinks, which must not modify it.
+  virtual
+  void
+  deliver(std::shared_ptr<void> feedback_message) = 0;
+};
+
+/// The action clients of a process which can get the feedback of a server without DDS.
+/**
+ * There is one channel per context, fully qualified action name and action type, shared by its
+ * servers and clients.
+ */
+class IntraProcessFeedbackChannel
+{
+public:
+  /// Add a sink, which is removed from the channel when it is destroyed.
+  void
+  add_sink(std::weak_ptr<IntraProcessFeedbackSink> sink);
+
+  /// Return the sinks which still exist.
+  std::vector<std::shared_ptr<IntraProcessFeedbackSink>>
+  get_sinks();
+
+private:
+  std::mutex mutex_;
+  std::vector<std::weak_ptr<IntraProcessFeedbackSink>> sinks_;
+};
+
+/// Return the channel of an action, created on first use.
+std::shared_ptr<IntraProcessFeedbackChannel>
+get_intra_process_feedback_channel(
+  const rcl_context_t * context,
+  const std::string & action_name,
+  const rosidl_action_type_support_t * type_support);
+
+/// Return the fully qualified name of an action of a node, without applying remappings.
+std::string
+expand_action_name(
+  const std::string & action_name, const std::string & node_name,
+  const std::string & node_namespace);
+
+}  // namespace detail
+}  // namespace rclcpp_action
+
+#endif  // INTRA_PROCESS_FEEDBACK_HPP_
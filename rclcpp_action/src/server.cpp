@@ -12,21 +12,31 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <rcl/graph.h>
+#include <rcl/timer.h>
 #include <rcl_action/action_server.h>
 #include <rcl_action/wait.h>
 
 #include <action_msgs/msg/goal_status_array.hpp>
 #include <action_msgs/srv/cancel_goal.hpp>
+#include <rclcpp/clock.hpp>
 #include <rclcpp/exceptions.hpp>
 #include <rclcpp/scope_exit.hpp>
 #include <rclcpp_action/server.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <memory>
 #include <mutex>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "intra_process_feedback.hpp"
+
 using rclcpp_action::ServerBase;
 using rclcpp_action::GoalUUID;
 
@@ -43,7 +53,8 @@ public:
   {
   }
 
-  // Lock everything except user callbacks
+  // Lock everything except user callbacks, which are called without it so that a slow callback
+  // doesn't delay the requests handled by other threads
   std::recursive_mutex reentrant_mutex_;
 
   std::shared_ptr<rcl_action_server_t> action_server_;
@@ -56,22 +67,243 @@ public:
   size_t num_services_ = 0;
   size_t num_guard_conditions_ = 0;
 
-  bool goal_request_ready_ = false;
-  bool cancel_request_ready_ = false;
-  bool result_request_ready_ = false;
-  bool goal_expired_ = false;
+  // Set by is_ready() and claimed by execute(), so that concurrent executions of the server in a
+  // reentrant callback group handle different entities
+  std::atomic<bool> goal_request_ready_{false};
+  std::atomic<bool> cancel_request_ready_{false};
+  std::atomic<bool> result_request_ready_{false};
+  std::atomic<bool> goal_expired_{false};
+
+  // Index of the goal service in the wait set, the cancel and result services follow it
+  size_t service_index_ = 0;
+  // Number of goal handles, read without the lock to skip idle servers in is_ready()
+  std::atomic<size_t> goal_count_{0};
 
   // Results to be kept until the goal expires after reaching a terminal state
   std::unordered_map<GoalUUID, std::shared_ptr<void>> goal_results_;
   // Requests for results are kept until a result becomes available
   std::unordered_map<GoalUUID, std::vector<rmw_request_id_t>> result_requests_;
+
+  // Results kept within the memory budget, oldest first, 0 for no budget
+  size_t result_memory_budget_ = 0;
+  size_t result_memory_usage_ = 0;
+  uint64_t evicted_result_count_ = 0;
+  std::unordered_map<GoalUUID, size_t> result_sizes_;
+  // May contain goals which expired since, skipped when evicting
+  std::deque<GoalUUID> result_order_;
+  // Shared by all evicted results, so that their result requests are still answered
+  std::shared_ptr<void> evicted_result_response_;
   // rcl goal handles are kept so api to send result doesn't try to access freed memory
   std::unordered_map<GoalUUID, std::shared_ptr<rcl_action_goal_handle_t>> goal_handles_;
 
+  // Statuses of the goals known to the server, updated in place and published as they are
+  action_msgs::msg::GoalStatusArray status_array_;
+  // Index of each goal in the status array
+  std::unordered_map<GoalUUID, size_t> status_index_;
+
+  // Minimum period between two status publishes, 0 to publish each change right away
+  std::chrono::nanoseconds status_publish_period_{0};
+  // True if statuses changed since the last publish, while the publish period is running
+  bool status_pending_ = false;
+  // Runs for a publish period after each publish, canceled otherwise
+  rclcpp::Clock::SharedPtr steady_clock_;
+  std::shared_ptr<rcl_timer_t> status_timer_;
+  size_t status_timer_index_ = 0;
+  std::atomic<bool> status_timer_ready_{false};
+
+  // Feedback publishing state of a goal
+  struct GoalFeedback
+  {
+    // When the last feedback of the goal was published
+    std::chrono::steady_clock::time_point last_publish;
+    // Latest feedback not published yet, when coalescing
+    std::shared_ptr<void> pending;
+  };
+  FeedbackPolicy feedback_policy_;
+  std::unordered_map<GoalUUID, GoalFeedback> goal_feedbacks_;
+  size_t pending_feedback_count_ = 0;
+  uint64_t dropped_feedback_count_ = 0;
+  uint64_t coalesced_feedback_count_ = 0;
+  // Runs while feedback is pending
+  std::shared_ptr<rcl_timer_t> feedback_timer_;
+  size_t feedback_timer_index_ = 0;
+  std::atomic<bool> feedback_timer_ready_{false};
+
+  // The node is notified when a timer is started, so that the executor waits for it
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base_;
+
+  // Clients of the same process, which get the feedback without DDS when there are no others
+  std::shared_ptr<detail::IntraProcessFeedbackChannel> feedback_channel_;
+  std::string feedback_topic_name_;
+
+  void
+  remove_result_size(const GoalUUID & uuid)
+  {
+    auto iter = result_sizes_.find(uuid);
+    if (iter != result_sizes_.end()) {
+      result_memory_usage_ -= iter->second;
+      result_sizes_.erase(iter);
+    }
+    // Results usually expire in the order they were published.
+    while (!result_order_.empty() && 0u == result_sizes_.count(result_order_.front())) {
+      result_order_.pop_front();
+    }
+  }
+
+  void
+  remove_goal_feedback(const GoalUUID & uuid)
+  {
+    auto iter = goal_feedbacks_.find(uuid);
+    if (iter == goal_feedbacks_.end()) {
+      return;
+    }
+    if (iter->second.pending) {
+      --pending_feedback_count_;
+      ++dropped_feedback_count_;
+    }
+    goal_feedbacks_.erase(iter);
+  }
+
+  // Start a timer if it is canceled, and wake up the executor
+  bool
+  start_timer(rcl_timer_t * timer)
+  {
+    bool canceled = true;
+    rcl_ret_t ret = rcl_timer_is_canceled(timer, &canceled);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
+    if (!canceled) {
+      return false;
+    }
+    ret = rcl_timer_reset(timer);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
+    auto notify_guard_condition_lock = node_base_->acquire_notify_guard_condition_lock();
+    ret = rcl_trigger_guard_condition(node_base_->get_notify_guard_condition());
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to trigger notify guard condition");
+    }
+    return true;
+  }
+
   rclcpp::Logger logger_;
+
+  // Set the status of a goal from its rcl goal handle, adding the goal if it is new
+  void
+  set_goal_status(const GoalUUID & uuid, const rcl_action_goal_handle_t * handle)
+  {
+    auto index = status_index_.find(uuid);
+    if (index == status_index_.end()) {
+      rcl_action_goal_info_t goal_info = rcl_action_get_zero_initialized_goal_info();
+      rcl_ret_t ret = rcl_action_goal_handle_get_info(handle, &goal_info);
+      if (RCL_RET_OK != ret) {
+        rclcpp::exceptions::throw_from_rcl_error(ret);
+      }
+      action_msgs::msg::GoalStatus msg;
+      msg.goal_info.goal_id.uuid = uuid;
+      msg.goal_info.stamp.sec = goal_info.stamp.sec;
+      msg.goal_info.stamp.nanosec = goal_info.stamp.nanosec;
+      index = status_index_.emplace(uuid, status_array_.status_list.size()).first;
+      status_array_.status_list.push_back(msg);
+    }
+    rcl_action_goal_state_t status;
+    rcl_ret_t ret = rcl_action_goal_handle_get_status(handle, &status);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
+    status_array_.status_list[index->second].status = status;
+  }
+
+  // Remove the status of a goal, the last status takes its place
+  void
+  remove_goal_status(const GoalUUID & uuid)
+  {
+    auto index = status_index_.find(uuid);
+    if (index == status_index_.end()) {
+      return;
+    }
+    auto & status_list = status_array_.status_list;
+    if (index->second != status_list.size() - 1) {
+      status_list[index->second] = std::move(status_list.back());
+      status_index_[status_list[index->second].goal_info.goal_id.uuid] = index->second;
+    }
+    status_list.pop_back();
+    status_index_.erase(index);
+  }
 };
 }  // namespace rclcpp_action
 
+namespace
+{
+// Create a timer used by the server itself, canceled until the server starts it
+std::shared_ptr<rcl_timer_t>
+create_canceled_timer(
+  rclcpp::Clock::SharedPtr clock, std::shared_ptr<rcl_context_t> rcl_context)
+{
+  std::shared_ptr<rcl_timer_t> timer(
+    new rcl_timer_t, [clock, rcl_context](rcl_timer_t * timer) {
+      {
+        std::lock_guard<std::mutex> clock_guard(clock->get_clock_mutex());
+        if (RCL_RET_OK != rcl_timer_fini(timer)) {
+          RCLCPP_DEBUG(
+            rclcpp::get_logger("rclcpp_action"), "failed to fini rcl_timer_t in deleter");
+          rcl_reset_error();
+        }
+      }
+      delete timer;
+    });
+  *timer = rcl_get_zero_initialized_timer();
+  rcl_ret_t ret;
+  {
+    std::lock_guard<std::mutex> clock_guard(clock->get_clock_mutex());
+    ret = rcl_timer_init(
+      timer.get(), clock->get_clock_handle(), rcl_context.get(),
+      std::chrono::nanoseconds(std::chrono::seconds(1)).count(), nullptr,
+      rcl_get_default_allocator());
+  }
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to create a timer of the server");
+  }
+  ret = rcl_timer_cancel(timer.get());
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret);
+  }
+  return timer;
+}
+
+// Return true if the timer is in the wait set and ready
+bool
+is_timer_ready(const rcl_wait_set_t * wait_set, const rcl_timer_t * timer, size_t index)
+{
+  return index < wait_set->size_of_timers && wait_set->timers[index] == timer;
+}
+
+// Return true if the timer is running and its period elapsed
+bool
+is_timer_due(const rcl_timer_t * timer)
+{
+  bool is_ready = false;
+  if (RCL_RET_OK != rcl_timer_is_ready(timer, &is_ready)) {
+    rcl_reset_error();
+    return false;
+  }
+  return is_ready;
+}
+
+bool
+is_any_service_ready(const rcl_wait_set_t * wait_set, size_t first, size_t count)
+{
+  for (size_t index = first; index < first + count && index < wait_set->size_of_services; ++index) {
+    if (nullptr != wait_set->services[index]) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
 ServerBase::ServerBase(
   rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node_base,
   rclcpp::node_interfaces::NodeClockInterface::SharedPtr node_clock,
@@ -102,8 +334,12 @@ ServerBase::ServerBase(
   rcl_node_t * rcl_node = node_base->get_rcl_node_handle();
   rcl_clock_t * rcl_clock = pimpl_->clock_->get_clock_handle();
 
+  // A shared rcl node has none of the names of this node.
+  const std::string rcl_action_name = node_base->shares_rcl_node() ?
+    detail::expand_action_name(name, node_base->get_name(), node_base->get_namespace()) : name;
   rcl_ret_t ret = rcl_action_server_init(
-    pimpl_->action_server_.get(), rcl_node, rcl_clock, type_support, name.c_str(), &options);
+    pimpl_->action_server_.get(), rcl_node, rcl_clock, type_support, rcl_action_name.c_str(),
+    &options);
 
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret);
@@ -120,6 +356,20 @@ ServerBase::ServerBase(
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret);
   }
+
+  // The timers are always part of the server, so that its number of entities doesn't change
+  // while it is in a wait set.
+  pimpl_->node_base_ = node_base;
+  pimpl_->steady_clock_ = std::make_shared<rclcpp::Clock>(RCL_STEADY_TIME);
+  auto rcl_context = node_base->get_context()->get_rcl_context();
+  pimpl_->status_timer_ = create_canceled_timer(pimpl_->steady_clock_, rcl_context);
+  pimpl_->feedback_timer_ = create_canceled_timer(pimpl_->steady_clock_, rcl_context);
+
+  std::string action_name = detail::expand_action_name(
+    name, node_base->get_name(), node_base->get_namespace());
+  pimpl_->feedback_channel_ = detail::get_intra_process_feedback_channel(
+    rcl_context.get(), action_name, type_support);
+  pimpl_->feedback_topic_name_ = action_name + "/_action/feedback";
 }
 
 ServerBase::~ServerBase()
@@ -135,7 +385,8 @@ ServerBase::get_number_of_ready_subscriptions()
 size_t
 ServerBase::get_number_of_ready_timers()
 {
-  return pimpl_->num_timers_;
+  // The status and feedback timers.
+  return pimpl_->num_timers_ + 2;
 }
 
 size_t
@@ -159,47 +410,90 @@ ServerBase::get_number_of_ready_guard_conditions()
 bool
 ServerBase::add_to_wait_set(rcl_wait_set_t * wait_set)
 {
-  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  // The wait set indices are only used by the executor thread which waits on this server, the
+  // lock isn't needed.
   rcl_ret_t ret = rcl_action_wait_set_add_action_server(
-    wait_set, pimpl_->action_server_.get(), NULL);
+    wait_set, pimpl_->action_server_.get(), &pimpl_->service_index_);
+  if (RCL_RET_OK != ret) {
+    return false;
+  }
+  ret = rcl_wait_set_add_timer(
+    wait_set, pimpl_->status_timer_.get(), &pimpl_->status_timer_index_);
+  if (RCL_RET_OK != ret) {
+    return false;
+  }
+  ret = rcl_wait_set_add_timer(
+    wait_set, pimpl_->feedback_timer_.get(), &pimpl_->feedback_timer_index_);
   return RCL_RET_OK == ret;
 }
 
 bool
 ServerBase::is_ready(rcl_wait_set_t * wait_set)
 {
-  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
-  rcl_ret_t ret = rcl_action_server_wait_set_get_entities_ready(
-    wait_set,
-    pimpl_->action_server_.get(),
-    &pimpl_->goal_request_ready_,
-    &pimpl_->cancel_request_ready_,
-    &pimpl_->result_request_ready_,
-    &pimpl_->goal_expired_);
-
-  if (RCL_RET_OK != ret) {
-    rclcpp::exceptions::throw_from_rcl_error(ret);
+  // The wait set clears the entities which aren't ready. Without goals the goal expiration timer
+  // can't be ready, so an idle server is skipped without locking nor querying rcl_action.
+  if (0u == pimpl_->goal_count_ &&
+    !is_any_service_ready(wait_set, pimpl_->service_index_, pimpl_->num_services_) &&
+    !is_timer_ready(wait_set, pimpl_->status_timer_.get(), pimpl_->status_timer_index_) &&
+    !is_timer_ready(wait_set, pimpl_->feedback_timer_.get(), pimpl_->feedback_timer_index_))
+  {
+    return false;
   }
 
-  return pimpl_->goal_request_ready_ ||
-         pimpl_->cancel_request_ready_ ||
-         pimpl_->result_request_ready_ ||
-         pimpl_->goal_expired_;
+  bool goal_request_ready = false;
+  bool cancel_request_ready = false;
+  bool result_request_ready = false;
+  bool goal_expired = false;
+  {
+    std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+    rcl_ret_t ret = rcl_action_server_wait_set_get_entities_ready(
+      wait_set,
+      pimpl_->action_server_.get(),
+      &goal_request_ready,
+      &cancel_request_ready,
+      &result_request_ready,
+      &goal_expired);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
+  }
+  // The entities ready before and not claimed yet by an execution stay ready.
+  auto set_ready = [](std::atomic<bool> & flag, bool ready) {
+      if (ready) {
+        flag = true;
+      }
+      return flag.load();
+    };
+  bool any_ready = set_ready(pimpl_->goal_request_ready_, goal_request_ready);
+  any_ready |= set_ready(pimpl_->cancel_request_ready_, cancel_request_ready);
+  any_ready |= set_ready(pimpl_->result_request_ready_, result_request_ready);
+  any_ready |= set_ready(pimpl_->goal_expired_, goal_expired);
+  any_ready |= set_ready(
+    pimpl_->status_timer_ready_,
+    is_timer_ready(wait_set, pimpl_->status_timer_.get(), pimpl_->status_timer_index_));
+  any_ready |= set_ready(
+    pimpl_->feedback_timer_ready_,
+    is_timer_ready(wait_set, pimpl_->feedback_timer_.get(), pimpl_->feedback_timer_index_));
+  return any_ready;
 }
 
 void
 ServerBase::execute()
 {
-  if (pimpl_->goal_request_ready_) {
+  // Each execution claims one ready entity. Executions in a reentrant callback group may run
+  // concurrently, and find the entities they were ready for claimed by the others.
+  if (pimpl_->goal_request_ready_.exchange(false)) {
     execute_goal_request_received();
-  } else if (pimpl_->cancel_request_ready_) {
+  } else if (pimpl_->cancel_request_ready_.exchange(false)) {
     execute_cancel_request_received();
-  } else if (pimpl_->result_request_ready_) {
+  } else if (pimpl_->result_request_ready_.exchange(false)) {
     execute_result_request_received();
-  } else if (pimpl_->goal_expired_) {
+  } else if (pimpl_->goal_expired_.exchange(false)) {
     execute_check_expired_goals();
-  } else {
-    throw std::runtime_error("Executing action server but nothing is ready");
+  } else if (pimpl_->status_timer_ready_.exchange(false)) {
+    execute_status_timer();
+  } else if (pimpl_->feedback_timer_ready_.exchange(false)) {
+    execute_feedback_timer();
   }
 }
 
@@ -210,7 +504,7 @@ ServerBase::execute_goal_request_received()
   rcl_action_goal_info_t goal_info = rcl_action_get_zero_initialized_goal_info();
   rmw_request_id_t request_header;
 
-  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  std::unique_lock<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
 
   std::shared_ptr<void> message = create_goal_request();
   ret = rcl_action_take_goal_request(
@@ -218,8 +512,6 @@ ServerBase::execute_goal_request_received()
     &request_header,
     message.get());
 
-  pimpl_->goal_request_ready_ = false;
-
   if (RCL_RET_ACTION_SERVER_TAKE_FAILED == ret) {
     // Ignore take failure because connext fails if it receives a sample without valid data.
     // This happens when a client shuts down and connext receives a sample saying the client is
@@ -233,7 +525,9 @@ ServerBase::execute_goal_request_received()
   convert(uuid, &goal_info);
 
   // Call user's callback, getting the user's response and a ros message to send back
+  lock.unlock();
   auto response_pair = call_handle_goal_callback(uuid, message);
+  lock.lock();
 
   ret = rcl_action_send_goal_response(
     pimpl_->action_server_.get(),
@@ -272,6 +566,7 @@ ServerBase::execute_goal_request_received()
     *handle = *rcl_handle;
 
     pimpl_->goal_handles_[uuid] = handle;
+    pimpl_->goal_count_ = pimpl_->goal_handles_.size();
 
     if (GoalResponse::ACCEPT_AND_EXECUTE == status) {
       // Change status to executing
@@ -281,7 +576,8 @@ ServerBase::execute_goal_request_received()
       }
     }
     // publish status since a goal's state has changed (was accepted or has begun execution)
-    publish_status();
+    publish_status(uuid);
+    lock.unlock();
 
     // Tell user to start executing action
     call_goal_accepted_callback(handle, uuid, message);
@@ -297,14 +593,12 @@ ServerBase::execute_cancel_request_received()
   // Initialize cancel request
   auto request = std::make_shared<action_msgs::srv::CancelGoal::Request>();
 
-  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  std::unique_lock<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
   ret = rcl_action_take_cancel_request(
     pimpl_->action_server_.get(),
     &request_header,
     request.get());
 
-  pimpl_->cancel_request_ready_ = false;
-
   if (RCL_RET_ACTION_SERVER_TAKE_FAILED == ret) {
     // Ignore take failure because connext fails if it receives a sample without valid data.
     // This happens when a client shuts down and connext receives a sample saying the client is
@@ -344,6 +638,7 @@ ServerBase::execute_cancel_request_received()
   response->return_code = cancel_response.msg.return_code;
   auto & goals = cancel_response.msg.goals_canceling;
   // For each canceled goal, call cancel callback
+  lock.unlock();
   for (size_t i = 0; i < goals.size; ++i) {
     const rcl_action_goal_info_t & goal_info = goals.data[i];
     GoalUUID uuid;
@@ -364,9 +659,17 @@ ServerBase::execute_cancel_request_received()
     response->return_code = action_msgs::srv::CancelGoal::Response::ERROR_REJECTED;
   }
 
+  lock.lock();
+
   if (!response->goals_canceling.empty()) {
     // at least one goal state changed, publish a new status message
-    publish_status();
+    for (const auto & goal_info : response->goals_canceling) {
+      auto handle = pimpl_->goal_handles_.find(goal_info.goal_id.uuid);
+      if (handle != pimpl_->goal_handles_.end()) {
+        pimpl_->set_goal_status(handle->first, handle->second.get());
+      }
+    }
+    publish_status_array();
   }
 
   ret = rcl_action_send_cancel_response(
@@ -387,8 +690,6 @@ ServerBase::execute_result_request_received()
   ret = rcl_action_take_result_request(
     pimpl_->action_server_.get(), &request_header, result_request.get());
 
-  pimpl_->result_request_ready_ = false;
-
   if (RCL_RET_ACTION_SERVER_TAKE_FAILED == ret) {
     // Ignore take failure because connext fails if it receives a sample without valid data.
     // This happens when a client shuts down and connext receives a sample saying the client is
@@ -433,25 +734,31 @@ ServerBase::execute_result_request_received()
 void
 ServerBase::execute_check_expired_goals()
 {
-  // Allocate expecting only one goal to expire at a time
-  rcl_action_goal_info_t expired_goals[1];
-  size_t num_expired = 1;
+  // Goals which finished together expire together, they are handled in batches.
+  constexpr size_t max_expired = 16;
+  rcl_action_goal_info_t expired_goals[max_expired];
+  size_t num_expired = max_expired;
 
-  // Loop in case more than 1 goal expired
-  while (num_expired > 0u) {
+  // Loop while batches are full, in case more goals expired
+  while (max_expired == num_expired) {
     std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
     rcl_ret_t ret;
-    ret = rcl_action_expire_goals(pimpl_->action_server_.get(), expired_goals, 1, &num_expired);
+    ret = rcl_action_expire_goals(
+      pimpl_->action_server_.get(), expired_goals, max_expired, &num_expired);
     if (RCL_RET_OK != ret) {
       rclcpp::exceptions::throw_from_rcl_error(ret);
-    } else if (num_expired) {
-      // A goal expired!
+    }
+    for (size_t i = 0; i < num_expired; ++i) {
       GoalUUID uuid;
-      convert(expired_goals[0], &uuid);
+      convert(expired_goals[i], &uuid);
       RCLCPP_DEBUG(pimpl_->logger_, "Expired goal %s", to_string(uuid).c_str());
       pimpl_->goal_results_.erase(uuid);
       pimpl_->result_requests_.erase(uuid);
       pimpl_->goal_handles_.erase(uuid);
+      pimpl_->goal_count_ = pimpl_->goal_handles_.size();
+      pimpl_->remove_goal_status(uuid);
+      pimpl_->remove_goal_feedback(uuid);
+      pimpl_->remove_result_size(uuid);
     }
   }
 }
@@ -459,55 +766,98 @@ ServerBase::execute_check_expired_goals()
 void
 ServerBase::publish_status()
 {
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  for (const auto & goal_handle : pimpl_->goal_handles_) {
+    pimpl_->set_goal_status(goal_handle.first, goal_handle.second.get());
+  }
+  publish_status_array();
+}
+
+void
+ServerBase::publish_status(const GoalUUID & uuid)
+{
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  auto goal_handle = pimpl_->goal_handles_.find(uuid);
+  if (goal_handle != pimpl_->goal_handles_.end()) {
+    pimpl_->set_goal_status(uuid, goal_handle->second.get());
+  }
+  publish_status_array();
+}
+
+void
+ServerBase::publish_status_array()
+{
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
   rcl_ret_t ret;
+  // Without a running period, one is started and the statuses are published right away.
+  if (
+    pimpl_->status_publish_period_.count() > 0 &&
+    !pimpl_->start_timer(pimpl_->status_timer_.get()))
+  {
+    // Published at the end of the period.
+    pimpl_->status_pending_ = true;
+    return;
+  }
+  pimpl_->status_pending_ = false;
 
-  // Get all goal handles known to C action server
-  rcl_action_goal_handle_t ** goal_handles = NULL;
-  size_t num_goals = 0;
-  ret = rcl_action_server_get_goal_handles(
-    pimpl_->action_server_.get(), &goal_handles, &num_goals);
+  // Publish a status message through the status publisher
+  ret = rcl_action_publish_status(pimpl_->action_server_.get(), &pimpl_->status_array_);
 
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret);
   }
+}
 
-  auto status_msg = std::make_shared<action_msgs::msg::GoalStatusArray>();
-  status_msg->status_list.reserve(num_goals);
-  // Populate a c++ status message with the goals and their statuses
-  rcl_action_goal_status_array_t c_status_array =
-    rcl_action_get_zero_initialized_goal_status_array();
-  ret = rcl_action_get_goal_status_array(pimpl_->action_server_.get(), &c_status_array);
+void
+ServerBase::execute_status_timer()
+{
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  if (!is_timer_due(pimpl_->status_timer_.get())) {
+    // Already called by a concurrent execution.
+    return;
+  }
+  rcl_ret_t ret = rcl_timer_call(pimpl_->status_timer_.get());
+  if (RCL_RET_TIMER_CANCELED == ret) {
+    // Canceled since the wait, e.g. by a change of the publish period.
+    rcl_reset_error();
+    return;
+  } else if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret);
+  }
+  if (pimpl_->status_pending_) {
+    // The timer keeps running for another period.
+    pimpl_->status_pending_ = false;
+    ret = rcl_action_publish_status(pimpl_->action_server_.get(), &pimpl_->status_array_);
+  } else {
+    ret = rcl_timer_cancel(pimpl_->status_timer_.get());
+  }
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret);
   }
+}
 
-  RCLCPP_SCOPE_EXIT(
-  {
-    ret = rcl_action_goal_status_array_fini(&c_status_array);
-    if (RCL_RET_OK != ret) {
-      RCLCPP_ERROR(pimpl_->logger_, "Failed to fini status array message");
-    }
-  });
-
-  for (size_t i = 0; i < c_status_array.msg.status_list.size; ++i) {
-    auto & c_status_msg = c_status_array.msg.status_list.data[i];
-
-    action_msgs::msg::GoalStatus msg;
-    msg.status = c_status_msg.status;
-    // Convert C goal info to C++ goal info
-    convert(c_status_msg.goal_info, &msg.goal_info.goal_id.uuid);
-    msg.goal_info.stamp.sec = c_status_msg.goal_info.stamp.sec;
-    msg.goal_info.stamp.nanosec = c_status_msg.goal_info.stamp.nanosec;
-
-    status_msg->status_list.push_back(msg);
+void
+ServerBase::set_status_publish_period(std::chrono::nanoseconds period)
+{
+  if (period.count() < 0) {
+    throw std::invalid_argument("the status publish period must not be negative");
   }
-
-  // Publish the message through the status publisher
-  ret = rcl_action_publish_status(pimpl_->action_server_.get(), status_msg.get());
-
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  pimpl_->status_publish_period_ = period;
+  rcl_ret_t ret = rcl_timer_cancel(pimpl_->status_timer_.get());
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret);
   }
+  if (period.count() > 0) {
+    int64_t old_period;
+    ret = rcl_timer_exchange_period(pimpl_->status_timer_.get(), period.count(), &old_period);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
+  }
+  if (pimpl_->status_pending_) {
+    publish_status_array();
+  }
 }
 
 void
@@ -525,6 +875,8 @@ ServerBase::publish_result(const GoalUUID & uuid, std::shared_ptr<void> result_m
   }
 
   pimpl_->goal_results_[uuid] = result_msg;
+  // Feedback still pending is outdated by the result.
+  pimpl_->remove_goal_feedback(uuid);
 
   // if there are clients who already asked for the result, send it to them
   auto iter = pimpl_->result_requests_.find(uuid);
@@ -537,6 +889,75 @@ ServerBase::publish_result(const GoalUUID & uuid, std::shared_ptr<void> result_m
       }
     }
   }
+
+  if (pimpl_->result_memory_budget_ > 0 && 0u == pimpl_->result_sizes_.count(uuid)) {
+    size_t size = estimate_result_size(result_msg);
+    pimpl_->result_sizes_[uuid] = size;
+    pimpl_->result_order_.push_back(uuid);
+    pimpl_->result_memory_usage_ += size;
+    evict_results();
+  }
+}
+
+void
+ServerBase::evict_results()
+{
+  while (
+    pimpl_->result_memory_usage_ > pimpl_->result_memory_budget_ &&
+    !pimpl_->result_order_.empty())
+  {
+    GoalUUID uuid = pimpl_->result_order_.front();
+    pimpl_->result_order_.pop_front();
+    auto iter = pimpl_->result_sizes_.find(uuid);
+    if (iter == pimpl_->result_sizes_.end()) {
+      // Expired already.
+      continue;
+    }
+    pimpl_->result_memory_usage_ -= iter->second;
+    pimpl_->result_sizes_.erase(iter);
+    if (!pimpl_->evicted_result_response_) {
+      pimpl_->evicted_result_response_ =
+        create_result_response(action_msgs::msg::GoalStatus::STATUS_UNKNOWN);
+    }
+    pimpl_->goal_results_[uuid] = pimpl_->evicted_result_response_;
+    ++pimpl_->evicted_result_count_;
+    RCLCPP_DEBUG(pimpl_->logger_, "Evicted result of goal %s", to_string(uuid).c_str());
+  }
+}
+
+size_t
+ServerBase::estimate_result_size(const std::shared_ptr<void> & result_msg)
+{
+  (void)result_msg;
+  return 0;
+}
+
+void
+ServerBase::set_result_memory_budget(size_t bytes)
+{
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  pimpl_->result_memory_budget_ = bytes;
+  if (0u == bytes) {
+    pimpl_->result_sizes_.clear();
+    pimpl_->result_order_.clear();
+    pimpl_->result_memory_usage_ = 0;
+    return;
+  }
+  evict_results();
+}
+
+size_t
+ServerBase::get_result_memory_usage() const
+{
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  return pimpl_->result_memory_usage_;
+}
+
+uint64_t
+ServerBase::get_evicted_result_count() const
+{
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  return pimpl_->evicted_result_count_;
 }
 
 void
@@ -553,8 +974,145 @@ void
 ServerBase::publish_feedback(std::shared_ptr<void> feedback_msg)
 {
   std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  auto sinks = pimpl_->feedback_channel_->get_sinks();
+  if (!sinks.empty()) {
+    // The clients of the process are subscribed too, if there is no one else the message is
+    // given to them without being serialized.
+    size_t subscriber_count = 0;
+    rcl_ret_t ret = rcl_count_subscribers(
+      pimpl_->node_base_->get_rcl_node_handle(), pimpl_->feedback_topic_name_.c_str(),
+      &subscriber_count);
+    if (RCL_RET_OK != ret) {
+      rcl_reset_error();
+    } else if (subscriber_count <= sinks.size()) {
+      for (auto & sink : sinks) {
+        sink->deliver(feedback_msg);
+      }
+      return;
+    }
+  }
   rcl_ret_t ret = rcl_action_publish_feedback(pimpl_->action_server_.get(), feedback_msg.get());
   if (RCL_RET_OK != ret) {
     rclcpp::exceptions::throw_from_rcl_error(ret, "Failed to publish feedback");
   }
 }
+
+void
+ServerBase::publish_feedback(const GoalUUID & uuid, std::shared_ptr<void> feedback_msg)
+{
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  if (pimpl_->feedback_policy_.min_period.count() == 0) {
+    publish_feedback(feedback_msg);
+    return;
+  }
+  auto now = std::chrono::steady_clock::now();
+  auto iter = pimpl_->goal_feedbacks_.find(uuid);
+  if (iter == pimpl_->goal_feedbacks_.end()) {
+    pimpl_->goal_feedbacks_[uuid].last_publish = now;
+    publish_feedback(feedback_msg);
+    return;
+  }
+  ServerBaseImpl::GoalFeedback & goal_feedback = iter->second;
+  if (goal_feedback.pending) {
+    // Only the latest feedback is published at the end of the period.
+    goal_feedback.pending = feedback_msg;
+    ++pimpl_->coalesced_feedback_count_;
+  } else if (now - goal_feedback.last_publish >= pimpl_->feedback_policy_.min_period) {
+    goal_feedback.last_publish = now;
+    publish_feedback(feedback_msg);
+  } else if (pimpl_->feedback_policy_.coalesce) {
+    goal_feedback.pending = feedback_msg;
+    ++pimpl_->pending_feedback_count_;
+    pimpl_->start_timer(pimpl_->feedback_timer_.get());
+  } else {
+    ++pimpl_->dropped_feedback_count_;
+  }
+}
+
+void
+ServerBase::publish_pending_feedback(bool all)
+{
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  auto now = std::chrono::steady_clock::now();
+  for (auto & goal_feedback : pimpl_->goal_feedbacks_) {
+    if (
+      !goal_feedback.second.pending ||
+      (!all && now - goal_feedback.second.last_publish < pimpl_->feedback_policy_.min_period))
+    {
+      continue;
+    }
+    std::shared_ptr<void> feedback_msg = std::move(goal_feedback.second.pending);
+    goal_feedback.second.pending.reset();
+    goal_feedback.second.last_publish = now;
+    --pimpl_->pending_feedback_count_;
+    publish_feedback(feedback_msg);
+  }
+  if (0u == pimpl_->pending_feedback_count_) {
+    rcl_ret_t ret = rcl_timer_cancel(pimpl_->feedback_timer_.get());
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret);
+    }
+  }
+}
+
+void
+ServerBase::execute_feedback_timer()
+{
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  if (!is_timer_due(pimpl_->feedback_timer_.get())) {
+    // Already called by a concurrent execution.
+    return;
+  }
+  rcl_ret_t ret = rcl_timer_call(pimpl_->feedback_timer_.get());
+  if (RCL_RET_TIMER_CANCELED == ret) {
+    // Canceled since the wait, e.g. by a change of the policy.
+    rcl_reset_error();
+    return;
+  } else if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret);
+  }
+  publish_pending_feedback(false);
+}
+
+void
+ServerBase::set_feedback_policy(const FeedbackPolicy & policy)
+{
+  if (policy.min_period.count() < 0) {
+    throw std::invalid_argument("the minimum feedback period must not be negative");
+  }
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  // Feedback pending under the previous policy is not delayed any longer.
+  publish_pending_feedback(true);
+  pimpl_->feedback_policy_ = policy;
+  if (policy.min_period.count() == 0) {
+    pimpl_->goal_feedbacks_.clear();
+    return;
+  }
+  int64_t old_period;
+  rcl_ret_t ret = rcl_timer_exchange_period(
+    pimpl_->feedback_timer_.get(), policy.min_period.count(), &old_period);
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret);
+  }
+}
+
+rclcpp_action::FeedbackPolicy
+ServerBase::get_feedback_policy() const
+{
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  return pimpl_->feedback_policy_;
+}
+
+uint64_t
+ServerBase::get_dropped_feedback_count() const
+{
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  return pimpl_->dropped_feedback_count_;
+}
+
+uint64_t
+ServerBase::get_coalesced_feedback_count() const
+{
+  std::lock_guard<std::recursive_mutex> lock(pimpl_->reentrant_mutex_);
+  return pimpl_->coalesced_feedback_count_;
+}
@@ -36,6 +36,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 #include <thread>
 #include <chrono>
 
@@ -292,6 +293,53 @@ TEST_F(TestClient, async_send_goal_no_callbacks)
   EXPECT_THROW(goal_handle->async_result(), rclcpp_action::exceptions::UnawareGoalHandleError);
 }
 
+TEST_F(TestClient, async_send_goal_with_goal_handle_callback)
+{
+  auto action_client = rclcpp_action::create_client<ActionType>(client_node, action_name);
+  ASSERT_TRUE(action_client->wait_for_action_server(WAIT_FOR_SERVER_TIMEOUT));
+
+  bool goal_response_callback_called = false;
+  auto send_goal_ops = rclcpp_action::Client<ActionType>::SendGoalOptions();
+  send_goal_ops.goal_response_callback =
+    [&goal_response_callback_called](std::shared_future<typename ActionGoalHandle::SharedPtr>)
+    {
+      goal_response_callback_called = true;
+    };
+
+  ActionGoal bad_goal;
+  bad_goal.order = -5;
+  auto rejected = std::make_shared<std::promise<typename ActionGoalHandle::SharedPtr>>();
+  std::shared_future<typename ActionGoalHandle::SharedPtr> future_rejected(rejected->get_future());
+  action_client->async_send_goal(
+    bad_goal, send_goal_ops,
+    [rejected](typename ActionGoalHandle::SharedPtr goal_handle) {
+      rejected->set_value(goal_handle);
+    });
+  dual_spin_until_future_complete(future_rejected);
+  EXPECT_EQ(nullptr, future_rejected.get().get());
+
+  // Sent one after the other, the goals reuse the goal request, but get different goal ids.
+  ActionGoal good_goal;
+  good_goal.order = 5;
+  std::vector<typename ActionGoalHandle::SharedPtr> goal_handles;
+  for (int i = 0; i < 2; ++i) {
+    auto accepted = std::make_shared<std::promise<typename ActionGoalHandle::SharedPtr>>();
+    std::shared_future<typename ActionGoalHandle::SharedPtr> future_accepted(
+      accepted->get_future());
+    action_client->async_send_goal(
+      good_goal, send_goal_ops,
+      [accepted](typename ActionGoalHandle::SharedPtr goal_handle) {
+        accepted->set_value(goal_handle);
+      });
+    dual_spin_until_future_complete(future_accepted);
+    goal_handles.push_back(future_accepted.get());
+    ASSERT_NE(nullptr, goal_handles.back());
+    EXPECT_EQ(rclcpp_action::GoalStatus::STATUS_ACCEPTED, goal_handles.back()->get_status());
+  }
+  EXPECT_NE(goal_handles[0]->get_goal_id(), goal_handles[1]->get_goal_id());
+  EXPECT_FALSE(goal_response_callback_called);
+}
+
 TEST_F(TestClient, async_send_goal_no_callbacks_wait_for_result)
 {
   auto action_client = rclcpp_action::create_client<ActionType>(client_node, action_name);
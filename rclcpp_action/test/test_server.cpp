@@ -12,16 +12,24 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <rcl/wait.h>
+
 #include <rclcpp/exceptions.hpp>
 #include <rclcpp/node.hpp>
 #include <rclcpp/rclcpp.hpp>
+#include <rclcpp/scope_exit.hpp>
 #include <test_msgs/action/fibonacci.hpp>
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <future>
+#include <limits>
 #include <memory>
+#include <thread>
 #include <vector>
 
+#include "rclcpp_action/create_client.hpp"
 #include "rclcpp_action/create_server.hpp"
 #include "rclcpp_action/server.hpp"
 
@@ -790,3 +798,474 @@ TEST_F(TestServer, deferred_execution)
   received_handle->execute();
   EXPECT_TRUE(received_handle->is_executing());
 }
+
+TEST_F(TestServer, publish_status_coalesced)
+{
+  auto node = std::make_shared<rclcpp::Node>("status_coalesced", "/rclcpp_action/status_coalesced");
+  const GoalUUID uuid1{{1, 2, 3, 40, 5, 6, 70, 8, 9, 1, 11, 120, 13, 140, 15, 160}};
+  const GoalUUID uuid2{{2, 2, 3, 40, 5, 6, 70, 8, 9, 1, 11, 120, 13, 140, 15, 160}};
+
+  auto handle_goal = [](
+    const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>)
+    {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    };
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+
+  auto handle_cancel = [](std::shared_ptr<GoalHandle>)
+    {
+      return rclcpp_action::CancelResponse::REJECT;
+    };
+
+  std::vector<std::shared_ptr<GoalHandle>> received_handles;
+  auto handle_accepted = [&received_handles](std::shared_ptr<GoalHandle> handle)
+    {
+      received_handles.push_back(handle);
+    };
+
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    handle_goal,
+    handle_cancel,
+    handle_accepted);
+  EXPECT_THROW(
+    as->set_status_publish_period(std::chrono::seconds(-1)), std::invalid_argument);
+  as->set_status_publish_period(std::chrono::seconds(2));
+
+  // Subscribe to status messages
+  std::vector<action_msgs::msg::GoalStatusArray::SharedPtr> received_msgs;
+  auto subscriber = node->create_subscription<action_msgs::msg::GoalStatusArray>(
+    "fibonacci/_action/status", 10,
+    [&received_msgs](action_msgs::msg::GoalStatusArray::SharedPtr list)
+    {
+      received_msgs.push_back(list);
+    });
+
+  // The first change is published right away, the next ones at the end of the period.
+  send_goal_request(node, uuid1);
+  send_goal_request(node, uuid2);
+  ASSERT_EQ(2u, received_handles.size());
+  received_handles[0]->succeed(std::make_shared<Fibonacci::Result>());
+
+  // 10 seconds
+  const size_t max_tries = 10 * 1000 / 100;
+  auto all_changes_received = [&received_msgs]() {
+      return !received_msgs.empty() && 2u == received_msgs.back()->status_list.size();
+    };
+  for (size_t retry = 0; retry < max_tries && !all_changes_received(); ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    rclcpp::spin_some(node);
+  }
+
+  // Three changes, at most two publishes.
+  ASSERT_TRUE(all_changes_received());
+  EXPECT_GE(2u, received_msgs.size());
+  auto & msg = received_msgs.back();
+  for (const auto & status : msg->status_list) {
+    if (status.goal_info.goal_id.uuid == uuid1) {
+      EXPECT_EQ(action_msgs::msg::GoalStatus::STATUS_SUCCEEDED, status.status);
+    } else {
+      EXPECT_EQ(uuid2, status.goal_info.goal_id.uuid);
+      EXPECT_EQ(action_msgs::msg::GoalStatus::STATUS_EXECUTING, status.status);
+    }
+  }
+}
+
+TEST_F(TestServer, publish_feedback_coalesced)
+{
+  auto node =
+    std::make_shared<rclcpp::Node>("feedback_coalesced", "/rclcpp_action/feedback_coalesced");
+  const GoalUUID uuid{{1, 20, 30, 4, 5, 6, 70, 8, 9, 1, 11, 120, 13, 14, 15, 170}};
+
+  auto handle_goal = [](
+    const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>)
+    {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    };
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+
+  auto handle_cancel = [](std::shared_ptr<GoalHandle>)
+    {
+      return rclcpp_action::CancelResponse::REJECT;
+    };
+
+  std::shared_ptr<GoalHandle> received_handle;
+  auto handle_accepted = [&received_handle](std::shared_ptr<GoalHandle> handle)
+    {
+      received_handle = handle;
+    };
+
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    handle_goal,
+    handle_cancel,
+    handle_accepted);
+  rclcpp_action::FeedbackPolicy policy;
+  policy.min_period = std::chrono::seconds(-1);
+  EXPECT_THROW(as->set_feedback_policy(policy), std::invalid_argument);
+  policy.min_period = std::chrono::seconds(1);
+  policy.coalesce = true;
+  as->set_feedback_policy(policy);
+
+  // Subscribe to feedback messages
+  using FeedbackT = Fibonacci::Impl::FeedbackMessage;
+  std::vector<FeedbackT::SharedPtr> received_msgs;
+  auto subscriber = node->create_subscription<FeedbackT>(
+    "fibonacci/_action/feedback", 10, [&received_msgs](FeedbackT::SharedPtr msg)
+    {
+      received_msgs.push_back(msg);
+    });
+
+  send_goal_request(node, uuid);
+
+  // The first feedback is published right away, the latest of the others after the period.
+  for (int32_t i = 0; i < 3; ++i) {
+    auto sent_message = std::make_shared<Fibonacci::Feedback>();
+    sent_message->sequence = {i};
+    received_handle->publish_feedback(sent_message);
+  }
+  EXPECT_EQ(1u, as->get_coalesced_feedback_count());
+  EXPECT_EQ(0u, as->get_dropped_feedback_count());
+
+  // 10 seconds
+  const size_t max_tries = 10 * 1000 / 100;
+  for (size_t retry = 0; retry < max_tries && received_msgs.size() < 2u; ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    rclcpp::spin_some(node);
+  }
+
+  ASSERT_EQ(2u, received_msgs.size());
+  EXPECT_EQ(std::vector<int32_t>{0}, received_msgs[0]->feedback.sequence);
+  EXPECT_EQ(std::vector<int32_t>{2}, received_msgs[1]->feedback.sequence);
+
+  // Without coalescing, the feedback within the period is dropped.
+  policy.coalesce = false;
+  as->set_feedback_policy(policy);
+  auto sent_message = std::make_shared<Fibonacci::Feedback>();
+  received_handle->publish_feedback(sent_message);
+  EXPECT_EQ(1u, as->get_dropped_feedback_count());
+}
+
+TEST_F(TestServer, goal_execution_pool)
+{
+  auto node = std::make_shared<rclcpp::Node>("goal_pool", "/rclcpp_action/goal_pool");
+  const GoalUUID uuid1{{1, 2, 3, 4, 50, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}};
+  const GoalUUID uuid2{{2, 2, 3, 4, 50, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}};
+  const GoalUUID uuid3{{3, 2, 3, 4, 50, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}};
+
+  size_t goal_requests = 0;
+  auto handle_goal = [&goal_requests](
+    const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>)
+    {
+      ++goal_requests;
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    };
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+
+  auto handle_cancel = [](std::shared_ptr<GoalHandle>)
+    {
+      return rclcpp_action::CancelResponse::ACCEPT;
+    };
+
+  std::vector<std::shared_ptr<GoalHandle>> received_handles;
+  auto handle_accepted = [&received_handles](std::shared_ptr<GoalHandle> handle)
+    {
+      received_handles.push_back(handle);
+    };
+
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    handle_goal,
+    handle_cancel,
+    handle_accepted);
+
+  // One goal executed at a time, and one waiting.
+  std::atomic<size_t> executed_goals{0};
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  as->set_goal_execution_pool(
+    1, 1, [&executed_goals, released](std::shared_ptr<GoalHandle> handle)
+    {
+      ++executed_goals;
+      released.wait();
+      handle->succeed(std::make_shared<Fibonacci::Result>());
+    });
+  EXPECT_THROW(
+    as->set_goal_execution_pool(1, 0, [](std::shared_ptr<GoalHandle>) {}), std::runtime_error);
+
+  send_goal_request(node, uuid1);
+  // 10 seconds
+  const size_t max_tries = 10 * 1000 / 100;
+  for (size_t retry = 0; retry < max_tries && 0u == executed_goals.load(); ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  ASSERT_EQ(1u, executed_goals.load());
+  send_goal_request(node, uuid2);
+  EXPECT_EQ(1u, as->get_number_of_queued_goals());
+
+  // The queue is full, the goal is rejected without asking the user.
+  send_goal_request(node, uuid3);
+  EXPECT_EQ(2u, goal_requests);
+  ASSERT_EQ(2u, received_handles.size());
+
+  // The queued goal is canceled without being executed.
+  send_cancel_request(node, uuid2);
+  EXPECT_TRUE(received_handles[1]->is_canceling());
+  release.set_value();
+  for (size_t retry = 0; retry < max_tries && received_handles[1]->is_active(); ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  EXPECT_FALSE(received_handles[1]->is_active());
+  EXPECT_FALSE(received_handles[0]->is_active());
+  EXPECT_EQ(1u, executed_goals.load());
+  EXPECT_EQ(0u, as->get_number_of_queued_goals());
+}
+
+TEST_F(TestServer, result_memory_budget)
+{
+  auto node = std::make_shared<rclcpp::Node>("result_budget", "/rclcpp_action/result_budget");
+  const GoalUUID uuid1{{1, 2, 3, 4, 5, 6, 7, 80, 90, 10, 11, 12, 13, 14, 15, 170}};
+  const GoalUUID uuid2{{2, 2, 3, 4, 5, 6, 7, 80, 90, 10, 11, 12, 13, 14, 15, 170}};
+
+  auto handle_goal = [](
+    const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>)
+    {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    };
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+
+  auto handle_cancel = [](std::shared_ptr<GoalHandle>)
+    {
+      return rclcpp_action::CancelResponse::REJECT;
+    };
+
+  std::vector<std::shared_ptr<GoalHandle>> received_handles;
+  auto handle_accepted = [&received_handles](std::shared_ptr<GoalHandle> handle)
+    {
+      received_handles.push_back(handle);
+    };
+
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    handle_goal,
+    handle_cancel,
+    handle_accepted);
+
+  send_goal_request(node, uuid1);
+  send_goal_request(node, uuid2);
+  ASSERT_EQ(2u, received_handles.size());
+
+  // Room for one result only, the oldest is evicted by the second.
+  auto result = std::make_shared<Fibonacci::Result>();
+  result->sequence = {5, 8, 13, 21};
+  as->set_result_memory_budget(std::numeric_limits<size_t>::max());
+  received_handles[0]->succeed(result);
+  size_t result_size = as->get_result_memory_usage();
+  ASSERT_LT(0u, result_size);
+  as->set_result_memory_budget(result_size);
+  received_handles[1]->succeed(result);
+  EXPECT_EQ(1u, as->get_evicted_result_count());
+  EXPECT_EQ(result_size, as->get_result_memory_usage());
+
+  auto result_client = node->create_client<Fibonacci::Impl::GetResultService>(
+    "fibonacci/_action/get_result");
+  if (!result_client->wait_for_service(std::chrono::seconds(20))) {
+    throw std::runtime_error("get result service didn't become available");
+  }
+  auto get_result = [&node, &result_client](const GoalUUID & uuid) {
+      auto request = std::make_shared<Fibonacci::Impl::GetResultService::Request>();
+      request->goal_id.uuid = uuid;
+      auto future = result_client->async_send_request(request);
+      EXPECT_EQ(
+        rclcpp::executor::FutureReturnCode::SUCCESS,
+        rclcpp::spin_until_future_complete(node, future));
+      return future.get();
+    };
+
+  EXPECT_EQ(action_msgs::msg::GoalStatus::STATUS_UNKNOWN, get_result(uuid1)->status);
+  auto response = get_result(uuid2);
+  EXPECT_EQ(action_msgs::msg::GoalStatus::STATUS_SUCCEEDED, response->status);
+  EXPECT_EQ(result->sequence, response->result.sequence);
+}
+
+TEST_F(TestServer, intra_process_feedback)
+{
+  auto node = std::make_shared<rclcpp::Node>("intra_feedback", "/rclcpp_action/intra_feedback");
+
+  auto handle_goal = [](
+    const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>)
+    {
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    };
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+
+  auto handle_cancel = [](std::shared_ptr<GoalHandle>)
+    {
+      return rclcpp_action::CancelResponse::REJECT;
+    };
+
+  std::shared_ptr<GoalHandle> received_handle;
+  auto handle_accepted = [&received_handle](std::shared_ptr<GoalHandle> handle)
+    {
+      received_handle = handle;
+    };
+
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    handle_goal,
+    handle_cancel,
+    handle_accepted);
+  (void)as;
+
+  // The client of the same node is the only subscriber, it gets the feedback without DDS.
+  auto ac = rclcpp_action::create_client<Fibonacci>(node, "fibonacci");
+  ASSERT_TRUE(ac->wait_for_action_server(std::chrono::seconds(20)));
+  std::vector<std::vector<int32_t>> received_feedback;
+  rclcpp_action::Client<Fibonacci>::SendGoalOptions options;
+  options.feedback_callback = [&received_feedback](
+    rclcpp_action::ClientGoalHandle<Fibonacci>::SharedPtr,
+    const std::shared_ptr<const Fibonacci::Feedback> feedback)
+    {
+      received_feedback.push_back(feedback->sequence);
+    };
+  auto goal_handle_future = ac->async_send_goal(Fibonacci::Goal(), options);
+  ASSERT_EQ(
+    rclcpp::executor::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(node, goal_handle_future));
+  ASSERT_TRUE(received_handle);
+
+  auto sent_message = std::make_shared<Fibonacci::Feedback>();
+  sent_message->sequence = {1, 1, 2, 3, 5};
+  received_handle->publish_feedback(sent_message);
+
+  // 10 seconds
+  const size_t max_tries = 10 * 1000 / 100;
+  for (size_t retry = 0; retry < max_tries && received_feedback.empty(); ++retry) {
+    rclcpp::spin_some(node);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  ASSERT_EQ(1u, received_feedback.size());
+  EXPECT_EQ(sent_message->sequence, received_feedback[0]);
+}
+
+TEST_F(TestServer, result_request_during_slow_goal_callback)
+{
+  auto node = std::make_shared<rclcpp::Node>(
+    "concurrent_requests", "/rclcpp_action/concurrent_requests");
+  auto client_node = std::make_shared<rclcpp::Node>(
+    "concurrent_requests_client", "/rclcpp_action/concurrent_requests");
+  const GoalUUID fast_uuid{{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}};
+  const GoalUUID slow_uuid{{2, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}};
+
+  std::promise<void> slow_goal_received;
+  std::promise<void> release_slow_goal;
+  std::shared_future<void> slow_goal_released(release_slow_goal.get_future());
+  auto handle_goal = [&](const GoalUUID & uuid, std::shared_ptr<const Fibonacci::Goal>)
+    {
+      if (uuid == slow_uuid) {
+        slow_goal_received.set_value();
+        slow_goal_released.wait_for(std::chrono::seconds(10));
+      }
+      return rclcpp_action::GoalResponse::ACCEPT_AND_EXECUTE;
+    };
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+  auto handle_accepted = [](std::shared_ptr<GoalHandle> handle)
+    {
+      handle->succeed(std::make_shared<Fibonacci::Result>());
+    };
+
+  // In a reentrant group, a multi-threaded executor handles the requests concurrently.
+  auto group = node->create_callback_group(
+    rclcpp::callback_group::CallbackGroupType::Reentrant);
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    handle_goal,
+    [](std::shared_ptr<GoalHandle>) {return rclcpp_action::CancelResponse::REJECT;},
+    handle_accepted,
+    rcl_action_server_get_default_options(),
+    group);
+  (void)as;
+
+  rclcpp::executors::MultiThreadedExecutor executor(rclcpp::executor::ExecutorArgs(), 2);
+  executor.add_node(node);
+  std::thread spinner([&executor]() {executor.spin();});
+  RCLCPP_SCOPE_EXIT(
+  {
+    release_slow_goal.set_value();
+    executor.cancel();
+    spinner.join();
+  });
+
+  auto goal_client = client_node->create_client<Fibonacci::Impl::SendGoalService>(
+    "fibonacci/_action/send_goal");
+  auto result_client = client_node->create_client<Fibonacci::Impl::GetResultService>(
+    "fibonacci/_action/get_result");
+  ASSERT_TRUE(goal_client->wait_for_service(std::chrono::seconds(20)));
+  ASSERT_TRUE(result_client->wait_for_service(std::chrono::seconds(20)));
+
+  auto fast_request = std::make_shared<Fibonacci::Impl::SendGoalService::Request>();
+  fast_request->goal_id.uuid = fast_uuid;
+  auto fast_future = goal_client->async_send_request(fast_request);
+  ASSERT_EQ(
+    rclcpp::executor::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(client_node, fast_future, std::chrono::seconds(10)));
+  ASSERT_TRUE(fast_future.get()->accepted);
+
+  auto slow_request = std::make_shared<Fibonacci::Impl::SendGoalService::Request>();
+  slow_request->goal_id.uuid = slow_uuid;
+  auto slow_future = goal_client->async_send_request(slow_request);
+  ASSERT_EQ(
+    std::future_status::ready,
+    slow_goal_received.get_future().wait_for(std::chrono::seconds(10)));
+
+  // The result of the first goal is given while the callback of the second one is running.
+  auto result_request = std::make_shared<Fibonacci::Impl::GetResultService::Request>();
+  result_request->goal_id.uuid = fast_uuid;
+  auto result_future = result_client->async_send_request(result_request);
+  ASSERT_EQ(
+    rclcpp::executor::FutureReturnCode::SUCCESS,
+    rclcpp::spin_until_future_complete(client_node, result_future, std::chrono::seconds(5)));
+  EXPECT_EQ(action_msgs::msg::GoalStatus::STATUS_SUCCEEDED, result_future.get()->status);
+  EXPECT_EQ(std::future_status::timeout, slow_future.wait_for(std::chrono::seconds(0)));
+}
+
+TEST_F(TestServer, idle_server_not_ready)
+{
+  auto node = std::make_shared<rclcpp::Node>("idle_server", "/rclcpp_action/idle_server");
+
+  using GoalHandle = rclcpp_action::ServerGoalHandle<Fibonacci>;
+  auto as = rclcpp_action::create_server<Fibonacci>(
+    node, "fibonacci",
+    [](const GoalUUID &, std::shared_ptr<const Fibonacci::Goal>) {
+      return rclcpp_action::GoalResponse::REJECT;
+    },
+    [](std::shared_ptr<GoalHandle>) {
+      return rclcpp_action::CancelResponse::REJECT;
+    },
+    [](std::shared_ptr<GoalHandle>) {});
+
+  rcl_wait_set_t wait_set = rcl_get_zero_initialized_wait_set();
+  rcl_ret_t ret = rcl_wait_set_init(
+    &wait_set,
+    as->get_number_of_ready_subscriptions(),
+    as->get_number_of_ready_guard_conditions(),
+    as->get_number_of_ready_timers(),
+    as->get_number_of_ready_clients(),
+    as->get_number_of_ready_services(),
+    0,
+    node->get_node_base_interface()->get_context()->get_rcl_context().get(),
+    rcl_get_default_allocator());
+  ASSERT_EQ(RCL_RET_OK, ret);
+  RCLCPP_SCOPE_EXIT({rcl_wait_set_fini(&wait_set);});
+
+  ASSERT_TRUE(as->add_to_wait_set(&wait_set));
+  ret = rcl_wait(&wait_set, RCL_MS_TO_NS(10));
+  ASSERT_EQ(RCL_RET_TIMEOUT, ret);
+  EXPECT_FALSE(as->is_ready(&wait_set));
+}
@@ -14,12 +14,30 @@
 
 #include "component_manager.hpp"
 
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <functional>
+#include <future>
 #include <memory>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "ament_index_cpp/get_resource.hpp"
+#include "rclcpp/executor_instrumentation.hpp"
+#include "rclcpp/executors/multi_threaded_executor.hpp"
+#include "rclcpp/thread_options.hpp"
 #include "rcpputils/filesystem_helper.hpp"
 #include "rcpputils/split.hpp"
 
@@ -28,14 +46,149 @@ using namespace std::placeholders;
 namespace rclcpp_components
 {
 
+namespace
+{
+
+/// Return the CPU time used by the calling thread since it started.
+std::chrono::nanoseconds
+get_current_thread_cpu_time()
+{
+#ifdef _WIN32
+  FILETIME creation_time, exit_time, kernel_time, user_time;
+  if (!GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time)) {
+    return std::chrono::nanoseconds(0);
+  }
+  auto to_100ns = [](const FILETIME & time) {
+      return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+  return std::chrono::nanoseconds(100 * (to_100ns(kernel_time) + to_100ns(user_time)));
+#else
+  struct timespec time;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) {
+    return std::chrono::nanoseconds(0);
+  }
+  return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+#endif
+}
+
+/// Instrumentation of a dedicated executor, which only keeps the CPU time of its threads.
+/**
+ * The threads only run the executor, so at each phase the CPU time of the calling thread since
+ * it started is the CPU time it spent in the executor.
+ */
+class ThreadCpuTimeInstrumentation : public rclcpp::executor::ExecutorInstrumentation
+{
+public:
+  void
+  record_phase(rclcpp::executor::ExecutorPhase, std::chrono::nanoseconds) override
+  {
+    std::chrono::nanoseconds cpu_time = get_current_thread_cpu_time();
+    std::lock_guard<std::mutex> lock(mutex_);
+    thread_cpu_times_[std::this_thread::get_id()] = cpu_time;
+  }
+
+  void
+  record_execution(const void *, const char *, const char *, std::chrono::nanoseconds) override
+  {}
+
+  void
+  record_dispatch_latency(const char *, std::chrono::nanoseconds) override
+  {}
+
+  std::chrono::nanoseconds
+  get_cpu_time() const
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::chrono::nanoseconds cpu_time(0);
+    for (const auto & thread_cpu_time : thread_cpu_times_) {
+      cpu_time += thread_cpu_time.second;
+    }
+    return cpu_time;
+  }
+
+private:
+  mutable std::mutex mutex_;
+  std::unordered_map<std::thread::id, std::chrono::nanoseconds> thread_cpu_times_;
+};
+
+}  // namespace
+
+struct ComponentManager::DedicatedExecutor
+{
+  std::shared_ptr<rclcpp::executors::MultiThreadedExecutor> executor;
+  std::shared_ptr<ThreadCpuTimeInstrumentation> instrumentation;
+  rclcpp::node_interfaces::NodeBaseInterface::SharedPtr node;
+  std::atomic<bool> stopped{false};
+  std::future<void> finished;
+  std::thread thread;
+};
+
 ComponentManager::ComponentManager(
-  std::weak_ptr<rclcpp::executor::Executor> executor)
+  std::weak_ptr<rclcpp::executor::Executor> executor,
+  size_t number_of_load_threads)
 : Node("ComponentManager"),
   executor_(executor)
 {
-  loadNode_srv_ = create_service<LoadNode>(
-    "~/_container/load_node",
-    std::bind(&ComponentManager::OnLoadNode, this, _1, _2, _3));
+  declare_parameter("use_intra_process_comms", false);
+  bool share_message_pools = declare_parameter("share_message_pools", false);
+  int64_t message_pool_chunk_size = declare_parameter("message_pool_chunk_size", int64_t{16});
+  int64_t message_pool_max_size = declare_parameter("message_pool_max_size", int64_t{0});
+  if (message_pool_chunk_size <= 0 || message_pool_max_size < 0) {
+    throw ComponentManagerException(
+            "'message_pool_chunk_size' must be positive and 'message_pool_max_size' non-negative");
+  }
+  if (share_message_pools) {
+    using rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry;
+    message_pools_ = std::make_shared<DynamicMessagePoolRegistry>(
+      static_cast<size_t>(message_pool_chunk_size), static_cast<size_t>(message_pool_max_size));
+  }
+  auto preload_packages = declare_parameter("preload_packages", std::vector<std::string>{});
+  int64_t preload_threads = declare_parameter("preload_threads", int64_t{0});
+  if (preload_threads < 0) {
+    throw ComponentManagerException("'preload_threads' must be non-negative");
+  }
+  auto preload = [this](const std::string & package_name) {
+      try {
+        size_t count = preload_components(package_name);
+        RCLCPP_INFO(
+          get_logger(), "Preloaded %zu components of package '%s'", count, package_name.c_str());
+      } catch (const std::exception & ex) {
+        RCLCPP_ERROR(
+          get_logger(), "Failed to preload package '%s': %s", package_name.c_str(), ex.what());
+      }
+    };
+  if (preload_threads > 0 && !preload_packages.empty()) {
+    preload_pool_ = std::make_shared<rclcpp::detail::WorkerPool>(
+      std::min(static_cast<size_t>(preload_threads), preload_packages.size()));
+    for (const auto & package_name : preload_packages) {
+      preload_pool_->post([preload, package_name]() {preload(package_name);});
+    }
+  } else {
+    for (const auto & package_name : preload_packages) {
+      preload(package_name);
+    }
+  }
+  destroy_unloaded_nodes_timer_ = create_wall_timer(
+    std::chrono::nanoseconds(0), [this]() {destroy_unloaded_nodes();});
+  destroy_unloaded_nodes_timer_->cancel();
+  if (number_of_load_threads > 0) {
+    load_pool_ = std::make_shared<rclcpp::detail::WorkerPool>(number_of_load_threads);
+    add_loaded_nodes_timer_ = create_wall_timer(
+      std::chrono::nanoseconds(0), [this]() {add_loaded_nodes();});
+    add_loaded_nodes_timer_->cancel();
+    loadNode_srv_ = create_service<LoadNode>(
+      "~/_container/load_node",
+      [this](
+        const std::shared_ptr<LoadNode::Request> request,
+        std::shared_ptr<rclcpp::ServiceResponder<LoadNode>> responder)
+      {
+        OnLoadNodeDeferred(request, responder);
+      });
+  } else {
+    loadNode_srv_ = create_service<LoadNode>(
+      "~/_container/load_node",
+      std::bind(&ComponentManager::OnLoadNode, this, _1, _2, _3));
+  }
   unloadNode_srv_ = create_service<UnloadNode>(
     "~/_container/unload_node",
     std::bind(&ComponentManager::OnUnloadNode, this, _1, _2, _3));
@@ -46,19 +199,77 @@ ComponentManager::ComponentManager(
 
 ComponentManager::~ComponentManager()
 {
+  // Wait for the components being loaded, the queued requests are dropped without a response.
+  load_pool_.reset();
+  preload_pool_.reset();
+  // The components still queued for destruction are destroyed here, before their libraries.
+  unload_pool_.reset();
+  unloaded_nodes_.clear();
   if (node_wrappers_.size()) {
     RCLCPP_DEBUG(get_logger(), "Removing components from executor");
-    if (auto exec = executor_.lock()) {
-      for (auto & wrapper : node_wrappers_) {
+    auto exec = executor_.lock();
+    for (auto & wrapper : node_wrappers_) {
+      if (dedicated_executors_.count(wrapper.first)) {
+        remove_dedicated_executor(wrapper.first);
+      } else if (exec) {
         exec->remove_node(wrapper.second.get_node_base_interface());
       }
     }
+    // The nodes are destroyed concurrently, so their entities are finalized in parallel.
+    std::vector<std::shared_ptr<void>> node_instances;
+    node_instances.reserve(node_wrappers_.size());
+    for (auto & wrapper : node_wrappers_) {
+      node_instances.push_back(wrapper.second.get_node_instance());
+    }
+    node_wrappers_.clear();
+    rclcpp::destroy_in_parallel(node_instances);
   }
 }
 
+/// Get the modification time of a file, in nanoseconds if the platform has them.
+static bool
+get_modification_time(const std::string & path, int64_t & modification_time)
+{
+#ifdef _WIN32
+  struct _stat64 status;
+  if (_stat64(path.c_str(), &status) != 0) {
+    return false;
+  }
+  modification_time = static_cast<int64_t>(status.st_mtime) * 1000000000;
+#elif defined(__APPLE__)
+  struct stat status;
+  if (stat(path.c_str(), &status) != 0) {
+    return false;
+  }
+  modification_time =
+    static_cast<int64_t>(status.st_mtimespec.tv_sec) * 1000000000 + status.st_mtimespec.tv_nsec;
+#else
+  struct stat status;
+  if (stat(path.c_str(), &status) != 0) {
+    return false;
+  }
+  modification_time =
+    static_cast<int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+#endif
+  return true;
+}
+
 std::vector<ComponentManager::ComponentResource>
 ComponentManager::get_component_resources(const std::string & package_name) const
 {
+  {
+    std::lock_guard<std::mutex> lock(resource_index_mutex_);
+    auto it = resource_index_.find(package_name);
+    int64_t modification_time;
+    if (
+      it != resource_index_.end() &&
+      get_modification_time(it->second.resource_file, modification_time) &&
+      modification_time == it->second.modification_time)
+    {
+      return it->second.resources;
+    }
+  }
+
   std::string content;
   std::string base_path;
   if (
@@ -82,6 +293,16 @@ ComponentManager::get_component_resources(const std::string & package_name) cons
     }
     resources.push_back({parts[0], library_path});
   }
+
+  PackageResources package_resources;
+  package_resources.resource_file =
+    base_path + "/share/ament_index/resource_index/rclcpp_components/" + package_name;
+  // Without a modification time, e.g. if the file was replaced since, it is parsed again.
+  if (get_modification_time(package_resources.resource_file, package_resources.modification_time)) {
+    package_resources.resources = resources;
+    std::lock_guard<std::mutex> lock(resource_index_mutex_);
+    resource_index_[package_name] = std::move(package_resources);
+  }
   return resources;
 }
 
@@ -92,126 +313,322 @@ ComponentManager::create_component_factory(const ComponentResource & resource)
   std::string class_name = resource.first;
   std::string fq_class_name = "rclcpp_components::NodeFactoryTemplate<" + class_name + ">";
 
-  class_loader::ClassLoader * loader;
-  if (loaders_.find(library_path) == loaders_.end()) {
+  std::unique_lock<std::mutex> lock(loaders_mutex_);
+  auto factory = factories_.find(resource);
+  if (factory != factories_.end()) {
+    return factory->second;
+  }
+
+  auto loader_it = loaders_.find(library_path);
+  if (loader_it == loaders_.end()) {
+    // The library is loaded without the lock, so several libraries can be loaded concurrently.
+    lock.unlock();
     RCLCPP_INFO(get_logger(), "Load Library: %s", library_path.c_str());
+    std::unique_ptr<class_loader::ClassLoader> new_loader;
     try {
-      loaders_[library_path] = std::make_unique<class_loader::ClassLoader>(library_path);
+      new_loader = std::make_unique<class_loader::ClassLoader>(library_path);
     } catch (const std::exception & ex) {
       throw ComponentManagerException("Failed to load library: " + std::string(ex.what()));
     } catch (...) {
       throw ComponentManagerException("Failed to load library");
     }
+    lock.lock();
+    // The loader of another thread loading the same library meanwhile is kept instead.
+    loader_it = loaders_.emplace(library_path, std::move(new_loader)).first;
+    factory = factories_.find(resource);
+    if (factory != factories_.end()) {
+      return factory->second;
+    }
   }
-  loader = loaders_[library_path].get();
+  class_loader::ClassLoader * loader = loader_it->second.get();
 
   auto classes = loader->getAvailableClasses<rclcpp_components::NodeFactory>();
   for (const auto & clazz : classes) {
     RCLCPP_INFO(get_logger(), "Found class: %s", clazz.c_str());
     if (clazz == class_name || clazz == fq_class_name) {
       RCLCPP_INFO(get_logger(), "Instantiate class: %s", clazz.c_str());
-      return loader->createInstance<rclcpp_components::NodeFactory>(clazz);
+      auto new_factory = loader->createInstance<rclcpp_components::NodeFactory>(clazz);
+      factories_[resource] = new_factory;
+      return new_factory;
     }
   }
   return {};
 }
 
-void
-ComponentManager::OnLoadNode(
-  const std::shared_ptr<rmw_request_id_t> request_header,
-  const std::shared_ptr<LoadNode::Request> request,
-  std::shared_ptr<LoadNode::Response> response)
+size_t
+ComponentManager::preload_components(const std::string & package_name)
 {
-  (void) request_header;
+  size_t count = 0;
+  for (const auto & resource : get_component_resources(package_name)) {
+    try {
+      if (create_component_factory(resource)) {
+        ++count;
+      }
+    } catch (const ComponentManagerException & ex) {
+      RCLCPP_ERROR(
+        get_logger(), "Failed to preload component '%s': %s", resource.first.c_str(), ex.what());
+    }
+  }
+  return count;
+}
 
-  try {
-    auto resources = get_component_resources(request->package_name);
+std::chrono::nanoseconds
+ComponentManager::get_component_cpu_time(uint64_t unique_id) const
+{
+  std::lock_guard<std::mutex> lock(dedicated_executors_mutex_);
+  auto dedicated = dedicated_executors_.find(unique_id);
+  if (dedicated == dedicated_executors_.end()) {
+    throw ComponentManagerException(
+            "No dedicated executor for the component with unique_id: " +
+            std::to_string(unique_id));
+  }
+  return dedicated->second->instrumentation->get_cpu_time();
+}
 
-    for (const auto & resource : resources) {
-      if (resource.first != request->plugin_name) {
-        continue;
-      }
-      auto factory = create_component_factory(resource);
+ComponentManager::LoadTimes
+ComponentManager::get_component_load_times(uint64_t unique_id) const
+{
+  std::lock_guard<std::mutex> lock(load_times_mutex_);
+  auto load_times = load_times_.find(unique_id);
+  if (load_times == load_times_.end()) {
+    throw ComponentManagerException(
+            "No component found with unique_id: " + std::to_string(unique_id));
+  }
+  return load_times->second;
+}
 
-      if (factory == nullptr) {
-        continue;
-      }
+rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry::SharedPtr
+ComponentManager::get_message_pools() const
+{
+  return message_pools_;
+}
 
-      std::vector<rclcpp::Parameter> parameters;
-      for (const auto & p : request->parameters) {
-        parameters.push_back(rclcpp::Parameter::from_parameter_msg(p));
-      }
+std::vector<rclcpp::experimental::IntraProcessConnection>
+ComponentManager::get_intra_process_connections() const
+{
+  auto context = get_node_base_interface()->get_context();
+  return context->get_sub_context<rclcpp::experimental::IntraProcessManager>()->get_connections();
+}
 
-      std::vector<std::string> remap_rules;
-      remap_rules.reserve(request->remap_rules.size() * 2 + 1);
-      remap_rules.push_back("--ros-args");
-      for (const std::string & rule : request->remap_rules) {
-        remap_rules.push_back("-r");
-        remap_rules.push_back(rule);
-      }
+bool
+ComponentManager::create_node_instance(
+  const LoadNode::Request & request,
+  rclcpp_components::NodeInstanceWrapper & wrapper,
+  ExecutorAssignment & assignment,
+  LoadTimes & load_times,
+  LoadNode::Response & response)
+{
+  auto start = std::chrono::steady_clock::now();
+  auto resources = get_component_resources(request.package_name);
+  load_times.resources = std::chrono::steady_clock::now() - start;
 
-      if (!request->node_name.empty()) {
-        remap_rules.push_back("-r");
-        remap_rules.push_back("__node:=" + request->node_name);
-      }
+  for (const auto & resource : resources) {
+    if (resource.first != request.plugin_name) {
+      continue;
+    }
+    start = std::chrono::steady_clock::now();
+    auto factory = create_component_factory(resource);
+    load_times.factory += std::chrono::steady_clock::now() - start;
 
-      if (!request->node_namespace.empty()) {
-        remap_rules.push_back("-r");
-        remap_rules.push_back("__ns:=" + request->node_namespace);
-      }
+    if (factory == nullptr) {
+      continue;
+    }
+
+    std::vector<rclcpp::Parameter> parameters;
+    for (const auto & p : request.parameters) {
+      parameters.push_back(rclcpp::Parameter::from_parameter_msg(p));
+    }
 
-      auto options = rclcpp::NodeOptions()
-        .use_global_arguments(false)
-        .parameter_overrides(parameters)
-        .arguments(remap_rules);
+    std::vector<std::string> remap_rules;
+    remap_rules.reserve(request.remap_rules.size() * 2 + 1);
+    remap_rules.push_back("--ros-args");
+    for (const std::string & rule : request.remap_rules) {
+      remap_rules.push_back("-r");
+      remap_rules.push_back(rule);
+    }
 
-      for (const auto & a : request->extra_arguments) {
-        const rclcpp::Parameter extra_argument = rclcpp::Parameter::from_parameter_msg(a);
-        if (extra_argument.get_name() == "use_intra_process_comms") {
-          if (extra_argument.get_type() != rclcpp::ParameterType::PARAMETER_BOOL) {
+    if (!request.node_name.empty()) {
+      remap_rules.push_back("-r");
+      remap_rules.push_back("__node:=" + request.node_name);
+    }
+
+    if (!request.node_namespace.empty()) {
+      remap_rules.push_back("-r");
+      remap_rules.push_back("__ns:=" + request.node_namespace);
+    }
+
+    auto options = rclcpp::NodeOptions()
+      .use_global_arguments(false)
+      .parameter_overrides(parameters)
+      .arguments(remap_rules)
+      .use_intra_process_comms(get_parameter("use_intra_process_comms").as_bool())
+      .message_pools(message_pools_);
+
+    for (const auto & a : request.extra_arguments) {
+      const rclcpp::Parameter extra_argument = rclcpp::Parameter::from_parameter_msg(a);
+      if (extra_argument.get_name() == "use_intra_process_comms") {
+        if (extra_argument.get_type() != rclcpp::ParameterType::PARAMETER_BOOL) {
+          throw ComponentManagerException(
+                  "Extra component argument 'use_intra_process_comms' must be a boolean");
+        }
+        options.use_intra_process_comms(extra_argument.get_value<bool>());
+      } else if (extra_argument.get_name() == "share_message_pools") {
+        if (extra_argument.get_type() != rclcpp::ParameterType::PARAMETER_BOOL) {
+          throw ComponentManagerException(
+                  "Extra component argument 'share_message_pools' must be a boolean");
+        }
+        options.message_pools(extra_argument.get_value<bool>() ? message_pools_ : nullptr);
+      } else if (extra_argument.get_name() == "executor_threads") {
+        if (
+          extra_argument.get_type() != rclcpp::ParameterType::PARAMETER_INTEGER ||
+          extra_argument.get_value<int64_t>() < 0)
+        {
+          throw ComponentManagerException(
+                  "Extra component argument 'executor_threads' must be a non-negative integer");
+        }
+        assignment.number_of_threads = static_cast<size_t>(extra_argument.get_value<int64_t>());
+      } else if (extra_argument.get_name() == "cpu_affinity") {
+        if (extra_argument.get_type() != rclcpp::ParameterType::PARAMETER_INTEGER_ARRAY) {
+          throw ComponentManagerException(
+                  "Extra component argument 'cpu_affinity' must be an integer array");
+        }
+        assignment.cpu_set.clear();
+        for (int64_t cpu : extra_argument.get_value<std::vector<int64_t>>()) {
+          if (cpu < 0) {
             throw ComponentManagerException(
-                    "Extra component argument 'use_intra_process_comms' must be a boolean");
+                    "Extra component argument 'cpu_affinity' must not contain negative CPUs");
           }
-          options.use_intra_process_comms(extra_argument.get_value<bool>());
+          assignment.cpu_set.push_back(static_cast<size_t>(cpu));
         }
       }
+    }
+    if (!assignment.cpu_set.empty() && assignment.number_of_threads == 0) {
+      assignment.number_of_threads = 1;
+    }
 
-      auto node_id = unique_id++;
-
-      if (0 == node_id) {
-        // This puts a technical limit on the number of times you can add a component.
-        // But even if you could add (and remove) them at 1 kHz (very optimistic rate)
-        // it would still be a very long time before you could exhaust the pool of id's:
-        //   2^64 / 1000 times per sec / 60 sec / 60 min / 24 hours / 365 days = 584,942,417 years
-        // So around 585 million years. Even at 1 GHz, it would take 585 years.
-        // I think it's safe to avoid trying to handle overflow.
-        // If we roll over then it's most likely a bug.
-        throw std::overflow_error("exhausted the unique ids for components in this process");
-      }
+    start = std::chrono::steady_clock::now();
+    try {
+      wrapper = factory->create_node_instance(options);
+    } catch (...) {
+      // In the case that the component constructor throws an exception,
+      // rethrow into the following catch block.
+      throw ComponentManagerException("Component constructor threw an exception");
+    }
+    load_times.construction = std::chrono::steady_clock::now() - start;
+    return true;
+  }
+  RCLCPP_ERROR(
+    get_logger(), "Failed to find class with the requested plugin name '%s' in "
+    "the loaded library",
+    request.plugin_name.c_str());
+  response.error_message = "Failed to find class with the requested plugin name.";
+  response.success = false;
+  return false;
+}
 
-      try {
-        node_wrappers_[node_id] = factory->create_node_instance(options);
-      } catch (...) {
-        // In the case that the component constructor throws an exception,
-        // rethrow into the following catch block.
-        throw ComponentManagerException("Component constructor threw an exception");
-      }
+void
+ComponentManager::add_node_instance(
+  rclcpp_components::NodeInstanceWrapper && wrapper,
+  const ExecutorAssignment & assignment,
+  LoadTimes load_times,
+  std::chrono::steady_clock::time_point received,
+  LoadNode::Response & response)
+{
+  auto node_id = unique_id++;
+
+  if (0 == node_id) {
+    // This puts a technical limit on the number of times you can add a component.
+    // But even if you could add (and remove) them at 1 kHz (very optimistic rate)
+    // it would still be a very long time before you could exhaust the pool of id's:
+    //   2^64 / 1000 times per sec / 60 sec / 60 min / 24 hours / 365 days = 584,942,417 years
+    // So around 585 million years. Even at 1 GHz, it would take 585 years.
+    // I think it's safe to avoid trying to handle overflow.
+    // If we roll over then it's most likely a bug.
+    throw std::overflow_error("exhausted the unique ids for components in this process");
+  }
 
-      auto node = node_wrappers_[node_id].get_node_base_interface();
-      if (auto exec = executor_.lock()) {
-        exec->add_node(node, true);
-      }
-      response->full_node_name = node->get_fully_qualified_name();
-      response->unique_id = node_id;
-      response->success = true;
-      return;
+  node_wrappers_[node_id] = std::move(wrapper);
+
+  auto node = node_wrappers_[node_id].get_node_base_interface();
+  auto start = std::chrono::steady_clock::now();
+  if (assignment.number_of_threads > 0) {
+    rclcpp::executor::ExecutorArgs args;
+    args.context = node->get_context();
+    if (!assignment.cpu_set.empty()) {
+      // Thread options are only supported on some platforms, so the threads are only named
+      // after the node along with an affinity.
+      rclcpp::ThreadOptions thread_options;
+      thread_options.name = node->get_name();
+      thread_options.cpu_set = assignment.cpu_set;
+      args.thread_options.assign(assignment.number_of_threads, thread_options);
+    }
+
+    auto dedicated = std::make_unique<DedicatedExecutor>();
+    dedicated->executor = std::make_shared<rclcpp::executors::MultiThreadedExecutor>(
+      args, assignment.number_of_threads);
+    dedicated->instrumentation = std::make_shared<ThreadCpuTimeInstrumentation>();
+    dedicated->executor->set_instrumentation(dedicated->instrumentation);
+    dedicated->executor->add_node(node, true);
+    dedicated->node = node;
+    std::promise<void> finished;
+    dedicated->finished = finished.get_future();
+    DedicatedExecutor * state = dedicated.get();
+    dedicated->thread = std::thread(
+      [this, state, node_id, finished = std::move(finished)]() mutable {
+        try {
+          while (!state->stopped.load() && rclcpp::ok(state->node->get_context())) {
+            state->executor->spin();
+          }
+        } catch (const std::exception & ex) {
+          std::string message = "Dedicated executor of the component with unique_id " +
+            std::to_string(node_id) + " stopped: " + ex.what();
+          RCLCPP_ERROR(get_logger(), message);
+        }
+        finished.set_value();
+      });
+    std::lock_guard<std::mutex> lock(dedicated_executors_mutex_);
+    dedicated_executors_[node_id] = std::move(dedicated);
+  } else if (auto exec = executor_.lock()) {
+    exec->add_node(node, true);
+  }
+  auto now = std::chrono::steady_clock::now();
+  load_times.add = now - start;
+  load_times.total = now - received;
+  {
+    std::lock_guard<std::mutex> lock(load_times_mutex_);
+    load_times_[node_id] = load_times;
+  }
+  auto to_ms = [](std::chrono::nanoseconds duration) {
+      return std::chrono::duration<double, std::milli>(duration).count();
+    };
+  RCLCPP_INFO(
+    get_logger(), "Loaded %s in %.3f ms: resources %.3f ms, factory %.3f ms, "
+    "construction %.3f ms, add %.3f ms", node->get_fully_qualified_name(),
+    to_ms(load_times.total), to_ms(load_times.resources), to_ms(load_times.factory),
+    to_ms(load_times.construction), to_ms(load_times.add));
+
+  response.full_node_name = node->get_fully_qualified_name();
+  response.unique_id = node_id;
+  response.success = true;
+  report_intra_process_fallbacks();
+}
+
+void
+ComponentManager::OnLoadNode(
+  const std::shared_ptr<rmw_request_id_t> request_header,
+  const std::shared_ptr<LoadNode::Request> request,
+  std::shared_ptr<LoadNode::Response> response)
+{
+  (void) request_header;
+
+  try {
+    auto received = std::chrono::steady_clock::now();
+    rclcpp_components::NodeInstanceWrapper wrapper;
+    ExecutorAssignment assignment;
+    LoadTimes load_times;
+    if (create_node_instance(*request, wrapper, assignment, load_times, *response)) {
+      add_node_instance(std::move(wrapper), assignment, load_times, received, *response);
     }
-    RCLCPP_ERROR(
-      get_logger(), "Failed to find class with the requested plugin name '%s' in "
-      "the loaded library",
-      request->plugin_name.c_str());
-    response->error_message = "Failed to find class with the requested plugin name.";
-    response->success = false;
   } catch (const ComponentManagerException & ex) {
     RCLCPP_ERROR(get_logger(), ex.what());
     response->error_message = ex.what();
@@ -219,6 +636,74 @@ ComponentManager::OnLoadNode(
   }
 }
 
+void
+ComponentManager::OnLoadNodeDeferred(
+  const std::shared_ptr<LoadNode::Request> request,
+  std::shared_ptr<rclcpp::ServiceResponder<LoadNode>> responder)
+{
+  auto received = std::chrono::steady_clock::now();
+  load_pool_->post(
+    [this, request, responder, received]() {
+      auto response = std::make_shared<LoadNode::Response>();
+      LoadedNode loaded_node;
+      loaded_node.received = received;
+      try {
+        if (
+          !create_node_instance(
+            *request, loaded_node.wrapper, loaded_node.assignment, loaded_node.load_times,
+            *response))
+        {
+          responder->send_response(response);
+          return;
+        }
+      } catch (const std::exception & ex) {
+        // Not only ComponentManagerException, nothing else would send the response.
+        RCLCPP_ERROR(get_logger(), ex.what());
+        response->error_message = ex.what();
+        response->success = false;
+        responder->send_response(response);
+        return;
+      }
+      loaded_node.response = response;
+      loaded_node.responder = responder;
+      {
+        std::lock_guard<std::mutex> lock(loaded_nodes_mutex_);
+        loaded_nodes_.push_back(std::move(loaded_node));
+      }
+      // The timer is ready right away, the executor is woken up to see it.
+      add_loaded_nodes_timer_->reset();
+      notify_executor();
+    });
+}
+
+void
+ComponentManager::notify_executor()
+{
+  auto node_base = get_node_base_interface();
+  auto notify_guard_condition_lock = node_base->acquire_notify_guard_condition_lock();
+  rcl_ret_t ret = rcl_trigger_guard_condition(node_base->get_notify_guard_condition());
+  if (RCL_RET_OK != ret) {
+    rclcpp::exceptions::throw_from_rcl_error(ret, "failed to trigger notify guard condition");
+  }
+}
+
+void
+ComponentManager::add_loaded_nodes()
+{
+  add_loaded_nodes_timer_->cancel();
+  std::deque<LoadedNode> loaded_nodes;
+  {
+    std::lock_guard<std::mutex> lock(loaded_nodes_mutex_);
+    loaded_nodes.swap(loaded_nodes_);
+  }
+  for (auto & loaded_node : loaded_nodes) {
+    add_node_instance(
+      std::move(loaded_node.wrapper), loaded_node.assignment, loaded_node.load_times,
+      loaded_node.received, *loaded_node.response);
+    loaded_node.responder->send_response(loaded_node.response);
+  }
+}
+
 void
 ComponentManager::OnUnloadNode(
   const std::shared_ptr<rmw_request_id_t> request_header,
@@ -236,14 +721,103 @@ ComponentManager::OnUnloadNode(
     response->error_message = ss.str();
     RCLCPP_WARN(get_logger(), ss.str());
   } else {
-    if (auto exec = executor_.lock()) {
-      exec->remove_node(wrapper->second.get_node_base_interface());
+    UnloadedNode unloaded_node;
+    unloaded_node.dedicated_executor = remove_dedicated_executor(request->unique_id);
+    if (!unloaded_node.dedicated_executor) {
+      if (auto exec = executor_.lock()) {
+        // The other components keep being dispatched, their wait isn't interrupted.
+        exec->remove_node(wrapper->second.get_node_base_interface(), false);
+      }
     }
+    // The memory strategy of the executor may still hold handles of the component, e.g. its
+    // intra-process subscriptions, until it collects the entities again, so the component is
+    // destroyed after the next iteration.
+    unloaded_node.wrapper = std::move(wrapper->second);
+    unloaded_nodes_.push_back(std::move(unloaded_node));
+    destroy_unloaded_nodes_timer_->reset();
+    notify_executor();
     node_wrappers_.erase(wrapper);
+    {
+      std::lock_guard<std::mutex> lock(load_times_mutex_);
+      load_times_.erase(request->unique_id);
+    }
     response->success = true;
   }
 }
 
+std::unique_ptr<ComponentManager::DedicatedExecutor>
+ComponentManager::remove_dedicated_executor(uint64_t node_id)
+{
+  std::unique_ptr<DedicatedExecutor> dedicated;
+  {
+    std::lock_guard<std::mutex> lock(dedicated_executors_mutex_);
+    auto it = dedicated_executors_.find(node_id);
+    if (it == dedicated_executors_.end()) {
+      return nullptr;
+    }
+    dedicated = std::move(it->second);
+    dedicated_executors_.erase(it);
+  }
+  dedicated->stopped.store(true);
+  // cancel() has no effect before spin() started, so it is repeated until the thread ends.
+  dedicated->executor->cancel();
+  while (dedicated->finished.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+    dedicated->executor->cancel();
+  }
+  dedicated->thread.join();
+  dedicated->executor->remove_node(dedicated->node);
+  RCLCPP_DEBUG(
+    get_logger(), "Component with unique_id %s used %.3f ms of CPU time",
+    std::to_string(node_id).c_str(),
+    std::chrono::duration<double, std::milli>(dedicated->instrumentation->get_cpu_time()).count());
+  return dedicated;
+}
+
+void
+ComponentManager::destroy_unloaded_nodes()
+{
+  destroy_unloaded_nodes_timer_->cancel();
+  if (unloaded_nodes_.empty()) {
+    return;
+  }
+  if (!unload_pool_) {
+    unload_pool_ = std::make_shared<rclcpp::detail::WorkerPool>(1);
+  }
+  // A task must be copyable, the components are moved into a shared vector.
+  auto unloaded_nodes = std::make_shared<std::vector<UnloadedNode>>();
+  unloaded_nodes->swap(unloaded_nodes_);
+  unload_pool_->post(
+    [unloaded_nodes]() {
+      // The executors go first, they may hold handles of the nodes.
+      for (auto & unloaded_node : *unloaded_nodes) {
+        unloaded_node.dedicated_executor.reset();
+      }
+      unloaded_nodes->clear();
+    });
+}
+
+void
+ComponentManager::report_intra_process_fallbacks()
+{
+  std::set<std::pair<uint64_t, uint64_t>> fallbacks;
+  for (const auto & connection : get_intra_process_connections()) {
+    if (connection.intra_process) {
+      continue;
+    }
+    auto ids = std::make_pair(connection.publisher_id, connection.subscription_id);
+    fallbacks.insert(ids);
+    if (!reported_intra_process_fallbacks_.count(ids)) {
+      std::stringstream ss;
+      ss << "Publisher " << connection.publisher_id << " and subscription " <<
+        connection.subscription_id << " of topic '" << connection.topic_name <<
+        "' don't communicate intra-process: " << connection.reason;
+      RCLCPP_WARN(get_logger(), ss.str());
+    }
+  }
+  // The pairs which were removed are forgotten.
+  reported_intra_process_fallbacks_.swap(fallbacks);
+}
+
 void
 ComponentManager::OnListNodes(
   const std::shared_ptr<rmw_request_id_t> request_header,
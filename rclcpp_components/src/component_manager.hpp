@@ -15,15 +15,21 @@
 #ifndef COMPONENT_MANAGER_HPP__
 #define COMPONENT_MANAGER_HPP__
 
+#include <chrono>
+#include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "class_loader/class_loader.hpp"
 
+#include "rclcpp/detail/worker_pool.hpp"
 #include "rclcpp/executor.hpp"
+#include "rclcpp/experimental/intra_process_manager.hpp"
 #include "rclcpp/node_options.hpp"
 #include "rclcpp/rclcpp.hpp"
 
@@ -56,19 +62,205 @@ public:
    */
   using ComponentResource = std::pair<std::string, std::string>;
 
-  ComponentManager(
-    std::weak_ptr<rclcpp::executor::Executor> executor);
+  /// Time spent in each phase of loading a component.
+  struct LoadTimes
+  {
+    /// Finding the component in the ament index.
+    std::chrono::nanoseconds resources{0};
+    /// Loading the library and creating the factory of the component, short if already loaded.
+    std::chrono::nanoseconds factory{0};
+    /// Constructing the node, e.g. declaring its parameters and creating its entities.
+    std::chrono::nanoseconds construction{0};
+    /// Adding the node to its executor.
+    std::chrono::nanoseconds add{0};
+    /// From the request to the node being added, including the time waiting for a load thread.
+    std::chrono::nanoseconds total{0};
+  };
+
+  /// Constructor.
+  /**
+   * The parameter "use_intra_process_comms" of the manager, false by default, is the default of
+   * the components for the extra argument of the same name, so setting it turns intra-process
+   * communication on for every component loaded without that extra argument.
+   *
+   * \param[in] executor The executor the nodes of the components are added to.
+   * \param[in] number_of_load_threads The number of threads loading the components, 0 to load
+   *   them one at a time on the executor thread.
+   *   With load threads, the libraries of the components are loaded and their nodes constructed
+   *   concurrently, several load requests being handled at once; the nodes are added to the
+   *   executor one by one, on the executor thread.
+   */
+  explicit ComponentManager(
+    std::weak_ptr<rclcpp::executor::Executor> executor,
+    size_t number_of_load_threads = 0);
 
   ~ComponentManager();
 
   /// Return a list of valid loadable components in a given package.
+  /**
+   * The resources of a package are parsed once, and parsed again only if the modification time
+   * of its resource file changed.
+   * This function is thread-safe.
+   */
   std::vector<ComponentResource>
   get_component_resources(const std::string & package_name) const;
 
+  /// Return the factory of a component, loading its library if it isn't yet.
+  /**
+   * The factories are kept, so creating the factory of a component again is a lookup.
+   * This function is thread-safe.
+   */
   std::shared_ptr<rclcpp_components::NodeFactory>
   create_component_factory(const ComponentResource & resource);
 
+  /// Create the factories of all the components of a package, loading their libraries.
+  /**
+   * The later loads of these components then only construct their nodes.
+   * The packages listed by the `preload_packages` parameter are preloaded when the manager is
+   * created: in the constructor, or concurrently by `preload_threads` threads if it is positive.
+   * A component which fails to load is logged and skipped.
+   * This function is thread-safe.
+   *
+   * \return the number of factories of the package.
+   * \throws ComponentManagerException if the package has no component resources.
+   */
+  size_t
+  preload_components(const std::string & package_name);
+
+  /// Return the CPU time used so far by the dedicated executor of a component.
+  /**
+   * It is the CPU time of the threads of the executor, up to their last pass through the
+   * executor, and stays zero if rclcpp is built without executor instrumentation.
+   * This function is thread-safe.
+   *
+   * \param[in] unique_id The unique id of the component, as returned by the load_node service.
+   * \throws ComponentManagerException if the component doesn't have a dedicated executor.
+   */
+  std::chrono::nanoseconds
+  get_component_cpu_time(uint64_t unique_id) const;
+
+  /// Return the pairs of intra-process publishers and subscriptions in the process.
+  /**
+   * Each pair tells whether the messages are given intra-process, i.e. without a copy when
+   * possible, or fall back to the middleware, and why.
+   * After a component is loaded, the pairs which newly fall back are logged as warnings.
+   * This function is thread-safe.
+   */
+  std::vector<rclcpp::experimental::IntraProcessConnection>
+  get_intra_process_connections() const;
+
+  /// Return the time spent in each phase of loading a component.
+  /**
+   * The times are also logged once the component is loaded.
+   * This function is thread-safe.
+   *
+   * \param[in] unique_id The unique id of the component, as returned by the load_node service.
+   * \throws ComponentManagerException if there is no component with this unique id.
+   */
+  LoadTimes
+  get_component_load_times(uint64_t unique_id) const;
+
+  /// Return the message pools shared by the components, nullptr if they aren't shared.
+  /**
+   * With the `share_message_pools` parameter set, the subscriptions of the components using the
+   * default message memory strategy take their messages from these pools, sized by the
+   * `message_pool_chunk_size` and `message_pool_max_size` parameters, so the messages are
+   * pooled once for the container.
+   * A component can opt out with the `share_message_pools` extra argument set to false.
+   */
+  rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry::SharedPtr
+  get_message_pools() const;
+
 private:
+  /// Executor a component is assigned to, from the extra arguments of its load request.
+  /**
+   * The extra arguments are:
+   * - "executor_threads", an integer: the number of threads of a dedicated executor.
+   * - "cpu_affinity", an integer array: the CPUs the threads of the dedicated executor may run
+   *   on, it implies a dedicated executor with one thread if "executor_threads" isn't given.
+   *
+   * Without them, the node is added to the executor of the container.
+   */
+  struct ExecutorAssignment
+  {
+    /// Number of threads of the dedicated executor, 0 for the executor of the container.
+    size_t number_of_threads = 0;
+    std::vector<size_t> cpu_set;
+  };
+
+  /// A dedicated executor and the thread spinning it, defined in the source file.
+  struct DedicatedExecutor;
+
+  /// A node constructed by a load thread, waiting to be added on the executor thread.
+  struct LoadedNode
+  {
+    rclcpp_components::NodeInstanceWrapper wrapper;
+    ExecutorAssignment assignment;
+    LoadTimes load_times;
+    std::chrono::steady_clock::time_point received;
+    std::shared_ptr<LoadNode::Response> response;
+    std::shared_ptr<rclcpp::ServiceResponder<LoadNode>> responder;
+  };
+
+  /// Construct the node of the component of a request, without adding it.
+  /**
+   * This function is thread-safe.
+   *
+   * \param[out] load_times The times of the phases up to the construction of the node.
+   * \return false, with the error in the response, if the component wasn't found.
+   * \throws ComponentManagerException if the component couldn't be loaded or constructed, or
+   *   if an extra argument is invalid.
+   */
+  bool
+  create_node_instance(
+    const LoadNode::Request & request,
+    rclcpp_components::NodeInstanceWrapper & wrapper,
+    ExecutorAssignment & assignment,
+    LoadTimes & load_times,
+    LoadNode::Response & response);
+
+  /// Give a unique id to a node, add it to its executor, and fill in the response.
+  /**
+   * \param[in] load_times The times of the phases up to the construction of the node.
+   * \param[in] received When the load request was received, for the total time.
+   */
+  void
+  add_node_instance(
+    rclcpp_components::NodeInstanceWrapper && wrapper,
+    const ExecutorAssignment & assignment,
+    LoadTimes load_times,
+    std::chrono::steady_clock::time_point received,
+    LoadNode::Response & response);
+
+  /// Stop the dedicated executor of a component, if it has one, and remove its node from it.
+  /**
+   * \return the stopped executor, nullptr if the component doesn't have one.
+   */
+  std::unique_ptr<DedicatedExecutor>
+  remove_dedicated_executor(uint64_t node_id);
+
+  /// Destroy the unloaded components on the unload thread, called on the executor thread.
+  void
+  destroy_unloaded_nodes();
+
+  /// Wake up the executor of the manager, e.g. after resetting one of its timers.
+  void
+  notify_executor();
+
+  /// Log the intra-process pairs falling back to the middleware which weren't logged yet.
+  void
+  report_intra_process_fallbacks();
+
+  /// Load a component on the load threads, its response is sent once its node is added.
+  void
+  OnLoadNodeDeferred(
+    const std::shared_ptr<LoadNode::Request> request,
+    std::shared_ptr<rclcpp::ServiceResponder<LoadNode>> responder);
+
+  /// Add the nodes constructed by the load threads, on the executor thread.
+  void
+  add_loaded_nodes();
+
   void
   OnLoadNode(
     const std::shared_ptr<rmw_request_id_t> request_header,
@@ -91,9 +283,60 @@ private:
   std::weak_ptr<rclcpp::executor::Executor> executor_;
 
   uint64_t unique_id {1};
+
+  /// Resources of a package, with the modification time of its resource file when parsed.
+  struct PackageResources
+  {
+    std::string resource_file;
+    int64_t modification_time;
+    std::vector<ComponentResource> resources;
+  };
+  mutable std::mutex resource_index_mutex_;
+  mutable std::map<std::string, PackageResources> resource_index_;
+
+  /// Guards the class loaders and the factories.
+  std::mutex loaders_mutex_;
   std::map<std::string, std::unique_ptr<class_loader::ClassLoader>> loaders_;
+  std::map<ComponentResource, std::shared_ptr<rclcpp_components::NodeFactory>> factories_;
   std::map<uint64_t, rclcpp_components::NodeInstanceWrapper> node_wrappers_;
 
+  /// Guards the map of the dedicated executors, the executors themselves are thread-safe.
+  mutable std::mutex dedicated_executors_mutex_;
+  std::map<uint64_t, std::unique_ptr<DedicatedExecutor>> dedicated_executors_;
+
+  /// A component removed from its executor, destroyed once the executor released its handles.
+  struct UnloadedNode
+  {
+    rclcpp_components::NodeInstanceWrapper wrapper;
+    std::unique_ptr<DedicatedExecutor> dedicated_executor;
+  };
+  /// Components unloaded since the last executor iteration, only used on the executor thread.
+  std::vector<UnloadedNode> unloaded_nodes_;
+  /// Timer with a zero period, reset to destroy the unloaded nodes in the next iteration.
+  rclcpp::TimerBase::SharedPtr destroy_unloaded_nodes_timer_;
+  /// Thread destroying the unloaded components, so their destructors don't block the executor.
+  rclcpp::detail::WorkerPool::SharedPtr unload_pool_;
+
+  mutable std::mutex load_times_mutex_;
+  std::map<uint64_t, LoadTimes> load_times_;
+
+  /// Message pools shared by the components, see get_message_pools().
+  rclcpp::strategies::message_pool_memory_strategy::DynamicMessagePoolRegistry::SharedPtr
+    message_pools_;
+
+  /// Publisher and subscription ids of the intra-process fallbacks already logged.
+  std::set<std::pair<uint64_t, uint64_t>> reported_intra_process_fallbacks_;
+
+  /// Threads preloading the packages of the `preload_packages` parameter, if any.
+  rclcpp::detail::WorkerPool::SharedPtr preload_pool_;
+
+  /// Threads loading the components, if any.
+  rclcpp::detail::WorkerPool::SharedPtr load_pool_;
+  /// Timer with a zero period, reset to add the loaded nodes on the executor thread.
+  rclcpp::TimerBase::SharedPtr add_loaded_nodes_timer_;
+  std::mutex loaded_nodes_mutex_;
+  std::deque<LoadedNode> loaded_nodes_;
+
   rclcpp::Service<LoadNode>::SharedPtr loadNode_srv_;
   rclcpp::Service<UnloadNode>::SharedPtr unloadNode_srv_;
   rclcpp::Service<ListNodes>::SharedPtr listNodes_srv_;
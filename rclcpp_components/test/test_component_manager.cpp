@@ -15,6 +15,8 @@
 #include <gtest/gtest.h>
 
 #include <memory>
+#include <thread>
+#include <vector>
 
 #include "component_manager.hpp"
 
@@ -74,6 +76,44 @@ TEST_F(TestComponentManager, create_component_factory_valid)
   }
 }
 
+TEST_F(TestComponentManager, component_resources_and_factories_cached)
+{
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto manager = std::make_shared<rclcpp_components::ComponentManager>(exec);
+
+  auto resources = manager->get_component_resources("rclcpp_components");
+  EXPECT_EQ(resources, manager->get_component_resources("rclcpp_components"));
+
+  // The factory of a component is created once.
+  auto factory = manager->create_component_factory(resources[0]);
+  ASSERT_NE(nullptr, factory);
+  EXPECT_EQ(factory, manager->create_component_factory(resources[0]));
+  EXPECT_NE(factory, manager->create_component_factory(resources[1]));
+}
+
+TEST_F(TestComponentManager, preload_components)
+{
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto manager = std::make_shared<rclcpp_components::ComponentManager>(exec);
+
+  EXPECT_THROW(
+    manager->preload_components("invalid_package"),
+    rclcpp_components::ComponentManagerException);
+
+  // Preloading concurrently creates the factories of all the components.
+  std::vector<std::thread> threads;
+  std::vector<size_t> counts(2);
+  for (size_t i = 0; i < counts.size(); ++i) {
+    threads.emplace_back(
+      [&manager, &counts, i]() {counts[i] = manager->preload_components("rclcpp_components");});
+  }
+  for (auto & thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(3u, counts[0]);
+  EXPECT_EQ(3u, counts[1]);
+}
+
 TEST_F(TestComponentManager, create_component_factory_invalid)
 {
   auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
@@ -14,8 +14,12 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <memory>
+#include <set>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "composition_interfaces/srv/load_node.hpp"
 #include "composition_interfaces/srv/unload_node.hpp"
@@ -241,3 +245,164 @@ TEST_F(TestComponentManager, components_api)
     }
   }
 }
+
+TEST_F(TestComponentManager, components_api_with_load_threads)
+{
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto node = rclcpp::Node::make_shared("test_component_manager_load_threads");
+  auto manager = std::make_shared<rclcpp_components::ComponentManager>(exec, 4);
+
+  exec->add_node(manager);
+  exec->add_node(node);
+
+  auto client = node->create_client<composition_interfaces::srv::LoadNode>(
+    "/ComponentManager/_container/load_node");
+
+  if (!client->wait_for_service(20s)) {
+    ASSERT_TRUE(false) << "service not available after waiting";
+  }
+
+  // The requests are sent at once, and loaded concurrently.
+  std::vector<rclcpp::Client<composition_interfaces::srv::LoadNode>::SharedFuture> results;
+  for (size_t i = 0; i < 4; ++i) {
+    auto request = std::make_shared<composition_interfaces::srv::LoadNode::Request>();
+    request->package_name = "rclcpp_components";
+    request->plugin_name = "test_rclcpp_components::TestComponentFoo";
+    request->node_name = "test_component_load_" + std::to_string(i);
+    results.push_back(client->async_send_request(request));
+  }
+  {
+    // Invalid package, the error is still sent back.
+    auto request = std::make_shared<composition_interfaces::srv::LoadNode::Request>();
+    request->package_name = "rclcpp_components_foo";
+    request->plugin_name = "test_rclcpp_components::TestComponentFoo";
+    results.push_back(client->async_send_request(request));
+  }
+
+  std::set<uint64_t> unique_ids;
+  for (size_t i = 0; i < results.size(); ++i) {
+    auto ret = exec->spin_until_future_complete(results[i], 5s);  // Wait for the result.
+    ASSERT_EQ(ret, rclcpp::executor::FutureReturnCode::SUCCESS);
+    auto response = results[i].get();
+    if (i < 4) {
+      EXPECT_EQ(response->success, true);
+      EXPECT_EQ(response->error_message, "");
+      EXPECT_EQ(response->full_node_name, "/test_component_load_" + std::to_string(i));
+      unique_ids.insert(response->unique_id);
+    } else {
+      EXPECT_EQ(response->success, false);
+      EXPECT_EQ(response->error_message, "Could not find requested resource in ament index");
+    }
+  }
+  EXPECT_EQ(unique_ids, std::set<uint64_t>({1u, 2u, 3u, 4u}));
+
+  // The total time includes the phases, and the time waiting for a load thread.
+  for (uint64_t unique_id : unique_ids) {
+    auto load_times = manager->get_component_load_times(unique_id);
+    EXPECT_GT(load_times.construction.count(), 0);
+    EXPECT_GE(
+      load_times.total,
+      load_times.resources + load_times.factory + load_times.construction + load_times.add);
+  }
+  EXPECT_THROW(
+    manager->get_component_load_times(42u), rclcpp_components::ComponentManagerException);
+
+  auto list_client = node->create_client<composition_interfaces::srv::ListNodes>(
+    "/ComponentManager/_container/list_nodes");
+  if (!list_client->wait_for_service(20s)) {
+    ASSERT_TRUE(false) << "service not available after waiting";
+  }
+  auto result = list_client->async_send_request(
+    std::make_shared<composition_interfaces::srv::ListNodes::Request>());
+  auto ret = exec->spin_until_future_complete(result, 5s);  // Wait for the result.
+  EXPECT_EQ(ret, rclcpp::executor::FutureReturnCode::SUCCESS);
+  EXPECT_EQ(result.get()->full_node_names.size(), 4u);
+}
+
+TEST_F(TestComponentManager, components_api_with_dedicated_executors)
+{
+  auto exec = std::make_shared<rclcpp::executors::SingleThreadedExecutor>();
+  auto node = rclcpp::Node::make_shared("test_component_manager_dedicated");
+  auto manager = std::make_shared<rclcpp_components::ComponentManager>(exec);
+
+  exec->add_node(manager);
+  exec->add_node(node);
+
+  auto client = node->create_client<composition_interfaces::srv::LoadNode>(
+    "/ComponentManager/_container/load_node");
+
+  if (!client->wait_for_service(20s)) {
+    ASSERT_TRUE(false) << "service not available after waiting";
+  }
+
+  auto load = [&](
+    const std::string & node_name,
+    const std::vector<rclcpp::Parameter> & extra_arguments)
+    {
+      auto request = std::make_shared<composition_interfaces::srv::LoadNode::Request>();
+      request->package_name = "rclcpp_components";
+      request->plugin_name = "test_rclcpp_components::TestComponentFoo";
+      request->node_name = node_name;
+      for (const auto & extra_argument : extra_arguments) {
+        request->extra_arguments.push_back(extra_argument.to_parameter_msg());
+      }
+      auto result = client->async_send_request(request);
+      auto ret = exec->spin_until_future_complete(result, 5s);  // Wait for the result.
+      EXPECT_EQ(ret, rclcpp::executor::FutureReturnCode::SUCCESS);
+      return result.get();
+    };
+
+  auto shared = load("test_component_shared", {});
+  EXPECT_EQ(shared->success, true);
+  EXPECT_THROW(
+    manager->get_component_cpu_time(shared->unique_id),
+    rclcpp_components::ComponentManagerException);
+
+  auto dedicated = load(
+    "test_component_dedicated", {rclcpp::Parameter("executor_threads", 2)});
+  EXPECT_EQ(dedicated->success, true);
+  EXPECT_EQ(dedicated->full_node_name, "/test_component_dedicated");
+  EXPECT_GE(manager->get_component_cpu_time(dedicated->unique_id).count(), 0);
+
+#ifdef __linux__
+  auto pinned = load(
+    "test_component_pinned", {rclcpp::Parameter("cpu_affinity", std::vector<int64_t>({0}))});
+  EXPECT_EQ(pinned->success, true);
+  EXPECT_GE(manager->get_component_cpu_time(pinned->unique_id).count(), 0);
+#endif
+
+  auto invalid = load(
+    "test_component_invalid", {rclcpp::Parameter("executor_threads", "two")});
+  EXPECT_EQ(invalid->success, false);
+  EXPECT_EQ(
+    invalid->error_message,
+    "Extra component argument 'executor_threads' must be a non-negative integer");
+
+  auto unload_client = node->create_client<composition_interfaces::srv::UnloadNode>(
+    "/ComponentManager/_container/unload_node");
+  if (!unload_client->wait_for_service(20s)) {
+    ASSERT_TRUE(false) << "service not available after waiting";
+  }
+  auto request = std::make_shared<composition_interfaces::srv::UnloadNode::Request>();
+  request->unique_id = dedicated->unique_id;
+  auto result = unload_client->async_send_request(request);
+  auto ret = exec->spin_until_future_complete(result, 5s);  // Wait for the result.
+  EXPECT_EQ(ret, rclcpp::executor::FutureReturnCode::SUCCESS);
+  EXPECT_EQ(result.get()->success, true);
+  EXPECT_THROW(
+    manager->get_component_cpu_time(dedicated->unique_id),
+    rclcpp_components::ComponentManagerException);
+
+  // The component is destroyed on the unload thread, after the next iteration of the executor.
+  auto unloaded = [&node]() {
+      auto node_names = node->get_node_names();
+      return std::find(
+        node_names.begin(), node_names.end(), "/test_component_dedicated") == node_names.end();
+    };
+  auto start = std::chrono::steady_clock::now();
+  while (!unloaded() && std::chrono::steady_clock::now() - start < 5s) {
+    exec->spin_some();
+    std::this_thread::sleep_for(10ms);
+  }
+  EXPECT_TRUE(unloaded());
+}
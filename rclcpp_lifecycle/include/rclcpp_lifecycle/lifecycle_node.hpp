@@ -105,23 +105,31 @@ public:
    * \param[in] node_name Name of the node.
    * \param[in] namespace_ Namespace of the node.
    * \param[in] options Additional options to control creation of the node.
+   * \param[in] enable_communication_interface Whether to create the lifecycle services and the
+   *   transition event publisher of the node, see enable_communication_interface().
    */
   RCLCPP_LIFECYCLE_PUBLIC
   explicit LifecycleNode(
     const std::string & node_name,
-    const rclcpp::NodeOptions & options = rclcpp::NodeOptions());
+    const rclcpp::NodeOptions & options = rclcpp::NodeOptions(),
+    bool enable_communication_interface = true);
 
   /// Create a node based on the node name and a rclcpp::Context.
   /**
    * \param[in] node_name Name of the node.
    * \param[in] namespace_ Namespace of the node.
    * \param[in] options Additional options to control creation of the node.
+   * \param[in] enable_communication_interface Whether to create the lifecycle services and the
+   *   transition event publisher of the node, see enable_communication_interface().
+   * \throws std::invalid_argument if the context shares one participant between its nodes,
+   *   see rclcpp::InitOptions::share_participant, which the rcl state machine doesn't support.
    */
   RCLCPP_LIFECYCLE_PUBLIC
   LifecycleNode(
     const std::string & node_name,
     const std::string & namespace_,
-    const rclcpp::NodeOptions & options = rclcpp::NodeOptions());
+    const rclcpp::NodeOptions & options = rclcpp::NodeOptions(),
+    bool enable_communication_interface = true);
 
   RCLCPP_LIFECYCLE_PUBLIC
   virtual ~LifecycleNode();
@@ -208,13 +216,15 @@ public:
    * \param[in] period Time interval between triggers of the callback.
    * \param[in] callback User-defined callback function.
    * \param[in] group Callback group to execute this timer's callback in.
+   * \param[in] slack Tolerated lateness of the callback, see rclcpp::TimerBase::set_slack().
    */
   template<typename DurationRepT = int64_t, typename DurationT = std::milli, typename CallbackT>
   typename rclcpp::WallTimer<CallbackT>::SharedPtr
   create_wall_timer(
     std::chrono::duration<DurationRepT, DurationT> period,
     CallbackT callback,
-    rclcpp::callback_group::CallbackGroup::SharedPtr group = nullptr);
+    rclcpp::callback_group::CallbackGroup::SharedPtr group = nullptr,
+    std::chrono::nanoseconds slack = std::chrono::nanoseconds::zero());
 
   /* Create and return a Client. */
   template<typename ServiceT>
@@ -280,6 +290,17 @@ public:
       std::pair<ParameterT, rcl_interfaces::msg::ParameterDescriptor>
     > & parameters);
 
+  /// Declare and initialize several parameters at once.
+  /**
+   * \sa rclcpp::Node::declare_parameters
+   */
+  RCLCPP_LIFECYCLE_PUBLIC
+  std::vector<rclcpp::ParameterValue>
+  declare_parameters(
+    const std::vector<rclcpp::Parameter> & parameters,
+    const std::vector<rcl_interfaces::msg::ParameterDescriptor> & parameter_descriptors =
+    std::vector<rcl_interfaces::msg::ParameterDescriptor>());
+
   /// Undeclare a previously declared parameter.
   /**
    * \sa rclcpp::Node::undeclare_parameter
@@ -559,6 +580,22 @@ public:
   std::vector<Transition>
   get_available_transitions();
 
+  /// Create the lifecycle services and the transition event publisher, if not done yet.
+  /**
+   * Without them, the node is only transitioned from within the process, for example by a
+   * LifecycleNodeGroup, and doesn't publish transition events.
+   * Creating them on demand keeps the DDS entities and the discovery traffic of the nodes which
+   * are never managed remotely down.
+   * The parameter services are controlled by rclcpp::NodeOptions::start_parameter_services().
+   */
+  RCLCPP_LIFECYCLE_PUBLIC
+  void
+  enable_communication_interface();
+
+  RCLCPP_LIFECYCLE_PUBLIC
+  bool
+  is_communication_interface_enabled() const;
+
   /// trigger the specified transition
   /*
    * return the new state after this transition
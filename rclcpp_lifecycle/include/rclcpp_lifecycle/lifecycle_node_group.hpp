@@ -0,0 +1,135 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef RCLCPP_LIFECYCLE__LIFECYCLE_NODE_GROUP_HPP_
+#define RCLCPP_LIFECYCLE__LIFECYCLE_NODE_GROUP_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rclcpp/macros.hpp"
+
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+#include "rclcpp_lifecycle/node_interfaces/lifecycle_node_interface.hpp"
+#include "rclcpp_lifecycle/state.hpp"
+#include "rclcpp_lifecycle/visibility_control.h"
+
+namespace rclcpp_lifecycle
+{
+
+/// Transitions a group of lifecycle nodes of the process together.
+/**
+ * The transitions are triggered directly on the nodes, without calling their change_state
+ * services. The nodes are transitioned in parallel by a number of threads, which only live
+ * for the duration of a transition of the group.
+ *
+ * A node must not be transitioned by other means while the group transitions it.
+ */
+class LifecycleNodeGroup
+{
+public:
+  RCLCPP_SMART_PTR_DEFINITIONS(LifecycleNodeGroup)
+
+  using CallbackReturn = node_interfaces::LifecycleNodeInterface::CallbackReturn;
+
+  /// Outcome of the transition of one node.
+  struct NodeTransitionResult
+  {
+    LifecycleNode::SharedPtr node;
+    /// Return code of the transition callback of the node.
+    CallbackReturn callback_return;
+    /// State of the node after the transition.
+    State state;
+  };
+
+  /// Outcome of the transition of the group, in the order the nodes were added.
+  struct TransitionResult
+  {
+    std::vector<NodeTransitionResult> nodes;
+
+    /// Return true if the transition callbacks of all the nodes succeeded.
+    RCLCPP_LIFECYCLE_PUBLIC
+    bool
+    success() const;
+  };
+
+  /// Create an empty group.
+  /**
+   * \param[in] number_of_threads maximum number of nodes transitioned at once, 0 to use the
+   *   number of hardware threads.
+   */
+  RCLCPP_LIFECYCLE_PUBLIC
+  explicit LifecycleNodeGroup(size_t number_of_threads = 0);
+
+  RCLCPP_LIFECYCLE_PUBLIC
+  virtual ~LifecycleNodeGroup();
+
+  /// Add a node to the group, does nothing if it is already part of it.
+  RCLCPP_LIFECYCLE_PUBLIC
+  void
+  add_node(LifecycleNode::SharedPtr node);
+
+  /// Remove a node from the group, does nothing if it isn't part of it.
+  RCLCPP_LIFECYCLE_PUBLIC
+  void
+  remove_node(const LifecycleNode::SharedPtr & node);
+
+  RCLCPP_LIFECYCLE_PUBLIC
+  size_t
+  size() const;
+
+  /// Trigger the transition of the given id on all the nodes.
+  RCLCPP_LIFECYCLE_PUBLIC
+  TransitionResult
+  trigger_transition(uint8_t transition_id);
+
+  RCLCPP_LIFECYCLE_PUBLIC
+  TransitionResult
+  configure();
+
+  RCLCPP_LIFECYCLE_PUBLIC
+  TransitionResult
+  cleanup();
+
+  RCLCPP_LIFECYCLE_PUBLIC
+  TransitionResult
+  activate();
+
+  RCLCPP_LIFECYCLE_PUBLIC
+  TransitionResult
+  deactivate();
+
+  RCLCPP_LIFECYCLE_PUBLIC
+  TransitionResult
+  shutdown();
+
+private:
+  RCLCPP_DISABLE_COPY(LifecycleNodeGroup)
+
+  using TransitionFunction = std::function<const State &(LifecycleNode &, CallbackReturn &)>;
+
+  TransitionResult
+  transition_nodes(const TransitionFunction & transition);
+
+  size_t number_of_threads_;
+  mutable std::mutex mutex_;
+  std::vector<LifecycleNode::SharedPtr> nodes_;
+};
+
+}  // namespace rclcpp_lifecycle
+
+#endif  // RCLCPP_LIFECYCLE__LIFECYCLE_NODE_GROUP_HPP_
@@ -84,11 +84,13 @@ typename rclcpp::WallTimer<CallbackT>::SharedPtr
 LifecycleNode::create_wall_timer(
   std::chrono::duration<DurationRepT, DurationT> period,
   CallbackT callback,
-  rclcpp::callback_group::CallbackGroup::SharedPtr group)
+  rclcpp::callback_group::CallbackGroup::SharedPtr group,
+  std::chrono::nanoseconds slack)
 {
   auto timer = rclcpp::WallTimer<CallbackT>::make_shared(
     std::chrono::duration_cast<std::chrono::nanoseconds>(period),
     std::move(callback), this->node_base_->get_context());
+  timer->set_slack(slack);
   node_timers_->add_timer(timer, group);
   return timer;
 }
@@ -150,14 +152,19 @@ LifecycleNode::declare_parameters(
   const std::string & namespace_,
   const std::map<std::string, ParameterT> & parameters)
 {
-  std::vector<ParameterT> result;
   std::string normalized_namespace = namespace_.empty() ? "" : (namespace_ + ".");
-  std::transform(
-    parameters.begin(), parameters.end(), std::back_inserter(result),
-    [this, &normalized_namespace](auto element) {
-      return this->declare_parameter(normalized_namespace + element.first, element.second);
-    }
-  );
+  std::vector<rclcpp::Parameter> default_values;
+  default_values.reserve(parameters.size());
+  for (const auto & element : parameters) {
+    default_values.emplace_back(
+      normalized_namespace + element.first, rclcpp::ParameterValue(element.second));
+  }
+  auto values = this->declare_parameters(default_values);
+  std::vector<ParameterT> result;
+  result.reserve(values.size());
+  for (const auto & value : values) {
+    result.push_back(value.get<ParameterT>());
+  }
   return result;
 }
 
@@ -170,19 +177,22 @@ LifecycleNode::declare_parameters(
     std::pair<ParameterT, rcl_interfaces::msg::ParameterDescriptor>
   > & parameters)
 {
-  std::vector<ParameterT> result;
   std::string normalized_namespace = namespace_.empty() ? "" : (namespace_ + ".");
-  std::transform(
-    parameters.begin(), parameters.end(), std::back_inserter(result),
-    [this, &normalized_namespace](auto element) {
-      return static_cast<ParameterT>(
-        this->declare_parameter(
-          normalized_namespace + element.first,
-          element.second.first,
-          element.second.second)
-      );
-    }
-  );
+  std::vector<rclcpp::Parameter> default_values;
+  std::vector<rcl_interfaces::msg::ParameterDescriptor> parameter_descriptors;
+  default_values.reserve(parameters.size());
+  parameter_descriptors.reserve(parameters.size());
+  for (const auto & element : parameters) {
+    default_values.emplace_back(
+      normalized_namespace + element.first, rclcpp::ParameterValue(element.second.first));
+    parameter_descriptors.push_back(element.second.second);
+  }
+  auto values = this->declare_parameters(default_values, parameter_descriptors);
+  std::vector<ParameterT> result;
+  result.reserve(values.size());
+  for (const auto & value : values) {
+    result.push_back(value.get<ParameterT>());
+  }
   return result;
 }
 
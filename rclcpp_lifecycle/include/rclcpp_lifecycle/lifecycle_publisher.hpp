@@ -15,6 +15,7 @@
 #ifndef RCLCPP_LIFECYCLE__LIFECYCLE_PUBLISHER_HPP_
 #define RCLCPP_LIFECYCLE__LIFECYCLE_PUBLISHER_HPP_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <utility>
@@ -63,7 +64,6 @@ public:
     const rclcpp::QoS & qos,
     const rclcpp::PublisherOptionsWithAllocator<Alloc> & options)
   : rclcpp::Publisher<MessageT, Alloc>(node_base, topic, qos, options),
-    enabled_(false),
     logger_(rclcpp::get_logger("LifecyclePublisher"))
   {
   }
@@ -79,12 +79,8 @@ public:
   virtual void
   publish(std::unique_ptr<MessageT, MessageDeleter> msg)
   {
-    if (!enabled_) {
-      RCLCPP_WARN(
-        logger_,
-        "Trying to publish message on the topic '%s', but the publisher is not activated",
-        this->get_topic_name());
-
+    if (!enabled_.load(std::memory_order_relaxed)) {
+      log_publisher_not_enabled();
       return;
     }
     rclcpp::Publisher<MessageT, Alloc>::publish(std::move(msg));
@@ -99,20 +95,36 @@ public:
   virtual void
   publish(const MessageT & msg)
   {
-    if (!enabled_) {
-      RCLCPP_WARN(
-        logger_,
-        "Trying to publish message on the topic '%s', but the publisher is not activated",
-        this->get_topic_name());
-
+    if (!enabled_.load(std::memory_order_relaxed)) {
+      log_publisher_not_enabled();
       return;
     }
     rclcpp::Publisher<MessageT, Alloc>::publish(msg);
   }
 
+  /// LifecyclePublisher publish_batch function
+  /**
+   * The publish_batch function checks once whether the communication
+   * was enabled or disabled and forwards the messages
+   * to the actual rclcpp Publisher base class
+   */
+  template<typename InputIt>
+  void
+  publish_batch(InputIt first, InputIt last)
+  {
+    if (!enabled_.load(std::memory_order_relaxed)) {
+      log_publisher_not_enabled();
+      return;
+    }
+    rclcpp::Publisher<MessageT, Alloc>::publish_batch(first, last);
+  }
+
   virtual void
   on_activate()
   {
+    if (detach_intra_process_when_inactive_) {
+      attach_intra_process();
+    }
     enabled_ = true;
   }
 
@@ -120,6 +132,10 @@ public:
   on_deactivate()
   {
     enabled_ = false;
+    should_log_ = true;
+    if (detach_intra_process_when_inactive_) {
+      detach_intra_process();
+    }
   }
 
   virtual bool
@@ -128,8 +144,80 @@ public:
     return enabled_;
   }
 
+  /// Remove the publisher from the intra process manager while it is not activated.
+  /**
+   * Intra process subscriptions then don't account for the inactive publisher.
+   * The publisher is added back on activation, which must not run concurrently with publishing.
+   * Does nothing if intra process communication is disabled for the publisher.
+   *
+   * \param[in] enable true to detach the publisher while it is not activated.
+   */
+  void
+  set_detach_intra_process_when_inactive(bool enable)
+  {
+    detach_intra_process_when_inactive_ = enable;
+    if (enabled_) {
+      return;
+    }
+    if (enable) {
+      detach_intra_process();
+    } else {
+      attach_intra_process();
+    }
+  }
+
 private:
-  bool enabled_ = false;
+  /// Warn once about publishing while not activated, until the next deactivation.
+  void
+  log_publisher_not_enabled()
+  {
+    if (!should_log_.load(std::memory_order_relaxed) || !should_log_.exchange(false)) {
+      return;
+    }
+    RCLCPP_WARN(
+      logger_,
+      "Trying to publish messages on the topic '%s', but the publisher is not activated. "
+      "Further messages are dropped without warning until the publisher is activated.",
+      this->get_topic_name());
+  }
+
+  void
+  detach_intra_process()
+  {
+    if (intra_process_detached_ || !this->intra_process_is_enabled_) {
+      return;
+    }
+    auto ipm = this->weak_ipm_.lock();
+    if (ipm) {
+      ipm->remove_publisher(this->intra_process_publisher_id_);
+    }
+    // The manager is kept in weak_ipm_ to attach the publisher again.
+    this->intra_process_is_enabled_ = false;
+    intra_process_detached_ = true;
+  }
+
+  void
+  attach_intra_process()
+  {
+    if (!intra_process_detached_) {
+      return;
+    }
+    intra_process_detached_ = false;
+    auto ipm = this->weak_ipm_.lock();
+    if (!ipm) {
+      return;
+    }
+    uint64_t intra_process_publisher_id = ipm->add_publisher(this->shared_from_this());
+    this->setup_intra_process(intra_process_publisher_id, ipm);
+    this->intra_process_subscriptions_ =
+      ipm->get_publisher_subscriptions(intra_process_publisher_id);
+  }
+
+  std::atomic<bool> enabled_{false};
+  // Whether the next publish while not activated warns
+  std::atomic<bool> should_log_{true};
+  bool detach_intra_process_when_inactive_ = false;
+  bool intra_process_detached_ = false;
   rclcpp::Logger logger_;
 };
 
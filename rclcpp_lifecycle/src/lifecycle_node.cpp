@@ -17,6 +17,7 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 #include <utility>
 
@@ -44,29 +45,55 @@
 namespace rclcpp_lifecycle
 {
 
-LifecycleNode::LifecycleNode(
+namespace
+{
+
+rclcpp::node_interfaces::NodeBase *
+create_node_base(
   const std::string & node_name,
+  const std::string & namespace_,
   const rclcpp::NodeOptions & options)
+{
+  // The services of the rcl state machine are named after the rcl node.
+  if (options.context()->get_init_options().share_participant) {
+    throw std::invalid_argument(
+            "lifecycle nodes are not supported in a context sharing one participant");
+  }
+  return new rclcpp::node_interfaces::NodeBase(
+    node_name,
+    namespace_,
+    options.context(),
+    *(options.get_rcl_node_options()),
+    options.use_intra_process_comms(),
+    options.entity_arena(),
+    options.message_pools());
+}
+
+}  // namespace
+
+LifecycleNode::LifecycleNode(
+  const std::string & node_name,
+  const rclcpp::NodeOptions & options,
+  bool enable_communication_interface)
 : LifecycleNode(
     node_name,
     "",
-    options)
+    options,
+    enable_communication_interface)
 {}
 
 LifecycleNode::LifecycleNode(
   const std::string & node_name,
   const std::string & namespace_,
-  const rclcpp::NodeOptions & options)
-: node_base_(new rclcpp::node_interfaces::NodeBase(
-      node_name,
-      namespace_,
-      options.context(),
-      *(options.get_rcl_node_options()),
-      options.use_intra_process_comms())),
-  node_graph_(new rclcpp::node_interfaces::NodeGraph(node_base_.get())),
-  node_logging_(new rclcpp::node_interfaces::NodeLogging(node_base_.get())),
+  const rclcpp::NodeOptions & options,
+  bool enable_communication_interface)
+: node_base_(create_node_base(node_name, namespace_, options)),
+  node_graph_(
+    new rclcpp::node_interfaces::NodeGraph(node_base_.get(), options.use_graph_cache())),
+  node_logging_(new rclcpp::node_interfaces::NodeLogging(
+      node_base_.get(), options.rosout_rate_limit())),
   node_timers_(new rclcpp::node_interfaces::NodeTimers(node_base_.get())),
-  node_topics_(new rclcpp::node_interfaces::NodeTopics(node_base_.get())),
+  node_topics_(new rclcpp::node_interfaces::NodeTopics(node_base_.get(), node_graph_.get())),
   node_services_(new rclcpp::node_interfaces::NodeServices(node_base_.get())),
   node_clock_(new rclcpp::node_interfaces::NodeClock(
       node_base_,
@@ -87,7 +114,11 @@ LifecycleNode::LifecycleNode(
       options.parameter_event_qos(),
       options.parameter_event_publisher_options(),
       options.allow_undeclared_parameters(),
-      options.automatically_declare_parameters_from_overrides()
+      options.automatically_declare_parameters_from_overrides(),
+      options.parameter_event_coalescing_period(),
+      node_timers_,
+      options.lazy_parameter_event_publisher(),
+      options.parameter_snapshot_path()
     )),
   node_time_source_(new rclcpp::node_interfaces::NodeTimeSource(
       node_base_,
@@ -102,7 +133,7 @@ LifecycleNode::LifecycleNode(
   node_options_(options),
   impl_(new LifecycleNodeInterfaceImpl(node_base_, node_services_))
 {
-  impl_->init();
+  impl_->init(enable_communication_interface);
 
   register_on_configure(
     std::bind(
@@ -161,6 +192,14 @@ LifecycleNode::declare_parameter(
   return this->node_parameters_->declare_parameter(name, default_value, parameter_descriptor);
 }
 
+std::vector<rclcpp::ParameterValue>
+LifecycleNode::declare_parameters(
+  const std::vector<rclcpp::Parameter> & parameters,
+  const std::vector<rcl_interfaces::msg::ParameterDescriptor> & parameter_descriptors)
+{
+  return this->node_parameters_->declare_parameters(parameters, parameter_descriptors);
+}
+
 void
 LifecycleNode::undeclare_parameter(const std::string & name)
 {
@@ -473,6 +512,18 @@ LifecycleNode::get_available_transitions()
   return impl_->get_available_transitions();
 }
 
+void
+LifecycleNode::enable_communication_interface()
+{
+  impl_->enable_communication_interface();
+}
+
+bool
+LifecycleNode::is_communication_interface_enabled() const
+{
+  return impl_->is_communication_interface_enabled();
+}
+
 const State &
 LifecycleNode::trigger_transition(const Transition & transition)
 {
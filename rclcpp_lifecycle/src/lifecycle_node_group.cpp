@@ -0,0 +1,176 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "rclcpp_lifecycle/lifecycle_node_group.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace rclcpp_lifecycle
+{
+
+bool
+LifecycleNodeGroup::TransitionResult::success() const
+{
+  return std::all_of(
+    nodes.begin(), nodes.end(),
+    [](const NodeTransitionResult & result) {
+      return CallbackReturn::SUCCESS == result.callback_return;
+    });
+}
+
+LifecycleNodeGroup::LifecycleNodeGroup(size_t number_of_threads)
+: number_of_threads_(number_of_threads)
+{
+  if (0u == number_of_threads_) {
+    number_of_threads_ = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+}
+
+LifecycleNodeGroup::~LifecycleNodeGroup()
+{
+}
+
+void
+LifecycleNodeGroup::add_node(LifecycleNode::SharedPtr node)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (std::find(nodes_.begin(), nodes_.end(), node) == nodes_.end()) {
+    nodes_.push_back(std::move(node));
+  }
+}
+
+void
+LifecycleNodeGroup::remove_node(const LifecycleNode::SharedPtr & node)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  nodes_.erase(std::remove(nodes_.begin(), nodes_.end(), node), nodes_.end());
+}
+
+size_t
+LifecycleNodeGroup::size() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return nodes_.size();
+}
+
+LifecycleNodeGroup::TransitionResult
+LifecycleNodeGroup::trigger_transition(uint8_t transition_id)
+{
+  return transition_nodes(
+    [transition_id](LifecycleNode & node, CallbackReturn & cb_return_code) -> const State & {
+      return node.trigger_transition(transition_id, cb_return_code);
+    });
+}
+
+LifecycleNodeGroup::TransitionResult
+LifecycleNodeGroup::configure()
+{
+  return transition_nodes(
+    [](LifecycleNode & node, CallbackReturn & cb_return_code) -> const State & {
+      return node.configure(cb_return_code);
+    });
+}
+
+LifecycleNodeGroup::TransitionResult
+LifecycleNodeGroup::cleanup()
+{
+  return transition_nodes(
+    [](LifecycleNode & node, CallbackReturn & cb_return_code) -> const State & {
+      return node.cleanup(cb_return_code);
+    });
+}
+
+LifecycleNodeGroup::TransitionResult
+LifecycleNodeGroup::activate()
+{
+  return transition_nodes(
+    [](LifecycleNode & node, CallbackReturn & cb_return_code) -> const State & {
+      return node.activate(cb_return_code);
+    });
+}
+
+LifecycleNodeGroup::TransitionResult
+LifecycleNodeGroup::deactivate()
+{
+  return transition_nodes(
+    [](LifecycleNode & node, CallbackReturn & cb_return_code) -> const State & {
+      return node.deactivate(cb_return_code);
+    });
+}
+
+LifecycleNodeGroup::TransitionResult
+LifecycleNodeGroup::shutdown()
+{
+  return transition_nodes(
+    [](LifecycleNode & node, CallbackReturn & cb_return_code) -> const State & {
+      return node.shutdown(cb_return_code);
+    });
+}
+
+LifecycleNodeGroup::TransitionResult
+LifecycleNodeGroup::transition_nodes(const TransitionFunction & transition)
+{
+  std::vector<LifecycleNode::SharedPtr> nodes;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    nodes = nodes_;
+  }
+
+  TransitionResult result;
+  result.nodes.resize(nodes.size());
+  std::vector<std::exception_ptr> exceptions(nodes.size());
+  std::atomic<size_t> next_node{0};
+
+  // Each thread takes the next node to transition, until all of them are done.
+  auto transition_next_nodes = [&]() {
+      for (size_t index = next_node++; index < nodes.size(); index = next_node++) {
+        auto & node_result = result.nodes[index];
+        node_result.node = nodes[index];
+        node_result.callback_return = CallbackReturn::ERROR;
+        try {
+          node_result.state = transition(*nodes[index], node_result.callback_return);
+        } catch (...) {
+          exceptions[index] = std::current_exception();
+        }
+      }
+    };
+
+  size_t number_of_threads = std::min(number_of_threads_, nodes.size());
+  std::vector<std::thread> threads;
+  if (number_of_threads > 1u) {
+    threads.reserve(number_of_threads - 1u);
+    for (size_t i = 1u; i < number_of_threads; ++i) {
+      threads.emplace_back(transition_next_nodes);
+    }
+  }
+  // The calling thread transitions nodes too.
+  transition_next_nodes();
+  for (auto & thread : threads) {
+    thread.join();
+  }
+
+  for (const auto & exception : exceptions) {
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+  }
+  return result;
+}
+
+}  // namespace rclcpp_lifecycle
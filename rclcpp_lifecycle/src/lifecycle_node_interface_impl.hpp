@@ -33,10 +33,13 @@
 #include "lifecycle_msgs/srv/get_available_transitions.hpp"
 
 #include "rcl/error_handling.h"
+#include "rcl/publisher.h"
+#include "rcl/service.h"
 
 #include "rcl_lifecycle/rcl_lifecycle.h"
 #include "rcl_lifecycle/transition_map.h"
 
+#include "rclcpp/exceptions.hpp"
 #include "rclcpp/node_interfaces/node_base_interface.hpp"
 #include "rclcpp/node_interfaces/node_services_interface.hpp"
 
@@ -75,7 +78,7 @@ public:
   }
 
   void
-  init()
+  init(bool enable_communication_interface)
   {
     rcl_node_t * node_handle = node_base_interface_->get_rcl_node_handle();
     const rcl_node_options_t * node_options =
@@ -104,6 +107,34 @@ public:
               node_base_interface_->get_name());
     }
 
+    if (enable_communication_interface) {
+      add_services();
+    } else {
+      fini_communication_interface();
+    }
+    communication_interface_enabled_ = enable_communication_interface;
+  }
+
+  void
+  enable_communication_interface()
+  {
+    if (communication_interface_enabled_) {
+      return;
+    }
+    init_communication_interface();
+    add_services();
+    communication_interface_enabled_ = true;
+  }
+
+  bool
+  is_communication_interface_enabled() const
+  {
+    return communication_interface_enabled_;
+  }
+
+  void
+  add_services()
+  {
     {  // change_state
       auto cb = std::bind(
         &LifecycleNodeInterfaceImpl::on_change_state, this,
@@ -187,6 +218,93 @@ public:
     }
   }
 
+  // rcl_lifecycle always creates the transition event publisher and the services, they are
+  // finalized right away when the communication interface is disabled.
+  void
+  fini_communication_interface()
+  {
+    rcl_node_t * node_handle = node_base_interface_->get_rcl_node_handle();
+    auto & com_interface = state_machine_.com_interface;
+    // rcl_lifecycle finalizes them again with the state machine, which ignores zero initialized
+    // handles.
+    rcl_ret_t ret = rcl_publisher_fini(&com_interface.pub_transition_event, node_handle);
+    com_interface.pub_transition_event = rcl_get_zero_initialized_publisher();
+    for (rcl_service_t * service : get_services()) {
+      rcl_ret_t service_ret = rcl_service_fini(service, node_handle);
+      if (RCL_RET_OK == ret) {
+        ret = service_ret;
+      }
+      *service = rcl_get_zero_initialized_service();
+    }
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(
+        ret, "failed to finalize the lifecycle communication interface");
+    }
+  }
+
+  // Creates the entities rcl_lifecycle would have created, with the same names and options.
+  void
+  init_communication_interface()
+  {
+    rcl_node_t * node_handle = node_base_interface_->get_rcl_node_handle();
+    auto & com_interface = state_machine_.com_interface;
+    rcl_publisher_options_t publisher_options = rcl_publisher_get_default_options();
+    rcl_ret_t ret = rcl_publisher_init(
+      &com_interface.pub_transition_event, node_handle,
+      ROSIDL_GET_MSG_TYPE_SUPPORT(lifecycle_msgs, msg, TransitionEvent),
+      "~/transition_event", &publisher_options);
+    if (RCL_RET_OK != ret) {
+      rclcpp::exceptions::throw_from_rcl_error(ret, "failed to create transition event publisher");
+    }
+
+    struct ServiceDescription
+    {
+      rcl_service_t * service;
+      const rosidl_service_type_support_t * type_support;
+      const char * name;
+    };
+    const ServiceDescription services[] = {
+      {&com_interface.srv_change_state,
+        rosidl_typesupport_cpp::get_service_type_support_handle<ChangeStateSrv>(),
+        "~/change_state"},
+      {&com_interface.srv_get_state,
+        rosidl_typesupport_cpp::get_service_type_support_handle<GetStateSrv>(),
+        "~/get_state"},
+      {&com_interface.srv_get_available_states,
+        rosidl_typesupport_cpp::get_service_type_support_handle<GetAvailableStatesSrv>(),
+        "~/get_available_states"},
+      {&com_interface.srv_get_available_transitions,
+        rosidl_typesupport_cpp::get_service_type_support_handle<GetAvailableTransitionsSrv>(),
+        "~/get_available_transitions"},
+      {&com_interface.srv_get_transition_graph,
+        rosidl_typesupport_cpp::get_service_type_support_handle<GetAvailableTransitionsSrv>(),
+        "~/get_transition_graph"},
+    };
+    rcl_service_options_t service_options = rcl_service_get_default_options();
+    for (const auto & description : services) {
+      ret = rcl_service_init(
+        description.service, node_handle, description.type_support, description.name,
+        &service_options);
+      if (RCL_RET_OK != ret) {
+        rclcpp::exceptions::throw_from_rcl_error(
+          ret, std::string("failed to create service ") + description.name);
+      }
+    }
+  }
+
+  std::vector<rcl_service_t *>
+  get_services()
+  {
+    auto & com_interface = state_machine_.com_interface;
+    return {
+      &com_interface.srv_change_state,
+      &com_interface.srv_get_state,
+      &com_interface.srv_get_available_states,
+      &com_interface.srv_get_available_transitions,
+      &com_interface.srv_get_transition_graph,
+    };
+  }
+
   bool
   register_callback(
     std::uint8_t lifecycle_transition,
@@ -366,7 +484,8 @@ public:
       return RCL_RET_ERROR;
     }
 
-    constexpr bool publish_update = true;
+    // Without communication interface there is no transition event publisher.
+    const bool publish_update = communication_interface_enabled_;
     // keep the initial state to pass to a transition callback
     State initial_state(state_machine_.current_state);
 
@@ -494,6 +613,7 @@ public:
   }
 
   rcl_lifecycle_state_machine_t state_machine_;
+  bool communication_interface_enabled_ = false;
   State current_state_;
   std::map<
     std::uint8_t,
@@ -160,6 +160,22 @@ TEST_F(TestDefaultStateMachine, trigger_transition) {
       rclcpp_lifecycle::Transition(Transition::TRANSITION_UNCONFIGURED_SHUTDOWN)).id());
 }
 
+TEST_F(TestDefaultStateMachine, disabled_communication_interface) {
+  auto test_node = std::make_shared<rclcpp_lifecycle::LifecycleNode>(
+    "testnode", rclcpp::NodeOptions(), false);
+  EXPECT_FALSE(test_node->is_communication_interface_enabled());
+
+  // Transitions don't publish their events without the communication interface.
+  EXPECT_EQ(State::PRIMARY_STATE_INACTIVE, test_node->configure().id());
+  EXPECT_EQ(State::PRIMARY_STATE_ACTIVE, test_node->activate().id());
+
+  test_node->enable_communication_interface();
+  EXPECT_TRUE(test_node->is_communication_interface_enabled());
+  test_node->enable_communication_interface();
+  EXPECT_EQ(State::PRIMARY_STATE_INACTIVE, test_node->deactivate().id());
+  EXPECT_EQ(State::PRIMARY_STATE_FINALIZED, test_node->shutdown().id());
+}
+
 TEST_F(TestDefaultStateMachine, trigger_transition_with_error_code) {
   auto test_node = std::make_shared<EmptyLifecycleNode>("testnode");
 
@@ -0,0 +1,96 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lifecycle_msgs/msg/state.hpp"
+#include "lifecycle_msgs/msg/transition.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+#include "rclcpp_lifecycle/lifecycle_node_group.hpp"
+
+using lifecycle_msgs::msg::State;
+using lifecycle_msgs::msg::Transition;
+using CallbackReturn = rclcpp_lifecycle::LifecycleNodeGroup::CallbackReturn;
+
+class TestLifecycleNodeGroup : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+};
+
+TEST_F(TestLifecycleNodeGroup, transition_nodes)
+{
+  rclcpp_lifecycle::LifecycleNodeGroup group(4);
+  std::vector<rclcpp_lifecycle::LifecycleNode::SharedPtr> nodes;
+  for (size_t i = 0; i < 10; ++i) {
+    nodes.push_back(
+      std::make_shared<rclcpp_lifecycle::LifecycleNode>("group_node_" + std::to_string(i)));
+    group.add_node(nodes.back());
+  }
+  group.add_node(nodes.front());
+  EXPECT_EQ(10u, group.size());
+
+  auto result = group.configure();
+  EXPECT_TRUE(result.success());
+  ASSERT_EQ(10u, result.nodes.size());
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    EXPECT_EQ(nodes[i], result.nodes[i].node);
+    EXPECT_EQ(State::PRIMARY_STATE_INACTIVE, result.nodes[i].state.id());
+    EXPECT_EQ(State::PRIMARY_STATE_INACTIVE, nodes[i]->get_current_state().id());
+  }
+
+  EXPECT_TRUE(group.trigger_transition(Transition::TRANSITION_ACTIVATE).success());
+  for (const auto & node : nodes) {
+    EXPECT_EQ(State::PRIMARY_STATE_ACTIVE, node->get_current_state().id());
+  }
+  EXPECT_TRUE(group.deactivate().success());
+  EXPECT_TRUE(group.cleanup().success());
+  EXPECT_TRUE(group.shutdown().success());
+  for (const auto & node : nodes) {
+    EXPECT_EQ(State::PRIMARY_STATE_FINALIZED, node->get_current_state().id());
+  }
+}
+
+TEST_F(TestLifecycleNodeGroup, failed_transition)
+{
+  rclcpp_lifecycle::LifecycleNodeGroup group;
+  auto good_node = std::make_shared<rclcpp_lifecycle::LifecycleNode>("good_group_node");
+  auto bad_node = std::make_shared<rclcpp_lifecycle::LifecycleNode>("bad_group_node");
+  bad_node->register_on_configure(
+    [](const rclcpp_lifecycle::State &) {
+      return CallbackReturn::FAILURE;
+    });
+  group.add_node(good_node);
+  group.add_node(bad_node);
+
+  auto result = group.configure();
+  EXPECT_FALSE(result.success());
+  ASSERT_EQ(2u, result.nodes.size());
+  EXPECT_EQ(CallbackReturn::SUCCESS, result.nodes[0].callback_return);
+  EXPECT_EQ(State::PRIMARY_STATE_INACTIVE, result.nodes[0].state.id());
+  EXPECT_EQ(CallbackReturn::FAILURE, result.nodes[1].callback_return);
+  EXPECT_EQ(State::PRIMARY_STATE_UNCONFIGURED, result.nodes[1].state.id());
+
+  group.remove_node(bad_node);
+  EXPECT_EQ(1u, group.size());
+}
@@ -0,0 +1,77 @@
+// Copyright 2020 Open Source Robotics Foundation, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+#include "lifecycle_msgs/msg/state.hpp"
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_lifecycle/lifecycle_node.hpp"
+#include "rclcpp_lifecycle/lifecycle_publisher.hpp"
+
+using lifecycle_msgs::msg::State;
+
+class TestLifecyclePublisher : public ::testing::Test
+{
+protected:
+  static void SetUpTestCase()
+  {
+    rclcpp::init(0, nullptr);
+  }
+};
+
+TEST_F(TestLifecyclePublisher, publish_while_inactive)
+{
+  auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>("lifecycle_publisher");
+  auto publisher = node->create_publisher<State>("state", 10);
+  EXPECT_FALSE(publisher->is_activated());
+
+  // Messages are dropped without throwing, the warning is only logged once.
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_NO_THROW(publisher->publish(State()));
+  }
+  publisher->on_activate();
+  EXPECT_TRUE(publisher->is_activated());
+  EXPECT_NO_THROW(publisher->publish(State()));
+  publisher->on_deactivate();
+  EXPECT_FALSE(publisher->is_activated());
+  EXPECT_NO_THROW(publisher->publish(State()));
+}
+
+TEST_F(TestLifecyclePublisher, detach_intra_process_when_inactive)
+{
+  auto options = rclcpp::NodeOptions().use_intra_process_comms(true);
+  auto node = std::make_shared<rclcpp_lifecycle::LifecycleNode>(
+    "lifecycle_publisher_ipc", options);
+  auto publisher = node->create_publisher<State>("state", 10);
+  auto subscription = node->create_subscription<State>(
+    "state", 10, [](State::SharedPtr) {});
+  EXPECT_EQ(1u, publisher->get_intra_process_subscription_count());
+
+  publisher->set_detach_intra_process_when_inactive(true);
+  EXPECT_EQ(0u, publisher->get_intra_process_subscription_count());
+  EXPECT_NO_THROW(publisher->publish(State()));
+
+  publisher->on_activate();
+  EXPECT_EQ(1u, publisher->get_intra_process_subscription_count());
+  EXPECT_NO_THROW(publisher->publish(State()));
+
+  publisher->on_deactivate();
+  EXPECT_EQ(0u, publisher->get_intra_process_subscription_count());
+
+  publisher->set_detach_intra_process_when_inactive(false);
+  EXPECT_EQ(1u, publisher->get_intra_process_subscription_count());
+}